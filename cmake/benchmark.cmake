@@ -0,0 +1,9 @@
+# Benchmarks are built with the target fwe-benchmarks and run with "ctest -L benchmark". The results are written as
+# JSON, so that they can be compared between builds.
+add_custom_target(fwe-benchmarks)
+function(add_benchmark BENCHMARK_NAME)
+    add_test(NAME ${BENCHMARK_NAME}
+        COMMAND ${BENCHMARK_NAME} --benchmark_out=benchmark-report-${BENCHMARK_NAME}.json --benchmark_out_format=json)
+    set_tests_properties(${BENCHMARK_NAME} PROPERTIES LABELS benchmark)
+    add_dependencies(fwe-benchmarks ${BENCHMARK_NAME})
+endfunction()
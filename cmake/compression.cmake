@@ -0,0 +1,37 @@
+#
+#  Finds the optional compression libraries besides Snappy.
+#
+#  Options used by this module:
+#
+#  FWE_FEATURE_LZ4   Enables the LZ4 codec, needs the LZ4 headers and library
+#  FWE_FEATURE_ZSTD  Enables the Zstandard codec, needs the Zstandard headers and library
+#
+#  Variables defined by this module:
+#
+#  COMPRESSION_LIBRARIES     The libraries of the enabled codecs
+
+set(COMPRESSION_LIBRARIES "")
+
+if(FWE_FEATURE_LZ4)
+  find_path(LZ4_INCLUDE_DIR NAMES lz4.h)
+  find_library(LZ4_LIBRARIES NAMES lz4)
+  if(NOT LZ4_INCLUDE_DIR OR NOT LZ4_LIBRARIES)
+    message(FATAL_ERROR "FWE_FEATURE_LZ4 is set but LZ4 was not found")
+  endif()
+  message(STATUS "LZ4_LIBRARY: ${LZ4_LIBRARIES}")
+  include_directories(${LZ4_INCLUDE_DIR})
+  add_compile_options("-DFWE_FEATURE_LZ4")
+  list(APPEND COMPRESSION_LIBRARIES ${LZ4_LIBRARIES})
+endif()
+
+if(FWE_FEATURE_ZSTD)
+  find_path(ZSTD_INCLUDE_DIR NAMES zstd.h)
+  find_library(ZSTD_LIBRARIES NAMES zstd)
+  if(NOT ZSTD_INCLUDE_DIR OR NOT ZSTD_LIBRARIES)
+    message(FATAL_ERROR "FWE_FEATURE_ZSTD is set but Zstandard was not found")
+  endif()
+  message(STATUS "ZSTD_LIBRARY: ${ZSTD_LIBRARIES}")
+  include_directories(${ZSTD_INCLUDE_DIR})
+  add_compile_options("-DFWE_FEATURE_ZSTD")
+  list(APPEND COMPRESSION_LIBRARIES ${ZSTD_LIBRARIES})
+endif()
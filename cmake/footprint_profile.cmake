@@ -0,0 +1,19 @@
+#
+#  Selects the compile-time limits of the build, see FootprintProfile.h
+#
+#  Options used by this module:
+#
+#  FWE_FOOTPRINT_PROFILE  SMALL for low-end control units with little RAM, LARGE for central compute units,
+#                         DEFAULT otherwise
+
+set(FWE_FOOTPRINT_PROFILE "DEFAULT" CACHE STRING "Compile-time limits of the build: SMALL, DEFAULT or LARGE")
+set_property(CACHE FWE_FOOTPRINT_PROFILE PROPERTY STRINGS SMALL DEFAULT LARGE)
+
+if(FWE_FOOTPRINT_PROFILE STREQUAL "SMALL")
+  add_compile_options("-DFWE_FOOTPRINT_PROFILE_SMALL")
+elseif(FWE_FOOTPRINT_PROFILE STREQUAL "LARGE")
+  add_compile_options("-DFWE_FOOTPRINT_PROFILE_LARGE")
+elseif(NOT FWE_FOOTPRINT_PROFILE STREQUAL "DEFAULT")
+  message(FATAL_ERROR "Unknown FWE_FOOTPRINT_PROFILE ${FWE_FOOTPRINT_PROFILE}, use SMALL, DEFAULT or LARGE")
+endif()
+message(STATUS "Footprint profile: ${FWE_FOOTPRINT_PROFILE}")
@@ -0,0 +1,33 @@
+#
+#  Generates static CAN decoders at build time, see StaticCANDecoder.h
+#
+#  Options used by this module:
+#
+#  FWE_STATIC_CAN_DECODERS             Decoder manifest in JSON (.json) or DBC file (.dbc) known at build time,
+#                                      empty to build without static decoders
+#  FWE_STATIC_CAN_DECODERS_SIGNAL_IDS  JSON object mapping the signal names of the DBC file to signal IDs
+
+set(FWE_STATIC_CAN_DECODERS "" CACHE FILEPATH "Decoder manifest or DBC file to generate static CAN decoders from")
+set(FWE_STATIC_CAN_DECODERS_SIGNAL_IDS "" CACHE FILEPATH "Signal IDs of the DBC signals of FWE_STATIC_CAN_DECODERS")
+
+if(FWE_STATIC_CAN_DECODERS)
+  find_package(PythonInterp 3 REQUIRED)
+  set(STATIC_CAN_DECODERS_DIR ${CMAKE_BINARY_DIR}/staticcandecoders)
+  set(STATIC_CAN_DECODERS_HEADER ${STATIC_CAN_DECODERS_DIR}/GeneratedStaticCANDecoders.h)
+  set(STATIC_CAN_DECODERS_GENERATOR
+    ${CMAKE_CURRENT_SOURCE_DIR}/tools/static-can-decoders/generate-static-can-decoders.py)
+  set(STATIC_CAN_DECODERS_ARGS ${FWE_STATIC_CAN_DECODERS} ${STATIC_CAN_DECODERS_HEADER})
+  set(STATIC_CAN_DECODERS_DEPENDS ${STATIC_CAN_DECODERS_GENERATOR} ${FWE_STATIC_CAN_DECODERS})
+  if(FWE_STATIC_CAN_DECODERS_SIGNAL_IDS)
+    list(APPEND STATIC_CAN_DECODERS_ARGS --signal-ids ${FWE_STATIC_CAN_DECODERS_SIGNAL_IDS})
+    list(APPEND STATIC_CAN_DECODERS_DEPENDS ${FWE_STATIC_CAN_DECODERS_SIGNAL_IDS})
+  endif()
+  file(MAKE_DIRECTORY ${STATIC_CAN_DECODERS_DIR})
+  add_custom_command(
+    OUTPUT ${STATIC_CAN_DECODERS_HEADER}
+    COMMAND ${PYTHON_EXECUTABLE} ${STATIC_CAN_DECODERS_GENERATOR} ${STATIC_CAN_DECODERS_ARGS}
+    DEPENDS ${STATIC_CAN_DECODERS_DEPENDS}
+    COMMENT "Generating static CAN decoders from ${FWE_STATIC_CAN_DECODERS}"
+  )
+  message(STATUS "Static CAN decoders: ${FWE_STATIC_CAN_DECODERS}")
+endif()
@@ -0,0 +1,146 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "CollectionInspectionAPITypes.h"
+#include "LoggingModule.h"
+#include "TimeTypes.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataManagement
+{
+using namespace Aws::IoTFleetWise::Platform::Linux;
+using namespace Aws::IoTFleetWise::DataInspection;
+
+/**
+ * @brief A codec with its compression level
+ */
+struct CompressionSetting
+{
+    CompressionCodecType codec{ CompressionCodecType::SNAPPY };
+    int level{ 0 }; // only used by Zstandard, 0 for its default level
+
+    bool
+    operator==( const CompressionSetting &other ) const
+    {
+        return ( codec == other.codec ) && ( level == other.level );
+    }
+
+    bool
+    operator!=( const CompressionSetting &other ) const
+    {
+        return !( *this == other );
+    }
+};
+
+/**
+ * @brief Bounds and thresholds of the AdaptiveCompressionController
+ */
+struct AdaptiveCompressionConfig
+{
+    CompressionSetting fastest{ CompressionCodecType::LZ4, 0 };
+    CompressionSetting strongest{ CompressionCodecType::ZSTD, 9 };
+    double maxCpuPercent{ 50.0 };       // above this CPU usage of the sender thread a faster setting is used
+    double targetBacklogSeconds{ 1.0 }; // a stronger setting is used if the backlog takes longer to upload
+    uint32_t intervalMs{ 1000 };        // time between two adjustments
+};
+
+/**
+ * @brief The measurements of one interval the setting is adjusted to
+ */
+struct CompressionLoad
+{
+    double cpuPercent{ 0.0 };           // CPU usage of the sender thread, 100 for one core
+    double uplinkBytesPerSecond{ 0.0 }; // bytes whose publish completed
+    uint64_t backlogBytes{ 0 };         // bytes handed over to the connection which are not published yet
+};
+
+/**
+ * @brief Picks the codec and level of the next payloads from the CPU usage of the sender thread and the throughput
+ *        and backlog of the uplink
+ *
+ * The settings the build supports between the configured fastest and strongest one form a ladder: LZ4, snappy and
+ * the Zstandard levels 1, 3, 6, 9, 15 and 19, plus the bounds themselves. Once per interval the controller moves one
+ * step: to a faster setting if the sender thread used more CPU than allowed, to a stronger one if the backlog takes
+ * longer than the target to upload at the measured throughput and there is CPU headroom, otherwise it stays. So a
+ * congested link is compressed as strongly as the CPU allows, and a CPU heavy burst falls back to the fastest codec.
+ * It starts in the middle of the ladder.
+ *
+ * The uplink is measured with the MQTT_PUBLISHED_BYTES and UPLOAD_BACKLOG_BYTES trace variables, so the controllers
+ * of several sender threads see the same link. A controller must only be used by one thread.
+ */
+class AdaptiveCompressionController
+{
+public:
+    // A stronger setting is only tried below this share of maxCpuPercent, so that the steps do not oscillate
+    static constexpr double STRONGER_CPU_HEADROOM = 0.75;
+
+    /**
+     * @param config bounds and thresholds, must be valid, see isValid()
+     */
+    explicit AdaptiveCompressionController( const AdaptiveCompressionConfig &config );
+
+    /**
+     * @brief Checks that the fastest bound is not stronger than the strongest one and the thresholds are positive
+     */
+    static bool isValid( const AdaptiveCompressionConfig &config );
+
+    /**
+     * @brief Returns the setting for the next payload. Measures the load of the calling thread and the uplink and
+     *        adjusts the setting once the interval passed.
+     */
+    CompressionSetting select();
+
+    /**
+     * @brief Moves at most one step on the ladder according to the load of the last interval
+     * @return the new setting
+     */
+    CompressionSetting update( const CompressionLoad &load );
+
+    CompressionSetting
+    getSetting() const
+    {
+        return mSettings[mIndex];
+    }
+
+    /**
+     * @brief The ladder of settings, the fastest first
+     */
+    const std::vector<CompressionSetting> &
+    getSettings() const
+    {
+        return mSettings;
+    }
+
+private:
+    AdaptiveCompressionConfig mConfig;
+    std::vector<CompressionSetting> mSettings;
+    size_t mIndex{ 0 };
+    bool mMeasuring{ false };
+    Timestamp mLastTimeMs{ 0 };
+    uint64_t mLastCpuTimeUs{ 0 };
+    uint64_t mLastPublishedBytes{ 0 };
+    LoggingModule mLogger;
+};
+
+} // namespace DataManagement
+} // namespace IoTFleetWise
+} // namespace Aws
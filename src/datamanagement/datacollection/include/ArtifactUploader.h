@@ -0,0 +1,173 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "ISender.h"
+#include "LoggingModule.h"
+#include "PayloadBufferPool.h"
+#include "Signal.h"
+#include "Thread.h"
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataManagement
+{
+using namespace Aws::IoTFleetWise::Platform::Linux;
+using namespace Aws::IoTFleetWise::OffboardConnectivity;
+
+/**
+ * @brief Uploads sensor artifacts, e.g. camera recordings, in fixed size chunks on its own thread
+ *
+ * The artifact is read from disk chunk by chunk, so its size does not matter for the memory used. Every chunk is
+ * sent as one message with a header identifying the artifact and the offset of the chunk, so the cloud can put the
+ * artifact together again. The chunks are handed to the sender without waiting for each other, so several of them
+ * are in flight at the same time, and the upload rate limits of the sender apply to them like to all other data.
+ *
+ * Next to the artifact a progress file keeps the offset of the next chunk. It is replaced atomically after every
+ * chunk, so when the connection drops, or the process restarts, the upload continues with the first chunk that was
+ * not sent instead of starting over. Uploads which could not be sent are retried after the retry interval. Once the
+ * last chunk is sent the artifact and its progress file are deleted.
+ *
+ * Chunk layout, integers little endian:
+ * | magic "FWAC" | version 1 (1 byte) | source ID (4 bytes) | artifact size (8 bytes) | chunk offset (8 bytes) |
+ * | name length (2 bytes) | file name of the artifact | chunk data |
+ */
+class ArtifactUploader
+{
+public:
+    static constexpr uint32_t DEFAULT_CHUNK_SIZE_BYTES = 64U * 1024U;
+    static constexpr uint32_t DEFAULT_RETRY_INTERVAL_MS = 5000U;
+    static constexpr uint8_t CHUNK_FORMAT_VERSION = 1U;
+    static constexpr size_t CHUNK_HEADER_FIXED_SIZE = 27U;
+    static const std::string PROGRESS_FILE_SUFFIX;
+
+    /**
+     * @param sender            sends the chunks, without persistency of its own
+     * @param chunkSizeBytes    artifact bytes per chunk, limited to what fits into one message of the sender
+     * @param retryIntervalMs   time until an upload which could not be sent is retried
+     */
+    ArtifactUploader( std::shared_ptr<ISender> sender,
+                      uint32_t chunkSizeBytes = DEFAULT_CHUNK_SIZE_BYTES,
+                      uint32_t retryIntervalMs = DEFAULT_RETRY_INTERVAL_MS );
+    ~ArtifactUploader();
+
+    ArtifactUploader( const ArtifactUploader & ) = delete;
+    ArtifactUploader &operator=( const ArtifactUploader & ) = delete;
+    ArtifactUploader( ArtifactUploader && ) = delete;
+    ArtifactUploader &operator=( ArtifactUploader && ) = delete;
+
+    /**
+     * @brief Starts the upload thread
+     * @return True if the thread is running
+     */
+    bool start();
+
+    /**
+     * @brief Stops the thread after the current chunk, the remaining uploads continue after the next start
+     * @return True if the thread stopped
+     */
+    bool stop();
+
+    bool isAlive();
+
+    /**
+     * @brief Queues an artifact for upload. The progress file is created right away, so the upload is resumed by
+     * resumeUploads() after a restart even if it did not start yet.
+     * @param path path of the artifact
+     * @param sourceID the source the artifact was collected from
+     * @return False if the artifact can not be read or the progress file not be written
+     */
+    bool submit( const std::string &path, uint32_t sourceID );
+
+    /**
+     * @brief Queues the artifacts in the directory which have a progress file, to resume the uploads interrupted by
+     * a restart. Progress files whose artifact is missing are deleted.
+     * @return the number of queued artifacts
+     */
+    size_t resumeUploads( const std::string &directory );
+
+    /**
+     * @return the number of artifacts waiting for upload, including the one being uploaded
+     */
+    size_t getPendingArtifactCount() const;
+
+    /**
+     * @return the artifact bytes sent since the start
+     */
+    uint64_t
+    getUploadedBytes() const
+    {
+        return mUploadedBytes.load( std::memory_order_relaxed );
+    }
+
+private:
+    struct Progress
+    {
+        uint32_t sourceID{ 0 };
+        uint64_t artifactSize{ 0 };
+        uint64_t nextOffset{ 0 };
+    };
+
+    enum class UploadResult
+    {
+        DONE,
+        RETRY,
+        FAILED
+    };
+
+    static void doWork( void *data );
+
+    static bool readProgress( const std::string &progressPath, Progress &progress );
+
+    static bool writeProgress( const std::string &progressPath, const Progress &progress );
+
+    /**
+     * @brief Sends the chunks of the artifact from its recorded progress on
+     * @return RETRY if a chunk could not be sent, e.g. without connection, FAILED if the artifact can not be read
+     */
+    UploadResult uploadArtifact( const std::string &path );
+
+    /**
+     * @brief Reads a chunk and sends it with its header
+     */
+    UploadResult sendChunk( int fd, const std::string &path, const Progress &progress, size_t chunkSize );
+
+    bool shouldStop() const;
+
+    std::shared_ptr<ISender> mSender;
+    size_t mChunkSizeBytes;
+    uint32_t mRetryIntervalMs;
+    PayloadBufferPool mPayloadBufferPool;
+    mutable std::mutex mPendingMutex;
+    std::deque<std::string> mPendingArtifacts;
+    std::atomic<uint64_t> mUploadedBytes{ 0 };
+    Thread mThread;
+    std::atomic<bool> mShouldStop{ false };
+    std::mutex mThreadMutex;
+    Platform::Linux::Signal mWait;
+    LoggingModule mLogger;
+};
+
+} // namespace DataManagement
+} // namespace IoTFleetWise
+} // namespace Aws
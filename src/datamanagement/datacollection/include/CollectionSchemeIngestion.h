@@ -16,6 +16,7 @@
 #include "CollectionInspectionAPITypes.h"
 #include "ICollectionScheme.h"
 #include "LoggingModule.h"
+#include <memory>
 #include <unordered_map>
 
 namespace Aws
@@ -47,6 +48,38 @@ public:
 
     bool build() override;
 
+    /**
+     * @brief Builds the collectionScheme and appends its expression nodes to the given arena
+     *
+     * The arena must have reserved capacity for at least getNumberOfExpressionNodes() more nodes, as the nodes
+     * point to each other and the arena is never reallocated.
+     *
+     * @param expressionNodeArena arena shared by all collectionSchemes of a list
+     * @return true if the collectionScheme is valid
+     */
+    bool build( const std::shared_ptr<ExpressionNode_t> &expressionNodeArena );
+
+    /**
+     * @brief Returns the maximum number of expression nodes the collectionScheme needs in the arena
+     *
+     * @param collectionScheme collectionScheme proto message
+     * @return number of nodes
+     */
+    static uint32_t getNumberOfExpressionNodes( const CollectionSchemesMsg::CollectionScheme &collectionScheme );
+
+    /**
+     * @brief Validates the collectionScheme but defers the build until buildIfDeferred is called
+     *
+     * Only the serialized proto message, the IDs and the start and expiry time are kept, so an idle collectionScheme
+     * that starts much later costs neither the build nor the memory of the parsed message. Until it is built it is
+     * not ready, but the IDs and times can be read.
+     *
+     * @return true if the collectionScheme is valid
+     */
+    bool deferBuild();
+
+    bool buildIfDeferred() override;
+
     bool copyData( std::shared_ptr<CollectionSchemesMsg::CollectionScheme> protoCollectionSchemeMessagePtr );
 
     const std::string &getCollectionSchemeID() const override;
@@ -75,6 +108,14 @@ public:
 
     bool isCompressionNeeded() const override;
 
+    DataInspection::CompressionCodecType getCompressionCodec() const override;
+
+    bool isRawCanLogNeeded() const override;
+
+    uint32_t getConditionEvaluationIntervalMs() const override;
+
+    uint32_t getConditionEvaluationBudgetUs() const override;
+
     uint32_t getPriority() const override;
 
     const struct ExpressionNode *getCondition() const override;
@@ -94,6 +135,24 @@ private:
      */
     bool mReady{ false };
 
+    /**
+     * @brief Serialized proto message of a collectionScheme whose build is deferred, empty otherwise
+     */
+    std::string mDeferredProtoData;
+
+    /**
+     * @brief Flag which is true from deferBuild until buildIfDeferred
+     */
+    bool mBuildDeferred{ false };
+
+    /**
+     * @brief IDs and times of a collectionScheme whose build is deferred
+     */
+    std::string mDeferredCollectionSchemeID;
+    std::string mDeferredDecoderManifestID;
+    uint64_t mDeferredStartTime{ 0 };
+    uint64_t mDeferredExpiryTime{ 0 };
+
     /**
      * @brief Vector of all the signals that need to be collected/monitored
      */
@@ -115,16 +174,27 @@ private:
     ExpressionNode *mExpressionNode{ nullptr };
 
     /**
-     * @brief Vector representing all of the ExpressionNode(s)
+     * @brief Arena holding the ExpressionNode(s), shared with the other collectionSchemes of the same list
      */
-    ExpressionNode_t mExpressionNodes;
+    std::shared_ptr<ExpressionNode_t> mExpressionNodes;
 
     /**
-     * @brief Function used to Flatten the Abstract Syntax Tree (AST)
+     * @brief Checks that the collectionScheme has its IDs and does not expire before it starts
      */
-    ExpressionNode *serializeNode( const CollectionSchemesMsg::ConditionNode &node,
-                                   uint32_t &nextIndex,
-                                   const int depth );
+    bool isValid();
+
+    /**
+     * @brief Function used to Flatten the Abstract Syntax Tree (AST). The children are appended to the arena
+     * before their parent, so that the nodes are laid out in evaluation order.
+     */
+    ExpressionNode *serializeNode( const CollectionSchemesMsg::ConditionNode &node, const int depth );
+
+    /**
+     * @brief Appends a node to the arena
+     *
+     * @return pointer to the node in the arena or nullptr if the reserved capacity is exhausted
+     */
+    ExpressionNode *appendNode( const ExpressionNode &node );
 
     /**
      * @brief Helper function that returns all nodes in the AST by doing a recursive traversal
@@ -134,7 +204,23 @@ private:
      *
      * @return Returns the number of nodes in the AST
      */
-    uint32_t getNumberOfNodes( const CollectionSchemesMsg::ConditionNode &node, const int depth );
+    static uint32_t getNumberOfNodes( const CollectionSchemesMsg::ConditionNode &node, const int depth );
+
+    /**
+     * @brief Sets the aggregation of a signal from its SignalInformation
+     *
+     * @return false if the signal has no fixed window or the histogram bounds or percentiles are invalid
+     */
+    bool buildSignalAggregation( const CollectionSchemesMsg::SignalInformation &signalInformation,
+                                 SignalCollectionInfo &signalInfo );
+
+    /**
+     * @brief Sets the decimation of a signal from its SignalInformation
+     *
+     * @return false if the signal is also aggregated or fewer than 2 samples are kept
+     */
+    bool buildSignalDecimation( const CollectionSchemesMsg::SignalInformation &signalInformation,
+                                SignalCollectionInfo &signalInfo );
 
     /**
      * @brief  Private Local Function used by the serializeNode Function to return the used Function Type
@@ -13,6 +13,7 @@
 
 #pragma once
 
+#include "ClockHandler.h"
 #include "CollectionSchemeIngestion.h"
 #include "ICollectionSchemeList.h"
 #include "LoggingModule.h"
@@ -46,6 +47,10 @@ public:
 
     bool isReady() const override;
 
+    /**
+     * @brief Parses the list and builds the collectionSchemes which already started. The build of the ones which
+     * start later is deferred until they are enabled, see CollectionSchemeIngestion::deferBuild.
+     */
     bool build() override;
 
     const std::vector<ICollectionSchemePtr> &getCollectionSchemes() const override;
@@ -58,6 +63,12 @@ public:
         return mProtoBinaryData;
     }
 
+    void
+    releaseData() override
+    {
+        std::vector<uint8_t>().swap( mProtoBinaryData );
+    }
+
 private:
     /**
      * @brief This vector will store the binary data copied from the IReceiver callback.
@@ -79,10 +90,7 @@ private:
      */
     const std::vector<ICollectionSchemePtr> EMPTY_COLLECTION_SCHEME_LIST{};
 
-    /**
-     * @brief Used internally to hold the collectionSchemes message from the protobuffer
-     */
-    CollectionSchemesMsg::CollectionSchemes mCollectionSchemeListMsg;
+    std::shared_ptr<const Clock> mClock = ClockHandler::getClock();
 
     /**
      * @brief Logging module used to output to logs
@@ -0,0 +1,128 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "CollectionInspectionAPITypes.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataManagement
+{
+using namespace Aws::IoTFleetWise::DataInspection;
+
+/**
+ * @brief Header in front of the payloads compressed with a codec other than snappy. Snappy payloads have no header
+ *        for compatibility with the existing cloud decoding. All fields are little endian.
+ *
+ * | Offset | Size | Content                                                 |
+ * |--------|------|---------------------------------------------------------|
+ * | 0      | 3    | Magic "FWC"                                             |
+ * | 3      | 1    | Codec ID, see CompressionCodecType                      |
+ * | 4      | 4    | ID of the Zstandard dictionary, 0 if none               |
+ * | 8      | 4    | Size of the uncompressed payload                        |
+ */
+struct CompressedPayloadHeader
+{
+    static constexpr size_t SIZE = 12;
+
+    CompressionCodecType codec{ CompressionCodecType::SNAPPY };
+    uint32_t dictionaryID{ 0 };
+    uint32_t uncompressedSize{ 0 };
+
+    /**
+     * @brief Writes the header to the first SIZE bytes of out
+     */
+    void write( uint8_t *out ) const;
+
+    /**
+     * @brief Reads the header from the beginning of a payload
+     *
+     * @return false if the payload is too short or does not start with the magic
+     */
+    bool read( const uint8_t *payload, size_t size );
+};
+
+/**
+ * @brief Compresses the vehicle data payloads with one codec
+ *
+ * A codec object keeps its compression context between payloads and is not thread safe.
+ */
+class ICompressionCodec
+{
+public:
+    virtual ~ICompressionCodec() = default;
+
+    virtual CompressionCodecType getType() const = 0;
+
+    /**
+     * @brief Compresses the input and replaces the content of out with the compressed payload including the header
+     *
+     * @param input data to compress
+     * @param size number of bytes of input
+     * @param out buffer that is resized to the compressed size, its capacity is reused
+     * @return false if compression failed, out is then unspecified
+     */
+    virtual bool compress( const uint8_t *input, size_t size, std::vector<uint8_t> &out ) = 0;
+
+    /**
+     * @brief Decompresses a payload written by compress
+     *
+     * @param input compressed payload including the header
+     * @param size number of bytes of input
+     * @param out buffer that is resized to the uncompressed size
+     * @return false if the payload is corrupted or was compressed with another codec or dictionary
+     */
+    virtual bool decompress( const uint8_t *input, size_t size, std::vector<uint8_t> &out ) = 0;
+};
+
+/**
+ * @brief Checks if the codec was enabled at build time, see the FWE_FEATURE_LZ4 and FWE_FEATURE_ZSTD options
+ */
+bool isCompressionCodecSupported( CompressionCodecType type );
+
+/**
+ * @brief Creates a codec
+ *
+ * @param type codec to create
+ * @param dictionary Zstandard dictionary, only used by the ZSTD codec. Kept alive by the codec.
+ * @param level compression level, only used by the ZSTD codec. 0 for the default level 3
+ * @return nullptr if the codec is not supported or the dictionary could not be loaded
+ */
+std::unique_ptr<ICompressionCodec> createCompressionCodec(
+    CompressionCodecType type,
+    std::shared_ptr<const std::string> dictionary = std::shared_ptr<const std::string>(),
+    int level = 0 );
+
+/**
+ * @brief Returns the lower case name of the codec as used in the configuration, for example "zstd"
+ */
+const char *getCompressionCodecName( CompressionCodecType type );
+
+/**
+ * @brief Finds the codec of a name returned by getCompressionCodecName
+ * @return False if there is no codec with the name
+ */
+bool getCompressionCodecType( const std::string &name, CompressionCodecType &type );
+
+} // namespace DataManagement
+} // namespace IoTFleetWise
+} // namespace Aws
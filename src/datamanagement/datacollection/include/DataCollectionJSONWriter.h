@@ -18,10 +18,10 @@
 #include "ClockHandler.h"
 #include "CollectionInspectionAPITypes.h"
 #include "GeohashInfo.h"
+#include "JSONStreamWriter.h"
 #include "LoggingModule.h"
 #include "OBDDataTypes.h"
 #include <boost/filesystem.hpp>
-#include <json/json.h>
 #include <string>
 
 namespace Aws
@@ -34,6 +34,9 @@ using namespace Aws::IoTFleetWise::DataInspection;
 
 /**
  * @brief A Json based writer of the collected data.
+ *
+ * The messages are streamed into one output buffer as they are appended. The buffer and the buffer of the
+ * compressed file contents are kept between events, so under steady load writing an event does not allocate.
  */
 class DataCollectionJSONWriter
 {
@@ -48,6 +51,7 @@ public:
 
     void append( const CollectedSignal &msg );
     void append( const CollectedCanRawFrame &msg );
+    void append( const SignalSummary &summary );
     void append( const GeohashInfo &geohashInfo );
 
     /**
@@ -78,9 +82,18 @@ private:
      */
     std::pair<boost::filesystem::path, bool> flushToFile( const std::string &fileBaseName );
 
-    Json::Value mEvent;
-    Json::Value mMessages{ Json::arrayValue };
-    Json::UInt64 mTriggerTime{ 0 };
+    /**
+     * @brief Writes the start of the document up to the opening of the messages array
+     */
+    void beginDocument();
+
+    JSONStreamWriter mWriter;
+    std::string mCompressed;
+    bool mHasEvent{ false };
+    uint32_t mCollectionEventID{ 0 };
+    unsigned mMessageCount{ 0 };
+    bool mDocumentClosed{ false };
+    uint64_t mTriggerTime{ 0 };
     std::string mPersistencyPath;
 
     /**
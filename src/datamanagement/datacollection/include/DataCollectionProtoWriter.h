@@ -17,10 +17,15 @@
 #include "CANDataTypes.h"
 #include "CANInterfaceIDTranslator.h"
 #include "CollectionInspectionAPITypes.h"
+#include "MemoryAccounting.h"
 #include "OBDDataTypes.h"
 #include "vehicle_data.pb.h"
 #include <cstdint>
+#include <google/protobuf/arena.h>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace Aws
 {
@@ -34,10 +39,32 @@ using namespace Aws::IoTFleetWise::DataInspection;
 /**
  * @brief Class that does the protobuf setup for the collected data
  *        and serializes the edge to cloud data
+ *
+ * The messages are built on an arena that is reset for every payload. The first block of the arena is owned by
+ * the writer and grows to the largest payload seen, so that in steady state appending does not allocate.
+ *
+ * With payload format version 1 the signals and raw CAN frames are grouped into columns when the payload is
+ * serialized, see payload_format_version in vehicle_data.proto.
+ *
+ * If the collectionScheme requested a raw CAN log, the raw CAN frames are packed into the raw_can_log block instead,
+ * independent of the payload format version.
+ *
+ * Samples of signals with an upload resolution are rounded to multiples of it. With payload format version 1 they
+ * are sent as integer multiples of the resolution.
  */
 class DataCollectionProtoWriter
 {
 public:
+    // Size of the first arena block before any payload was built
+    static constexpr size_t INITIAL_ARENA_BLOCK_SIZE = 4096;
+    // One message per sample
+    static constexpr uint32_t PAYLOAD_FORMAT_SAMPLES = 0;
+    // Samples grouped per signal and per CAN frame with delta encoded times and values
+    static constexpr uint32_t PAYLOAD_FORMAT_COLUMNS = 1;
+    // Upper bound of the bytes a column adds to the payload besides its samples: tag, length, ID and the tags and
+    // lengths of the packed fields
+    static constexpr size_t COLUMN_OVERHEAD_SIZE = 32;
+
     /**
      * @brief Constructor. Setup the DataCollectionProtoWriter.
      */
@@ -53,6 +80,14 @@ public:
     DataCollectionProtoWriter( DataCollectionProtoWriter && ) = delete;
     DataCollectionProtoWriter &operator=( DataCollectionProtoWriter && ) = delete;
 
+    /**
+     * @brief Sets the layout of the samples, applies from the next call of setupVehicleData
+     *
+     * @param version PAYLOAD_FORMAT_SAMPLES or PAYLOAD_FORMAT_COLUMNS
+     * @return false if the version is not supported, the layout is then unchanged
+     */
+    bool setPayloadFormatVersion( uint32_t version );
+
     /**
      * @brief Does the protobuf set up for the data collected by inspection engine
      *
@@ -77,6 +112,13 @@ public:
      */
     void append( const CollectedCanRawFrame &msg );
 
+    /**
+     * @brief Appends the summary of an aggregated signal over one window to the output protobuf
+     *
+     *  @param summary  the values selected by the aggregation of the signal
+     */
+    void append( const SignalSummary &summary );
+
     /**
      * @brief Appends the DTC codes to the output protobuf
      *
@@ -98,6 +140,24 @@ public:
      */
     void setupDTCInfo( const DTCInfo &msg );
 
+    /**
+     * @brief Marks the payload as one part of the payloads of its collection event, so that the cloud can reassemble
+     * them in any order. Has to be called again after every setupVehicleData.
+     *
+     * @param part index of the payload among the payloads of the event, starting at 0
+     * @param partCount number of payloads of the event, 0 if it is not known yet
+     */
+    void setPayloadPart( uint32_t part, uint32_t partCount );
+
+    /**
+     * @brief Sets the number of payloads of the event in a vehicle data message that was serialized without it, by
+     * appending the field to the serialized bytes. The message must not be compressed yet.
+     *
+     * @param serialized message serialized with a partCount of 0
+     * @param partCount number of payloads of the event
+     */
+    static void appendPayloadPartCount( std::vector<uint8_t> &serialized, uint32_t partCount );
+
     /**
      * @brief Gets the total number of collectionScheme messages sent to the cloud
      *
@@ -105,6 +165,20 @@ public:
      */
     unsigned getVehicleDataMsgCount() const;
 
+    /**
+     * @brief Gets a running estimate of the size of the serialized payload, kept up to date by every append
+     *
+     * The estimate is exact for payload format version 0. For version 1 it is an upper bound assuming the values
+     * are encoded as doubles.
+     *
+     * @return estimated size in bytes of the payload if it was serialized now
+     */
+    size_t
+    getEstimatedSize() const
+    {
+        return mEstimatedSize;
+    }
+
     /**
      * @brief Serializes the vehicle data to be sent to cloud
      *
@@ -112,7 +186,34 @@ public:
      * @return true if the data was serialized
      */
 
-    bool serializeVehicleData( std::string *out ) const;
+    bool serializeVehicleData( std::string *out );
+
+    /**
+     * @brief Serializes the vehicle data straight into the buffer, replacing its content
+     *
+     * @param out  buffer that is resized to the serialized size, its capacity is reused
+     * @return true if the data was serialized
+     */
+    bool serializeVehicleData( std::vector<uint8_t> &out );
+
+    /**
+     * @brief Bytes a serialized payload adds when it is appended to another one with appendAggregatedVehicleData
+     *
+     * @param payloadSize size of the serialized payload
+     * @return payload size plus the tag and length of the aggregated_vehicle_data field
+     */
+    static size_t getAggregatedVehicleDataSize( size_t payloadSize );
+
+    /**
+     * @brief Appends a serialized payload to another one as an aggregated_vehicle_data entry
+     *
+     * A serialized message is extended by appending fields to it, so the aggregated payloads are neither parsed nor
+     * serialized again.
+     *
+     * @param aggregate serialized payload of the first event, extended in place
+     * @param payload   serialized payload of a further event
+     */
+    static void appendAggregatedVehicleData( std::vector<uint8_t> &aggregate, const std::vector<uint8_t> &payload );
 
     /**
      * @brief This function translates the IEEE 754 double format to the quotient and
@@ -125,11 +226,87 @@ public:
      */
     static void convertToPeculiarFloat( double physicalValue, uint32_t &quotient, uint32_t &divisor );
 
+    /**
+     * @brief Size of the arena block owned by the writer, the high-water mark of the arena so far
+     */
+    size_t
+    getArenaBlockSize() const
+    {
+        return mArenaBlock.size();
+    }
+
 private:
+    struct SignalColumnData
+    {
+        uint32_t mSignalID{ 0 };
+        double mResolution{ 0.0 }; // if greater than 0, mValues are the rounded multiples of it
+        std::vector<int64_t> mRelativeTimesMs;
+        std::vector<uint32_t> mTimeFractionsUs;
+        std::vector<double> mValues;
+    };
+
+    struct CanFrameColumnData
+    {
+        CANRawFrameID mFrameID{ 0 };
+        CANChannelNumericID mChannelID{ 0 };
+        std::vector<int64_t> mRelativeTimesMs;
+        std::vector<uint32_t> mTimeFractionsUs;
+        std::vector<uint32_t> mSizes;
+        std::string mBytes;
+    };
+
+    // Frees the previous payload and creates an empty message on the arena
+    void resetArena();
+
+    // Resolution the samples of the signal are rounded to, 0 if they are sent unchanged
+    double getUploadResolution( SignalID signalID ) const;
+
+    // Adds the size of a sub-message of the payload including its tag and length to the estimate
+    void addMessageSize( size_t size );
+
+    // Bytes a sample adds to the times of a column, the previous time is the last one of the column if any
+    static size_t getTimeSize( const std::vector<int64_t> &relativeTimesMs, int64_t relativeTimeMs, uint32_t fraction );
+
+    // Writes the collected columns to the message
+    void writeColumns();
+
+    // Writes the raw CAN log to the message if any frame was packed
+    void writeRawCanLog();
+
+    // Appends a varint to the packed frames of the raw CAN log
+    void appendRawCanLogVarint( uint64_t value );
+
+    static void writeSignalColumn( const SignalColumnData &column, VehicleDataMsg::SignalColumn &out );
+
+    // Writes the deltas of the times and the fractions if any is not 0
+    template <typename Column>
+    static void writeTimes( const std::vector<int64_t> &relativeTimesMs,
+                            const std::vector<uint32_t> &timeFractionsUs,
+                            Column &out );
+
     Timestamp mTriggerTime;
     unsigned mVehicleDataMsgCount{}; // tracks the number of messages being sent in the edge to cloud payload
-    VehicleDataMsg::VehicleData mVehicleData{};
+    size_t mEstimatedSize{ 0 };
+    std::vector<char, Platform::Linux::TrackedAllocator<char, Platform::Linux::MemorySubsystem::COLLECTION>>
+        mArenaBlock; // must outlive mArena
+    std::unique_ptr<google::protobuf::Arena> mArena;
+    VehicleDataMsg::VehicleData *mVehicleData{ nullptr }; // owned by mArena
     CANInterfaceIDTranslator mIDTranslator;
+    uint32_t mPayloadFormatVersion{ PAYLOAD_FORMAT_SAMPLES };
+    uint32_t mNextPayloadFormatVersion{ PAYLOAD_FORMAT_SAMPLES };
+    std::shared_ptr<const SignalUploadResolutions> mUploadResolutions;
+    // The column objects are kept between payloads to reuse their memory, only the first m*ColumnCount are used
+    std::vector<SignalColumnData> mSignalColumns;
+    size_t mSignalColumnCount{ 0 };
+    std::unordered_map<uint32_t, size_t> mSignalColumnIndices;
+    std::vector<CanFrameColumnData> mCanFrameColumns;
+    size_t mCanFrameColumnCount{ 0 };
+    std::unordered_map<uint64_t, size_t> mCanFrameColumnIndices; // key is channel ID and frame ID
+    bool mRawCanLog{ false };
+    std::string mRawCanLogFrames;
+    int64_t mRawCanLogPreviousTimeUs{ 0 };
+    std::vector<CANChannelNumericID> mRawCanLogChannels; // the index of a channel is its interface index in the log
+    std::unordered_map<CANChannelNumericID, uint32_t> mRawCanLogChannelIndices;
 };
 } // namespace DataManagement
 } // namespace IoTFleetWise
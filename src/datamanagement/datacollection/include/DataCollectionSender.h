@@ -14,13 +14,18 @@
 #pragma once
 
 // Includes
+#include "FastClock.h"
+#include "AdaptiveCompressionController.h"
 #include "CollectionInspectionAPITypes.h"
+#include "CompressionCodec.h"
 #include "DataCollectionJSONWriter.h"
 #include "DataCollectionProtoWriter.h"
 #include "ISender.h"
 #include "LoggingModule.h"
+#include <atomic>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace Aws
@@ -43,16 +48,51 @@ enum class SendDestination
     MQTT
 };
 
+/**
+ * @brief Aggregation window for the payloads of the collection schemes up to a priority number
+ */
+struct PayloadAggregationClass
+{
+    uint32_t maxPriority{ 0 }; // applies to the collection schemes with a priority number up to this one
+    size_t maxBytes{ 0 };      // an aggregate is sent once it reaches this size before compression
+    uint32_t maxDelayMs{ 0 };  // an aggregate is sent at the latest this long after its first payload was added
+};
+
 /**
  * @brief Serializes collected data and sends it to the cloud.
  *        Optionally supports debug JSON output of collected data.
  *        The maxMessageCount option limits the number of messages
  *        (or signals) appended to the protobuf message before the
  *        protobuf is serialized and sent to the cloud.
+ *        Independently of the message count, a payload is sent as soon as its
+ *        estimated size reaches the target fill ratio of the max send size of
+ *        the sender. For compressed collection schemes the size is scaled by
+ *        the compression ratio observed on the previous payloads.
+ *        The codec is selected per collection scheme. Codecs not enabled at
+ *        build time fall back to snappy. With adaptive compression the codec
+ *        and level are instead picked before every payload according to the
+ *        CPU load and the uplink, see setAdaptiveCompression.
+ *        Optionally small payloads of different triggers are aggregated into
+ *        one publish, see setAggregationClasses.
+ *        While the sender is not connected, the payloads of a trigger whose
+ *        collection scheme persists its data are not published but handed
+ *        over to ISender::persistBuffers together. Otherwise the payloads
+ *        of a trigger with more than one payload are handed over to
+ *        ISender::sendBatch together.
+ *        The payloads of a trigger with more than one payload are numbered,
+ *        so that the cloud can reassemble them also if some of them were
+ *        published and the others persisted and sent after a reconnect.
+ *        The serialized and compressed bytes are accounted per collection
+ *        scheme in the UplinkAccounting, whose account ID is passed on to the
+ *        sender with the CollectionSchemeParams.
  */
 class DataCollectionSender
 {
 public:
+    static constexpr double DEFAULT_TARGET_FILL_RATIO = 0.8;
+    // Weight of the last payload in the smoothed compression ratio
+    static constexpr double COMPRESSION_RATIO_SMOOTHING = 0.5;
+
     /**
      * @brief Constructor. Setup the DataCollectionSender.
      *
@@ -77,11 +117,79 @@ public:
     void send( const TriggeredCollectionSchemeDataPtr triggeredCollectionSchemeDataPtr );
 
     /**
-     * @brief Send the serialized data to the cloud
+     * @brief Sets the layout of the samples in the payloads, see DataCollectionProtoWriter::setPayloadFormatVersion
+     *
+     * @param version payload format version
+     * @return false if the version is not supported
+     */
+    bool
+    setPayloadFormatVersion( uint32_t version )
+    {
+        return mProtoWriter.setPayloadFormatVersion( version );
+    }
+
+    /**
+     * @brief Sets the fraction of the max send size a payload is filled to before it is sent
+     *
+     * As the payload is sent once its estimated size reaches the target, a ratio below 1 leaves room for the last
+     * message appended and for an underestimated compression ratio.
+     *
+     * @param ratio fill ratio greater than 0 and at most 1
+     * @return false if the ratio is out of range, the ratio is then unchanged
+     */
+    bool setTargetFillRatio( double ratio );
+
+    /**
+     * @brief Changes the maximum number of messages of a payload, also while another thread sends
+     * @param maxMessageCount maximum number of messages, 0 for no limit
+     */
+    void setMaxMessageCount( unsigned maxMessageCount );
+
+    /**
+     * @brief Sets the priority classes whose small payloads are aggregated
+     *
+     * The last payload of a trigger is not sent right away if it is smaller than maxBytes of the first class with a
+     * maxPriority at or above the priority of the collection scheme. Instead it is appended to an aggregate of that
+     * class with the same persistency and compression settings, see aggregated_vehicle_data in vehicle_data.proto.
+     * The aggregate is compressed and sent once it reaches maxBytes or by flushAggregates after maxDelayMs.
+     * Collection schemes above the maxPriority of all classes are not aggregated.
+     *
+     * @param classes the priority classes, in any order
+     * @return false if a class has a maxBytes or maxDelayMs of 0, the classes are then unchanged
+     */
+    bool setAggregationClasses( std::vector<PayloadAggregationClass> classes );
+
+    /**
+     * @brief Picks the codec and level of the payloads of compressed collection schemes with an
+     *        AdaptiveCompressionController instead of using the codec of the collection scheme
      *
+     * The Zstandard dictionary of a collection scheme is still used if the controller picks Zstandard. Must be
+     * called before data is sent.
+     *
+     * @param config bounds and thresholds of the controller
+     * @return false if the config is not valid, see AdaptiveCompressionController::isValid
+     */
+    bool setAdaptiveCompression( const AdaptiveCompressionConfig &config );
+
+    /**
+     * @brief Sends the aggregates whose max delay expired
+     *
+     * Must be called from the thread calling send(), at the latest after the returned time.
+     *
+     * @param all true to send all aggregates regardless of their delay, for example before shutting down
+     * @return milliseconds until the next aggregate has to be sent, 0 if no aggregate is open
+     */
+    uint32_t flushAggregates( bool all = false );
+
+    /**
+     * @brief Send the serialized data to the cloud, compressing it first if the collection scheme requests it
+     *
+     * The buffer is handed over to the sender without copying it.
+     *
+     * @param payload serialized vehicle data from the payload buffer pool
      * @return SUCCESS if transmit was successful, else return an errorcode
      */
-    ConnectivityError transmit();
+    ConnectivityError transmit( PayloadBufferPtr payload );
 
     /**
      * @brief Send the serialized data to the cloud
@@ -91,24 +199,80 @@ public:
      */
     ConnectivityError transmit( const std::string &payload );
 
+    /**
+     * @brief Send a payload retrieved from persistency to the cloud as it is
+     *
+     * The buffer is handed over to the sender without copying it.
+     *
+     * @param payload payload proto to be transmitted, already compressed if the collection scheme requested it
+     * @return SUCCESS if transmit was successful, else return an errorcode
+     */
+    ConnectivityError transmitPersisted( PayloadBufferPtr payload );
+
 private:
     LoggingModule mLogger;
     uint32_t mCollectionEventID; // A unique ID that FWE generates each time a collectionScheme condition is triggered.
     std::shared_ptr<ISender> mSender;
     bool mJsonOutputEnabled{ false };
     SendDestination mSendDestination{ SendDestination::MQTT };
-    unsigned mTransmitThreshold; // max number of messages that can be sent to cloud at one time
+    std::atomic<unsigned> mTransmitThreshold; // max number of messages that can be sent to cloud at one time
+    double mTargetFillRatio{ DEFAULT_TARGET_FILL_RATIO };
+    double mCompressionRatio{ 1.0 }; // smoothed ratio of compressed to uncompressed payload size with mCodec
+    std::shared_ptr<ICompressionCodec> mCodec; // shared with the aggregates compressed with it
+    CompressionCodecType mRequestedCodec{ CompressionCodecType::SNAPPY }; // mCodec is snappy if not supported
+    std::shared_ptr<const std::string> mCodecDictionary;                  // dictionary mCodec was created with
+    int mCodecLevel{ 0 };                                                 // level mCodec was created with
+    // Zstandard dictionary of the current collection scheme, used if the adaptive compression picks Zstandard
+    std::shared_ptr<const std::string> mSchemeDictionary;
+    std::unique_ptr<AdaptiveCompressionController> mAdaptiveCompression;
     std::string mPersistencyPath;
     DataCollectionProtoWriter mProtoWriter;
     DataCollectionJSONWriter mJsonWriter;
-    std::string mProtoOutput;
+    // The buffers the payloads are serialized and compressed to, they come back once the sender released them
+    PayloadBufferPool mPayloadBufferPool;
     CollectionSchemeParams mCollectionSchemeParams;
 
+    struct PayloadAggregate
+    {
+        size_t mClassIndex{ 0 };
+        CollectionSchemeParams mCollectionSchemeParams;
+        std::shared_ptr<ICompressionCodec> mCodec; // nullptr if the aggregate is not compressed
+        PayloadBufferPtr mPayload;
+        Timestamp mDeadline{ 0 };
+        // Serialized bytes per UplinkAccounting account, the aggregate is accounted to the one with the most bytes
+        std::vector<std::pair<uint32_t, size_t>> mAccountBytes;
+    };
+    std::vector<PayloadAggregationClass> mAggregationClasses; // sorted by maxPriority
+    std::vector<PayloadAggregate> mAggregates;
+    // Set while the payloads of a trigger are collected in mOfflineBatch because the sender is not connected
+    bool mPersistOffline{ false };
+    std::vector<PayloadBufferPtr> mOfflineBatch;
+    // Compressed payloads of a trigger with more than one payload, sent with one batch at the end of send()
+    std::vector<SendBatchItem> mLiveBatch;
+    // Full payloads of the current trigger, serialized but not compressed until the number of parts is known at the
+    // end of send(), see VehicleData.payload_part_count
+    std::vector<PayloadBufferPtr> mPayloadParts;
+
     /**
      * @brief Set up collectionSchemeParams struct
      */
     void setCollectionSchemeParameters( const TriggeredCollectionSchemeDataPtr &triggeredCollectionSchemeDataPtr );
 
+    /**
+     * @brief Makes mCodec the codec of the collection scheme, or the one the adaptive compression picks
+     */
+    void selectCodec( const PassThroughMetaData &metaData );
+
+    /**
+     * @brief Lets the adaptive compression pick the codec of the next payload, if enabled
+     */
+    void adaptCodec();
+
+    /**
+     * @brief Makes mCodec the given codec, creating it if the codec, its dictionary or its level changed
+     */
+    void useCodec( CompressionCodecType type, std::shared_ptr<const std::string> dictionary, int level );
+
     /**
      * @brief Get the collection event ID for the data to be serialized
      *
@@ -119,8 +283,70 @@ private:
 
     /**
      * @brief Serialize and send the protobuf data to the cloud
+     *
+     * @param lastPayload true for the last payload of the trigger, which is added to an aggregate if it is small
+     * enough. The other payloads are kept in mPayloadParts until the last one is serialized.
+     */
+    void serializeAndTransmit( bool lastPayload = false );
+
+    /**
+     * @brief Sets the number of parts in the kept payloads of the trigger and queues them compressed for the batch of
+     * the trigger
+     *
+     * @param partCount number of payloads of the trigger, including the ones that are not kept
+     */
+    void queuePayloadParts( uint32_t partCount );
+
+    /**
+     * @brief Compresses the payload with the codec if the parameters request it and sends it
+     */
+    ConnectivityError transmit( PayloadBufferPtr payload,
+                                const CollectionSchemeParams &collectionSchemeParams,
+                                const std::shared_ptr<ICompressionCodec> &codec );
+
+    /**
+     * @brief Compresses the payload with the codec if the parameters request it, replacing the payload
+     *
+     * @return false if the compression failed
+     */
+    bool compressPayload( PayloadBufferPtr &payload,
+                          const CollectionSchemeParams &collectionSchemeParams,
+                          const std::shared_ptr<ICompressionCodec> &codec );
+
+    /**
+     * @brief Hands the payloads collected while offline over to the sender to be persisted with one write
+     */
+    void persistOfflineBatch();
+
+    /**
+     * @brief Hands the payloads of a trigger with more than one payload over to the sender as one batch
+     */
+    void sendLiveBatch();
+
+    /**
+     * @brief Adds the payload to an aggregate of its priority class, sending the aggregate if it is full
+     *
+     * @return false if the payload is not aggregated and has to be sent on its own
+     */
+    bool aggregatePayload( PayloadBufferPtr &payload );
+
+    void transmitAggregate( PayloadAggregate &aggregate );
+
+    /**
+     * @brief Size in bytes a payload is filled to before compression, according to the max send size of the sender
+     */
+    double getTargetPayloadSize() const;
+
+    /**
+     * @brief Checks whether the payload reached the max message count or the target size
+     */
+    bool isPayloadFull() const;
+
+    /**
+     * @brief Appends a signal to the outputs and transmits the payload when it is full
      */
-    void serializeAndTransmit();
+    void appendSignal( const CollectedSignal &signal,
+                       const TriggeredCollectionSchemeDataPtr &triggeredCollectionSchemeDataPtr );
 };
 
 } // namespace DataManagement
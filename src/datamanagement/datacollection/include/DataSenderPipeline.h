@@ -0,0 +1,164 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "BoundedQueue.h"
+#include "CollectionInspectionAPITypes.h"
+#include "DataCollectionSender.h"
+#include "ISender.h"
+#include "LoggingModule.h"
+#include "PrioritySendQueue.h"
+#include "Thread.h"
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataManagement
+{
+using namespace Aws::IoTFleetWise::Platform::Linux;
+using namespace Aws::IoTFleetWise::DataInspection;
+using namespace Aws::IoTFleetWise::OffboardConnectivity;
+
+/**
+ * @brief Serializes, compresses and publishes the collected data on its own threads
+ *
+ * The triggered data is handed over with submit() and flows through two stages connected by bounded queues:
+ * 1- A pool of worker threads, each serializing and compressing with its own DataCollectionSender. All payloads of
+ *    one trigger are built by one worker, so they are sent in order. Serialization and compression of a payload stay
+ *    on the same worker because the chunking of the next payload depends on the compression ratio of the previous.
+ * 2- One publish thread handing the payloads over to the sender. The payloads are queued per priority level and
+ *    the most important level is sent first, see PrioritySendQueue.
+ * When the stages can not keep up the queues fill up and submit() blocks, which pushes back on the caller instead of
+ * buffering an unbounded amount of payloads. Aggregates of small payloads are sent by the worker that built them
+ * once their delay expired. On stop the queued data and the open aggregates are still sent, so that the sender can
+ * persist them if there is no connection.
+ */
+class DataSenderPipeline
+{
+public:
+    static constexpr size_t DEFAULT_QUEUE_SIZE = 16;
+
+    /**
+     * @brief Creates the DataCollectionSender of a worker, which must send its payloads to the given sender
+     */
+    using SenderFactory = std::function<std::unique_ptr<DataCollectionSender>( std::shared_ptr<ISender> sender )>;
+
+    /**
+     * @param sender          sender the payloads are published to
+     * @param workerCount     number of threads serializing and compressing, at least 1
+     * @param queueSize       capacity of the queue in front of each stage
+     * @param senderFactory   creates the DataCollectionSender of each worker
+     * @param priorityLevels  levels of the publish queue with their in-flight limits, empty for a FIFO queue
+     */
+    DataSenderPipeline( std::shared_ptr<ISender> sender,
+                        uint32_t workerCount,
+                        size_t queueSize,
+                        const SenderFactory &senderFactory,
+                        std::vector<SendPriorityLevel> priorityLevels = std::vector<SendPriorityLevel>() );
+    ~DataSenderPipeline();
+
+    DataSenderPipeline( const DataSenderPipeline & ) = delete;
+    DataSenderPipeline &operator=( const DataSenderPipeline & ) = delete;
+    DataSenderPipeline( DataSenderPipeline && ) = delete;
+    DataSenderPipeline &operator=( DataSenderPipeline && ) = delete;
+
+    /**
+     * @brief Starts the worker and publish threads
+     * @return True if all threads are running
+     */
+    bool start();
+
+    /**
+     * @brief Sends the queued data and stops the threads
+     * @return True if all threads stopped
+     */
+    bool stop();
+
+    bool isAlive();
+
+    /**
+     * @brief Queues the triggered data for serialization, waiting while the queue is full
+     * @return False if the pipeline is stopped, the data is then not sent
+     */
+    bool submit( TriggeredCollectionSchemeDataPtr triggeredCollectionSchemeDataPtr );
+
+    /**
+     * @brief Changes the maximum number of messages of a payload of all workers while they run
+     */
+    void setMaxMessageCount( unsigned maxMessageCount );
+
+    size_t
+    getWorkerCount() const
+    {
+        return mWorkers.size();
+    }
+
+private:
+    /**
+     * @brief Sender of the workers, queues the payloads for the publish thread
+     */
+    class PublishQueue : public ISender
+    {
+    public:
+        PublishQueue( std::shared_ptr<ISender> sender,
+                      std::vector<SendPriorityLevel> priorityLevels,
+                      size_t queueSize );
+
+        bool isAlive() override;
+        size_t getMaxSendSize() const override;
+        ConnectivityError send( const std::uint8_t *buf,
+                                size_t size,
+                                struct CollectionSchemeParams collectionSchemeParams = CollectionSchemeParams() )
+            override;
+        ConnectivityError sendBuffer( PayloadBufferPtr buffer,
+                                      struct CollectionSchemeParams collectionSchemeParams = CollectionSchemeParams() )
+            override;
+        // Not queued, the workers store the payloads in parallel to the publish thread
+        ConnectivityError persistBuffers(
+            const std::vector<PayloadBufferPtr> &buffers,
+            struct CollectionSchemeParams collectionSchemeParams = CollectionSchemeParams() ) override;
+
+        std::shared_ptr<ISender> mSender;
+        PrioritySendQueue mQueue;
+        // Only for payloads passed to send(), the workers use sendBuffer()
+        PayloadBufferPool mPayloadBufferPool;
+    };
+
+    struct Worker
+    {
+        DataSenderPipeline *mPipeline{ nullptr };
+        std::unique_ptr<DataCollectionSender> mDataCollectionSender;
+        Thread mThread;
+    };
+
+    static void doWork( void *data );
+    static void doPublish( void *data );
+
+    std::shared_ptr<PublishQueue> mPublishQueue;
+    BoundedQueue<TriggeredCollectionSchemeDataPtr> mInputQueue;
+    std::vector<std::unique_ptr<Worker>> mWorkers;
+    Thread mPublishThread;
+    std::mutex mThreadMutex;
+    LoggingModule mLogger;
+};
+
+} // namespace DataManagement
+} // namespace IoTFleetWise
+} // namespace Aws
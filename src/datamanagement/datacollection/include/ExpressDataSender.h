@@ -0,0 +1,93 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "CollectionInspectionAPITypes.h"
+#include "DataCollectionSender.h"
+#include "LoggingModule.h"
+#include "Thread.h"
+#include <cstddef>
+#include <memory>
+#include <mutex>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataManagement
+{
+using namespace Aws::IoTFleetWise::Platform::Linux;
+using namespace Aws::IoTFleetWise::DataInspection;
+
+/**
+ * @brief Serializes and publishes the data of the express collection schemes on its own thread
+ *
+ * The inspection threads push the express data into the queue of this sender instead of the output queue of the
+ * normal data, so it never waits behind the serialization, compression, aggregation or priority queues of the other
+ * collection schemes. The DataCollectionSender passed in should neither aggregate nor adapt its compression, so that
+ * every trigger is published as soon as it is serialized. The sender of the payloads reserves SDK memory for them,
+ * see AwsIotChannel::setExpressMemoryReservation.
+ */
+class ExpressDataSender
+{
+public:
+    /**
+     * @param dataCollectionSender  serializes and sends the express data
+     * @param queueSize             capacity of the queue, data is sent the normal way while it is full
+     */
+    ExpressDataSender( std::unique_ptr<DataCollectionSender> dataCollectionSender, size_t queueSize );
+    ~ExpressDataSender();
+
+    ExpressDataSender( const ExpressDataSender & ) = delete;
+    ExpressDataSender &operator=( const ExpressDataSender & ) = delete;
+    ExpressDataSender( ExpressDataSender && ) = delete;
+    ExpressDataSender &operator=( ExpressDataSender && ) = delete;
+
+    /**
+     * @brief Starts the sender thread
+     * @return True if the thread is running
+     */
+    bool start();
+
+    /**
+     * @brief Sends the queued data and stops the thread
+     * @return True if the thread stopped
+     */
+    bool stop();
+
+    bool isAlive();
+
+    /**
+     * @brief The queue the inspection threads push the express data into, see CollectionInspectionRouter
+     */
+    std::shared_ptr<ExpressCollectedData>
+    getQueue() const
+    {
+        return mQueue;
+    }
+
+private:
+    static void doWork( void *data );
+
+    std::shared_ptr<ExpressCollectedData> mQueue;
+    std::unique_ptr<DataCollectionSender> mDataCollectionSender;
+    Thread mThread;
+    std::mutex mThreadMutex;
+    LoggingModule mLogger;
+};
+
+} // namespace DataManagement
+} // namespace IoTFleetWise
+} // namespace Aws
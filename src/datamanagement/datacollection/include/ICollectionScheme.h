@@ -14,8 +14,10 @@
 #pragma once
 
 #include "CollectionInspectionAPITypes.h"
+#include "GeofenceIndex.h"
 #include "SignalTypes.h"
 #include "collection_schemes.pb.h"
+#include "datatypes/ImageCaptureOptions.h"
 #include <climits>
 #include <cstdint>
 #include <memory>
@@ -58,6 +60,8 @@ struct ImageCollectionInfo
                                     // condition is met and thus can be used to create
                                     // a time interval before and after a certain condition is
                                     // met in the system.
+    VehicleNetwork::ImageCaptureOptions captureOptions; // Selection and re-encoding of the frames before they are
+                                                        // persisted
 };
 
 struct SignalCollectionInfo
@@ -90,6 +94,30 @@ struct SignalCollectionInfo
      * condition logic with its associated fixed_window_period_ms. Default is false.
      */
     bool isConditionOnlySignal{ false };
+
+    /**
+     * @brief When true, the older samples of the buffer can be kept in a file on flash instead of memory,
+     * see deep_history of the collection scheme. Default is false.
+     */
+    bool deepHistory{ false };
+
+    /**
+     * @brief If set, summaries of the samples per fixed window of fixedWindowPeriod are collected instead of the
+     * samples, see aggregation of the collection scheme
+     */
+    std::shared_ptr<const DataInspection::SignalAggregationInfo> aggregation;
+
+    /**
+     * @brief If set, the collected samples are decimated before they are sent, see decimation of the collection
+     * scheme
+     */
+    std::shared_ptr<const DataInspection::SignalDecimationInfo> decimation;
+
+    /**
+     * @brief If greater than 0, the collected samples are rounded to multiples of this resolution before they are
+     * sent, see upload_resolution of the collection scheme
+     */
+    double uploadResolution{ 0.0 };
 };
 
 struct CanFrameCollectionInfo
@@ -118,14 +146,21 @@ struct CanFrameCollectionInfo
      * as they arrive.
      */
     uint32_t minimumSampleIntervalMs{ 0 };
+
+    /**
+     * @brief True if the frame is only captured for RAWFRAMEFIELD nodes of the condition and not sent to the cloud
+     */
+    bool isConditionOnlyFrame{ false };
 };
 
 enum class ExpressionNodeType
 {
     FLOAT = 0,
-    SIGNAL,          // Node_Signal_ID
-    WINDOWFUNCTION,  // NodeFunction
-    GEOHASHFUNCTION, // GEOHASH
+    SIGNAL,           // Node_Signal_ID
+    WINDOWFUNCTION,   // NodeFunction
+    GEOHASHFUNCTION,  // GEOHASH
+    GEOFENCEFUNCTION, // GEOFENCE
+    RAWFRAMEFIELD,    // NodeRawFrameField
     BOOLEAN,
     OPERATOR_SMALLER, // NodeOperator
     OPERATOR_BIGGER,
@@ -149,6 +184,12 @@ enum class WindowFunction
     PREV_LAST_FIXED_WINDOW_MIN,
     LAST_FIXED_WINDOW_MAX,
     PREV_LAST_FIXED_WINDOW_MAX,
+    SLIDING_WINDOW_AVG,
+    SLIDING_WINDOW_MIN,
+    SLIDING_WINDOW_MAX,
+    SLIDING_WINDOW_COUNT,
+    SLIDING_WINDOW_STDDEV,
+    SLIDING_WINDOW_RATE_OF_CHANGE,
     NONE
 };
 
@@ -167,9 +208,39 @@ struct GeohashFunction
     GPSUnitType gpsUnitType{ GPSUnitType::DECIMAL_DEGREE };
 };
 
+/**
+ * @brief Evaluates to true while the position is inside any of the geofences
+ */
+struct GeofenceFunction
+{
+    SignalID latitudeSignalID{ 0 };
+    SignalID longitudeSignalID{ 0 };
+    GeohashFunction::GPSUnitType gpsUnitType{ GeohashFunction::GPSUnitType::DECIMAL_DEGREE };
+    /**
+     * @brief Built spatial index over all fences of the node, shared by all copies of the node
+     */
+    std::shared_ptr<const DataInspection::GeofenceIndex> geofences;
+};
+
+/**
+ * @brief Evaluates to the raw value of a bit field of the latest captured CAN frame, without decoding the frame
+ */
+struct RawFrameField
+{
+    CANInterfaceID interfaceID;
+    CANChannelNumericID channelID{ INVALID_CAN_SOURCE_NUMERIC_ID }; /**< resolved from interfaceID on extraction */
+    CANRawFrameID frameID{ 0 };
+    uint16_t startBit{ 0 }; /**< same bit numbering as the signals of the Decoder Manifest */
+    uint16_t length{ 0 };
+    bool isBigEndian{ false };
+    bool isSigned{ false };
+};
+
 struct ExpressionFunction
 {
     GeohashFunction geohashFunction;
+    GeofenceFunction geofenceFunction;
+    RawFrameField rawFrameField;
     WindowFunction windowFunction{ WindowFunction::NONE };
 };
 
@@ -279,6 +350,12 @@ public:
      * */
     virtual bool build() = 0;
 
+    /**
+     * @brief Builds the internal structures if the build was deferred until the collectionScheme is enabled
+     * @return true if the collectionScheme is built, false if the deferred build failed
+     */
+    virtual bool buildIfDeferred() = 0;
+
     /**
      * @brief Get the unique collectionScheme ID in the form of an Amazon Resource Name
      *
@@ -363,6 +440,30 @@ public:
      */
     virtual bool isCompressionNeeded() const = 0;
 
+    /**
+     * @brief Codec to compress the data with if compression is needed
+     */
+    virtual DataInspection::CompressionCodecType getCompressionCodec() const = 0;
+
+    /**
+     * @brief Are the raw CAN frames sent packed into one block instead of one message per frame
+     */
+    virtual bool isRawCanLogNeeded() const = 0;
+
+    /**
+     * @brief Minimum time between two evaluations of the collectionScheme condition
+     *
+     * @return interval in milliseconds, 0 if the condition is evaluated with every evaluation of the inspection
+     */
+    virtual uint32_t getConditionEvaluationIntervalMs() const = 0;
+
+    /**
+     * @brief CPU time the evaluation of the collectionScheme condition may use per evaluation of the inspection
+     *
+     * @return budget in microseconds, 0 if the condition has no budget
+     */
+    virtual uint32_t getConditionEvaluationBudgetUs() const = 0;
+
     /**
      * @brief Returns the condition to trigger the collectionScheme
      *
@@ -392,7 +493,10 @@ public:
     virtual const ImagesDataType &getImageCaptureData() const = 0;
 
     /**
-     * @brief Returns all of the Expression Nodes
+     * @brief Returns all of the Expression Nodes, laid out in evaluation order so children precede their parent
+     *
+     * The nodes of all collectionSchemes built from the same list share one arena, so the vector can also
+     * contain the nodes of the other collectionSchemes of the list. The root is returned by getCondition().
      *
      * @return if not ready an empty vector
      */
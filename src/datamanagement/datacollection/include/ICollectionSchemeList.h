@@ -86,6 +86,12 @@ public:
      */
     virtual const std::vector<uint8_t> &getData() const = 0;
 
+    /**
+     * @brief Frees the binary data once it is persisted. getData() returns an empty vector afterwards, while the
+     * built CollectionScheme List stays usable
+     */
+    virtual void releaseData() = 0;
+
     virtual ~ICollectionSchemeList() = default;
 };
 
@@ -0,0 +1,110 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataManagement
+{
+
+/**
+ * @brief Writes JSON text directly into an output buffer, without building a document first.
+ *
+ * The buffer keeps its capacity when it is cleared, so a writer that is reused for every payload stops allocating
+ * once the largest payload was written. The caller is responsible for the structure: keys are only written inside
+ * objects and every begin has its end. Commas between the elements are inserted by the writer.
+ *
+ * Doubles are written with the fewest digits that read back to the same value, integral doubles without
+ * calling into printf. Like jsoncpp, doubles always have a fraction or an exponent, NaN is written as null and
+ * the infinities as 1e+9999 and -1e+9999.
+ */
+class JSONStreamWriter
+{
+public:
+    /**
+     * @brief Empties the output, keeping the allocated buffer
+     */
+    void clear();
+
+    void beginObject();
+    void endObject();
+    void beginArray();
+    void endArray();
+
+    /**
+     * @brief Writes the key of the next value of the current object
+     * @param name key, written without escaping, so it must not need any
+     */
+    void key( const char *name );
+
+    void value( const std::string &value );
+    void value( uint64_t value );
+    void value( int64_t value );
+    void value( uint32_t value );
+    void value( double value );
+
+    /**
+     * @brief Writes a key and its value
+     */
+    template <typename T>
+    void
+    member( const char *name, const T &memberValue )
+    {
+        key( name );
+        value( memberValue );
+    }
+
+    /**
+     * @brief The JSON written since the last clear
+     */
+    const std::string &
+    str() const
+    {
+        return mBuffer;
+    }
+
+    /**
+     * @brief Appends the shortest representation of a double that reads back to the same value
+     * @param output string to append to
+     * @param value value to write
+     */
+    static void appendDouble( std::string &output, double value );
+
+    /**
+     * @brief Appends the decimal digits of an unsigned integer
+     */
+    static void appendUnsigned( std::string &output, uint64_t value );
+
+private:
+    // Writes the comma before every element but the first of an object or array
+    void separate();
+    void appendEscaped( const std::string &value );
+
+    std::string mBuffer;
+    // One entry per open object or array, whether it has an element already
+    std::vector<bool> mHasElement;
+    bool mAfterKey{ false };
+};
+
+} // namespace DataManagement
+} // namespace IoTFleetWise
+} // namespace Aws
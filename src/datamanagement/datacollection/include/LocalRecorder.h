@@ -0,0 +1,263 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "BoundedQueue.h"
+#include "ClockHandler.h"
+#include "CollectionInspectionAPITypes.h"
+#include "CompressionCodec.h"
+#include "LoggingModule.h"
+#include "Thread.h"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataManagement
+{
+using namespace Aws::IoTFleetWise::Platform::Linux;
+using namespace Aws::IoTFleetWise::DataInspection;
+
+/**
+ * @brief Records the collected signals and raw CAN frames into local files, e.g. to record test vehicles at full bus
+ *        rate and to offload the files in the depot
+ *
+ * The recorder is fed with the output of the inspection next to the upload. A campaign that collects all signals and
+ * frames periodically records everything: samples are only recorded if they are newer than the last recorded sample
+ * of their signal or frame, so the overlapping histories of consecutive triggers give one continuous recording.
+ *
+ * The samples are stored in columns, one column per field, in blocks of up to blockRows rows which are compressed with
+ * the configured codec. The blocks are collected into chunks of writeChunkBytes, which are written with one call, so
+ * the flash sees large sequential writes. A file is written as recording-<start time>-<sequence>.fwr.part and renamed
+ * to .fwr once it exceeded maxFileBytes or maxFileDurationMs and its block index was written. Each closed file is
+ * appended as line "<file name>,<first sample time>,<last sample time>,<signal rows>,<frame rows>,<bytes>" to the file
+ * index.csv in the directory. With maxTotalBytes the oldest files are deleted. Files of a run that was not stopped
+ * properly are closed when the recorder starts, they have no block index, but their blocks can still be read in
+ * sequence. The lines of deleted files stay in the file index. All numbers in the files are little endian.
+ *
+ * File header:
+ * | Offset | Size | Content                                                 |
+ * |--------|------|---------------------------------------------------------|
+ * | 0      | 4    | Magic "FWR1"                                            |
+ * | 4      | 1    | Codec ID of the blocks, see CompressionCodecType        |
+ * | 5      | 3    | Reserved                                                |
+ * | 8      | 8    | Creation time in ms since epoch                         |
+ *
+ * Block header, followed by the compressed columns:
+ * | Offset | Size | Content                                                 |
+ * |--------|------|---------------------------------------------------------|
+ * | 0      | 3    | Magic "FWB"                                             |
+ * | 3      | 1    | Block type, 0 for signals and 1 for raw CAN frames      |
+ * | 4      | 4    | Rows                                                    |
+ * | 8      | 8    | Oldest receive time of the rows in ms since epoch       |
+ * | 16     | 8    | Newest receive time of the rows in ms since epoch       |
+ * | 24     | 4    | Size of the compressed columns                          |
+ * | 28     | 4    | CRC32C of the compressed columns                        |
+ *
+ * The signal columns are the receive times (8 bytes each), the microseconds within the millisecond (2), the signal
+ * IDs (4) and the values (8, double). The frame columns are the receive times (8), the microseconds within the
+ * millisecond (2), the channel IDs (4), the frame IDs (4), the sizes (1) and the payloads of all frames back to back.
+ *
+ * The block index at the end of a closed file has one entry of 32 bytes per block: the offset of the block header
+ * (8), the block type (1), 3 reserved bytes, the rows (4), the oldest (8) and the newest receive time (8). It is
+ * followed by the trailer of 16 bytes: the offset of the index (8), the number of blocks (4) and the magic "FWRI".
+ */
+class LocalRecorder
+{
+public:
+    struct Config
+    {
+        std::string directory;                                  /**< existing directory the files are written to */
+        CompressionCodecType codec{ CompressionCodecType::SNAPPY }; /**< codec of the blocks */
+        uint32_t blockRows{ DEFAULT_BLOCK_ROWS };               /**< rows per block */
+        size_t writeChunkBytes{ DEFAULT_WRITE_CHUNK_BYTES };    /**< blocks are written in chunks of this size */
+        uint64_t maxFileBytes{ DEFAULT_MAX_FILE_BYTES };        /**< the file is closed once it exceeds this size */
+        uint64_t maxFileDurationMs{ DEFAULT_MAX_FILE_DURATION_MS }; /**< the file is closed once it is this old */
+        uint64_t maxTotalBytes{ 0 };                            /**< oldest files are deleted above, 0 for no limit */
+        uint32_t flushIntervalMs{ DEFAULT_FLUSH_INTERVAL_MS };  /**< rows are written at least this often */
+        size_t queueSize{ DEFAULT_QUEUE_SIZE };                 /**< collected data waiting to be recorded */
+    };
+
+    static constexpr uint32_t DEFAULT_BLOCK_ROWS = 65536;
+    static constexpr size_t DEFAULT_WRITE_CHUNK_BYTES = 4 * 1024 * 1024;
+    static constexpr uint64_t DEFAULT_MAX_FILE_BYTES = 256 * 1024 * 1024;
+    static constexpr uint64_t DEFAULT_MAX_FILE_DURATION_MS = 600000;
+    static constexpr uint32_t DEFAULT_FLUSH_INTERVAL_MS = 5000;
+    static constexpr size_t DEFAULT_QUEUE_SIZE = 64;
+
+    static constexpr size_t FILE_HEADER_SIZE = 16;
+    static constexpr size_t BLOCK_HEADER_SIZE = 32;
+    static constexpr size_t INDEX_ENTRY_SIZE = 32;
+    static constexpr size_t TRAILER_SIZE = 16;
+
+    static constexpr uint8_t BLOCK_TYPE_SIGNALS = 0;
+    static constexpr uint8_t BLOCK_TYPE_CAN_FRAMES = 1;
+
+    explicit LocalRecorder( Config config );
+    ~LocalRecorder();
+
+    LocalRecorder( const LocalRecorder & ) = delete;
+    LocalRecorder &operator=( const LocalRecorder & ) = delete;
+    LocalRecorder( LocalRecorder && ) = delete;
+    LocalRecorder &operator=( LocalRecorder && ) = delete;
+
+    /**
+     * @brief Closes the files left by an earlier run and starts the recording thread
+     * @return True if the codec is supported, the directory exists and the thread is running
+     */
+    bool start();
+
+    /**
+     * @brief Records the queued data, closes the current file and stops the thread. Data submitted afterwards is
+     *        rejected.
+     * @return True if the thread stopped
+     */
+    bool stop();
+
+    bool isAlive();
+
+    /**
+     * @brief Queues the data for recording without waiting. Called by the thread consuming the inspection output.
+     * @return False if the queue is full, the data is then not recorded
+     */
+    bool submit( const TriggeredCollectionSchemeDataPtr &data );
+
+    /**
+     * @brief Records the samples of the data which are newer than the recorded ones, called by the recording thread
+     */
+    void record( const TriggeredCollectionSchemeData &data );
+
+    /**
+     * @brief Writes the buffered rows to the current file
+     * @param closeCurrentFile true to also close the file, the next rows are written to a new file
+     */
+    void flush( bool closeCurrentFile );
+
+    /**
+     * @brief Reads the rows of a recording file, e.g. for the offload tooling
+     * @param path the recording file, with or without block index
+     * @param signals the recorded signals are appended
+     * @param frames the recorded raw CAN frames are appended
+     * @return False if the file could not be read or is corrupted, the rows of the blocks before are still appended
+     */
+    static bool readFile( const std::string &path,
+                          std::vector<CollectedSignal> &signals,
+                          std::vector<CollectedCanRawFrame> &frames );
+
+private:
+    struct IndexEntry
+    {
+        uint64_t offset{ 0 };
+        uint8_t type{ BLOCK_TYPE_SIGNALS };
+        uint32_t rows{ 0 };
+        Timestamp oldest{ 0 };
+        Timestamp newest{ 0 };
+    };
+
+    struct ClosedFile
+    {
+        std::string path;
+        uint64_t bytes{ 0 };
+    };
+
+    static void doWork( void *data );
+
+    // Microseconds since epoch, the key of the recorded samples
+    static uint64_t
+    getTimeUs( Timestamp time, TimestampFractionUs fractionUs )
+    {
+        return ( time * 1000U ) + fractionUs;
+    }
+
+    static uint64_t
+    getFrameKey( CANChannelNumericID channelId, CANRawFrameID frameId )
+    {
+        return ( static_cast<uint64_t>( channelId ) << 32U ) | frameId;
+    }
+
+    void recordSignal( SignalID signalId, Timestamp time, TimestampFractionUs fractionUs, double value );
+    void recordFrame( const CollectedCanRawFrame &frame );
+    void applyWatermarks();
+
+    void encodeSignalBlock();
+    void encodeFrameBlock();
+    void appendBlock( uint8_t type, uint32_t rows, Timestamp oldest, Timestamp newest );
+
+    bool openFile();
+    void closeFile();
+    bool writeChunk();
+    bool isFileFull() const;
+    bool recoverFiles();
+    void deleteOldestFiles();
+
+    Config mConfig;
+    std::unique_ptr<ICompressionCodec> mCodec;
+    std::shared_ptr<const Clock> mClock = ClockHandler::getClock();
+
+    // Newest recorded sample per signal and per channel and frame, in microseconds since epoch
+    std::unordered_map<SignalID, uint64_t> mSignalWatermarks;
+    std::unordered_map<uint64_t, uint64_t> mFrameWatermarks;
+    // Watermarks of the data being recorded, applied after all of its samples were compared with the previous ones
+    std::vector<std::pair<SignalID, uint64_t>> mPendingSignalWatermarks;
+    std::vector<std::pair<uint64_t, uint64_t>> mPendingFrameWatermarks;
+
+    // Columns of the block being filled
+    std::vector<Timestamp> mSignalTimes;
+    std::vector<TimestampFractionUs> mSignalFractions;
+    std::vector<SignalID> mSignalIds;
+    std::vector<double> mSignalValues;
+    std::vector<Timestamp> mFrameTimes;
+    std::vector<TimestampFractionUs> mFrameFractions;
+    std::vector<CANChannelNumericID> mFrameChannels;
+    std::vector<CANRawFrameID> mFrameIds;
+    std::vector<uint8_t> mFrameSizes;
+    std::vector<uint8_t> mFramePayloads;
+    // Uncompressed columns and compressed block, reused
+    std::vector<uint8_t> mColumns;
+    std::vector<uint8_t> mCompressed;
+
+    // Encoded blocks not written yet
+    std::vector<uint8_t> mChunk;
+    int mFd{ -1 };
+    std::string mFilePath;
+    uint64_t mFileBytes{ 0 };
+    Timestamp mFileOpenTime{ 0 };
+    Timestamp mFileOldest{ 0 };
+    Timestamp mFileNewest{ 0 };
+    Timestamp mLastFlushTime{ 0 };
+    std::vector<IndexEntry> mIndex;
+    uint64_t mFileSignalRows{ 0 };
+    uint64_t mFileFrameRows{ 0 };
+    uint32_t mFileSequence{ 0 };
+    std::deque<ClosedFile> mClosedFiles;
+    uint64_t mClosedFilesBytes{ 0 };
+
+    BoundedQueue<TriggeredCollectionSchemeDataPtr> mQueue;
+    Thread mThread;
+    std::mutex mThreadMutex;
+    LoggingModule mLogger;
+};
+
+} // namespace DataManagement
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -0,0 +1,121 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "CacheAndPersist.h"
+#include "CompressionCodec.h"
+#include "LoggingModule.h"
+#include "PayloadManager.h"
+#include "Signal.h"
+#include "Thread.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataManagement
+{
+using namespace Aws::IoTFleetWise::Platform::Linux;
+using namespace Aws::IoTFleetWise::Platform::Linux::PersistencyManagement;
+using namespace Aws::IoTFleetWise::OffboardConnectivityAwsIot;
+
+/**
+ * @brief Compresses the persisted payloads in the background, so that they can be stored uncompressed without
+ *        adding latency to the data path, see PayloadManager::setDeferredCompression
+ *
+ * The compactor sets the strongest codec of the build as storage codec of the PayloadManager, Zstandard, else LZ4,
+ * else snappy. Its thread runs with the lowest priority and compacts one closed segment per interval, and only if the
+ * agent used less than the configured share of the CPU in the last interval, so it uses the CPU while the vehicle
+ * data is idle. Segments are never compacted while they are uploaded.
+ */
+class PersistedDataCompactor
+{
+public:
+    static constexpr uint32_t DEFAULT_INTERVAL_MS = 1000;
+    static constexpr double DEFAULT_MAX_CPU_PERCENT = 20.0;
+
+    /**
+     * @param payloadManager    stores and retrieves the payloads, its storage codec is set
+     * @param persistency       persistency of the payloads
+     * @param maxCpuPercent     segments are only compacted if the agent used less CPU in the last interval, in
+     *                          percent of all cores
+     * @param intervalMs        time between two compacted segments
+     */
+    PersistedDataCompactor( std::shared_ptr<PayloadManager> payloadManager,
+                            std::shared_ptr<CacheAndPersist> persistency,
+                            double maxCpuPercent = DEFAULT_MAX_CPU_PERCENT,
+                            uint32_t intervalMs = DEFAULT_INTERVAL_MS );
+    ~PersistedDataCompactor();
+
+    PersistedDataCompactor( const PersistedDataCompactor & ) = delete;
+    PersistedDataCompactor &operator=( const PersistedDataCompactor & ) = delete;
+    PersistedDataCompactor( PersistedDataCompactor && ) = delete;
+    PersistedDataCompactor &operator=( PersistedDataCompactor && ) = delete;
+
+    /**
+     * @brief Starts the compaction thread
+     * @return True if the thread is running
+     */
+    bool start();
+
+    /**
+     * @brief Stops the compaction thread, a segment being compacted is finished first
+     * @return True if the thread stopped
+     */
+    bool stop();
+
+    bool isAlive();
+
+    /**
+     * @brief Compacts the oldest segment which was not compacted yet
+     * @return True if a segment was compacted, false if there was none to compact
+     */
+    bool compactNext();
+
+    CompressionCodecType
+    getCodecType() const
+    {
+        return mCodecType;
+    }
+
+private:
+    static void doWork( void *data );
+
+    bool shouldStop() const;
+
+    std::shared_ptr<PayloadManager> mPayloadManager;
+    std::shared_ptr<CacheAndPersist> mPersistency;
+    double mMaxCpuPercent;
+    uint32_t mIntervalMs;
+    CompressionCodecType mCodecType{ CompressionCodecType::SNAPPY };
+    // Only used by the thread calling compactNext
+    std::unique_ptr<ICompressionCodec> mCodec;
+    // Segments which were compacted or had nothing to compact
+    std::set<uint64_t> mCompactedSegmentIds;
+    Thread mThread;
+    std::atomic<bool> mShouldStop{ false };
+    std::mutex mThreadMutex;
+    Signal mWait;
+    LoggingModule mLogger;
+};
+
+} // namespace DataManagement
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -0,0 +1,169 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "ISender.h"
+#include "PayloadBufferPool.h"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataManagement
+{
+using namespace Aws::IoTFleetWise::OffboardConnectivity;
+
+/**
+ * @brief Payloads of collection schemes up to a priority, which share a queue and an in-flight limit
+ */
+struct SendPriorityLevel
+{
+    uint32_t maxPriority{ 0 }; /**< least important collection scheme priority (highest number) of the level */
+    uint32_t maxInFlight{ 0 }; /**< payloads handed over to the sender and not yet released by it, 0 for no limit */
+};
+
+/**
+ * @brief Blocking queue of payloads, which hands out the payloads of the most important priority level first
+ *
+ * Each level has its own bounded queue, so a backlog of less important payloads does not block the producers of more
+ * important ones. A popped payload counts as in flight until the sender released all references to its buffer,
+ * which AwsIotChannel does in the publish completion callback. While a level has its maximum of payloads in flight
+ * its queue is skipped, so a degraded connection fills up with the payloads of the important levels first and the
+ * others wait in their queue. After close() the remaining payloads are handed out regardless of the in-flight limits.
+ */
+class PrioritySendQueue
+{
+public:
+    /**
+     * @param levels             ordered from the most to the least important. Payloads with a priority above all
+     *                           levels belong to the last one. Without levels the queue is a single FIFO queue
+     * @param capacityPerLevel   maximum number of queued payloads per level, at least 1
+     */
+    PrioritySendQueue( std::vector<SendPriorityLevel> levels, size_t capacityPerLevel );
+
+    PrioritySendQueue( const PrioritySendQueue & ) = delete;
+    PrioritySendQueue &operator=( const PrioritySendQueue & ) = delete;
+    PrioritySendQueue( PrioritySendQueue && ) = delete;
+    PrioritySendQueue &operator=( PrioritySendQueue && ) = delete;
+
+    /**
+     * @brief Appends a payload to the queue of its level, waiting while that queue is full
+     * @return False if the queue was closed, the payload is then dropped
+     */
+    bool push( PayloadBufferPtr buffer, const CollectionSchemeParams &collectionSchemeParams );
+
+    /**
+     * @brief Removes the oldest payload of the most important level which has room for one more payload in flight,
+     *        waiting while there is none
+     * @param buffer set to the payload, it is in flight until all references to it are released
+     * @param collectionSchemeParams set to the parameters the payload was pushed with
+     * @return False if the queue is closed and empty
+     */
+    bool pop( PayloadBufferPtr &buffer, CollectionSchemeParams &collectionSchemeParams );
+
+    /**
+     * @brief Rejects further payloads and wakes up all waiting threads
+     */
+    void close();
+
+    /**
+     * @brief Accepts payloads again after close(), the queue must be empty
+     */
+    void reopen();
+
+    /**
+     * @brief Index of the level the payloads of a collection scheme priority belong to
+     */
+    size_t getLevel( uint32_t priority ) const;
+
+    size_t
+    getLevelCount() const
+    {
+        return mState->mLevels.size();
+    }
+
+    /**
+     * @brief Number of queued payloads of a level
+     */
+    size_t size( size_t level ) const;
+
+    /**
+     * @brief Number of payloads of a level handed out and not yet released
+     */
+    uint32_t getInFlight( size_t level ) const;
+
+private:
+    struct QueuedPayload
+    {
+        PayloadBufferPtr mBuffer;
+        CollectionSchemeParams mCollectionSchemeParams;
+    };
+
+    struct Level
+    {
+        SendPriorityLevel mConfig;
+        std::deque<QueuedPayload> mPayloads;
+        uint32_t mInFlight{ 0 };
+    };
+
+    /**
+     * @brief Shared with the payloads in flight, as their buffers can outlive the queue
+     */
+    struct State
+    {
+        std::mutex mMutex;
+        std::condition_variable mNotFull;
+        std::condition_variable mReady;
+        std::vector<Level> mLevels;
+        size_t mCapacityPerLevel{ 1 };
+        bool mClosed{ false };
+    };
+
+    /**
+     * @brief Owns a handed out buffer and ends its in-flight state when released
+     */
+    struct InFlightPayload
+    {
+        InFlightPayload( std::shared_ptr<State> state, size_t level, PayloadBufferPtr buffer );
+        ~InFlightPayload();
+
+        InFlightPayload( const InFlightPayload & ) = delete;
+        InFlightPayload &operator=( const InFlightPayload & ) = delete;
+        InFlightPayload( InFlightPayload && ) = delete;
+        InFlightPayload &operator=( InFlightPayload && ) = delete;
+
+        std::shared_ptr<State> mState;
+        size_t mLevel;
+        PayloadBufferPtr mBuffer;
+    };
+
+    /**
+     * @brief Index of the first level with a payload that can be handed out, the level count if there is none.
+     *        Must be called with the mutex held
+     */
+    size_t findReadyLevel() const;
+
+    std::shared_ptr<State> mState;
+};
+
+} // namespace DataManagement
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -0,0 +1,179 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "AdaptiveCompressionController.h"
+#include "CompressionCodec.h"
+#include "FastClock.h"
+#include "TraceModule.h"
+#include <algorithm>
+#include <string>
+#include <utility>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataManagement
+{
+namespace
+{
+constexpr int ZSTD_DEFAULT_LEVEL = 3;
+constexpr int ZSTD_LADDER_LEVELS[] = { 1, 3, 6, 9, 15, 19 };
+
+// Only Zstandard has levels, its level 0 is the default level
+CompressionSetting
+normalize( CompressionSetting setting )
+{
+    if ( setting.codec != CompressionCodecType::ZSTD )
+    {
+        setting.level = 0;
+    }
+    else if ( setting.level == 0 )
+    {
+        setting.level = ZSTD_DEFAULT_LEVEL;
+    }
+    return setting;
+}
+
+// Orders the settings from the fastest to the strongest
+std::pair<int, int>
+getStrength( const CompressionSetting &setting )
+{
+    int codecRank = 0;
+    switch ( setting.codec )
+    {
+    case CompressionCodecType::LZ4:
+        codecRank = 0;
+        break;
+    case CompressionCodecType::SNAPPY:
+        codecRank = 1;
+        break;
+    default:
+        codecRank = 2;
+        break;
+    }
+    return std::make_pair( codecRank, normalize( setting ).level );
+}
+
+std::string
+toString( const CompressionSetting &setting )
+{
+    return std::string( getCompressionCodecName( setting.codec ) ) + " level " + std::to_string( setting.level );
+}
+} // namespace
+
+constexpr double AdaptiveCompressionController::STRONGER_CPU_HEADROOM;
+
+AdaptiveCompressionController::AdaptiveCompressionController( const AdaptiveCompressionConfig &config )
+    : mConfig( config )
+{
+    std::vector<CompressionSetting> candidates = { normalize( config.fastest ),
+                                                   normalize( config.strongest ),
+                                                   { CompressionCodecType::LZ4, 0 },
+                                                   { CompressionCodecType::SNAPPY, 0 } };
+    for ( auto level : ZSTD_LADDER_LEVELS )
+    {
+        candidates.push_back( { CompressionCodecType::ZSTD, level } );
+    }
+    auto fastest = getStrength( config.fastest );
+    auto strongest = getStrength( config.strongest );
+    for ( const auto &candidate : candidates )
+    {
+        auto strength = getStrength( candidate );
+        if ( isCompressionCodecSupported( candidate.codec ) && ( strength >= fastest ) && ( strength <= strongest ) &&
+             ( std::find( mSettings.begin(), mSettings.end(), candidate ) == mSettings.end() ) )
+        {
+            mSettings.push_back( candidate );
+        }
+    }
+    std::sort( mSettings.begin(), mSettings.end(), []( const CompressionSetting &a, const CompressionSetting &b ) {
+        return getStrength( a ) < getStrength( b );
+    } );
+    if ( mSettings.empty() )
+    {
+        mSettings.push_back( { CompressionCodecType::SNAPPY, 0 } );
+    }
+    mIndex = ( mSettings.size() - 1U ) / 2U;
+}
+
+bool
+AdaptiveCompressionController::isValid( const AdaptiveCompressionConfig &config )
+{
+    return ( getStrength( config.fastest ) <= getStrength( config.strongest ) ) && ( config.maxCpuPercent > 0.0 ) &&
+           ( config.targetBacklogSeconds > 0.0 ) && ( config.intervalMs > 0U );
+}
+
+CompressionSetting
+AdaptiveCompressionController::select()
+{
+    auto nowMs = FastClock::monotonicTimeMs( ClockPrecision::COARSE );
+    if ( ( mMeasuring ) && ( nowMs - mLastTimeMs < mConfig.intervalMs ) )
+    {
+        return getSetting();
+    }
+    auto cpuTimeUs = FastClock::threadCpuTimeUs();
+    auto publishedBytes = TraceModule::get().getAtomicVariable( TraceAtomicVariable::MQTT_PUBLISHED_BYTES );
+    // The first call only starts the measurement
+    if ( mMeasuring )
+    {
+        auto elapsedMs = static_cast<double>( nowMs - mLastTimeMs );
+        CompressionLoad load;
+        load.cpuPercent = static_cast<double>( cpuTimeUs - mLastCpuTimeUs ) / ( elapsedMs * 10.0 );
+        load.uplinkBytesPerSecond =
+            ( publishedBytes >= mLastPublishedBytes )
+                ? ( static_cast<double>( publishedBytes - mLastPublishedBytes ) * 1000.0 / elapsedMs )
+                : 0.0;
+        load.backlogBytes = TraceModule::get().getAtomicVariable( TraceAtomicVariable::UPLOAD_BACKLOG_BYTES );
+        update( load );
+    }
+    mMeasuring = true;
+    mLastTimeMs = nowMs;
+    mLastCpuTimeUs = cpuTimeUs;
+    mLastPublishedBytes = publishedBytes;
+    return getSetting();
+}
+
+CompressionSetting
+AdaptiveCompressionController::update( const CompressionLoad &load )
+{
+    auto previousIndex = mIndex;
+    if ( load.cpuPercent > mConfig.maxCpuPercent )
+    {
+        if ( mIndex > 0U )
+        {
+            mIndex--;
+        }
+    }
+    else if ( ( load.cpuPercent <= mConfig.maxCpuPercent * STRONGER_CPU_HEADROOM ) &&
+              ( mIndex + 1U < mSettings.size() ) && ( load.backlogBytes > 0U ) &&
+              ( ( load.uplinkBytesPerSecond <= 0.0 ) ||
+                ( static_cast<double>( load.backlogBytes ) / load.uplinkBytesPerSecond >
+                  mConfig.targetBacklogSeconds ) ) )
+    {
+        mIndex++;
+    }
+    if ( mIndex != previousIndex )
+    {
+        mLogger.trace( "AdaptiveCompressionController::update", [&]() {
+            return "Compressing with " + toString( mSettings[mIndex] ) + ", sender CPU " +
+                   std::to_string( load.cpuPercent ) + "%, uplink " + std::to_string( load.uplinkBytesPerSecond ) +
+                   " B/s, backlog " + std::to_string( load.backlogBytes ) + " B";
+        } );
+    }
+    return getSetting();
+}
+
+} // namespace DataManagement
+} // namespace IoTFleetWise
+} // namespace Aws
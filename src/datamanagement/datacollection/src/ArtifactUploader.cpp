@@ -0,0 +1,340 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "ArtifactUploader.h"
+#include <algorithm>
+#include <boost/filesystem.hpp>
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataManagement
+{
+
+constexpr uint32_t ArtifactUploader::DEFAULT_CHUNK_SIZE_BYTES;
+constexpr uint32_t ArtifactUploader::DEFAULT_RETRY_INTERVAL_MS;
+constexpr uint8_t ArtifactUploader::CHUNK_FORMAT_VERSION;
+constexpr size_t ArtifactUploader::CHUNK_HEADER_FIXED_SIZE;
+const std::string ArtifactUploader::PROGRESS_FILE_SUFFIX = ".upload";
+
+namespace
+{
+template <typename T>
+void
+appendLittleEndian( PayloadBuffer &buffer, T value )
+{
+    for ( size_t i = 0; i < sizeof( T ); i++ )
+    {
+        buffer.push_back( static_cast<uint8_t>( ( static_cast<uint64_t>( value ) >> ( i * 8U ) ) & 0xFFU ) );
+    }
+}
+} // namespace
+
+ArtifactUploader::ArtifactUploader( std::shared_ptr<ISender> sender, uint32_t chunkSizeBytes, uint32_t retryIntervalMs )
+    : mSender( std::move( sender ) )
+    , mChunkSizeBytes( std::max( 1U, chunkSizeBytes ) )
+    , mRetryIntervalMs( retryIntervalMs )
+{
+}
+
+ArtifactUploader::~ArtifactUploader()
+{
+    // To make sure the thread stops during teardown of tests.
+    if ( isAlive() )
+    {
+        stop();
+    }
+}
+
+bool
+ArtifactUploader::start()
+{
+    // Prevent concurrent stop/init
+    std::lock_guard<std::mutex> lock( mThreadMutex );
+    // On multi core systems the shared variable mShouldStop must be updated for
+    // all cores before starting the thread otherwise thread will directly end
+    mShouldStop.store( false );
+    if ( !mThread.create( doWork, this, "fwDMArtUpload" ) )
+    {
+        mLogger.error( "ArtifactUploader::start", " Artifact Upload Thread failed to start " );
+        return false;
+    }
+    mLogger.trace( "ArtifactUploader::start", " Artifact Upload Thread started " );
+    return true;
+}
+
+bool
+ArtifactUploader::stop()
+{
+    std::lock_guard<std::mutex> lock( mThreadMutex );
+    mShouldStop.store( true, std::memory_order_relaxed );
+    mWait.notify();
+    mThread.release();
+    mShouldStop.store( false, std::memory_order_relaxed );
+    mLogger.trace( "ArtifactUploader::stop", " Artifact Upload Thread stopped " );
+    return !mThread.isActive();
+}
+
+bool
+ArtifactUploader::isAlive()
+{
+    return mThread.isValid() && mThread.isActive();
+}
+
+bool
+ArtifactUploader::shouldStop() const
+{
+    return mShouldStop.load( std::memory_order_relaxed );
+}
+
+bool
+ArtifactUploader::submit( const std::string &path, uint32_t sourceID )
+{
+    struct stat fileStat = {};
+    if ( stat( path.c_str(), &fileStat ) != 0 )
+    {
+        mLogger.error( "ArtifactUploader::submit", " Artifact not found: " + path );
+        return false;
+    }
+    Progress progress;
+    progress.sourceID = sourceID;
+    progress.artifactSize = static_cast<uint64_t>( fileStat.st_size );
+    if ( !writeProgress( path + PROGRESS_FILE_SUFFIX, progress ) )
+    {
+        mLogger.error( "ArtifactUploader::submit", " Could not write the upload progress of " + path );
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock( mPendingMutex );
+        if ( std::find( mPendingArtifacts.begin(), mPendingArtifacts.end(), path ) == mPendingArtifacts.end() )
+        {
+            mPendingArtifacts.push_back( path );
+        }
+    }
+    mWait.notify();
+    return true;
+}
+
+size_t
+ArtifactUploader::resumeUploads( const std::string &directory )
+{
+    size_t resumed = 0;
+    boost::system::error_code errorCode;
+    for ( boost::filesystem::directory_iterator entry( directory, errorCode ), end; ( !errorCode ) && ( entry != end );
+          entry.increment( errorCode ) )
+    {
+        auto progressPath = entry->path().string();
+        if ( ( progressPath.size() <= PROGRESS_FILE_SUFFIX.size() ) ||
+             ( progressPath.compare( progressPath.size() - PROGRESS_FILE_SUFFIX.size(),
+                                     PROGRESS_FILE_SUFFIX.size(),
+                                     PROGRESS_FILE_SUFFIX ) != 0 ) )
+        {
+            continue;
+        }
+        auto path = progressPath.substr( 0, progressPath.size() - PROGRESS_FILE_SUFFIX.size() );
+        Progress progress;
+        if ( ( !boost::filesystem::exists( path ) ) || ( !readProgress( progressPath, progress ) ) )
+        {
+            mLogger.warn( "ArtifactUploader::resumeUploads", " Removing the stale upload progress " + progressPath );
+            (void)std::remove( progressPath.c_str() );
+            continue;
+        }
+        std::lock_guard<std::mutex> lock( mPendingMutex );
+        if ( std::find( mPendingArtifacts.begin(), mPendingArtifacts.end(), path ) == mPendingArtifacts.end() )
+        {
+            mPendingArtifacts.push_back( path );
+            resumed++;
+        }
+    }
+    if ( resumed > 0U )
+    {
+        mLogger.info( "ArtifactUploader::resumeUploads", " Resuming " + std::to_string( resumed ) + " uploads" );
+        mWait.notify();
+    }
+    return resumed;
+}
+
+size_t
+ArtifactUploader::getPendingArtifactCount() const
+{
+    std::lock_guard<std::mutex> lock( mPendingMutex );
+    return mPendingArtifacts.size();
+}
+
+bool
+ArtifactUploader::readProgress( const std::string &progressPath, Progress &progress )
+{
+    std::ifstream file( progressPath );
+    return static_cast<bool>( file >> progress.sourceID >> progress.artifactSize >> progress.nextOffset ) &&
+           ( progress.nextOffset <= progress.artifactSize );
+}
+
+bool
+ArtifactUploader::writeProgress( const std::string &progressPath, const Progress &progress )
+{
+    // Replaced atomically, so that a power loss leaves either the old or the new progress
+    auto tmpPath = progressPath + ".tmp";
+    {
+        std::ofstream file( tmpPath, std::ios::trunc );
+        file << progress.sourceID << " " << progress.artifactSize << " " << progress.nextOffset << "\n";
+        file.flush();
+        if ( !file )
+        {
+            (void)std::remove( tmpPath.c_str() );
+            return false;
+        }
+    }
+    return std::rename( tmpPath.c_str(), progressPath.c_str() ) == 0;
+}
+
+ArtifactUploader::UploadResult
+ArtifactUploader::sendChunk( int fd, const std::string &path, const Progress &progress, size_t chunkSize )
+{
+    auto fileName = boost::filesystem::path( path ).filename().string();
+    auto buffer = mPayloadBufferPool.acquire();
+    buffer->reserve( CHUNK_HEADER_FIXED_SIZE + fileName.size() + chunkSize );
+    buffer->insert( buffer->end(), { 'F', 'W', 'A', 'C' } );
+    buffer->push_back( CHUNK_FORMAT_VERSION );
+    appendLittleEndian<uint32_t>( *buffer, progress.sourceID );
+    appendLittleEndian<uint64_t>( *buffer, progress.artifactSize );
+    appendLittleEndian<uint64_t>( *buffer, progress.nextOffset );
+    appendLittleEndian<uint16_t>( *buffer, static_cast<uint16_t>( fileName.size() ) );
+    buffer->insert( buffer->end(), fileName.begin(), fileName.end() );
+    auto headerSize = buffer->size();
+    buffer->resize( headerSize + chunkSize );
+    size_t read = 0;
+    while ( read < chunkSize )
+    {
+        auto result = pread( fd,
+                             buffer->data() + headerSize + read,
+                             chunkSize - read,
+                             static_cast<off_t>( progress.nextOffset + read ) );
+        if ( ( result < 0 ) && ( errno == EINTR ) )
+        {
+            continue;
+        }
+        if ( result <= 0 )
+        {
+            return UploadResult::FAILED;
+        }
+        read += static_cast<size_t>( result );
+    }
+    auto error = mSender->sendBuffer( buffer );
+    if ( error == ConnectivityError::Success )
+    {
+        return UploadResult::DONE;
+    }
+    return ( error == ConnectivityError::NoConnection ) || ( error == ConnectivityError::QuotaReached )
+               ? UploadResult::RETRY
+               : UploadResult::FAILED;
+}
+
+ArtifactUploader::UploadResult
+ArtifactUploader::uploadArtifact( const std::string &path )
+{
+    auto progressPath = path + PROGRESS_FILE_SUFFIX;
+    Progress progress;
+    if ( !readProgress( progressPath, progress ) )
+    {
+        return UploadResult::FAILED;
+    }
+    auto fileNameSize = boost::filesystem::path( path ).filename().string().size();
+    if ( mSender->getMaxSendSize() <= CHUNK_HEADER_FIXED_SIZE + fileNameSize )
+    {
+        return UploadResult::FAILED;
+    }
+    auto chunkSize = std::min( mChunkSizeBytes, mSender->getMaxSendSize() - CHUNK_HEADER_FIXED_SIZE - fileNameSize );
+    int fd = open( path.c_str(), O_RDONLY | O_CLOEXEC );
+    if ( fd < 0 )
+    {
+        return UploadResult::FAILED;
+    }
+    auto result = UploadResult::DONE;
+    // An empty artifact is sent as one empty chunk, so the cloud learns about it
+    do
+    {
+        if ( shouldStop() )
+        {
+            result = UploadResult::RETRY;
+            break;
+        }
+        auto size = static_cast<size_t>( std::min<uint64_t>( chunkSize, progress.artifactSize - progress.nextOffset ) );
+        result = sendChunk( fd, path, progress, size );
+        if ( result != UploadResult::DONE )
+        {
+            break;
+        }
+        progress.nextOffset += size;
+        mUploadedBytes.fetch_add( size, std::memory_order_relaxed );
+        if ( !writeProgress( progressPath, progress ) )
+        {
+            mLogger.warn( "ArtifactUploader::uploadArtifact", " Could not write the upload progress of " + path );
+        }
+    } while ( progress.nextOffset < progress.artifactSize );
+    close( fd );
+    return result;
+}
+
+void
+ArtifactUploader::doWork( void *data )
+{
+    auto *uploader = static_cast<ArtifactUploader *>( data );
+    while ( !uploader->shouldStop() )
+    {
+        std::string path;
+        {
+            std::lock_guard<std::mutex> lock( uploader->mPendingMutex );
+            if ( !uploader->mPendingArtifacts.empty() )
+            {
+                path = uploader->mPendingArtifacts.front();
+            }
+        }
+        if ( path.empty() )
+        {
+            uploader->mWait.wait( Platform::Linux::Signal::WaitWithPredicate );
+            continue;
+        }
+        auto result = uploader->uploadArtifact( path );
+        if ( result == UploadResult::RETRY )
+        {
+            // The artifact stays first in the queue, the chunks sent so far are not sent again
+            uploader->mWait.wait( uploader->mRetryIntervalMs );
+            continue;
+        }
+        if ( result == UploadResult::DONE )
+        {
+            uploader->mLogger.info( "ArtifactUploader::doWork", " Uploaded " + path );
+            (void)std::remove( path.c_str() );
+        }
+        else
+        {
+            uploader->mLogger.error( "ArtifactUploader::doWork", " Could not upload " + path + ", dropping it" );
+        }
+        (void)std::remove( ( path + PROGRESS_FILE_SUFFIX ).c_str() );
+        std::lock_guard<std::mutex> lock( uploader->mPendingMutex );
+        uploader->mPendingArtifacts.pop_front();
+    }
+}
+
+} // namespace DataManagement
+} // namespace IoTFleetWise
+} // namespace Aws
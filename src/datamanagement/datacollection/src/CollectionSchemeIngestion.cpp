@@ -13,6 +13,8 @@
 
 // Includes
 #include "CollectionSchemeIngestion.h"
+#include <algorithm>
+#include <cmath>
 
 namespace Aws
 {
@@ -45,6 +47,15 @@ CollectionSchemeIngestion::copyData(
 
 bool
 CollectionSchemeIngestion::build()
+{
+    // Without a list the collectionScheme gets an arena of its own
+    auto expressionNodeArena = std::make_shared<ExpressionNode_t>();
+    expressionNodeArena->reserve( getNumberOfExpressionNodes( *mProtoCollectionSchemeMessagePtr ) );
+    return build( expressionNodeArena );
+}
+
+bool
+CollectionSchemeIngestion::isValid()
 {
     // Check if Collection collectionScheme has an ID and a Decoder Manifest ID
     if ( mProtoCollectionSchemeMessagePtr->campaign_arn().empty() ||
@@ -61,6 +72,63 @@ CollectionSchemeIngestion::build()
         mLogger.error( "CollectionSchemeIngestion::build()", "CollectionScheme end time comes before start time." );
         return false;
     }
+    return true;
+}
+
+bool
+CollectionSchemeIngestion::deferBuild()
+{
+    if ( !isValid() || !mProtoCollectionSchemeMessagePtr->SerializeToString( &mDeferredProtoData ) )
+    {
+        return false;
+    }
+    mDeferredCollectionSchemeID = mProtoCollectionSchemeMessagePtr->campaign_arn();
+    mDeferredDecoderManifestID = mProtoCollectionSchemeMessagePtr->decoder_manifest_arn();
+    mDeferredStartTime = mProtoCollectionSchemeMessagePtr->start_time_ms_epoch();
+    mDeferredExpiryTime = mProtoCollectionSchemeMessagePtr->expiry_time_ms_epoch();
+    mProtoCollectionSchemeMessagePtr.reset();
+    mBuildDeferred = true;
+    mLogger.trace( "CollectionSchemeIngestion::deferBuild()",
+                   "Deferring the build of CollectionScheme with ID: " + mDeferredCollectionSchemeID );
+    return true;
+}
+
+bool
+CollectionSchemeIngestion::buildIfDeferred()
+{
+    if ( !mBuildDeferred )
+    {
+        return true;
+    }
+    mBuildDeferred = false;
+    auto collectionSchemeMsg = std::make_shared<CollectionSchemesMsg::CollectionScheme>();
+    bool parsed = collectionSchemeMsg->ParseFromString( mDeferredProtoData );
+    std::string().swap( mDeferredProtoData );
+    if ( !parsed )
+    {
+        mLogger.error( "CollectionSchemeIngestion::buildIfDeferred()",
+                       "Error parsing the deferred CollectionScheme " + mDeferredCollectionSchemeID );
+        return false;
+    }
+    mProtoCollectionSchemeMessagePtr = collectionSchemeMsg;
+    if ( !build() )
+    {
+        mLogger.error( "CollectionSchemeIngestion::buildIfDeferred()",
+                       "Error building the deferred CollectionScheme " + mDeferredCollectionSchemeID );
+        return false;
+    }
+    return true;
+}
+
+bool
+CollectionSchemeIngestion::build( const std::shared_ptr<ExpressionNode_t> &expressionNodeArena )
+{
+    mExpressionNodes = expressionNodeArena;
+
+    if ( !isValid() )
+    {
+        return false;
+    }
 
     mLogger.trace( "CollectionSchemeIngestion::build()",
                    "Building CollectionScheme with ID: " + mProtoCollectionSchemeMessagePtr->campaign_arn() );
@@ -80,6 +148,29 @@ CollectionSchemeIngestion::build()
         signalInfo.minimumSampleIntervalMs = signalInformation.minimum_sample_period_ms();
         signalInfo.fixedWindowPeriod = signalInformation.fixed_window_period_ms();
         signalInfo.isConditionOnlySignal = signalInformation.condition_only_signal();
+        signalInfo.deepHistory = signalInformation.deep_history();
+        if ( signalInformation.has_aggregation() )
+        {
+            if ( !buildSignalAggregation( signalInformation, signalInfo ) )
+            {
+                return false;
+            }
+        }
+        if ( signalInformation.has_decimation() )
+        {
+            if ( !buildSignalDecimation( signalInformation, signalInfo ) )
+            {
+                return false;
+            }
+        }
+        if ( ( !std::isfinite( signalInformation.upload_resolution() ) ) ||
+             ( signalInformation.upload_resolution() < 0.0 ) )
+        {
+            mLogger.error( "CollectionSchemeIngestion::build()",
+                           "Invalid upload resolution of signal " + std::to_string( signalInfo.signalID ) );
+            return false;
+        }
+        signalInfo.uploadResolution = signalInformation.upload_resolution();
 
         mLogger.trace( "CollectionSchemeIngestion::build()",
                        "Adding signalID: " + std::to_string( signalInfo.signalID ) +
@@ -120,13 +211,8 @@ CollectionSchemeIngestion::build()
                       "CollectionScheme is Condition Based. Building AST with " + std::to_string( numNodes ) +
                           " nodes" );
 
-        mExpressionNodes.resize( numNodes );
-
-        // As pointers to elements inside the vector are used after this no realloc for mExpressionNodes is allowed
-        uint32_t currentIndex = 0; // start at index 0 of mExpressionNodes for first node
         mExpressionNode =
             serializeNode( mProtoCollectionSchemeMessagePtr->condition_based_collection_scheme().condition_tree(),
-                           currentIndex,
                            Aws::IoTFleetWise::DataInspection::MAX_EQUATION_DEPTH );
         mLogger.info( "CollectionSchemeIngestion::build()", "AST complete." );
     }
@@ -141,11 +227,10 @@ CollectionSchemeIngestion::build()
                                               .time_based_collection_scheme_period_ms() ) +
                           " ms." );
 
-        mExpressionNodes.emplace_back();
-        ExpressionNode &currentNode = mExpressionNodes.back();
+        ExpressionNode currentNode;
         currentNode.booleanValue = true;
         currentNode.nodeType = ExpressionNodeType::BOOLEAN;
-        mExpressionNode = &currentNode;
+        mExpressionNode = appendNode( currentNode );
     }
     else
     {
@@ -172,6 +257,30 @@ CollectionSchemeIngestion::build()
             imageCaptureData.beforeDurationMs = imageData.time_based_image_data().before_duration_ms();
             // Image format
             imageCaptureData.imageFormat = static_cast<uint32_t>( imageData.image_type() );
+            // Frame selection and re-encoding on the edge
+            if ( imageData.has_capture_options() )
+            {
+                const auto &captureOptions = imageData.capture_options();
+                imageCaptureData.captureOptions.keepEveryNthFrame = captureOptions.keep_every_nth_frame();
+                imageCaptureData.captureOptions.keyFramesOnly = captureOptions.key_frames_only();
+                imageCaptureData.captureOptions.similarityThreshold = captureOptions.similarity_threshold();
+                switch ( captureOptions.encoding() )
+                {
+                case CollectionSchemesMsg::ImageData::CaptureOptions::JPEG:
+                    imageCaptureData.captureOptions.encoding = VehicleNetwork::ImageEncoding::JPEG;
+                    break;
+                case CollectionSchemesMsg::ImageData::CaptureOptions::WEBP:
+                    imageCaptureData.captureOptions.encoding = VehicleNetwork::ImageEncoding::WEBP;
+                    break;
+                default:
+                    imageCaptureData.captureOptions.encoding = VehicleNetwork::ImageEncoding::ORIGINAL;
+                    break;
+                }
+                if ( captureOptions.encoding_quality() > 0U )
+                {
+                    imageCaptureData.captureOptions.encodingQuality = captureOptions.encoding_quality();
+                }
+            }
             mLogger.info( "CollectionSchemeIngestion::build()",
                           "Adding Image capture settings for DeviceID: " +
                               std::to_string( imageCaptureData.deviceID ) );
@@ -201,7 +310,7 @@ CollectionSchemeIngestion::getAllExpressionNodes() const
         return INVALID_EXPRESSION_NODE;
     }
 
-    return mExpressionNodes;
+    return *mExpressionNodes;
 }
 
 WindowFunction
@@ -231,6 +340,25 @@ CollectionSchemeIngestion::convertFunctionType(
         mLogger.info( "CollectionSchemeIngestion::convertFunctionType",
                       "Converting node to: PREV_LAST_FIXED_WINDOW_AVG" );
         return WindowFunction::PREV_LAST_FIXED_WINDOW_AVG;
+    case CollectionSchemesMsg::ConditionNode_NodeFunction_WindowFunction_WindowType_SLIDING_WINDOW_MIN:
+        mLogger.info( "CollectionSchemeIngestion::convertFunctionType", "Converting node to: SLIDING_WINDOW_MIN" );
+        return WindowFunction::SLIDING_WINDOW_MIN;
+    case CollectionSchemesMsg::ConditionNode_NodeFunction_WindowFunction_WindowType_SLIDING_WINDOW_MAX:
+        mLogger.info( "CollectionSchemeIngestion::convertFunctionType", "Converting node to: SLIDING_WINDOW_MAX" );
+        return WindowFunction::SLIDING_WINDOW_MAX;
+    case CollectionSchemesMsg::ConditionNode_NodeFunction_WindowFunction_WindowType_SLIDING_WINDOW_AVG:
+        mLogger.info( "CollectionSchemeIngestion::convertFunctionType", "Converting node to: SLIDING_WINDOW_AVG" );
+        return WindowFunction::SLIDING_WINDOW_AVG;
+    case CollectionSchemesMsg::ConditionNode_NodeFunction_WindowFunction_WindowType_SLIDING_WINDOW_COUNT:
+        mLogger.info( "CollectionSchemeIngestion::convertFunctionType", "Converting node to: SLIDING_WINDOW_COUNT" );
+        return WindowFunction::SLIDING_WINDOW_COUNT;
+    case CollectionSchemesMsg::ConditionNode_NodeFunction_WindowFunction_WindowType_SLIDING_WINDOW_STDDEV:
+        mLogger.info( "CollectionSchemeIngestion::convertFunctionType", "Converting node to: SLIDING_WINDOW_STDDEV" );
+        return WindowFunction::SLIDING_WINDOW_STDDEV;
+    case CollectionSchemesMsg::ConditionNode_NodeFunction_WindowFunction_WindowType_SLIDING_WINDOW_RATE_OF_CHANGE:
+        mLogger.info( "CollectionSchemeIngestion::convertFunctionType",
+                      "Converting node to: SLIDING_WINDOW_RATE_OF_CHANGE" );
+        return WindowFunction::SLIDING_WINDOW_RATE_OF_CHANGE;
     default:
         mLogger.error( "CollectionSchemeIngestion::convertFunctionType", "Function node type not supported." );
         return WindowFunction::NONE;
@@ -295,6 +423,101 @@ CollectionSchemeIngestion::convertOperatorType( CollectionSchemesMsg::ConditionN
     }
 }
 
+uint32_t
+CollectionSchemeIngestion::getNumberOfExpressionNodes( const CollectionSchemesMsg::CollectionScheme &collectionScheme )
+{
+    if ( collectionScheme.collection_scheme_type_case() ==
+         CollectionSchemesMsg::CollectionScheme::kConditionBasedCollectionScheme )
+    {
+        return getNumberOfNodes( collectionScheme.condition_based_collection_scheme().condition_tree(),
+                                 Aws::IoTFleetWise::DataInspection::MAX_EQUATION_DEPTH );
+    }
+    // A time based collectionScheme has a single node that is always true
+    return collectionScheme.collection_scheme_type_case() ==
+                   CollectionSchemesMsg::CollectionScheme::kTimeBasedCollectionScheme
+               ? 1U
+               : 0U;
+}
+
+bool
+CollectionSchemeIngestion::buildSignalAggregation( const CollectionSchemesMsg::SignalInformation &signalInformation,
+                                                   SignalCollectionInfo &signalInfo )
+{
+    const auto &aggregation = signalInformation.aggregation();
+    if ( signalInformation.fixed_window_period_ms() == 0 )
+    {
+        mLogger.error( "CollectionSchemeIngestion::buildSignalAggregation",
+                       "Aggregated signal " + std::to_string( signalInformation.signal_id() ) +
+                           " has no fixed window period" );
+        return false;
+    }
+    auto info = std::make_shared<DataInspection::SignalAggregationInfo>();
+    info->count = aggregation.count();
+    info->min = aggregation.min();
+    info->max = aggregation.max();
+    info->mean = aggregation.mean();
+    info->variance = aggregation.variance();
+    info->histogramBounds.assign( aggregation.histogram_bucket_bounds().begin(),
+                                  aggregation.histogram_bucket_bounds().end() );
+    info->percentiles.assign( aggregation.percentiles().begin(), aggregation.percentiles().end() );
+    if ( !std::is_sorted( info->histogramBounds.begin(), info->histogramBounds.end() ) )
+    {
+        mLogger.error( "CollectionSchemeIngestion::buildSignalAggregation",
+                       "Histogram bounds of signal " + std::to_string( signalInformation.signal_id() ) +
+                           " are not ascending" );
+        return false;
+    }
+    for ( auto percentile : info->percentiles )
+    {
+        if ( !( ( percentile >= 0.0 ) && ( percentile <= 100.0 ) ) )
+        {
+            mLogger.error( "CollectionSchemeIngestion::buildSignalAggregation",
+                           "Percentile of signal " + std::to_string( signalInformation.signal_id() ) +
+                               " is not between 0 and 100" );
+            return false;
+        }
+    }
+    signalInfo.aggregation = std::move( info );
+    return true;
+}
+
+bool
+CollectionSchemeIngestion::buildSignalDecimation( const CollectionSchemesMsg::SignalInformation &signalInformation,
+                                                  SignalCollectionInfo &signalInfo )
+{
+    const auto &decimation = signalInformation.decimation();
+    if ( signalInformation.has_aggregation() )
+    {
+        mLogger.error( "CollectionSchemeIngestion::buildSignalDecimation",
+                       "Signal " + std::to_string( signalInformation.signal_id() ) +
+                           " cannot be aggregated and decimated" );
+        return false;
+    }
+    if ( decimation.max_samples() < 2 )
+    {
+        mLogger.error( "CollectionSchemeIngestion::buildSignalDecimation",
+                       "Decimated signal " + std::to_string( signalInformation.signal_id() ) +
+                           " keeps less than 2 samples" );
+        return false;
+    }
+    auto info = std::make_shared<DataInspection::SignalDecimationInfo>();
+    switch ( decimation.method() )
+    {
+    case CollectionSchemesMsg::SignalDecimation::MIN_MAX:
+        info->method = DataInspection::SignalDecimationMethod::MIN_MAX;
+        break;
+    case CollectionSchemesMsg::SignalDecimation::UNIFORM:
+        info->method = DataInspection::SignalDecimationMethod::UNIFORM;
+        break;
+    default:
+        info->method = DataInspection::SignalDecimationMethod::LARGEST_TRIANGLE_THREE_BUCKETS;
+        break;
+    }
+    info->maxSamples = decimation.max_samples();
+    signalInfo.decimation = std::move( info );
+    return true;
+}
+
 uint32_t
 CollectionSchemeIngestion::getNumberOfNodes( const CollectionSchemesMsg::ConditionNode &node, const int depth )
 {
@@ -319,77 +542,152 @@ CollectionSchemeIngestion::getNumberOfNodes( const CollectionSchemesMsg::Conditi
 }
 
 ExpressionNode *
-CollectionSchemeIngestion::serializeNode( const CollectionSchemesMsg::ConditionNode &node,
-                                          uint32_t &nextIndex,
-                                          int remainingDepth )
+CollectionSchemeIngestion::serializeNode( const CollectionSchemesMsg::ConditionNode &node, int remainingDepth )
 {
     if ( remainingDepth <= 0 )
     {
         return nullptr;
     }
-    mExpressionNodes.emplace_back();
-    ExpressionNode *currentNode = &( mExpressionNodes[nextIndex] );
-    nextIndex++;
+    ExpressionNode currentNode;
 
     if ( node.node_case() == CollectionSchemesMsg::ConditionNode::kNodeSignalId )
     {
-        currentNode->signalID = node.node_signal_id();
-        currentNode->nodeType = ExpressionNodeType::SIGNAL;
+        currentNode.signalID = node.node_signal_id();
+        currentNode.nodeType = ExpressionNodeType::SIGNAL;
         mLogger.trace( "CollectionSchemeIngestion::serializeNode",
-                       "Creating SIGNAL node with ID: " + std::to_string( currentNode->signalID ) );
-        return currentNode;
+                       "Creating SIGNAL node with ID: " + std::to_string( currentNode.signalID ) );
+        return appendNode( currentNode );
     }
     else if ( node.node_case() == CollectionSchemesMsg::ConditionNode::kNodeDoubleValue )
     {
-        currentNode->floatingValue = node.node_double_value();
-        currentNode->nodeType = ExpressionNodeType::FLOAT;
+        currentNode.floatingValue = node.node_double_value();
+        currentNode.nodeType = ExpressionNodeType::FLOAT;
         mLogger.trace( "CollectionSchemeIngestion::serializeNode",
-                       "Creating FLOAT node with value: " + std::to_string( currentNode->floatingValue ) );
-        return currentNode;
+                       "Creating FLOAT node with value: " + std::to_string( currentNode.floatingValue ) );
+        return appendNode( currentNode );
     }
     else if ( node.node_case() == CollectionSchemesMsg::ConditionNode::kNodeBooleanValue )
     {
-        currentNode->booleanValue = node.node_boolean_value();
-        currentNode->nodeType = ExpressionNodeType::BOOLEAN;
+        currentNode.booleanValue = node.node_boolean_value();
+        currentNode.nodeType = ExpressionNodeType::BOOLEAN;
         mLogger.trace( "CollectionSchemeIngestion::serializeNode",
                        "Creating BOOLEAN node with value: " +
-                           std::to_string( static_cast<int>( currentNode->booleanValue ) ) );
-        return currentNode;
+                           std::to_string( static_cast<int>( currentNode.booleanValue ) ) );
+        return appendNode( currentNode );
+    }
+    else if ( node.node_case() == CollectionSchemesMsg::ConditionNode::kNodeRawFrameField )
+    {
+        const auto &rawFrameField = node.node_raw_frame_field();
+        currentNode.nodeType = ExpressionNodeType::RAWFRAMEFIELD;
+        currentNode.function.rawFrameField.interfaceID = rawFrameField.can_interface_id();
+        currentNode.function.rawFrameField.frameID = rawFrameField.can_message_id();
+        currentNode.function.rawFrameField.startBit = static_cast<uint16_t>( rawFrameField.start_bit() );
+        currentNode.function.rawFrameField.length = static_cast<uint16_t>( rawFrameField.length() );
+        currentNode.function.rawFrameField.isBigEndian = rawFrameField.is_big_endian();
+        currentNode.function.rawFrameField.isSigned = rawFrameField.is_signed();
+        // The frame has to be captured raw for the condition, but is only sent if the scheme collects it
+        auto collected = std::find_if( mCollectedRawCAN.begin(),
+                                       mCollectedRawCAN.end(),
+                                       [&rawFrameField]( const CanFrameCollectionInfo &frame ) {
+                                           return ( frame.frameID == rawFrameField.can_message_id() ) &&
+                                                  ( frame.interfaceID == rawFrameField.can_interface_id() );
+                                       } );
+        if ( collected == mCollectedRawCAN.end() )
+        {
+            CanFrameCollectionInfo rawCAN;
+            rawCAN.frameID = rawFrameField.can_message_id();
+            rawCAN.interfaceID = rawFrameField.can_interface_id();
+            rawCAN.sampleBufferSize = 1;
+            rawCAN.isConditionOnlyFrame = true;
+            mCollectedRawCAN.emplace_back( rawCAN );
+        }
+        mLogger.trace( "CollectionSchemeIngestion::serializeNode",
+                       "Creating RAWFRAMEFIELD node for frame ID: " + std::to_string( rawFrameField.can_message_id() ) +
+                           " start bit: " + std::to_string( rawFrameField.start_bit() ) +
+                           " length: " + std::to_string( rawFrameField.length() ) );
+        return appendNode( currentNode );
     }
     else if ( node.node_case() == CollectionSchemesMsg::ConditionNode::kNodeFunction )
     {
         if ( node.node_function().functionType_case() ==
              CollectionSchemesMsg::ConditionNode_NodeFunction::kWindowFunction )
         {
-            currentNode->signalID = node.node_function().window_function().signal_id();
-            currentNode->function.windowFunction =
+            currentNode.signalID = node.node_function().window_function().signal_id();
+            currentNode.function.windowFunction =
                 convertFunctionType( node.node_function().window_function().window_type() );
-            currentNode->nodeType = ExpressionNodeType::WINDOWFUNCTION;
+            currentNode.nodeType = ExpressionNodeType::WINDOWFUNCTION;
             mLogger.trace( "CollectionSchemeIngestion::serializeNode",
-                           "Creating Window FUNCTION node for Signal ID:" + std::to_string( currentNode->signalID ) );
-            return currentNode;
+                           "Creating Window FUNCTION node for Signal ID:" + std::to_string( currentNode.signalID ) );
+            return appendNode( currentNode );
         }
         else if ( node.node_function().functionType_case() ==
                   CollectionSchemesMsg::ConditionNode_NodeFunction::kGeohashFunction )
         {
-            currentNode->nodeType = ExpressionNodeType::GEOHASHFUNCTION; // geohash
-            currentNode->function.geohashFunction.latitudeSignalID =
+            currentNode.nodeType = ExpressionNodeType::GEOHASHFUNCTION; // geohash
+            currentNode.function.geohashFunction.latitudeSignalID =
                 node.node_function().geohash_function().latitude_signal_id();
-            currentNode->function.geohashFunction.longitudeSignalID =
+            currentNode.function.geohashFunction.longitudeSignalID =
                 node.node_function().geohash_function().longitude_signal_id();
-            currentNode->function.geohashFunction.precision =
+            currentNode.function.geohashFunction.precision =
                 static_cast<uint8_t>( node.node_function().geohash_function().geohash_precision() );
-            currentNode->function.geohashFunction.gpsUnitType =
+            currentNode.function.geohashFunction.gpsUnitType =
                 static_cast<GeohashFunction::GPSUnitType>( node.node_function().geohash_function().gps_unit() );
             mLogger.trace(
                 "CollectionSchemeIngestion::serializeNode",
                 "Creating Geohash FUNCTION node: Lat SignalID: " +
-                    std::to_string( currentNode->function.geohashFunction.latitudeSignalID ) +
-                    "; Lon SignalID: " + std::to_string( currentNode->function.geohashFunction.longitudeSignalID ) +
-                    "; precision: " + std::to_string( currentNode->function.geohashFunction.precision ) +
+                    std::to_string( currentNode.function.geohashFunction.latitudeSignalID ) +
+                    "; Lon SignalID: " + std::to_string( currentNode.function.geohashFunction.longitudeSignalID ) +
+                    "; precision: " + std::to_string( currentNode.function.geohashFunction.precision ) +
                     "; GPS Unit Type: " +
-                    std::to_string( static_cast<uint8_t>( currentNode->function.geohashFunction.gpsUnitType ) ) );
-            return currentNode;
+                    std::to_string( static_cast<uint8_t>( currentNode.function.geohashFunction.gpsUnitType ) ) );
+            return appendNode( currentNode );
+        }
+        else if ( node.node_function().functionType_case() ==
+                  CollectionSchemesMsg::ConditionNode_NodeFunction::kGeofenceFunction )
+        {
+            const auto &geofenceFunction = node.node_function().geofence_function();
+            currentNode.nodeType = ExpressionNodeType::GEOFENCEFUNCTION;
+            currentNode.function.geofenceFunction.latitudeSignalID = geofenceFunction.latitude_signal_id();
+            currentNode.function.geofenceFunction.longitudeSignalID = geofenceFunction.longitude_signal_id();
+            currentNode.function.geofenceFunction.gpsUnitType =
+                static_cast<GeohashFunction::GPSUnitType>( geofenceFunction.gps_unit() );
+            using GeofenceMsg = CollectionSchemesMsg::ConditionNode_NodeFunction_GeofenceFunction_Geofence;
+            auto geofences = std::make_shared<DataInspection::GeofenceIndex>();
+            for ( const auto &geofence : geofenceFunction.geofences() )
+            {
+                bool added = false;
+                if ( geofence.shape_case() == GeofenceMsg::kCircle )
+                {
+                    added = geofences->addCircle( geofence.circle().center().latitude(),
+                                                  geofence.circle().center().longitude(),
+                                                  geofence.circle().radius_meters() );
+                }
+                else if ( geofence.shape_case() == GeofenceMsg::kPolygon )
+                {
+                    std::vector<DataInspection::GeofenceIndex::Coordinate> vertices;
+                    for ( const auto &vertex : geofence.polygon().vertices() )
+                    {
+                        DataInspection::GeofenceIndex::Coordinate coordinate;
+                        coordinate.latitude = vertex.latitude();
+                        coordinate.longitude = vertex.longitude();
+                        vertices.push_back( coordinate );
+                    }
+                    added = geofences->addPolygon( vertices );
+                }
+                if ( !added )
+                {
+                    mLogger.warn( "CollectionSchemeIngestion::serializeNode", "Ignoring invalid geofence" );
+                }
+            }
+            geofences->build();
+            currentNode.function.geofenceFunction.geofences = geofences;
+            mLogger.trace(
+                "CollectionSchemeIngestion::serializeNode",
+                "Creating Geofence FUNCTION node: Lat SignalID: " +
+                    std::to_string( currentNode.function.geofenceFunction.latitudeSignalID ) +
+                    "; Lon SignalID: " + std::to_string( currentNode.function.geofenceFunction.longitudeSignalID ) +
+                    "; fences: " + std::to_string( geofences->size() ) );
+            return appendNode( currentNode );
         }
         else
         {
@@ -403,42 +701,57 @@ CollectionSchemeIngestion::serializeNode( const CollectionSchemesMsg::ConditionN
         if ( node.node_operator().has_left_child() )
         {
             mLogger.trace( "CollectionSchemeIngestion::serializeNode", "Processing left child" );
-            currentNode->nodeType = convertOperatorType( node.node_operator().operator_() );
+            currentNode.nodeType = convertOperatorType( node.node_operator().operator_() );
             // If no valid function found return always false
-            if ( currentNode->nodeType == ExpressionNodeType::BOOLEAN )
+            if ( currentNode.nodeType == ExpressionNodeType::BOOLEAN )
             {
                 mLogger.info( "CollectionSchemeIngestion::serializeNode", "Setting BOOLEAN node to false" );
-                currentNode->booleanValue = false;
-                return currentNode;
+                currentNode.booleanValue = false;
+                return appendNode( currentNode );
             }
-            ExpressionNode *left = serializeNode( node.node_operator().left_child(), nextIndex, remainingDepth - 1 );
-            currentNode->left = left;
+            ExpressionNode *left = serializeNode( node.node_operator().left_child(), remainingDepth - 1 );
+            currentNode.left = left;
             // Not operator is unary and has only left child
-            if ( currentNode->nodeType != ExpressionNodeType::OPERATOR_LOGICAL_NOT &&
+            if ( currentNode.nodeType != ExpressionNodeType::OPERATOR_LOGICAL_NOT &&
                  node.node_operator().has_right_child() )
             {
                 mLogger.trace( "CollectionSchemeIngestion::serializeNode", "Processing right child" );
-                ExpressionNode *right =
-                    serializeNode( node.node_operator().right_child(), nextIndex, remainingDepth - 1 );
-                currentNode->right = right;
+                ExpressionNode *right = serializeNode( node.node_operator().right_child(), remainingDepth - 1 );
+                currentNode.right = right;
             }
             else
             {
                 mLogger.trace( "CollectionSchemeIngestion::serializeNode", "Setting right child to nullptr" );
-                currentNode->right = nullptr;
+                currentNode.right = nullptr;
             }
-            return currentNode;
+            return appendNode( currentNode );
         }
     }
 
-    // if not returned until here its an invalid node so remove it from buffer
-    mExpressionNodes.pop_back();
+    // if not returned until here its an invalid node so it is not added to the arena
     return nullptr;
 }
 
+ExpressionNode *
+CollectionSchemeIngestion::appendNode( const ExpressionNode &node )
+{
+    // As pointers to elements inside the arena are used no realloc of the arena is allowed
+    if ( mExpressionNodes->size() >= mExpressionNodes->capacity() )
+    {
+        mLogger.error( "CollectionSchemeIngestion::appendNode", "Expression node arena exhausted" );
+        return nullptr;
+    }
+    mExpressionNodes->emplace_back( node );
+    return &mExpressionNodes->back();
+}
+
 const std::string &
 CollectionSchemeIngestion::getCollectionSchemeID() const
 {
+    if ( mBuildDeferred )
+    {
+        return mDeferredCollectionSchemeID;
+    }
     if ( !mReady )
     {
         return INVALID_COLLECTION_SCHEME_ID;
@@ -450,6 +763,10 @@ CollectionSchemeIngestion::getCollectionSchemeID() const
 const std::string &
 CollectionSchemeIngestion::getDecoderManifestID() const
 {
+    if ( mBuildDeferred )
+    {
+        return mDeferredDecoderManifestID;
+    }
     if ( !mReady )
     {
         return INVALID_DECODER_MANIFEST_ID;
@@ -461,6 +778,10 @@ CollectionSchemeIngestion::getDecoderManifestID() const
 uint64_t
 CollectionSchemeIngestion::getStartTime() const
 {
+    if ( mBuildDeferred )
+    {
+        return mDeferredStartTime;
+    }
     if ( !mReady )
     {
         return INVALID_COLLECTION_SCHEME_START_TIME;
@@ -472,6 +793,10 @@ CollectionSchemeIngestion::getStartTime() const
 uint64_t
 CollectionSchemeIngestion::getExpiryTime() const
 {
+    if ( mBuildDeferred )
+    {
+        return mDeferredExpiryTime;
+    }
     if ( !mReady )
     {
         return INVALID_COLLECTION_SCHEME_EXPIRY_TIME;
@@ -535,6 +860,58 @@ CollectionSchemeIngestion::isCompressionNeeded() const
     return mProtoCollectionSchemeMessagePtr->compress_collected_data();
 }
 
+DataInspection::CompressionCodecType
+CollectionSchemeIngestion::getCompressionCodec() const
+{
+    if ( !mReady )
+    {
+        return DataInspection::CompressionCodecType::SNAPPY;
+    }
+
+    switch ( mProtoCollectionSchemeMessagePtr->compression_codec() )
+    {
+    case CollectionSchemesMsg::CollectionScheme_CompressionCodec_LZ4:
+        return DataInspection::CompressionCodecType::LZ4;
+    case CollectionSchemesMsg::CollectionScheme_CompressionCodec_ZSTD:
+        return DataInspection::CompressionCodecType::ZSTD;
+    default:
+        return DataInspection::CompressionCodecType::SNAPPY;
+    }
+}
+
+bool
+CollectionSchemeIngestion::isRawCanLogNeeded() const
+{
+    if ( !mReady )
+    {
+        return false;
+    }
+
+    return mProtoCollectionSchemeMessagePtr->raw_can_log();
+}
+
+uint32_t
+CollectionSchemeIngestion::getConditionEvaluationIntervalMs() const
+{
+    if ( !mReady )
+    {
+        return 0;
+    }
+
+    return mProtoCollectionSchemeMessagePtr->condition_evaluation_interval_ms();
+}
+
+uint32_t
+CollectionSchemeIngestion::getConditionEvaluationBudgetUs() const
+{
+    if ( !mReady )
+    {
+        return 0;
+    }
+
+    return mProtoCollectionSchemeMessagePtr->condition_evaluation_budget_us();
+}
+
 uint32_t
 CollectionSchemeIngestion::getMinimumPublishIntervalMs() const
 {
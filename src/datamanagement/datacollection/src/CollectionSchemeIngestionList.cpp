@@ -100,9 +100,10 @@ CollectionSchemeIngestionList::build()
         return false;
     }
 
-    // Try to parse the binary data into our mProtoDecoderManifest member variable
-    if ( !mCollectionSchemeListMsg.ParseFromArray( mProtoBinaryData.data(),
-                                                   static_cast<int>( mProtoBinaryData.size() ) ) )
+    // Try to parse the binary data into a message that only lives during the build
+    CollectionSchemesMsg::CollectionSchemes collectionSchemeListMsg;
+    if ( !collectionSchemeListMsg.ParseFromArray( mProtoBinaryData.data(),
+                                                  static_cast<int>( mProtoBinaryData.size() ) ) )
     {
         // Error parsing proto binary
         mLogger.error( "CollectionSchemeIngestionList::build()", "Error parsing collectionSchemes.proto binary" );
@@ -112,22 +113,45 @@ CollectionSchemeIngestionList::build()
     // Ensure we start with an empty vector of collectionScheme pointers
     mVectorCollectionSchemePtr.clear();
 
+    // The collectionSchemes which start later are only built once they are enabled, as large scheduled lists
+    // would otherwise be built and held in memory long before they are needed
+    auto currentTime = mClock->timeSinceEpochMs();
+
+    // The expression nodes of all collectionSchemes built now are allocated from one arena, so it is sized upfront
+    // and never reallocated
+    uint32_t numberOfExpressionNodes = 0;
+    for ( const auto &collectionSchemeMsg : collectionSchemeListMsg.collection_schemes() )
+    {
+        if ( collectionSchemeMsg.start_time_ms_epoch() <= currentTime )
+        {
+            numberOfExpressionNodes += CollectionSchemeIngestion::getNumberOfExpressionNodes( collectionSchemeMsg );
+        }
+    }
+    auto expressionNodeArena = std::make_shared<ICollectionScheme::ExpressionNode_t>();
+    expressionNodeArena->reserve( numberOfExpressionNodes );
+
     // Iterate through all the collectionSchemes in the collectionScheme list, make a shared pointer of them
-    for ( int i = 0; i < mCollectionSchemeListMsg.collection_schemes_size(); i++ )
+    for ( int i = 0; i < collectionSchemeListMsg.collection_schemes_size(); i++ )
     {
         // Create a CollectionSchemeIngestion Pointer, or pICPPtr.
         auto pICPPtr = std::make_shared<CollectionSchemeIngestion>();
 
-        // Stuff the pointer with the collectionScheme proto message data
-        pICPPtr->copyData( std::make_shared<CollectionSchemesMsg::CollectionScheme>(
-            mCollectionSchemeListMsg.collection_schemes( i ) ) );
+        // Stuff the pointer with the collectionScheme proto message data. The message is moved out of the list
+        // instead of copied, so that the parsed document is not held twice in memory
+        auto collectionSchemeMsg = std::make_shared<CollectionSchemesMsg::CollectionScheme>();
+        collectionSchemeMsg->Swap( collectionSchemeListMsg.mutable_collection_schemes( i ) );
+        pICPPtr->copyData( collectionSchemeMsg );
 
         // Check to see if it successfully builds
-        if ( pICPPtr->build() )
+        auto arenaSize = expressionNodeArena->size();
+        bool built = ( collectionSchemeMsg->start_time_ms_epoch() > currentTime )
+                         ? pICPPtr->deferBuild()
+                         : pICPPtr->build( expressionNodeArena );
+        if ( built )
         {
             mLogger.trace( "CollectionSchemeIngestionList::build()",
                            "Adding CollectionScheme index: " + std::to_string( i ) + " of " +
-                               std::to_string( mCollectionSchemeListMsg.collection_schemes_size() ) );
+                               std::to_string( collectionSchemeListMsg.collection_schemes_size() ) );
 
             // Add this newly created shared pointer to the vector of ICollectionScheme shared pointers.
             // It is implicitly upcasted to its base pointer
@@ -137,6 +161,8 @@ CollectionSchemeIngestionList::build()
         {
             mLogger.error( "CollectionSchemeIngestionList::build()",
                            "CollectionScheme index: " + std::to_string( i ) + " failed to build. Dropping it. " );
+            // Release the nodes of the dropped collectionScheme, this does not move the nodes before them
+            expressionNodeArena->resize( arenaSize );
         }
     }
 
@@ -0,0 +1,367 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "CompressionCodec.h"
+#include <climits>
+#include <cstring>
+#include <snappy.h>
+#ifdef FWE_FEATURE_LZ4
+#include <lz4.h>
+#endif
+#ifdef FWE_FEATURE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataManagement
+{
+
+namespace
+{
+
+constexpr uint8_t HEADER_MAGIC[] = { 'F', 'W', 'C' };
+
+void
+writeUint32( uint8_t *out, uint32_t value )
+{
+    for ( size_t i = 0; i < sizeof( value ); i++ )
+    {
+        out[i] = static_cast<uint8_t>( value >> ( 8U * i ) );
+    }
+}
+
+uint32_t
+readUint32( const uint8_t *in )
+{
+    uint32_t value = 0;
+    for ( size_t i = 0; i < sizeof( value ); i++ )
+    {
+        value |= static_cast<uint32_t>( in[i] ) << ( 8U * i );
+    }
+    return value;
+}
+
+// Snappy raw format without header, as sent before the codec became selectable
+class SnappyCodec : public ICompressionCodec
+{
+public:
+    CompressionCodecType
+    getType() const override
+    {
+        return CompressionCodecType::SNAPPY;
+    }
+
+    bool
+    compress( const uint8_t *input, size_t size, std::vector<uint8_t> &out ) override
+    {
+        out.resize( snappy::MaxCompressedLength( size ) );
+        size_t compressedSize = 0;
+        snappy::RawCompress(
+            reinterpret_cast<const char *>( input ), size, reinterpret_cast<char *>( out.data() ), &compressedSize );
+        out.resize( compressedSize );
+        return compressedSize > 0U;
+    }
+
+    bool
+    decompress( const uint8_t *input, size_t size, std::vector<uint8_t> &out ) override
+    {
+        size_t uncompressedSize = 0;
+        if ( !snappy::GetUncompressedLength( reinterpret_cast<const char *>( input ), size, &uncompressedSize ) )
+        {
+            return false;
+        }
+        out.resize( uncompressedSize );
+        return snappy::RawUncompress(
+            reinterpret_cast<const char *>( input ), size, reinterpret_cast<char *>( out.data() ) );
+    }
+};
+
+#if defined( FWE_FEATURE_LZ4 ) || defined( FWE_FEATURE_ZSTD )
+// Reads the header of a payload compressed by the codec and checks the uncompressed size against the limit
+bool
+readHeader( const uint8_t *input,
+            size_t size,
+            CompressionCodecType codec,
+            uint32_t dictionaryID,
+            CompressedPayloadHeader &header )
+{
+    return header.read( input, size ) && ( header.codec == codec ) && ( header.dictionaryID == dictionaryID ) &&
+           ( header.uncompressedSize <= static_cast<uint32_t>( INT_MAX ) );
+}
+#endif
+
+#ifdef FWE_FEATURE_LZ4
+// LZ4 block format, the block does not store the uncompressed size so it is taken from the header
+class Lz4Codec : public ICompressionCodec
+{
+public:
+    CompressionCodecType
+    getType() const override
+    {
+        return CompressionCodecType::LZ4;
+    }
+
+    bool
+    compress( const uint8_t *input, size_t size, std::vector<uint8_t> &out ) override
+    {
+        if ( size > static_cast<size_t>( LZ4_MAX_INPUT_SIZE ) )
+        {
+            return false;
+        }
+        auto bound = LZ4_compressBound( static_cast<int>( size ) );
+        out.resize( CompressedPayloadHeader::SIZE + static_cast<size_t>( bound ) );
+        auto compressedSize = LZ4_compress_default( reinterpret_cast<const char *>( input ),
+                                                    reinterpret_cast<char *>( &out[CompressedPayloadHeader::SIZE] ),
+                                                    static_cast<int>( size ),
+                                                    bound );
+        if ( compressedSize <= 0 )
+        {
+            return false;
+        }
+        CompressedPayloadHeader header;
+        header.codec = CompressionCodecType::LZ4;
+        header.uncompressedSize = static_cast<uint32_t>( size );
+        header.write( out.data() );
+        out.resize( CompressedPayloadHeader::SIZE + static_cast<size_t>( compressedSize ) );
+        return true;
+    }
+
+    bool
+    decompress( const uint8_t *input, size_t size, std::vector<uint8_t> &out ) override
+    {
+        CompressedPayloadHeader header;
+        if ( ( !readHeader( input, size, CompressionCodecType::LZ4, 0, header ) ) ||
+             ( size - CompressedPayloadHeader::SIZE > static_cast<size_t>( INT_MAX ) ) )
+        {
+            return false;
+        }
+        out.resize( header.uncompressedSize );
+        auto uncompressedSize =
+            LZ4_decompress_safe( reinterpret_cast<const char *>( &input[CompressedPayloadHeader::SIZE] ),
+                                 reinterpret_cast<char *>( out.data() ),
+                                 static_cast<int>( size - CompressedPayloadHeader::SIZE ),
+                                 static_cast<int>( header.uncompressedSize ) );
+        return ( uncompressedSize >= 0 ) && ( static_cast<uint32_t>( uncompressedSize ) == header.uncompressedSize );
+    }
+};
+#endif
+
+#ifdef FWE_FEATURE_ZSTD
+// Typical payloads are a few KiB, where levels above the default gain little
+constexpr int ZSTD_DEFAULT_COMPRESSION_LEVEL = 3;
+
+// Zstandard frames, optionally with a dictionary that is digested once when the codec is created
+class ZstdCodec : public ICompressionCodec
+{
+public:
+    ZstdCodec( std::shared_ptr<const std::string> dictionary, int level )
+        : mDictionary( std::move( dictionary ) )
+        , mLevel( ( level != 0 ) ? level : ZSTD_DEFAULT_COMPRESSION_LEVEL )
+        , mCompressionContext( ZSTD_createCCtx(), &ZSTD_freeCCtx )
+        , mDecompressionContext( ZSTD_createDCtx(), &ZSTD_freeDCtx )
+        , mCompressionDictionary( nullptr, &ZSTD_freeCDict )
+        , mDecompressionDictionary( nullptr, &ZSTD_freeDDict )
+    {
+        if ( ( mDictionary != nullptr ) && ( !mDictionary->empty() ) )
+        {
+            mCompressionDictionary.reset(
+                ZSTD_createCDict( mDictionary->data(), mDictionary->size(), mLevel ) );
+            mDecompressionDictionary.reset( ZSTD_createDDict( mDictionary->data(), mDictionary->size() ) );
+            mDictionaryID = ZSTD_getDictID_fromDict( mDictionary->data(), mDictionary->size() );
+        }
+    }
+
+    bool
+    isValid() const
+    {
+        bool hasDictionary = ( mDictionary != nullptr ) && ( !mDictionary->empty() );
+        bool dictionaryLoaded = ( mCompressionDictionary != nullptr ) && ( mDecompressionDictionary != nullptr );
+        return ( mCompressionContext != nullptr ) && ( mDecompressionContext != nullptr ) &&
+               ( ( !hasDictionary ) || dictionaryLoaded );
+    }
+
+    CompressionCodecType
+    getType() const override
+    {
+        return CompressionCodecType::ZSTD;
+    }
+
+    bool
+    compress( const uint8_t *input, size_t size, std::vector<uint8_t> &out ) override
+    {
+        if ( size > UINT32_MAX )
+        {
+            return false;
+        }
+        auto bound = ZSTD_compressBound( size );
+        out.resize( CompressedPayloadHeader::SIZE + bound );
+        auto *dst = &out[CompressedPayloadHeader::SIZE];
+        auto compressedSize =
+            ( mCompressionDictionary != nullptr )
+                ? ZSTD_compress_usingCDict(
+                      mCompressionContext.get(), dst, bound, input, size, mCompressionDictionary.get() )
+                : ZSTD_compressCCtx( mCompressionContext.get(), dst, bound, input, size, mLevel );
+        if ( ZSTD_isError( compressedSize ) != 0U )
+        {
+            return false;
+        }
+        CompressedPayloadHeader header;
+        header.codec = CompressionCodecType::ZSTD;
+        header.dictionaryID = mDictionaryID;
+        header.uncompressedSize = static_cast<uint32_t>( size );
+        header.write( out.data() );
+        out.resize( CompressedPayloadHeader::SIZE + compressedSize );
+        return true;
+    }
+
+    bool
+    decompress( const uint8_t *input, size_t size, std::vector<uint8_t> &out ) override
+    {
+        CompressedPayloadHeader header;
+        if ( !readHeader( input, size, CompressionCodecType::ZSTD, mDictionaryID, header ) )
+        {
+            return false;
+        }
+        out.resize( header.uncompressedSize );
+        const auto *src = &input[CompressedPayloadHeader::SIZE];
+        auto srcSize = size - CompressedPayloadHeader::SIZE;
+        auto *context = mDecompressionContext.get();
+        auto uncompressedSize =
+            ( mDecompressionDictionary != nullptr )
+                ? ZSTD_decompress_usingDDict(
+                      context, out.data(), out.size(), src, srcSize, mDecompressionDictionary.get() )
+                : ZSTD_decompressDCtx( context, out.data(), out.size(), src, srcSize );
+        return ( ZSTD_isError( uncompressedSize ) == 0U ) && ( uncompressedSize == header.uncompressedSize );
+    }
+
+private:
+    std::shared_ptr<const std::string> mDictionary; // must outlive the digested dictionaries
+    int mLevel;
+    std::unique_ptr<ZSTD_CCtx, decltype( &ZSTD_freeCCtx )> mCompressionContext;
+    std::unique_ptr<ZSTD_DCtx, decltype( &ZSTD_freeDCtx )> mDecompressionContext;
+    std::unique_ptr<ZSTD_CDict, decltype( &ZSTD_freeCDict )> mCompressionDictionary;
+    std::unique_ptr<ZSTD_DDict, decltype( &ZSTD_freeDDict )> mDecompressionDictionary;
+    uint32_t mDictionaryID{ 0 };
+};
+#endif
+
+} // namespace
+
+void
+CompressedPayloadHeader::write( uint8_t *out ) const
+{
+    memcpy( out, HEADER_MAGIC, sizeof( HEADER_MAGIC ) );
+    out[3] = static_cast<uint8_t>( codec );
+    writeUint32( &out[4], dictionaryID );
+    writeUint32( &out[8], uncompressedSize );
+}
+
+bool
+CompressedPayloadHeader::read( const uint8_t *payload, size_t size )
+{
+    if ( ( payload == nullptr ) || ( size < SIZE ) || ( memcmp( payload, HEADER_MAGIC, sizeof( HEADER_MAGIC ) ) != 0 ) )
+    {
+        return false;
+    }
+    codec = static_cast<CompressionCodecType>( payload[3] );
+    dictionaryID = readUint32( &payload[4] );
+    uncompressedSize = readUint32( &payload[8] );
+    return true;
+}
+
+bool
+isCompressionCodecSupported( CompressionCodecType type )
+{
+    switch ( type )
+    {
+    case CompressionCodecType::SNAPPY:
+        return true;
+#ifdef FWE_FEATURE_LZ4
+    case CompressionCodecType::LZ4:
+        return true;
+#endif
+#ifdef FWE_FEATURE_ZSTD
+    case CompressionCodecType::ZSTD:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+std::unique_ptr<ICompressionCodec>
+createCompressionCodec( CompressionCodecType type, std::shared_ptr<const std::string> dictionary, int level )
+{
+    switch ( type )
+    {
+    case CompressionCodecType::SNAPPY:
+        return std::unique_ptr<ICompressionCodec>( new SnappyCodec() );
+#ifdef FWE_FEATURE_LZ4
+    case CompressionCodecType::LZ4:
+        return std::unique_ptr<ICompressionCodec>( new Lz4Codec() );
+#endif
+#ifdef FWE_FEATURE_ZSTD
+    case CompressionCodecType::ZSTD:
+    {
+        std::unique_ptr<ZstdCodec> codec( new ZstdCodec( std::move( dictionary ), level ) );
+        if ( !codec->isValid() )
+        {
+            return nullptr;
+        }
+        return std::unique_ptr<ICompressionCodec>( codec.release() );
+    }
+#endif
+    default:
+        static_cast<void>( dictionary );
+        static_cast<void>( level );
+        return nullptr;
+    }
+}
+
+const char *
+getCompressionCodecName( CompressionCodecType type )
+{
+    switch ( type )
+    {
+    case CompressionCodecType::SNAPPY:
+        return "snappy";
+    case CompressionCodecType::LZ4:
+        return "lz4";
+    case CompressionCodecType::ZSTD:
+        return "zstd";
+    default:
+        return "unknown";
+    }
+}
+
+bool
+getCompressionCodecType( const std::string &name, CompressionCodecType &type )
+{
+    for ( auto candidate : { CompressionCodecType::SNAPPY, CompressionCodecType::LZ4, CompressionCodecType::ZSTD } )
+    {
+        if ( name == getCompressionCodecName( candidate ) )
+        {
+            type = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace DataManagement
+} // namespace IoTFleetWise
+} // namespace Aws
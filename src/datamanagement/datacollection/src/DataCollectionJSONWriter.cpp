@@ -16,7 +16,6 @@
 #include <snappy.h>
 
 #include <fstream>
-#include <iostream>
 #include <sstream>
 
 namespace Aws
@@ -36,6 +35,8 @@ constexpr char COLLECTION_SCHEME_ARN_KEY[] = "collectionSchemeARN";
 constexpr char DECODER_ARN_KEY[] = "decoderARN";
 constexpr char COLLECTION_EVENT_ID_KEY[] = "collectionEventID";
 constexpr char COLLECTION_EVENT_TIME_KEY[] = "collectionEventTimeMSEpoch";
+constexpr char SHARED_EVENTS_KEY[] = "sharedEvents";
+constexpr char MESSAGES_KEY[] = "Messages";
 
 constexpr char PATH_SEP = '/';
 
@@ -44,53 +45,111 @@ constexpr char PATH_SEP = '/';
 DataCollectionJSONWriter::DataCollectionJSONWriter( std::string persistencyPath )
     : mPersistencyPath( std::move( persistencyPath ) )
 {
+    // Without an event the document only has the messages
+    beginDocument();
+    mWriter.key( MESSAGES_KEY );
+    mWriter.beginArray();
 }
 
 void
-DataCollectionJSONWriter::append( const CollectedCanRawFrame &msg )
+DataCollectionJSONWriter::beginDocument()
 {
-    Json::Value message;
-    message["CANFrame"]["messageID"] = (Json::UInt)msg.frameID;
-    message["CANFrame"]["nodeID"] = (Json::UInt)msg.channelId;
-    message["CANFrame"]["relativeTimeMS"] = ( Json::Int64 )( ( msg.receiveTime ) - mTriggerTime );
+    mWriter.clear();
+    mMessageCount = 0;
+    mDocumentClosed = false;
+    mWriter.beginObject();
+}
 
-    Json::Value signals( Json::arrayValue );
-    Json::Value signal;
+void
+DataCollectionJSONWriter::append( const CollectedCanRawFrame &msg )
+{
+    mWriter.beginObject();
+    mWriter.key( "CANFrame" );
+    mWriter.beginObject();
+    mWriter.member( "messageID", static_cast<uint32_t>( msg.frameID ) );
+    mWriter.member( "nodeID", static_cast<uint32_t>( msg.channelId ) );
+    mWriter.member( "relativeTimeMS", static_cast<int64_t>( msg.receiveTime - mTriggerTime ) );
+    mWriter.key( "byteValues" );
+    mWriter.beginArray();
     for ( size_t i = 0; i < msg.size; ++i )
     {
-        signal["CANFrame"]["byteValue"] = msg.data[i];
-        signals.append( signal );
+        mWriter.beginObject();
+        mWriter.key( "CANFrame" );
+        mWriter.beginObject();
+        mWriter.member( "byteValue", static_cast<uint32_t>( msg.data[i] ) );
+        mWriter.endObject();
+        mWriter.endObject();
     }
-    message["CANFrame"]["byteValues"] = signals;
-    mMessages.append( message );
+    mWriter.endArray();
+    mWriter.endObject();
+    mWriter.endObject();
+    mMessageCount++;
 }
 
 void
 DataCollectionJSONWriter::append( const CollectedSignal &msg )
 {
-    Json::Value message;
-    message["CapturedSignal"]["signalID"] = (Json::UInt)msg.signalID;
-    message["CapturedSignal"]["relativeTimeMS"] = ( Json::Int64 )( ( msg.receiveTime ) - mTriggerTime );
-    message["CapturedSignal"]["doubleValue"] = msg.value;
-    mMessages.append( message );
+    mWriter.beginObject();
+    mWriter.key( "CapturedSignal" );
+    mWriter.beginObject();
+    mWriter.member( "signalID", static_cast<uint32_t>( msg.signalID ) );
+    mWriter.member( "relativeTimeMS", static_cast<int64_t>( msg.receiveTime - mTriggerTime ) );
+    mWriter.member( "doubleValue", msg.value );
+    mWriter.endObject();
+    mWriter.endObject();
+    mMessageCount++;
+}
+
+void
+DataCollectionJSONWriter::append( const SignalSummary &summary )
+{
+    mWriter.beginObject();
+    mWriter.key( "SignalSummary" );
+    mWriter.beginObject();
+    mWriter.member( "signalID", static_cast<uint32_t>( summary.signalID ) );
+    mWriter.member( "relativeWindowStartMS", static_cast<int64_t>( summary.windowStartTime - mTriggerTime ) );
+    mWriter.member( "windowPeriodMS", static_cast<uint32_t>( summary.windowSizeMs ) );
+    mWriter.member( "count", static_cast<uint32_t>( summary.count ) );
+    mWriter.member( "min", summary.min );
+    mWriter.member( "max", summary.max );
+    mWriter.member( "mean", summary.mean );
+    mWriter.member( "variance", summary.variance );
+    mWriter.key( "histogramCounts" );
+    mWriter.beginArray();
+    for ( auto count : summary.histogramCounts )
+    {
+        mWriter.value( static_cast<uint32_t>( count ) );
+    }
+    mWriter.endArray();
+    mWriter.key( "percentileValues" );
+    mWriter.beginArray();
+    for ( auto value : summary.percentileValues )
+    {
+        mWriter.value( static_cast<double>( value ) );
+    }
+    mWriter.endArray();
+    mWriter.endObject();
+    mWriter.endObject();
+    mMessageCount++;
 }
 
 void
 DataCollectionJSONWriter::append( const GeohashInfo &geohashInfo )
 {
-    Json::Value message;
-    message["Geohash"] = geohashInfo.mGeohashString;
-    message["PrevReportedGeohash"] = geohashInfo.mPrevReportedGeohashString;
-    mMessages.append( message );
+    mWriter.beginObject();
+    mWriter.member( "Geohash", geohashInfo.mGeohashString );
+    mWriter.member( "PrevReportedGeohash", geohashInfo.mPrevReportedGeohashString );
+    mWriter.endObject();
+    mMessageCount++;
 }
 
 std::pair<boost::filesystem::path, bool>
 DataCollectionJSONWriter::flushToFile()
 {
     std::string eventId = "NoEventID";
-    if ( mEvent.isMember( EVENT_KEY ) && mEvent[EVENT_KEY].isMember( COLLECTION_EVENT_ID_KEY ) )
+    if ( mHasEvent )
     {
-        eventId = std::to_string( mEvent[EVENT_KEY][COLLECTION_EVENT_ID_KEY].asUInt() );
+        eventId = std::to_string( mCollectionEventID );
     }
 
     static constexpr char SEP = '-';
@@ -105,34 +164,35 @@ DataCollectionJSONWriter::flushToFile( const std::string &fileBaseName )
     constexpr char FUNC_NAME[] = "DataCollectionJSONWriter::flushToFile";
 
     mLogger.trace( FUNC_NAME, "Base file name: " + fileBaseName );
-    mEvent["Messages"] = mMessages;
-    Json::StreamWriterBuilder builder;
-    builder["commentStyle"] = "None";
-    builder["indentation"] = "   "; // or whatever you like
-    std::unique_ptr<Json::StreamWriter> writer( builder.newStreamWriter() );
-    std::ostringstream ss;
-    writer->write( mEvent, &ss );
-
-    auto data = ss.str();
-    std::string outData;
+    if ( !mDocumentClosed )
+    {
+        mWriter.endArray();
+        mWriter.endObject();
+        mDocumentClosed = true;
+    }
+
+    const auto &data = mWriter.str();
+    const char *outData = data.data();
+    size_t outSize = data.size();
     bool didCompress = false;
     if ( mShouldCompress )
     {
         mLogger.trace( FUNC_NAME, "File contents will be compressed" );
-        if ( snappy::Compress( data.data(), data.size(), &outData ) == 0u )
+        mCompressed.clear();
+        if ( snappy::Compress( data.data(), data.size(), &mCompressed ) == 0u )
         {
             mLogger.warn( FUNC_NAME, "Compression resulted in 0 bytes. Writing uncompressed file content" );
-            outData = std::move( data );
         }
         else
         {
+            outData = mCompressed.data();
+            outSize = mCompressed.size();
             didCompress = true;
         }
     }
     else
     {
         mLogger.trace( FUNC_NAME, "File contents will be uncompressed" );
-        outData = std::move( data );
     }
 
     auto fileCloser = []( std::ofstream *fs ) { fs->close(); };
@@ -142,7 +202,7 @@ DataCollectionJSONWriter::flushToFile( const std::string &fileBaseName )
     const std::string fileExt = didCompress ? SNAPPY_FILE_EXT : JSON_FILE_EXT;
     const auto fileNameWithExt = mPersistencyPath + PATH_SEP + fileBaseName + fileExt;
     ofs.open( fileNameWithExt, std::ios::out | std::ios::binary );
-    ofs.write( outData.c_str(), static_cast<std::streamsize>( outData.size() ) );
+    ofs.write( outData, static_cast<std::streamsize>( outSize ) );
     mLogger.trace( FUNC_NAME, "File write completed. File: " + fileNameWithExt );
 
     return std::make_pair( boost::filesystem::path( fileNameWithExt ), didCompress );
@@ -152,12 +212,33 @@ void
 DataCollectionJSONWriter::setupEvent( const TriggeredCollectionSchemeDataPtr triggeredCollectionSchemeData,
                                       uint32_t collectionEventID )
 {
-    mEvent.clear();
-    mMessages.clear();
-    mEvent[EVENT_KEY][COLLECTION_SCHEME_ARN_KEY] = triggeredCollectionSchemeData->metaData.collectionSchemeID;
-    mEvent[EVENT_KEY][DECODER_ARN_KEY] = triggeredCollectionSchemeData->metaData.decoderID;
-    mEvent[EVENT_KEY][COLLECTION_EVENT_ID_KEY] = (Json::UInt)collectionEventID;
-    mEvent[EVENT_KEY][COLLECTION_EVENT_TIME_KEY] = ( Json::UInt64 )( triggeredCollectionSchemeData->triggerTime );
+    beginDocument();
+    mWriter.key( EVENT_KEY );
+    mWriter.beginObject();
+    mWriter.member( COLLECTION_SCHEME_ARN_KEY, triggeredCollectionSchemeData->metaData.collectionSchemeID.str() );
+    mWriter.member( DECODER_ARN_KEY, triggeredCollectionSchemeData->metaData.decoderID.str() );
+    mWriter.member( COLLECTION_EVENT_ID_KEY, collectionEventID );
+    mWriter.member( COLLECTION_EVENT_TIME_KEY, static_cast<uint64_t>( triggeredCollectionSchemeData->triggerTime ) );
+    if ( !triggeredCollectionSchemeData->sharedEvents.empty() )
+    {
+        mWriter.key( SHARED_EVENTS_KEY );
+        mWriter.beginArray();
+        for ( const auto &sharedEvent : triggeredCollectionSchemeData->sharedEvents )
+        {
+            mWriter.beginObject();
+            mWriter.member( COLLECTION_SCHEME_ARN_KEY, sharedEvent.collectionSchemeID.str() );
+            mWriter.member( COLLECTION_EVENT_ID_KEY, static_cast<uint32_t>( sharedEvent.eventID ) );
+            mWriter.member( COLLECTION_EVENT_TIME_KEY, static_cast<uint64_t>( sharedEvent.triggerTime ) );
+            mWriter.endObject();
+        }
+        mWriter.endArray();
+    }
+    mWriter.endObject();
+    // The messages are appended to the open array until the event is flushed
+    mWriter.key( MESSAGES_KEY );
+    mWriter.beginArray();
+    mHasEvent = true;
+    mCollectionEventID = collectionEventID;
     mTriggerTime = triggeredCollectionSchemeData->triggerTime;
     mShouldCompress = triggeredCollectionSchemeData->metaData.compress;
 }
@@ -165,7 +246,7 @@ DataCollectionJSONWriter::setupEvent( const TriggeredCollectionSchemeDataPtr tri
 unsigned
 DataCollectionJSONWriter::getJSONMessageCount() const
 {
-    return mMessages.size();
+    return mMessageCount;
 }
 
 } // namespace DataManagement
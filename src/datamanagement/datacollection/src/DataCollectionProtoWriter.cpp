@@ -13,6 +13,14 @@
 
 // Includes
 #include "DataCollectionProtoWriter.h"
+#include "TraceModule.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <climits>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include <google/protobuf/wire_format_lite.h>
 
 // Refer to the following for definitions of significand and exponent:
 // https://en.wikipedia.org/wiki/Double-precision_floating-point_format
@@ -21,6 +29,8 @@
 #define DBL_SIGNIFICAND_FULL_BITS ( DBL_SIGNIFICAND_BITS + 1U ) // Including 'hidden' 53rd bit
 #define DBL_EXPONENT_BITS 11U
 #define DBL_EXPONENT_MASK ( ( 1U << DBL_EXPONENT_BITS ) - 1U )
+// Integers up to this magnitude are exact in a double
+#define DBL_MAX_EXACT_INTEGER ( 1LL << DBL_SIGNIFICAND_FULL_BITS )
 
 namespace Aws
 {
@@ -31,8 +41,10 @@ namespace DataManagement
 
 DataCollectionProtoWriter::DataCollectionProtoWriter( CANInterfaceIDTranslator &canIDTranslator )
     : mTriggerTime( 0U )
+    , mArenaBlock( INITIAL_ARENA_BLOCK_SIZE )
     , mIDTranslator( canIDTranslator )
 {
+    resetArena();
 }
 
 DataCollectionProtoWriter::~DataCollectionProtoWriter()
@@ -97,64 +109,314 @@ DataCollectionProtoWriter::convertToPeculiarFloat( double physicalValue, uint32_
     divisor = 1U << ( ( UINT32_WIDTH - 1U ) - static_cast<unsigned>( exponent ) );
 }
 
+void
+DataCollectionProtoWriter::resetArena()
+{
+    // Only the blocks allocated in addition to the owned block are freed on reset. If the last payload needed
+    // them, the owned block is grown to the high-water mark so that the next payloads fit into it.
+    if ( ( mArena == nullptr ) || ( mArena->SpaceAllocated() > mArenaBlock.size() ) )
+    {
+        if ( mArena != nullptr )
+        {
+            auto highWaterMark = static_cast<size_t>( mArena->SpaceAllocated() );
+            mArena.reset();
+            mArenaBlock.resize( highWaterMark );
+        }
+        google::protobuf::ArenaOptions options;
+        options.initial_block = mArenaBlock.data();
+        options.initial_block_size = mArenaBlock.size();
+        mArena.reset( new google::protobuf::Arena( options ) );
+    }
+    else
+    {
+        mArena->Reset();
+    }
+    mVehicleData = google::protobuf::Arena::CreateMessage<VehicleDataMsg::VehicleData>( mArena.get() );
+}
+
+bool
+DataCollectionProtoWriter::setPayloadFormatVersion( uint32_t version )
+{
+    if ( ( version != PAYLOAD_FORMAT_SAMPLES ) && ( version != PAYLOAD_FORMAT_COLUMNS ) )
+    {
+        return false;
+    }
+    mNextPayloadFormatVersion = version;
+    return true;
+}
+
 void
 DataCollectionProtoWriter::setupVehicleData( const TriggeredCollectionSchemeDataPtr triggeredCollectionSchemeData,
                                              uint32_t collectionEventID )
 {
     mVehicleDataMsgCount = 0U;
+    mPayloadFormatVersion = mNextPayloadFormatVersion;
+    mSignalColumnCount = 0;
+    mSignalColumnIndices.clear();
+    mCanFrameColumnCount = 0;
+    mCanFrameColumnIndices.clear();
+    mRawCanLog = triggeredCollectionSchemeData->metaData.rawCanLog;
+    mUploadResolutions = triggeredCollectionSchemeData->metaData.uploadResolutions;
+    mRawCanLogFrames.clear();
+    mRawCanLogPreviousTimeUs = static_cast<int64_t>( triggeredCollectionSchemeData->triggerTime ) * 1000;
+    mRawCanLogChannels.clear();
+    mRawCanLogChannelIndices.clear();
 
-    mVehicleData.Clear();
-    mVehicleData.set_campaign_arn( triggeredCollectionSchemeData->metaData.collectionSchemeID );
-    mVehicleData.set_decoder_arn( triggeredCollectionSchemeData->metaData.decoderID );
-    mVehicleData.set_collection_event_id( collectionEventID );
+    resetArena();
+    mVehicleData->set_campaign_arn( triggeredCollectionSchemeData->metaData.collectionSchemeID.str() );
+    mVehicleData->set_decoder_arn( triggeredCollectionSchemeData->metaData.decoderID.str() );
+    mVehicleData->set_collection_event_id( collectionEventID );
     mTriggerTime = triggeredCollectionSchemeData->triggerTime;
-    mVehicleData.set_collection_event_time_ms_epoch( mTriggerTime );
+    mVehicleData->set_collection_event_time_ms_epoch( mTriggerTime );
+    mVehicleData->set_payload_format_version( mPayloadFormatVersion );
+    for ( const auto &sharedEvent : triggeredCollectionSchemeData->sharedEvents )
+    {
+        auto *event = mVehicleData->add_shared_collection_events();
+        event->set_campaign_arn( sharedEvent.collectionSchemeID.str() );
+        event->set_collection_event_id( sharedEvent.eventID );
+        event->set_collection_event_time_ms_epoch( sharedEvent.triggerTime );
+        for ( auto signalID : sharedEvent.signalIDs )
+        {
+            event->add_signal_ids( signalID );
+        }
+        for ( auto canFrameID : sharedEvent.canFrameIDs )
+        {
+            event->add_can_message_ids( canFrameID );
+        }
+    }
+    mEstimatedSize = mVehicleData->ByteSizeLong();
+}
+
+double
+DataCollectionProtoWriter::getUploadResolution( SignalID signalID ) const
+{
+    if ( mUploadResolutions == nullptr )
+    {
+        return 0.0;
+    }
+    auto it = mUploadResolutions->find( signalID );
+    return ( it == mUploadResolutions->end() ) ? 0.0 : it->second;
 }
+
+void
+DataCollectionProtoWriter::addMessageSize( size_t size )
+{
+    // One byte for the tag as all field numbers of VehicleData are below 16
+    mEstimatedSize += 1U + google::protobuf::io::CodedOutputStream::VarintSize64( size ) + size;
+}
+
+size_t
+DataCollectionProtoWriter::getTimeSize( const std::vector<int64_t> &relativeTimesMs,
+                                        int64_t relativeTimeMs,
+                                        uint32_t fraction )
+{
+    auto delta = relativeTimesMs.empty() ? relativeTimeMs : ( relativeTimeMs - relativeTimesMs.back() );
+    // The fractions are only written if any is not 0, counting them always keeps the estimate an upper bound
+    return google::protobuf::io::CodedOutputStream::VarintSize64(
+               google::protobuf::internal::WireFormatLite::ZigZagEncode64( delta ) ) +
+           google::protobuf::io::CodedOutputStream::VarintSize32( fraction );
+}
+
 void
 DataCollectionProtoWriter::append( const CollectedSignal &msg )
 {
-    auto capturedSignals = mVehicleData.add_captured_signals();
     mVehicleDataMsgCount++;
+    if ( mPayloadFormatVersion == PAYLOAD_FORMAT_COLUMNS )
+    {
+        auto inserted = mSignalColumnIndices.emplace( msg.signalID, mSignalColumnCount );
+        if ( inserted.second )
+        {
+            if ( mSignalColumnCount == mSignalColumns.size() )
+            {
+                mSignalColumns.emplace_back();
+            }
+            auto &newColumn = mSignalColumns[mSignalColumnCount];
+            newColumn.mSignalID = msg.signalID;
+            newColumn.mResolution = getUploadResolution( msg.signalID );
+            newColumn.mRelativeTimesMs.clear();
+            newColumn.mTimeFractionsUs.clear();
+            newColumn.mValues.clear();
+            mSignalColumnCount++;
+            mEstimatedSize += COLUMN_OVERHEAD_SIZE;
+        }
+        auto &column = mSignalColumns[inserted.first->second];
+        auto relativeTime = static_cast<int64_t>( msg.receiveTime ) - static_cast<int64_t>( mTriggerTime );
+        mEstimatedSize +=
+            getTimeSize( column.mRelativeTimesMs, relativeTime, msg.receiveTimeFractionUs ) + sizeof( double );
+        column.mRelativeTimesMs.push_back( relativeTime );
+        column.mTimeFractionsUs.push_back( msg.receiveTimeFractionUs );
+        column.mValues.push_back( ( column.mResolution > 0.0 ) ? std::round( msg.value / column.mResolution )
+                                                                : msg.value );
+        return;
+    }
+    auto resolution = getUploadResolution( msg.signalID );
+    auto capturedSignals = mVehicleData->add_captured_signals();
     capturedSignals->set_relative_time_ms( static_cast<int64_t>( msg.receiveTime ) -
                                            static_cast<int64_t>( mTriggerTime ) );
+    // Not serialized if 0, so the payload only grows for interfaces with microsecond timestamps
+    capturedSignals->set_relative_time_us_fraction( msg.receiveTimeFractionUs );
     capturedSignals->set_signal_id( msg.signalID );
-    capturedSignals->set_double_value( msg.value );
+    // Rounding clears the noise in the low bits of the mantissa, so the payload compresses better
+    capturedSignals->set_double_value( ( resolution > 0.0 ) ? ( std::round( msg.value / resolution ) * resolution )
+                                                            : msg.value );
+    addMessageSize( capturedSignals->ByteSizeLong() );
+}
+
+void
+DataCollectionProtoWriter::appendRawCanLogVarint( uint64_t value )
+{
+    // A varint carries 7 bits per byte
+    std::array<uint8_t, 10> buffer;
+    auto *end = google::protobuf::io::CodedOutputStream::WriteVarint64ToArray( value, buffer.data() );
+    mRawCanLogFrames.append( reinterpret_cast<char const *>( buffer.data() ),
+                             static_cast<size_t>( end - buffer.data() ) );
 }
 
 void
 DataCollectionProtoWriter::append( const CollectedCanRawFrame &msg )
 {
-    auto rawCanFrames = mVehicleData.add_can_frames();
     mVehicleDataMsgCount++;
+    if ( mRawCanLog )
+    {
+        if ( mRawCanLogFrames.empty() )
+        {
+            mEstimatedSize += COLUMN_OVERHEAD_SIZE;
+        }
+        auto inserted =
+            mRawCanLogChannelIndices.emplace( msg.channelId, static_cast<uint32_t>( mRawCanLogChannels.size() ) );
+        if ( inserted.second )
+        {
+            mRawCanLogChannels.push_back( msg.channelId );
+            addMessageSize( mIDTranslator.getInterfaceID( msg.channelId ).size() );
+        }
+        auto timeUs = ( static_cast<int64_t>( msg.receiveTime ) * 1000 ) + msg.receiveTimeFractionUs;
+        auto sizeBefore = mRawCanLogFrames.size();
+        // Frames of different channels may be pushed slightly out of order, so the delta can be negative
+        appendRawCanLogVarint(
+            google::protobuf::internal::WireFormatLite::ZigZagEncode64( timeUs - mRawCanLogPreviousTimeUs ) );
+        mRawCanLogPreviousTimeUs = timeUs;
+        appendRawCanLogVarint( inserted.first->second );
+        appendRawCanLogVarint( msg.frameID );
+        mRawCanLogFrames.push_back( static_cast<char>( msg.size ) );
+        mRawCanLogFrames.append( reinterpret_cast<char const *>( msg.data.data() ), msg.size );
+        mEstimatedSize += mRawCanLogFrames.size() - sizeBefore;
+        return;
+    }
+    if ( mPayloadFormatVersion == PAYLOAD_FORMAT_COLUMNS )
+    {
+        auto key = ( static_cast<uint64_t>( msg.channelId ) << 32U ) | msg.frameID;
+        auto inserted = mCanFrameColumnIndices.emplace( key, mCanFrameColumnCount );
+        if ( inserted.second )
+        {
+            if ( mCanFrameColumnCount == mCanFrameColumns.size() )
+            {
+                mCanFrameColumns.emplace_back();
+            }
+            auto &newColumn = mCanFrameColumns[mCanFrameColumnCount];
+            newColumn.mFrameID = msg.frameID;
+            newColumn.mChannelID = msg.channelId;
+            newColumn.mRelativeTimesMs.clear();
+            newColumn.mTimeFractionsUs.clear();
+            newColumn.mSizes.clear();
+            newColumn.mBytes.clear();
+            mCanFrameColumnCount++;
+            mEstimatedSize += COLUMN_OVERHEAD_SIZE;
+        }
+        auto &column = mCanFrameColumns[inserted.first->second];
+        auto relativeTime = static_cast<int64_t>( msg.receiveTime ) - static_cast<int64_t>( mTriggerTime );
+        mEstimatedSize += getTimeSize( column.mRelativeTimesMs, relativeTime, msg.receiveTimeFractionUs ) +
+                          google::protobuf::io::CodedOutputStream::VarintSize32( msg.size ) + msg.size;
+        column.mRelativeTimesMs.push_back( relativeTime );
+        column.mTimeFractionsUs.push_back( msg.receiveTimeFractionUs );
+        column.mSizes.push_back( msg.size );
+        column.mBytes.append( reinterpret_cast<char const *>( msg.data.data() ), msg.size );
+        return;
+    }
+    auto rawCanFrames = mVehicleData->add_can_frames();
     rawCanFrames->set_relative_time_ms( static_cast<int64_t>( msg.receiveTime ) -
                                         static_cast<int64_t>( mTriggerTime ) );
+    rawCanFrames->set_relative_time_us_fraction( msg.receiveTimeFractionUs );
     rawCanFrames->set_message_id( msg.frameID );
     rawCanFrames->set_interface_id( mIDTranslator.getInterfaceID( msg.channelId ) );
     rawCanFrames->set_byte_values( reinterpret_cast<char const *>( msg.data.data() ), msg.size );
+    addMessageSize( rawCanFrames->ByteSizeLong() );
+}
+
+void
+DataCollectionProtoWriter::setPayloadPart( uint32_t part, uint32_t partCount )
+{
+    mVehicleData->set_payload_part( part );
+    mVehicleData->set_payload_part_count( partCount );
+}
+
+void
+DataCollectionProtoWriter::appendPayloadPartCount( std::vector<uint8_t> &serialized, uint32_t partCount )
+{
+    // Fields may be serialized in any order and a partCount of 0 is not serialized at all, so the appended field
+    // parses the same as if it had been set before serializing. The tag and the count are varints of at most 5 bytes.
+    std::array<uint8_t, 10> buffer;
+    auto *end = google::protobuf::io::CodedOutputStream::WriteVarint32ToArray(
+        google::protobuf::internal::WireFormatLite::MakeTag(
+            VehicleDataMsg::VehicleData::kPayloadPartCountFieldNumber,
+            google::protobuf::internal::WireFormatLite::WIRETYPE_VARINT ),
+        buffer.data() );
+    end = google::protobuf::io::CodedOutputStream::WriteVarint32ToArray( partCount, end );
+    serialized.insert( serialized.end(), buffer.data(), end );
 }
 
 void
 DataCollectionProtoWriter::setupDTCInfo( const DTCInfo &msg )
 {
-    auto dtcData = mVehicleData.mutable_dtc_data();
+    auto dtcData = mVehicleData->mutable_dtc_data();
     dtcData->set_relative_time_ms( static_cast<int64_t>( msg.receiveTime ) - static_cast<int64_t>( mTriggerTime ) );
+    dtcData->set_sequence_number( msg.mSequenceNumber );
+    dtcData->set_unchanged( msg.mIsUnchanged );
+    addMessageSize( dtcData->ByteSizeLong() );
 }
 
 void
 DataCollectionProtoWriter::append( const std::string &dtc )
 {
-    auto dtcData = mVehicleData.mutable_dtc_data();
+    auto dtcData = mVehicleData->mutable_dtc_data();
     mVehicleDataMsgCount++;
+    // Growing the length of the DTC message by a byte every 128 bytes of codes is not counted
     dtcData->add_active_dtc_codes( dtc );
+    mEstimatedSize += 1U + google::protobuf::io::CodedOutputStream::VarintSize64( dtc.size() ) + dtc.size();
+}
+
+void
+DataCollectionProtoWriter::append( const SignalSummary &summary )
+{
+    auto *summaryProto = mVehicleData->add_signal_summaries();
+    mVehicleDataMsgCount++;
+    summaryProto->set_signal_id( summary.signalID );
+    summaryProto->set_relative_window_start_ms( static_cast<int64_t>( summary.windowStartTime ) -
+                                                static_cast<int64_t>( mTriggerTime ) );
+    summaryProto->set_window_period_ms( summary.windowSizeMs );
+    summaryProto->set_count( summary.count );
+    summaryProto->set_min( summary.min );
+    summaryProto->set_max( summary.max );
+    summaryProto->set_mean( summary.mean );
+    summaryProto->set_variance( summary.variance );
+    for ( auto count : summary.histogramCounts )
+    {
+        summaryProto->add_histogram_counts( count );
+    }
+    for ( auto value : summary.percentileValues )
+    {
+        summaryProto->add_percentile_values( value );
+    }
+    addMessageSize( summaryProto->ByteSizeLong() );
 }
 
 void
 DataCollectionProtoWriter::append( const GeohashInfo &geohashInfo )
 {
-    auto geohashProto = mVehicleData.mutable_geohash();
+    auto geohashProto = mVehicleData->mutable_geohash();
     mVehicleDataMsgCount++;
     geohashProto->set_geohash_string( geohashInfo.mGeohashString );
     geohashProto->set_prev_reported_geohash_string( geohashInfo.mPrevReportedGeohashString );
+    addMessageSize( geohashProto->ByteSizeLong() );
 }
 
 unsigned
@@ -163,10 +425,168 @@ DataCollectionProtoWriter::getVehicleDataMsgCount() const
     return mVehicleDataMsgCount;
 }
 
+template <typename Column>
+void
+DataCollectionProtoWriter::writeTimes( const std::vector<int64_t> &relativeTimesMs,
+                                       const std::vector<uint32_t> &timeFractionsUs,
+                                       Column &out )
+{
+    int64_t previousTime = 0;
+    for ( auto relativeTime : relativeTimesMs )
+    {
+        out.add_relative_time_ms_deltas( relativeTime - previousTime );
+        previousTime = relativeTime;
+    }
+    if ( std::any_of( timeFractionsUs.begin(), timeFractionsUs.end(), []( uint32_t f ) { return f != 0; } ) )
+    {
+        for ( auto fraction : timeFractionsUs )
+        {
+            out.add_relative_time_us_fractions( fraction );
+        }
+    }
+}
+
+void
+DataCollectionProtoWriter::writeSignalColumn( const SignalColumnData &column, VehicleDataMsg::SignalColumn &out )
+{
+    out.set_signal_id( column.mSignalID );
+    writeTimes( column.mRelativeTimesMs, column.mTimeFractionsUs, out );
+    // -0.0 is not an integer and NaN is neither an integer nor exact as float
+    bool allIntegers = std::all_of( column.mValues.begin(), column.mValues.end(), []( double value ) {
+        return ( std::fabs( value ) <= static_cast<double>( DBL_MAX_EXACT_INTEGER ) ) &&
+               ( std::trunc( value ) == value ) && ( !std::signbit( value ) || ( value != 0.0 ) );
+    } );
+    if ( allIntegers )
+    {
+        // The multiples of the resolution are sent, which are small integers with small deltas
+        out.set_value_resolution( column.mResolution );
+        int64_t previousValue = 0;
+        for ( auto value : column.mValues )
+        {
+            auto integerValue = static_cast<int64_t>( value );
+            out.add_integer_value_deltas( integerValue - previousValue );
+            previousValue = integerValue;
+        }
+        return;
+    }
+    auto getValue = [&column]( double value ) {
+        return ( column.mResolution > 0.0 ) ? ( value * column.mResolution ) : value;
+    };
+    bool allFloats = std::all_of( column.mValues.begin(), column.mValues.end(), [&getValue]( double value ) {
+        return static_cast<double>( static_cast<float>( getValue( value ) ) ) == getValue( value );
+    } );
+    for ( auto rawValue : column.mValues )
+    {
+        auto value = getValue( rawValue );
+        if ( allFloats )
+        {
+            out.add_float_values( static_cast<float>( value ) );
+        }
+        else
+        {
+            out.add_double_values( value );
+        }
+    }
+}
+
+void
+DataCollectionProtoWriter::writeColumns()
+{
+    mVehicleData->clear_signal_columns();
+    for ( size_t i = 0; i < mSignalColumnCount; i++ )
+    {
+        writeSignalColumn( mSignalColumns[i], *mVehicleData->add_signal_columns() );
+    }
+    mVehicleData->clear_can_frame_columns();
+    for ( size_t i = 0; i < mCanFrameColumnCount; i++ )
+    {
+        const auto &column = mCanFrameColumns[i];
+        auto out = mVehicleData->add_can_frame_columns();
+        out->set_message_id( column.mFrameID );
+        out->set_interface_id( mIDTranslator.getInterfaceID( column.mChannelID ) );
+        writeTimes( column.mRelativeTimesMs, column.mTimeFractionsUs, *out );
+        for ( auto size : column.mSizes )
+        {
+            out->add_frame_sizes( size );
+        }
+        out->set_byte_values( column.mBytes );
+    }
+}
+
+void
+DataCollectionProtoWriter::writeRawCanLog()
+{
+    if ( mRawCanLogFrames.empty() )
+    {
+        return;
+    }
+    auto rawCanLog = mVehicleData->mutable_raw_can_log();
+    rawCanLog->clear_interface_ids();
+    for ( auto channel : mRawCanLogChannels )
+    {
+        rawCanLog->add_interface_ids( mIDTranslator.getInterfaceID( channel ) );
+    }
+    rawCanLog->set_frames( mRawCanLogFrames );
+}
+
 bool
-DataCollectionProtoWriter::serializeVehicleData( std::string *out ) const
+DataCollectionProtoWriter::serializeVehicleData( std::string *out )
+{
+    // Payloads are serialized rarely enough to time every one
+    TraceScopedTimer serializeTimer( TraceHistogram::PROTO_SERIALIZE_NS, 1 );
+    if ( mPayloadFormatVersion == PAYLOAD_FORMAT_COLUMNS )
+    {
+        writeColumns();
+    }
+    writeRawCanLog();
+    return mVehicleData->SerializeToString( out );
+}
+
+bool
+DataCollectionProtoWriter::serializeVehicleData( std::vector<uint8_t> &out )
+{
+    TraceScopedTimer serializeTimer( TraceHistogram::PROTO_SERIALIZE_NS, 1 );
+    if ( mPayloadFormatVersion == PAYLOAD_FORMAT_COLUMNS )
+    {
+        writeColumns();
+    }
+    writeRawCanLog();
+    auto size = mVehicleData->ByteSizeLong();
+    if ( size > static_cast<size_t>( INT_MAX ) )
+    {
+        return false;
+    }
+    out.resize( size );
+    google::protobuf::io::ArrayOutputStream stream( out.data(), static_cast<int>( size ) );
+    google::protobuf::io::CodedOutputStream codedStream( &stream );
+    // The sizes were cached by ByteSizeLong above
+    mVehicleData->SerializeWithCachedSizes( &codedStream );
+    return !codedStream.HadError();
+}
+
+size_t
+DataCollectionProtoWriter::getAggregatedVehicleDataSize( size_t payloadSize )
+{
+    return google::protobuf::internal::WireFormatLite::TagSize(
+               VehicleDataMsg::VehicleData::kAggregatedVehicleDataFieldNumber,
+               google::protobuf::internal::WireFormatLite::TYPE_MESSAGE ) +
+           google::protobuf::io::CodedOutputStream::VarintSize32( static_cast<uint32_t>( payloadSize ) ) + payloadSize;
+}
+
+void
+DataCollectionProtoWriter::appendAggregatedVehicleData( std::vector<uint8_t> &aggregate,
+                                                        const std::vector<uint8_t> &payload )
 {
-    return mVehicleData.SerializeToString( out );
+    auto offset = aggregate.size();
+    aggregate.resize( offset + getAggregatedVehicleDataSize( payload.size() ) );
+    auto *out = google::protobuf::io::CodedOutputStream::WriteVarint32ToArray(
+        google::protobuf::internal::WireFormatLite::MakeTag(
+            VehicleDataMsg::VehicleData::kAggregatedVehicleDataFieldNumber,
+            google::protobuf::internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED ),
+        &aggregate[offset] );
+    out = google::protobuf::io::CodedOutputStream::WriteVarint32ToArray( static_cast<uint32_t>( payload.size() ),
+                                                                        out );
+    std::copy( payload.begin(), payload.end(), out );
 }
 
 } // namespace DataManagement
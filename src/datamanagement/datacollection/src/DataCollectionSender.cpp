@@ -13,8 +13,12 @@
 
 // Includes
 #include "DataCollectionSender.h"
+#include "LatencyTracer.h"
+#include "TraceModule.h"
+#include "UplinkAccounting.h"
+#include <algorithm>
 #include <boost/filesystem.hpp>
-#include <snappy.h>
+#include <limits>
 #include <sstream>
 
 namespace Aws
@@ -34,10 +38,16 @@ DataCollectionSender::DataCollectionSender( std::shared_ptr<ISender> sender,
     , mProtoWriter( canIDTranslator )
     , mJsonWriter( std::move( persistencyPath ) )
 {
-    mTransmitThreshold = ( maxMessageCount > 0U ) ? maxMessageCount : UINT_MAX;
+    setMaxMessageCount( maxMessageCount );
     mCollectionEventID = 0U;
 }
 
+void
+DataCollectionSender::setMaxMessageCount( unsigned maxMessageCount )
+{
+    mTransmitThreshold.store( ( maxMessageCount > 0U ) ? maxMessageCount : UINT_MAX, std::memory_order_relaxed );
+}
+
 void
 DataCollectionSender::send( const TriggeredCollectionSchemeDataPtr triggeredCollectionSchemeDataPtr )
 {
@@ -51,6 +61,11 @@ DataCollectionSender::send( const TriggeredCollectionSchemeDataPtr triggeredColl
     mCollectionEventID = triggeredCollectionSchemeDataPtr->eventID;
 
     setCollectionSchemeParameters( triggeredCollectionSchemeDataPtr );
+    mPayloadParts.clear();
+    // While the connection is known to be down, the payloads of the trigger are stored with one write instead of
+    // failing to publish each of them
+    mPersistOffline = mCollectionSchemeParams.persist && ( mSendDestination == SendDestination::MQTT ) &&
+                      ( !mSender->isAlive() );
 
     if ( mJsonOutputEnabled )
     {
@@ -64,15 +79,29 @@ DataCollectionSender::send( const TriggeredCollectionSchemeDataPtr triggeredColl
 
     // Iterate through all the signals and add to the protobuf
     for ( const auto &signal : triggeredCollectionSchemeDataPtr->signals )
+    {
+        appendSignal( signal, triggeredCollectionSchemeDataPtr );
+    }
+    // The snapshots are read directly from the chunks of the inspection engine
+    for ( const auto &snapshot : triggeredCollectionSchemeDataPtr->signalSnapshots )
+    {
+        for ( uint32_t i = 0; i < snapshot.sampleCount; i++ )
+        {
+            appendSignal( snapshot.getSample( i ), triggeredCollectionSchemeDataPtr );
+        }
+    }
+
+    // Iterate through all the raw CAN frames and add to the protobuf
+    for ( const auto &canFrame : triggeredCollectionSchemeDataPtr->canFrames )
     {
         if ( mJsonOutputEnabled )
         {
-            mJsonWriter.append( signal );
+            mJsonWriter.append( canFrame );
         }
         if ( mSendDestination == SendDestination::MQTT )
         {
-            mProtoWriter.append( signal );
-            if ( mProtoWriter.getVehicleDataMsgCount() >= mTransmitThreshold )
+            mProtoWriter.append( canFrame );
+            if ( isPayloadFull() )
             {
                 serializeAndTransmit();
                 // Setup the next payload chunk
@@ -81,17 +110,17 @@ DataCollectionSender::send( const TriggeredCollectionSchemeDataPtr triggeredColl
         }
     }
 
-    // Iterate through all the raw CAN frames and add to the protobuf
-    for ( const auto &canFrame : triggeredCollectionSchemeDataPtr->canFrames )
+    // Aggregated signals only send the summaries of their windows
+    for ( const auto &summary : triggeredCollectionSchemeDataPtr->signalSummaries )
     {
         if ( mJsonOutputEnabled )
         {
-            mJsonWriter.append( canFrame );
+            mJsonWriter.append( summary );
         }
         if ( mSendDestination == SendDestination::MQTT )
         {
-            mProtoWriter.append( canFrame );
-            if ( mProtoWriter.getVehicleDataMsgCount() >= mTransmitThreshold )
+            mProtoWriter.append( summary );
+            if ( isPayloadFull() )
             {
                 serializeAndTransmit();
                 // Setup the next payload chunk
@@ -113,7 +142,7 @@ DataCollectionSender::send( const TriggeredCollectionSchemeDataPtr triggeredColl
             {
                 mProtoWriter.append( dtc );
 
-                if ( mProtoWriter.getVehicleDataMsgCount() >= mTransmitThreshold )
+                if ( isPayloadFull() )
                 {
                     serializeAndTransmit();
                     // Setup the next payload chunk
@@ -135,7 +164,7 @@ DataCollectionSender::send( const TriggeredCollectionSchemeDataPtr triggeredColl
         if ( mSendDestination == SendDestination::MQTT )
         {
             mProtoWriter.append( triggeredCollectionSchemeDataPtr->mGeohashInfo );
-            if ( mProtoWriter.getVehicleDataMsgCount() >= mTransmitThreshold )
+            if ( isPayloadFull() )
             {
                 serializeAndTransmit();
                 // Setup the next payload chunk
@@ -156,13 +185,242 @@ DataCollectionSender::send( const TriggeredCollectionSchemeDataPtr triggeredColl
             mLogger.trace( "DataCollectionSender::send",
                            "The data collection snapshot has been written on disk and is now scheduled for upload to "
                            "AWS IoT Core" );
+            serializeAndTransmit( true );
+        }
+        else if ( !mPayloadParts.empty() )
+        {
+            // The last message filled the last payload, so no empty payload is sent to tell the number of parts
+            queuePayloadParts( static_cast<uint32_t>( mPayloadParts.size() ) );
+        }
+        if ( mPersistOffline )
+        {
+            persistOfflineBatch();
+        }
+        sendLiveBatch();
+    }
+}
+
+bool
+DataCollectionSender::setTargetFillRatio( double ratio )
+{
+    if ( ( ratio <= 0.0 ) || ( ratio > 1.0 ) )
+    {
+        return false;
+    }
+    mTargetFillRatio = ratio;
+    return true;
+}
+
+bool
+DataCollectionSender::setAggregationClasses( std::vector<PayloadAggregationClass> classes )
+{
+    for ( const auto &aggregationClass : classes )
+    {
+        if ( ( aggregationClass.maxBytes == 0U ) || ( aggregationClass.maxDelayMs == 0U ) )
+        {
+            return false;
+        }
+    }
+    std::sort(
+        classes.begin(), classes.end(), []( const PayloadAggregationClass &a, const PayloadAggregationClass &b ) {
+            return a.maxPriority < b.maxPriority;
+        } );
+    // Aggregates of the previous classes are sent as they were
+    flushAggregates( true );
+    mAggregationClasses = std::move( classes );
+    return true;
+}
+
+bool
+DataCollectionSender::setAdaptiveCompression( const AdaptiveCompressionConfig &config )
+{
+    if ( !AdaptiveCompressionController::isValid( config ) )
+    {
+        return false;
+    }
+    mAdaptiveCompression = std::make_unique<AdaptiveCompressionController>( config );
+    return true;
+}
+
+uint32_t
+DataCollectionSender::flushAggregates( bool all )
+{
+    auto now = FastClock::monotonicTimeMs();
+    Timestamp nextDeadline = std::numeric_limits<Timestamp>::max();
+    for ( auto aggregate = mAggregates.begin(); aggregate != mAggregates.end(); )
+    {
+        if ( all || ( aggregate->mDeadline <= now ) )
+        {
+            transmitAggregate( *aggregate );
+            aggregate = mAggregates.erase( aggregate );
+        }
+        else
+        {
+            nextDeadline = std::min( nextDeadline, aggregate->mDeadline );
+            aggregate++;
+        }
+    }
+    if ( mAggregates.empty() )
+    {
+        return 0;
+    }
+    return static_cast<uint32_t>( nextDeadline - now );
+}
+
+bool
+DataCollectionSender::aggregatePayload( PayloadBufferPtr &payload )
+{
+    auto aggregationClass =
+        std::find_if( mAggregationClasses.begin(), mAggregationClasses.end(), [this]( const PayloadAggregationClass &c ) {
+            return c.maxPriority >= mCollectionSchemeParams.priority;
+        } );
+    if ( aggregationClass == mAggregationClasses.end() )
+    {
+        return false;
+    }
+    auto maxBytes = std::min( static_cast<double>( aggregationClass->maxBytes ), getTargetPayloadSize() );
+    if ( static_cast<double>( payload->size() ) >= maxBytes )
+    {
+        return false;
+    }
+    auto classIndex = static_cast<size_t>( aggregationClass - mAggregationClasses.begin() );
+    auto codec = mCollectionSchemeParams.compression ? mCodec : nullptr;
+    auto aggregate = std::find_if( mAggregates.begin(), mAggregates.end(), [&]( const PayloadAggregate &a ) {
+        return ( a.mClassIndex == classIndex ) &&
+               ( a.mCollectionSchemeParams.persist == mCollectionSchemeParams.persist ) &&
+               ( a.mCollectionSchemeParams.compression == mCollectionSchemeParams.compression ) &&
+               ( a.mCodec == codec );
+    } );
+    if ( ( aggregate != mAggregates.end() ) &&
+         ( static_cast<double>( aggregate->mPayload->size() +
+                                DataCollectionProtoWriter::getAggregatedVehicleDataSize( payload->size() ) ) >
+           maxBytes ) )
+    {
+        // The payload does not fit anymore, it starts the next aggregate
+        transmitAggregate( *aggregate );
+        mAggregates.erase( aggregate );
+        aggregate = mAggregates.end();
+    }
+    if ( aggregate == mAggregates.end() )
+    {
+        PayloadAggregate newAggregate;
+        newAggregate.mClassIndex = classIndex;
+        newAggregate.mCollectionSchemeParams = mCollectionSchemeParams;
+        newAggregate.mCodec = codec;
+        newAggregate.mPayload = std::move( payload );
+        newAggregate.mDeadline = FastClock::monotonicTimeMs() + aggregationClass->maxDelayMs;
+        newAggregate.mAccountBytes.emplace_back( mCollectionSchemeParams.accountId, newAggregate.mPayload->size() );
+        mAggregates.emplace_back( std::move( newAggregate ) );
+        return true;
+    }
+    DataCollectionProtoWriter::appendAggregatedVehicleData( *aggregate->mPayload, *payload );
+    auto accountBytes = std::find_if(
+        aggregate->mAccountBytes.begin(),
+        aggregate->mAccountBytes.end(),
+        [this]( const std::pair<uint32_t, size_t> &a ) { return a.first == mCollectionSchemeParams.accountId; } );
+    if ( accountBytes == aggregate->mAccountBytes.end() )
+    {
+        aggregate->mAccountBytes.emplace_back( mCollectionSchemeParams.accountId, payload->size() );
+    }
+    else
+    {
+        accountBytes->second += payload->size();
+    }
+    // The aggregate is sent with the most important priority of its payloads
+    aggregate->mCollectionSchemeParams.priority =
+        std::min( aggregate->mCollectionSchemeParams.priority, mCollectionSchemeParams.priority );
+    // Only one trace is followed per publish
+    if ( aggregate->mCollectionSchemeParams.traceId == 0U )
+    {
+        aggregate->mCollectionSchemeParams.traceId = mCollectionSchemeParams.traceId;
+    }
+    if ( static_cast<double>( aggregate->mPayload->size() ) >= maxBytes )
+    {
+        transmitAggregate( *aggregate );
+        mAggregates.erase( aggregate );
+    }
+    return true;
+}
+
+void
+DataCollectionSender::transmitAggregate( PayloadAggregate &aggregate )
+{
+    // The compressed, published and persisted bytes of an aggregate are not split between its collection schemes
+    auto mainAccount = std::max_element(
+        aggregate.mAccountBytes.begin(),
+        aggregate.mAccountBytes.end(),
+        []( const std::pair<uint32_t, size_t> &a, const std::pair<uint32_t, size_t> &b ) {
+            return a.second < b.second;
+        } );
+    if ( mainAccount != aggregate.mAccountBytes.end() )
+    {
+        aggregate.mCollectionSchemeParams.accountId = mainAccount->first;
+    }
+    auto res = transmit( std::move( aggregate.mPayload ), aggregate.mCollectionSchemeParams, aggregate.mCodec );
+    if ( res != ConnectivityError::Success )
+    {
+        mLogger.error( "DataCollectionSender::transmitAggregate",
+                       "offboardconnectivity error while transmitting data" +
+                           std::to_string( static_cast<int>( res ) ) );
+    }
+}
+
+double
+DataCollectionSender::getTargetPayloadSize() const
+{
+    auto maxSendSize = mSender->getMaxSendSize();
+    if ( maxSendSize == 0U )
+    {
+        return std::numeric_limits<double>::max();
+    }
+    auto targetSize = static_cast<double>( maxSendSize ) * mTargetFillRatio;
+    if ( mCollectionSchemeParams.compression )
+    {
+        targetSize /= mCompressionRatio;
+    }
+    return targetSize;
+}
+
+bool
+DataCollectionSender::isPayloadFull() const
+{
+    if ( mProtoWriter.getVehicleDataMsgCount() >= mTransmitThreshold.load( std::memory_order_relaxed ) )
+    {
+        return true;
+    }
+    return static_cast<double>( mProtoWriter.getEstimatedSize() ) >= getTargetPayloadSize();
+}
+
+void
+DataCollectionSender::appendSignal( const CollectedSignal &signal,
+                                    const TriggeredCollectionSchemeDataPtr &triggeredCollectionSchemeDataPtr )
+{
+    if ( mJsonOutputEnabled )
+    {
+        mJsonWriter.append( signal );
+    }
+    if ( mSendDestination == SendDestination::MQTT )
+    {
+        mProtoWriter.append( signal );
+        if ( isPayloadFull() )
+        {
             serializeAndTransmit();
+            // Setup the next payload chunk
+            mProtoWriter.setupVehicleData( triggeredCollectionSchemeDataPtr, mCollectionEventID );
         }
     }
 }
 
 ConnectivityError
-DataCollectionSender::transmit()
+DataCollectionSender::transmit( PayloadBufferPtr payload )
+{
+    return transmit( std::move( payload ), mCollectionSchemeParams, mCodec );
+}
+
+ConnectivityError
+DataCollectionSender::transmit( PayloadBufferPtr payload,
+                                const CollectionSchemeParams &collectionSchemeParams,
+                                const std::shared_ptr<ICompressionCodec> &codec )
 {
     if ( mSendDestination != SendDestination::MQTT )
     {
@@ -171,38 +429,129 @@ DataCollectionSender::transmit()
         return ConnectivityError::Success;
     }
 
-    std::string payloadData;
+    if ( !compressPayload( payload, collectionSchemeParams, codec ) )
+    {
+        return ConnectivityError::WrongInputData;
+    }
+
+    auto payloadSize = payload->size();
+    ConnectivityError ret = mSender->sendBuffer( std::move( payload ), collectionSchemeParams );
+    if ( ret != ConnectivityError::Success )
+    {
+        mLogger.error( "DataCollectionSender::transmit",
+                       "Failed to send vehicle data proto with error: " + std::to_string( static_cast<int>( ret ) ) );
+    }
+    else
+    {
+        TraceModule::get().addToAtomicVariable( TraceAtomicVariable::UPLOADED_LIVE_BYTES, payloadSize );
+        mLogger.info( "DataCollectionSender::transmit", [&]() {
+            return "A Payload of size: " + std::to_string( payloadSize ) + " bytes has been unloaded to AWS IoT Core";
+        } );
+    }
+    return ret;
+}
+
+bool
+DataCollectionSender::compressPayload( PayloadBufferPtr &payload,
+                                       const CollectionSchemeParams &collectionSchemeParams,
+                                       const std::shared_ptr<ICompressionCodec> &codec )
+{
     // compress the data before transmitting if specified in the collectionScheme
-    if ( mCollectionSchemeParams.compression )
+    if ( ( !collectionSchemeParams.compression ) || ( codec == nullptr ) )
     {
-        mLogger.trace( "DataCollectionSender::transmit",
-                       "Compress the payload before transmitting since compression flag is true" );
-        if ( snappy::Compress( mProtoOutput.data(), mProtoOutput.size(), &payloadData ) == 0u )
+        UplinkAccounting::get().add(
+            collectionSchemeParams.accountId, UplinkCounter::COMPRESSED_BYTES, payload->size() );
+        return true;
+    }
+    mLogger.trace( "DataCollectionSender::compressPayload",
+                   []() { return "Compress the payload before transmitting since compression flag is true"; } );
+    auto compressed = mPayloadBufferPool.acquire();
+    bool compressedSuccessfully = false;
+    {
+        TraceScopedTimer compressionTimer( TraceHistogram::COMPRESSION_NS, 1 );
+        compressedSuccessfully = codec->compress( payload->data(), payload->size(), *compressed );
+    }
+    if ( !compressedSuccessfully )
+    {
+        mLogger.trace( "DataCollectionSender::compressPayload", "Error in compressing the payload" );
+        return false;
+    }
+    // Aggregates compressed with a previous codec do not tell the ratio of the current one
+    if ( ( !payload->empty() ) && ( codec == mCodec ) )
+    {
+        auto ratio = static_cast<double>( compressed->size() ) / static_cast<double>( payload->size() );
+        mCompressionRatio =
+            ( COMPRESSION_RATIO_SMOOTHING * ratio ) + ( ( 1.0 - COMPRESSION_RATIO_SMOOTHING ) * mCompressionRatio );
+    }
+    UplinkAccounting::get().add(
+        collectionSchemeParams.accountId, UplinkCounter::COMPRESSED_BYTES, compressed->size() );
+    // The uncompressed buffer goes back to the pool
+    payload = std::move( compressed );
+    return true;
+}
+
+void
+DataCollectionSender::persistOfflineBatch()
+{
+    mPersistOffline = false;
+    if ( mOfflineBatch.empty() )
+    {
+        return;
+    }
+    auto res = mSender->persistBuffers( mOfflineBatch, mCollectionSchemeParams );
+    if ( res == ConnectivityError::NotConfigured )
+    {
+        // The sender has no persistency of its own, so the payloads take the regular way
+        for ( auto &payload : mOfflineBatch )
         {
-            mLogger.trace( "DataCollectionSender::transmit", "Error in compressing the payload" );
-            return ConnectivityError::WrongInputData;
+            res = mSender->sendBuffer( std::move( payload ), mCollectionSchemeParams );
         }
     }
+    else if ( res != ConnectivityError::Success )
+    {
+        mLogger.error( "DataCollectionSender::persistOfflineBatch",
+                       "Failed to persist " + std::to_string( mOfflineBatch.size() ) +
+                           " payloads with error: " + std::to_string( static_cast<int>( res ) ) );
+    }
     else
     {
-        // Using payloadData as a container to send(), hence assign it to original uncompressed payload
-        payloadData = mProtoOutput;
+        mLogger.info( "DataCollectionSender::persistOfflineBatch", [&]() {
+            return "No connection, " + std::to_string( mOfflineBatch.size() ) + " payloads persisted for later upload";
+        } );
     }
+    // The buffers go back to the pool
+    mOfflineBatch.clear();
+}
 
-    ConnectivityError ret = mSender->send(
-        reinterpret_cast<const uint8_t *>( payloadData.data() ), payloadData.size(), mCollectionSchemeParams );
-    if ( ret != ConnectivityError::Success )
+void
+DataCollectionSender::sendLiveBatch()
+{
+    if ( mLiveBatch.empty() )
     {
-        mLogger.error( "DataCollectionSender::transmit",
-                       "Failed to send vehicle data proto with error: " + std::to_string( static_cast<int>( ret ) ) );
+        return;
+    }
+    size_t batchSize = 0;
+    for ( const auto &item : mLiveBatch )
+    {
+        batchSize += item.segments.front()->size();
+    }
+    auto res = mSender->sendBatch( mLiveBatch );
+    if ( res != ConnectivityError::Success )
+    {
+        mLogger.error( "DataCollectionSender::sendLiveBatch",
+                       "Failed to send " + std::to_string( mLiveBatch.size() ) +
+                           " payloads with error: " + std::to_string( static_cast<int>( res ) ) );
     }
     else
     {
-        mLogger.info( "DataCollectionSender::transmit",
-                      "A Payload of size: " + std::to_string( payloadData.length() ) +
-                          " bytes has been unloaded to AWS IoT Core" );
+        TraceModule::get().addToAtomicVariable( TraceAtomicVariable::UPLOADED_LIVE_BYTES, batchSize );
+        mLogger.info( "DataCollectionSender::sendLiveBatch", [&]() {
+            return "A batch of " + std::to_string( mLiveBatch.size() ) + " payloads with " +
+                   std::to_string( batchSize ) + " bytes has been unloaded to AWS IoT Core";
+        } );
     }
-    return ret;
+    // The buffers go back to the pool once the sender released them
+    mLiveBatch.clear();
 }
 
 ConnectivityError
@@ -224,8 +573,32 @@ DataCollectionSender::transmit( const std::string &payload )
     return res;
 }
 
+ConnectivityError
+DataCollectionSender::transmitPersisted( PayloadBufferPtr payload )
+{
+    if ( mSendDestination != SendDestination::MQTT )
+    {
+        mLogger.trace( "DataCollectionSender::transmitPersisted",
+                       "Upload destination is not  set to AWS IoT Core. Skipping this request" );
+        return ConnectivityError::WrongInputData;
+    }
+
+    auto payloadSize = ( payload != nullptr ) ? payload->size() : 0;
+    auto res = mSender->sendBuffer( std::move( payload ) );
+    if ( res != ConnectivityError::Success )
+    {
+        mLogger.error( "DataCollectionSender::transmitPersisted",
+                       "offboardconnectivity error " + std::to_string( static_cast<int>( res ) ) );
+    }
+    else
+    {
+        TraceModule::get().addToAtomicVariable( TraceAtomicVariable::UPLOADED_PERSISTED_BYTES, payloadSize );
+    }
+    return res;
+}
+
 void
-DataCollectionSender::serializeAndTransmit()
+DataCollectionSender::serializeAndTransmit( bool lastPayload )
 {
     if ( mSendDestination != SendDestination::MQTT )
     {
@@ -234,15 +607,70 @@ DataCollectionSender::serializeAndTransmit()
         return;
     }
 
-    // Note: a class member is used to store the serialized proto output to avoid heap fragmentation
-    if ( !mProtoWriter.serializeVehicleData( &mProtoOutput ) )
+    // The parts are numbered so that the cloud can reassemble a trigger whose payloads were partly persisted. Their
+    // number is only known with the last one and is added to the others before they are compressed.
+    auto partIndex = static_cast<uint32_t>( mPayloadParts.size() );
+    if ( !lastPayload )
+    {
+        mProtoWriter.setPayloadPart( partIndex, 0 );
+    }
+    else if ( partIndex > 0U )
+    {
+        mProtoWriter.setPayloadPart( partIndex, partIndex + 1U );
+    }
+
+    // Note: pooled buffers are used to store the serialized proto output to avoid heap fragmentation
+    auto payload = mPayloadBufferPool.acquire();
+    if ( !mProtoWriter.serializeVehicleData( *payload ) )
     {
         mLogger.error( "DataCollectionSender::serializeAndTransmit", "serialization failed" );
+        return;
+    }
+    LatencyTracer::get().mark( mCollectionSchemeParams.traceId, LatencyStage::SERIALIZE );
+    UplinkAccounting::get().add( mCollectionSchemeParams.accountId, UplinkCounter::SERIALIZED_BYTES, payload->size() );
+    if ( !lastPayload )
+    {
+        mPayloadParts.emplace_back( std::move( payload ) );
+        return;
+    }
+    if ( partIndex > 0U )
+    {
+        queuePayloadParts( partIndex + 1U );
+    }
+    if ( mPersistOffline )
+    {
+        // Neither aggregated nor published, all payloads of the trigger are persisted together at the end of send()
+        if ( compressPayload( payload, mCollectionSchemeParams, mCodec ) )
+        {
+            mOfflineBatch.emplace_back( std::move( payload ) );
+        }
+        else
+        {
+            mLogger.error( "DataCollectionSender::serializeAndTransmit", "Failed to compress the payload" );
+        }
+    }
+    else if ( aggregatePayload( payload ) )
+    {
+        mLogger.trace( "DataCollectionSender::serializeAndTransmit", []() { return "Payload added to an aggregate"; } );
+    }
+    else if ( !mLiveBatch.empty() )
+    {
+        // The payloads of a trigger with more than one payload are sent as one batch at the end of send()
+        if ( compressPayload( payload, mCollectionSchemeParams, mCodec ) )
+        {
+            mLiveBatch.emplace_back();
+            mLiveBatch.back().segments.emplace_back( std::move( payload ) );
+            mLiveBatch.back().collectionSchemeParams = mCollectionSchemeParams;
+        }
+        else
+        {
+            mLogger.error( "DataCollectionSender::serializeAndTransmit", "Failed to compress the payload" );
+        }
     }
     else
     {
         // transmit the data to the cloud
-        auto res = transmit();
+        auto res = transmit( std::move( payload ) );
         if ( res != ConnectivityError::Success )
         {
             mLogger.error( "DataCollectionSender::serializeAndTransmit",
@@ -250,6 +678,32 @@ DataCollectionSender::serializeAndTransmit()
                                std::to_string( static_cast<int>( res ) ) );
         }
     }
+    // Changed before the next payload is filled, as its size depends on the compression ratio of the codec
+    adaptCodec();
+}
+
+void
+DataCollectionSender::queuePayloadParts( uint32_t partCount )
+{
+    for ( auto &payload : mPayloadParts )
+    {
+        DataCollectionProtoWriter::appendPayloadPartCount( *payload, partCount );
+        if ( !compressPayload( payload, mCollectionSchemeParams, mCodec ) )
+        {
+            mLogger.error( "DataCollectionSender::queuePayloadParts", "Failed to compress the payload" );
+        }
+        else if ( mPersistOffline )
+        {
+            mOfflineBatch.emplace_back( std::move( payload ) );
+        }
+        else
+        {
+            mLiveBatch.emplace_back();
+            mLiveBatch.back().segments.emplace_back( std::move( payload ) );
+            mLiveBatch.back().collectionSchemeParams = mCollectionSchemeParams;
+        }
+    }
+    mPayloadParts.clear();
 }
 
 void
@@ -259,6 +713,70 @@ DataCollectionSender::setCollectionSchemeParameters(
     mCollectionSchemeParams.persist = triggeredCollectionSchemeDataPtr->metaData.persist;
     mCollectionSchemeParams.compression = triggeredCollectionSchemeDataPtr->metaData.compress;
     mCollectionSchemeParams.priority = triggeredCollectionSchemeDataPtr->metaData.priority;
+    mCollectionSchemeParams.express = triggeredCollectionSchemeDataPtr->metaData.express;
+    mCollectionSchemeParams.traceId = triggeredCollectionSchemeDataPtr->traceId;
+    mCollectionSchemeParams.accountId =
+        UplinkAccounting::get().getAccountId( triggeredCollectionSchemeDataPtr->metaData.collectionSchemeID );
+    if ( mCollectionSchemeParams.compression )
+    {
+        selectCodec( triggeredCollectionSchemeDataPtr->metaData );
+    }
+}
+
+void
+DataCollectionSender::selectCodec( const PassThroughMetaData &metaData )
+{
+    mSchemeDictionary =
+        ( metaData.compressionCodec == CompressionCodecType::ZSTD ) ? metaData.compressionDictionary : nullptr;
+    if ( mAdaptiveCompression != nullptr )
+    {
+        adaptCodec();
+        return;
+    }
+    useCodec( metaData.compressionCodec, mSchemeDictionary, 0 );
+}
+
+void
+DataCollectionSender::adaptCodec()
+{
+    if ( ( mAdaptiveCompression == nullptr ) || ( !mCollectionSchemeParams.compression ) )
+    {
+        return;
+    }
+    auto setting = mAdaptiveCompression->select();
+    useCodec( setting.codec,
+              ( setting.codec == CompressionCodecType::ZSTD ) ? mSchemeDictionary : nullptr,
+              setting.level );
+}
+
+void
+DataCollectionSender::useCodec( CompressionCodecType type, std::shared_ptr<const std::string> dictionary, int level )
+{
+    // Compared with the requested codec, so that a fallback is not retried for every payload
+    if ( ( mCodec != nullptr ) && ( mRequestedCodec == type ) && ( mCodecDictionary == dictionary ) &&
+         ( mCodecLevel == level ) )
+    {
+        return;
+    }
+    mRequestedCodec = type;
+    mCodecDictionary = dictionary;
+    mCodecLevel = level;
+    // The ratio observed with the previous codec does not apply
+    mCompressionRatio = 1.0;
+    if ( !isCompressionCodecSupported( type ) )
+    {
+        mLogger.warn( "DataCollectionSender::selectCodec",
+                      "Compression codec " + std::to_string( static_cast<int>( type ) ) +
+                          " is not supported, using snappy" );
+        mCodec = createCompressionCodec( CompressionCodecType::SNAPPY );
+        return;
+    }
+    mCodec = createCompressionCodec( type, std::move( dictionary ), level );
+    if ( mCodec == nullptr )
+    {
+        mLogger.warn( "DataCollectionSender::selectCodec", "Failed to load the compression dictionary, using snappy" );
+        mCodec = createCompressionCodec( CompressionCodecType::SNAPPY );
+    }
 }
 
 uint32_t
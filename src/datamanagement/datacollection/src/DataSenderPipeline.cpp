@@ -0,0 +1,236 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "DataSenderPipeline.h"
+#include <algorithm>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataManagement
+{
+
+DataSenderPipeline::PublishQueue::PublishQueue( std::shared_ptr<ISender> sender,
+                                                std::vector<SendPriorityLevel> priorityLevels,
+                                                size_t queueSize )
+    : mSender( std::move( sender ) )
+    , mQueue( std::move( priorityLevels ), queueSize )
+{
+}
+
+bool
+DataSenderPipeline::PublishQueue::isAlive()
+{
+    return mSender->isAlive();
+}
+
+size_t
+DataSenderPipeline::PublishQueue::getMaxSendSize() const
+{
+    return mSender->getMaxSendSize();
+}
+
+ConnectivityError
+DataSenderPipeline::PublishQueue::send( const std::uint8_t *buf,
+                                        size_t size,
+                                        struct CollectionSchemeParams collectionSchemeParams )
+{
+    if ( ( buf == nullptr ) || ( size == 0U ) )
+    {
+        return ConnectivityError::WrongInputData;
+    }
+    auto buffer = mPayloadBufferPool.acquire();
+    buffer->assign( buf, buf + size );
+    return sendBuffer( std::move( buffer ), collectionSchemeParams );
+}
+
+ConnectivityError
+DataSenderPipeline::PublishQueue::sendBuffer( PayloadBufferPtr buffer,
+                                              struct CollectionSchemeParams collectionSchemeParams )
+{
+    if ( ( buffer == nullptr ) || buffer->empty() )
+    {
+        return ConnectivityError::WrongInputData;
+    }
+    // Checked here, as the size is no longer reported back to the worker once the payload is queued
+    if ( buffer->size() > mSender->getMaxSendSize() )
+    {
+        return ConnectivityError::WrongInputData;
+    }
+    if ( !mQueue.push( std::move( buffer ), collectionSchemeParams ) )
+    {
+        return ConnectivityError::NotConfigured;
+    }
+    return ConnectivityError::Success;
+}
+
+ConnectivityError
+DataSenderPipeline::PublishQueue::persistBuffers( const std::vector<PayloadBufferPtr> &buffers,
+                                                  struct CollectionSchemeParams collectionSchemeParams )
+{
+    return mSender->persistBuffers( buffers, collectionSchemeParams );
+}
+
+DataSenderPipeline::DataSenderPipeline( std::shared_ptr<ISender> sender,
+                                        uint32_t workerCount,
+                                        size_t queueSize,
+                                        const SenderFactory &senderFactory,
+                                        std::vector<SendPriorityLevel> priorityLevels )
+    : mPublishQueue( std::make_shared<PublishQueue>( std::move( sender ), std::move( priorityLevels ), queueSize ) )
+    , mInputQueue( queueSize )
+{
+    workerCount = std::max( 1U, workerCount );
+    for ( uint32_t i = 0; i < workerCount; i++ )
+    {
+        auto worker = std::make_unique<Worker>();
+        worker->mPipeline = this;
+        worker->mDataCollectionSender = senderFactory( mPublishQueue );
+        mWorkers.emplace_back( std::move( worker ) );
+    }
+}
+
+DataSenderPipeline::~DataSenderPipeline()
+{
+    // To make sure the threads stop during teardown of tests.
+    if ( isAlive() )
+    {
+        stop();
+    }
+}
+
+bool
+DataSenderPipeline::start()
+{
+    // Prevent concurrent stop/init
+    std::lock_guard<std::mutex> lock( mThreadMutex );
+    mInputQueue.reopen();
+    mPublishQueue->mQueue.reopen();
+    if ( !mPublishThread.create( doPublish, this, "fwDMSendPub" ) )
+    {
+        mLogger.error( "DataSenderPipeline::start", " Publish Thread failed to start " );
+        return false;
+    }
+    for ( size_t i = 0; i < mWorkers.size(); i++ )
+    {
+        if ( !mWorkers[i]->mThread.create( doWork, mWorkers[i].get(), "fwDMSendWork" + std::to_string( i + 1 ) ) )
+        {
+            mLogger.error( "DataSenderPipeline::start", " Worker Thread failed to start " );
+            return false;
+        }
+    }
+    mLogger.trace( "DataSenderPipeline::start",
+                   " Started " + std::to_string( mWorkers.size() ) + " worker threads and the publish thread " );
+    return true;
+}
+
+bool
+DataSenderPipeline::stop()
+{
+    std::lock_guard<std::mutex> lock( mThreadMutex );
+    // Closing a queue lets its consumers drain it and then return, so the stages are stopped front to back
+    mInputQueue.close();
+    bool stopped = true;
+    for ( auto &worker : mWorkers )
+    {
+        worker->mThread.release();
+        stopped = stopped && !worker->mThread.isActive();
+    }
+    mPublishQueue->mQueue.close();
+    mPublishThread.release();
+    mLogger.trace( "DataSenderPipeline::stop", " Worker and publish Threads stopped " );
+    return stopped && !mPublishThread.isActive();
+}
+
+bool
+DataSenderPipeline::isAlive()
+{
+    if ( !mPublishThread.isValid() || !mPublishThread.isActive() )
+    {
+        return false;
+    }
+    return std::all_of( mWorkers.begin(), mWorkers.end(), []( const std::unique_ptr<Worker> &worker ) {
+        return worker->mThread.isValid() && worker->mThread.isActive();
+    } );
+}
+
+void
+DataSenderPipeline::setMaxMessageCount( unsigned maxMessageCount )
+{
+    for ( auto &worker : mWorkers )
+    {
+        worker->mDataCollectionSender->setMaxMessageCount( maxMessageCount );
+    }
+}
+
+bool
+DataSenderPipeline::submit( TriggeredCollectionSchemeDataPtr triggeredCollectionSchemeDataPtr )
+{
+    if ( !mInputQueue.push( std::move( triggeredCollectionSchemeDataPtr ) ) )
+    {
+        mLogger.warn( "DataSenderPipeline::submit", "Pipeline is stopped, the data is not sent" );
+        return false;
+    }
+    return true;
+}
+
+void
+DataSenderPipeline::doWork( void *data )
+{
+    auto *worker = static_cast<Worker *>( data );
+    auto &inputQueue = worker->mPipeline->mInputQueue;
+    TriggeredCollectionSchemeDataPtr triggeredCollectionSchemeDataPtr;
+    // Time until the next aggregate of the worker's sender has to be sent, 0 if there is none
+    uint32_t timeToFlushMs = 0;
+    while ( true )
+    {
+        bool popped = ( timeToFlushMs > 0U ) ? inputQueue.pop( triggeredCollectionSchemeDataPtr, timeToFlushMs )
+                                             : inputQueue.pop( triggeredCollectionSchemeDataPtr );
+        if ( popped )
+        {
+            worker->mDataCollectionSender->send( triggeredCollectionSchemeDataPtr );
+            // Release the data, its signal snapshots reference the sample buffers of the inspection engine
+            triggeredCollectionSchemeDataPtr.reset();
+        }
+        else if ( inputQueue.isClosed() )
+        {
+            break;
+        }
+        timeToFlushMs = worker->mDataCollectionSender->flushAggregates();
+    }
+    worker->mDataCollectionSender->flushAggregates( true );
+}
+
+void
+DataSenderPipeline::doPublish( void *data )
+{
+    auto *pipeline = static_cast<DataSenderPipeline *>( data );
+    auto &publishQueue = *pipeline->mPublishQueue;
+    PayloadBufferPtr payload;
+    CollectionSchemeParams collectionSchemeParams;
+    while ( publishQueue.mQueue.pop( payload, collectionSchemeParams ) )
+    {
+        auto res = publishQueue.mSender->sendBuffer( std::move( payload ), collectionSchemeParams );
+        if ( res != ConnectivityError::Success )
+        {
+            pipeline->mLogger.error( "DataSenderPipeline::doPublish",
+                                     "Failed to send vehicle data proto with error: " +
+                                         std::to_string( static_cast<int>( res ) ) );
+        }
+    }
+}
+
+} // namespace DataManagement
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -0,0 +1,87 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "ExpressDataSender.h"
+#include <utility>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataManagement
+{
+
+ExpressDataSender::ExpressDataSender( std::unique_ptr<DataCollectionSender> dataCollectionSender, size_t queueSize )
+    : mQueue( std::make_shared<ExpressCollectedData>( queueSize ) )
+    , mDataCollectionSender( std::move( dataCollectionSender ) )
+{
+}
+
+ExpressDataSender::~ExpressDataSender()
+{
+    // To make sure the thread stops during teardown of tests.
+    if ( isAlive() )
+    {
+        stop();
+    }
+}
+
+bool
+ExpressDataSender::start()
+{
+    // Prevent concurrent stop/init
+    std::lock_guard<std::mutex> lock( mThreadMutex );
+    mQueue->reopen();
+    if ( !mThread.create( doWork, this, "fwDMExpressSend" ) )
+    {
+        mLogger.error( "ExpressDataSender::start", " Express Sender Thread failed to start " );
+        return false;
+    }
+    mLogger.trace( "ExpressDataSender::start", " Express Sender Thread started " );
+    return true;
+}
+
+bool
+ExpressDataSender::stop()
+{
+    std::lock_guard<std::mutex> lock( mThreadMutex );
+    // The thread sends the queued data and returns once the closed queue is empty
+    mQueue->close();
+    mThread.release();
+    mLogger.trace( "ExpressDataSender::stop", " Express Sender Thread stopped " );
+    return !mThread.isActive();
+}
+
+bool
+ExpressDataSender::isAlive()
+{
+    return mThread.isValid() && mThread.isActive();
+}
+
+void
+ExpressDataSender::doWork( void *data )
+{
+    auto *sender = static_cast<ExpressDataSender *>( data );
+    TriggeredCollectionSchemeDataPtr triggeredCollectionSchemeDataPtr;
+    while ( sender->mQueue->pop( triggeredCollectionSchemeDataPtr ) )
+    {
+        sender->mDataCollectionSender->send( triggeredCollectionSchemeDataPtr );
+        // Release the data, its signal snapshots reference the sample buffers of the inspection engine
+        triggeredCollectionSchemeDataPtr.reset();
+    }
+}
+
+} // namespace DataManagement
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -0,0 +1,247 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "JSONStreamWriter.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataManagement
+{
+
+namespace
+{
+// Integral doubles below are written exactly with the integer digits
+constexpr double MAX_EXACT_INTEGER = 9007199254740992.0; // 2^53
+constexpr char HEX_DIGITS[] = "0123456789abcdef";
+} // namespace
+
+void
+JSONStreamWriter::clear()
+{
+    mBuffer.clear();
+    mHasElement.clear();
+    mAfterKey = false;
+}
+
+void
+JSONStreamWriter::separate()
+{
+    if ( mAfterKey )
+    {
+        mAfterKey = false;
+        return;
+    }
+    if ( !mHasElement.empty() )
+    {
+        if ( mHasElement.back() )
+        {
+            mBuffer += ',';
+        }
+        mHasElement.back() = true;
+    }
+}
+
+void
+JSONStreamWriter::beginObject()
+{
+    separate();
+    mBuffer += '{';
+    mHasElement.push_back( false );
+}
+
+void
+JSONStreamWriter::endObject()
+{
+    mBuffer += '}';
+    mHasElement.pop_back();
+}
+
+void
+JSONStreamWriter::beginArray()
+{
+    separate();
+    mBuffer += '[';
+    mHasElement.push_back( false );
+}
+
+void
+JSONStreamWriter::endArray()
+{
+    mBuffer += ']';
+    mHasElement.pop_back();
+}
+
+void
+JSONStreamWriter::key( const char *name )
+{
+    separate();
+    mBuffer += '"';
+    mBuffer += name;
+    mBuffer += "\":";
+    mAfterKey = true;
+}
+
+void
+JSONStreamWriter::value( const std::string &value )
+{
+    separate();
+    appendEscaped( value );
+}
+
+void
+JSONStreamWriter::value( uint64_t value )
+{
+    separate();
+    appendUnsigned( mBuffer, value );
+}
+
+void
+JSONStreamWriter::value( uint32_t value )
+{
+    separate();
+    appendUnsigned( mBuffer, value );
+}
+
+void
+JSONStreamWriter::value( int64_t value )
+{
+    separate();
+    if ( value < 0 )
+    {
+        mBuffer += '-';
+        // Negating in unsigned arithmetic also works for the minimum value
+        appendUnsigned( mBuffer, 0U - static_cast<uint64_t>( value ) );
+    }
+    else
+    {
+        appendUnsigned( mBuffer, static_cast<uint64_t>( value ) );
+    }
+}
+
+void
+JSONStreamWriter::value( double value )
+{
+    separate();
+    appendDouble( mBuffer, value );
+}
+
+void
+JSONStreamWriter::appendUnsigned( std::string &output, uint64_t value )
+{
+    char digits[20];
+    size_t count = 0;
+    do
+    {
+        digits[count++] = static_cast<char>( '0' + ( value % 10U ) );
+        value /= 10U;
+    } while ( value != 0U );
+    while ( count > 0 )
+    {
+        output += digits[--count];
+    }
+}
+
+void
+JSONStreamWriter::appendDouble( std::string &output, double value )
+{
+    if ( std::isnan( value ) )
+    {
+        output += "null";
+        return;
+    }
+    if ( std::isinf( value ) )
+    {
+        output += ( value < 0.0 ) ? "-1e+9999" : "1e+9999";
+        return;
+    }
+    // Most signal values are integral, they are written without printf
+    if ( ( std::fabs( value ) < MAX_EXACT_INTEGER ) && ( std::trunc( value ) == value ) )
+    {
+        if ( std::signbit( value ) )
+        {
+            output += '-';
+        }
+        appendUnsigned( output, static_cast<uint64_t>( std::fabs( value ) ) );
+        output += ".0";
+        return;
+    }
+    // 15 significant digits are enough for most values, only if they do not read back 17 are needed
+    char digits[32];
+    int length = snprintf( digits, sizeof( digits ), "%.15g", value );
+    if ( std::strtod( digits, nullptr ) != value )
+    {
+        length = snprintf( digits, sizeof( digits ), "%.17g", value );
+    }
+    if ( ( length <= 0 ) || ( static_cast<size_t>( length ) >= sizeof( digits ) ) )
+    {
+        output += "null";
+        return;
+    }
+    output.append( digits, static_cast<size_t>( length ) );
+    // Large integral values can be printed without exponent, they are still written as doubles
+    if ( std::strpbrk( digits, ".e" ) == nullptr )
+    {
+        output += ".0";
+    }
+}
+
+void
+JSONStreamWriter::appendEscaped( const std::string &value )
+{
+    mBuffer += '"';
+    for ( char c : value )
+    {
+        switch ( c )
+        {
+        case '"':
+            mBuffer += "\\\"";
+            break;
+        case '\\':
+            mBuffer += "\\\\";
+            break;
+        case '\n':
+            mBuffer += "\\n";
+            break;
+        case '\r':
+            mBuffer += "\\r";
+            break;
+        case '\t':
+            mBuffer += "\\t";
+            break;
+        default:
+            if ( static_cast<unsigned char>( c ) < 0x20U )
+            {
+                mBuffer += "\\u00";
+                mBuffer += HEX_DIGITS[( static_cast<unsigned char>( c ) >> 4U ) & 0xFU];
+                mBuffer += HEX_DIGITS[static_cast<unsigned char>( c ) & 0xFU];
+            }
+            else
+            {
+                mBuffer += c;
+            }
+            break;
+        }
+    }
+    mBuffer += '"';
+}
+
+} // namespace DataManagement
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -0,0 +1,818 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "LocalRecorder.h"
+#include "Crc32c.h"
+#include "FastClock.h"
+#include "TraceModule.h"
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataManagement
+{
+namespace
+{
+constexpr const char *THREAD_NAME = "fwDCRecorder";
+constexpr const char *FILE_MAGIC = "FWR1";
+constexpr const char *BLOCK_MAGIC = "FWB";
+constexpr const char *INDEX_MAGIC = "FWRI";
+constexpr const char *FILE_PREFIX = "recording-";
+constexpr const char *FILE_SUFFIX = ".fwr";
+constexpr const char *OPEN_FILE_SUFFIX = ".fwr.part";
+constexpr const char *FILE_INDEX_NAME = "index.csv";
+
+// Bytes per row of the columns of a block, without the frame payloads
+constexpr size_t SIGNAL_ROW_SIZE = sizeof( uint64_t ) + sizeof( uint16_t ) + sizeof( uint32_t ) + sizeof( double );
+constexpr size_t FRAME_ROW_SIZE =
+    sizeof( uint64_t ) + sizeof( uint16_t ) + sizeof( uint32_t ) + sizeof( uint32_t ) + sizeof( uint8_t );
+
+void
+putLittleEndian( uint8_t *out, uint64_t value, size_t size )
+{
+    for ( size_t i = 0; i < size; i++ )
+    {
+        out[i] = static_cast<uint8_t>( value >> ( 8U * i ) );
+    }
+}
+
+uint64_t
+getLittleEndian( const uint8_t *in, size_t size )
+{
+    uint64_t value = 0;
+    for ( size_t i = 0; i < size; i++ )
+    {
+        value |= static_cast<uint64_t>( in[i] ) << ( 8U * i );
+    }
+    return value;
+}
+
+/**
+ * @brief Appends a column of values in little endian
+ */
+template <typename T>
+void
+appendColumn( std::vector<uint8_t> &out, const std::vector<T> &values, size_t size )
+{
+    auto offset = out.size();
+    out.resize( offset + ( values.size() * size ) );
+    auto *position = out.data() + offset;
+    for ( auto value : values )
+    {
+        putLittleEndian( position, static_cast<uint64_t>( value ), size );
+        position += size;
+    }
+}
+
+uint64_t
+doubleToBits( double value )
+{
+    uint64_t bits = 0;
+    std::memcpy( &bits, &value, sizeof( bits ) );
+    return bits;
+}
+
+double
+bitsToDouble( uint64_t bits )
+{
+    double value = 0.0;
+    std::memcpy( &value, &bits, sizeof( value ) );
+    return value;
+}
+
+bool
+endsWith( const std::string &value, const std::string &suffix )
+{
+    return ( value.size() >= suffix.size() ) &&
+           ( value.compare( value.size() - suffix.size(), suffix.size(), suffix ) == 0 );
+}
+
+bool
+writeAll( int fd, const uint8_t *data, size_t size )
+{
+    while ( size > 0U )
+    {
+        auto written = write( fd, data, size );
+        if ( written < 0 )
+        {
+            if ( errno == EINTR )
+            {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>( written );
+    }
+    return true;
+}
+
+bool
+readFileContent( const std::string &path, std::vector<uint8_t> &content )
+{
+    int fd = open( path.c_str(), O_RDONLY | O_CLOEXEC );
+    if ( fd < 0 )
+    {
+        return false;
+    }
+    struct stat status
+    {
+    };
+    bool success = fstat( fd, &status ) == 0;
+    if ( success )
+    {
+        content.resize( static_cast<size_t>( status.st_size ) );
+        size_t position = 0;
+        while ( success && ( position < content.size() ) )
+        {
+            auto bytesRead = read( fd, content.data() + position, content.size() - position );
+            if ( ( bytesRead < 0 ) && ( errno == EINTR ) )
+            {
+                continue;
+            }
+            success = bytesRead > 0;
+            position += success ? static_cast<size_t>( bytesRead ) : 0U;
+        }
+    }
+    close( fd );
+    return success;
+}
+
+struct BlockHeader
+{
+    uint8_t type{ 0 };
+    uint32_t rows{ 0 };
+    Timestamp oldest{ 0 };
+    Timestamp newest{ 0 };
+    uint32_t size{ 0 };
+    uint32_t crc{ 0 };
+
+    void
+    write( uint8_t *out ) const
+    {
+        std::memcpy( out, BLOCK_MAGIC, 3 );
+        out[3] = type;
+        putLittleEndian( out + 4, rows, 4 );
+        putLittleEndian( out + 8, oldest, 8 );
+        putLittleEndian( out + 16, newest, 8 );
+        putLittleEndian( out + 24, size, 4 );
+        putLittleEndian( out + 28, crc, 4 );
+    }
+
+    /**
+     * @brief Reads the header at the offset and checks that the block is complete and not corrupted
+     */
+    bool
+    read( const uint8_t *data, size_t dataSize, size_t offset )
+    {
+        if ( ( dataSize < offset ) || ( dataSize - offset < LocalRecorder::BLOCK_HEADER_SIZE ) ||
+             ( std::memcmp( data + offset, BLOCK_MAGIC, 3 ) != 0 ) )
+        {
+            return false;
+        }
+        const auto *in = data + offset;
+        type = in[3];
+        rows = static_cast<uint32_t>( getLittleEndian( in + 4, 4 ) );
+        oldest = getLittleEndian( in + 8, 8 );
+        newest = getLittleEndian( in + 16, 8 );
+        size = static_cast<uint32_t>( getLittleEndian( in + 24, 4 ) );
+        crc = static_cast<uint32_t>( getLittleEndian( in + 28, 4 ) );
+        return ( dataSize - offset - LocalRecorder::BLOCK_HEADER_SIZE >= size ) &&
+               ( PersistencyManagement::crc32c( 0, in + LocalRecorder::BLOCK_HEADER_SIZE, size ) == crc );
+    }
+};
+} // namespace
+
+constexpr uint32_t LocalRecorder::DEFAULT_BLOCK_ROWS;
+constexpr size_t LocalRecorder::DEFAULT_WRITE_CHUNK_BYTES;
+constexpr uint64_t LocalRecorder::DEFAULT_MAX_FILE_BYTES;
+constexpr uint64_t LocalRecorder::DEFAULT_MAX_FILE_DURATION_MS;
+constexpr uint32_t LocalRecorder::DEFAULT_FLUSH_INTERVAL_MS;
+constexpr size_t LocalRecorder::DEFAULT_QUEUE_SIZE;
+constexpr size_t LocalRecorder::FILE_HEADER_SIZE;
+constexpr size_t LocalRecorder::BLOCK_HEADER_SIZE;
+constexpr size_t LocalRecorder::INDEX_ENTRY_SIZE;
+constexpr size_t LocalRecorder::TRAILER_SIZE;
+constexpr uint8_t LocalRecorder::BLOCK_TYPE_SIGNALS;
+constexpr uint8_t LocalRecorder::BLOCK_TYPE_CAN_FRAMES;
+
+LocalRecorder::LocalRecorder( Config config )
+    : mConfig( std::move( config ) )
+    , mCodec( createCompressionCodec( mConfig.codec ) )
+    , mQueue( mConfig.queueSize )
+{
+    mConfig.blockRows = std::max( mConfig.blockRows, 1U );
+    // No data is accepted before start
+    mQueue.close();
+}
+
+LocalRecorder::~LocalRecorder()
+{
+    // To make sure the thread stops during teardown of tests.
+    if ( isAlive() )
+    {
+        stop();
+    }
+    if ( mFd >= 0 )
+    {
+        flush( true );
+    }
+}
+
+bool
+LocalRecorder::start()
+{
+    // Prevent concurrent stop/init
+    std::lock_guard<std::mutex> lock( mThreadMutex );
+    if ( mCodec == nullptr )
+    {
+        mLogger.error( "LocalRecorder::start",
+                       std::string( " Codec " ) + getCompressionCodecName( mConfig.codec ) + " is not supported" );
+        return false;
+    }
+    if ( !recoverFiles() )
+    {
+        return false;
+    }
+    mLastFlushTime = FastClock::monotonicTimeMs();
+    mQueue.reopen();
+    if ( !mThread.create( doWork, this, THREAD_NAME ) )
+    {
+        mLogger.error( "LocalRecorder::start", " Recorder Thread failed to start " );
+        mQueue.close();
+        return false;
+    }
+    mLogger.trace( "LocalRecorder::start", " Recorder Thread started, recording to " + mConfig.directory );
+    return true;
+}
+
+bool
+LocalRecorder::stop()
+{
+    std::lock_guard<std::mutex> lock( mThreadMutex );
+    // Closing the queue lets the thread record the queued data, close the file and return
+    mQueue.close();
+    mThread.release();
+    mLogger.trace( "LocalRecorder::stop", " Recorder Thread stopped " );
+    return !mThread.isActive();
+}
+
+bool
+LocalRecorder::isAlive()
+{
+    return mThread.isValid() && mThread.isActive();
+}
+
+bool
+LocalRecorder::submit( const TriggeredCollectionSchemeDataPtr &data )
+{
+    auto element = data;
+    if ( !mQueue.tryPush( element ) )
+    {
+        TraceModule::get().incrementAtomicVariable( TraceAtomicVariable::RECORDER_DROPPED_DATA );
+        return false;
+    }
+    return true;
+}
+
+void
+LocalRecorder::record( const TriggeredCollectionSchemeData &data )
+{
+    for ( const auto &signal : data.signals )
+    {
+        recordSignal( signal.signalID, signal.receiveTime, signal.receiveTimeFractionUs, signal.value );
+    }
+    for ( const auto &snapshot : data.signalSnapshots )
+    {
+        for ( uint32_t i = 0; i < snapshot.sampleCount; i++ )
+        {
+            auto sample = snapshot.getSample( i );
+            recordSignal( snapshot.signalID, sample.receiveTime, sample.receiveTimeFractionUs, sample.value );
+        }
+    }
+    for ( const auto &frame : data.canFrames )
+    {
+        recordFrame( frame );
+    }
+    applyWatermarks();
+}
+
+void
+LocalRecorder::recordSignal( SignalID signalId, Timestamp time, TimestampFractionUs fractionUs, double value )
+{
+    auto timeUs = getTimeUs( time, fractionUs );
+    auto watermark = mSignalWatermarks.find( signalId );
+    if ( ( watermark != mSignalWatermarks.end() ) && ( timeUs <= watermark->second ) )
+    {
+        return;
+    }
+    mPendingSignalWatermarks.emplace_back( signalId, timeUs );
+    mSignalTimes.push_back( time );
+    mSignalFractions.push_back( fractionUs );
+    mSignalIds.push_back( signalId );
+    mSignalValues.push_back( value );
+    if ( mSignalTimes.size() >= mConfig.blockRows )
+    {
+        encodeSignalBlock();
+    }
+}
+
+void
+LocalRecorder::recordFrame( const CollectedCanRawFrame &frame )
+{
+    auto key = getFrameKey( frame.channelId, frame.frameID );
+    auto timeUs = getTimeUs( frame.receiveTime, frame.receiveTimeFractionUs );
+    auto watermark = mFrameWatermarks.find( key );
+    if ( ( watermark != mFrameWatermarks.end() ) && ( timeUs <= watermark->second ) )
+    {
+        return;
+    }
+    mPendingFrameWatermarks.emplace_back( key, timeUs );
+    mFrameTimes.push_back( frame.receiveTime );
+    mFrameFractions.push_back( frame.receiveTimeFractionUs );
+    mFrameChannels.push_back( frame.channelId );
+    mFrameIds.push_back( frame.frameID );
+    auto size = std::min( frame.size, MAX_CANFD_FRAME_BYTE_SIZE );
+    mFrameSizes.push_back( size );
+    mFramePayloads.insert( mFramePayloads.end(), frame.data.begin(), frame.data.begin() + size );
+    if ( mFrameTimes.size() >= mConfig.blockRows )
+    {
+        encodeFrameBlock();
+    }
+}
+
+void
+LocalRecorder::applyWatermarks()
+{
+    for ( const auto &pending : mPendingSignalWatermarks )
+    {
+        auto &watermark = mSignalWatermarks[pending.first];
+        watermark = std::max( watermark, pending.second );
+    }
+    for ( const auto &pending : mPendingFrameWatermarks )
+    {
+        auto &watermark = mFrameWatermarks[pending.first];
+        watermark = std::max( watermark, pending.second );
+    }
+    mPendingSignalWatermarks.clear();
+    mPendingFrameWatermarks.clear();
+}
+
+void
+LocalRecorder::encodeSignalBlock()
+{
+    if ( mSignalTimes.empty() )
+    {
+        return;
+    }
+    mColumns.clear();
+    mColumns.reserve( mSignalTimes.size() * SIGNAL_ROW_SIZE );
+    appendColumn( mColumns, mSignalTimes, sizeof( uint64_t ) );
+    appendColumn( mColumns, mSignalFractions, sizeof( uint16_t ) );
+    appendColumn( mColumns, mSignalIds, sizeof( uint32_t ) );
+    auto offset = mColumns.size();
+    mColumns.resize( offset + ( mSignalValues.size() * sizeof( uint64_t ) ) );
+    for ( size_t i = 0; i < mSignalValues.size(); i++ )
+    {
+        putLittleEndian( mColumns.data() + offset + ( i * sizeof( uint64_t ) ),
+                         doubleToBits( mSignalValues[i] ),
+                         sizeof( uint64_t ) );
+    }
+    auto range = std::minmax_element( mSignalTimes.begin(), mSignalTimes.end() );
+    appendBlock( BLOCK_TYPE_SIGNALS, static_cast<uint32_t>( mSignalTimes.size() ), *range.first, *range.second );
+    mSignalTimes.clear();
+    mSignalFractions.clear();
+    mSignalIds.clear();
+    mSignalValues.clear();
+}
+
+void
+LocalRecorder::encodeFrameBlock()
+{
+    if ( mFrameTimes.empty() )
+    {
+        return;
+    }
+    mColumns.clear();
+    mColumns.reserve( ( mFrameTimes.size() * FRAME_ROW_SIZE ) + mFramePayloads.size() );
+    appendColumn( mColumns, mFrameTimes, sizeof( uint64_t ) );
+    appendColumn( mColumns, mFrameFractions, sizeof( uint16_t ) );
+    appendColumn( mColumns, mFrameChannels, sizeof( uint32_t ) );
+    appendColumn( mColumns, mFrameIds, sizeof( uint32_t ) );
+    mColumns.insert( mColumns.end(), mFrameSizes.begin(), mFrameSizes.end() );
+    mColumns.insert( mColumns.end(), mFramePayloads.begin(), mFramePayloads.end() );
+    auto range = std::minmax_element( mFrameTimes.begin(), mFrameTimes.end() );
+    appendBlock( BLOCK_TYPE_CAN_FRAMES, static_cast<uint32_t>( mFrameTimes.size() ), *range.first, *range.second );
+    mFrameTimes.clear();
+    mFrameFractions.clear();
+    mFrameChannels.clear();
+    mFrameIds.clear();
+    mFrameSizes.clear();
+    mFramePayloads.clear();
+}
+
+void
+LocalRecorder::appendBlock( uint8_t type, uint32_t rows, Timestamp oldest, Timestamp newest )
+{
+    if ( !mCodec->compress( mColumns.data(), mColumns.size(), mCompressed ) )
+    {
+        mLogger.error( "LocalRecorder::appendBlock", " Compression failed, " + std::to_string( rows ) + " rows lost" );
+        return;
+    }
+    if ( ( mFd < 0 ) && ( !openFile() ) )
+    {
+        return;
+    }
+    BlockHeader header;
+    header.type = type;
+    header.rows = rows;
+    header.oldest = oldest;
+    header.newest = newest;
+    header.size = static_cast<uint32_t>( mCompressed.size() );
+    header.crc = PersistencyManagement::crc32c( 0, mCompressed.data(), mCompressed.size() );
+    IndexEntry entry;
+    entry.offset = mFileBytes + mChunk.size();
+    entry.type = type;
+    entry.rows = rows;
+    entry.oldest = oldest;
+    entry.newest = newest;
+    mIndex.push_back( entry );
+    ( ( type == BLOCK_TYPE_SIGNALS ) ? mFileSignalRows : mFileFrameRows ) += rows;
+    mFileOldest = ( mFileOldest == 0 ) ? oldest : std::min( mFileOldest, oldest );
+    mFileNewest = std::max( mFileNewest, newest );
+
+    auto offset = mChunk.size();
+    mChunk.resize( offset + BLOCK_HEADER_SIZE );
+    header.write( mChunk.data() + offset );
+    mChunk.insert( mChunk.end(), mCompressed.begin(), mCompressed.end() );
+    if ( mChunk.size() >= mConfig.writeChunkBytes )
+    {
+        writeChunk();
+    }
+    if ( isFileFull() )
+    {
+        closeFile();
+    }
+}
+
+bool
+LocalRecorder::isFileFull() const
+{
+    return ( mFd >= 0 ) && ( ( mFileBytes + mChunk.size() >= mConfig.maxFileBytes ) ||
+                             ( mClock->timeSinceEpochMs() - mFileOpenTime >= mConfig.maxFileDurationMs ) );
+}
+
+void
+LocalRecorder::flush( bool closeCurrentFile )
+{
+    encodeSignalBlock();
+    encodeFrameBlock();
+    if ( mFd < 0 )
+    {
+        return;
+    }
+    if ( closeCurrentFile || isFileFull() )
+    {
+        closeFile();
+        return;
+    }
+    if ( writeChunk() )
+    {
+        // Bounds the rows lost on a power loss to the flush interval
+        (void)fdatasync( mFd );
+    }
+}
+
+bool
+LocalRecorder::openFile()
+{
+    mFileOpenTime = mClock->timeSinceEpochMs();
+    char name[64];
+    (void)snprintf( name,
+                    sizeof( name ),
+                    "%s%013" PRIu64 "-%06" PRIu32 "%s",
+                    FILE_PREFIX,
+                    static_cast<uint64_t>( mFileOpenTime ),
+                    mFileSequence,
+                    OPEN_FILE_SUFFIX );
+    mFileSequence++;
+    mFilePath = mConfig.directory + "/" + name;
+    mFd = open( mFilePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644 );
+    if ( mFd < 0 )
+    {
+        mLogger.error( "LocalRecorder::openFile",
+                       " Could not create " + mFilePath + ": " + std::string( strerror( errno ) ) );
+        return false;
+    }
+    mFileBytes = 0;
+    mFileOldest = 0;
+    mFileNewest = 0;
+    mFileSignalRows = 0;
+    mFileFrameRows = 0;
+    mIndex.clear();
+    mChunk.clear();
+    mChunk.resize( FILE_HEADER_SIZE );
+    std::memcpy( mChunk.data(), FILE_MAGIC, 4 );
+    mChunk[4] = static_cast<uint8_t>( mConfig.codec );
+    putLittleEndian( mChunk.data() + 8, mFileOpenTime, 8 );
+    deleteOldestFiles();
+    return true;
+}
+
+bool
+LocalRecorder::writeChunk()
+{
+    if ( mChunk.empty() )
+    {
+        return true;
+    }
+    bool success = writeAll( mFd, mChunk.data(), mChunk.size() );
+    if ( success )
+    {
+        mFileBytes += mChunk.size();
+        TraceModule::get().addToAtomicVariable( TraceAtomicVariable::RECORDER_WRITTEN_BYTES, mChunk.size() );
+    }
+    else
+    {
+        mLogger.error( "LocalRecorder::writeChunk",
+                       " Could not write " + std::to_string( mChunk.size() ) + " bytes to " + mFilePath + ": " +
+                           std::string( strerror( errno ) ) );
+        // The index still refers to the lost blocks, so the file is closed without one
+        mIndex.clear();
+    }
+    mChunk.clear();
+    return success;
+}
+
+void
+LocalRecorder::closeFile()
+{
+    if ( mFd < 0 )
+    {
+        return;
+    }
+    if ( writeChunk() && ( !mIndex.empty() ) )
+    {
+        auto indexOffset = mFileBytes;
+        mChunk.resize( ( mIndex.size() * INDEX_ENTRY_SIZE ) + TRAILER_SIZE );
+        auto *out = mChunk.data();
+        for ( const auto &entry : mIndex )
+        {
+            putLittleEndian( out, entry.offset, 8 );
+            out[8] = entry.type;
+            putLittleEndian( out + 9, 0, 3 );
+            putLittleEndian( out + 12, entry.rows, 4 );
+            putLittleEndian( out + 16, entry.oldest, 8 );
+            putLittleEndian( out + 24, entry.newest, 8 );
+            out += INDEX_ENTRY_SIZE;
+        }
+        putLittleEndian( out, indexOffset, 8 );
+        putLittleEndian( out + 8, mIndex.size(), 4 );
+        std::memcpy( out + 12, INDEX_MAGIC, 4 );
+        writeChunk();
+    }
+    (void)fsync( mFd );
+    close( mFd );
+    mFd = -1;
+    auto closedPath = mFilePath.substr( 0, mFilePath.size() - strlen( OPEN_FILE_SUFFIX ) ) + FILE_SUFFIX;
+    if ( rename( mFilePath.c_str(), closedPath.c_str() ) != 0 )
+    {
+        mLogger.error( "LocalRecorder::closeFile", " Could not rename " + mFilePath );
+        closedPath = mFilePath;
+    }
+    auto fileName = closedPath.substr( closedPath.find_last_of( '/' ) + 1 );
+    auto line = fileName + "," + std::to_string( mFileOldest ) + "," + std::to_string( mFileNewest ) + "," +
+                std::to_string( mFileSignalRows ) + "," + std::to_string( mFileFrameRows ) + "," +
+                std::to_string( mFileBytes ) + "\n";
+    auto indexPath = mConfig.directory + "/" + FILE_INDEX_NAME;
+    int indexFd = open( indexPath.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644 );
+    if ( ( indexFd < 0 ) || ( !writeAll( indexFd, reinterpret_cast<const uint8_t *>( line.data() ), line.size() ) ) )
+    {
+        mLogger.error( "LocalRecorder::closeFile", " Could not append " + fileName + " to " + indexPath );
+    }
+    if ( indexFd >= 0 )
+    {
+        close( indexFd );
+    }
+    mLogger.trace( "LocalRecorder::closeFile",
+                   " Closed " + fileName + " with " + std::to_string( mFileSignalRows ) + " signals and " +
+                       std::to_string( mFileFrameRows ) + " frames" );
+    mClosedFiles.push_back( ClosedFile{ closedPath, mFileBytes } );
+    mClosedFilesBytes += mFileBytes;
+    mFileBytes = 0;
+    deleteOldestFiles();
+}
+
+bool
+LocalRecorder::recoverFiles()
+{
+    auto *directory = opendir( mConfig.directory.c_str() );
+    if ( directory == nullptr )
+    {
+        mLogger.error( "LocalRecorder::recoverFiles", " Could not open directory " + mConfig.directory );
+        return false;
+    }
+    std::vector<std::string> names;
+    for ( auto *entry = readdir( directory ); entry != nullptr; entry = readdir( directory ) )
+    {
+        std::string name( entry->d_name );
+        if ( ( name.compare( 0, strlen( FILE_PREFIX ), FILE_PREFIX ) == 0 ) &&
+             ( endsWith( name, FILE_SUFFIX ) || endsWith( name, OPEN_FILE_SUFFIX ) ) )
+        {
+            names.push_back( name );
+        }
+    }
+    closedir( directory );
+    // The names start with the zero padded creation time, so they sort from oldest to newest
+    std::sort( names.begin(), names.end() );
+    mClosedFiles.clear();
+    mClosedFilesBytes = 0;
+    for ( const auto &name : names )
+    {
+        auto path = mConfig.directory + "/" + name;
+        if ( endsWith( name, OPEN_FILE_SUFFIX ) )
+        {
+            // Left open by a run that was not stopped. Its blocks are complete up to the last write.
+            auto closedPath = path.substr( 0, path.size() - strlen( OPEN_FILE_SUFFIX ) ) + FILE_SUFFIX;
+            if ( rename( path.c_str(), closedPath.c_str() ) == 0 )
+            {
+                mLogger.info( "LocalRecorder::recoverFiles", " Closed " + path + " without block index" );
+                path = closedPath;
+            }
+        }
+        struct stat status
+        {
+        };
+        if ( stat( path.c_str(), &status ) == 0 )
+        {
+            mClosedFiles.push_back( ClosedFile{ path, static_cast<uint64_t>( status.st_size ) } );
+            mClosedFilesBytes += static_cast<uint64_t>( status.st_size );
+        }
+    }
+    deleteOldestFiles();
+    return true;
+}
+
+void
+LocalRecorder::deleteOldestFiles()
+{
+    if ( mConfig.maxTotalBytes == 0 )
+    {
+        return;
+    }
+    while ( ( !mClosedFiles.empty() ) && ( mClosedFilesBytes + mFileBytes + mChunk.size() > mConfig.maxTotalBytes ) )
+    {
+        const auto &oldest = mClosedFiles.front();
+        if ( unlink( oldest.path.c_str() ) != 0 )
+        {
+            mLogger.warn( "LocalRecorder::deleteOldestFiles", " Could not delete " + oldest.path );
+        }
+        mClosedFilesBytes -= oldest.bytes;
+        mClosedFiles.pop_front();
+    }
+}
+
+void
+LocalRecorder::doWork( void *data )
+{
+    auto *recorder = static_cast<LocalRecorder *>( data );
+    TriggeredCollectionSchemeDataPtr collectedData;
+    while ( true )
+    {
+        if ( recorder->mQueue.pop( collectedData, recorder->mConfig.flushIntervalMs ) )
+        {
+            recorder->record( *collectedData );
+            // Returns the data to its pool
+            collectedData.reset();
+        }
+        // Nothing is pushed after close, so the queue stays empty
+        else if ( recorder->mQueue.isClosed() && ( recorder->mQueue.size() == 0U ) )
+        {
+            break;
+        }
+        auto timeMs = FastClock::monotonicTimeMs();
+        if ( timeMs - recorder->mLastFlushTime >= recorder->mConfig.flushIntervalMs )
+        {
+            recorder->flush( false );
+            recorder->mLastFlushTime = timeMs;
+        }
+    }
+    recorder->flush( true );
+}
+
+bool
+LocalRecorder::readFile( const std::string &path,
+                         std::vector<CollectedSignal> &signals,
+                         std::vector<CollectedCanRawFrame> &frames )
+{
+    std::vector<uint8_t> content;
+    if ( ( !readFileContent( path, content ) ) || ( content.size() < FILE_HEADER_SIZE ) ||
+         ( std::memcmp( content.data(), FILE_MAGIC, 4 ) != 0 ) )
+    {
+        return false;
+    }
+    auto codec = createCompressionCodec( static_cast<CompressionCodecType>( content[4] ) );
+    if ( codec == nullptr )
+    {
+        return false;
+    }
+    // Blocks end at the index of a closed file, or at the end of a file that was left open
+    auto end = content.size();
+    if ( ( content.size() >= FILE_HEADER_SIZE + TRAILER_SIZE ) &&
+         ( std::memcmp( content.data() + content.size() - 4, INDEX_MAGIC, 4 ) == 0 ) )
+    {
+        end = std::min<size_t>( getLittleEndian( content.data() + content.size() - TRAILER_SIZE, 8 ), end );
+    }
+    std::vector<uint8_t> columns;
+    size_t offset = FILE_HEADER_SIZE;
+    while ( offset < end )
+    {
+        BlockHeader header;
+        if ( ( !header.read( content.data(), end, offset ) ) ||
+             ( !codec->decompress( content.data() + offset + BLOCK_HEADER_SIZE, header.size, columns ) ) )
+        {
+            return false;
+        }
+        offset += BLOCK_HEADER_SIZE + header.size;
+        const auto *in = columns.data();
+        size_t rows = header.rows;
+        if ( header.type == BLOCK_TYPE_SIGNALS )
+        {
+            if ( columns.size() != rows * SIGNAL_ROW_SIZE )
+            {
+                return false;
+            }
+            const auto *fractions = in + ( rows * 8 );
+            const auto *ids = fractions + ( rows * 2 );
+            const auto *values = ids + ( rows * 4 );
+            for ( size_t i = 0; i < rows; i++ )
+            {
+                CollectedSignal signal( static_cast<SignalID>( getLittleEndian( ids + ( i * 4 ), 4 ) ),
+                                        getLittleEndian( in + ( i * 8 ), 8 ),
+                                        bitsToDouble( getLittleEndian( values + ( i * 8 ), 8 ) ) );
+                signal.receiveTimeFractionUs =
+                    static_cast<TimestampFractionUs>( getLittleEndian( fractions + ( i * 2 ), 2 ) );
+                signals.push_back( signal );
+            }
+        }
+        else if ( header.type == BLOCK_TYPE_CAN_FRAMES )
+        {
+            if ( columns.size() < rows * FRAME_ROW_SIZE )
+            {
+                return false;
+            }
+            const auto *fractions = in + ( rows * 8 );
+            const auto *channels = fractions + ( rows * 2 );
+            const auto *ids = channels + ( rows * 4 );
+            const auto *sizes = ids + ( rows * 4 );
+            const auto *payload = sizes + rows;
+            const auto *payloadEnd = columns.data() + columns.size();
+            for ( size_t i = 0; i < rows; i++ )
+            {
+                if ( ( sizes[i] > MAX_CANFD_FRAME_BYTE_SIZE ) ||
+                     ( static_cast<size_t>( payloadEnd - payload ) < sizes[i] ) )
+                {
+                    return false;
+                }
+                auto channelId = static_cast<CANChannelNumericID>( getLittleEndian( channels + ( i * 4 ), 4 ) );
+                CollectedCanRawFrame frame( static_cast<CANRawFrameID>( getLittleEndian( ids + ( i * 4 ), 4 ) ),
+                                            channelId,
+                                            getLittleEndian( in + ( i * 8 ), 8 ),
+                                            payload,
+                                            sizes[i] );
+                frame.receiveTimeFractionUs =
+                    static_cast<TimestampFractionUs>( getLittleEndian( fractions + ( i * 2 ), 2 ) );
+                frames.push_back( frame );
+                payload += sizes[i];
+            }
+        }
+        // Blocks of unknown types, written by newer versions, are skipped
+    }
+    return true;
+}
+
+} // namespace DataManagement
+} // namespace IoTFleetWise
+} // namespace Aws
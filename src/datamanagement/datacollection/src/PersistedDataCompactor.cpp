@@ -0,0 +1,234 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "PersistedDataCompactor.h"
+#include "CPUUsageInfo.h"
+#include "FastClock.h"
+#include "TraceModule.h"
+#include <algorithm>
+#include <map>
+#include <string>
+#include <utility>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataManagement
+{
+namespace
+{
+constexpr const char *THREAD_NAME = "fwDMCompactor";
+constexpr int LOWEST_PRIORITY_NICE = 19;
+
+/**
+ * @brief Uncompresses the payloads compressed by any codec of the build. Called by the thread retrieving the
+ *        persisted data, while the compactor compresses with its own codec.
+ */
+class StorageDecompressor
+{
+public:
+    bool
+    decompress( const uint8_t *input, size_t size, std::vector<uint8_t> &out )
+    {
+        CompressedPayloadHeader header;
+        if ( !header.read( input, size ) )
+        {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock( mMutex );
+        auto &codec = mCodecs[header.codec];
+        if ( codec == nullptr )
+        {
+            codec = createCompressionCodec( header.codec );
+        }
+        return ( codec != nullptr ) && codec->decompress( input, size, out );
+    }
+
+private:
+    std::mutex mMutex;
+    std::map<CompressionCodecType, std::unique_ptr<ICompressionCodec>> mCodecs;
+};
+} // namespace
+
+constexpr uint32_t PersistedDataCompactor::DEFAULT_INTERVAL_MS;
+constexpr double PersistedDataCompactor::DEFAULT_MAX_CPU_PERCENT;
+
+PersistedDataCompactor::PersistedDataCompactor( std::shared_ptr<PayloadManager> payloadManager,
+                                                std::shared_ptr<CacheAndPersist> persistency,
+                                                double maxCpuPercent,
+                                                uint32_t intervalMs )
+    : mPayloadManager( std::move( payloadManager ) )
+    , mPersistency( std::move( persistency ) )
+    , mMaxCpuPercent( maxCpuPercent )
+    , mIntervalMs( intervalMs )
+{
+    for ( auto type : { CompressionCodecType::ZSTD, CompressionCodecType::LZ4 } )
+    {
+        if ( isCompressionCodecSupported( type ) )
+        {
+            mCodec = createCompressionCodec( type );
+            if ( mCodec != nullptr )
+            {
+                mCodecType = type;
+                break;
+            }
+        }
+    }
+    // Payloads compressed with a codec by an earlier run can be read even if the codec is not used anymore
+    auto decompressor = std::make_shared<StorageDecompressor>();
+    PayloadCodecFunction compress;
+    if ( mCodec != nullptr )
+    {
+        auto *codec = mCodec.get();
+        compress = [codec]( const uint8_t *input, size_t size, std::vector<uint8_t> &out ) {
+            return codec->compress( input, size, out );
+        };
+    }
+    mPayloadManager->setStorageCodec(
+        compress, [decompressor]( const uint8_t *input, size_t size, std::vector<uint8_t> &out ) {
+            return decompressor->decompress( input, size, out );
+        } );
+}
+
+PersistedDataCompactor::~PersistedDataCompactor()
+{
+    stop();
+}
+
+bool
+PersistedDataCompactor::start()
+{
+    // Prevent concurrent stop/init
+    std::lock_guard<std::mutex> lock( mThreadMutex );
+    mShouldStop.store( false );
+    if ( !mThread.create( doWork, this, THREAD_NAME ) )
+    {
+        mLogger.error( "PersistedDataCompactor::start", " Compactor Thread failed to start " );
+        return false;
+    }
+    mLogger.trace( "PersistedDataCompactor::start",
+                   " Compactor Thread started with codec " + std::to_string( static_cast<int>( mCodecType ) ) );
+    return true;
+}
+
+bool
+PersistedDataCompactor::stop()
+{
+    if ( !mThread.isValid() || !mThread.isActive() )
+    {
+        return true;
+    }
+    std::lock_guard<std::mutex> lock( mThreadMutex );
+    mShouldStop.store( true, std::memory_order_relaxed );
+    mWait.notify();
+    mThread.release();
+    mLogger.trace( "PersistedDataCompactor::stop", " Compactor Thread stopped " );
+    mShouldStop.store( false, std::memory_order_relaxed );
+    return !mThread.isActive();
+}
+
+bool
+PersistedDataCompactor::isAlive()
+{
+    return mThread.isValid() && mThread.isActive();
+}
+
+bool
+PersistedDataCompactor::shouldStop() const
+{
+    return mShouldStop.load( std::memory_order_relaxed );
+}
+
+bool
+PersistedDataCompactor::compactNext()
+{
+    auto segments = mPersistency->getCollectedDataSegments();
+    if ( !segments.empty() )
+    {
+        // Deleted segments are never compacted again, segment ids are not reused
+        mCompactedSegmentIds.erase( mCompactedSegmentIds.begin(),
+                                    mCompactedSegmentIds.lower_bound( segments.front().id ) );
+    }
+    for ( const auto &segment : segments )
+    {
+        if ( mCompactedSegmentIds.find( segment.id ) != mCompactedSegmentIds.end() )
+        {
+            continue;
+        }
+        size_t savedBytes = 0;
+        auto status = mPayloadManager->compactSegment( segment.id, savedBytes );
+        if ( status == ErrorCode::EMPTY )
+        {
+            // Still written to or uploaded, tried again later
+            continue;
+        }
+        mCompactedSegmentIds.insert( segment.id );
+        if ( status != ErrorCode::SUCCESS )
+        {
+            mLogger.warn( "PersistedDataCompactor::compactNext",
+                          " Could not compact segment " + std::to_string( segment.id ) );
+            return true;
+        }
+        TraceModule::get().addToAtomicVariable( TraceAtomicVariable::PERSISTENCY_COMPACTED_BYTES, savedBytes );
+        mLogger.trace( "PersistedDataCompactor::compactNext",
+                       " Segment " + std::to_string( segment.id ) + " compacted by " + std::to_string( savedBytes ) +
+                           " bytes" );
+        return true;
+    }
+    return false;
+}
+
+void
+PersistedDataCompactor::doWork( void *data )
+{
+    auto *compactor = static_cast<PersistedDataCompactor *>( data );
+    // Unless configured otherwise the thread only gets the CPU time no other thread needs
+    ThreadConfig config;
+    if ( !Thread::findConfig( THREAD_NAME, config ) )
+    {
+        config.hasNice = true;
+        config.nice = LOWEST_PRIORITY_NICE;
+        Thread::applyConfigToCurrentThread( config );
+    }
+    CPUUsageInfo lastUsage;
+    lastUsage.reportCPUUsageInfo();
+    auto lastTimeMs = FastClock::monotonicTimeMs();
+    while ( !compactor->shouldStop() )
+    {
+        compactor->mWait.wait( compactor->mIntervalMs );
+        if ( compactor->shouldStop() )
+        {
+            break;
+        }
+        CPUUsageInfo usage;
+        usage.reportCPUUsageInfo();
+        auto timeMs = FastClock::monotonicTimeMs();
+        auto elapsedSeconds = static_cast<double>( std::max<Timestamp>( timeMs - lastTimeMs, 1 ) ) / 1000.0;
+        auto cpuPercent = usage.getTotalCPUPercentage( lastUsage, elapsedSeconds );
+        lastUsage = usage;
+        lastTimeMs = timeMs;
+        if ( cpuPercent > compactor->mMaxCpuPercent )
+        {
+            compactor->mLogger.trace( "PersistedDataCompactor::doWork",
+                                      " Agent uses " + std::to_string( cpuPercent ) + "% CPU, not compacting" );
+            continue;
+        }
+        compactor->compactNext();
+    }
+}
+
+} // namespace DataManagement
+} // namespace IoTFleetWise
+} // namespace Aws
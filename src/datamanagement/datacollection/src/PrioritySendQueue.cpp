@@ -0,0 +1,175 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "PrioritySendQueue.h"
+#include <limits>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataManagement
+{
+
+PrioritySendQueue::PrioritySendQueue( std::vector<SendPriorityLevel> levels, size_t capacityPerLevel )
+    : mState( std::make_shared<State>() )
+{
+    if ( levels.empty() )
+    {
+        SendPriorityLevel allPriorities;
+        allPriorities.maxPriority = std::numeric_limits<uint32_t>::max();
+        levels.emplace_back( allPriorities );
+    }
+    for ( const auto &config : levels )
+    {
+        Level level;
+        level.mConfig = config;
+        mState->mLevels.emplace_back( std::move( level ) );
+    }
+    mState->mCapacityPerLevel = ( capacityPerLevel > 0U ) ? capacityPerLevel : 1U;
+}
+
+size_t
+PrioritySendQueue::getLevel( uint32_t priority ) const
+{
+    // The configuration is never modified, so no lock is needed
+    for ( size_t i = 0; i < mState->mLevels.size(); i++ )
+    {
+        if ( priority <= mState->mLevels[i].mConfig.maxPriority )
+        {
+            return i;
+        }
+    }
+    return mState->mLevels.size() - 1U;
+}
+
+bool
+PrioritySendQueue::push( PayloadBufferPtr buffer, const CollectionSchemeParams &collectionSchemeParams )
+{
+    auto &level = mState->mLevels[getLevel( collectionSchemeParams.priority )];
+    std::unique_lock<std::mutex> lock( mState->mMutex );
+    mState->mNotFull.wait(
+        lock, [this, &level]() { return mState->mClosed || ( level.mPayloads.size() < mState->mCapacityPerLevel ); } );
+    if ( mState->mClosed )
+    {
+        return false;
+    }
+    level.mPayloads.push_back( QueuedPayload{ std::move( buffer ), collectionSchemeParams } );
+    lock.unlock();
+    mState->mReady.notify_all();
+    return true;
+}
+
+size_t
+PrioritySendQueue::findReadyLevel() const
+{
+    for ( size_t i = 0; i < mState->mLevels.size(); i++ )
+    {
+        const auto &level = mState->mLevels[i];
+        if ( level.mPayloads.empty() )
+        {
+            continue;
+        }
+        if ( mState->mClosed || ( level.mConfig.maxInFlight == 0U ) || ( level.mInFlight < level.mConfig.maxInFlight ) )
+        {
+            return i;
+        }
+    }
+    return mState->mLevels.size();
+}
+
+bool
+PrioritySendQueue::pop( PayloadBufferPtr &buffer, CollectionSchemeParams &collectionSchemeParams )
+{
+    std::unique_lock<std::mutex> lock( mState->mMutex );
+    size_t levelIndex = mState->mLevels.size();
+    mState->mReady.wait( lock, [this, &levelIndex]() {
+        levelIndex = findReadyLevel();
+        return ( levelIndex < mState->mLevels.size() ) || mState->mClosed;
+    } );
+    if ( levelIndex >= mState->mLevels.size() )
+    {
+        // Closed and empty
+        return false;
+    }
+    auto &level = mState->mLevels[levelIndex];
+    auto payload = std::move( level.mPayloads.front() );
+    level.mPayloads.pop_front();
+    level.mInFlight++;
+    lock.unlock();
+    mState->mNotFull.notify_all();
+
+    // The returned pointer shares the ownership of the tracker, so the payload is in flight until the last
+    // reference, for example the one of the publish completion callback, is released
+    auto *rawBuffer = payload.mBuffer.get();
+    auto inFlightPayload = std::make_shared<InFlightPayload>( mState, levelIndex, std::move( payload.mBuffer ) );
+    buffer = PayloadBufferPtr( inFlightPayload, rawBuffer );
+    collectionSchemeParams = payload.mCollectionSchemeParams;
+    return true;
+}
+
+void
+PrioritySendQueue::close()
+{
+    {
+        std::lock_guard<std::mutex> lock( mState->mMutex );
+        mState->mClosed = true;
+    }
+    mState->mNotFull.notify_all();
+    mState->mReady.notify_all();
+}
+
+void
+PrioritySendQueue::reopen()
+{
+    std::lock_guard<std::mutex> lock( mState->mMutex );
+    mState->mClosed = false;
+}
+
+size_t
+PrioritySendQueue::size( size_t level ) const
+{
+    std::lock_guard<std::mutex> lock( mState->mMutex );
+    return mState->mLevels[level].mPayloads.size();
+}
+
+uint32_t
+PrioritySendQueue::getInFlight( size_t level ) const
+{
+    std::lock_guard<std::mutex> lock( mState->mMutex );
+    return mState->mLevels[level].mInFlight;
+}
+
+PrioritySendQueue::InFlightPayload::InFlightPayload( std::shared_ptr<State> state,
+                                                     size_t level,
+                                                     PayloadBufferPtr buffer )
+    : mState( std::move( state ) )
+    , mLevel( level )
+    , mBuffer( std::move( buffer ) )
+{
+}
+
+PrioritySendQueue::InFlightPayload::~InFlightPayload()
+{
+    {
+        std::lock_guard<std::mutex> lock( mState->mMutex );
+        mState->mLevels[mLevel].mInFlight--;
+    }
+    // A queued payload of this level may be ready now
+    mState->mReady.notify_all();
+}
+
+} // namespace DataManagement
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -0,0 +1,149 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "AdaptiveCompressionController.h"
+#include "CompressionCodec.h"
+#include <gtest/gtest.h>
+
+using namespace Aws::IoTFleetWise::DataManagement;
+
+namespace
+{
+AdaptiveCompressionConfig
+getSnappyToZstdConfig()
+{
+    AdaptiveCompressionConfig config;
+    config.fastest = { CompressionCodecType::SNAPPY, 0 };
+    config.strongest = { CompressionCodecType::ZSTD, 9 };
+    config.maxCpuPercent = 40.0;
+    config.targetBacklogSeconds = 2.0;
+    return config;
+}
+} // namespace
+
+TEST( AdaptiveCompressionControllerTest, LadderWithinBounds )
+{
+    AdaptiveCompressionController controller( getSnappyToZstdConfig() );
+    const auto &settings = controller.getSettings();
+    ASSERT_FALSE( settings.empty() );
+    ASSERT_EQ( settings.front(), ( CompressionSetting{ CompressionCodecType::SNAPPY, 0 } ) );
+    if ( isCompressionCodecSupported( CompressionCodecType::ZSTD ) )
+    {
+        ASSERT_EQ( settings.size(), 5 );
+        ASSERT_EQ( settings[1], ( CompressionSetting{ CompressionCodecType::ZSTD, 1 } ) );
+        ASSERT_EQ( settings.back(), ( CompressionSetting{ CompressionCodecType::ZSTD, 9 } ) );
+    }
+    else
+    {
+        ASSERT_EQ( settings.size(), 1 );
+    }
+    for ( const auto &setting : settings )
+    {
+        ASSERT_TRUE( isCompressionCodecSupported( setting.codec ) );
+        ASSERT_NE( setting.codec, CompressionCodecType::LZ4 );
+    }
+    ASSERT_EQ( controller.getSetting(), settings[( settings.size() - 1 ) / 2] );
+
+    // A bound between the levels of the ladder is part of it
+    auto config = getSnappyToZstdConfig();
+    config.fastest = { CompressionCodecType::ZSTD, 4 };
+    config.strongest = { CompressionCodecType::ZSTD, 4 };
+    AdaptiveCompressionController single( config );
+    ASSERT_EQ( single.getSettings().size(), 1 );
+    if ( isCompressionCodecSupported( CompressionCodecType::ZSTD ) )
+    {
+        ASSERT_EQ( single.getSetting(), ( CompressionSetting{ CompressionCodecType::ZSTD, 4 } ) );
+    }
+    else
+    {
+        // Nothing of the ladder is supported
+        ASSERT_EQ( single.getSetting(), ( CompressionSetting{ CompressionCodecType::SNAPPY, 0 } ) );
+    }
+}
+
+TEST( AdaptiveCompressionControllerTest, InvalidConfig )
+{
+    auto config = getSnappyToZstdConfig();
+    ASSERT_TRUE( AdaptiveCompressionController::isValid( config ) );
+    config.fastest = { CompressionCodecType::ZSTD, 3 };
+    config.strongest = { CompressionCodecType::SNAPPY, 0 };
+    ASSERT_FALSE( AdaptiveCompressionController::isValid( config ) );
+    config = getSnappyToZstdConfig();
+    config.maxCpuPercent = 0.0;
+    ASSERT_FALSE( AdaptiveCompressionController::isValid( config ) );
+    config = getSnappyToZstdConfig();
+    config.targetBacklogSeconds = 0.0;
+    ASSERT_FALSE( AdaptiveCompressionController::isValid( config ) );
+    config = getSnappyToZstdConfig();
+    config.intervalMs = 0;
+    ASSERT_FALSE( AdaptiveCompressionController::isValid( config ) );
+}
+
+TEST( AdaptiveCompressionControllerTest, StepsWithLoad )
+{
+    if ( !isCompressionCodecSupported( CompressionCodecType::ZSTD ) )
+    {
+        GTEST_SKIP() << "Zstandard is not enabled in this build";
+    }
+    AdaptiveCompressionController controller( getSnappyToZstdConfig() );
+    const auto settings = controller.getSettings();
+    size_t index = ( settings.size() - 1 ) / 2;
+
+    CompressionLoad congested;
+    congested.cpuPercent = 10.0;
+    congested.uplinkBytesPerSecond = 1000.0;
+    congested.backlogBytes = 5000;
+    // One step per update up to the strongest setting
+    while ( index + 1 < settings.size() )
+    {
+        ASSERT_EQ( controller.update( congested ), settings[++index] );
+    }
+    ASSERT_EQ( controller.update( congested ), settings.back() );
+
+    // The link keeps up, the setting is kept
+    CompressionLoad idle;
+    idle.cpuPercent = 10.0;
+    idle.uplinkBytesPerSecond = 1000.0;
+    idle.backlogBytes = 1000;
+    ASSERT_EQ( controller.update( idle ), settings.back() );
+
+    // Too busy for a stronger setting, but below the limit
+    congested.cpuPercent = 35.0;
+    ASSERT_EQ( controller.update( congested ), settings.back() );
+
+    // CPU heavy burst, one step per update down to the fastest setting
+    CompressionLoad busy = congested;
+    busy.cpuPercent = 60.0;
+    while ( index > 0 )
+    {
+        ASSERT_EQ( controller.update( busy ), settings[--index] );
+    }
+    ASSERT_EQ( controller.update( busy ), settings.front() );
+
+    // Nothing was published while data is waiting
+    CompressionLoad stalled;
+    stalled.backlogBytes = 1;
+    ASSERT_EQ( controller.update( stalled ), settings[1] );
+}
+
+TEST( AdaptiveCompressionControllerTest, SelectMeasuresOncePerInterval )
+{
+    auto config = getSnappyToZstdConfig();
+    config.intervalMs = 60000;
+    AdaptiveCompressionController controller( config );
+    auto initial = controller.getSetting();
+    for ( int i = 0; i < 10; i++ )
+    {
+        ASSERT_EQ( controller.select(), initial );
+    }
+}
@@ -0,0 +1,257 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "ArtifactUploader.h"
+#include <atomic>
+#include <boost/filesystem.hpp>
+#include <chrono>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace Aws::IoTFleetWise::DataManagement;
+
+namespace
+{
+struct Chunk
+{
+    uint32_t sourceID{ 0 };
+    uint64_t artifactSize{ 0 };
+    uint64_t offset{ 0 };
+    std::string name;
+    std::vector<uint8_t> data;
+};
+
+template <typename T>
+T
+readLittleEndian( const uint8_t *buf )
+{
+    uint64_t value = 0;
+    for ( size_t i = 0; i < sizeof( T ); i++ )
+    {
+        value |= static_cast<uint64_t>( buf[i] ) << ( i * 8U );
+    }
+    return static_cast<T>( value );
+}
+
+class MockArtifactSender : public ISender
+{
+public:
+    bool
+    isAlive() override
+    {
+        return mConnected;
+    }
+
+    size_t
+    getMaxSendSize() const override
+    {
+        return 128U * 1024U;
+    }
+
+    ConnectivityError
+    send( const std::uint8_t *buf,
+          size_t size,
+          struct CollectionSchemeParams collectionSchemeParams = CollectionSchemeParams() ) override
+    {
+        static_cast<void>( collectionSchemeParams );
+        if ( ( !mConnected ) || ( mChunksUntilDisconnect == 0 ) )
+        {
+            mConnected = false;
+            return ConnectivityError::NoConnection;
+        }
+        mChunksUntilDisconnect--;
+        EXPECT_GE( size, ArtifactUploader::CHUNK_HEADER_FIXED_SIZE );
+        EXPECT_EQ( std::string( buf, buf + 4 ), "FWAC" );
+        EXPECT_EQ( buf[4], ArtifactUploader::CHUNK_FORMAT_VERSION );
+        Chunk chunk;
+        chunk.sourceID = readLittleEndian<uint32_t>( buf + 5 );
+        chunk.artifactSize = readLittleEndian<uint64_t>( buf + 9 );
+        chunk.offset = readLittleEndian<uint64_t>( buf + 17 );
+        auto nameLength = readLittleEndian<uint16_t>( buf + 25 );
+        auto dataStart = ArtifactUploader::CHUNK_HEADER_FIXED_SIZE + nameLength;
+        chunk.name.assign( buf + ArtifactUploader::CHUNK_HEADER_FIXED_SIZE, buf + dataStart );
+        chunk.data.assign( buf + dataStart, buf + size );
+        std::lock_guard<std::mutex> lock( mMutex );
+        mChunks.emplace_back( std::move( chunk ) );
+        return ConnectivityError::Success;
+    }
+
+    std::vector<Chunk>
+    getChunks()
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        return mChunks;
+    }
+
+    std::atomic<bool> mConnected{ true };
+    std::atomic<int> mChunksUntilDisconnect{ 1000 };
+    std::mutex mMutex;
+    std::vector<Chunk> mChunks;
+};
+
+class ArtifactUploaderTest : public ::testing::Test
+{
+protected:
+    void
+    SetUp() override
+    {
+        mTmpDir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+        boost::filesystem::create_directories( mTmpDir );
+        mSender = std::make_shared<MockArtifactSender>();
+    }
+
+    void
+    TearDown() override
+    {
+        boost::filesystem::remove_all( mTmpDir );
+    }
+
+    std::string
+    createArtifact( const std::string &name, size_t size )
+    {
+        auto path = ( mTmpDir / name ).string();
+        std::ofstream file( path, std::ios::binary );
+        for ( size_t i = 0; i < size; i++ )
+        {
+            auto byte = static_cast<char>( i % 251 );
+            file.write( &byte, 1 );
+        }
+        return path;
+    }
+
+    static bool
+    waitFor( const std::function<bool()> &condition )
+    {
+        for ( int i = 0; i < 200; i++ )
+        {
+            if ( condition() )
+            {
+                return true;
+            }
+            std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+        }
+        return false;
+    }
+
+    // Puts the chunks together, every byte must be sent exactly once
+    static std::vector<uint8_t>
+    reassemble( const std::vector<Chunk> &chunks, uint64_t artifactSize )
+    {
+        std::vector<uint8_t> artifact( artifactSize );
+        std::vector<bool> sent( artifactSize, false );
+        for ( const auto &chunk : chunks )
+        {
+            EXPECT_EQ( chunk.artifactSize, artifactSize );
+            for ( size_t i = 0; i < chunk.data.size(); i++ )
+            {
+                EXPECT_FALSE( sent[chunk.offset + i] );
+                sent[chunk.offset + i] = true;
+                artifact[chunk.offset + i] = chunk.data[i];
+            }
+        }
+        EXPECT_TRUE( std::all_of( sent.begin(), sent.end(), []( bool s ) { return s; } ) );
+        return artifact;
+    }
+
+    boost::filesystem::path mTmpDir;
+    std::shared_ptr<MockArtifactSender> mSender;
+};
+} // namespace
+
+TEST_F( ArtifactUploaderTest, UploadsInChunksAndDeletesTheArtifact )
+{
+    auto path = createArtifact( "camera1", 10000 );
+    ArtifactUploader uploader( mSender, 4096, 10 );
+    ASSERT_TRUE( uploader.start() );
+    ASSERT_TRUE( uploader.isAlive() );
+    ASSERT_TRUE( uploader.submit( path, 7 ) );
+    ASSERT_TRUE( waitFor( [&]() { return uploader.getPendingArtifactCount() == 0; } ) );
+
+    auto chunks = mSender->getChunks();
+    ASSERT_EQ( chunks.size(), 3 );
+    ASSERT_EQ( chunks[0].sourceID, 7 );
+    ASSERT_EQ( chunks[0].name, "camera1" );
+    ASSERT_EQ( chunks[2].data.size(), 10000 - 2 * 4096 );
+    auto artifact = reassemble( chunks, 10000 );
+    for ( size_t i = 0; i < artifact.size(); i++ )
+    {
+        ASSERT_EQ( artifact[i], i % 251 );
+    }
+    ASSERT_EQ( uploader.getUploadedBytes(), 10000 );
+    ASSERT_FALSE( boost::filesystem::exists( path ) );
+    ASSERT_FALSE( boost::filesystem::exists( path + ArtifactUploader::PROGRESS_FILE_SUFFIX ) );
+    ASSERT_TRUE( uploader.stop() );
+}
+
+TEST_F( ArtifactUploaderTest, ContinuesAfterConnectionLoss )
+{
+    auto path = createArtifact( "camera2", 20000 );
+    mSender->mChunksUntilDisconnect = 2;
+    ArtifactUploader uploader( mSender, 4096, 10 );
+    ASSERT_TRUE( uploader.start() );
+    ASSERT_TRUE( uploader.submit( path, 1 ) );
+    ASSERT_TRUE( waitFor( [&]() { return !mSender->mConnected; } ) );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+    // The progress is kept on disk and the artifact stays queued
+    ASSERT_EQ( uploader.getPendingArtifactCount(), 1 );
+    std::ifstream progress( path + ArtifactUploader::PROGRESS_FILE_SUFFIX );
+    uint32_t sourceID = 0;
+    uint64_t artifactSize = 0;
+    uint64_t nextOffset = 0;
+    ASSERT_TRUE( static_cast<bool>( progress >> sourceID >> artifactSize >> nextOffset ) );
+    ASSERT_EQ( artifactSize, 20000 );
+    ASSERT_EQ( nextOffset, 2 * 4096 );
+
+    // The retry sends only the remaining chunks
+    mSender->mChunksUntilDisconnect = 1000;
+    mSender->mConnected = true;
+    ASSERT_TRUE( waitFor( [&]() { return uploader.getPendingArtifactCount() == 0; } ) );
+    auto chunks = mSender->getChunks();
+    ASSERT_EQ( chunks.size(), 5 );
+    reassemble( chunks, 20000 );
+    ASSERT_TRUE( uploader.stop() );
+}
+
+TEST_F( ArtifactUploaderTest, ResumesAfterRestart )
+{
+    auto path = createArtifact( "camera3", 9000 );
+    {
+        // Stopped before the upload started, e.g. the process ends
+        ArtifactUploader uploader( mSender, 4096, 10 );
+        ASSERT_TRUE( uploader.submit( path, 3 ) );
+    }
+    // Progress of an artifact that no longer exists
+    std::ofstream( ( mTmpDir / "gone" ).string() + ArtifactUploader::PROGRESS_FILE_SUFFIX ) << "1 100 0\n";
+
+    ArtifactUploader uploader( mSender, 4096, 10 );
+    ASSERT_EQ( uploader.resumeUploads( mTmpDir.string() ), 1 );
+    ASSERT_FALSE( boost::filesystem::exists( ( mTmpDir / "gone" ).string() + ArtifactUploader::PROGRESS_FILE_SUFFIX ) );
+    ASSERT_TRUE( uploader.start() );
+    ASSERT_TRUE( waitFor( [&]() { return uploader.getPendingArtifactCount() == 0; } ) );
+    auto chunks = mSender->getChunks();
+    ASSERT_EQ( chunks.size(), 3 );
+    ASSERT_EQ( chunks[0].sourceID, 3 );
+    reassemble( chunks, 9000 );
+    ASSERT_TRUE( uploader.stop() );
+}
+
+TEST_F( ArtifactUploaderTest, MissingArtifactIsRejected )
+{
+    ArtifactUploader uploader( mSender );
+    ASSERT_FALSE( uploader.submit( ( mTmpDir / "missing" ).string(), 1 ) );
+    ASSERT_EQ( uploader.getPendingArtifactCount(), 0 );
+}
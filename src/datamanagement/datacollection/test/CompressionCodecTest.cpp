@@ -0,0 +1,170 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "CompressionCodec.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+using namespace Aws::IoTFleetWise::DataManagement;
+
+namespace
+{
+
+// Repetitive like the serialized vehicle data
+std::vector<uint8_t>
+createPayload()
+{
+    std::vector<uint8_t> payload;
+    for ( uint32_t i = 0; i < 1000; i++ )
+    {
+        payload.push_back( 0x0a );
+        payload.push_back( static_cast<uint8_t>( i % 10 ) );
+        payload.push_back( 0x11 );
+        payload.push_back( static_cast<uint8_t>( i % 16 ) );
+    }
+    return payload;
+}
+
+void
+expectRoundTrip( ICompressionCodec &codec, const std::vector<uint8_t> &payload )
+{
+    std::vector<uint8_t> compressed;
+    ASSERT_TRUE( codec.compress( payload.data(), payload.size(), compressed ) );
+    std::vector<uint8_t> uncompressed;
+    ASSERT_TRUE( codec.decompress( compressed.data(), compressed.size(), uncompressed ) );
+    ASSERT_EQ( uncompressed, payload );
+}
+
+} // namespace
+
+TEST( CompressionCodecTest, PayloadHeader )
+{
+    CompressedPayloadHeader header;
+    header.codec = CompressionCodecType::ZSTD;
+    header.dictionaryID = 0x12345678;
+    header.uncompressedSize = 4000;
+    std::vector<uint8_t> buffer( CompressedPayloadHeader::SIZE );
+    header.write( buffer.data() );
+    std::vector<uint8_t> expected = { 'F', 'W', 'C', 2, 0x78, 0x56, 0x34, 0x12, 0xa0, 0x0f, 0, 0 };
+    ASSERT_EQ( buffer, expected );
+
+    CompressedPayloadHeader readHeader;
+    ASSERT_TRUE( readHeader.read( buffer.data(), buffer.size() ) );
+    ASSERT_EQ( readHeader.codec, CompressionCodecType::ZSTD );
+    ASSERT_EQ( readHeader.dictionaryID, 0x12345678U );
+    ASSERT_EQ( readHeader.uncompressedSize, 4000U );
+
+    ASSERT_FALSE( readHeader.read( buffer.data(), buffer.size() - 1 ) );
+    buffer[0] = 'X';
+    ASSERT_FALSE( readHeader.read( buffer.data(), buffer.size() ) );
+}
+
+TEST( CompressionCodecTest, Snappy )
+{
+    ASSERT_TRUE( isCompressionCodecSupported( CompressionCodecType::SNAPPY ) );
+    auto codec = createCompressionCodec( CompressionCodecType::SNAPPY );
+    ASSERT_NE( codec, nullptr );
+    ASSERT_EQ( codec->getType(), CompressionCodecType::SNAPPY );
+    expectRoundTrip( *codec, createPayload() );
+
+    // No header for compatibility
+    auto payload = createPayload();
+    std::vector<uint8_t> compressed;
+    ASSERT_TRUE( codec->compress( payload.data(), payload.size(), compressed ) );
+    CompressedPayloadHeader header;
+    ASSERT_FALSE( header.read( compressed.data(), compressed.size() ) );
+}
+
+TEST( CompressionCodecTest, Lz4 )
+{
+    auto codec = createCompressionCodec( CompressionCodecType::LZ4 );
+#ifdef FWE_FEATURE_LZ4
+    ASSERT_TRUE( isCompressionCodecSupported( CompressionCodecType::LZ4 ) );
+    ASSERT_NE( codec, nullptr );
+    auto payload = createPayload();
+    expectRoundTrip( *codec, payload );
+
+    std::vector<uint8_t> compressed;
+    ASSERT_TRUE( codec->compress( payload.data(), payload.size(), compressed ) );
+    ASSERT_LT( compressed.size(), payload.size() );
+    CompressedPayloadHeader header;
+    ASSERT_TRUE( header.read( compressed.data(), compressed.size() ) );
+    ASSERT_EQ( header.codec, CompressionCodecType::LZ4 );
+    ASSERT_EQ( header.uncompressedSize, payload.size() );
+    // Truncated payload
+    std::vector<uint8_t> uncompressed;
+    ASSERT_FALSE( codec->decompress( compressed.data(), compressed.size() - 1, uncompressed ) );
+#else
+    ASSERT_FALSE( isCompressionCodecSupported( CompressionCodecType::LZ4 ) );
+    ASSERT_EQ( codec, nullptr );
+#endif
+}
+
+TEST( CompressionCodecTest, Zstd )
+{
+    auto codec = createCompressionCodec( CompressionCodecType::ZSTD );
+#ifdef FWE_FEATURE_ZSTD
+    ASSERT_TRUE( isCompressionCodecSupported( CompressionCodecType::ZSTD ) );
+    ASSERT_NE( codec, nullptr );
+    auto payload = createPayload();
+    expectRoundTrip( *codec, payload );
+
+    // A higher level compresses at least as well as the fastest one
+    auto fastCodec = createCompressionCodec( CompressionCodecType::ZSTD, nullptr, 1 );
+    auto strongCodec = createCompressionCodec( CompressionCodecType::ZSTD, nullptr, 19 );
+    ASSERT_NE( fastCodec, nullptr );
+    ASSERT_NE( strongCodec, nullptr );
+    expectRoundTrip( *strongCodec, payload );
+    std::vector<uint8_t> fastCompressed;
+    std::vector<uint8_t> strongCompressed;
+    ASSERT_TRUE( fastCodec->compress( payload.data(), payload.size(), fastCompressed ) );
+    ASSERT_TRUE( strongCodec->compress( payload.data(), payload.size(), strongCompressed ) );
+    ASSERT_LE( strongCompressed.size(), fastCompressed.size() );
+
+    // A raw content dictionary has ID 0 but still makes the payloads smaller
+    auto dictionary = std::make_shared<const std::string>( payload.begin(), payload.begin() + 400 );
+    auto dictionaryCodec = createCompressionCodec( CompressionCodecType::ZSTD, dictionary );
+    ASSERT_NE( dictionaryCodec, nullptr );
+    expectRoundTrip( *dictionaryCodec, payload );
+    std::vector<uint8_t> compressed;
+    std::vector<uint8_t> compressedWithDictionary;
+    ASSERT_TRUE( codec->compress( payload.data(), 800, compressed ) );
+    ASSERT_TRUE( dictionaryCodec->compress( payload.data(), 800, compressedWithDictionary ) );
+    ASSERT_LT( compressedWithDictionary.size(), compressed.size() );
+    CompressedPayloadHeader header;
+    ASSERT_TRUE( header.read( compressedWithDictionary.data(), compressedWithDictionary.size() ) );
+    ASSERT_EQ( header.codec, CompressionCodecType::ZSTD );
+    ASSERT_EQ( header.uncompressedSize, 800U );
+    // Other codecs do not decompress the payload
+    std::vector<uint8_t> uncompressed;
+    ASSERT_FALSE( createCompressionCodec( CompressionCodecType::SNAPPY )
+                      ->decompress( compressedWithDictionary.data(), compressedWithDictionary.size(), uncompressed ) );
+#else
+    ASSERT_FALSE( isCompressionCodecSupported( CompressionCodecType::ZSTD ) );
+    ASSERT_EQ( codec, nullptr );
+#endif
+}
+
+TEST( CompressionCodecTest, CodecNames )
+{
+    for ( auto codec : { CompressionCodecType::SNAPPY, CompressionCodecType::LZ4, CompressionCodecType::ZSTD } )
+    {
+        CompressionCodecType parsed{};
+        ASSERT_TRUE( getCompressionCodecType( getCompressionCodecName( codec ), parsed ) );
+        ASSERT_EQ( parsed, codec );
+    }
+    CompressionCodecType parsed{};
+    ASSERT_FALSE( getCompressionCodecType( "gzip", parsed ) );
+    ASSERT_STREQ( getCompressionCodecName( CompressionCodecType::ZSTD ), "zstd" );
+}
@@ -0,0 +1,109 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "CompressionCodec.h"
+#include "DataCollectionProtoWriter.h"
+#include <benchmark/benchmark.h>
+
+using namespace Aws::IoTFleetWise::DataManagement;
+
+static constexpr Timestamp TRIGGER_TIME = 1600000000000;
+
+static std::shared_ptr<TriggeredCollectionSchemeData>
+createTriggeredData( size_t signalCount )
+{
+    auto data = std::make_shared<TriggeredCollectionSchemeData>();
+    data->metaData.collectionSchemeID = "arn:aws:iotfleetwise:us-east-1:123456789012:campaign/benchmark";
+    data->metaData.decoderID = "arn:aws:iotfleetwise:us-east-1:123456789012:decoder-manifest/benchmark";
+    data->triggerTime = TRIGGER_TIME;
+    // 20 signals with slowly changing values sampled every 10 ms, like the signals of a campaign
+    for ( size_t i = 0; i < signalCount; i++ )
+    {
+        data->signals.emplace_back( static_cast<SignalID>( i % 20 ),
+                                    TRIGGER_TIME - ( i / 20 ) * 10,
+                                    static_cast<double>( ( i / 20 ) % 100 ) * 0.5 );
+    }
+    return data;
+}
+
+static std::vector<uint8_t>
+serialize( const std::shared_ptr<TriggeredCollectionSchemeData> &data )
+{
+    CANInterfaceIDTranslator canIDTranslator;
+    DataCollectionProtoWriter protoWriter( canIDTranslator );
+    protoWriter.setupVehicleData( data, 1 );
+    for ( const auto &signal : data->signals )
+    {
+        protoWriter.append( signal );
+    }
+    std::vector<uint8_t> payload;
+    protoWriter.serializeVehicleData( payload );
+    return payload;
+}
+
+static void
+BM_appendAndSerializeSignals( benchmark::State &state )
+{
+    auto data = createTriggeredData( static_cast<size_t>( state.range( 0 ) ) );
+    CANInterfaceIDTranslator canIDTranslator;
+    DataCollectionProtoWriter protoWriter( canIDTranslator );
+    std::vector<uint8_t> payload;
+    for ( auto _ : state )
+    {
+        protoWriter.setupVehicleData( data, 1 );
+        for ( const auto &signal : data->signals )
+        {
+            protoWriter.append( signal );
+        }
+        protoWriter.serializeVehicleData( payload );
+        benchmark::DoNotOptimize( payload.data() );
+    }
+    state.SetItemsProcessed( state.iterations() * state.range( 0 ) );
+    state.SetBytesProcessed( state.iterations() * static_cast<int64_t>( payload.size() ) );
+}
+BENCHMARK( BM_appendAndSerializeSignals )->Arg( 100 )->Arg( 10000 );
+
+static void
+BM_compressSnappy( benchmark::State &state )
+{
+    auto payload = serialize( createTriggeredData( static_cast<size_t>( state.range( 0 ) ) ) );
+    auto codec = createCompressionCodec( CompressionCodecType::SNAPPY );
+    std::vector<uint8_t> compressed;
+    for ( auto _ : state )
+    {
+        codec->compress( payload.data(), payload.size(), compressed );
+        benchmark::DoNotOptimize( compressed.data() );
+    }
+    state.counters["ratio"] = static_cast<double>( compressed.size() ) / static_cast<double>( payload.size() );
+    state.SetBytesProcessed( state.iterations() * static_cast<int64_t>( payload.size() ) );
+}
+BENCHMARK( BM_compressSnappy )->Arg( 100 )->Arg( 10000 );
+
+static void
+BM_decompressSnappy( benchmark::State &state )
+{
+    auto payload = serialize( createTriggeredData( static_cast<size_t>( state.range( 0 ) ) ) );
+    auto codec = createCompressionCodec( CompressionCodecType::SNAPPY );
+    std::vector<uint8_t> compressed;
+    codec->compress( payload.data(), payload.size(), compressed );
+    std::vector<uint8_t> decompressed;
+    for ( auto _ : state )
+    {
+        codec->decompress( compressed.data(), compressed.size(), decompressed );
+        benchmark::DoNotOptimize( decompressed.data() );
+    }
+    state.SetBytesProcessed( state.iterations() * static_cast<int64_t>( payload.size() ) );
+}
+BENCHMARK( BM_decompressSnappy )->Arg( 100 )->Arg( 10000 );
+
+BENCHMARK_MAIN();
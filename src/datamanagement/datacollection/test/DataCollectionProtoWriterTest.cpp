@@ -165,12 +165,16 @@ TEST_F( DataCollectionProtoWriterTest, TestVehicleData )
     CollectedSignal collectedSignalMsg( 120 /*signalId*/, testTriggerTime + 2000 /*receiveTime*/, 77.88 /*value*/ );
     protoWriter.append( collectedSignalMsg );
     EXPECT_EQ( protoWriter.getVehicleDataMsgCount(), 1 );
+    CollectedSignal microsecondSignalMsg( 121 /*signalId*/, testTriggerTime - 3 /*receiveTime*/, 1.5 /*value*/ );
+    microsecondSignalMsg.receiveTimeFractionUs = 250;
+    protoWriter.append( microsecondSignalMsg );
 
     std::array<uint8_t, 8> data = { 1, 2, 3, 4, 5, 6, 7, 8 };
     CollectedCanRawFrame canRawFrameMsg(
         12 /*frameId*/, 1 /*nodeId*/, testTriggerTime + 1000 /*receiveTime*/, data, 8 /*sizeof data*/ );
+    canRawFrameMsg.receiveTimeFractionUs = 999;
     protoWriter.append( canRawFrameMsg );
-    EXPECT_EQ( protoWriter.getVehicleDataMsgCount(), 2 );
+    EXPECT_EQ( protoWriter.getVehicleDataMsgCount(), 3 );
     std::string out;
     EXPECT_TRUE( protoWriter.serializeVehicleData( &out ) );
 
@@ -187,6 +191,15 @@ TEST_F( DataCollectionProtoWriterTest, TestVehicleData )
     ASSERT_EQ( "456", vehicleDataTest.decoder_arn() );
     ASSERT_EQ( collectionEventID, vehicleDataTest.collection_event_id() );
     ASSERT_EQ( testTriggerTime, vehicleDataTest.collection_event_time_ms_epoch() );
+    // Millisecond timestamps are unchanged, the microseconds are only added as a fraction
+    ASSERT_EQ( vehicleDataTest.captured_signals_size(), 2 );
+    ASSERT_EQ( vehicleDataTest.captured_signals( 0 ).relative_time_ms(), 2000 );
+    ASSERT_EQ( vehicleDataTest.captured_signals( 0 ).relative_time_us_fraction(), 0 );
+    ASSERT_EQ( vehicleDataTest.captured_signals( 1 ).relative_time_ms(), -3 );
+    ASSERT_EQ( vehicleDataTest.captured_signals( 1 ).relative_time_us_fraction(), 250 );
+    ASSERT_EQ( vehicleDataTest.can_frames_size(), 1 );
+    ASSERT_EQ( vehicleDataTest.can_frames( 0 ).relative_time_ms(), 1000 );
+    ASSERT_EQ( vehicleDataTest.can_frames( 0 ).relative_time_us_fraction(), 999 );
 }
 
 // Test the DTC fields in the proto for the edge to cloud payload
@@ -214,6 +227,7 @@ TEST_F( DataCollectionProtoWriterTest, TestDTCData )
     dtcInfo.mSID = SID::STORED_DTC;
     dtcInfo.receiveTime = testTriggerTime + 2000;
     dtcInfo.mDTCCodes = { "U0123", "P0456" };
+    dtcInfo.mSequenceNumber = 7;
 
     protoWriter.setupDTCInfo( dtcInfo );
 
@@ -244,6 +258,8 @@ TEST_F( DataCollectionProtoWriterTest, TestDTCData )
     ASSERT_EQ( dtcData->relative_time_ms(), dtcInfo.receiveTime - testTriggerTime );
     ASSERT_EQ( "U0123", dtcData->active_dtc_codes( 0 ) );
     ASSERT_EQ( "P0456", dtcData->active_dtc_codes( 1 ) );
+    ASSERT_EQ( dtcData->sequence_number(), 7 );
+    ASSERT_FALSE( dtcData->unchanged() );
 }
 
 // Test the Geohash fields in the proto for the edge to cloud payload
@@ -291,4 +307,392 @@ TEST_F( DataCollectionProtoWriterTest, TestGeohash )
     auto geohash = vehicleDataTest.mutable_geohash();
     ASSERT_EQ( "9q9hwg28j", geohash->geohash_string() );
     ASSERT_EQ( "9q9hwg281", geohash->prev_reported_geohash_string() );
-}
\ No newline at end of file
+}
+// Test that the arena grows to the largest payload and the payloads built on the reset arena are complete
+TEST_F( DataCollectionProtoWriterTest, ArenaReusedBetweenPayloads )
+{
+    CANInterfaceIDTranslator canIDTranslator;
+    DataCollectionProtoWriter protoWriter( canIDTranslator );
+    ASSERT_EQ( protoWriter.getArenaBlockSize(), size_t{ DataCollectionProtoWriter::INITIAL_ARENA_BLOCK_SIZE } );
+
+    std::shared_ptr<TriggeredCollectionSchemeData> triggeredCollectionSchemeDataPtr =
+        std::make_shared<TriggeredCollectionSchemeData>();
+    triggeredCollectionSchemeDataPtr->metaData.collectionSchemeID = "123";
+    triggeredCollectionSchemeDataPtr->metaData.decoderID = "456";
+    triggeredCollectionSchemeDataPtr->triggerTime = 1000000;
+
+    size_t blockSizeAfterFirstPayload = 0;
+    for ( uint32_t payload = 0; payload < 5; payload++ )
+    {
+        protoWriter.setupVehicleData( triggeredCollectionSchemeDataPtr, payload );
+        if ( payload == 1 )
+        {
+            // The first payload did not fit into the initial block
+            blockSizeAfterFirstPayload = protoWriter.getArenaBlockSize();
+            ASSERT_GT( blockSizeAfterFirstPayload, size_t{ DataCollectionProtoWriter::INITIAL_ARENA_BLOCK_SIZE } );
+        }
+        for ( uint32_t i = 0; i < 1000; i++ )
+        {
+            protoWriter.append( CollectedSignal( i, 1000000 + i, static_cast<double>( payload ) ) );
+        }
+        std::string out;
+        ASSERT_TRUE( protoWriter.serializeVehicleData( &out ) );
+
+        VehicleDataMsg::VehicleData vehicleDataTest{};
+        ASSERT_TRUE( vehicleDataTest.ParseFromString( out ) );
+        ASSERT_EQ( "123", vehicleDataTest.campaign_arn() );
+        ASSERT_EQ( payload, vehicleDataTest.collection_event_id() );
+        ASSERT_EQ( vehicleDataTest.captured_signals_size(), 1000 );
+        ASSERT_EQ( vehicleDataTest.captured_signals( 999 ).signal_id(), 999 );
+        ASSERT_EQ( vehicleDataTest.captured_signals( 999 ).double_value(), static_cast<double>( payload ) );
+    }
+    // Payloads of the same size fit into the grown block
+    ASSERT_EQ( protoWriter.getArenaBlockSize(), blockSizeAfterFirstPayload );
+}
+
+// Test the samples grouped per signal and per CAN frame in payload format version 1
+TEST_F( DataCollectionProtoWriterTest, EstimatedSize )
+{
+    CANInterfaceIDTranslator canIDTranslator;
+    canIDTranslator.add( "can0" );
+    DataCollectionProtoWriter protoWriter( canIDTranslator );
+    std::shared_ptr<TriggeredCollectionSchemeData> triggeredCollectionSchemeDataPtr =
+        std::make_shared<TriggeredCollectionSchemeData>();
+    triggeredCollectionSchemeDataPtr->metaData.collectionSchemeID = "123";
+    triggeredCollectionSchemeDataPtr->metaData.decoderID = "456";
+    Timestamp testTriggerTime = 1000000;
+    triggeredCollectionSchemeDataPtr->triggerTime = testTriggerTime;
+    DTCInfo dtcInfo;
+    dtcInfo.mSID = SID::STORED_DTC;
+    dtcInfo.receiveTime = testTriggerTime + 3;
+    GeohashInfo geohashInfo;
+    geohashInfo.mGeohashString = "9q9hwg28j";
+    geohashInfo.mPrevReportedGeohashString = "9q9hwg281";
+    std::array<uint8_t, 8> data = { 1, 2, 3, 4, 5, 6, 7, 8 };
+
+    for ( auto version :
+          { DataCollectionProtoWriter::PAYLOAD_FORMAT_SAMPLES, DataCollectionProtoWriter::PAYLOAD_FORMAT_COLUMNS } )
+    {
+        ASSERT_TRUE( protoWriter.setPayloadFormatVersion( version ) );
+        protoWriter.setupVehicleData( triggeredCollectionSchemeDataPtr, 10 );
+        std::string out;
+        ASSERT_TRUE( protoWriter.serializeVehicleData( &out ) );
+        ASSERT_EQ( protoWriter.getEstimatedSize(), out.size() );
+
+        for ( int i = 0; i < 200; i++ )
+        {
+            CollectedSignal signal( i % 3, testTriggerTime + 7 * i - 100, 0.1 * i );
+            signal.receiveTimeFractionUs = ( i % 2 == 0 ) ? 0 : 999;
+            protoWriter.append( signal );
+            protoWriter.append(
+                CollectedCanRawFrame( 0x100 + i % 2, 0, testTriggerTime + i, data, static_cast<uint8_t>( i % 9 ) ) );
+        }
+        protoWriter.setupDTCInfo( dtcInfo );
+        protoWriter.append( std::string( "U0123" ) );
+        protoWriter.append( std::string( "P0456" ) );
+        protoWriter.append( geohashInfo );
+        ASSERT_TRUE( protoWriter.serializeVehicleData( &out ) );
+        if ( version == DataCollectionProtoWriter::PAYLOAD_FORMAT_SAMPLES )
+        {
+            ASSERT_EQ( protoWriter.getEstimatedSize(), out.size() );
+        }
+        else
+        {
+            // Upper bound, close enough for chunking as the values of the doubles can not be packed smaller
+            ASSERT_GE( protoWriter.getEstimatedSize(), out.size() );
+            ASSERT_LE( protoWriter.getEstimatedSize(), out.size() + out.size() / 4 );
+        }
+    }
+}
+
+TEST_F( DataCollectionProtoWriterTest, ColumnarPayloadFormat )
+{
+    CANInterfaceIDTranslator canIDTranslator;
+    canIDTranslator.add( "can0" );
+    DataCollectionProtoWriter protoWriter( canIDTranslator );
+    ASSERT_FALSE( protoWriter.setPayloadFormatVersion( 2 ) );
+    ASSERT_TRUE( protoWriter.setPayloadFormatVersion( DataCollectionProtoWriter::PAYLOAD_FORMAT_COLUMNS ) );
+
+    std::shared_ptr<TriggeredCollectionSchemeData> triggeredCollectionSchemeDataPtr =
+        std::make_shared<TriggeredCollectionSchemeData>();
+    triggeredCollectionSchemeDataPtr->metaData.collectionSchemeID = "123";
+    triggeredCollectionSchemeDataPtr->metaData.decoderID = "456";
+    Timestamp testTriggerTime = 1000000;
+    triggeredCollectionSchemeDataPtr->triggerTime = testTriggerTime;
+    protoWriter.setupVehicleData( triggeredCollectionSchemeDataPtr, 10 );
+
+    // Integer values, float values, double values and a signal with a microsecond timestamp interleaved
+    for ( int i = 0; i < 3; i++ )
+    {
+        protoWriter.append( CollectedSignal( 1, testTriggerTime + 10 * i, 100.0 - i ) );
+        protoWriter.append( CollectedSignal( 2, testTriggerTime - 5 + i, 0.5 * i ) );
+        protoWriter.append( CollectedSignal( 3, testTriggerTime + i, 0.1 * i ) );
+    }
+    CollectedSignal microsecondSignalMsg( 4, testTriggerTime + 7, -0.0 );
+    microsecondSignalMsg.receiveTimeFractionUs = 250;
+    protoWriter.append( microsecondSignalMsg );
+    std::array<uint8_t, 8> data = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    protoWriter.append( CollectedCanRawFrame( 0x100, 0, testTriggerTime + 1, data, 8 ) );
+    protoWriter.append( CollectedCanRawFrame( 0x200, 0, testTriggerTime + 2, data, 2 ) );
+    protoWriter.append( CollectedCanRawFrame( 0x100, 0, testTriggerTime + 4, data, 3 ) );
+    EXPECT_EQ( protoWriter.getVehicleDataMsgCount(), 13 );
+
+    std::string out;
+    ASSERT_TRUE( protoWriter.serializeVehicleData( &out ) );
+    VehicleDataMsg::VehicleData vehicleDataTest{};
+    ASSERT_TRUE( vehicleDataTest.ParseFromString( out ) );
+    ASSERT_EQ( vehicleDataTest.payload_format_version(),
+               uint32_t{ DataCollectionProtoWriter::PAYLOAD_FORMAT_COLUMNS } );
+    ASSERT_EQ( vehicleDataTest.captured_signals_size(), 0 );
+    ASSERT_EQ( vehicleDataTest.can_frames_size(), 0 );
+    ASSERT_EQ( vehicleDataTest.signal_columns_size(), 4 );
+
+    const auto &integers = vehicleDataTest.signal_columns( 0 );
+    ASSERT_EQ( integers.signal_id(), 1 );
+    ASSERT_EQ( integers.relative_time_ms_deltas_size(), 3 );
+    ASSERT_EQ( integers.relative_time_ms_deltas( 0 ), 0 );
+    ASSERT_EQ( integers.relative_time_ms_deltas( 2 ), 10 );
+    ASSERT_EQ( integers.relative_time_us_fractions_size(), 0 );
+    ASSERT_EQ( integers.integer_value_deltas_size(), 3 );
+    ASSERT_EQ( integers.integer_value_deltas( 0 ), 100 );
+    ASSERT_EQ( integers.integer_value_deltas( 1 ), -1 );
+    ASSERT_EQ( integers.float_values_size(), 0 );
+    ASSERT_EQ( integers.double_values_size(), 0 );
+
+    const auto &floats = vehicleDataTest.signal_columns( 1 );
+    ASSERT_EQ( floats.relative_time_ms_deltas( 0 ), -5 );
+    ASSERT_EQ( floats.relative_time_ms_deltas( 1 ), 1 );
+    ASSERT_EQ( floats.integer_value_deltas_size(), 0 );
+    ASSERT_EQ( floats.float_values_size(), 3 );
+    ASSERT_EQ( floats.float_values( 1 ), 0.5F );
+
+    const auto &doubles = vehicleDataTest.signal_columns( 2 );
+    ASSERT_EQ( doubles.float_values_size(), 0 );
+    ASSERT_EQ( doubles.double_values_size(), 3 );
+    ASSERT_EQ( doubles.double_values( 2 ), 0.1 * 2 );
+
+    const auto &microseconds = vehicleDataTest.signal_columns( 3 );
+    ASSERT_EQ( microseconds.relative_time_ms_deltas( 0 ), 7 );
+    ASSERT_EQ( microseconds.relative_time_us_fractions_size(), 1 );
+    ASSERT_EQ( microseconds.relative_time_us_fractions( 0 ), 250 );
+    // -0.0 is not sent as integer to keep the sign
+    ASSERT_EQ( microseconds.integer_value_deltas_size(), 0 );
+    ASSERT_TRUE( std::signbit( microseconds.float_values( 0 ) ) );
+
+    ASSERT_EQ( vehicleDataTest.can_frame_columns_size(), 2 );
+    const auto &frames = vehicleDataTest.can_frame_columns( 0 );
+    ASSERT_EQ( frames.message_id(), 0x100 );
+    ASSERT_EQ( frames.interface_id(), "can0" );
+    ASSERT_EQ( frames.relative_time_ms_deltas_size(), 2 );
+    ASSERT_EQ( frames.relative_time_ms_deltas( 0 ), 1 );
+    ASSERT_EQ( frames.relative_time_ms_deltas( 1 ), 3 );
+    ASSERT_EQ( frames.frame_sizes_size(), 2 );
+    ASSERT_EQ( frames.frame_sizes( 1 ), 3 );
+    ASSERT_EQ( frames.byte_values(), std::string( "\x01\x02\x03\x04\x05\x06\x07\x08\x01\x02\x03" ) );
+    ASSERT_EQ( vehicleDataTest.can_frame_columns( 1 ).message_id(), 0x200 );
+
+    // The columns of the next payload start empty
+    protoWriter.setupVehicleData( triggeredCollectionSchemeDataPtr, 11 );
+    protoWriter.append( CollectedSignal( 3, testTriggerTime, 1.0 ) );
+    ASSERT_TRUE( protoWriter.serializeVehicleData( &out ) );
+    ASSERT_TRUE( vehicleDataTest.ParseFromString( out ) );
+    ASSERT_EQ( vehicleDataTest.signal_columns_size(), 1 );
+    ASSERT_EQ( vehicleDataTest.signal_columns( 0 ).signal_id(), 3 );
+    ASSERT_EQ( vehicleDataTest.signal_columns( 0 ).integer_value_deltas_size(), 1 );
+    ASSERT_EQ( vehicleDataTest.can_frame_columns_size(), 0 );
+}
+
+TEST_F( DataCollectionProtoWriterTest, SharedCollectionEvents )
+{
+    CANInterfaceIDTranslator canIDTranslator;
+    DataCollectionProtoWriter protoWriter( canIDTranslator );
+
+    auto triggeredCollectionSchemeDataPtr = std::make_shared<TriggeredCollectionSchemeData>();
+    triggeredCollectionSchemeDataPtr->metaData.collectionSchemeID = "123";
+    triggeredCollectionSchemeDataPtr->metaData.decoderID = "456";
+    triggeredCollectionSchemeDataPtr->triggerTime = 1000;
+    SharedCollectionEvent sharedEvent;
+    sharedEvent.collectionSchemeID = "789";
+    sharedEvent.triggerTime = 990;
+    sharedEvent.eventID = 42;
+    sharedEvent.signalIDs = { 1, 2 };
+    sharedEvent.canFrameIDs = { 0x100 };
+    triggeredCollectionSchemeDataPtr->sharedEvents.emplace_back( sharedEvent );
+
+    protoWriter.setupVehicleData( triggeredCollectionSchemeDataPtr, 7 );
+    protoWriter.append( CollectedSignal( 1, 1000, 1.0 ) );
+    // The references are part of the estimated size
+    auto estimatedSize = protoWriter.getEstimatedSize();
+
+    std::string out;
+    EXPECT_TRUE( protoWriter.serializeVehicleData( &out ) );
+    EXPECT_EQ( out.size(), estimatedSize );
+    VehicleDataMsg::VehicleData vehicleDataTest{};
+    ASSERT_TRUE( vehicleDataTest.ParseFromString( out ) );
+    ASSERT_EQ( vehicleDataTest.collection_event_id(), 7 );
+    ASSERT_EQ( vehicleDataTest.shared_collection_events_size(), 1 );
+    const auto &event = vehicleDataTest.shared_collection_events( 0 );
+    ASSERT_EQ( event.campaign_arn(), "789" );
+    ASSERT_EQ( event.collection_event_id(), 42 );
+    ASSERT_EQ( event.collection_event_time_ms_epoch(), 990 );
+    ASSERT_EQ( event.signal_ids_size(), 2 );
+    ASSERT_EQ( event.signal_ids( 1 ), 2 );
+    ASSERT_EQ( event.can_message_ids_size(), 1 );
+    ASSERT_EQ( event.can_message_ids( 0 ), 0x100 );
+}
+
+TEST_F( DataCollectionProtoWriterTest, UploadResolution )
+{
+    CANInterfaceIDTranslator canIDTranslator;
+    DataCollectionProtoWriter protoWriter( canIDTranslator );
+
+    auto triggeredCollectionSchemeDataPtr = std::make_shared<TriggeredCollectionSchemeData>();
+    triggeredCollectionSchemeDataPtr->metaData.collectionSchemeID = "123";
+    triggeredCollectionSchemeDataPtr->metaData.decoderID = "456";
+    triggeredCollectionSchemeDataPtr->triggerTime = 1000;
+    triggeredCollectionSchemeDataPtr->metaData.uploadResolutions =
+        std::make_shared<SignalUploadResolutions>( SignalUploadResolutions{ { 1, 0.1 }, { 3, 10.0 } } );
+
+    protoWriter.setupVehicleData( triggeredCollectionSchemeDataPtr, 7 );
+    protoWriter.append( CollectedSignal( 1, 1000, 21.5499 ) );
+    protoWriter.append( CollectedSignal( 2, 1000, 21.5499 ) );
+    std::string out;
+    ASSERT_TRUE( protoWriter.serializeVehicleData( &out ) );
+    VehicleDataMsg::VehicleData vehicleDataTest{};
+    ASSERT_TRUE( vehicleDataTest.ParseFromString( out ) );
+    ASSERT_EQ( vehicleDataTest.captured_signals_size(), 2 );
+    ASSERT_EQ( vehicleDataTest.captured_signals( 0 ).double_value(), std::round( 215.499 ) * 0.1 );
+    // Signals without resolution are sent unchanged
+    ASSERT_EQ( vehicleDataTest.captured_signals( 1 ).double_value(), 21.5499 );
+
+    ASSERT_TRUE( protoWriter.setPayloadFormatVersion( DataCollectionProtoWriter::PAYLOAD_FORMAT_COLUMNS ) );
+    protoWriter.setupVehicleData( triggeredCollectionSchemeDataPtr, 8 );
+    protoWriter.append( CollectedSignal( 1, 1000, 21.5499 ) );
+    protoWriter.append( CollectedSignal( 1, 1001, 21.6001 ) );
+    protoWriter.append( CollectedSignal( 1, 1002, 21.4 ) );
+    protoWriter.append( CollectedSignal( 2, 1000, 21.5499 ) );
+    protoWriter.append( CollectedSignal( 3, 1000, 1234.0 ) );
+    protoWriter.append( CollectedSignal( 3, 1001, std::nan( "" ) ) );
+    ASSERT_TRUE( protoWriter.serializeVehicleData( &out ) );
+    ASSERT_TRUE( vehicleDataTest.ParseFromString( out ) );
+    ASSERT_EQ( vehicleDataTest.signal_columns_size(), 3 );
+
+    const auto &rounded = vehicleDataTest.signal_columns( 0 );
+    ASSERT_EQ( rounded.value_resolution(), 0.1 );
+    ASSERT_EQ( rounded.integer_value_deltas_size(), 3 );
+    ASSERT_EQ( rounded.integer_value_deltas( 0 ), 215 );
+    ASSERT_EQ( rounded.integer_value_deltas( 1 ), 1 );
+    ASSERT_EQ( rounded.integer_value_deltas( 2 ), -2 );
+
+    const auto &unchanged = vehicleDataTest.signal_columns( 1 );
+    ASSERT_EQ( unchanged.value_resolution(), 0.0 );
+    ASSERT_EQ( unchanged.double_values_size(), 1 );
+    ASSERT_EQ( unchanged.double_values( 0 ), 21.5499 );
+
+    // NaN is no multiple of the resolution, so the rounded values are sent
+    const auto &notANumber = vehicleDataTest.signal_columns( 2 );
+    ASSERT_EQ( notANumber.value_resolution(), 0.0 );
+    ASSERT_EQ( notANumber.integer_value_deltas_size(), 0 );
+    ASSERT_EQ( notANumber.float_values_size(), 0 );
+    ASSERT_EQ( notANumber.double_values_size(), 2 );
+    ASSERT_EQ( notANumber.double_values( 0 ), 1230.0 );
+    ASSERT_TRUE( std::isnan( notANumber.double_values( 1 ) ) );
+}
+
+TEST_F( DataCollectionProtoWriterTest, RawCanLog )
+{
+    CANInterfaceIDTranslator canIDTranslator;
+    canIDTranslator.add( "can0" );
+    canIDTranslator.add( "can1" );
+    DataCollectionProtoWriter protoWriter( canIDTranslator );
+
+    auto triggeredCollectionSchemeDataPtr = std::make_shared<TriggeredCollectionSchemeData>();
+    triggeredCollectionSchemeDataPtr->metaData.collectionSchemeID = "123";
+    triggeredCollectionSchemeDataPtr->metaData.decoderID = "456";
+    triggeredCollectionSchemeDataPtr->metaData.rawCanLog = true;
+    Timestamp testTriggerTime = 1000000;
+    triggeredCollectionSchemeDataPtr->triggerTime = testTriggerTime;
+    protoWriter.setupVehicleData( triggeredCollectionSchemeDataPtr, 10 );
+
+    std::array<uint8_t, 8> data = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    CollectedCanRawFrame microsecondFrame( 0x80000123, 1, testTriggerTime + 2, data, 2 );
+    microsecondFrame.receiveTimeFractionUs = 5;
+    protoWriter.append( CollectedCanRawFrame( 0x100, 0, testTriggerTime - 1, data, 8 ) );
+    protoWriter.append( microsecondFrame );
+    protoWriter.append( CollectedCanRawFrame( 0x100, 0, testTriggerTime + 2, data, 0 ) );
+    protoWriter.append( CollectedSignal( 1, testTriggerTime, 1.0 ) );
+    EXPECT_EQ( protoWriter.getVehicleDataMsgCount(), 4 );
+    auto estimatedSize = protoWriter.getEstimatedSize();
+
+    std::string out;
+    ASSERT_TRUE( protoWriter.serializeVehicleData( &out ) );
+    ASSERT_GE( estimatedSize, out.size() );
+    VehicleDataMsg::VehicleData vehicleDataTest{};
+    ASSERT_TRUE( vehicleDataTest.ParseFromString( out ) );
+    ASSERT_EQ( vehicleDataTest.can_frames_size(), 0 );
+    ASSERT_EQ( vehicleDataTest.captured_signals_size(), 1 );
+    ASSERT_TRUE( vehicleDataTest.has_raw_can_log() );
+    const auto &rawCanLog = vehicleDataTest.raw_can_log();
+    ASSERT_EQ( rawCanLog.interface_ids_size(), 2 );
+    ASSERT_EQ( rawCanLog.interface_ids( 0 ), "can0" );
+    ASSERT_EQ( rawCanLog.interface_ids( 1 ), "can1" );
+    // -1000 us, interface 0, ID 0x100 as varint, 8 bytes
+    std::string expected( "\xCF\x0F\x00\x80\x02\x08\x01\x02\x03\x04\x05\x06\x07\x08", 14 );
+    // +3005 us, interface 1, ID 0x80000123 as varint, 2 bytes
+    expected += std::string( "\xFA\x2E\x01\xA3\x82\x80\x80\x08\x02\x01\x02", 11 );
+    // -5 us, interface 0, ID 0x100, no payload
+    expected += std::string( "\x09\x00\x80\x02\x00", 5 );
+    ASSERT_EQ( rawCanLog.frames(), expected );
+
+    // Without the flag the frames are sent as messages again
+    triggeredCollectionSchemeDataPtr->metaData.rawCanLog = false;
+    protoWriter.setupVehicleData( triggeredCollectionSchemeDataPtr, 11 );
+    protoWriter.append( CollectedCanRawFrame( 0x100, 0, testTriggerTime, data, 8 ) );
+    ASSERT_TRUE( protoWriter.serializeVehicleData( &out ) );
+    ASSERT_TRUE( vehicleDataTest.ParseFromString( out ) );
+    ASSERT_FALSE( vehicleDataTest.has_raw_can_log() );
+    ASSERT_EQ( vehicleDataTest.can_frames_size(), 1 );
+}
+
+TEST_F( DataCollectionProtoWriterTest, SignalSummaries )
+{
+    CANInterfaceIDTranslator canIDTranslator;
+    DataCollectionProtoWriter protoWriter( canIDTranslator );
+    auto triggeredCollectionSchemeDataPtr = std::make_shared<TriggeredCollectionSchemeData>();
+    triggeredCollectionSchemeDataPtr->metaData.collectionSchemeID = "123";
+    Timestamp testTriggerTime = 1000000;
+    triggeredCollectionSchemeDataPtr->triggerTime = testTriggerTime;
+    protoWriter.setupVehicleData( triggeredCollectionSchemeDataPtr, 10 );
+
+    SignalSummary summary{};
+    summary.signalID = 7;
+    summary.windowStartTime = testTriggerTime - 200;
+    summary.windowSizeMs = 100;
+    summary.count = 10;
+    summary.max = 9.0;
+    summary.variance = 8.25;
+    summary.histogramCounts = { 5, 5 };
+    summary.percentileValues = { 4.5, 8.9 };
+    protoWriter.append( summary );
+    EXPECT_EQ( protoWriter.getVehicleDataMsgCount(), 1 );
+    auto estimatedSize = protoWriter.getEstimatedSize();
+
+    std::string out;
+    ASSERT_TRUE( protoWriter.serializeVehicleData( &out ) );
+    ASSERT_GE( estimatedSize, out.size() );
+    VehicleDataMsg::VehicleData vehicleDataTest{};
+    ASSERT_TRUE( vehicleDataTest.ParseFromString( out ) );
+    ASSERT_EQ( vehicleDataTest.signal_summaries_size(), 1 );
+    const auto &summaryProto = vehicleDataTest.signal_summaries( 0 );
+    ASSERT_EQ( summaryProto.signal_id(), 7 );
+    ASSERT_EQ( summaryProto.relative_window_start_ms(), -200 );
+    ASSERT_EQ( summaryProto.window_period_ms(), 100 );
+    ASSERT_EQ( summaryProto.count(), 10 );
+    ASSERT_DOUBLE_EQ( summaryProto.min(), 0.0 );
+    ASSERT_DOUBLE_EQ( summaryProto.max(), 9.0 );
+    ASSERT_DOUBLE_EQ( summaryProto.variance(), 8.25 );
+    ASSERT_EQ( summaryProto.histogram_counts_size(), 2 );
+    ASSERT_EQ( summaryProto.histogram_counts( 1 ), 5 );
+    ASSERT_EQ( summaryProto.percentile_values_size(), 2 );
+    ASSERT_DOUBLE_EQ( summaryProto.percentile_values( 1 ), 8.9 );
+}
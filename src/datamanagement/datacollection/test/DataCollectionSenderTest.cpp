@@ -12,10 +12,13 @@
  */
 
 #include "DataCollectionSender.h"
+#include "UplinkAccounting.h"
 #include <boost/filesystem.hpp>
 #include <functional>
 #include <gtest/gtest.h>
 #include <list>
+#include <snappy.h>
+#include <thread>
 
 using namespace Aws::IoTFleetWise::DataManagement;
 
@@ -23,18 +26,24 @@ class MockSender : public ISender
 {
 public:
     using Callback = std::function<ConnectivityError( const std::uint8_t *buf, size_t size )>;
+    using PersistCallback = std::function<ConnectivityError( const std::vector<PayloadBufferPtr> &buffers )>;
     Callback mCallback;
+    PersistCallback mPersistCallback;
+    size_t mMaxSendSize{ 128U * 1024U };
+    bool mAlive{ true };
+    CollectionSchemeParams mLastCollectionSchemeParams;
+    std::vector<size_t> mBatchSizes;
 
     bool
     isAlive()
     {
-        return true;
+        return mAlive;
     }
 
     size_t
     getMaxSendSize() const
     {
-        return 128U * 1024U;
+        return mMaxSendSize;
     }
 
     ConnectivityError
@@ -43,7 +52,7 @@ public:
           struct Aws::IoTFleetWise::OffboardConnectivity::CollectionSchemeParams collectionSchemeParams =
               CollectionSchemeParams() )
     {
-        static_cast<void>( collectionSchemeParams ); // Currently not implemented, hence unused
+        mLastCollectionSchemeParams = collectionSchemeParams;
 
         if ( !mCallback )
         {
@@ -51,6 +60,26 @@ public:
         }
         return mCallback( buf, size );
     }
+
+    ConnectivityError
+    sendBatch( const std::vector<SendBatchItem> &items, SendBatchCallback onComplete = SendBatchCallback() ) override
+    {
+        mBatchSizes.push_back( items.size() );
+        return ISender::sendBatch( items, std::move( onComplete ) );
+    }
+
+    ConnectivityError
+    persistBuffers( const std::vector<PayloadBufferPtr> &buffers,
+                    struct Aws::IoTFleetWise::OffboardConnectivity::CollectionSchemeParams collectionSchemeParams =
+                        CollectionSchemeParams() ) override
+    {
+        static_cast<void>( collectionSchemeParams );
+        if ( !mPersistCallback )
+        {
+            return ConnectivityError::NotConfigured;
+        }
+        return mPersistCallback( buffers );
+    }
 };
 
 class DataCollectionSenderTest : public ::testing::Test
@@ -174,6 +203,222 @@ TEST_F( DataCollectionSenderTest, TestMaxMessageCountHit )
     dataCollectionSender.send( collectedDataPtr );
 }
 
+TEST_F( DataCollectionSenderTest, TestMaxMessageCountChanged )
+{
+    auto mockSender = std::make_shared<MockSender>();
+    CANInterfaceIDTranslator canIDTranslator;
+    DataCollectionSender dataCollectionSender( mockSender, true, 10, canIDTranslator, mTmpDir.generic_string() );
+    dataCollectionSender.setMaxMessageCount( 2 );
+
+    uint32_t maxMessageCount = 2;
+    mockSender->mCallback = [&]( const std::uint8_t *buf, size_t size ) -> ConnectivityError {
+        checkProtoForMaxMessages( buf, size, maxMessageCount );
+        return ConnectivityError::Success;
+    };
+
+    dataCollectionSender.send( collectedDataPtr );
+}
+
+TEST_F( DataCollectionSenderTest, TestPayloadsFilledToMaxSendSize )
+{
+    for ( auto compress : { false, true } )
+    {
+        auto mockSender = std::make_shared<MockSender>();
+        mockSender->mMaxSendSize = 4096;
+        CANInterfaceIDTranslator canIDTranslator;
+        // Message count limit above the number of samples, so the payloads are only split by size
+        DataCollectionSender dataCollectionSender(
+            mockSender, false, 100000, canIDTranslator, mTmpDir.generic_string() );
+        ASSERT_FALSE( dataCollectionSender.setTargetFillRatio( 0.0 ) );
+        ASSERT_FALSE( dataCollectionSender.setTargetFillRatio( 1.5 ) );
+        ASSERT_TRUE( dataCollectionSender.setTargetFillRatio( 0.9 ) );
+
+        auto collectedData = std::make_shared<TriggeredCollectionSchemeData>();
+        collectedData->metaData.collectionSchemeID = "123";
+        collectedData->metaData.decoderID = "456";
+        collectedData->metaData.compress = compress;
+        collectedData->triggerTime = 100000;
+        for ( int i = 0; i < 10000; i++ )
+        {
+            collectedData->signals.emplace_back( i % 10, 100000 + i, static_cast<double>( i % 100 ) );
+        }
+
+        std::vector<size_t> payloadSizes;
+        size_t sampleCount = 0;
+        mockSender->mCallback = [&]( const std::uint8_t *buf, size_t size ) -> ConnectivityError {
+            std::string uncompressed( reinterpret_cast<const char *>( buf ), size );
+            if ( compress )
+            {
+                EXPECT_TRUE( snappy::Uncompress( reinterpret_cast<const char *>( buf ), size, &uncompressed ) );
+            }
+            VehicleDataMsg::VehicleData vehicleData;
+            EXPECT_TRUE( vehicleData.ParseFromString( uncompressed ) );
+            sampleCount += static_cast<size_t>( vehicleData.captured_signals_size() );
+            payloadSizes.push_back( size );
+            return ConnectivityError::Success;
+        };
+        dataCollectionSender.send( collectedData );
+
+        ASSERT_EQ( sampleCount, collectedData->signals.size() );
+        ASSERT_GT( payloadSizes.size(), 2U );
+        for ( size_t i = 0; i < payloadSizes.size(); i++ )
+        {
+            EXPECT_LE( payloadSizes[i], mockSender->mMaxSendSize );
+            // The first compressed payload is sent before any compression ratio is known
+            if ( ( i > 1U ) && ( i < payloadSizes.size() - 1U ) )
+            {
+                EXPECT_GE( payloadSizes[i], mockSender->mMaxSendSize * 7U / 10U );
+            }
+        }
+    }
+}
+
+TEST_F( DataCollectionSenderTest, TestPayloadsOfTriggerSentAsOneBatch )
+{
+    auto mockSender = std::make_shared<MockSender>();
+    CANInterfaceIDTranslator canIDTranslator;
+    DataCollectionSender dataCollectionSender( mockSender, false, 2, canIDTranslator, mTmpDir.generic_string() );
+
+    size_t sendCount = 0;
+    mockSender->mCallback = [&]( const std::uint8_t *buf, size_t size ) -> ConnectivityError {
+        checkProtoForMaxMessages( buf, size, 2 );
+        sendCount++;
+        return ConnectivityError::Success;
+    };
+    dataCollectionSender.send( collectedDataPtr );
+    // 3 signals, 3 frames and 2 DTCs in payloads of 2 messages
+    ASSERT_EQ( mockSender->mBatchSizes, std::vector<size_t>{ sendCount } );
+    ASSERT_GT( sendCount, 1U );
+
+    // A trigger with one payload is sent on its own
+    mockSender->mCallback = [&]( const std::uint8_t *buf, size_t size ) -> ConnectivityError {
+        checkProto( buf, size );
+        return ConnectivityError::Success;
+    };
+    dataCollectionSender.setMaxMessageCount( 10 );
+    dataCollectionSender.send( collectedDataPtr );
+    ASSERT_EQ( mockSender->mBatchSizes.size(), 1U );
+}
+
+TEST_F( DataCollectionSenderTest, TestPayloadsOfTriggerNumbered )
+{
+    auto mockSender = std::make_shared<MockSender>();
+    CANInterfaceIDTranslator canIDTranslator;
+    DataCollectionSender dataCollectionSender( mockSender, false, 2, canIDTranslator, mTmpDir.generic_string() );
+
+    std::vector<VehicleDataMsg::VehicleData> payloads;
+    mockSender->mCallback = [&]( const std::uint8_t *buf, size_t size ) -> ConnectivityError {
+        VehicleDataMsg::VehicleData vehicleData;
+        EXPECT_TRUE( vehicleData.ParseFromArray( buf, static_cast<int>( size ) ) );
+        payloads.push_back( vehicleData );
+        return ConnectivityError::Success;
+    };
+    dataCollectionSender.send( collectedDataPtr );
+
+    // 3 signals, 3 frames, 2 DTCs and the geohash in payloads of 2 messages, all of them tell the number of parts
+    ASSERT_EQ( payloads.size(), 5U );
+    for ( size_t i = 0; i < payloads.size(); i++ )
+    {
+        EXPECT_EQ( payloads[i].payload_part(), i );
+        EXPECT_EQ( payloads[i].payload_part_count(), payloads.size() );
+    }
+
+    // Without the geohash the last message fills the last payload, no empty payload is sent after it
+    payloads.clear();
+    collectedDataPtr->mGeohashInfo = GeohashInfo();
+    dataCollectionSender.send( collectedDataPtr );
+    ASSERT_EQ( payloads.size(), 4U );
+    for ( size_t i = 0; i < payloads.size(); i++ )
+    {
+        EXPECT_EQ( payloads[i].payload_part(), i );
+        EXPECT_EQ( payloads[i].payload_part_count(), payloads.size() );
+    }
+    EXPECT_EQ( payloads.back().dtc_data().active_dtc_codes_size(), 2 );
+
+    // A trigger with one payload is not numbered
+    payloads.clear();
+    dataCollectionSender.setMaxMessageCount( 10 );
+    dataCollectionSender.send( collectedDataPtr );
+    ASSERT_EQ( payloads.size(), 1U );
+    ASSERT_EQ( payloads[0].payload_part(), 0U );
+    ASSERT_EQ( payloads[0].payload_part_count(), 0U );
+}
+
+TEST_F( DataCollectionSenderTest, TestPayloadBuffersReused )
+{
+    auto mockSender = std::make_shared<MockSender>();
+    CANInterfaceIDTranslator canIDTranslator;
+    DataCollectionSender dataCollectionSender( mockSender, false, 10, canIDTranslator, mTmpDir.generic_string() );
+
+    std::vector<const std::uint8_t *> buffers;
+    mockSender->mCallback = [&]( const std::uint8_t *buf, size_t size ) -> ConnectivityError {
+        checkProto( buf, size );
+        buffers.push_back( buf );
+        return ConnectivityError::Success;
+    };
+    dataCollectionSender.send( collectedDataPtr );
+    dataCollectionSender.send( collectedDataPtr );
+
+    // The sender released the buffer of the first payload, so it is reused for the second one
+    ASSERT_EQ( buffers.size(), 2U );
+    ASSERT_EQ( buffers[0], buffers[1] );
+}
+
+TEST_F( DataCollectionSenderTest, TestCompressionCodecOfCollectionScheme )
+{
+    for ( auto codec : { CompressionCodecType::SNAPPY, CompressionCodecType::LZ4, CompressionCodecType::ZSTD } )
+    {
+        auto mockSender = std::make_shared<MockSender>();
+        CANInterfaceIDTranslator canIDTranslator;
+        DataCollectionSender dataCollectionSender( mockSender, false, 10, canIDTranslator, mTmpDir.generic_string() );
+        collectedDataPtr->metaData.compress = true;
+        collectedDataPtr->metaData.compressionCodec = codec;
+
+        // Codecs not enabled at build time fall back to snappy
+        auto expectedCodec = isCompressionCodecSupported( codec ) ? codec : CompressionCodecType::SNAPPY;
+        auto decompressor = createCompressionCodec( expectedCodec );
+        ASSERT_NE( decompressor, nullptr );
+        int payloadCount = 0;
+        mockSender->mCallback = [&]( const std::uint8_t *buf, size_t size ) -> ConnectivityError {
+            std::vector<uint8_t> uncompressed;
+            EXPECT_TRUE( decompressor->decompress( buf, size, uncompressed ) );
+            checkProto( uncompressed.data(), uncompressed.size() );
+            payloadCount++;
+            return ConnectivityError::Success;
+        };
+        dataCollectionSender.send( collectedDataPtr );
+        ASSERT_EQ( payloadCount, 1 );
+    }
+}
+
+TEST_F( DataCollectionSenderTest, TestAdaptiveCompressionOverridesCodecOfCollectionScheme )
+{
+    auto mockSender = std::make_shared<MockSender>();
+    CANInterfaceIDTranslator canIDTranslator;
+    DataCollectionSender dataCollectionSender( mockSender, false, 10, canIDTranslator, mTmpDir.generic_string() );
+    AdaptiveCompressionConfig config;
+    config.fastest = { CompressionCodecType::ZSTD, 1 };
+    config.strongest = { CompressionCodecType::SNAPPY, 0 };
+    ASSERT_FALSE( dataCollectionSender.setAdaptiveCompression( config ) );
+    // The only setting within the bounds
+    config.fastest = { CompressionCodecType::SNAPPY, 0 };
+    ASSERT_TRUE( dataCollectionSender.setAdaptiveCompression( config ) );
+
+    collectedDataPtr->metaData.compress = true;
+    collectedDataPtr->metaData.compressionCodec = CompressionCodecType::ZSTD;
+    auto decompressor = createCompressionCodec( CompressionCodecType::SNAPPY );
+    int payloadCount = 0;
+    mockSender->mCallback = [&]( const std::uint8_t *buf, size_t size ) -> ConnectivityError {
+        std::vector<uint8_t> uncompressed;
+        EXPECT_TRUE( decompressor->decompress( buf, size, uncompressed ) );
+        checkProto( uncompressed.data(), uncompressed.size() );
+        payloadCount++;
+        return ConnectivityError::Success;
+    };
+    dataCollectionSender.send( collectedDataPtr );
+    ASSERT_EQ( payloadCount, 1 );
+}
+
 TEST_F( DataCollectionSenderTest, TestTransmitPayload )
 {
     auto mockSender = std::make_shared<MockSender>();
@@ -189,3 +434,236 @@ TEST_F( DataCollectionSenderTest, TestTransmitPayload )
     };
     ASSERT_EQ( dataCollectionSender.transmit( testProto ), ConnectivityError::Success );
 }
+
+TEST_F( DataCollectionSenderTest, TestTransmitPersistedPayload )
+{
+    auto mockSender = std::make_shared<MockSender>();
+    CANInterfaceIDTranslator canIDTranslator;
+    DataCollectionSender dataCollectionSender( mockSender, true, 10, canIDTranslator, mTmpDir.generic_string() );
+
+    PayloadBufferPool pool;
+    auto payload = pool.acquire();
+    std::string testProto = "abcdefjh!24$iklmnop!24$3@qrstuvwxyz";
+    payload->assign( testProto.begin(), testProto.end() );
+    const auto *sentData = payload->data();
+
+    mockSender->mCallback = [&]( const std::uint8_t *buf, size_t size ) -> ConnectivityError {
+        // The retrieved buffer is sent as it is, without copying
+        EXPECT_EQ( buf, sentData );
+        EXPECT_EQ( size, testProto.size() );
+        return ConnectivityError::Success;
+    };
+    ASSERT_EQ( dataCollectionSender.transmitPersisted( std::move( payload ) ), ConnectivityError::Success );
+    ASSERT_EQ( pool.getPooledBufferCount(), 1 );
+}
+
+TEST_F( DataCollectionSenderTest, TestPayloadsPersistedTogetherWhileOffline )
+{
+    auto mockSender = std::make_shared<MockSender>();
+    mockSender->mMaxSendSize = 4096;
+    mockSender->mAlive = false;
+    CANInterfaceIDTranslator canIDTranslator;
+    DataCollectionSender dataCollectionSender( mockSender, false, 100000, canIDTranslator, mTmpDir.generic_string() );
+
+    auto collectedData = std::make_shared<TriggeredCollectionSchemeData>();
+    collectedData->metaData.collectionSchemeID = "123";
+    collectedData->metaData.decoderID = "456";
+    collectedData->metaData.compress = true;
+    collectedData->metaData.persist = true;
+    collectedData->triggerTime = 100000;
+    for ( int i = 0; i < 10000; i++ )
+    {
+        collectedData->signals.emplace_back( i % 10, 100000 + i, static_cast<double>( i % 100 ) );
+    }
+
+    int sendCount = 0;
+    mockSender->mCallback = [&]( const std::uint8_t *buf, size_t size ) -> ConnectivityError {
+        static_cast<void>( buf );
+        static_cast<void>( size );
+        sendCount++;
+        return ConnectivityError::NoConnection;
+    };
+    int persistCount = 0;
+    size_t sampleCount = 0;
+    size_t payloadCount = 0;
+    mockSender->mPersistCallback = [&]( const std::vector<PayloadBufferPtr> &buffers ) -> ConnectivityError {
+        persistCount++;
+        payloadCount = buffers.size();
+        for ( const auto &buffer : buffers )
+        {
+            // Payloads are persisted as they would have been published, compressed and within the size limit
+            EXPECT_LE( buffer->size(), mockSender->mMaxSendSize );
+            std::string uncompressed;
+            EXPECT_TRUE(
+                snappy::Uncompress( reinterpret_cast<const char *>( buffer->data() ), buffer->size(), &uncompressed ) );
+            VehicleDataMsg::VehicleData vehicleData;
+            EXPECT_TRUE( vehicleData.ParseFromString( uncompressed ) );
+            sampleCount += static_cast<size_t>( vehicleData.captured_signals_size() );
+        }
+        return ConnectivityError::Success;
+    };
+    dataCollectionSender.send( collectedData );
+
+    ASSERT_EQ( sendCount, 0 );
+    ASSERT_EQ( persistCount, 1 );
+    ASSERT_GT( payloadCount, 1U );
+    ASSERT_EQ( sampleCount, collectedData->signals.size() );
+
+    // Without persistency of the sender the payloads are sent on their own
+    mockSender->mPersistCallback = nullptr;
+    dataCollectionSender.send( collectedData );
+    ASSERT_EQ( sendCount, static_cast<int>( payloadCount ) );
+
+    // Schemes that do not persist their data are never batched
+    mockSender->mPersistCallback = [&]( const std::vector<PayloadBufferPtr> &buffers ) -> ConnectivityError {
+        static_cast<void>( buffers );
+        persistCount++;
+        return ConnectivityError::Success;
+    };
+    collectedData->metaData.persist = false;
+    dataCollectionSender.send( collectedData );
+    ASSERT_EQ( persistCount, 1 );
+}
+
+TEST_F( DataCollectionSenderTest, TestAggregationOfSmallPayloads )
+{
+    auto mockSender = std::make_shared<MockSender>();
+    CANInterfaceIDTranslator canIDTranslator;
+    DataCollectionSender dataCollectionSender( mockSender, false, 100, canIDTranslator, mTmpDir.generic_string() );
+    ASSERT_FALSE( dataCollectionSender.setAggregationClasses( { { 5, 0, 100 } } ) );
+    ASSERT_FALSE( dataCollectionSender.setAggregationClasses( { { 5, 2000, 0 } } ) );
+    ASSERT_TRUE( dataCollectionSender.setAggregationClasses( { { 5, 2000, 100000 } } ) );
+
+    std::vector<VehicleDataMsg::VehicleData> payloads;
+    mockSender->mCallback = [&]( const std::uint8_t *buf, size_t size ) -> ConnectivityError {
+        EXPECT_LE( size, 2000 );
+        VehicleDataMsg::VehicleData vehicleData;
+        EXPECT_TRUE( vehicleData.ParseFromArray( buf, static_cast<int>( size ) ) );
+        payloads.push_back( vehicleData );
+        return ConnectivityError::Success;
+    };
+
+    // Priority class 5 and below is aggregated
+    collectedDataPtr->metaData.priority = 1;
+    for ( uint32_t eventID = 1; eventID <= 3; eventID++ )
+    {
+        collectedDataPtr->eventID = eventID;
+        dataCollectionSender.send( collectedDataPtr );
+    }
+    ASSERT_TRUE( payloads.empty() );
+    auto timeToFlushMs = dataCollectionSender.flushAggregates();
+    ASSERT_GT( timeToFlushMs, 0 );
+    ASSERT_LE( timeToFlushMs, 100000 );
+    ASSERT_TRUE( payloads.empty() );
+
+    // Above all classes the payload is sent right away
+    collectedDataPtr->metaData.priority = 6;
+    collectedDataPtr->eventID = 4;
+    dataCollectionSender.send( collectedDataPtr );
+    ASSERT_EQ( payloads.size(), 1 );
+    ASSERT_EQ( payloads[0].collection_event_id(), 4 );
+    ASSERT_EQ( payloads[0].aggregated_vehicle_data_size(), 0 );
+
+    ASSERT_EQ( dataCollectionSender.flushAggregates( true ), 0 );
+    ASSERT_EQ( payloads.size(), 2 );
+    ASSERT_EQ( payloads[1].collection_event_id(), 1 );
+    ASSERT_EQ( payloads[1].captured_signals_size(), 3 );
+    ASSERT_EQ( payloads[1].aggregated_vehicle_data_size(), 2 );
+    for ( int i = 0; i < 2; i++ )
+    {
+        const auto &aggregated = payloads[1].aggregated_vehicle_data( i );
+        ASSERT_EQ( aggregated.collection_event_id(), static_cast<uint32_t>( i + 2 ) );
+        ASSERT_EQ( aggregated.campaign_arn(), "123" );
+        ASSERT_EQ( aggregated.captured_signals_size(), 3 );
+        ASSERT_EQ( aggregated.can_frames_size(), 3 );
+        ASSERT_EQ( aggregated.dtc_data().active_dtc_codes_size(), 2 );
+    }
+
+    // An aggregate is sent once the next payload does not fit into the max bytes anymore
+    payloads.clear();
+    collectedDataPtr->metaData.priority = 5;
+    for ( uint32_t eventID = 1; eventID <= 100; eventID++ )
+    {
+        collectedDataPtr->eventID = eventID;
+        dataCollectionSender.send( collectedDataPtr );
+    }
+    dataCollectionSender.flushAggregates( true );
+    ASSERT_GT( payloads.size(), 1 );
+    int eventCount = 0;
+    for ( const auto &payload : payloads )
+    {
+        eventCount += 1 + payload.aggregated_vehicle_data_size();
+    }
+    ASSERT_EQ( eventCount, 100 );
+}
+
+TEST_F( DataCollectionSenderTest, TestUplinkAccountingPerCollectionScheme )
+{
+    auto mockSender = std::make_shared<MockSender>();
+    CANInterfaceIDTranslator canIDTranslator;
+    DataCollectionSender dataCollectionSender( mockSender, false, 100, canIDTranslator, mTmpDir.generic_string() );
+    size_t sentBytes = 0;
+    mockSender->mCallback = [&]( const std::uint8_t *buf, size_t size ) -> ConnectivityError {
+        static_cast<void>( buf );
+        sentBytes += size;
+        return ConnectivityError::Success;
+    };
+    auto &accounting = UplinkAccounting::get();
+    auto accountA = accounting.getAccountId( "senderUplinkA" );
+    auto accountB = accounting.getAccountId( "senderUplinkB" );
+    auto serializedBytes = accounting.getTotal( accountA, UplinkCounter::SERIALIZED_BYTES );
+    auto compressedBytes = accounting.getTotal( accountA, UplinkCounter::COMPRESSED_BYTES );
+
+    collectedDataPtr->metaData.collectionSchemeID = "senderUplinkA";
+    dataCollectionSender.send( collectedDataPtr );
+    ASSERT_GT( sentBytes, 0 );
+    ASSERT_EQ( mockSender->mLastCollectionSchemeParams.accountId, accountA );
+    ASSERT_EQ( accounting.getTotal( accountA, UplinkCounter::SERIALIZED_BYTES ) - serializedBytes, sentBytes );
+    // Not compressed, so the serialized payload is handed over
+    ASSERT_EQ( accounting.getTotal( accountA, UplinkCounter::COMPRESSED_BYTES ) - compressedBytes, sentBytes );
+
+    // An aggregate is accounted to the collection scheme with the most bytes in it
+    ASSERT_TRUE( dataCollectionSender.setAggregationClasses( { { 5, 100000, 100000 } } ) );
+    collectedDataPtr->metaData.collectionSchemeID = "senderUplinkB";
+    dataCollectionSender.send( collectedDataPtr );
+    collectedDataPtr->metaData.collectionSchemeID = "senderUplinkA";
+    dataCollectionSender.send( collectedDataPtr );
+    dataCollectionSender.send( collectedDataPtr );
+    ASSERT_EQ( dataCollectionSender.flushAggregates( true ), 0 );
+    ASSERT_EQ( mockSender->mLastCollectionSchemeParams.accountId, accountA );
+    ASSERT_GT( accounting.getTotal( accountB, UplinkCounter::SERIALIZED_BYTES ), 0 );
+}
+
+TEST_F( DataCollectionSenderTest, TestAggregateSentAfterMaxDelay )
+{
+    for ( auto compress : { false, true } )
+    {
+        auto mockSender = std::make_shared<MockSender>();
+        CANInterfaceIDTranslator canIDTranslator;
+        DataCollectionSender dataCollectionSender( mockSender, false, 100, canIDTranslator, mTmpDir.generic_string() );
+        ASSERT_TRUE( dataCollectionSender.setAggregationClasses( { { 10, 100000, 20 } } ) );
+        collectedDataPtr->metaData.compress = compress;
+
+        int payloadCount = 0;
+        mockSender->mCallback = [&]( const std::uint8_t *buf, size_t size ) -> ConnectivityError {
+            std::string uncompressed( reinterpret_cast<const char *>( buf ), size );
+            if ( compress )
+            {
+                EXPECT_TRUE( snappy::Uncompress( reinterpret_cast<const char *>( buf ), size, &uncompressed ) );
+            }
+            VehicleDataMsg::VehicleData vehicleData;
+            EXPECT_TRUE( vehicleData.ParseFromString( uncompressed ) );
+            EXPECT_EQ( vehicleData.aggregated_vehicle_data_size(), 1 );
+            payloadCount++;
+            return ConnectivityError::Success;
+        };
+        dataCollectionSender.send( collectedDataPtr );
+        dataCollectionSender.send( collectedDataPtr );
+        ASSERT_GT( dataCollectionSender.flushAggregates(), 0 );
+        ASSERT_EQ( payloadCount, 0 );
+
+        std::this_thread::sleep_for( std::chrono::milliseconds( 30 ) );
+        ASSERT_EQ( dataCollectionSender.flushAggregates(), 0 );
+        ASSERT_EQ( payloadCount, 1 );
+    }
+}
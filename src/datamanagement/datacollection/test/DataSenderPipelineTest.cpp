@@ -0,0 +1,170 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "DataSenderPipeline.h"
+#include <atomic>
+#include <boost/filesystem.hpp>
+#include <condition_variable>
+#include <gtest/gtest.h>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+
+using namespace Aws::IoTFleetWise::DataManagement;
+
+class MockPipelineSender : public ISender
+{
+public:
+    bool
+    isAlive() override
+    {
+        return true;
+    }
+
+    size_t
+    getMaxSendSize() const override
+    {
+        return 128U * 1024U;
+    }
+
+    ConnectivityError
+    send( const std::uint8_t *buf,
+          size_t size,
+          struct CollectionSchemeParams collectionSchemeParams = CollectionSchemeParams() ) override
+    {
+        static_cast<void>( collectionSchemeParams );
+        VehicleDataMsg::VehicleData vehicleData;
+        EXPECT_TRUE( vehicleData.ParseFromArray( buf, static_cast<int>( size ) ) );
+        // Blocks the publish thread until the test releases it
+        std::unique_lock<std::mutex> lock( mMutex );
+        mReleased.wait( lock, [this]() { return mRelease; } );
+        mSignalsPerEvent[vehicleData.collection_event_id()] +=
+            static_cast<uint32_t>( vehicleData.captured_signals_size() );
+        mThreadIds.insert( std::this_thread::get_id() );
+        return ConnectivityError::Success;
+    }
+
+    void
+    release()
+    {
+        {
+            std::lock_guard<std::mutex> lock( mMutex );
+            mRelease = true;
+        }
+        mReleased.notify_all();
+    }
+
+    std::mutex mMutex;
+    std::condition_variable mReleased;
+    bool mRelease{ false };
+    std::map<uint32_t, uint32_t> mSignalsPerEvent;
+    std::set<std::thread::id> mThreadIds;
+};
+
+class DataSenderPipelineTest : public ::testing::Test
+{
+protected:
+    std::shared_ptr<TriggeredCollectionSchemeData>
+    createCollectedData( uint32_t eventID, uint32_t signalCount )
+    {
+        auto collectedData = std::make_shared<TriggeredCollectionSchemeData>();
+        collectedData->metaData.collectionSchemeID = "123";
+        collectedData->metaData.decoderID = "456";
+        collectedData->triggerTime = 800;
+        collectedData->eventID = eventID;
+        for ( uint32_t i = 0; i < signalCount; i++ )
+        {
+            collectedData->signals.emplace_back( i, 800 + i, static_cast<double>( i ) );
+        }
+        return collectedData;
+    }
+
+    DataSenderPipeline::SenderFactory
+    createSenderFactory( uint32_t maxMessageCount )
+    {
+        return [this, maxMessageCount]( std::shared_ptr<ISender> sender ) {
+            return std::make_unique<DataCollectionSender>(
+                sender, false, maxMessageCount, mCanIDTranslator, mTmpDir.generic_string() );
+        };
+    }
+
+    CANInterfaceIDTranslator mCanIDTranslator;
+    boost::filesystem::path mTmpDir = boost::filesystem::temp_directory_path();
+};
+
+TEST_F( DataSenderPipelineTest, AllTriggersPublished )
+{
+    auto mockSender = std::make_shared<MockPipelineSender>();
+    mockSender->release();
+    DataSenderPipeline pipeline( mockSender, 3, 4, createSenderFactory( 10 ) );
+    ASSERT_EQ( pipeline.getWorkerCount(), 3 );
+    ASSERT_TRUE( pipeline.start() );
+    ASSERT_TRUE( pipeline.isAlive() );
+    for ( uint32_t eventID = 1; eventID <= 20; eventID++ )
+    {
+        ASSERT_TRUE( pipeline.submit( createCollectedData( eventID, 25 ) ) );
+    }
+    // Stop sends the queued data
+    ASSERT_TRUE( pipeline.stop() );
+    ASSERT_FALSE( pipeline.isAlive() );
+
+    ASSERT_EQ( mockSender->mSignalsPerEvent.size(), 20 );
+    for ( const auto &event : mockSender->mSignalsPerEvent )
+    {
+        ASSERT_EQ( event.second, 25 );
+    }
+    // Everything is published from the publish thread
+    ASSERT_EQ( mockSender->mThreadIds.size(), 1 );
+    ASSERT_EQ( mockSender->mThreadIds.count( std::this_thread::get_id() ), 0 );
+    ASSERT_FALSE( pipeline.submit( createCollectedData( 21, 1 ) ) );
+}
+
+TEST_F( DataSenderPipelineTest, SubmitBlocksWhenQueuesAreFull )
+{
+    auto mockSender = std::make_shared<MockPipelineSender>();
+    DataSenderPipeline pipeline( mockSender, 1, 1, createSenderFactory( 10 ) );
+    ASSERT_TRUE( pipeline.start() );
+
+    // The publish thread is blocked in the sender, so at most the publish queue, the worker and the input queue take
+    // data before submit blocks
+    std::atomic<uint32_t> submitted{ 0 };
+    std::thread producer( [&]() {
+        for ( uint32_t eventID = 1; eventID <= 10; eventID++ )
+        {
+            pipeline.submit( createCollectedData( eventID, 5 ) );
+            submitted++;
+        }
+    } );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 200 ) );
+    EXPECT_LT( submitted.load(), 10 );
+
+    mockSender->release();
+    producer.join();
+    ASSERT_TRUE( pipeline.stop() );
+    ASSERT_EQ( mockSender->mSignalsPerEvent.size(), 10 );
+}
+
+TEST_F( DataSenderPipelineTest, RestartAfterStop )
+{
+    auto mockSender = std::make_shared<MockPipelineSender>();
+    mockSender->release();
+    DataSenderPipeline pipeline( mockSender, 2, 4, createSenderFactory( 10 ) );
+    ASSERT_TRUE( pipeline.start() );
+    ASSERT_TRUE( pipeline.submit( createCollectedData( 1, 5 ) ) );
+    ASSERT_TRUE( pipeline.stop() );
+    ASSERT_TRUE( pipeline.start() );
+    ASSERT_TRUE( pipeline.submit( createCollectedData( 2, 5 ) ) );
+    ASSERT_TRUE( pipeline.stop() );
+    ASSERT_EQ( mockSender->mSignalsPerEvent.size(), 2 );
+}
@@ -0,0 +1,127 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "ExpressDataSender.h"
+#include <boost/filesystem.hpp>
+#include <gtest/gtest.h>
+#include <mutex>
+#include <set>
+#include <thread>
+
+using namespace Aws::IoTFleetWise::DataManagement;
+
+class MockExpressSender : public ISender
+{
+public:
+    bool
+    isAlive() override
+    {
+        return true;
+    }
+
+    size_t
+    getMaxSendSize() const override
+    {
+        return 128U * 1024U;
+    }
+
+    ConnectivityError
+    send( const std::uint8_t *buf,
+          size_t size,
+          struct CollectionSchemeParams collectionSchemeParams = CollectionSchemeParams() ) override
+    {
+        VehicleDataMsg::VehicleData vehicleData;
+        EXPECT_TRUE( vehicleData.ParseFromArray( buf, static_cast<int>( size ) ) );
+        std::lock_guard<std::mutex> lock( mMutex );
+        mEventIDs.insert( vehicleData.collection_event_id() );
+        mAllExpress = mAllExpress && collectionSchemeParams.express;
+        mThreadIds.insert( std::this_thread::get_id() );
+        return ConnectivityError::Success;
+    }
+
+    std::mutex mMutex;
+    std::set<uint32_t> mEventIDs;
+    bool mAllExpress{ true };
+    std::set<std::thread::id> mThreadIds;
+};
+
+class ExpressDataSenderTest : public ::testing::Test
+{
+protected:
+    std::shared_ptr<TriggeredCollectionSchemeData>
+    createCollectedData( uint32_t eventID )
+    {
+        auto collectedData = std::make_shared<TriggeredCollectionSchemeData>();
+        collectedData->metaData.collectionSchemeID = "123";
+        collectedData->metaData.decoderID = "456";
+        collectedData->metaData.express = true;
+        collectedData->triggerTime = 800;
+        collectedData->eventID = eventID;
+        collectedData->signals.emplace_back( 1, 800, 1.0 );
+        return collectedData;
+    }
+
+    std::unique_ptr<DataCollectionSender>
+    createDataCollectionSender( std::shared_ptr<ISender> sender )
+    {
+        return std::make_unique<DataCollectionSender>( sender, false, 10, mCanIDTranslator, mTmpDir.generic_string() );
+    }
+
+    CANInterfaceIDTranslator mCanIDTranslator;
+    boost::filesystem::path mTmpDir = boost::filesystem::temp_directory_path();
+};
+
+TEST_F( ExpressDataSenderTest, QueuedDataPublished )
+{
+    auto mockSender = std::make_shared<MockExpressSender>();
+    ExpressDataSender expressSender( createDataCollectionSender( mockSender ), 4 );
+    auto queue = expressSender.getQueue();
+    ASSERT_TRUE( expressSender.start() );
+    ASSERT_TRUE( expressSender.isAlive() );
+    for ( uint32_t eventID = 1; eventID <= 10; eventID++ )
+    {
+        ASSERT_TRUE( queue->push( createCollectedData( eventID ) ) );
+    }
+    // Stop sends the queued data
+    ASSERT_TRUE( expressSender.stop() );
+    ASSERT_FALSE( expressSender.isAlive() );
+
+    ASSERT_EQ( mockSender->mEventIDs.size(), 10 );
+    ASSERT_TRUE( mockSender->mAllExpress );
+    // Everything is published from the express thread
+    ASSERT_EQ( mockSender->mThreadIds.size(), 1 );
+    ASSERT_EQ( mockSender->mThreadIds.count( std::this_thread::get_id() ), 0 );
+    TriggeredCollectionSchemeDataPtr data = createCollectedData( 11 );
+    ASSERT_FALSE( queue->tryPush( data ) );
+}
+
+TEST_F( ExpressDataSenderTest, FullQueueRejectsData )
+{
+    auto mockSender = std::make_shared<MockExpressSender>();
+    ExpressDataSender expressSender( createDataCollectionSender( mockSender ), 1 );
+    auto queue = expressSender.getQueue();
+    // Not started, nothing is taken out of the queue
+    TriggeredCollectionSchemeDataPtr data = createCollectedData( 1 );
+    ASSERT_TRUE( queue->tryPush( data ) );
+    data = createCollectedData( 2 );
+    ASSERT_FALSE( queue->tryPush( data ) );
+
+    ASSERT_TRUE( expressSender.start() );
+    ASSERT_TRUE( expressSender.stop() );
+    ASSERT_EQ( mockSender->mEventIDs.size(), 1 );
+    // Restarted after stop
+    ASSERT_TRUE( expressSender.start() );
+    ASSERT_TRUE( queue->push( createCollectedData( 3 ) ) );
+    ASSERT_TRUE( expressSender.stop() );
+    ASSERT_EQ( mockSender->mEventIDs.size(), 2 );
+}
@@ -0,0 +1,96 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "JSONStreamWriter.h"
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include <json/json.h>
+#include <limits>
+
+using namespace Aws::IoTFleetWise::DataManagement;
+
+namespace
+{
+std::string
+doubleToString( double value )
+{
+    std::string output;
+    JSONStreamWriter::appendDouble( output, value );
+    return output;
+}
+} // namespace
+
+/**
+ * @brief Validates that doubles are written with the fewest digits that read back to the same value
+ */
+TEST( JSONStreamWriterTest, DoublesRoundTrip )
+{
+    ASSERT_EQ( doubleToString( 0.0 ), "0.0" );
+    ASSERT_EQ( doubleToString( -0.0 ), "-0.0" );
+    ASSERT_EQ( doubleToString( 1.0 ), "1.0" );
+    ASSERT_EQ( doubleToString( -42.0 ), "-42.0" );
+    ASSERT_EQ( doubleToString( 0.1 ), "0.1" );
+    ASSERT_EQ( doubleToString( 1.5e-7 ), "1.5e-07" );
+    ASSERT_EQ( doubleToString( 1e300 ), "1e+300" );
+    ASSERT_EQ( doubleToString( 9007199254740992.0 ), "9007199254740992.0" );
+    // Needs all 17 digits
+    ASSERT_EQ( doubleToString( 0.1 + 0.2 ), "0.30000000000000004" );
+    ASSERT_EQ( doubleToString( std::numeric_limits<double>::quiet_NaN() ), "null" );
+    ASSERT_EQ( doubleToString( std::numeric_limits<double>::infinity() ), "1e+9999" );
+    ASSERT_EQ( doubleToString( -std::numeric_limits<double>::infinity() ), "-1e+9999" );
+
+    for ( double value : { 3.141592653589793, 2.0 / 3.0, 1e-310, std::numeric_limits<double>::max(), 123456.789 } )
+    {
+        ASSERT_EQ( std::strtod( doubleToString( value ).c_str(), nullptr ), value );
+    }
+}
+
+/**
+ * @brief Validates nesting, separators, integers and escaping against the jsoncpp reader
+ */
+TEST( JSONStreamWriterTest, DocumentStructure )
+{
+    JSONStreamWriter writer;
+    writer.beginObject();
+    writer.member( "unsigned", static_cast<uint64_t>( 18446744073709551615U ) );
+    writer.member( "signed", static_cast<int64_t>( -9000 ) );
+    writer.member( "text", std::string( "a\"b\\c\n\x01" ) );
+    writer.key( "array" );
+    writer.beginArray();
+    writer.value( static_cast<uint32_t>( 1 ) );
+    writer.beginObject();
+    writer.endObject();
+    writer.beginArray();
+    writer.endArray();
+    writer.value( 2.5 );
+    writer.endArray();
+    writer.endObject();
+    ASSERT_EQ( writer.str(),
+               "{\"unsigned\":18446744073709551615,\"signed\":-9000,\"text\":\"a\\\"b\\\\c\\n\\u0001\","
+               "\"array\":[1,{},[],2.5]}" );
+
+    Json::Value root;
+    Json::Reader reader;
+    ASSERT_TRUE( reader.parse( writer.str(), root ) );
+    ASSERT_EQ( root["unsigned"].asUInt64(), 18446744073709551615U );
+    ASSERT_EQ( root["signed"].asInt64(), -9000 );
+    ASSERT_EQ( root["text"].asString(), "a\"b\\c\n\x01" );
+    ASSERT_EQ( root["array"].size(), 4U );
+
+    // The writer is reused after clear
+    writer.clear();
+    writer.beginArray();
+    writer.value( static_cast<int64_t>( 1 ) );
+    writer.endArray();
+    ASSERT_EQ( writer.str(), "[1]" );
+}
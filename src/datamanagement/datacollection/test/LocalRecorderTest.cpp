@@ -0,0 +1,242 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "LocalRecorder.h"
+#include <algorithm>
+#include <cstdlib>
+#include <dirent.h>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace Aws::IoTFleetWise::DataManagement;
+
+class LocalRecorderTest : public ::testing::Test
+{
+protected:
+    void
+    SetUp() override
+    {
+        char directory[] = "/tmp/LocalRecorderTestXXXXXX";
+        ASSERT_NE( mkdtemp( directory ), nullptr );
+        mConfig.directory = directory;
+    }
+
+    void
+    TearDown() override
+    {
+        for ( const auto &name : listFiles( "" ) )
+        {
+            unlink( ( mConfig.directory + "/" + name ).c_str() );
+        }
+        rmdir( mConfig.directory.c_str() );
+    }
+
+    std::vector<std::string>
+    listFiles( const std::string &suffix ) const
+    {
+        std::vector<std::string> names;
+        auto *directory = opendir( mConfig.directory.c_str() );
+        for ( auto *entry = readdir( directory ); entry != nullptr; entry = readdir( directory ) )
+        {
+            std::string name( entry->d_name );
+            if ( ( name != "." ) && ( name != ".." ) && ( name.size() >= suffix.size() ) &&
+                 ( name.compare( name.size() - suffix.size(), suffix.size(), suffix ) == 0 ) )
+            {
+                names.push_back( name );
+            }
+        }
+        closedir( directory );
+        std::sort( names.begin(), names.end() );
+        return names;
+    }
+
+    void
+    readRecordings( std::vector<CollectedSignal> &signals, std::vector<CollectedCanRawFrame> &frames ) const
+    {
+        for ( const auto &name : listFiles( ".fwr" ) )
+        {
+            ASSERT_TRUE( LocalRecorder::readFile( mConfig.directory + "/" + name, signals, frames ) );
+        }
+    }
+
+    // The newest samples of a periodic trigger at the given time, the history overlaps with the previous trigger
+    static TriggeredCollectionSchemeDataPtr
+    makeData( Timestamp triggerTime, Timestamp historyMs )
+    {
+        auto data = std::make_shared<TriggeredCollectionSchemeData>();
+        data->metaData.collectionSchemeID = "recordAll";
+        data->triggerTime = triggerTime;
+        for ( auto time = triggerTime - historyMs + 1; time <= triggerTime; time++ )
+        {
+            CollectedSignal signal( 1, time, static_cast<double>( time ) * 0.5 );
+            signal.receiveTimeFractionUs = 250;
+            data->signals.push_back( signal );
+            data->signals.emplace_back( 2, time, -static_cast<double>( time ) );
+            std::array<uint8_t, 3> payload{ static_cast<uint8_t>( time ), 0xAA, 0x55 };
+            data->canFrames.emplace_back( 0x100, 1, time, payload, static_cast<uint8_t>( 1 + ( time % 3 ) ) );
+        }
+        return data;
+    }
+
+    LocalRecorder::Config mConfig;
+};
+
+TEST_F( LocalRecorderTest, OverlappingTriggersAreRecordedOnce )
+{
+    {
+        LocalRecorder recorder( mConfig );
+        recorder.record( *makeData( 1000, 100 ) );
+        recorder.record( *makeData( 1050, 100 ) );
+        recorder.record( *makeData( 1100, 100 ) );
+        // An older trigger adds nothing
+        recorder.record( *makeData( 1080, 100 ) );
+        recorder.flush( true );
+    }
+    ASSERT_EQ( listFiles( ".fwr.part" ).size(), 0 );
+    ASSERT_EQ( listFiles( ".fwr" ).size(), 1 );
+
+    std::vector<CollectedSignal> signals;
+    std::vector<CollectedCanRawFrame> frames;
+    readRecordings( signals, frames );
+    ASSERT_EQ( signals.size(), 2 * 200 );
+    ASSERT_EQ( frames.size(), 200 );
+    for ( Timestamp time = 901; time <= 1100; time++ )
+    {
+        auto signal = std::find_if( signals.begin(), signals.end(), [time]( const CollectedSignal &s ) {
+            return ( s.signalID == 1 ) && ( s.receiveTime == time );
+        } );
+        ASSERT_NE( signal, signals.end() );
+        ASSERT_DOUBLE_EQ( signal->value, static_cast<double>( time ) * 0.5 );
+        ASSERT_EQ( signal->receiveTimeFractionUs, 250 );
+        auto frame = std::find_if( frames.begin(), frames.end(), [time]( const CollectedCanRawFrame &f ) {
+            return f.receiveTime == time;
+        } );
+        ASSERT_NE( frame, frames.end() );
+        ASSERT_EQ( frame->frameID, 0x100 );
+        ASSERT_EQ( frame->channelId, 1 );
+        ASSERT_EQ( frame->size, 1 + ( time % 3 ) );
+        ASSERT_EQ( frame->data[0], static_cast<uint8_t>( time ) );
+    }
+
+    std::ifstream index( mConfig.directory + "/index.csv" );
+    std::string line;
+    ASSERT_TRUE( std::getline( index, line ) );
+    ASSERT_EQ( line.substr( 0, line.find( ',' ) ), listFiles( ".fwr" )[0] );
+    ASSERT_NE( line.find( ",901,1100,400,200," ), std::string::npos );
+}
+
+TEST_F( LocalRecorderTest, FilesAreRotatedAndOldestDeleted )
+{
+    mConfig.blockRows = 100;
+    mConfig.maxFileBytes = 1;
+    {
+        LocalRecorder recorder( mConfig );
+        for ( Timestamp time = 1000; time <= 5000; time += 1000 )
+        {
+            recorder.record( *makeData( time, 50 ) );
+        }
+        recorder.flush( true );
+    }
+    // Each block closes its file
+    auto files = listFiles( ".fwr" );
+    ASSERT_GE( files.size(), 5 );
+    std::vector<CollectedSignal> signals;
+    std::vector<CollectedCanRawFrame> frames;
+    readRecordings( signals, frames );
+    ASSERT_EQ( signals.size(), 5 * 100 );
+    ASSERT_EQ( frames.size(), 5 * 50 );
+
+    // A new recorder deletes the oldest files above the limit
+    mConfig.maxTotalBytes = 1;
+    LocalRecorder recorder( mConfig );
+    ASSERT_TRUE( recorder.start() );
+    ASSERT_TRUE( recorder.stop() );
+    ASSERT_EQ( listFiles( ".fwr" ).size(), 0 );
+}
+
+TEST_F( LocalRecorderTest, FileLeftOpenIsReadable )
+{
+    mConfig.blockRows = 10;
+    mConfig.writeChunkBytes = 1;
+    std::string leftOpen = mConfig.directory + "/recording-0000000000001-000000.fwr.part";
+    {
+        LocalRecorder recorder( mConfig );
+        recorder.record( *makeData( 1000, 20 ) );
+        recorder.flush( false );
+        // Copy of the file as it is left by a power loss
+        auto open = listFiles( ".fwr.part" );
+        ASSERT_EQ( open.size(), 1 );
+        std::ifstream source( mConfig.directory + "/" + open[0], std::ios::binary );
+        std::ofstream copy( leftOpen, std::ios::binary );
+        copy << source.rdbuf();
+    }
+    std::vector<CollectedSignal> signals;
+    std::vector<CollectedCanRawFrame> frames;
+    ASSERT_TRUE( LocalRecorder::readFile( leftOpen, signals, frames ) );
+    ASSERT_EQ( signals.size(), 40 );
+    ASSERT_EQ( frames.size(), 20 );
+
+    LocalRecorder recorder( mConfig );
+    ASSERT_TRUE( recorder.start() );
+    ASSERT_TRUE( recorder.stop() );
+    ASSERT_EQ( listFiles( ".fwr.part" ).size(), 0 );
+    ASSERT_EQ( listFiles( ".fwr" ).size(), 2 );
+
+    // A corrupted block ends the reading
+    std::string recovered = mConfig.directory + "/recording-0000000000001-000000.fwr";
+    std::fstream file( recovered, std::ios::in | std::ios::out | std::ios::binary );
+    file.seekp( LocalRecorder::FILE_HEADER_SIZE + LocalRecorder::BLOCK_HEADER_SIZE );
+    file.put( 0x42 );
+    file.close();
+    signals.clear();
+    frames.clear();
+    ASSERT_FALSE( LocalRecorder::readFile( recovered, signals, frames ) );
+}
+
+TEST_F( LocalRecorderTest, SubmittedDataIsRecordedByTheThread )
+{
+    mConfig.queueSize = 2;
+    LocalRecorder recorder( mConfig );
+    // Rejected before start
+    ASSERT_FALSE( recorder.submit( makeData( 1000, 10 ) ) );
+    ASSERT_TRUE( recorder.start() );
+    ASSERT_TRUE( recorder.isAlive() );
+    for ( Timestamp time = 2000; time <= 2100; time += 10 )
+    {
+        while ( !recorder.submit( makeData( time, 10 ) ) )
+        {
+            usleep( 1000 );
+        }
+    }
+    ASSERT_TRUE( recorder.stop() );
+    ASSERT_FALSE( recorder.isAlive() );
+    ASSERT_FALSE( recorder.submit( makeData( 3000, 10 ) ) );
+
+    std::vector<CollectedSignal> signals;
+    std::vector<CollectedCanRawFrame> frames;
+    readRecordings( signals, frames );
+    ASSERT_EQ( signals.size(), 2 * 110 );
+    ASSERT_EQ( frames.size(), 110 );
+}
+
+TEST_F( LocalRecorderTest, MissingDirectory )
+{
+    auto config = mConfig;
+    config.directory += "/missing";
+    LocalRecorder recorder( config );
+    ASSERT_FALSE( recorder.start() );
+}
@@ -0,0 +1,108 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "PersistedDataCompactor.h"
+#include "TraceModule.h"
+#include <boost/filesystem.hpp>
+#include <gtest/gtest.h>
+#include <string>
+
+using namespace Aws::IoTFleetWise::DataManagement;
+
+class PersistedDataCompactorTest : public ::testing::Test
+{
+protected:
+    void
+    SetUp() override
+    {
+        mDirectory = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+        ASSERT_TRUE( boost::filesystem::create_directories( mDirectory ) );
+        // Segments of one payload each
+        mPersistency = std::make_shared<CacheAndPersist>(
+            mDirectory.string(), 131072, SegmentedLog::RECORD_HEADER_SIZE + sizeof( PayloadHeader ) + mData.size() );
+        ASSERT_TRUE( mPersistency->init() );
+        mPayloadManager = std::make_shared<PayloadManager>( mPersistency );
+        mPayloadManager->setDeferredCompression( true );
+    }
+
+    void
+    TearDown() override
+    {
+        mPersistency->erase( DataType::EDGE_TO_CLOUD_PAYLOAD );
+        boost::filesystem::remove_all( mDirectory );
+    }
+
+    void
+    store()
+    {
+        CollectionSchemeParams collectionSchemeParams;
+        collectionSchemeParams.persist = true;
+        collectionSchemeParams.compression = false;
+        ASSERT_TRUE( mPayloadManager->storeData(
+            reinterpret_cast<const uint8_t *>( mData.data() ), mData.size(), collectionSchemeParams ) );
+    }
+
+    std::string mData = std::string( 1000, 'a' );
+    boost::filesystem::path mDirectory;
+    std::shared_ptr<CacheAndPersist> mPersistency;
+    std::shared_ptr<PayloadManager> mPayloadManager;
+};
+
+TEST_F( PersistedDataCompactorTest, CompactsClosedSegmentsOnce )
+{
+    PersistedDataCompactor compactor( mPayloadManager, mPersistency );
+    ASSERT_TRUE( isCompressionCodecSupported( compactor.getCodecType() ) );
+    for ( int i = 0; i < 3; i++ )
+    {
+        store();
+    }
+    auto sizeBefore = mPersistency->getSize( DataType::EDGE_TO_CLOUD_PAYLOAD );
+    auto compactedBytes = TraceModule::get().getAtomicVariable( TraceAtomicVariable::PERSISTENCY_COMPACTED_BYTES );
+
+    // The newest segment is still written to
+    ASSERT_TRUE( compactor.compactNext() );
+    ASSERT_TRUE( compactor.compactNext() );
+    ASSERT_FALSE( compactor.compactNext() );
+    auto savedBytes =
+        TraceModule::get().getAtomicVariable( TraceAtomicVariable::PERSISTENCY_COMPACTED_BYTES ) - compactedBytes;
+    ASSERT_EQ( mPersistency->getSize( DataType::EDGE_TO_CLOUD_PAYLOAD ), sizeBefore - savedBytes );
+
+    store();
+    ASSERT_TRUE( compactor.compactNext() );
+    ASSERT_FALSE( compactor.compactNext() );
+
+    PersistedPayloadChunk chunk;
+    for ( int i = 0; i < 4; i++ )
+    {
+        ASSERT_EQ( mPayloadManager->retrieveNext( chunk, 1 ), ErrorCode::SUCCESS );
+        ASSERT_EQ( std::string( chunk.payloads[0]->begin(), chunk.payloads[0]->end() ), mData );
+        ASSERT_EQ( mPayloadManager->acknowledge( chunk ), ErrorCode::SUCCESS );
+    }
+    ASSERT_EQ( mPayloadManager->retrieveNext( chunk, 1 ), ErrorCode::EMPTY );
+}
+
+TEST_F( PersistedDataCompactorTest, StartAndStop )
+{
+    PersistedDataCompactor compactor( mPayloadManager, mPersistency, 100.0, 10 );
+    store();
+    store();
+    ASSERT_TRUE( compactor.start() );
+    ASSERT_TRUE( compactor.isAlive() );
+    ASSERT_TRUE( compactor.stop() );
+    ASSERT_FALSE( compactor.isAlive() );
+    // The stored data is unchanged
+    std::vector<PayloadBufferPtr> payloads;
+    ASSERT_EQ( mPayloadManager->retrieveData( payloads ), ErrorCode::SUCCESS );
+    ASSERT_EQ( payloads.size(), 2 );
+    ASSERT_EQ( std::string( payloads[1]->begin(), payloads[1]->end() ), mData );
+}
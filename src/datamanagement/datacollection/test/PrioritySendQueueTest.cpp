@@ -0,0 +1,154 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "PrioritySendQueue.h"
+#include <atomic>
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace Aws::IoTFleetWise::DataManagement;
+
+class PrioritySendQueueTest : public ::testing::Test
+{
+protected:
+    bool
+    pushPayload( PrioritySendQueue &queue, uint8_t id, uint32_t priority )
+    {
+        auto buffer = mPool.acquire();
+        buffer->push_back( id );
+        CollectionSchemeParams collectionSchemeParams;
+        collectionSchemeParams.priority = priority;
+        return queue.push( std::move( buffer ), collectionSchemeParams );
+    }
+
+    PayloadBufferPool mPool;
+};
+
+TEST_F( PrioritySendQueueTest, MostImportantLevelFirst )
+{
+    PrioritySendQueue queue( { { 0, 0 }, { 5, 0 } }, 4 );
+    ASSERT_EQ( queue.getLevelCount(), 2 );
+    ASSERT_EQ( queue.getLevel( 0 ), 0 );
+    ASSERT_EQ( queue.getLevel( 3 ), 1 );
+    // Priorities above all levels belong to the last one
+    ASSERT_EQ( queue.getLevel( 100 ), 1 );
+
+    ASSERT_TRUE( pushPayload( queue, 1, 10 ) );
+    ASSERT_TRUE( pushPayload( queue, 2, 5 ) );
+    ASSERT_TRUE( pushPayload( queue, 3, 0 ) );
+    ASSERT_EQ( queue.size( 0 ), 1 );
+    ASSERT_EQ( queue.size( 1 ), 2 );
+
+    PayloadBufferPtr buffer;
+    CollectionSchemeParams collectionSchemeParams;
+    ASSERT_TRUE( queue.pop( buffer, collectionSchemeParams ) );
+    ASSERT_EQ( ( *buffer )[0], 3 );
+    ASSERT_EQ( collectionSchemeParams.priority, 0 );
+    ASSERT_TRUE( queue.pop( buffer, collectionSchemeParams ) );
+    ASSERT_EQ( ( *buffer )[0], 1 );
+    ASSERT_EQ( collectionSchemeParams.priority, 10 );
+    ASSERT_TRUE( queue.pop( buffer, collectionSchemeParams ) );
+    ASSERT_EQ( ( *buffer )[0], 2 );
+}
+
+TEST_F( PrioritySendQueueTest, InFlightLimit )
+{
+    PrioritySendQueue queue( { { 0, 0 }, { 10, 1 } }, 4 );
+    ASSERT_TRUE( pushPayload( queue, 1, 10 ) );
+    ASSERT_TRUE( pushPayload( queue, 2, 10 ) );
+
+    PayloadBufferPtr lowPriority;
+    CollectionSchemeParams collectionSchemeParams;
+    ASSERT_TRUE( queue.pop( lowPriority, collectionSchemeParams ) );
+    ASSERT_EQ( ( *lowPriority )[0], 1 );
+    ASSERT_EQ( queue.getInFlight( 1 ), 1 );
+
+    // The low priority level is at its limit, a payload of the important level is still handed out
+    ASSERT_TRUE( pushPayload( queue, 3, 0 ) );
+    PayloadBufferPtr buffer;
+    ASSERT_TRUE( queue.pop( buffer, collectionSchemeParams ) );
+    ASSERT_EQ( ( *buffer )[0], 3 );
+    buffer.reset();
+    ASSERT_EQ( queue.getInFlight( 0 ), 0 );
+
+    // The next low priority payload waits until the sender released the one in flight
+    std::atomic<bool> popped{ false };
+    std::thread consumer( [&]() {
+        PayloadBufferPtr next;
+        CollectionSchemeParams params;
+        EXPECT_TRUE( queue.pop( next, params ) );
+        EXPECT_EQ( ( *next )[0], 2 );
+        popped = true;
+    } );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+    EXPECT_FALSE( popped );
+    // Copies held by the sender, like the one of the publish completion callback, keep it in flight
+    auto callbackReference = lowPriority;
+    lowPriority.reset();
+    std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+    EXPECT_FALSE( popped );
+    callbackReference.reset();
+    consumer.join();
+    ASSERT_TRUE( popped );
+    ASSERT_EQ( queue.getInFlight( 1 ), 0 );
+    // The buffers went back to the pool
+    ASSERT_EQ( mPool.getPooledBufferCount(), 3 );
+}
+
+TEST_F( PrioritySendQueueTest, LevelsHaveSeparateCapacity )
+{
+    PrioritySendQueue queue( { { 0, 0 }, { 10, 0 } }, 1 );
+    ASSERT_TRUE( pushPayload( queue, 1, 10 ) );
+    // The full low priority queue does not block important payloads
+    ASSERT_TRUE( pushPayload( queue, 2, 0 ) );
+
+    std::atomic<bool> pushed{ false };
+    std::thread producer( [&]() {
+        EXPECT_TRUE( pushPayload( queue, 3, 10 ) );
+        pushed = true;
+    } );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+    EXPECT_FALSE( pushed );
+    PayloadBufferPtr buffer;
+    CollectionSchemeParams collectionSchemeParams;
+    ASSERT_TRUE( queue.pop( buffer, collectionSchemeParams ) );
+    ASSERT_EQ( ( *buffer )[0], 2 );
+    ASSERT_TRUE( queue.pop( buffer, collectionSchemeParams ) );
+    ASSERT_EQ( ( *buffer )[0], 1 );
+    producer.join();
+    ASSERT_TRUE( pushed );
+}
+
+TEST_F( PrioritySendQueueTest, CloseDrainsRegardlessOfInFlightLimit )
+{
+    // Without levels the queue is FIFO
+    PrioritySendQueue queue( {}, 4 );
+    ASSERT_EQ( queue.getLevelCount(), 1 );
+    PrioritySendQueue limitedQueue( { { 10, 1 } }, 4 );
+    ASSERT_TRUE( pushPayload( limitedQueue, 1, 10 ) );
+    ASSERT_TRUE( pushPayload( limitedQueue, 2, 10 ) );
+
+    PayloadBufferPtr first;
+    PayloadBufferPtr second;
+    CollectionSchemeParams collectionSchemeParams;
+    ASSERT_TRUE( limitedQueue.pop( first, collectionSchemeParams ) );
+    limitedQueue.close();
+    ASSERT_FALSE( pushPayload( limitedQueue, 3, 10 ) );
+    ASSERT_TRUE( limitedQueue.pop( second, collectionSchemeParams ) );
+    ASSERT_EQ( ( *second )[0], 2 );
+    ASSERT_FALSE( limitedQueue.pop( second, collectionSchemeParams ) );
+    ASSERT_EQ( limitedQueue.getInFlight( 0 ), 2 );
+    first.reset();
+    second.reset();
+    ASSERT_EQ( limitedQueue.getInFlight( 0 ), 0 );
+}
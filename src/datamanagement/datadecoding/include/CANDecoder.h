@@ -15,7 +15,7 @@
 
 // Includes
 #include "CANDataTypes.h"
-#include "ClockHandler.h"
+#include "FastClock.h"
 #include "IDecoderManifest.h"
 #include "LoggingModule.h"
 #include "Timer.h"
@@ -40,6 +40,8 @@ class CANDecoder
 public:
     /**
      * @brief Decode a given frameData of frameSize using the DBC format.
+     * The format is compiled into a decode plan on every call, so for the hot path prefer passing a plan
+     * compiled once with compileDecodePlan.
      * @param frameData pointer to the frame data
      * @param frameSize size in bytes of the frame.
      * @param format of the frame according to the DBC file.
@@ -51,9 +53,54 @@ public:
     bool decodeCANMessage( const uint8_t *frameData,
                            size_t frameSize,
                            const CANMessageFormat &format,
-                           const std::unordered_set<SignalID> signalIDsToCollect,
+                           const std::unordered_set<SignalID> &signalIDsToCollect,
                            CANDecodedMessage &decodedMessage );
 
+    /**
+     * @brief Decode a given frameData of frameSize using a precompiled decode plan.
+     * @param frameData pointer to the frame data
+     * @param frameSize size in bytes of the frame.
+     * @param plan decode plan of the frame compiled with compileDecodePlan, only its signals are decoded
+     * @param decodedMessage result of the decoding.
+     * @return True if the decoding is successful, False means that the decoding was
+     * partially not successful
+     */
+    bool decodeCANMessage( const uint8_t *frameData,
+                           size_t frameSize,
+                           const CANMessageDecodePlan &plan,
+                           CANDecodedMessage &decodedMessage );
+
+    /**
+     * @brief Decode a run of frames with the same CAN ID and the same size signal by signal.
+     * The words of all frames holding a signal are gathered into a column first. The column is then extracted
+     * and scaled in loops without branches, which the compiler vectorizes with the SIMD instructions of the
+     * target. This is faster than decoding the frames one by one for bursts of the same CAN ID.
+     * Multiplexed plans are not supported, as every frame can carry other signals.
+     * @param frameData pointers to the data of the frames
+     * @param frameCount number of frames
+     * @param frameSize size in bytes of every frame
+     * @param plan not multiplexed decode plan of the frames compiled with compileDecodePlan
+     * @param columns result, one column per decoded signal in the order of the plan. The allocated columns
+     * are reused.
+     * @return True if the decoding is successful, False means that the decoding was
+     * partially not successful
+     */
+    bool decodeCANMessages( const uint8_t *const *frameData,
+                            size_t frameCount,
+                            size_t frameSize,
+                            const CANMessageDecodePlan &plan,
+                            std::vector<CANDecodedSignalColumn> &columns );
+
+    /**
+     * @brief Validates the signal layouts of a format once and precomputes the load offsets, shifts and masks
+     * of the signals to be collected.
+     * @param format of the frame according to the DBC file.
+     * @param signalIDsToCollect the id for the signals to be collected, all other signals are left out of the plan
+     * @return the decode plan. Signals with an invalid layout are kept, but never decoded.
+     */
+    static CANMessageDecodePlan compileDecodePlan( const CANMessageFormat &format,
+                                                   const std::unordered_set<SignalID> &signalIDsToCollect );
+
     /**
      * @brief extracts a signal raw value from a frame.
      * @param frameData pointer to the frame data
@@ -62,9 +109,30 @@ public:
      */
     static int64_t extractSignalFromFrame( const uint8_t *frameData, const CANSignalFormat &signalDescription );
 
+    /**
+     * @brief extracts the raw value of one signal of a decode plan with a single 64 bit load.
+     * @param frameData pointer to the frame data
+     * @param frameSize size in bytes of the frame, must be at least step.mMinFrameSize
+     * @param step decoding rule of the signal compiled with compileDecodePlan
+     * @return the raw value of the signal, without factor and offset applied
+     */
+    static int64_t extractSignalFromFrame( const uint8_t *frameData,
+                                           size_t frameSize,
+                                           const CANSignalDecodeStep &step );
+
 private:
+    // Decodes one signal of a plan and appends it to decodedMessage, increments errorCounter if the frame is too short
+    void decodeSignal( const uint8_t *frameData,
+                       size_t frameSize,
+                       const CANSignalDecodeStep &step,
+                       CANDecodedMessage &decodedMessage,
+                       uint8_t &errorCounter );
+    // Loads the 64 bit word of a step from a frame in the byte order of the signal
+    static uint64_t loadWord( const uint8_t *frameData, size_t frameSize, const CANSignalDecodeStep &step );
+
     LoggingModule mLogger;
-    std::shared_ptr<const Clock> mClock = ClockHandler::getClock();
+    // Column of words used by decodeCANMessages
+    std::vector<uint64_t> mWords;
 };
 
 } // namespace DataManagement
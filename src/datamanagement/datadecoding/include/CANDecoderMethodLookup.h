@@ -0,0 +1,164 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+
+#pragma once
+
+// Includes
+#include "IDecoderDictionary.h"
+#include "StaticCANDecoder.h"
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataManagement
+{
+/**
+ * @brief A static decoder matching the active decoder manifest, with the signals to pass on in the order of the
+ * message format
+ */
+struct StaticCANDecodePlan
+{
+    struct CollectedSignal
+    {
+        size_t mValueIndex; /**< index of the signal in the values decoded by the static decoder */
+        SignalID mSignalID;
+        ManifestSignalIndex mSignalIndex;
+    };
+
+    const StaticCANMessageDecoder *mDecoder{ nullptr };
+    std::vector<CollectedSignal> mSignals;
+};
+
+/**
+ * @brief Lookup of the decoder methods of one CAN channel by CAN ID, built once when a decoder dictionary
+ * gets active.
+ *
+ * Standard 11 bit IDs index a direct array. All other IDs, like the 29 bit IDs including CAN_EFF_FLAG, are
+ * stored in an open addressing table with linear probing at a load factor of at most 50%, so
+ * resolving an ID normally needs a single probe. The lookup keeps the dictionary alive, the returned
+ * pointers stay valid as long as the lookup exists.
+ */
+class CANDecoderMethodLookup
+{
+public:
+    // Number of entries of the direct array, one for each standard 11 bit ID
+    static constexpr size_t STANDARD_ID_COUNT = 0x800;
+
+    /**
+     * @brief Builds the lookup for one channel of the dictionary
+     * @param dictionary the CAN decoder dictionary, must not be nullptr
+     * @param channelID the channel to build the lookup for. If the dictionary has no decoder
+     * methods for the channel the lookup is empty.
+     */
+    CANDecoderMethodLookup( std::shared_ptr<const CANDecoderDictionary> dictionary, CANChannelNumericID channelID );
+
+    /**
+     * @brief Finds the decoder method of a CAN ID
+     * @param messageID CAN ID as used as key in the dictionary
+     * @return the decoder method or nullptr if the dictionary has none for this ID
+     */
+    inline const CANMessageDecoderMethod *
+    find( CANRawFrameID messageID ) const
+    {
+        if ( messageID < STANDARD_ID_COUNT )
+        {
+            return mStandardIDs.empty() ? nullptr : mStandardIDs[messageID];
+        }
+        if ( mOtherIDs.empty() )
+        {
+            return nullptr;
+        }
+        for ( size_t index = hash( messageID );; index = ( index + 1 ) & mOtherIDsMask )
+        {
+            const auto &entry = mOtherIDs[index];
+            if ( ( entry.second == nullptr ) || ( entry.first == messageID ) )
+            {
+                return entry.second;
+            }
+        }
+    }
+
+    /**
+     * @brief Registers the static decoders generated at build time as fast path. A decoder is only used for a CAN
+     * ID if the decoding rules it was generated from match the format of the CAN ID in the dictionary.
+     * @param decoders array of static decoders
+     * @param count number of decoders
+     * @return number of CAN IDs of the channel decoded by a static decoder
+     */
+    size_t registerStaticDecoders( const StaticCANMessageDecoder *decoders, size_t count );
+
+    /**
+     * @brief Finds the static decoder of a CAN ID
+     * @param messageID CAN ID as used as key in the dictionary
+     * @return the plan of the static decoder or nullptr if the CAN ID has to be decoded with its decoder method
+     */
+    inline const StaticCANDecodePlan *
+    findStatic( CANRawFrameID messageID ) const
+    {
+        if ( mStaticPlans.empty() )
+        {
+            return nullptr;
+        }
+        auto plan = mStaticPlans.find( messageID );
+        return ( plan != mStaticPlans.end() ) ? &plan->second : nullptr;
+    }
+
+    /**
+     * @brief Returns the dictionary the lookup was built from
+     * @return the CAN decoder dictionary
+     */
+    inline const std::shared_ptr<const CANDecoderDictionary> &
+    getDictionary() const
+    {
+        return mDictionary;
+    }
+
+    /**
+     * @brief Returns the number of CAN IDs with a decoder method on the channel
+     * @return number of CAN IDs
+     */
+    inline size_t
+    size() const
+    {
+        return mSize;
+    }
+
+private:
+    inline size_t
+    hash( CANRawFrameID messageID ) const
+    {
+        // Fibonacci hashing, the upper bits of the product are the ones influenced by all bits of the ID
+        return static_cast<size_t>( ( messageID * 2654435769U ) >> mOtherIDsShift ) & mOtherIDsMask;
+    }
+
+    std::shared_ptr<const CANDecoderDictionary> mDictionary;
+    // Empty if the channel has no standard IDs
+    std::vector<const CANMessageDecoderMethod *> mStandardIDs;
+    // Empty slots have a nullptr as decoder method
+    std::vector<std::pair<CANRawFrameID, const CANMessageDecoderMethod *>> mOtherIDs;
+    size_t mOtherIDsMask{ 0 };
+    uint32_t mOtherIDsShift{ 0 };
+    size_t mSize{ 0 };
+    // Empty if no static decoder matches the dictionary
+    std::unordered_map<CANRawFrameID, StaticCANDecodePlan> mStaticPlans;
+};
+
+} // namespace DataManagement
+} // namespace IoTFleetWise
+} // namespace Aws
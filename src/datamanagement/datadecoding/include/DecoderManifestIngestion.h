@@ -16,6 +16,7 @@
 #include "IDecoderManifest.h"
 #include "LoggingModule.h"
 #include "decoder_manifest.pb.h"
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -37,6 +38,16 @@ using CANFrameToMessageMap = std::unordered_map<CANRawFrameID, CANMessageFormat>
  */
 constexpr size_t DECODER_MANIFEST_BYTE_SIZE_LIMIT = 128000000;
 
+/**
+ * @brief Result of adding a chunk of a Decoder Manifest delivered in several chunks
+ */
+enum class DecoderManifestChunkStatus
+{
+    INCOMPLETE, /**< The chunk was added, more chunks are expected */
+    COMPLETE,   /**< The last chunk was added and the digest matches, build() can be called */
+    INVALID     /**< The chunk was rejected and all previously added chunks are discarded */
+};
+
 /**
  * @brief DecoderManifestIngestion (PI = Schema) is the implementation of IDecoderManifest used by
  * CollectionSchemeIngestion.
@@ -70,6 +81,16 @@ public:
 
     PIDSignalDecoderFormat getPIDSignalDecoderFormat( SignalID signalID ) const override;
 
+    DIDSignalDecoderFormat getDIDSignalDecoderFormat( SignalID signalID ) const override;
+
+    ManifestSignalIndex getSignalIndex( SignalID signalID ) const override;
+
+    std::shared_ptr<const std::string>
+    getCompressionDictionary() const override
+    {
+        return mCompressionDictionary;
+    }
+
     bool copyData( const std::uint8_t *inputBuffer, const size_t size ) override;
 
     inline const std::vector<uint8_t> &
@@ -78,11 +99,57 @@ public:
         return mProtoBinaryData;
     }
 
+    void
+    releaseData() override
+    {
+        std::vector<uint8_t>().swap( mProtoBinaryData );
+    }
+
+    /**
+     * @brief Checks if a message received from Cloud is a chunk of a Decoder Manifest, without parsing it
+     *
+     * @param inputBuffer Pointer to the binary data of the message
+     * @param size Size of the binary data
+     * @return True if the chunk field is set at the top level of the message
+     */
+    static bool isChunk( const std::uint8_t *inputBuffer, const size_t size );
+
+    /**
+     * @brief Adds a chunk of a Decoder Manifest delivered in several chunks
+     *
+     * The signals of the chunk are added to the lookup tables right away, so that the build overlaps with the
+     * download and only one chunk is parsed at a time. The fragments are concatenated in the binary data, which is
+     * then the serialized complete Decoder Manifest that can be persisted. A chunk with sequence number 0 starts a new
+     * Decoder Manifest. After the last chunk, build() only marks the Decoder Manifest as ready.
+     *
+     * @param inputBuffer Pointer to the binary data of the chunk
+     * @param size Size of the binary data
+     * @return Whether the Decoder Manifest is complete, or if the chunk was rejected
+     */
+    DecoderManifestChunkStatus addChunk( const std::uint8_t *inputBuffer, const size_t size );
+
 private:
     /**
-     * @brief The DecoderManifest message that will hold the deserialized proto.
+     * @brief Adds the CAN and OBD signals of a Decoder Manifest message to the lookup tables
+     *
+     * @param protoDecoderManifest Complete Decoder Manifest or fragment of a chunk
+     */
+    void addSignals( const DecoderManifestMsg::DecoderManifest &protoDecoderManifest );
+
+    /**
+     * @brief Assigns the next dense index to a signal that has none yet
+     */
+    void addSignalIndex( SignalID signalID );
+
+    /**
+     * @brief Clears the lookup tables and the state of a Decoder Manifest delivered in chunks
      */
-    DecoderManifestMsg::DecoderManifest mProtoDecoderManifest;
+    void reset();
+
+    /**
+     * @brief The ID of the Decoder Manifest. The deserialized proto itself is only kept during build.
+     */
+    std::string mID;
 
     /**
      * @brief This vector will store the binary data copied from the IReceiver callback.
@@ -94,6 +161,31 @@ private:
      */
     bool mReady{ false };
 
+    /**
+     * @brief Flag which is true if the lookup tables were built from all the chunks of a Decoder Manifest
+     */
+    bool mBuiltFromChunks{ false };
+
+    /**
+     * @brief Sequence number of the next expected chunk
+     */
+    uint32_t mNextChunkSequenceNumber{ 0 };
+
+    /**
+     * @brief Number of chunks announced by the first chunk
+     */
+    uint32_t mTotalChunks{ 0 };
+
+    /**
+     * @brief CRC32C of the fragments of the chunks added so far
+     */
+    uint32_t mChunksDigest{ 0 };
+
+    /**
+     * @brief Copy of the compression dictionary of the proto, shared with the collected data metadata
+     */
+    std::shared_ptr<const std::string> mCompressionDictionary;
+
     /**
      * @brief A dictionary used internally that allows the retrieval of a CANMessageFormat per CanChannelId and
      * CANRawFrameID Key: CANRawFrameID Value: CANMessageFormat
@@ -119,6 +211,18 @@ private:
      */
     std::unordered_map<SignalID, PIDSignalDecoderFormat> mSignalToPIDDictionary;
 
+    /**
+     * @brief A dictionary used to read the Decoder Format for UDS DID Signal
+     * Key: Signal ID Value: UDS DID Signal Decoder Format
+     */
+    std::unordered_map<SignalID, DIDSignalDecoderFormat> mSignalToDIDDictionary;
+
+    /**
+     * @brief Dense index of every signal, assigned in the order the signals are added
+     * Key: Signal ID Value: index from 0 to the number of signals - 1
+     */
+    std::unordered_map<SignalID, ManifestSignalIndex> mSignalToIndex;
+
     /**
      * @brief Logging module used to output to logs
      */
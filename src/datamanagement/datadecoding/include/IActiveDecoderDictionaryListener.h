@@ -46,6 +46,26 @@ public:
      */
     virtual void onChangeOfActiveDictionary( ConstDecoderDictionaryConstPtr &dictionary,
                                              VehicleDataSourceProtocol networkProtocol ) = 0;
+
+    /**
+     * @brief The callback function used to notify any listeners on change of an already active Decoder Dictionary.
+     * Only invoked if the dictionary changed, listeners should only update the changed channels.
+     *
+     * The default implementation handles it like a new dictionary.
+     *
+     * @param dictionary const shared pointer pointing to the new constant decoder dictionary
+     * @param networkProtocol network protocol type indicating which type of decoder dictionary it's updating
+     * @param diff changes to the previously notified dictionary of this network protocol
+     * @return None
+     */
+    virtual void
+    onIncrementalChangeOfActiveDictionary( ConstDecoderDictionaryConstPtr &dictionary,
+                                           VehicleDataSourceProtocol networkProtocol,
+                                           const DecoderDictionaryDiff &diff )
+    {
+        static_cast<void>( diff );
+        onChangeOfActiveDictionary( dictionary, networkProtocol );
+    }
 };
 } // namespace DataInspection
 } // namespace IoTFleetWise
@@ -15,8 +15,11 @@
 
 // Includes
 #include "IDecoderManifest.h"
+#include <cstdint>
+#include <memory>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 namespace Aws
 {
@@ -48,11 +51,14 @@ enum class CANMessageCollectType
  * collectType: specify whether the message is intended to be decoded or kept as raw or both
  * format: CAN message format specifying the frame ID, number of bytes and whether it's Multiplexed.
  * Note the format only contains the signals intended to be collected.
+ * decodePlan: the format compiled once when the dictionary is built, containing only the signals to collect.
+ * If it is not valid the format is used.
  */
 struct CANMessageDecoderMethod
 {
     CANMessageCollectType collectType;
     CANMessageFormat format;
+    CANMessageDecodePlan decodePlan; /**< format compiled for decoding, see CANDecoder::compileDecodePlan */
 };
 
 /**
@@ -126,6 +132,86 @@ struct CANDecoderDictionary : DecoderDictionary
     {
     }
     CANMsgDecoderMethodType canMessageDecoderMethod;
+    /**
+     * @brief Emission policies of the signals to collect, only contains signals that do not pass every value
+     */
+    std::unordered_map<SignalID, SignalEmissionPolicy> signalEmissionPolicies;
+    /**
+     * @brief Smallest minimum sample interval of all collection schemes collecting a signal, including the ones only
+     * using it in their condition. Only contains signals where it is not 0. Samples of a signal closer than this to
+     * the last passed on sample are not needed by any of them and are dropped by the CAN consumers.
+     */
+    std::unordered_map<SignalID, uint32_t> signalMinimumSampleIntervalsMs;
+    /**
+     * @brief Most important priority, the smallest value, of the collection schemes collecting a signal. Used to shed
+     * the signals of low priority collection schemes first under load.
+     */
+    std::unordered_map<SignalID, uint32_t> signalPriorities;
+    /**
+     * @brief Collected signals used in the conditions of the collection schemes, they are never shed
+     */
+    std::unordered_set<SignalID> conditionSignalIDs;
+    /**
+     * @brief Immutable dictionaries with the decoding rules of a single channel, built by the CollectionSchemeManager.
+     * A slice only contains the frames of its channel and the entries of the signal sets and maps for their signals,
+     * so the consumer of a channel neither keeps the rules of other channels alive nor is woken up by their changes.
+     */
+    std::unordered_map<CANChannelNumericID, std::shared_ptr<const CANDecoderDictionary>> channelSlices;
+    /**
+     * @brief Fingerprint of the decoding rules of a slice, equal for slices with equal rules and never 0. 0 if the
+     * dictionary is not a slice.
+     */
+    uint64_t version{ 0 };
+};
+
+/**
+ * @brief Changes of the decoding rules of one channel between two CAN decoder dictionaries
+ *
+ * Frames are changed if their collect type, format or collected signals differ. Signals are the collected signals
+ * of the frames of this channel.
+ */
+struct CANChannelDecoderDiff
+{
+    std::vector<CANRawFrameID> addedFrameIDs;
+    std::vector<CANRawFrameID> removedFrameIDs;
+    std::vector<CANRawFrameID> changedFrameIDs;
+    std::vector<SignalID> addedSignalIDs;
+    std::vector<SignalID> removedSignalIDs;
+    /**
+     * @brief The version of the channel slice changed, also if only the settings of its signals changed, like their
+     * emission policies, minimum sample intervals or priorities
+     */
+    bool versionChanged{ false };
+
+    bool
+    empty() const
+    {
+        return addedFrameIDs.empty() && removedFrameIDs.empty() && changedFrameIDs.empty() &&
+               addedSignalIDs.empty() && removedSignalIDs.empty() && ( !versionChanged );
+    }
+
+    /**
+     * @brief The set of frame IDs received on the channel changed, so frame filters have to be updated
+     */
+    bool
+    framesAddedOrRemoved() const
+    {
+        return ( !addedFrameIDs.empty() ) || ( !removedFrameIDs.empty() );
+    }
+};
+
+/**
+ * @brief Changes between two CAN decoder dictionaries of the same protocol, only contains the changed channels
+ */
+struct DecoderDictionaryDiff
+{
+    std::unordered_map<CANChannelNumericID, CANChannelDecoderDiff> channels;
+
+    bool
+    empty() const
+    {
+        return channels.empty();
+    }
 };
 
 /**
@@ -19,6 +19,7 @@
 #include "SensorTypes.h"
 #include "SignalTypes.h"
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <utility>
 
@@ -171,6 +172,84 @@ const PIDSignalDecoderFormat NOT_READY_PID_DECODER_FORMAT = PIDSignalDecoderForm
  */
 const PIDSignalDecoderFormat NOT_FOUND_PID_DECODER_FORMAT = PIDSignalDecoderFormat();
 
+/**
+ * @brief Contains the decoding rules to decode UDS data identifier Signals
+ */
+struct DIDSignalDecoderFormat
+{
+    /*
+     * CAN interface the periodic DID is received on
+     */
+    CANInterfaceID mInterfaceID;
+
+    /*
+     * CAN ID of the physical requests to the ECU holding the DID
+     */
+    uint32_t mRequestMessageID{ 0 };
+
+    /*
+     * 16-bit data identifier
+     */
+    DID mDID{ 0 };
+
+    /*
+     * Length of the data record of the DID. Note this is not the signal byte length as a DID might contain
+     * multiple signals
+     */
+    size_t mDidResponseLength{ 0 };
+
+    /*
+     * ReadDataByPeriodicIdentifier transmission mode, 0 if the DID is read on request
+     */
+    uint8_t mPeriodicTransmissionMode{ 0 };
+
+    /*
+     * CAN ID of the frames the ECU streams the periodic DID on
+     */
+    uint32_t mPeriodicResponseMessageID{ 0 };
+
+    double mScaling{ 0 };
+    double mOffset{ 0 };
+
+    /*
+     * the start byte order (starting from 0th) for this signal in the data record of the DID
+     */
+    size_t mStartByte{ 0 };
+
+    /*
+     * number of bytes for this signal in the data record of the DID
+     */
+    size_t mByteLength{ 0 };
+
+    /*
+     * Right shift and bit mask length of the signal, only applied when byteLength is 1
+     */
+    uint8_t mBitRightShift{ 0 };
+    uint8_t mBitMaskLength{ 0 };
+
+public:
+    /**
+     * @brief Overload of the == operator
+     * @param other Other DIDSignalDecoderFormat object to compare
+     * @return true if ==, false otherwise
+     */
+    bool
+    operator==( const DIDSignalDecoderFormat &other ) const
+    {
+        return mInterfaceID == other.mInterfaceID && mRequestMessageID == other.mRequestMessageID &&
+               mDID == other.mDID && mDidResponseLength == other.mDidResponseLength &&
+               mPeriodicTransmissionMode == other.mPeriodicTransmissionMode &&
+               mPeriodicResponseMessageID == other.mPeriodicResponseMessageID && mScaling == other.mScaling &&
+               mOffset == other.mOffset && mStartByte == other.mStartByte && mByteLength == other.mByteLength &&
+               mBitRightShift == other.mBitRightShift && mBitMaskLength == other.mBitMaskLength;
+    }
+};
+
+/**
+ * @brief Error Code for UDS DID Decoder Format Not Found in decoder manifest or not ready to read
+ */
+const DIDSignalDecoderFormat NOT_FOUND_DID_DECODER_FORMAT = DIDSignalDecoderFormat();
+
 /**
  * @brief IDecoderManifest is used to exchange DecoderManifest between components
  *
@@ -233,6 +312,26 @@ public:
      */
     virtual PIDSignalDecoderFormat getPIDSignalDecoderFormat( SignalID signalID ) const = 0;
 
+    /**
+     * @brief Get the UDS DID Signal decoder format
+     * @param signalID the unique signalID
+     * @return NOT_FOUND_DID_DECODER_FORMAT if signal is not a UDS DID signal
+     */
+    virtual DIDSignalDecoderFormat getDIDSignalDecoderFormat( SignalID signalID ) const = 0;
+
+    /**
+     * @brief Get the dense index of the signal in this decoder manifest, which is also set in the CANSignalFormats
+     * @param signalID the unique signalID
+     * @return INVALID_MANIFEST_SIGNAL_INDEX if the signal is not found in decoder manifest
+     */
+    virtual ManifestSignalIndex getSignalIndex( SignalID signalID ) const = 0;
+
+    /**
+     * @brief Get the Zstandard dictionary to compress the vehicle data of this decoder manifest with
+     * @return nullptr if the decoder manifest has no dictionary or is not ready
+     */
+    virtual std::shared_ptr<const std::string> getCompressionDictionary() const = 0;
+
     /**
      * @brief Used by the AWS IoT MQTT callback to copy data received from Cloud into this object without any further
      * processing to minimize time spent in callback context.
@@ -252,6 +351,12 @@ public:
      */
     virtual const std::vector<uint8_t> &getData() const = 0;
 
+    /**
+     * @brief Frees the binary data once it is persisted. getData() returns an empty vector afterwards, while the
+     * built Decoder Manifest stays usable
+     */
+    virtual void releaseData() = 0;
+
     /**
      * @brief Virtual destructor to be implemented by the base class
      */
@@ -19,7 +19,10 @@
 #include "LoggingModule.h"
 #include "OBDDataTypes.h"
 #include "Timer.h"
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace Aws
@@ -62,80 +65,167 @@ public:
      * Validates first from the first byte whether it's a positive response.
      * @param sid SID for which the PIDs where requested.
      * @param inputData raw response from the ECU
+     * @param inputSize number of bytes of the response
      * @param supportedPIDs Output vector of PIDs
      * @return True if we received a positive response and extracted the PIDs.
      * needed.
      */
-    bool decodeSupportedPIDs( const SID &sid, const std::vector<uint8_t> &inputData, SupportedPIDs &supportedPIDs );
+    bool decodeSupportedPIDs( const SID &sid,
+                              const uint8_t *inputData,
+                              size_t inputSize,
+                              SupportedPIDs &supportedPIDs );
+
+    inline bool
+    decodeSupportedPIDs( const SID &sid, const std::vector<uint8_t> &inputData, SupportedPIDs &supportedPIDs )
+    {
+        return decodeSupportedPIDs( sid, inputData.data(), inputData.size(), supportedPIDs );
+    }
 
     /**
      * @brief Decodes an ECU response to a list of Emission related PIDs.
      * Validates first from the first byte whether it's a positive response.
      * @param sid SID for which the PIDs where requested.
      * @param pids List of PIDs that edge agent requested from ECU
+     * @param pidCount number of requested PIDs
      * @param inputData raw response from the ECU
-     * @param info Output vector of PID physical values
+     * @param inputSize number of bytes of the response
+     * @param info Output PID physical values. The signals are appended, and only if the whole response is valid, so
+     * the caller can reuse info for every response without allocating.
      * @return True if we received a positive response and decoded at least one supported PID.
      * needed.
      */
     bool decodeEmissionPIDs( const SID &sid,
-                             const std::vector<PID> &pids,
-                             const std::vector<uint8_t> &inputData,
+                             const PID *pids,
+                             size_t pidCount,
+                             const uint8_t *inputData,
+                             size_t inputSize,
                              EmissionInfo &info );
 
+    inline bool
+    decodeEmissionPIDs( const SID &sid,
+                        const std::vector<PID> &pids,
+                        const std::vector<uint8_t> &inputData,
+                        EmissionInfo &info )
+    {
+        return decodeEmissionPIDs( sid, pids.data(), pids.size(), inputData.data(), inputData.size(), info );
+    }
+
     /**
      * @brief Decodes DTCs from the ECU response,
      * Validates first from the first byte whether it's a positive response.
      * @param sid SID for which the PIDs where requested. This is either Mode 3 or Mode 7
      * @param inputData raw response from the ECU
+     * @param inputSize number of bytes of the response
      * @param info Output vector of DTCs
      * @return True if we received a positive response and decoded the DTCs.
      * A positive response also can mean that no DTCs were reported by the ECU.
      */
-    static bool decodeDTCs( const SID &sid, const std::vector<uint8_t> &inputData, DTCInfo &info );
+    static bool decodeDTCs( const SID &sid, const uint8_t *inputData, size_t inputSize, DTCInfo &info );
+
+    static inline bool
+    decodeDTCs( const SID &sid, const std::vector<uint8_t> &inputData, DTCInfo &info )
+    {
+        return decodeDTCs( sid, inputData.data(), inputData.size(), info );
+    }
 
     /**
      * @brief Decodes VIN from the ECU response,
      * Validates first from the first byte whether it's a positive response.
      * @param inputData raw response from the ECU
+     * @param inputSize number of bytes of the response
      * @param vin output string
      * @return True if we received a positive response and decoded the VIN.
      */
-    static bool decodeVIN( const std::vector<uint8_t> &inputData, std::string &vin );
+    static bool decodeVIN( const uint8_t *inputData, size_t inputSize, std::string &vin );
+
+    static inline bool
+    decodeVIN( const std::vector<uint8_t> &inputData, std::string &vin )
+    {
+        return decodeVIN( inputData.data(), inputData.size(), vin );
+    }
+
+    /**
+     * @brief Decodes the signals of a DID from a UDS ReadDataByIdentifier response.
+     * Validates first whether it's a positive response for the DID and has the length of the format.
+     * @param did the requested DID
+     * @param inputData raw response from the ECU
+     * @param inputSize number of bytes of the response
+     * @param format DID decoding rules, the signals are relative to the data record of the DID
+     * @param info output the decoded signals, appended like in decodeEmissionPIDs
+     * @return True if the response is valid and at least one signal was decoded.
+     */
+    bool decodeDataIdentifier( DID did,
+                               const uint8_t *inputData,
+                               size_t inputSize,
+                               const CANMessageFormat &format,
+                               EmissionInfo &info );
+
+    inline bool
+    decodeDataIdentifier( DID did,
+                          const std::vector<uint8_t> &inputData,
+                          const CANMessageFormat &format,
+                          EmissionInfo &info )
+    {
+        return decodeDataIdentifier( did, inputData.data(), inputData.size(), format, info );
+    }
 
     static bool extractDTCString( const uint8_t &firstByte, const uint8_t &secondByte, std::string &dtcString );
 
     /**
      * @brief Update OBD Data Decoder module with decoder dictionary
      *
+     * The dictionary is compiled into a table indexed by PID, so changes of the dictionary after this call are not
+     * taken into account.
+     *
      * @param dictionary Const shared pointer to Const OBD Decoder Dictionary
      * @return None
      */
     void setDecoderDictionary( ConstOBDDecoderDictionaryConstPtr &dictionary );
 
 private:
+    /**
+     * @brief Formula of a signal, with the bit operations precomputed from the CANSignalFormat
+     */
+    struct PIDFormula
+    {
+        SignalID signalID{ 0 };
+        uint8_t byteOffset{ 0 }; /**< offset of the first byte within the PID response */
+        uint8_t numOfBytes{ 0 }; /**< number of bytes to concatenate, 0 for a bit field within one byte */
+        uint8_t bitShift{ 0 };
+        uint8_t bitMask{ 0 };
+        double factor{ 1.0 };
+        double offset{ 0.0 };
+    };
+
+    /**
+     * @brief Entry of the PID table. The formulas of the PID are a range of mPIDFormulas.
+     */
+    struct PIDEntry
+    {
+        bool inDictionary{ false };
+        uint8_t responseLength{ 0 }; /**< expected number of data bytes following the PID */
+        uint32_t firstFormula{ 0 };
+        uint32_t formulaCount{ 0 };
+    };
+
     Timer mTimer;
     LoggingModule mLogger;
     std::shared_ptr<const Clock> mClock = ClockHandler::getClock();
-    // shared pointer to decoder dictionary
-    std::shared_ptr<const OBDDecoderDictionary> mDecoderDictionaryConstPtr;
+    // The decoder dictionary compiled into a table indexed by PID, empty if there is no decoder dictionary
+    std::vector<PIDEntry> mPIDTable;
+    std::vector<PIDFormula> mPIDFormulas;
     /**
      * @brief Validate signal formula
-     * @param pid
+     * @param responseLength expected number of data bytes of the PID
      * @param formula
      * @return True if formula is valid.
      */
-    bool isFormulaValid( PID pid, CANSignalFormat formula );
-    /**
-     * @brief Check if PIDs response length is valid. When the response consists of multiple PIDs,
-     * this function will check whether each PID exists in response and whether each PID's response
-     * matches with decoder dictionary
-     * @param pids List of PIDs that edge agent requested from ECU
-     * @param ecuResponse The PID response from ECU
-     * @return true if response length is valid
-     * @return false if response length is invalid
-     */
-    bool isPIDResponseValid( const std::vector<PID> &pids, const std::vector<uint8_t> &ecuResponse );
+    static bool isFormulaValid( uint8_t responseLength, const CANSignalFormat &formula );
+
+    static PIDFormula toFormula( const CANSignalFormat &signal );
+
+    // Applies the formula to the data bytes of the PID or DID
+    static SignalValue applyFormula( const PIDFormula &formula, const uint8_t *data );
 };
 
 } // namespace DataManagement
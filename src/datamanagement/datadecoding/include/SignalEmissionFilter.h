@@ -0,0 +1,89 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+
+#pragma once
+
+// Includes
+#include "SignalTypes.h"
+#include "TimeTypes.h"
+#include <unordered_map>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataManagement
+{
+using namespace Aws::IoTFleetWise::Platform::Linux;
+/**
+ * @brief Applies the emission policies and the minimum sample intervals of signals to their decoded values, so that
+ * values of slowly changing signals and samples more frequent than needed can be dropped before they are queued for
+ * the inspection.
+ *
+ * Every value is compared against the last value that was passed on for the same signal. The minimum sample interval
+ * is applied after the emission policy, like the inspection does for the values it receives. The filter is not
+ * thread safe and is meant to be owned by one decoding thread.
+ */
+class SignalEmissionFilter
+{
+public:
+    /**
+     * @brief Replaces the policies and intervals and forgets all previously passed on values
+     * @param policies the policies by signal. Signals without a policy always pass.
+     * @param minimumSampleIntervalsMs the minimum sample interval by signal. Signals without one are not rate limited.
+     */
+    void setPolicies( const std::unordered_map<SignalID, SignalEmissionPolicy> &policies,
+                      const std::unordered_map<SignalID, uint32_t> &minimumSampleIntervalsMs =
+                          std::unordered_map<SignalID, uint32_t>() );
+
+    /**
+     * @brief Check if no signal has a policy, so that the filter does not need to be called at all
+     * @return True if every value passes
+     */
+    inline bool
+    isEmpty() const
+    {
+        return mStates.empty();
+    }
+
+    /**
+     * @brief Decides if a decoded value is passed on and remembers it if so
+     * @param signalID the signal the value belongs to
+     * @param value the decoded physical value
+     * @param receiveTime reception time of the value in milliseconds
+     * @param receiveTimeFractionUs microseconds within the millisecond of receiveTime
+     * @return True if the value should be passed on
+     */
+    bool shouldEmit( SignalID signalID,
+                     double value,
+                     Timestamp receiveTime,
+                     TimestampFractionUs receiveTimeFractionUs = 0 );
+
+private:
+    struct SignalEmissionState
+    {
+        SignalEmissionPolicy mPolicy;
+        bool mHasEmitted{ false };
+        double mLastValue{ 0 };
+        Timestamp mLastTime{ 0 };
+        uint32_t mMinimumSampleIntervalMs{ 0 };
+        uint64_t mLastSampleUs{ 0 }; /**< last sample passed on by the minimum sample interval */
+    };
+
+    std::unordered_map<SignalID, SignalEmissionState> mStates;
+};
+
+} // namespace DataManagement
+} // namespace IoTFleetWise
+} // namespace Aws
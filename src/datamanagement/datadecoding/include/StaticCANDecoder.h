@@ -0,0 +1,156 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "MessageTypes.h"
+#include "SignalTypes.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataManagement
+{
+
+/**
+ * @brief Layout of one signal of a static decoder, compared against the active decoder manifest
+ */
+struct StaticCANSignalInfo
+{
+    SignalID mSignalID;
+    uint16_t mFirstBitPosition;
+    uint16_t mSizeInBits;
+    bool mIsBigEndian;
+    bool mIsSigned;
+    double mFactor;
+    double mOffset;
+};
+
+/**
+ * @brief Decodes all signals of a frame into physicalValues in the order of the signals of the decoder
+ * @return false if the frame is too short for any of the signals, then nothing is decoded
+ */
+using StaticCANDecodeFunction = bool ( * )( const uint8_t *frameData, size_t frameSize, double *physicalValues );
+
+/**
+ * @brief Decoder of one CAN message generated at build time, see tools/static-can-decoders
+ */
+struct StaticCANMessageDecoder
+{
+    uint32_t mMessageID;
+    uint8_t mSizeInBytes;
+    const StaticCANSignalInfo *mSignals;
+    size_t mSignalCount;
+    StaticCANDecodeFunction mDecode;
+
+    /**
+     * @brief Checks that the decoder was generated from the same decoding rules as a message format of the active
+     * decoder manifest. Multiplexed formats are never matched.
+     * @param format message format of the active decoder manifest
+     * @return true if the decoder can be used instead of decoding the format
+     */
+    bool matches( const CANMessageFormat &format ) const;
+
+    /**
+     * @brief Finds the position of a signal in the decoded values
+     * @return the index into mSignals or mSignalCount if the decoder does not decode the signal
+     */
+    size_t findSignal( const CANSignalFormat &signal ) const;
+};
+
+/**
+ * @brief Extraction of one signal with the load offset, shift and masks computed at compile time, the
+ * counterpart of CANSignalDecodeStep for the static decoders.
+ *
+ * The values are computed the same way as by CANDecoder::compileDecodePlan, only signals that fit into one
+ * 64 bit word are supported.
+ */
+template <uint16_t FIRST_BIT, uint16_t SIZE_IN_BITS, bool IS_BIG_ENDIAN, bool IS_SIGNED, uint8_t FRAME_SIZE>
+struct StaticCANSignal
+{
+    static_assert( ( SIZE_IN_BITS >= 1 ) && ( SIZE_IN_BITS <= 64 ), "Signal size must be 1 to 64 bits" );
+
+    static constexpr uint32_t BYTE_SIZE = 8;
+    static constexpr uint32_t WORD_SIZE = sizeof( uint64_t );
+    static constexpr uint32_t START_BYTE = FIRST_BIT / BYTE_SIZE;
+    static constexpr uint32_t START_BIT_IN_BYTE = FIRST_BIT % BYTE_SIZE;
+    // Motorola signals grow towards lower bytes. Bits that would be located before byte 0 are read as 0
+    static constexpr uint32_t END_BIT = START_BYTE * BYTE_SIZE + BYTE_SIZE - START_BIT_IN_BYTE;
+    static constexpr uint32_t LOW_BYTE =
+        IS_BIG_ENDIAN ? ( ( END_BIT >= SIZE_IN_BITS ) ? ( ( END_BIT - SIZE_IN_BITS ) / BYTE_SIZE ) : 0 ) : START_BYTE;
+    static constexpr uint32_t HIGH_BYTE = IS_BIG_ENDIAN ? START_BYTE : ( FIRST_BIT + SIZE_IN_BITS - 1 ) / BYTE_SIZE;
+    static constexpr uint32_t MIN_FRAME_SIZE =
+        IS_BIG_ENDIAN ? ( ( START_BYTE + 1 > ( SIZE_IN_BITS + BYTE_SIZE - 1 ) / BYTE_SIZE )
+                              ? START_BYTE + 1
+                              : ( SIZE_IN_BITS + BYTE_SIZE - 1 ) / BYTE_SIZE )
+                      : HIGH_BYTE + 1;
+    static_assert( HIGH_BYTE - LOW_BYTE + 1 <= WORD_SIZE, "Signals spanning more than 8 bytes are not supported" );
+    // Prefer a word that lies completely inside the frame, so that it can be loaded directly
+    static constexpr uint32_t LOAD_OFFSET =
+        ( LOW_BYTE + WORD_SIZE > FRAME_SIZE ) ? ( ( HIGH_BYTE + 1 >= WORD_SIZE ) ? ( HIGH_BYTE + 1 - WORD_SIZE ) : 0 )
+                                              : LOW_BYTE;
+    static constexpr uint32_t SHIFT = IS_BIG_ENDIAN
+                                          ? ( LOAD_OFFSET + WORD_SIZE - 1 - START_BYTE ) * BYTE_SIZE + START_BIT_IN_BYTE
+                                          : FIRST_BIT - LOAD_OFFSET * BYTE_SIZE;
+    static constexpr uint64_t MASK = ( SIZE_IN_BITS == 64 ) ? UINT64_MAX : ( ( 1ULL << SIZE_IN_BITS ) - 1ULL );
+    static constexpr uint64_t SIGN_MASK = IS_SIGNED ? ( 1ULL << ( SIZE_IN_BITS - 1 ) ) : 0ULL;
+
+    /**
+     * @brief Extracts the raw value, frameSize must be at least MIN_FRAME_SIZE
+     */
+    static inline int64_t
+    extract( const uint8_t *frameData, size_t frameSize )
+    {
+        uint64_t word = 0;
+        if ( frameSize >= LOAD_OFFSET + WORD_SIZE )
+        {
+            std::memcpy( &word, frameData + LOAD_OFFSET, sizeof( word ) );
+        }
+        else if ( frameSize > LOAD_OFFSET )
+        {
+            // Short frame, the missing bytes are zero and masked out anyway
+            std::memcpy( &word, frameData + LOAD_OFFSET, frameSize - LOAD_OFFSET );
+        }
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        if ( IS_BIG_ENDIAN )
+        {
+            word = __builtin_bswap64( word );
+        }
+#else
+        if ( !IS_BIG_ENDIAN )
+        {
+            word = __builtin_bswap64( word );
+        }
+#endif
+        uint64_t result = ( word >> SHIFT ) & MASK;
+        // perform sign extension, is a no-op for unsigned signals
+        result = ( result ^ SIGN_MASK ) - SIGN_MASK;
+        return static_cast<int64_t>( result );
+    }
+};
+
+/**
+ * @brief Returns the decoders generated at build time
+ * @param count set to the number of decoders, 0 if the build has no static decoders
+ * @return array of count decoders
+ */
+const StaticCANMessageDecoder *getStaticCANDecoders( size_t &count );
+
+} // namespace DataManagement
+} // namespace IoTFleetWise
+} // namespace Aws
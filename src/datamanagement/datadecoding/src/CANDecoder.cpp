@@ -15,6 +15,7 @@
 #include "CANDecoder.h"
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 #define MASK64( nbits ) ( ( 0xffffffffffffffffULL ) >> ( 64 - ( nbits ) ) )
 
 namespace Aws
@@ -28,88 +29,348 @@ bool
 CANDecoder::decodeCANMessage( const uint8_t *frameData,
                               size_t frameSize,
                               const CANMessageFormat &format,
-                              const std::unordered_set<uint32_t> signalIDsToCollect,
+                              const std::unordered_set<uint32_t> &signalIDsToCollect,
+                              CANDecodedMessage &decodedMessage )
+{
+    return decodeCANMessage( frameData, frameSize, compileDecodePlan( format, signalIDsToCollect ), decodedMessage );
+}
+
+bool
+CANDecoder::decodeCANMessage( const uint8_t *frameData,
+                              size_t frameSize,
+                              const CANMessageDecodePlan &plan,
                               CANDecodedMessage &decodedMessage )
 {
     uint8_t errorCounter = 0;
-    uint32_t frameSizeInBits = static_cast<uint32_t>( frameSize * 8 );
     uint8_t multiplexorValue = UINT8_MAX;
 
     // Check if the message is multiplexed
-    if ( format.isMultiplexed() )
+    if ( plan.mIsMultiplexed )
     {
-        // Lookup the multiplexor signal
-        // complexity. Try to fix in the scheme not in the code.
-        auto it = std::find_if( format.mSignals.begin(), format.mSignals.end(), []( CANSignalFormat signal ) {
-            return signal.isMultiplexor();
-        } );
-        if ( it == format.mSignals.end() )
+        if ( plan.mMultiplexorStep == CANMessageDecodePlan::NO_MULTIPLEXOR )
         {
             mLogger.error( "CANDecoder::decodeCANMessage",
-                           "Message ID" + std::to_string( format.mMessageID ) +
+                           "Message ID" + std::to_string( plan.mMessageID ) +
                                " is multiplexed but no Multiplexor signal has been found " );
             return false;
         }
-        if ( signalIDsToCollect.find( it->mSignalID ) != signalIDsToCollect.end() )
+        const auto &multiplexor = plan.mSteps[plan.mMultiplexorStep];
+        // Decode the multiplexor Value. It selects the signals to decode even if it is not collected itself
+        int64_t rawValue = extractSignalFromFrame( frameData, frameSize, multiplexor );
+        multiplexorValue =
+            static_cast<uint8_t>( static_cast<uint8_t>( rawValue ) * multiplexor.mFactor + multiplexor.mOffset );
+        if ( multiplexor.mCollect )
         {
-            // Decode the multiplexor Value
-            int64_t rawValue = extractSignalFromFrame( frameData, *it );
-            multiplexorValue = static_cast<uint8_t>( static_cast<uint8_t>( rawValue ) * it->mFactor + it->mOffset );
             decodedMessage.mFrameInfo.mSignals.emplace_back(
-                CANDecodedSignal( it->mSignalID, rawValue, static_cast<double>( multiplexorValue ) ) );
+                CANDecodedSignal( multiplexor.mSignalID,
+                                  rawValue,
+                                  static_cast<double>( multiplexorValue ),
+                                  multiplexor.mSignalIndex ) );
         }
     }
 
-    for ( size_t i = 0; i < format.mSignals.size(); ++i )
+    if ( multiplexorValue != UINT8_MAX )
     {
-        if ( signalIDsToCollect.find( format.mSignals[i].mSignalID ) != signalIDsToCollect.end() )
+        // Only the signals matching the MUX value are decoded
+        for ( auto i = plan.mMultiplexedStepsBegin[multiplexorValue];
+              i < plan.mMultiplexedStepsBegin[multiplexorValue + 1U];
+              i++ )
         {
-            // Skip the signals that don't match the MUX value
-            if ( multiplexorValue != UINT8_MAX && format.mSignals[i].mMultiplexorValue != multiplexorValue )
+            decodeSignal( frameData, frameSize, plan.mSteps[plan.mMultiplexedSteps[i]], decodedMessage, errorCounter );
+        }
+    }
+    else
+    {
+        for ( const auto &step : plan.mSteps )
+        {
+            if ( step.mCollect )
             {
-                continue;
+                decodeSignal( frameData, frameSize, step, decodedMessage, errorCounter );
             }
+        }
+    }
 
-            if ( ( format.mSignals[i].mFirstBitPosition >= frameSizeInBits ) ||
-                 ( format.mSignals[i].mSizeInBits < 1 ) || ( format.mSignals[i].mSizeInBits > frameSizeInBits ) )
+    // Message decoding time
+    decodedMessage.mDecodingTime = FastClock::systemTimeMs();
+    // Should not harm, callers will ignore the return code.
+    return errorCounter == 0;
+}
+
+bool
+CANDecoder::decodeCANMessages( const uint8_t *const *frameData,
+                               size_t frameCount,
+                               size_t frameSize,
+                               const CANMessageDecodePlan &plan,
+                               std::vector<CANDecodedSignalColumn> &columns )
+{
+    if ( plan.mIsMultiplexed )
+    {
+        mLogger.error( "CANDecoder::decodeCANMessages",
+                       "Message ID" + std::to_string( plan.mMessageID ) +
+                           " is multiplexed and can not be batch decoded" );
+        columns.clear();
+        return false;
+    }
+    uint8_t errorCounter = 0;
+    size_t columnCount = 0;
+    mWords.resize( frameCount );
+    for ( const auto &step : plan.mSteps )
+    {
+        if ( !step.mCollect )
+        {
+            continue;
+        }
+        // All frames have the same size, so the signal either fits into all of them or into none
+        if ( frameSize < step.mMinFrameSize )
+        {
+            mLogger.error( "CANDecoder::decodeCANMessages", "Signal Out of Range" );
+            errorCounter++;
+            continue;
+        }
+        if ( columnCount == columns.size() )
+        {
+            columns.emplace_back();
+        }
+        auto &column = columns[columnCount];
+        columnCount++;
+        column.mSignalID = step.mSignalID;
+        column.mSignalIndex = step.mSignalIndex;
+        column.mPhysicalValues.resize( frameCount );
+        double *values = column.mPhysicalValues.data();
+        uint64_t *words = mWords.data();
+        if ( step.mUseSlowPath )
+        {
+            for ( size_t i = 0; i < frameCount; i++ )
             {
-                // Wrongly coded Signal, skip it
-                mLogger.error( "CANDecoder::decodeCANMessage", "Signal Out of Range" );
-                errorCounter++;
-                continue;
+                words[i] = static_cast<uint64_t>( extractSignalFromFrame( frameData[i], frameSize, step ) );
             }
+        }
+        else
+        {
+            for ( size_t i = 0; i < frameCount; i++ )
+            {
+                words[i] = loadWord( frameData[i], frameSize, step );
+            }
+            // The shift, mask and sign mask are the same for the whole column
+            const uint8_t shift = step.mShift;
+            const uint64_t mask = step.mMask;
+            const uint64_t signMask = step.mSignMask;
+            for ( size_t i = 0; i < frameCount; i++ )
+            {
+                uint64_t result = ( words[i] >> shift ) & mask;
+                words[i] = ( result ^ signMask ) - signMask;
+            }
+        }
+        const double factor = step.mFactor;
+        const double offset = step.mOffset;
+        for ( size_t i = 0; i < frameCount; i++ )
+        {
+            values[i] = static_cast<double>( static_cast<int64_t>( words[i] ) ) * factor + offset;
+        }
+    }
+    columns.resize( columnCount );
+    return errorCounter == 0;
+}
+
+void
+CANDecoder::decodeSignal( const uint8_t *frameData,
+                          size_t frameSize,
+                          const CANSignalDecodeStep &step,
+                          CANDecodedMessage &decodedMessage,
+                          uint8_t &errorCounter )
+{
+    // The signal layout was validated when compiling the plan, only the frame size is left to check
+    if ( frameSize < step.mMinFrameSize )
+    {
+        // Wrongly coded Signal, skip it
+        mLogger.error( "CANDecoder::decodeCANMessage", "Signal Out of Range" );
+        errorCounter++;
+        return;
+    }
+
+    // Start decoding the signal, extract the value before scaling from the Frame.
+    int64_t rawValue = extractSignalFromFrame( frameData, frameSize, step );
+    double physicalValue = static_cast<double>( rawValue ) * step.mFactor + step.mOffset;
+    decodedMessage.mFrameInfo.mSignals.emplace_back(
+        CANDecodedSignal( step.mSignalID, rawValue, physicalValue, step.mSignalIndex ) );
+}
 
-            if ( ( !format.mSignals[i].mIsBigEndian ) &&
-                 ( format.mSignals[i].mFirstBitPosition + format.mSignals[i].mSizeInBits > frameSizeInBits ) )
+CANMessageDecodePlan
+CANDecoder::compileDecodePlan( const CANMessageFormat &format,
+                               const std::unordered_set<SignalID> &signalIDsToCollect )
+{
+    const uint32_t BYTE_SIZE = 8;
+    const uint32_t WORD_SIZE = sizeof( uint64_t );
+    CANMessageDecodePlan plan;
+    plan.mMessageID = format.mMessageID;
+    plan.mIsMultiplexed = format.isMultiplexed();
+    plan.mSteps.reserve( format.mSignals.size() );
+    for ( const auto &signal : format.mSignals )
+    {
+        bool collect = signalIDsToCollect.find( signal.mSignalID ) != signalIDsToCollect.end();
+        if ( plan.mIsMultiplexed && signal.isMultiplexor() &&
+             ( plan.mMultiplexorStep == CANMessageDecodePlan::NO_MULTIPLEXOR ) )
+        {
+            // The multiplexor stays in the plan even if it is not collected to know that it exists
+            plan.mMultiplexorStep = plan.mSteps.size();
+        }
+        else if ( !collect )
+        {
+            continue;
+        }
+        CANSignalDecodeStep step;
+        step.mSignalID = signal.mSignalID;
+        step.mSignalIndex = signal.mSignalIndex;
+        step.mCollect = collect;
+        step.mIsBigEndian = signal.mIsBigEndian;
+        step.mIsSigned = signal.mIsSigned;
+        step.mMultiplexorValue = signal.mMultiplexorValue;
+        step.mFirstBitPosition = signal.mFirstBitPosition;
+        step.mSizeInBits = signal.mSizeInBits;
+        step.mFactor = signal.mFactor;
+        step.mOffset = signal.mOffset;
+
+        uint32_t startBit = signal.mFirstBitPosition;
+        uint32_t sizeInBits = signal.mSizeInBits;
+        uint32_t startByte = startBit / BYTE_SIZE;
+        uint32_t startBitInByte = startBit % BYTE_SIZE;
+        if ( ( sizeInBits < 1 ) || ( sizeInBits > BYTE_SIZE * WORD_SIZE ) )
+        {
+            step.mMinFrameSize = UINT16_MAX;
+            plan.mSteps.emplace_back( step );
+            continue;
+        }
+        uint32_t lowByte = 0;
+        uint32_t highByte = 0;
+        if ( signal.mIsBigEndian )
+        {
+            // Motorola signals grow towards lower bytes. Bits that would be located before byte 0 are read as 0
+            lowByte = ( startByte * BYTE_SIZE + BYTE_SIZE - startBitInByte >= sizeInBits )
+                          ? ( ( startByte * BYTE_SIZE + BYTE_SIZE - startBitInByte - sizeInBits ) / BYTE_SIZE )
+                          : 0;
+            highByte = startByte;
+            step.mMinFrameSize =
+                static_cast<uint16_t>( std::max( startByte + 1, ( sizeInBits + BYTE_SIZE - 1 ) / BYTE_SIZE ) );
+        }
+        else
+        {
+            lowByte = startByte;
+            highByte = ( startBit + sizeInBits - 1 ) / BYTE_SIZE;
+            step.mMinFrameSize = static_cast<uint16_t>( highByte + 1 );
+        }
+        step.mMask = MASK64( sizeInBits );
+        step.mSignMask = signal.mIsSigned ? ( 1ULL << ( sizeInBits - 1 ) ) : 0ULL;
+        if ( highByte - lowByte + 1 > WORD_SIZE )
+        {
+            // Can only happen for signals with more than 56 bits not aligned to a byte
+            step.mUseSlowPath = true;
+            plan.mSteps.emplace_back( step );
+            continue;
+        }
+        // Prefer a word that lies completely inside the frame, so that it can be loaded directly
+        uint32_t loadOffset = lowByte;
+        if ( loadOffset + WORD_SIZE > format.mSizeInBytes )
+        {
+            loadOffset = ( highByte + 1 >= WORD_SIZE ) ? ( highByte + 1 - WORD_SIZE ) : 0;
+        }
+        step.mLoadOffset = static_cast<uint8_t>( loadOffset );
+        if ( signal.mIsBigEndian )
+        {
+            // The byte at loadOffset is the most significant byte of the word
+            step.mShift =
+                static_cast<uint8_t>( ( loadOffset + WORD_SIZE - 1 - startByte ) * BYTE_SIZE + startBitInByte );
+        }
+        else
+        {
+            step.mShift = static_cast<uint8_t>( startBit - loadOffset * BYTE_SIZE );
+        }
+        plan.mSteps.emplace_back( step );
+    }
+    if ( plan.mMultiplexorStep != CANMessageDecodePlan::NO_MULTIPLEXOR )
+    {
+        // Group the collected signals by MUX value so that a frame only visits the signals of its MUX value
+        plan.mMultiplexedStepsBegin.assign( CANMessageDecodePlan::MULTIPLEXOR_VALUE_COUNT + 1, 0 );
+        for ( const auto &step : plan.mSteps )
+        {
+            if ( step.mCollect )
+            {
+                plan.mMultiplexedStepsBegin[step.mMultiplexorValue + 1U]++;
+            }
+        }
+        for ( size_t value = 1; value < plan.mMultiplexedStepsBegin.size(); value++ )
+        {
+            plan.mMultiplexedStepsBegin[value] += plan.mMultiplexedStepsBegin[value - 1];
+        }
+        plan.mMultiplexedSteps.resize( plan.mMultiplexedStepsBegin.back() );
+        auto nextPosition = plan.mMultiplexedStepsBegin;
+        for ( uint32_t i = 0; i < plan.mSteps.size(); i++ )
+        {
+            if ( plan.mSteps[i].mCollect )
             {
-                // Wrongly coded Signal, skip it
-                mLogger.error( "CANDecoder::decodeCANMessage", "Little endian signal Out of Range" );
-                errorCounter++;
-                continue;
+                plan.mMultiplexedSteps[nextPosition[plan.mSteps[i].mMultiplexorValue]++] = i;
             }
+        }
+    }
+    return plan;
+}
 
-            // Start decoding the signal, extract the value before scaling from the Frame.
-            int64_t rawValue = extractSignalFromFrame( frameData, format.mSignals[i] );
-            double physicalValue =
-                static_cast<double>( rawValue ) * format.mSignals[i].mFactor + format.mSignals[i].mOffset;
-            decodedMessage.mFrameInfo.mSignals.emplace_back(
-                CANDecodedSignal( format.mSignals[i].mSignalID, rawValue, physicalValue ) );
+int64_t
+CANDecoder::extractSignalFromFrame( const uint8_t *frameData, size_t frameSize, const CANSignalDecodeStep &step )
+{
+    if ( step.mUseSlowPath )
+    {
+        if ( frameSize < step.mMinFrameSize )
+        {
+            return 0;
         }
+        CANSignalFormat signalDescription;
+        signalDescription.mIsBigEndian = step.mIsBigEndian;
+        signalDescription.mIsSigned = step.mIsSigned;
+        signalDescription.mFirstBitPosition = step.mFirstBitPosition;
+        signalDescription.mSizeInBits = step.mSizeInBits;
+        return extractSignalFromFrame( frameData, signalDescription );
     }
+    uint64_t result = ( loadWord( frameData, frameSize, step ) >> step.mShift ) & step.mMask;
+    // perform sign extension, is a no-op for unsigned signals
+    result = ( result ^ step.mSignMask ) - step.mSignMask;
+    return static_cast<int64_t>( result );
+}
 
-    // Message decoding time
-    decodedMessage.mDecodingTime = mClock->timeSinceEpochMs();
-    // Should not harm, callers will ignore the return code.
-    return errorCounter == 0;
+uint64_t
+CANDecoder::loadWord( const uint8_t *frameData, size_t frameSize, const CANSignalDecodeStep &step )
+{
+    uint64_t word = 0;
+    if ( frameSize >= static_cast<size_t>( step.mLoadOffset ) + sizeof( word ) )
+    {
+        std::memcpy( &word, frameData + step.mLoadOffset, sizeof( word ) );
+    }
+    else if ( frameSize > step.mLoadOffset )
+    {
+        // Short frame, the missing bytes are zero and masked out anyway
+        std::memcpy( &word, frameData + step.mLoadOffset, frameSize - step.mLoadOffset );
+    }
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    if ( step.mIsBigEndian )
+    {
+        word = __builtin_bswap64( word );
+    }
+#else
+    if ( !step.mIsBigEndian )
+    {
+        word = __builtin_bswap64( word );
+    }
+#endif
+    return word;
 }
 
 int64_t
 CANDecoder::extractSignalFromFrame( const uint8_t *frameData, const CANSignalFormat &signalDescription )
 {
     const uint8_t BYTE_SIZE = 8;
-    uint8_t startBit = static_cast<uint8_t>( signalDescription.mFirstBitPosition );
-    uint8_t startByte = startBit / BYTE_SIZE;
-    uint8_t startBitInByte = startBit % BYTE_SIZE;
+    // CAN FD frames have up to 512 bits so the start bit does not fit into one byte
+    uint16_t startBit = signalDescription.mFirstBitPosition;
+    uint8_t startByte = static_cast<uint8_t>( startBit / BYTE_SIZE );
+    uint8_t startBitInByte = static_cast<uint8_t>( startBit % BYTE_SIZE );
     uint8_t resultLength = static_cast<uint8_t>( BYTE_SIZE - startBitInByte );
     uint8_t endByte = 0U;
 
@@ -0,0 +1,105 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+
+// Includes
+#include "CANDecoderMethodLookup.h"
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataManagement
+{
+
+CANDecoderMethodLookup::CANDecoderMethodLookup( std::shared_ptr<const CANDecoderDictionary> dictionary,
+                                                CANChannelNumericID channelID )
+    : mDictionary( std::move( dictionary ) )
+{
+    auto channel = mDictionary->canMessageDecoderMethod.find( channelID );
+    if ( channel == mDictionary->canMessageDecoderMethod.end() )
+    {
+        return;
+    }
+    size_t otherIDCount = 0;
+    for ( const auto &frame : channel->second )
+    {
+        if ( frame.first >= STANDARD_ID_COUNT )
+        {
+            otherIDCount++;
+        }
+    }
+    if ( otherIDCount < channel->second.size() )
+    {
+        mStandardIDs.resize( STANDARD_ID_COUNT, nullptr );
+    }
+    if ( otherIDCount > 0 )
+    {
+        // Power of two with at least twice the number of IDs
+        uint32_t bits = 1;
+        while ( ( static_cast<size_t>( 1 ) << bits ) < otherIDCount * 2 )
+        {
+            bits++;
+        }
+        mOtherIDs.resize( static_cast<size_t>( 1 ) << bits, { 0, nullptr } );
+        mOtherIDsMask = mOtherIDs.size() - 1;
+        mOtherIDsShift = 32 - bits;
+    }
+    for ( const auto &frame : channel->second )
+    {
+        if ( frame.first < STANDARD_ID_COUNT )
+        {
+            mStandardIDs[frame.first] = &frame.second;
+        }
+        else
+        {
+            size_t index = hash( frame.first );
+            while ( mOtherIDs[index].second != nullptr )
+            {
+                index = ( index + 1 ) & mOtherIDsMask;
+            }
+            mOtherIDs[index] = { frame.first, &frame.second };
+        }
+    }
+    mSize = channel->second.size();
+}
+
+size_t
+CANDecoderMethodLookup::registerStaticDecoders( const StaticCANMessageDecoder *decoders, size_t count )
+{
+    for ( size_t i = 0; i < count; i++ )
+    {
+        const auto &decoder = decoders[i];
+        const auto *decoderMethod = find( decoder.mMessageID );
+        if ( ( decoderMethod == nullptr ) || ( mStaticPlans.find( decoder.mMessageID ) != mStaticPlans.end() ) ||
+             ( !decoder.matches( decoderMethod->format ) ) )
+        {
+            continue;
+        }
+        StaticCANDecodePlan plan;
+        plan.mDecoder = &decoder;
+        for ( const auto &signal : decoderMethod->format.mSignals )
+        {
+            if ( mDictionary->signalIDsToCollect.find( signal.mSignalID ) != mDictionary->signalIDsToCollect.end() )
+            {
+                plan.mSignals.push_back( { decoder.findSignal( signal ), signal.mSignalID, signal.mSignalIndex } );
+            }
+        }
+        mStaticPlans.emplace( decoder.mMessageID, std::move( plan ) );
+    }
+    return mStaticPlans.size();
+}
+
+} // namespace DataManagement
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -13,7 +13,14 @@
 
 #include "DecoderManifestIngestion.h"
 #include "CollectionInspectionAPITypes.h"
+#include "Crc32c.h"
+#include "TraceModule.h"
+#include <algorithm>
+#include <google/protobuf/arena.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/wire_format_lite.h>
 #include <iostream>
+#include <thread>
 
 namespace Aws
 {
@@ -24,6 +31,100 @@ namespace DataManagement
 
 using namespace Aws::IoTFleetWise::Schemas;
 
+namespace
+{
+// Signals reaching beyond byte 8 can only be carried by CAN FD frames
+bool
+isCANFDSignal( const CANSignalFormat &signalFormat )
+{
+    return ( static_cast<uint32_t>( signalFormat.mFirstBitPosition ) + signalFormat.mSizeInBits ) >
+           ( static_cast<uint32_t>( MAX_CAN_FRAME_BYTE_SIZE ) * 8U );
+}
+
+// Below this number of CAN signals starting threads costs more than building the tables on one thread
+constexpr int PARALLEL_BUILD_MIN_CAN_SIGNALS = 10000;
+
+CANSignalFormat
+toCANSignalFormat( const DecoderManifestMsg::CANSignal &canSignal )
+{
+    // Create a container to hold the InterfaceManagement::CANSignal we will build
+    CANSignalFormat canSignalFormat;
+
+    canSignalFormat.mSignalID = canSignal.signal_id();
+    canSignalFormat.mIsBigEndian = canSignal.is_big_endian();
+    canSignalFormat.mIsSigned = canSignal.is_signed();
+    canSignalFormat.mFirstBitPosition = static_cast<uint16_t>( canSignal.start_bit() );
+    canSignalFormat.mSizeInBits = static_cast<uint16_t>( canSignal.length() );
+    canSignalFormat.mOffset = canSignal.offset();
+    canSignalFormat.mFactor = canSignal.factor();
+
+    canSignalFormat.mIsMultiplexorSignal = false;
+    canSignalFormat.mMultiplexorValue = 0;
+
+    if ( canSignal.has_emission_policy() )
+    {
+        const auto &emissionPolicy = canSignal.emission_policy();
+        switch ( emissionPolicy.type() )
+        {
+        case DecoderManifestMsg::EmissionPolicy::ON_CHANGE:
+            canSignalFormat.mEmissionPolicy.mType = SignalEmissionPolicyType::ON_CHANGE;
+            break;
+        case DecoderManifestMsg::EmissionPolicy::ABSOLUTE_DEADBAND:
+            canSignalFormat.mEmissionPolicy.mType = SignalEmissionPolicyType::ABSOLUTE_DEADBAND;
+            break;
+        case DecoderManifestMsg::EmissionPolicy::RELATIVE_DEADBAND:
+            canSignalFormat.mEmissionPolicy.mType = SignalEmissionPolicyType::RELATIVE_DEADBAND;
+            break;
+        default:
+            canSignalFormat.mEmissionPolicy.mType = SignalEmissionPolicyType::ALWAYS;
+            break;
+        }
+        canSignalFormat.mEmissionPolicy.mDeadband = emissionPolicy.deadband();
+        canSignalFormat.mEmissionPolicy.mMaxSilenceMs = emissionPolicy.max_silence_ms();
+    }
+    return canSignalFormat;
+}
+
+/**
+ * @brief Builds the CANMessageFormats of the given CAN signals, which all belong to the same interface
+ *
+ * Each CANMessageFormat object contains an array of signal decoding rules for each signal it contains. Cloud sends us
+ * a set of Signal IDs so we need to iterate through them and either create new CANMessageFormat objects when they
+ * don't exist yet for the specified CAN frame id, or add the signal decoding rule to an existing one.
+ */
+void
+buildCANMessageFormats( const DecoderManifestMsg::DecoderManifest &protoDecoderManifest,
+                        const std::vector<int> &signalIndexes,
+                        const std::unordered_map<SignalID, ManifestSignalIndex> &signalToIndex,
+                        CANFrameToMessageMap &messageFormats )
+{
+    for ( auto i : signalIndexes )
+    {
+        const DecoderManifestMsg::CANSignal &canSignal = protoDecoderManifest.can_signals( i );
+        auto canSignalFormat = toCANSignalFormat( canSignal );
+        auto signalIndex = signalToIndex.find( canSignal.signal_id() );
+        if ( signalIndex != signalToIndex.end() )
+        {
+            canSignalFormat.mSignalIndex = signalIndex->second;
+        }
+        auto emplaced = messageFormats.emplace( canSignal.message_id(), CANMessageFormat() );
+        auto &messageFormat = emplaced.first->second;
+        if ( emplaced.second )
+        {
+            // The CANMessageFormat for this CANRawFrameID in this Node was not found, so it was created
+            messageFormat.mMessageID = canSignal.message_id();
+            messageFormat.mIsMultiplexed = false;
+            messageFormat.mSizeInBytes = MAX_CAN_FRAME_BYTE_SIZE;
+        }
+        if ( isCANFDSignal( canSignalFormat ) )
+        {
+            messageFormat.mSizeInBytes = MAX_CANFD_FRAME_BYTE_SIZE;
+        }
+        messageFormat.mSignals.emplace_back( canSignalFormat );
+    }
+}
+} // namespace
+
 DecoderManifestIngestion::~DecoderManifestIngestion()
 {
     // delete any global objects that were allocated by the Protocol Buffer library
@@ -39,7 +140,7 @@ DecoderManifestIngestion::getID() const
         return std::string();
     }
 
-    return mProtoDecoderManifest.arn();
+    return mID;
 }
 
 bool
@@ -122,6 +223,36 @@ DecoderManifestIngestion::getPIDSignalDecoderFormat( SignalID signalID ) const
     return NOT_FOUND_PID_DECODER_FORMAT;
 }
 
+DIDSignalDecoderFormat
+DecoderManifestIngestion::getDIDSignalDecoderFormat( SignalID signalID ) const
+{
+    if ( !mReady )
+    {
+        return NOT_FOUND_DID_DECODER_FORMAT;
+    }
+    auto didFormat = mSignalToDIDDictionary.find( signalID );
+    if ( didFormat == mSignalToDIDDictionary.end() )
+    {
+        return NOT_FOUND_DID_DECODER_FORMAT;
+    }
+    return didFormat->second;
+}
+
+ManifestSignalIndex
+DecoderManifestIngestion::getSignalIndex( SignalID signalID ) const
+{
+    if ( !mReady )
+    {
+        return INVALID_MANIFEST_SIGNAL_INDEX;
+    }
+    auto signalIndex = mSignalToIndex.find( signalID );
+    if ( signalIndex == mSignalToIndex.end() )
+    {
+        return INVALID_MANIFEST_SIGNAL_INDEX;
+    }
+    return signalIndex->second;
+}
+
 bool
 DecoderManifestIngestion::copyData( const std::uint8_t *inputBuffer, const size_t size )
 {
@@ -153,6 +284,7 @@ DecoderManifestIngestion::copyData( const std::uint8_t *inputBuffer, const size_
 
     // Set the ready flag to false, as we have new data that needs to be parsed
     mReady = false;
+    mBuiltFromChunks = false;
 
     mLogger.trace( "DecoderManifestIngestion::copyData()", "Copy of DecoderManifest data success." );
     return true;
@@ -168,6 +300,14 @@ DecoderManifestIngestion::build()
     // the headers we compiled with.
     GOOGLE_PROTOBUF_VERIFY_VERSION;
 
+    // The lookup tables were already built while the chunks were added
+    if ( mBuiltFromChunks )
+    {
+        mLogger.trace( "DecoderManifestIngestion::build", "Decoder Manifest built from chunks." );
+        mReady = true;
+        return true;
+    }
+
     // Ensure that we have data to parse
     if ( mProtoBinaryData.empty() )
     {
@@ -176,107 +316,160 @@ DecoderManifestIngestion::build()
         return false;
     }
 
-    // Try to parse the binary data into our mProtoDecoderManifest member variable
-    if ( !mProtoDecoderManifest.ParseFromArray( mProtoBinaryData.data(), static_cast<int>( mProtoBinaryData.size() ) ) )
+    // The parsed message is only needed while building the lookup tables. Parsing into an arena places the whole
+    // message tree in a few large blocks which are freed at once when the build returns.
+    TraceModule::get().sectionBegin( TraceSection::DECODER_MANIFEST_BUILD );
+    google::protobuf::Arena arena;
+    auto &protoDecoderManifest = *google::protobuf::Arena::CreateMessage<DecoderManifestMsg::DecoderManifest>( &arena );
+
+    // Try to parse the binary data into the arena allocated message
+    if ( !protoDecoderManifest.ParseFromArray( mProtoBinaryData.data(), static_cast<int>( mProtoBinaryData.size() ) ) )
     {
         mLogger.error( "DecoderManifestIngestion::build", "Failed to parse DecoderManifest proto." );
+        TraceModule::get().sectionEnd( TraceSection::DECODER_MANIFEST_BUILD );
         // Error parsing proto binary
         return false;
     }
 
-    // Do some validation of the DecoderManifest. Either CAN or OBD or both should be specified.
-    if ( mProtoDecoderManifest.can_signals_size() == 0 && mProtoDecoderManifest.obd_pid_signals_size() == 0 )
+    // Do some validation of the DecoderManifest. At least one of CAN, OBD or UDS signals should be specified.
+    if ( protoDecoderManifest.can_signals_size() == 0 && protoDecoderManifest.obd_pid_signals_size() == 0 &&
+         protoDecoderManifest.uds_did_signals_size() == 0 )
     {
-        // Error, missing required decoding information in the Decoder mProtoDecoderManifest
+        // Error, missing required decoding information in the Decoder Manifest
         mLogger.error(
             "DecoderManifestIngestion::build",
             "CAN Nodes or CAN Signal array or OBD PID Signal array is empty. Failed to build Decoder Manifest" );
+        TraceModule::get().sectionEnd( TraceSection::DECODER_MANIFEST_BUILD );
         return false;
     }
 
     mLogger.info( "DecoderManifestIngestion::build",
-                  "Building Decoder Manifest with ID: " + mProtoDecoderManifest.arn() );
+                  "Building Decoder Manifest with ID: " + protoDecoderManifest.arn() );
+
+    reset();
+    addSignals( protoDecoderManifest );
 
-    // Iterate over CAN Signals and build the mCANSignalFormatDictionary
-    for ( int i = 0; i < mProtoDecoderManifest.can_signals_size(); i++ )
+    mCompressionDictionary.reset();
+    if ( !protoDecoderManifest.compression_dictionary().empty() )
+    {
+        mCompressionDictionary = std::make_shared<const std::string>( protoDecoderManifest.compression_dictionary() );
+    }
+
+    mID = protoDecoderManifest.arn();
+    TraceModule::get().sectionEnd( TraceSection::DECODER_MANIFEST_BUILD );
+
+    mLogger.trace( "DecoderManifestIngestion::build", "Decoder Manifest build succeeded." );
+    // Set our ready flag to true
+    mReady = true;
+    return true;
+}
+
+void
+DecoderManifestIngestion::addSignals( const DecoderManifestMsg::DecoderManifest &protoDecoderManifest )
+{
+    // Reserve Map memory upfront as program already know the number of signals.
+    // This optimization can avoid multiple rehashes and improve overall build performance
+    auto signalCount = static_cast<size_t>( protoDecoderManifest.can_signals_size() ) +
+                       static_cast<size_t>( protoDecoderManifest.obd_pid_signals_size() ) +
+                       static_cast<size_t>( protoDecoderManifest.uds_did_signals_size() );
+    mSignalToVehicleDataSourceProtocol.reserve( mSignalToVehicleDataSourceProtocol.size() + signalCount );
+    mSignalToIndex.reserve( mSignalToIndex.size() + signalCount );
+    mSignalToCANRawFrameIDAndInterfaceIDDictionary.reserve(
+        mSignalToCANRawFrameIDAndInterfaceIDDictionary.size() +
+        static_cast<size_t>( protoDecoderManifest.can_signals_size() ) );
+
+    // Group the CAN Signals by interface keeping their order, as the CANMessageFormats of different interfaces are
+    // independent and can be built in parallel
+    std::vector<CANInterfaceID> interfaceIDs;
+    std::vector<std::vector<int>> signalIndexesPerInterface;
+    std::unordered_map<CANInterfaceID, size_t> interfaceIndexes;
+    for ( int i = 0; i < protoDecoderManifest.can_signals_size(); i++ )
     {
         // Get a reference to the CAN signal in the protobuf
-        const DecoderManifestMsg::CANSignal &canSignal = mProtoDecoderManifest.can_signals( i );
+        const DecoderManifestMsg::CANSignal &canSignal = protoDecoderManifest.can_signals( i );
         mSignalToVehicleDataSourceProtocol[canSignal.signal_id()] = VehicleDataSourceProtocol::RAW_SOCKET;
+        addSignalIndex( canSignal.signal_id() );
 
         // Add an entry to the Signal to CANRawFrameID and NodeID dictionary
         mSignalToCANRawFrameIDAndInterfaceIDDictionary.insert( std::make_pair(
             canSignal.signal_id(), std::make_pair( canSignal.message_id(), canSignal.interface_id() ) ) );
 
-        // Create a container to hold the InterfaceManagement::CANSignal we will build
-        CANSignalFormat canSignalFormat;
-
-        canSignalFormat.mSignalID = canSignal.signal_id();
-        canSignalFormat.mIsBigEndian = canSignal.is_big_endian();
-        canSignalFormat.mIsSigned = canSignal.is_signed();
-        canSignalFormat.mFirstBitPosition = static_cast<uint16_t>( canSignal.start_bit() );
-        canSignalFormat.mSizeInBits = static_cast<uint16_t>( canSignal.length() );
-        canSignalFormat.mOffset = canSignal.offset();
-        canSignalFormat.mFactor = canSignal.factor();
-
-        canSignalFormat.mIsMultiplexorSignal = false;
-        canSignalFormat.mMultiplexorValue = 0;
-
-        mLogger.trace( "DecoderManifestIngestion::build",
-                       "Adding CAN Signal Format for Signal ID: " + std::to_string( canSignalFormat.mSignalID ) );
+        auto emplaced = interfaceIndexes.emplace( canSignal.interface_id(), interfaceIDs.size() );
+        if ( emplaced.second )
+        {
+            interfaceIDs.emplace_back( canSignal.interface_id() );
+            signalIndexesPerInterface.emplace_back();
+        }
+        signalIndexesPerInterface[emplaced.first->second].emplace_back( i );
+    }
 
-        // Each CANMessageFormat object contains an array of signal decoding rules for each signal it contains. Cloud
-        // sends us a set of Signal IDs so we need to iterate through them and either create new CANMessageFormat
-        // objects when they don't exist yet for the specified CAN frame id, or add the signal decoding rule to an
-        // existing one.
+    // Each interface gets its own partial map, so that the threads share nothing but the read only proto
+    std::vector<CANFrameToMessageMap> messageFormatsPerInterface( interfaceIDs.size() );
+    size_t threadCount = 1;
+    if ( protoDecoderManifest.can_signals_size() >= PARALLEL_BUILD_MIN_CAN_SIGNALS )
+    {
+        threadCount = std::min<size_t>( std::max( std::thread::hardware_concurrency(), 1U ), interfaceIDs.size() );
+    }
+    auto buildInterfaces = [&]( size_t firstInterface ) {
+        for ( size_t j = firstInterface; j < interfaceIDs.size(); j += threadCount )
+        {
+            buildCANMessageFormats(
+                protoDecoderManifest, signalIndexesPerInterface[j], mSignalToIndex, messageFormatsPerInterface[j] );
+        }
+    };
+    std::vector<std::thread> threads;
+    for ( size_t t = 1; t < threadCount; t++ )
+    {
+        threads.emplace_back( buildInterfaces, t );
+    }
+    buildInterfaces( 0 );
+    for ( auto &thread : threads )
+    {
+        thread.join();
+    }
+    if ( threadCount > 1 )
+    {
+        mLogger.trace( "DecoderManifestIngestion::addSignals",
+                       "Built " + std::to_string( interfaceIDs.size() ) + " CAN interfaces on " +
+                           std::to_string( threadCount ) + " threads" );
+    }
 
-        // First check if CANMessageFormat exists for this message id and node id
-        if ( mCANMessageFormatDictionary.count( canSignal.interface_id() ) == 1 &&
-             mCANMessageFormatDictionary[canSignal.interface_id()].count( canSignal.message_id() ) == 1 )
+    // Merge the partial maps. A fragment of a chunked Decoder Manifest can add signals to existing messages.
+    for ( size_t j = 0; j < interfaceIDs.size(); j++ )
+    {
+        // Looked up first, as emplace may move the partial map away even if the interface exists already
+        auto existingInterface = mCANMessageFormatDictionary.find( interfaceIDs[j] );
+        if ( existingInterface == mCANMessageFormatDictionary.end() )
         {
-            // CANMessageFormat exists for a given node id and message id. Add this signal format to it
-            mCANMessageFormatDictionary[canSignal.interface_id()][canSignal.message_id()].mSignals.emplace_back(
-                canSignalFormat );
+            mCANMessageFormatDictionary.emplace( interfaceIDs[j], std::move( messageFormatsPerInterface[j] ) );
+            continue;
         }
-        else
+        auto &existingFormats = existingInterface->second;
+        for ( auto &messageFormat : messageFormatsPerInterface[j] )
         {
-            // The CANMessageFormat for this CANRawFrameID in this Node was not found. We have to create it
-
-            // First check if we need to create a node entry
-            if ( mCANMessageFormatDictionary.count( canSignal.interface_id() ) == 0 )
+            auto existing = existingFormats.find( messageFormat.first );
+            if ( existing == existingFormats.end() )
             {
-                // Create an empty CAN Frame ID -> CAN Message Format map for this node
-                mCANMessageFormatDictionary.insert(
-                    std::make_pair( canSignal.interface_id(), CANFrameToMessageMap() ) );
+                existingFormats.emplace( messageFormat.first, std::move( messageFormat.second ) );
+                continue;
             }
-
-            // Create the CANMessageFormat object
-            CANMessageFormat newCANMessageFormat;
-            newCANMessageFormat.mMessageID = canSignal.message_id();
-
-            newCANMessageFormat.mIsMultiplexed = false;
-
-            newCANMessageFormat.mSizeInBytes = MAX_CAN_FRAME_BYTE_SIZE;
-
-            // Insert the CAN Signal Format in the newly created CAN Message Format
-            newCANMessageFormat.mSignals.emplace_back( canSignalFormat );
-
-            // Insert the newly created CANMessageFormat containing the Signal Format in the CAN Message Format
-            // Dictionary
-            mCANMessageFormatDictionary.at( canSignal.interface_id() )
-                .insert( std::make_pair( canSignal.message_id(), newCANMessageFormat ) );
+            auto &existingFormat = existing->second;
+            existingFormat.mSizeInBytes = std::max( existingFormat.mSizeInBytes, messageFormat.second.mSizeInBytes );
+            existingFormat.mSignals.insert( existingFormat.mSignals.end(),
+                                            messageFormat.second.mSignals.begin(),
+                                            messageFormat.second.mSignals.end() );
         }
     }
 
-    // Reserve Map memory upfront as program already know the number of signals.
-    // This optimization can avoid multiple rehashes and improve overall build performance
-    mSignalToPIDDictionary.reserve( static_cast<size_t>( mProtoDecoderManifest.obd_pid_signals_size() ) );
+    mSignalToPIDDictionary.reserve( mSignalToPIDDictionary.size() +
+                                    static_cast<size_t>( protoDecoderManifest.obd_pid_signals_size() ) );
     // Iterate over OBD-II PID Signals and build the obdPIDSignalDecoderFormat
-    for ( int i = 0; i < mProtoDecoderManifest.obd_pid_signals_size(); i++ )
+    for ( int i = 0; i < protoDecoderManifest.obd_pid_signals_size(); i++ )
     {
         // Get a reference to the OBD PID signal in the protobuf
-        const DecoderManifestMsg::OBDPIDSignal &pidSignal = mProtoDecoderManifest.obd_pid_signals( i );
+        const DecoderManifestMsg::OBDPIDSignal &pidSignal = protoDecoderManifest.obd_pid_signals( i );
         mSignalToVehicleDataSourceProtocol[pidSignal.signal_id()] = VehicleDataSourceProtocol::OBD;
+        addSignalIndex( pidSignal.signal_id() );
 
         PIDSignalDecoderFormat obdPIDSignalDecoderFormat =
             PIDSignalDecoderFormat( pidSignal.pid_response_length(),
@@ -291,10 +484,193 @@ DecoderManifestIngestion::build()
         mSignalToPIDDictionary[pidSignal.signal_id()] = obdPIDSignalDecoderFormat;
     }
 
-    mLogger.trace( "DecoderManifestIngestion::build", "Decoder Manifest build succeeded." );
-    // Set our ready flag to true
-    mReady = true;
-    return true;
+    mSignalToDIDDictionary.reserve( mSignalToDIDDictionary.size() +
+                                    static_cast<size_t>( protoDecoderManifest.uds_did_signals_size() ) );
+    // Iterate over UDS DID Signals and build the DIDSignalDecoderFormat
+    for ( int i = 0; i < protoDecoderManifest.uds_did_signals_size(); i++ )
+    {
+        const DecoderManifestMsg::UDSDIDSignal &didSignal = protoDecoderManifest.uds_did_signals( i );
+        bool isPeriodic = didSignal.periodic_transmission_mode() != 0;
+        // A periodic DID is identified on the bus by its low byte and has to fit into one CAN frame with it
+        if ( ( didSignal.did() > UINT16_MAX ) || ( didSignal.periodic_transmission_mode() > 3 ) ||
+             ( didSignal.start_byte() + didSignal.byte_length() > didSignal.did_response_length() ) ||
+             ( isPeriodic && ( ( ( didSignal.did() & 0xFF00 ) != 0xF200 ) || ( didSignal.did() == 0xF2FF ) ||
+                               ( didSignal.did_response_length() > 7 ) ) ) )
+        {
+            mLogger.warn( "DecoderManifestIngestion::addSignals",
+                          "Invalid decoding rule of UDS DID signal " + std::to_string( didSignal.signal_id() ) );
+            continue;
+        }
+        mSignalToVehicleDataSourceProtocol[didSignal.signal_id()] = VehicleDataSourceProtocol::UDS;
+        addSignalIndex( didSignal.signal_id() );
+
+        DIDSignalDecoderFormat didSignalDecoderFormat;
+        didSignalDecoderFormat.mInterfaceID = didSignal.interface_id();
+        didSignalDecoderFormat.mRequestMessageID = didSignal.request_message_id();
+        didSignalDecoderFormat.mDID = static_cast<DID>( didSignal.did() );
+        didSignalDecoderFormat.mDidResponseLength = didSignal.did_response_length();
+        didSignalDecoderFormat.mPeriodicTransmissionMode =
+            static_cast<uint8_t>( didSignal.periodic_transmission_mode() );
+        didSignalDecoderFormat.mPeriodicResponseMessageID = didSignal.periodic_response_message_id();
+        didSignalDecoderFormat.mScaling = didSignal.scaling();
+        didSignalDecoderFormat.mOffset = didSignal.offset();
+        didSignalDecoderFormat.mStartByte = didSignal.start_byte();
+        didSignalDecoderFormat.mByteLength = didSignal.byte_length();
+        didSignalDecoderFormat.mBitRightShift = static_cast<uint8_t>( didSignal.bit_right_shift() );
+        didSignalDecoderFormat.mBitMaskLength = static_cast<uint8_t>( didSignal.bit_mask_length() );
+        mSignalToDIDDictionary[didSignal.signal_id()] = didSignalDecoderFormat;
+    }
+}
+
+void
+DecoderManifestIngestion::reset()
+{
+    mReady = false;
+    mBuiltFromChunks = false;
+    mNextChunkSequenceNumber = 0;
+    mTotalChunks = 0;
+    mChunksDigest = 0;
+    mID.clear();
+    mCompressionDictionary.reset();
+    mCANMessageFormatDictionary.clear();
+    mSignalToCANRawFrameIDAndInterfaceIDDictionary.clear();
+    mSignalToVehicleDataSourceProtocol.clear();
+    mSignalToPIDDictionary.clear();
+    mSignalToDIDDictionary.clear();
+    mSignalToIndex.clear();
+}
+
+void
+DecoderManifestIngestion::addSignalIndex( SignalID signalID )
+{
+    // A signal repeated in the Decoder Manifest keeps its first index
+    mSignalToIndex.emplace( signalID, static_cast<ManifestSignalIndex>( mSignalToIndex.size() ) );
+}
+
+bool
+DecoderManifestIngestion::isChunk( const std::uint8_t *inputBuffer, const size_t size )
+{
+    if ( ( inputBuffer == nullptr ) || ( size == 0 ) || ( size > DECODER_MANIFEST_BYTE_SIZE_LIMIT ) )
+    {
+        return false;
+    }
+    // Walk over the top level fields without parsing them. For a complete Decoder Manifest this skips over each
+    // signal once, which is much cheaper than parsing it twice.
+    google::protobuf::io::CodedInputStream stream( inputBuffer, static_cast<int>( size ) );
+    for ( uint32_t tag = stream.ReadTag(); tag != 0; tag = stream.ReadTag() )
+    {
+        if ( google::protobuf::internal::WireFormatLite::GetTagFieldNumber( tag ) ==
+             DecoderManifestMsg::DecoderManifest::kChunkFieldNumber )
+        {
+            return true;
+        }
+        if ( !google::protobuf::internal::WireFormatLite::SkipField( &stream, tag ) )
+        {
+            return false;
+        }
+    }
+    return false;
+}
+
+DecoderManifestChunkStatus
+DecoderManifestIngestion::addChunk( const std::uint8_t *inputBuffer, const size_t size )
+{
+    GOOGLE_PROTOBUF_VERIFY_VERSION;
+
+    if ( inputBuffer == nullptr || size == 0 )
+    {
+        mLogger.error( "DecoderManifestIngestion::addChunk", "Input buffer invalid" );
+        reset();
+        return DecoderManifestChunkStatus::INVALID;
+    }
+
+    // Only the chunk being added is parsed, so that the peak memory is bounded by the size of a chunk
+    google::protobuf::Arena arena;
+    auto &protoChunkMessage = *google::protobuf::Arena::CreateMessage<DecoderManifestMsg::DecoderManifest>( &arena );
+    if ( !protoChunkMessage.ParseFromArray( inputBuffer, static_cast<int>( size ) ) || !protoChunkMessage.has_chunk() )
+    {
+        mLogger.error( "DecoderManifestIngestion::addChunk", "Failed to parse DecoderManifest chunk." );
+        reset();
+        return DecoderManifestChunkStatus::INVALID;
+    }
+    const auto &chunk = protoChunkMessage.chunk();
+
+    if ( chunk.sequence_number() == 0 )
+    {
+        // A new Decoder Manifest starts, drop any incomplete previous one
+        reset();
+        mProtoBinaryData.clear();
+        mTotalChunks = chunk.total_chunks();
+        mID = protoChunkMessage.arn();
+    }
+    if ( ( chunk.sequence_number() != mNextChunkSequenceNumber ) || ( chunk.total_chunks() != mTotalChunks ) ||
+         ( mTotalChunks == 0 ) || ( protoChunkMessage.arn() != mID ) )
+    {
+        mLogger.error( "DecoderManifestIngestion::addChunk",
+                       "Unexpected chunk " + std::to_string( chunk.sequence_number() ) + " of " +
+                           std::to_string( chunk.total_chunks() ) + " for Decoder Manifest " +
+                           protoChunkMessage.arn() + ", expected chunk " +
+                           std::to_string( mNextChunkSequenceNumber ) + " of " + std::to_string( mTotalChunks ) +
+                           " for " + mID );
+        reset();
+        return DecoderManifestChunkStatus::INVALID;
+    }
+
+    const auto &fragment = chunk.fragment();
+    if ( mProtoBinaryData.size() + fragment.size() > DECODER_MANIFEST_BYTE_SIZE_LIMIT )
+    {
+        mLogger.error( "DecoderManifestIngestion::addChunk",
+                       "Decoder Manifest binary too big. Limit: " +
+                           std::to_string( DECODER_MANIFEST_BYTE_SIZE_LIMIT ) );
+        reset();
+        return DecoderManifestChunkStatus::INVALID;
+    }
+
+    auto &protoFragment = *google::protobuf::Arena::CreateMessage<DecoderManifestMsg::DecoderManifest>( &arena );
+    if ( !protoFragment.ParseFromString( fragment ) )
+    {
+        mLogger.error( "DecoderManifestIngestion::addChunk",
+                       "Failed to parse fragment of chunk " + std::to_string( chunk.sequence_number() ) );
+        reset();
+        return DecoderManifestChunkStatus::INVALID;
+    }
+
+    const auto *fragmentData = reinterpret_cast<const uint8_t *>( fragment.data() );
+    mChunksDigest = PersistencyManagement::crc32c( mChunksDigest, fragmentData, fragment.size() );
+    mProtoBinaryData.insert( mProtoBinaryData.end(), fragmentData, fragmentData + fragment.size() );
+    addSignals( protoFragment );
+    if ( !protoFragment.compression_dictionary().empty() )
+    {
+        mCompressionDictionary = std::make_shared<const std::string>( protoFragment.compression_dictionary() );
+    }
+    mNextChunkSequenceNumber++;
+
+    if ( mNextChunkSequenceNumber < mTotalChunks )
+    {
+        mLogger.trace( "DecoderManifestIngestion::addChunk",
+                       "Added chunk " + std::to_string( chunk.sequence_number() ) + " of " +
+                           std::to_string( mTotalChunks ) );
+        return DecoderManifestChunkStatus::INCOMPLETE;
+    }
+
+    if ( chunk.digest() != mChunksDigest )
+    {
+        mLogger.error( "DecoderManifestIngestion::addChunk", "Digest mismatch for Decoder Manifest " + mID );
+        reset();
+        return DecoderManifestChunkStatus::INVALID;
+    }
+    if ( mSignalToVehicleDataSourceProtocol.empty() )
+    {
+        mLogger.error( "DecoderManifestIngestion::addChunk",
+                       "CAN Signal array and OBD PID Signal array are empty. Failed to build Decoder Manifest" );
+        reset();
+        return DecoderManifestChunkStatus::INVALID;
+    }
+
+    mLogger.info( "DecoderManifestIngestion::addChunk",
+                  "Received all " + std::to_string( mTotalChunks ) + " chunks of Decoder Manifest with ID: " + mID );
+    mBuiltFromChunks = true;
+    return DecoderManifestChunkStatus::COMPLETE;
 }
 
 } // namespace DataManagement
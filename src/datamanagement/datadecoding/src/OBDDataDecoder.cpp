@@ -34,14 +34,15 @@ OBDDataDecoder::OBDDataDecoder()
 
 bool
 OBDDataDecoder::decodeSupportedPIDs( const SID &sid,
-                                     const std::vector<uint8_t> &inputData,
+                                     const uint8_t *inputData,
+                                     size_t inputSize,
                                      SupportedPIDs &supportedPIDs )
 {
     // First look at whether we received a positive response
     // The positive response can be identified by 0x40 + SID.
     // If the input size is less than 6 ( Response byte + Requested PID + 4 data bytes )
     // this is also not a valid input
-    if ( inputData.size() < 6 || POSITIVE_ECU_RESPONSE_BASE + toUType( sid ) != inputData[0] )
+    if ( inputSize < 6 || POSITIVE_ECU_RESPONSE_BASE + toUType( sid ) != inputData[0] )
     {
         mLogger.warn( "OBDDataDecoder::decodeSupportedPIDs", "Invalid Supported PID Input" );
         return false;
@@ -54,7 +55,7 @@ OBDDataDecoder::decodeSupportedPIDs( const SID &sid,
     // from the J1979 spec
     // 0x41(Positive response), 0x00( requested PID range), 4 Bytes, 0x20( requested PID range), 4 Bytes. etc
     uint8_t basePIDCount = 0;
-    for ( size_t i = 1; i < inputData.size(); ++i )
+    for ( size_t i = 1; i < inputSize; ++i )
     {
         // First extract the PID Range, its position is always ByteIndex mod 5
         if ( ( i % 5 ) == 1 )
@@ -93,13 +94,44 @@ void
 OBDDataDecoder::setDecoderDictionary( ConstOBDDecoderDictionaryConstPtr &dictionary )
 {
     // OBDDataDecoder is running in one thread, hence we don't need mutext to prevent race condition
-    mDecoderDictionaryConstPtr = dictionary;
+    mPIDTable.clear();
+    mPIDFormulas.clear();
+    if ( dictionary == nullptr )
+    {
+        return;
+    }
+    mPIDTable.resize( static_cast<size_t>( UINT8_MAX ) + 1U );
+    for ( const auto &pidFormat : *dictionary )
+    {
+        auto &entry = mPIDTable[pidFormat.first];
+        entry.inDictionary = true;
+        entry.responseLength = pidFormat.second.mSizeInBytes;
+        entry.firstFormula = static_cast<uint32_t>( mPIDFormulas.size() );
+        // check how many signals do we need to collect from this PID.
+        // This is defined in cloud decoder manifest.
+        // Each signal has its associated formula
+        for ( const auto &signal : pidFormat.second.mSignals )
+        {
+            // Before using formula, check it against rule
+            if ( !isFormulaValid( entry.responseLength, signal ) )
+            {
+                mLogger.warn( "OBDDataDecoder::setDecoderDictionary",
+                              "Invalid formula of signal " + std::to_string( signal.mSignalID ) + " of PID " +
+                                  std::to_string( pidFormat.first ) );
+                continue;
+            }
+            mPIDFormulas.emplace_back( toFormula( signal ) );
+        }
+        entry.formulaCount = static_cast<uint32_t>( mPIDFormulas.size() ) - entry.firstFormula;
+    }
 }
 
 bool
 OBDDataDecoder::decodeEmissionPIDs( const SID &sid,
-                                    const std::vector<PID> &pids,
-                                    const std::vector<uint8_t> &inputData,
+                                    const PID *pids,
+                                    size_t pidCount,
+                                    const uint8_t *inputData,
+                                    size_t inputSize,
                                     EmissionInfo &info )
 {
     // First look at whether we received a positive response
@@ -107,103 +139,77 @@ OBDDataDecoder::decodeEmissionPIDs( const SID &sid,
     // If the input size is less than 3 ( Positive Response + Response byte + Requested PID )
 
     // this is also not a valid input as we expect at least one by response.
-    if ( inputData.size() < 3 || POSITIVE_ECU_RESPONSE_BASE + toUType( sid ) != inputData[0] )
+    if ( inputSize < 3 || POSITIVE_ECU_RESPONSE_BASE + toUType( sid ) != inputData[0] )
     {
         mLogger.warn( "OBDDataDecoder::decodeEmissionPIDs", "Invalid response to PID request" );
         return false;
     }
-    if ( mDecoderDictionaryConstPtr == nullptr )
+    if ( mPIDTable.empty() )
     {
         mLogger.warn( "OBDDataDecoder::decodeEmissionPIDs", "Invalid Decoder Dictionary!" );
         return false;
     }
-    // Validate 1) The PIDs in response match with expected PID; 2) Total length of PID response matches with Decoder
-    // Manifest. If not matched, the program will discard this response and not attempt to decode.
-    if ( isPIDResponseValid( pids, inputData ) == false )
-    {
-        mLogger.warn( "OBDDataDecoder::decodeEmissionPIDs", "Invalid PIDs response" );
-        return false;
-    }
-    // Setup the Info
-    info.mSID = sid;
+    // Validate and decode in one pass: 1) The PIDs in response match with expected PID; 2) Total length of PID
+    // response matches with Decoder Manifest. If not matched, the program will discard this response. The signals
+    // are appended right away and removed again if the response turns out to be invalid.
+    auto previousSignalCount = info.mSignals.size();
     // Start from byte number 2 which is the PID requested
     size_t byteCounter = 1;
-    while ( byteCounter < inputData.size() )
+    for ( size_t pidIndex = 0; pidIndex < pidCount; pidIndex++ )
     {
-        auto pid = inputData[byteCounter++];
-        // first check whether the decoder dictionary contains this PID
-        if ( mDecoderDictionaryConstPtr->find( pid ) != mDecoderDictionaryConstPtr->end() )
+        auto pid = pids[pidIndex];
+        // if the response length is shorter than expected or the PID in ECU response mismatches with
+        // the requested PID, it's an invalid ECU response
+        if ( byteCounter >= inputSize || inputData[byteCounter] != pid )
         {
-            // The expected number of bytes returned from PID
-            auto expectedResponseLength = mDecoderDictionaryConstPtr->at( pid ).mSizeInBytes;
-            auto formulas = mDecoderDictionaryConstPtr->at( pid ).mSignals;
-            // first check whether we have received enough bytes for this PID
-            if ( byteCounter + expectedResponseLength <= inputData.size() )
-            {
-                // check how many signals do we need to collect from this PID.
-                // This is defined in cloud decoder manifest.
-                // Each signal has its associated formula
-                for ( auto formula : formulas )
-                {
-                    // Before using formula, check it against rule
-                    if ( isFormulaValid( pid, formula ) )
-                    {
-                        // In J1979 spec, longest value has 4-byte.
-                        // Allocate 64-bit here in case signal value increased in the future
-                        uint64_t rawData = 0;
-                        size_t byteIdx = byteCounter + ( formula.mFirstBitPosition / BYTE_SIZE );
-                        // If the signal length is less than 8-bit, we need to perform bit field operation
-                        if ( formula.mSizeInBits < BYTE_SIZE )
-                        {
-                            // bit manipulation performed here: shift first, then apply mask
-                            // e.g. If signal are bit 4 ~ 7 in Byte A.
-                            // we firstly right shift by 4, then apply bit mask 0b1111
-                            rawData = inputData[byteIdx];
-                            rawData >>= formula.mFirstBitPosition % BYTE_SIZE;
-                            rawData &= ( 0xFF >> ( BYTE_SIZE - formula.mSizeInBits ) );
-                        }
-                        else
-                        {
-                            // This signal contain greater or equal than one byte, concatenate raw bytes
-                            auto numOfBytes = formula.mSizeInBits / BYTE_SIZE;
-                            // This signal contains multiple bytes, concatenate the bytes
-                            while ( numOfBytes != 0 )
-                            {
-                                --numOfBytes;
-                                rawData = ( rawData << BYTE_SIZE ) | inputData[byteIdx++];
-                            }
-                        }
-                        // apply scaling and offset to the raw data.
-                        info.mPIDsToValues.emplace( formula.mSignalID,
-                                                    static_cast<SignalValue>( rawData ) * formula.mFactor +
-                                                        formula.mOffset );
-                    }
-                }
-            }
-            // Done with this PID, move on to next PID by increment byteCounter by response length of current PID
-            byteCounter += expectedResponseLength;
+            mLogger.warn( "OBDDataDecoder::decodeEmissionPIDs",
+                          "Cannot find PID " + std::to_string( pid ) + " in ECU response" );
+            info.mSignals.resize( previousSignalCount );
+            return false;
+        }
+        const auto &entry = mPIDTable[pid];
+        if ( !entry.inDictionary )
+        {
+            mLogger.warn( "OBDDataDecoder::decodeEmissionPIDs",
+                          "PID " + std::to_string( pid ) + " not found in decoder dictionary" );
+            info.mSignals.resize( previousSignalCount );
+            return false;
         }
-        else
+        byteCounter++;
+        // check whether we have received enough bytes for this PID
+        if ( byteCounter + entry.responseLength > inputSize )
         {
-            mLogger.trace( "OBDDataDecoder::decodeEmissionPIDs",
-                           "PID " + std::to_string( pid ) + " missing in decoder dictionary" );
-            // Cannot decode this byte as it doesn't exist in both decoder dictionary
-            // Cannot proceed with the rest of response because the payload might already be misaligned.
-            // Note because we already checked the response validity with isPIDResponseValid(), the program should
-            // not come here logically. But it might still happen in rare case such as bit flipping.
             break;
         }
+        const auto *pidData = &inputData[byteCounter];
+        for ( uint32_t i = entry.firstFormula; i < entry.firstFormula + entry.formulaCount; i++ )
+        {
+            const auto &formula = mPIDFormulas[i];
+            info.mSignals.emplace_back( formula.signalID, applyFormula( formula, pidData ) );
+        }
+        // Done with this PID, move on to next PID by increment byteCounter by response length of current PID
+        byteCounter += entry.responseLength;
+    }
+    if ( byteCounter != inputSize )
+    {
+        mLogger.warn( "OBDDataDecoder::decodeEmissionPIDs",
+                      "Expect response length: " + std::to_string( byteCounter ) +
+                          " Actual response length: " + std::to_string( inputSize ) );
+        info.mSignals.resize( previousSignalCount );
+        return false;
     }
-    return !info.mPIDsToValues.empty();
+    // Setup the Info
+    info.mSID = sid;
+    return info.mSignals.size() > previousSignalCount;
 }
 
 bool
-OBDDataDecoder::decodeDTCs( const SID &sid, const std::vector<uint8_t> &inputData, DTCInfo &info )
+OBDDataDecoder::decodeDTCs( const SID &sid, const uint8_t *inputData, size_t inputSize, DTCInfo &info )
 {
     // First look at whether we received a positive response
     // The positive response can be identified by 0x40 + SID.
     // If an ECU has no DTCs, it should respond with 2 Bytes ( 1 for Positive response + 1 number of DTCs( 0) )
-    if ( inputData.size() < 2 || POSITIVE_ECU_RESPONSE_BASE + toUType( sid ) != inputData[0] )
+    if ( inputSize < 2 || POSITIVE_ECU_RESPONSE_BASE + toUType( sid ) != inputData[0] )
     {
         return false;
     }
@@ -219,14 +225,14 @@ OBDDataDecoder::decodeDTCs( const SID &sid, const std::vector<uint8_t> &inputDat
     else
     {
         // Expect the size of the ECU response to be 2 + the 2 bytes for each DTC
-        if ( ( dtcCount * 2 ) + 2 != inputData.size() )
+        if ( ( dtcCount * 2 ) + 2 != inputSize )
         {
             // Corrupt frame
             return false;
         }
         // Process the DTCs in a chunk of 2 bytes
         std::string dtcString;
-        for ( size_t byteIndex = 2; byteIndex < inputData.size() - 1; byteIndex += 2 )
+        for ( size_t byteIndex = 2; byteIndex < inputSize - 1; byteIndex += 2 )
         {
 
             if ( extractDTCString( inputData[byteIndex], inputData[byteIndex + 1], dtcString ) )
@@ -279,79 +285,112 @@ OBDDataDecoder::extractDTCString( const uint8_t &firstByte, const uint8_t &secon
 }
 
 bool
-OBDDataDecoder::decodeVIN( const std::vector<uint8_t> &inputData, std::string &vin )
+OBDDataDecoder::decodeVIN( const uint8_t *inputData, size_t inputSize, std::string &vin )
 {
     // First look at whether we received a positive response
     // The positive response can be identified by 0x40 + SID.
     // The response is usually 1 byte of the positive response, 1 byte for the InfoType(PID), 1 byte for the number of
     // data item.
-    if ( inputData.size() < 3 ||
+    if ( inputSize < 3 ||
          POSITIVE_ECU_RESPONSE_BASE + toUType( vehicleIdentificationNumberRequest.mSID ) != inputData[0] ||
          vehicleIdentificationNumberRequest.mPID != inputData[1] )
     {
         return false;
     }
-    // Assign the rest of the vector to the output string
-    vin.assign( inputData.begin() + 3, inputData.end() );
+    // Assign the rest of the response to the output string
+    vin.assign( inputData + 3, inputData + inputSize );
     return !vin.empty();
 }
 
 bool
-OBDDataDecoder::isPIDResponseValid( const std::vector<PID> &pids, const std::vector<uint8_t> &ecuResponse )
+OBDDataDecoder::decodeDataIdentifier( DID did,
+                                      const uint8_t *inputData,
+                                      size_t inputSize,
+                                      const CANMessageFormat &format,
+                                      EmissionInfo &info )
 {
-    // This index is used to iterate through the ECU PID response length
-    // As the first byte in response is the Service Mode, we will start from the second byte.
-    size_t responseByteIndex = 1;
-    for ( auto pid : pids )
+    // A positive response is 0x62 followed by the DID and its data record
+    const size_t headerSize = 3;
+    if ( inputSize != headerSize + format.mSizeInBytes ||
+         inputData[0] != POSITIVE_ECU_RESPONSE_BASE + UDS_READ_DATA_BY_IDENTIFIER ||
+         inputData[1] != static_cast<uint8_t>( did >> BYTE_SIZE ) || inputData[2] != static_cast<uint8_t>( did ) )
     {
-        // if the response length is shorter than expected or the PID in ECU response mismatches with
-        // the requested PID, it's an invalid ECU response
-        if ( responseByteIndex >= ecuResponse.size() || ecuResponse[responseByteIndex] != pid )
-        {
-            mLogger.warn( "OBDDataDecoder::isPIDResponseValid",
-                          "Cannot find PID " + std::to_string( pid ) + " in ECU response" );
-            return false;
-        }
-        if ( mDecoderDictionaryConstPtr->find( pid ) != mDecoderDictionaryConstPtr->end() )
-        {
-            // Move Index into the next PID
-            responseByteIndex += ( mDecoderDictionaryConstPtr->at( pid ).mSizeInBytes + 1 );
-        }
-        else
+        mLogger.warn( "OBDDataDecoder::decodeDataIdentifier",
+                      "Invalid response to request of DID " + std::to_string( did ) );
+        return false;
+    }
+    bool decoded = false;
+    for ( const auto &signal : format.mSignals )
+    {
+        if ( !isFormulaValid( format.mSizeInBytes, signal ) )
         {
-            mLogger.warn( "OBDDataDecoder::isPIDResponseValid",
-                          "PID " + std::to_string( pid ) + " not found in decoder dictionary" );
-            return false;
+            mLogger.warn( "OBDDataDecoder::decodeDataIdentifier",
+                          "Invalid formula of signal " + std::to_string( signal.mSignalID ) + " of DID " +
+                              std::to_string( did ) );
+            continue;
         }
+        info.mSignals.emplace_back( signal.mSignalID, applyFormula( toFormula( signal ), &inputData[headerSize] ) );
+        decoded = true;
+    }
+    return decoded;
+}
+
+OBDDataDecoder::PIDFormula
+OBDDataDecoder::toFormula( const CANSignalFormat &signal )
+{
+    PIDFormula formula;
+    formula.signalID = signal.mSignalID;
+    formula.byteOffset = static_cast<uint8_t>( signal.mFirstBitPosition / BYTE_SIZE );
+    // If the signal length is less than 8-bit, we need to perform bit field operation
+    if ( signal.mSizeInBits < BYTE_SIZE )
+    {
+        // e.g. If signal are bit 4 ~ 7 in Byte A, shift right by 4, then apply bit mask 0b1111
+        formula.bitShift = static_cast<uint8_t>( signal.mFirstBitPosition % BYTE_SIZE );
+        formula.bitMask = static_cast<uint8_t>( 0xFF >> ( BYTE_SIZE - signal.mSizeInBits ) );
+    }
+    else
+    {
+        formula.numOfBytes = static_cast<uint8_t>( signal.mSizeInBits / BYTE_SIZE );
+    }
+    formula.factor = signal.mFactor;
+    formula.offset = signal.mOffset;
+    return formula;
+}
+
+SignalValue
+OBDDataDecoder::applyFormula( const PIDFormula &formula, const uint8_t *data )
+{
+    // In J1979 spec, longest value has 4-byte.
+    // Allocate 64-bit here in case signal value increased in the future
+    uint64_t rawData = 0;
+    if ( formula.numOfBytes == 0 )
+    {
+        rawData = static_cast<uint64_t>( ( data[formula.byteOffset] >> formula.bitShift ) & formula.bitMask );
     }
-    if ( responseByteIndex != ecuResponse.size() )
+    else
     {
-        mLogger.warn( "OBDDataDecoder::isPIDResponseValid",
-                      "Expect response length: " + std::to_string( responseByteIndex ) +
-                          " Actual response length: " + std::to_string( ecuResponse.size() ) );
+        // This signal contains multiple bytes, concatenate the bytes
+        for ( uint8_t byteIdx = formula.byteOffset; byteIdx < formula.byteOffset + formula.numOfBytes; byteIdx++ )
+        {
+            rawData = ( rawData << BYTE_SIZE ) | data[byteIdx];
+        }
     }
-    return responseByteIndex == ecuResponse.size();
+    // apply scaling and offset to the raw data.
+    return static_cast<SignalValue>( rawData ) * formula.factor + formula.offset;
 }
 
 bool
-OBDDataDecoder::isFormulaValid( PID pid, CANSignalFormat formula )
+OBDDataDecoder::isFormulaValid( uint8_t responseLength, const CANSignalFormat &formula )
 {
-    bool isValid = false;
     // Here's the rules we apply to check whether PID formula is valid
     // 1. First Bit Position has to be less than last bit position of PID response length
     // 2. Last Bit Position (first bit + sizeInBits) has to be less than or equal to last bit position of PID response
     // length
     // 3. If mSizeInBits are greater or equal than 8, both mSizeInBits and first bit position has to be multiple of 8
-    if ( mDecoderDictionaryConstPtr->find( pid ) != mDecoderDictionaryConstPtr->end() &&
-         formula.mFirstBitPosition < mDecoderDictionaryConstPtr->at( pid ).mSizeInBytes * BYTE_SIZE &&
-         ( formula.mSizeInBits + formula.mFirstBitPosition <=
-           mDecoderDictionaryConstPtr->at( pid ).mSizeInBytes * BYTE_SIZE ) &&
-         ( formula.mSizeInBits < 8 ||
-           ( ( formula.mSizeInBits & 0x7 ) == 0 && ( formula.mFirstBitPosition & 0x7 ) == 0 ) ) )
-    {
-        isValid = true;
-    }
-    return isValid;
+    return formula.mFirstBitPosition < responseLength * BYTE_SIZE &&
+           ( formula.mSizeInBits + formula.mFirstBitPosition <= responseLength * BYTE_SIZE ) &&
+           ( formula.mSizeInBits < 8 ||
+             ( ( formula.mSizeInBits & 0x7 ) == 0 && ( formula.mFirstBitPosition & 0x7 ) == 0 ) );
 }
 
 } // namespace DataManagement
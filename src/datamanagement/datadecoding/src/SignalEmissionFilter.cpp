@@ -0,0 +1,109 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+
+// Includes
+#include "SignalEmissionFilter.h"
+#include <cmath>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataManagement
+{
+
+void
+SignalEmissionFilter::setPolicies( const std::unordered_map<SignalID, SignalEmissionPolicy> &policies,
+                                   const std::unordered_map<SignalID, uint32_t> &minimumSampleIntervalsMs )
+{
+    mStates.clear();
+    for ( const auto &policy : policies )
+    {
+        if ( !policy.second.isAlways() )
+        {
+            mStates[policy.first].mPolicy = policy.second;
+        }
+    }
+    for ( const auto &interval : minimumSampleIntervalsMs )
+    {
+        if ( interval.second != 0 )
+        {
+            mStates[interval.first].mMinimumSampleIntervalMs = interval.second;
+        }
+    }
+}
+
+bool
+SignalEmissionFilter::shouldEmit( SignalID signalID,
+                                  double value,
+                                  Timestamp receiveTime,
+                                  TimestampFractionUs receiveTimeFractionUs )
+{
+    auto stateIterator = mStates.find( signalID );
+    if ( stateIterator == mStates.end() )
+    {
+        return true;
+    }
+    auto &state = stateIterator->second;
+    const auto &policy = state.mPolicy;
+    bool emit = !state.mHasEmitted;
+    if ( ( !emit ) && ( policy.mMaxSilenceMs != 0 ) && ( receiveTime >= state.mLastTime ) &&
+         ( receiveTime - state.mLastTime >= policy.mMaxSilenceMs ) )
+    {
+        // Heartbeat so that the inspection still sees a signal that did not change for a long time
+        emit = true;
+    }
+    if ( !emit )
+    {
+        double change = std::abs( value - state.mLastValue );
+        switch ( policy.mType )
+        {
+        case SignalEmissionPolicyType::ALWAYS:
+            emit = true;
+            break;
+        case SignalEmissionPolicyType::ON_CHANGE:
+            // NaN never equals the last value, so it is passed on
+            emit = !( value == state.mLastValue );
+            break;
+        case SignalEmissionPolicyType::ABSOLUTE_DEADBAND:
+            emit = !( change <= policy.mDeadband );
+            break;
+        case SignalEmissionPolicyType::RELATIVE_DEADBAND:
+            emit = !( change <= policy.mDeadband * std::abs( state.mLastValue ) );
+            break;
+        }
+    }
+    if ( !emit )
+    {
+        return false;
+    }
+    state.mHasEmitted = true;
+    state.mLastValue = value;
+    state.mLastTime = receiveTime;
+    if ( state.mMinimumSampleIntervalMs != 0 )
+    {
+        // Same check as the inspection applies to its signal buffers, so no sample needed by it is dropped
+        auto receiveTimeUs = toMicroseconds( receiveTime, receiveTimeFractionUs );
+        if ( receiveTimeUs < state.mLastSampleUs + state.mMinimumSampleIntervalMs * MICROSECONDS_PER_MILLISECOND )
+        {
+            return false;
+        }
+        state.mLastSampleUs = receiveTimeUs;
+    }
+    return true;
+}
+
+} // namespace DataManagement
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -0,0 +1,78 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "StaticCANDecoder.h"
+
+#ifdef FWE_STATIC_CAN_DECODERS
+// Generated by tools/static-can-decoders/generate-static-can-decoders.py, defines GENERATED_STATIC_CAN_DECODERS
+#include "GeneratedStaticCANDecoders.h"
+#endif
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataManagement
+{
+
+bool
+StaticCANMessageDecoder::matches( const CANMessageFormat &format ) const
+{
+    if ( ( format.mMessageID != mMessageID ) || ( format.mSizeInBytes != mSizeInBytes ) || format.isMultiplexed() ||
+         ( format.mSignals.size() != mSignalCount ) )
+    {
+        return false;
+    }
+    for ( const auto &signal : format.mSignals )
+    {
+        if ( findSignal( signal ) == mSignalCount )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t
+StaticCANMessageDecoder::findSignal( const CANSignalFormat &signal ) const
+{
+    for ( size_t i = 0; i < mSignalCount; i++ )
+    {
+        const auto &info = mSignals[i];
+        if ( ( info.mSignalID == signal.mSignalID ) && ( info.mFirstBitPosition == signal.mFirstBitPosition ) &&
+             ( info.mSizeInBits == signal.mSizeInBits ) && ( info.mIsBigEndian == signal.mIsBigEndian ) &&
+             ( info.mIsSigned == signal.mIsSigned ) && ( info.mFactor == signal.mFactor ) &&
+             ( info.mOffset == signal.mOffset ) && ( !signal.isMultiplexor() ) )
+        {
+            return i;
+        }
+    }
+    return mSignalCount;
+}
+
+const StaticCANMessageDecoder *
+getStaticCANDecoders( size_t &count )
+{
+#ifdef FWE_STATIC_CAN_DECODERS
+    count = sizeof( GENERATED_STATIC_CAN_DECODERS ) / sizeof( GENERATED_STATIC_CAN_DECODERS[0] );
+    return GENERATED_STATIC_CAN_DECODERS;
+#else
+    count = 0;
+    return nullptr;
+#endif
+}
+
+} // namespace DataManagement
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -0,0 +1,189 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+
+#include "CANDecoder.h"
+#include <benchmark/benchmark.h>
+
+using namespace Aws::IoTFleetWise::DataManagement;
+
+static CANMessageDecodePlan
+createWheelSpeedPlan()
+{
+    // Four 16 bit wheel speeds with scaling, a typical high rate message
+    CANMessageFormat msgFormat;
+    msgFormat.mSizeInBytes = 8;
+    for ( uint16_t i = 0; i < 4; i++ )
+    {
+        CANSignalFormat signal;
+        signal.mSignalID = i;
+        signal.mFirstBitPosition = static_cast<uint16_t>( i * 16 );
+        signal.mSizeInBits = 16;
+        signal.mFactor = 0.01;
+        signal.mOffset = -100.0;
+        msgFormat.mSignals.emplace_back( signal );
+    }
+    return CANDecoder::compileDecodePlan( msgFormat, { 0, 1, 2, 3 } );
+}
+
+static CANMessageDecodePlan
+createMotorolaPlan()
+{
+    // The same layout as the wheel speeds, but in Motorola byte order as used by many powertrain ECUs
+    CANMessageFormat msgFormat;
+    msgFormat.mSizeInBytes = 8;
+    for ( uint16_t i = 0; i < 4; i++ )
+    {
+        CANSignalFormat signal;
+        signal.mSignalID = i;
+        signal.mIsBigEndian = true;
+        signal.mFirstBitPosition = static_cast<uint16_t>( 8 + ( i * 16 ) );
+        signal.mSizeInBits = 16;
+        signal.mFactor = 0.01;
+        signal.mOffset = -100.0;
+        msgFormat.mSignals.emplace_back( signal );
+    }
+    return CANDecoder::compileDecodePlan( msgFormat, { 0, 1, 2, 3 } );
+}
+
+static CANMessageDecodePlan
+createMultiplexedPlan()
+{
+    // A multiplexor in the first byte and three signals in the other bytes for each of 4 MUX values, like the
+    // cell voltages of a battery management system
+    CANMessageFormat msgFormat;
+    msgFormat.mSizeInBytes = 8;
+    msgFormat.mIsMultiplexed = true;
+    CANSignalFormat multiplexor;
+    multiplexor.mSignalID = 100;
+    multiplexor.mFirstBitPosition = 0;
+    multiplexor.mSizeInBits = 8;
+    multiplexor.mFactor = 1.0;
+    multiplexor.mIsMultiplexorSignal = true;
+    msgFormat.mSignals.emplace_back( multiplexor );
+    std::unordered_set<SignalID> signalIDs;
+    for ( uint8_t muxValue = 0; muxValue < 4; muxValue++ )
+    {
+        for ( uint16_t i = 0; i < 3; i++ )
+        {
+            CANSignalFormat signal;
+            signal.mSignalID = static_cast<SignalID>( ( muxValue * 3 ) + i );
+            signal.mFirstBitPosition = static_cast<uint16_t>( 8 + ( i * 16 ) );
+            signal.mSizeInBits = 16;
+            signal.mFactor = 0.001;
+            signal.mMultiplexorValue = muxValue;
+            msgFormat.mSignals.emplace_back( signal );
+            signalIDs.insert( signal.mSignalID );
+        }
+    }
+    return CANDecoder::compileDecodePlan( msgFormat, signalIDs );
+}
+
+static std::vector<std::vector<uint8_t>>
+createFrames( size_t frameCount )
+{
+    std::vector<std::vector<uint8_t>> frames( frameCount, std::vector<uint8_t>( 8 ) );
+    for ( size_t i = 0; i < frameCount; i++ )
+    {
+        for ( size_t j = 0; j < 8; j++ )
+        {
+            frames[i][j] = static_cast<uint8_t>( i * 8 + j );
+        }
+    }
+    return frames;
+}
+
+static void
+BM_decodeFramesOneByOne( benchmark::State &state )
+{
+    auto plan = createWheelSpeedPlan();
+    auto frames = createFrames( static_cast<size_t>( state.range( 0 ) ) );
+    CANDecoder decoder;
+    for ( auto _ : state )
+    {
+        for ( const auto &frame : frames )
+        {
+            CANDecodedMessage decodedMessage;
+            decoder.decodeCANMessage( frame.data(), frame.size(), plan, decodedMessage );
+            benchmark::DoNotOptimize( decodedMessage.mFrameInfo.mSignals.data() );
+        }
+    }
+    state.SetItemsProcessed( state.iterations() * state.range( 0 ) );
+}
+BENCHMARK( BM_decodeFramesOneByOne )->Arg( 8 )->Arg( 64 );
+
+static void
+BM_decodeFramesBatch( benchmark::State &state )
+{
+    auto plan = createWheelSpeedPlan();
+    auto frames = createFrames( static_cast<size_t>( state.range( 0 ) ) );
+    std::vector<const uint8_t *> frameData;
+    for ( const auto &frame : frames )
+    {
+        frameData.push_back( frame.data() );
+    }
+    CANDecoder decoder;
+    std::vector<CANDecodedSignalColumn> columns;
+    for ( auto _ : state )
+    {
+        decoder.decodeCANMessages( frameData.data(), frameData.size(), 8, plan, columns );
+        benchmark::DoNotOptimize( columns.data() );
+    }
+    state.SetItemsProcessed( state.iterations() * state.range( 0 ) );
+}
+BENCHMARK( BM_decodeFramesBatch )->Arg( 8 )->Arg( 64 );
+
+static void
+BM_decodeMotorolaFramesOneByOne( benchmark::State &state )
+{
+    auto plan = createMotorolaPlan();
+    auto frames = createFrames( static_cast<size_t>( state.range( 0 ) ) );
+    CANDecoder decoder;
+    for ( auto _ : state )
+    {
+        for ( const auto &frame : frames )
+        {
+            CANDecodedMessage decodedMessage;
+            decoder.decodeCANMessage( frame.data(), frame.size(), plan, decodedMessage );
+            benchmark::DoNotOptimize( decodedMessage.mFrameInfo.mSignals.data() );
+        }
+    }
+    state.SetItemsProcessed( state.iterations() * state.range( 0 ) );
+}
+BENCHMARK( BM_decodeMotorolaFramesOneByOne )->Arg( 8 )->Arg( 64 );
+
+static void
+BM_decodeMultiplexedFramesOneByOne( benchmark::State &state )
+{
+    auto plan = createMultiplexedPlan();
+    auto frames = createFrames( static_cast<size_t>( state.range( 0 ) ) );
+    // The frames cycle through the MUX values
+    for ( size_t i = 0; i < frames.size(); i++ )
+    {
+        frames[i][0] = static_cast<uint8_t>( i % 4 );
+    }
+    CANDecoder decoder;
+    for ( auto _ : state )
+    {
+        for ( const auto &frame : frames )
+        {
+            CANDecodedMessage decodedMessage;
+            decoder.decodeCANMessage( frame.data(), frame.size(), plan, decodedMessage );
+            benchmark::DoNotOptimize( decodedMessage.mFrameInfo.mSignals.data() );
+        }
+    }
+    state.SetItemsProcessed( state.iterations() * state.range( 0 ) );
+}
+BENCHMARK( BM_decodeMultiplexedFramesOneByOne )->Arg( 8 )->Arg( 64 );
+
+BENCHMARK_MAIN();
@@ -0,0 +1,82 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+
+#include "CANDecoderMethodLookup.h"
+#include <gtest/gtest.h>
+#include <linux/can.h>
+
+using namespace Aws::IoTFleetWise::DataManagement;
+
+static CANMessageDecoderMethod
+createDecoderMethod( CANRawFrameID messageID )
+{
+    CANMessageDecoderMethod decoderMethod;
+    decoderMethod.collectType = CANMessageCollectType::DECODE;
+    decoderMethod.format.mMessageID = messageID;
+    return decoderMethod;
+}
+
+TEST( CANDecoderMethodLookupTest, StandardAndExtendedIDs )
+{
+    std::vector<CANRawFrameID> messageIDs = { 0x0, 0x123, 0x7FF, 0x800, 0x1FFFFFFF, 0x18FEF100 | CAN_EFF_FLAG };
+    // Many extended IDs differing only in the lower bits to provoke collisions
+    for ( CANRawFrameID i = 0; i < 100; i++ )
+    {
+        messageIDs.push_back( ( 0x18DA0000 + i ) | CAN_EFF_FLAG );
+    }
+    auto dictionary = std::make_shared<CANDecoderDictionary>();
+    for ( auto messageID : messageIDs )
+    {
+        dictionary->canMessageDecoderMethod[1][messageID] = createDecoderMethod( messageID );
+    }
+    dictionary->canMessageDecoderMethod[2][0x100] = createDecoderMethod( 0x100 );
+
+    CANDecoderMethodLookup lookup( dictionary, 1 );
+    ASSERT_EQ( lookup.size(), messageIDs.size() );
+    ASSERT_EQ( lookup.getDictionary(), dictionary );
+    for ( auto messageID : messageIDs )
+    {
+        auto decoderMethod = lookup.find( messageID );
+        ASSERT_NE( decoderMethod, nullptr ) << messageID;
+        ASSERT_EQ( decoderMethod->format.mMessageID, messageID );
+        ASSERT_EQ( decoderMethod, &dictionary->canMessageDecoderMethod[1][messageID] );
+    }
+    ASSERT_EQ( lookup.find( 0x100 ), nullptr );
+    ASSERT_EQ( lookup.find( 0x18FEF100 ), nullptr );
+    ASSERT_EQ( lookup.find( 0x18DA0100 | CAN_EFF_FLAG ), nullptr );
+    ASSERT_EQ( lookup.find( 0xFFFFFFFF ), nullptr );
+}
+
+TEST( CANDecoderMethodLookupTest, OnlyOneKindOfIDs )
+{
+    auto dictionary = std::make_shared<CANDecoderDictionary>();
+    dictionary->canMessageDecoderMethod[0][0x10] = createDecoderMethod( 0x10 );
+    dictionary->canMessageDecoderMethod[1][0x10 | CAN_EFF_FLAG] = createDecoderMethod( 0x10 | CAN_EFF_FLAG );
+
+    CANDecoderMethodLookup standardLookup( dictionary, 0 );
+    ASSERT_EQ( standardLookup.size(), 1 );
+    ASSERT_NE( standardLookup.find( 0x10 ), nullptr );
+    ASSERT_EQ( standardLookup.find( 0x10 | CAN_EFF_FLAG ), nullptr );
+
+    CANDecoderMethodLookup extendedLookup( dictionary, 1 );
+    ASSERT_EQ( extendedLookup.size(), 1 );
+    ASSERT_EQ( extendedLookup.find( 0x10 ), nullptr );
+    ASSERT_NE( extendedLookup.find( 0x10 | CAN_EFF_FLAG ), nullptr );
+
+    // A channel without decoder methods gives an empty lookup
+    CANDecoderMethodLookup emptyLookup( dictionary, 5 );
+    ASSERT_EQ( emptyLookup.size(), 0 );
+    ASSERT_EQ( emptyLookup.find( 0x10 ), nullptr );
+    ASSERT_EQ( emptyLookup.find( 0x10 | CAN_EFF_FLAG ), nullptr );
+}
@@ -297,6 +297,51 @@ TEST( CANDecoderTest, CANDecoderTestMultiplexedMessage1 )
     EXPECT_EQ( decodedMsg.mFrameInfo.mSignals[3].mRawValue, 0xD3 );
 }
 
+/** @brief
+ * This test validates that the MUX value selects the signals to decode even if the multiplexor is not collected, as
+ * for the frames of periodic UDS DIDs
+ */
+TEST( CANDecoderTest, CANDecoderTestMultiplexorNotCollected )
+{
+    std::vector<uint8_t> frameData = { 0x10, 0x12, 0x34, 0x56, 0x00, 0x00, 0x00, 0x00 };
+
+    CANSignalFormat multiplexorSignal;
+    multiplexorSignal.mSignalID = 60;
+    multiplexorSignal.mFirstBitPosition = 0;
+    multiplexorSignal.mSizeInBits = 8;
+    multiplexorSignal.mFactor = 1.0;
+    multiplexorSignal.mIsMultiplexorSignal = true;
+
+    CANSignalFormat sigMuxValue0x10;
+    sigMuxValue0x10.mSignalID = 61;
+    sigMuxValue0x10.mIsBigEndian = true;
+    sigMuxValue0x10.mFirstBitPosition = 16;
+    sigMuxValue0x10.mSizeInBits = 16;
+    sigMuxValue0x10.mMultiplexorValue = 0x10;
+
+    CANSignalFormat sigMuxValue0x11;
+    sigMuxValue0x11.mSignalID = 62;
+    sigMuxValue0x11.mIsBigEndian = true;
+    sigMuxValue0x11.mFirstBitPosition = 8;
+    sigMuxValue0x11.mSizeInBits = 8;
+    sigMuxValue0x11.mMultiplexorValue = 0x11;
+
+    CANMessageFormat msgFormat;
+    msgFormat.mSizeInBytes = 8;
+    msgFormat.mSignals.emplace_back( multiplexorSignal );
+    msgFormat.mSignals.emplace_back( sigMuxValue0x10 );
+    msgFormat.mSignals.emplace_back( sigMuxValue0x11 );
+    msgFormat.mIsMultiplexed = true;
+
+    CANDecoder decoder;
+    CANDecodedMessage decodedMsg;
+    std::unordered_set<SignalID> signalIDsToCollect = { 61, 62 };
+    ASSERT_TRUE( decoder.decodeCANMessage( frameData.data(), 8, msgFormat, signalIDsToCollect, decodedMsg ) );
+    ASSERT_EQ( decodedMsg.mFrameInfo.mSignals.size(), 1 );
+    EXPECT_EQ( decodedMsg.mFrameInfo.mSignals[0].mSignalID, 61 );
+    EXPECT_EQ( decodedMsg.mFrameInfo.mSignals[0].mRawValue, 0x1234 );
+}
+
 TEST( CANDecoderTest, CANDecoderTestMultiplexedMessage2 )
 {
     // Multiplexed Frame
@@ -506,4 +551,336 @@ TEST( CANDecoderTest, CANDecoderTestSkippingOutOfBoundSignals2 )
     std::unordered_set<SignalID> signalIDsToCollect = { 1, 2 };
     ASSERT_FALSE( decoder.decodeCANMessage( frameData.data(), frameSize, msgFormat, signalIDsToCollect, decodedMsg ) );
     ASSERT_EQ( decodedMsg.mFrameInfo.mSignals.size(), 1 );
-}
\ No newline at end of file
+}
+
+TEST( CANDecoderTest, CANDecoderTestCANFDSignalAboveByte8 )
+{
+    // 64 byte CAN FD frame with a little endian signal in bytes 60-61 and a big endian signal in bytes 40-41
+    std::vector<uint8_t> frameData( 64, 0 );
+    frameData[60] = 0x34;
+    frameData[61] = 0x12;
+    frameData[40] = 0xAB;
+    frameData[41] = 0xCD;
+
+    CANSignalFormat sigFormat1;
+    sigFormat1.mSignalID = 1;
+    sigFormat1.mIsBigEndian = false;
+    sigFormat1.mIsSigned = false;
+    sigFormat1.mFirstBitPosition = 480;
+    sigFormat1.mSizeInBits = 16;
+    sigFormat1.mOffset = 0.0;
+    sigFormat1.mFactor = 1.0;
+
+    CANSignalFormat sigFormat2;
+    sigFormat2.mSignalID = 2;
+    sigFormat2.mIsBigEndian = true;
+    sigFormat2.mIsSigned = false;
+    sigFormat2.mFirstBitPosition = 328;
+    sigFormat2.mSizeInBits = 16;
+    sigFormat2.mOffset = 0.0;
+    sigFormat2.mFactor = 1.0;
+
+    CANMessageFormat msgFormat;
+    msgFormat.mMessageID = 0x101;
+    msgFormat.mSizeInBytes = 64;
+    msgFormat.mSignals.emplace_back( sigFormat1 );
+    msgFormat.mSignals.emplace_back( sigFormat2 );
+
+    CANDecoder decoder;
+    CANDecodedMessage decodedMsg;
+    std::unordered_set<SignalID> signalIDsToCollect = { 1, 2 };
+    ASSERT_TRUE(
+        decoder.decodeCANMessage( frameData.data(), frameData.size(), msgFormat, signalIDsToCollect, decodedMsg ) );
+    ASSERT_EQ( decodedMsg.mFrameInfo.mSignals.size(), 2 );
+    ASSERT_EQ( decodedMsg.mFrameInfo.mSignals[0].mRawValue, 0x1234 );
+    ASSERT_EQ( decodedMsg.mFrameInfo.mSignals[1].mRawValue, 0xABCD );
+
+    // The same format on a classic 8 byte frame must be rejected
+    CANDecodedMessage decodedClassicMsg;
+    ASSERT_FALSE( decoder.decodeCANMessage( frameData.data(), 8, msgFormat, signalIDsToCollect, decodedClassicMsg ) );
+    ASSERT_EQ( decodedClassicMsg.mFrameInfo.mSignals.size(), 0 );
+}
+
+TEST( CANDecoderTest, CANDecoderTestDecodePlanMatchesByteWiseExtraction )
+{
+    // Every layout fitting into 8 bytes must give the same raw value with the single 64 bit load of the plan
+    std::vector<uint8_t> frameData( 64 );
+    for ( size_t i = 0; i < frameData.size(); i++ )
+    {
+        frameData[i] = static_cast<uint8_t>( ( i * 37 ) ^ 0xA5 );
+    }
+    for ( size_t frameSize : { 8U, 64U } )
+    {
+        for ( bool bigEndian : { false, true } )
+        {
+            for ( bool isSigned : { false, true } )
+            {
+                for ( uint16_t sizeInBits = 1; sizeInBits <= 57; sizeInBits++ )
+                {
+                    for ( size_t startBit = 0; startBit < frameSize * 8; startBit += 3 )
+                    {
+                        CANSignalFormat signal;
+                        signal.mSignalID = 1;
+                        signal.mIsBigEndian = bigEndian;
+                        signal.mIsSigned = isSigned;
+                        signal.mFirstBitPosition = static_cast<uint16_t>( startBit );
+                        signal.mSizeInBits = sizeInBits;
+                        signal.mFactor = 1.0;
+                        CANMessageFormat msgFormat;
+                        msgFormat.mSizeInBytes = static_cast<uint8_t>( frameSize );
+                        msgFormat.mSignals.emplace_back( signal );
+                        auto plan = CANDecoder::compileDecodePlan( msgFormat, { 1 } );
+                        ASSERT_EQ( plan.mSteps.size(), 1 );
+                        // Skip signals not fitting into the frame and Motorola signals reaching below byte 0
+                        if ( ( plan.mSteps[0].mMinFrameSize > frameSize ) ||
+                             ( bigEndian && ( ( startBit / 8 ) * 8 + 8 - ( startBit % 8 ) < sizeInBits ) ) )
+                        {
+                            continue;
+                        }
+                        ASSERT_FALSE( plan.mSteps[0].mUseSlowPath );
+                        CANDecoder decoder;
+                        CANDecodedMessage decodedMsg;
+                        ASSERT_TRUE( decoder.decodeCANMessage( frameData.data(), frameSize, plan, decodedMsg ) );
+                        ASSERT_EQ( decodedMsg.mFrameInfo.mSignals.size(), 1 );
+                        ASSERT_EQ( decodedMsg.mFrameInfo.mSignals[0].mRawValue,
+                                   CANDecoder::extractSignalFromFrame( frameData.data(), signal ) )
+                            << "start " << startBit << " size " << sizeInBits << " big endian " << bigEndian;
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST( CANDecoderTest, CANDecoderTestDecodePlanValidation )
+{
+    std::vector<uint8_t> frameData = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09 };
+    CANSignalFormat zeroSize;
+    zeroSize.mSignalID = 1;
+    zeroSize.mSizeInBits = 0;
+    // Motorola signal growing below byte 0, the missing bits are 0
+    CANSignalFormat bigEndianUnderflow;
+    bigEndianUnderflow.mSignalID = 2;
+    bigEndianUnderflow.mIsBigEndian = true;
+    bigEndianUnderflow.mFirstBitPosition = 4;
+    bigEndianUnderflow.mSizeInBits = 16;
+    bigEndianUnderflow.mFactor = 1.0;
+    // 61 bits starting at bit 4 span 9 bytes and need the byte wise extraction
+    CANSignalFormat wideSignal;
+    wideSignal.mSignalID = 3;
+    wideSignal.mFirstBitPosition = 4;
+    wideSignal.mSizeInBits = 61;
+    wideSignal.mFactor = 1.0;
+    CANMessageFormat msgFormat;
+    msgFormat.mSizeInBytes = 9;
+    msgFormat.mSignals = { zeroSize, bigEndianUnderflow, wideSignal };
+
+    auto plan = CANDecoder::compileDecodePlan( msgFormat, { 1, 2, 3 } );
+    ASSERT_EQ( plan.mSteps.size(), 3 );
+    ASSERT_EQ( plan.mSteps[0].mMinFrameSize, UINT16_MAX );
+    ASSERT_EQ( plan.mSteps[1].mMinFrameSize, 2 );
+    ASSERT_TRUE( plan.mSteps[2].mUseSlowPath );
+    ASSERT_EQ( plan.mSteps[2].mMinFrameSize, 9 );
+
+    CANDecoder decoder;
+    CANDecodedMessage decodedMsg;
+    ASSERT_FALSE( decoder.decodeCANMessage( frameData.data(), frameData.size(), plan, decodedMsg ) );
+    ASSERT_EQ( decodedMsg.mFrameInfo.mSignals.size(), 2 );
+    ASSERT_EQ( decodedMsg.mFrameInfo.mSignals[0].mSignalID, 2 );
+    ASSERT_EQ( decodedMsg.mFrameInfo.mSignals[0].mRawValue, 0x00 );
+    ASSERT_EQ( decodedMsg.mFrameInfo.mSignals[0].mRawValue,
+               CANDecoder::extractSignalFromFrame( frameData.data(), bigEndianUnderflow ) );
+    ASSERT_EQ( decodedMsg.mFrameInfo.mSignals[1].mSignalID, 3 );
+    ASSERT_EQ( decodedMsg.mFrameInfo.mSignals[1].mRawValue,
+               CANDecoder::extractSignalFromFrame( frameData.data(), wideSignal ) );
+
+    // A plan of a multiplexed message without multiplexor signal can not be decoded
+    msgFormat.mIsMultiplexed = true;
+    CANDecodedMessage decodedMuxMsg;
+    ASSERT_FALSE( decoder.decodeCANMessage(
+        frameData.data(), frameData.size(), CANDecoder::compileDecodePlan( msgFormat, { 3 } ), decodedMuxMsg ) );
+    ASSERT_EQ( decodedMuxMsg.mFrameInfo.mSignals.size(), 0 );
+}
+
+TEST( CANDecoderTest, CANDecoderTestDecodePlanOnlyContainsSignalsToCollect )
+{
+    std::vector<uint8_t> frameData = { 0x05, 0x02, 0x0B, 0x00, 0xD3, 0x00, 0x4B, 0x18 };
+    CANSignalFormat multiplexorSignal;
+    multiplexorSignal.mSignalID = 50;
+    multiplexorSignal.mSizeInBits = 4;
+    multiplexorSignal.mFactor = 1.0;
+    multiplexorSignal.mIsMultiplexorSignal = true;
+    CANMessageFormat msgFormat;
+    msgFormat.mSizeInBytes = 8;
+    msgFormat.mIsMultiplexed = true;
+    msgFormat.mSignals.emplace_back( multiplexorSignal );
+    for ( uint16_t i = 0; i < 3; i++ )
+    {
+        CANSignalFormat signal;
+        signal.mSignalID = 51U + i;
+        signal.mIsBigEndian = true;
+        signal.mFirstBitPosition = static_cast<uint16_t>( 16U + i * 16U );
+        signal.mSizeInBits = 16;
+        signal.mFactor = 1.0;
+        signal.mMultiplexorValue = 5;
+        msgFormat.mSignals.emplace_back( signal );
+    }
+
+    // The multiplexor is kept in the plan even if it is not collected
+    CANDecoder decoder;
+    auto plan = CANDecoder::compileDecodePlan( msgFormat, { 52 } );
+    ASSERT_EQ( plan.mSteps.size(), 2 );
+    ASSERT_EQ( plan.mMultiplexorStep, 0 );
+    ASSERT_FALSE( plan.mSteps[0].mCollect );
+    ASSERT_EQ( plan.mSteps[1].mSignalID, 52 );
+    CANDecodedMessage decodedMsg;
+    ASSERT_TRUE( decoder.decodeCANMessage( frameData.data(), frameData.size(), plan, decodedMsg ) );
+    ASSERT_EQ( decodedMsg.mFrameInfo.mSignals.size(), 1 );
+    ASSERT_EQ( decodedMsg.mFrameInfo.mSignals[0].mSignalID, 52 );
+    ASSERT_EQ( decodedMsg.mFrameInfo.mSignals[0].mRawValue, 0xD3 );
+
+    plan = CANDecoder::compileDecodePlan( msgFormat, { 50, 53 } );
+    ASSERT_EQ( plan.mSteps.size(), 2 );
+    ASSERT_TRUE( plan.mSteps[0].mCollect );
+    CANDecodedMessage decodedMuxMsg;
+    ASSERT_TRUE( decoder.decodeCANMessage( frameData.data(), frameData.size(), plan, decodedMuxMsg ) );
+    ASSERT_EQ( decodedMuxMsg.mFrameInfo.mSignals.size(), 2 );
+    ASSERT_EQ( decodedMuxMsg.mFrameInfo.mSignals[0].mRawValue, 0x05 );
+    ASSERT_EQ( decodedMuxMsg.mFrameInfo.mSignals[1].mSignalID, 53 );
+    ASSERT_EQ( decodedMuxMsg.mFrameInfo.mSignals[1].mRawValue, 0x4B );
+}
+
+TEST( CANDecoderTest, CANDecoderTestDecodePlanMultiplexorIndex )
+{
+    // 40 MUX values with 5 signals each, interleaved in the format
+    CANSignalFormat multiplexorSignal;
+    multiplexorSignal.mSignalID = 1000;
+    multiplexorSignal.mSizeInBits = 8;
+    multiplexorSignal.mFactor = 1.0;
+    multiplexorSignal.mIsMultiplexorSignal = true;
+    CANMessageFormat msgFormat;
+    msgFormat.mSizeInBytes = 8;
+    msgFormat.mIsMultiplexed = true;
+    msgFormat.mSignals.emplace_back( multiplexorSignal );
+    std::unordered_set<SignalID> signalIDsToCollect = { 1000 };
+    for ( uint32_t i = 0; i < 5; i++ )
+    {
+        for ( uint32_t muxValue = 0; muxValue < 40; muxValue++ )
+        {
+            CANSignalFormat signal;
+            signal.mSignalID = muxValue * 10 + i;
+            signal.mFirstBitPosition = static_cast<uint16_t>( 8 + i * 8 );
+            signal.mSizeInBits = 8;
+            signal.mFactor = 1.0;
+            signal.mMultiplexorValue = static_cast<uint8_t>( muxValue );
+            msgFormat.mSignals.emplace_back( signal );
+            signalIDsToCollect.insert( signal.mSignalID );
+        }
+    }
+    auto plan = CANDecoder::compileDecodePlan( msgFormat, signalIDsToCollect );
+    ASSERT_EQ( plan.mMultiplexedStepsBegin.size(), CANMessageDecodePlan::MULTIPLEXOR_VALUE_COUNT + 1 );
+    ASSERT_EQ( plan.mMultiplexedSteps.size(), plan.mSteps.size() );
+    ASSERT_EQ( plan.mMultiplexedStepsBegin[8], plan.mMultiplexedStepsBegin[7] + 5 );
+
+    CANDecoder decoder;
+    std::vector<uint8_t> frameData = { 7, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77 };
+    CANDecodedMessage decodedMsg;
+    ASSERT_TRUE( decoder.decodeCANMessage( frameData.data(), frameData.size(), plan, decodedMsg ) );
+    ASSERT_EQ( decodedMsg.mFrameInfo.mSignals.size(), 6 );
+    ASSERT_EQ( decodedMsg.mFrameInfo.mSignals[0].mSignalID, 1000 );
+    ASSERT_EQ( decodedMsg.mFrameInfo.mSignals[0].mRawValue, 7 );
+    for ( uint32_t i = 0; i < 5; i++ )
+    {
+        ASSERT_EQ( decodedMsg.mFrameInfo.mSignals[i + 1].mSignalID, 70 + i );
+        ASSERT_EQ( decodedMsg.mFrameInfo.mSignals[i + 1].mRawValue, frameData[i + 1] );
+    }
+
+    // A MUX value without signals only gives the multiplexor
+    frameData[0] = 200;
+    CANDecodedMessage decodedUnknownMuxMsg;
+    ASSERT_TRUE( decoder.decodeCANMessage( frameData.data(), frameData.size(), plan, decodedUnknownMuxMsg ) );
+    ASSERT_EQ( decodedUnknownMuxMsg.mFrameInfo.mSignals.size(), 1 );
+}
+
+TEST( CANDecoderTest, CANDecoderTestBatchDecodingMatchesSingleFrames )
+{
+    CANMessageFormat msgFormat;
+    msgFormat.mSizeInBytes = 16;
+    std::vector<CANSignalFormat> signals( 5 );
+    // Little endian signed with scaling
+    signals[0].mFirstBitPosition = 3;
+    signals[0].mSizeInBits = 12;
+    signals[0].mIsSigned = true;
+    signals[0].mFactor = 0.5;
+    signals[0].mOffset = -10.0;
+    // Motorola unsigned
+    signals[1].mFirstBitPosition = 23;
+    signals[1].mSizeInBits = 16;
+    signals[1].mIsBigEndian = true;
+    signals[1].mFactor = 1.0;
+    // 61 bits spanning 9 bytes use the byte wise extraction
+    signals[2].mFirstBitPosition = 36;
+    signals[2].mSizeInBits = 61;
+    signals[2].mFactor = 1.0;
+    // Not collected
+    signals[3].mFirstBitPosition = 0;
+    signals[3].mSizeInBits = 8;
+    signals[3].mFactor = 1.0;
+    // Does not fit into the frames
+    signals[4].mFirstBitPosition = 200;
+    signals[4].mSizeInBits = 8;
+    signals[4].mFactor = 1.0;
+    for ( uint32_t i = 0; i < signals.size(); i++ )
+    {
+        signals[i].mSignalID = i + 1;
+        signals[i].mSignalIndex = i;
+    }
+    msgFormat.mSignals = signals;
+    auto plan = CANDecoder::compileDecodePlan( msgFormat, { 1, 2, 3, 5 } );
+
+    const size_t FRAME_COUNT = 37;
+    std::vector<std::vector<uint8_t>> frames( FRAME_COUNT, std::vector<uint8_t>( 16 ) );
+    std::vector<const uint8_t *> frameData;
+    for ( size_t i = 0; i < FRAME_COUNT; i++ )
+    {
+        for ( size_t j = 0; j < frames[i].size(); j++ )
+        {
+            frames[i][j] = static_cast<uint8_t>( ( i * 131 + j * 29 ) ^ 0x5A );
+        }
+        frameData.push_back( frames[i].data() );
+    }
+
+    CANDecoder decoder;
+    std::vector<CANDecodedSignalColumn> columns;
+    // The signal not fitting into the frames fails the decoding like for single frames
+    ASSERT_FALSE( decoder.decodeCANMessages( frameData.data(), FRAME_COUNT, 16, plan, columns ) );
+    ASSERT_EQ( columns.size(), 3 );
+    for ( size_t i = 0; i < FRAME_COUNT; i++ )
+    {
+        CANDecodedMessage decodedMsg;
+        ASSERT_FALSE( decoder.decodeCANMessage( frameData[i], 16, plan, decodedMsg ) );
+        ASSERT_EQ( decodedMsg.mFrameInfo.mSignals.size(), columns.size() );
+        for ( size_t c = 0; c < columns.size(); c++ )
+        {
+            ASSERT_EQ( columns[c].mSignalID, decodedMsg.mFrameInfo.mSignals[c].mSignalID );
+            // The Decoder Manifest index is passed on with the signal
+            ASSERT_EQ( columns[c].mSignalIndex, columns[c].mSignalID - 1 );
+            ASSERT_EQ( decodedMsg.mFrameInfo.mSignals[c].mSignalIndex, columns[c].mSignalIndex );
+            ASSERT_EQ( columns[c].mPhysicalValues.size(), FRAME_COUNT );
+            ASSERT_DOUBLE_EQ( columns[c].mPhysicalValues[i], decodedMsg.mFrameInfo.mSignals[c].mPhysicalValue );
+        }
+    }
+
+    // Without the signal out of range the columns are reused
+    plan = CANDecoder::compileDecodePlan( msgFormat, { 1, 2 } );
+    ASSERT_TRUE( decoder.decodeCANMessages( frameData.data(), 2, 16, plan, columns ) );
+    ASSERT_EQ( columns.size(), 2 );
+    ASSERT_EQ( columns[1].mPhysicalValues.size(), 2 );
+
+    // Multiplexed plans can not be batch decoded
+    msgFormat.mIsMultiplexed = true;
+    msgFormat.mSignals[3].mIsMultiplexorSignal = true;
+    plan = CANDecoder::compileDecodePlan( msgFormat, { 1, 4 } );
+    ASSERT_FALSE( decoder.decodeCANMessages( frameData.data(), FRAME_COUNT, 16, plan, columns ) );
+    ASSERT_TRUE( columns.empty() );
+}
@@ -15,6 +15,7 @@
 #include "OBDDataDecoder.h"
 #include "EnumUtility.h"
 #include <gtest/gtest.h>
+#include <limits>
 #include <unistd.h>
 
 using namespace Aws::IoTFleetWise::DataManagement;
@@ -22,6 +23,23 @@ using namespace Aws::IoTFleetWise::DataManagement;
 // For testing purpose, Signal ID is defined as PID | (signal_order << PID_SIGNAL_BITS_LEFT_SHIFT)
 #define PID_SIGNAL_BITS_LEFT_SHIFT 8
 
+namespace
+{
+// Returns the value of the decoded signal, NaN if the signal was not decoded
+SignalValue
+getSignalValue( const EmissionInfo &info, uint32_t signalID )
+{
+    for ( const auto &signal : info.mSignals )
+    {
+        if ( signal.first == signalID )
+        {
+            return signal.second;
+        }
+    }
+    return std::numeric_limits<SignalValue>::quiet_NaN();
+}
+} // namespace
+
 class OBDDataDecoderTest : public ::testing::Test
 {
 protected:
@@ -92,7 +110,7 @@ TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedEngineLoad )
     ASSERT_TRUE( decoder.decodeEmissionPIDs( SID::CURRENT_STATS, { 0x04 }, txPDUData, info ) );
     ASSERT_EQ( info.mSID, SID::CURRENT_STATS );
 
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::ENGINE_LOAD )], 60 );
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::ENGINE_LOAD ) ), 60 );
 }
 
 TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedEngineTemperature )
@@ -103,7 +121,7 @@ TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedEngineTemperature )
 
     ASSERT_TRUE( decoder.decodeEmissionPIDs( SID::CURRENT_STATS, { 0x05 }, txPDUData, info ) );
     ASSERT_EQ( info.mSID, SID::CURRENT_STATS );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::ENGINE_COOLANT_TEMPERATURE )], 70 );
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::ENGINE_COOLANT_TEMPERATURE ) ), 70 );
 }
 
 TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedFuelTrim )
@@ -115,10 +133,10 @@ TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedFuelTrim )
 
     ASSERT_TRUE( decoder.decodeEmissionPIDs( SID::CURRENT_STATS, { 0x06, 0x07, 0x08, 0x09 }, txPDUData, info ) );
     ASSERT_EQ( info.mSID, SID::CURRENT_STATS );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::SHORT_TERM_FUEL_TRIM_BANK_1 )], 50 );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::SHORT_TERM_FUEL_TRIM_BANK_2 )], 50 );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::LONG_TERM_FUEL_TRIM_BANK_1 )], 50 );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::LONG_TERM_FUEL_TRIM_BANK_2 )], 50 );
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::SHORT_TERM_FUEL_TRIM_BANK_1 ) ), 50 );
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::SHORT_TERM_FUEL_TRIM_BANK_2 ) ), 50 );
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::LONG_TERM_FUEL_TRIM_BANK_1 ) ), 50 );
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::LONG_TERM_FUEL_TRIM_BANK_2 ) ), 50 );
 }
 
 TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedIntakeManifoldPressure )
@@ -129,7 +147,7 @@ TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedIntakeManifoldPressure )
 
     ASSERT_TRUE( decoder.decodeEmissionPIDs( SID::CURRENT_STATS, { 0x0B }, txPDUData, info ) );
     ASSERT_EQ( info.mSID, SID::CURRENT_STATS );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::INTAKE_MANIFOLD_ABSOLUTE_PRESSURE )], 200 );
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::INTAKE_MANIFOLD_ABSOLUTE_PRESSURE ) ), 200 );
 }
 
 TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedIntakeAirFLowTemperature )
@@ -140,7 +158,7 @@ TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedIntakeAirFLowTemperature )
 
     ASSERT_TRUE( decoder.decodeEmissionPIDs( SID::CURRENT_STATS, { 0x0F }, txPDUData, info ) );
     ASSERT_EQ( info.mSID, SID::CURRENT_STATS );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::INTAKE_AIR_FLOW_TEMPERATURE )], 30 );
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::INTAKE_AIR_FLOW_TEMPERATURE ) ), 30 );
 }
 
 TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedMAFRate )
@@ -151,7 +169,7 @@ TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedMAFRate )
 
     ASSERT_TRUE( decoder.decodeEmissionPIDs( SID::CURRENT_STATS, { 0x10 }, txPDUData, info ) );
     ASSERT_EQ( info.mSID, SID::CURRENT_STATS );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::MAF_RATE )], ( 256.0 * 0x0A + 0x0A ) / 100 );
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::MAF_RATE ) ), ( 256.0 * 0x0A + 0x0A ) / 100 );
 }
 
 TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedThrottlePosition )
@@ -162,7 +180,7 @@ TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedThrottlePosition )
 
     ASSERT_TRUE( decoder.decodeEmissionPIDs( SID::CURRENT_STATS, { 0x11 }, txPDUData, info ) );
     ASSERT_EQ( info.mSID, SID::CURRENT_STATS );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::THROTTLE_POSITION )], (double)0x80 * 100 / 255 );
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::THROTTLE_POSITION ) ), (double)0x80 * 100 / 255 );
 }
 
 TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedOxygenSensorX_1 )
@@ -175,8 +193,8 @@ TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedOxygenSensorX_1 )
         txPDUData[1] = pid;
         ASSERT_TRUE( decoder.decodeEmissionPIDs( SID::CURRENT_STATS, { pid }, txPDUData, info ) );
         ASSERT_EQ( info.mSID, SID::CURRENT_STATS );
-        ASSERT_DOUBLE_EQ( info.mPIDsToValues[pid | ( 0 << PID_SIGNAL_BITS_LEFT_SHIFT )], (double)0x10 / 200 );
-        ASSERT_DOUBLE_EQ( info.mPIDsToValues[pid | ( 1 << PID_SIGNAL_BITS_LEFT_SHIFT )],
+        ASSERT_DOUBLE_EQ( getSignalValue( info, pid | ( 0 << PID_SIGNAL_BITS_LEFT_SHIFT ) ), (double)0x10 / 200 );
+        ASSERT_DOUBLE_EQ( getSignalValue( info, pid | ( 1 << PID_SIGNAL_BITS_LEFT_SHIFT ) ),
                           (double)0x20 * 100 / 128 - 100 );
     }
 }
@@ -189,7 +207,7 @@ TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedRuntimeSinceEngineStart )
 
     ASSERT_TRUE( decoder.decodeEmissionPIDs( SID::CURRENT_STATS, { 0x1F }, txPDUData, info ) );
     ASSERT_EQ( info.mSID, SID::CURRENT_STATS );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::RUNTIME_SINCE_ENGINE_START )], 500 );
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::RUNTIME_SINCE_ENGINE_START ) ), 500 );
 }
 
 TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedDistanceTraveledWithMIL )
@@ -200,7 +218,7 @@ TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedDistanceTraveledWithMIL )
 
     ASSERT_TRUE( decoder.decodeEmissionPIDs( SID::CURRENT_STATS, { 0x21 }, txPDUData, info ) );
     ASSERT_EQ( info.mSID, SID::CURRENT_STATS );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::DISTANCE_TRAVELED_WITH_MIL )], 10 );
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::DISTANCE_TRAVELED_WITH_MIL ) ), 10 );
 }
 
 TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedOxygenSensorX_2 )
@@ -213,9 +231,9 @@ TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedOxygenSensorX_2 )
         txPDUData[1] = pid;
         ASSERT_TRUE( decoder.decodeEmissionPIDs( SID::CURRENT_STATS, { pid }, txPDUData, info ) );
         ASSERT_EQ( info.mSID, SID::CURRENT_STATS );
-        ASSERT_DOUBLE_EQ( info.mPIDsToValues[pid | ( 0 << PID_SIGNAL_BITS_LEFT_SHIFT )],
+        ASSERT_DOUBLE_EQ( getSignalValue( info, pid | ( 0 << PID_SIGNAL_BITS_LEFT_SHIFT ) ),
                           ( 256 * 0x10 + 0x20 ) * 0.0000305 );
-        ASSERT_DOUBLE_EQ( info.mPIDsToValues[pid | ( 1 << PID_SIGNAL_BITS_LEFT_SHIFT )],
+        ASSERT_DOUBLE_EQ( getSignalValue( info, pid | ( 1 << PID_SIGNAL_BITS_LEFT_SHIFT ) ),
                           ( 256 * 0x30 + 0x40 ) * 0.000122 );
     }
 }
@@ -228,7 +246,7 @@ TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedFuelTankLevel )
 
     ASSERT_TRUE( decoder.decodeEmissionPIDs( SID::CURRENT_STATS, { 0x2F }, txPDUData, info ) );
     ASSERT_EQ( info.mSID, SID::CURRENT_STATS );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::FUEL_TANK_LEVEL )], 100 );
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::FUEL_TANK_LEVEL ) ), 100 );
 }
 
 TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedDistanceTraveledSinceClearedDTC )
@@ -239,7 +257,7 @@ TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedDistanceTraveledSinceClearedDTC
 
     ASSERT_TRUE( decoder.decodeEmissionPIDs( SID::CURRENT_STATS, { 0x31 }, txPDUData, info ) );
     ASSERT_EQ( info.mSID, SID::CURRENT_STATS );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::DISTANCE_TRAVELED_SINCE_CLEARED_DTC )], 10 );
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::DISTANCE_TRAVELED_SINCE_CLEARED_DTC ) ), 10 );
 }
 
 TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedControlModuleVoltage )
@@ -250,7 +268,7 @@ TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedControlModuleVoltage )
 
     ASSERT_TRUE( decoder.decodeEmissionPIDs( SID::CURRENT_STATS, { 0x42 }, txPDUData, info ) );
     ASSERT_EQ( info.mSID, SID::CURRENT_STATS );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::CONTROL_MODULE_VOLTAGE )],
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::CONTROL_MODULE_VOLTAGE ) ),
                       ( 256.0 * 100 + 100 ) / 1000 );
 }
 
@@ -262,7 +280,7 @@ TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedRelativeThrottlePosition )
 
     ASSERT_TRUE( decoder.decodeEmissionPIDs( SID::CURRENT_STATS, { 0x45 }, txPDUData, info ) );
     ASSERT_EQ( info.mSID, SID::CURRENT_STATS );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::RELATIVE_THROTTLE_POSITION )],
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::RELATIVE_THROTTLE_POSITION ) ),
                       (double)0x80 * 100 / 255 );
 }
 
@@ -274,7 +292,7 @@ TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedAmbientAireTemperature )
 
     ASSERT_TRUE( decoder.decodeEmissionPIDs( SID::CURRENT_STATS, { 0x46 }, txPDUData, info ) );
     ASSERT_EQ( info.mSID, SID::CURRENT_STATS );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::AMBIENT_AIR_TEMPERATURE )], 30 );
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::AMBIENT_AIR_TEMPERATURE ) ), 30 );
 }
 
 TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedRelativePedalPosition )
@@ -285,7 +303,7 @@ TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedRelativePedalPosition )
 
     ASSERT_TRUE( decoder.decodeEmissionPIDs( SID::CURRENT_STATS, { 0x5A }, txPDUData, info ) );
     ASSERT_EQ( info.mSID, SID::CURRENT_STATS );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::RELATIVE_ACCELERATOR_PEDAL_POSITION )], 100 );
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::RELATIVE_ACCELERATOR_PEDAL_POSITION ) ), 100 );
 }
 
 TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedBatteryRemainingLife )
@@ -296,7 +314,7 @@ TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedBatteryRemainingLife )
 
     ASSERT_TRUE( decoder.decodeEmissionPIDs( SID::CURRENT_STATS, { 0x5B }, txPDUData, info ) );
     ASSERT_EQ( info.mSID, SID::CURRENT_STATS );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::HYBRID_BATTERY_PACK_REMAINING_LIFE )], 100 );
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::HYBRID_BATTERY_PACK_REMAINING_LIFE ) ), 100 );
 }
 
 TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedEngineOilTemperature )
@@ -307,7 +325,7 @@ TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedEngineOilTemperature )
 
     ASSERT_TRUE( decoder.decodeEmissionPIDs( SID::CURRENT_STATS, { 0x5C }, txPDUData, info ) );
     ASSERT_EQ( info.mSID, SID::CURRENT_STATS );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::ENGINE_OIL_TEMPERATURE )], 30 );
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::ENGINE_OIL_TEMPERATURE ) ), 30 );
 }
 
 TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedDriverDemandTorque )
@@ -318,7 +336,7 @@ TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedDriverDemandTorque )
 
     ASSERT_TRUE( decoder.decodeEmissionPIDs( SID::CURRENT_STATS, { 0x61 }, txPDUData, info ) );
     ASSERT_EQ( info.mSID, SID::CURRENT_STATS );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::DRIVER_DEMAND_PERCENT_TORQUE )], 100 );
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::DRIVER_DEMAND_PERCENT_TORQUE ) ), 100 );
 }
 
 TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedActualEngineTorque )
@@ -329,7 +347,7 @@ TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedActualEngineTorque )
 
     ASSERT_TRUE( decoder.decodeEmissionPIDs( SID::CURRENT_STATS, { 0x62 }, txPDUData, info ) );
     ASSERT_EQ( info.mSID, SID::CURRENT_STATS );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::ACTUAL_PERCENT_TORQUE )], 100 );
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::ACTUAL_PERCENT_TORQUE ) ), 100 );
 }
 
 TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedReferenceEngineTorque )
@@ -340,7 +358,7 @@ TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedReferenceEngineTorque )
 
     ASSERT_TRUE( decoder.decodeEmissionPIDs( SID::CURRENT_STATS, { 0x63 }, txPDUData, info ) );
     ASSERT_EQ( info.mSID, SID::CURRENT_STATS );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::ENGINE_REFERENCE_PERCENT_TORQUE )], 25700 );
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::ENGINE_REFERENCE_PERCENT_TORQUE ) ), 25700 );
 }
 
 TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedBoostPressureControl )
@@ -351,28 +369,28 @@ TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedBoostPressureControl )
     ASSERT_TRUE( decoder.decodeEmissionPIDs( SID::CURRENT_STATS, { 0x70 }, txPDUData, info ) );
     ASSERT_EQ( info.mSID, SID::CURRENT_STATS );
     ASSERT_DOUBLE_EQ(
-        info.mPIDsToValues[toUType( EmissionPIDs::BOOST_PRESSURE_CONTROL ) | ( 0 << PID_SIGNAL_BITS_LEFT_SHIFT )],
+        getSignalValue( info, toUType( EmissionPIDs::BOOST_PRESSURE_CONTROL ) | ( 0 << PID_SIGNAL_BITS_LEFT_SHIFT ) ),
         0x3F );
     ASSERT_DOUBLE_EQ(
-        info.mPIDsToValues[toUType( EmissionPIDs::BOOST_PRESSURE_CONTROL ) | ( 1 << PID_SIGNAL_BITS_LEFT_SHIFT )],
+        getSignalValue( info, toUType( EmissionPIDs::BOOST_PRESSURE_CONTROL ) | ( 1 << PID_SIGNAL_BITS_LEFT_SHIFT ) ),
         803.125 );
     ASSERT_DOUBLE_EQ(
-        info.mPIDsToValues[toUType( EmissionPIDs::BOOST_PRESSURE_CONTROL ) | ( 2 << PID_SIGNAL_BITS_LEFT_SHIFT )],
+        getSignalValue( info, toUType( EmissionPIDs::BOOST_PRESSURE_CONTROL ) | ( 2 << PID_SIGNAL_BITS_LEFT_SHIFT ) ),
         803.125 );
     ASSERT_DOUBLE_EQ(
-        info.mPIDsToValues[toUType( EmissionPIDs::BOOST_PRESSURE_CONTROL ) | ( 3 << PID_SIGNAL_BITS_LEFT_SHIFT )],
+        getSignalValue( info, toUType( EmissionPIDs::BOOST_PRESSURE_CONTROL ) | ( 3 << PID_SIGNAL_BITS_LEFT_SHIFT ) ),
         803.125 );
     ASSERT_DOUBLE_EQ(
-        info.mPIDsToValues[toUType( EmissionPIDs::BOOST_PRESSURE_CONTROL ) | ( 4 << PID_SIGNAL_BITS_LEFT_SHIFT )],
+        getSignalValue( info, toUType( EmissionPIDs::BOOST_PRESSURE_CONTROL ) | ( 4 << PID_SIGNAL_BITS_LEFT_SHIFT ) ),
         803.125 );
     ASSERT_DOUBLE_EQ(
-        info.mPIDsToValues[toUType( EmissionPIDs::BOOST_PRESSURE_CONTROL ) | ( 5 << PID_SIGNAL_BITS_LEFT_SHIFT )],
+        getSignalValue( info, toUType( EmissionPIDs::BOOST_PRESSURE_CONTROL ) | ( 5 << PID_SIGNAL_BITS_LEFT_SHIFT ) ),
         0x03 );
     ASSERT_DOUBLE_EQ(
-        info.mPIDsToValues[toUType( EmissionPIDs::BOOST_PRESSURE_CONTROL ) | ( 6 << PID_SIGNAL_BITS_LEFT_SHIFT )],
+        getSignalValue( info, toUType( EmissionPIDs::BOOST_PRESSURE_CONTROL ) | ( 6 << PID_SIGNAL_BITS_LEFT_SHIFT ) ),
         0x03 );
     ASSERT_DOUBLE_EQ(
-        info.mPIDsToValues[toUType( EmissionPIDs::BOOST_PRESSURE_CONTROL ) | ( 7 << PID_SIGNAL_BITS_LEFT_SHIFT )],
+        getSignalValue( info, toUType( EmissionPIDs::BOOST_PRESSURE_CONTROL ) | ( 7 << PID_SIGNAL_BITS_LEFT_SHIFT ) ),
         0x00 );
 }
 
@@ -383,29 +401,29 @@ TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedVariableGeometryTurboControl )
 
     ASSERT_TRUE( decoder.decodeEmissionPIDs( SID::CURRENT_STATS, { 0x71 }, txPDUData, info ) );
     ASSERT_EQ( info.mSID, SID::CURRENT_STATS );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::VARIABLE_GEOMETRY_TURBO_CONTROL ) |
-                                         ( 0 << PID_SIGNAL_BITS_LEFT_SHIFT )],
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::VARIABLE_GEOMETRY_TURBO_CONTROL ) |
+                                            ( 0 << PID_SIGNAL_BITS_LEFT_SHIFT ) ),
                       0x3F );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::VARIABLE_GEOMETRY_TURBO_CONTROL ) |
-                                         ( 1 << PID_SIGNAL_BITS_LEFT_SHIFT )],
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::VARIABLE_GEOMETRY_TURBO_CONTROL ) |
+                                            ( 1 << PID_SIGNAL_BITS_LEFT_SHIFT ) ),
                       (double)100 / 255 * 0x10 );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::VARIABLE_GEOMETRY_TURBO_CONTROL ) |
-                                         ( 2 << PID_SIGNAL_BITS_LEFT_SHIFT )],
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::VARIABLE_GEOMETRY_TURBO_CONTROL ) |
+                                            ( 2 << PID_SIGNAL_BITS_LEFT_SHIFT ) ),
                       (double)100 / 255 * 0x20 );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::VARIABLE_GEOMETRY_TURBO_CONTROL ) |
-                                         ( 3 << PID_SIGNAL_BITS_LEFT_SHIFT )],
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::VARIABLE_GEOMETRY_TURBO_CONTROL ) |
+                                            ( 3 << PID_SIGNAL_BITS_LEFT_SHIFT ) ),
                       (double)100 / 255 * 0x30 );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::VARIABLE_GEOMETRY_TURBO_CONTROL ) |
-                                         ( 4 << PID_SIGNAL_BITS_LEFT_SHIFT )],
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::VARIABLE_GEOMETRY_TURBO_CONTROL ) |
+                                            ( 4 << PID_SIGNAL_BITS_LEFT_SHIFT ) ),
                       (double)100 / 255 * 0x40 );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::VARIABLE_GEOMETRY_TURBO_CONTROL ) |
-                                         ( 5 << PID_SIGNAL_BITS_LEFT_SHIFT )],
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::VARIABLE_GEOMETRY_TURBO_CONTROL ) |
+                                            ( 5 << PID_SIGNAL_BITS_LEFT_SHIFT ) ),
                       0x03 );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::VARIABLE_GEOMETRY_TURBO_CONTROL ) |
-                                         ( 6 << PID_SIGNAL_BITS_LEFT_SHIFT )],
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::VARIABLE_GEOMETRY_TURBO_CONTROL ) |
+                                            ( 6 << PID_SIGNAL_BITS_LEFT_SHIFT ) ),
                       0x03 );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::VARIABLE_GEOMETRY_TURBO_CONTROL ) |
-                                         ( 7 << PID_SIGNAL_BITS_LEFT_SHIFT )],
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::VARIABLE_GEOMETRY_TURBO_CONTROL ) |
+                                            ( 7 << PID_SIGNAL_BITS_LEFT_SHIFT ) ),
                       0x00 );
 }
 
@@ -435,52 +453,52 @@ TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedBoostPressureControlAndVariable
     ASSERT_TRUE( decoder.decodeEmissionPIDs( SID::CURRENT_STATS, { 0x70, 0x71 }, txPDUData, info ) );
     ASSERT_EQ( info.mSID, SID::CURRENT_STATS );
     ASSERT_DOUBLE_EQ(
-        info.mPIDsToValues[toUType( EmissionPIDs::BOOST_PRESSURE_CONTROL ) | ( 0 << PID_SIGNAL_BITS_LEFT_SHIFT )],
+        getSignalValue( info, toUType( EmissionPIDs::BOOST_PRESSURE_CONTROL ) | ( 0 << PID_SIGNAL_BITS_LEFT_SHIFT ) ),
         0x3F );
     ASSERT_DOUBLE_EQ(
-        info.mPIDsToValues[toUType( EmissionPIDs::BOOST_PRESSURE_CONTROL ) | ( 1 << PID_SIGNAL_BITS_LEFT_SHIFT )],
+        getSignalValue( info, toUType( EmissionPIDs::BOOST_PRESSURE_CONTROL ) | ( 1 << PID_SIGNAL_BITS_LEFT_SHIFT ) ),
         803.125 );
     ASSERT_DOUBLE_EQ(
-        info.mPIDsToValues[toUType( EmissionPIDs::BOOST_PRESSURE_CONTROL ) | ( 2 << PID_SIGNAL_BITS_LEFT_SHIFT )],
+        getSignalValue( info, toUType( EmissionPIDs::BOOST_PRESSURE_CONTROL ) | ( 2 << PID_SIGNAL_BITS_LEFT_SHIFT ) ),
         803.125 );
     ASSERT_DOUBLE_EQ(
-        info.mPIDsToValues[toUType( EmissionPIDs::BOOST_PRESSURE_CONTROL ) | ( 3 << PID_SIGNAL_BITS_LEFT_SHIFT )],
+        getSignalValue( info, toUType( EmissionPIDs::BOOST_PRESSURE_CONTROL ) | ( 3 << PID_SIGNAL_BITS_LEFT_SHIFT ) ),
         803.125 );
     ASSERT_DOUBLE_EQ(
-        info.mPIDsToValues[toUType( EmissionPIDs::BOOST_PRESSURE_CONTROL ) | ( 4 << PID_SIGNAL_BITS_LEFT_SHIFT )],
+        getSignalValue( info, toUType( EmissionPIDs::BOOST_PRESSURE_CONTROL ) | ( 4 << PID_SIGNAL_BITS_LEFT_SHIFT ) ),
         803.125 );
     ASSERT_DOUBLE_EQ(
-        info.mPIDsToValues[toUType( EmissionPIDs::BOOST_PRESSURE_CONTROL ) | ( 5 << PID_SIGNAL_BITS_LEFT_SHIFT )],
+        getSignalValue( info, toUType( EmissionPIDs::BOOST_PRESSURE_CONTROL ) | ( 5 << PID_SIGNAL_BITS_LEFT_SHIFT ) ),
         0x03 );
     ASSERT_DOUBLE_EQ(
-        info.mPIDsToValues[toUType( EmissionPIDs::BOOST_PRESSURE_CONTROL ) | ( 6 << PID_SIGNAL_BITS_LEFT_SHIFT )],
+        getSignalValue( info, toUType( EmissionPIDs::BOOST_PRESSURE_CONTROL ) | ( 6 << PID_SIGNAL_BITS_LEFT_SHIFT ) ),
         0x03 );
     ASSERT_DOUBLE_EQ(
-        info.mPIDsToValues[toUType( EmissionPIDs::BOOST_PRESSURE_CONTROL ) | ( 7 << PID_SIGNAL_BITS_LEFT_SHIFT )],
+        getSignalValue( info, toUType( EmissionPIDs::BOOST_PRESSURE_CONTROL ) | ( 7 << PID_SIGNAL_BITS_LEFT_SHIFT ) ),
         0x00 );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::VARIABLE_GEOMETRY_TURBO_CONTROL ) |
-                                         ( 0 << PID_SIGNAL_BITS_LEFT_SHIFT )],
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::VARIABLE_GEOMETRY_TURBO_CONTROL ) |
+                                            ( 0 << PID_SIGNAL_BITS_LEFT_SHIFT ) ),
                       0x3F );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::VARIABLE_GEOMETRY_TURBO_CONTROL ) |
-                                         ( 1 << PID_SIGNAL_BITS_LEFT_SHIFT )],
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::VARIABLE_GEOMETRY_TURBO_CONTROL ) |
+                                            ( 1 << PID_SIGNAL_BITS_LEFT_SHIFT ) ),
                       (double)100 / 255 * 0x10 );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::VARIABLE_GEOMETRY_TURBO_CONTROL ) |
-                                         ( 2 << PID_SIGNAL_BITS_LEFT_SHIFT )],
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::VARIABLE_GEOMETRY_TURBO_CONTROL ) |
+                                            ( 2 << PID_SIGNAL_BITS_LEFT_SHIFT ) ),
                       (double)100 / 255 * 0x20 );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::VARIABLE_GEOMETRY_TURBO_CONTROL ) |
-                                         ( 3 << PID_SIGNAL_BITS_LEFT_SHIFT )],
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::VARIABLE_GEOMETRY_TURBO_CONTROL ) |
+                                            ( 3 << PID_SIGNAL_BITS_LEFT_SHIFT ) ),
                       (double)100 / 255 * 0x30 );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::VARIABLE_GEOMETRY_TURBO_CONTROL ) |
-                                         ( 4 << PID_SIGNAL_BITS_LEFT_SHIFT )],
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::VARIABLE_GEOMETRY_TURBO_CONTROL ) |
+                                            ( 4 << PID_SIGNAL_BITS_LEFT_SHIFT ) ),
                       (double)100 / 255 * 0x40 );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::VARIABLE_GEOMETRY_TURBO_CONTROL ) |
-                                         ( 5 << PID_SIGNAL_BITS_LEFT_SHIFT )],
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::VARIABLE_GEOMETRY_TURBO_CONTROL ) |
+                                            ( 5 << PID_SIGNAL_BITS_LEFT_SHIFT ) ),
                       0x03 );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::VARIABLE_GEOMETRY_TURBO_CONTROL ) |
-                                         ( 6 << PID_SIGNAL_BITS_LEFT_SHIFT )],
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::VARIABLE_GEOMETRY_TURBO_CONTROL ) |
+                                            ( 6 << PID_SIGNAL_BITS_LEFT_SHIFT ) ),
                       0x03 );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::VARIABLE_GEOMETRY_TURBO_CONTROL ) |
-                                         ( 7 << PID_SIGNAL_BITS_LEFT_SHIFT )],
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::VARIABLE_GEOMETRY_TURBO_CONTROL ) |
+                                            ( 7 << PID_SIGNAL_BITS_LEFT_SHIFT ) ),
                       0x00 );
 }
 
@@ -493,13 +511,16 @@ TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedEngineRunTime )
     ASSERT_TRUE( decoder.decodeEmissionPIDs( SID::CURRENT_STATS, { 0x7F }, txPDUData, info ) );
     ASSERT_EQ( info.mSID, SID::CURRENT_STATS );
     ASSERT_DOUBLE_EQ(
-        info.mPIDsToValues[toUType( EmissionPIDs::ENGINE_RUN_TIME ) | ( 0 << PID_SIGNAL_BITS_LEFT_SHIFT )], 0x08 );
+        getSignalValue( info, toUType( EmissionPIDs::ENGINE_RUN_TIME ) | ( 0 << PID_SIGNAL_BITS_LEFT_SHIFT ) ), 0x08 );
     ASSERT_DOUBLE_EQ(
-        info.mPIDsToValues[toUType( EmissionPIDs::ENGINE_RUN_TIME ) | ( 1 << PID_SIGNAL_BITS_LEFT_SHIFT )], 16909060 );
+        getSignalValue( info, toUType( EmissionPIDs::ENGINE_RUN_TIME ) | ( 1 << PID_SIGNAL_BITS_LEFT_SHIFT ) ),
+        16909060 );
     ASSERT_DOUBLE_EQ(
-        info.mPIDsToValues[toUType( EmissionPIDs::ENGINE_RUN_TIME ) | ( 2 << PID_SIGNAL_BITS_LEFT_SHIFT )], 16909060 );
+        getSignalValue( info, toUType( EmissionPIDs::ENGINE_RUN_TIME ) | ( 2 << PID_SIGNAL_BITS_LEFT_SHIFT ) ),
+        16909060 );
     ASSERT_DOUBLE_EQ(
-        info.mPIDsToValues[toUType( EmissionPIDs::ENGINE_RUN_TIME ) | ( 3 << PID_SIGNAL_BITS_LEFT_SHIFT )], 16909060 );
+        getSignalValue( info, toUType( EmissionPIDs::ENGINE_RUN_TIME ) | ( 3 << PID_SIGNAL_BITS_LEFT_SHIFT ) ),
+        16909060 );
 }
 
 TEST_F( OBDDataDecoderTest, OBDDataDecoderExhaustGasTemperatureSensor )
@@ -509,20 +530,20 @@ TEST_F( OBDDataDecoderTest, OBDDataDecoderExhaustGasTemperatureSensor )
 
     ASSERT_TRUE( decoder.decodeEmissionPIDs( SID::CURRENT_STATS, { 0x98 }, txPDUData, info ) );
     ASSERT_EQ( info.mSID, SID::CURRENT_STATS );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::EXHAUST_GAS_TEMPERATURE_SENSORA ) |
-                                         ( 0 << PID_SIGNAL_BITS_LEFT_SHIFT )],
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::EXHAUST_GAS_TEMPERATURE_SENSORA ) |
+                                            ( 0 << PID_SIGNAL_BITS_LEFT_SHIFT ) ),
                       0xFF );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::EXHAUST_GAS_TEMPERATURE_SENSORA ) |
-                                         ( 1 << PID_SIGNAL_BITS_LEFT_SHIFT )],
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::EXHAUST_GAS_TEMPERATURE_SENSORA ) |
+                                            ( 1 << PID_SIGNAL_BITS_LEFT_SHIFT ) ),
                       0x1020 * 0.1 - 40 );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::EXHAUST_GAS_TEMPERATURE_SENSORA ) |
-                                         ( 2 << PID_SIGNAL_BITS_LEFT_SHIFT )],
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::EXHAUST_GAS_TEMPERATURE_SENSORA ) |
+                                            ( 2 << PID_SIGNAL_BITS_LEFT_SHIFT ) ),
                       0x3040 * 0.1 - 40 );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::EXHAUST_GAS_TEMPERATURE_SENSORA ) |
-                                         ( 3 << PID_SIGNAL_BITS_LEFT_SHIFT )],
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::EXHAUST_GAS_TEMPERATURE_SENSORA ) |
+                                            ( 3 << PID_SIGNAL_BITS_LEFT_SHIFT ) ),
                       0x5060 * 0.1 - 40 );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::EXHAUST_GAS_TEMPERATURE_SENSORA ) |
-                                         ( 4 << PID_SIGNAL_BITS_LEFT_SHIFT )],
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::EXHAUST_GAS_TEMPERATURE_SENSORA ) |
+                                            ( 4 << PID_SIGNAL_BITS_LEFT_SHIFT ) ),
                       0x7080 * 0.1 - 40 );
 }
 
@@ -534,13 +555,13 @@ TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedTransmissionActualGear )
     ASSERT_TRUE( decoder.decodeEmissionPIDs( SID::CURRENT_STATS, { 0xA4 }, txPDUData, info ) );
     ASSERT_EQ( info.mSID, SID::CURRENT_STATS );
     ASSERT_DOUBLE_EQ(
-        info.mPIDsToValues[toUType( EmissionPIDs::TRANSMISSION_ACTUAL_GEAR ) | ( 0 << PID_SIGNAL_BITS_LEFT_SHIFT )],
+        getSignalValue( info, toUType( EmissionPIDs::TRANSMISSION_ACTUAL_GEAR ) | ( 0 << PID_SIGNAL_BITS_LEFT_SHIFT ) ),
         0xFF );
     ASSERT_DOUBLE_EQ(
-        info.mPIDsToValues[toUType( EmissionPIDs::TRANSMISSION_ACTUAL_GEAR ) | ( 1 << PID_SIGNAL_BITS_LEFT_SHIFT )],
+        getSignalValue( info, toUType( EmissionPIDs::TRANSMISSION_ACTUAL_GEAR ) | ( 1 << PID_SIGNAL_BITS_LEFT_SHIFT ) ),
         0x0F );
     ASSERT_DOUBLE_EQ(
-        info.mPIDsToValues[toUType( EmissionPIDs::TRANSMISSION_ACTUAL_GEAR ) | ( 2 << PID_SIGNAL_BITS_LEFT_SHIFT )],
+        getSignalValue( info, toUType( EmissionPIDs::TRANSMISSION_ACTUAL_GEAR ) | ( 2 << PID_SIGNAL_BITS_LEFT_SHIFT ) ),
         0xAA55 * 0.001 );
 }
 
@@ -551,7 +572,7 @@ TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedOdometer )
 
     ASSERT_TRUE( decoder.decodeEmissionPIDs( SID::CURRENT_STATS, { 0xA6 }, txPDUData, info ) );
     ASSERT_EQ( info.mSID, SID::CURRENT_STATS );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::ODOMETER ) | ( 0 << PID_SIGNAL_BITS_LEFT_SHIFT )],
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::ODOMETER ) | ( 0 << PID_SIGNAL_BITS_LEFT_SHIFT ) ),
                       0x0110AA55 * 0.1 );
 }
 
@@ -563,7 +584,7 @@ TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedFuelPressure )
 
     ASSERT_TRUE( decoder.decodeEmissionPIDs( SID::CURRENT_STATS, { 0x0A }, txPDUData, info ) );
     ASSERT_EQ( info.mSID, SID::CURRENT_STATS );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::FUEL_PRESSURE )], 450 );
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::FUEL_PRESSURE ) ), 450 );
 }
 
 TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedEngineSpeed )
@@ -574,7 +595,7 @@ TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedEngineSpeed )
 
     ASSERT_TRUE( decoder.decodeEmissionPIDs( SID::CURRENT_STATS, { 0x0C }, txPDUData, info ) );
     ASSERT_EQ( info.mSID, SID::CURRENT_STATS );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::ENGINE_SPEED )], ( 256.0 * 0x0A + 0x6B ) / 4 );
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::ENGINE_SPEED ) ), ( 256.0 * 0x0A + 0x6B ) / 4 );
 }
 
 TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedVehicleSpeed )
@@ -585,7 +606,7 @@ TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedVehicleSpeed )
 
     ASSERT_TRUE( decoder.decodeEmissionPIDs( SID::CURRENT_STATS, { 0x0D }, txPDUData, info ) );
     ASSERT_EQ( info.mSID, SID::CURRENT_STATS );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::VEHICLE_SPEED )], 35 );
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::VEHICLE_SPEED ) ), 35 );
 }
 
 TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedMultiplePIDs )
@@ -595,11 +616,11 @@ TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedMultiplePIDs )
 
     ASSERT_TRUE( decoder.decodeEmissionPIDs( SID::CURRENT_STATS, { 0x04, 0x05, 0x0A, 0x0C, 0x0D }, txPDUData, info ) );
     ASSERT_EQ( info.mSID, SID::CURRENT_STATS );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::ENGINE_LOAD )], 60 );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::ENGINE_COOLANT_TEMPERATURE )], 70 );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::FUEL_PRESSURE )], 450 );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::ENGINE_SPEED )], ( 256.0 * 0x0A + 0x6B ) / 4 );
-    ASSERT_DOUBLE_EQ( info.mPIDsToValues[toUType( EmissionPIDs::VEHICLE_SPEED )], 35 );
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::ENGINE_LOAD ) ), 60 );
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::ENGINE_COOLANT_TEMPERATURE ) ), 70 );
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::FUEL_PRESSURE ) ), 450 );
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::ENGINE_SPEED ) ), ( 256.0 * 0x0A + 0x6B ) / 4 );
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::VEHICLE_SPEED ) ), 35 );
 }
 
 TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedMultiplePIDsWrongPDU )
@@ -672,6 +693,40 @@ TEST_F( OBDDataDecoderTest, OBDDataDecoderNoVIN )
     ASSERT_FALSE( decoder.decodeVIN( txPDUData, vin ) );
 }
 
+TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodeDataIdentifier )
+{
+    // DID 0xF40D holds a 2-byte value and a bit field of 3 bits starting at bit 2 of the third byte
+    CANMessageFormat format;
+    format.mMessageID = 0xF40D;
+    format.mSizeInBytes = 3;
+    CANSignalFormat value;
+    value.mSignalID = 0x2000;
+    value.mFirstBitPosition = 0;
+    value.mSizeInBits = 16;
+    value.mFactor = 0.5;
+    value.mOffset = -10;
+    format.mSignals.emplace_back( value );
+    CANSignalFormat bitField;
+    bitField.mSignalID = 0x2001;
+    bitField.mFirstBitPosition = 18;
+    bitField.mSizeInBits = 3;
+    bitField.mFactor = 1.0;
+    format.mSignals.emplace_back( bitField );
+
+    EmissionInfo info;
+    ASSERT_TRUE( decoder.decodeDataIdentifier( 0xF40D, { 0x62, 0xF4, 0x0D, 0x01, 0x00, 0x14 }, format, info ) );
+    ASSERT_EQ( info.mSignals.size(), 2 );
+    ASSERT_DOUBLE_EQ( getSignalValue( info, 0x2000 ), 118.0 );
+    ASSERT_DOUBLE_EQ( getSignalValue( info, 0x2001 ), 5.0 );
+
+    // Response to another DID, negative response and wrong length
+    EmissionInfo rejected;
+    ASSERT_FALSE( decoder.decodeDataIdentifier( 0xF40D, { 0x62, 0xF4, 0x0E, 0x01, 0x00, 0x14 }, format, rejected ) );
+    ASSERT_FALSE( decoder.decodeDataIdentifier( 0xF40D, { 0x7F, 0x22, 0x31 }, format, rejected ) );
+    ASSERT_FALSE( decoder.decodeDataIdentifier( 0xF40D, { 0x62, 0xF4, 0x0D, 0x01, 0x00 }, format, rejected ) );
+    ASSERT_TRUE( rejected.mSignals.empty() );
+}
+
 TEST_F( OBDDataDecoderTest, OBDDataDecoderCorruptFormulaTest )
 {
     PID pid = 0x66;
@@ -686,17 +741,20 @@ TEST_F( OBDDataDecoderTest, OBDDataDecoderCorruptFormulaTest )
     decoderDictPtr->at( pid ).mSignals[0] = originalFormula;
     // corrupt mSizeInBits to out of bound
     decoderDictPtr->at( pid ).mSignals[0].mSizeInBits = 80;
+    decoder.setDecoderDictionary( decoderDictPtr );
     ASSERT_FALSE( decoder.decodeEmissionPIDs( SID::CURRENT_STATS, { pid }, txPDUData, info ) );
 
     decoderDictPtr->at( pid ).mSignals[0] = originalFormula;
     // corrupt mSizeInBits to be invalid
     decoderDictPtr->at( pid ).mSignals[0].mSizeInBits = 33;
+    decoder.setDecoderDictionary( decoderDictPtr );
     ASSERT_FALSE( decoder.decodeEmissionPIDs( SID::CURRENT_STATS, { pid }, txPDUData, info ) );
 
     decoderDictPtr->at( pid ).mSignals[0] = originalFormula;
     // corrupt mFirstBitPosition to be invalid. Because mSizeInBit is 8, First Bit position
     // has to be aligned with byte
     decoderDictPtr->at( pid ).mSignals[0].mFirstBitPosition = 2;
+    decoder.setDecoderDictionary( decoderDictPtr );
     ASSERT_FALSE( decoder.decodeEmissionPIDs( SID::CURRENT_STATS, { pid }, txPDUData, info ) );
 }
 
@@ -709,7 +767,7 @@ TEST_F( OBDDataDecoderTest, OBDDataDecoderWithECUResponseMismatchWithDecoderMani
     std::vector<uint8_t> txPDUData = { 0x41, 107, 0, 108, 0, 109, 0, 13, 102, 12, 252, 110, 0, 111, 0, 112, 0 };
     EmissionInfo info;
     ASSERT_FALSE( decoder.decodeEmissionPIDs( SID::CURRENT_STATS, { 107, 108, 109, 110, 111, 112 }, txPDUData, info ) );
-    ASSERT_EQ( info.mPIDsToValues.size(), 0 );
+    ASSERT_EQ( info.mSignals.size(), 0 );
 }
 
 TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedEngineLoadCorruptDecoderDictionaryTest )
@@ -721,4 +779,29 @@ TEST_F( OBDDataDecoderTest, OBDDataDecoderDecodedEngineLoadCorruptDecoderDiction
     EmissionInfo info;
 
     ASSERT_FALSE( decoder.decodeEmissionPIDs( SID::CURRENT_STATS, { pid }, txPDUData, info ) );
-}
\ No newline at end of file
+}
+
+TEST_F( OBDDataDecoderTest, OBDDataDecoderReusedEmissionInfo )
+{
+    // The PDU is decoded in place from a larger receive buffer
+    std::vector<uint8_t> rxBuffer( 64, 0xFF );
+    const std::vector<uint8_t> response = { 0x41, 0x04, 0x99, 0x05, 0x6E };
+    std::copy( response.begin(), response.end(), rxBuffer.begin() );
+    const std::vector<PID> pids = { 0x04, 0x05 };
+    EmissionInfo info;
+    ASSERT_TRUE( decoder.decodeEmissionPIDs(
+        SID::CURRENT_STATS, pids.data(), pids.size(), rxBuffer.data(), response.size(), info ) );
+    ASSERT_EQ( info.mSignals.size(), 2 );
+    // Signals are appended, and nothing is appended for an invalid response
+    const std::vector<PID> otherPIDs = { 0x04, 0x06 };
+    ASSERT_FALSE( decoder.decodeEmissionPIDs(
+        SID::CURRENT_STATS, otherPIDs.data(), otherPIDs.size(), rxBuffer.data(), response.size(), info ) );
+    ASSERT_EQ( info.mSignals.size(), 2 );
+    info.mSignals.clear();
+    auto capacity = info.mSignals.capacity();
+    ASSERT_TRUE( decoder.decodeEmissionPIDs(
+        SID::CURRENT_STATS, pids.data(), pids.size(), rxBuffer.data(), response.size(), info ) );
+    ASSERT_EQ( info.mSignals.capacity(), capacity );
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::ENGINE_LOAD ) ), 60 );
+    ASSERT_DOUBLE_EQ( getSignalValue( info, toUType( EmissionPIDs::ENGINE_COOLANT_TEMPERATURE ) ), 70 );
+}
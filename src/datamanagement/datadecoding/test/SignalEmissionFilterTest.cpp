@@ -0,0 +1,140 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+
+#include "SignalEmissionFilter.h"
+#include <gtest/gtest.h>
+#include <limits>
+
+using namespace Aws::IoTFleetWise::DataManagement;
+
+static SignalEmissionPolicy
+createPolicy( SignalEmissionPolicyType type, double deadband, uint32_t maxSilenceMs )
+{
+    SignalEmissionPolicy policy;
+    policy.mType = type;
+    policy.mDeadband = deadband;
+    policy.mMaxSilenceMs = maxSilenceMs;
+    return policy;
+}
+
+TEST( SignalEmissionFilterTest, SignalsWithoutPolicyAlwaysPass )
+{
+    SignalEmissionFilter filter;
+    ASSERT_TRUE( filter.isEmpty() );
+    filter.setPolicies( { { 1, createPolicy( SignalEmissionPolicyType::ALWAYS, 0, 0 ) } } );
+    // Policies passing every value are not stored at all
+    ASSERT_TRUE( filter.isEmpty() );
+    filter.setPolicies( { { 1, createPolicy( SignalEmissionPolicyType::ON_CHANGE, 0, 0 ) } } );
+    ASSERT_FALSE( filter.isEmpty() );
+    ASSERT_TRUE( filter.shouldEmit( 2, 5.0, 10 ) );
+    ASSERT_TRUE( filter.shouldEmit( 2, 5.0, 20 ) );
+}
+
+TEST( SignalEmissionFilterTest, OnChange )
+{
+    SignalEmissionFilter filter;
+    filter.setPolicies( { { 1, createPolicy( SignalEmissionPolicyType::ON_CHANGE, 0, 0 ) } } );
+    ASSERT_TRUE( filter.shouldEmit( 1, 5.0, 10 ) );
+    ASSERT_FALSE( filter.shouldEmit( 1, 5.0, 20 ) );
+    ASSERT_FALSE( filter.shouldEmit( 1, 5.0, 100000 ) );
+    ASSERT_TRUE( filter.shouldEmit( 1, 6.0, 100010 ) );
+    ASSERT_TRUE( filter.shouldEmit( 1, 5.0, 100020 ) );
+    ASSERT_TRUE( filter.shouldEmit( 1, std::numeric_limits<double>::quiet_NaN(), 100030 ) );
+}
+
+TEST( SignalEmissionFilterTest, AbsoluteDeadband )
+{
+    SignalEmissionFilter filter;
+    filter.setPolicies( { { 1, createPolicy( SignalEmissionPolicyType::ABSOLUTE_DEADBAND, 1.0, 0 ) } } );
+    ASSERT_TRUE( filter.shouldEmit( 1, 10.0, 10 ) );
+    ASSERT_FALSE( filter.shouldEmit( 1, 10.5, 20 ) );
+    ASSERT_FALSE( filter.shouldEmit( 1, 9.0, 30 ) );
+    // Compared against the last passed on value, so a slow drift passes eventually
+    ASSERT_TRUE( filter.shouldEmit( 1, 11.5, 40 ) );
+    ASSERT_FALSE( filter.shouldEmit( 1, 11.0, 50 ) );
+    ASSERT_TRUE( filter.shouldEmit( 1, 10.0, 60 ) );
+}
+
+TEST( SignalEmissionFilterTest, RelativeDeadband )
+{
+    SignalEmissionFilter filter;
+    filter.setPolicies( { { 1, createPolicy( SignalEmissionPolicyType::RELATIVE_DEADBAND, 0.1, 0 ) } } );
+    ASSERT_TRUE( filter.shouldEmit( 1, 100.0, 10 ) );
+    ASSERT_FALSE( filter.shouldEmit( 1, 109.0, 20 ) );
+    ASSERT_FALSE( filter.shouldEmit( 1, 91.0, 30 ) );
+    ASSERT_TRUE( filter.shouldEmit( 1, 89.0, 40 ) );
+    ASSERT_TRUE( filter.shouldEmit( 1, -1.0, 50 ) );
+    ASSERT_FALSE( filter.shouldEmit( 1, -1.05, 60 ) );
+}
+
+TEST( SignalEmissionFilterTest, MaxSilenceHeartbeat )
+{
+    SignalEmissionFilter filter;
+    filter.setPolicies( { { 1, createPolicy( SignalEmissionPolicyType::ON_CHANGE, 0, 1000 ) } } );
+    ASSERT_TRUE( filter.shouldEmit( 1, 5.0, 10 ) );
+    ASSERT_FALSE( filter.shouldEmit( 1, 5.0, 1009 ) );
+    ASSERT_TRUE( filter.shouldEmit( 1, 5.0, 1010 ) );
+    ASSERT_FALSE( filter.shouldEmit( 1, 5.0, 2000 ) );
+    ASSERT_TRUE( filter.shouldEmit( 1, 5.0, 2010 ) );
+    // A time jump backwards does not trigger the heartbeat
+    ASSERT_FALSE( filter.shouldEmit( 1, 5.0, 5 ) );
+}
+
+TEST( SignalEmissionFilterTest, NewPoliciesForgetPassedOnValues )
+{
+    SignalEmissionFilter filter;
+    auto policy = createPolicy( SignalEmissionPolicyType::ON_CHANGE, 0, 0 );
+    filter.setPolicies( { { 1, policy }, { 2, policy } } );
+    ASSERT_TRUE( filter.shouldEmit( 1, 5.0, 10 ) );
+    ASSERT_TRUE( filter.shouldEmit( 2, 5.0, 10 ) );
+    ASSERT_FALSE( filter.shouldEmit( 1, 5.0, 20 ) );
+    ASSERT_FALSE( filter.shouldEmit( 2, 5.0, 20 ) );
+    filter.setPolicies( { { 1, policy } } );
+    ASSERT_TRUE( filter.shouldEmit( 1, 5.0, 30 ) );
+    ASSERT_TRUE( filter.shouldEmit( 2, 5.0, 30 ) );
+    ASSERT_TRUE( filter.shouldEmit( 2, 5.0, 40 ) );
+}
+
+TEST( SignalEmissionFilterTest, MinimumSampleInterval )
+{
+    SignalEmissionFilter filter;
+    filter.setPolicies( {}, { { 1, 100 }, { 2, 0 } } );
+    ASSERT_FALSE( filter.isEmpty() );
+    ASSERT_TRUE( filter.shouldEmit( 1, 5.0, 1000 ) );
+    ASSERT_FALSE( filter.shouldEmit( 1, 6.0, 1050 ) );
+    ASSERT_FALSE( filter.shouldEmit( 1, 7.0, 1099, 999 ) );
+    ASSERT_TRUE( filter.shouldEmit( 1, 8.0, 1100 ) );
+    // The interval is measured from the last passed on sample, with microsecond resolution
+    ASSERT_FALSE( filter.shouldEmit( 1, 9.0, 1199, 500 ) );
+    ASSERT_TRUE( filter.shouldEmit( 1, 9.0, 1200, 1 ) );
+    ASSERT_FALSE( filter.shouldEmit( 1, 9.0, 1300 ) );
+    ASSERT_TRUE( filter.shouldEmit( 1, 9.0, 1300, 1 ) );
+    // An interval of 0 does not limit the signal
+    ASSERT_TRUE( filter.shouldEmit( 2, 1.0, 1000 ) );
+    ASSERT_TRUE( filter.shouldEmit( 2, 1.0, 1000 ) );
+}
+
+TEST( SignalEmissionFilterTest, MinimumSampleIntervalAfterPolicy )
+{
+    SignalEmissionFilter filter;
+    filter.setPolicies( { { 1, createPolicy( SignalEmissionPolicyType::ON_CHANGE, 0, 0 ) } }, { { 1, 100 } } );
+    ASSERT_TRUE( filter.shouldEmit( 1, 5.0, 1000 ) );
+    // Unchanged values do not restart the interval
+    ASSERT_FALSE( filter.shouldEmit( 1, 5.0, 1100 ) );
+    ASSERT_TRUE( filter.shouldEmit( 1, 6.0, 1150 ) );
+    // A changed value within the interval is still the last value passed on by the policy, as for the inspection
+    ASSERT_FALSE( filter.shouldEmit( 1, 7.0, 1200 ) );
+    ASSERT_FALSE( filter.shouldEmit( 1, 7.0, 1300 ) );
+    ASSERT_TRUE( filter.shouldEmit( 1, 8.0, 1300 ) );
+}
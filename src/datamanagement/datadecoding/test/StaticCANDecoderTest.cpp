@@ -0,0 +1,167 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "StaticCANDecoder.h"
+#include "CANDecoder.h"
+#include "CANDecoderMethodLookup.h"
+#include <algorithm>
+#include <gtest/gtest.h>
+
+using namespace Aws::IoTFleetWise::DataManagement;
+
+namespace
+{
+
+// Same as generate-static-can-decoders.py emits for these signals
+constexpr StaticCANSignalInfo SIGNALS_0x123[] = {
+    { 1U, 0, 16, false, true, 0.1, -40.0 },
+    { 2U, 23, 12, true, false, 1.0, 0.0 },
+    { 3U, 60, 4, false, false, 1.0, 0.0 },
+    { 4U, 39, 32, true, true, 0.5, 10.0 },
+};
+
+bool
+decode0x123( const uint8_t *frameData, size_t frameSize, double *physicalValues )
+{
+    using S0 = StaticCANSignal<0, 16, false, true, 8>;
+    using S1 = StaticCANSignal<23, 12, true, false, 8>;
+    using S2 = StaticCANSignal<60, 4, false, false, 8>;
+    using S3 = StaticCANSignal<39, 32, true, true, 8>;
+    constexpr uint32_t MIN_FRAME_SIZE =
+        std::max( { S0::MIN_FRAME_SIZE, S1::MIN_FRAME_SIZE, S2::MIN_FRAME_SIZE, S3::MIN_FRAME_SIZE } );
+    if ( frameSize < MIN_FRAME_SIZE )
+    {
+        return false;
+    }
+    physicalValues[0] = static_cast<double>( S0::extract( frameData, frameSize ) ) * 0.1 + -40.0;
+    physicalValues[1] = static_cast<double>( S1::extract( frameData, frameSize ) ) * 1.0 + 0.0;
+    physicalValues[2] = static_cast<double>( S2::extract( frameData, frameSize ) ) * 1.0 + 0.0;
+    physicalValues[3] = static_cast<double>( S3::extract( frameData, frameSize ) ) * 0.5 + 10.0;
+    return true;
+}
+
+constexpr StaticCANMessageDecoder STATIC_DECODERS[] = {
+    { 0x123U, 8, SIGNALS_0x123, 4, &decode0x123 },
+};
+
+CANMessageFormat
+createFormat()
+{
+    CANMessageFormat format;
+    format.mMessageID = 0x123;
+    format.mSizeInBytes = 8;
+    // In another order than the static decoder
+    for ( auto i : { 3, 1, 0, 2 } )
+    {
+        const auto &info = SIGNALS_0x123[i];
+        CANSignalFormat signal;
+        signal.mSignalID = info.mSignalID;
+        signal.mSignalIndex = static_cast<ManifestSignalIndex>( 100 + i );
+        signal.mFirstBitPosition = info.mFirstBitPosition;
+        signal.mSizeInBits = info.mSizeInBits;
+        signal.mIsBigEndian = info.mIsBigEndian;
+        signal.mIsSigned = info.mIsSigned;
+        signal.mFactor = info.mFactor;
+        signal.mOffset = info.mOffset;
+        format.mSignals.push_back( signal );
+    }
+    return format;
+}
+
+} // namespace
+
+/**
+ * @brief Validates that the values computed at compile time decode the same as the generic decoder
+ */
+TEST( StaticCANDecoderTest, DecodesLikeGenericDecoder )
+{
+    auto format = createFormat();
+    std::unordered_set<SignalID> allSignals = { 1, 2, 3, 4 };
+    auto plan = CANDecoder::compileDecodePlan( format, allSignals );
+    CANDecoder decoder;
+    std::vector<std::vector<uint8_t>> frames = {
+        { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+        { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF },
+        { 0x12, 0x34, 0x56, 0x78, 0x9A, 0xBC, 0xDE, 0xF0 },
+        { 0x01, 0x80, 0x7F, 0x00, 0x80, 0xFE, 0x55, 0xAA },
+    };
+    for ( const auto &frame : frames )
+    {
+        CANDecodedMessage decodedMessage;
+        ASSERT_TRUE( decoder.decodeCANMessage( frame.data(), frame.size(), plan, decodedMessage ) );
+        double values[4];
+        ASSERT_TRUE( STATIC_DECODERS[0].mDecode( frame.data(), frame.size(), values ) );
+        ASSERT_EQ( decodedMessage.mFrameInfo.mSignals.size(), 4U );
+        for ( const auto &signal : decodedMessage.mFrameInfo.mSignals )
+        {
+            size_t index = 4;
+            for ( const auto &formatSignal : format.mSignals )
+            {
+                if ( formatSignal.mSignalID == signal.mSignalID )
+                {
+                    index = STATIC_DECODERS[0].findSignal( formatSignal );
+                }
+            }
+            ASSERT_LT( index, 4U );
+            ASSERT_DOUBLE_EQ( values[index], signal.mPhysicalValue ) << signal.mSignalID;
+        }
+    }
+
+    // A frame too short for the signals is left to the generic decoder
+    std::vector<uint8_t> shortFrame = { 0x01, 0x02, 0x03 };
+    double values[4];
+    ASSERT_FALSE( STATIC_DECODERS[0].mDecode( shortFrame.data(), shortFrame.size(), values ) );
+}
+
+/**
+ * @brief Validates that a static decoder is only used if it was generated from the active format
+ */
+TEST( StaticCANDecoderTest, RegisteredOnlyIfFormatMatches )
+{
+    auto dictionary = std::make_shared<CANDecoderDictionary>();
+    dictionary->signalIDsToCollect = { 1, 4 };
+    auto &decoderMethod = dictionary->canMessageDecoderMethod[0][0x123];
+    decoderMethod.collectType = CANMessageCollectType::DECODE;
+    decoderMethod.format = createFormat();
+
+    CANDecoderMethodLookup lookup( dictionary, 0 );
+    ASSERT_EQ( lookup.findStatic( 0x123 ), nullptr );
+    ASSERT_EQ( lookup.registerStaticDecoders( STATIC_DECODERS, 1 ), 1U );
+    const auto *plan = lookup.findStatic( 0x123 );
+    ASSERT_NE( plan, nullptr );
+    ASSERT_EQ( plan->mDecoder, &STATIC_DECODERS[0] );
+    // Only the collected signals, in the order of the format
+    ASSERT_EQ( plan->mSignals.size(), 2U );
+    ASSERT_EQ( plan->mSignals[0].mSignalID, 4U );
+    ASSERT_EQ( plan->mSignals[0].mValueIndex, 3U );
+    ASSERT_EQ( plan->mSignals[0].mSignalIndex, 103U );
+    ASSERT_EQ( plan->mSignals[1].mSignalID, 1U );
+    ASSERT_EQ( plan->mSignals[1].mValueIndex, 0U );
+    ASSERT_EQ( lookup.findStatic( 0x124 ), nullptr );
+
+    // Another factor in the active manifest
+    auto changedDictionary = std::make_shared<CANDecoderDictionary>( *dictionary );
+    changedDictionary->canMessageDecoderMethod[0][0x123].format.mSignals[0].mFactor = 1.0;
+    CANDecoderMethodLookup changedLookup( changedDictionary, 0 );
+    ASSERT_EQ( changedLookup.registerStaticDecoders( STATIC_DECODERS, 1 ), 0U );
+    ASSERT_EQ( changedLookup.findStatic( 0x123 ), nullptr );
+
+    // An additional signal in the active manifest
+    auto extendedDictionary = std::make_shared<CANDecoderDictionary>( *dictionary );
+    CANSignalFormat extraSignal;
+    extraSignal.mSignalID = 5;
+    extraSignal.mSizeInBits = 1;
+    extendedDictionary->canMessageDecoderMethod[0][0x123].format.mSignals.push_back( extraSignal );
+    CANDecoderMethodLookup extendedLookup( extendedDictionary, 0 );
+    ASSERT_EQ( extendedLookup.registerStaticDecoders( STATIC_DECODERS, 1 ), 0U );
+}
@@ -16,12 +16,21 @@
 // Includes
 
 #include "CANDecoder.h"
+#include "CANDecoderMethodLookup.h"
 #include "ClockHandler.h"
+#include "IInspectionInput.h"
 #include "IVehicleDataConsumer.h"
+#include "InstrumentedMutex.h"
 #include "LoggingModule.h"
+#include "LowActivityMode.h"
+#include "MemoryAccounting.h"
+#include "PipelineLoadController.h"
+#include "SignalEmissionFilter.h"
 #include "Signal.h"
 #include "Thread.h"
 #include "Timer.h"
+#include "VersionedSharedPtr.h"
+#include <array>
 #include <iostream>
 
 namespace Aws
@@ -33,11 +42,15 @@ namespace DataInspection
 using namespace Aws::IoTFleetWise::Platform::Linux;
 /**
  * @brief CAN Network Data Consumer impl, outputs data to an in-memory buffer.
- *        Operates in Polling mode.
+ *        Operates in Polling mode. With a direct output the frames are decoded by the thread driving the run to
+ *        completion pipeline and handed to the inspection without the buffers.
  */
 class CANDataConsumer : public IVehicleDataConsumer
 {
 public:
+    // Maximum number of directly following frames with the same CAN ID that are decoded together
+    static constexpr size_t MAX_DECODE_BATCH_SIZE = 64;
+
     CANDataConsumer() = default;
     ~CANDataConsumer() override;
 
@@ -58,17 +71,67 @@ public:
 
     void suspendDataConsumption() override;
 
+    std::shared_ptr<Platform::Linux::Signal>
+    getDataAvailableSignal() override
+    {
+        return mWait;
+    }
+
+    /**
+     * @brief Lets the worker thread spin and yield before it blocks when the input buffer is empty.
+     * Can also be changed while the thread runs.
+     * @param spinCount number of busy polls before yielding, 0 to not spin
+     * @param yieldCount number of polls with a CPU yield in between before blocking, 0 to not yield
+     */
+    inline void
+    setWaitStrategy( uint32_t spinCount, uint32_t yieldCount )
+    {
+        mWait->setWaitStrategy( spinCount, yieldCount );
+    }
+
+    /**
+     * @brief Sheds low priority signals and raw CAN frames according to the level of the controller.
+     * Must be called before connect.
+     * @param loadController controller of the whole pipeline, nullptr to never shed
+     */
+    inline void
+    setLoadController( std::shared_ptr<const PipelineLoadController> loadController )
+    {
+        mLoadController = std::move( loadController );
+    }
+
     /**
      * @brief This setter is specific to CAN Bus data consumers and captures the raw
-     * CAN Frames if wanted.
+     * CAN Frames if wanted. The consumer registers an own producer ring in the buffer.
      * @param canBufferPtr- RAW CAN Buffer
      */
     inline void
     setCANBufferPtr( CANBufferPtr canBufferPtr )
     {
-        mCANBufferPtr = canBufferPtr;
+        mCANBufferPtr = std::move( canBufferPtr );
+        mCANProducer = ( mCANBufferPtr != nullptr ) ? mCANBufferPtr->addProducer() : nullptr;
+    }
+
+    /**
+     * @brief Hands the decoded signals and raw CAN frames directly to the inspection instead of the Signal Buffer and
+     * the CAN Buffer. No own thread is started then, the frames are decoded by the thread calling consumeFrames.
+     * Must be called before connect.
+     * @param inspection input of the inspection, only called by the thread calling consumeFrames
+     */
+    inline void
+    setDirectOutput( IInspectionInput *inspection )
+    {
+        mDirectOutput = inspection;
     }
 
+    /**
+     * @brief Decodes the frames of the input buffer on the thread of the caller if a direct output is set, see
+     * setDirectOutput. Must always be called by the same thread.
+     * @param maxFrames the decoding stops after this number of frames
+     * @return false if frames are left in the input buffer
+     */
+    bool consumeFrames( size_t maxFrames );
+
     /**
      * @brief Handle of the CAN Raw Output Buffer. This buffer shared between Collection Engine
      * and Vehicle Data CAN Consumer.
@@ -95,19 +158,96 @@ private:
 
     bool switchCollectionSchemeIfNeeded();
 
+    // Picks up a new decoder dictionary between two frames
+    void refreshDecoderDictionary();
+
+    // Decodes the next frame of the input buffer and the directly following frames with the same CAN ID, returns the
+    // number of decoded frames, 0 if the input buffer is empty
+    size_t decodeNextFrame();
+
+    // Adds a decoded signal to the signals of the current frame, unless it is filtered
+    void pushCollectedSignal( const CollectedSignal &collectedSignal );
+
+    // Pushes the raw frames of the current burst to the CAN buffer and the signals not attached to a raw frame to
+    // the signal buffer in one push
+    void flushCollectedSignals();
+
+    // Keeps a raw frame in mPendingRawFrames until the flush
+    void addRawFrame( const VehicleDataMessage &frame );
+
+    // Decodes a frame with a static decoder and pushes the collected signals, returns false if the frame is too
+    // short for the static decoder
+    bool decodeStatic( const StaticCANDecodePlan &plan, const VehicleDataMessage &frame );
+
+    // Starts a LatencyTracer trace if the frame is sampled and marks it decoded, returns the trace ID or 0
+    static uint32_t traceDecodedFrame( const VehicleDataMessage &frame );
+
+    // Collects the signals of the dictionary that are shed at LoadSheddingLevel::LOW_PRIORITY_SIGNALS
+    void updateSheddableSignals( const CANDecoderDictionary &dictionary );
+
+    // Returns true if a raw CAN frame is dropped by the load shedding
+    bool shedRawFrame();
+
     Thread mThread;
     std::atomic<bool> mShouldStop{ false };
     std::atomic<bool> mShouldSleep{ false };
     mutable std::mutex mThreadMutex;
     LoggingModule mLogger;
     std::shared_ptr<const Clock> mClock = ClockHandler::getClock();
-    std::mutex mDecoderDictMutex;
+    InstrumentedMutex mDecoderDictMutex{ "CANDecoderDict" };
+    // Decoder methods of this channel from the active dictionary, the worker thread checks for a new version
+    // before every frame
+    VersionedSharedPtr<const CANDecoderMethodLookup> mDecoderMethodLookup;
+    // Lookup the frames are decoded with, only used by the decoding thread
+    std::shared_ptr<const CANDecoderMethodLookup> mActiveDecoderMethodLookup;
+    uint64_t mActiveDecoderMethodLookupVersion{ 0 };
+    // Only used for TRACE log level logging, .first=can id, .second=counter
+    std::array<std::pair<uint32_t, uint32_t>, 8> mLastFrameIds{};
+    uint8_t mLastFrameIdPos{ 0 };
+    uint32_t mProcessedFramesCounter{ 0 };
     std::unique_ptr<CANDecoder> mCANDecoder;
-    Platform::Linux::Signal mWait;
+    // Also notified by the data source after pushing to the input buffer
+    std::shared_ptr<Platform::Linux::Signal> mWait{ std::make_shared<Platform::Linux::Signal>() };
+    // Emission policies and minimum sample intervals of the active dictionary, only used by the worker thread
+    SignalEmissionFilter mEmissionFilter;
+    uint64_t mEmissionDroppedSignals{ 0 };
+    std::shared_ptr<const PipelineLoadController> mLoadController;
+    // Read from mLoadController once per frame, the sets and counters are only used by the worker thread
+    LoadSheddingLevel mLoadSheddingLevel{ LoadSheddingLevel::NONE };
+    std::unordered_set<SignalID> mSheddableSignals;
+    uint64_t mShedSignals{ 0 };
+    uint64_t mShedRawFrames{ 0 };
+    uint32_t mRawFramesSinceKept{ 0 };
+    // Set by flushCollectedSignals, only used by the worker thread
+    bool mPushedSignals{ false };
+    // Signals of the current frame not pushed to the signal buffer yet, only used by the worker thread
+    std::vector<CollectedSignal, TrackedAllocator<CollectedSignal, MemorySubsystem::DECODING>> mPendingSignals;
+    // Raw frames of the current burst not pushed to the CAN buffer yet, only used by the worker thread
+    std::vector<CollectedCanFrameWithSignals> mPendingRawFrames;
+    // Index in mPendingRawFrames per frame of the burst the decoded signals are attached to, NO_RAW_FRAME to push
+    // the signals to the signal buffer
+    static constexpr size_t NO_RAW_FRAME = SIZE_MAX;
+    std::vector<size_t> mBatchRawFrames;
+    // Raw frame the signals passed to pushCollectedSignal are attached to, NO_RAW_FRAME if none
+    size_t mSignalsRawFrame{ NO_RAW_FRAME };
+    // Signal that switches the LowActivityMode on ignition on and off, read when the thread starts
+    uint32_t mIgnitionSignalId{ LowActivityMode::INVALID_IGNITION_SIGNAL_ID };
     uint32_t mIdleTime{ DEFAULT_THREAD_IDLE_TIME_MS };
     static constexpr uint32_t DEFAULT_THREAD_IDLE_TIME_MS = 1000;
     // Raw CAN Frame Buffer shared pointer
     CANBufferPtr mCANBufferPtr;
+    // Rings of this consumer in the Signal and the Raw CAN Frame Buffer, only pushed to by the worker thread
+    SignalBufferProducerPtr mSignalProducer;
+    CANBufferProducerPtr mCANProducer;
+    // Set in the run to completion mode instead of pushing to the rings
+    IInspectionInput *mDirectOutput{ nullptr };
+    std::atomic<bool> mDirectConnected{ false };
+    // Frames of the current burst of one CAN ID, only used by the worker thread
+    std::vector<VehicleDataMessage> mMessageBatch;
+    std::vector<const uint8_t *> mFrameDataBatch;
+    std::vector<CANDecodedSignalColumn> mDecodedColumns;
+    // Values decoded by a static decoder, only used by the worker thread
+    std::vector<double> mStaticDecodedValues;
 };
 } // namespace DataInspection
 } // namespace IoTFleetWise
@@ -13,16 +13,31 @@
 
 #pragma once
 
+#include "ConditionBitset.h"
+#ifdef FWE_FEATURE_CONDITION_JIT
+#include "ConditionJit.h"
+#endif // FWE_FEATURE_CONDITION_JIT
 #include "DataReduction.h"
+#include "CompressedSampleHistory.h"
+#include "DeepHistoryFile.h"
+#include "DeviceJitter.h"
+#include "FootprintProfile.h"
+#include "GeofenceFunctionNode.h"
 #include "GeohashFunctionNode.h"
 #include "IActiveConditionProcessor.h"
 #include "InspectionEventListener.h"
 #include "Listener.h"
 #include "LoggingModule.h"
+#include "MemoryArena.h"
+#include "MessageTypes.h"
+#include "SignalAggregation.h"
+#include "TriggeredCollectionSchemeDataPool.h"
+#include <deque>
 #include <limits>
+#include <map>
+#include <memory>
+#include <string>
 #include <unordered_map>
-// As _Find_first() is not part of C++ standard and compiler specific other structure could be considered
-#include <bitset>
 
 namespace Aws
 {
@@ -54,6 +69,15 @@ public:
      */
     CollectionInspectionEngine( bool sendDataOnlyOncePerCondition = true );
 
+    /**
+     * @brief Activates a new inspection matrix
+     *
+     * Signal and CAN frame buffers that the new matrix uses with the same sample interval keep their history and
+     * window state, and are only reallocated if their size changes. Buffers the new matrix does not use anymore
+     * are freed. Conditions of the same collection scheme keep their trigger and consumed state.
+     *
+     * @param activeInspectionMatrix the new matrix
+     */
     void onChangeInspectionMatrix( const std::shared_ptr<const InspectionMatrix> &activeInspectionMatrix ) override;
 
     /**
@@ -62,17 +86,33 @@ public:
      * This needs to be called directly after new signals are added to the CollectionEngine.
      * If multiple samples of the same signal are added to CollectionEngine without calling
      * this function data can get lost and triggers can get missed.
+     * Periodic conditions, see isPeriodicCondition, are not evaluated but triggered when the tick of their
+     * period is due.
      * @return at least one condition is true
      *
      */
     bool evaluateConditions( InspectionTimestamp currentTime );
 
+    /**
+     * @brief Returns when evaluateConditions has work to do the next time without new input
+     *
+     * These are conditions whose input changed, at the earliest when their minimum publish interval is over,
+     * conditions that trigger repeatedly while true once their minimum publish interval is over, the next tick of
+     * a period with a periodic condition that is not waiting for its data to be collected, and the next
+     * timeout of a window function. Conditions that trigger repeatedly without minimum publish interval are not
+     * included, they are evaluated again with the next input.
+     * @param currentTime returned if a condition is to be evaluated already
+     * @return the time of the next evaluation or the maximum timestamp if there is nothing to evaluate
+     */
+    InspectionTimestamp getNextEvaluationTime( InspectionTimestamp currentTime ) const;
+
     /**
      * @brief Copy for a triggered condition data out of the signal buffer
      *
      * It will copy the data the next triggered condition wants to publish out of
      * the signal history buffer.
-     * It will allocate new memory for the data and return a shared ptr to it.
+     * The data is stored in an object taken from a pool sized from the inspection matrix, which gets the
+     * object back once the last shared ptr to it is released.
      * This data can then be passed on to be serialized and sent to the cloud.
      * Should be called after dataReadyToBeSent() true an shortly after adding new signals
      *
@@ -95,8 +135,27 @@ public:
      * @param id id of the obd based or can based signal
      * @param receiveTime timestamp at which time was the signal seen on the physical bus
      * @param value the signal value as double
+     * @param receiveTimeFractionUs microseconds within the millisecond of receiveTime, used for the minimum
+     * sample interval and passed on with the collected data
+     * @param manifestSignalIndex index of the signal in the Decoder Manifest if the source knows it. The signal is
+     * then found with a flat table, otherwise by its id.
      */
-    void addNewSignal( InspectionSignalID id, InspectionTimestamp receiveTime, InspectionValue value );
+    void addNewSignal( InspectionSignalID id,
+                       InspectionTimestamp receiveTime,
+                       InspectionValue value,
+                       TimestampFractionUs receiveTimeFractionUs = 0,
+                       ManifestSignalIndex manifestSignalIndex = INVALID_MANIFEST_SIGNAL_INDEX );
+
+    /**
+     * @brief Remembers the LatencyTracer trace of a signal given to addNewSignal, so that the trace is passed on
+     * with the next data collected with the signal
+     *
+     * Only a few traces are kept, older ones are dropped if the signals are not collected.
+     *
+     * @param id id of the signal
+     * @param traceId trace ID from the CollectedSignal, must not be 0
+     */
+    void addTracedSignal( InspectionSignalID id, uint32_t traceId );
 
     /**
      * @brief Add new raw CAN Frame history buffer. If frame is not needed call will be just ignored
@@ -108,14 +167,33 @@ public:
      * @param channelID the internal channel id on which the can frame was seen
      * @param receiveTime timestamp at which time was the can frame was seen on the physical bus
      * @param buffer raw byte buffer to the can frame
-     * @param size size of the buffer in number of bytes
+     * @param size size of the buffer in number of bytes, up to MAX_CANFD_FRAME_BYTE_SIZE for CAN FD frames
+     * @param receiveTimeFractionUs microseconds within the millisecond of receiveTime
      *
      */
     void addNewRawCanFrame( CANRawFrameID canID,
                             CANChannelNumericID channelID,
                             InspectionTimestamp receiveTime,
-                            std::array<uint8_t, MAX_CAN_FRAME_BYTE_SIZE> &buffer,
-                            uint8_t size );
+                            const uint8_t *buffer,
+                            uint8_t size,
+                            TimestampFractionUs receiveTimeFractionUs = 0 );
+
+    template <size_t N>
+    void
+    addNewRawCanFrame( CANRawFrameID canID,
+                       CANChannelNumericID channelID,
+                       InspectionTimestamp receiveTime,
+                       const std::array<uint8_t, N> &buffer,
+                       uint8_t size,
+                       TimestampFractionUs receiveTimeFractionUs = 0 )
+    {
+        addNewRawCanFrame( canID,
+                           channelID,
+                           receiveTime,
+                           buffer.data(),
+                           std::min( size, static_cast<uint8_t>( N ) ),
+                           receiveTimeFractionUs );
+    }
 
     /**
      * @brief Copies the data reduction object over and applies it before handing out data
@@ -129,59 +207,278 @@ public:
         mDataReduction.setDisableProbability( disableProbability );
     };
 
+    /**
+     * @brief Lets collected data reference the samples of the signal history buffers in
+     * TriggeredCollectionSchemeData::signalSnapshots instead of copying them to TriggeredCollectionSchemeData::signals
+     * @param enabled true to collect snapshots
+     */
+    void
+    setSignalSnapshotsEnabled( bool enabled )
+    {
+        mSignalSnapshotsEnabled = enabled;
+    }
+
+    /**
+     * @brief Lets collectNextDataToSend merge the data of all conditions that are due at the same time and have the
+     * same payload parameters into the data of the first one. Samples collected by several of them are only
+     * contained once, the further events are listed in TriggeredCollectionSchemeData::sharedEvents.
+     * @param enabled true to share payloads
+     */
+    void
+    setSharedPayloadsEnabled( bool enabled )
+    {
+        mSharedPayloadsEnabled = enabled;
+    }
+
+    /**
+     * @brief Delays the first tick of each period of the periodic conditions by the offset of the device, so that the
+     * periodic collections of a fleet started at the same time are spread over the period. The following ticks keep
+     * the phase.
+     * @param jitter offsets of this device
+     */
+    void
+    setDeviceJitter( const DeviceJitter &jitter )
+    {
+        mDeviceJitter = jitter;
+    }
+
+    /**
+     * @brief Lets conditions with an afterDuration collect their samples while the duration passes instead of all at
+     * once when it has passed. At the trigger the samples in the buffers are collected, every sample arriving until
+     * the deadline is appended to the same data. So the sample buffer size only has to cover the samples before the
+     * trigger, and the collection does not cause a burst of copies at the deadline.
+     * @param enabled true to stream the samples after the trigger
+     */
+    void
+    setStreamingCollectionEnabled( bool enabled )
+    {
+        mStreamingCollectionEnabled = enabled;
+    }
+
+    /**
+     * @brief Cost of one condition since the last call of takeHotConditions
+     */
+    struct ConditionProfile
+    {
+        std::string collectionSchemeID;
+        uint64_t evaluations{ 0 };
+        uint64_t sampledEvaluations{ 0 }; /**< evaluations whose time was measured */
+        uint64_t sampledEvaluationTimeNs{ 0 };
+        uint64_t triggers{ 0 };
+        uint64_t collectedBytes{ 0 }; /**< memory of the collected samples */
+        uint64_t collectTimeNs{ 0 };
+
+        /**
+         * @brief Returns the time of all evaluations, extrapolated from the sampled ones, plus the collection time
+         */
+        uint64_t
+        getEstimatedCostNs() const
+        {
+            auto evaluationTimeNs =
+                ( sampledEvaluations == 0 ) ? 0 : ( ( sampledEvaluationTimeNs * evaluations ) / sampledEvaluations );
+            return evaluationTimeNs + collectTimeNs;
+        }
+    };
+
+    // Every n-th evaluation of a condition is timed if condition profiling is enabled
+    static constexpr uint32_t CONDITION_PROFILING_SAMPLING_INTERVAL = 16;
+
+    /**
+     * @brief Returns for how many evaluation passes a condition is deferred after an evaluation, so that on average
+     * the condition stays within its CPU budget per evaluation pass
+     * @param evaluationTimeNs time the evaluation took
+     * @param budgetUs CPU budget of the condition per evaluation pass, 0 for no budget
+     * @return 0 if the evaluation was within the budget
+     */
+    static uint64_t
+    getDeferredEvaluationPasses( uint64_t evaluationTimeNs, uint32_t budgetUs )
+    {
+        return ( budgetUs == 0 ) ? 0 : ( evaluationTimeNs / ( static_cast<uint64_t>( budgetUs ) * 1000U ) );
+    }
+
+    /**
+     * @brief Counts evaluations, triggers and collected data of every condition and times a sample of the
+     * evaluations and every collection, see takeHotConditions
+     * @param enabled true to profile the conditions
+     */
+    void
+    setConditionProfilingEnabled( bool enabled )
+    {
+        mConditionProfilingEnabled = enabled;
+    }
+
+#ifdef FWE_FEATURE_CONDITION_JIT
+    /**
+     * @brief Evaluates the conditions with their native code instead of interpreting their programs. Enabled by
+     * default, the native code is generated by onChangeInspectionMatrix in any case.
+     * @param enabled false to interpret all conditions
+     */
+    void
+    setNativeConditionsEnabled( bool enabled )
+    {
+        mNativeConditionsEnabled = enabled;
+    }
+
+    /**
+     * @brief Returns the number of conditions of the active inspection matrix compiled to native code
+     */
+    size_t getNativeConditionCount() const;
+#endif // FWE_FEATURE_CONDITION_JIT
+
+    /**
+     * @brief Returns the most expensive conditions since the last call and resets the counters of all conditions
+     * @param count maximum number of conditions to return
+     * @return the conditions that were evaluated or triggered, the highest getEstimatedCostNs first
+     */
+    std::vector<ConditionProfile> takeHotConditions( size_t count );
+
+    /**
+     * @brief Takes the most expensive conditions and sets their cost as named variables of the TraceModule, which
+     * forwards them to the RemoteProfiler: conditionCostUs_<campaign>, conditionEvaluations_<campaign>,
+     * conditionTriggers_<campaign>, conditionCollectedBytes_<campaign> and conditionCollectTimeUs_<campaign>. The
+     * variables of conditions reported the last time but not this time are removed.
+     * @param count maximum number of conditions to report
+     */
+    void reportHotConditions( size_t count );
+
+    /**
+     * @brief Takes over the active DTCs of the Active DTC Buffer
+     * @param activeDTCs full set of active DTCs, or the changes since the previous set if mIsDelta is set. A delta
+     * that does not follow the current set is ignored until the next full set arrives.
+     */
     void setActiveDTCs( const DTCInfo &activeDTCs );
 
+    // Default memory for all signal and CAN frame samples
+    static constexpr size_t DEFAULT_SAMPLE_MEMORY_BUDGET = FootprintProfile::DEFAULT_SAMPLE_MEMORY_BUDGET;
+
+    /**
+     * @brief Sets the memory available for the signal and CAN frame history buffers. Takes effect with the next
+     * inspection matrix.
+     *
+     * If the conditions request more samples than fit, the buffers of the conditions with the lowest priority,
+     * which is the highest priority number, are shrunk first.
+     * @param bytes the memory budget in bytes
+     */
+    void
+    setSampleMemoryBudget( size_t bytes )
+    {
+        mSampleMemoryBudget = bytes;
+    }
+
+    // Newest samples of a deep history signal that are kept in memory, the older ones go to the file on flash
+    static constexpr uint32_t DEEP_HISTORY_MEMORY_SAMPLES = 1024;
+
+    /**
+     * @brief Sets the directory on flash for the deep history of signals. Takes effect with the next inspection
+     * matrix.
+     *
+     * Signals the collection scheme marks as deep history keep only their newest DEEP_HISTORY_MEMORY_SAMPLES
+     * samples in memory. The older samples of the sample buffer size are moved to a DeepHistoryFile in this
+     * directory and collected from there as if they were in memory. The files do not count into the sample memory
+     * budget.
+     * @param directory existing directory, empty to keep all samples in memory
+     */
+    void
+    setDeepHistoryDirectory( const std::string &directory )
+    {
+        mDeepHistoryDirectory = directory;
+    }
+
+    /**
+     * @brief Keeps the older samples of deep history signals compressed in memory if no deep history directory is
+     * set. Takes effect with the next inspection matrix.
+     *
+     * Like with a directory, only the newest DEEP_HISTORY_MEMORY_SAMPLES samples stay uncompressed. The older ones
+     * are moved to a CompressedSampleHistory, which is decompressed when the samples are collected. The compressed
+     * samples do not count into the sample memory budget.
+     * @param enabled true to compress the deep history
+     */
+    void
+    setDeepHistoryCompressionEnabled( bool enabled )
+    {
+        mDeepHistoryCompressionEnabled = enabled;
+    }
+
+    /**
+     * @brief Writes the state of the active inspection matrix to a file, so that the engine can continue with it
+     * after a restart, see restoreState.
+     *
+     * The file holds the samples of the signal and CAN frame history buffers, the fixed window data, the last trigger
+     * times and which conditions are currently true. It is written sequentially to a temporary file that then
+     * replaces the file at path. Deep history samples, sliding windows, the partial window of aggregated signals and
+     * collected data that was not sent are not kept.
+     * @param path file to write, its directory must exist
+     * @return true if the state was written
+     */
+    bool saveState( const std::string &path );
+
+    /**
+     * @brief Restores the state written by saveState if it was saved for the same inspection matrix as the active
+     * one. The matrices are compared by a fingerprint of their conditions, as the inspection matrix is rebuilt after
+     * a restart. Should be called directly after onChangeInspectionMatrix, samples added in between are overwritten.
+     * @param path file written by saveState
+     * @return true if the state was restored
+     */
+    bool restoreState( const std::string &path );
+
+    /**
+     * @brief Memory accounting of the signal and CAN frame history buffers of the active inspection matrix
+     */
+    struct SampleMemoryUsage
+    {
+        size_t budgetBytes{ 0 };
+        size_t usedBytes{ 0 };
+        uint32_t shrunkBuffers{ 0 }; /**< buffers of conditions that hold fewer samples than requested */
+        std::map<std::string, size_t> bytesPerCampaign; /**< by collection scheme ID, the samples of a buffer shared
+                                                          by multiple campaigns are counted for each of them */
+        std::map<InspectionSignalID, size_t> bytesPerSignal; /**< over all sample intervals of the signal */
+    };
+
+    /**
+     * @brief Get the memory accounting of the active inspection matrix. The same values are published as named
+     * variables of the TraceModule. Must be called from the thread calling onChangeInspectionMatrix.
+     */
+    const SampleMemoryUsage &
+    getSampleMemoryUsage() const
+    {
+        return mSampleMemoryUsage;
+    }
+
+    ~CollectionInspectionEngine() override;
+
+    CollectionInspectionEngine( const CollectionInspectionEngine & ) = delete;
+    CollectionInspectionEngine &operator=( const CollectionInspectionEngine & ) = delete;
+    CollectionInspectionEngine( CollectionInspectionEngine && ) = delete;
+    CollectionInspectionEngine &operator=( CollectionInspectionEngine && ) = delete;
+
 private:
-    static const uint32_t MAX_SAMPLE_MEMORY = 20 * 1024 * 1024; // 20MB max for all samples
+    // The history buffers are allocated from the MemoryArena if one is reserved
+    template <typename T>
+    using HistoryAllocator = ArenaAllocator<T, MemorySubsystem::INSPECTION>;
+
     static inline InspectionValue
     EVAL_EQUAL_DISTANCE()
     {
         return 0.001;
     } // because static const double (non-integral type) not possible
 
-    struct SampleConsumed
-    {
-        bool
-        isAlreadyConsumed( uint32_t conditionId )
-        {
-            return mAlreadyConsumed.test( conditionId );
-        }
-        void
-        setAlreadyConsumed( uint32_t conditionId, bool value )
-        {
-            if ( conditionId == ALL_CONDITIONS )
-            {
-                if ( value )
-                {
-                    mAlreadyConsumed.set();
-                }
-                else
-                {
-                    mAlreadyConsumed.reset();
-                }
-            }
-            else
-            {
-                mAlreadyConsumed[conditionId] = value;
-            }
-        }
-
-    private:
-        std::bitset<MAX_NUMBER_OF_ACTIVE_CONDITION> mAlreadyConsumed{ 0 };
-    };
-    struct SignalSample : SampleConsumed
+    /**
+     * @brief Counter of the newest sample of a buffer a condition already collected. All older samples of the
+     * buffer are consumed by this condition as well, so one value per condition replaces a flag per sample.
+     */
+    struct ConsumedUntil
     {
-        InspectionValue mValue{ 0.0 };
-        InspectionTimestamp mTimestamp{ 0 };
+        uint32_t mConditionId{ 0 };
+        uint32_t mCounter{ 0 };
     };
+    using ConsumedUntilVector = std::vector<ConsumedUntil>;
 
-    struct CanFrameSample : SampleConsumed
+    struct CanFrameSample
     {
-        uint8_t mSize{ 0 }; /**< elements in buffer variable used. So if the raw can messages is only 3 bytes big this
-                           uint8_t will be 3 and only the first three bytes of buffer will contain meaningful data. size
-                           optimized sizeof(size)+sizeof(buffer) = 9 < sizeof(std:vector) = 24 so also for empty
-                           messages its mor efficient to preallocate 8 bytes even if not all will be used*/
-        std::array<uint8_t, MAX_CAN_FRAME_BYTE_SIZE> mBuffer{};
+        uint8_t mSize{ 0 }; /**< bytes used in the payload slot of this sample. So if the raw can messages is only 3
+                           bytes big this uint8_t will be 3 and only the first three bytes of the slot will contain
+                           meaningful data. The payload itself lives in CanFrameHistoryBuffer::mPayload */
+        TimestampFractionUs mTimestampFractionUs{ 0 };
         InspectionTimestamp mTimestamp{ 0 };
     };
 
@@ -224,6 +521,7 @@ private:
         InspectionValue mCollectingMax{ std::numeric_limits<InspectionValue>::max() };
         InspectionValue mCollectingSum{ 0 };
         uint32_t mCollectedSignals{ 0 };
+        std::vector<SignalAggregator> mAggregators; /**< one per condition aggregating the signal over this window */
 
         /**
          * @brief update fixed sample windows when fixed time is over
@@ -251,6 +549,23 @@ private:
             mCollectingMax = std::max( mCollectingMax, value );
             mCollectingSum += value;
             mCollectedSignals++;
+            for ( auto &aggregator : mAggregators )
+            {
+                aggregator.addValue( value );
+            }
+        }
+        inline void
+        finishAggregations()
+        {
+            for ( auto &aggregator : mAggregators )
+            {
+                aggregator.finishWindow( mLastTimeCalculated,
+                                         static_cast<uint32_t>( mWindowSizeMs ),
+                                         mCollectedSignals,
+                                         mCollectingMin,
+                                         mCollectingMax,
+                                         mCollectingSum );
+            }
         }
         inline void
         initNewWindow( InspectionTimestamp timestamp, InspectionTimestamp &nextWindowFunctionTimesOut )
@@ -265,11 +580,84 @@ private:
         }
     }; // end class FixedTimeWindowFunctionData
 
+    /**
+     * @brief maintains values like min, max, avg, count, standard deviation and rate of change over the samples
+     * of the last window size milliseconds
+     *
+     * Other than FixedTimeWindowFunctionData the window moves with every sample and with time. Min and max are
+     * kept in monotonic deques and avg and standard deviation as running sums, so every sample is added and removed
+     * exactly once and all values are available in constant time.
+     * */
+    class SlidingTimeWindowFunctionData
+    {
+    public:
+        SlidingTimeWindowFunctionData( uint32_t size )
+            : mWindowSizeMs( size )
+        {
+        }
+
+        InspectionTimestamp mWindowSizeMs{ 0 }; /** <over which time is the window calculated */
+
+        /**
+         * @brief removes the samples that are older than the window
+         *
+         * @param timestamp the current time
+         * @param nextWindowFunctionTimesOut will be reduced if the oldest sample in the window expires earlier
+         *
+         * @return true if any sample was removed false otherwise
+         */
+        bool updateWindow( InspectionTimestamp timestamp, InspectionTimestamp &nextWindowFunctionTimesOut );
+
+        void addValue( InspectionValue value,
+                       InspectionTimestamp timestamp,
+                       InspectionTimestamp &nextWindowFunctionTimesOut );
+
+        /**
+         * @brief calculates one of the SLIDING_WINDOW_* functions over the samples currently in the window
+         *
+         * @param function the function to calculate
+         * @param result the value of the function
+         *
+         * @return false if the window has not enough samples to calculate the function
+         */
+        bool getValue( WindowFunction function, InspectionValue &result ) const;
+
+    private:
+        struct Sample
+        {
+            InspectionTimestamp mTimestamp{ 0 };
+            InspectionValue mValue{ 0 };
+        };
+        std::deque<Sample> mSamples;        /** <all samples in the window, oldest first */
+        std::deque<Sample> mMinCandidates;  /** <increasing values, front is the minimum of the window */
+        std::deque<Sample> mMaxCandidates;  /** <decreasing values, front is the maximum of the window */
+        InspectionValue mSum{ 0 };          /** <sum of all values in mSamples */
+        InspectionValue mSumOfSquares{ 0 }; /** <sum of the squares of all values in mSamples */
+    }; // end class SlidingTimeWindowFunctionData
+
+    /**
+     * @brief Comparison of the latest sample of a signal buffer with a constant, in the form
+     * sample mOperator mThreshold. The result is kept in mThresholdLeafValues[mLeafIndex].
+     */
+    struct ThresholdLeaf
+    {
+        InspectionValue mThreshold{ 0 };
+        ExpressionNodeType mOperator{ ExpressionNodeType::OPERATOR_EQUAL };
+        uint32_t mLeafIndex{ 0 };
+    };
+
     /**
      * @brief stores the history of one signal.
      *
      * The signal can be used as part of a condition or only to be published in the case
-     * a condition is true
+     * a condition is true. The samples are stored in chunks of separate arrays of values and timestamps, the
+     * timestamps as 32 bit offsets to mTimestampEpoch. Collected data can reference the chunks, a referenced chunk
+     * is copied before it is written.
+     *
+     * A buffer with a minimum sample interval can be a view of the buffer of the same signal without a sample
+     * interval, its base buffer. The samples of a view are always also stored by the base buffer, so a view only
+     * keeps the counters of its samples in the base buffer instead of chunks. Before the base buffer overwrites a
+     * sample a view still has, the view copies its samples into chunks of its own, see materializeSignalView.
      */
     struct SignalHistoryBuffer
     {
@@ -281,18 +669,181 @@ private:
         {
         }
 
+        // Bytes one sample needs in the arrays below
+        static constexpr size_t BYTES_PER_SAMPLE =
+            sizeof( InspectionValue ) + sizeof( int32_t ) + sizeof( TimestampFractionUs );
+
         uint32_t mMinimumSampleIntervalMs{ 0 };
-        std::vector<struct SignalSample>
-            mBuffer; // ringbuffer, Consider to move to raw pointer allocated with new[] if vector allocates too much
+        std::vector<std::shared_ptr<SignalSampleChunk>> mChunks; /**< ringbuffer of mSize samples */
+        uint32_t mBaseBufferIndex{ INVALID_SIGNAL_INDEX }; /**< index of the base buffer if this buffer is a view */
+        std::vector<uint32_t> mBaseCounters; /**< ringbuffer of mSize base buffer counters instead of mChunks, if this
+                                                buffer is a view */
+        bool mHasViews{ false };             /**< other buffers of the signal may be views of this buffer */
+        InspectionTimestamp mTimestampEpoch{ 0 };
         uint32_t mSize{ 0 };            // minimum size needed by all conditions, buffer must be at least this big
         uint32_t mCurrentPosition{ 0 }; /**< position in ringbuffer needs to come after size as it depends on it */
         uint32_t mCounter{ 0 };         /**< over all recorded samples*/
-        InspectionTimestamp mLastSample{ 0 };
+        uint64_t mLastSampleUs{ 0 }; /**< microseconds since epoch, to apply the minimum sample interval */
+        ConsumedUntilVector mConsumedUntil; /**< one entry per condition that collected from this buffer */
+        std::vector<uint32_t> mStreamingConditions; /**< conditions new samples are appended to, see
+                                                       setStreamingCollectionEnabled */
+        uint32_t mDeepHistorySize{ 0 }; /**< samples requested by deep history conditions, in memory and on flash */
+        std::shared_ptr<DeepHistoryFile> mDeepHistory; /**< samples older than the mSize samples in memory */
+        std::shared_ptr<CompressedSampleHistory>
+            mCompressedHistory; /**< instead of mDeepHistory if there is no directory and compression is enabled */
         std::vector<FixedTimeWindowFunctionData>
             mWindowFunctionData; /**< every signal buffer can have multiple windows over different time periods*/
-        std::bitset<MAX_NUMBER_OF_ACTIVE_CONDITION>
-            mConditionsThatEvaluateOnThisSignal; /**< if bit 0 is set it means element with index 0 of vector conditions
-                                                 needs to reevaluate if this signal changes*/
+        std::vector<SlidingTimeWindowFunctionData>
+            mSlidingWindowFunctionData; /**< only created for the periods a condition uses a sliding function on */
+        InspectionTimestamp mNextWindowTimeout{
+            std::numeric_limits<InspectionTimestamp>::max() }; /**< earliest time a window changes without a new
+                                                                  sample, the time of the valid entry of this buffer
+                                                                  in the window timeout heap */
+        std::vector<uint32_t>
+            mConditionsThatEvaluateOnThisSignal; /**< indices in the vector conditions of the conditions that need to
+                                                 reevaluate if this signal changes*/
+        std::vector<ThresholdLeaf> mThresholds; /**< comparisons of all conditions with the latest sample, sorted by
+                                                   the threshold */
+        InspectionValue mThresholdValue{ 0 };   /**< the sample the threshold leaves currently hold the results of */
+        bool mThresholdValueValid{ false };
+
+        // Chunks that are already allocated, because the history was taken over, are kept
+        inline void
+        allocate()
+        {
+            mChunks.resize( ( mSize + SignalSampleChunk::SIZE - 1 ) / SignalSampleChunk::SIZE );
+            for ( auto &chunk : mChunks )
+            {
+                if ( !chunk )
+                {
+                    chunk = std::allocate_shared<SignalSampleChunk>( HistoryAllocator<SignalSampleChunk>() );
+                }
+            }
+        }
+
+        inline bool
+        isView() const
+        {
+            return mBaseBufferIndex != INVALID_SIGNAL_INDEX;
+        }
+
+        inline bool
+        isAllocated() const
+        {
+            return ( mSize > 0 ) && ( isView() ? ( mBaseCounters.size() == mSize )
+                                               : ( mSize <= mChunks.size() * SignalSampleChunk::SIZE ) );
+        }
+
+        /**
+         * @brief Returns the position of a sample in this buffer from its counter value, which is the value of
+         * mCounter right after the sample was added
+         * @return the position, INVALID_SIGNAL_INDEX if the sample was already overwritten
+         */
+        inline uint32_t
+        getPositionOfCounter( uint32_t counter ) const
+        {
+            if ( ( counter == 0 ) || ( counter > mCounter ) || ( mCounter - counter >= std::min( mCounter, mSize ) ) )
+            {
+                return INVALID_SIGNAL_INDEX;
+            }
+            return ( mCurrentPosition + mSize - ( mCounter - counter ) ) % mSize;
+        }
+
+        /**
+         * @brief Returns the base buffer counter of the oldest sample a view has, 0 if the view has none
+         */
+        inline uint32_t
+        getOldestBaseCounter() const
+        {
+            if ( mCounter == 0 )
+            {
+                return 0;
+            }
+            return mBaseCounters[getPositionOfCounter( mCounter - std::min( mCounter, mSize ) + 1 )];
+        }
+
+        inline const SignalSampleChunk &
+        getChunk( uint32_t position ) const
+        {
+            return *mChunks[position / SignalSampleChunk::SIZE];
+        }
+
+        // Copies the chunk of the position first if collected data still references it
+        inline SignalSampleChunk &
+        getWritableChunk( uint32_t position )
+        {
+            auto &chunk = mChunks[position / SignalSampleChunk::SIZE];
+            if ( chunk.use_count() > 1 )
+            {
+                chunk = std::allocate_shared<SignalSampleChunk>( HistoryAllocator<SignalSampleChunk>(), *chunk );
+            }
+            return *chunk;
+        }
+
+        inline InspectionValue
+        getValue( uint32_t position ) const
+        {
+            return getChunk( position ).values[position % SignalSampleChunk::SIZE];
+        }
+
+        inline TimestampFractionUs
+        getTimestampFractionUs( uint32_t position ) const
+        {
+            return getChunk( position ).timestampFractionsUs[position % SignalSampleChunk::SIZE];
+        }
+
+        inline InspectionTimestamp
+        getTimestamp( uint32_t position ) const
+        {
+            return static_cast<InspectionTimestamp>(
+                static_cast<int64_t>( mTimestampEpoch ) +
+                getChunk( position ).timestampOffsets[position % SignalSampleChunk::SIZE] );
+        }
+
+        inline void
+        setSample( uint32_t position,
+                   InspectionValue value,
+                   InspectionTimestamp timestamp,
+                   TimestampFractionUs timestampFractionUs )
+        {
+            if ( mCounter == 0 )
+            {
+                mTimestampEpoch = timestamp;
+            }
+            int64_t offset = static_cast<int64_t>( timestamp ) - static_cast<int64_t>( mTimestampEpoch );
+            if ( ( offset > std::numeric_limits<int32_t>::max() ) || ( offset < std::numeric_limits<int32_t>::min() ) )
+            {
+                moveTimestampEpoch( timestamp );
+                offset = 0;
+            }
+            auto &chunk = getWritableChunk( position );
+            auto chunkPosition = position % SignalSampleChunk::SIZE;
+            chunk.values[chunkPosition] = value;
+            chunk.timestampOffsets[chunkPosition] = static_cast<int32_t>( offset );
+            chunk.timestampFractionsUs[chunkPosition] = timestampFractionUs;
+        }
+
+        /**
+         * @brief Makes all timestamps relative to a new epoch. Samples that are too far away from the new epoch
+         * are clamped, that happens only for samples older than 24 days.
+         */
+        void
+        moveTimestampEpoch( InspectionTimestamp epoch )
+        {
+            int64_t shift = static_cast<int64_t>( mTimestampEpoch ) - static_cast<int64_t>( epoch );
+            for ( uint32_t position = 0; position < mChunks.size() * SignalSampleChunk::SIZE;
+                  position += SignalSampleChunk::SIZE )
+            {
+                for ( auto &timestampOffset : getWritableChunk( position ).timestampOffsets )
+                {
+                    int64_t offset = timestampOffset + shift;
+                    offset = std::max<int64_t>( offset, std::numeric_limits<int32_t>::min() );
+                    offset = std::min<int64_t>( offset, std::numeric_limits<int32_t>::max() );
+                    timestampOffset = static_cast<int32_t>( offset );
+                }
+            }
+            mTimestampEpoch = epoch;
+        }
 
         inline FixedTimeWindowFunctionData *
         addFixedWindow( uint32_t windowSizeMs )
@@ -326,6 +877,24 @@ private:
             }
             return nullptr;
         }
+
+        /**
+         * @brief Returns the index of the sliding window with the size in mSlidingWindowFunctionData, the window is
+         * added if there is none yet
+         */
+        inline uint32_t
+        addSlidingWindow( uint32_t windowSizeMs )
+        {
+            for ( uint32_t windowIndex = 0; windowIndex < mSlidingWindowFunctionData.size(); windowIndex++ )
+            {
+                if ( mSlidingWindowFunctionData[windowIndex].mWindowSizeMs == windowSizeMs )
+                {
+                    return windowIndex;
+                }
+            }
+            mSlidingWindowFunctionData.emplace_back( windowSizeMs );
+            return static_cast<uint32_t>( mSlidingWindowFunctionData.size() - 1 );
+        }
     };
 
     /**
@@ -349,16 +918,48 @@ private:
         CANRawFrameID mFrameID{ INVALID_CAN_FRAME_ID };
         CANChannelNumericID mChannelID{ INVALID_CAN_SOURCE_NUMERIC_ID };
         uint32_t mMinimumSampleIntervalMs{ 0 };
-        std::vector<struct CanFrameSample>
-            mBuffer; // ringbuffer, Consider to move to raw pointer allocated with new[] if vector allocates too much
+        std::vector<struct CanFrameSample, HistoryAllocator<struct CanFrameSample>> mBuffer; // ringbuffer
+        std::vector<uint8_t, HistoryAllocator<uint8_t>>
+            mPayload; // mSize slots of mFrameCapacity bytes, one for each sample in mBuffer
+        uint8_t mFrameCapacity{ MAX_CAN_FRAME_BYTE_SIZE }; // grows to MAX_CANFD_FRAME_BYTE_SIZE on first CAN FD frame
         uint32_t mSize{ 0 };
         uint32_t mCurrentPosition{ mSize - 1 }; // position in ringbuffer
         uint32_t mCounter{ 0 };
-        InspectionTimestamp mLastSample{ 0 };
+        uint64_t mLastSampleUs{ 0 }; /**< microseconds since epoch, to apply the minimum sample interval */
+        ConsumedUntilVector mConsumedUntil; /**< one entry per condition that collected from this buffer */
+        std::vector<uint32_t> mStreamingConditions; /**< conditions new frames are appended to */
+        std::vector<uint32_t> mConditionsThatEvaluateOnThisFrame; /**< conditions with a RAWFRAMEFIELD node reading
+                                                                       this buffer */
+    };
+
+    /**
+     * @brief State of one condition that every evaluation reads. The states of all conditions are kept in
+     * mConditionStates in the order of mConditions, one cache line each, so that the evaluation streams through
+     * them and only collecting reads the ActiveCondition and its ConditionWithCollectedData.
+     */
+    struct alignas( MemoryArena::ALIGNMENT ) ConditionEvaluationState
+    {
+        InspectionTimestamp mLastTrigger{ 0 };
+        // Not evaluated before this time, see ConditionWithCollectedData::evaluationIntervalMs
+        InspectionTimestamp mNextEvaluation{ 0 };
+        // Not evaluated until mEvaluationPass is bigger, set if an evaluation exceeded the CPU budget
+        uint64_t mDeferredUntilPass{ 0 };
+        // The compiled condition expression in mPrograms
+        uint32_t mProgramStart{ 0 };
+        uint32_t mProgramLength{ 0 };
+        // Copied from the ConditionWithCollectedData
+        uint32_t mMinimumPublishInterval{ 0 };
+        uint32_t mEvaluationIntervalMs{ 0 };
+        uint32_t mEvaluationBudgetUs{ 0 };
+        bool mTriggerOnlyOnRisingEdge{ false };
     };
+    static_assert( sizeof( ConditionEvaluationState ) == MemoryArena::ALIGNMENT,
+                   "ConditionEvaluationState should fill exactly one cache line" );
+    using ConditionStateVector = std::vector<ConditionEvaluationState, HistoryAllocator<ConditionEvaluationState>>;
 
     /**
-     * @brief Stores information specific to one condition like the last time if was true
+     * @brief Stores information specific to one condition that is only needed when it triggered, see
+     * ConditionEvaluationState for the state used by the evaluation
      */
     struct ActiveCondition
     {
@@ -367,14 +968,49 @@ private:
         {
         }
         InspectionTimestamp mLastDataTimestampPublished{ 0 };
-        InspectionTimestamp mLastTrigger{ 0 };
-        std::unordered_map<InspectionSignalID, SignalHistoryBuffer *>
-            mEvaluationSignals; // for fast lookup signals used for evaluation
-        std::unordered_map<InspectionSignalID, FixedTimeWindowFunctionData *>
-            mEvaluationFunctions; // for fast lookup functions used for evaluation
         const ConditionWithCollectedData &mCondition;
         // Unique Identifier of the Event matched by this condition.
         EventID mEventID{ 0 };
+        // Only counted if condition profiling is enabled, the campaign is set when the profile is taken
+        ConditionProfile mProfile;
+        // Data collected since the trigger while the afterDuration passes, see setStreamingCollectionEnabled
+        std::shared_ptr<TriggeredCollectionSchemeData> mStreamingData;
+        InspectionTimestamp mStreamingNewestTimestamp{ 0 };
+    };
+
+    /**
+     * @brief The periodic conditions of one period. They trigger together at the ticks of the period, so that
+     * their data is collected and sent in one shared payload. The phase of the ticks is kept across inspection
+     * matrix changes, a condition added to a period triggers with the next tick.
+     */
+    struct PeriodicGroup
+    {
+        uint32_t mPeriodMs{ 0 };
+        InspectionTimestamp mNextTick{ 0 }; /**< 0 until the first evaluation, which triggers after the jitter */
+        std::vector<uint32_t> mConditions;
+    };
+
+    // Bytes one CAN frame sample needs with the classic CAN payload reserved upfront
+    static constexpr size_t CAN_FRAME_BYTES_PER_SAMPLE = sizeof( struct CanFrameSample ) + MAX_CAN_FRAME_BYTE_SIZE;
+    // Steps of the binary search for the factor a priority level is shrunk with
+    static constexpr uint32_t SAMPLE_MEMORY_BUDGET_SEARCH_STEPS = 20;
+
+    // Marks a dense index as not assigned
+    static constexpr uint32_t INVALID_SIGNAL_INDEX = 0xFFFFFFFF;
+    // Marks a condition of the previous inspection matrix that is not part of the new one
+    static constexpr uint32_t INVALID_CONDITION_INDEX = 0xFFFFFFFF;
+
+    /**
+     * @brief Data one instruction of a compiled condition evaluates, Instruction::index points into
+     * mEvaluationSignals. Every condition has own entries as the conditions can use different buffers and windows
+     * of a signal. Indices are used instead of pointers as the buffers of later conditions can still be added.
+     */
+    struct EvaluationSignal
+    {
+        uint32_t mSignalIndex{ INVALID_SIGNAL_INDEX }; /**< index in mSignalBuffers */
+        uint32_t mBufferIndex{ 0 };                    /**< index of the subsampling buffer of the signal */
+        uint32_t mWindowIndex{ INVALID_SIGNAL_INDEX }; /**< index in mWindowFunctionData, if the condition has one */
+        uint32_t mSlidingWindowIndex{ INVALID_SIGNAL_INDEX }; /**< index in mSlidingWindowFunctionData */
     };
 
     enum class ExpressionErrorCode
@@ -387,33 +1023,484 @@ private:
         NOT_IMPLEMENTED_FUNCTION
     };
 
+    /**
+     * @brief One instruction of a compiled condition.
+     * The program is the postfix form of the expression tree evaluated on a stack of values. Sub expressions
+     * without signals are folded to constants and logical AND / OR jump over their right operand if the left
+     * operand already decides the result.
+     */
+    struct Instruction
+    {
+        enum class OpCode : uint8_t
+        {
+            PUSH_CONSTANT,        /**< push value and boolValue */
+            PUSH_SIGNAL,          /**< push the latest sample of mEvaluationSignals[index] */
+            PUSH_WINDOW_FUNCTION, /**< push windowFunction of mEvaluationSignals[index] */
+            PUSH_GEOHASH,         /**< push the geohash function of node with latitude index and longitude
+                                       secondIndex */
+            PUSH_GEOFENCE,        /**< push the geofence function mGeofenceFunctions[index] */
+            PUSH_RAW_FRAME_FIELD, /**< push the bit field mRawFrameFields[index] of the latest frame */
+            PUSH_THRESHOLD,       /**< push mThresholdLeafValues[index], the comparison of the latest sample of
+                                       mEvaluationSignals[secondIndex] with a constant */
+            PUSH_SHARED,          /**< push the result of mSharedExpressions[index], evaluated at most once per
+                                       evaluation pass */
+            OPERATOR,             /**< replace the operands on top of the stack by the result of nodeType */
+            JUMP_IF_FALSE,        /**< if the top is false it is the result of the AND and evaluation continues at
+                                       index */
+            JUMP_IF_TRUE,         /**< if the top is true it is the result of the OR and evaluation continues at
+                                       index */
+            FAIL                  /**< stop the evaluation with error */
+        };
+        OpCode opCode{ OpCode::FAIL };
+        ExpressionNodeType nodeType{ ExpressionNodeType::FLOAT };
+        WindowFunction windowFunction{ WindowFunction::NONE };
+        ExpressionErrorCode error{ ExpressionErrorCode::SUCCESSFUL };
+        uint32_t index{ INVALID_SIGNAL_INDEX };
+        uint32_t secondIndex{ INVALID_SIGNAL_INDEX };
+        InspectionValue value{ 0 };
+        bool boolValue{ false };
+        const ExpressionNode *node{ nullptr };
+    };
+
+    /**
+     * @brief Result of an expression, depending on the expression either the double or the bool is used
+     */
+    struct EvaluationValue
+    {
+        InspectionValue mDouble{ 0 };
+        bool mBool{ false };
+    };
+
+    /**
+     * @brief Sub expression that is used multiple times by one or multiple conditions. Its program is in
+     * mSharedPrograms and the result is cached for the evaluation pass it was calculated in.
+     */
+    struct SharedExpression
+    {
+        uint32_t mProgramStart{ 0 };
+        uint32_t mProgramLength{ 0 };
+        uint64_t mEvaluationPass{ 0 };
+        ExpressionErrorCode mError{ ExpressionErrorCode::SUCCESSFUL };
+        EvaluationValue mResult;
+    };
+
+    /**
+     * @brief Geofence function used by a condition with the evaluation signals of its latitude and longitude
+     */
+    struct GeofenceFunctionEvaluation
+    {
+        GeofenceFunctionEvaluation( uint32_t latitudeIndex,
+                                    uint32_t longitudeIndex,
+                                    std::shared_ptr<const GeofenceIndex> geofences )
+            : mLatitudeIndex( latitudeIndex )
+            , mLongitudeIndex( longitudeIndex )
+            , mNode( std::move( geofences ) )
+        {
+        }
+        uint32_t mLatitudeIndex;
+        uint32_t mLongitudeIndex;
+        GeofenceFunctionNode mNode;
+    };
+
+    /**
+     * @brief Bit field of a raw CAN frame used by a condition, read from the latest frame of a CAN frame buffer
+     */
+    struct RawFrameFieldEvaluation
+    {
+        uint32_t mBufferIndex{ INVALID_SIGNAL_INDEX }; /**< index in mCanFrameBuffers */
+        CANSignalDecodeStep mStep;                     /**< the bit field compiled like a decoded signal */
+    };
+
     SignalHistoryBuffer &addSignalToBuffer( const InspectionMatrixSignalCollectionInfo &signal );
+    // Samples of the signal that have to be kept in memory, without the part a deep history file can hold
+    uint32_t getMemorySampleDemand( const InspectionMatrixSignalCollectionInfo &signal ) const;
+    /**
+     * @brief Returns the dense index of a signal in mSignalBuffers
+     * @return the index or INVALID_SIGNAL_INDEX if the signal is not used by the active conditions
+     */
+    inline uint32_t
+    getSignalIndex( InspectionSignalID id ) const
+    {
+        if ( id < mSignalIndexTable.size() )
+        {
+            return mSignalIndexTable[id];
+        }
+        if ( mSparseSignalIndices.empty() )
+        {
+            return INVALID_SIGNAL_INDEX;
+        }
+        auto it = mSparseSignalIndices.find( id );
+        return ( it == mSparseSignalIndices.end() ) ? INVALID_SIGNAL_INDEX : it->second;
+    }
+    /**
+     * @brief Returns the dense index of a signal in mSignalBuffers using its index in the Decoder Manifest
+     *
+     * The entry is only used if it was built for the same signal ID, so that a signal decoded with another Decoder
+     * Manifest than the one of the inspection matrix is still found by its ID.
+     */
+    inline uint32_t
+    getSignalIndex( InspectionSignalID id, ManifestSignalIndex manifestSignalIndex ) const
+    {
+        if ( ( manifestSignalIndex < mManifestSignalIndexTable.size() ) &&
+             ( mManifestSignalIndexTable[manifestSignalIndex].mSignalID == id ) )
+        {
+            return mManifestSignalIndexTable[manifestSignalIndex].mSignalIndex;
+        }
+        return getSignalIndex( id );
+    }
+    /**
+     * @brief Appends the program of an expression to mPrograms
+     * @param expression the expression or sub expression to compile
+     * @param conditionIndex the condition the expression belongs to, to resolve its signals
+     * @param remainingStackDepth nodes deeper than MAX_EQUATION_DEPTH compile to a STACK_DEPTH_REACHED error
+     * @return true if the program of the expression is a constant
+     */
+    bool compileExpression( const ExpressionNode *expression, uint32_t conditionIndex, int remainingStackDepth );
+    /**
+     * @brief Appends the program of an operator node and its operands to mPrograms, see compileExpression
+     */
+    bool compileOperator( const ExpressionNode *expression, uint32_t conditionIndex, int remainingStackDepth );
+    /**
+     * @brief Moves the program of a sub expression used multiple times from the end of mPrograms to
+     * mSharedPrograms and replaces it by a PUSH_SHARED instruction. If the same node was already compiled to the
+     * same program for another condition, that program is used.
+     * @param expression the shared sub expression
+     * @param begin index in mPrograms of the first instruction of the sub expression
+     */
+    void shareProgram( const ExpressionNode *expression, size_t begin );
+    bool isSameInstruction( const Instruction &shared,
+                            size_t sharedStart,
+                            const Instruction &instruction,
+                            size_t start ) const;
+    // Counts how often each node is reached over all conditions in mExpressionUseCounts
+    void countExpressionUses( const ExpressionNode *expression, int remainingStackDepth );
+    /**
+     * @brief Adds the entry in mEvaluationSignals for a signal used by a condition
+     * @param conditionIndex the condition that uses the signal
+     * @param signalID the signal
+     * @param slidingWindow if true a sliding window over the fixed window period of the signal is used and created
+     * if the buffer has none yet
+     * @return index in mEvaluationSignals or INVALID_SIGNAL_INDEX if the signal has no buffer
+     */
+    uint32_t getEvaluationSignalIndex( uint32_t conditionIndex, InspectionSignalID signalID, bool slidingWindow );
+    /**
+     * @brief Compiles a comparison of a signal with a constant to a leaf of the threshold table of the signal buffer
+     * @param expression comparison node
+     * @param conditionIndex the condition the expression belongs to
+     * @return false if the expression is no such comparison, nothing is appended to mPrograms then
+     */
+    bool compileThresholdLeaf( const ExpressionNode *expression, uint32_t conditionIndex );
+    /**
+     * @brief Updates the threshold leaves of a buffer to a new latest sample. Only the leaves with a threshold
+     * between the previous and the new sample can change, they are found with a binary search.
+     */
+    void updateThresholdLeaves( SignalHistoryBuffer &buffer, InspectionValue value );
+    /**
+     * @brief Adds a sample of addNewSignal to one buffer of the signal, if its minimum sample interval passed. A
+     * view only stores the counter of the sample in its base buffer, which must have been added to before.
+     */
+    void addSampleToBuffer( uint32_t signalIndex,
+                            uint32_t bufferIndex,
+                            InspectionSignalID id,
+                            InspectionTimestamp receiveTime,
+                            InspectionValue value,
+                            TimestampFractionUs receiveTimeFractionUs,
+                            uint64_t receiveTimeUs );
+    static bool compareWithThreshold( InspectionValue value, const ThresholdLeaf &leaf );
+    static bool hasSideEffects( const ExpressionNode *expression, int remainingStackDepth );
+    /**
+     * @brief Returns true for a condition that is always true and triggers again after its minimum publish
+     * interval, like the condition of a time based collection scheme
+     */
+    static bool isPeriodicCondition( const ConditionWithCollectedData &condition );
+    /**
+     * @brief Adds a periodic condition to the group of its period
+     * @param previousGroups the groups of the previous inspection matrix, a new group takes over their phase
+     */
+    void addPeriodicCondition( uint32_t conditionIndex, const std::vector<PeriodicGroup> &previousGroups );
+    /**
+     * @brief Triggers the periodic conditions of the due ticks that are not waiting for their data to be collected
+     * @return at least one condition triggered
+     */
+    bool triggerDuePeriodicConditions( InspectionTimestamp currentTime );
+    // Records the trigger of a condition and schedules the collection of its data
+    void triggerCondition( uint32_t conditionIndex, InspectionTimestamp currentTime );
+    static inline bool
+    isSlidingWindowFunction( WindowFunction function )
+    {
+        return ( function >= WindowFunction::SLIDING_WINDOW_AVG ) &&
+               ( function <= WindowFunction::SLIDING_WINDOW_RATE_OF_CHANGE );
+    }
     bool preAllocateBuffers();
+
+    static inline uint64_t
+    getCanFrameKey( CANRawFrameID frameID, CANChannelNumericID channelID )
+    {
+        return ( static_cast<uint64_t>( channelID ) << 32U ) | frameID;
+    }
+    /**
+     * @brief Returns the indices in mCanFrameBuffers of all sample intervals of a CAN frame
+     * @return the indices or nullptr if no active condition collects the frame
+     */
+    inline const std::vector<uint32_t> *
+    getCanFrameBufferIndices( CANRawFrameID frameID, CANChannelNumericID channelID ) const
+    {
+        auto it = mCanFrameBufferIndices.find( getCanFrameKey( frameID, channelID ) );
+        return ( it == mCanFrameBufferIndices.end() ) ? nullptr : &it->second;
+    }
+    /**
+     * @brief Returns the index in mCanFrameBuffers of the buffer of a CAN frame with a sample interval
+     * @return the index or INVALID_SIGNAL_INDEX if there is no such buffer
+     */
+    uint32_t getCanFrameBufferIndex( CANRawFrameID frameID,
+                                     CANChannelNumericID channelID,
+                                     uint32_t minimumSampleIntervalMs ) const;
+
+    /**
+     * @brief Samples one condition requests from one signal or CAN frame buffer
+     */
+    struct SampleDemand
+    {
+        uint32_t mConditionIndex{ 0 };
+        bool mCanFrame{ false };
+        uint32_t mSignalIndex{ 0 }; /**< index in mSignalBuffers, only for signals */
+        uint32_t mBufferIndex{ 0 }; /**< index of the sample interval buffer of the signal or in mCanFrameBuffers */
+        uint32_t mSamples{ 0 };
+    };
+
+    /**
+     * @brief Sets the size of all buffers to the maximum demand of the conditions using them
+     * @param demands the demands of all conditions
+     * @param degrade if false the full demands are used
+     * @param degradedPriority conditions with a higher priority number get only one sample, conditions with this
+     * priority number get their demand scaled by factor
+     * @param factor between 0 and 1
+     * @return the memory all buffers need in bytes
+     */
+    uint64_t resizeBuffers( const std::vector<SampleDemand> &demands,
+                            bool degrade,
+                            uint32_t degradedPriority,
+                            double factor );
+
+    // Shrinks the buffers of the least important conditions until all buffers fit into mSampleMemoryBudget
+    void applySampleMemoryBudget();
+
+    // Publishes mSampleMemoryUsage as named TraceModule variables, negative to remove it again
+    void traceSampleMemoryUsage( int64_t sign );
+
+    /**
+     * @brief Maps the conditions of the previous inspection matrix to the conditions of the same collection scheme
+     * in the new one and takes over their trigger state
+     * @param previousConditions conditions of the previous matrix
+     * @param previousStates evaluation states of the previous conditions
+     * @return for each previous condition its index in mConditions, INVALID_CONDITION_INDEX if it was removed
+     */
+    std::vector<uint32_t> mapPreviousConditions( const std::vector<ActiveCondition> &previousConditions,
+                                                 const ConditionStateVector &previousStates );
+
+    /**
+     * @brief Moves the samples of a buffer of the previous inspection matrix into the buffer of the new matrix that
+     * collects the same signal with the same sample interval. If the size did not change the chunks are moved,
+     * otherwise the newest samples that fit are copied. Windows with the same period keep their state.
+     * @param buf buffer of the new matrix, mSize must already be set
+     * @param previous buffer of the previous matrix
+     * @param conditionMap result of mapPreviousConditions
+     */
+    static void takeOverSignalHistory( SignalHistoryBuffer &buf,
+                                       SignalHistoryBuffer &previous,
+                                       const std::vector<uint32_t> &conditionMap );
+
+    /**
+     * @brief Same as takeOverSignalHistory for a view of the previous matrix that becomes a view of the base buffer
+     * of the new matrix
+     * @param buf buffer of the new matrix, mSize must already be set
+     * @param previous view of the previous matrix
+     * @param baseBufferIndex index of the base buffer of the new matrix
+     * @param base base buffer of the new matrix, which already took over the previous base buffer
+     * @param droppedBaseSamples number of the oldest samples the base buffer did not take over
+     * @param conditionMap result of mapPreviousConditions
+     * @return false if the base buffer does not have all samples to take over, buf is not changed then
+     */
+    static bool takeOverSignalView( SignalHistoryBuffer &buf,
+                                    SignalHistoryBuffer &previous,
+                                    uint32_t baseBufferIndex,
+                                    const SignalHistoryBuffer &base,
+                                    uint32_t droppedBaseSamples,
+                                    const std::vector<uint32_t> &conditionMap );
+
+    // Moves the state of the windows with the same period of the previous buffer into the buffer
+    static void takeOverWindows( SignalHistoryBuffer &buf,
+                                 SignalHistoryBuffer &previous,
+                                 const std::vector<uint32_t> &conditionMap );
+
+    /**
+     * @brief Copies the samples of a view from its base buffer into chunks of its own, afterwards it is no view
+     * anymore
+     */
+    static void materializeSignalView( SignalHistoryBuffer &view, const SignalHistoryBuffer &base );
+
+    // Returns the index of the buffer without a sample interval, INVALID_SIGNAL_INDEX if there is none
+    static uint32_t getBaseBufferIndex( const std::vector<SignalHistoryBuffer> &bufferVector );
+
+    /**
+     * @brief Makes the buffers with a sample interval views of the base buffer of their signal. Buffers with deep
+     * history and buffers that took over samples in chunks are not made views.
+     */
+    void assignSignalViews();
+
+    // Returns the newest sample of a buffer with at least one sample, read from the base buffer for a view
+    static InspectionValue getNewestValue( const std::vector<SignalHistoryBuffer> &bufferVector,
+                                           const SignalHistoryBuffer &buf );
+
+    /**
+     * @brief Hands the aggregators of conditions that exist in both matrices their window state and pending
+     * summaries, the other aggregators start with the next window
+     */
+    static void takeOverAggregators( FixedTimeWindowFunctionData &window,
+                                     const FixedTimeWindowFunctionData &previous,
+                                     const std::vector<uint32_t> &conditionMap );
+
+    /**
+     * @brief Same as takeOverSignalHistory for a CAN frame buffer
+     */
+    static void takeOverCanFrameHistory( CanFrameHistoryBuffer &buf,
+                                         CanFrameHistoryBuffer &previous,
+                                         const std::vector<uint32_t> &conditionMap );
+
+    /**
+     * @brief Converts the consumed counters of a previous buffer to the new condition indices
+     * @param previous consumed counters of the previous buffer
+     * @param droppedSamples number of the oldest samples not taken over, the counter of the new buffer is that
+     * much smaller
+     * @param conditionMap result of mapPreviousConditions
+     * @return the consumed counters for the new buffer
+     */
+    static ConsumedUntilVector takeOverConsumedUntil( const ConsumedUntilVector &previous,
+                                                      uint32_t droppedSamples,
+                                                      const std::vector<uint32_t> &conditionMap );
+    // Marks all conditions that evaluate on the signal of the buffer as changed
+    void setInputSignalChanged( const SignalHistoryBuffer &buffer );
     bool isSignalPartOfEval( const struct ExpressionNode *expression,
                              InspectionSignalID signalID,
                              int remainingStackDepth );
 
-    ExpressionErrorCode eval( const struct ExpressionNode *expression,
-                              ActiveCondition &condition,
-                              InspectionValue &resultValueDouble,
-                              bool &resultValueBool,
-                              int remainingStackDepth );
-    ExpressionErrorCode getLatestSignalValue( InspectionSignalID id,
-                                              ActiveCondition &condition,
-                                              InspectionValue &result );
-    static ExpressionErrorCode getSampleWindowFunction( WindowFunction function,
-                                                        InspectionSignalID signalID,
-                                                        ActiveCondition &condition,
-                                                        InspectionValue &result );
-    ExpressionErrorCode getGeohashFunctionNode( const struct ExpressionNode *expression,
-                                                ActiveCondition &condition,
-                                                bool &resultValueBool );
+    /**
+     * @brief Runs the instructions from begin to end of mPrograms or mSharedPrograms
+     * @param program mPrograms or mSharedPrograms
+     * @param begin index of the first instruction
+     * @param end index after the last instruction
+     * @param result the value of the expression
+     * @return SUCCESSFUL or the first error that happened
+     */
+    ExpressionErrorCode runProgram( const std::vector<Instruction> &program,
+                                    size_t begin,
+                                    size_t end,
+                                    EvaluationValue &result );
+    // Calculates the value of an instruction that pushes a signal, function or shared expression
+    ExpressionErrorCode evaluateLeaf( const Instruction &instruction, EvaluationValue &value );
+    // Evaluates the condition with its native code if it has one, otherwise with runProgram
+    ExpressionErrorCode runCondition( const ConditionEvaluationState &state,
+                                      uint32_t conditionIndex,
+                                      EvaluationValue &result );
+#ifdef FWE_FEATURE_CONDITION_JIT
+    /**
+     * @brief Generates the native code of the programs of all conditions in mPrograms. Conditions with a program
+     * the code generation does not support keep being interpreted.
+     */
+    void compileNativeConditions();
+    // Called by the native code for the leaves, which are bound to their instruction in mPrograms
+    static uint32_t evaluateNativeLeaf( void *context, const void *leaf, ConditionJit::Slot *slot );
+#endif // FWE_FEATURE_CONDITION_JIT
+    static ExpressionErrorCode applyOperator( ExpressionNodeType nodeType,
+                                              const EvaluationValue &left,
+                                              const EvaluationValue &right,
+                                              EvaluationValue &result );
+    ExpressionErrorCode getLatestSignalValue( uint32_t signalIndex, InspectionValue &result );
+    ExpressionErrorCode getSampleWindowFunction( WindowFunction function,
+                                                 uint32_t signalIndex,
+                                                 InspectionValue &result );
+    ExpressionErrorCode getGeohashFunctionNode( const Instruction &instruction, bool &resultValueBool );
+    ExpressionErrorCode getGeofenceFunctionNode( const Instruction &instruction, bool &resultValueBool );
+    ExpressionErrorCode getRawFrameField( const Instruction &instruction, InspectionValue &result );
+    /**
+     * @brief Compiles a RAWFRAMEFIELD node of a condition, the frame must be one of the CAN frames of the condition
+     * @return false if the frame is not captured for the condition or the bit field is invalid
+     */
+    bool compileRawFrameField( const RawFrameField &field, uint32_t conditionIndex, Instruction &instruction );
+    /**
+     * @brief Returns the counter of the newest sample the condition collected from a buffer
+     * @param consumedUntil the entries of the buffer, an entry for the condition is added if there is none yet
+     * @param conditionId index of the condition
+     */
+    static uint32_t &getConsumedUntil( ConsumedUntilVector &consumedUntil, uint32_t conditionId );
+    /**
+     * @brief Returns the newest timestamp of the newest samples of a buffer. The samples are read in runs that do
+     * not wrap around the ring buffer or cross a chunk.
+     * @param buf the buffer
+     * @param sampleCount number of samples to look at, at most the size of the buffer
+     * @param newestTimestamp raised to the newest timestamp of the samples
+     */
+    static void updateNewestTimestamp( const SignalHistoryBuffer &buf,
+                                       uint32_t sampleCount,
+                                       InspectionTimestamp &newestTimestamp );
     void collectLastSignals( InspectionSignalID id,
                              uint32_t minimumSamplingInterval,
                              uint32_t maxNumberOfSignalsToCollect,
                              uint32_t conditionId,
                              InspectionTimestamp &newestSignalTimestamp,
-                             std::vector<CollectedSignal> &output );
+                             TriggeredCollectionSchemeData &output,
+                             bool copySamples );
+    // Copies the samples of collectLastSignals from the chunks of the buffer, newest first
+    void collectSignalSamples( InspectionSignalID id,
+                               const SignalHistoryBuffer &buf,
+                               uint32_t maxNumberOfSignalsToCollect,
+                               uint32_t consumedUntil,
+                               InspectionTimestamp &newestSignalTimestamp,
+                               TriggeredCollectionSchemeData &output ) const;
+    // Copies the samples of collectLastSignals of a view from its base buffer, newest first
+    void collectSignalViewSamples( InspectionSignalID id,
+                                   const SignalHistoryBuffer &view,
+                                   const SignalHistoryBuffer &base,
+                                   uint32_t maxNumberOfSignalsToCollect,
+                                   uint32_t consumedUntil,
+                                   InspectionTimestamp &newestSignalTimestamp,
+                                   TriggeredCollectionSchemeData &output ) const;
+    // Adds the samples of collectLastSignals as a snapshot referencing the chunks of the buffer
+    void collectSignalSnapshot( InspectionSignalID id,
+                                const SignalHistoryBuffer &buf,
+                                uint32_t maxNumberOfSignalsToCollect,
+                                uint32_t consumedUntil,
+                                InspectionTimestamp &newestSignalTimestamp,
+                                TriggeredCollectionSchemeData &output );
+    // Moves the summaries the aggregator of the condition completed for an aggregated signal to the output
+    void collectSignalSummaries( const InspectionMatrixSignalCollectionInfo &signal,
+                                 uint32_t conditionId,
+                                 std::vector<SignalSummary> &output );
+    // Reduces the samples of the decimated signals of the condition, see decimateSignalSamples
+    static void decimateSignals( const ConditionWithCollectedData &condition, TriggeredCollectionSchemeData &data );
+    // Returns the buffer of the signal with the sample interval, nullptr if the signal is not collected
+    SignalHistoryBuffer *getSignalBuffer( InspectionSignalID id, uint32_t minimumSamplingInterval );
+    /**
+     * @brief Collects the samples of a triggered condition that are in the buffers now and registers the condition
+     * at its buffers, so that addNewSignal and addNewRawCanFrame append the following samples until
+     * takeStreamingData is called
+     */
+    void startStreamingCollection( uint32_t conditionIndex );
+    /**
+     * @brief Unregisters the condition from its buffers
+     * @param conditionIndex index of the condition
+     * @param newestSignalTimestamp the newest timestamp of the streamed samples
+     * @return the data collected since startStreamingCollection
+     */
+    std::shared_ptr<TriggeredCollectionSchemeData> takeStreamingData( uint32_t conditionIndex,
+                                                                      InspectionTimestamp &newestSignalTimestamp );
+    // Adds the samples of collectLastSignals that are older than the samples in memory from the deep history file or
+    // the compressed history
+    void collectDeepHistory( InspectionSignalID id,
+                             const SignalHistoryBuffer &buf,
+                             uint32_t maxNumberOfSignalsToCollect,
+                             uint32_t consumedUntil,
+                             TriggeredCollectionSchemeData &output ) const;
     void collectLastCanFrames( CANRawFrameID canID,
                                CANChannelNumericID channelID,
                                uint32_t minimumSamplingInterval,
@@ -422,7 +1509,58 @@ private:
                                InspectionTimestamp &newestSignalTimestamp,
                                std::vector<CollectedCanRawFrame> &output );
 
-    void updateAllFixedWindowFunctions( InspectionTimestamp timestamp );
+    /**
+     * @brief Widens the payload slots of a CAN frame ring buffer from classic CAN to CAN FD size.
+     * Already stored frames keep their content.
+     */
+    static void growCanFramePayload( CanFrameHistoryBuffer &buf );
+
+    /**
+     * @brief Entry of the min-heap of the times at which the windows of a signal history buffer time out
+     */
+    struct WindowTimeout
+    {
+        InspectionTimestamp mTimeout{ 0 };
+        uint32_t mSignalIndex{ 0 }; /**< index in mSignalBuffers */
+        uint32_t mBufferIndex{ 0 }; /**< index of the sample interval buffer of this signal */
+    };
+
+    /**
+     * @brief Entry of the min-heap of triggered conditions waiting for their afterDuration to pass
+     */
+    struct PendingCollection
+    {
+        InspectionTimestamp mDeadline{ 0 };
+        uint32_t mConditionIndex{ 0 };
+    };
+
+    // Comparator for std::push_heap and std::pop_heap to keep the earliest entry at the front of the heaps
+    struct IsLater
+    {
+        bool
+        operator()( const WindowTimeout &a, const WindowTimeout &b ) const
+        {
+            return a.mTimeout > b.mTimeout;
+        }
+        // Conditions due at the same time are collected in the order of the inspection matrix
+        bool
+        operator()( const PendingCollection &a, const PendingCollection &b ) const
+        {
+            return ( a.mDeadline > b.mDeadline ) ||
+                   ( ( a.mDeadline == b.mDeadline ) && ( a.mConditionIndex > b.mConditionIndex ) );
+        }
+    };
+
+    // Updates the fixed and the sliding windows of the buffers whose windows timed out
+    void updateDueWindowFunctions( InspectionTimestamp timestamp );
+
+    /**
+     * @brief Makes sure the window timeout heap has an entry for the next timeout of a buffer
+     * @param signalIndex index in mSignalBuffers
+     * @param bufferIndex index of the sample interval buffer of the signal
+     * @param nextTimeout earliest timeout of all windows of the buffer, max if no window times out
+     */
+    void scheduleWindowTimeout( uint32_t signalIndex, uint32_t bufferIndex, InspectionTimestamp nextTimeout );
 
     /**
      * @brief Generate a unique Identifier of an event. The event ID
@@ -443,6 +1581,23 @@ private:
 
     void clear();
 
+    // Identifies state files written by saveState, the version changes with the file layout
+    static constexpr uint32_t STATE_FILE_MAGIC = 0x53455746; // "FWES"
+    static constexpr uint32_t STATE_FILE_VERSION = 1;
+
+    /**
+     * @brief Hash of what determines the layout of the buffers and conditions built from an inspection matrix, so
+     * that a state file is only applied to the same layout
+     */
+    static uint64_t getInspectionMatrixFingerprint( const InspectionMatrix &matrix );
+
+    /**
+     * @brief Parses the content of a state file, see restoreState
+     * @param apply false to only check that the content fits the active inspection matrix, true to apply it
+     * @return true if the content fits
+     */
+    bool readState( const uint8_t *data, size_t size, bool apply );
+
     /**
      * @brief Get an event counter since the last reset of the software.
      * @return One byte counter
@@ -454,50 +1609,129 @@ private:
         return ++counter;
     }
 
-    using SignalHistoryBufferCollection = std::unordered_map<InspectionSignalID, std::vector<SignalHistoryBuffer>>;
+    // Signal IDs up to this value are mapped to their dense index with a table, bigger ones with a hash map
+    static constexpr InspectionSignalID MAX_SIGNAL_INDEX_TABLE_ID = 65535;
+    using SignalHistoryBufferCollection = std::vector<std::vector<SignalHistoryBuffer>>;
     SignalHistoryBufferCollection
-        mSignalBuffers; /**< signal history buffer. First vector has the signalID as index. In the nested vector
-                         * the different subsampling of this signal are stored. */
+        mSignalBuffers; /**< signal history buffer. First vector has the dense signal index as index. In the nested
+                         * vector the different subsampling of this signal are stored. */
+    std::vector<uint32_t> mSignalIndexTable; /**< dense signal index by signal ID */
+    std::unordered_map<InspectionSignalID, uint32_t> mSparseSignalIndices; /**< for signal IDs not in the table */
+    struct ManifestSignalIndexEntry
+    {
+        InspectionSignalID mSignalID{ INVALID_SIGNAL_ID };
+        uint32_t mSignalIndex{ INVALID_SIGNAL_INDEX }; /**< index in mSignalBuffers */
+    };
+    std::vector<ManifestSignalIndexEntry>
+        mManifestSignalIndexTable; /**< dense signal index by the index of the signal in the Decoder Manifest */
+    std::vector<EvaluationSignal> mEvaluationSignals;
+    std::vector<Instruction> mPrograms; /**< compiled condition expressions of all conditions */
+#ifdef FWE_FEATURE_CONDITION_JIT
+    std::unique_ptr<ConditionJit> mConditionJit;
+    std::vector<ConditionJit::Function> mNativeConditions; /**< by condition index, nullptr if interpreted */
+    bool mNativeConditionsEnabled{ true };
+#endif // FWE_FEATURE_CONDITION_JIT
+    std::vector<uint8_t> mThresholdLeafValues; /**< results of the comparisons in the threshold tables */
+    std::vector<Instruction> mSharedPrograms;  /**< compiled sub expressions used multiple times */
+    std::vector<SharedExpression> mSharedExpressions;
+    std::vector<GeofenceFunctionEvaluation> mGeofenceFunctions; /**< geofence functions of all conditions */
+    std::vector<RawFrameFieldEvaluation> mRawFrameFields;       /**< raw frame fields of all conditions */
+    uint64_t mEvaluationPass{ 0 }; /**< incremented by every evaluateConditions call */
+    // Only used while compiling the conditions of a new inspection matrix
+    std::unordered_map<const ExpressionNode *, uint32_t> mExpressionUseCounts;
+    std::unordered_map<const ExpressionNode *, std::vector<uint32_t>> mSharedExpressionsOfNode;
 
     using CanFrameHistoryBufferCollection = std::vector<CanFrameHistoryBuffer>;
     CanFrameHistoryBufferCollection mCanFrameBuffers; /**< signal history buffer for raw can frames. */
+    std::unordered_map<uint64_t, std::vector<uint32_t>>
+        mCanFrameBufferIndices; /**< indices in mCanFrameBuffers by channel and frame ID, one per sample interval */
     DTCInfo mActiveDTCs;
-    SampleConsumed mActiveDTCsConsumed;
+    ConditionBitset mActiveDTCsConsumed;
 
     bool
     isActiveDTCsConsumed( uint32_t conditionId )
     {
-        return mActiveDTCsConsumed.isAlreadyConsumed( conditionId );
+        return mActiveDTCsConsumed.test( conditionId );
     }
     void
     setActiveDTCsConsumed( uint32_t conditionId, bool value )
     {
-        mActiveDTCsConsumed.setAlreadyConsumed( conditionId, value );
+        if ( conditionId == ALL_CONDITIONS )
+        {
+            value ? mActiveDTCsConsumed.set() : mActiveDTCsConsumed.reset();
+        }
+        else
+        {
+            value ? mActiveDTCsConsumed.set( conditionId ) : mActiveDTCsConsumed.reset( conditionId );
+        }
     }
 
     GeohashFunctionNode mGeohashFunctionNode;
-    // index in this bitset also the index in conditions vector.
-    std::bitset<MAX_NUMBER_OF_ACTIVE_CONDITION>
-        mConditionsWithInputSignalChanged; // bit is set if any signal or fixed window that this condition uses in its
-                                           // condition changed
-    std::bitset<MAX_NUMBER_OF_ACTIVE_CONDITION>
-        mConditionsWithConditionCurrentlyTrue; // bit is set if the condition evaluated to true the last time
-    std::bitset<MAX_NUMBER_OF_ACTIVE_CONDITION>
-        mConditionsNotTriggeredWaitingPublished; // bit is set if condition is not triggered, if bit is not set it means
-                                                 // condition is triggered and waits for its data to be sent out
+    // index in these bitsets is also the index in conditions vector, they have one bit per active condition
+    // bit is set if any signal or fixed window that this condition uses in its condition changed
+    ConditionBitset mConditionsWithInputSignalChanged;
+    // bit is set if the condition evaluated to true the last time
+    ConditionBitset mConditionsWithConditionCurrentlyTrue;
+    // bit is set if the condition is evaluated while true even without input change, because it triggers
+    // repeatedly or has side effects
+    ConditionBitset mConditionsEvaluatedWhileTrue;
+    // bit is set if condition is not triggered, if bit is not set it means condition is triggered and waits for
+    // its data to be sent out
+    ConditionBitset mConditionsNotTriggeredWaitingPublished;
 
     std::vector<ActiveCondition> mConditions;
+    ConditionStateVector mConditionStates; /**< evaluation state of each condition in mConditions */
     std::shared_ptr<const InspectionMatrix> mActiveInspectionMatrix;
 
-    std::shared_ptr<const TriggeredCollectionSchemeData> collectData( ActiveCondition &condition,
-                                                                      uint32_t conditionId,
-                                                                      InspectionTimestamp &newestSignalTimestamp );
-    uint32_t mNextConditionToCollectedIndex{ 0 };
-
-    InspectionTimestamp mNextWindowFunctionTimesOut{ 0 };
+    std::shared_ptr<TriggeredCollectionSchemeData> collectData( ActiveCondition &condition,
+                                                                uint32_t conditionId,
+                                                                InspectionTimestamp &newestSignalTimestamp );
+    // Generates the event of a due condition and collects its data
+    std::shared_ptr<TriggeredCollectionSchemeData> collectTriggeredData( uint32_t conditionIndex,
+                                                                         InspectionTimestamp currentTime );
+    // Memory of the samples of collected data, as counted by the condition profiling
+    static uint64_t getCollectedBytes( const TriggeredCollectionSchemeData &data );
+    // Merges the data of all further due conditions with the same payload parameters into sharedData
+    void collectSharedEvents( TriggeredCollectionSchemeData &sharedData, InspectionTimestamp currentTime );
+    // Adds the event and the samples of data that are not contained yet to sharedData
+    static void mergeSharedEvent( TriggeredCollectionSchemeData &sharedData,
+                                  const TriggeredCollectionSchemeData &data,
+                                  const ConditionWithCollectedData &condition );
+    static bool canSharePayload( const PassThroughMetaData &a, const PassThroughMetaData &b );
+    // Returns and forgets the first pending trace of a signal collected by the condition, 0 if there is none
+    uint32_t takePendingTrace( const ActiveCondition &condition );
+    // LatencyTracer traces of signals that were not collected yet, the oldest first
+    std::vector<std::pair<InspectionSignalID, uint32_t>> mPendingTraces;
+    static constexpr size_t MAX_PENDING_TRACES = 16;
+    // Min-heap of the triggered conditions by the time their data can be collected. A condition has at most
+    // one entry as it is not evaluated again until its data is collected
+    std::vector<PendingCollection> mPendingCollections;
+    // Periodic conditions are only in these groups and never in the bitsets of the conditions to evaluate
+    std::vector<PeriodicGroup> mPeriodicGroups;
+    // Min-heap of the window timeouts. Entries are removed only when due, so an entry is stale if its timeout
+    // differs from SignalHistoryBuffer::mNextWindowTimeout
+    std::vector<WindowTimeout> mWindowTimeouts;
     Aws::IoTFleetWise::Platform::Linux::LoggingModule mLogger;
     DataReduction mDataReduction;
     bool mSendDataOnlyOncePerCondition{ false };
+    bool mSignalSnapshotsEnabled{ false };
+    bool mSharedPayloadsEnabled{ false };
+    DeviceJitter mDeviceJitter;
+    bool mStreamingCollectionEnabled{ false };
+    bool mConditionProfilingEnabled{ false };
+    std::string mDeepHistoryDirectory;
+    bool mDeepHistoryCompressionEnabled{ false };
+    // Named variables set by the last reportHotConditions
+    std::vector<std::string> mReportedConditionVariables;
+    // Due conditions that could not share the payload, reused by collectSharedEvents
+    std::vector<PendingCollection> mNotSharedCollections;
+    size_t mSampleMemoryBudget{ DEFAULT_SAMPLE_MEMORY_BUDGET };
+    SampleMemoryUsage mSampleMemoryUsage;
+    uint64_t mInspectionMatrixFingerprint{ 0 };
+    // Number of pooled triggered data objects per condition, as the sender may still hold the previous one
+    static constexpr size_t TRIGGERED_DATA_PER_CONDITION = 2;
+    std::shared_ptr<TriggeredCollectionSchemeDataPool> mTriggeredDataPool{
+        std::make_shared<TriggeredCollectionSchemeDataPool>() };
 };
 
 } // namespace DataInspection
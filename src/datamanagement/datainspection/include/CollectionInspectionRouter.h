@@ -0,0 +1,334 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+
+#pragma once
+
+#include "CollectionInspectionWorkerThread.h"
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataInspection
+{
+using namespace Aws::IoTFleetWise::DataManagement;
+using Aws::IoTFleetWise::Platform::Linux::ThreadListeners;
+
+/**
+ * @brief Runs the inspection on multiple CollectionInspectionWorkerThreads, each evaluating a partition of the
+ * conditions of the inspection matrix.
+ *
+ * Every partition keeps own history buffers for its signals, so conditions on the same signals are put into the same
+ * partition where possible. The router thread takes the signals and raw CAN frames from the input queues and pushes
+ * them only to the partitions using them, hands the active DTCs to all partitions and merges the collected data of all
+ * partitions into the output queue. With a single partition the worker is bound directly to the queues and no router
+ * thread is started.
+ */
+class CollectionInspectionRouter : public IActiveConditionProcessor,
+                                   public IDataReadyToPublishListener,
+                                   public ThreadListeners<IDataReadyToPublishListener>
+{
+public:
+    // Limited by the bit masks of partitions in the routes
+    static constexpr size_t MAX_PARTITIONS = 64;
+    // Maximum number of elements taken from each input queue before the partitions are notified
+    static constexpr size_t MAX_ROUTE_BATCH_SIZE = CollectionInspectionWorkerThread::MAX_DRAIN_BATCH_SIZE;
+
+    CollectionInspectionRouter() = default;
+    ~CollectionInspectionRouter() override;
+
+    CollectionInspectionRouter( const CollectionInspectionRouter & ) = delete;
+    CollectionInspectionRouter &operator=( const CollectionInspectionRouter & ) = delete;
+    CollectionInspectionRouter( CollectionInspectionRouter && ) = delete;
+    CollectionInspectionRouter &operator=( CollectionInspectionRouter && ) = delete;
+
+    // Inherited from IActiveConditionProcessor
+    void onChangeInspectionMatrix( const std::shared_ptr<const InspectionMatrix> &activeConditions ) override;
+
+    // Inherited from IDataReadyToPublishListener, called by the workers
+    void onDataReadyToPublish() override;
+
+    /**
+     * @brief As soon as new data is available in any input queue call this to wakeup the thread
+     * */
+    void onNewDataAvailable();
+
+    /**
+     * @brief Signal that wakes up the thread consuming the input queues, producers can notify it directly
+     * instead of calling onNewDataAvailable.
+     * @return the signal
+     */
+    std::shared_ptr<Platform::Linux::Signal> getDataAvailableSignal();
+
+    /**
+     * @brief Lets the router and the worker threads spin and yield before they block when no new data is available.
+     * Can also be changed while the threads run.
+     * @param spinCount number of busy polls before yielding, 0 to not spin
+     * @param yieldCount number of polls with a CPU yield in between before blocking, 0 to not yield
+     */
+    void setWaitStrategy( uint32_t spinCount, uint32_t yieldCount );
+
+    /**
+     * @brief Lets the collected data of all workers reference the signal samples instead of copying them, see
+     * CollectionInspectionEngine::setSignalSnapshotsEnabled. Must be called before start.
+     * @param enabled true to collect snapshots
+     */
+    void setSignalSnapshotsEnabled( bool enabled );
+
+    /**
+     * @brief Lets conditions of the same worker that are due at the same time share one payload, see
+     * CollectionInspectionEngine::setSharedPayloadsEnabled. Must be called before start.
+     * @param enabled true to share payloads
+     */
+    void setSharedPayloadsEnabled( bool enabled );
+
+    /**
+     * @brief Spreads the first ticks of the periodic conditions by the offset of the device, see
+     * CollectionInspectionEngine::setDeviceJitter. Must be called before start.
+     * @param jitter offsets of this device
+     */
+    void setDeviceJitter( const Platform::Linux::DeviceJitter &jitter );
+
+    /**
+     * @brief Lets conditions of all workers with an afterDuration collect the samples after the trigger as they
+     * arrive, see CollectionInspectionEngine::setStreamingCollectionEnabled. Must be called before start.
+     * @param enabled true to stream the samples after the trigger
+     */
+    void setStreamingCollectionEnabled( bool enabled );
+
+    /**
+     * @brief Sets the memory for the sample history buffers of all workers, each worker gets an equal share, see
+     * CollectionInspectionEngine::setSampleMemoryBudget. Must be called before start.
+     * @param bytes the memory budget in bytes
+     */
+    void setSampleMemoryBudget( size_t bytes );
+
+    /**
+     * @brief Sets the directory for the deep history of signals of all workers, see
+     * CollectionInspectionEngine::setDeepHistoryDirectory. Must be called before start.
+     * @param directory existing directory on flash, empty to keep all samples in memory
+     */
+    void setDeepHistoryDirectory( const std::string &directory );
+
+    /**
+     * @brief Keeps the deep history of signals of all workers compressed in memory if no directory is set, see
+     * CollectionInspectionEngine::setDeepHistoryCompressionEnabled. Must be called before start.
+     * @param enabled true to compress the deep history
+     */
+    void setDeepHistoryCompressionEnabled( bool enabled );
+
+    /**
+     * @brief Sets the directory the workers keep the state of their inspection engine in across restarts, one file
+     * per worker, see CollectionInspectionEngine::saveState. Must be called before start.
+     * @param directory existing directory on flash, empty to not keep the state
+     */
+    void setStateDirectory( const std::string &directory );
+
+    /**
+     * @brief Sets the minimum time between two evaluations of the conditions of every worker, see
+     * EvaluationScheduler. Must be called before start.
+     * @param minimumSpacingMs minimum spacing in milliseconds
+     */
+    void setMinimumEvaluationSpacing( uint32_t minimumSpacingMs );
+
+    /**
+     * @brief Lets every worker profile its conditions and periodically report the most expensive ones, see
+     * CollectionInspectionEngine::reportHotConditions. Must be called before start.
+     * @param reportIntervalMs time between two reports, 0 to disable the profiling
+     * @param hotConditionCount number of conditions per report of each worker
+     */
+    void setConditionProfiling( uint32_t reportIntervalMs, uint32_t hotConditionCount );
+
+    /**
+     * @brief Lets every worker put the collected data of the express collection schemes directly into the given
+     * queue, see CollectionInspectionWorkerThread::setExpressOutput. Must be called before init.
+     * @param expressCollectedData queue consumed by the ExpressDataSender
+     */
+    void
+    setExpressOutput( std::shared_ptr<ExpressCollectedData> expressCollectedData )
+    {
+        fExpressCollectedData = std::move( expressCollectedData );
+    }
+
+    /**
+     * @brief Runs the single worker in cycles driven by the caller instead of on an own thread, see
+     * CollectionInspectionWorkerThread::setRunToCompletion. Must be called before init, init then fails with more
+     * than one partition.
+     * @param wakeup called when the worker has new input or a new inspection matrix
+     */
+    void
+    setRunToCompletion( std::function<void()> wakeup )
+    {
+        fRunToCompletionWakeup = std::move( wakeup );
+    }
+
+    /**
+     * @brief The worker whose cycles are driven by the caller
+     * @return the single worker after init in the run to completion mode, otherwise nullptr
+     */
+    CollectionInspectionWorkerThread *
+    getRunToCompletionWorker()
+    {
+        return ( fRunToCompletionWakeup && ( fPartitions.size() == 1 ) ) ? fPartitions[0].mWorker.get() : nullptr;
+    }
+
+    /**
+     * @brief Initialize the component by handing over all queues and creating the workers
+     * @param inputSignalBuffer IVehicleDataSourceConsumer instances will put relevant signals in this queue
+     * @param inputCANBuffer CANDataConsumers will put relevant raw can frames in this queue
+     * @param inputActiveDTCBuffer OBDModule DTC Circular buffer
+     * @param outputCollectedData the collected data of all partitions is put into this queue
+     * @param idleTimeMs if no new data is available sleep for this amount of milliseconds
+     * @param dataReductionProbability set to true to disable data reduction using probability
+     * @param partitionCount number of worker threads, 1 to run a single worker on the input queues directly
+     * @param partitionQueueSize size of the queues between the router and each worker
+     *
+     * @return true if initialization was successful
+     * */
+    bool init( const std::shared_ptr<SignalBuffer> &inputSignalBuffer,
+               const std::shared_ptr<CANBuffer> &inputCANBuffer,
+               const std::shared_ptr<ActiveDTCBuffer> &inputActiveDTCBuffer,
+               const std::shared_ptr<CollectedDataReadyToPublish> &outputCollectedData,
+               uint32_t idleTimeMs,
+               bool dataReductionProbability,
+               size_t partitionCount,
+               size_t partitionQueueSize );
+
+    /**
+     * @brief stops the workers and the router thread and waits until they finish
+     *
+     * @return true if the stop was successful
+     */
+    bool stop();
+
+    /**
+     * @brief starts the workers and if there are multiple partitions the router thread
+     *
+     * @return true if the start was successful
+     */
+    bool start();
+
+    /**
+     * @brief Checks that all threads are healthy and consuming data.
+     */
+    bool isAlive();
+
+    /**
+     * @brief Register a thread as a listener to the Inspection Engine events of all partitions.
+     * @param listener an InspectionEventListener instance
+     * @return true if the listener was registered at all workers
+     */
+    bool subscribeToEvents( InspectionEventListener *listener );
+
+    /**
+     * @brief unRegister a thread as a listener from the Inspection Engine events of all partitions.
+     * @param listener an InspectionEventListener instance
+     * @return true if the listener was unregistered from all workers
+     */
+    bool unSubscribeFromEvents( InspectionEventListener *listener );
+
+    /**
+     * @brief Splits the conditions of an inspection matrix into partitions of about the same number of conditions.
+     *
+     * Conditions are processed in the order of the matrix and put into the partition that already has most of their
+     * signals and CAN frames, with ties going to the partition with fewer conditions.
+     * @param matrix the inspection matrix to split, can be nullptr
+     * @param partitionCount number of partitions
+     * @return partitionCount matrices, nullptr if matrix is nullptr. The conditions point to the expression nodes of
+     * matrix, which is kept alive as long as one of the partitions
+     */
+    static std::vector<std::shared_ptr<const InspectionMatrix>> partitionInspectionMatrix(
+        const std::shared_ptr<const InspectionMatrix> &matrix, size_t partitionCount );
+
+private:
+    static constexpr uint32_t DEFAULT_THREAD_IDLE_TIME_MS = 1000;
+
+    // Bit masks of the partitions that need a signal or raw CAN frame
+    struct Routes
+    {
+        std::unordered_map<SignalID, uint64_t> mSignals;
+        std::unordered_map<uint64_t, uint64_t> mCanFrames; /**< key is built by getCanFrameKey */
+    };
+
+    struct Partition
+    {
+        std::unique_ptr<CollectionInspectionWorkerThread> mWorker;
+        std::shared_ptr<SignalBuffer> mSignalBuffer;
+        std::shared_ptr<CANBuffer> mCANBuffer;
+        std::shared_ptr<ActiveDTCBuffer> mActiveDTCBuffer;
+        std::shared_ptr<CollectedDataReadyToPublish> mCollectedData;
+    };
+
+    static inline uint64_t
+    getCanFrameKey( CANRawFrameID frameID, CANChannelNumericID channelID )
+    {
+        return ( static_cast<uint64_t>( channelID ) << 32 ) | frameID;
+    }
+
+    // The partitions of the same inspection matrix are the same after a restart, so the file is per partition
+    std::string getStateFile( size_t partitionIndex ) const;
+
+    static std::shared_ptr<const Routes> buildRoutes(
+        const std::vector<std::shared_ptr<const InspectionMatrix>> &partitions );
+
+    // Pushes an element to the queues of all partitions in the mask, returns the number of successful pushes
+    template <typename T, typename Queue>
+    size_t pushToPartitions( uint64_t partitionMask, const T &element, std::shared_ptr<Queue> Partition::*queue );
+
+    // Moves the collected data of the partitions to the output queue, returns the number of moved elements
+    uint32_t mergeCollectedData();
+
+    bool shouldStop() const;
+
+    static void doWork( void *data );
+
+    std::vector<Partition> fPartitions;
+    std::shared_ptr<SignalBuffer> fInputSignalBuffer;
+    std::shared_ptr<CANBuffer> fInputCANBuffer;
+    std::shared_ptr<ActiveDTCBuffer> fInputActiveDTCBuffer;
+    std::shared_ptr<CollectedDataReadyToPublish> fOutputCollectedData;
+    Thread fThread;
+    std::atomic<bool> fShouldStop{ false };
+    // Published by onChangeInspectionMatrix, the router thread checks for a new version in every cycle
+    VersionedSharedPtr<const Routes> fRoutes;
+    std::mutex fThreadMutex;
+    std::shared_ptr<Platform::Linux::Signal> fWait{ std::make_shared<Platform::Linux::Signal>() };
+    LoggingModule fLogger;
+    uint32_t fIdleTimeMs{ DEFAULT_THREAD_IDLE_TIME_MS };
+    uint32_t fSpinCount{ 0 };
+    uint32_t fYieldCount{ 0 };
+    bool fSignalSnapshotsEnabled{ false };
+    bool fSharedPayloadsEnabled{ false };
+    Platform::Linux::DeviceJitter fDeviceJitter;
+    bool fStreamingCollectionEnabled{ false };
+    size_t fSampleMemoryBudget{ CollectionInspectionEngine::DEFAULT_SAMPLE_MEMORY_BUDGET };
+    std::string fDeepHistoryDirectory;
+    bool fDeepHistoryCompressionEnabled{ false };
+    std::string fStateDirectory;
+    uint32_t fMinimumEvaluationSpacingMs{ EvaluationScheduler::DEFAULT_MINIMUM_SPACING_MS };
+    uint32_t fConditionProfilingReportIntervalMs{ 0 };
+    uint32_t fHotConditionCount{ 0 };
+    std::shared_ptr<ExpressCollectedData> fExpressCollectedData;
+    std::function<void()> fRunToCompletionWakeup;
+    uint64_t fDroppedElements{ 0 };
+};
+
+} // namespace DataInspection
+} // namespace IoTFleetWise
+} // namespace Aws
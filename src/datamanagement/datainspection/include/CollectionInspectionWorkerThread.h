@@ -15,12 +15,17 @@
 
 #include "ClockHandler.h"
 #include "CollectionInspectionEngine.h"
+#include "EvaluationScheduler.h"
 #include "IDataReadyToPublishListener.h"
+#include "IInspectionInput.h"
 #include "Listener.h"
 #include "LoggingModule.h"
 #include "Signal.h"
 #include "Thread.h"
 #include "Timer.h"
+#include "VersionedSharedPtr.h"
+#include <functional>
+#include <vector>
 namespace Aws
 {
 namespace IoTFleetWise
@@ -31,12 +36,18 @@ using namespace Aws::IoTFleetWise::DataManagement;
 using Aws::IoTFleetWise::Platform::Linux::ThreadListeners;
 
 class CollectionInspectionWorkerThread : public IActiveConditionProcessor,
+                                         public IInspectionInput,
                                          public ThreadListeners<IDataReadyToPublishListener>
 {
 public:
     CollectionInspectionWorkerThread() = default;
     ~CollectionInspectionWorkerThread() override;
 
+    // Maximum number of elements taken from each input queue before conditions are evaluated
+    static constexpr size_t MAX_DRAIN_BATCH_SIZE = 256;
+    // Maximum number of signals taken from the signal queue with one pop
+    static constexpr size_t SIGNAL_POP_BATCH_SIZE = 64;
+
     CollectionInspectionWorkerThread( const CollectionInspectionWorkerThread & ) = delete;
     CollectionInspectionWorkerThread &operator=( const CollectionInspectionWorkerThread & ) = delete;
     CollectionInspectionWorkerThread( CollectionInspectionWorkerThread && ) = delete;
@@ -50,6 +61,187 @@ public:
      * */
     void onNewDataAvailable();
 
+    /**
+     * @brief Signal that wakes up the thread, producers of the input queues can notify it directly
+     * instead of calling onNewDataAvailable.
+     * @return the signal
+     */
+    inline std::shared_ptr<Platform::Linux::Signal>
+    getDataAvailableSignal()
+    {
+        return fWait;
+    }
+
+    /**
+     * @brief Lets the thread spin and yield before it blocks when no new data is available.
+     * Can also be changed while the thread runs.
+     * @param spinCount number of busy polls before yielding, 0 to not spin
+     * @param yieldCount number of polls with a CPU yield in between before blocking, 0 to not yield
+     */
+    inline void
+    setWaitStrategy( uint32_t spinCount, uint32_t yieldCount )
+    {
+        fWait->setWaitStrategy( spinCount, yieldCount );
+    }
+
+    /**
+     * @brief Lets the collected data reference the signal samples instead of copying them, see
+     * CollectionInspectionEngine::setSignalSnapshotsEnabled. Must be called before start.
+     * @param enabled true to collect snapshots
+     */
+    inline void
+    setSignalSnapshotsEnabled( bool enabled )
+    {
+        fCollectionInspectionEngine.setSignalSnapshotsEnabled( enabled );
+    }
+
+    /**
+     * @brief Lets conditions due at the same time share one payload, see
+     * CollectionInspectionEngine::setSharedPayloadsEnabled. Must be called before start.
+     * @param enabled true to share payloads
+     */
+    inline void
+    setSharedPayloadsEnabled( bool enabled )
+    {
+        fCollectionInspectionEngine.setSharedPayloadsEnabled( enabled );
+    }
+
+    /**
+     * @brief Spreads the first ticks of the periodic conditions by the offset of the device, see
+     * CollectionInspectionEngine::setDeviceJitter. Must be called before start.
+     * @param jitter offsets of this device
+     */
+    inline void
+    setDeviceJitter( const Platform::Linux::DeviceJitter &jitter )
+    {
+        fCollectionInspectionEngine.setDeviceJitter( jitter );
+    }
+
+    /**
+     * @brief Lets conditions with an afterDuration collect the samples after the trigger as they arrive, see
+     * CollectionInspectionEngine::setStreamingCollectionEnabled. Must be called before start.
+     * @param enabled true to stream the samples after the trigger
+     */
+    inline void
+    setStreamingCollectionEnabled( bool enabled )
+    {
+        fCollectionInspectionEngine.setStreamingCollectionEnabled( enabled );
+    }
+
+    /**
+     * @brief Sets the memory for the sample history buffers, see CollectionInspectionEngine::setSampleMemoryBudget.
+     * Must be called before start.
+     * @param bytes the memory budget in bytes
+     */
+    inline void
+    setSampleMemoryBudget( size_t bytes )
+    {
+        fCollectionInspectionEngine.setSampleMemoryBudget( bytes );
+    }
+
+    /**
+     * @brief Sets the directory for the deep history of signals, see
+     * CollectionInspectionEngine::setDeepHistoryDirectory. Must be called before start.
+     * @param directory existing directory on flash, empty to keep all samples in memory
+     */
+    inline void
+    setDeepHistoryDirectory( const std::string &directory )
+    {
+        fCollectionInspectionEngine.setDeepHistoryDirectory( directory );
+    }
+
+    /**
+     * @brief Keeps the deep history of signals compressed in memory if no directory is set, see
+     * CollectionInspectionEngine::setDeepHistoryCompressionEnabled. Must be called before start.
+     * @param enabled true to compress the deep history
+     */
+    inline void
+    setDeepHistoryCompressionEnabled( bool enabled )
+    {
+        fCollectionInspectionEngine.setDeepHistoryCompressionEnabled( enabled );
+    }
+
+    /**
+     * @brief Sets the file the state of the inspection engine is saved to when the thread stops, and restored from
+     * with the first inspection matrix after the start, see CollectionInspectionEngine::saveState. Must be called
+     * before start.
+     * @param path file in an existing directory, empty to not keep the state
+     */
+    inline void
+    setStateFile( const std::string &path )
+    {
+        fStateFile = path;
+    }
+
+    /**
+     * @brief Sets the minimum time between two evaluations of the conditions, see EvaluationScheduler.
+     * Must be called before start.
+     * @param minimumSpacingMs minimum spacing in milliseconds
+     */
+    inline void
+    setMinimumEvaluationSpacing( uint32_t minimumSpacingMs )
+    {
+        fMinimumEvaluationSpacingMs = minimumSpacingMs;
+        fEvaluationScheduler.setMinimumSpacing( minimumSpacingMs );
+    }
+
+    /**
+     * @brief Profiles the conditions and periodically reports the most expensive ones, see
+     * CollectionInspectionEngine::reportHotConditions. Must be called before start.
+     * @param reportIntervalMs time between two reports, 0 to disable the profiling
+     * @param hotConditionCount number of conditions per report
+     */
+    inline void
+    setConditionProfiling( uint32_t reportIntervalMs, uint32_t hotConditionCount )
+    {
+        fConditionProfilingReportIntervalMs = reportIntervalMs;
+        fHotConditionCount = hotConditionCount;
+        fCollectionInspectionEngine.setConditionProfilingEnabled( reportIntervalMs > 0 );
+    }
+
+    /**
+     * @brief Puts the collected data of the express collection schemes into a separate queue instead of the output
+     * queue, see PassThroughMetaData::express. If the queue is full the data goes to the output queue. Must be
+     * called before start.
+     * @param expressCollectedData queue shared by all inspection threads, nullptr to use the output queue
+     */
+    inline void
+    setExpressOutput( std::shared_ptr<ExpressCollectedData> expressCollectedData )
+    {
+        fExpressCollectedData = std::move( expressCollectedData );
+    }
+
+    /**
+     * @brief Runs the inspection in cycles driven by the caller instead of on an own thread, e.g. by the thread
+     * receiving and decoding the CAN frames, see beginCycle and endCycle. Must be called before start.
+     * @param wakeup called instead of waking up the own thread when a new inspection matrix or new data is available,
+     * the caller should then run a cycle
+     */
+    inline void
+    setRunToCompletion( std::function<void()> wakeup )
+    {
+        fRunToCompletionWakeup = std::move( wakeup );
+    }
+
+    /**
+     * @brief Starts a cycle in the run to completion mode: picks up a new inspection matrix and reads the clock once
+     * for the input of the cycle. Only called by the thread driving the cycles.
+     * @return false if there is no inspection matrix yet, the input of the cycle is then dropped
+     */
+    bool beginCycle();
+
+    /**
+     * @brief Ends a cycle in the run to completion mode: consumes the input queues filled by the other data
+     * sources, evaluates the conditions if due and puts the collected data into the output queue. Only called by the
+     * thread driving the cycles.
+     * @return time in milliseconds until the next cycle is due, 0 if the input queues were not drained
+     */
+    uint32_t endCycle();
+
+    // Inherited from IInspectionInput, called between beginCycle and endCycle
+    void addSignals( const CollectedSignal *signals, size_t count ) override;
+    void addRawFrames( const CollectedCanFrameWithSignals *frames, size_t count ) override;
+
     /**
      * @brief Initialize the component by handing over all queues
      * @param inputSignalBuffer IVehicleDataSourceConsumer instances will put relevant signals in this queue
@@ -112,7 +304,6 @@ public:
     }
 
 private:
-    static constexpr Timestamp EVALUATE_INTERVAL_MS = 1; // Evaluate every millisecond
     static constexpr uint32_t DEFAULT_THREAD_IDLE_TIME_MS = 1000;
 
     // Stop the  thread
@@ -121,22 +312,68 @@ private:
 
     static void doWork( void *data );
 
+    // Wakes up the own thread or in the run to completion mode the thread driving the cycles
+    void wakeUp();
+
+    // Picks up a new inspection matrix, returns false if there is none yet
+    bool refreshInspectionMatrix();
+
+    // Hand one input element to the engine. Signals that are the minimum spacing newer than the last evaluated ones
+    // are evaluated directly if a condition has work to do, so that conditions still see the changes over time within
+    // a batch, e.g. rising edges
+    void addSignal( const CollectedSignal &inputSignal );
+    void addRawFrame( const CollectedCanFrameWithSignals &inputCANFrame );
+
+    // Take at most MAX_DRAIN_BATCH_SIZE elements from the input queue, return the number of taken elements
+    size_t drainSignalBuffer();
+    size_t drainCANBuffer();
+
+    // Takes the active DTCs and evaluates the conditions if due
+    void evaluateConditionsIfDue();
+
+    // Moves the collected data to the output queues, returns the maximum time until the next collection is due
+    uint32_t collectData();
+
+    // Time to idle after all input queues were drained
+    uint32_t getIdleWaitTimeMs( uint32_t waitTimeMs );
+
     CollectionInspectionEngine fCollectionInspectionEngine;
 
     std::shared_ptr<SignalBuffer> fInputSignalBuffer;
     std::shared_ptr<CANBuffer> fInputCANBuffer;
     std::shared_ptr<ActiveDTCBuffer> fInputActiveDTCBuffer;
     std::shared_ptr<CollectedDataReadyToPublish> fOutputCollectedData;
+    std::shared_ptr<ExpressCollectedData> fExpressCollectedData;
     Thread fThread;
     std::atomic<bool> fShouldStop{ false };
-    std::atomic<bool> fUpdatedInspectionMatrixAvailable{ false };
-    std::shared_ptr<const InspectionMatrix> fUpdatedInspectionMatrix;
-    std::mutex fInspectionMatrixMutex;
+    // Published by onChangeInspectionMatrix, the worker thread checks for a new version in every cycle
+    VersionedSharedPtr<const InspectionMatrix> fUpdatedInspectionMatrix;
     std::mutex fThreadMutex;
-    Platform::Linux::Signal fWait;
+    std::shared_ptr<Platform::Linux::Signal> fWait{ std::make_shared<Platform::Linux::Signal>() };
     LoggingModule fLogger;
     uint32_t fIdleTimeMs{ DEFAULT_THREAD_IDLE_TIME_MS };
+    uint32_t fMinimumEvaluationSpacingMs{ EvaluationScheduler::DEFAULT_MINIMUM_SPACING_MS };
+    EvaluationScheduler fEvaluationScheduler{ fMinimumEvaluationSpacingMs, fIdleTimeMs };
+    uint32_t fConditionProfilingReportIntervalMs{ 0 };
+    uint32_t fHotConditionCount{ 0 };
+    std::string fStateFile;
     std::shared_ptr<const Clock> fClock = ClockHandler::getClock();
+    std::function<void()> fRunToCompletionWakeup;
+    std::atomic<bool> fRunToCompletionStarted{ false };
+    // State of the inspection cycles, only used by the thread running the cycles
+    std::shared_ptr<const InspectionMatrix> fInspectionMatrix;
+    uint64_t fInspectionMatrixVersion{ 0 };
+    // The saved state is restored with the first matrix it fits, as long as no input was consumed yet
+    bool fStateRestorePending{ false };
+    // The clock is read once per cycle
+    Timestamp fCycleTime{ 0 };
+    Timestamp fLatestSignalTime{ 0 };
+    Timestamp fLastInputTimeEvaluated{ 0 };
+    bool fInputSinceLastEvaluation{ false };
+    Timestamp fLastConditionProfilingReport{ 0 };
+    uint32_t fStatisticDataSentOut{ 0 };
+    // The data sources push the signals of a frame at once, they are popped together as well
+    std::vector<CollectedSignal> fInputSignals;
 };
 
 } // namespace DataInspection
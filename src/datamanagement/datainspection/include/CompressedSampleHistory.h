@@ -0,0 +1,122 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "CollectionInspectionAPITypes.h"
+#include "MemoryAccounting.h"
+#include "TimeTypes.h"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataInspection
+{
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+/**
+ * @brief Ring of signal samples compressed in memory, the older tier of a signal history buffer whose newest
+ * samples are kept uncompressed. The in memory alternative to a DeepHistoryFile.
+ *
+ * The samples are compressed into blocks of BLOCK_SAMPLES samples like in the Gorilla time series database: the
+ * timestamps in microseconds as delta of deltas and the values XORed with the previous value, both with a
+ * variable number of bits. Samples at a fixed rate with slowly changing values need a few bits instead of the 20
+ * bytes of an uncompressed sample. Only the newest block is written to, the samples are decompressed when they
+ * are collected. Once the capacity is reached, the oldest block is dropped as a whole.
+ */
+class CompressedSampleHistory
+{
+public:
+    // Samples per block, a block is decompressed as a whole
+    static constexpr uint32_t BLOCK_SAMPLES = 256;
+
+    /**
+     * @brief Sets the capacity and drops all samples
+     * @param capacity number of newest samples to keep
+     * @return False if the capacity is 0
+     */
+    bool init( uint32_t capacity );
+
+    /**
+     * @brief Adds the newest sample, the oldest block is dropped once the capacity is exceeded
+     * @param timestamp milliseconds since epoch
+     * @param value the value
+     * @param timestampFractionUs microseconds within the millisecond of the timestamp
+     */
+    void push( uint64_t timestamp, double value, TimestampFractionUs timestampFractionUs );
+
+    /**
+     * @brief Number of samples that can be collected, at most the capacity passed to init
+     */
+    uint32_t size() const;
+
+    inline uint32_t
+    getCapacity() const
+    {
+        return mCapacity;
+    }
+
+    /**
+     * @brief Returns the memory used by the compressed blocks
+     */
+    size_t getCompressedBytes() const;
+
+    /**
+     * @brief Decompresses the newest samples and appends them, newest first
+     * @param signalID signal ID of the appended samples
+     * @param count number of samples to append, at most size()
+     * @param output the samples are appended to
+     */
+    void collectNewest( SignalID signalID, uint32_t count, std::vector<CollectedSignal> &output ) const;
+
+private:
+    struct Block
+    {
+        std::vector<uint64_t, TrackedAllocator<uint64_t, MemorySubsystem::INSPECTION>> mWords;
+        uint32_t mBitCount{ 0 };
+        uint32_t mSampleCount{ 0 };
+    };
+
+    struct DecodedSample
+    {
+        uint64_t mTimeUs{ 0 };
+        double mValue{ 0.0 };
+    };
+
+    static void appendBits( Block &block, uint64_t value, uint32_t bitCount );
+    static uint64_t readBits( const Block &block, uint32_t &position, uint32_t bitCount );
+    void appendTime( Block &block, uint64_t timeUs );
+    void appendValue( Block &block, uint64_t valueBits );
+    static void decodeBlock( const Block &block, DecodedSample *samples );
+
+    uint32_t mCapacity{ 0 };
+    uint32_t mMaxFullBlocks{ 0 };
+    std::deque<Block> mBlocks; /**< oldest first, samples are appended to the last one */
+    // State of the encoder of the last block
+    uint64_t mPreviousTimeUs{ 0 };
+    int64_t mPreviousDeltaUs{ 0 };
+    uint64_t mPreviousValueBits{ 0 };
+    uint32_t mLeadingZeros{ 0 };
+    uint32_t mTrailingZeros{ 0 };
+    bool mHasValueWindow{ false };
+};
+
+} // namespace DataInspection
+} // namespace IoTFleetWise
+} // namespace Aws
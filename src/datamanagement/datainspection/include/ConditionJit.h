@@ -0,0 +1,186 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataInspection
+{
+
+/**
+ * @brief Compiles the stack programs of the conditions to native x86-64 functions
+ *
+ * The operators, constants and jumps of a program are translated to machine code working on a stack of slots, the
+ * position of every slot is known at compile time. Leaves like signals or window functions stay calls into the
+ * engine, their operand is bound as a constant pointer. All programs added until finalize share one executable
+ * mapping, which is only writable before finalize.
+ *
+ * On other targets than x86-64 Linux isSupported returns false and nothing is compiled, so the caller keeps
+ * interpreting the programs.
+ */
+class ConditionJit
+{
+public:
+    /**
+     * @brief Value of one slot of the stack, depending on the expression either the double or the bool is used.
+     * The stack does not need to be initialized, every slot is written before it is read.
+     */
+    struct Slot
+    {
+        double mDouble;
+        bool mBool;
+    };
+
+    /**
+     * @brief Evaluates a leaf of a program
+     * @param context the context passed to the compiled function
+     * @param leaf the pointer bound to the leaf operation
+     * @param slot the slot the value of the leaf is written to
+     * @return 0 if successful, otherwise the error the compiled function returns immediately
+     */
+    using LeafFunction = uint32_t ( * )( void *context, const void *leaf, Slot *slot );
+
+    /**
+     * @brief Compiled program
+     * @param context passed to every leaf call
+     * @param stack at least the maxStackSize slots given to add, the result is in the first slot
+     * @return 0 if successful, otherwise the error of the failed leaf or FAIL operation
+     */
+    using Function = uint32_t ( * )( void *context, Slot *stack );
+
+    struct Operation
+    {
+        enum class Type : uint8_t
+        {
+            CONSTANT,      /**< push value and boolValue */
+            LEAF,          /**< push the value calculated by the leaf function for leaf */
+            JUMP_IF_FALSE, /**< if the top is false it is the result and evaluation continues at target */
+            JUMP_IF_TRUE,  /**< if the top is true it is the result and evaluation continues at target */
+            SMALLER,
+            BIGGER,
+            SMALLER_EQUAL,
+            BIGGER_EQUAL,
+            EQUAL,
+            AND,
+            OR,
+            NOT,
+            PLUS,
+            MINUS,
+            MULTIPLY,
+            DIVIDE,
+            FAIL /**< stop with error */
+        };
+        Type type{ Type::FAIL };
+        double value{ 0 };
+        bool boolValue{ false };
+        uint32_t target{ 0 }; /**< index of the operation in the same program a jump continues at */
+        uint32_t error{ 0 };
+        const void *leaf{ nullptr };
+    };
+
+    static constexpr uint32_t INVALID_HANDLE = std::numeric_limits<uint32_t>::max();
+
+    /**
+     * @param leafFunction called for every LEAF operation
+     * @param equalDistance two doubles are EQUAL if their difference is smaller than this
+     */
+    ConditionJit( LeafFunction leafFunction, double equalDistance );
+    ~ConditionJit();
+
+    ConditionJit( const ConditionJit & ) = delete;
+    ConditionJit &operator=( const ConditionJit & ) = delete;
+    ConditionJit( ConditionJit && ) = delete;
+    ConditionJit &operator=( ConditionJit && ) = delete;
+
+    /**
+     * @brief Returns if native code can be generated for this target
+     */
+    static bool isSupported();
+
+    /**
+     * @brief Generates the code of a program
+     * @param program the operations in postfix order, jumps only go forward
+     * @param maxStackSize slots available to the program
+     * @return the handle of the function or INVALID_HANDLE if the program is malformed, needs more slots or
+     * native code is not supported
+     */
+    uint32_t add( const std::vector<Operation> &program, size_t maxStackSize );
+
+    /**
+     * @brief Makes the code of all added programs executable, no programs can be added afterwards
+     * @return false if the memory could not be mapped
+     */
+    bool finalize();
+
+    /**
+     * @brief Returns the function of a program after finalize
+     * @return the function or nullptr if handle is invalid or finalize was not successful
+     */
+    Function getFunction( uint32_t handle ) const;
+
+    /**
+     * @brief Releases the code of all programs, so that new ones can be added
+     */
+    void clear();
+
+    /**
+     * @brief Returns the size of the generated code in bytes
+     */
+    size_t
+    getCodeSize() const
+    {
+        return mCode.size();
+    }
+
+private:
+    // Offsets of the bool in a slot and of the slots on the stack
+    static constexpr int32_t SLOT_SIZE = 16;
+    static constexpr int32_t BOOL_OFFSET = 8;
+
+    void emit( std::initializer_list<uint8_t> bytes );
+    void emit32( uint32_t value );
+    void emit64( uint64_t value );
+    // Emits an instruction with the memory operand [r12 + displacement], prefix and opcode given without the REX
+    void emitSlotAccess( std::initializer_list<uint8_t> prefix,
+                         uint8_t rex,
+                         std::initializer_list<uint8_t> opcode,
+                         uint8_t reg,
+                         int32_t displacement );
+    // Emits a rel32 jump to the exit of the function and records it for patching
+    void emitJumpToExit( std::initializer_list<uint8_t> opcode );
+    static bool getStackDepths( const std::vector<Operation> &program,
+                                size_t maxStackSize,
+                                std::vector<size_t> &depthBefore );
+
+    LeafFunction mLeafFunction;
+    double mEqualDistance;
+    std::vector<uint8_t> mCode;
+    std::vector<size_t> mFunctionOffsets;
+    std::vector<size_t> mExitJumps; /**< offsets of rel32 jumps to the exit of the program being generated */
+    void *mExecutable{ nullptr };
+    size_t mExecutableSize{ 0 };
+};
+
+} // namespace DataInspection
+} // namespace IoTFleetWise
+} // namespace Aws
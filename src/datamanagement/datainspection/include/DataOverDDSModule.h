@@ -14,16 +14,19 @@
 #pragma once
 
 // Includes
+#include "ArtifactUploader.h"
 #include "ClockHandler.h"
+#include "IActiveConditionProcessor.h"
 #include "InspectionEventListener.h"
 #include "LoggingModule.h"
-#include "Signal.h"
-#include "Thread.h"
+#include "SerialTaskExecutor.h"
 #include "Timer.h"
 #include "dds/DDSDataTypes.h"
 #include "dds/IDDSPublisher.h"
 #include "dds/IDDSSubscriber.h"
 #include "dds/SensorDataListener.h"
+#include <map>
+#include <set>
 
 namespace Aws
 {
@@ -39,13 +42,19 @@ using namespace Aws::IoTFleetWise::VehicleNetwork;
  * distributed over the Data Distribution Service.
  * It manages the life cycle of the data readers and data writers in
  * the configured DDS domains.
- * This module owns a thread that intercepts event triggers from the
- * inspection engine and forwards them into the underlying protocol data readers.
+ * This module owns an executor whose worker threads are shared by all sources: the
+ * event triggers from the inspection engine are forwarded to the underlying protocol
+ * data writers in a queue of the module, and each subscriber takes and persists its
+ * data in its own queues. So the number of threads does not grow with the number of
+ * sources and an idle source costs no thread.
  * It also intercepts notifications from the protocol data writer when data
  * has been received from the network and triggers the cloud offboardconnectivity
  * in order to upload it to IoTFleetWise's Data Plane.
+ * If a source keeps a pre-trigger buffer, the data before the event is taken from it
+ * instead of being requested from the source. The artifacts written by the sources are
+ * handed to the artifact uploader, if one is set.
  */
-class DataOverDDSModule : public InspectionEventListener, public SensorDataListener
+class DataOverDDSModule : public InspectionEventListener, public SensorDataListener, public IActiveConditionProcessor
 {
 public:
     DataOverDDSModule() = default;
@@ -66,6 +75,14 @@ public:
      */
     bool init( const DDSDataSourcesConfig &ddsDataSourcesConfig );
 
+    /**
+     * @brief Sets the uploader the artifacts of the sources are handed to once they are written. On connect the
+     * uploads interrupted by a restart are resumed from the cache locations of the sources. Without an uploader the
+     * artifacts stay on disk. Must be called before connect().
+     * @param artifactUploader the uploader, started by the caller
+     */
+    void setArtifactUploader( std::shared_ptr<DataManagement::ArtifactUploader> artifactUploader );
+
     /**
      * @brief Connects the DDS readers/writers to their corresponding DDS Domains.
      * then  start monitoring the DDS Traffic.
@@ -94,49 +111,50 @@ public:
 
     /**
      * @brief Overwrite of SensorDataListener notification. Upon a reception of this event,
-     * the corresponding metadata is processed.
+     * the artifact is queued for upload.
      * @param artifactMetadata The artifact metadata.
      */
     void onSensorArtifactAvailable( const SensorArtifactMetadata &artifactMetadata ) override;
 
+    /**
+     * @brief Overwrite of IActiveConditionProcessor notification. The pre-trigger buffer of each source
+     * is sized to keep the longest time window any active condition collects from that source.
+     * @param activeConditions all currently active conditions
+     */
+    void onChangeInspectionMatrix( const std::shared_ptr<const InspectionMatrix> &activeConditions ) override;
+
 private:
-    // Start the  worker thread
-    bool start();
-    // Stop the worker thread
-    bool stop();
-    // Intercepts stop signals
-    bool shouldStop() const;
+    // Number of worker threads of the executor, one per core
+    static uint32_t getWorkerCount();
 
     /**
-     * @brief Work function of the module.
-     * The thread is typically waiting on a conditional variable and wakes up upon :
-     * 1- The inspection Engine raises an event of interest, and so rich sensor data is requested
-     * from the DDS network.
-     * 2- A DDS node fetches an artifact from the network ( e.g. Camera snapshot ) and shares the
-     * artifact metadata with the module. In this case, the artifact is processed e.g. shared with
-     * the cloud.
+     * @brief Requests the data of the event from the sources, preferring their pre-trigger buffers.
+     * Runs on the event queue of the executor.
+     * @param eventMetadata one item for each source we want to request e.g. multiple cameras.
      */
-    static void doWork( void *data );
+    void requestEventData( const std::vector<EventMetadata> &eventMetadata );
+
+    // Events waiting to be forwarded to the sources
+    static constexpr size_t EVENT_QUEUE_SIZE = 16;
 
-    Thread mThread;
-    std::atomic<bool> mShouldStop{ false };
-    std::atomic<bool> mNewEventReceived{ false };
+    std::shared_ptr<SerialTaskExecutor> mExecutor;
+    SerialTaskExecutor::QueueId mEventQueue{ SerialTaskExecutor::INVALID_QUEUE_ID };
+    std::atomic<bool> mConnected{ false };
     mutable std::mutex mThreadMutex;
     LoggingModule mLogger;
     std::shared_ptr<const Clock> mClock = ClockHandler::getClock();
-    Platform::Linux::Signal mWait;
     Timer mTimer;
-    // For Subscriber, we don't need to track the sourceID.
-    std::vector<DDSSubscriberPtr> mSubscribers;
+    // For Subscriber, we need to track the sourceID to take the data of an event from its pre-trigger buffer.
+    std::map<uint32_t, DDSSubscriberPtr> mSubscribers;
     // For Publisher, we need to track the sourceID as we need to know which Publisher we
     // need to invoke upon a new event.
     std::map<uint32_t, DDSPublisherPtr> mPublishers;
-    mutable std::mutex mEventMetaMutex;
+    std::shared_ptr<DataManagement::ArtifactUploader> mArtifactUploader;
+    // Where the sources write their artifacts, to resume the interrupted uploads
+    std::set<std::string> mCacheLocations;
     // To protect against race condition during find and emplace ops on the
     // Pub/Sub containers.
     mutable std::mutex mPubSubMutex;
-    // One item for each source we want to request e.g. multiple cameras.
-    std::vector<EventMetadata> mEventMetatdata;
 };
 } // namespace DataInspection
 } // namespace IoTFleetWise
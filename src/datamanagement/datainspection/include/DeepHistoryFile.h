@@ -0,0 +1,141 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "LoggingModule.h"
+#include "TimeTypes.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataInspection
+{
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+/**
+ * @brief Ring of signal samples in a memory mapped file, the older tier of a signal history buffer whose newest
+ * samples are kept in memory.
+ *
+ * Samples are pushed one by one into a block in memory. Only full blocks are copied into the mapping, so the file
+ * is written in large sequential pieces, which is what flash handles best. The file only backs the memory of this
+ * process: it is removed from the directory right after it was created and its content is lost on restart.
+ */
+class DeepHistoryFile
+{
+public:
+    // Samples per block written to the file at once
+    static constexpr uint32_t BLOCK_SAMPLES = 512;
+
+    struct Sample
+    {
+        uint64_t timestamp; /**< milliseconds since epoch */
+        double value;
+        TimestampFractionUs timestampFractionUs;
+        uint16_t reserved0;
+        uint32_t reserved1;
+    };
+
+    DeepHistoryFile() = default;
+    ~DeepHistoryFile();
+
+    DeepHistoryFile( const DeepHistoryFile & ) = delete;
+    DeepHistoryFile &operator=( const DeepHistoryFile & ) = delete;
+    DeepHistoryFile( DeepHistoryFile && ) = delete;
+    DeepHistoryFile &operator=( DeepHistoryFile && ) = delete;
+
+    /**
+     * @brief Creates and maps the file. The space is allocated upfront, so that a full flash is detected here and
+     * not when a block is written.
+     * @param directory existing directory on flash
+     * @param capacity number of samples to keep, rounded up to whole blocks
+     * @return True if successful
+     */
+    bool open( const std::string &directory, uint32_t capacity );
+
+    /**
+     * @brief Adds the newest sample, the oldest one is overwritten once the file is full
+     */
+    inline void
+    push( uint64_t timestamp, double value, TimestampFractionUs timestampFractionUs )
+    {
+        auto &sample = mStagingBlock[mStagedSamples];
+        sample.timestamp = timestamp;
+        sample.value = value;
+        sample.timestampFractionUs = timestampFractionUs;
+        mStagedSamples++;
+        if ( mStagedSamples == BLOCK_SAMPLES )
+        {
+            writeStagingBlock();
+        }
+    }
+
+    /**
+     * @brief Number of samples that can be read with get, at most the capacity passed to open
+     */
+    inline uint32_t
+    size() const
+    {
+        auto samples = static_cast<uint64_t>( mStoredBlocks ) * BLOCK_SAMPLES + mStagedSamples;
+        return static_cast<uint32_t>( std::min<uint64_t>( samples, mCapacity ) );
+    }
+
+    /**
+     * @brief Reads a sample
+     * @param index 0 for the newest sample, must be smaller than size()
+     */
+    inline const Sample &
+    get( uint32_t index ) const
+    {
+        if ( index < mStagedSamples )
+        {
+            return mStagingBlock[mStagedSamples - 1 - index];
+        }
+        index -= mStagedSamples;
+        // Blocks are filled oldest sample first
+        auto block = ( mNextBlock + mBlockCount - 1 - ( index / BLOCK_SAMPLES ) ) % mBlockCount;
+        auto offset = BLOCK_SAMPLES - 1 - ( index % BLOCK_SAMPLES );
+        return mSamples[( static_cast<size_t>( block ) * BLOCK_SAMPLES ) + offset];
+    }
+
+    inline uint32_t
+    getCapacity() const
+    {
+        return mCapacity;
+    }
+
+private:
+    void writeStagingBlock();
+    void close();
+
+    LoggingModule mLogger;
+    Sample *mSamples{ nullptr };
+    size_t mMappedBytes{ 0 };
+    uint32_t mCapacity{ 0 };
+    uint32_t mBlockCount{ 0 };
+    uint32_t mNextBlock{ 0 };    /**< block of the file the staging block is written to */
+    uint32_t mStoredBlocks{ 0 }; /**< blocks of the file that hold samples */
+    uint32_t mStagedSamples{ 0 };
+    std::array<Sample, BLOCK_SAMPLES> mStagingBlock{};
+};
+
+} // namespace DataInspection
+} // namespace IoTFleetWise
+} // namespace Aws
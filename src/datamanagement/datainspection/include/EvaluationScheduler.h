@@ -0,0 +1,131 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+#include "TimeTypes.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataInspection
+{
+using Aws::IoTFleetWise::Platform::Linux::Timestamp;
+
+/**
+ * @brief Decides when the inspection worker evaluates the conditions.
+ *
+ * An evaluation is due when the engine reports a condition to evaluate or a deadline that has passed, see
+ * CollectionInspectionEngine::getNextEvaluationTime. Consecutive evaluations are at least the minimum spacing
+ * apart, so that bursts of input are evaluated together, and if nothing is due the conditions are still
+ * evaluated once every idle time.
+ *
+ * The time from receiving an input until the evaluation that sees it is recorded in a histogram.
+ */
+class EvaluationScheduler
+{
+public:
+    static constexpr uint32_t DEFAULT_MINIMUM_SPACING_MS = 1;
+    // Latency buckets: 0 ms, below 2 ms, below 4 ms, ..., below 64 ms, 64 ms and more
+    static constexpr size_t LATENCY_BUCKETS = 8;
+    static constexpr Timestamp NO_DEADLINE = std::numeric_limits<Timestamp>::max();
+
+    using LatencyHistogram = std::array<uint64_t, LATENCY_BUCKETS>;
+
+    /**
+     * @param minimumSpacingMs minimum time between two evaluations
+     * @param idleTimeMs maximum time between two evaluations while there is an inspection matrix
+     */
+    EvaluationScheduler( uint32_t minimumSpacingMs, uint32_t idleTimeMs );
+
+    /**
+     * @brief Changes the minimum time between two evaluations
+     */
+    void
+    setMinimumSpacing( uint32_t minimumSpacingMs )
+    {
+        mMinimumSpacingMs = minimumSpacingMs;
+    }
+
+    /**
+     * @brief Records an input handed to the engine that is not evaluated yet
+     * @param receiveTime time the input was received
+     */
+    void
+    onInput( Timestamp receiveTime )
+    {
+        mOldestPendingInput = std::min( mOldestPendingInput, receiveTime );
+    }
+
+    /**
+     * @brief Whether the conditions are to be evaluated now
+     * @param currentTime now
+     * @param nextEvaluationTime time the engine next has work to do, NO_DEADLINE if none
+     */
+    bool isEvaluationDue( Timestamp currentTime, Timestamp nextEvaluationTime ) const;
+
+    /**
+     * @brief Records that the conditions were evaluated, which sees all inputs recorded so far
+     */
+    void onEvaluated( Timestamp currentTime );
+
+    /**
+     * @brief Time until the next evaluation is due
+     * @param currentTime now
+     * @param nextEvaluationTime time the engine next has work to do, NO_DEADLINE if none
+     * @return milliseconds to wait, at most the idle time
+     */
+    uint32_t getWaitTimeMs( Timestamp currentTime, Timestamp nextEvaluationTime ) const;
+
+    /**
+     * @brief Number of inputs per latency bucket, counted since construction. Every evaluation is counted once
+     * with the latency of the oldest input it sees.
+     */
+    const LatencyHistogram &
+    getLatencyHistogram() const
+    {
+        return mLatencyHistogram;
+    }
+
+    /**
+     * @brief Adds the evaluations counted since the last call to the named trace variables
+     * inspectionLatency_<bucket>, so that the distribution of all workers is published
+     */
+    void publishLatencyHistogram();
+
+    static size_t getLatencyBucket( Timestamp latencyMs );
+
+    static std::string getLatencyBucketName( size_t bucket );
+
+private:
+    Timestamp getEarliestEvaluationTime( Timestamp nextEvaluationTime ) const;
+
+    uint32_t mMinimumSpacingMs;
+    uint32_t mIdleTimeMs;
+    Timestamp mLastEvaluation{ 0 };
+    bool mEvaluated{ false };
+    Timestamp mOldestPendingInput{ NO_DEADLINE };
+    LatencyHistogram mLatencyHistogram{};
+    LatencyHistogram mPublishedLatencyHistogram{};
+};
+
+} // namespace DataInspection
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -0,0 +1,66 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+#include "GeofenceIndex.h"
+#include "ICollectionScheme.h"
+#include <memory>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataInspection
+{
+
+using namespace Aws::IoTFleetWise::DataManagement;
+
+/**
+ * @brief This is the Geofence Function Node module that can be used as part of the AST tree to
+ * evaluate whether the vehicle is inside any of a set of geofences.
+ *
+ * The result is cached, so looking up the fences is only done when the position has changed.
+ */
+class GeofenceFunctionNode
+{
+public:
+    /**
+     * @param geofences built spatial index over the fences. If nullptr the node always evaluates to false
+     */
+    explicit GeofenceFunctionNode( std::shared_ptr<const GeofenceIndex> geofences );
+
+    /**
+     * @brief Checks whether the position is inside any of the geofences
+     *
+     * @param lat: latitude from GPS
+     * @param lon: longitude from GPS
+     * @param gpsUnitType: The GPS signal latitude / longitude unit type
+     * @return True if the position is inside at least one of the geofences
+     */
+    bool evaluateGeofence( double lat, double lon, GeohashFunction::GPSUnitType gpsUnitType );
+
+private:
+    std::shared_ptr<const GeofenceIndex> mGeofences;
+    /**
+     * @brief Position of the last evaluation as given to evaluateGeofence and its result
+     */
+    double mLastLatitude{ 0 };
+    double mLastLongitude{ 0 };
+    GeohashFunction::GPSUnitType mLastGpsUnitType{ GeohashFunction::GPSUnitType::DECIMAL_DEGREE };
+    bool mLastResultValid{ false };
+    bool mLastResult{ false };
+};
+} // namespace DataInspection
+} // namespace IoTFleetWise
+} // namespace Aws
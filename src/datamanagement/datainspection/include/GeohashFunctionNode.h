@@ -46,6 +46,7 @@ public:
      * @brief This function calculates current Geohash for the vehicle and compare it against
      * the previous Geohash.
      * The Geohash will always be calculated at the maximum precision defined in Geohash module.
+     * As long as the position stays within the cell of the last calculated Geohash the encoding is skipped.
      * However, the comparison between current and previous Geohash is at the precision specified at the input.
      *
      * For Instance: Geohash calculated previously at 9q9hwg28j and currently at 9q9hwheb9. If the precision is
@@ -74,7 +75,6 @@ public:
      */
     bool hasNewGeohash() const;
 
-private:
     /**
      * @brief Utility function to convert different GPS unit to Decimal Degree
      *
@@ -82,11 +82,22 @@ private:
      */
     static double convertToDecimalDegree( double val, GeohashFunction::GPSUnitType gpsUnitType );
 
+private:
+
     /**
      * @brief This is the Geohash in String format holding the latest calculated geohash
      */
     GeohashInfo mGeohashInfo;
 
+    /**
+     * @brief Edges of the cell of mGeohashInfo.mGeohashString, only valid if mCellValid is true
+     */
+    double mCellLatMin{ 0 };
+    double mCellLatMax{ 0 };
+    double mCellLonMin{ 0 };
+    double mCellLonMax{ 0 };
+    bool mCellValid{ false };
+
     /**
      * @brief If this flag is true, it indicates a Geohash has been generated but not read yet.
      */
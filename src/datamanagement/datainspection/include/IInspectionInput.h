@@ -0,0 +1,51 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+#include "CollectionInspectionAPITypes.h"
+#include <cstddef>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataInspection
+{
+
+/**
+ * @brief Takes decoded signals and raw CAN frames directly from the thread that decoded them, without the Signal
+ * Buffer and the CAN Buffer in between
+ */
+class IInspectionInput
+{
+public:
+    virtual ~IInspectionInput() = default;
+
+    /**
+     * @brief Hands over the signals decoded from the frames of a burst
+     * @param signals the decoded signals in the order of their frames
+     * @param count number of signals
+     */
+    virtual void addSignals( const CollectedSignal *signals, size_t count ) = 0;
+
+    /**
+     * @brief Hands over the raw CAN frames of a burst, with the signals decoded from them
+     * @param frames the raw frames in the order they were received
+     * @param count number of frames
+     */
+    virtual void addRawFrames( const CollectedCanFrameWithSignals *frames, size_t count ) = 0;
+};
+} // namespace DataInspection
+} // namespace IoTFleetWise
+} // namespace Aws
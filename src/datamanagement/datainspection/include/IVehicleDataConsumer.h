@@ -17,6 +17,7 @@
 
 #include "CollectionInspectionAPITypes.h"
 #include "IDecoderDictionary.h"
+#include "Signal.h"
 #include "businterfaces/AbstractVehicleDataSource.h"
 #include <iostream>
 
@@ -38,7 +39,7 @@ constexpr VehicleDataConsumerID INVALID_DATA_CONSUMER_ID = 0;
  * the Vehicle Data Source and decodes/filters the data according to the decoder dictionary.
  * The result will be put into three output buffers for inspection engine to process in a fanout
  * fashion.
- * The life cycle of this Consumer is fully managed by the VehicleDataSourceBinder worker thread.
+ * The life cycle of this Consumer is fully managed by the VehicleDataSourceBinder.
  * Only instantiation is allowed on startup.
  */
 class IVehicleDataConsumer
@@ -111,6 +112,27 @@ public:
         mInputBufferPtr = std::move( producerBufferPtr );
     }
 
+    /**
+     * @brief Signal that wakes up the consumer, the data source notifies it after pushing to the input buffer.
+     * @return the signal, nullptr if the consumer only polls its input buffer
+     */
+    virtual std::shared_ptr<Platform::Linux::Signal>
+    getDataAvailableSignal()
+    {
+        return nullptr;
+    }
+
+    /**
+     * @brief Set the signal to notify after new data was pushed to the Signal Output Buffer.
+     * Must be called before connect.
+     * @param outputDataAvailableSignal signal of the Signal Output Buffer consumer
+     */
+    inline void
+    setOutputDataAvailableSignal( std::shared_ptr<Platform::Linux::Signal> outputDataAvailableSignal )
+    {
+        mOutputDataAvailableSignal = std::move( outputDataAvailableSignal );
+    }
+
     /**
      * @return the unique ID of the consumer.
      */
@@ -157,6 +179,8 @@ protected:
     std::shared_ptr<const DecoderDictionary> mDecoderDictionaryConstPtr;
     // Signal Buffer shared pointer
     SignalBufferPtr mSignalBufferPtr;
+    // Notified after data was pushed to the Signal Buffer, can be nullptr
+    std::shared_ptr<Platform::Linux::Signal> mOutputDataAvailableSignal;
     VehicleDataConsumerID mID;
     VehicleDataSourceType mType;
     VehicleDataSourceIfName mIfName;
@@ -13,6 +13,7 @@
 
 #pragma once
 
+#include "datatypes/ImageCaptureOptions.h"
 #include <string>
 #include <vector>
 
@@ -37,6 +38,8 @@ namespace DataInspection
  * any other unique identifier that is known as a source of vehicle data across the system.
  * @param negativeOffsetMs amount of time in milliseconds before the event happened.
  * @param positiveOffsetMs amount of time in milliseconds after the event happened.
+ * @param imageType image type the source provides its frames in, for image sources.
+ * @param captureOptions selection and re-encoding of the frames before they are persisted, for image sources.
  */
 struct EventMetadata
 
@@ -53,6 +56,8 @@ struct EventMetadata
     uint32_t sourceID{ 0 };
     uint32_t negativeOffsetMs{ 0 };
     uint32_t positiveOffsetMs{ 0 };
+    uint32_t imageType{ 0 };
+    VehicleNetwork::ImageCaptureOptions captureOptions;
 };
 
 class InspectionEventListener
@@ -0,0 +1,77 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "OBDDataTypes.h"
+#include "datatypes/VehicleDataSourceTypes.h"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataInspection
+{
+using namespace Aws::IoTFleetWise::DataManagement;
+using namespace Aws::IoTFleetWise::VehicleNetwork;
+
+/**
+ * @brief VIN, ECUs and supported PIDs of the vehicle, persisted so that the PID requests start on the first cycle
+ * after a restart.
+ *
+ * The cache is keyed by the VIN: it is only valid as long as the vehicle reports the same VIN, which the
+ * OBDOverCANModule checks after the first requests.
+ */
+class OBDECUCache
+{
+public:
+    /**
+     * @brief Version of the binary format, caches of other versions are ignored
+     */
+    static constexpr uint32_t VERSION = 1;
+
+    struct ECU
+    {
+        ECUType type{ ECUType::OTHER };
+        uint32_t requestCANId{ 0 };
+        uint32_t responseCANId{ 0 };
+        std::map<SID, SupportedPIDs> supportedPIDs;
+    };
+
+    std::string vin;
+    std::vector<ECU> ecus;
+
+    /**
+     * @brief Serializes the cache into a versioned binary with a CRC32C
+     * @param output the binary, replaced
+     */
+    void serialize( std::vector<uint8_t> &output ) const;
+
+    /**
+     * @brief Validates and loads a binary written by serialize()
+     *
+     * @param data pointer to the binary
+     * @param size size of the binary
+     * @return false if the binary is corrupted or of another version
+     */
+    bool deserialize( const uint8_t *data, size_t size );
+};
+
+} // namespace DataInspection
+} // namespace IoTFleetWise
+} // namespace Aws
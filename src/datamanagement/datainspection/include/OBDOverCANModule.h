@@ -15,9 +15,12 @@
 
 // Includes
 #include "ClockHandler.h"
+#include "FastClock.h"
+#include "ICacheAndPersist.h"
 #include "CollectionInspectionAPITypes.h"
 #include "IActiveConditionProcessor.h"
 #include "IActiveDecoderDictionaryListener.h"
+#include "InstrumentedMutex.h"
 #include "LoggingModule.h"
 #include "OBDDataDecoder.h"
 #include "OBDDataTypes.h"
@@ -27,7 +30,12 @@
 #include "Timer.h"
 #include "businterfaces/ISOTPOverCANSenderReceiver.h"
 #include <boost/lockfree/spsc_queue.hpp>
+#include <functional>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <poll.h>
+#include <unordered_map>
 
 namespace Aws
 {
@@ -38,6 +46,7 @@ namespace DataInspection
 using namespace Aws::IoTFleetWise::Platform::Linux;
 using namespace Aws::IoTFleetWise::VehicleNetwork;
 using namespace Aws::IoTFleetWise::DataManagement;
+using namespace Aws::IoTFleetWise::Platform::Linux::PersistencyManagement;
 
 /**
  * @brief This module handles the collection of Emission related data and DTC codes
@@ -67,6 +76,8 @@ public:
      * @param dtcRequestIntervalSeconds Interval in seconds used to schedule DTC requests
      * @param useExtendedIDs use Extended CAN IDs on TX and RX side.
      * @param hasTransmissionECU specifies whether the vehicle has a Transmission ECU
+     * @param discoverECUs if true, further ECUs answering a functional broadcast request are polled as well
+     * @param persistency if set, the VIN, ECUs and supported PIDs are cached there and reused after a restart
      * @return True if successful. False if both pidRequestIntervalSeconds
      * and dtcRequestIntervalSeconds are zero i.e. no collection
      *
@@ -77,17 +88,19 @@ public:
                const uint32_t &pidRequestIntervalSeconds,
                const uint32_t &dtcRequestIntervalSeconds = 0,
                const bool &useExtendedIDs = false,
-               const bool &hasTransmissionECU = false );
+               const bool &hasTransmissionECU = false,
+               const bool &discoverECUs = false,
+               const std::shared_ptr<ICacheAndPersist> &persistency = nullptr );
 
     /**
-     * @brief Creates an ISO-TP connection to the Engine/Transmission ECUs. Starts the
+     * @brief Creates an ISO-TP connection to each configured ECU. Starts the
      * Keep Alive cyclic thread.
      * @return True if successful. False otherwise.
      */
     bool connect();
 
     /**
-     * @brief Closes the ISO-TP connection to the Engine/Transmission ECUs. Stops the
+     * @brief Closes the ISO-TP connection to each ECU. Stops the
      * Keep Alive cyclic tread.
      * @return True if successful. False otherwise.
      */
@@ -113,11 +126,16 @@ public:
      * @brief Returns the PIDs that are to be requested from ECU
      * @param sid the SID e.g. Mode 1
      * @param supportedPIDs container where the result will be copied
-     * @param type the ECU Type e.g. Engine , Transmission
+     * @param type the ECU Type e.g. Engine , Transmission. For OTHER the first discovered ECU is used
      * @return True if successful. False if the SID was not processed.
      */
     bool getPIDsToRequest( const SID &sid, const ECUType &type, SupportedPIDs &supportedPIDs ) const;
 
+    /**
+     * @brief Returns the number of ECUs polled, including the ECUs found by the functional broadcast
+     */
+    size_t getECUCount() const;
+
     /**
      * @brief Returns the VIN received in this OBD Session
      * @param[out] vin output string
@@ -160,49 +178,147 @@ private:
     // Intercepts stop signals.
     bool shouldStop() const;
     // Main worker function. The following operations are coded by the function
-    // 1- Sends  Supported PIDs request to Engine and TX ECUs
-    // 2- Stores the supported PIDs
+    // 1- Discovers the ECUs answering a functional broadcast, if enabled
+    // 2- Sends  Supported PIDs request to all ECUs
+    // 3- Stores the supported PIDs
     // Cyclically:
-    // 3- Send  PID requests ( up to 6 at a time )
-    // 4- waits for the response from the ECU
-    // 5- If an RX PDU arrives, decodes the value and puts the result to the
+    // 4- Send requests for the due PIDs ( up to 6 at a time ) to all ECUs concurrently
+    // 5- waits for the responses of all ECUs in a single poll
+    // 6- If an RX PDU arrives, decodes the value and puts the result to the
     // output buffer
     static void doWork( void *data );
 
-    // Issues a supported PID request to the specific ECU and SID
-    bool requestSupportedPIDs( const SID &sid, ISOTPOverCANSenderReceiver &isoTPSendReceive );
+    /**
+     * @brief A request PDU and the handler of its response. The handler gets the ECU index and the request, so that
+     * handlers which only capture this are stored by std::function without allocation.
+     */
+    struct ECURequest
+    {
+        std::vector<uint8_t> pdu;
+        std::function<void( size_t ecuIndex, const ECURequest &request, const uint8_t *response, size_t size )>
+            onResponse;
+    };
+
+    /**
+     * @brief ISO-TP session with one ECU together with the PIDs it supports
+     */
+    struct ECUSession
+    {
+        ECUType type{ ECUType::OTHER };
+        ISOTPOverCANSenderReceiver isoTPSendReceive;
+        // Supported PIDs of the ECU
+        std::map<SID, SupportedPIDs> supportedPIDs;
+        // The PIDs to request from the ECU. It will be the common PIDs that are required by
+        // decoder dictionary as well as supported by ECU
+        std::map<SID, std::vector<PID>> pidsToRequest;
+        // Set while the supported PIDs are taken from the cache and were not yet confirmed by the ECU
+        bool supportedPIDsFromCache{ false };
+        // Requests of the current round, only the first requestCount entries are valid. The entries are reused by
+        // the next rounds, so their PDUs keep their capacity.
+        std::vector<ECURequest> requests;
+        size_t requestCount{ 0 };
+        // Index of the outstanding request, requestCount once the round is done
+        size_t nextRequest{ 0 };
+        // Deadline of the outstanding request
+        Timestamp deadline{ 0 };
+        // Receive buffer of MAX_PDU_SIZE bytes, allocated with the session
+        std::vector<uint8_t> responseBuffer;
+    };
+
+    // Creates the session with the ECU. The session is only connected if connectSession is true.
+    bool addECU( ECUType type,
+                 uint32_t requestCANId,
+                 uint32_t responseCANId,
+                 const std::string &gatewayCanInterfaceName,
+                 bool connectSession );
+
+    // Sends a functional Supported PIDs request as a single CAN frame and adds a session for every
+    // ECU that responds and is not yet known.
+    void discoverECUs();
+
+    // Starts a new round of requests, without releasing the request entries of the ECUs
+    void clearRequests();
+
+    // Returns the next request entry of the ECU for the current round, with an empty PDU
+    static ECURequest &addRequest( ECUSession &ecu );
+
+    // Sends the requests of the current round of all ECUs, at most one outstanding request per ECU. The responses of
+    // all ECUs are multiplexed through one poll, and a request not answered within the P2 timeout of its ECU is
+    // dropped. Once the buffers have grown to the size of a round, nothing is allocated.
+    void sendReceiveConcurrently();
+
+    // Requests the supported PIDs from all ECUs that did not report them yet. If revalidateCache is true, the ECUs
+    // whose supported PIDs were loaded from the cache are requested instead.
+    void requestSupportedPIDs( const SID &sid, bool revalidateCache );
+
+    // Requests the due PIDs from all ECUs that support them ( up to 6 PIDs per request ) and pushes the
+    // decoded signals. duePIDs must be sorted.
+    void requestEmissionPIDs( const SID &sid, const std::vector<PID> &duePIDs );
+
+    /**
+     * @brief Next request time and request interval of a PID
+     */
+    struct PIDSchedule
+    {
+        uint32_t intervalMs{ 0 };
+        Timestamp nextRequestTime{ 0 };
+    };
+
+    // Rebuilds the schedule of all PIDs of the decoder dictionary. A PID is requested at the smallest
+    // minimumSampleIntervalMs of its signals in the inspection matrix, or at the PID request interval if none of its
+    // signals has one. PIDs with the same interval are packed into groups of up to 6 PIDs, and the groups are spread
+    // across the interval so that the bus load is balanced.
+    void updatePIDSchedule( Timestamp now );
+
+    // Fills duePIDs with the sorted PIDs that are due at the given time and reschedules them
+    void popDuePIDs( Timestamp now, std::vector<PID> &duePIDs );
 
-    // Receives the supported PID request to the specific ECU and SID
-    bool receiveSupportedPIDs( const SID &sid,
-                               ISOTPOverCANSenderReceiver &isoTPSendReceive,
-                               SupportedPIDs &supportedPIDs );
     // Update the PID Request List with PIDs that are common between decoder dictionary and the PIDs supported by ECU
-    void updatePIDRequestList( const SID &sid,
-                               const ECUType &type,
-                               std::map<SID, SupportedPIDs> &supportedPIDs,
-                               std::map<SID, std::vector<PID>> &pidsToRequestPerService );
-    // Request a set of PIDs from one ECU ( up to 6 PIDs at a time )
-    bool requestPIDs( const SID &sid, const std::vector<PID> &pids, ISOTPOverCANSenderReceiver &isoTPSendReceive );
-    bool receivePIDs( const SID &sid,
-                      const std::vector<PID> &pids,
-                      ISOTPOverCANSenderReceiver &isoTPSendReceive,
-                      EmissionInfo &info );
-
-    bool requestReceiveSupportedPIDs( const SID &sid,
-                                      ISOTPOverCANSenderReceiver &isoTPSendReceive,
-                                      SupportedPIDs &supportedPIDs );
-
-    bool requestReceiveEmissionPIDs( const SID &sid,
-                                     const SupportedPIDs &pids,
-                                     ISOTPOverCANSenderReceiver &isoTPSendReceive,
-                                     EmissionInfo &info );
+    void updatePIDRequestList( const SID &sid, ECUSession &ecu );
+
+    // Pushes the decoded signals to the Signal Buffer at once
+    void pushDecodedSignals( const EmissionInfo &info, Timestamp receptionTime );
+
+    /**
+     * @brief DIDs of one ECU in the UDS decoder dictionary
+     */
+    struct UDSDataIdentifiers
+    {
+        // DIDs read with ReadDataByIdentifier and their decoding rules
+        std::vector<std::pair<DID, CANMessageFormat>> polledDIDs;
+        // Low bytes of the periodic DIDs per ReadDataByPeriodicIdentifier transmission mode
+        std::map<uint8_t, std::vector<uint8_t>> periodicDIDs;
+    };
+
+    // Builds the DIDs per ECU from the UDS decoder dictionary
+    static std::map<uint32_t, UDSDataIdentifiers> toUDSDataIdentifiers( const CANDecoderDictionary &dictionary );
+
+    // Requests the DIDs of the UDS decoder dictionary from their ECUs with ReadDataByIdentifier and pushes the
+    // decoded signals
+    void requestDataIdentifiers();
+
+    // Starts or stops the streaming of the periodic DIDs with ReadDataByPeriodicIdentifier. The periodic responses are
+    // not handled by this module, they are decoded by the CAN data source like broadcast frames.
+    void configurePeriodicDataIdentifiers( bool start );
 
     // For SID 9/pid 0x02
     bool requestReceiveVIN( std::string &vin );
-    // For SID 3 and 7
-    bool requestDTCs( const SID &sid, ISOTPOverCANSenderReceiver &isoTPSendReceive );
-    bool receiveDTCs( const SID &sid, ISOTPOverCANSenderReceiver &isoTPSendReceive, DTCInfo &info );
-    bool requestReceiveDTCs( const SID &sid, ISOTPOverCANSenderReceiver &isoTPSendReceive, DTCInfo &info );
+    // For SID 3 and 7, from all ECUs
+    bool requestReceiveDTCs( const SID &sid, DTCInfo &info );
+    // Pushes the changes of the set of active DTCs since the previous push to the DTC Buffer, with the next sequence
+    // number. Nothing is pushed if the set is unchanged, and the full set is pushed if the previous push failed.
+    void pushDTCChanges( DTCInfo &dtcInfo );
+
+    // Takes over the VIN, ECUs and supported PIDs of the persisted cache, if any
+    void loadECUCache();
+    // Persists the VIN, ECUs and supported PIDs
+    void storeECUCache();
+    // Requests the VIN to check that the cache belongs to this vehicle. If not, the cached ECUs and supported PIDs
+    // are dropped and requested again.
+    void revalidateCachedVIN();
+
+    // Logs the PDU with the given prefix, the message is only built if traces are logged
+    void tracePDU( const char *function, const char *prefix, const uint8_t *pdu, size_t size );
 
     Thread mThread;
     std::atomic<bool> mShouldStop{ false };
@@ -211,44 +327,75 @@ private:
     mutable std::mutex mThreadMutex;
     LoggingModule mLogger;
     std::shared_ptr<const Clock> mClock = ClockHandler::getClock();
-    ISOTPOverCANSenderReceiver mEngineECUSenderReceiver;
-    ISOTPOverCANSenderReceiver mTransmissionECUSenderReceiver;
+    // Sessions with all ECUs. The first one is the Engine ECU. The vector is only modified by the worker thread, and
+    // modifications of the vector and of the PID lists are guarded by mECUsMutex
+    std::vector<std::unique_ptr<ECUSession>> mECUs;
+    mutable std::mutex mECUsMutex;
     // Stop signal
     Platform::Linux::Signal mWait;
     // Decoder Manifest and campaigns availability Signal
     Platform::Linux::Signal mDataAvailableWait;
-    std::vector<uint8_t> mTxPDU;
-    std::vector<uint8_t> mRxPDU;
     // Signal Buffer shared pointer
     SignalBufferPtr mSignalBufferPtr;
+    // Ring of this module in the Signal Buffer, only pushed to by the worker thread
+    SignalBufferProducerPtr mSignalProducer;
     // Active DTC Buffer shared pointer
     ActiveDTCBufferPtr mActiveDTCBufferPtr;
     uint32_t mPIDRequestIntervalSeconds;
     uint32_t mDTCRequestIntervalSeconds;
     uint32_t mOBDHeartBeatIntervalSeconds;
-    bool mHasTransmission;
+    bool mUseExtendedIDs{ false };
+    bool mDiscoverECUs{ false };
+    bool mECUDiscoveryDone{ false };
+    std::string mGatewayCanInterfaceName;
     std::string mVIN;
+    // Set while the VIN is taken from the cache and was not yet confirmed by the vehicle
+    bool mVINFromCache{ false };
+    // Set if the VIN, ECUs or supported PIDs changed since the cache was persisted
+    bool mECUCacheOutdated{ false };
+    std::shared_ptr<ICacheAndPersist> mPersistency;
     Timer mTimer;
     Timer mDTCTimer;
+    // Sorted DTCs and sequence number of the last set pushed to the DTC Buffer, only accessed by the worker thread
+    std::vector<std::string> mLastDTCCodes;
+    uint32_t mDTCSequenceNumber{ 0 };
+    bool mDTCResyncRequired{ true };
     Timer mPIDTimer;
-    // Supported PIDs for both ECUs
-    std::map<SID, SupportedPIDs> mSupportedPIDsEngine;
-    std::map<SID, SupportedPIDs> mSupportedPIDsTransmission;
+    // Schedule of all PIDs of the decoder dictionary, only accessed by the worker thread
+    std::map<PID, PIDSchedule> mPIDSchedule;
+    // Buffers of the worker thread that are reused by every polling cycle, so that the PID polling does not allocate
+    // once they have grown to the size of a cycle
+    std::vector<PID> mDuePIDs;
+    std::vector<PID> mECUDuePIDs;
+    std::vector<struct pollfd> mPollFDs;
+    std::vector<size_t> mPollECUs;
+    EmissionInfo mEmissionInfo;
+    std::vector<CollectedSignal> mPendingSignals;
+    // Set if the decoder dictionary or the inspection matrix changed and the PID schedule must be rebuilt
+    std::atomic<bool> mPIDScheduleOutdated{ false };
+    // Smallest minimumSampleIntervalMs of each signal in the inspection matrix, guarded by mDecoderDictMutex
+    std::unordered_map<SignalID, uint32_t> mSignalSampleIntervalsMs;
     // PIDs that are required by decoder dictionary
     std::unordered_map<SID, std::vector<PID>> mPIDsRequestedByDecoderDict;
-    // The PIDs to request from ECUs. It will be the common PIDs that are required by
-    // decoder dictionary as well as supported by ECU
-    std::map<SID, std::vector<PID>> mPIDsToRequestEngine;
-    std::map<SID, std::vector<PID>> mPIDsToRequestTransmission;
 
     // OBD Session Manager
     // Will not be used. This is for Future use for ECU discovery.
     // OBDOverCANSessionManager mSessionManager;
     std::unique_ptr<OBDDataDecoder> mOBDDataDecoder;
     // Mutex to ensure atomic decoder dictionary shared pointer content assignment
-    std::mutex mDecoderDictMutex;
+    InstrumentedMutex mDecoderDictMutex{ "OBDDecoderDict" };
     // shared pointer to decoder dictionary
     std::shared_ptr<OBDDecoderDictionary> mDecoderDictionaryPtr;
+    // DIDs per request CAN ID of the ECU of the last UDS decoder dictionary, guarded by mDecoderDictMutex
+    std::map<uint32_t, UDSDataIdentifiers> mUDSDataIdentifiers;
+    std::atomic<bool> mUDSDictionaryAvailable{ false };
+    // DIDs currently requested and streamed, only accessed by the worker thread
+    std::map<uint32_t, UDSDataIdentifiers> mActiveUDSDataIdentifiers;
+    bool mPeriodicDIDsStarted{ false };
+    // Set once the DIDs of the current UDS decoder dictionary were requested, then they are requested at the PID
+    // request interval
+    bool mDIDsRequested{ false };
+    Timer mDIDTimer;
 };
 } // namespace DataInspection
 } // namespace IoTFleetWise
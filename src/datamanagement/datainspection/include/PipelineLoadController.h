@@ -0,0 +1,174 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "LoggingModule.h"
+#include "SerialTaskExecutor.h"
+#include "Signal.h"
+#include "Thread.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataInspection
+{
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+/**
+ * @brief Data shed by the vehicle data consumers, every level also sheds the data of the levels before
+ */
+enum class LoadSheddingLevel : uint8_t
+{
+    NONE = 0,
+    LOW_PRIORITY_SIGNALS, /**< signals only collected by low priority collection schemes are dropped after decoding */
+    RAW_CAN_FRAMES        /**< additionally only every rawFrameKeepInterval-th raw CAN frame is captured */
+};
+
+/**
+ * @brief Watermarks and policy of the PipelineLoadController. The watermarks are ratios of the fullest queue.
+ */
+struct LoadSheddingConfig
+{
+    double lowWatermark{ 0.5 };      /**< shedding stops when the fullest queue is below */
+    double highWatermark{ 0.8 };     /**< low priority signals are shed when the fullest queue reaches it */
+    double criticalWatermark{ 0.95 }; /**< raw CAN frames are thinned out when the fullest queue reaches it */
+    /** Signals of collection schemes with a priority value above are shed, smaller values are more important */
+    uint32_t sheddingPriorityThreshold{ 0 };
+    uint32_t rawFrameKeepInterval{ 4 }; /**< 1 of this number of raw CAN frames is kept while thinning */
+    uint32_t samplingPeriodMs{ 50 };    /**< time between two evaluations of the queue occupancy */
+};
+
+/**
+ * @brief Watches the occupancy of all queues of the data pipeline and decides centrally which data is shed when a
+ * downstream stage falls behind, instead of every queue dropping data at random when it overflows.
+ *
+ * The consumers read the level with a single relaxed atomic load per frame. Signals used in conditions are never
+ * shed, so the triggers keep working while the collected data is reduced. The level is set as the TraceVariable
+ * LOAD_SHEDDING_LEVEL and every change is logged, the consumers count the shed data in the TraceAtomicVariables
+ * LOAD_SHEDDING_DROPPED_SIGNALS and LOAD_SHEDDING_DROPPED_RAW_FRAMES.
+ */
+class PipelineLoadController
+{
+public:
+    using OccupancyFunction = std::function<size_t()>;
+
+    /**
+     * @param config watermarks and policy, the watermarks are sorted if needed
+     */
+    explicit PipelineLoadController( LoadSheddingConfig config );
+    ~PipelineLoadController();
+
+    PipelineLoadController( const PipelineLoadController & ) = delete;
+    PipelineLoadController &operator=( const PipelineLoadController & ) = delete;
+    PipelineLoadController( PipelineLoadController && ) = delete;
+    PipelineLoadController &operator=( PipelineLoadController && ) = delete;
+
+    /**
+     * @brief Registers a queue whose occupancy is watched. Has to be called before start.
+     * @param name name of the queue in the log
+     * @param occupancy returns the current number of elements, called from the controller thread
+     * @param capacity maximum number of elements, queues with a capacity of 0 are ignored
+     */
+    void registerQueue( const std::string &name, OccupancyFunction occupancy, size_t capacity );
+
+    /**
+     * @brief Evaluates the queues as a periodic task of the executor instead of on an own thread. Must be called
+     * before start.
+     */
+    void
+    setExecutor( std::shared_ptr<SerialTaskExecutor> executor )
+    {
+        mExecutor = std::move( executor );
+    }
+
+    bool start();
+
+    bool stop();
+
+    bool isAlive();
+
+    /**
+     * @brief Evaluates the occupancy of the queues once and updates the level. Only called by the controller
+     * thread, or if it is not running.
+     * @return The new level
+     */
+    LoadSheddingLevel evaluate();
+
+    /**
+     * @brief Current level, can be called from any thread
+     */
+    inline LoadSheddingLevel
+    getLevel() const
+    {
+        return mLevel.load( std::memory_order_relaxed );
+    }
+
+    /**
+     * @brief Whether a signal is shed at LOW_PRIORITY_SIGNALS
+     * @param priority most important priority of the collection schemes collecting the signal
+     * @param conditionSignal whether the signal is used in a condition
+     */
+    inline bool
+    isSheddable( uint32_t priority, bool conditionSignal ) const
+    {
+        return ( !conditionSignal ) && ( priority > mConfig.sheddingPriorityThreshold );
+    }
+
+    inline const LoadSheddingConfig &
+    getConfig() const
+    {
+        return mConfig;
+    }
+
+private:
+    struct WatchedQueue
+    {
+        std::string name;
+        OccupancyFunction occupancy;
+        size_t capacity{ 0 };
+    };
+
+    static void doWork( void *data );
+    bool shouldStop() const;
+    /**
+     * @brief Evaluates the queues and posts the next evaluation after the sampling period, run by the executor
+     */
+    void runPeriodicTask();
+    LoadSheddingLevel nextLevel( double fillRatio ) const;
+
+    LoadSheddingConfig mConfig;
+    std::vector<WatchedQueue> mQueues;
+    std::atomic<LoadSheddingLevel> mLevel{ LoadSheddingLevel::NONE };
+    Thread mThread;
+    std::atomic<bool> mShouldStop{ false };
+    std::mutex mThreadMutex;
+    Platform::Linux::Signal mWait;
+    std::shared_ptr<SerialTaskExecutor> mExecutor;
+    SerialTaskExecutor::QueueId mQueueId{ SerialTaskExecutor::INVALID_QUEUE_ID };
+    LoggingModule mLogger;
+};
+
+} // namespace DataInspection
+} // namespace IoTFleetWise
+} // namespace Aws
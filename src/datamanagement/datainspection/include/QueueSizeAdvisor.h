@@ -0,0 +1,197 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "ICacheAndPersist.h"
+#include "LoggingModule.h"
+#include "SerialTaskExecutor.h"
+#include "Signal.h"
+#include "Thread.h"
+#include "Timer.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataInspection
+{
+using namespace Aws::IoTFleetWise::Platform::Linux;
+using namespace Aws::IoTFleetWise::Platform::Linux::PersistencyManagement;
+
+/**
+ * @brief Policy of the QueueSizeAdvisor
+ */
+struct QueueSizingConfig
+{
+    double headroom{ 2.0 };         /**< the recommended size is the high-water mark times this factor */
+    double growthFactor{ 2.0 };     /**< a queue that dropped data grows at least by this factor */
+    double maxShrinkFactor{ 0.5 };  /**< a queue shrinks at most to this share of its capacity per run */
+    size_t minimumSize{ 64 };       /**< no queue is recommended smaller */
+    size_t memoryCeilingBytes{ 0 }; /**< upper limit of the memory of one ring of every queue, 0 for no limit */
+    uint32_t samplingPeriodMs{ 100 };     /**< time between two samples of the queue occupancy */
+    uint32_t persistIntervalMs{ 600000 }; /**< time between two updates of the persisted sizes */
+};
+
+/**
+ * @brief Sizes the queues of the data pipeline from the traffic observed on the vehicle instead of static
+ * configuration values.
+ *
+ * While running, the high-water mark and the data dropped because a queue was full are tracked for every
+ * registered queue. From them the size for the next start is derived: the high-water mark with headroom, grown if
+ * data was dropped, shrunk slowly if the queue was oversized and scaled down together with the other queues if
+ * all of them exceed the memory ceiling. The sizes are persisted periodically and when the advisor stops, and are
+ * returned by getSize on the next start.
+ *
+ * The decisions are published to the TraceModule as the named variables queueCapacity_<queue>,
+ * queueHighWater_<queue>, queueDropped_<queue> and queueRecommendedSize_<queue>.
+ */
+class QueueSizeAdvisor
+{
+public:
+    using CountFunction = std::function<uint64_t()>;
+
+    static constexpr uint32_t PUBLISH_INTERVAL_MS = 1000;
+
+    /**
+     * @param config policy, factors out of range are corrected
+     * @param persistency storage of the recommended sizes, can be nullptr to only publish the recommendations
+     */
+    QueueSizeAdvisor( QueueSizingConfig config, std::shared_ptr<ICacheAndPersist> persistency );
+    ~QueueSizeAdvisor();
+
+    QueueSizeAdvisor( const QueueSizeAdvisor & ) = delete;
+    QueueSizeAdvisor &operator=( const QueueSizeAdvisor & ) = delete;
+    QueueSizeAdvisor( QueueSizeAdvisor && ) = delete;
+    QueueSizeAdvisor &operator=( QueueSizeAdvisor && ) = delete;
+
+    /**
+     * @brief Loads the sizes recommended by the previous run. Has to be called before getSize.
+     * @return true if persisted sizes were loaded
+     */
+    bool load();
+
+    /**
+     * @brief Size a queue is allocated with
+     * @param name name of the queue
+     * @param configuredSize size from the static configuration
+     * @return the size recommended by the previous run, configuredSize if there is none
+     */
+    size_t getSize( const std::string &name, size_t configuredSize ) const;
+
+    /**
+     * @brief Registers a queue whose usage is tracked. Has to be called before start.
+     * @param name name of the queue, also the key of the persisted size
+     * @param occupancy returns the current number of elements, called from the advisor thread
+     * @param dropped returns the number of elements dropped because the queue was full, counted from any point in
+     * time before the registration, can be empty
+     * @param capacity number of elements the queue was allocated with
+     * @param elementBytes memory used per element, to apply the memory ceiling
+     */
+    void registerQueue( const std::string &name,
+                        CountFunction occupancy,
+                        CountFunction dropped,
+                        size_t capacity,
+                        size_t elementBytes );
+
+    /**
+     * @brief Samples the queues as a periodic task of the executor instead of on an own thread. Must be called
+     * before start.
+     */
+    void
+    setExecutor( std::shared_ptr<SerialTaskExecutor> executor )
+    {
+        mExecutor = std::move( executor );
+    }
+
+    bool start();
+
+    /**
+     * @brief Stops the thread and persists the recommended sizes
+     */
+    bool stop();
+
+    bool isAlive();
+
+    /**
+     * @brief Samples the occupancy of all queues once. Only called by the advisor thread or task, or if it is not
+     * running.
+     */
+    void sample();
+
+    /**
+     * @brief Derives the sizes for the next start from the samples so far and publishes them as metrics
+     * @return the recommended size by queue name
+     */
+    std::map<std::string, size_t> recommend();
+
+    /**
+     * @brief Persists the sizes returned by recommend
+     * @return true if the sizes were written
+     */
+    bool persist();
+
+private:
+    struct TrackedQueue
+    {
+        std::string name;
+        CountFunction occupancy;
+        CountFunction dropped;
+        size_t capacity{ 0 };
+        size_t elementBytes{ 0 };
+        uint64_t droppedAtStart{ 0 };
+        size_t highWater{ 0 };
+    };
+
+    static constexpr const char *FILE_HEADER = "QueueSizes 1";
+
+    static void doWork( void *data );
+    bool shouldStop() const;
+    /**
+     * @brief Samples the queues and publishes or persists the recommendations when they are due
+     */
+    void runOnce();
+    /**
+     * @brief Runs once and posts the next run after the sampling period, run by the executor
+     */
+    void runPeriodicTask();
+    uint64_t getDropped( const TrackedQueue &queue ) const;
+
+    QueueSizingConfig mConfig;
+    std::shared_ptr<ICacheAndPersist> mPersistency;
+    std::map<std::string, size_t> mPersistedSizes;
+    std::vector<TrackedQueue> mQueues;
+    Thread mThread;
+    std::atomic<bool> mShouldStop{ false };
+    std::mutex mThreadMutex;
+    Platform::Linux::Signal mWait;
+    Timer mPublishTimer;
+    Timer mPersistTimer;
+    std::shared_ptr<SerialTaskExecutor> mExecutor;
+    SerialTaskExecutor::QueueId mQueueId{ SerialTaskExecutor::INVALID_QUEUE_ID };
+    LoggingModule mLogger;
+};
+
+} // namespace DataInspection
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -0,0 +1,118 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "CollectionInspectionAPITypes.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataInspection
+{
+
+/**
+ * @brief Batch of decoded signals and raw CAN frames as sent from the acquisition ECU to the inspection ECU in one
+ * datagram.
+ *
+ * All fields are little endian and unaligned, so the acquisition and the inspection can run on different
+ * architectures:
+ *
+ * header:  magic u32, version u8, reserved u8, signal count u16, sequence u32, frame count u16, reserved u16
+ * signal:  signal ID u32, receive time ms u64, receive time fraction us u16, value f64
+ * frame:   frame ID u32, channel u32, receive time ms u64, receive time fraction us u16, size u8,
+ *          decoded signal count u8, size bytes of data, decoded signal count times (signal ID u32, value f64)
+ *
+ * The receive times are passed through unchanged. The manifest signal index and the latency trace are local to
+ * the decoding ECU, so they are not sent and the inspection looks up the signals by ID.
+ */
+class RemoteInspectionBatch
+{
+public:
+    static constexpr uint32_t MAGIC = 0x49525746U; // "FWRI"
+    static constexpr uint8_t VERSION = 1;
+    static constexpr size_t HEADER_SIZE = 16;
+    static constexpr size_t SIGNAL_SIZE = 22;
+    static constexpr size_t FRAME_HEADER_SIZE = 20;
+    static constexpr size_t DECODED_SIGNAL_SIZE = 12;
+    // Fits into an Ethernet frame together with the IP and UDP headers, so the datagrams are not fragmented
+    static constexpr size_t DEFAULT_MAX_SIZE = 1472;
+    // Largest UDP payload
+    static constexpr size_t MAX_SIZE = 65507;
+
+    /**
+     * @param maxSize maximum size of the encoded batch in bytes, at least large enough for one CAN FD frame with
+     * all its decoded signals
+     */
+    explicit RemoteInspectionBatch( size_t maxSize = DEFAULT_MAX_SIZE );
+
+    /**
+     * @brief Appends a signal if it still fits
+     * @return False if the batch is full
+     */
+    bool addSignal( const CollectedSignal &signal );
+
+    /**
+     * @brief Appends a raw frame with its decoded signals if it still fits
+     * @return False if the batch is full
+     */
+    bool addFrame( const CollectedCanFrameWithSignals &frame );
+
+    /**
+     * @brief Writes the header with the sequence number
+     * @param sequence incremented by the sender for every batch, so that the receiver can detect lost batches
+     * @return the encoded batch, valid until the next call to clear or add
+     */
+    const std::vector<uint8_t> &finish( uint32_t sequence );
+
+    /**
+     * @brief Removes all signals and frames
+     */
+    void clear();
+
+    bool
+    empty() const
+    {
+        return ( mSignalCount == 0 ) && ( mFrameCount == 0 );
+    }
+
+    /**
+     * @brief Decodes an encoded batch
+     * @param data the received datagram
+     * @param size size of the datagram
+     * @param sequence the sequence number of the batch
+     * @param signals the decoded signals are appended
+     * @param frames the decoded raw frames are appended
+     * @return False if the datagram is not a valid batch, nothing is appended then
+     */
+    static bool decode( const uint8_t *data,
+                        size_t size,
+                        uint32_t &sequence,
+                        std::vector<CollectedSignal> &signals,
+                        std::vector<CollectedCanFrameWithSignals> &frames );
+
+private:
+    size_t mMaxSize;
+    std::vector<uint8_t> mBuffer;
+    uint16_t mSignalCount{ 0 };
+    uint16_t mFrameCount{ 0 };
+};
+
+} // namespace DataInspection
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -0,0 +1,186 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "CollectionInspectionAPITypes.h"
+#include "LoggingModule.h"
+#include "RemoteInspectionProtocol.h"
+#include "Signal.h"
+#include "Thread.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataInspection
+{
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+/**
+ * @brief Runs on the ECU that runs the inspection. Receives the batches of a RemoteInspectionSender over UDP and
+ * pushes their signals and raw frames to the Signal Buffer and the CAN Buffer, as if they were decoded locally.
+ *
+ * Gaps in the sequence numbers of the batches are counted as lost batches, in the trace variable RemLost. Signals
+ * and frames that do not fit into the buffers are dropped, as the sender cannot be slowed down.
+ */
+class RemoteInspectionReceiver
+{
+public:
+    RemoteInspectionReceiver() = default;
+    ~RemoteInspectionReceiver();
+
+    RemoteInspectionReceiver( const RemoteInspectionReceiver & ) = delete;
+    RemoteInspectionReceiver &operator=( const RemoteInspectionReceiver & ) = delete;
+    RemoteInspectionReceiver( RemoteInspectionReceiver && ) = delete;
+    RemoteInspectionReceiver &operator=( RemoteInspectionReceiver && ) = delete;
+
+    /**
+     * @brief Initializes the receiver
+     * @param signalBufferPtr Signal Buffer the received signals are pushed to
+     * @param canBufferPtr CAN Buffer the received raw frames are pushed to
+     * @param listenAddress local IPv4 address to receive on, 0.0.0.0 for all interfaces
+     * @param port UDP port to receive on, 0 to let the kernel choose one, see getPort
+     * @return True if the parameters are valid
+     */
+    bool init( SignalBufferPtr signalBufferPtr,
+               CANBufferPtr canBufferPtr,
+               const std::string &listenAddress,
+               uint16_t port );
+
+    /**
+     * @brief Set the signal to notify after new data was pushed to the buffers. Must be called before connect.
+     * @param outputDataAvailableSignal signal of the buffer consumer
+     */
+    void
+    setOutputDataAvailableSignal( std::shared_ptr<Platform::Linux::Signal> outputDataAvailableSignal )
+    {
+        mOutputDataAvailableSignal = std::move( outputDataAvailableSignal );
+    }
+
+    /**
+     * @brief Binds the socket and starts the thread receiving the batches
+     * @return True if successful
+     */
+    bool connect();
+
+    /**
+     * @brief Stops the thread and closes the socket
+     * @return True if successful
+     */
+    bool disconnect();
+
+    /**
+     * @brief Checks that the worker thread is healthy and consuming data.
+     */
+    bool isAlive();
+
+    /**
+     * @brief Handles one received datagram, public for testing
+     * @param data the datagram
+     * @param size size of the datagram
+     */
+    void handleDatagram( const uint8_t *data, size_t size );
+
+    /**
+     * @brief Returns the UDP port the receiver is bound to after connect
+     */
+    uint16_t
+    getPort() const
+    {
+        return mPort;
+    }
+
+    /**
+     * @brief Returns the number of valid batches received
+     */
+    uint64_t
+    getReceivedBatches() const
+    {
+        return mReceivedBatches.load( std::memory_order_relaxed );
+    }
+
+    /**
+     * @brief Returns the number of batches missing in the sequence
+     */
+    uint64_t
+    getLostBatches() const
+    {
+        return mLostBatches.load( std::memory_order_relaxed );
+    }
+
+    /**
+     * @brief Returns the number of datagrams that were not valid batches
+     */
+    uint64_t
+    getInvalidDatagrams() const
+    {
+        return mInvalidDatagrams.load( std::memory_order_relaxed );
+    }
+
+    /**
+     * @brief Returns the number of signals and frames dropped because the buffers were full
+     */
+    uint64_t
+    getDroppedData() const
+    {
+        return mDroppedData.load( std::memory_order_relaxed );
+    }
+
+private:
+    // Time the thread waits for datagrams before it checks whether it should stop
+    static constexpr uint32_t POLL_TIMEOUT_MS = 200;
+    // Batches that arrive at most this many sequence numbers late are passed on and no longer count as lost
+    static constexpr uint32_t REORDER_WINDOW = 64;
+
+    // atomic state of the bus. If true, we should stop
+    bool shouldStop() const;
+    // Main work function for the thread
+    static void doWork( void *data );
+
+    Thread mThread;
+    std::atomic<bool> mShouldStop{ false };
+    mutable std::mutex mThreadMutex;
+    LoggingModule mLogger;
+
+    std::string mListenAddress;
+    uint16_t mPort{ 0 };
+    int mSocket{ -1 };
+    SignalBufferPtr mSignalBufferPtr;
+    CANBufferPtr mCANBufferPtr;
+    // Rings of this receiver in the buffers, only pushed to by the worker thread
+    SignalBufferProducerPtr mSignalProducer;
+    CANBufferProducerPtr mCANProducer;
+    std::shared_ptr<Platform::Linux::Signal> mOutputDataAvailableSignal;
+    // Decoded batch, reused for every datagram
+    std::vector<CollectedSignal> mSignals;
+    std::vector<CollectedCanFrameWithSignals> mFrames;
+    bool mSequenceKnown{ false };
+    uint32_t mExpectedSequence{ 0 };
+    std::atomic<uint64_t> mReceivedBatches{ 0 };
+    std::atomic<uint64_t> mLostBatches{ 0 };
+    std::atomic<uint64_t> mInvalidDatagrams{ 0 };
+    std::atomic<uint64_t> mDroppedData{ 0 };
+};
+
+} // namespace DataInspection
+} // namespace IoTFleetWise
+} // namespace Aws
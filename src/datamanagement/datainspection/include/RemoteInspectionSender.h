@@ -0,0 +1,158 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "CollectionInspectionAPITypes.h"
+#include "FastClock.h"
+#include "LoggingModule.h"
+#include "RemoteInspectionProtocol.h"
+#include "Signal.h"
+#include "Thread.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataInspection
+{
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+/**
+ * @brief Runs on the ECU that acquires the data, e.g. a gateway on which the CAN buses terminate. Takes the place
+ * of the inspection as the consumer of the Signal Buffer and the CAN Buffer and sends their content over UDP to a
+ * RemoteInspectionReceiver on the ECU that runs the inspection.
+ *
+ * The signals and frames are packed into RemoteInspectionBatch datagrams. A batch is sent when it is full or when
+ * the buffers are empty and the oldest element in the batch waited for the flush interval, so under load the
+ * datagrams are full and at low rates the added latency is at most the flush interval.
+ */
+class RemoteInspectionSender
+{
+public:
+    RemoteInspectionSender() = default;
+    ~RemoteInspectionSender();
+
+    RemoteInspectionSender( const RemoteInspectionSender & ) = delete;
+    RemoteInspectionSender &operator=( const RemoteInspectionSender & ) = delete;
+    RemoteInspectionSender( RemoteInspectionSender && ) = delete;
+    RemoteInspectionSender &operator=( RemoteInspectionSender && ) = delete;
+
+    /**
+     * @brief Initializes the sender
+     * @param signalBufferPtr Signal Buffer filled by the CAN Data Consumers and the other sources
+     * @param canBufferPtr CAN Buffer filled by the CAN Data Consumers
+     * @param address IPv4 address of the receiver
+     * @param port UDP port of the receiver
+     * @param maxDatagramSize maximum size of a datagram in bytes, 0 for RemoteInspectionBatch::DEFAULT_MAX_SIZE
+     * @param flushIntervalMs maximum time a signal or frame waits for the batch to fill up, 0 to send whenever the
+     * buffers are empty
+     * @return True if the parameters are valid
+     */
+    bool init( SignalBufferPtr signalBufferPtr,
+               CANBufferPtr canBufferPtr,
+               const std::string &address,
+               uint16_t port,
+               size_t maxDatagramSize,
+               uint32_t flushIntervalMs );
+
+    /**
+     * @brief Returns the signal the producers of the buffers notify after they pushed new data
+     */
+    std::shared_ptr<Platform::Linux::Signal>
+    getDataAvailableSignal() const
+    {
+        return mDataAvailableSignal;
+    }
+
+    /**
+     * @brief Opens the socket and starts the thread sending the batches
+     * @return True if successful
+     */
+    bool connect();
+
+    /**
+     * @brief Sends the pending batch, stops the thread and closes the socket
+     * @return True if successful
+     */
+    bool disconnect();
+
+    /**
+     * @brief Checks that the worker thread is healthy and consuming data.
+     */
+    bool isAlive();
+
+    /**
+     * @brief Returns the number of datagrams sent
+     */
+    uint64_t
+    getSentBatches() const
+    {
+        return mSentBatches.load( std::memory_order_relaxed );
+    }
+
+    /**
+     * @brief Returns the number of datagrams that could not be sent, e.g. because the network was down
+     */
+    uint64_t
+    getFailedBatches() const
+    {
+        return mFailedBatches.load( std::memory_order_relaxed );
+    }
+
+private:
+    // Time the thread waits for new data if no batch is pending
+    static constexpr uint32_t IDLE_TIME_MS = 100;
+    // Number of elements popped from a buffer at once
+    static constexpr size_t POP_BATCH_SIZE = 64;
+
+    // Moves the available signals and frames into batches and sends the full batches
+    void consumeBuffers();
+    void addSignal( const CollectedSignal &signal );
+    void addFrame( const CollectedCanFrameWithSignals &frame );
+    void sendBatch();
+    // atomic state of the bus. If true, we should stop
+    bool shouldStop() const;
+    // Main work function for the thread
+    static void doWork( void *data );
+
+    Thread mThread;
+    std::atomic<bool> mShouldStop{ false };
+    mutable std::mutex mThreadMutex;
+    LoggingModule mLogger;
+    std::shared_ptr<Platform::Linux::Signal> mDataAvailableSignal = std::make_shared<Platform::Linux::Signal>();
+
+    SignalBufferPtr mSignalBufferPtr;
+    CANBufferPtr mCANBufferPtr;
+    std::string mAddress;
+    uint16_t mPort{ 0 };
+    uint32_t mFlushIntervalMs{ 0 };
+    int mSocket{ -1 };
+    std::unique_ptr<RemoteInspectionBatch> mBatch;
+    // Monotonic time the first element was added to the pending batch
+    Timestamp mBatchStartTime{ 0 };
+    uint32_t mSequence{ 0 };
+    std::atomic<uint64_t> mSentBatches{ 0 };
+    std::atomic<uint64_t> mFailedBatches{ 0 };
+};
+
+} // namespace DataInspection
+} // namespace IoTFleetWise
+} // namespace Aws
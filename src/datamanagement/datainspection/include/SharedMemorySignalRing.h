@@ -0,0 +1,161 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/*
+ * Layout of the shared memory signal ring and the functions for processes producing signals into it. The header
+ * only depends on the C library and the GCC atomic builtins, so that it can be copied into C and C++ producers.
+ *
+ * The ring is a single producer, single consumer queue of pre-decoded signal records. It is created by AWS IoT
+ * FleetWise Edge under the configured name in /dev/shm, a producer maps it with fwe_shm_signal_ring_open and pushes
+ * from exactly one thread with fwe_shm_signal_ring_push. If the ring is full the record is dropped and counted.
+ */
+
+#ifndef FWE_SHARED_MEMORY_SIGNAL_RING_H
+#define FWE_SHARED_MEMORY_SIGNAL_RING_H
+
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define FWE_SHM_SIGNAL_RING_MAGIC 0x46574553U /* "FWES" */
+#define FWE_SHM_SIGNAL_RING_VERSION 1U
+
+/* A signal value sampled by the producer */
+struct fwe_shm_signal_record
+{
+    uint32_t signal_id;    /* signal ID of the decoder manifest */
+    uint32_t reserved;     /* must be 0 */
+    uint64_t timestamp_ms; /* milliseconds since Epoch, 0 to use the time the record is read */
+    double value;
+};
+
+/* Indexes are only ever incremented, the position in the ring is the index modulo the capacity. Every index is in
+ * its own cache line, so that the producer and the consumer do not invalidate each other's line. */
+struct fwe_shm_signal_ring_header
+{
+    uint32_t magic;       /* written last by the creator, the ring is valid once it is FWE_SHM_SIGNAL_RING_MAGIC */
+    uint32_t version;     /* FWE_SHM_SIGNAL_RING_VERSION */
+    uint32_t capacity;    /* number of records, a power of two */
+    uint32_t record_size; /* sizeof( struct fwe_shm_signal_record ) */
+    uint8_t padding0[48];
+    uint64_t write_index; /* only written by the producer */
+    uint8_t padding1[56];
+    uint64_t read_index; /* only written by the consumer */
+    uint8_t padding2[56];
+    uint64_t dropped; /* records not pushed because the ring was full, only written by the producer */
+    uint8_t padding3[56];
+    /* followed by capacity records */
+};
+
+/* Size of the shared memory object of a ring with the given capacity */
+static inline size_t
+fwe_shm_signal_ring_size( uint32_t capacity )
+{
+    return sizeof( struct fwe_shm_signal_ring_header ) + ( (size_t)capacity * sizeof( struct fwe_shm_signal_record ) );
+}
+
+static inline struct fwe_shm_signal_record *
+fwe_shm_signal_ring_records( struct fwe_shm_signal_ring_header *ring )
+{
+    return (struct fwe_shm_signal_record *)( ring + 1 );
+}
+
+/*
+ * Maps the ring created by AWS IoT FleetWise Edge.
+ * name: the shared memory object name, e.g. "/fwe-signals"
+ * Returns the ring, or NULL if it does not exist yet or has an incompatible layout. Unmap it with
+ * fwe_shm_signal_ring_close.
+ */
+static inline struct fwe_shm_signal_ring_header *
+fwe_shm_signal_ring_open( const char *name )
+{
+    struct stat fileStat;
+    struct fwe_shm_signal_ring_header *ring;
+    void *mapping;
+    int fd = shm_open( name, O_RDWR, 0 );
+    if ( fd < 0 )
+    {
+        return NULL;
+    }
+    if ( ( fstat( fd, &fileStat ) != 0 ) || ( (size_t)fileStat.st_size < sizeof( struct fwe_shm_signal_ring_header ) ) )
+    {
+        close( fd );
+        return NULL;
+    }
+    mapping = mmap( NULL, (size_t)fileStat.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+    close( fd );
+    if ( mapping == MAP_FAILED )
+    {
+        return NULL;
+    }
+    ring = (struct fwe_shm_signal_ring_header *)mapping;
+    if ( ( __atomic_load_n( &ring->magic, __ATOMIC_ACQUIRE ) != FWE_SHM_SIGNAL_RING_MAGIC ) ||
+         ( ring->version != FWE_SHM_SIGNAL_RING_VERSION ) ||
+         ( ring->record_size != sizeof( struct fwe_shm_signal_record ) ) || ( ring->capacity == 0U ) ||
+         ( fwe_shm_signal_ring_size( ring->capacity ) > (size_t)fileStat.st_size ) )
+    {
+        munmap( mapping, (size_t)fileStat.st_size );
+        return NULL;
+    }
+    return ring;
+}
+
+static inline void
+fwe_shm_signal_ring_close( struct fwe_shm_signal_ring_header *ring )
+{
+    if ( ring != NULL )
+    {
+        munmap( ring, fwe_shm_signal_ring_size( ring->capacity ) );
+    }
+}
+
+/*
+ * Pushes a record. Must only be called from one thread of one process per ring.
+ * Returns 1 if the record was pushed, 0 if the ring is full.
+ */
+static inline int
+fwe_shm_signal_ring_push( struct fwe_shm_signal_ring_header *ring,
+                          uint32_t signal_id,
+                          uint64_t timestamp_ms,
+                          double value )
+{
+    struct fwe_shm_signal_record *record;
+    uint64_t writeIndex = __atomic_load_n( &ring->write_index, __ATOMIC_RELAXED );
+    uint64_t readIndex = __atomic_load_n( &ring->read_index, __ATOMIC_ACQUIRE );
+    if ( ( writeIndex - readIndex ) >= ring->capacity )
+    {
+        __atomic_store_n( &ring->dropped, __atomic_load_n( &ring->dropped, __ATOMIC_RELAXED ) + 1U, __ATOMIC_RELAXED );
+        return 0;
+    }
+    record = &fwe_shm_signal_ring_records( ring )[writeIndex & ( ring->capacity - 1U )];
+    record->signal_id = signal_id;
+    record->reserved = 0U;
+    record->timestamp_ms = timestamp_ms;
+    record->value = value;
+    __atomic_store_n( &ring->write_index, writeIndex + 1U, __ATOMIC_RELEASE );
+    return 1;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FWE_SHARED_MEMORY_SIGNAL_RING_H */
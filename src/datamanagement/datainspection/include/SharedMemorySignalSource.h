@@ -0,0 +1,148 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "ClockHandler.h"
+#include "CollectionInspectionAPITypes.h"
+#include "LoggingModule.h"
+#include "SharedMemorySignalRing.h"
+#include "Signal.h"
+#include "Thread.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataInspection
+{
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+/**
+ * @brief Receives pre-decoded signals from another process on the same ECU through a ring in shared memory and
+ * pushes them directly to the Signal Buffer, without a VehicleDataMessage and without decoding.
+ *
+ * The ring is created in /dev/shm on connect, its layout and the producer functions are defined in the C header
+ * SharedMemorySignalRing.h. If a ring with the same name and capacity exists already, e.g. after a restart, it is
+ * reused together with the records and the producer mappings in it. Records are only consumed while there is space
+ * in the Signal Buffer, so a slow inspection applies back pressure to the producer instead of losing records
+ * silently.
+ */
+class SharedMemorySignalSource
+{
+public:
+    SharedMemorySignalSource() = default;
+    ~SharedMemorySignalSource();
+
+    SharedMemorySignalSource( const SharedMemorySignalSource & ) = delete;
+    SharedMemorySignalSource &operator=( const SharedMemorySignalSource & ) = delete;
+    SharedMemorySignalSource( SharedMemorySignalSource && ) = delete;
+    SharedMemorySignalSource &operator=( SharedMemorySignalSource && ) = delete;
+
+    /**
+     * @brief Initializes the source
+     * @param signalBufferPtr Signal Buffer the records are pushed to
+     * @param shmName name of the shared memory object, starting with a slash, e.g. /fwe-signals
+     * @param capacity number of records of the ring, a power of two
+     * @param idleTimeMs time the thread sleeps if the ring is empty, 0 for the default
+     * @return True if the parameters are valid
+     */
+    bool init( SignalBufferPtr signalBufferPtr, const std::string &shmName, uint32_t capacity, uint32_t idleTimeMs );
+
+    /**
+     * @brief Set the signal to notify after new data was pushed to the Signal Buffer. Must be called before connect.
+     * @param outputDataAvailableSignal signal of the Signal Buffer consumer
+     */
+    void
+    setOutputDataAvailableSignal( std::shared_ptr<Platform::Linux::Signal> outputDataAvailableSignal )
+    {
+        mOutputDataAvailableSignal = std::move( outputDataAvailableSignal );
+    }
+
+    /**
+     * @brief Creates or reuses the ring in shared memory and starts the thread reading it
+     * @return True if successful
+     */
+    bool connect();
+
+    /**
+     * @brief Stops the thread and unmaps the ring. The shared memory object is kept, so that producers can continue
+     * pushing until the ring is full and the records are read after the next connect.
+     * @return True if successful
+     */
+    bool disconnect();
+
+    /**
+     * @brief Checks that the worker thread is healthy and consuming data.
+     */
+    bool isAlive();
+
+    /**
+     * @brief Returns the number of records read from the ring
+     */
+    uint64_t
+    getReceivedSignals() const
+    {
+        return mReceivedSignals.load( std::memory_order_relaxed );
+    }
+
+    /**
+     * @brief Returns the number of records the producer dropped because the ring was full, as last seen by the thread
+     */
+    uint64_t
+    getDroppedSignals() const
+    {
+        return mDroppedSignals.load( std::memory_order_relaxed );
+    }
+
+private:
+    static constexpr uint32_t DEFAULT_IDLE_TIME_MS = 10;
+    static constexpr size_t MAX_BATCH_SIZE = 256;
+
+    bool mapRing();
+    void unmapRing();
+    // Moves up to MAX_BATCH_SIZE records to the Signal Buffer, returns the number of moved records
+    size_t consumeRecords();
+    // atomic state of the bus. If true, we should stop
+    bool shouldStop() const;
+    // Main work function for the thread
+    static void doWork( void *data );
+
+    Thread mThread;
+    std::atomic<bool> mShouldStop{ false };
+    mutable std::mutex mThreadMutex;
+    Platform::Linux::Signal mWait;
+    LoggingModule mLogger;
+    std::shared_ptr<const Clock> mClock = ClockHandler::getClock();
+
+    std::string mShmName;
+    uint32_t mCapacity{ 0 };
+    uint32_t mIdleTimeMs{ DEFAULT_IDLE_TIME_MS };
+    fwe_shm_signal_ring_header *mRing{ nullptr };
+    SignalBufferPtr mSignalBufferPtr;
+    // Ring of this source in the Signal Buffer, only pushed to by the worker thread
+    SignalBufferProducerPtr mSignalProducer;
+    std::shared_ptr<Platform::Linux::Signal> mOutputDataAvailableSignal;
+    std::atomic<uint64_t> mReceivedSignals{ 0 };
+    std::atomic<uint64_t> mDroppedSignals{ 0 };
+};
+
+} // namespace DataInspection
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -0,0 +1,169 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "CollectionInspectionAPITypes.h"
+#include "TimeTypes.h"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataInspection
+{
+
+/**
+ * @brief Estimates quantiles of a stream of values in bounded memory.
+ *
+ * The values are counted in buckets whose bounds grow geometrically, so every quantile is estimated with a relative
+ * error of at most RELATIVE_ACCURACY. If a sign needs more than MAX_BUCKETS buckets, the buckets of the values closest
+ * to 0 are merged, which only affects the accuracy of the quantiles close to 0.
+ */
+class QuantileSketch
+{
+public:
+    static constexpr double RELATIVE_ACCURACY = 0.01;
+    static constexpr size_t MAX_BUCKETS = 512;
+    // Values of a smaller magnitude are counted as 0
+    static constexpr double MIN_MAGNITUDE = 1e-9;
+
+    QuantileSketch();
+
+    /**
+     * @brief Adds a value, values that are not finite are ignored
+     */
+    void add( double value );
+
+    /**
+     * @brief Estimates a quantile of the added values
+     * @param quantile between 0 and 1
+     * @return the estimate or 0 if no value was added
+     */
+    double getQuantile( double quantile ) const;
+
+    inline uint64_t
+    getCount() const
+    {
+        return mCount;
+    }
+
+    /**
+     * @brief Removes all values
+     */
+    void clear();
+
+private:
+    int32_t getIndex( double magnitude ) const;
+    double getMagnitude( int32_t index ) const;
+    static void addToBuckets( std::map<int32_t, uint32_t> &buckets, int32_t index );
+
+    double mGamma;
+    double mLogGamma;
+    std::map<int32_t, uint32_t> mPositiveBuckets; /**< bucket index to count, bucket i holds (gamma^(i-1), gamma^i] */
+    std::map<int32_t, uint32_t> mNegativeBuckets; /**< by the index of the magnitude of the value */
+    uint64_t mZeroCount{ 0 };
+    uint64_t mCount{ 0 };
+};
+
+/**
+ * @brief Computes the SignalSummary of an aggregated signal for one condition.
+ *
+ * The aggregator is part of the FixedTimeWindowFunctionData of the fixed window period of the signal, which passes
+ * every sample and its min, max and sum when the window is complete. The aggregator itself only keeps what the
+ * window does not have: the running variance, the histogram and the quantile sketch, and only if they are selected.
+ * The summaries of the completed windows are kept until the condition collects its data.
+ */
+class SignalAggregator
+{
+public:
+    // Summaries kept for a condition that does not collect, the oldest ones are dropped
+    static constexpr size_t MAX_PENDING_SUMMARIES = 1024;
+
+    SignalAggregator( SignalID signalID, uint32_t conditionIndex, std::shared_ptr<const SignalAggregationInfo> info );
+
+    inline uint32_t
+    getConditionIndex() const
+    {
+        return mConditionIndex;
+    }
+
+    inline const std::shared_ptr<const SignalAggregationInfo> &
+    getInfo() const
+    {
+        return mInfo;
+    }
+
+    void addValue( double value );
+
+    /**
+     * @brief Completes the summary of the current window and starts the next one
+     * @param windowStart start of the window in milliseconds since epoch
+     * @param windowSizeMs length of the window
+     * @param count number of samples in the window, no summary is added for an empty window
+     * @param min minimum of the samples
+     * @param max maximum of the samples
+     * @param sum sum of the samples
+     */
+    void finishWindow(
+        Timestamp windowStart, uint32_t windowSizeMs, uint32_t count, double min, double max, double sum );
+
+    /**
+     * @brief Skips the summary of the current window, used if the aggregator started within a window
+     */
+    inline void
+    skipCurrentWindow()
+    {
+        mSkipWindow = true;
+    }
+
+    /**
+     * @brief Takes over the state and pending summaries of the aggregator of the previous inspection matrix
+     */
+    void takeOver( const SignalAggregator &previous );
+
+    /**
+     * @brief Moves the summaries of the completed windows to the collected data
+     */
+    void takeSummaries( std::vector<SignalSummary> &out );
+
+    /**
+     * @brief Returns true if both aggregators compute the same summaries
+     */
+    static bool isSameAggregation( const SignalAggregationInfo &a, const SignalAggregationInfo &b );
+
+private:
+    void clearWindow();
+
+    SignalID mSignalID;
+    uint32_t mConditionIndex;
+    std::shared_ptr<const SignalAggregationInfo> mInfo;
+    bool mSkipWindow{ false };
+    // Welford's online algorithm, only used if the variance is selected
+    uint32_t mVarianceCount{ 0 };
+    double mVarianceMean{ 0.0 };
+    double mSquaredDistanceSum{ 0.0 };
+    std::vector<uint32_t> mHistogramCounts;
+    QuantileSketch mSketch; /**< only filled if percentiles are selected */
+    std::vector<SignalSummary> mSummaries;
+};
+
+} // namespace DataInspection
+} // namespace IoTFleetWise
+} // namespace Aws
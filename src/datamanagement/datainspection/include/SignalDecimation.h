@@ -0,0 +1,49 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "CollectionInspectionAPITypes.h"
+#include <cstddef>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataInspection
+{
+
+/**
+ * @brief Reduces the samples of one signal to at most maxSamples of them which keep the shape of the waveform
+ *
+ * Only original samples are kept, no values are interpolated, so peaks are sent with their exact value and time.
+ * The methods split the samples into buckets of the same number of samples:
+ * - LARGEST_TRIANGLE_THREE_BUCKETS keeps the first and the last sample and per bucket the sample which spans the
+ *   largest triangle with the previously kept sample and the average of the next bucket
+ * - MIN_MAX keeps the smallest and the largest sample per bucket, in the order of time
+ * - UNIFORM keeps the sample closest to each point of a uniform time grid from the first to the last sample
+ *
+ * The samples from first to the end of the vector are sorted by time, decimated in place and the vector is shrunk,
+ * so that no memory is allocated. Fewer samples than maxSamples are only sorted.
+ *
+ * @param info method and maximum number of samples, which must be at least 2
+ * @param samples the samples of the signal start at first
+ * @param first index of the first sample of the signal
+ */
+void decimateSignalSamples( const SignalDecimationInfo &info, std::vector<CollectedSignal> &samples, size_t first );
+
+} // namespace DataInspection
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -0,0 +1,83 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+#include "CollectionInspectionAPITypes.h"
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataInspection
+{
+
+/**
+ * @brief Pool of TriggeredCollectionSchemeData used by CollectionInspectionEngine for the collected data
+ *
+ * Objects handed out by acquire() are returned to the pool when the last shared_ptr to them is released,
+ * which normally happens on the sender thread after serialization. Returned objects are cleared but keep
+ * the capacity of their vectors, so after the first triggers no heap memory has to be allocated anymore.
+ * If all pooled objects are in use a not pooled object is allocated.
+ */
+class TriggeredCollectionSchemeDataPool : public std::enable_shared_from_this<TriggeredCollectionSchemeDataPool>
+{
+public:
+    // Upper limit for the capacity reserved per vector of a pooled object
+    static constexpr size_t MAX_RESERVED_SAMPLES = 4096;
+
+    /**
+     * @brief Changes the number of pooled objects and the capacity reserved for their vectors.
+     * Objects currently in use that do not fit into the new size are freed when they are released.
+     * @param poolSize maximum number of pooled objects
+     * @param signalCapacity number of signal samples reserved per object, limited to MAX_RESERVED_SAMPLES
+     * @param canFrameCapacity number of CAN frames reserved per object, limited to MAX_RESERVED_SAMPLES
+     */
+    void resize( size_t poolSize, size_t signalCapacity, size_t canFrameCapacity );
+
+    /**
+     * @brief Takes a cleared object out of the pool
+     * @return the object, which goes back to the pool once the last shared_ptr to it is released
+     */
+    std::shared_ptr<TriggeredCollectionSchemeData> acquire();
+
+    /**
+     * @brief Number of pooled objects currently in use
+     */
+    size_t getUsedCount() const;
+
+    /**
+     * @brief Number of pooled objects currently waiting in the pool
+     */
+    size_t getFreeCount() const;
+
+private:
+    void release( TriggeredCollectionSchemeData *data );
+    std::unique_ptr<TriggeredCollectionSchemeData> allocate() const;
+    static void clearData( TriggeredCollectionSchemeData &data );
+
+    mutable std::mutex mMutex;
+    std::vector<std::unique_ptr<TriggeredCollectionSchemeData>> mFreeData;
+    size_t mPoolSize{ 0 };
+    // Number of pooled objects in use or in mFreeData
+    size_t mAllocatedCount{ 0 };
+    size_t mSignalCapacity{ 0 };
+    size_t mCanFrameCapacity{ 0 };
+};
+
+} // namespace DataInspection
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -18,13 +18,13 @@
 #include "IActiveDecoderDictionaryListener.h"
 #include "IVehicleDataConsumer.h"
 #include "LoggingModule.h"
-#include "Signal.h"
-#include "Thread.h"
-#include "Timer.h"
+#include "RetryScheduler.h"
 #include "businterfaces/AbstractVehicleDataSource.h"
 #include <atomic>
 #include <map>
 #include <mutex>
+#include <set>
+#include <vector>
 
 namespace Aws
 {
@@ -41,8 +41,14 @@ using namespace Aws::IoTFleetWise::Platform::Linux;
  * 2- handing the circular buffers of the data sources to the consumers in a thread safe way.
  * 3- Manages the life cycle of the consumer thread
  * 4- receives interrupts when the data sources are disconnected and reflects that to the consumer state.
+ *
+ * The binder has no thread of its own. The connect and disconnect events of the data sources are handled right away
+ * in the context of the source. A consumer that fails to reconnect is retried with exponential backoff on the shared
+ * workers of the RetryScheduler.
  */
-class VehicleDataSourceBinder : public VehicleDataSourceListener, public IActiveDecoderDictionaryListener
+class VehicleDataSourceBinder : public VehicleDataSourceListener,
+                                public IActiveDecoderDictionaryListener,
+                                public IRetryable
 {
 public:
     VehicleDataSourceBinder() = default;
@@ -67,6 +73,8 @@ public:
     bool removeVehicleDataSource( const VehicleDataSourceID &id );
     /**
      * @brief Binds a Vehicle Data Source to a consumer
+     * If the source splits its messages over multiple buffers, this is called once per buffer and the n-th
+     * bound consumer gets the n-th buffer.
      * @param id Vehicle Data Source ID.
      * @param consumer Pointer to the consumer
      * @return True if the circular buffer of the data source is handed over to the consumer.
@@ -74,9 +82,9 @@ public:
      */
     bool bindConsumerToVehicleDataSource( VehicleDataConsumerPtr consumer, const VehicleDataSourceID &id );
     /**
-     * @brief unBinds a Vehicle Data Source from the consumer.
+     * @brief unBinds a Vehicle Data Source from all its consumers.
      * @param id Vehicle Data Source ID.
-     * @return True of the consumer worker is stopped.
+     * @return True if the consumer workers are stopped.
      */
     bool unBindConsumerFromVehicleDataSource( const VehicleDataSourceID &id );
 
@@ -87,14 +95,13 @@ public:
     bool isAlive();
 
     /**
-     * @brief Connect the Binder by starting its worker thread.
+     * @brief Connect the Binder. From now on the events of the data sources are reflected to the consumers.
      * @return True if successful. False otherwise.
      */
     bool connect();
 
     /**
-     * @brief disconnects all Vehicle Data Sources and corresponding consumers. Then stop the worker
-     * thread
+     * @brief Stops pending reconnects and disconnects all Vehicle Data Sources and corresponding consumers.
      * @return True if successful. False otherwise.
      */
     bool disconnect();
@@ -106,44 +113,68 @@ public:
     void onChangeOfActiveDictionary( ConstDecoderDictionaryConstPtr &dictionary,
                                      VehicleDataSourceProtocol networkProtocol ) override;
 
-    using SourcesToConsumers = std::map<VehicleDataSourceID, VehicleDataConsumerPtr>;
+    /**
+     * @brief From IActiveDecoderDictionaryListener. Only the data sources and consumers of the changed channels are
+     * updated, the others keep acquiring and decoding without interruption.
+     */
+    void onIncrementalChangeOfActiveDictionary( ConstDecoderDictionaryConstPtr &dictionary,
+                                                VehicleDataSourceProtocol networkProtocol,
+                                                const DecoderDictionaryDiff &diff ) override;
+
+    // A source splitting its messages over multiple buffers has one consumer per buffer
+    using SourcesToConsumers = std::multimap<VehicleDataSourceID, VehicleDataConsumerPtr>;
     using IdsToDataSources = std::map<VehicleDataSourceID, VehicleDataSourcePtr>;
-    using IdsToStates = std::map<VehicleDataSourceID, VehicleDataSourceState>;
+
+    /**
+     * @brief From IRetryable. Reconnects the consumers of the sources that failed to reconnect before.
+     * @return SUCCESS once no reconnect is pending anymore, RETRY otherwise
+     */
+    RetryStatus attempt() override;
+
+    /**
+     * @brief From IRetryable. Called when the pending reconnects are done or cancelled.
+     */
+    void onFinished( RetryStatus code ) override;
 
 private:
-    // atomic state of the thread. If true, we should stop
-    bool shouldStop() const;
+    static constexpr uint32_t RECONNECT_START_BACKOFF_MS = 100;
+    static constexpr uint32_t RECONNECT_MAX_BACKOFF_MS = 5000;
 
-    // Main work function
-    static void doWork( void *data );
+    /**
+     * @brief Lets the kernel drop all frames of the source that are not in the dictionary before they are copied to
+     * user space
+     */
+    static void setMessageFilter( const CANDecoderDictionary &dictionary, const VehicleDataSourcePtr &source );
 
     /**
-     * @brief starts the binder worker. Worker is ready to bind data sources to consumers.
-     * @return True of the binder worker is running.
+     * @brief Returns the dictionary handed over to the consumers of a channel: the slice of the channel if the
+     * dictionary has slices, else the dictionary itself
      */
-    bool start();
+    static std::shared_ptr<const DecoderDictionary> getChannelDictionary(
+        ConstDecoderDictionaryConstPtr &dictionary,
+        const std::shared_ptr<const CANDecoderDictionary> &canDictionary,
+        VehicleDataSourceID channelID );
 
     /**
-     * @brief stops the binder worker.
-     * @return True of the binder worker is stopped.
+     * @brief Stops the retries of the pending reconnects. Must not be called from attempt()
      */
-    bool stop();
+    void cancelReconnects();
 
     // Listener Callbacks
     void onVehicleDataSourceConnected( const VehicleDataSourceID &id ) override;
     void onVehicleDataSourceDisconnected( const VehicleDataSourceID &id ) override;
     bool reConnectConsumer( const VehicleDataSourceID &id );
     bool disconnectConsumer( const VehicleDataSourceID &id );
+    // Copy of all consumers bound to a data source
+    std::vector<VehicleDataConsumerPtr> getConsumers( const VehicleDataSourceID &id );
 
-    Thread mThread;
-    std::atomic<bool> mShouldStop{ false };
-    mutable std::mutex mThreadMutex;
-    mutable std::mutex mVehicleDataSourceUpdatesMutex;
+    std::atomic<bool> mConnected{ false };
     mutable std::mutex mVehicleDataSourcesMutex;
     mutable std::mutex mConsumersMutex;
-    IdsToStates mDataSourceStates;
-    Platform::Linux::Signal mWait;
-    Timer mTimer;
+    // Guards the sources whose consumers failed to reconnect and the id of their retries
+    std::mutex mReconnectMutex;
+    std::set<VehicleDataSourceID> mPendingReconnects;
+    RetryScheduler::RetryId mReconnectRetryId{ 0 };
     LoggingModule mLogger;
     std::shared_ptr<const Clock> mClock = ClockHandler::getClock();
     SourcesToConsumers mDataSourcesToConsumers;
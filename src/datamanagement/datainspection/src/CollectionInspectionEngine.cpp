@@ -12,10 +12,26 @@
  */
 
 #include "CollectionInspectionEngine.h"
+#include "CANDecoder.h"
 #include "ClockHandler.h"
+#include "LatencyTracer.h"
+#include "SignalDecimation.h"
 #include "TraceModule.h"
 #include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
 #include <iostream>
+#include <iterator>
+#include <set>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <tuple>
+#include <type_traits>
+#include <unistd.h>
 
 namespace Aws
 {
@@ -24,27 +40,567 @@ namespace IoTFleetWise
 namespace DataInspection
 {
 
+constexpr uint32_t CollectionInspectionEngine::DEEP_HISTORY_MEMORY_SAMPLES;
+constexpr uint32_t CollectionInspectionEngine::STATE_FILE_MAGIC;
+constexpr uint32_t CollectionInspectionEngine::STATE_FILE_VERSION;
+
 CollectionInspectionEngine::CollectionInspectionEngine( bool sendDataOnlyOncePerCondition )
     : mSendDataOnlyOncePerCondition( sendDataOnlyOncePerCondition )
 {
     setActiveDTCsConsumed( ALL_CONDITIONS, false );
 }
 
+CollectionInspectionEngine::~CollectionInspectionEngine()
+{
+    traceSampleMemoryUsage( -1 );
+}
+
 CollectionInspectionEngine::SignalHistoryBuffer &
 CollectionInspectionEngine::addSignalToBuffer( const InspectionMatrixSignalCollectionInfo &signal )
 {
-
-    for ( auto &buffer : mSignalBuffers[signal.signalID] )
+    auto signalIndex = getSignalIndex( signal.signalID );
+    if ( signalIndex == INVALID_SIGNAL_INDEX )
+    {
+        // While the matrix is processed all indices are kept in the hash map, the table is built at the end
+        signalIndex = static_cast<uint32_t>( mSignalBuffers.size() );
+        mSparseSignalIndices[signal.signalID] = signalIndex;
+        mSignalBuffers.emplace_back();
+    }
+    auto &bufferVector = mSignalBuffers[signalIndex];
+    auto memorySamples = getMemorySampleDemand( signal );
+    auto deepHistorySize = ( memorySamples < signal.sampleBufferSize ) ? signal.sampleBufferSize : 0;
+    for ( auto &buffer : bufferVector )
     {
         if ( buffer.mMinimumSampleIntervalMs == signal.minimumSampleIntervalMs )
         {
-            buffer.mSize = std::max( buffer.mSize, signal.sampleBufferSize );
+            buffer.mSize = std::max( buffer.mSize, memorySamples );
+            buffer.mDeepHistorySize = std::max( buffer.mDeepHistorySize, deepHistorySize );
             return buffer;
         }
     }
     // No entry with same sample interval found
-    mSignalBuffers[signal.signalID].emplace_back( signal.sampleBufferSize, signal.minimumSampleIntervalMs );
-    return mSignalBuffers[signal.signalID].back();
+    bufferVector.emplace_back( memorySamples, signal.minimumSampleIntervalMs );
+    bufferVector.back().mDeepHistorySize = deepHistorySize;
+    return bufferVector.back();
+}
+
+uint32_t
+CollectionInspectionEngine::getMemorySampleDemand( const InspectionMatrixSignalCollectionInfo &signal ) const
+{
+    if ( signal.deepHistory && ( ( !mDeepHistoryDirectory.empty() ) || mDeepHistoryCompressionEnabled ) )
+    {
+        return std::min( signal.sampleBufferSize, DEEP_HISTORY_MEMORY_SAMPLES );
+    }
+    return signal.sampleBufferSize;
+}
+
+uint32_t
+CollectionInspectionEngine::getEvaluationSignalIndex( uint32_t conditionIndex,
+                                                      InspectionSignalID signalID,
+                                                      bool slidingWindow )
+{
+    auto signalIndex = getSignalIndex( signalID );
+    if ( signalIndex == INVALID_SIGNAL_INDEX )
+    {
+        return INVALID_SIGNAL_INDEX;
+    }
+    auto &bufferVector = mSignalBuffers[signalIndex];
+    EvaluationSignal evaluationSignal;
+    // If the signal is listed multiple times in the condition the last entry is used
+    for ( auto &s : mConditions[conditionIndex].mCondition.signals )
+    {
+        if ( s.signalID != signalID )
+        {
+            continue;
+        }
+        for ( uint32_t bufferIndex = 0; bufferIndex < bufferVector.size(); bufferIndex++ )
+        {
+            auto &buffer = bufferVector[bufferIndex];
+            if ( buffer.mMinimumSampleIntervalMs == s.minimumSampleIntervalMs )
+            {
+                evaluationSignal.mSignalIndex = signalIndex;
+                evaluationSignal.mBufferIndex = bufferIndex;
+                evaluationSignal.mWindowIndex = INVALID_SIGNAL_INDEX;
+                evaluationSignal.mSlidingWindowIndex = INVALID_SIGNAL_INDEX;
+                if ( slidingWindow && ( s.fixedWindowPeriod != 0 ) )
+                {
+                    evaluationSignal.mSlidingWindowIndex = buffer.addSlidingWindow( s.fixedWindowPeriod );
+                }
+                for ( uint32_t windowIndex = 0;
+                      ( s.fixedWindowPeriod != 0 ) && ( windowIndex < buffer.mWindowFunctionData.size() );
+                      windowIndex++ )
+                {
+                    if ( buffer.mWindowFunctionData[windowIndex].mWindowSizeMs == s.fixedWindowPeriod )
+                    {
+                        evaluationSignal.mWindowIndex = windowIndex;
+                        break;
+                    }
+                }
+                break;
+            }
+        }
+    }
+    if ( evaluationSignal.mSignalIndex == INVALID_SIGNAL_INDEX )
+    {
+        return INVALID_SIGNAL_INDEX;
+    }
+    mEvaluationSignals.push_back( evaluationSignal );
+    return static_cast<uint32_t>( mEvaluationSignals.size() - 1 );
+}
+
+bool
+CollectionInspectionEngine::hasSideEffects( const ExpressionNode *expression, int remainingStackDepth )
+{
+    if ( remainingStackDepth <= 0 || expression == nullptr )
+    {
+        return false;
+    }
+    // The geohash function keeps the last geohash to detect changes so it must not be skipped
+    if ( expression->nodeType == ExpressionNodeType::GEOHASHFUNCTION )
+    {
+        return true;
+    }
+    return hasSideEffects( expression->left, remainingStackDepth - 1 ) ||
+           hasSideEffects( expression->right, remainingStackDepth - 1 );
+}
+
+bool
+CollectionInspectionEngine::compileExpression( const ExpressionNode *expression,
+                                               uint32_t conditionIndex,
+                                               int remainingStackDepth )
+{
+    Instruction instruction;
+    if ( remainingStackDepth <= 0 || expression == nullptr )
+    {
+        instruction.opCode = Instruction::OpCode::FAIL;
+        instruction.error = ExpressionErrorCode::STACK_DEPTH_REACHED;
+        mPrograms.push_back( instruction );
+        return false;
+    }
+    switch ( expression->nodeType )
+    {
+    case ExpressionNodeType::FLOAT:
+        instruction.opCode = Instruction::OpCode::PUSH_CONSTANT;
+        instruction.value = expression->floatingValue;
+        mPrograms.push_back( instruction );
+        return true;
+    case ExpressionNodeType::BOOLEAN:
+        instruction.opCode = Instruction::OpCode::PUSH_CONSTANT;
+        instruction.boolValue = expression->booleanValue;
+        mPrograms.push_back( instruction );
+        return true;
+    case ExpressionNodeType::SIGNAL:
+        instruction.opCode = Instruction::OpCode::PUSH_SIGNAL;
+        instruction.index = getEvaluationSignalIndex( conditionIndex, expression->signalID, false );
+        mPrograms.push_back( instruction );
+        return false;
+    case ExpressionNodeType::WINDOWFUNCTION:
+        instruction.opCode = Instruction::OpCode::PUSH_WINDOW_FUNCTION;
+        instruction.windowFunction = expression->function.windowFunction;
+        instruction.index = getEvaluationSignalIndex(
+            conditionIndex, expression->signalID, isSlidingWindowFunction( instruction.windowFunction ) );
+        mPrograms.push_back( instruction );
+        return false;
+    case ExpressionNodeType::GEOHASHFUNCTION:
+        instruction.opCode = Instruction::OpCode::PUSH_GEOHASH;
+        instruction.index =
+            getEvaluationSignalIndex( conditionIndex, expression->function.geohashFunction.latitudeSignalID, false );
+        instruction.secondIndex =
+            getEvaluationSignalIndex( conditionIndex, expression->function.geohashFunction.longitudeSignalID, false );
+        instruction.node = expression;
+        mPrograms.push_back( instruction );
+        return false;
+    case ExpressionNodeType::GEOFENCEFUNCTION:
+        instruction.opCode = Instruction::OpCode::PUSH_GEOFENCE;
+        instruction.index = static_cast<uint32_t>( mGeofenceFunctions.size() );
+        instruction.node = expression;
+        mGeofenceFunctions.emplace_back(
+            getEvaluationSignalIndex( conditionIndex, expression->function.geofenceFunction.latitudeSignalID, false ),
+            getEvaluationSignalIndex( conditionIndex, expression->function.geofenceFunction.longitudeSignalID, false ),
+            expression->function.geofenceFunction.geofences );
+        mPrograms.push_back( instruction );
+        return false;
+    case ExpressionNodeType::RAWFRAMEFIELD:
+        if ( !compileRawFrameField( expression->function.rawFrameField, conditionIndex, instruction ) )
+        {
+            instruction.opCode = Instruction::OpCode::FAIL;
+            instruction.error = ExpressionErrorCode::SIGNAL_NOT_FOUND;
+        }
+        mPrograms.push_back( instruction );
+        return false;
+    default:
+        break;
+    }
+    if ( compileThresholdLeaf( expression, conditionIndex ) )
+    {
+        return false;
+    }
+    // Sub expressions used multiple times, by one or by multiple conditions, are evaluated once per evaluation pass
+    auto useCount = mExpressionUseCounts.find( expression );
+    if ( ( useCount == mExpressionUseCounts.end() ) || ( useCount->second < 2 ) ||
+         hasSideEffects( expression, remainingStackDepth ) )
+    {
+        return compileOperator( expression, conditionIndex, remainingStackDepth );
+    }
+    auto begin = mPrograms.size();
+    if ( compileOperator( expression, conditionIndex, remainingStackDepth ) )
+    {
+        // Folded to a constant
+        return true;
+    }
+    shareProgram( expression, begin );
+    return false;
+}
+
+bool
+CollectionInspectionEngine::compileRawFrameField( const RawFrameField &field,
+                                                  uint32_t conditionIndex,
+                                                  Instruction &instruction )
+{
+    // The bit field is read from the buffer of the frame with the smallest sample interval of the condition
+    uint32_t bufferIndex = INVALID_SIGNAL_INDEX;
+    for ( const auto &c : mConditions[conditionIndex].mCondition.canFrames )
+    {
+        if ( ( c.frameID != field.frameID ) || ( c.channelID != field.channelID ) )
+        {
+            continue;
+        }
+        auto index = getCanFrameBufferIndex( c.frameID, c.channelID, c.minimumSampleIntervalMs );
+        if ( index == INVALID_SIGNAL_INDEX )
+        {
+            continue;
+        }
+        if ( ( bufferIndex == INVALID_SIGNAL_INDEX ) || ( mCanFrameBuffers[index].mMinimumSampleIntervalMs <
+                                                           mCanFrameBuffers[bufferIndex].mMinimumSampleIntervalMs ) )
+        {
+            bufferIndex = index;
+        }
+    }
+    if ( bufferIndex == INVALID_SIGNAL_INDEX )
+    {
+        mLogger.warn( "CollectionInspectionEngine::compileRawFrameField",
+                      "Frame " + std::to_string( field.frameID ) + " of a raw frame field is not captured" );
+        return false;
+    }
+    // Compiled like a signal of the frame, so that the field is read with a single load like decoded signals
+    CANMessageFormat format;
+    format.mMessageID = field.frameID;
+    format.mSizeInBytes = MAX_CANFD_FRAME_BYTE_SIZE;
+    CANSignalFormat signal;
+    signal.mIsBigEndian = field.isBigEndian;
+    signal.mIsSigned = field.isSigned;
+    signal.mFirstBitPosition = field.startBit;
+    signal.mSizeInBits = field.length;
+    format.mSignals.push_back( signal );
+    auto plan = CANDecoder::compileDecodePlan( format, { signal.mSignalID } );
+    if ( ( plan.mSteps.size() != 1 ) || ( plan.mSteps[0].mMinFrameSize > MAX_CANFD_FRAME_BYTE_SIZE ) )
+    {
+        mLogger.warn( "CollectionInspectionEngine::compileRawFrameField",
+                      "Invalid raw frame field of frame " + std::to_string( field.frameID ) );
+        return false;
+    }
+    instruction.opCode = Instruction::OpCode::PUSH_RAW_FRAME_FIELD;
+    instruction.index = static_cast<uint32_t>( mRawFrameFields.size() );
+    RawFrameFieldEvaluation evaluation;
+    evaluation.mBufferIndex = bufferIndex;
+    evaluation.mStep = plan.mSteps[0];
+    mRawFrameFields.push_back( evaluation );
+    auto &conditions = mCanFrameBuffers[bufferIndex].mConditionsThatEvaluateOnThisFrame;
+    if ( conditions.empty() || ( conditions.back() != conditionIndex ) )
+    {
+        conditions.push_back( conditionIndex );
+    }
+    return true;
+}
+
+bool
+CollectionInspectionEngine::compileOperator( const ExpressionNode *expression,
+                                             uint32_t conditionIndex,
+                                             int remainingStackDepth )
+{
+    Instruction instruction;
+    auto begin = mPrograms.size();
+    // Recursion limited depth through last parameter
+    bool constant = compileExpression( expression->left, conditionIndex, remainingStackDepth - 1 );
+    auto jump = mPrograms.size();
+    bool shortCircuit = ( ( expression->nodeType == ExpressionNodeType::OPERATOR_LOGICAL_AND ) ||
+                          ( expression->nodeType == ExpressionNodeType::OPERATOR_LOGICAL_OR ) ) &&
+                        ( !hasSideEffects( expression->right, remainingStackDepth - 1 ) );
+    if ( shortCircuit )
+    {
+        instruction.opCode = ( expression->nodeType == ExpressionNodeType::OPERATOR_LOGICAL_AND )
+                                 ? Instruction::OpCode::JUMP_IF_FALSE
+                                 : Instruction::OpCode::JUMP_IF_TRUE;
+        mPrograms.push_back( instruction );
+    }
+    // Logical NOT operator does not have a right operand, hence expression->right can be nullptr
+    if ( expression->nodeType != ExpressionNodeType::OPERATOR_LOGICAL_NOT )
+    {
+        constant = compileExpression( expression->right, conditionIndex, remainingStackDepth - 1 ) && constant;
+    }
+    instruction.opCode = Instruction::OpCode::OPERATOR;
+    instruction.nodeType = expression->nodeType;
+    mPrograms.push_back( instruction );
+    if ( shortCircuit )
+    {
+        mPrograms[jump].index = static_cast<uint32_t>( mPrograms.size() );
+    }
+
+    if ( !constant )
+    {
+        return false;
+    }
+    // All operands are constant so replace the program of this node by its result
+    EvaluationValue result;
+    auto ret = runProgram( mPrograms, begin, mPrograms.size(), result );
+    mPrograms.resize( begin );
+    instruction = Instruction();
+    if ( ret != ExpressionErrorCode::SUCCESSFUL )
+    {
+        instruction.opCode = Instruction::OpCode::FAIL;
+        instruction.error = ret;
+        mPrograms.push_back( instruction );
+        return false;
+    }
+    instruction.opCode = Instruction::OpCode::PUSH_CONSTANT;
+    instruction.value = result.mDouble;
+    instruction.boolValue = result.mBool;
+    mPrograms.push_back( instruction );
+    return true;
+}
+
+void
+CollectionInspectionEngine::shareProgram( const ExpressionNode *expression, size_t begin )
+{
+    auto length = mPrograms.size() - begin;
+    auto &candidates = mSharedExpressionsOfNode[expression];
+    uint32_t sharedIndex = INVALID_SIGNAL_INDEX;
+    for ( auto candidate : candidates )
+    {
+        const auto &shared = mSharedExpressions[candidate];
+        if ( shared.mProgramLength != length )
+        {
+            continue;
+        }
+        bool same = true;
+        for ( size_t i = 0; same && ( i < length ); i++ )
+        {
+            same = isSameInstruction(
+                mSharedPrograms[shared.mProgramStart + i], shared.mProgramStart, mPrograms[begin + i], begin );
+        }
+        if ( same )
+        {
+            sharedIndex = candidate;
+            break;
+        }
+    }
+    if ( sharedIndex == INVALID_SIGNAL_INDEX )
+    {
+        // The node is used the first time or with other signal buffers or windows
+        SharedExpression shared;
+        shared.mProgramStart = static_cast<uint32_t>( mSharedPrograms.size() );
+        shared.mProgramLength = static_cast<uint32_t>( length );
+        for ( size_t i = begin; i < mPrograms.size(); i++ )
+        {
+            auto instruction = mPrograms[i];
+            if ( ( instruction.opCode == Instruction::OpCode::JUMP_IF_FALSE ) ||
+                 ( instruction.opCode == Instruction::OpCode::JUMP_IF_TRUE ) )
+            {
+                instruction.index = static_cast<uint32_t>( instruction.index - begin + shared.mProgramStart );
+            }
+            mSharedPrograms.push_back( instruction );
+        }
+        sharedIndex = static_cast<uint32_t>( mSharedExpressions.size() );
+        mSharedExpressions.push_back( shared );
+        candidates.push_back( sharedIndex );
+    }
+    mPrograms.resize( begin );
+    Instruction instruction;
+    instruction.opCode = Instruction::OpCode::PUSH_SHARED;
+    instruction.index = sharedIndex;
+    mPrograms.push_back( instruction );
+}
+
+bool
+CollectionInspectionEngine::isSameInstruction( const Instruction &shared,
+                                               size_t sharedStart,
+                                               const Instruction &instruction,
+                                               size_t start ) const
+{
+    bool sameValue =
+        ( shared.value == instruction.value ) || ( std::isnan( shared.value ) && std::isnan( instruction.value ) );
+    if ( ( shared.opCode != instruction.opCode ) || ( shared.nodeType != instruction.nodeType ) ||
+         ( shared.windowFunction != instruction.windowFunction ) || ( shared.error != instruction.error ) ||
+         ( shared.boolValue != instruction.boolValue ) || ( shared.node != instruction.node ) || ( !sameValue ) )
+    {
+        return false;
+    }
+    switch ( instruction.opCode )
+    {
+    case Instruction::OpCode::PUSH_SIGNAL:
+    case Instruction::OpCode::PUSH_WINDOW_FUNCTION:
+    {
+        // Every condition has own evaluation signals, they have to point to the same buffer and windows
+        if ( ( shared.index == INVALID_SIGNAL_INDEX ) || ( instruction.index == INVALID_SIGNAL_INDEX ) )
+        {
+            return shared.index == instruction.index;
+        }
+        const auto &a = mEvaluationSignals[shared.index];
+        const auto &b = mEvaluationSignals[instruction.index];
+        return ( a.mSignalIndex == b.mSignalIndex ) && ( a.mBufferIndex == b.mBufferIndex ) &&
+               ( a.mWindowIndex == b.mWindowIndex ) && ( a.mSlidingWindowIndex == b.mSlidingWindowIndex );
+    }
+    case Instruction::OpCode::JUMP_IF_FALSE:
+    case Instruction::OpCode::JUMP_IF_TRUE:
+        return ( shared.index - sharedStart ) == ( instruction.index - start );
+    default:
+        // The same threshold leaf or shared expression has the same index
+        return shared.index == instruction.index;
+    }
+}
+
+void
+CollectionInspectionEngine::countExpressionUses( const ExpressionNode *expression, int remainingStackDepth )
+{
+    if ( remainingStackDepth <= 0 || expression == nullptr )
+    {
+        return;
+    }
+    mExpressionUseCounts[expression]++;
+    // Recursion limited depth through last parameter
+    countExpressionUses( expression->left, remainingStackDepth - 1 );
+    countExpressionUses( expression->right, remainingStackDepth - 1 );
+}
+
+bool
+CollectionInspectionEngine::compileThresholdLeaf( const ExpressionNode *expression, uint32_t conditionIndex )
+{
+    auto nodeType = expression->nodeType;
+    if ( ( nodeType != ExpressionNodeType::OPERATOR_SMALLER ) && ( nodeType != ExpressionNodeType::OPERATOR_BIGGER ) &&
+         ( nodeType != ExpressionNodeType::OPERATOR_SMALLER_EQUAL ) &&
+         ( nodeType != ExpressionNodeType::OPERATOR_BIGGER_EQUAL ) &&
+         ( nodeType != ExpressionNodeType::OPERATOR_EQUAL ) )
+    {
+        return false;
+    }
+    if ( ( expression->left == nullptr ) || ( expression->right == nullptr ) )
+    {
+        return false;
+    }
+    const ExpressionNode *signal = expression->left;
+    const ExpressionNode *constant = expression->right;
+    if ( ( signal->nodeType == ExpressionNodeType::FLOAT ) && ( constant->nodeType == ExpressionNodeType::SIGNAL ) )
+    {
+        // Turn constant op signal around to signal op constant
+        std::swap( signal, constant );
+        switch ( nodeType )
+        {
+        case ExpressionNodeType::OPERATOR_SMALLER:
+            nodeType = ExpressionNodeType::OPERATOR_BIGGER;
+            break;
+        case ExpressionNodeType::OPERATOR_BIGGER:
+            nodeType = ExpressionNodeType::OPERATOR_SMALLER;
+            break;
+        case ExpressionNodeType::OPERATOR_SMALLER_EQUAL:
+            nodeType = ExpressionNodeType::OPERATOR_BIGGER_EQUAL;
+            break;
+        case ExpressionNodeType::OPERATOR_BIGGER_EQUAL:
+            nodeType = ExpressionNodeType::OPERATOR_SMALLER_EQUAL;
+            break;
+        default:
+            break;
+        }
+    }
+    if ( ( signal->nodeType != ExpressionNodeType::SIGNAL ) || ( constant->nodeType != ExpressionNodeType::FLOAT ) ||
+         std::isnan( constant->floatingValue ) )
+    {
+        return false;
+    }
+    auto evaluationSignalIndex = getEvaluationSignalIndex( conditionIndex, signal->signalID, false );
+    if ( evaluationSignalIndex == INVALID_SIGNAL_INDEX )
+    {
+        return false;
+    }
+    const auto &evaluationSignal = mEvaluationSignals[evaluationSignalIndex];
+    auto &buffer = mSignalBuffers[evaluationSignal.mSignalIndex][evaluationSignal.mBufferIndex];
+    ThresholdLeaf leaf;
+    leaf.mThreshold = constant->floatingValue;
+    leaf.mOperator = nodeType;
+    // Keep the table sorted, so updates only have to look at the thresholds between two samples
+    auto position = std::upper_bound( buffer.mThresholds.begin(),
+                                      buffer.mThresholds.end(),
+                                      leaf,
+                                      []( const ThresholdLeaf &x, const ThresholdLeaf &y ) {
+                                          return x.mThreshold < y.mThreshold;
+                                      } );
+    // The same comparison of other conditions is already in the table before the insert position
+    auto existing = position;
+    while ( ( existing != buffer.mThresholds.begin() ) && ( ( existing - 1 )->mThreshold == leaf.mThreshold ) &&
+            ( ( existing - 1 )->mOperator != nodeType ) )
+    {
+        existing--;
+    }
+    if ( ( existing != buffer.mThresholds.begin() ) && ( ( existing - 1 )->mThreshold == leaf.mThreshold ) )
+    {
+        leaf.mLeafIndex = ( existing - 1 )->mLeafIndex;
+    }
+    else
+    {
+        leaf.mLeafIndex = static_cast<uint32_t>( mThresholdLeafValues.size() );
+        mThresholdLeafValues.push_back( 0 );
+        buffer.mThresholds.insert( position, leaf );
+    }
+
+    Instruction instruction;
+    instruction.opCode = Instruction::OpCode::PUSH_THRESHOLD;
+    instruction.index = leaf.mLeafIndex;
+    instruction.secondIndex = evaluationSignalIndex;
+    mPrograms.push_back( instruction );
+    return true;
+}
+
+bool
+CollectionInspectionEngine::compareWithThreshold( InspectionValue value, const ThresholdLeaf &leaf )
+{
+    switch ( leaf.mOperator )
+    {
+    case ExpressionNodeType::OPERATOR_SMALLER:
+        return value < leaf.mThreshold;
+    case ExpressionNodeType::OPERATOR_BIGGER:
+        return value > leaf.mThreshold;
+    case ExpressionNodeType::OPERATOR_SMALLER_EQUAL:
+        return value <= leaf.mThreshold;
+    case ExpressionNodeType::OPERATOR_BIGGER_EQUAL:
+        return value >= leaf.mThreshold;
+    default:
+        return std::abs( value - leaf.mThreshold ) < EVAL_EQUAL_DISTANCE();
+    }
+}
+
+void
+CollectionInspectionEngine::updateThresholdLeaves( SignalHistoryBuffer &buffer, InspectionValue value )
+{
+    auto begin = buffer.mThresholds.begin();
+    auto end = buffer.mThresholds.end();
+    if ( buffer.mThresholdValueValid && ( !std::isnan( value ) ) && ( !std::isnan( buffer.mThresholdValue ) ) )
+    {
+        // A comparison can only change its result if the threshold is between the previous and the new sample,
+        // the equal distance widens the range for the equal operator
+        auto lower = std::min( value, buffer.mThresholdValue ) - EVAL_EQUAL_DISTANCE();
+        auto upper = std::max( value, buffer.mThresholdValue ) + EVAL_EQUAL_DISTANCE();
+        begin = std::lower_bound( begin, end, lower, []( const ThresholdLeaf &leaf, InspectionValue threshold ) {
+            return leaf.mThreshold < threshold;
+        } );
+        end = std::upper_bound( begin, end, upper, []( InspectionValue threshold, const ThresholdLeaf &leaf ) {
+            return threshold < leaf.mThreshold;
+        } );
+    }
+    for ( auto it = begin; it != end; it++ )
+    {
+        mThresholdLeafValues[it->mLeafIndex] = compareWithThreshold( value, *it ) ? 1 : 0;
+    }
+    buffer.mThresholdValue = value;
+    buffer.mThresholdValueValid = true;
 }
 
 bool
@@ -66,6 +622,11 @@ CollectionInspectionEngine::isSignalPartOfEval( const struct ExpressionNode *exp
         return expression->function.geohashFunction.latitudeSignalID == signalID ||
                expression->function.geohashFunction.longitudeSignalID == signalID;
     }
+    else if ( expression->nodeType == ExpressionNodeType::GEOFENCEFUNCTION )
+    {
+        return expression->function.geofenceFunction.latitudeSignalID == signalID ||
+               expression->function.geofenceFunction.longitudeSignalID == signalID;
+    }
     // Recursion limited depth through last parameter
     bool leftRet = isSignalPartOfEval( expression->left, signalID, remainingStackDepth - 1 );
     bool rightRet = isSignalPartOfEval( expression->right, signalID, remainingStackDepth - 1 );
@@ -76,11 +637,40 @@ void
 CollectionInspectionEngine::onChangeInspectionMatrix(
     const std::shared_ptr<const InspectionMatrix> &activeInspectionMatrix )
 {
-    // Clears everything in this class including all data in the signal history buffer
+    // Keep the buffers of the previous matrix aside, the history of signals and frames that are still collected
+    // is taken over by the buffers of the new matrix. The rest is freed at the end of this function.
+    auto previousInspectionMatrix = mActiveInspectionMatrix;
+    auto previousConditions = std::move( mConditions );
+    auto previousConditionStates = std::move( mConditionStates );
+    auto previousSignalBuffers = std::move( mSignalBuffers );
+    auto previousCanFrameBuffers = std::move( mCanFrameBuffers );
+    auto previousSignalIndices = std::move( mSparseSignalIndices );
+    auto previousPeriodicGroups = std::move( mPeriodicGroups );
+    for ( InspectionSignalID id = 0; id < mSignalIndexTable.size(); id++ )
+    {
+        if ( mSignalIndexTable[id] != INVALID_SIGNAL_INDEX )
+        {
+            previousSignalIndices[id] = mSignalIndexTable[id];
+        }
+    }
     clear();
     mActiveInspectionMatrix = activeInspectionMatrix; // Pointers and references into this memory are maintained so hold
                                                       // a shared_ptr to it so it does not get deleted
+    mInspectionMatrixFingerprint = getInspectionMatrixFingerprint( *mActiveInspectionMatrix );
+    auto conditionCount =
+        std::min<size_t>( mActiveInspectionMatrix->conditions.size(), MAX_NUMBER_OF_ACTIVE_CONDITION );
+    mConditionsWithInputSignalChanged.resize( conditionCount );
+    mConditionsWithConditionCurrentlyTrue.resize( conditionCount );
+    mConditionsEvaluatedWhileTrue.resize( conditionCount );
+    mConditionsNotTriggeredWaitingPublished.resize( conditionCount );
+    mActiveDTCsConsumed.resize( conditionCount );
     mConditionsNotTriggeredWaitingPublished.set();
+    mConditions.reserve( conditionCount );
+    mConditionStates.reserve( conditionCount );
+    for ( size_t conditionIndex = 0; conditionIndex < conditionCount; conditionIndex++ )
+    {
+        countExpressionUses( mActiveInspectionMatrix->conditions[conditionIndex].condition, MAX_EQUATION_DEPTH );
+    }
     for ( auto &p : mActiveInspectionMatrix->conditions )
     {
         // Check if we can add an additional condition to mConditions
@@ -94,6 +684,12 @@ CollectionInspectionEngine::onChangeInspectionMatrix(
             break;
         }
         mConditions.emplace_back( p );
+        mConditionStates.emplace_back();
+        auto &state = mConditionStates.back();
+        state.mMinimumPublishInterval = p.minimumPublishInterval;
+        state.mEvaluationIntervalMs = p.evaluationIntervalMs;
+        state.mEvaluationBudgetUs = p.evaluationBudgetUs;
+        state.mTriggerOnlyOnRisingEdge = p.triggerOnlyOnRisingEdge;
         if ( p.signals.size() > MAX_DIFFERENT_SIGNAL_IDS )
         {
             TraceModule::get().incrementVariable( TraceVariable::CE_SIGNAL_ID_OUTBOUND );
@@ -118,751 +714,3489 @@ CollectionInspectionEngine::onChangeInspectionMatrix(
                 return;
             }
             SignalHistoryBuffer &buf = addSignalToBuffer( s );
-            buf.addFixedWindow( s.fixedWindowPeriod );
+            auto *window = buf.addFixedWindow( s.fixedWindowPeriod );
+            if ( ( window != nullptr ) && ( s.aggregation != nullptr ) && ( !s.isConditionOnlySignal ) )
+            {
+                window->mAggregators.emplace_back(
+                    s.signalID, static_cast<uint32_t>( mConditions.size() - 1 ), s.aggregation );
+            }
         }
         for ( auto &c : p.canFrames )
         {
-            bool found = false;
-            for ( auto &buf : mCanFrameBuffers )
+            auto bufferIndex = getCanFrameBufferIndex( c.frameID, c.channelID, c.minimumSampleIntervalMs );
+            if ( bufferIndex != INVALID_SIGNAL_INDEX )
             {
-                if ( buf.mFrameID == c.frameID && buf.mChannelID == c.channelID &&
-                     buf.mMinimumSampleIntervalMs == c.minimumSampleIntervalMs )
-                {
-                    found = true;
-                    buf.mSize = std::max( buf.mSize, c.sampleBufferSize );
-                    break;
-                }
+                auto &buf = mCanFrameBuffers[bufferIndex];
+                buf.mSize = std::max( buf.mSize, c.sampleBufferSize );
             }
-            if ( !found )
+            else
             {
+                mCanFrameBufferIndices[getCanFrameKey( c.frameID, c.channelID )].push_back(
+                    static_cast<uint32_t>( mCanFrameBuffers.size() ) );
                 mCanFrameBuffers.emplace_back( c.frameID, c.channelID, c.sampleBufferSize, c.minimumSampleIntervalMs );
             }
         }
+        state.mProgramStart = static_cast<uint32_t>( mPrograms.size() );
+        (void)compileExpression( p.condition, static_cast<uint32_t>( mConditions.size() - 1 ), MAX_EQUATION_DEPTH );
+        state.mProgramLength = static_cast<uint32_t>( mPrograms.size() ) - state.mProgramStart;
     }
+    mExpressionUseCounts.clear();
+    mSharedExpressionsOfNode.clear();
+#ifdef FWE_FEATURE_CONDITION_JIT
+    compileNativeConditions();
+#endif // FWE_FEATURE_CONDITION_JIT
 
-    // At this point all buffers should be resized to correct size. Now pointer to std::vector elements can be used
-    for ( size_t conditionIndex = 0; conditionIndex < mConditions.size(); conditionIndex++ )
+    // Move the indices of all signal IDs that fit into the table out of the hash map
+    for ( auto it = mSparseSignalIndices.begin(); it != mSparseSignalIndices.end(); )
     {
-        auto &ac = mConditions[conditionIndex];
-        for ( auto &s : ac.mCondition.signals )
+        if ( it->first > MAX_SIGNAL_INDEX_TABLE_ID )
         {
-            SignalHistoryBuffer *buf = nullptr;
-            for ( auto &buffer : mSignalBuffers[s.signalID] )
+            it++;
+            continue;
+        }
+        if ( it->first >= mSignalIndexTable.size() )
+        {
+            mSignalIndexTable.resize( static_cast<size_t>( it->first ) + 1, uint32_t{ INVALID_SIGNAL_INDEX } );
+        }
+        mSignalIndexTable[it->first] = it->second;
+        it = mSparseSignalIndices.erase( it );
+    }
+    // The Decoder Manifest indexes are dense, so the table has at most one entry per signal of the manifest
+    for ( const auto &condition : mConditions )
+    {
+        for ( const auto &signal : condition.mCondition.signals )
+        {
+            if ( signal.signalIndex == INVALID_MANIFEST_SIGNAL_INDEX )
             {
-                if ( buffer.mMinimumSampleIntervalMs == s.minimumSampleIntervalMs )
-                {
-                    buf = &buffer;
-                    break;
-                }
+                continue;
             }
-            if ( buf != nullptr && isSignalPartOfEval( ac.mCondition.condition, s.signalID, MAX_EQUATION_DEPTH ) )
+            if ( signal.signalIndex >= mManifestSignalIndexTable.size() )
             {
-                buf->mConditionsThatEvaluateOnThisSignal.set( conditionIndex );
-                ac.mEvaluationSignals[s.signalID] = buf;
-                FixedTimeWindowFunctionData *window = buf->getFixedWindow( s.fixedWindowPeriod );
-                if ( window != nullptr )
-                {
-                    ac.mEvaluationFunctions[s.signalID] = window;
-                }
+                mManifestSignalIndexTable.resize( static_cast<size_t>( signal.signalIndex ) + 1 );
             }
+            mManifestSignalIndexTable[signal.signalIndex] = { signal.signalID, getSignalIndex( signal.signalID ) };
         }
     }
 
-    // Assume all conditions are currently true;
-    mConditionsWithConditionCurrentlyTrue.set();
+    applySampleMemoryBudget();
 
-    (void)preAllocateBuffers();
-}
-bool
-CollectionInspectionEngine::preAllocateBuffers()
-{
-    // Allocate size
-    uint32_t usedBytes = 0;
-    // Allocate Signal Buffer
-    for ( auto &bufferVector : mSignalBuffers )
+    // Take over the history of the buffers that are used by the previous and the new matrix
+    auto conditionMap = mapPreviousConditions( previousConditions, previousConditionStates );
+    for ( const auto &previousSignal : previousSignalIndices )
     {
-        // Go trough different sample intervals
-        for ( auto &signal : bufferVector.second )
+        auto signalIndex = getSignalIndex( previousSignal.first );
+        if ( signalIndex == INVALID_SIGNAL_INDEX )
         {
-            uint64_t requiredBytes = signal.mSize * static_cast<uint64_t>( sizeof( struct SignalSample ) );
-            if ( usedBytes + requiredBytes > MAX_SAMPLE_MEMORY )
+            continue;
+        }
+        auto &previousBufferVector = previousSignalBuffers[previousSignal.second];
+        auto &bufferVector = mSignalBuffers[signalIndex];
+        for ( auto &previousBuffer : previousBufferVector )
+        {
+            auto *buffer = previousBuffer.isView()
+                               ? nullptr
+                               : getSignalBuffer( previousSignal.first, previousBuffer.mMinimumSampleIntervalMs );
+            if ( buffer != nullptr )
             {
-                mLogger.warn( "CollectionInspectionEngine::preAllocateBuffers",
-                              "The requested " + std::to_string( signal.mSize ) +
-                                  " number of signal samples leads to a memory requirement  that's above the maximum "
-                                  "configured of " +
-                                  std::to_string( MAX_SAMPLE_MEMORY ) + "Bytes" );
-                signal.mSize = 0;
-                return false;
+                takeOverSignalHistory( *buffer, previousBuffer, conditionMap );
             }
-            usedBytes += static_cast<uint32_t>( requiredBytes );
-
-            // reserve the size like new[]
-            signal.mBuffer.resize( signal.mSize );
         }
-    }
-    // Allocate Can buffer
-    for ( auto &buf : mCanFrameBuffers )
-    {
-        uint64_t requiredBytes = buf.mSize * static_cast<uint64_t>( sizeof( struct CanFrameSample ) );
-        if ( usedBytes + requiredBytes > MAX_SAMPLE_MEMORY )
+        // The views are taken over after their base buffer. A view stays a view if the new base buffer still has
+        // its samples, otherwise it gets its own chunks.
+        auto baseBufferIndex = getBaseBufferIndex( bufferVector );
+        for ( auto &previousBuffer : previousBufferVector )
         {
-            mLogger.warn( "CollectionInspectionEngine::preAllocateBuffers",
-                          "The requested " + std::to_string( buf.mSize ) +
-                              " number of CAN raw samples leads to a memory requirement  that's above the maximum "
-                              "configured of" +
-                              std::to_string( MAX_SAMPLE_MEMORY ) + "Bytes" );
-            buf.mSize = 0;
-            return false;
+            auto *buffer = previousBuffer.isView()
+                               ? getSignalBuffer( previousSignal.first, previousBuffer.mMinimumSampleIntervalMs )
+                               : nullptr;
+            if ( buffer == nullptr )
+            {
+                continue;
+            }
+            const auto &previousBase = previousBufferVector[previousBuffer.mBaseBufferIndex];
+            if ( ( baseBufferIndex != INVALID_SIGNAL_INDEX ) && ( bufferVector[baseBufferIndex].mSize > 0 ) &&
+                 ( buffer->mSize > 0 ) && ( buffer->mDeepHistorySize == 0 ) )
+            {
+                const auto &base = bufferVector[baseBufferIndex];
+                auto droppedBaseSamples =
+                    ( previousBase.mCounter > base.mCounter ) ? ( previousBase.mCounter - base.mCounter ) : 0;
+                if ( takeOverSignalView(
+                         *buffer, previousBuffer, baseBufferIndex, base, droppedBaseSamples, conditionMap ) )
+                {
+                    continue;
+                }
+            }
+            // The chunks of the previous base buffer were moved to the new one if its size did not change
+            materializeSignalView( previousBuffer,
+                                   previousBase.isAllocated() ? previousBase : bufferVector[baseBufferIndex] );
+            takeOverSignalHistory( *buffer, previousBuffer, conditionMap );
+        }
+    }
+    for ( auto &previousBuffer : previousCanFrameBuffers )
+    {
+        auto bufferIndex = getCanFrameBufferIndex(
+            previousBuffer.mFrameID, previousBuffer.mChannelID, previousBuffer.mMinimumSampleIntervalMs );
+        if ( bufferIndex != INVALID_SIGNAL_INDEX )
+        {
+            takeOverCanFrameHistory( mCanFrameBuffers[bufferIndex], previousBuffer, conditionMap );
         }
-        usedBytes += static_cast<uint32_t>( requiredBytes );
-
-        // reserve the size like new[]
-        buf.mBuffer.resize( buf.mSize );
     }
-    return true;
-}
 
-void
-CollectionInspectionEngine::clear()
-{
-    mSignalBuffers.clear();
-    mCanFrameBuffers.clear();
-    mConditions.clear();
-    mNextConditionToCollectedIndex = 0;
-    mNextWindowFunctionTimesOut = 0;
-    mConditionsWithInputSignalChanged.reset();
-    mConditionsWithConditionCurrentlyTrue.reset();
-    mConditionsNotTriggeredWaitingPublished.reset();
-}
+    assignSignalViews();
 
-void
-CollectionInspectionEngine::updateAllFixedWindowFunctions( InspectionTimestamp timestamp )
-{
-    mNextWindowFunctionTimesOut = std::numeric_limits<InspectionTimestamp>::max();
-    for ( auto &signalVector : mSignalBuffers )
+    // The threshold leaves of buffers that took over their history start with the latest sample
+    for ( auto &bufferVector : mSignalBuffers )
     {
-        for ( auto &signal : signalVector.second )
+        for ( auto &buf : bufferVector )
         {
-            for ( auto &functionWindow : signal.mWindowFunctionData )
+            if ( ( !buf.mThresholds.empty() ) && ( buf.mCounter > 0 ) )
             {
-                bool changed = functionWindow.updateWindow( timestamp, mNextWindowFunctionTimesOut );
-                if ( changed )
-                {
-                    mConditionsWithInputSignalChanged |= signal.mConditionsThatEvaluateOnThisSignal;
-                }
+                updateThresholdLeaves( buf, getNewestValue( bufferVector, buf ) );
             }
         }
     }
-}
 
-bool
-CollectionInspectionEngine::evaluateConditions( InspectionTimestamp currentTime )
-{
-    bool oneConditionIsTrue = false;
-    // if any sampling window times out there is a new value available to be processed by a condition
-    if ( currentTime >= mNextWindowFunctionTimesOut )
-    {
-        updateAllFixedWindowFunctions( currentTime );
-    }
-    auto conditionsToEvaluate = ( mConditionsWithConditionCurrentlyTrue | mConditionsWithInputSignalChanged ) &
-                                mConditionsNotTriggeredWaitingPublished;
-    if ( conditionsToEvaluate.none() )
-    {
-        // No conditions to evaluate
-        return false;
-    }
-    // faster implementation like find next bit set to one would be possible but for example
-    // conditionsToEvaluate._Find_first is not part of C++ standard
-    for ( uint32_t i = 0; i < mConditions.size(); i++ )
+    // At this point all buffers should be resized to correct size. Now pointer to std::vector elements can be used
+    for ( size_t conditionIndex = 0; conditionIndex < mConditions.size(); conditionIndex++ )
     {
-        if ( conditionsToEvaluate.test( i ) )
+        auto &ac = mConditions[conditionIndex];
+        for ( auto &s : ac.mCondition.signals )
         {
-            ActiveCondition &condition = mConditions[i];
-            if ( ( currentTime >= condition.mLastTrigger + condition.mCondition.minimumPublishInterval ) )
+            auto signalIndex = getSignalIndex( s.signalID );
+            if ( signalIndex == INVALID_SIGNAL_INDEX )
             {
-                InspectionValue result = 0;
-                bool resultBool = false;
-                mConditionsWithInputSignalChanged.reset( i );
-                ExpressionErrorCode ret =
-                    eval( condition.mCondition.condition, condition, result, resultBool, MAX_EQUATION_DEPTH );
-                if ( ret == ExpressionErrorCode::SUCCESSFUL && resultBool )
+                continue;
+            }
+            SignalHistoryBuffer *buf = nullptr;
+            for ( auto &buffer : mSignalBuffers[signalIndex] )
+            {
+                if ( buffer.mMinimumSampleIntervalMs == s.minimumSampleIntervalMs )
                 {
-                    if ( !condition.mCondition.triggerOnlyOnRisingEdge ||
-                         !mConditionsWithConditionCurrentlyTrue.test( i ) )
-                    {
-                        mConditionsNotTriggeredWaitingPublished.reset( i );
-                        condition.mLastTrigger = currentTime;
-                    }
-                    mConditionsWithConditionCurrentlyTrue.set( i );
-                    oneConditionIsTrue = true;
+                    buf = &buffer;
+                    break;
                 }
-                else
+            }
+            if ( buf != nullptr && isSignalPartOfEval( ac.mCondition.condition, s.signalID, MAX_EQUATION_DEPTH ) )
+            {
+                auto &conditions = buf->mConditionsThatEvaluateOnThisSignal;
+                if ( conditions.empty() || ( conditions.back() != conditionIndex ) )
                 {
-                    mConditionsWithConditionCurrentlyTrue.reset( i );
+                    conditions.push_back( static_cast<uint32_t>( conditionIndex ) );
                 }
             }
         }
+        if ( isPeriodicCondition( ac.mCondition ) )
+        {
+            addPeriodicCondition( static_cast<uint32_t>( conditionIndex ), previousPeriodicGroups );
+        }
+        // Without an input change the result of a condition only changes if it has side effects. Conditions that
+        // trigger repeatedly while true depend on the time since their last trigger.
+        else if ( !ac.mCondition.triggerOnlyOnRisingEdge ||
+                  hasSideEffects( ac.mCondition.condition, MAX_EQUATION_DEPTH ) )
+        {
+            mConditionsEvaluatedWhileTrue.set( conditionIndex );
+        }
     }
-    return oneConditionIsTrue;
-}
 
-void
-CollectionInspectionEngine::collectLastSignals( InspectionSignalID id,
-                                                uint32_t minimumSamplingInterval,
-                                                uint32_t maxNumberOfSignalsToCollect,
-                                                uint32_t conditionId,
-                                                InspectionTimestamp &newestSignalTimestamp,
-                                                std::vector<CollectedSignal> &output )
-{
-    if ( mSignalBuffers[id].empty() )
+    // Assume all conditions are currently true;
+    mConditionsWithConditionCurrentlyTrue.set();
+    // Evaluate every condition at least once, except the periodic ones that trigger with their ticks
+    mConditionsWithInputSignalChanged.set();
+    for ( const auto &group : mPeriodicGroups )
     {
-        // Signal not collected by any active condition
-        return;
+        for ( auto conditionIndex : group.mConditions )
+        {
+            mConditionsWithInputSignalChanged.reset( conditionIndex );
+        }
     }
-    // Iterate through all sampling intervals of the signal
-    for ( auto &buf : mSignalBuffers[id] )
+
+    // Size the pool for the collected data from the largest condition
+    size_t maxSignalSamples = 0;
+    size_t maxCanFrames = 0;
+    for ( const auto &ac : mConditions )
     {
-        if ( buf.mMinimumSampleIntervalMs == minimumSamplingInterval && buf.mSize > 0 )
+        size_t signalSamples = 0;
+        size_t canFrames = 0;
+        for ( const auto &s : ac.mCondition.signals )
         {
-            int pos = static_cast<int>( buf.mCurrentPosition );
-            for ( uint32_t i = 0; i < std::min( maxNumberOfSignalsToCollect, buf.mCounter ); i++ )
+            // Samples of a deep history file are copied even with snapshots, aggregated signals only send summaries
+            if ( ( !s.isConditionOnlySignal ) && ( s.aggregation == nullptr ) &&
+                 ( ( !mSignalSnapshotsEnabled ) || s.deepHistory ) )
             {
-                // Ensure access is in bounds
-                if ( pos < 0 )
-                {
-                    pos = static_cast<int>( buf.mSize ) - 1;
-                }
-                if ( pos >= static_cast<int>( buf.mSize ) )
-                {
-                    pos = 0;
-                }
-                auto &sample = buf.mBuffer[static_cast<uint32_t>( pos )];
-                if ( !sample.isAlreadyConsumed( conditionId ) || !mSendDataOnlyOncePerCondition )
-                {
-                    output.emplace_back( id, sample.mTimestamp, sample.mValue );
-                    sample.setAlreadyConsumed( conditionId, true );
-                }
-                newestSignalTimestamp = std::max( newestSignalTimestamp, sample.mTimestamp );
-                pos--;
+                signalSamples += s.sampleBufferSize;
+            }
+        }
+        for ( const auto &c : ac.mCondition.canFrames )
+        {
+            if ( !c.isConditionOnlyFrame )
+            {
+                canFrames += c.sampleBufferSize;
             }
-            return;
         }
+        maxSignalSamples = std::max( maxSignalSamples, signalSamples );
+        maxCanFrames = std::max( maxCanFrames, canFrames );
     }
-}
+    mTriggeredDataPool->resize( mConditions.size() * TRIGGERED_DATA_PER_CONDITION, maxSignalSamples, maxCanFrames );
 
-void
-CollectionInspectionEngine::collectLastCanFrames( CANRawFrameID canID,
-                                                  CANChannelNumericID channelID,
-                                                  uint32_t minimumSamplingInterval,
-                                                  uint32_t maxNumberOfSignalsToCollect,
-                                                  uint32_t conditionId,
-                                                  InspectionTimestamp &newestSignalTimestamp,
-                                                  std::vector<CollectedCanRawFrame> &output )
-{
-    for ( auto &buf : mCanFrameBuffers )
+    (void)preAllocateBuffers();
+
+    // The windows start with the first evaluation, so all of them are due immediately
+    for ( uint32_t signalIndex = 0; signalIndex < mSignalBuffers.size(); signalIndex++ )
     {
-        if ( buf.mFrameID == canID && buf.mChannelID == channelID &&
-             buf.mMinimumSampleIntervalMs == minimumSamplingInterval )
+        for ( uint32_t bufferIndex = 0; bufferIndex < mSignalBuffers[signalIndex].size(); bufferIndex++ )
         {
-            int pos = static_cast<int>( buf.mCurrentPosition );
-            for ( uint32_t i = 0; i < std::min( maxNumberOfSignalsToCollect, buf.mCounter ); i++ )
+            const auto &buf = mSignalBuffers[signalIndex][bufferIndex];
+            if ( ( !buf.mWindowFunctionData.empty() ) || ( !buf.mSlidingWindowFunctionData.empty() ) )
             {
-                // Ensure access is in bounds
-                if ( pos < 0 )
-                {
-                    pos = static_cast<int>( buf.mSize ) - 1;
-                }
-                if ( pos >= static_cast<int>( buf.mSize ) )
-                {
-                    pos = 0;
-                }
-                auto &sample = buf.mBuffer[static_cast<uint32_t>( pos )];
-                if ( !sample.isAlreadyConsumed( conditionId ) || !mSendDataOnlyOncePerCondition )
-                {
-                    output.emplace_back( canID, channelID, sample.mTimestamp, sample.mBuffer, sample.mSize );
-                    sample.setAlreadyConsumed( conditionId, true );
-                }
-                newestSignalTimestamp = std::max( newestSignalTimestamp, sample.mTimestamp );
-                pos--;
+                scheduleWindowTimeout( signalIndex, bufferIndex, 0 );
             }
-            return;
         }
     }
 }
+std::vector<uint32_t>
+CollectionInspectionEngine::mapPreviousConditions( const std::vector<ActiveCondition> &previousConditions,
+                                                   const ConditionStateVector &previousStates )
+{
+    std::vector<uint32_t> conditionMap( previousConditions.size(), uint32_t{ INVALID_CONDITION_INDEX } );
+    // New condition indices per collection scheme, the last entry is the first condition of the scheme
+    std::unordered_map<std::string, std::vector<uint32_t>> newConditions;
+    for ( auto i = static_cast<uint32_t>( mConditions.size() ); i > 0; i-- )
+    {
+        newConditions[mConditions[i - 1].mCondition.metaData.collectionSchemeID].push_back( i - 1 );
+    }
+    for ( uint32_t i = 0; i < previousConditions.size(); i++ )
+    {
+        auto it = newConditions.find( previousConditions[i].mCondition.metaData.collectionSchemeID );
+        if ( ( it == newConditions.end() ) || it->second.empty() )
+        {
+            continue;
+        }
+        auto conditionIndex = it->second.back();
+        it->second.pop_back();
+        conditionMap[i] = conditionIndex;
+        mConditionStates[conditionIndex].mLastTrigger = previousStates[i].mLastTrigger;
+        mConditions[conditionIndex].mLastDataTimestampPublished = previousConditions[i].mLastDataTimestampPublished;
+    }
+    return conditionMap;
+}
 
-std::shared_ptr<const TriggeredCollectionSchemeData>
-CollectionInspectionEngine::collectData( ActiveCondition &condition,
-                                         uint32_t conditionId,
-                                         InspectionTimestamp &newestSignalTimestamp )
+CollectionInspectionEngine::ConsumedUntilVector
+CollectionInspectionEngine::takeOverConsumedUntil( const ConsumedUntilVector &previous,
+                                                   uint32_t droppedSamples,
+                                                   const std::vector<uint32_t> &conditionMap )
 {
-    std::shared_ptr<TriggeredCollectionSchemeData> collectedData = std::make_shared<TriggeredCollectionSchemeData>();
-    collectedData->metaData = condition.mCondition.metaData;
-    collectedData->triggerTime = condition.mLastTrigger;
-    // Pack signals
-    for ( auto &s : condition.mCondition.signals )
+    ConsumedUntilVector consumedUntil;
+    for ( const auto &entry : previous )
     {
-        if ( !s.isConditionOnlySignal )
+        if ( ( entry.mConditionId < conditionMap.size() ) &&
+             ( conditionMap[entry.mConditionId] != INVALID_CONDITION_INDEX ) )
         {
-            collectLastSignals( s.signalID,
-                                s.minimumSampleIntervalMs,
-                                s.sampleBufferSize,
-                                conditionId,
-                                newestSignalTimestamp,
-                                collectedData->signals );
+            consumedUntil.push_back( ConsumedUntil{
+                conditionMap[entry.mConditionId],
+                ( entry.mCounter > droppedSamples ) ? ( entry.mCounter - droppedSamples ) : 0 } );
         }
     }
+    return consumedUntil;
+}
 
-    // Pack raw frames
-    for ( auto &c : condition.mCondition.canFrames )
+void
+CollectionInspectionEngine::takeOverSignalHistory( SignalHistoryBuffer &buf,
+                                                   SignalHistoryBuffer &previous,
+                                                   const std::vector<uint32_t> &conditionMap )
+{
+    if ( !previous.isAllocated() )
     {
-        collectLastCanFrames( c.frameID,
-                              c.channelID,
-                              c.minimumSampleIntervalMs,
-                              c.sampleBufferSize,
-                              conditionId,
-                              newestSignalTimestamp,
-                              collectedData->canFrames );
+        return;
     }
-    // Pack active DTCs if any
-    if ( condition.mCondition.includeActiveDtcs &&
-         ( !isActiveDTCsConsumed( conditionId ) || mSendDataOnlyOncePerCondition ) )
+    uint32_t droppedSamples = 0;
+    buf.mTimestampEpoch = previous.mTimestampEpoch;
+    buf.mLastSampleUs = previous.mLastSampleUs;
+    if ( buf.mSize == previous.mSize )
     {
-        collectedData->mDTCInfo = mActiveDTCs;
-        setActiveDTCsConsumed( conditionId, true );
+        buf.mChunks = std::move( previous.mChunks );
+        buf.mCurrentPosition = previous.mCurrentPosition;
+        buf.mCounter = previous.mCounter;
+        // The samples on flash continue the samples in memory only if those are unchanged
+        if ( buf.mDeepHistorySize > 0 )
+        {
+            buf.mDeepHistory = std::move( previous.mDeepHistory );
+            buf.mCompressedHistory = std::move( previous.mCompressedHistory );
+        }
     }
-    // Pack geohash into data sender buffer if there's new geohash.
-    // A new geohash is generated during geohash function node evaluation
-    if ( mGeohashFunctionNode.hasNewGeohash() )
+    else
     {
-        mGeohashFunctionNode.consumeGeohash( collectedData->mGeohashInfo );
+        // Copy the newest samples that fit oldest first to the start of the resized buffer
+        auto sampleCount = std::min( std::min( previous.mCounter, previous.mSize ), buf.mSize );
+        buf.allocate();
+        for ( uint32_t i = 0; i < sampleCount; i++ )
+        {
+            auto previousPosition =
+                ( previous.mCurrentPosition + previous.mSize - ( sampleCount - 1 - i ) ) % previous.mSize;
+            const auto &previousChunk = previous.getChunk( previousPosition );
+            auto &chunk = buf.getWritableChunk( i );
+            auto previousOffset = previousPosition % SignalSampleChunk::SIZE;
+            auto offset = i % SignalSampleChunk::SIZE;
+            chunk.values[offset] = previousChunk.values[previousOffset];
+            chunk.timestampOffsets[offset] = previousChunk.timestampOffsets[previousOffset];
+            chunk.timestampFractionsUs[offset] = previousChunk.timestampFractionsUs[previousOffset];
+        }
+        buf.mCurrentPosition = ( sampleCount == 0 ) ? ( buf.mSize - 1 ) : ( sampleCount - 1 );
+        buf.mCounter = sampleCount;
+        droppedSamples = previous.mCounter - sampleCount;
     }
-    // Propagate the event ID
-    collectedData->eventID = condition.mEventID;
-    return std::const_pointer_cast<const TriggeredCollectionSchemeData>( collectedData );
+    buf.mConsumedUntil = takeOverConsumedUntil( previous.mConsumedUntil, droppedSamples, conditionMap );
+    takeOverWindows( buf, previous, conditionMap );
 }
 
-std::shared_ptr<const TriggeredCollectionSchemeData>
-CollectionInspectionEngine::collectNextDataToSend( InspectionTimestamp currentTime, uint32_t &waitTimeMs )
+bool
+CollectionInspectionEngine::takeOverSignalView( SignalHistoryBuffer &buf,
+                                                SignalHistoryBuffer &previous,
+                                                uint32_t baseBufferIndex,
+                                                const SignalHistoryBuffer &base,
+                                                uint32_t droppedBaseSamples,
+                                                const std::vector<uint32_t> &conditionMap )
 {
-    uint32_t minimumWaitTimeMs = std::numeric_limits<uint32_t>::max();
-    if ( mConditionsNotTriggeredWaitingPublished.all() )
+    // The newest samples that fit must all still be in the new base buffer
+    auto sampleCount = std::min( std::min( previous.mCounter, previous.mSize ), buf.mSize );
+    std::vector<uint32_t> baseCounters( buf.mSize, 0 );
+    for ( uint32_t i = 0; i < sampleCount; i++ )
     {
-        waitTimeMs = minimumWaitTimeMs;
-        return std::shared_ptr<const TriggeredCollectionSchemeData>( nullptr );
+        auto previousPosition =
+            ( previous.mCurrentPosition + previous.mSize - ( sampleCount - 1 - i ) ) % previous.mSize;
+        auto previousCounter = previous.mBaseCounters[previousPosition];
+        if ( ( previousCounter <= droppedBaseSamples ) ||
+             ( base.getPositionOfCounter( previousCounter - droppedBaseSamples ) == INVALID_SIGNAL_INDEX ) )
+        {
+            return false;
+        }
+        baseCounters[i] = previousCounter - droppedBaseSamples;
     }
-    for ( uint32_t i = 0; i < mConditions.size(); i++ )
+    buf.mChunks.clear();
+    buf.mBaseBufferIndex = baseBufferIndex;
+    buf.mBaseCounters = std::move( baseCounters );
+    buf.mCurrentPosition = ( sampleCount == 0 ) ? ( buf.mSize - 1 ) : ( sampleCount - 1 );
+    buf.mCounter = sampleCount;
+    buf.mLastSampleUs = previous.mLastSampleUs;
+    buf.mConsumedUntil =
+        takeOverConsumedUntil( previous.mConsumedUntil, previous.mCounter - sampleCount, conditionMap );
+    takeOverWindows( buf, previous, conditionMap );
+    return true;
+}
+
+void
+CollectionInspectionEngine::materializeSignalView( SignalHistoryBuffer &view, const SignalHistoryBuffer &base )
+{
+    view.mTimestampEpoch = base.mTimestampEpoch;
+    view.allocate();
+    for ( uint32_t i = 0; i < std::min( view.mCounter, view.mSize ); i++ )
     {
-        if ( mNextConditionToCollectedIndex >= mConditions.size() )
+        auto position = ( view.mCurrentPosition + view.mSize - i ) % view.mSize;
+        auto basePosition = base.getPositionOfCounter( view.mBaseCounters[position] );
+        if ( basePosition == INVALID_SIGNAL_INDEX )
         {
-            mNextConditionToCollectedIndex = 0;
+            // Cannot happen, the base buffer keeps the samples of its views
+            break;
         }
-        if ( !mConditionsNotTriggeredWaitingPublished.test( mNextConditionToCollectedIndex ) )
+        const auto &baseChunk = base.getChunk( basePosition );
+        auto &chunk = view.getWritableChunk( position );
+        auto baseOffset = basePosition % SignalSampleChunk::SIZE;
+        auto offset = position % SignalSampleChunk::SIZE;
+        chunk.values[offset] = baseChunk.values[baseOffset];
+        chunk.timestampOffsets[offset] = baseChunk.timestampOffsets[baseOffset];
+        chunk.timestampFractionsUs[offset] = baseChunk.timestampFractionsUs[baseOffset];
+    }
+    view.mBaseBufferIndex = INVALID_SIGNAL_INDEX;
+    view.mBaseCounters = std::vector<uint32_t>();
+}
+
+uint32_t
+CollectionInspectionEngine::getBaseBufferIndex( const std::vector<SignalHistoryBuffer> &bufferVector )
+{
+    for ( uint32_t bufferIndex = 0; bufferIndex < bufferVector.size(); bufferIndex++ )
+    {
+        if ( bufferVector[bufferIndex].mMinimumSampleIntervalMs == 0 )
         {
-            auto &condition = mConditions[mNextConditionToCollectedIndex];
-            if ( currentTime >= condition.mLastTrigger + condition.mCondition.afterDuration )
-            {
-                mConditionsNotTriggeredWaitingPublished.set( mNextConditionToCollectedIndex );
-                // Send message out only with a certain probability. If probabilityToSend==0
-                // no data is sent out
-                if ( mDataReduction.shallSendData( condition.mCondition.probabilityToSend ) )
-                {
-                    // Generate the Event ID and pack  it into the active Condition
-                    condition.mEventID = generateEventID( currentTime );
-                    // Check if we need more data from other sensors
-                    evaluateAndTriggerRichSensorCapture( condition );
-                    // Return the collected data
-                    InspectionTimestamp newestSignalTimeStamp = 0;
-                    auto cd = collectData( condition, mNextConditionToCollectedIndex, newestSignalTimeStamp );
-                    // After collecting the data set the newest timestamp from any data that was
-                    // collected
-                    condition.mLastDataTimestampPublished = std::min( newestSignalTimeStamp, currentTime );
-                    return cd;
-                }
-            }
-            else
-            {
-                minimumWaitTimeMs = std::min<uint32_t>(
-                    minimumWaitTimeMs,
-                    static_cast<uint32_t>( ( condition.mLastTrigger + condition.mCondition.afterDuration ) -
-                                           currentTime ) );
-            }
+            return bufferIndex;
         }
-        mNextConditionToCollectedIndex++;
     }
-    // No Data ready to be sent
-    waitTimeMs = minimumWaitTimeMs;
-    return std::shared_ptr<const TriggeredCollectionSchemeData>( nullptr );
+    return INVALID_SIGNAL_INDEX;
 }
 
 void
-CollectionInspectionEngine::evaluateAndTriggerRichSensorCapture( const ActiveCondition &condition )
+CollectionInspectionEngine::assignSignalViews()
 {
-    // Find out whether Image Data is needed.
-    if ( condition.mCondition.includeImageCapture )
+    for ( auto &bufferVector : mSignalBuffers )
     {
-        std::vector<EventMetadata> eventMetadata;
-        // Create an Event Item for each device we want to get image from
-        for ( const auto &imageCollectionInfo : condition.mCondition.imageCollectionInfos )
+        auto baseBufferIndex = getBaseBufferIndex( bufferVector );
+        if ( ( baseBufferIndex == INVALID_SIGNAL_INDEX ) || ( bufferVector[baseBufferIndex].mSize == 0 ) )
         {
-            // Make sure the same Event ID is passed to the Image capture module
-            // The event happened  afterDuration before now, and thus, the camera
-            // data should have been requested already during the condition eval,
-            // however, because the Camera request is completely not in scope of the
-            // InspectionCycle, we want to make sure that no data leaves the system
-            // if it does not fit into the probability. We also want to make sure
-            // we don 't trigger camera collection if the probably meanwhile changed.
-            // That's why the PositiveOffset is set to zero.
-            eventMetadata.emplace_back( condition.mEventID,
-                                        imageCollectionInfo.deviceID,
-                                        imageCollectionInfo.beforeDurationMs + condition.mCondition.afterDuration,
-                                        0 );
+            continue;
+        }
+        for ( auto &buf : bufferVector )
+        {
+            // Buffers that took over samples of their own keep them. Deep history needs the samples in chunks.
+            if ( ( buf.mMinimumSampleIntervalMs == 0 ) || ( buf.mSize == 0 ) || ( buf.mDeepHistorySize > 0 ) ||
+                 ( ( !buf.isView() ) && ( buf.mCounter > 0 ) ) )
+            {
+                continue;
+            }
+            if ( !buf.isView() )
+            {
+                buf.mChunks.clear();
+                buf.mBaseBufferIndex = baseBufferIndex;
+                buf.mBaseCounters.assign( buf.mSize, 0 );
+            }
+            bufferVector[baseBufferIndex].mHasViews = true;
         }
-        // This is non blocking. Listeners simply copy the metadata.
-        notifyListeners<const std::vector<EventMetadata> &>( &InspectionEventListener::onEventOfInterestDetected,
-                                                             eventMetadata );
     }
 }
 
-void
-CollectionInspectionEngine::addNewSignal( InspectionSignalID id,
-                                          InspectionTimestamp receiveTime,
-                                          InspectionValue value )
+CollectionInspectionEngine::InspectionValue
+CollectionInspectionEngine::getNewestValue( const std::vector<SignalHistoryBuffer> &bufferVector,
+                                            const SignalHistoryBuffer &buf )
 {
-    if ( mSignalBuffers.find( id ) == mSignalBuffers.end() || mSignalBuffers[id].empty() )
+    if ( !buf.isView() )
     {
-        // Signal not collected by any active condition
-        return;
+        return buf.getValue( buf.mCurrentPosition );
     }
-    // Iterate through all sampling intervals of the signal
-    for ( auto &buf : mSignalBuffers[id] )
+    const auto &base = bufferVector[buf.mBaseBufferIndex];
+    return base.getValue( base.getPositionOfCounter( buf.mBaseCounters[buf.mCurrentPosition] ) );
+}
+
+void
+CollectionInspectionEngine::takeOverWindows( SignalHistoryBuffer &buf,
+                                             SignalHistoryBuffer &previous,
+                                             const std::vector<uint32_t> &conditionMap )
+{
+    for ( auto &window : buf.mWindowFunctionData )
     {
-        if ( buf.mSize > 0 && buf.mSize <= buf.mBuffer.size() &&
-             ( buf.mMinimumSampleIntervalMs == 0 ||
-               ( receiveTime >= buf.mLastSample + buf.mMinimumSampleIntervalMs ) ) )
+        for ( const auto &previousWindow : previous.mWindowFunctionData )
         {
-            buf.mCurrentPosition++;
-            if ( buf.mCurrentPosition >= buf.mSize )
+            if ( previousWindow.mWindowSizeMs == window.mWindowSizeMs )
             {
-                buf.mCurrentPosition = 0;
+                auto aggregators = std::move( window.mAggregators );
+                window = previousWindow;
+                window.mAggregators = std::move( aggregators );
+                takeOverAggregators( window, previousWindow, conditionMap );
+                break;
             }
-            buf.mBuffer[buf.mCurrentPosition].mValue = value;
-            buf.mBuffer[buf.mCurrentPosition].mTimestamp = receiveTime;
-            buf.mBuffer[buf.mCurrentPosition].setAlreadyConsumed( ALL_CONDITIONS, false );
-            buf.mCounter++;
-            buf.mLastSample = receiveTime;
-            for ( auto &window : buf.mWindowFunctionData )
+        }
+    }
+    for ( auto &window : buf.mSlidingWindowFunctionData )
+    {
+        for ( auto &previousWindow : previous.mSlidingWindowFunctionData )
+        {
+            if ( previousWindow.mWindowSizeMs == window.mWindowSizeMs )
             {
-                window.addValue( value, receiveTime, mNextWindowFunctionTimesOut );
+                window = std::move( previousWindow );
+                break;
             }
-            mConditionsWithInputSignalChanged |= buf.mConditionsThatEvaluateOnThisSignal;
         }
     }
 }
 
 void
-CollectionInspectionEngine::addNewRawCanFrame( CANRawFrameID canID,
-                                               CANChannelNumericID channelID,
-                                               InspectionTimestamp receiveTime,
-                                               std::array<uint8_t, MAX_CAN_FRAME_BYTE_SIZE> &buffer,
-                                               uint8_t size )
+CollectionInspectionEngine::takeOverAggregators( FixedTimeWindowFunctionData &window,
+                                                 const FixedTimeWindowFunctionData &previous,
+                                                 const std::vector<uint32_t> &conditionMap )
 {
-    for ( auto &buf : mCanFrameBuffers )
+    for ( auto &aggregator : window.mAggregators )
     {
-        if ( buf.mFrameID == canID && buf.mChannelID == channelID )
+        bool tookOver = false;
+        for ( const auto &previousAggregator : previous.mAggregators )
         {
-            if ( buf.mSize > 0 && buf.mSize <= buf.mBuffer.size() &&
-                 ( buf.mMinimumSampleIntervalMs == 0 ||
-                   ( receiveTime >= buf.mLastSample + buf.mMinimumSampleIntervalMs ) ) )
+            if ( ( conditionMap[previousAggregator.getConditionIndex()] == aggregator.getConditionIndex() ) &&
+                 SignalAggregator::isSameAggregation( *previousAggregator.getInfo(), *aggregator.getInfo() ) )
             {
-                buf.mCurrentPosition++;
-                if ( buf.mCurrentPosition >= buf.mSize )
-                {
-                    buf.mCurrentPosition = 0;
-                }
-                buf.mBuffer[buf.mCurrentPosition].mSize = std::min( size, static_cast<uint8_t>( buf.mBuffer.size() ) );
-                for ( size_t i = 0; i < buf.mBuffer[buf.mCurrentPosition].mSize; i++ )
-                {
-                    buf.mBuffer[buf.mCurrentPosition].mBuffer[i] = buffer[i];
-                }
-                buf.mBuffer[buf.mCurrentPosition].mTimestamp = receiveTime;
-                buf.mBuffer[buf.mCurrentPosition].setAlreadyConsumed( ALL_CONDITIONS, false );
-                buf.mCounter++;
-                buf.mLastSample = receiveTime;
+                aggregator.takeOver( previousAggregator );
+                tookOver = true;
+                break;
             }
         }
+        // A new aggregator only summarizes complete windows
+        if ( ( !tookOver ) && ( window.mLastTimeCalculated != 0 ) )
+        {
+            aggregator.skipCurrentWindow();
+        }
     }
 }
 
 void
-CollectionInspectionEngine::setActiveDTCs( const DTCInfo &activeDTCs )
-{
-    setActiveDTCsConsumed( ALL_CONDITIONS, false );
-    mActiveDTCs = activeDTCs;
-}
-
-CollectionInspectionEngine::ExpressionErrorCode
-CollectionInspectionEngine::getLatestSignalValue( InspectionSignalID id,
-                                                  ActiveCondition &condition,
-                                                  InspectionValue &result )
+CollectionInspectionEngine::takeOverCanFrameHistory( CanFrameHistoryBuffer &buf,
+                                                     CanFrameHistoryBuffer &previous,
+                                                     const std::vector<uint32_t> &conditionMap )
 {
-    auto mapLookup = condition.mEvaluationSignals.find( id );
-    if ( mapLookup == condition.mEvaluationSignals.end() || mapLookup->second == nullptr )
+    if ( ( previous.mSize == 0 ) || ( previous.mBuffer.size() != previous.mSize ) )
     {
-        mLogger.warn( "CollectionInspectionEngine::getLatestSignalValue", "SIGNAL_NOT_FOUND" );
-        // Signal not collected by any active condition
-        return ExpressionErrorCode::SIGNAL_NOT_FOUND;
+        return;
     }
-    SignalHistoryBuffer *s = mapLookup->second;
-    if ( s->mCounter == 0 )
+    uint32_t droppedSamples = 0;
+    buf.mLastSampleUs = previous.mLastSampleUs;
+    buf.mFrameCapacity = previous.mFrameCapacity;
+    if ( buf.mSize == previous.mSize )
     {
-        // Not a single sample collected yet
-        return ExpressionErrorCode::SIGNAL_NOT_FOUND;
+        buf.mBuffer = std::move( previous.mBuffer );
+        buf.mPayload = std::move( previous.mPayload );
+        buf.mCurrentPosition = previous.mCurrentPosition;
+        buf.mCounter = previous.mCounter;
     }
-    result = s->mBuffer[s->mCurrentPosition].mValue;
-    return ExpressionErrorCode::SUCCESSFUL;
+    else
+    {
+        // Copy the newest frames that fit oldest first to the start of the resized buffer
+        auto sampleCount = std::min( std::min( previous.mCounter, previous.mSize ), buf.mSize );
+        buf.mBuffer.resize( buf.mSize );
+        buf.mPayload.resize( static_cast<size_t>( buf.mSize ) * buf.mFrameCapacity );
+        for ( uint32_t i = 0; i < sampleCount; i++ )
+        {
+            auto previousPosition =
+                ( previous.mCurrentPosition + previous.mSize - ( sampleCount - 1 - i ) ) % previous.mSize;
+            buf.mBuffer[i] = previous.mBuffer[previousPosition];
+            std::copy( &previous.mPayload[static_cast<size_t>( previousPosition ) * previous.mFrameCapacity],
+                       &previous.mPayload[static_cast<size_t>( previousPosition ) * previous.mFrameCapacity] +
+                           previous.mFrameCapacity,
+                       &buf.mPayload[static_cast<size_t>( i ) * buf.mFrameCapacity] );
+        }
+        buf.mCurrentPosition = ( sampleCount == 0 ) ? ( buf.mSize - 1 ) : ( sampleCount - 1 );
+        buf.mCounter = sampleCount;
+        droppedSamples = previous.mCounter - sampleCount;
+    }
+    buf.mConsumedUntil = takeOverConsumedUntil( previous.mConsumedUntil, droppedSamples, conditionMap );
 }
 
-CollectionInspectionEngine::ExpressionErrorCode
-CollectionInspectionEngine::getSampleWindowFunction( WindowFunction function,
-                                                     InspectionSignalID signalID,
-                                                     ActiveCondition &condition,
-                                                     InspectionValue &result )
+uint64_t
+CollectionInspectionEngine::resizeBuffers( const std::vector<SampleDemand> &demands,
+                                           bool degrade,
+                                           uint32_t degradedPriority,
+                                           double factor )
 {
-    auto mapLookup = condition.mEvaluationFunctions.find( signalID );
-    if ( mapLookup == condition.mEvaluationFunctions.end() || mapLookup->second == nullptr )
+    for ( auto &bufferVector : mSignalBuffers )
     {
-        // Signal not collected by any active condition
-        return ExpressionErrorCode::SIGNAL_NOT_FOUND;
+        for ( auto &buf : bufferVector )
+        {
+            buf.mSize = 0;
+        }
     }
-    auto w = mapLookup->second;
-
-    switch ( function )
+    for ( auto &buf : mCanFrameBuffers )
     {
-    case WindowFunction::LAST_FIXED_WINDOW_AVG:
-        result = w->mLastAvg;
-        return w->mLastAvailable ? ExpressionErrorCode::SUCCESSFUL : ExpressionErrorCode::FUNCTION_DATA_NOT_AVAILABLE;
-    case WindowFunction::LAST_FIXED_WINDOW_MIN:
-        result = w->mLastMin;
-        return w->mLastAvailable ? ExpressionErrorCode::SUCCESSFUL : ExpressionErrorCode::FUNCTION_DATA_NOT_AVAILABLE;
-    case WindowFunction::LAST_FIXED_WINDOW_MAX:
-        result = w->mLastMax;
-        return w->mLastAvailable ? ExpressionErrorCode::SUCCESSFUL : ExpressionErrorCode::FUNCTION_DATA_NOT_AVAILABLE;
-    case WindowFunction::PREV_LAST_FIXED_WINDOW_AVG:
-        result = w->mPreviousLastAvg;
-        return w->mPreviousLastAvailable ? ExpressionErrorCode::SUCCESSFUL
-                                         : ExpressionErrorCode::FUNCTION_DATA_NOT_AVAILABLE;
-    case WindowFunction::PREV_LAST_FIXED_WINDOW_MIN:
-        result = w->mPreviousLastMin;
-        return w->mPreviousLastAvailable ? ExpressionErrorCode::SUCCESSFUL
-                                         : ExpressionErrorCode::FUNCTION_DATA_NOT_AVAILABLE;
-    case WindowFunction::PREV_LAST_FIXED_WINDOW_MAX:
-        result = w->mPreviousLastMax;
-        return w->mPreviousLastAvailable ? ExpressionErrorCode::SUCCESSFUL
-                                         : ExpressionErrorCode::FUNCTION_DATA_NOT_AVAILABLE;
-    default:
-        return ExpressionErrorCode::NOT_IMPLEMENTED_FUNCTION;
+        buf.mSize = 0;
     }
-}
-
-CollectionInspectionEngine::ExpressionErrorCode
-CollectionInspectionEngine::getGeohashFunctionNode( const struct ExpressionNode *expression,
-                                                    ActiveCondition &condition,
-                                                    bool &resultValueBool )
-{
-    resultValueBool = false;
-    // First we need to grab Latitude / longitude signal from collected signal buffer
-    InspectionValue latitude = 0;
-    auto status = getLatestSignalValue( expression->function.geohashFunction.latitudeSignalID, condition, latitude );
-    if ( status != ExpressionErrorCode::SUCCESSFUL )
+    for ( const auto &demand : demands )
     {
-        mLogger.warn( "CollectionInspectionEngine::getGeohashFunctionNode",
-                      "Unable to evaluate Geohash due to missing latitude signal!" );
-        return status;
+        auto samples = demand.mSamples;
+        auto priority = mConditions[demand.mConditionIndex].mCondition.metaData.priority;
+        if ( degrade && ( priority > degradedPriority ) )
+        {
+            samples = 1;
+        }
+        else if ( degrade && ( priority == degradedPriority ) )
+        {
+            samples = std::max( 1U, static_cast<uint32_t>( static_cast<double>( samples ) * factor ) );
+        }
+        auto &size = demand.mCanFrame ? mCanFrameBuffers[demand.mBufferIndex].mSize
+                                      : mSignalBuffers[demand.mSignalIndex][demand.mBufferIndex].mSize;
+        size = std::max( size, samples );
     }
-    InspectionValue longitude = 0;
-    status = getLatestSignalValue( expression->function.geohashFunction.longitudeSignalID, condition, longitude );
-    if ( status != ExpressionErrorCode::SUCCESSFUL )
+    uint64_t requiredBytes = 0;
+    for ( const auto &bufferVector : mSignalBuffers )
     {
-        mLogger.warn( "CollectionInspectionEngine::getGeohashFunctionNode",
-                      "Unable to evaluate Geohash due to missing longitude signal!" );
-        return status;
+        for ( const auto &buf : bufferVector )
+        {
+            requiredBytes += buf.mSize * static_cast<uint64_t>( SignalHistoryBuffer::BYTES_PER_SAMPLE );
+        }
     }
-    resultValueBool = mGeohashFunctionNode.evaluateGeohash( latitude,
-                                                            longitude,
-                                                            expression->function.geohashFunction.precision,
-                                                            expression->function.geohashFunction.gpsUnitType );
-    return ExpressionErrorCode::SUCCESSFUL;
+    for ( const auto &buf : mCanFrameBuffers )
+    {
+        requiredBytes += buf.mSize * static_cast<uint64_t>( CAN_FRAME_BYTES_PER_SAMPLE );
+    }
+    return requiredBytes;
 }
 
-CollectionInspectionEngine::ExpressionErrorCode
-CollectionInspectionEngine::eval( const struct ExpressionNode *expression,
-                                  ActiveCondition &condition,
-                                  InspectionValue &resultValueDouble,
-                                  bool &resultValueBool,
-                                  int remainingStackDepth )
+void
+CollectionInspectionEngine::applySampleMemoryBudget()
 {
-    if ( remainingStackDepth <= 0 || expression == nullptr )
+    traceSampleMemoryUsage( -1 );
+    mSampleMemoryUsage = SampleMemoryUsage();
+    mSampleMemoryUsage.budgetBytes = mSampleMemoryBudget;
+    std::vector<SampleDemand> demands;
+    std::vector<InspectionSignalID> signalIDs( mSignalBuffers.size(), INVALID_SIGNAL_ID );
+    for ( uint32_t conditionIndex = 0; conditionIndex < mConditions.size(); conditionIndex++ )
     {
-        mLogger.warn( "CollectionInspectionEngine::eval", "STACK_DEPTH_REACHED or nullptr" );
-        return ExpressionErrorCode::STACK_DEPTH_REACHED;
+        const auto &condition = mConditions[conditionIndex].mCondition;
+        for ( const auto &s : condition.signals )
+        {
+            auto signalIndex = getSignalIndex( s.signalID );
+            if ( signalIndex == INVALID_SIGNAL_INDEX )
+            {
+                continue;
+            }
+            signalIDs[signalIndex] = s.signalID;
+            for ( uint32_t bufferIndex = 0; bufferIndex < mSignalBuffers[signalIndex].size(); bufferIndex++ )
+            {
+                if ( mSignalBuffers[signalIndex][bufferIndex].mMinimumSampleIntervalMs == s.minimumSampleIntervalMs )
+                {
+                    demands.push_back( SampleDemand{
+                        conditionIndex, false, signalIndex, bufferIndex, getMemorySampleDemand( s ) } );
+                    break;
+                }
+            }
+        }
+        for ( const auto &c : condition.canFrames )
+        {
+            auto bufferIndex = getCanFrameBufferIndex( c.frameID, c.channelID, c.minimumSampleIntervalMs );
+            if ( bufferIndex != INVALID_SIGNAL_INDEX )
+            {
+                demands.push_back( SampleDemand{ conditionIndex, true, 0, bufferIndex, c.sampleBufferSize } );
+            }
+        }
     }
-    if ( expression->nodeType == ExpressionNodeType::FLOAT )
+
+    auto requiredBytes = resizeBuffers( demands, false, 0, 1.0 );
+    if ( requiredBytes > mSampleMemoryBudget )
     {
-        resultValueDouble = expression->floatingValue;
-        return ExpressionErrorCode::SUCCESSFUL;
+        // Degrade the priority levels one after the other starting with the least important one, which has the
+        // highest priority number. The first level that makes everything fit is scaled down just as much as needed.
+        std::vector<uint32_t> priorities;
+        for ( const auto &condition : mConditions )
+        {
+            priorities.push_back( condition.mCondition.metaData.priority );
+        }
+        std::sort( priorities.begin(), priorities.end(), std::greater<uint32_t>() );
+        priorities.erase( std::unique( priorities.begin(), priorities.end() ), priorities.end() );
+        for ( auto priority : priorities )
+        {
+            requiredBytes = resizeBuffers( demands, true, priority, 0.0 );
+            if ( requiredBytes > mSampleMemoryBudget )
+            {
+                continue;
+            }
+            double fittingFactor = 0.0;
+            double tooBigFactor = 1.0;
+            for ( uint32_t i = 0; i < SAMPLE_MEMORY_BUDGET_SEARCH_STEPS; i++ )
+            {
+                double factor = ( fittingFactor + tooBigFactor ) / 2;
+                if ( resizeBuffers( demands, true, priority, factor ) <= mSampleMemoryBudget )
+                {
+                    fittingFactor = factor;
+                }
+                else
+                {
+                    tooBigFactor = factor;
+                }
+            }
+            requiredBytes = resizeBuffers( demands, true, priority, fittingFactor );
+            break;
+        }
+        mLogger.warn( "CollectionInspectionEngine::applySampleMemoryBudget",
+                      "The conditions request more samples than fit into the budget of " +
+                          std::to_string( mSampleMemoryBudget ) + " Bytes, the buffers of the least important " +
+                          "conditions are shrunk" );
     }
-    if ( expression->nodeType == ExpressionNodeType::BOOLEAN )
+    if ( requiredBytes > mSampleMemoryBudget )
     {
-        resultValueBool = expression->booleanValue;
-        return ExpressionErrorCode::SUCCESSFUL;
+        // Even one sample per buffer does not fit, the last buffers get no samples at all
+        uint64_t usedBytes = 0;
+        for ( auto &bufferVector : mSignalBuffers )
+        {
+            for ( auto &buf : bufferVector )
+            {
+                usedBytes += buf.mSize * static_cast<uint64_t>( SignalHistoryBuffer::BYTES_PER_SAMPLE );
+                if ( usedBytes > mSampleMemoryBudget )
+                {
+                    buf.mSize = 0;
+                }
+            }
+        }
+        for ( auto &buf : mCanFrameBuffers )
+        {
+            usedBytes += buf.mSize * static_cast<uint64_t>( CAN_FRAME_BYTES_PER_SAMPLE );
+            if ( usedBytes > mSampleMemoryBudget )
+            {
+                buf.mSize = 0;
+            }
+        }
     }
-    if ( expression->nodeType == ExpressionNodeType::SIGNAL )
+
+    // Accounting
+    for ( const auto &demand : demands )
     {
-        return getLatestSignalValue( expression->signalID, condition, resultValueDouble );
+        const auto &campaign = mConditions[demand.mConditionIndex].mCondition.metaData.collectionSchemeID;
+        auto size = demand.mCanFrame ? mCanFrameBuffers[demand.mBufferIndex].mSize
+                                     : mSignalBuffers[demand.mSignalIndex][demand.mBufferIndex].mSize;
+        auto bytesPerSample = demand.mCanFrame ? CAN_FRAME_BYTES_PER_SAMPLE : SignalHistoryBuffer::BYTES_PER_SAMPLE;
+        mSampleMemoryUsage.bytesPerCampaign[campaign] += std::min( size, demand.mSamples ) * bytesPerSample;
+        if ( size < demand.mSamples )
+        {
+            mSampleMemoryUsage.shrunkBuffers++;
+        }
     }
-    if ( expression->nodeType == ExpressionNodeType::WINDOWFUNCTION )
+    for ( uint32_t signalIndex = 0; signalIndex < mSignalBuffers.size(); signalIndex++ )
     {
-        return getSampleWindowFunction(
-            expression->function.windowFunction, expression->signalID, condition, resultValueDouble );
+        for ( const auto &buf : mSignalBuffers[signalIndex] )
+        {
+            auto bytes = buf.mSize * SignalHistoryBuffer::BYTES_PER_SAMPLE;
+            mSampleMemoryUsage.bytesPerSignal[signalIDs[signalIndex]] += bytes;
+            mSampleMemoryUsage.usedBytes += bytes;
+        }
     }
-    if ( expression->nodeType == ExpressionNodeType::GEOHASHFUNCTION )
+    for ( const auto &buf : mCanFrameBuffers )
     {
-        return getGeohashFunctionNode( expression, condition, resultValueBool );
+        mSampleMemoryUsage.usedBytes += buf.mSize * CAN_FRAME_BYTES_PER_SAMPLE;
     }
+    TraceModule::get().setVariable( TraceVariable::CE_SAMPLE_MEMORY_SHRUNK_BUFFERS, mSampleMemoryUsage.shrunkBuffers );
+    traceSampleMemoryUsage( 1 );
+}
 
-    InspectionValue leftDouble = 0;
-    InspectionValue rightDouble = 0;
-    bool leftBool = false;
-    bool rightBool = false;
-    ExpressionErrorCode leftRet = ExpressionErrorCode::SUCCESSFUL;
-    ExpressionErrorCode rightRet = ExpressionErrorCode::SUCCESSFUL;
-    // Recursion limited depth through last parameter
-    leftRet = eval( expression->left, condition, leftDouble, leftBool, remainingStackDepth - 1 );
-
-    if ( leftRet != ExpressionErrorCode::SUCCESSFUL )
+void
+CollectionInspectionEngine::traceSampleMemoryUsage( int64_t sign )
+{
+    // Multiple engines add up in the same variables
+    TraceModule::get().addToNamedVariable(
+        "sampleMemoryUsed", sign * static_cast<int64_t>( mSampleMemoryUsage.usedBytes ), "Bytes" );
+    for ( const auto &campaign : mSampleMemoryUsage.bytesPerCampaign )
     {
-        return leftRet;
+        TraceModule::get().addToNamedVariable(
+            "sampleMemoryCampaign_" + campaign.first, sign * static_cast<int64_t>( campaign.second ), "Bytes" );
     }
-
-    // Logical NOT operator does not have a right operand, hence expression->right can be nullptr
-    if ( expression->nodeType != ExpressionNodeType::OPERATOR_LOGICAL_NOT )
+    for ( const auto &signal : mSampleMemoryUsage.bytesPerSignal )
     {
-        // No short-circuit evaluation so always evaluate right part
-        rightRet = eval( expression->right, condition, rightDouble, rightBool, remainingStackDepth - 1 );
+        TraceModule::get().addToNamedVariable( "sampleMemorySignal_" + std::to_string( signal.first ),
+                                               sign * static_cast<int64_t>( signal.second ),
+                                               "Bytes" );
+    }
+}
 
-        if ( rightRet != ExpressionErrorCode::SUCCESSFUL )
+bool
+CollectionInspectionEngine::preAllocateBuffers()
+{
+    // The sizes already fit into the budget, see applySampleMemoryBudget
+    bool result = true;
+    for ( auto &bufferVector : mSignalBuffers )
+    {
+        for ( auto &buf : bufferVector )
         {
-            return rightRet;
+            if ( buf.isView() )
+            {
+                continue;
+            }
+            // reserve the size like new[]
+            buf.allocate();
+            auto deepHistorySamples = ( buf.mDeepHistorySize > buf.mSize ) ? ( buf.mDeepHistorySize - buf.mSize ) : 0;
+            if ( ( deepHistorySamples == 0 ) || ( buf.mSize == 0 ) )
+            {
+                buf.mDeepHistory.reset();
+                buf.mCompressedHistory.reset();
+            }
+            else if ( mDeepHistoryDirectory.empty() )
+            {
+                if ( ( buf.mCompressedHistory == nullptr ) ||
+                     ( buf.mCompressedHistory->getCapacity() != deepHistorySamples ) )
+                {
+                    buf.mCompressedHistory = std::make_shared<CompressedSampleHistory>();
+                    (void)buf.mCompressedHistory->init( deepHistorySamples );
+                }
+            }
+            else if ( ( buf.mDeepHistory == nullptr ) || ( buf.mDeepHistory->getCapacity() != deepHistorySamples ) )
+            {
+                buf.mDeepHistory = std::make_shared<DeepHistoryFile>();
+                if ( !buf.mDeepHistory->open( mDeepHistoryDirectory, deepHistorySamples ) )
+                {
+                    mLogger.warn( "CollectionInspectionEngine::preAllocateBuffers",
+                                  "Deep history is not available, only the newest " + std::to_string( buf.mSize ) +
+                                      " samples are kept" );
+                    buf.mDeepHistory.reset();
+                    result = false;
+                }
+            }
         }
     }
-
-    switch ( expression->nodeType )
+    for ( auto &buf : mCanFrameBuffers )
     {
-    case ExpressionNodeType::OPERATOR_SMALLER:
-        resultValueBool = leftDouble < rightDouble;
-        return ExpressionErrorCode::SUCCESSFUL;
-    case ExpressionNodeType::OPERATOR_BIGGER:
-        resultValueBool = leftDouble > rightDouble;
-        return ExpressionErrorCode::SUCCESSFUL;
-    case ExpressionNodeType::OPERATOR_SMALLER_EQUAL:
-        resultValueBool = leftDouble <= rightDouble;
-        return ExpressionErrorCode::SUCCESSFUL;
-    case ExpressionNodeType::OPERATOR_BIGGER_EQUAL:
-        resultValueBool = leftDouble >= rightDouble;
-        return ExpressionErrorCode::SUCCESSFUL;
-    case ExpressionNodeType::OPERATOR_EQUAL:
-        resultValueBool = std::abs( leftDouble - rightDouble ) < EVAL_EQUAL_DISTANCE();
-        return ExpressionErrorCode::SUCCESSFUL;
-    case ExpressionNodeType::OPERATOR_LOGICAL_AND:
-        resultValueBool = leftBool && rightBool;
-        return ExpressionErrorCode::SUCCESSFUL;
-    case ExpressionNodeType::OPERATOR_LOGICAL_OR:
-        resultValueBool = leftBool || rightBool;
-        return ExpressionErrorCode::SUCCESSFUL;
-    case ExpressionNodeType::OPERATOR_LOGICAL_NOT:
-        resultValueBool = !leftBool;
-        return ExpressionErrorCode::SUCCESSFUL;
-    case ExpressionNodeType::OPERATOR_ARITHMETIC_PLUS:
-        resultValueDouble = leftDouble + rightDouble;
-        return ExpressionErrorCode::SUCCESSFUL;
-    case ExpressionNodeType::OPERATOR_ARITHMETIC_MINUS:
-        resultValueDouble = leftDouble - rightDouble;
-        return ExpressionErrorCode::SUCCESSFUL;
-    case ExpressionNodeType::OPERATOR_ARITHMETIC_MULTIPLY:
-        resultValueDouble = leftDouble * rightDouble;
-        return ExpressionErrorCode::SUCCESSFUL;
-    case ExpressionNodeType::OPERATOR_ARITHMETIC_DIVIDE:
-        resultValueDouble = leftDouble / rightDouble;
-        return ExpressionErrorCode::SUCCESSFUL;
-    default:
-        return ExpressionErrorCode::NOT_IMPLEMENTED_TYPE;
+        // Classic CAN payload is reserved upfront, the slots only grow if CAN FD frames are seen.
+        // Buffers that took over the history of the previous matrix are already allocated.
+        if ( buf.mBuffer.size() != buf.mSize )
+        {
+            buf.mBuffer.resize( buf.mSize );
+            buf.mFrameCapacity = MAX_CAN_FRAME_BYTE_SIZE;
+            buf.mPayload.resize( static_cast<size_t>( buf.mSize ) * buf.mFrameCapacity );
+        }
     }
+    return result;
 }
 
-bool
-CollectionInspectionEngine::FixedTimeWindowFunctionData::updateWindow( InspectionTimestamp timestamp,
-                                                                       InspectionTimestamp &nextWindowFunctionTimesOut )
+uint32_t
+CollectionInspectionEngine::getCanFrameBufferIndex( CANRawFrameID frameID,
+                                                    CANChannelNumericID channelID,
+                                                    uint32_t minimumSampleIntervalMs ) const
 {
-    if ( mLastTimeCalculated == 0 )
+    auto bufferIndices = getCanFrameBufferIndices( frameID, channelID );
+    if ( bufferIndices == nullptr )
     {
-        // First time a signal arrives start the window for this signal
-        mLastTimeCalculated = timestamp;
-        initNewWindow( timestamp, nextWindowFunctionTimesOut );
+        return INVALID_SIGNAL_INDEX;
     }
-    // check the last 2 windows as this class records the last and previous last data
-    else if ( timestamp >= mLastTimeCalculated + mWindowSizeMs * 2 )
+    for ( auto bufferIndex : *bufferIndices )
     {
-        // In the last window not a single sample arrived
-        mLastAvailable = false;
-        if ( mCollectedSignals == 0 )
+        if ( mCanFrameBuffers[bufferIndex].mMinimumSampleIntervalMs == minimumSampleIntervalMs )
         {
-            mPreviousLastAvailable = false;
-        }
-        else
-        {
-            mPreviousLastAvailable = true;
-            mPreviousLastMin = mCollectingMin;
-            mPreviousLastMax = mCollectingMax;
-            mPreviousLastAvg = mCollectingSum / mCollectedSignals;
+            return bufferIndex;
         }
-        initNewWindow( timestamp, nextWindowFunctionTimesOut );
     }
-    else if ( timestamp >= mLastTimeCalculated + mWindowSizeMs )
+    return INVALID_SIGNAL_INDEX;
+}
+
+void
+CollectionInspectionEngine::clear()
+{
+    mSignalBuffers.clear();
+    mSignalIndexTable.clear();
+    mSparseSignalIndices.clear();
+    mManifestSignalIndexTable.clear();
+    mEvaluationSignals.clear();
+    mPrograms.clear();
+#ifdef FWE_FEATURE_CONDITION_JIT
+    if ( mConditionJit )
     {
-        mPreviousLastMin = mLastMin;
-        mPreviousLastMax = mLastMax;
-        mPreviousLastAvg = mLastAvg;
-        mPreviousLastAvailable = mLastAvailable;
-        if ( mCollectedSignals == 0 )
-        {
-            mLastAvailable = false;
-        }
-        else
-        {
-            mLastAvailable = true;
-            mLastMin = mCollectingMin;
-            mLastMax = mCollectingMax;
-            mLastAvg = mCollectingSum / mCollectedSignals;
-        }
-        initNewWindow( timestamp, nextWindowFunctionTimesOut );
+        mConditionJit->clear();
     }
-    else
+    mNativeConditions.clear();
+#endif // FWE_FEATURE_CONDITION_JIT
+    mThresholdLeafValues.clear();
+    mSharedPrograms.clear();
+    mSharedExpressions.clear();
+    mGeofenceFunctions.clear();
+    mRawFrameFields.clear();
+    mCanFrameBuffers.clear();
+    mCanFrameBufferIndices.clear();
+    mConditions.clear();
+    mConditionStates.clear();
+    mPendingCollections.clear();
+    mPeriodicGroups.clear();
+    mWindowTimeouts.clear();
+    mConditionsWithInputSignalChanged.reset();
+    mConditionsWithConditionCurrentlyTrue.reset();
+    mConditionsEvaluatedWhileTrue.reset();
+    mConditionsNotTriggeredWaitingPublished.reset();
+}
+
+void
+CollectionInspectionEngine::setInputSignalChanged( const SignalHistoryBuffer &buffer )
+{
+    for ( auto conditionIndex : buffer.mConditionsThatEvaluateOnThisSignal )
     {
-        nextWindowFunctionTimesOut = std::min( nextWindowFunctionTimesOut, mLastTimeCalculated + mWindowSizeMs );
-        return false;
+        mConditionsWithInputSignalChanged.set( conditionIndex );
     }
-    return true;
 }
 
-EventID
-CollectionInspectionEngine::generateEventID( InspectionTimestamp timestamp )
+void
+CollectionInspectionEngine::scheduleWindowTimeout( uint32_t signalIndex,
+                                                   uint32_t bufferIndex,
+                                                   InspectionTimestamp nextTimeout )
 {
-    // Generate an eventId as a combination of an event counter and a timestamp
-    uint32_t eventId = static_cast<uint32_t>( ( generateEventCounter() & 0xFF ) | ( timestamp << 8 ) );
-    // As Kotlin reads eventId as int32, set most significant bit to 0 so event IDs stay positive
-    eventId = eventId & 0x7FFFFFFF;
-    return eventId;
+    auto &buf = mSignalBuffers[signalIndex][bufferIndex];
+    if ( nextTimeout == buf.mNextWindowTimeout )
+    {
+        // The existing entry is still valid
+        return;
+    }
+    // An existing entry with a different timeout becomes stale and is dropped when it is due
+    buf.mNextWindowTimeout = nextTimeout;
+    if ( nextTimeout != std::numeric_limits<InspectionTimestamp>::max() )
+    {
+        mWindowTimeouts.push_back( WindowTimeout{ nextTimeout, signalIndex, bufferIndex } );
+        std::push_heap( mWindowTimeouts.begin(), mWindowTimeouts.end(), IsLater() );
+    }
+}
+
+void
+CollectionInspectionEngine::updateDueWindowFunctions( InspectionTimestamp timestamp )
+{
+    while ( ( !mWindowTimeouts.empty() ) && ( mWindowTimeouts.front().mTimeout <= timestamp ) )
+    {
+        auto due = mWindowTimeouts.front();
+        std::pop_heap( mWindowTimeouts.begin(), mWindowTimeouts.end(), IsLater() );
+        mWindowTimeouts.pop_back();
+        auto &buf = mSignalBuffers[due.mSignalIndex][due.mBufferIndex];
+        if ( due.mTimeout != buf.mNextWindowTimeout )
+        {
+            continue;
+        }
+        buf.mNextWindowTimeout = std::numeric_limits<InspectionTimestamp>::max();
+        // The windows report timeouts after timestamp, so the entry scheduled below is not due in this loop
+        InspectionTimestamp nextTimeout = std::numeric_limits<InspectionTimestamp>::max();
+        for ( auto &functionWindow : buf.mWindowFunctionData )
+        {
+            bool changed = functionWindow.updateWindow( timestamp, nextTimeout );
+            if ( changed )
+            {
+                setInputSignalChanged( buf );
+            }
+        }
+        for ( auto &functionWindow : buf.mSlidingWindowFunctionData )
+        {
+            bool changed = functionWindow.updateWindow( timestamp, nextTimeout );
+            if ( changed )
+            {
+                setInputSignalChanged( buf );
+            }
+        }
+        scheduleWindowTimeout( due.mSignalIndex, due.mBufferIndex, nextTimeout );
+    }
+}
+
+bool
+CollectionInspectionEngine::evaluateConditions( InspectionTimestamp currentTime )
+{
+    TraceScopedTimer evaluationTimer( TraceHistogram::INSPECTION_EVALUATION_NS );
+    TraceModule::get().incrementVariable( TraceVariable::INSPECTION_EVALUATIONS );
+    // if any sampling window times out there is a new value available to be processed by a condition
+    updateDueWindowFunctions( currentTime );
+    bool oneConditionIsTrue = triggerDuePeriodicConditions( currentTime );
+    // Invalidates the cached results of the shared expressions
+    mEvaluationPass++;
+    // The bitsets are walked word by word and only the conditions to evaluate are visited
+    for ( size_t wordIndex = 0; wordIndex < mConditionsWithInputSignalChanged.wordCount(); wordIndex++ )
+    {
+        // Conditions that are true and have no input change keep their result unless they are time dependent
+        auto conditionsToEvaluate = ( mConditionsWithInputSignalChanged.word( wordIndex ) |
+                                      ( mConditionsWithConditionCurrentlyTrue.word( wordIndex ) &
+                                        mConditionsEvaluatedWhileTrue.word( wordIndex ) ) ) &
+                                    mConditionsNotTriggeredWaitingPublished.word( wordIndex );
+        while ( conditionsToEvaluate != 0 )
+        {
+            auto i = static_cast<uint32_t>( ( wordIndex * ConditionBitset::BITS_PER_WORD ) +
+                                            ConditionBitset::lowestSetBit( conditionsToEvaluate ) );
+            // Clear the lowest bit set
+            conditionsToEvaluate &= conditionsToEvaluate - 1;
+            if ( i >= mConditionStates.size() )
+            {
+                break;
+            }
+            ConditionEvaluationState &state = mConditionStates[i];
+            // A condition that is not evaluated keeps its input change, so that it is evaluated later
+            if ( ( currentTime >= state.mLastTrigger + state.mMinimumPublishInterval ) &&
+                 ( currentTime >= state.mNextEvaluation ) )
+            {
+                if ( state.mDeferredUntilPass >= mEvaluationPass )
+                {
+                    // The last evaluation exceeded the CPU budget, the other conditions go first
+                    TraceModule::get().incrementVariable( TraceVariable::CE_CONDITION_EVALUATIONS_DEFERRED );
+                    continue;
+                }
+                EvaluationValue result;
+                mConditionsWithInputSignalChanged.reset( i );
+                if ( state.mEvaluationIntervalMs > 0 )
+                {
+                    state.mNextEvaluation = currentTime + state.mEvaluationIntervalMs;
+                }
+                // The profile is in the ActiveCondition, which is only read with the profiling enabled
+                bool sampled =
+                    mConditionProfilingEnabled &&
+                    ( ( mConditions[i].mProfile.evaluations++ % CONDITION_PROFILING_SAMPLING_INTERVAL ) == 0 );
+                uint64_t evaluationStartNs = 0;
+                if ( sampled || ( state.mEvaluationBudgetUs > 0 ) )
+                {
+                    evaluationStartNs = TraceScopedTimer::getMonotonicRawTimeNs();
+                }
+                ExpressionErrorCode ret = runCondition( state, i, result );
+                if ( evaluationStartNs != 0 )
+                {
+                    auto evaluationTimeNs = TraceScopedTimer::getMonotonicRawTimeNs() - evaluationStartNs;
+                    if ( sampled )
+                    {
+                        mConditions[i].mProfile.sampledEvaluations++;
+                        mConditions[i].mProfile.sampledEvaluationTimeNs += evaluationTimeNs;
+                    }
+                    auto deferredPasses = getDeferredEvaluationPasses( evaluationTimeNs, state.mEvaluationBudgetUs );
+                    if ( deferredPasses > 0 )
+                    {
+                        state.mDeferredUntilPass = mEvaluationPass + deferredPasses;
+                    }
+                }
+                if ( ret == ExpressionErrorCode::SUCCESSFUL && result.mBool )
+                {
+                    if ( !state.mTriggerOnlyOnRisingEdge ||
+                         !mConditionsWithConditionCurrentlyTrue.test( i ) )
+                    {
+                        triggerCondition( i, currentTime );
+                    }
+                    mConditionsWithConditionCurrentlyTrue.set( i );
+                    oneConditionIsTrue = true;
+                }
+                else
+                {
+                    mConditionsWithConditionCurrentlyTrue.reset( i );
+                }
+            }
+        }
+    }
+    return oneConditionIsTrue;
+}
+
+void
+CollectionInspectionEngine::triggerCondition( uint32_t conditionIndex, InspectionTimestamp currentTime )
+{
+    auto &condition = mConditions[conditionIndex];
+    mConditionsNotTriggeredWaitingPublished.reset( conditionIndex );
+    mConditionStates[conditionIndex].mLastTrigger = currentTime;
+    if ( mConditionProfilingEnabled )
+    {
+        condition.mProfile.triggers++;
+    }
+    mPendingCollections.push_back(
+        PendingCollection{ currentTime + condition.mCondition.afterDuration, conditionIndex } );
+    std::push_heap( mPendingCollections.begin(), mPendingCollections.end(), IsLater() );
+    if ( mStreamingCollectionEnabled && ( condition.mCondition.afterDuration > 0 ) )
+    {
+        startStreamingCollection( conditionIndex );
+    }
+}
+
+bool
+CollectionInspectionEngine::isPeriodicCondition( const ConditionWithCollectedData &condition )
+{
+    return ( condition.condition != nullptr ) && ( condition.condition->nodeType == ExpressionNodeType::BOOLEAN ) &&
+           condition.condition->booleanValue && ( condition.minimumPublishInterval > 0 ) &&
+           ( !condition.triggerOnlyOnRisingEdge );
+}
+
+void
+CollectionInspectionEngine::addPeriodicCondition( uint32_t conditionIndex,
+                                                  const std::vector<PeriodicGroup> &previousGroups )
+{
+    auto periodMs = mConditions[conditionIndex].mCondition.minimumPublishInterval;
+    for ( auto &group : mPeriodicGroups )
+    {
+        if ( group.mPeriodMs == periodMs )
+        {
+            group.mConditions.push_back( conditionIndex );
+            return;
+        }
+    }
+    PeriodicGroup group;
+    group.mPeriodMs = periodMs;
+    for ( const auto &previousGroup : previousGroups )
+    {
+        if ( previousGroup.mPeriodMs == periodMs )
+        {
+            group.mNextTick = previousGroup.mNextTick;
+            break;
+        }
+    }
+    group.mConditions.push_back( conditionIndex );
+    mPeriodicGroups.emplace_back( std::move( group ) );
+}
+
+bool
+CollectionInspectionEngine::triggerDuePeriodicConditions( InspectionTimestamp currentTime )
+{
+    bool triggered = false;
+    for ( auto &group : mPeriodicGroups )
+    {
+        if ( group.mNextTick > currentTime )
+        {
+            continue;
+        }
+        if ( group.mNextTick == 0 )
+        {
+            auto offsetMs = mDeviceJitter.getOffsetMs( "periodicCollection", group.mPeriodMs );
+            if ( offsetMs > 0 )
+            {
+                group.mNextTick = currentTime + offsetMs;
+                continue;
+            }
+        }
+        for ( auto conditionIndex : group.mConditions )
+        {
+            // A condition whose data of the previous tick is not collected yet skips this tick
+            if ( mConditionsNotTriggeredWaitingPublished.test( conditionIndex ) )
+            {
+                triggerCondition( conditionIndex, currentTime );
+                triggered = true;
+            }
+        }
+        // The next tick stays on the grid of the phase, ticks that were missed are skipped
+        if ( group.mNextTick == 0 )
+        {
+            group.mNextTick = currentTime + group.mPeriodMs;
+        }
+        else
+        {
+            group.mNextTick += ( ( ( currentTime - group.mNextTick ) / group.mPeriodMs ) + 1 ) * group.mPeriodMs;
+        }
+    }
+    return triggered;
+}
+
+CollectionInspectionEngine::InspectionTimestamp
+CollectionInspectionEngine::getNextEvaluationTime( InspectionTimestamp currentTime ) const
+{
+    // The front entry might be stale, that only causes one evaluation too many
+    InspectionTimestamp nextTime =
+        mWindowTimeouts.empty() ? std::numeric_limits<InspectionTimestamp>::max() : mWindowTimeouts.front().mTimeout;
+    for ( const auto &group : mPeriodicGroups )
+    {
+        // The tick only has work to do if a condition of the group can trigger
+        if ( std::any_of( group.mConditions.begin(), group.mConditions.end(), [this]( uint32_t conditionIndex ) {
+                 return mConditionsNotTriggeredWaitingPublished.test( conditionIndex );
+             } ) )
+        {
+            nextTime = std::min( nextTime, group.mNextTick );
+        }
+    }
+    if ( nextTime <= currentTime )
+    {
+        return currentTime;
+    }
+    for ( size_t wordIndex = 0; wordIndex < mConditionsWithInputSignalChanged.wordCount(); wordIndex++ )
+    {
+        auto changed = mConditionsWithInputSignalChanged.word( wordIndex );
+        // Conditions that are true and evaluated again without input change only make a difference if they
+        // trigger again. Without minimum publish interval they are evaluated again with the next input.
+        auto conditionsToEvaluate = ( changed | ( mConditionsWithConditionCurrentlyTrue.word( wordIndex ) &
+                                                  mConditionsEvaluatedWhileTrue.word( wordIndex ) ) ) &
+                                    mConditionsNotTriggeredWaitingPublished.word( wordIndex );
+        while ( conditionsToEvaluate != 0 )
+        {
+            auto bit = ConditionBitset::lowestSetBit( conditionsToEvaluate );
+            auto i = static_cast<uint32_t>( ( wordIndex * ConditionBitset::BITS_PER_WORD ) + bit );
+            conditionsToEvaluate &= conditionsToEvaluate - 1;
+            if ( i >= mConditionStates.size() )
+            {
+                break;
+            }
+            const auto &state = mConditionStates[i];
+            bool inputChanged = ( ( changed >> bit ) & 1U ) != 0;
+            if ( ( !inputChanged ) && ( state.mTriggerOnlyOnRisingEdge || ( state.mMinimumPublishInterval == 0 ) ) )
+            {
+                continue;
+            }
+            nextTime = std::min(
+                nextTime, std::max( state.mLastTrigger + state.mMinimumPublishInterval, state.mNextEvaluation ) );
+            if ( nextTime <= currentTime )
+            {
+                return currentTime;
+            }
+        }
+    }
+    return nextTime;
+}
+
+uint32_t &
+CollectionInspectionEngine::getConsumedUntil( ConsumedUntilVector &consumedUntil, uint32_t conditionId )
+{
+    // Only the few conditions collecting from the same buffer have an entry so a linear search is enough
+    for ( auto &entry : consumedUntil )
+    {
+        if ( entry.mConditionId == conditionId )
+        {
+            return entry.mCounter;
+        }
+    }
+    consumedUntil.push_back( ConsumedUntil{ conditionId, 0 } );
+    return consumedUntil.back().mCounter;
+}
+
+void
+CollectionInspectionEngine::collectLastSignals( InspectionSignalID id,
+                                                uint32_t minimumSamplingInterval,
+                                                uint32_t maxNumberOfSignalsToCollect,
+                                                uint32_t conditionId,
+                                                InspectionTimestamp &newestSignalTimestamp,
+                                                TriggeredCollectionSchemeData &output,
+                                                bool copySamples )
+{
+    auto signalIndex = getSignalIndex( id );
+    if ( signalIndex == INVALID_SIGNAL_INDEX )
+    {
+        // Signal not collected by any active condition
+        return;
+    }
+    // Iterate through all sampling intervals of the signal
+    for ( auto &buf : mSignalBuffers[signalIndex] )
+    {
+        if ( buf.mMinimumSampleIntervalMs == minimumSamplingInterval && buf.mSize > 0 )
+        {
+            uint32_t &consumedUntil = getConsumedUntil( buf.mConsumedUntil, conditionId );
+            if ( buf.isView() )
+            {
+                // A view has no chunks to reference, its samples are copied from the base buffer
+                collectSignalViewSamples( id,
+                                          buf,
+                                          mSignalBuffers[signalIndex][buf.mBaseBufferIndex],
+                                          maxNumberOfSignalsToCollect,
+                                          consumedUntil,
+                                          newestSignalTimestamp,
+                                          output );
+            }
+            else if ( mSignalSnapshotsEnabled && ( !copySamples ) )
+            {
+                collectSignalSnapshot(
+                    id, buf, maxNumberOfSignalsToCollect, consumedUntil, newestSignalTimestamp, output );
+            }
+            else
+            {
+                collectSignalSamples(
+                    id, buf, maxNumberOfSignalsToCollect, consumedUntil, newestSignalTimestamp, output );
+            }
+            if ( ( buf.mDeepHistory != nullptr ) || ( buf.mCompressedHistory != nullptr ) )
+            {
+                collectDeepHistory( id, buf, maxNumberOfSignalsToCollect, consumedUntil, output );
+            }
+            consumedUntil = buf.mCounter;
+            return;
+        }
+    }
+}
+
+void
+CollectionInspectionEngine::updateNewestTimestamp( const SignalHistoryBuffer &buf,
+                                                   uint32_t sampleCount,
+                                                   InspectionTimestamp &newestTimestamp )
+{
+    if ( sampleCount == 0 )
+    {
+        return;
+    }
+    auto newestOffset = std::numeric_limits<int32_t>::min();
+    auto position = ( buf.mCurrentPosition < buf.mSize ) ? buf.mCurrentPosition : 0;
+    for ( uint32_t i = 0; i < sampleCount; )
+    {
+        const auto &offsets = buf.getChunk( position ).timestampOffsets;
+        auto last = position % SignalSampleChunk::SIZE;
+        auto runLength = std::min( last + 1, sampleCount - i );
+        // Contiguous and without a branch per sample, so that the compiler can vectorize it
+        newestOffset = std::max( newestOffset,
+                                 *std::max_element( offsets.begin() + ( last + 1 - runLength ),
+                                                    offsets.begin() + ( last + 1 ) ) );
+        i += runLength;
+        position = ( position >= runLength ) ? ( position - runLength ) : ( buf.mSize - 1 );
+    }
+    newestTimestamp = std::max(
+        newestTimestamp,
+        static_cast<InspectionTimestamp>( static_cast<int64_t>( buf.mTimestampEpoch ) + newestOffset ) );
+}
+
+void
+CollectionInspectionEngine::collectSignalSamples( InspectionSignalID id,
+                                                  const SignalHistoryBuffer &buf,
+                                                  uint32_t maxNumberOfSignalsToCollect,
+                                                  uint32_t consumedUntil,
+                                                  InspectionTimestamp &newestSignalTimestamp,
+                                                  TriggeredCollectionSchemeData &output ) const
+{
+    // The buffer can be smaller than requested because of the sample memory budget
+    auto availableSamples = std::min( std::min( maxNumberOfSignalsToCollect, buf.mCounter ), buf.mSize );
+    updateNewestTimestamp( buf, availableSamples, newestSignalTimestamp );
+    // The consumed samples are the oldest ones, so the samples to send are the newest in one piece
+    auto sampleCount =
+        mSendDataOnlyOncePerCondition ? std::min( availableSamples, buf.mCounter - consumedUntil ) : availableSamples;
+    output.signals.reserve( output.signals.size() + sampleCount );
+    // Newest sample first, copied in runs that do not wrap around the ring buffer or cross a chunk
+    auto position = ( buf.mCurrentPosition < buf.mSize ) ? buf.mCurrentPosition : 0;
+    for ( uint32_t i = 0; i < sampleCount; )
+    {
+        const auto &chunk = buf.getChunk( position );
+        auto last = position % SignalSampleChunk::SIZE;
+        auto runLength = std::min( last + 1, sampleCount - i );
+        for ( auto index = last + 1; index > last + 1 - runLength; index-- )
+        {
+            output.signals.emplace_back( id,
+                                         static_cast<InspectionTimestamp>( static_cast<int64_t>( buf.mTimestampEpoch ) +
+                                                                           chunk.timestampOffsets[index - 1] ),
+                                         chunk.values[index - 1] );
+            output.signals.back().receiveTimeFractionUs = chunk.timestampFractionsUs[index - 1];
+        }
+        i += runLength;
+        position = ( position >= runLength ) ? ( position - runLength ) : ( buf.mSize - 1 );
+    }
+}
+
+void
+CollectionInspectionEngine::collectSignalViewSamples( InspectionSignalID id,
+                                                      const SignalHistoryBuffer &view,
+                                                      const SignalHistoryBuffer &base,
+                                                      uint32_t maxNumberOfSignalsToCollect,
+                                                      uint32_t consumedUntil,
+                                                      InspectionTimestamp &newestSignalTimestamp,
+                                                      TriggeredCollectionSchemeData &output ) const
+{
+    auto availableSamples = std::min( std::min( maxNumberOfSignalsToCollect, view.mCounter ), view.mSize );
+    auto sampleCount = mSendDataOnlyOncePerCondition
+                           ? std::min( availableSamples, view.mCounter - consumedUntil )
+                           : availableSamples;
+    output.signals.reserve( output.signals.size() + sampleCount );
+    // Newest sample first, the newest timestamp is taken from all available samples like for the other buffers
+    for ( uint32_t i = 0; i < availableSamples; i++ )
+    {
+        auto position = ( view.mCurrentPosition + view.mSize - i ) % view.mSize;
+        auto basePosition = base.getPositionOfCounter( view.mBaseCounters[position] );
+        auto timestamp = base.getTimestamp( basePosition );
+        newestSignalTimestamp = std::max( newestSignalTimestamp, timestamp );
+        if ( i < sampleCount )
+        {
+            output.signals.emplace_back( id, timestamp, base.getValue( basePosition ) );
+            output.signals.back().receiveTimeFractionUs = base.getTimestampFractionUs( basePosition );
+        }
+    }
+}
+
+void
+CollectionInspectionEngine::collectSignalSnapshot( InspectionSignalID id,
+                                                   const SignalHistoryBuffer &buf,
+                                                   uint32_t maxNumberOfSignalsToCollect,
+                                                   uint32_t consumedUntil,
+                                                   InspectionTimestamp &newestSignalTimestamp,
+                                                   TriggeredCollectionSchemeData &output )
+{
+    // The buffer can be smaller than requested because of the sample memory budget
+    auto availableSamples = std::min( std::min( maxNumberOfSignalsToCollect, buf.mCounter ), buf.mSize );
+    // The consumed samples are the oldest ones, so the samples to send are the newest in one piece
+    auto sampleCount =
+        mSendDataOnlyOncePerCondition ? std::min( availableSamples, buf.mCounter - consumedUntil ) : availableSamples;
+    // Only the timestamps are read to find the newest sample, as done when the samples are copied
+    updateNewestTimestamp( buf, availableSamples, newestSignalTimestamp );
+    if ( sampleCount == 0 )
+    {
+        return;
+    }
+    SignalSnapshot snapshot;
+    snapshot.signalID = id;
+    snapshot.timestampEpoch = buf.mTimestampEpoch;
+    snapshot.bufferSize = buf.mSize;
+    snapshot.newestPosition = buf.mCurrentPosition;
+    snapshot.sampleCount = sampleCount;
+    snapshot.chunks.resize( buf.mChunks.size() );
+    // Walk backwards from the newest sample one chunk at a time
+    for ( uint32_t i = 0; i < sampleCount; )
+    {
+        auto position = ( buf.mCurrentPosition + buf.mSize - i ) % buf.mSize;
+        auto chunkIndex = position / SignalSampleChunk::SIZE;
+        snapshot.chunks[chunkIndex] = buf.mChunks[chunkIndex];
+        i += ( position % SignalSampleChunk::SIZE ) + 1;
+    }
+    output.signalSnapshots.emplace_back( std::move( snapshot ) );
+}
+
+void
+CollectionInspectionEngine::collectDeepHistory( InspectionSignalID id,
+                                                const SignalHistoryBuffer &buf,
+                                                uint32_t maxNumberOfSignalsToCollect,
+                                                uint32_t consumedUntil,
+                                                TriggeredCollectionSchemeData &output ) const
+{
+    // The deep history only has samples once the buffer in memory is full, they are all older than the samples in
+    // memory
+    if ( maxNumberOfSignalsToCollect <= buf.mSize )
+    {
+        return;
+    }
+    if ( buf.mCompressedHistory != nullptr )
+    {
+        auto sampleCount = std::min( maxNumberOfSignalsToCollect - buf.mSize, buf.mCompressedHistory->size() );
+        // The newest compressed sample has the counter value buf.mCounter - buf.mSize
+        if ( mSendDataOnlyOncePerCondition )
+        {
+            auto newestCounter = buf.mCounter - buf.mSize;
+            sampleCount =
+                ( newestCounter > consumedUntil ) ? std::min( sampleCount, newestCounter - consumedUntil ) : 0;
+        }
+        buf.mCompressedHistory->collectNewest( id, sampleCount, output.signals );
+        return;
+    }
+    auto sampleCount = std::min( maxNumberOfSignalsToCollect - buf.mSize, buf.mDeepHistory->size() );
+    for ( uint32_t i = 0; i < sampleCount; i++ )
+    {
+        // The newest sample in the file has the counter value buf.mCounter - buf.mSize
+        if ( mSendDataOnlyOncePerCondition && ( buf.mCounter - buf.mSize - i <= consumedUntil ) )
+        {
+            break;
+        }
+        const auto &sample = buf.mDeepHistory->get( i );
+        output.signals.emplace_back( id, sample.timestamp, sample.value );
+        output.signals.back().receiveTimeFractionUs = sample.timestampFractionUs;
+    }
+}
+
+void
+CollectionInspectionEngine::collectLastCanFrames( CANRawFrameID canID,
+                                                  CANChannelNumericID channelID,
+                                                  uint32_t minimumSamplingInterval,
+                                                  uint32_t maxNumberOfSignalsToCollect,
+                                                  uint32_t conditionId,
+                                                  InspectionTimestamp &newestSignalTimestamp,
+                                                  std::vector<CollectedCanRawFrame> &output )
+{
+    auto bufferIndex = getCanFrameBufferIndex( canID, channelID, minimumSamplingInterval );
+    if ( bufferIndex == INVALID_SIGNAL_INDEX )
+    {
+        return;
+    }
+    auto &buf = mCanFrameBuffers[bufferIndex];
+    uint32_t &consumedUntil = getConsumedUntil( buf.mConsumedUntil, conditionId );
+    auto availableSamples = std::min( std::min( maxNumberOfSignalsToCollect, buf.mCounter ), buf.mSize );
+    // The consumed samples are the oldest ones, so the samples to send are the newest in one piece
+    auto sampleCount =
+        mSendDataOnlyOncePerCondition ? std::min( availableSamples, buf.mCounter - consumedUntil ) : availableSamples;
+    output.reserve( output.size() + sampleCount );
+    // At most two runs, from the newest sample down to the start of the ring buffer and from its end
+    auto position = ( buf.mCurrentPosition < buf.mSize ) ? buf.mCurrentPosition : 0;
+    for ( uint32_t i = 0; i < availableSamples; )
+    {
+        auto runLength = std::min( position + 1, availableSamples - i );
+        auto copyLength = ( i < sampleCount ) ? std::min( runLength, sampleCount - i ) : 0;
+        for ( auto index = position + 1; index > position + 1 - runLength; index-- )
+        {
+            const auto &sample = buf.mBuffer[index - 1];
+            newestSignalTimestamp = std::max( newestSignalTimestamp, sample.mTimestamp );
+        }
+        for ( auto index = position + 1; index > position + 1 - copyLength; index-- )
+        {
+            const auto &sample = buf.mBuffer[index - 1];
+            output.emplace_back( canID,
+                                 channelID,
+                                 sample.mTimestamp,
+                                 &buf.mPayload[static_cast<size_t>( index - 1 ) * buf.mFrameCapacity],
+                                 sample.mSize );
+            output.back().receiveTimeFractionUs = sample.mTimestampFractionUs;
+        }
+        i += runLength;
+        position = buf.mSize - 1;
+    }
+    consumedUntil = buf.mCounter;
+}
+
+void
+CollectionInspectionEngine::collectSignalSummaries( const InspectionMatrixSignalCollectionInfo &signal,
+                                                    uint32_t conditionId,
+                                                    std::vector<SignalSummary> &output )
+{
+    auto *buf = getSignalBuffer( signal.signalID, signal.minimumSampleIntervalMs );
+    if ( buf == nullptr )
+    {
+        return;
+    }
+    auto *window = buf->getFixedWindow( signal.fixedWindowPeriod );
+    if ( window == nullptr )
+    {
+        return;
+    }
+    for ( auto &aggregator : window->mAggregators )
+    {
+        if ( ( aggregator.getConditionIndex() == conditionId ) && ( aggregator.getInfo() == signal.aggregation ) )
+        {
+            aggregator.takeSummaries( output );
+            return;
+        }
+    }
+}
+
+std::shared_ptr<TriggeredCollectionSchemeData>
+CollectionInspectionEngine::collectData( ActiveCondition &condition,
+                                         uint32_t conditionId,
+                                         InspectionTimestamp &newestSignalTimestamp )
+{
+    TraceScopedTimer collectTimer( TraceHistogram::INSPECTION_COLLECT_DATA_NS );
+    std::shared_ptr<TriggeredCollectionSchemeData> collectedData = mTriggeredDataPool->acquire();
+    collectedData->metaData = condition.mCondition.metaData;
+    collectedData->triggerTime = mConditionStates[conditionId].mLastTrigger;
+    // Pack signals
+    for ( auto &s : condition.mCondition.signals )
+    {
+        if ( s.isConditionOnlySignal )
+        {
+            continue;
+        }
+        if ( s.aggregation != nullptr )
+        {
+            // Only the summaries of the windows completed since the last collection are sent, not the samples
+            collectSignalSummaries( s, conditionId, collectedData->signalSummaries );
+        }
+        else
+        {
+            collectLastSignals( s.signalID,
+                                s.minimumSampleIntervalMs,
+                                s.sampleBufferSize,
+                                conditionId,
+                                newestSignalTimestamp,
+                                *collectedData,
+                                s.decimation != nullptr );
+        }
+    }
+
+    // Pack raw frames
+    for ( auto &c : condition.mCondition.canFrames )
+    {
+        if ( c.isConditionOnlyFrame )
+        {
+            continue;
+        }
+        collectLastCanFrames( c.frameID,
+                              c.channelID,
+                              c.minimumSampleIntervalMs,
+                              c.sampleBufferSize,
+                              conditionId,
+                              newestSignalTimestamp,
+                              collectedData->canFrames );
+    }
+    // Pack active DTCs if any. A versioned set that was already collected by this condition is only referenced by
+    // its sequence number, so that unchanged DTCs are not uploaded with every trigger.
+    if ( condition.mCondition.includeActiveDtcs )
+    {
+        if ( !isActiveDTCsConsumed( conditionId ) ||
+             ( mSendDataOnlyOncePerCondition && ( mActiveDTCs.mSequenceNumber == 0 ) ) )
+        {
+            collectedData->mDTCInfo = mActiveDTCs;
+            setActiveDTCsConsumed( conditionId, true );
+        }
+        else if ( mSendDataOnlyOncePerCondition )
+        {
+            collectedData->mDTCInfo.mSID = mActiveDTCs.mSID;
+            collectedData->mDTCInfo.receiveTime = mActiveDTCs.receiveTime;
+            collectedData->mDTCInfo.mSequenceNumber = mActiveDTCs.mSequenceNumber;
+            collectedData->mDTCInfo.mIsUnchanged = true;
+        }
+    }
+    // Pack geohash into data sender buffer if there's new geohash.
+    // A new geohash is generated during geohash function node evaluation
+    if ( mGeohashFunctionNode.hasNewGeohash() )
+    {
+        mGeohashFunctionNode.consumeGeohash( collectedData->mGeohashInfo );
+    }
+    // Propagate the event ID
+    collectedData->eventID = condition.mEventID;
+    collectedData->traceId = takePendingTrace( condition );
+    LatencyTracer::get().mark( collectedData->traceId, LatencyStage::TRIGGER );
+    return collectedData;
+}
+
+void
+CollectionInspectionEngine::decimateSignals( const ConditionWithCollectedData &condition,
+                                             TriggeredCollectionSchemeData &data )
+{
+    for ( const auto &s : condition.signals )
+    {
+        if ( ( s.decimation == nullptr ) || s.isConditionOnlySignal )
+        {
+            continue;
+        }
+        // The samples of the signal are moved to the end, the other signals keep their order
+        auto first = std::stable_partition( data.signals.begin(),
+                                            data.signals.end(),
+                                            [&s]( const CollectedSignal &signal ) {
+                                                return signal.signalID != s.signalID;
+                                            } );
+        decimateSignalSamples(
+            *s.decimation, data.signals, static_cast<size_t>( std::distance( data.signals.begin(), first ) ) );
+    }
+}
+
+CollectionInspectionEngine::SignalHistoryBuffer *
+CollectionInspectionEngine::getSignalBuffer( InspectionSignalID id, uint32_t minimumSamplingInterval )
+{
+    auto signalIndex = getSignalIndex( id );
+    if ( signalIndex == INVALID_SIGNAL_INDEX )
+    {
+        return nullptr;
+    }
+    for ( auto &buf : mSignalBuffers[signalIndex] )
+    {
+        if ( buf.mMinimumSampleIntervalMs == minimumSamplingInterval )
+        {
+            return &buf;
+        }
+    }
+    return nullptr;
+}
+
+void
+CollectionInspectionEngine::startStreamingCollection( uint32_t conditionIndex )
+{
+    auto &condition = mConditions[conditionIndex];
+    auto collectStartNs = mConditionProfilingEnabled ? TraceScopedTimer::getMonotonicRawTimeNs() : 0;
+    condition.mStreamingNewestTimestamp = 0;
+    condition.mStreamingData = collectData( condition, conditionIndex, condition.mStreamingNewestTimestamp );
+    if ( mConditionProfilingEnabled )
+    {
+        condition.mProfile.collectTimeNs += TraceScopedTimer::getMonotonicRawTimeNs() - collectStartNs;
+    }
+    // A signal or frame listed twice by the condition is still only appended once. Aggregated signals only send
+    // their summaries.
+    for ( const auto &s : condition.mCondition.signals )
+    {
+        auto *buf = ( s.isConditionOnlySignal || ( s.aggregation != nullptr ) )
+                        ? nullptr
+                        : getSignalBuffer( s.signalID, s.minimumSampleIntervalMs );
+        if ( ( buf != nullptr ) && buf->isAllocated() &&
+             ( std::find( buf->mStreamingConditions.begin(), buf->mStreamingConditions.end(), conditionIndex ) ==
+               buf->mStreamingConditions.end() ) )
+        {
+            buf->mStreamingConditions.push_back( conditionIndex );
+        }
+    }
+    for ( const auto &c : condition.mCondition.canFrames )
+    {
+        auto bufferIndex = getCanFrameBufferIndex( c.frameID, c.channelID, c.minimumSampleIntervalMs );
+        if ( ( bufferIndex == INVALID_SIGNAL_INDEX ) || c.isConditionOnlyFrame )
+        {
+            continue;
+        }
+        auto &conditions = mCanFrameBuffers[bufferIndex].mStreamingConditions;
+        if ( std::find( conditions.begin(), conditions.end(), conditionIndex ) == conditions.end() )
+        {
+            conditions.push_back( conditionIndex );
+        }
+    }
+}
+
+std::shared_ptr<TriggeredCollectionSchemeData>
+CollectionInspectionEngine::takeStreamingData( uint32_t conditionIndex, InspectionTimestamp &newestSignalTimestamp )
+{
+    auto &condition = mConditions[conditionIndex];
+    // The streamed samples count as collected, like the samples collected at the deadline without streaming
+    for ( const auto &s : condition.mCondition.signals )
+    {
+        auto *buf = getSignalBuffer( s.signalID, s.minimumSampleIntervalMs );
+        if ( buf == nullptr )
+        {
+            continue;
+        }
+        auto &conditions = buf->mStreamingConditions;
+        auto it = std::find( conditions.begin(), conditions.end(), conditionIndex );
+        if ( it != conditions.end() )
+        {
+            conditions.erase( it );
+            getConsumedUntil( buf->mConsumedUntil, conditionIndex ) = buf->mCounter;
+        }
+    }
+    for ( const auto &c : condition.mCondition.canFrames )
+    {
+        auto bufferIndex = getCanFrameBufferIndex( c.frameID, c.channelID, c.minimumSampleIntervalMs );
+        if ( bufferIndex == INVALID_SIGNAL_INDEX )
+        {
+            continue;
+        }
+        auto &buf = mCanFrameBuffers[bufferIndex];
+        auto it = std::find( buf.mStreamingConditions.begin(), buf.mStreamingConditions.end(), conditionIndex );
+        if ( it != buf.mStreamingConditions.end() )
+        {
+            buf.mStreamingConditions.erase( it );
+            getConsumedUntil( buf.mConsumedUntil, conditionIndex ) = buf.mCounter;
+        }
+    }
+    newestSignalTimestamp = condition.mStreamingNewestTimestamp;
+    return std::move( condition.mStreamingData );
+}
+
+std::shared_ptr<TriggeredCollectionSchemeData>
+CollectionInspectionEngine::collectTriggeredData( uint32_t conditionIndex, InspectionTimestamp currentTime )
+{
+    auto &condition = mConditions[conditionIndex];
+    // Generate the Event ID and pack  it into the active Condition
+    condition.mEventID = generateEventID( currentTime );
+    // Check if we need more data from other sensors
+    evaluateAndTriggerRichSensorCapture( condition );
+    InspectionTimestamp newestSignalTimeStamp = 0;
+    auto collectStartNs = mConditionProfilingEnabled ? TraceScopedTimer::getMonotonicRawTimeNs() : 0;
+    std::shared_ptr<TriggeredCollectionSchemeData> cd;
+    if ( condition.mStreamingData != nullptr )
+    {
+        cd = takeStreamingData( conditionIndex, newestSignalTimeStamp );
+        cd->eventID = condition.mEventID;
+    }
+    else
+    {
+        cd = collectData( condition, conditionIndex, newestSignalTimeStamp );
+    }
+    // Decimated after streaming, so that the streamed samples are decimated together with the samples before them
+    decimateSignals( condition.mCondition, *cd );
+    if ( mConditionProfilingEnabled )
+    {
+        condition.mProfile.collectTimeNs += TraceScopedTimer::getMonotonicRawTimeNs() - collectStartNs;
+        condition.mProfile.collectedBytes += getCollectedBytes( *cd );
+    }
+    // After collecting the data set the newest timestamp from any data that was
+    // collected
+    condition.mLastDataTimestampPublished = std::min( newestSignalTimeStamp, currentTime );
+    return cd;
+}
+
+uint64_t
+CollectionInspectionEngine::getCollectedBytes( const TriggeredCollectionSchemeData &data )
+{
+    uint64_t samples = data.signals.size();
+    for ( const auto &snapshot : data.signalSnapshots )
+    {
+        samples += snapshot.sampleCount;
+    }
+    return ( samples * sizeof( CollectedSignal ) ) + ( data.canFrames.size() * sizeof( CollectedCanRawFrame ) ) +
+           ( data.signalSummaries.size() * sizeof( SignalSummary ) );
+}
+
+std::vector<CollectionInspectionEngine::ConditionProfile>
+CollectionInspectionEngine::takeHotConditions( size_t count )
+{
+    std::vector<ConditionProfile> profiles;
+    for ( auto &condition : mConditions )
+    {
+        if ( ( condition.mProfile.evaluations > 0 ) || ( condition.mProfile.triggers > 0 ) )
+        {
+            profiles.emplace_back( condition.mProfile );
+            profiles.back().collectionSchemeID = condition.mCondition.metaData.collectionSchemeID;
+        }
+        condition.mProfile = ConditionProfile();
+    }
+    auto hotCount = std::min( count, profiles.size() );
+    std::partial_sort( profiles.begin(),
+                       profiles.begin() + static_cast<ptrdiff_t>( hotCount ),
+                       profiles.end(),
+                       []( const ConditionProfile &a, const ConditionProfile &b ) {
+                           return a.getEstimatedCostNs() > b.getEstimatedCostNs();
+                       } );
+    profiles.resize( hotCount );
+    return profiles;
+}
+
+void
+CollectionInspectionEngine::reportHotConditions( size_t count )
+{
+    auto hotConditions = takeHotConditions( count );
+    auto &traceModule = TraceModule::get();
+    // A condition that is not among the most expensive ones anymore must not keep its old values
+    for ( const auto &name : mReportedConditionVariables )
+    {
+        traceModule.removeNamedVariable( name );
+    }
+    mReportedConditionVariables.clear();
+    std::string report;
+    for ( const auto &profile : hotConditions )
+    {
+        auto setVariable = [&]( const std::string &prefix, uint64_t value, const std::string &unit ) {
+            auto name = prefix + profile.collectionSchemeID;
+            traceModule.setNamedVariable( name, static_cast<int64_t>( value ), unit );
+            mReportedConditionVariables.emplace_back( std::move( name ) );
+        };
+        auto costUs = profile.getEstimatedCostNs() / 1000;
+        setVariable( "conditionCostUs_", costUs, "Microseconds" );
+        setVariable( "conditionEvaluations_", profile.evaluations, "Count" );
+        setVariable( "conditionTriggers_", profile.triggers, "Count" );
+        setVariable( "conditionCollectedBytes_", profile.collectedBytes, "Bytes" );
+        setVariable( "conditionCollectTimeUs_", profile.collectTimeNs / 1000, "Microseconds" );
+        report += " " + profile.collectionSchemeID + ": " + std::to_string( costUs ) + " us";
+    }
+    if ( !hotConditions.empty() )
+    {
+        mLogger.info( "CollectionInspectionEngine::reportHotConditions", "Most expensive conditions:" + report );
+    }
+}
+
+bool
+CollectionInspectionEngine::canSharePayload( const PassThroughMetaData &a, const PassThroughMetaData &b )
+{
+    // The sender stores, compresses and prioritizes a payload as a whole and writes its raw CAN frames in one layout.
+    // A sample is sent once, so it must be rounded to the same resolution for all events.
+    bool sameResolutions = ( a.uploadResolutions == b.uploadResolutions ) ||
+                           ( ( a.uploadResolutions != nullptr ) && ( b.uploadResolutions != nullptr ) &&
+                             ( *a.uploadResolutions == *b.uploadResolutions ) );
+    return ( a.compress == b.compress ) && ( a.compressionCodec == b.compressionCodec ) &&
+           ( a.compressionDictionary == b.compressionDictionary ) && ( a.rawCanLog == b.rawCanLog ) &&
+           ( a.persist == b.persist ) && ( a.priority == b.priority ) && ( a.decoderID == b.decoderID ) &&
+           sameResolutions;
+}
+
+void
+CollectionInspectionEngine::collectSharedEvents( TriggeredCollectionSchemeData &sharedData,
+                                                 InspectionTimestamp currentTime )
+{
+    while ( ( !mPendingCollections.empty() ) && ( mPendingCollections.front().mDeadline <= currentTime ) )
+    {
+        auto next = mPendingCollections.front();
+        std::pop_heap( mPendingCollections.begin(), mPendingCollections.end(), IsLater() );
+        mPendingCollections.pop_back();
+        auto &condition = mConditions[next.mConditionIndex];
+        if ( !canSharePayload( sharedData.metaData, condition.mCondition.metaData ) )
+        {
+            mNotSharedCollections.emplace_back( next );
+            continue;
+        }
+        mConditionsNotTriggeredWaitingPublished.set( next.mConditionIndex );
+        if ( mDataReduction.shallSendData( condition.mCondition.probabilityToSend ) )
+        {
+            auto data = collectTriggeredData( next.mConditionIndex, currentTime );
+            mergeSharedEvent( sharedData, *data, condition.mCondition );
+        }
+        else if ( condition.mStreamingData != nullptr )
+        {
+            InspectionTimestamp newestSignalTimestamp = 0;
+            (void)takeStreamingData( next.mConditionIndex, newestSignalTimestamp );
+        }
+    }
+    // The other conditions are collected with the next call
+    for ( const auto &pending : mNotSharedCollections )
+    {
+        mPendingCollections.emplace_back( pending );
+        std::push_heap( mPendingCollections.begin(), mPendingCollections.end(), IsLater() );
+    }
+    mNotSharedCollections.clear();
+}
+
+void
+CollectionInspectionEngine::mergeSharedEvent( TriggeredCollectionSchemeData &sharedData,
+                                              const TriggeredCollectionSchemeData &data,
+                                              const ConditionWithCollectedData &condition )
+{
+    SharedCollectionEvent event;
+    event.collectionSchemeID = data.metaData.collectionSchemeID;
+    event.triggerTime = data.triggerTime;
+    event.eventID = data.eventID;
+    for ( const auto &s : condition.signals )
+    {
+        if ( !s.isConditionOnlySignal )
+        {
+            event.signalIDs.emplace_back( s.signalID );
+        }
+    }
+    for ( const auto &c : condition.canFrames )
+    {
+        if ( !c.isConditionOnlyFrame )
+        {
+            event.canFrameIDs.emplace_back( c.frameID );
+        }
+    }
+    sharedData.sharedEvents.emplace_back( std::move( event ) );
+
+    // A sample is identified by its signal and time, as all conditions read the same history buffers
+    std::set<std::tuple<SignalID, Timestamp, TimestampFractionUs>> signalSamples;
+    for ( const auto &signal : sharedData.signals )
+    {
+        signalSamples.emplace( signal.signalID, signal.receiveTime, signal.receiveTimeFractionUs );
+    }
+    for ( const auto &signal : data.signals )
+    {
+        if ( signalSamples.emplace( signal.signalID, signal.receiveTime, signal.receiveTimeFractionUs ).second )
+        {
+            sharedData.signals.emplace_back( signal );
+        }
+    }
+    // Snapshots of the same history buffer end at the same sample, so the longer one contains the other
+    auto sharedSnapshotCount = sharedData.signalSnapshots.size();
+    for ( const auto &snapshot : data.signalSnapshots )
+    {
+        const auto &newestChunk = snapshot.chunks[snapshot.newestPosition / SignalSampleChunk::SIZE];
+        size_t i = 0;
+        while ( ( i < sharedSnapshotCount ) &&
+                ( ( sharedData.signalSnapshots[i].signalID != snapshot.signalID ) ||
+                  ( sharedData.signalSnapshots[i].bufferSize != snapshot.bufferSize ) ||
+                  ( sharedData.signalSnapshots[i].newestPosition != snapshot.newestPosition ) ||
+                  ( sharedData.signalSnapshots[i].chunks[snapshot.newestPosition / SignalSampleChunk::SIZE] !=
+                    newestChunk ) ) )
+        {
+            i++;
+        }
+        if ( i == sharedSnapshotCount )
+        {
+            sharedData.signalSnapshots.emplace_back( snapshot );
+        }
+        else if ( snapshot.sampleCount > sharedData.signalSnapshots[i].sampleCount )
+        {
+            sharedData.signalSnapshots[i] = snapshot;
+        }
+    }
+    std::set<std::tuple<CANRawFrameID, CANChannelNumericID, Timestamp, TimestampFractionUs>> canFrames;
+    for ( const auto &frame : sharedData.canFrames )
+    {
+        canFrames.emplace( frame.frameID, frame.channelId, frame.receiveTime, frame.receiveTimeFractionUs );
+    }
+    for ( const auto &frame : data.canFrames )
+    {
+        if ( canFrames.emplace( frame.frameID, frame.channelId, frame.receiveTime, frame.receiveTimeFractionUs )
+                 .second )
+        {
+            sharedData.canFrames.emplace_back( frame );
+        }
+    }
+    // Conditions with the same aggregation of a signal complete the same summaries
+    for ( const auto &summary : data.signalSummaries )
+    {
+        auto isSameSummary = [&summary]( const SignalSummary &other ) {
+            return ( other.signalID == summary.signalID ) && ( other.windowStartTime == summary.windowStartTime ) &&
+                   ( other.windowSizeMs == summary.windowSizeMs ) && ( other.count == summary.count ) &&
+                   ( other.min == summary.min ) && ( other.max == summary.max ) && ( other.mean == summary.mean ) &&
+                   ( other.variance == summary.variance ) && ( other.histogramCounts == summary.histogramCounts ) &&
+                   ( other.percentileValues == summary.percentileValues );
+        };
+        if ( std::none_of( sharedData.signalSummaries.begin(), sharedData.signalSummaries.end(), isSameSummary ) )
+        {
+            sharedData.signalSummaries.emplace_back( summary );
+        }
+    }
+    // The active DTCs and the geohash are the same for all conditions collected at the same time
+    if ( ( !sharedData.mDTCInfo.hasItems() ) && data.mDTCInfo.hasItems() )
+    {
+        sharedData.mDTCInfo = data.mDTCInfo;
+    }
+    if ( ( !sharedData.mGeohashInfo.hasItems() ) && data.mGeohashInfo.hasItems() )
+    {
+        sharedData.mGeohashInfo = data.mGeohashInfo;
+    }
+    if ( sharedData.traceId == 0 )
+    {
+        sharedData.traceId = data.traceId;
+    }
+}
+
+std::shared_ptr<const TriggeredCollectionSchemeData>
+CollectionInspectionEngine::collectNextDataToSend( InspectionTimestamp currentTime, uint32_t &waitTimeMs )
+{
+    // Only the triggered conditions are in the heap, so only the conditions that are due are visited
+    while ( !mPendingCollections.empty() )
+    {
+        auto next = mPendingCollections.front();
+        if ( next.mDeadline > currentTime )
+        {
+            waitTimeMs = static_cast<uint32_t>(
+                std::min<InspectionTimestamp>( next.mDeadline - currentTime, std::numeric_limits<uint32_t>::max() ) );
+            return std::shared_ptr<const TriggeredCollectionSchemeData>( nullptr );
+        }
+        std::pop_heap( mPendingCollections.begin(), mPendingCollections.end(), IsLater() );
+        mPendingCollections.pop_back();
+        auto &condition = mConditions[next.mConditionIndex];
+        mConditionsNotTriggeredWaitingPublished.set( next.mConditionIndex );
+        // Send message out only with a certain probability. If probabilityToSend==0
+        // no data is sent out
+        if ( mDataReduction.shallSendData( condition.mCondition.probabilityToSend ) )
+        {
+            auto cd = collectTriggeredData( next.mConditionIndex, currentTime );
+            if ( mSharedPayloadsEnabled )
+            {
+                collectSharedEvents( *cd, currentTime );
+            }
+            return cd;
+        }
+        if ( condition.mStreamingData != nullptr )
+        {
+            InspectionTimestamp newestSignalTimestamp = 0;
+            (void)takeStreamingData( next.mConditionIndex, newestSignalTimestamp );
+        }
+    }
+    // No Data ready to be sent
+    waitTimeMs = std::numeric_limits<uint32_t>::max();
+    return std::shared_ptr<const TriggeredCollectionSchemeData>( nullptr );
+}
+
+void
+CollectionInspectionEngine::evaluateAndTriggerRichSensorCapture( const ActiveCondition &condition )
+{
+    // Find out whether Image Data is needed.
+    if ( condition.mCondition.includeImageCapture )
+    {
+        std::vector<EventMetadata> eventMetadata;
+        // Create an Event Item for each device we want to get image from
+        for ( const auto &imageCollectionInfo : condition.mCondition.imageCollectionInfos )
+        {
+            // Make sure the same Event ID is passed to the Image capture module
+            // The event happened  afterDuration before now, and thus, the camera
+            // data should have been requested already during the condition eval,
+            // however, because the Camera request is completely not in scope of the
+            // InspectionCycle, we want to make sure that no data leaves the system
+            // if it does not fit into the probability. We also want to make sure
+            // we don 't trigger camera collection if the probably meanwhile changed.
+            // That's why the PositiveOffset is set to zero.
+            eventMetadata.emplace_back( condition.mEventID,
+                                        imageCollectionInfo.deviceID,
+                                        imageCollectionInfo.beforeDurationMs + condition.mCondition.afterDuration,
+                                        0 );
+            eventMetadata.back().imageType = imageCollectionInfo.imageFormat;
+            eventMetadata.back().captureOptions = imageCollectionInfo.captureOptions;
+        }
+        // This is non blocking. Listeners simply copy the metadata.
+        notifyListeners<const std::vector<EventMetadata> &>( &InspectionEventListener::onEventOfInterestDetected,
+                                                             eventMetadata );
+    }
+}
+
+uint32_t
+CollectionInspectionEngine::takePendingTrace( const ActiveCondition &condition )
+{
+    for ( auto trace = mPendingTraces.begin(); trace != mPendingTraces.end(); trace++ )
+    {
+        for ( const auto &s : condition.mCondition.signals )
+        {
+            if ( ( !s.isConditionOnlySignal ) && ( s.signalID == trace->first ) )
+            {
+                auto traceId = trace->second;
+                mPendingTraces.erase( trace );
+                return traceId;
+            }
+        }
+    }
+    return 0;
+}
+
+void
+CollectionInspectionEngine::addTracedSignal( InspectionSignalID id, uint32_t traceId )
+{
+    if ( getSignalIndex( id ) == INVALID_SIGNAL_INDEX )
+    {
+        return;
+    }
+    if ( mPendingTraces.size() >= MAX_PENDING_TRACES )
+    {
+        mPendingTraces.erase( mPendingTraces.begin() );
+    }
+    mPendingTraces.emplace_back( id, traceId );
+}
+
+void
+CollectionInspectionEngine::addNewSignal( InspectionSignalID id,
+                                          InspectionTimestamp receiveTime,
+                                          InspectionValue value,
+                                          TimestampFractionUs receiveTimeFractionUs,
+                                          ManifestSignalIndex manifestSignalIndex )
+{
+    auto signalIndex = getSignalIndex( id, manifestSignalIndex );
+    if ( signalIndex == INVALID_SIGNAL_INDEX )
+    {
+        // Signal not collected by any active condition
+        return;
+    }
+    // The minimum sample interval is applied with microsecond resolution if the source provides it
+    uint64_t receiveTimeUs = toMicroseconds( receiveTime, receiveTimeFractionUs );
+    // Iterate through all sampling intervals of the signal. The views come last, they reference the sample the
+    // base buffer just stored.
+    auto &bufferVector = mSignalBuffers[signalIndex];
+    bool hasViews = false;
+    for ( uint32_t bufferIndex = 0; bufferIndex < bufferVector.size(); bufferIndex++ )
+    {
+        if ( bufferVector[bufferIndex].isView() )
+        {
+            hasViews = true;
+            continue;
+        }
+        addSampleToBuffer( signalIndex, bufferIndex, id, receiveTime, value, receiveTimeFractionUs, receiveTimeUs );
+    }
+    for ( uint32_t bufferIndex = 0; hasViews && ( bufferIndex < bufferVector.size() ); bufferIndex++ )
+    {
+        if ( bufferVector[bufferIndex].isView() )
+        {
+            addSampleToBuffer(
+                signalIndex, bufferIndex, id, receiveTime, value, receiveTimeFractionUs, receiveTimeUs );
+        }
+    }
+}
+
+void
+CollectionInspectionEngine::addSampleToBuffer( uint32_t signalIndex,
+                                               uint32_t bufferIndex,
+                                               InspectionSignalID id,
+                                               InspectionTimestamp receiveTime,
+                                               InspectionValue value,
+                                               TimestampFractionUs receiveTimeFractionUs,
+                                               uint64_t receiveTimeUs )
+{
+    auto &bufferVector = mSignalBuffers[signalIndex];
+    auto &buf = bufferVector[bufferIndex];
+    if ( ( !buf.isAllocated() ) ||
+         ( ( buf.mMinimumSampleIntervalMs != 0 ) &&
+           ( receiveTimeUs < buf.mLastSampleUs + buf.mMinimumSampleIntervalMs * MICROSECONDS_PER_MILLISECOND ) ) )
+    {
+        return;
+    }
+    if ( buf.mHasViews && ( buf.mCounter >= buf.mSize ) )
+    {
+        // The oldest sample is overwritten next, views that still have it need their own chunks from now on
+        auto oldestCounter = buf.mCounter - buf.mSize + 1;
+        for ( auto &view : bufferVector )
+        {
+            if ( view.isView() && ( view.mCounter > 0 ) && ( view.getOldestBaseCounter() <= oldestCounter ) )
+            {
+                materializeSignalView( view, buf );
+            }
+        }
+    }
+    buf.mCurrentPosition++;
+    if ( buf.mCurrentPosition >= buf.mSize )
+    {
+        buf.mCurrentPosition = 0;
+    }
+    if ( buf.isView() )
+    {
+        // The base buffer has no sample interval, so it stored the sample already
+        buf.mBaseCounters[buf.mCurrentPosition] = bufferVector[buf.mBaseBufferIndex].mCounter;
+    }
+    else
+    {
+        if ( ( buf.mDeepHistory != nullptr ) && ( buf.mCounter >= buf.mSize ) )
+        {
+            // The oldest sample in memory is overwritten next, it moves to the file
+            buf.mDeepHistory->push( buf.getTimestamp( buf.mCurrentPosition ),
+                                    buf.getValue( buf.mCurrentPosition ),
+                                    buf.getTimestampFractionUs( buf.mCurrentPosition ) );
+        }
+        else if ( ( buf.mCompressedHistory != nullptr ) && ( buf.mCounter >= buf.mSize ) )
+        {
+            buf.mCompressedHistory->push( buf.getTimestamp( buf.mCurrentPosition ),
+                                          buf.getValue( buf.mCurrentPosition ),
+                                          buf.getTimestampFractionUs( buf.mCurrentPosition ) );
+        }
+        buf.setSample( buf.mCurrentPosition, value, receiveTime, receiveTimeFractionUs );
+    }
+    buf.mCounter++;
+    buf.mLastSampleUs = receiveTimeUs;
+    for ( auto conditionIndex : buf.mStreamingConditions )
+    {
+        auto &condition = mConditions[conditionIndex];
+        condition.mStreamingData->signals.emplace_back( id, receiveTime, value );
+        condition.mStreamingData->signals.back().receiveTimeFractionUs = receiveTimeFractionUs;
+        condition.mStreamingNewestTimestamp = std::max( condition.mStreamingNewestTimestamp, receiveTime );
+    }
+    if ( !buf.mThresholds.empty() )
+    {
+        updateThresholdLeaves( buf, value );
+    }
+    if ( ( !buf.mWindowFunctionData.empty() ) || ( !buf.mSlidingWindowFunctionData.empty() ) )
+    {
+        InspectionTimestamp nextTimeout = std::numeric_limits<InspectionTimestamp>::max();
+        for ( auto &window : buf.mWindowFunctionData )
+        {
+            window.addValue( value, receiveTime, nextTimeout );
+        }
+        for ( auto &window : buf.mSlidingWindowFunctionData )
+        {
+            window.addValue( value, receiveTime, nextTimeout );
+        }
+        scheduleWindowTimeout( signalIndex, bufferIndex, nextTimeout );
+    }
+    setInputSignalChanged( buf );
+}
+
+void
+CollectionInspectionEngine::addNewRawCanFrame( CANRawFrameID canID,
+                                               CANChannelNumericID channelID,
+                                               InspectionTimestamp receiveTime,
+                                               const uint8_t *buffer,
+                                               uint8_t size,
+                                               TimestampFractionUs receiveTimeFractionUs )
+{
+    auto bufferIndices = getCanFrameBufferIndices( canID, channelID );
+    if ( bufferIndices == nullptr )
+    {
+        // Frame not collected by any active condition
+        return;
+    }
+    uint64_t receiveTimeUs = toMicroseconds( receiveTime, receiveTimeFractionUs );
+    // Iterate through all sampling intervals of the frame
+    for ( auto bufferIndex : *bufferIndices )
+    {
+        auto &buf = mCanFrameBuffers[bufferIndex];
+        if ( buf.mSize > 0 && buf.mSize <= buf.mBuffer.size() &&
+             ( buf.mMinimumSampleIntervalMs == 0 ||
+               ( receiveTimeUs >=
+                 buf.mLastSampleUs + buf.mMinimumSampleIntervalMs * MICROSECONDS_PER_MILLISECOND ) ) )
+        {
+            buf.mCurrentPosition++;
+            if ( buf.mCurrentPosition >= buf.mSize )
+            {
+                buf.mCurrentPosition = 0;
+            }
+            if ( size > buf.mFrameCapacity )
+            {
+                growCanFramePayload( buf );
+            }
+            buf.mBuffer[buf.mCurrentPosition].mSize = std::min( size, buf.mFrameCapacity );
+            std::copy( buffer,
+                       buffer + buf.mBuffer[buf.mCurrentPosition].mSize,
+                       buf.mPayload.begin() +
+                           static_cast<std::ptrdiff_t>( buf.mCurrentPosition * buf.mFrameCapacity ) );
+            buf.mBuffer[buf.mCurrentPosition].mTimestamp = receiveTime;
+            buf.mBuffer[buf.mCurrentPosition].mTimestampFractionUs = receiveTimeFractionUs;
+            buf.mCounter++;
+            buf.mLastSampleUs = receiveTimeUs;
+            for ( auto conditionIndex : buf.mConditionsThatEvaluateOnThisFrame )
+            {
+                mConditionsWithInputSignalChanged.set( conditionIndex );
+            }
+            for ( auto conditionIndex : buf.mStreamingConditions )
+            {
+                auto &condition = mConditions[conditionIndex];
+                condition.mStreamingData->canFrames.emplace_back(
+                    canID, channelID, receiveTime, buffer, buf.mBuffer[buf.mCurrentPosition].mSize );
+                condition.mStreamingData->canFrames.back().receiveTimeFractionUs = receiveTimeFractionUs;
+                condition.mStreamingNewestTimestamp = std::max( condition.mStreamingNewestTimestamp, receiveTime );
+            }
+        }
+    }
+}
+
+void
+CollectionInspectionEngine::growCanFramePayload( CanFrameHistoryBuffer &buf )
+{
+    decltype( buf.mPayload ) payload( static_cast<size_t>( buf.mSize ) * MAX_CANFD_FRAME_BYTE_SIZE );
+    for ( size_t i = 0; i < buf.mSize; i++ )
+    {
+        std::copy( buf.mPayload.begin() + static_cast<std::ptrdiff_t>( i * buf.mFrameCapacity ),
+                   buf.mPayload.begin() + static_cast<std::ptrdiff_t>( ( i + 1 ) * buf.mFrameCapacity ),
+                   payload.begin() + static_cast<std::ptrdiff_t>( i * MAX_CANFD_FRAME_BYTE_SIZE ) );
+    }
+    buf.mPayload.swap( payload );
+    buf.mFrameCapacity = MAX_CANFD_FRAME_BYTE_SIZE;
+}
+
+void
+CollectionInspectionEngine::setActiveDTCs( const DTCInfo &activeDTCs )
+{
+    if ( !activeDTCs.mIsDelta )
+    {
+        mActiveDTCs = activeDTCs;
+    }
+    else if ( activeDTCs.mSequenceNumber != mActiveDTCs.mSequenceNumber + 1U )
+    {
+        // A delta was lost. The OBD module sends the full set again after a failed push.
+        mLogger.warn( "CollectionInspectionEngine::setActiveDTCs", [&]() {
+            return "DTC delta " + std::to_string( activeDTCs.mSequenceNumber ) + " does not follow DTC set " +
+                   std::to_string( mActiveDTCs.mSequenceNumber ) + ", keeping the previous DTCs";
+        } );
+        return;
+    }
+    else
+    {
+        auto &codes = mActiveDTCs.mDTCCodes;
+        for ( const auto &removedCode : activeDTCs.mRemovedDTCCodes )
+        {
+            codes.erase( std::remove( codes.begin(), codes.end(), removedCode ), codes.end() );
+        }
+        codes.insert( codes.end(), activeDTCs.mDTCCodes.begin(), activeDTCs.mDTCCodes.end() );
+        mActiveDTCs.mSID = activeDTCs.mSID;
+        mActiveDTCs.receiveTime = activeDTCs.receiveTime;
+        mActiveDTCs.mSequenceNumber = activeDTCs.mSequenceNumber;
+    }
+    mActiveDTCs.mIsDelta = false;
+    mActiveDTCs.mRemovedDTCCodes.clear();
+    setActiveDTCsConsumed( ALL_CONDITIONS, false );
+}
+
+CollectionInspectionEngine::ExpressionErrorCode
+CollectionInspectionEngine::getLatestSignalValue( uint32_t signalIndex, InspectionValue &result )
+{
+    if ( signalIndex >= mEvaluationSignals.size() )
+    {
+        mLogger.warn( "CollectionInspectionEngine::getLatestSignalValue", []() { return "SIGNAL_NOT_FOUND"; } );
+        // Signal not collected by any active condition
+        return ExpressionErrorCode::SIGNAL_NOT_FOUND;
+    }
+    const auto &evaluationSignal = mEvaluationSignals[signalIndex];
+    SignalHistoryBuffer *s = &mSignalBuffers[evaluationSignal.mSignalIndex][evaluationSignal.mBufferIndex];
+    if ( s->mCounter == 0 )
+    {
+        // Not a single sample collected yet
+        return ExpressionErrorCode::SIGNAL_NOT_FOUND;
+    }
+    result = getNewestValue( mSignalBuffers[evaluationSignal.mSignalIndex], *s );
+    return ExpressionErrorCode::SUCCESSFUL;
+}
+
+CollectionInspectionEngine::ExpressionErrorCode
+CollectionInspectionEngine::getSampleWindowFunction( WindowFunction function,
+                                                     uint32_t signalIndex,
+                                                     InspectionValue &result )
+{
+    if ( isSlidingWindowFunction( function ) )
+    {
+        if ( ( signalIndex >= mEvaluationSignals.size() ) ||
+             ( mEvaluationSignals[signalIndex].mSlidingWindowIndex == INVALID_SIGNAL_INDEX ) )
+        {
+            // Signal not collected by any active condition or without fixed window period
+            return ExpressionErrorCode::SIGNAL_NOT_FOUND;
+        }
+        const auto &evaluationSignal = mEvaluationSignals[signalIndex];
+        const auto &window = mSignalBuffers[evaluationSignal.mSignalIndex][evaluationSignal.mBufferIndex]
+                                 .mSlidingWindowFunctionData[evaluationSignal.mSlidingWindowIndex];
+        return window.getValue( function, result ) ? ExpressionErrorCode::SUCCESSFUL
+                                                   : ExpressionErrorCode::FUNCTION_DATA_NOT_AVAILABLE;
+    }
+    if ( ( signalIndex >= mEvaluationSignals.size() ) ||
+         ( mEvaluationSignals[signalIndex].mWindowIndex == INVALID_SIGNAL_INDEX ) )
+    {
+        // Signal not collected by any active condition
+        return ExpressionErrorCode::SIGNAL_NOT_FOUND;
+    }
+    const auto &evaluationSignal = mEvaluationSignals[signalIndex];
+    auto w = &mSignalBuffers[evaluationSignal.mSignalIndex][evaluationSignal.mBufferIndex]
+                  .mWindowFunctionData[evaluationSignal.mWindowIndex];
+
+    switch ( function )
+    {
+    case WindowFunction::LAST_FIXED_WINDOW_AVG:
+        result = w->mLastAvg;
+        return w->mLastAvailable ? ExpressionErrorCode::SUCCESSFUL : ExpressionErrorCode::FUNCTION_DATA_NOT_AVAILABLE;
+    case WindowFunction::LAST_FIXED_WINDOW_MIN:
+        result = w->mLastMin;
+        return w->mLastAvailable ? ExpressionErrorCode::SUCCESSFUL : ExpressionErrorCode::FUNCTION_DATA_NOT_AVAILABLE;
+    case WindowFunction::LAST_FIXED_WINDOW_MAX:
+        result = w->mLastMax;
+        return w->mLastAvailable ? ExpressionErrorCode::SUCCESSFUL : ExpressionErrorCode::FUNCTION_DATA_NOT_AVAILABLE;
+    case WindowFunction::PREV_LAST_FIXED_WINDOW_AVG:
+        result = w->mPreviousLastAvg;
+        return w->mPreviousLastAvailable ? ExpressionErrorCode::SUCCESSFUL
+                                         : ExpressionErrorCode::FUNCTION_DATA_NOT_AVAILABLE;
+    case WindowFunction::PREV_LAST_FIXED_WINDOW_MIN:
+        result = w->mPreviousLastMin;
+        return w->mPreviousLastAvailable ? ExpressionErrorCode::SUCCESSFUL
+                                         : ExpressionErrorCode::FUNCTION_DATA_NOT_AVAILABLE;
+    case WindowFunction::PREV_LAST_FIXED_WINDOW_MAX:
+        result = w->mPreviousLastMax;
+        return w->mPreviousLastAvailable ? ExpressionErrorCode::SUCCESSFUL
+                                         : ExpressionErrorCode::FUNCTION_DATA_NOT_AVAILABLE;
+    default:
+        return ExpressionErrorCode::NOT_IMPLEMENTED_FUNCTION;
+    }
+}
+
+CollectionInspectionEngine::ExpressionErrorCode
+CollectionInspectionEngine::getGeohashFunctionNode( const Instruction &instruction, bool &resultValueBool )
+{
+    resultValueBool = false;
+    // First we need to grab Latitude / longitude signal from collected signal buffer
+    InspectionValue latitude = 0;
+    auto status = getLatestSignalValue( instruction.index, latitude );
+    if ( status != ExpressionErrorCode::SUCCESSFUL )
+    {
+        mLogger.warn( "CollectionInspectionEngine::getGeohashFunctionNode",
+                      []() { return "Unable to evaluate Geohash due to missing latitude signal!"; } );
+        return status;
+    }
+    InspectionValue longitude = 0;
+    status = getLatestSignalValue( instruction.secondIndex, longitude );
+    if ( status != ExpressionErrorCode::SUCCESSFUL )
+    {
+        mLogger.warn( "CollectionInspectionEngine::getGeohashFunctionNode",
+                      []() { return "Unable to evaluate Geohash due to missing longitude signal!"; } );
+        return status;
+    }
+    const auto &geohashFunction = instruction.node->function.geohashFunction;
+    resultValueBool = mGeohashFunctionNode.evaluateGeohash(
+        latitude, longitude, geohashFunction.precision, geohashFunction.gpsUnitType );
+    return ExpressionErrorCode::SUCCESSFUL;
+}
+
+CollectionInspectionEngine::ExpressionErrorCode
+CollectionInspectionEngine::getGeofenceFunctionNode( const Instruction &instruction, bool &resultValueBool )
+{
+    resultValueBool = false;
+    auto &geofenceFunction = mGeofenceFunctions[instruction.index];
+    InspectionValue latitude = 0;
+    auto status = getLatestSignalValue( geofenceFunction.mLatitudeIndex, latitude );
+    if ( status != ExpressionErrorCode::SUCCESSFUL )
+    {
+        return status;
+    }
+    InspectionValue longitude = 0;
+    status = getLatestSignalValue( geofenceFunction.mLongitudeIndex, longitude );
+    if ( status != ExpressionErrorCode::SUCCESSFUL )
+    {
+        return status;
+    }
+    resultValueBool = geofenceFunction.mNode.evaluateGeofence(
+        latitude, longitude, instruction.node->function.geofenceFunction.gpsUnitType );
+    return ExpressionErrorCode::SUCCESSFUL;
+}
+
+CollectionInspectionEngine::ExpressionErrorCode
+CollectionInspectionEngine::getRawFrameField( const Instruction &instruction, InspectionValue &result )
+{
+    const auto &field = mRawFrameFields[instruction.index];
+    const auto &buf = mCanFrameBuffers[field.mBufferIndex];
+    if ( ( buf.mCounter == 0 ) || ( buf.mCurrentPosition >= buf.mBuffer.size() ) )
+    {
+        // Not a single frame received yet
+        return ExpressionErrorCode::SIGNAL_NOT_FOUND;
+    }
+    const auto &sample = buf.mBuffer[buf.mCurrentPosition];
+    if ( sample.mSize < field.mStep.mMinFrameSize )
+    {
+        // The frame is too short to contain the field
+        return ExpressionErrorCode::SIGNAL_NOT_FOUND;
+    }
+    result = static_cast<InspectionValue>( CANDecoder::extractSignalFromFrame(
+        &buf.mPayload[static_cast<size_t>( buf.mCurrentPosition ) * buf.mFrameCapacity], sample.mSize, field.mStep ) );
+    return ExpressionErrorCode::SUCCESSFUL;
+}
+
+CollectionInspectionEngine::ExpressionErrorCode
+CollectionInspectionEngine::runProgram( const std::vector<Instruction> &program,
+                                        size_t begin,
+                                        size_t end,
+                                        EvaluationValue &result )
+{
+    // Every level of the expression leaves at most one value on the stack
+    std::array<EvaluationValue, MAX_EQUATION_DEPTH + 1> stack;
+    size_t top = 0;
+    size_t pc = begin;
+    while ( pc < end )
+    {
+        const auto &instruction = program[pc];
+        pc++;
+        ExpressionErrorCode ret = ExpressionErrorCode::SUCCESSFUL;
+        EvaluationValue value;
+        switch ( instruction.opCode )
+        {
+        case Instruction::OpCode::PUSH_CONSTANT:
+            value.mDouble = instruction.value;
+            value.mBool = instruction.boolValue;
+            break;
+        case Instruction::OpCode::JUMP_IF_FALSE:
+        case Instruction::OpCode::JUMP_IF_TRUE:
+            if ( stack[top - 1].mBool == ( instruction.opCode == Instruction::OpCode::JUMP_IF_TRUE ) )
+            {
+                // The left operand decides the result of the logical operator
+                stack[top - 1].mDouble = 0;
+                pc = instruction.index;
+            }
+            continue;
+        case Instruction::OpCode::OPERATOR:
+        {
+            EvaluationValue right;
+            // Logical NOT operator does not have a right operand
+            if ( instruction.nodeType != ExpressionNodeType::OPERATOR_LOGICAL_NOT )
+            {
+                top--;
+                right = stack[top];
+            }
+            top--;
+            ret = applyOperator( instruction.nodeType, stack[top], right, value );
+            break;
+        }
+        case Instruction::OpCode::FAIL:
+            if ( instruction.error == ExpressionErrorCode::STACK_DEPTH_REACHED )
+            {
+                mLogger.warn( "CollectionInspectionEngine::runProgram", []() { return "STACK_DEPTH_REACHED or nullptr"; } );
+            }
+            return instruction.error;
+        default:
+            ret = evaluateLeaf( instruction, value );
+            break;
+        }
+        if ( ret != ExpressionErrorCode::SUCCESSFUL )
+        {
+            return ret;
+        }
+        stack[top] = value;
+        top++;
+    }
+    if ( top != 1 )
+    {
+        mLogger.warn( "CollectionInspectionEngine::runProgram", []() { return "STACK_DEPTH_REACHED or nullptr"; } );
+        return ExpressionErrorCode::STACK_DEPTH_REACHED;
+    }
+    result = stack[0];
+    return ExpressionErrorCode::SUCCESSFUL;
+}
+
+CollectionInspectionEngine::ExpressionErrorCode
+CollectionInspectionEngine::evaluateLeaf( const Instruction &instruction, EvaluationValue &value )
+{
+    switch ( instruction.opCode )
+    {
+    case Instruction::OpCode::PUSH_SIGNAL:
+        return getLatestSignalValue( instruction.index, value.mDouble );
+    case Instruction::OpCode::PUSH_WINDOW_FUNCTION:
+        return getSampleWindowFunction( instruction.windowFunction, instruction.index, value.mDouble );
+    case Instruction::OpCode::PUSH_GEOHASH:
+        return getGeohashFunctionNode( instruction, value.mBool );
+    case Instruction::OpCode::PUSH_GEOFENCE:
+        return getGeofenceFunctionNode( instruction, value.mBool );
+    case Instruction::OpCode::PUSH_RAW_FRAME_FIELD:
+        return getRawFrameField( instruction, value.mDouble );
+    case Instruction::OpCode::PUSH_THRESHOLD:
+    {
+        const auto &evaluationSignal = mEvaluationSignals[instruction.secondIndex];
+        if ( mSignalBuffers[evaluationSignal.mSignalIndex][evaluationSignal.mBufferIndex].mCounter == 0 )
+        {
+            // Not a single sample collected yet
+            return ExpressionErrorCode::SIGNAL_NOT_FOUND;
+        }
+        value.mBool = mThresholdLeafValues[instruction.index] != 0;
+        return ExpressionErrorCode::SUCCESSFUL;
+    }
+    case Instruction::OpCode::PUSH_SHARED:
+    {
+        auto &shared = mSharedExpressions[instruction.index];
+        if ( shared.mEvaluationPass != mEvaluationPass )
+        {
+            // Recursion limited by the expression depth as shared expressions only contain smaller ones
+            shared.mError = runProgram( mSharedPrograms,
+                                        shared.mProgramStart,
+                                        shared.mProgramStart + shared.mProgramLength,
+                                        shared.mResult );
+            shared.mEvaluationPass = mEvaluationPass;
+        }
+        value = shared.mResult;
+        return shared.mError;
+    }
+    default:
+        return ExpressionErrorCode::NOT_IMPLEMENTED_TYPE;
+    }
+}
+
+CollectionInspectionEngine::ExpressionErrorCode
+CollectionInspectionEngine::runCondition( const ConditionEvaluationState &state,
+                                          uint32_t conditionIndex,
+                                          EvaluationValue &result )
+{
+#ifdef FWE_FEATURE_CONDITION_JIT
+    auto function = mNativeConditionsEnabled && ( conditionIndex < mNativeConditions.size() )
+                        ? mNativeConditions[conditionIndex]
+                        : nullptr;
+    if ( function != nullptr )
+    {
+        std::array<ConditionJit::Slot, MAX_EQUATION_DEPTH + 1> stack;
+        auto ret = static_cast<ExpressionErrorCode>( function( this, stack.data() ) );
+        if ( ret == ExpressionErrorCode::SUCCESSFUL )
+        {
+            result.mDouble = stack[0].mDouble;
+            result.mBool = stack[0].mBool;
+        }
+        return ret;
+    }
+#else
+    static_cast<void>( conditionIndex );
+#endif // FWE_FEATURE_CONDITION_JIT
+    return runProgram( mPrograms, state.mProgramStart, state.mProgramStart + state.mProgramLength, result );
+}
+
+#ifdef FWE_FEATURE_CONDITION_JIT
+namespace
+{
+// Returns FAIL for the node types that are no operators
+ConditionJit::Operation::Type
+getNativeOperator( ExpressionNodeType nodeType )
+{
+    switch ( nodeType )
+    {
+    case ExpressionNodeType::OPERATOR_SMALLER:
+        return ConditionJit::Operation::Type::SMALLER;
+    case ExpressionNodeType::OPERATOR_BIGGER:
+        return ConditionJit::Operation::Type::BIGGER;
+    case ExpressionNodeType::OPERATOR_SMALLER_EQUAL:
+        return ConditionJit::Operation::Type::SMALLER_EQUAL;
+    case ExpressionNodeType::OPERATOR_BIGGER_EQUAL:
+        return ConditionJit::Operation::Type::BIGGER_EQUAL;
+    case ExpressionNodeType::OPERATOR_EQUAL:
+        return ConditionJit::Operation::Type::EQUAL;
+    case ExpressionNodeType::OPERATOR_LOGICAL_AND:
+        return ConditionJit::Operation::Type::AND;
+    case ExpressionNodeType::OPERATOR_LOGICAL_OR:
+        return ConditionJit::Operation::Type::OR;
+    case ExpressionNodeType::OPERATOR_LOGICAL_NOT:
+        return ConditionJit::Operation::Type::NOT;
+    case ExpressionNodeType::OPERATOR_ARITHMETIC_PLUS:
+        return ConditionJit::Operation::Type::PLUS;
+    case ExpressionNodeType::OPERATOR_ARITHMETIC_MINUS:
+        return ConditionJit::Operation::Type::MINUS;
+    case ExpressionNodeType::OPERATOR_ARITHMETIC_MULTIPLY:
+        return ConditionJit::Operation::Type::MULTIPLY;
+    case ExpressionNodeType::OPERATOR_ARITHMETIC_DIVIDE:
+        return ConditionJit::Operation::Type::DIVIDE;
+    default:
+        return ConditionJit::Operation::Type::FAIL;
+    }
+}
+} // namespace
+
+uint32_t
+CollectionInspectionEngine::evaluateNativeLeaf( void *context, const void *leaf, ConditionJit::Slot *slot )
+{
+    EvaluationValue value;
+    auto ret = static_cast<CollectionInspectionEngine *>( context )->evaluateLeaf(
+        *static_cast<const Instruction *>( leaf ), value );
+    slot->mDouble = value.mDouble;
+    slot->mBool = value.mBool;
+    return static_cast<uint32_t>( ret );
+}
+
+void
+CollectionInspectionEngine::compileNativeConditions()
+{
+    mNativeConditions.assign( mConditionStates.size(), nullptr );
+    if ( !ConditionJit::isSupported() )
+    {
+        return;
+    }
+    if ( !mConditionJit )
+    {
+        mConditionJit = std::make_unique<ConditionJit>( evaluateNativeLeaf, EVAL_EQUAL_DISTANCE() );
+    }
+    mConditionJit->clear();
+    std::vector<uint32_t> handles( mConditionStates.size(), ConditionJit::INVALID_HANDLE );
+    std::vector<ConditionJit::Operation> program;
+    for ( size_t i = 0; i < mConditionStates.size(); i++ )
+    {
+        const auto &state = mConditionStates[i];
+        program.clear();
+        bool supported = true;
+        for ( size_t pc = state.mProgramStart; supported && ( pc < state.mProgramStart + state.mProgramLength );
+              pc++ )
+        {
+            const auto &instruction = mPrograms[pc];
+            ConditionJit::Operation operation;
+            switch ( instruction.opCode )
+            {
+            case Instruction::OpCode::PUSH_CONSTANT:
+                operation.type = ConditionJit::Operation::Type::CONSTANT;
+                operation.value = instruction.value;
+                operation.boolValue = instruction.boolValue;
+                break;
+            case Instruction::OpCode::JUMP_IF_FALSE:
+            case Instruction::OpCode::JUMP_IF_TRUE:
+                operation.type = ( instruction.opCode == Instruction::OpCode::JUMP_IF_FALSE )
+                                     ? ConditionJit::Operation::Type::JUMP_IF_FALSE
+                                     : ConditionJit::Operation::Type::JUMP_IF_TRUE;
+                operation.target = instruction.index - state.mProgramStart;
+                break;
+            case Instruction::OpCode::OPERATOR:
+                operation.type = getNativeOperator( instruction.nodeType );
+                // The interpreter fails with NOT_IMPLEMENTED_TYPE after taking the operands from the stack
+                supported = operation.type != ConditionJit::Operation::Type::FAIL;
+                break;
+            case Instruction::OpCode::FAIL:
+                // The interpreter warns about too deep expressions on every evaluation
+                supported = instruction.error != ExpressionErrorCode::STACK_DEPTH_REACHED;
+                operation.type = ConditionJit::Operation::Type::FAIL;
+                operation.error = static_cast<uint32_t>( instruction.error );
+                break;
+            default:
+                // The instruction stays in mPrograms until the next inspection matrix
+                operation.type = ConditionJit::Operation::Type::LEAF;
+                operation.leaf = &instruction;
+                break;
+            }
+            program.push_back( operation );
+        }
+        if ( supported )
+        {
+            handles[i] = mConditionJit->add( program, MAX_EQUATION_DEPTH + 1 );
+        }
+    }
+    if ( mConditionJit->getCodeSize() == 0 )
+    {
+        return;
+    }
+    if ( !mConditionJit->finalize() )
+    {
+        mLogger.warn( "CollectionInspectionEngine::compileNativeConditions",
+                      "Failed to map the native code, the conditions are interpreted" );
+        return;
+    }
+    for ( size_t i = 0; i < handles.size(); i++ )
+    {
+        mNativeConditions[i] = mConditionJit->getFunction( handles[i] );
+    }
+    mLogger.info( "CollectionInspectionEngine::compileNativeConditions",
+                  "Compiled " + std::to_string( getNativeConditionCount() ) + " of " +
+                      std::to_string( mConditionStates.size() ) + " conditions to " +
+                      std::to_string( mConditionJit->getCodeSize() ) + " bytes of native code" );
+}
+
+size_t
+CollectionInspectionEngine::getNativeConditionCount() const
+{
+    return static_cast<size_t>( std::count_if( mNativeConditions.begin(),
+                                               mNativeConditions.end(),
+                                               []( ConditionJit::Function function ) {
+                                                   return function != nullptr;
+                                               } ) );
+}
+#endif // FWE_FEATURE_CONDITION_JIT
+
+CollectionInspectionEngine::ExpressionErrorCode
+CollectionInspectionEngine::applyOperator( ExpressionNodeType nodeType,
+                                           const EvaluationValue &left,
+                                           const EvaluationValue &right,
+                                           EvaluationValue &result )
+{
+    InspectionValue leftDouble = left.mDouble;
+    InspectionValue rightDouble = right.mDouble;
+    bool leftBool = left.mBool;
+    bool rightBool = right.mBool;
+    InspectionValue &resultValueDouble = result.mDouble;
+    bool &resultValueBool = result.mBool;
+    switch ( nodeType )
+    {
+    case ExpressionNodeType::OPERATOR_SMALLER:
+        resultValueBool = leftDouble < rightDouble;
+        return ExpressionErrorCode::SUCCESSFUL;
+    case ExpressionNodeType::OPERATOR_BIGGER:
+        resultValueBool = leftDouble > rightDouble;
+        return ExpressionErrorCode::SUCCESSFUL;
+    case ExpressionNodeType::OPERATOR_SMALLER_EQUAL:
+        resultValueBool = leftDouble <= rightDouble;
+        return ExpressionErrorCode::SUCCESSFUL;
+    case ExpressionNodeType::OPERATOR_BIGGER_EQUAL:
+        resultValueBool = leftDouble >= rightDouble;
+        return ExpressionErrorCode::SUCCESSFUL;
+    case ExpressionNodeType::OPERATOR_EQUAL:
+        resultValueBool = std::abs( leftDouble - rightDouble ) < EVAL_EQUAL_DISTANCE();
+        return ExpressionErrorCode::SUCCESSFUL;
+    case ExpressionNodeType::OPERATOR_LOGICAL_AND:
+        resultValueBool = leftBool && rightBool;
+        return ExpressionErrorCode::SUCCESSFUL;
+    case ExpressionNodeType::OPERATOR_LOGICAL_OR:
+        resultValueBool = leftBool || rightBool;
+        return ExpressionErrorCode::SUCCESSFUL;
+    case ExpressionNodeType::OPERATOR_LOGICAL_NOT:
+        resultValueBool = !leftBool;
+        return ExpressionErrorCode::SUCCESSFUL;
+    case ExpressionNodeType::OPERATOR_ARITHMETIC_PLUS:
+        resultValueDouble = leftDouble + rightDouble;
+        return ExpressionErrorCode::SUCCESSFUL;
+    case ExpressionNodeType::OPERATOR_ARITHMETIC_MINUS:
+        resultValueDouble = leftDouble - rightDouble;
+        return ExpressionErrorCode::SUCCESSFUL;
+    case ExpressionNodeType::OPERATOR_ARITHMETIC_MULTIPLY:
+        resultValueDouble = leftDouble * rightDouble;
+        return ExpressionErrorCode::SUCCESSFUL;
+    case ExpressionNodeType::OPERATOR_ARITHMETIC_DIVIDE:
+        resultValueDouble = leftDouble / rightDouble;
+        return ExpressionErrorCode::SUCCESSFUL;
+    default:
+        return ExpressionErrorCode::NOT_IMPLEMENTED_TYPE;
+    }
+}
+
+bool
+CollectionInspectionEngine::FixedTimeWindowFunctionData::updateWindow( InspectionTimestamp timestamp,
+                                                                       InspectionTimestamp &nextWindowFunctionTimesOut )
+{
+    if ( mLastTimeCalculated == 0 )
+    {
+        // First time a signal arrives start the window for this signal
+        mLastTimeCalculated = timestamp;
+        initNewWindow( timestamp, nextWindowFunctionTimesOut );
+    }
+    // check the last 2 windows as this class records the last and previous last data
+    else if ( timestamp >= mLastTimeCalculated + mWindowSizeMs * 2 )
+    {
+        finishAggregations();
+        // In the last window not a single sample arrived
+        mLastAvailable = false;
+        if ( mCollectedSignals == 0 )
+        {
+            mPreviousLastAvailable = false;
+        }
+        else
+        {
+            mPreviousLastAvailable = true;
+            mPreviousLastMin = mCollectingMin;
+            mPreviousLastMax = mCollectingMax;
+            mPreviousLastAvg = mCollectingSum / mCollectedSignals;
+        }
+        initNewWindow( timestamp, nextWindowFunctionTimesOut );
+    }
+    else if ( timestamp >= mLastTimeCalculated + mWindowSizeMs )
+    {
+        finishAggregations();
+        mPreviousLastMin = mLastMin;
+        mPreviousLastMax = mLastMax;
+        mPreviousLastAvg = mLastAvg;
+        mPreviousLastAvailable = mLastAvailable;
+        if ( mCollectedSignals == 0 )
+        {
+            mLastAvailable = false;
+        }
+        else
+        {
+            mLastAvailable = true;
+            mLastMin = mCollectingMin;
+            mLastMax = mCollectingMax;
+            mLastAvg = mCollectingSum / mCollectedSignals;
+        }
+        initNewWindow( timestamp, nextWindowFunctionTimesOut );
+    }
+    else
+    {
+        nextWindowFunctionTimesOut = std::min( nextWindowFunctionTimesOut, mLastTimeCalculated + mWindowSizeMs );
+        return false;
+    }
+    return true;
+}
+
+bool
+CollectionInspectionEngine::SlidingTimeWindowFunctionData::updateWindow(
+    InspectionTimestamp timestamp, InspectionTimestamp &nextWindowFunctionTimesOut )
+{
+    bool changed = false;
+    while ( ( !mSamples.empty() ) && ( mSamples.front().mTimestamp + mWindowSizeMs <= timestamp ) )
+    {
+        const auto &oldest = mSamples.front();
+        if ( ( !mMinCandidates.empty() ) && ( mMinCandidates.front().mTimestamp <= oldest.mTimestamp ) )
+        {
+            mMinCandidates.pop_front();
+        }
+        if ( ( !mMaxCandidates.empty() ) && ( mMaxCandidates.front().mTimestamp <= oldest.mTimestamp ) )
+        {
+            mMaxCandidates.pop_front();
+        }
+        mSum -= oldest.mValue;
+        mSumOfSquares -= oldest.mValue * oldest.mValue;
+        mSamples.pop_front();
+        changed = true;
+    }
+    if ( mSamples.empty() )
+    {
+        // Start again from exact zero so that rounding errors of the running sums do not add up
+        mSum = 0;
+        mSumOfSquares = 0;
+    }
+    else
+    {
+        nextWindowFunctionTimesOut =
+            std::min( nextWindowFunctionTimesOut, mSamples.front().mTimestamp + mWindowSizeMs );
+    }
+    return changed;
+}
+
+void
+CollectionInspectionEngine::SlidingTimeWindowFunctionData::addValue( InspectionValue value,
+                                                                     InspectionTimestamp timestamp,
+                                                                     InspectionTimestamp &nextWindowFunctionTimesOut )
+{
+    // The deques rely on ordered timestamps, a sample older than the newest one is treated as received with it
+    if ( ( !mSamples.empty() ) && ( timestamp < mSamples.back().mTimestamp ) )
+    {
+        timestamp = mSamples.back().mTimestamp;
+    }
+    updateWindow( timestamp, nextWindowFunctionTimesOut );
+    Sample sample;
+    sample.mTimestamp = timestamp;
+    sample.mValue = value;
+    // A candidate that is not smaller than the new sample can never become the minimum again
+    while ( ( !mMinCandidates.empty() ) && ( mMinCandidates.back().mValue >= value ) )
+    {
+        mMinCandidates.pop_back();
+    }
+    mMinCandidates.push_back( sample );
+    while ( ( !mMaxCandidates.empty() ) && ( mMaxCandidates.back().mValue <= value ) )
+    {
+        mMaxCandidates.pop_back();
+    }
+    mMaxCandidates.push_back( sample );
+    mSum += value;
+    mSumOfSquares += value * value;
+    mSamples.push_back( sample );
+    nextWindowFunctionTimesOut = std::min( nextWindowFunctionTimesOut, mSamples.front().mTimestamp + mWindowSizeMs );
+}
+
+bool
+CollectionInspectionEngine::SlidingTimeWindowFunctionData::getValue( WindowFunction function,
+                                                                     InspectionValue &result ) const
+{
+    if ( function == WindowFunction::SLIDING_WINDOW_COUNT )
+    {
+        result = static_cast<InspectionValue>( mSamples.size() );
+        return true;
+    }
+    if ( mSamples.empty() )
+    {
+        return false;
+    }
+    auto count = static_cast<InspectionValue>( mSamples.size() );
+    switch ( function )
+    {
+    case WindowFunction::SLIDING_WINDOW_MIN:
+        result = mMinCandidates.front().mValue;
+        return true;
+    case WindowFunction::SLIDING_WINDOW_MAX:
+        result = mMaxCandidates.front().mValue;
+        return true;
+    case WindowFunction::SLIDING_WINDOW_AVG:
+        result = mSum / count;
+        return true;
+    case WindowFunction::SLIDING_WINDOW_STDDEV:
+    {
+        auto avg = mSum / count;
+        // Rounding can make the variance of equal values slightly negative
+        result = std::sqrt( std::max( 0.0, ( mSumOfSquares / count ) - ( avg * avg ) ) );
+        return true;
+    }
+    case WindowFunction::SLIDING_WINDOW_RATE_OF_CHANGE:
+    {
+        const auto &oldest = mSamples.front();
+        const auto &newest = mSamples.back();
+        if ( newest.mTimestamp <= oldest.mTimestamp )
+        {
+            return false;
+        }
+        result = ( newest.mValue - oldest.mValue ) * 1000.0 /
+                 static_cast<InspectionValue>( newest.mTimestamp - oldest.mTimestamp );
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+EventID
+CollectionInspectionEngine::generateEventID( InspectionTimestamp timestamp )
+{
+    // Generate an eventId as a combination of an event counter and a timestamp
+    uint32_t eventId = static_cast<uint32_t>( ( generateEventCounter() & 0xFF ) | ( timestamp << 8 ) );
+    // As Kotlin reads eventId as int32, set most significant bit to 0 so event IDs stay positive
+    eventId = eventId & 0x7FFFFFFF;
+    return eventId;
+}
+
+namespace
+{
+// Fills a file sequentially with the values of a state file, the first failure is kept
+class StateFileWriter
+{
+public:
+    explicit StateFileWriter( FILE *file )
+        : mFile( file )
+    {
+    }
+
+    template <typename T>
+    void
+    write( const T &value )
+    {
+        static_assert( std::is_trivially_copyable<T>::value, "Only plain values can be written" );
+        writeBytes( &value, sizeof( T ) );
+    }
+
+    void
+    writeBytes( const void *data, size_t size )
+    {
+        mFailed = mFailed || ( ( size > 0 ) && ( fwrite( data, size, 1, mFile ) != 1 ) );
+    }
+
+    bool
+    failed() const
+    {
+        return mFailed;
+    }
+
+private:
+    FILE *mFile;
+    bool mFailed{ false };
+};
+
+// Reads the values of a mapped state file, every read is checked against the end of the file
+class StateFileReader
+{
+public:
+    StateFileReader( const uint8_t *data, size_t size )
+        : mData( data )
+        , mSize( size )
+    {
+    }
+
+    template <typename T>
+    bool
+    read( T &value )
+    {
+        static_assert( std::is_trivially_copyable<T>::value, "Only plain values can be read" );
+        auto *bytes = readBytes( sizeof( T ) );
+        if ( bytes == nullptr )
+        {
+            return false;
+        }
+        std::memcpy( &value, bytes, sizeof( T ) );
+        return true;
+    }
+
+    const uint8_t *
+    readBytes( size_t size )
+    {
+        if ( ( mSize - mOffset ) < size )
+        {
+            return nullptr;
+        }
+        auto *bytes = mData + mOffset;
+        mOffset += size;
+        return bytes;
+    }
+
+    bool
+    atEnd() const
+    {
+        return mOffset == mSize;
+    }
+
+    size_t
+    remaining() const
+    {
+        return mSize - mOffset;
+    }
+
+private:
+    const uint8_t *mData;
+    size_t mSize;
+    size_t mOffset{ 0 };
+};
+
+// FNV-1a, stable across builds and restarts unlike std::hash
+void
+addToFingerprint( uint64_t &hash, const void *data, size_t size )
+{
+    const auto *bytes = static_cast<const uint8_t *>( data );
+    for ( size_t i = 0; i < size; i++ )
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001B3ULL;
+    }
+}
+
+template <typename T>
+void
+addToFingerprint( uint64_t &hash, const T &value )
+{
+    addToFingerprint( hash, &value, sizeof( T ) );
+}
+} // namespace
+
+uint64_t
+CollectionInspectionEngine::getInspectionMatrixFingerprint( const InspectionMatrix &matrix )
+{
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    addToFingerprint( hash, static_cast<uint64_t>( matrix.conditions.size() ) );
+    for ( const auto &condition : matrix.conditions )
+    {
+        const auto &schemeID = condition.metaData.collectionSchemeID;
+        addToFingerprint( hash, static_cast<uint64_t>( schemeID.size() ) );
+        addToFingerprint( hash, schemeID.data(), schemeID.size() );
+        addToFingerprint( hash, condition.minimumPublishInterval );
+        addToFingerprint( hash, condition.afterDuration );
+        addToFingerprint( hash, condition.triggerOnlyOnRisingEdge );
+        addToFingerprint( hash, static_cast<uint64_t>( condition.signals.size() ) );
+        for ( const auto &signal : condition.signals )
+        {
+            addToFingerprint( hash, signal.signalID );
+            addToFingerprint( hash, signal.sampleBufferSize );
+            addToFingerprint( hash, signal.minimumSampleIntervalMs );
+            addToFingerprint( hash, signal.fixedWindowPeriod );
+            addToFingerprint( hash, signal.isConditionOnlySignal );
+            addToFingerprint( hash, signal.deepHistory );
+            addToFingerprint( hash, signal.aggregation != nullptr );
+        }
+        addToFingerprint( hash, static_cast<uint64_t>( condition.canFrames.size() ) );
+        for ( const auto &canFrame : condition.canFrames )
+        {
+            addToFingerprint( hash, canFrame.frameID );
+            addToFingerprint( hash, canFrame.channelID );
+            addToFingerprint( hash, canFrame.sampleBufferSize );
+            addToFingerprint( hash, canFrame.minimumSampleIntervalMs );
+            addToFingerprint( hash, canFrame.isConditionOnlyFrame );
+        }
+    }
+    return hash;
+}
+
+bool
+CollectionInspectionEngine::saveState( const std::string &path )
+{
+    if ( !mActiveInspectionMatrix )
+    {
+        return false;
+    }
+    auto temporaryPath = path + ".tmp";
+    FILE *file = fopen( temporaryPath.c_str(), "wb" );
+    if ( file == nullptr )
+    {
+        mLogger.error( "CollectionInspectionEngine::saveState",
+                       "Failed to create " + temporaryPath + ": " + std::string( strerror( errno ) ) );
+        return false;
+    }
+    StateFileWriter writer( file );
+    writer.write( STATE_FILE_MAGIC );
+    writer.write( STATE_FILE_VERSION );
+    writer.write( mInspectionMatrixFingerprint );
+    writer.write( static_cast<uint32_t>( mConditions.size() ) );
+    for ( uint32_t conditionIndex = 0; conditionIndex < mConditions.size(); conditionIndex++ )
+    {
+        writer.write( mConditionStates[conditionIndex].mLastTrigger );
+        writer.write( mConditions[conditionIndex].mLastDataTimestampPublished );
+        writer.write( static_cast<uint8_t>( mConditionsWithConditionCurrentlyTrue.test( conditionIndex ) ) );
+    }
+    writer.write( static_cast<uint32_t>( mPeriodicGroups.size() ) );
+    for ( const auto &group : mPeriodicGroups )
+    {
+        writer.write( group.mNextTick );
+    }
+    writer.write( static_cast<uint32_t>( mSignalBuffers.size() ) );
+    for ( const auto &bufferVector : mSignalBuffers )
+    {
+        writer.write( static_cast<uint32_t>( bufferVector.size() ) );
+        for ( const auto &buf : bufferVector )
+        {
+            // The samples in memory of a deep history buffer continue the samples on flash, which are not kept
+            bool keepSamples = buf.isAllocated() && ( buf.mCounter > 0 ) && ( buf.mDeepHistorySize == 0 );
+            // A view is saved with the samples in chunks of its own, it is restored as a buffer with chunks
+            SignalHistoryBuffer materialized;
+            const auto *samples = &buf;
+            if ( keepSamples && buf.isView() )
+            {
+                materialized.mSize = buf.mSize;
+                materialized.mCurrentPosition = buf.mCurrentPosition;
+                materialized.mCounter = buf.mCounter;
+                materialized.mBaseCounters = buf.mBaseCounters;
+                materializeSignalView( materialized, bufferVector[buf.mBaseBufferIndex] );
+                samples = &materialized;
+            }
+            writer.write( buf.mSize );
+            writer.write( buf.mMinimumSampleIntervalMs );
+            writer.write( keepSamples ? buf.mCounter : 0U );
+            writer.write( keepSamples ? buf.mCurrentPosition : ( buf.mSize - 1 ) );
+            writer.write( samples->mTimestampEpoch );
+            writer.write( buf.mLastSampleUs );
+            writer.write( static_cast<uint32_t>( keepSamples ? samples->mChunks.size() : 0 ) );
+            if ( keepSamples )
+            {
+                for ( const auto &chunk : samples->mChunks )
+                {
+                    writer.write( *chunk );
+                }
+            }
+            writer.write( static_cast<uint32_t>( keepSamples ? buf.mConsumedUntil.size() : 0 ) );
+            if ( keepSamples )
+            {
+                for ( const auto &consumedUntil : buf.mConsumedUntil )
+                {
+                    writer.write( consumedUntil );
+                }
+            }
+            writer.write( static_cast<uint32_t>( buf.mWindowFunctionData.size() ) );
+            for ( const auto &window : buf.mWindowFunctionData )
+            {
+                writer.write( window.mWindowSizeMs );
+                writer.write( window.mLastTimeCalculated );
+                writer.write( window.mLastMin );
+                writer.write( window.mLastMax );
+                writer.write( window.mLastAvg );
+                writer.write( window.mLastAvailable );
+                writer.write( window.mPreviousLastMin );
+                writer.write( window.mPreviousLastMax );
+                writer.write( window.mPreviousLastAvg );
+                writer.write( window.mPreviousLastAvailable );
+                writer.write( window.mCollectingMin );
+                writer.write( window.mCollectingMax );
+                writer.write( window.mCollectingSum );
+                writer.write( window.mCollectedSignals );
+            }
+        }
+    }
+    writer.write( static_cast<uint32_t>( mCanFrameBuffers.size() ) );
+    for ( const auto &buf : mCanFrameBuffers )
+    {
+        bool keepFrames = ( buf.mSize > 0 ) && ( buf.mBuffer.size() == buf.mSize ) && ( buf.mCounter > 0 );
+        writer.write( buf.mFrameID );
+        writer.write( buf.mChannelID );
+        writer.write( buf.mSize );
+        writer.write( buf.mMinimumSampleIntervalMs );
+        writer.write( buf.mFrameCapacity );
+        writer.write( keepFrames ? buf.mCounter : 0U );
+        writer.write( keepFrames ? buf.mCurrentPosition : ( buf.mSize - 1 ) );
+        writer.write( buf.mLastSampleUs );
+        writer.write( static_cast<uint8_t>( keepFrames ) );
+        if ( keepFrames )
+        {
+            writer.writeBytes( buf.mBuffer.data(), buf.mBuffer.size() * sizeof( CanFrameSample ) );
+            writer.writeBytes( buf.mPayload.data(), buf.mPayload.size() );
+            writer.write( static_cast<uint32_t>( buf.mConsumedUntil.size() ) );
+            for ( const auto &consumedUntil : buf.mConsumedUntil )
+            {
+                writer.write( consumedUntil );
+            }
+        }
+    }
+    // Written to flash before the rename, so a crash leaves either the old or the new complete file
+    bool failed = writer.failed() || ( fflush( file ) != 0 ) || ( fsync( fileno( file ) ) != 0 );
+    failed = ( fclose( file ) != 0 ) || failed;
+    if ( failed || ( rename( temporaryPath.c_str(), path.c_str() ) != 0 ) )
+    {
+        mLogger.error( "CollectionInspectionEngine::saveState",
+                       "Failed to write " + path + ": " + std::string( strerror( errno ) ) );
+        (void)unlink( temporaryPath.c_str() );
+        return false;
+    }
+    mLogger.info( "CollectionInspectionEngine::saveState",
+                  "Saved the state of " + std::to_string( mConditions.size() ) + " conditions to " + path );
+    return true;
+}
+
+bool
+CollectionInspectionEngine::restoreState( const std::string &path )
+{
+    if ( !mActiveInspectionMatrix )
+    {
+        return false;
+    }
+    int fd = open( path.c_str(), O_RDONLY | O_CLOEXEC );
+    if ( fd < 0 )
+    {
+        return false;
+    }
+    struct stat fileStatus = {};
+    if ( ( fstat( fd, &fileStatus ) != 0 ) || ( fileStatus.st_size <= 0 ) )
+    {
+        ::close( fd );
+        return false;
+    }
+    auto size = static_cast<size_t>( fileStatus.st_size );
+    auto *mapping = mmap( nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0 );
+    ::close( fd );
+    if ( mapping == MAP_FAILED )
+    {
+        mLogger.error( "CollectionInspectionEngine::restoreState", "Failed to map " + path );
+        return false;
+    }
+    (void)madvise( mapping, size, MADV_SEQUENTIAL );
+    const auto *data = static_cast<const uint8_t *>( mapping );
+    // Only a file that fits as a whole is applied, so the state is never partially restored
+    bool restored = readState( data, size, false ) && readState( data, size, true );
+    munmap( mapping, size );
+    if ( !restored )
+    {
+        mLogger.info( "CollectionInspectionEngine::restoreState",
+                      "The state in " + path + " does not fit the active inspection matrix" );
+        return false;
+    }
+    mLogger.info( "CollectionInspectionEngine::restoreState",
+                  "Restored the state of " + std::to_string( mConditions.size() ) + " conditions from " + path );
+    return true;
+}
+
+bool
+CollectionInspectionEngine::readState( const uint8_t *data, size_t size, bool apply )
+{
+    StateFileReader reader( data, size );
+    // Checked before the vector is allocated, so that a corrupt count does not request billions of entries
+    auto isConsumedUntilCountValid = [this, &reader]( uint32_t consumedUntilCount ) {
+        return ( consumedUntilCount <= mConditions.size() ) &&
+               ( ( static_cast<size_t>( consumedUntilCount ) * sizeof( ConsumedUntil ) ) <= reader.remaining() );
+    };
+    uint32_t magic = 0;
+    uint32_t version = 0;
+    uint64_t fingerprint = 0;
+    uint32_t count = 0;
+    if ( ( !reader.read( magic ) ) || ( magic != STATE_FILE_MAGIC ) || ( !reader.read( version ) ) ||
+         ( version != STATE_FILE_VERSION ) || ( !reader.read( fingerprint ) ) ||
+         ( fingerprint != mInspectionMatrixFingerprint ) || ( !reader.read( count ) ) ||
+         ( count != mConditions.size() ) )
+    {
+        return false;
+    }
+    for ( uint32_t conditionIndex = 0; conditionIndex < count; conditionIndex++ )
+    {
+        InspectionTimestamp lastTrigger = 0;
+        InspectionTimestamp lastDataTimestampPublished = 0;
+        uint8_t currentlyTrue = 0;
+        if ( ( !reader.read( lastTrigger ) ) || ( !reader.read( lastDataTimestampPublished ) ) ||
+             ( !reader.read( currentlyTrue ) ) )
+        {
+            return false;
+        }
+        if ( apply )
+        {
+            mConditionStates[conditionIndex].mLastTrigger = lastTrigger;
+            mConditions[conditionIndex].mLastDataTimestampPublished = lastDataTimestampPublished;
+            if ( currentlyTrue == 0 )
+            {
+                mConditionsWithConditionCurrentlyTrue.reset( conditionIndex );
+            }
+        }
+    }
+    if ( ( !reader.read( count ) ) || ( count != mPeriodicGroups.size() ) )
+    {
+        return false;
+    }
+    for ( auto &group : mPeriodicGroups )
+    {
+        InspectionTimestamp nextTick = 0;
+        if ( !reader.read( nextTick ) )
+        {
+            return false;
+        }
+        if ( apply )
+        {
+            group.mNextTick = nextTick;
+        }
+    }
+    if ( ( !reader.read( count ) ) || ( count != mSignalBuffers.size() ) )
+    {
+        return false;
+    }
+    for ( auto &bufferVector : mSignalBuffers )
+    {
+        if ( ( !reader.read( count ) ) || ( count != bufferVector.size() ) )
+        {
+            return false;
+        }
+        for ( auto &buf : bufferVector )
+        {
+            uint32_t bufferSize = 0;
+            uint32_t sampleInterval = 0;
+            uint32_t counter = 0;
+            uint32_t currentPosition = 0;
+            InspectionTimestamp timestampEpoch = 0;
+            uint64_t lastSampleUs = 0;
+            uint32_t chunkCount = 0;
+            if ( ( !reader.read( bufferSize ) ) || ( bufferSize != buf.mSize ) || ( !reader.read( sampleInterval ) ) ||
+                 ( sampleInterval != buf.mMinimumSampleIntervalMs ) || ( !reader.read( counter ) ) ||
+                 ( !reader.read( currentPosition ) ) || ( currentPosition >= buf.mSize ) ||
+                 ( !reader.read( timestampEpoch ) ) || ( !reader.read( lastSampleUs ) ) ||
+                 ( !reader.read( chunkCount ) ) )
+            {
+                return false;
+            }
+            auto neededChunks = ( buf.mSize + SignalSampleChunk::SIZE - 1 ) / SignalSampleChunk::SIZE;
+            if ( ( chunkCount != 0 ) && ( ( chunkCount != neededChunks ) || ( counter == 0 ) ) )
+            {
+                return false;
+            }
+            const auto *chunks = reader.readBytes( static_cast<size_t>( chunkCount ) * sizeof( SignalSampleChunk ) );
+            if ( ( chunks == nullptr ) || ( !reader.read( count ) ) || ( !isConsumedUntilCountValid( count ) ) )
+            {
+                return false;
+            }
+            ConsumedUntilVector consumedUntil( count );
+            for ( auto &entry : consumedUntil )
+            {
+                if ( ( !reader.read( entry ) ) || ( entry.mConditionId >= mConditions.size() ) )
+                {
+                    return false;
+                }
+            }
+            if ( apply && ( chunkCount > 0 ) )
+            {
+                if ( buf.isView() )
+                {
+                    buf.mBaseBufferIndex = INVALID_SIGNAL_INDEX;
+                    buf.mBaseCounters = std::vector<uint32_t>();
+                }
+                buf.allocate();
+                for ( uint32_t chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++ )
+                {
+                    std::memcpy( &buf.getWritableChunk( chunkIndex * SignalSampleChunk::SIZE ),
+                                 chunks + ( static_cast<size_t>( chunkIndex ) * sizeof( SignalSampleChunk ) ),
+                                 sizeof( SignalSampleChunk ) );
+                }
+                buf.mCounter = counter;
+                buf.mCurrentPosition = currentPosition;
+                buf.mTimestampEpoch = timestampEpoch;
+                buf.mConsumedUntil = std::move( consumedUntil );
+            }
+            if ( apply )
+            {
+                buf.mLastSampleUs = lastSampleUs;
+            }
+            if ( ( !reader.read( count ) ) || ( count != buf.mWindowFunctionData.size() ) )
+            {
+                return false;
+            }
+            for ( auto &window : buf.mWindowFunctionData )
+            {
+                FixedTimeWindowFunctionData saved( 0 );
+                if ( ( !reader.read( saved.mWindowSizeMs ) ) || ( saved.mWindowSizeMs != window.mWindowSizeMs ) ||
+                     ( !reader.read( saved.mLastTimeCalculated ) ) || ( !reader.read( saved.mLastMin ) ) ||
+                     ( !reader.read( saved.mLastMax ) ) || ( !reader.read( saved.mLastAvg ) ) ||
+                     ( !reader.read( saved.mLastAvailable ) ) || ( !reader.read( saved.mPreviousLastMin ) ) ||
+                     ( !reader.read( saved.mPreviousLastMax ) ) || ( !reader.read( saved.mPreviousLastAvg ) ) ||
+                     ( !reader.read( saved.mPreviousLastAvailable ) ) || ( !reader.read( saved.mCollectingMin ) ) ||
+                     ( !reader.read( saved.mCollectingMax ) ) || ( !reader.read( saved.mCollectingSum ) ) ||
+                     ( !reader.read( saved.mCollectedSignals ) ) )
+                {
+                    return false;
+                }
+                if ( apply )
+                {
+                    saved.mAggregators = std::move( window.mAggregators );
+                    window = std::move( saved );
+                    // The samples of the current window before the restart were not aggregated
+                    for ( auto &aggregator : window.mAggregators )
+                    {
+                        if ( window.mLastTimeCalculated != 0 )
+                        {
+                            aggregator.skipCurrentWindow();
+                        }
+                    }
+                }
+            }
+            if ( apply && ( !buf.mThresholds.empty() ) && ( buf.mCounter > 0 ) )
+            {
+                updateThresholdLeaves( buf, getNewestValue( bufferVector, buf ) );
+            }
+        }
+    }
+    if ( ( !reader.read( count ) ) || ( count != mCanFrameBuffers.size() ) )
+    {
+        return false;
+    }
+    for ( auto &buf : mCanFrameBuffers )
+    {
+        CANRawFrameID frameID = 0;
+        CANChannelNumericID channelID = 0;
+        uint32_t bufferSize = 0;
+        uint32_t sampleInterval = 0;
+        uint8_t frameCapacity = 0;
+        uint32_t counter = 0;
+        uint32_t currentPosition = 0;
+        uint64_t lastSampleUs = 0;
+        uint8_t keepFrames = 0;
+        if ( ( !reader.read( frameID ) ) || ( frameID != buf.mFrameID ) || ( !reader.read( channelID ) ) ||
+             ( channelID != buf.mChannelID ) || ( !reader.read( bufferSize ) ) || ( bufferSize != buf.mSize ) ||
+             ( !reader.read( sampleInterval ) ) || ( sampleInterval != buf.mMinimumSampleIntervalMs ) ||
+             ( !reader.read( frameCapacity ) ) ||
+             ( ( frameCapacity != MAX_CAN_FRAME_BYTE_SIZE ) && ( frameCapacity != MAX_CANFD_FRAME_BYTE_SIZE ) ) ||
+             ( !reader.read( counter ) ) || ( !reader.read( currentPosition ) ) ||
+             ( currentPosition >= buf.mSize ) || ( !reader.read( lastSampleUs ) ) || ( !reader.read( keepFrames ) ) )
+        {
+            return false;
+        }
+        if ( keepFrames == 0 )
+        {
+            if ( apply )
+            {
+                buf.mLastSampleUs = lastSampleUs;
+            }
+            continue;
+        }
+        const auto *frames = reader.readBytes( static_cast<size_t>( buf.mSize ) * sizeof( CanFrameSample ) );
+        const auto *payload = reader.readBytes( static_cast<size_t>( buf.mSize ) * frameCapacity );
+        if ( ( frames == nullptr ) || ( payload == nullptr ) || ( !reader.read( count ) ) ||
+             ( !isConsumedUntilCountValid( count ) ) )
+        {
+            return false;
+        }
+        ConsumedUntilVector consumedUntil( count );
+        for ( auto &entry : consumedUntil )
+        {
+            if ( ( !reader.read( entry ) ) || ( entry.mConditionId >= mConditions.size() ) )
+            {
+                return false;
+            }
+        }
+        for ( uint32_t position = 0; ( !apply ) && ( position < buf.mSize ); position++ )
+        {
+            CanFrameSample frame;
+            std::memcpy(
+                &frame, frames + ( static_cast<size_t>( position ) * sizeof( CanFrameSample ) ), sizeof( frame ) );
+            if ( frame.mSize > frameCapacity )
+            {
+                return false;
+            }
+        }
+        if ( apply )
+        {
+            buf.mBuffer.resize( buf.mSize );
+            std::memcpy( buf.mBuffer.data(), frames, buf.mBuffer.size() * sizeof( CanFrameSample ) );
+            buf.mFrameCapacity = frameCapacity;
+            buf.mPayload.assign( payload, payload + ( static_cast<size_t>( buf.mSize ) * frameCapacity ) );
+            buf.mCounter = counter;
+            buf.mCurrentPosition = currentPosition;
+            buf.mLastSampleUs = lastSampleUs;
+            buf.mConsumedUntil = std::move( consumedUntil );
+        }
+    }
+    return reader.atEnd();
 }
 
 } // namespace DataInspection
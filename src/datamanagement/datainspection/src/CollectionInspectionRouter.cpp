@@ -0,0 +1,657 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+
+#include "CollectionInspectionRouter.h"
+#include "ConditionBitset.h"
+#include "FastClock.h"
+#include "TraceModule.h"
+#include <unordered_set>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataInspection
+{
+
+bool
+CollectionInspectionRouter::init( const std::shared_ptr<SignalBuffer> &inputSignalBufferIn,
+                                  const std::shared_ptr<CANBuffer> &inputCANBufferIn,
+                                  const std::shared_ptr<ActiveDTCBuffer> &inputActiveDTCBuffer,
+                                  const std::shared_ptr<CollectedDataReadyToPublish> &outputCollectedDataIn,
+                                  uint32_t idleTimeMs,
+                                  bool dataReductionProbabilityDisabled,
+                                  size_t partitionCount,
+                                  size_t partitionQueueSize )
+{
+    if ( ( partitionCount == 0 ) || ( partitionCount > MAX_PARTITIONS ) || ( partitionQueueSize == 0 ) )
+    {
+        fLogger.error( "CollectionInspectionRouter::init",
+                       "Invalid number of partitions " + std::to_string( partitionCount ) + " or queue size " +
+                           std::to_string( partitionQueueSize ) );
+        return false;
+    }
+    if ( fRunToCompletionWakeup && ( partitionCount != 1 ) )
+    {
+        fLogger.error( "CollectionInspectionRouter::init", "The run to completion mode needs a single partition" );
+        return false;
+    }
+    fInputSignalBuffer = inputSignalBufferIn;
+    fInputCANBuffer = inputCANBufferIn;
+    fInputActiveDTCBuffer = inputActiveDTCBuffer;
+    fOutputCollectedData = outputCollectedDataIn;
+    if ( idleTimeMs != 0 )
+    {
+        fIdleTimeMs = idleTimeMs;
+    }
+    fPartitions.clear();
+    fPartitions.resize( partitionCount );
+    for ( size_t partitionIndex = 0; partitionIndex < partitionCount; partitionIndex++ )
+    {
+        auto &partition = fPartitions[partitionIndex];
+        if ( partitionCount == 1 )
+        {
+            // The single worker consumes the input queues directly
+            partition.mSignalBuffer = fInputSignalBuffer;
+            partition.mCANBuffer = fInputCANBuffer;
+            partition.mActiveDTCBuffer = fInputActiveDTCBuffer;
+            partition.mCollectedData = fOutputCollectedData;
+        }
+        else
+        {
+            partition.mSignalBuffer = std::make_shared<SignalBuffer>( partitionQueueSize );
+            partition.mCANBuffer = std::make_shared<CANBuffer>( partitionQueueSize );
+            partition.mActiveDTCBuffer = std::make_shared<ActiveDTCBuffer>( partitionQueueSize );
+            partition.mCollectedData = std::make_shared<CollectedDataReadyToPublish>( partitionQueueSize );
+        }
+        partition.mWorker.reset( new CollectionInspectionWorkerThread() );
+        partition.mWorker->setWaitStrategy( fSpinCount, fYieldCount );
+        partition.mWorker->setSignalSnapshotsEnabled( fSignalSnapshotsEnabled );
+        partition.mWorker->setSharedPayloadsEnabled( fSharedPayloadsEnabled );
+        partition.mWorker->setDeviceJitter( fDeviceJitter );
+        partition.mWorker->setStreamingCollectionEnabled( fStreamingCollectionEnabled );
+        partition.mWorker->setSampleMemoryBudget( fSampleMemoryBudget / partitionCount );
+        partition.mWorker->setDeepHistoryDirectory( fDeepHistoryDirectory );
+        partition.mWorker->setDeepHistoryCompressionEnabled( fDeepHistoryCompressionEnabled );
+        partition.mWorker->setStateFile( getStateFile( partitionIndex ) );
+        partition.mWorker->setMinimumEvaluationSpacing( fMinimumEvaluationSpacingMs );
+        partition.mWorker->setConditionProfiling( fConditionProfilingReportIntervalMs, fHotConditionCount );
+        partition.mWorker->setExpressOutput( fExpressCollectedData );
+        partition.mWorker->setRunToCompletion( fRunToCompletionWakeup );
+        if ( ( !partition.mWorker->init( partition.mSignalBuffer,
+                                         partition.mCANBuffer,
+                                         partition.mActiveDTCBuffer,
+                                         partition.mCollectedData,
+                                         idleTimeMs,
+                                         dataReductionProbabilityDisabled ) ) ||
+             ( !partition.mWorker->subscribeListener( this ) ) )
+        {
+            fLogger.error( "CollectionInspectionRouter::init", "Failed to init the inspection worker" );
+            return false;
+        }
+    }
+    return true;
+}
+
+void
+CollectionInspectionRouter::setWaitStrategy( uint32_t spinCount, uint32_t yieldCount )
+{
+    fSpinCount = spinCount;
+    fYieldCount = yieldCount;
+    fWait->setWaitStrategy( spinCount, yieldCount );
+    for ( auto &partition : fPartitions )
+    {
+        partition.mWorker->setWaitStrategy( spinCount, yieldCount );
+    }
+}
+
+void
+CollectionInspectionRouter::setSignalSnapshotsEnabled( bool enabled )
+{
+    fSignalSnapshotsEnabled = enabled;
+    for ( auto &partition : fPartitions )
+    {
+        partition.mWorker->setSignalSnapshotsEnabled( enabled );
+    }
+}
+
+void
+CollectionInspectionRouter::setSharedPayloadsEnabled( bool enabled )
+{
+    fSharedPayloadsEnabled = enabled;
+    for ( auto &partition : fPartitions )
+    {
+        partition.mWorker->setSharedPayloadsEnabled( enabled );
+    }
+}
+
+void
+CollectionInspectionRouter::setDeviceJitter( const Platform::Linux::DeviceJitter &jitter )
+{
+    fDeviceJitter = jitter;
+    for ( auto &partition : fPartitions )
+    {
+        partition.mWorker->setDeviceJitter( jitter );
+    }
+}
+
+void
+CollectionInspectionRouter::setStreamingCollectionEnabled( bool enabled )
+{
+    fStreamingCollectionEnabled = enabled;
+    for ( auto &partition : fPartitions )
+    {
+        partition.mWorker->setStreamingCollectionEnabled( enabled );
+    }
+}
+
+void
+CollectionInspectionRouter::setSampleMemoryBudget( size_t bytes )
+{
+    fSampleMemoryBudget = bytes;
+    for ( auto &partition : fPartitions )
+    {
+        partition.mWorker->setSampleMemoryBudget( bytes / fPartitions.size() );
+    }
+}
+
+void
+CollectionInspectionRouter::setDeepHistoryDirectory( const std::string &directory )
+{
+    fDeepHistoryDirectory = directory;
+    for ( auto &partition : fPartitions )
+    {
+        partition.mWorker->setDeepHistoryDirectory( directory );
+    }
+}
+
+void
+CollectionInspectionRouter::setDeepHistoryCompressionEnabled( bool enabled )
+{
+    fDeepHistoryCompressionEnabled = enabled;
+    for ( auto &partition : fPartitions )
+    {
+        partition.mWorker->setDeepHistoryCompressionEnabled( enabled );
+    }
+}
+
+void
+CollectionInspectionRouter::setStateDirectory( const std::string &directory )
+{
+    fStateDirectory = directory;
+    for ( size_t partitionIndex = 0; partitionIndex < fPartitions.size(); partitionIndex++ )
+    {
+        fPartitions[partitionIndex].mWorker->setStateFile( getStateFile( partitionIndex ) );
+    }
+}
+
+std::string
+CollectionInspectionRouter::getStateFile( size_t partitionIndex ) const
+{
+    if ( fStateDirectory.empty() )
+    {
+        return std::string();
+    }
+    return fStateDirectory + "/inspection-state-" + std::to_string( partitionIndex );
+}
+
+void
+CollectionInspectionRouter::setMinimumEvaluationSpacing( uint32_t minimumSpacingMs )
+{
+    fMinimumEvaluationSpacingMs = minimumSpacingMs;
+    for ( auto &partition : fPartitions )
+    {
+        partition.mWorker->setMinimumEvaluationSpacing( minimumSpacingMs );
+    }
+}
+
+void
+CollectionInspectionRouter::setConditionProfiling( uint32_t reportIntervalMs, uint32_t hotConditionCount )
+{
+    fConditionProfilingReportIntervalMs = reportIntervalMs;
+    fHotConditionCount = hotConditionCount;
+    for ( auto &partition : fPartitions )
+    {
+        partition.mWorker->setConditionProfiling( reportIntervalMs, hotConditionCount );
+    }
+}
+
+std::shared_ptr<Platform::Linux::Signal>
+CollectionInspectionRouter::getDataAvailableSignal()
+{
+    if ( fPartitions.size() == 1 )
+    {
+        return fPartitions[0].mWorker->getDataAvailableSignal();
+    }
+    return fWait;
+}
+
+bool
+CollectionInspectionRouter::start()
+{
+    if ( fPartitions.empty() || fInputSignalBuffer == nullptr || fInputCANBuffer == nullptr ||
+         fInputActiveDTCBuffer == nullptr || fOutputCollectedData == nullptr )
+    {
+        fLogger.error( "CollectionInspectionRouter::start",
+                       " Inspection router cannot be started without correct configurations " );
+        return false;
+    }
+    for ( auto &partition : fPartitions )
+    {
+        if ( !partition.mWorker->start() )
+        {
+            return false;
+        }
+    }
+    if ( fPartitions.size() == 1 )
+    {
+        return true;
+    }
+    // Prevent concurrent stop/init
+    std::lock_guard<std::mutex> lock( fThreadMutex );
+    // On multi core systems the shared variable fShouldStop must be updated for
+    // all cores before starting the thread otherwise thread will directly end
+    fShouldStop.store( false );
+    if ( !fThread.create( doWork, this, "fwDIInsRouter" ) )
+    {
+        fLogger.trace( "CollectionInspectionRouter::start", " Router Thread failed to start " );
+    }
+    else
+    {
+        fLogger.trace( "CollectionInspectionRouter::start",
+                       " Router Thread started for " + std::to_string( fPartitions.size() ) + " partitions" );
+    }
+
+    return fThread.isActive() && fThread.isValid();
+}
+
+bool
+CollectionInspectionRouter::stop()
+{
+    bool stopped = true;
+    if ( fThread.isValid() && fThread.isActive() )
+    {
+        std::lock_guard<std::mutex> lock( fThreadMutex );
+        fShouldStop.store( true, std::memory_order_relaxed );
+        fLogger.trace( "CollectionInspectionRouter::stop", " Request stop " );
+        fWait->notify();
+        fThread.release();
+        fLogger.trace( "CollectionInspectionRouter::stop", " Stop finished " );
+        fShouldStop.store( false, std::memory_order_relaxed );
+        stopped = !fThread.isActive();
+    }
+    for ( auto &partition : fPartitions )
+    {
+        stopped = partition.mWorker->stop() && stopped;
+    }
+    return stopped;
+}
+
+bool
+CollectionInspectionRouter::shouldStop() const
+{
+    return fShouldStop.load( std::memory_order_relaxed );
+}
+
+bool
+CollectionInspectionRouter::isAlive()
+{
+    for ( auto &partition : fPartitions )
+    {
+        if ( !partition.mWorker->isAlive() )
+        {
+            return false;
+        }
+    }
+    return ( !fPartitions.empty() ) && ( ( fPartitions.size() == 1 ) || ( fThread.isValid() && fThread.isActive() ) );
+}
+
+bool
+CollectionInspectionRouter::subscribeToEvents( InspectionEventListener *listener )
+{
+    bool subscribed = !fPartitions.empty();
+    for ( auto &partition : fPartitions )
+    {
+        subscribed = partition.mWorker->subscribeToEvents( listener ) && subscribed;
+    }
+    return subscribed;
+}
+
+bool
+CollectionInspectionRouter::unSubscribeFromEvents( InspectionEventListener *listener )
+{
+    bool unsubscribed = !fPartitions.empty();
+    for ( auto &partition : fPartitions )
+    {
+        unsubscribed = partition.mWorker->unSubscribeFromEvents( listener ) && unsubscribed;
+    }
+    return unsubscribed;
+}
+
+std::vector<std::shared_ptr<const InspectionMatrix>>
+CollectionInspectionRouter::partitionInspectionMatrix( const std::shared_ptr<const InspectionMatrix> &matrix,
+                                                       size_t partitionCount )
+{
+    std::vector<std::shared_ptr<const InspectionMatrix>> result( partitionCount );
+    if ( ( matrix == nullptr ) || ( partitionCount == 0 ) )
+    {
+        return result;
+    }
+    std::vector<std::shared_ptr<InspectionMatrix>> partitions;
+    // The conditions of the partitions point to the expression nodes of the original matrix
+    for ( size_t i = 0; i < partitionCount; i++ )
+    {
+        partitions.emplace_back( new InspectionMatrix(), [matrix]( InspectionMatrix *partition ) {
+            delete partition;
+        } );
+    }
+    // No partition gets more than its share of conditions, even if all conditions use the same signals
+    auto capacity = ( matrix->conditions.size() + partitionCount - 1 ) / partitionCount;
+    std::vector<std::unordered_set<SignalID>> partitionSignals( partitionCount );
+    std::vector<std::unordered_set<uint64_t>> partitionCanFrames( partitionCount );
+    for ( const auto &condition : matrix->conditions )
+    {
+        size_t bestPartition = partitionCount;
+        size_t bestShared = 0;
+        for ( size_t i = 0; i < partitionCount; i++ )
+        {
+            if ( partitions[i]->conditions.size() >= capacity )
+            {
+                continue;
+            }
+            size_t shared = 0;
+            for ( const auto &signal : condition.signals )
+            {
+                shared += partitionSignals[i].count( signal.signalID );
+            }
+            for ( const auto &canFrame : condition.canFrames )
+            {
+                shared += partitionCanFrames[i].count( getCanFrameKey( canFrame.frameID, canFrame.channelID ) );
+            }
+            if ( ( bestPartition == partitionCount ) || ( shared > bestShared ) ||
+                 ( ( shared == bestShared ) &&
+                   ( partitions[i]->conditions.size() < partitions[bestPartition]->conditions.size() ) ) )
+            {
+                bestPartition = i;
+                bestShared = shared;
+            }
+        }
+        partitions[bestPartition]->conditions.push_back( condition );
+        for ( const auto &signal : condition.signals )
+        {
+            partitionSignals[bestPartition].insert( signal.signalID );
+        }
+        for ( const auto &canFrame : condition.canFrames )
+        {
+            partitionCanFrames[bestPartition].insert( getCanFrameKey( canFrame.frameID, canFrame.channelID ) );
+        }
+    }
+    for ( size_t i = 0; i < partitionCount; i++ )
+    {
+        result[i] = partitions[i];
+    }
+    return result;
+}
+
+std::shared_ptr<const CollectionInspectionRouter::Routes>
+CollectionInspectionRouter::buildRoutes( const std::vector<std::shared_ptr<const InspectionMatrix>> &partitions )
+{
+    auto routes = std::make_shared<Routes>();
+    for ( size_t i = 0; i < partitions.size(); i++ )
+    {
+        if ( partitions[i] == nullptr )
+        {
+            continue;
+        }
+        for ( const auto &condition : partitions[i]->conditions )
+        {
+            for ( const auto &signal : condition.signals )
+            {
+                routes->mSignals[signal.signalID] |= uint64_t{ 1 } << i;
+            }
+            for ( const auto &canFrame : condition.canFrames )
+            {
+                routes->mCanFrames[getCanFrameKey( canFrame.frameID, canFrame.channelID )] |= uint64_t{ 1 } << i;
+            }
+        }
+    }
+    return routes;
+}
+
+void
+CollectionInspectionRouter::onChangeInspectionMatrix( const std::shared_ptr<const InspectionMatrix> &activeConditions )
+{
+    if ( fPartitions.size() == 1 )
+    {
+        fPartitions[0].mWorker->onChangeInspectionMatrix( activeConditions );
+        return;
+    }
+    auto partitions = partitionInspectionMatrix( activeConditions, fPartitions.size() );
+    fRoutes.store( activeConditions == nullptr ? nullptr : buildRoutes( partitions ) );
+    for ( size_t i = 0; i < fPartitions.size(); i++ )
+    {
+        fPartitions[i].mWorker->onChangeInspectionMatrix( partitions[i] );
+        if ( partitions[i] != nullptr )
+        {
+            fLogger.trace( "CollectionInspectionRouter::onChangeInspectionMatrix",
+                           "Partition " + std::to_string( i ) + " has " +
+                               std::to_string( partitions[i]->conditions.size() ) + " conditions" );
+        }
+    }
+    // Wake up the thread.
+    fWait->notify();
+}
+
+void
+CollectionInspectionRouter::onDataReadyToPublish()
+{
+    if ( fPartitions.size() == 1 )
+    {
+        // The single worker pushes directly to the output queue
+        notifyListeners<>( &IDataReadyToPublishListener::onDataReadyToPublish );
+    }
+    else
+    {
+        fWait->notify();
+    }
+}
+
+void
+CollectionInspectionRouter::onNewDataAvailable()
+{
+    if ( fPartitions.size() == 1 )
+    {
+        fPartitions[0].mWorker->onNewDataAvailable();
+    }
+    else
+    {
+        fWait->notify();
+    }
+}
+
+template <typename T, typename Queue>
+size_t
+CollectionInspectionRouter::pushToPartitions( uint64_t partitionMask,
+                                              const T &element,
+                                              std::shared_ptr<Queue> Partition::*queue )
+{
+    size_t pushed = 0;
+    for ( auto mask = partitionMask; mask != 0; mask &= mask - 1 )
+    {
+        if ( ( fPartitions[ConditionBitset::lowestSetBit( mask )].*queue )->push( element ) )
+        {
+            pushed++;
+        }
+        else
+        {
+            fDroppedElements++;
+        }
+    }
+    return pushed;
+}
+
+uint32_t
+CollectionInspectionRouter::mergeCollectedData()
+{
+    uint32_t merged = 0;
+    TriggeredCollectionSchemeDataPtr collectedData;
+    for ( auto &partition : fPartitions )
+    {
+        // Data stays in the queue of the partition while the output queue is full
+        while ( ( fOutputCollectedData->write_available() > 0 ) && partition.mCollectedData->pop( collectedData ) )
+        {
+            fOutputCollectedData->push( collectedData );
+            merged++;
+        }
+    }
+    if ( merged > 0 )
+    {
+        notifyListeners<>( &IDataReadyToPublishListener::onDataReadyToPublish );
+    }
+    return merged;
+}
+
+void
+CollectionInspectionRouter::doWork( void *data )
+{
+    CollectionInspectionRouter *router = static_cast<CollectionInspectionRouter *>( data );
+    std::shared_ptr<const Routes> routes;
+    uint64_t routesVersion = 0;
+    Timestamp lastTraceOutput = 0;
+    uint64_t statisticRoutedElements = 0;
+    uint32_t statisticDataSentOut = 0;
+    do
+    {
+        router->fRoutes.refresh( routes, routesVersion );
+        uint64_t partitionsWithNewData = 0;
+        size_t signalCount = 0;
+        size_t canFrameCount = 0;
+        // Without routes the input stays in the queues until the first inspection matrix arrives
+        if ( routes != nullptr )
+        {
+            size_t routedSignalCount = 0;
+            CollectedSignal inputSignal( 0, 0, 0.0 );
+            while ( ( signalCount < MAX_ROUTE_BATCH_SIZE ) && router->fInputSignalBuffer->pop( inputSignal ) )
+            {
+                signalCount++;
+                auto route = routes->mSignals.find( inputSignal.signalID );
+                if ( route != routes->mSignals.end() )
+                {
+                    routedSignalCount +=
+                        router->pushToPartitions( route->second, inputSignal, &Partition::mSignalBuffer );
+                    partitionsWithNewData |= route->second;
+                }
+            }
+            size_t routedCanFrameCount = 0;
+            CollectedCanFrameWithSignals inputCANFrame;
+            while ( ( canFrameCount < MAX_ROUTE_BATCH_SIZE ) && router->fInputCANBuffer->pop( inputCANFrame ) )
+            {
+                canFrameCount++;
+                uint64_t partitionMask = 0;
+                auto route =
+                    routes->mCanFrames.find( getCanFrameKey( inputCANFrame.frameID, inputCANFrame.channelId ) );
+                if ( route != routes->mCanFrames.end() )
+                {
+                    partitionMask = route->second;
+                }
+                // The frame also goes to the partitions of the signals decoded from it
+                for ( uint8_t i = 0; i < inputCANFrame.decodedSignalCount; i++ )
+                {
+                    auto signalRoute = routes->mSignals.find( inputCANFrame.decodedSignals[i].signalID );
+                    if ( signalRoute != routes->mSignals.end() )
+                    {
+                        partitionMask |= signalRoute->second;
+                    }
+                }
+                if ( partitionMask != 0 )
+                {
+                    routedCanFrameCount +=
+                        router->pushToPartitions( partitionMask, inputCANFrame, &Partition::mCANBuffer );
+                    partitionsWithNewData |= partitionMask;
+                }
+            }
+            // The queue trace counters count every copy that waits for a worker
+            if ( routedSignalCount > signalCount )
+            {
+                TraceModule::get().addToAtomicVariable( TraceAtomicVariable::QUEUE_CONSUMER_TO_INSPECTION_SIGNALS,
+                                                        routedSignalCount - signalCount );
+            }
+            else if ( routedSignalCount < signalCount )
+            {
+                TraceModule::get().subtractFromAtomicVariable(
+                    TraceAtomicVariable::QUEUE_CONSUMER_TO_INSPECTION_SIGNALS, signalCount - routedSignalCount );
+            }
+            if ( routedCanFrameCount > canFrameCount )
+            {
+                TraceModule::get().addToAtomicVariable( TraceAtomicVariable::QUEUE_CONSUMER_TO_INSPECTION_CAN,
+                                                        routedCanFrameCount - canFrameCount );
+            }
+            else if ( routedCanFrameCount < canFrameCount )
+            {
+                TraceModule::get().subtractFromAtomicVariable( TraceAtomicVariable::QUEUE_CONSUMER_TO_INSPECTION_CAN,
+                                                               canFrameCount - routedCanFrameCount );
+            }
+            statisticRoutedElements += routedSignalCount + routedCanFrameCount;
+
+            // The DTCs are needed by all partitions
+            DTCInfo activeDTCs = {};
+            if ( router->fInputActiveDTCBuffer->pop( activeDTCs ) )
+            {
+                for ( size_t i = 0; i < router->fPartitions.size(); i++ )
+                {
+                    if ( router->fPartitions[i].mActiveDTCBuffer->push( activeDTCs ) )
+                    {
+                        partitionsWithNewData |= uint64_t{ 1 } << i;
+                    }
+                }
+            }
+        }
+        for ( auto mask = partitionsWithNewData; mask != 0; mask &= mask - 1 )
+        {
+            router->fPartitions[ConditionBitset::lowestSetBit( mask )].mWorker->onNewDataAvailable();
+        }
+        statisticDataSentOut += router->mergeCollectedData();
+
+        if ( ( signalCount < MAX_ROUTE_BATCH_SIZE ) && ( canFrameCount < MAX_ROUTE_BATCH_SIZE ) )
+        {
+            auto currentTime = FastClock::monotonicTimeMs( ClockPrecision::COARSE );
+            // Print only every LOG_AGGREGATION_TIME_MS to avoid console spam
+            if ( currentTime > ( lastTraceOutput + LoggingModule::LOG_AGGREGATION_TIME_MS ) )
+            {
+                router->fLogger.trace( "CollectionInspectionRouter::doWork",
+                                       "Routed " + std::to_string( statisticRoutedElements ) +
+                                           " elements to the partitions, dropped " +
+                                           std::to_string( router->fDroppedElements ) +
+                                           " as the partition was full and sent out " +
+                                           std::to_string( statisticDataSentOut ) + " packages" );
+                statisticRoutedElements = 0;
+                statisticDataSentOut = 0;
+                router->fDroppedElements = 0;
+                lastTraceOutput = currentTime;
+            }
+            // All input queues are drained, wait for new data or collected data of a worker
+            router->fWait->wait( router->fIdleTimeMs );
+        }
+    } while ( !router->shouldStop() );
+}
+
+CollectionInspectionRouter::~CollectionInspectionRouter()
+{
+    // To make sure the threads stop during teardown of tests.
+    stop();
+}
+
+} // namespace DataInspection
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -12,7 +12,11 @@
  */
 
 #include "CollectionInspectionWorkerThread.h"
+#include "LatencyTracer.h"
+#include "LowActivityMode.h"
+#include "StallWatchdog.h"
 #include "TraceModule.h"
+#include <unistd.h>
 
 namespace Aws
 {
@@ -37,6 +41,7 @@ CollectionInspectionWorkerThread::init( const std::shared_ptr<SignalBuffer> &inp
     {
         fIdleTimeMs = idleTimeMs;
     }
+    fEvaluationScheduler = EvaluationScheduler( fMinimumEvaluationSpacingMs, fIdleTimeMs );
     fCollectionInspectionEngine.setDataReductionParameters( dataReductionProbabilityDisabled );
 
     return true;
@@ -54,17 +59,25 @@ CollectionInspectionWorkerThread::start()
     }
     // Prevent concurrent stop/init
     std::lock_guard<std::mutex> lock( fThreadMutex );
+    fStateRestorePending = !fStateFile.empty();
+    fInputSignals.resize( SIGNAL_POP_BATCH_SIZE );
+    if ( fRunToCompletionWakeup )
+    {
+        // The cycles are run by the thread of the caller
+        fRunToCompletionStarted.store( true );
+        fLogger.trace( "CollectionInspectionWorkerThread::start", " Inspection started in run to completion mode " );
+        return true;
+    }
     // On multi core systems the shared variable fShouldStop must be updated for
     // all cores before starting the thread otherwise thread will directly end
     fShouldStop.store( false );
-    if ( !fThread.create( doWork, this ) )
+    if ( !fThread.create( doWork, this, "fwDICollInsEng" ) )
     {
         fLogger.trace( "CollectionInspectionWorkerThread::start", " Inspection Thread failed to start " );
     }
     else
     {
         fLogger.trace( "CollectionInspectionWorkerThread::start", " Inspection Thread started " );
-        fThread.setThreadName( "fwDICollInsEng" );
     }
 
     return fThread.isActive() && fThread.isValid();
@@ -73,6 +86,18 @@ CollectionInspectionWorkerThread::start()
 bool
 CollectionInspectionWorkerThread::stop()
 {
+    if ( fRunToCompletionStarted.load() )
+    {
+        // The thread driving the cycles must be stopped before, so the engine is not used anymore
+        std::lock_guard<std::mutex> lock( fThreadMutex );
+        if ( ( !fStateFile.empty() ) && fInspectionMatrix )
+        {
+            (void)fCollectionInspectionEngine.saveState( fStateFile );
+        }
+        fRunToCompletionStarted.store( false );
+        fLogger.trace( "CollectionInspectionWorkerThread::stop", " Stop finished " );
+        return true;
+    }
     if ( !fThread.isValid() || !fThread.isActive() )
     {
         return true;
@@ -80,7 +105,7 @@ CollectionInspectionWorkerThread::stop()
     std::lock_guard<std::mutex> lock( fThreadMutex );
     fShouldStop.store( true, std::memory_order_relaxed );
     fLogger.trace( "CollectionInspectionWorkerThread::stop", " Request stop " );
-    fWait.notify();
+    fWait->notify();
     fThread.release();
     fLogger.trace( "CollectionInspectionWorkerThread::stop", " Stop finished " );
     fShouldStop.store( false, std::memory_order_relaxed );
@@ -97,21 +122,321 @@ void
 CollectionInspectionWorkerThread::onChangeInspectionMatrix(
     const std::shared_ptr<const InspectionMatrix> &activeConditions )
 {
+    fUpdatedInspectionMatrix.store( activeConditions );
+    fLogger.trace( "CollectionInspectionWorkerThread::onChangeInspectionMatrix",
+                   " new inspection matrix handed over " );
+    // Wake up the thread.
+    wakeUp();
+}
+
+void
+CollectionInspectionWorkerThread::onNewDataAvailable()
+{
+    wakeUp();
+}
+
+void
+CollectionInspectionWorkerThread::wakeUp()
+{
+    if ( fRunToCompletionWakeup )
+    {
+        fRunToCompletionWakeup();
+    }
+    else
     {
-        std::lock_guard<std::mutex> lock( fInspectionMatrixMutex );
-        fUpdatedInspectionMatrix = activeConditions;
-        fUpdatedInspectionMatrixAvailable = true;
-        fLogger.trace( "CollectionInspectionWorkerThread::onChangeInspectionMatrix",
-                       " new inspection matrix handed over " );
-        // Wake up the thread.
-        fWait.notify();
+        fWait->notify();
     }
 }
 
+bool
+CollectionInspectionWorkerThread::refreshInspectionMatrix()
+{
+    // A single atomic load unless a new inspection matrix was handed over
+    if ( fUpdatedInspectionMatrix.refresh( fInspectionMatrix, fInspectionMatrixVersion ) )
+    {
+        fCollectionInspectionEngine.onChangeInspectionMatrix( fInspectionMatrix );
+        if ( fStateRestorePending && fCollectionInspectionEngine.restoreState( fStateFile ) )
+        {
+            fStateRestorePending = false;
+            (void)unlink( fStateFile.c_str() );
+        }
+    }
+    return fInspectionMatrix != nullptr;
+}
+
 void
-CollectionInspectionWorkerThread::onNewDataAvailable()
+CollectionInspectionWorkerThread::addSignal( const CollectedSignal &inputSignal )
+{
+    auto &engine = fCollectionInspectionEngine;
+    engine.addNewSignal( inputSignal.signalID,
+                         inputSignal.receiveTime,
+                         inputSignal.value,
+                         inputSignal.receiveTimeFractionUs,
+                         inputSignal.signalIndex );
+    if ( inputSignal.traceId != 0U )
+    {
+        LatencyTracer::get().mark( inputSignal.traceId, LatencyStage::QUEUE_POP );
+        engine.addTracedSignal( inputSignal.signalID, inputSignal.traceId );
+    }
+    fEvaluationScheduler.onInput( inputSignal.receiveTime );
+    fLatestSignalTime = std::max( fLatestSignalTime, inputSignal.receiveTime );
+    if ( ( ( inputSignal.receiveTime - fLastInputTimeEvaluated ) >= fMinimumEvaluationSpacingMs ) &&
+         ( engine.getNextEvaluationTime( fCycleTime ) <= fCycleTime ) )
+    {
+        fLastInputTimeEvaluated = inputSignal.receiveTime;
+        engine.evaluateConditions( fCycleTime );
+        fEvaluationScheduler.onEvaluated( fCycleTime );
+    }
+}
+
+void
+CollectionInspectionWorkerThread::addRawFrame( const CollectedCanFrameWithSignals &inputCANFrame )
+{
+    auto &engine = fCollectionInspectionEngine;
+    engine.addNewRawCanFrame( inputCANFrame.frameID,
+                              inputCANFrame.channelId,
+                              inputCANFrame.receiveTime,
+                              inputCANFrame.data,
+                              inputCANFrame.size,
+                              inputCANFrame.receiveTimeFractionUs );
+    // Signals decoded from a RAW_AND_DECODE frame come with the frame
+    for ( uint8_t i = 0; i < inputCANFrame.decodedSignalCount; i++ )
+    {
+        const auto &decodedSignal = inputCANFrame.decodedSignals[i];
+        engine.addNewSignal( decodedSignal.signalID,
+                             inputCANFrame.receiveTime,
+                             decodedSignal.value,
+                             inputCANFrame.receiveTimeFractionUs,
+                             decodedSignal.signalIndex );
+        if ( inputCANFrame.traceId != 0U )
+        {
+            engine.addTracedSignal( decodedSignal.signalID, inputCANFrame.traceId );
+        }
+    }
+    if ( ( inputCANFrame.traceId != 0U ) && ( inputCANFrame.decodedSignalCount > 0 ) )
+    {
+        LatencyTracer::get().mark( inputCANFrame.traceId, LatencyStage::QUEUE_POP );
+    }
+    fEvaluationScheduler.onInput( inputCANFrame.receiveTime );
+    fLatestSignalTime = std::max( fLatestSignalTime, inputCANFrame.receiveTime );
+    // Same as for the signals
+    if ( ( inputCANFrame.decodedSignalCount > 0 ) &&
+         ( ( inputCANFrame.receiveTime - fLastInputTimeEvaluated ) >= fMinimumEvaluationSpacingMs ) &&
+         ( engine.getNextEvaluationTime( fCycleTime ) <= fCycleTime ) )
+    {
+        fLastInputTimeEvaluated = inputCANFrame.receiveTime;
+        engine.evaluateConditions( fCycleTime );
+        fEvaluationScheduler.onEvaluated( fCycleTime );
+    }
+}
+
+size_t
+CollectionInspectionWorkerThread::drainSignalBuffer()
 {
-    fWait.notify();
+    size_t signalCount = 0;
+    while ( signalCount < MAX_DRAIN_BATCH_SIZE )
+    {
+        auto poppedCount = fInputSignalBuffer->pop(
+            fInputSignals.data(), std::min( fInputSignals.size(), MAX_DRAIN_BATCH_SIZE - signalCount ) );
+        if ( poppedCount == 0 )
+        {
+            break;
+        }
+        signalCount += poppedCount;
+        for ( size_t i = 0; i < poppedCount; i++ )
+        {
+            addSignal( fInputSignals[i] );
+        }
+    }
+    // The trace counters are updated once per batch
+    if ( signalCount > 0 )
+    {
+        TraceModule::get().subtractFromAtomicVariable( TraceAtomicVariable::QUEUE_CONSUMER_TO_INSPECTION_SIGNALS,
+                                                       signalCount );
+        fInputSinceLastEvaluation = true;
+        fStateRestorePending = false;
+    }
+    return signalCount;
+}
+
+size_t
+CollectionInspectionWorkerThread::drainCANBuffer()
+{
+    size_t canFrameCount = 0;
+    CollectedCanFrameWithSignals inputCANFrame;
+    while ( ( canFrameCount < MAX_DRAIN_BATCH_SIZE ) && fInputCANBuffer->pop( inputCANFrame ) )
+    {
+        addRawFrame( inputCANFrame );
+        canFrameCount++;
+    }
+    if ( canFrameCount > 0 )
+    {
+        TraceModule::get().subtractFromAtomicVariable( TraceAtomicVariable::QUEUE_CONSUMER_TO_INSPECTION_CAN,
+                                                       canFrameCount );
+        fInputSinceLastEvaluation = true;
+        fStateRestorePending = false;
+    }
+    return canFrameCount;
+}
+
+void
+CollectionInspectionWorkerThread::addSignals( const CollectedSignal *signals, size_t count )
+{
+    // Without an inspection matrix the input is dropped, like a full Signal Buffer would drop it
+    if ( ( !fInspectionMatrix ) || ( count == 0 ) )
+    {
+        return;
+    }
+    for ( size_t i = 0; i < count; i++ )
+    {
+        addSignal( signals[i] );
+    }
+    fInputSinceLastEvaluation = true;
+    fStateRestorePending = false;
+}
+
+void
+CollectionInspectionWorkerThread::addRawFrames( const CollectedCanFrameWithSignals *frames, size_t count )
+{
+    if ( ( !fInspectionMatrix ) || ( count == 0 ) )
+    {
+        return;
+    }
+    for ( size_t i = 0; i < count; i++ )
+    {
+        addRawFrame( frames[i] );
+    }
+    fInputSinceLastEvaluation = true;
+    fStateRestorePending = false;
+}
+
+void
+CollectionInspectionWorkerThread::evaluateConditionsIfDue()
+{
+    auto &engine = fCollectionInspectionEngine;
+    // Consume any Active DTCs
+    // We could check if the DTCs have changed here, but not necessary
+    // as we are looking at only the latest known DTCs.
+    // We only pop one item from the Buffer for a reason : DTCs represent
+    // the health of all ECUs in the network. The Inspection Engine does
+    // not need to know that topology and thus counts on the OBD Module
+    // to aggregate all DTCs from all ECUs in one single Item.
+    DTCInfo activeDTCs = {};
+    if ( fInputActiveDTCBuffer->pop( activeDTCs ) )
+    {
+        engine.setActiveDTCs( activeDTCs );
+    }
+
+    // Trigger inspection on whatever that has been consumed if a condition has work to do or a window
+    // function timed out, at most once per minimum spacing and at least once per idle time. Consumed input
+    // is always evaluated once more after the batch, also by the conditions that did not see a change.
+    if ( fEvaluationScheduler.isEvaluationDue(
+             fCycleTime, fInputSinceLastEvaluation ? fCycleTime : engine.getNextEvaluationTime( fCycleTime ) ) )
+    {
+        fLastInputTimeEvaluated = std::max( fLastInputTimeEvaluated, fLatestSignalTime );
+        engine.evaluateConditions( fCycleTime );
+        fEvaluationScheduler.onEvaluated( fCycleTime );
+        fInputSinceLastEvaluation = false;
+    }
+}
+
+uint32_t
+CollectionInspectionWorkerThread::collectData()
+{
+    auto &engine = fCollectionInspectionEngine;
+    uint32_t waitTimeMs = fIdleTimeMs;
+    std::shared_ptr<const TriggeredCollectionSchemeData> collectedData =
+        engine.collectNextDataToSend( fCycleTime, waitTimeMs );
+    while ( collectedData != nullptr && !shouldStop() )
+    {
+        if ( ( fExpressCollectedData != nullptr ) && collectedData->metaData.express )
+        {
+            // The express data bypasses the output queue and the thread sending the other data
+            TriggeredCollectionSchemeDataPtr expressData = collectedData;
+            if ( fExpressCollectedData->tryPush( expressData ) )
+            {
+                fStatisticDataSentOut++;
+                collectedData = engine.collectNextDataToSend( fCycleTime, waitTimeMs );
+                continue;
+            }
+            TraceModule::get().incrementAtomicVariable( TraceAtomicVariable::EXPRESS_QUEUE_FULL );
+        }
+        if ( !fOutputCollectedData->push( collectedData ) )
+        {
+            TraceModule::get().incrementAtomicVariable( TraceAtomicVariable::QUEUE_FULL_DROPPED_COLLECTED_DATA );
+            fLogger.warn( "CollectionInspectionWorkerThread::collectData",
+                          []() { return "Collected data output buffer is full"; } );
+        }
+        else
+        {
+            fStatisticDataSentOut++;
+            notifyListeners<>( &IDataReadyToPublishListener::onDataReadyToPublish );
+        }
+        collectedData = engine.collectNextDataToSend( fCycleTime, waitTimeMs );
+    }
+    if ( fConditionProfilingReportIntervalMs > 0 )
+    {
+        if ( fLastConditionProfilingReport == 0 )
+        {
+            fLastConditionProfilingReport = fCycleTime;
+        }
+        else if ( fCycleTime >= ( fLastConditionProfilingReport + fConditionProfilingReportIntervalMs ) )
+        {
+            engine.reportHotConditions( fHotConditionCount );
+            fLastConditionProfilingReport = fCycleTime;
+        }
+    }
+    return waitTimeMs;
+}
+
+uint32_t
+CollectionInspectionWorkerThread::getIdleWaitTimeMs( uint32_t waitTimeMs )
+{
+    // Go to idle mode until the next collection or the next evaluation is due.
+    auto nextEvaluationTime =
+        fInputSinceLastEvaluation ? fCycleTime : fCollectionInspectionEngine.getNextEvaluationTime( fCycleTime );
+    uint32_t timeToWait = std::min( waitTimeMs, fEvaluationScheduler.getWaitTimeMs( fCycleTime, nextEvaluationTime ) );
+    // While the vehicle is parked the evaluation once per idle time is not needed without input, only
+    // the pending collections and timed out window functions are waited for
+    uint32_t deadlineMs = waitTimeMs;
+    if ( nextEvaluationTime != std::numeric_limits<Timestamp>::max() )
+    {
+        deadlineMs = static_cast<uint32_t>( std::min<Timestamp>(
+            deadlineMs, ( nextEvaluationTime > fCycleTime ) ? nextEvaluationTime - fCycleTime : 0 ) );
+    }
+    return LowActivityMode::get().getDeadlineWaitTimeMs( std::max( deadlineMs, timeToWait ), timeToWait );
+}
+
+bool
+CollectionInspectionWorkerThread::beginCycle()
+{
+    if ( !refreshInspectionMatrix() )
+    {
+        return false;
+    }
+    fCycleTime = fClock->timeSinceEpochMs();
+    fLatestSignalTime = 0;
+    return true;
+}
+
+uint32_t
+CollectionInspectionWorkerThread::endCycle()
+{
+    if ( !fInspectionMatrix )
+    {
+        // Woken up by the new inspection matrix
+        return fIdleTimeMs;
+    }
+    // Other data sources, e.g. OBD, still push to the input queues
+    auto signalCount = drainSignalBuffer();
+    auto canFrameCount = drainCANBuffer();
+    evaluateConditionsIfDue();
+    auto waitTimeMs = collectData();
+    if ( ( signalCount >= MAX_DRAIN_BATCH_SIZE ) || ( canFrameCount >= MAX_DRAIN_BATCH_SIZE ) )
+    {
+        return 0;
+    }
+    return getIdleWaitTimeMs( waitTimeMs );
 }
 
 void
@@ -119,148 +444,84 @@ CollectionInspectionWorkerThread::doWork( void *data )
 {
 
     CollectionInspectionWorkerThread *consumer = static_cast<CollectionInspectionWorkerThread *>( data );
-    Timestamp lastInputTimeEvaluated = 0;
-    Timestamp lastTimeEvaluated = 0;
     Timestamp lastTraceOutput = 0;
-    uint64_t inputCounterSinceLastEvaluate = 0;
     uint32_t statisticInputMessagesProcessed = 0;
-    uint32_t statisticDataSentOut = 0;
     uint32_t activations = 0;
+    StallWatchdog::Heartbeat heartbeat;
     do
     {
         activations++;
-        if ( consumer->fUpdatedInspectionMatrixAvailable )
-        {
-            std::shared_ptr<const InspectionMatrix> newInspectionMatrix;
-            {
-                std::lock_guard<std::mutex> lock( consumer->fInspectionMatrixMutex );
-                consumer->fUpdatedInspectionMatrixAvailable = false;
-                newInspectionMatrix = consumer->fUpdatedInspectionMatrix;
-            }
-            consumer->fCollectionInspectionEngine.onChangeInspectionMatrix( newInspectionMatrix );
-        }
+        heartbeat.enter( "matrixUpdate" );
         // Only run the main inspection loop if there is an inspection matrix
         // Otherwise, go to sleep.
-        if ( consumer->fUpdatedInspectionMatrix )
+        if ( consumer->refreshInspectionMatrix() )
         {
-            bool readyToSleep = true;
-            Timestamp latestSignalTime = 0;
-            CollectedSignal inputSignal( 0, 0, 0.0 );
-            std::array<uint8_t, MAX_CAN_FRAME_BYTE_SIZE> buf = {};
-            CollectedCanRawFrame inputCANFrame( 0, 0, 0, buf, 0 );
-            // Consume any new signals and pass them over to the inspection Engine
-            if ( consumer->fInputSignalBuffer->pop( inputSignal ) )
-            {
-                TraceModule::get().decrementAtomicVariable( TraceAtomicVariable::QUEUE_CONSUMER_TO_INSPECTION_SIGNALS );
-                readyToSleep = false;
-                consumer->fCollectionInspectionEngine.addNewSignal(
-                    inputSignal.signalID, inputSignal.receiveTime, inputSignal.value );
-                latestSignalTime = std::max( latestSignalTime, inputSignal.receiveTime );
-                inputCounterSinceLastEvaluate++;
-                statisticInputMessagesProcessed++;
-            }
-            // Consume any raw frames
-            if ( consumer->fInputCANBuffer->pop( inputCANFrame ) )
-            {
-                TraceModule::get().decrementAtomicVariable( TraceAtomicVariable::QUEUE_CONSUMER_TO_INSPECTION_CAN );
-                readyToSleep = false;
-                consumer->fCollectionInspectionEngine.addNewRawCanFrame( inputCANFrame.frameID,
-                                                                         inputCANFrame.channelId,
-                                                                         inputCANFrame.receiveTime,
-                                                                         inputCANFrame.data,
-                                                                         inputCANFrame.size );
-                latestSignalTime = std::max( latestSignalTime, inputCANFrame.receiveTime );
-                inputCounterSinceLastEvaluate++;
-                statisticInputMessagesProcessed++;
-            }
+            // The clock is read once for the whole batch
+            consumer->fCycleTime = consumer->fClock->timeSinceEpochMs();
+            consumer->fLatestSignalTime = 0;
+            // Consume a batch of new signals and pass them over to the inspection Engine
+            heartbeat.enter( "addSignals" );
+            auto signalCount = consumer->drainSignalBuffer();
+            // Consume a batch of raw frames
+            heartbeat.enter( "addRawFrames" );
+            auto canFrameCount = consumer->drainCANBuffer();
+            // If the batch did not fill up all queues are drained, so after this evaluation the thread can idle
+            bool readyToSleep = ( signalCount < MAX_DRAIN_BATCH_SIZE ) && ( canFrameCount < MAX_DRAIN_BATCH_SIZE );
+            statisticInputMessagesProcessed += static_cast<uint32_t>( signalCount + canFrameCount );
 
-            // Consume any Active DTCs
-            // We could check if the DTCs have changed here, but not necessary
-            // as we are looking at only the latest known DTCs.
-            // We only pop one item from the Buffer for a reason : DTCs represent
-            // the health of all ECUs in the network. The Inspection Engine does
-            // not need to know that topology and thus counts on the OBD Module
-            // to aggregate all DTCs from all ECUs in one single Item.
-            DTCInfo activeDTCs = {};
-            if ( consumer->fInputActiveDTCBuffer->pop( activeDTCs ) )
-            {
-                consumer->fCollectionInspectionEngine.setActiveDTCs( activeDTCs );
-            }
-
-            // Trigger inspection on whatever that has been consumed.
-            if ( ( ( latestSignalTime - lastInputTimeEvaluated ) >= EVALUATE_INTERVAL_MS ) ||
-                 ( inputCounterSinceLastEvaluate >= 256 ) )
-            {
-                lastInputTimeEvaluated = latestSignalTime;
-                lastTimeEvaluated = consumer->fClock->timeSinceEpochMs();
-                consumer->fCollectionInspectionEngine.evaluateConditions( lastTimeEvaluated );
-                inputCounterSinceLastEvaluate = 0;
-            }
-
-            // before going to sleep do another evaluation if last evaluation is more than EVALUATE_INTERVAL_MS ago
-            if ( readyToSleep &&
-                 ( ( consumer->fClock->timeSinceEpochMs() - lastTimeEvaluated ) >= EVALUATE_INTERVAL_MS ) )
-            {
-                lastInputTimeEvaluated = latestSignalTime;
-                lastTimeEvaluated = consumer->fClock->timeSinceEpochMs();
-                consumer->fCollectionInspectionEngine.evaluateConditions( lastTimeEvaluated );
-                inputCounterSinceLastEvaluate = 0;
-            }
-            uint32_t waitTimeMs = consumer->fIdleTimeMs;
-            std::shared_ptr<const TriggeredCollectionSchemeData> collectedData =
-                consumer->fCollectionInspectionEngine.collectNextDataToSend( consumer->fClock->timeSinceEpochMs(),
-                                                                             waitTimeMs );
-            while ( collectedData != nullptr && !consumer->shouldStop() )
-            {
-                if ( !consumer->fOutputCollectedData->push( collectedData ) )
-                {
-                    consumer->fLogger.warn( "CollectionInspectionWorkerThread::doWork",
-                                            "Collected data output buffer is full" );
-                }
-                else
-                {
-                    statisticDataSentOut++;
-                    consumer->notifyListeners<>( &IDataReadyToPublishListener::onDataReadyToPublish );
-                }
-                collectedData = consumer->fCollectionInspectionEngine.collectNextDataToSend(
-                    consumer->fClock->timeSinceEpochMs(), waitTimeMs );
-            }
+            heartbeat.enter( "evaluateConditions" );
+            consumer->evaluateConditionsIfDue();
+            heartbeat.enter( "collectData" );
+            auto waitTimeMs = consumer->collectData();
 
             if ( readyToSleep )
             {
-                // Nothing is in the ring buffer to consume. Go to idle mode for some time.
-                uint32_t timeToWait = std::min( waitTimeMs, consumer->fIdleTimeMs );
+                // Nothing is in the ring buffer to consume.
+                auto timeToWait = consumer->getIdleWaitTimeMs( waitTimeMs );
+                auto currentTime = consumer->fCycleTime;
                 // Print only every THREAD_IDLE_TIME_MS to avoid console spam
-                if ( consumer->fClock->timeSinceEpochMs() >
-                     ( lastTraceOutput + LoggingModule::LOG_AGGREGATION_TIME_MS ) )
+                if ( currentTime > ( lastTraceOutput + LoggingModule::LOG_AGGREGATION_TIME_MS ) )
                 {
-                    consumer->fLogger.trace(
-                        "CollectionInspectionWorkerThread::doWork",
-                        "Activations: " + std::to_string( activations ) +
-                            ". Waiting for some data to come. Idling for :" + std::to_string( timeToWait ) +
-                            " ms or until notify. Since last idling processed " +
-                            std::to_string( statisticInputMessagesProcessed ) +
-                            " incoming data packages and sent out " + std::to_string( statisticDataSentOut ) +
-                            " packages out" );
+                    consumer->fLogger.trace( "CollectionInspectionWorkerThread::doWork", [&]() {
+                        return "Activations: " + std::to_string( activations ) +
+                               ". Waiting for some data to come. Idling for :" + std::to_string( timeToWait ) +
+                               " ms or until notify. Since last idling processed " +
+                               std::to_string( statisticInputMessagesProcessed ) +
+                               " incoming data packages and sent out " +
+                               std::to_string( consumer->fStatisticDataSentOut ) + " packages out";
+                    } );
                     activations = 0;
                     statisticInputMessagesProcessed = 0;
-                    statisticDataSentOut = 0;
-                    lastTraceOutput = consumer->fClock->timeSinceEpochMs();
+                    consumer->fStatisticDataSentOut = 0;
+                    lastTraceOutput = currentTime;
+                    consumer->fEvaluationScheduler.publishLatencyHistogram();
                 }
-                consumer->fWait.wait( timeToWait );
+                heartbeat.idle();
+                consumer->fWait->wait( timeToWait );
             }
         }
         else
         {
             // No inspection Matrix available. Wait for it from the CollectionScheme manager
-            consumer->fWait.wait( Platform::Linux::Signal::WaitWithPredicate );
+            heartbeat.idle();
+            consumer->fWait->wait( Platform::Linux::Signal::WaitWithPredicate );
         }
     } while ( !consumer->shouldStop() );
+    // The engine is only used by this thread, so the state is saved before the thread ends
+    if ( ( !consumer->fStateFile.empty() ) && consumer->fInspectionMatrix )
+    {
+        heartbeat.enter( "saveState" );
+        (void)consumer->fCollectionInspectionEngine.saveState( consumer->fStateFile );
+    }
 }
 
 bool
 CollectionInspectionWorkerThread::isAlive()
 {
+    if ( fRunToCompletionStarted.load() )
+    {
+        return true;
+    }
     return fThread.isValid() && fThread.isActive();
 }
 
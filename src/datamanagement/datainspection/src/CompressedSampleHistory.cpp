@@ -0,0 +1,308 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "CompressedSampleHistory.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataInspection
+{
+
+constexpr uint32_t CompressedSampleHistory::BLOCK_SAMPLES;
+
+namespace
+{
+constexpr uint32_t BITS_PER_WORD = 64;
+constexpr uint64_t MICROSECONDS_PER_MILLISECOND = 1000;
+// Zigzag encoded delta of deltas up to these sizes are written with the bits behind the prefixes 10, 110 and 1110,
+// larger ones with all 64 bits behind 1111
+constexpr std::array<uint32_t, 3> DELTA_OF_DELTA_BITS = { 7, 12, 20 };
+// The leading zeros of a value are written with 5 bits
+constexpr uint32_t MAX_LEADING_ZEROS = 31;
+constexpr uint32_t LEADING_ZEROS_BITS = 5;
+constexpr uint32_t MEANINGFUL_BITS_BITS = 6;
+
+inline uint64_t
+toBits( double value )
+{
+    uint64_t bits = 0;
+    std::memcpy( &bits, &value, sizeof( bits ) );
+    return bits;
+}
+
+inline double
+fromBits( uint64_t bits )
+{
+    double value = 0.0;
+    std::memcpy( &value, &bits, sizeof( value ) );
+    return value;
+}
+
+inline uint64_t
+zigzagEncode( int64_t value )
+{
+    return ( static_cast<uint64_t>( value ) << 1U ) ^ static_cast<uint64_t>( value >> 63 );
+}
+
+inline int64_t
+zigzagDecode( uint64_t value )
+{
+    return static_cast<int64_t>( value >> 1U ) ^ -static_cast<int64_t>( value & 1U );
+}
+} // namespace
+
+bool
+CompressedSampleHistory::init( uint32_t capacity )
+{
+    mBlocks.clear();
+    mCapacity = capacity;
+    mMaxFullBlocks = ( capacity + BLOCK_SAMPLES - 1 ) / BLOCK_SAMPLES;
+    return capacity > 0;
+}
+
+void
+CompressedSampleHistory::push( uint64_t timestamp, double value, TimestampFractionUs timestampFractionUs )
+{
+    if ( mCapacity == 0 )
+    {
+        return;
+    }
+    if ( mBlocks.empty() || ( mBlocks.back().mSampleCount == BLOCK_SAMPLES ) )
+    {
+        if ( !mBlocks.empty() )
+        {
+            mBlocks.back().mWords.shrink_to_fit();
+        }
+        // The samples of the new block still count once the oldest full block is dropped
+        if ( mBlocks.size() > mMaxFullBlocks )
+        {
+            mBlocks.pop_front();
+        }
+        mBlocks.emplace_back();
+        mBlocks.back().mWords.reserve( BLOCK_SAMPLES / 4 );
+    }
+    auto &block = mBlocks.back();
+    auto timeUs = ( timestamp * MICROSECONDS_PER_MILLISECOND ) + timestampFractionUs;
+    auto valueBits = toBits( value );
+    if ( block.mSampleCount == 0 )
+    {
+        // Every block starts uncompressed, so that it can be decompressed on its own
+        appendBits( block, timeUs, BITS_PER_WORD );
+        appendBits( block, valueBits, BITS_PER_WORD );
+        mPreviousDeltaUs = 0;
+        mHasValueWindow = false;
+    }
+    else
+    {
+        appendTime( block, timeUs );
+        appendValue( block, valueBits );
+    }
+    mPreviousTimeUs = timeUs;
+    mPreviousValueBits = valueBits;
+    block.mSampleCount++;
+}
+
+uint32_t
+CompressedSampleHistory::size() const
+{
+    uint64_t samples = 0;
+    if ( !mBlocks.empty() )
+    {
+        samples = ( static_cast<uint64_t>( mBlocks.size() - 1 ) * BLOCK_SAMPLES ) + mBlocks.back().mSampleCount;
+    }
+    return static_cast<uint32_t>( std::min<uint64_t>( samples, mCapacity ) );
+}
+
+size_t
+CompressedSampleHistory::getCompressedBytes() const
+{
+    size_t bytes = 0;
+    for ( const auto &block : mBlocks )
+    {
+        bytes += block.mWords.capacity() * sizeof( uint64_t );
+    }
+    return bytes;
+}
+
+void
+CompressedSampleHistory::collectNewest( SignalID signalID,
+                                        uint32_t count,
+                                        std::vector<CollectedSignal> &output ) const
+{
+    count = std::min( count, size() );
+    output.reserve( output.size() + count );
+    std::array<DecodedSample, BLOCK_SAMPLES> samples;
+    for ( auto block = mBlocks.rbegin(); ( block != mBlocks.rend() ) && ( count > 0 ); block++ )
+    {
+        decodeBlock( *block, samples.data() );
+        auto blockCount = std::min( count, block->mSampleCount );
+        for ( auto index = block->mSampleCount; index > block->mSampleCount - blockCount; index-- )
+        {
+            const auto &sample = samples[index - 1];
+            output.emplace_back( signalID, sample.mTimeUs / MICROSECONDS_PER_MILLISECOND, sample.mValue );
+            output.back().receiveTimeFractionUs =
+                static_cast<TimestampFractionUs>( sample.mTimeUs % MICROSECONDS_PER_MILLISECOND );
+        }
+        count -= blockCount;
+    }
+}
+
+void
+CompressedSampleHistory::appendBits( Block &block, uint64_t value, uint32_t bitCount )
+{
+    if ( bitCount < BITS_PER_WORD )
+    {
+        value &= ( 1ULL << bitCount ) - 1U;
+    }
+    auto offset = block.mBitCount % BITS_PER_WORD;
+    if ( offset == 0 )
+    {
+        block.mWords.push_back( 0 );
+    }
+    block.mWords.back() |= value << offset;
+    if ( offset + bitCount > BITS_PER_WORD )
+    {
+        block.mWords.push_back( value >> ( BITS_PER_WORD - offset ) );
+    }
+    block.mBitCount += bitCount;
+}
+
+uint64_t
+CompressedSampleHistory::readBits( const Block &block, uint32_t &position, uint32_t bitCount )
+{
+    auto index = position / BITS_PER_WORD;
+    auto offset = position % BITS_PER_WORD;
+    uint64_t value = block.mWords[index] >> offset;
+    if ( offset + bitCount > BITS_PER_WORD )
+    {
+        value |= block.mWords[index + 1] << ( BITS_PER_WORD - offset );
+    }
+    position += bitCount;
+    if ( bitCount < BITS_PER_WORD )
+    {
+        value &= ( 1ULL << bitCount ) - 1U;
+    }
+    return value;
+}
+
+void
+CompressedSampleHistory::appendTime( Block &block, uint64_t timeUs )
+{
+    auto deltaUs = static_cast<int64_t>( timeUs - mPreviousTimeUs );
+    auto encoded = zigzagEncode( deltaUs - mPreviousDeltaUs );
+    mPreviousDeltaUs = deltaUs;
+    if ( encoded == 0 )
+    {
+        // Sampled at a fixed rate
+        appendBits( block, 0, 1 );
+        return;
+    }
+    // Prefix of one bits per size class, terminated by a zero bit except for the largest class
+    for ( auto bits : DELTA_OF_DELTA_BITS )
+    {
+        appendBits( block, 1, 1 );
+        if ( encoded < ( 1ULL << bits ) )
+        {
+            appendBits( block, 0, 1 );
+            appendBits( block, encoded, bits );
+            return;
+        }
+    }
+    appendBits( block, 1, 1 );
+    appendBits( block, encoded, BITS_PER_WORD );
+}
+
+void
+CompressedSampleHistory::appendValue( Block &block, uint64_t valueBits )
+{
+    auto xored = valueBits ^ mPreviousValueBits;
+    if ( xored == 0 )
+    {
+        appendBits( block, 0, 1 );
+        return;
+    }
+    appendBits( block, 1, 1 );
+    auto leadingZeros = std::min( static_cast<uint32_t>( __builtin_clzll( xored ) ), MAX_LEADING_ZEROS );
+    auto trailingZeros = static_cast<uint32_t>( __builtin_ctzll( xored ) );
+    if ( mHasValueWindow && ( leadingZeros >= mLeadingZeros ) && ( trailingZeros >= mTrailingZeros ) )
+    {
+        // The changed bits fit into the window of the previous value
+        appendBits( block, 0, 1 );
+        appendBits( block, xored >> mTrailingZeros, BITS_PER_WORD - mLeadingZeros - mTrailingZeros );
+        return;
+    }
+    auto meaningfulBits = BITS_PER_WORD - leadingZeros - trailingZeros;
+    appendBits( block, 1, 1 );
+    appendBits( block, leadingZeros, LEADING_ZEROS_BITS );
+    appendBits( block, meaningfulBits - 1, MEANINGFUL_BITS_BITS );
+    appendBits( block, xored >> trailingZeros, meaningfulBits );
+    mLeadingZeros = leadingZeros;
+    mTrailingZeros = trailingZeros;
+    mHasValueWindow = true;
+}
+
+void
+CompressedSampleHistory::decodeBlock( const Block &block, DecodedSample *samples )
+{
+    if ( block.mSampleCount == 0 )
+    {
+        return;
+    }
+    uint32_t position = 0;
+    auto timeUs = readBits( block, position, BITS_PER_WORD );
+    auto valueBits = readBits( block, position, BITS_PER_WORD );
+    samples[0].mTimeUs = timeUs;
+    samples[0].mValue = fromBits( valueBits );
+    int64_t deltaUs = 0;
+    uint32_t leadingZeros = 0;
+    uint32_t trailingZeros = 0;
+    for ( uint32_t i = 1; i < block.mSampleCount; i++ )
+    {
+        if ( readBits( block, position, 1 ) != 0 )
+        {
+            auto bits = BITS_PER_WORD;
+            for ( auto classBits : DELTA_OF_DELTA_BITS )
+            {
+                if ( readBits( block, position, 1 ) == 0 )
+                {
+                    bits = classBits;
+                    break;
+                }
+            }
+            deltaUs += zigzagDecode( readBits( block, position, bits ) );
+        }
+        timeUs += static_cast<uint64_t>( deltaUs );
+        if ( readBits( block, position, 1 ) != 0 )
+        {
+            if ( readBits( block, position, 1 ) != 0 )
+            {
+                leadingZeros = static_cast<uint32_t>( readBits( block, position, LEADING_ZEROS_BITS ) );
+                auto meaningfulBits = static_cast<uint32_t>( readBits( block, position, MEANINGFUL_BITS_BITS ) ) + 1;
+                trailingZeros = BITS_PER_WORD - leadingZeros - meaningfulBits;
+            }
+            valueBits ^= readBits( block, position, BITS_PER_WORD - leadingZeros - trailingZeros ) << trailingZeros;
+        }
+        samples[i].mTimeUs = timeUs;
+        samples[i].mValue = fromBits( valueBits );
+    }
+}
+
+} // namespace DataInspection
+} // namespace IoTFleetWise
+} // namespace Aws
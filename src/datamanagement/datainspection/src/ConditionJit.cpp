@@ -0,0 +1,437 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "ConditionJit.h"
+#include <cstring>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <utility>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataInspection
+{
+
+constexpr uint32_t ConditionJit::INVALID_HANDLE;
+constexpr int32_t ConditionJit::SLOT_SIZE;
+constexpr int32_t ConditionJit::BOOL_OFFSET;
+
+static_assert( sizeof( ConditionJit::Slot ) == 16, "The generated code expects 16 byte slots" );
+
+namespace
+{
+constexpr size_t UNKNOWN_DEPTH = SIZE_MAX;
+// Registers in the reg field of the ModRM byte
+constexpr uint8_t RAX = 0;
+constexpr uint8_t XMM0 = 0;
+constexpr uint8_t XMM1 = 1;
+constexpr uint8_t RDX = 2;
+// Extensions of the opcode in the reg field of the ModRM byte
+constexpr uint8_t EXT_MOV_IMMEDIATE = 0;
+constexpr uint8_t EXT_CMP_IMMEDIATE = 7;
+// REX.W selects the 64 bit operand size
+constexpr uint8_t REX_W = 0x08;
+
+template <typename T>
+uint64_t
+toBits( T value )
+{
+    static_assert( sizeof( T ) <= sizeof( uint64_t ), "Only up to 64 bit immediates" );
+    uint64_t bits = 0;
+    std::memcpy( &bits, &value, sizeof( T ) );
+    return bits;
+}
+} // namespace
+
+ConditionJit::ConditionJit( LeafFunction leafFunction, double equalDistance )
+    : mLeafFunction( leafFunction )
+    , mEqualDistance( equalDistance )
+{
+}
+
+ConditionJit::~ConditionJit()
+{
+    clear();
+}
+
+bool
+ConditionJit::isSupported()
+{
+#if defined( __x86_64__ ) && defined( __linux__ )
+    return true;
+#else
+    return false;
+#endif
+}
+
+void
+ConditionJit::emit( std::initializer_list<uint8_t> bytes )
+{
+    mCode.insert( mCode.end(), bytes.begin(), bytes.end() );
+}
+
+void
+ConditionJit::emit32( uint32_t value )
+{
+    for ( int i = 0; i < 4; i++ )
+    {
+        mCode.push_back( static_cast<uint8_t>( value >> ( i * 8 ) ) );
+    }
+}
+
+void
+ConditionJit::emit64( uint64_t value )
+{
+    emit32( static_cast<uint32_t>( value ) );
+    emit32( static_cast<uint32_t>( value >> 32 ) );
+}
+
+void
+ConditionJit::emitSlotAccess( std::initializer_list<uint8_t> prefix,
+                              uint8_t rex,
+                              std::initializer_list<uint8_t> opcode,
+                              uint8_t reg,
+                              int32_t displacement )
+{
+    emit( prefix );
+    // REX.B extends the base register of the SIB byte to r12, REX.R the reg field
+    mCode.push_back( static_cast<uint8_t>( 0x41 | rex | ( ( reg & 0x08 ) >> 1 ) ) );
+    emit( opcode );
+    // ModRM with 32 bit displacement and SIB byte, SIB with base r12 and no index
+    mCode.push_back( static_cast<uint8_t>( 0x84 | ( ( reg & 0x07 ) << 3 ) ) );
+    mCode.push_back( 0x24 );
+    emit32( static_cast<uint32_t>( displacement ) );
+}
+
+void
+ConditionJit::emitJumpToExit( std::initializer_list<uint8_t> opcode )
+{
+    emit( opcode );
+    mExitJumps.push_back( mCode.size() );
+    emit32( 0 );
+}
+
+bool
+ConditionJit::getStackDepths( const std::vector<Operation> &program,
+                              size_t maxStackSize,
+                              std::vector<size_t> &depthBefore )
+{
+    // Depth of the stack before every operation and at the end, the depth a jump arrives with must match
+    depthBefore.assign( program.size() + 1, UNKNOWN_DEPTH );
+    size_t depth = 0;
+    for ( size_t i = 0; i < program.size(); i++ )
+    {
+        if ( ( depthBefore[i] != UNKNOWN_DEPTH ) && ( depthBefore[i] != depth ) )
+        {
+            return false;
+        }
+        depthBefore[i] = depth;
+        const auto &operation = program[i];
+        switch ( operation.type )
+        {
+        case Operation::Type::CONSTANT:
+        case Operation::Type::LEAF:
+        case Operation::Type::FAIL:
+            // FAIL stands for the value of the sub expression it replaces
+            if ( depth >= maxStackSize )
+            {
+                return false;
+            }
+            depth++;
+            break;
+        case Operation::Type::JUMP_IF_FALSE:
+        case Operation::Type::JUMP_IF_TRUE:
+            if ( ( depth < 1 ) || ( operation.target <= i ) || ( operation.target > program.size() ) ||
+                 ( ( depthBefore[operation.target] != UNKNOWN_DEPTH ) && ( depthBefore[operation.target] != depth ) ) )
+            {
+                return false;
+            }
+            depthBefore[operation.target] = depth;
+            break;
+        case Operation::Type::NOT:
+            if ( depth < 1 )
+            {
+                return false;
+            }
+            break;
+        default:
+            if ( depth < 2 )
+            {
+                return false;
+            }
+            depth--;
+            break;
+        }
+    }
+    if ( ( depthBefore[program.size()] != UNKNOWN_DEPTH ) && ( depthBefore[program.size()] != depth ) )
+    {
+        return false;
+    }
+    depthBefore[program.size()] = depth;
+    return depth == 1;
+}
+
+uint32_t
+ConditionJit::add( const std::vector<Operation> &program, size_t maxStackSize )
+{
+    std::vector<size_t> depthBefore;
+    if ( ( !isSupported() ) || ( mExecutable != nullptr ) || program.empty() ||
+         ( maxStackSize > static_cast<size_t>( INT32_MAX / SLOT_SIZE ) ) ||
+         ( !getStackDepths( program, maxStackSize, depthBefore ) ) )
+    {
+        return INVALID_HANDLE;
+    }
+    auto slot = []( size_t index ) {
+        return static_cast<int32_t>( index ) * SLOT_SIZE;
+    };
+    auto functionOffset = mCode.size();
+    mExitJumps.clear();
+    // Offsets of the rel32 of the jumps with the index of their target operation
+    std::vector<std::pair<size_t, uint32_t>> jumps;
+    std::vector<size_t> operationOffsets( program.size() + 1 );
+
+    // push rbx; push r12; push r13 keeps the stack 16 byte aligned for the calls of the leaves
+    emit( { 0x53, 0x41, 0x54, 0x41, 0x55 } );
+    // mov rbx, rdi (context); mov r12, rsi (stack)
+    emit( { 0x48, 0x89, 0xFB, 0x49, 0x89, 0xF4 } );
+    for ( size_t i = 0; i < program.size(); i++ )
+    {
+        operationOffsets[i] = mCode.size();
+        const auto &operation = program[i];
+        auto depth = depthBefore[i];
+        switch ( operation.type )
+        {
+        case Operation::Type::CONSTANT:
+            // mov rax, value; mov [top], rax; mov byte [top + 8], boolValue
+            emit( { 0x48, 0xB8 } );
+            emit64( toBits( operation.value ) );
+            emitSlotAccess( {}, REX_W, { 0x89 }, RAX, slot( depth ) );
+            emitSlotAccess( {}, 0, { 0xC6 }, EXT_MOV_IMMEDIATE, slot( depth ) + BOOL_OFFSET );
+            mCode.push_back( operation.boolValue ? 1 : 0 );
+            break;
+        case Operation::Type::LEAF:
+            // mov rdi, rbx; mov rsi, leaf; lea rdx, [top]; mov rax, leafFunction; call rax
+            emit( { 0x48, 0x89, 0xDF, 0x48, 0xBE } );
+            emit64( toBits( operation.leaf ) );
+            emitSlotAccess( {}, REX_W, { 0x8D }, RDX, slot( depth ) );
+            emit( { 0x48, 0xB8 } );
+            emit64( toBits( mLeafFunction ) );
+            emit( { 0xFF, 0xD0 } );
+            // test eax, eax; jnz exit with the error in eax
+            emit( { 0x85, 0xC0 } );
+            emitJumpToExit( { 0x0F, 0x85 } );
+            break;
+        case Operation::Type::JUMP_IF_FALSE:
+        case Operation::Type::JUMP_IF_TRUE:
+            // cmp byte [top - 1 + 8], 0; skip the jump if the top does not decide the result
+            emitSlotAccess( {}, 0, { 0x80 }, EXT_CMP_IMMEDIATE, slot( depth - 1 ) + BOOL_OFFSET );
+            mCode.push_back( 0 );
+            // jne / je over the 12 bytes of the mov and the 5 bytes of the jmp
+            emit( { static_cast<uint8_t>( ( operation.type == Operation::Type::JUMP_IF_FALSE ) ? 0x75 : 0x74 ),
+                    17 } );
+            // Like the interpreter the result of the logical operator has no double value
+            emitSlotAccess( {}, REX_W, { 0xC7 }, EXT_MOV_IMMEDIATE, slot( depth - 1 ) );
+            emit32( 0 );
+            emit( { 0xE9 } );
+            jumps.emplace_back( mCode.size(), operation.target );
+            emit32( 0 );
+            break;
+        case Operation::Type::SMALLER:
+        case Operation::Type::BIGGER:
+        case Operation::Type::SMALLER_EQUAL:
+        case Operation::Type::BIGGER_EQUAL:
+        case Operation::Type::EQUAL:
+        {
+            auto left = slot( depth - 2 );
+            // movsd xmm0, [left]; movsd xmm1, [right]
+            emitSlotAccess( { 0xF2 }, 0, { 0x0F, 0x10 }, XMM0, left );
+            emitSlotAccess( { 0xF2 }, 0, { 0x0F, 0x10 }, XMM1, slot( depth - 1 ) );
+            // seta and setae are false for NaN like the C++ comparisons
+            switch ( operation.type )
+            {
+            case Operation::Type::SMALLER:
+                // ucomisd xmm1, xmm0; seta al
+                emit( { 0x66, 0x0F, 0x2E, 0xC8, 0x0F, 0x97, 0xC0 } );
+                break;
+            case Operation::Type::BIGGER:
+                // ucomisd xmm0, xmm1; seta al
+                emit( { 0x66, 0x0F, 0x2E, 0xC1, 0x0F, 0x97, 0xC0 } );
+                break;
+            case Operation::Type::SMALLER_EQUAL:
+                // ucomisd xmm1, xmm0; setae al
+                emit( { 0x66, 0x0F, 0x2E, 0xC8, 0x0F, 0x93, 0xC0 } );
+                break;
+            case Operation::Type::BIGGER_EQUAL:
+                // ucomisd xmm0, xmm1; setae al
+                emit( { 0x66, 0x0F, 0x2E, 0xC1, 0x0F, 0x93, 0xC0 } );
+                break;
+            default:
+                // subsd xmm0, xmm1; mov rax, ~sign; movq xmm1, rax; andpd xmm0, xmm1
+                emit( { 0xF2, 0x0F, 0x5C, 0xC1, 0x48, 0xB8 } );
+                emit64( 0x7FFFFFFFFFFFFFFFULL );
+                emit( { 0x66, 0x48, 0x0F, 0x6E, 0xC8, 0x66, 0x0F, 0x54, 0xC1 } );
+                // mov rax, equalDistance; movq xmm1, rax; ucomisd xmm1, xmm0; seta al
+                emit( { 0x48, 0xB8 } );
+                emit64( toBits( mEqualDistance ) );
+                emit( { 0x66, 0x48, 0x0F, 0x6E, 0xC8, 0x66, 0x0F, 0x2E, 0xC8, 0x0F, 0x97, 0xC0 } );
+                break;
+            }
+            // mov qword [left], 0; mov [left + 8], al
+            emitSlotAccess( {}, REX_W, { 0xC7 }, EXT_MOV_IMMEDIATE, left );
+            emit32( 0 );
+            emitSlotAccess( {}, 0, { 0x88 }, RAX, left + BOOL_OFFSET );
+            break;
+        }
+        case Operation::Type::AND:
+        case Operation::Type::OR:
+        case Operation::Type::NOT:
+        {
+            auto left = slot( depth - ( ( operation.type == Operation::Type::NOT ) ? 1 : 2 ) );
+            // mov al, [left + 8]
+            emitSlotAccess( {}, 0, { 0x8A }, RAX, left + BOOL_OFFSET );
+            if ( operation.type == Operation::Type::NOT )
+            {
+                // xor al, 1
+                emit( { 0x34, 0x01 } );
+            }
+            else
+            {
+                // and al, [right + 8] or or al, [right + 8], the bools are 0 or 1
+                emitSlotAccess( {},
+                                0,
+                                { static_cast<uint8_t>( ( operation.type == Operation::Type::AND ) ? 0x22 : 0x0A ) },
+                                RAX,
+                                slot( depth - 1 ) + BOOL_OFFSET );
+            }
+            emitSlotAccess( {}, REX_W, { 0xC7 }, EXT_MOV_IMMEDIATE, left );
+            emit32( 0 );
+            emitSlotAccess( {}, 0, { 0x88 }, RAX, left + BOOL_OFFSET );
+            break;
+        }
+        case Operation::Type::PLUS:
+        case Operation::Type::MINUS:
+        case Operation::Type::MULTIPLY:
+        case Operation::Type::DIVIDE:
+        {
+            auto left = slot( depth - 2 );
+            uint8_t opcode = 0x58;
+            if ( operation.type == Operation::Type::MINUS )
+            {
+                opcode = 0x5C;
+            }
+            else if ( operation.type == Operation::Type::MULTIPLY )
+            {
+                opcode = 0x59;
+            }
+            else if ( operation.type == Operation::Type::DIVIDE )
+            {
+                opcode = 0x5E;
+            }
+            // movsd xmm0, [left]; addsd / subsd / mulsd / divsd xmm0, [right]; movsd [left], xmm0
+            emitSlotAccess( { 0xF2 }, 0, { 0x0F, 0x10 }, XMM0, left );
+            emitSlotAccess( { 0xF2 }, 0, { 0x0F, opcode }, XMM0, slot( depth - 1 ) );
+            emitSlotAccess( { 0xF2 }, 0, { 0x0F, 0x11 }, XMM0, left );
+            // mov byte [left + 8], 0
+            emitSlotAccess( {}, 0, { 0xC6 }, EXT_MOV_IMMEDIATE, left + BOOL_OFFSET );
+            mCode.push_back( 0 );
+            break;
+        }
+        default:
+            // mov eax, error; jmp exit
+            emit( { 0xB8 } );
+            emit32( operation.error );
+            emitJumpToExit( { 0xE9 } );
+            break;
+        }
+    }
+    operationOffsets[program.size()] = mCode.size();
+    // xor eax, eax
+    emit( { 0x31, 0xC0 } );
+    auto exitOffset = mCode.size();
+    // pop r13; pop r12; pop rbx; ret
+    emit( { 0x41, 0x5D, 0x41, 0x5C, 0x5B, 0xC3 } );
+
+    auto patch = [this]( size_t position, size_t target ) {
+        auto relative = static_cast<int32_t>( static_cast<int64_t>( target ) - static_cast<int64_t>( position + 4 ) );
+        std::memcpy( &mCode[position], &relative, sizeof( relative ) );
+    };
+    for ( const auto &jump : jumps )
+    {
+        patch( jump.first, operationOffsets[jump.second] );
+    }
+    for ( auto position : mExitJumps )
+    {
+        patch( position, exitOffset );
+    }
+    mExitJumps.clear();
+    mFunctionOffsets.push_back( functionOffset );
+    return static_cast<uint32_t>( mFunctionOffsets.size() - 1 );
+}
+
+bool
+ConditionJit::finalize()
+{
+    if ( ( mExecutable != nullptr ) || mCode.empty() )
+    {
+        return mExecutable != nullptr;
+    }
+    auto pageSize = static_cast<size_t>( sysconf( _SC_PAGESIZE ) );
+    auto size = ( ( mCode.size() + pageSize - 1 ) / pageSize ) * pageSize;
+    // The code is copied into a writable mapping that is then made executable, it is never writable and executable
+    void *memory = mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+    if ( memory == MAP_FAILED )
+    {
+        return false;
+    }
+    std::memcpy( memory, mCode.data(), mCode.size() );
+    if ( mprotect( memory, size, PROT_READ | PROT_EXEC ) != 0 )
+    {
+        munmap( memory, size );
+        return false;
+    }
+    mExecutable = memory;
+    mExecutableSize = size;
+    return true;
+}
+
+ConditionJit::Function
+ConditionJit::getFunction( uint32_t handle ) const
+{
+    if ( ( mExecutable == nullptr ) || ( handle >= mFunctionOffsets.size() ) )
+    {
+        return nullptr;
+    }
+    return reinterpret_cast<Function>(
+        reinterpret_cast<uintptr_t>( static_cast<uint8_t *>( mExecutable ) + mFunctionOffsets[handle] ) );
+}
+
+void
+ConditionJit::clear()
+{
+    if ( mExecutable != nullptr )
+    {
+        munmap( mExecutable, mExecutableSize );
+        mExecutable = nullptr;
+        mExecutableSize = 0;
+    }
+    mCode.clear();
+    mFunctionOffsets.clear();
+    mExitJumps.clear();
+}
+
+} // namespace DataInspection
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -0,0 +1,118 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "DeepHistoryFile.h"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataInspection
+{
+
+constexpr uint32_t DeepHistoryFile::BLOCK_SAMPLES;
+
+static_assert( sizeof( DeepHistoryFile::Sample ) == 24, "Unexpected deep history sample size" );
+
+DeepHistoryFile::~DeepHistoryFile()
+{
+    close();
+}
+
+bool
+DeepHistoryFile::open( const std::string &directory, uint32_t capacity )
+{
+    close();
+    if ( capacity == 0 )
+    {
+        mLogger.error( "DeepHistoryFile::open", " Capacity must not be 0 " );
+        return false;
+    }
+    auto path = directory + "/fwe-deep-history-XXXXXX";
+    std::vector<char> pathTemplate( path.begin(), path.end() );
+    pathTemplate.push_back( '\0' );
+    int fd = mkstemp( pathTemplate.data() );
+    if ( fd < 0 )
+    {
+        mLogger.error( "DeepHistoryFile::open",
+                       " Failed to create a file in " + directory + ": " + std::string( strerror( errno ) ) );
+        return false;
+    }
+    // The mapping keeps the file alive, without a name it cannot be left behind by a crash
+    unlink( pathTemplate.data() );
+    auto blockCount = ( capacity + BLOCK_SAMPLES - 1 ) / BLOCK_SAMPLES;
+    auto bytes = static_cast<size_t>( blockCount ) * BLOCK_SAMPLES * sizeof( Sample );
+    // Writing to a sparse mapping on a full flash would raise SIGBUS, so the space is allocated now
+    int result = posix_fallocate( fd, 0, static_cast<off_t>( bytes ) );
+    if ( result != 0 )
+    {
+        mLogger.error( "DeepHistoryFile::open",
+                       " Failed to allocate " + std::to_string( bytes ) + " Bytes in " + directory + ": " +
+                           std::string( strerror( result ) ) );
+        ::close( fd );
+        return false;
+    }
+    auto *mapping = mmap( nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+    ::close( fd );
+    if ( mapping == MAP_FAILED )
+    {
+        mLogger.error( "DeepHistoryFile::open", " Failed to map a file in " + directory );
+        return false;
+    }
+    // Blocks are written in order, the kernel can write them back in order too
+    (void)madvise( mapping, bytes, MADV_SEQUENTIAL );
+    mSamples = static_cast<Sample *>( mapping );
+    mMappedBytes = bytes;
+    mCapacity = capacity;
+    mBlockCount = blockCount;
+    return true;
+}
+
+void
+DeepHistoryFile::close()
+{
+    if ( mSamples != nullptr )
+    {
+        munmap( mSamples, mMappedBytes );
+        mSamples = nullptr;
+    }
+    mMappedBytes = 0;
+    mCapacity = 0;
+    mBlockCount = 0;
+    mNextBlock = 0;
+    mStoredBlocks = 0;
+    mStagedSamples = 0;
+}
+
+void
+DeepHistoryFile::writeStagingBlock()
+{
+    std::memcpy( &mSamples[static_cast<size_t>( mNextBlock ) * BLOCK_SAMPLES],
+                 mStagingBlock.data(),
+                 sizeof( mStagingBlock ) );
+    mNextBlock = ( mNextBlock + 1 ) % mBlockCount;
+    mStoredBlocks = std::min( mStoredBlocks + 1, mBlockCount );
+    mStagedSamples = 0;
+}
+
+} // namespace DataInspection
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -0,0 +1,117 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "EvaluationScheduler.h"
+#include "TraceModule.h"
+#include <algorithm>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataInspection
+{
+using Aws::IoTFleetWise::Platform::Linux::TraceModule;
+
+EvaluationScheduler::EvaluationScheduler( uint32_t minimumSpacingMs, uint32_t idleTimeMs )
+    : mMinimumSpacingMs( minimumSpacingMs )
+    , mIdleTimeMs( idleTimeMs )
+{
+}
+
+Timestamp
+EvaluationScheduler::getEarliestEvaluationTime( Timestamp nextEvaluationTime ) const
+{
+    if ( !mEvaluated )
+    {
+        return nextEvaluationTime;
+    }
+    // Without work the conditions are still evaluated once per idle time, as before the deadlines existed
+    auto dueTime = std::min( nextEvaluationTime, mLastEvaluation + mIdleTimeMs );
+    return std::max( dueTime, mLastEvaluation + mMinimumSpacingMs );
+}
+
+bool
+EvaluationScheduler::isEvaluationDue( Timestamp currentTime, Timestamp nextEvaluationTime ) const
+{
+    return getEarliestEvaluationTime( nextEvaluationTime ) <= currentTime;
+}
+
+void
+EvaluationScheduler::onEvaluated( Timestamp currentTime )
+{
+    if ( mOldestPendingInput != NO_DEADLINE )
+    {
+        auto latency = ( currentTime > mOldestPendingInput ) ? ( currentTime - mOldestPendingInput ) : 0;
+        mLatencyHistogram[getLatencyBucket( latency )]++;
+        mOldestPendingInput = NO_DEADLINE;
+    }
+    mLastEvaluation = currentTime;
+    mEvaluated = true;
+}
+
+uint32_t
+EvaluationScheduler::getWaitTimeMs( Timestamp currentTime, Timestamp nextEvaluationTime ) const
+{
+    auto dueTime = getEarliestEvaluationTime( nextEvaluationTime );
+    if ( dueTime <= currentTime )
+    {
+        return 0;
+    }
+    return static_cast<uint32_t>( std::min<Timestamp>( dueTime - currentTime, mIdleTimeMs ) );
+}
+
+size_t
+EvaluationScheduler::getLatencyBucket( Timestamp latencyMs )
+{
+    size_t bucket = 0;
+    // Bucket n > 0 holds latencies below 2^n ms
+    while ( ( bucket < LATENCY_BUCKETS - 1 ) && ( latencyMs >= ( Timestamp{ 1 } << bucket ) ) )
+    {
+        bucket++;
+    }
+    return bucket;
+}
+
+std::string
+EvaluationScheduler::getLatencyBucketName( size_t bucket )
+{
+    if ( bucket == 0 )
+    {
+        return "inspectionLatency_0ms";
+    }
+    if ( bucket >= LATENCY_BUCKETS - 1 )
+    {
+        return "inspectionLatency_" + std::to_string( 1U << ( LATENCY_BUCKETS - 2 ) ) + "msOrMore";
+    }
+    return "inspectionLatency_below" + std::to_string( 1U << bucket ) + "ms";
+}
+
+void
+EvaluationScheduler::publishLatencyHistogram()
+{
+    for ( size_t bucket = 0; bucket < LATENCY_BUCKETS; bucket++ )
+    {
+        auto added = mLatencyHistogram[bucket] - mPublishedLatencyHistogram[bucket];
+        if ( added > 0 )
+        {
+            TraceModule::get().addToNamedVariable( getLatencyBucketName( bucket ), static_cast<int64_t>( added ) );
+            mPublishedLatencyHistogram[bucket] = mLatencyHistogram[bucket];
+        }
+    }
+}
+
+} // namespace DataInspection
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -0,0 +1,197 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "PipelineLoadController.h"
+#include "TraceModule.h"
+#include <algorithm>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataInspection
+{
+
+PipelineLoadController::PipelineLoadController( LoadSheddingConfig config )
+    : mConfig( config )
+{
+    mConfig.highWatermark = std::max( mConfig.lowWatermark, mConfig.highWatermark );
+    mConfig.criticalWatermark = std::max( mConfig.highWatermark, mConfig.criticalWatermark );
+    mConfig.rawFrameKeepInterval = std::max( 1U, mConfig.rawFrameKeepInterval );
+    mConfig.samplingPeriodMs = std::max( 1U, mConfig.samplingPeriodMs );
+}
+
+PipelineLoadController::~PipelineLoadController()
+{
+    // To make sure the thread stops during teardown of tests.
+    if ( isAlive() )
+    {
+        stop();
+    }
+}
+
+void
+PipelineLoadController::registerQueue( const std::string &name, OccupancyFunction occupancy, size_t capacity )
+{
+    if ( capacity == 0 )
+    {
+        return;
+    }
+    WatchedQueue queue;
+    queue.name = name;
+    queue.occupancy = std::move( occupancy );
+    queue.capacity = capacity;
+    mQueues.emplace_back( std::move( queue ) );
+}
+
+bool
+PipelineLoadController::start()
+{
+    // Prevent concurrent stop/init
+    std::lock_guard<std::mutex> lock( mThreadMutex );
+    if ( mExecutor != nullptr )
+    {
+        mQueueId = mExecutor->createQueue( 1 );
+        if ( !mExecutor->post( mQueueId, [this]() { runPeriodicTask(); } ) )
+        {
+            mExecutor->removeQueue( mQueueId );
+            mQueueId = SerialTaskExecutor::INVALID_QUEUE_ID;
+            mLogger.trace( "PipelineLoadController::start", " Load controller failed to start on the executor " );
+            return false;
+        }
+        mLogger.trace( "PipelineLoadController::start", " Load controller started on the executor " );
+        return true;
+    }
+    // On multi core systems the shared variable mShouldStop must be updated for
+    // all cores before starting the thread otherwise thread will directly end
+    mShouldStop.store( false );
+    if ( !mThread.create( doWork, this, "fwDILoadCtrl" ) )
+    {
+        mLogger.trace( "PipelineLoadController::start", " Load controller thread failed to start " );
+        return false;
+    }
+    mLogger.trace( "PipelineLoadController::start", " Load controller thread started " );
+    return true;
+}
+
+bool
+PipelineLoadController::stop()
+{
+    std::lock_guard<std::mutex> lock( mThreadMutex );
+    if ( mExecutor != nullptr )
+    {
+        // Drops the next evaluation without waiting for it
+        mExecutor->removeQueue( mQueueId );
+        mQueueId = SerialTaskExecutor::INVALID_QUEUE_ID;
+        mLevel.store( LoadSheddingLevel::NONE, std::memory_order_relaxed );
+        return true;
+    }
+    mShouldStop.store( true, std::memory_order_relaxed );
+    mWait.notify();
+    mThread.release();
+    mShouldStop.store( false, std::memory_order_relaxed );
+    // The consumers must not keep shedding after the controller stopped
+    mLevel.store( LoadSheddingLevel::NONE, std::memory_order_relaxed );
+    return !mThread.isActive();
+}
+
+bool
+PipelineLoadController::isAlive()
+{
+    if ( mExecutor != nullptr )
+    {
+        return ( mQueueId != SerialTaskExecutor::INVALID_QUEUE_ID ) && mExecutor->isAlive();
+    }
+    return mThread.isValid() && mThread.isActive();
+}
+
+bool
+PipelineLoadController::shouldStop() const
+{
+    return mShouldStop.load( std::memory_order_relaxed );
+}
+
+LoadSheddingLevel
+PipelineLoadController::nextLevel( double fillRatio ) const
+{
+    if ( fillRatio >= mConfig.criticalWatermark )
+    {
+        return LoadSheddingLevel::RAW_CAN_FRAMES;
+    }
+    auto level = getLevel();
+    // Every level is only left below the watermark of the level before, so that the level does not toggle with
+    // every evaluation around a watermark
+    if ( fillRatio >= mConfig.highWatermark )
+    {
+        return ( level == LoadSheddingLevel::RAW_CAN_FRAMES ) ? LoadSheddingLevel::RAW_CAN_FRAMES
+                                                              : LoadSheddingLevel::LOW_PRIORITY_SIGNALS;
+    }
+    if ( ( level != LoadSheddingLevel::NONE ) && ( fillRatio >= mConfig.lowWatermark ) )
+    {
+        return LoadSheddingLevel::LOW_PRIORITY_SIGNALS;
+    }
+    return LoadSheddingLevel::NONE;
+}
+
+LoadSheddingLevel
+PipelineLoadController::evaluate()
+{
+    double maxFillRatio = 0.0;
+    const WatchedQueue *fullestQueue = nullptr;
+    for ( const auto &queue : mQueues )
+    {
+        auto fillRatio = static_cast<double>( queue.occupancy() ) / static_cast<double>( queue.capacity );
+        if ( ( fullestQueue == nullptr ) || ( fillRatio > maxFillRatio ) )
+        {
+            maxFillRatio = fillRatio;
+            fullestQueue = &queue;
+        }
+    }
+    auto previousLevel = getLevel();
+    auto level = nextLevel( maxFillRatio );
+    if ( level != previousLevel )
+    {
+        mLevel.store( level, std::memory_order_relaxed );
+        mLogger.info( "PipelineLoadController::evaluate",
+                      "Load shedding level changed from " + std::to_string( toUType( previousLevel ) ) + " to " +
+                          std::to_string( toUType( level ) ) + ", fullest queue " +
+                          ( ( fullestQueue != nullptr ) ? fullestQueue->name : std::string() ) + " at " +
+                          std::to_string( static_cast<uint32_t>( maxFillRatio * 100.0 ) ) + "%" );
+    }
+    TraceModule::get().setVariable( TraceVariable::LOAD_SHEDDING_LEVEL, toUType( level ) );
+    return level;
+}
+
+void
+PipelineLoadController::runPeriodicTask()
+{
+    evaluate();
+    // Rejected once stop removed the queue
+    mExecutor->postAfter( mQueueId, mConfig.samplingPeriodMs, [this]() { runPeriodicTask(); } );
+}
+
+void
+PipelineLoadController::doWork( void *data )
+{
+    auto *controller = static_cast<PipelineLoadController *>( data );
+    while ( !controller->shouldStop() )
+    {
+        controller->evaluate();
+        controller->mWait.wait( controller->mConfig.samplingPeriodMs );
+    }
+}
+
+} // namespace DataInspection
+} // namespace IoTFleetWise
+} // namespace Aws
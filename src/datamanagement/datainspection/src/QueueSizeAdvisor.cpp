@@ -0,0 +1,318 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "QueueSizeAdvisor.h"
+#include "CacheAndPersist.h"
+#include "TraceModule.h"
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataInspection
+{
+
+constexpr uint32_t QueueSizeAdvisor::PUBLISH_INTERVAL_MS;
+constexpr const char *QueueSizeAdvisor::FILE_HEADER;
+
+namespace
+{
+size_t
+scaleSize( size_t size, double factor )
+{
+    return static_cast<size_t>( std::ceil( static_cast<double>( size ) * factor ) );
+}
+} // namespace
+
+QueueSizeAdvisor::QueueSizeAdvisor( QueueSizingConfig config, std::shared_ptr<ICacheAndPersist> persistency )
+    : mConfig( config )
+    , mPersistency( std::move( persistency ) )
+{
+    mConfig.headroom = std::max( 1.0, mConfig.headroom );
+    mConfig.growthFactor = std::max( 1.0, mConfig.growthFactor );
+    mConfig.maxShrinkFactor = std::min( 1.0, std::max( 0.0, mConfig.maxShrinkFactor ) );
+    mConfig.minimumSize = std::max<size_t>( 1U, mConfig.minimumSize );
+    mConfig.samplingPeriodMs = std::max( 1U, mConfig.samplingPeriodMs );
+}
+
+QueueSizeAdvisor::~QueueSizeAdvisor()
+{
+    // To make sure the thread stops during teardown of tests.
+    if ( isAlive() )
+    {
+        stop();
+    }
+}
+
+bool
+QueueSizeAdvisor::load()
+{
+    mPersistedSizes.clear();
+    if ( mPersistency == nullptr )
+    {
+        return false;
+    }
+    size_t size = mPersistency->getSize( DataType::QUEUE_SIZES );
+    if ( ( size == 0 ) || ( size == INVALID_FILE_SIZE ) )
+    {
+        return false;
+    }
+    std::string data( size, '\0' );
+    if ( mPersistency->read( reinterpret_cast<uint8_t *>( &data[0] ), size, DataType::QUEUE_SIZES ) !=
+         ErrorCode::SUCCESS )
+    {
+        mLogger.warn( "QueueSizeAdvisor::load", "Failed to read the persisted queue sizes" );
+        return false;
+    }
+    std::istringstream stream( data );
+    std::string header;
+    if ( ( !std::getline( stream, header ) ) || ( header != FILE_HEADER ) )
+    {
+        mLogger.warn( "QueueSizeAdvisor::load", "Ignoring queue sizes of another version" );
+        return false;
+    }
+    std::string name;
+    size_t queueSize = 0;
+    while ( stream >> name >> queueSize )
+    {
+        if ( queueSize > 0 )
+        {
+            mPersistedSizes[name] = queueSize;
+        }
+    }
+    mLogger.info( "QueueSizeAdvisor::load",
+                  "Loaded the sizes of " + std::to_string( mPersistedSizes.size() ) + " queues of the previous run" );
+    return !mPersistedSizes.empty();
+}
+
+size_t
+QueueSizeAdvisor::getSize( const std::string &name, size_t configuredSize ) const
+{
+    auto it = mPersistedSizes.find( name );
+    return ( it != mPersistedSizes.end() ) ? it->second : configuredSize;
+}
+
+void
+QueueSizeAdvisor::registerQueue(
+    const std::string &name, CountFunction occupancy, CountFunction dropped, size_t capacity, size_t elementBytes )
+{
+    TrackedQueue queue;
+    queue.name = name;
+    queue.occupancy = std::move( occupancy );
+    queue.dropped = std::move( dropped );
+    queue.capacity = capacity;
+    queue.elementBytes = elementBytes;
+    // Only the data dropped from now on is caused by this size
+    queue.droppedAtStart = getDropped( queue );
+    mQueues.emplace_back( std::move( queue ) );
+}
+
+uint64_t
+QueueSizeAdvisor::getDropped( const TrackedQueue &queue ) const
+{
+    return queue.dropped ? queue.dropped() : 0;
+}
+
+bool
+QueueSizeAdvisor::start()
+{
+    // Prevent concurrent stop/init
+    std::lock_guard<std::mutex> lock( mThreadMutex );
+    mPublishTimer.reset();
+    mPersistTimer.reset();
+    if ( mExecutor != nullptr )
+    {
+        mQueueId = mExecutor->createQueue( 1 );
+        if ( !mExecutor->post( mQueueId, [this]() { runPeriodicTask(); } ) )
+        {
+            mExecutor->removeQueue( mQueueId );
+            mQueueId = SerialTaskExecutor::INVALID_QUEUE_ID;
+            mLogger.trace( "QueueSizeAdvisor::start", " Queue size advisor failed to start on the executor " );
+            return false;
+        }
+        mLogger.trace( "QueueSizeAdvisor::start", " Queue size advisor started on the executor " );
+        return true;
+    }
+    // On multi core systems the shared variable mShouldStop must be updated for
+    // all cores before starting the thread otherwise thread will directly end
+    mShouldStop.store( false );
+    if ( !mThread.create( doWork, this, "fwDIQueueSize" ) )
+    {
+        mLogger.trace( "QueueSizeAdvisor::start", " Queue size advisor thread failed to start " );
+        return false;
+    }
+    mLogger.trace( "QueueSizeAdvisor::start", " Queue size advisor thread started " );
+    return true;
+}
+
+bool
+QueueSizeAdvisor::stop()
+{
+    std::lock_guard<std::mutex> lock( mThreadMutex );
+    if ( mExecutor != nullptr )
+    {
+        // Drops the next run without waiting for it
+        mExecutor->removeQueue( mQueueId );
+        mQueueId = SerialTaskExecutor::INVALID_QUEUE_ID;
+        persist();
+        return true;
+    }
+    mShouldStop.store( true, std::memory_order_relaxed );
+    mWait.notify();
+    mThread.release();
+    mShouldStop.store( false, std::memory_order_relaxed );
+    // The last samples are the most complete picture of this run
+    persist();
+    return !mThread.isActive();
+}
+
+bool
+QueueSizeAdvisor::isAlive()
+{
+    if ( mExecutor != nullptr )
+    {
+        return ( mQueueId != SerialTaskExecutor::INVALID_QUEUE_ID ) && mExecutor->isAlive();
+    }
+    return mThread.isValid() && mThread.isActive();
+}
+
+bool
+QueueSizeAdvisor::shouldStop() const
+{
+    return mShouldStop.load( std::memory_order_relaxed );
+}
+
+void
+QueueSizeAdvisor::sample()
+{
+    for ( auto &queue : mQueues )
+    {
+        queue.highWater = std::max( queue.highWater, static_cast<size_t>( queue.occupancy() ) );
+    }
+}
+
+std::map<std::string, size_t>
+QueueSizeAdvisor::recommend()
+{
+    std::map<std::string, size_t> sizes;
+    size_t totalBytes = 0;
+    for ( const auto &queue : mQueues )
+    {
+        auto size = scaleSize( queue.highWater, mConfig.headroom );
+        if ( getDropped( queue ) > queue.droppedAtStart )
+        {
+            size = std::max( size, scaleSize( queue.capacity, mConfig.growthFactor ) );
+        }
+        // A quiet run, e.g. while the vehicle was parked, must not shrink a queue needed while driving at once
+        size = std::max( size, scaleSize( queue.capacity, mConfig.maxShrinkFactor ) );
+        size = std::max( size, mConfig.minimumSize );
+        sizes[queue.name] = size;
+        totalBytes += size * queue.elementBytes;
+    }
+    if ( ( mConfig.memoryCeilingBytes > 0 ) && ( totalBytes > mConfig.memoryCeilingBytes ) )
+    {
+        // All queues give up the same share, so their ratio to each other stays as observed
+        auto factor = static_cast<double>( mConfig.memoryCeilingBytes ) / static_cast<double>( totalBytes );
+        for ( auto &size : sizes )
+        {
+            size.second = std::max( mConfig.minimumSize,
+                                    static_cast<size_t>( std::floor( static_cast<double>( size.second ) * factor ) ) );
+        }
+    }
+    for ( const auto &queue : mQueues )
+    {
+        auto &trace = TraceModule::get();
+        trace.setNamedVariable( "queueCapacity_" + queue.name, static_cast<int64_t>( queue.capacity ) );
+        trace.setNamedVariable( "queueHighWater_" + queue.name, static_cast<int64_t>( queue.highWater ) );
+        trace.setNamedVariable( "queueDropped_" + queue.name,
+                                static_cast<int64_t>( getDropped( queue ) - queue.droppedAtStart ) );
+        trace.setNamedVariable( "queueRecommendedSize_" + queue.name, static_cast<int64_t>( sizes[queue.name] ) );
+    }
+    return sizes;
+}
+
+bool
+QueueSizeAdvisor::persist()
+{
+    if ( ( mPersistency == nullptr ) || mQueues.empty() )
+    {
+        return false;
+    }
+    auto sizes = recommend();
+    std::string data = std::string( FILE_HEADER ) + "\n";
+    for ( const auto &queue : mQueues )
+    {
+        data += queue.name + " " + std::to_string( sizes[queue.name] ) + "\n";
+        mLogger.info( "QueueSizeAdvisor::persist",
+                      "Queue " + queue.name + " capacity " + std::to_string( queue.capacity ) + " high-water " +
+                          std::to_string( queue.highWater ) + " dropped " +
+                          std::to_string( getDropped( queue ) - queue.droppedAtStart ) + " next size " +
+                          std::to_string( sizes[queue.name] ) );
+    }
+    auto ret =
+        mPersistency->write( reinterpret_cast<const uint8_t *>( data.data() ), data.size(), DataType::QUEUE_SIZES );
+    if ( ret != ErrorCode::SUCCESS )
+    {
+        mLogger.warn( "QueueSizeAdvisor::persist",
+                      "Failed to persist the queue sizes: " + std::string( mPersistency->getErrorString( ret ) ) );
+        return false;
+    }
+    return true;
+}
+
+void
+QueueSizeAdvisor::runOnce()
+{
+    sample();
+    if ( mPublishTimer.getElapsedMs().count() >= static_cast<int64_t>( PUBLISH_INTERVAL_MS ) )
+    {
+        mPublishTimer.reset();
+        auto persistIntervalMs = static_cast<int64_t>( mConfig.persistIntervalMs );
+        if ( ( persistIntervalMs > 0 ) && ( mPersistTimer.getElapsedMs().count() >= persistIntervalMs ) )
+        {
+            mPersistTimer.reset();
+            persist();
+        }
+        else
+        {
+            recommend();
+        }
+    }
+}
+
+void
+QueueSizeAdvisor::runPeriodicTask()
+{
+    runOnce();
+    // Rejected once stop removed the queue
+    mExecutor->postAfter( mQueueId, mConfig.samplingPeriodMs, [this]() { runPeriodicTask(); } );
+}
+
+void
+QueueSizeAdvisor::doWork( void *data )
+{
+    auto *advisor = static_cast<QueueSizeAdvisor *>( data );
+    while ( !advisor->shouldStop() )
+    {
+        advisor->runOnce();
+        advisor->mWait.wait( advisor->mConfig.samplingPeriodMs );
+    }
+}
+
+} // namespace DataInspection
+} // namespace IoTFleetWise
+} // namespace Aws
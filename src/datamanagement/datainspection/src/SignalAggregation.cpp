@@ -0,0 +1,236 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "SignalAggregation.h"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataInspection
+{
+
+constexpr double QuantileSketch::RELATIVE_ACCURACY;
+constexpr size_t QuantileSketch::MAX_BUCKETS;
+constexpr double QuantileSketch::MIN_MAGNITUDE;
+constexpr size_t SignalAggregator::MAX_PENDING_SUMMARIES;
+
+QuantileSketch::QuantileSketch()
+    : mGamma( ( 1.0 + RELATIVE_ACCURACY ) / ( 1.0 - RELATIVE_ACCURACY ) )
+    , mLogGamma( std::log( mGamma ) )
+{
+}
+
+int32_t
+QuantileSketch::getIndex( double magnitude ) const
+{
+    return static_cast<int32_t>( std::ceil( std::log( magnitude ) / mLogGamma ) );
+}
+
+double
+QuantileSketch::getMagnitude( int32_t index ) const
+{
+    // The value in the bucket with the same relative distance to both bounds
+    return 2.0 * std::pow( mGamma, index ) / ( mGamma + 1.0 );
+}
+
+void
+QuantileSketch::addToBuckets( std::map<int32_t, uint32_t> &buckets, int32_t index )
+{
+    buckets[index]++;
+    if ( buckets.size() > MAX_BUCKETS )
+    {
+        auto lowest = buckets.begin();
+        std::next( lowest )->second += lowest->second;
+        buckets.erase( lowest );
+    }
+}
+
+void
+QuantileSketch::add( double value )
+{
+    if ( !std::isfinite( value ) )
+    {
+        return;
+    }
+    mCount++;
+    if ( value > MIN_MAGNITUDE )
+    {
+        addToBuckets( mPositiveBuckets, getIndex( value ) );
+    }
+    else if ( value < -MIN_MAGNITUDE )
+    {
+        addToBuckets( mNegativeBuckets, getIndex( -value ) );
+    }
+    else
+    {
+        mZeroCount++;
+    }
+}
+
+double
+QuantileSketch::getQuantile( double quantile ) const
+{
+    if ( mCount == 0 )
+    {
+        return 0.0;
+    }
+    auto rank = static_cast<uint64_t>( std::max( 0.0, std::min( quantile, 1.0 ) ) * static_cast<double>( mCount - 1 ) );
+    uint64_t count = 0;
+    // Ascending values: the negative values from the largest magnitude, 0, then the positive values
+    for ( auto it = mNegativeBuckets.rbegin(); it != mNegativeBuckets.rend(); it++ )
+    {
+        count += it->second;
+        if ( count > rank )
+        {
+            return -getMagnitude( it->first );
+        }
+    }
+    count += mZeroCount;
+    if ( count > rank )
+    {
+        return 0.0;
+    }
+    for ( const auto &bucket : mPositiveBuckets )
+    {
+        count += bucket.second;
+        if ( count > rank )
+        {
+            return getMagnitude( bucket.first );
+        }
+    }
+    return getMagnitude( mPositiveBuckets.rbegin()->first );
+}
+
+void
+QuantileSketch::clear()
+{
+    mPositiveBuckets.clear();
+    mNegativeBuckets.clear();
+    mZeroCount = 0;
+    mCount = 0;
+}
+
+SignalAggregator::SignalAggregator( SignalID signalID,
+                                    uint32_t conditionIndex,
+                                    std::shared_ptr<const SignalAggregationInfo> info )
+    : mSignalID( signalID )
+    , mConditionIndex( conditionIndex )
+    , mInfo( std::move( info ) )
+{
+    if ( !mInfo->histogramBounds.empty() )
+    {
+        mHistogramCounts.resize( mInfo->histogramBounds.size() + 1 );
+    }
+}
+
+void
+SignalAggregator::addValue( double value )
+{
+    if ( mInfo->variance )
+    {
+        mVarianceCount++;
+        auto delta = value - mVarianceMean;
+        mVarianceMean += delta / static_cast<double>( mVarianceCount );
+        mSquaredDistanceSum += delta * ( value - mVarianceMean );
+    }
+    if ( !mHistogramCounts.empty() )
+    {
+        // The bounds are inclusive, values above the last bound are counted in the last bucket
+        auto bucket = std::lower_bound( mInfo->histogramBounds.begin(), mInfo->histogramBounds.end(), value ) -
+                      mInfo->histogramBounds.begin();
+        mHistogramCounts[static_cast<size_t>( bucket )]++;
+    }
+    if ( !mInfo->percentiles.empty() )
+    {
+        mSketch.add( value );
+    }
+}
+
+void
+SignalAggregator::finishWindow(
+    Timestamp windowStart, uint32_t windowSizeMs, uint32_t count, double min, double max, double sum )
+{
+    if ( mSkipWindow || ( count == 0 ) )
+    {
+        clearWindow();
+        return;
+    }
+    if ( mSummaries.size() >= MAX_PENDING_SUMMARIES )
+    {
+        mSummaries.erase( mSummaries.begin() );
+    }
+    mSummaries.emplace_back();
+    auto &summary = mSummaries.back();
+    summary.signalID = mSignalID;
+    summary.windowStartTime = windowStart;
+    summary.windowSizeMs = windowSizeMs;
+    summary.count = mInfo->count ? count : 0;
+    summary.min = mInfo->min ? min : 0.0;
+    summary.max = mInfo->max ? max : 0.0;
+    summary.mean = mInfo->mean ? ( sum / static_cast<double>( count ) ) : 0.0;
+    if ( mInfo->variance && ( mVarianceCount > 0 ) )
+    {
+        summary.variance = mSquaredDistanceSum / static_cast<double>( mVarianceCount );
+    }
+    summary.histogramCounts = mHistogramCounts;
+    for ( auto percentile : mInfo->percentiles )
+    {
+        summary.percentileValues.emplace_back( mSketch.getQuantile( percentile / 100.0 ) );
+    }
+    clearWindow();
+}
+
+void
+SignalAggregator::clearWindow()
+{
+    mSkipWindow = false;
+    mVarianceCount = 0;
+    mVarianceMean = 0.0;
+    mSquaredDistanceSum = 0.0;
+    std::fill( mHistogramCounts.begin(), mHistogramCounts.end(), 0 );
+    mSketch.clear();
+}
+
+void
+SignalAggregator::takeOver( const SignalAggregator &previous )
+{
+    auto conditionIndex = mConditionIndex;
+    auto info = mInfo;
+    *this = previous;
+    mConditionIndex = conditionIndex;
+    mInfo = std::move( info );
+}
+
+void
+SignalAggregator::takeSummaries( std::vector<SignalSummary> &out )
+{
+    std::move( mSummaries.begin(), mSummaries.end(), std::back_inserter( out ) );
+    mSummaries.clear();
+}
+
+bool
+SignalAggregator::isSameAggregation( const SignalAggregationInfo &a, const SignalAggregationInfo &b )
+{
+    return ( a.count == b.count ) && ( a.min == b.min ) && ( a.max == b.max ) && ( a.mean == b.mean ) &&
+           ( a.variance == b.variance ) && ( a.histogramBounds == b.histogramBounds ) &&
+           ( a.percentiles == b.percentiles );
+}
+
+} // namespace DataInspection
+} // namespace IoTFleetWise
+} // namespace Aws
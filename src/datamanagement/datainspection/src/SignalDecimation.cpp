@@ -0,0 +1,213 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "SignalDecimation.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataInspection
+{
+namespace
+{
+/**
+ * @brief Moves the kept samples to the front of the range. The samples must be kept in the order of time, so that
+ * a sample is never written to a position that is still read.
+ */
+class SampleCompactor
+{
+public:
+    SampleCompactor( CollectedSignal *samples, size_t count )
+        : mSamples( samples )
+        , mTimeOrigin( ( count > 0 ) ? samples[0].receiveTime : 0 )
+    {
+    }
+
+    // Microseconds since the first sample, which keeps the precision of a double
+    double
+    getTime( size_t index ) const
+    {
+        return ( static_cast<double>( mSamples[index].receiveTime - mTimeOrigin ) * 1000.0 ) +
+               static_cast<double>( mSamples[index].receiveTimeFractionUs );
+    }
+
+    double
+    getValue( size_t index ) const
+    {
+        return mSamples[index].value;
+    }
+
+    void
+    keep( size_t index )
+    {
+        if ( ( mKeptCount > 0 ) && ( index <= mLastKept ) )
+        {
+            return;
+        }
+        mSamples[mKeptCount++] = mSamples[index];
+        mLastKept = index;
+    }
+
+    size_t
+    getKeptCount() const
+    {
+        return mKeptCount;
+    }
+
+private:
+    CollectedSignal *mSamples;
+    Timestamp mTimeOrigin;
+    size_t mKeptCount{ 0 };
+    size_t mLastKept{ 0 };
+};
+
+void
+decimateLargestTriangleThreeBuckets( SampleCompactor &compactor, size_t count, size_t maxSamples )
+{
+    compactor.keep( 0 );
+    // The first and the last sample are kept, the samples between them are split into maxSamples - 2 buckets
+    auto bucketSize = static_cast<double>( count - 2 ) / static_cast<double>( maxSamples - 2 );
+    auto previousTime = compactor.getTime( 0 );
+    auto previousValue = compactor.getValue( 0 );
+    for ( size_t bucket = 0; bucket + 2 < maxSamples; bucket++ )
+    {
+        auto start = static_cast<size_t>( std::floor( static_cast<double>( bucket ) * bucketSize ) ) + 1;
+        auto end = static_cast<size_t>( std::floor( static_cast<double>( bucket + 1 ) * bucketSize ) ) + 1;
+        // The next bucket is only represented by its average, the last bucket is followed by the last sample
+        auto nextEnd = std::min(
+            static_cast<size_t>( std::floor( static_cast<double>( bucket + 2 ) * bucketSize ) ) + 1, count );
+        double averageTime = 0.0;
+        double averageValue = 0.0;
+        for ( auto i = end; i < nextEnd; i++ )
+        {
+            averageTime += compactor.getTime( i );
+            averageValue += compactor.getValue( i );
+        }
+        averageTime /= static_cast<double>( nextEnd - end );
+        averageValue /= static_cast<double>( nextEnd - end );
+
+        auto selected = start;
+        double largestArea = -1.0;
+        for ( auto i = start; i < end; i++ )
+        {
+            // Twice the area of the triangle, which does not change the order
+            auto area = std::abs( ( ( previousTime - averageTime ) * ( compactor.getValue( i ) - previousValue ) ) -
+                                  ( ( previousTime - compactor.getTime( i ) ) * ( averageValue - previousValue ) ) );
+            if ( area > largestArea )
+            {
+                largestArea = area;
+                selected = i;
+            }
+        }
+        previousTime = compactor.getTime( selected );
+        previousValue = compactor.getValue( selected );
+        compactor.keep( selected );
+    }
+    compactor.keep( count - 1 );
+}
+
+void
+decimateMinMax( SampleCompactor &compactor, size_t count, size_t maxSamples )
+{
+    auto bucketCount = static_cast<uint64_t>( maxSamples / 2 );
+    for ( uint64_t bucket = 0; bucket < bucketCount; bucket++ )
+    {
+        auto start = static_cast<size_t>( ( bucket * count ) / bucketCount );
+        auto end = static_cast<size_t>( ( ( bucket + 1 ) * count ) / bucketCount );
+        auto minIndex = start;
+        auto maxIndex = start;
+        for ( auto i = start + 1; i < end; i++ )
+        {
+            if ( compactor.getValue( i ) < compactor.getValue( minIndex ) )
+            {
+                minIndex = i;
+            }
+            if ( compactor.getValue( i ) > compactor.getValue( maxIndex ) )
+            {
+                maxIndex = i;
+            }
+        }
+        compactor.keep( std::min( minIndex, maxIndex ) );
+        compactor.keep( std::max( minIndex, maxIndex ) );
+    }
+}
+
+void
+decimateUniform( SampleCompactor &compactor, size_t count, size_t maxSamples )
+{
+    auto step = compactor.getTime( count - 1 ) / static_cast<double>( maxSamples - 1 );
+    size_t current = 0;
+    for ( size_t point = 0; point < maxSamples; point++ )
+    {
+        auto gridTime = static_cast<double>( point ) * step;
+        while ( ( current + 1 < count ) && ( compactor.getTime( current + 1 ) <= gridTime ) )
+        {
+            current++;
+        }
+        // The grid point is between the current and the next sample
+        auto selected = current;
+        if ( ( current + 1 < count ) &&
+             ( compactor.getTime( current + 1 ) - gridTime < gridTime - compactor.getTime( current ) ) )
+        {
+            selected = current + 1;
+        }
+        compactor.keep( selected );
+        // The following grid points are not closer to an earlier sample, whose position may be overwritten now
+        current = selected;
+    }
+}
+} // namespace
+
+void
+decimateSignalSamples( const SignalDecimationInfo &info, std::vector<CollectedSignal> &samples, size_t first )
+{
+    if ( first >= samples.size() )
+    {
+        return;
+    }
+    std::sort( samples.begin() + static_cast<std::ptrdiff_t>( first ),
+               samples.end(),
+               []( const CollectedSignal &a, const CollectedSignal &b ) {
+                   return ( a.receiveTime < b.receiveTime ) ||
+                          ( ( a.receiveTime == b.receiveTime ) && ( a.receiveTimeFractionUs < b.receiveTimeFractionUs ) );
+               } );
+    auto count = samples.size() - first;
+    size_t maxSamples = info.maxSamples;
+    if ( ( maxSamples < 2 ) || ( count <= maxSamples ) )
+    {
+        return;
+    }
+    SampleCompactor compactor( &samples[first], count );
+    switch ( info.method )
+    {
+    case SignalDecimationMethod::MIN_MAX:
+        decimateMinMax( compactor, count, maxSamples );
+        break;
+    case SignalDecimationMethod::UNIFORM:
+        decimateUniform( compactor, count, maxSamples );
+        break;
+    default:
+        decimateLargestTriangleThreeBuckets( compactor, count, maxSamples );
+        break;
+    }
+    samples.resize( first + compactor.getKeptCount() );
+}
+
+} // namespace DataInspection
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -0,0 +1,143 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "TriggeredCollectionSchemeDataPool.h"
+#include "TraceModule.h"
+#include <algorithm>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataInspection
+{
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+constexpr size_t TriggeredCollectionSchemeDataPool::MAX_RESERVED_SAMPLES;
+
+void
+TriggeredCollectionSchemeDataPool::resize( size_t poolSize, size_t signalCapacity, size_t canFrameCapacity )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    mPoolSize = poolSize;
+    mSignalCapacity = std::min( signalCapacity, MAX_RESERVED_SAMPLES );
+    mCanFrameCapacity = std::min( canFrameCapacity, MAX_RESERVED_SAMPLES );
+    while ( ( mAllocatedCount > mPoolSize ) && ( !mFreeData.empty() ) )
+    {
+        mFreeData.pop_back();
+        mAllocatedCount--;
+    }
+    for ( auto &data : mFreeData )
+    {
+        data->signals.reserve( mSignalCapacity );
+        data->canFrames.reserve( mCanFrameCapacity );
+    }
+    // Preallocate all objects now instead of while triggers are collected
+    while ( mAllocatedCount < mPoolSize )
+    {
+        mFreeData.emplace_back( allocate() );
+        mAllocatedCount++;
+    }
+}
+
+std::shared_ptr<TriggeredCollectionSchemeData>
+TriggeredCollectionSchemeDataPool::acquire()
+{
+    std::unique_ptr<TriggeredCollectionSchemeData> data;
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        if ( !mFreeData.empty() )
+        {
+            data = std::move( mFreeData.back() );
+            mFreeData.pop_back();
+        }
+    }
+    if ( !data )
+    {
+        TraceModule::get().incrementAtomicVariable( TraceAtomicVariable::TRIGGERED_DATA_POOL_EXHAUSTED );
+        return std::make_shared<TriggeredCollectionSchemeData>();
+    }
+    TraceModule::get().incrementAtomicVariable( TraceAtomicVariable::TRIGGERED_DATA_POOL_USED );
+    auto pool = shared_from_this();
+    return std::shared_ptr<TriggeredCollectionSchemeData>( data.release(),
+                                                           [pool]( TriggeredCollectionSchemeData *usedData ) {
+                                                               pool->release( usedData );
+                                                           } );
+}
+
+void
+TriggeredCollectionSchemeDataPool::release( TriggeredCollectionSchemeData *data )
+{
+    std::unique_ptr<TriggeredCollectionSchemeData> usedData( data );
+    TraceModule::get().decrementAtomicVariable( TraceAtomicVariable::TRIGGERED_DATA_POOL_USED );
+    // Clear outside of the lock, this is normally done by the sender thread
+    clearData( *usedData );
+    std::lock_guard<std::mutex> lock( mMutex );
+    if ( mAllocatedCount > mPoolSize )
+    {
+        mAllocatedCount--;
+        return;
+    }
+    mFreeData.emplace_back( std::move( usedData ) );
+}
+
+std::unique_ptr<TriggeredCollectionSchemeData>
+TriggeredCollectionSchemeDataPool::allocate() const
+{
+    std::unique_ptr<TriggeredCollectionSchemeData> data( new TriggeredCollectionSchemeData() );
+    data->signals.reserve( mSignalCapacity );
+    data->canFrames.reserve( mCanFrameCapacity );
+    return data;
+}
+
+void
+TriggeredCollectionSchemeDataPool::clearData( TriggeredCollectionSchemeData &data )
+{
+    // clear() keeps the capacity of the vectors
+    data.metaData = PassThroughMetaData();
+    data.triggerTime = 0;
+    data.signals.clear();
+    data.signalSnapshots.clear();
+    data.canFrames.clear();
+    data.signalSummaries.clear();
+    data.mDTCInfo.mSID = SID::INVALID_SERVICE_MODE;
+    data.mDTCInfo.receiveTime = 0;
+    data.mDTCInfo.mDTCCodes.clear();
+    data.mDTCInfo.mSequenceNumber = 0;
+    data.mDTCInfo.mIsDelta = false;
+    data.mDTCInfo.mRemovedDTCCodes.clear();
+    data.mDTCInfo.mIsUnchanged = false;
+    data.mGeohashInfo.mGeohashString.clear();
+    data.mGeohashInfo.mPrevReportedGeohashString.clear();
+    data.eventID = 0;
+    data.sharedEvents.clear();
+}
+
+size_t
+TriggeredCollectionSchemeDataPool::getUsedCount() const
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    return mAllocatedCount - mFreeData.size();
+}
+
+size_t
+TriggeredCollectionSchemeDataPool::getFreeCount() const
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    return mFreeData.size();
+}
+
+} // namespace DataInspection
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -15,10 +15,12 @@
 #include "DataOverDDSModule.h"
 #include "dds/CameraDataPublisher.h"
 #include "dds/CameraDataSubscriber.h"
+#include <algorithm>
 #include <bitset>
 #include <cstring>
 #include <iostream>
 #include <iterator>
+#include <thread>
 namespace Aws
 {
 namespace IoTFleetWise
@@ -26,15 +28,24 @@ namespace IoTFleetWise
 namespace DataInspection
 {
 
+constexpr size_t DataOverDDSModule::EVENT_QUEUE_SIZE;
+
 DataOverDDSModule::~DataOverDDSModule()
 {
-    // To make sure the thread stops during teardown of tests.
-    if ( mThread.isValid() && mThread.isActive() )
+    // To make sure the threads stop during teardown of tests. The subscribers are destroyed afterwards and
+    // then no longer wait for their queues.
+    if ( ( mExecutor != nullptr ) && mExecutor->isAlive() )
     {
-        stop();
+        mExecutor->stop();
     }
 }
 
+uint32_t
+DataOverDDSModule::getWorkerCount()
+{
+    return std::max( 1U, std::thread::hardware_concurrency() );
+}
+
 bool
 DataOverDDSModule::init( const DDSDataSourcesConfig &ddsDataSourcesConfig )
 {
@@ -50,6 +61,10 @@ DataOverDDSModule::init( const DDSDataSourcesConfig &ddsDataSourcesConfig )
 
     DDSPublisherPtr publisher;
     DDSSubscriberPtr subscriber;
+    if ( mExecutor == nullptr )
+    {
+        mExecutor = std::make_shared<SerialTaskExecutor>( getWorkerCount(), "fwDIDDSExec" );
+    }
     for ( auto &config : ddsDataSourcesConfig )
     {
         switch ( config.sourceType )
@@ -64,11 +79,13 @@ DataOverDDSModule::init( const DDSDataSourcesConfig &ddsDataSourcesConfig )
             }
             else
             {
+                subscriber->setExecutor( mExecutor );
+                mCacheLocations.insert( config.temporaryCacheLocation );
                 // Store these nodes
                 {
                     std::lock_guard<std::mutex> lock( mPubSubMutex );
                     mPublishers.emplace( config.sourceID, std::move( publisher ) );
-                    mSubscribers.emplace_back( std::move( subscriber ) );
+                    mSubscribers.emplace( config.sourceID, std::move( subscriber ) );
                 }
 
                 mLogger.info( "DataOverDDSModule::init", "Camera Publisher/Subscriber successfully initialised" );
@@ -83,105 +100,87 @@ DataOverDDSModule::init( const DDSDataSourcesConfig &ddsDataSourcesConfig )
     return !mPublishers.empty() && !mSubscribers.empty() && mPublishers.size() == mSubscribers.size();
 }
 
-bool
-DataOverDDSModule::start()
+void
+DataOverDDSModule::requestEventData( const std::vector<EventMetadata> &eventMetadata )
 {
-    // Prevent concurrent stop/init
-    std::lock_guard<std::mutex> lock( mThreadMutex );
-    // On multi core systems the shared variable mShouldStop must be updated for
-    // all cores before starting the thread otherwise thread will directly end
-    mShouldStop.store( false );
-    if ( !mThread.create( doWork, this ) )
+    // We don't want a disconnect or connect to change the content of our container.
+    std::lock_guard<std::mutex> lockPubSub( mPubSubMutex );
+    // We need to iterate through all the items in the event and request every device
+    // listed in there.
+    for ( const auto &eventItem : eventMetadata )
     {
-        mLogger.trace( "DataOverDDSModule::start", " DataOverDDSModule Thread failed to start" );
-    }
-    else
-    {
-        mLogger.trace( "DataOverDDSModule::start", " DataOverDDSModule Thread started" );
-        mThread.setThreadName( "fwDIDDSModule" );
-    }
+        auto publishIterator = mPublishers.find( eventItem.sourceID );
+        // Something went wrong... The sourceID requested is not available
+        if ( publishIterator == mPublishers.end() )
+        {
+            // Hmm, we have received a notification to request data from a source that's
+            // not configured. We should log an error and skip the event.
+            mLogger.error( "DataOverDDSModule::requestEventData",
+                           " received an event for a Source that's not configured, Source ID: " +
+                               std::to_string( eventItem.sourceID ) );
+        }
+        else
+        {
+            // Okey, now we know there is a new event, forward it to the publisher
+            DDSDataRequest request = {};
+            request.eventID = eventItem.eventID;
+            request.negativeOffsetMs = eventItem.negativeOffsetMs;
+            request.positiveOffsetMs = eventItem.positiveOffsetMs;
+            request.imageType = eventItem.imageType;
+            request.captureOptions = eventItem.captureOptions;
 
-    return mThread.isActive() && mThread.isValid();
+            // Prefer the pre-trigger buffer of the source, as it already holds the frames
+            auto subscribeIterator = mSubscribers.find( eventItem.sourceID );
+            if ( ( subscribeIterator != mSubscribers.end() ) &&
+                 subscribeIterator->second->persistFromPreTriggerBuffer( request ) )
+            {
+                mLogger.trace( "DataOverDDSModule::requestEventData",
+                               " Took the data of eventID: " + std::to_string( eventItem.eventID ) +
+                                   " from the pre-trigger buffer of DeviceID " +
+                                   std::to_string( eventItem.sourceID ) );
+                continue;
+            }
+            // Go ahead and request the data from the underlying source
+            if ( subscribeIterator != mSubscribers.end() )
+            {
+                subscribeIterator->second->registerDataRequest( request );
+            }
+            publishIterator->second->publishDataRequest( request );
+            mLogger.trace( "DataOverDDSModule::requestEventData",
+                           " Send a request to the DDS Network upon eventID: " + std::to_string( eventItem.eventID ) +
+                               " to DeviceID " + std::to_string( eventItem.sourceID ) );
+        }
+    }
 }
 
-bool
-DataOverDDSModule::stop()
+void
+DataOverDDSModule::setArtifactUploader( std::shared_ptr<DataManagement::ArtifactUploader> artifactUploader )
 {
-    std::lock_guard<std::mutex> lock( mThreadMutex );
-    mShouldStop.store( true, std::memory_order_relaxed );
-    mWait.notify();
-    mThread.release();
-    mShouldStop.store( false, std::memory_order_relaxed );
-    return !mThread.isActive();
+    mArtifactUploader = std::move( artifactUploader );
 }
 
 bool
-DataOverDDSModule::shouldStop() const
-{
-    return mShouldStop.load( std::memory_order_relaxed );
-}
-
-void
-DataOverDDSModule::doWork( void *data )
+DataOverDDSModule::connect()
 {
-    DataOverDDSModule *DDSModule = static_cast<DataOverDDSModule *>( data );
-    while ( !DDSModule->shouldStop() )
+    if ( mArtifactUploader != nullptr )
     {
-        // Always go to a busy wait state and stay there till a notify comes.
-        DDSModule->mWait.wait( Platform::Linux::Signal::WaitWithPredicate );
-        // We are now awake because there is an event notification from the inspection Engine.
-        // We need to interpret the event metadata and find out which Source we need to
-        // communicate with, and then invoke the corresponding publisher.
-        // Make sure we don't do anything during a shutdown cycle
-        if ( DDSModule->mNewEventReceived.load() )
+        for ( const auto &cacheLocation : mCacheLocations )
         {
-            {
-                // We don't want a disconnect or connect to change the content of our container.
-                std::lock_guard<std::mutex> lockPubSub( DDSModule->mPubSubMutex );
-                // We need to iterate through all the items in the event and request every device
-                // listed in there.
-                // Critical section only to make sure the request content
-                // is atomic e.g. not changed when this thread wakes up.
-                std::lock_guard<std::mutex> lockEvent( DDSModule->mEventMetaMutex );
-                for ( const auto &eventItem : DDSModule->mEventMetatdata )
-                {
-
-                    auto publishIterator = DDSModule->mPublishers.find( eventItem.sourceID );
-                    // Something went wrong... The sourceID requested is not available
-                    if ( publishIterator == DDSModule->mPublishers.end() )
-                    {
-                        // Hmm, we have received a notification to request data from a source that's
-                        // not configured. We should log an error and skip the event.
-                        DDSModule->mLogger.error( "DataOverDDSModule::doWork",
-                                                  " received an event for a Source that's not configured, Source ID: " +
-                                                      std::to_string( eventItem.sourceID ) );
-                    }
-                    else
-                    {
-                        // Okey, now we know there is a new event, forward it to the publisher
-                        DDSDataRequest request = {};
-                        request.eventID = eventItem.eventID;
-                        request.negativeOffsetMs = eventItem.negativeOffsetMs;
-                        request.positiveOffsetMs = eventItem.positiveOffsetMs;
-
-                        // Go ahead and request the data from the underlying source
-                        publishIterator->second->publishDataRequest( request );
-                        DDSModule->mLogger.trace(
-                            "DataOverDDSModule::doWork",
-                            " Send a request to the DDS Network upon eventID: " + std::to_string( eventItem.eventID ) +
-                                " to DeviceID " + std::to_string( eventItem.sourceID ) );
-                    }
-                }
-            }
-            // Reset the event received and go back to a wait state
-            DDSModule->mNewEventReceived.store( false );
+            mArtifactUploader->resumeUploads( cacheLocation );
         }
     }
-}
-
-bool
-DataOverDDSModule::connect()
-{
+    {
+        // Prevent concurrent connect/disconnect
+        std::lock_guard<std::mutex> lock( mThreadMutex );
+        // The subscribers create their queues when they connect, so the executor runs first
+        if ( ( mExecutor == nullptr ) || ( !mExecutor->start() ) )
+        {
+            mLogger.error( "DataOverDDSModule::connect", " Executor failed to start" );
+            return false;
+        }
+        mEventQueue = mExecutor->createQueue( EVENT_QUEUE_SIZE );
+        mConnected.store( true );
+    }
 
     {
         std::lock_guard<std::mutex> lock( mPubSubMutex );
@@ -189,7 +188,7 @@ DataOverDDSModule::connect()
         for ( auto &sub : mSubscribers )
         {
             // Register the module as a listener of the Subscriber
-            if ( !sub->subscribeListener( this ) || !sub->connect() )
+            if ( !sub.second->subscribeListener( this ) || !sub.second->connect() )
             {
                 mLogger.error( "DataOverDDSModule::connect", " Failed to connect Subscriber" );
                 return false;
@@ -214,8 +213,7 @@ DataOverDDSModule::connect()
         }
     }
 
-    // Then start the worker thread
-    return start();
+    return true;
 }
 
 bool
@@ -226,7 +224,7 @@ DataOverDDSModule::disconnect()
         // First disconnect the Subscribers and the Publishers
         for ( auto &sub : mSubscribers )
         {
-            if ( !sub->unSubscribeListener( this ) || !sub->disconnect() )
+            if ( !sub.second->unSubscribeListener( this ) || !sub.second->disconnect() )
             {
                 mLogger.error( "DataOverDDSModule::disconnect", " Failed to disconnect Subscriber" );
                 return false;
@@ -250,8 +248,15 @@ DataOverDDSModule::disconnect()
             }
         }
     }
-    // Stop the worker thread
-    return stop();
+    // Stop the executor once the pending events are forwarded
+    std::lock_guard<std::mutex> lock( mThreadMutex );
+    mConnected.store( false );
+    if ( mExecutor == nullptr )
+    {
+        return true;
+    }
+    mExecutor->removeQueue( mEventQueue );
+    return mExecutor->stop();
 }
 
 bool
@@ -262,7 +267,7 @@ DataOverDDSModule::isAlive()
     {
         for ( auto &sub : mSubscribers )
         {
-            if ( !sub->isAlive() )
+            if ( !sub.second->isAlive() )
             {
                 mLogger.error( "DataOverDDSModule::isAlive", " Subscriber not alive" );
                 return false;
@@ -279,32 +284,67 @@ DataOverDDSModule::isAlive()
         }
     }
 
-    // This thread should be alive
-    return ( mThread.isValid() && mThread.isActive() );
+    // The workers should be alive
+    return mConnected.load() && ( mExecutor != nullptr ) && mExecutor->isAlive();
 }
 
 void
 DataOverDDSModule::onEventOfInterestDetected( const std::vector<EventMetadata> &eventMetadata )
 {
-    // This runs in the context of the Inspection thread.
-    // We don't have an event loop at we manage a single event at a time.
-    // We don't need to guard for thread safety as this notification comes
-    // from the Inspection thread only, but we still guard as the main loop
-    // might be running an ongoing request.
+    // This runs in the context of the Inspection thread. The event is forwarded on the executor, so an ongoing
+    // request does not block the inspection, and events arriving meanwhile are queued behind it.
     mLogger.trace( "DataOverDDSModule::onEventOfInterestDetected", " Received a new event " );
-    std::lock_guard<std::mutex> lock( mEventMetaMutex );
+    if ( ( !mConnected.load() ) ||
+         ( !mExecutor->post( mEventQueue, [this, eventMetadata]() { requestEventData( eventMetadata ); } ) ) )
     {
-        mEventMetatdata = eventMetadata;
-        mNewEventReceived.store( true );
+        mLogger.warn( "DataOverDDSModule::onEventOfInterestDetected", " Event dropped, the queue is full or stopped" );
+    }
+}
+
+void
+DataOverDDSModule::onChangeInspectionMatrix( const std::shared_ptr<const InspectionMatrix> &activeConditions )
+{
+    // The engine requests the time before the condition and the time after it at once after the
+    // after duration, so the whole window has to be buffered.
+    std::map<uint32_t, uint32_t> retentionMsPerSource;
+    if ( activeConditions != nullptr )
+    {
+        for ( const auto &condition : activeConditions->conditions )
+        {
+            if ( !condition.includeImageCapture )
+            {
+                continue;
+            }
+            for ( const auto &imageInfo : condition.imageCollectionInfos )
+            {
+                auto &retentionMs = retentionMsPerSource[imageInfo.deviceID];
+                retentionMs = std::max( retentionMs, imageInfo.beforeDurationMs + condition.afterDuration );
+            }
+        }
+    }
+    std::lock_guard<std::mutex> lock( mPubSubMutex );
+    for ( auto &sub : mSubscribers )
+    {
+        auto retentionIterator = retentionMsPerSource.find( sub.first );
+        sub.second->setPreTriggerRetentionMs( retentionIterator == retentionMsPerSource.end()
+                                                  ? 0U
+                                                  : retentionIterator->second );
     }
-    // Wake up the thread
-    mWait.notify();
 }
 
 void
 DataOverDDSModule::onSensorArtifactAvailable( const SensorArtifactMetadata &artifactMetadata )
 {
-    static_cast<void>( artifactMetadata );
+    // Runs on the executor, the upload itself runs on the thread of the uploader
+    if ( mArtifactUploader == nullptr )
+    {
+        return;
+    }
+    if ( !mArtifactUploader->submit( artifactMetadata.path, artifactMetadata.sourceID ) )
+    {
+        mLogger.error( "DataOverDDSModule::onSensorArtifactAvailable",
+                       " Could not queue the artifact for upload: " + artifactMetadata.path );
+    }
 }
 
 } // namespace DataInspection
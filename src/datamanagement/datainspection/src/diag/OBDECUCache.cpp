@@ -0,0 +1,187 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "OBDECUCache.h"
+#include "Crc32c.h"
+#include <cstring>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataInspection
+{
+constexpr uint32_t OBDECUCache::VERSION;
+
+namespace
+{
+constexpr uint32_t CACHE_MAGIC = 0x4345424FU; // "OBEC"
+
+struct CacheHeader
+{
+    uint32_t magic{ 0 };
+    uint32_t version{ 0 };
+    uint32_t crc{ 0 }; /**< CRC32C of the data behind the header */
+    uint32_t size{ 0 };
+};
+
+// Values are stored in the byte order of the device, as the cache is never read by another device
+void
+writeUInt32( std::vector<uint8_t> &output, uint32_t value )
+{
+    const auto *bytes = reinterpret_cast<const uint8_t *>( &value );
+    output.insert( output.end(), bytes, bytes + sizeof( value ) );
+}
+
+void
+writeBytes( std::vector<uint8_t> &output, const uint8_t *bytes, size_t size )
+{
+    writeUInt32( output, static_cast<uint32_t>( size ) );
+    output.insert( output.end(), bytes, bytes + size );
+}
+
+/**
+ * @brief Reads the values written above, failing instead of reading beyond the end
+ */
+class CacheReader
+{
+public:
+    CacheReader( const uint8_t *data, size_t size )
+        : mData( data )
+        , mSize( size )
+    {
+    }
+
+    bool
+    readUInt32( uint32_t &value )
+    {
+        if ( mSize - mOffset < sizeof( value ) )
+        {
+            return false;
+        }
+        std::memcpy( &value, mData + mOffset, sizeof( value ) );
+        mOffset += sizeof( value );
+        return true;
+    }
+
+    bool
+    readBytes( std::vector<uint8_t> &bytes )
+    {
+        uint32_t length = 0;
+        if ( ( !readUInt32( length ) ) || ( mSize - mOffset < length ) )
+        {
+            return false;
+        }
+        bytes.assign( mData + mOffset, mData + mOffset + length );
+        mOffset += length;
+        return true;
+    }
+
+    bool
+    isAtEnd() const
+    {
+        return mOffset == mSize;
+    }
+
+private:
+    const uint8_t *mData;
+    size_t mSize;
+    size_t mOffset{ 0 };
+};
+} // namespace
+
+void
+OBDECUCache::serialize( std::vector<uint8_t> &output ) const
+{
+    output.assign( sizeof( CacheHeader ), 0 );
+    writeBytes( output, reinterpret_cast<const uint8_t *>( vin.data() ), vin.size() );
+    writeUInt32( output, static_cast<uint32_t>( ecus.size() ) );
+    for ( const auto &ecu : ecus )
+    {
+        writeUInt32( output, static_cast<uint32_t>( ecu.type ) );
+        writeUInt32( output, ecu.requestCANId );
+        writeUInt32( output, ecu.responseCANId );
+        writeUInt32( output, static_cast<uint32_t>( ecu.supportedPIDs.size() ) );
+        for ( const auto &pids : ecu.supportedPIDs )
+        {
+            writeUInt32( output, static_cast<uint32_t>( pids.first ) );
+            writeBytes( output, pids.second.data(), pids.second.size() );
+        }
+    }
+
+    CacheHeader header;
+    header.magic = CACHE_MAGIC;
+    header.version = VERSION;
+    header.size = static_cast<uint32_t>( output.size() - sizeof( CacheHeader ) );
+    header.crc = Platform::Linux::PersistencyManagement::crc32c(
+        0, output.data() + sizeof( CacheHeader ), output.size() - sizeof( CacheHeader ) );
+    std::memcpy( output.data(), &header, sizeof( CacheHeader ) );
+}
+
+bool
+OBDECUCache::deserialize( const uint8_t *data, size_t size )
+{
+    CacheHeader header;
+    if ( ( data == nullptr ) || ( size < sizeof( CacheHeader ) ) )
+    {
+        return false;
+    }
+    std::memcpy( &header, data, sizeof( CacheHeader ) );
+    if ( ( header.magic != CACHE_MAGIC ) || ( header.version != VERSION ) ||
+         ( header.size != size - sizeof( CacheHeader ) ) ||
+         ( header.crc !=
+           Platform::Linux::PersistencyManagement::crc32c( 0, data + sizeof( CacheHeader ), header.size ) ) )
+    {
+        return false;
+    }
+
+    CacheReader reader( data + sizeof( CacheHeader ), header.size );
+    std::vector<uint8_t> vinBytes;
+    uint32_t ecuCount = 0;
+    if ( ( !reader.readBytes( vinBytes ) ) || ( !reader.readUInt32( ecuCount ) ) )
+    {
+        return false;
+    }
+    vin.assign( vinBytes.begin(), vinBytes.end() );
+    ecus.clear();
+    for ( uint32_t i = 0; i < ecuCount; i++ )
+    {
+        ECU ecu;
+        uint32_t type = 0;
+        uint32_t sidCount = 0;
+        if ( ( !reader.readUInt32( type ) ) || ( type > static_cast<uint32_t>( ECUType::OTHER ) ) ||
+             ( !reader.readUInt32( ecu.requestCANId ) ) || ( !reader.readUInt32( ecu.responseCANId ) ) ||
+             ( !reader.readUInt32( sidCount ) ) )
+        {
+            return false;
+        }
+        ecu.type = static_cast<ECUType>( type );
+        for ( uint32_t j = 0; j < sidCount; j++ )
+        {
+            uint32_t sid = 0;
+            SupportedPIDs pids;
+            if ( ( !reader.readUInt32( sid ) ) || ( !reader.readBytes( pids ) ) )
+            {
+                return false;
+            }
+            ecu.supportedPIDs[static_cast<SID>( sid )] = std::move( pids );
+        }
+        ecus.emplace_back( std::move( ecu ) );
+    }
+    return reader.isAtEnd();
+}
+
+} // namespace DataInspection
+} // namespace IoTFleetWise
+} // namespace Aws
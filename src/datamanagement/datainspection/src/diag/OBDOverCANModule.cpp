@@ -13,8 +13,10 @@
 
 // Includes
 #include "OBDOverCANModule.h"
+#include "CacheAndPersist.h"
 #include "EnumUtility.h"
 #include "OBDDataTypes.h"
+#include "OBDECUCache.h"
 #include "TraceModule.h"
 
 #include <algorithm>
@@ -22,9 +24,34 @@
 #include <cstring>
 #include <iostream>
 #include <iterator>
+#include <limits>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include <net/if.h>
+#include <poll.h>
+#include <set>
 #include <sstream>
+#include <sys/socket.h>
+#include <unistd.h>
 
 #define MAX_PID_RANGE ( 6U )
+// Functional request and physical response IDs according to ISO 15765-4
+#define FUNCTIONAL_REQUEST_ID ( 0x7DFU )
+#define FUNCTIONAL_REQUEST_ID_EXTENDED ( 0x18DB33F1U )
+#define PHYSICAL_RESPONSE_ID_BASE ( 0x7E8U )
+#define PHYSICAL_RESPONSE_ID_MASK ( 0x7F8U )
+#define PHYSICAL_RESPONSE_ID_BASE_EXTENDED ( 0x18DAF100U )
+#define PHYSICAL_RESPONSE_ID_MASK_EXTENDED ( 0x1FFFFF00U )
+#define PHYSICAL_REQUEST_ID_OFFSET ( 8U )
+#define PHYSICAL_REQUEST_ID_BASE_EXTENDED ( 0x18DA00F1U )
+// Time the ECUs get to answer the functional request. P2CAN max is 50 ms according to J1979, relaxed
+// for network latency.
+#define ECU_DISCOVERY_TIMEOUT_MS ( 100 )
+// Lower bound of the request interval of a PID. Smaller sample intervals would only flood the bus, as every
+// request takes at least one round trip.
+#define MIN_PID_REQUEST_INTERVAL_MS ( 100U )
+// Positive responses to UDS services are the service ID plus this value
+#define POSITIVE_UDS_RESPONSE_BASE ( 0x40U )
 namespace Aws
 {
 namespace IoTFleetWise
@@ -37,7 +64,6 @@ OBDOverCANModule::OBDOverCANModule()
     mOBDHeartBeatIntervalSeconds = 0;
     mPIDRequestIntervalSeconds = 0;
     mDTCRequestIntervalSeconds = 0;
-    mHasTransmission = false;
     mVIN.clear();
 }
 
@@ -57,7 +83,9 @@ OBDOverCANModule::init( SignalBufferPtr signalBufferPtr,
                         const uint32_t &pidRequestIntervalSeconds,
                         const uint32_t &dtcRequestIntervalSeconds,
                         const bool &useExtendedIDs,
-                        const bool &hasTransmissionECU )
+                        const bool &hasTransmissionECU,
+                        const bool &discoverECUs,
+                        const std::shared_ptr<ICacheAndPersist> &persistency )
 {
     // Sanity check
     if ( pidRequestIntervalSeconds == 0 && dtcRequestIntervalSeconds == 0 )
@@ -65,36 +93,13 @@ OBDOverCANModule::init( SignalBufferPtr signalBufferPtr,
         // We should not start the module if both intervals are zero
         return false;
     }
-    // Establish a bi-directional P2P channel on ISO-TP between FWE, Engine ECU and Transmission ECU.
-    // Each ECU listens on the bus for their RX IDs, and respond with their TX IDs.
-    ISOTPOverCANSenderReceiverOptions optionsEngine;
-    ISOTPOverCANSenderReceiverOptions optionsTransmission;
-    optionsEngine.mSocketCanIFName = gatewayCanInterfaceName;
-    optionsTransmission.mSocketCanIFName = gatewayCanInterfaceName;
-
-    if ( useExtendedIDs )
-    {
-        // ECM
-        optionsEngine.mIsExtendedId = true;
-        optionsEngine.mSourceCANId = toUType( ECUID::ENGINE_ECU_TX_EXTENDED );
-        optionsEngine.mDestinationCANId = toUType( ECUID::ENGINE_ECU_RX_EXTENDED );
-        // TCM
-        optionsTransmission.mIsExtendedId = true;
-        optionsTransmission.mSourceCANId = toUType( ECUID::TRANSMISSION_ECU_TX_EXTENDED );
-        optionsTransmission.mDestinationCANId = toUType( ECUID::TRANSMISSION_ECU_RX_EXTENDED );
-    }
-    else
-    {
-        // ECM
-        optionsEngine.mSourceCANId = toUType( ECUID::ENGINE_ECU_TX );
-        optionsEngine.mDestinationCANId = toUType( ECUID::ENGINE_ECU_RX );
-        // TCM
-        optionsTransmission.mSourceCANId = toUType( ECUID::TRANSMISSION_ECU_TX );
-        optionsTransmission.mDestinationCANId = toUType( ECUID::TRANSMISSION_ECU_RX );
-    }
 
     mPIDRequestIntervalSeconds = pidRequestIntervalSeconds;
     mDTCRequestIntervalSeconds = dtcRequestIntervalSeconds;
+    mUseExtendedIDs = useExtendedIDs;
+    mDiscoverECUs = discoverECUs;
+    mGatewayCanInterfaceName = gatewayCanInterfaceName;
+    mPersistency = persistency;
 
     if ( signalBufferPtr.get() == nullptr || activeDTCBufferPtr.get() == nullptr )
     {
@@ -106,38 +111,88 @@ OBDOverCANModule::init( SignalBufferPtr signalBufferPtr,
         mSignalBufferPtr = signalBufferPtr;
         mActiveDTCBufferPtr = activeDTCBufferPtr;
     }
+    mSignalProducer = mSignalBufferPtr->addProducer();
+    if ( mSignalProducer == nullptr )
+    {
+        mLogger.error( "OBDOverCANModule::init", "Too many producers for the Signal Buffer" );
+        return false;
+    }
 
     // Init the OBD Decoder
     mOBDDataDecoder = std::make_unique<OBDDataDecoder>();
 
+    // Establish a bi-directional P2P channel on ISO-TP between FWE and each ECU.
+    // Each ECU listens on the bus for their RX IDs, and respond with their TX IDs.
+    // Init the Engine ECU
+    bool engineInitialized =
+        useExtendedIDs ? addECU( ECUType::ENGINE,
+                                 toUType( ECUID::ENGINE_ECU_TX_EXTENDED ),
+                                 toUType( ECUID::ENGINE_ECU_RX_EXTENDED ),
+                                 gatewayCanInterfaceName,
+                                 false )
+                       : addECU( ECUType::ENGINE,
+                                 toUType( ECUID::ENGINE_ECU_TX ),
+                                 toUType( ECUID::ENGINE_ECU_RX ),
+                                 gatewayCanInterfaceName,
+                                 false );
+    if ( !engineInitialized )
+    {
+        mLogger.error( "OBDOverCANModule::init", "Failed to init the Engine ECU" );
+        return false;
+    }
+    mLogger.trace( "OBDOverCANModule::init", "Engine ECU Initialized" );
+
     // Init the Transmission ECU
     if ( hasTransmissionECU )
     {
-        if ( mTransmissionECUSenderReceiver.init( optionsTransmission ) )
-        {
-            mLogger.trace( "OBDOverCANModule::init", "Transmission ECU Initialized" );
-            mHasTransmission = true;
-        }
-        else
+        bool transmissionInitialized =
+            useExtendedIDs ? addECU( ECUType::TRANSMISSION,
+                                     toUType( ECUID::TRANSMISSION_ECU_TX_EXTENDED ),
+                                     toUType( ECUID::TRANSMISSION_ECU_RX_EXTENDED ),
+                                     gatewayCanInterfaceName,
+                                     false )
+                           : addECU( ECUType::TRANSMISSION,
+                                     toUType( ECUID::TRANSMISSION_ECU_TX ),
+                                     toUType( ECUID::TRANSMISSION_ECU_RX ),
+                                     gatewayCanInterfaceName,
+                                     false );
+        if ( !transmissionInitialized )
         {
             mLogger.error( "OBDOverCANModule::init", "Failed to the Transmission ECU" );
-            mHasTransmission = false;
             return false;
         }
+        mLogger.trace( "OBDOverCANModule::init", "Transmission ECU Initialized" );
     }
-    // Init the Engine ECU
-    if ( mEngineECUSenderReceiver.init( optionsEngine ) )
-    {
+    mLogger.info( "OBDOverCANModule::init", "OBD Module Initialized" );
+    return true;
+}
 
-        mLogger.trace( "OBDOverCANModule::init", "Engine ECU Initialized" );
-        mLogger.info( "OBDOverCANModule::init", "OBD Module Initialized" );
+bool
+OBDOverCANModule::addECU( ECUType type,
+                          uint32_t requestCANId,
+                          uint32_t responseCANId,
+                          const std::string &gatewayCanInterfaceName,
+                          bool connectSession )
+{
+    ISOTPOverCANSenderReceiverOptions options;
+    options.mSocketCanIFName = gatewayCanInterfaceName;
+    options.mIsExtendedId = mUseExtendedIDs;
+    options.mSourceCANId = requestCANId;
+    options.mDestinationCANId = responseCANId;
+    auto ecu = std::make_unique<ECUSession>();
+    ecu->type = type;
+    ecu->responseBuffer.resize( MAX_PDU_SIZE );
+    if ( !ecu->isoTPSendReceive.init( options ) )
+    {
+        return false;
     }
-    else
+    if ( connectSession && !ecu->isoTPSendReceive.connect() )
     {
-        mLogger.error( "OBDOverCANModule::init", "Failed to init the Engine ECU" );
         return false;
     }
-
+    std::lock_guard<std::mutex> lock( mECUsMutex );
+    updatePIDRequestList( SID::CURRENT_STATS, *ecu );
+    mECUs.emplace_back( std::move( ecu ) );
     return true;
 }
 
@@ -154,14 +209,13 @@ OBDOverCANModule::start()
     mDecoderManifestAvailable.store( false );
     // Do not request DTCs on startup
     mShouldRequestDTCs.store( false );
-    if ( !mThread.create( doWork, this ) )
+    if ( !mThread.create( doWork, this, "fwDIOBDModule" ) )
     {
         mLogger.trace( "OBDOverCANModule::start", " OBD Module Thread failed to start " );
     }
     else
     {
         mLogger.trace( "OBDOverCANModule::start", " OBD Module Thread started" );
-        mThread.setThreadName( "fwDIOBDModule" );
     }
 
     return mThread.isActive() && mThread.isValid();
@@ -199,13 +253,17 @@ OBDOverCANModule::doWork( void *data )
 
     OBDModule->mDTCTimer.reset();
     OBDModule->mPIDTimer.reset();
+    // With a cache the PIDs are requested right away, and the cache is revalidated after the first requests
+    OBDModule->loadECUCache();
     while ( !OBDModule->shouldStop() )
     {
 
-        // If we don't have an OBD decoder manifest and we should not request DTCs,
+        // If we don't have an OBD or UDS decoder manifest and we should not request DTCs,
         // Take the thread to sleep
         if ( !OBDModule->mShouldRequestDTCs.load( std::memory_order_relaxed ) &&
-             ( !OBDModule->mDecoderDictionaryPtr || OBDModule->mDecoderDictionaryPtr->empty() ) )
+             ( !OBDModule->mDecoderDictionaryPtr || OBDModule->mDecoderDictionaryPtr->empty() ) &&
+             OBDModule->mActiveUDSDataIdentifiers.empty() &&
+             !OBDModule->mUDSDictionaryAvailable.load( std::memory_order_relaxed ) )
         {
             OBDModule->mLogger.trace(
                 "OBDOverCANModule::doWork",
@@ -218,7 +276,7 @@ OBDOverCANModule::doWork( void *data )
         {
             // A new decoder manifest arrived. Pass it over to the OBD decoder.
             {
-                std::lock_guard<std::mutex> lock( OBDModule->mDecoderDictMutex );
+                std::lock_guard<InstrumentedMutex> lock( OBDModule->mDecoderDictMutex );
                 OBDModule->mOBDDataDecoder->setDecoderDictionary( OBDModule->mDecoderDictionaryPtr );
                 OBDModule->mLogger.trace( "OBDOverCANModule::doWork", "Decoder Manifest set on the OBD Decoder " );
                 // Reset the atomic state
@@ -226,22 +284,53 @@ OBDOverCANModule::doWork( void *data )
             }
         }
 
+        // Further ECUs are only discovered once per connection
+        if ( OBDModule->mDiscoverECUs && !OBDModule->mECUDiscoveryDone )
+        {
+            OBDModule->discoverECUs();
+            OBDModule->mECUDiscoveryDone = true;
+        }
+
+        // A new UDS decoder dictionary arrived. The previous periodic DIDs are stopped before the new ones are started.
+        if ( OBDModule->mUDSDictionaryAvailable.exchange( false, std::memory_order_relaxed ) )
+        {
+            if ( OBDModule->mPeriodicDIDsStarted )
+            {
+                OBDModule->configurePeriodicDataIdentifiers( false );
+                OBDModule->mPeriodicDIDsStarted = false;
+            }
+            {
+                std::lock_guard<InstrumentedMutex> lock( OBDModule->mDecoderDictMutex );
+                OBDModule->mActiveUDSDataIdentifiers = OBDModule->mUDSDataIdentifiers;
+            }
+            // The DIDs of the new dictionary are requested right away
+            OBDModule->mDIDTimer.reset();
+            OBDModule->mDIDsRequested = false;
+        }
+        if ( !OBDModule->mActiveUDSDataIdentifiers.empty() )
+        {
+            // Periodic DIDs are configured once, afterwards the ECUs stream them without any further request
+            if ( !OBDModule->mPeriodicDIDsStarted )
+            {
+                OBDModule->configurePeriodicDataIdentifiers( true );
+                OBDModule->mPeriodicDIDsStarted = true;
+            }
+            if ( OBDModule->mPIDRequestIntervalSeconds > 0 &&
+                 ( !OBDModule->mDIDsRequested ||
+                   OBDModule->mDIDTimer.getElapsedMs().count() >= OBDModule->mPIDRequestIntervalSeconds * 1000 ) )
+            {
+                OBDModule->requestDataIdentifiers();
+                OBDModule->mDIDTimer.reset();
+                OBDModule->mDIDsRequested = true;
+            }
+        }
+
         // Thread woken up. Execute the PID request flow if activated.
         if ( OBDModule->mDecoderDictionaryPtr && !OBDModule->mDecoderDictionaryPtr->empty() )
         {
             // Start by requesting the VIN then
             // Check whether the ECUs reported their support PIDs.
             // If not, request and process them.
-            // We need to consolidate these functions into a generic implementation that
-            // takes the ECUType as an input. Currently we are limited to 2 ECUs only.
-            SupportedPIDs enginePIDs;
-            SupportedPIDs transmissionPIDs;
-            EmissionInfo enginePIDInfo;
-            EmissionInfo transmissionPIDInfo;
-            ECUDiagnosticInfo transmissionDiagnosticInfo;
-            ECUDiagnosticInfo engineDiagnosticInfo;
-            engineDiagnosticInfo.mEcuType = ECUType::ENGINE;
-            transmissionDiagnosticInfo.mEcuType = ECUType::TRANSMISSION;
             // Check if the VIN has been already successfully requested.
             // If not, request it and store it.
             // The request always goes to the ECM, even though the VIN is also available
@@ -251,6 +340,7 @@ OBDOverCANModule::doWork( void *data )
                 OBDModule->mLogger.trace( "OBDOverCANModule::doWork", "Requesting VIN from Engine ECU" );
                 if ( OBDModule->requestReceiveVIN( OBDModule->mVIN ) )
                 {
+                    OBDModule->mECUCacheOutdated = true;
                     OBDModule->mLogger.trace( "OBDOverCANModule::doWork", "Received VIN from Engine ECU" );
                 }
                 else
@@ -260,212 +350,50 @@ OBDOverCANModule::doWork( void *data )
                 }
             }
 
-            // Set the VIN on the diagnostic infos
-            engineDiagnosticInfo.mVIN = OBDModule->mVIN;
-            transmissionDiagnosticInfo.mVIN = OBDModule->mVIN;
-            // Is it time to request PIDs ?
-            // If so, send the requests then reschedule PID requests
-            if ( OBDModule->mPIDRequestIntervalSeconds > 0 &&
-                 OBDModule->mPIDTimer.getElapsedSeconds() >= OBDModule->mPIDRequestIntervalSeconds )
+            // Are PIDs due ?
+            // If so, send the requests. They are rescheduled according to their own interval.
+            if ( OBDModule->mPIDRequestIntervalSeconds > 0 )
             {
-                // Engine ECU
-                if ( OBDModule->mEngineECUSenderReceiver.isAlive() && OBDModule->mSupportedPIDsEngine.empty() )
-                {
-                    OBDModule->mLogger.trace( "OBDOverCANModule::doWork", "Requesting Supported PIDs from Engine ECU" );
-                    // Send the Supported PID request
-                    SupportedPIDs enginePIDs;
-                    if ( OBDModule->requestReceiveSupportedPIDs(
-                             SID::CURRENT_STATS, OBDModule->mEngineECUSenderReceiver, enginePIDs ) )
-                    {
-                        std::sort( enginePIDs.begin(), enginePIDs.end() );
-                        OBDModule->mSupportedPIDsEngine.emplace( SID::CURRENT_STATS, enginePIDs );
-                        std::ostringstream oss;
-                        oss << ": ";
-                        if ( !enginePIDs.empty() )
-                        {
-                            std::copy(
-                                enginePIDs.begin(), enginePIDs.end() - 1, std::ostream_iterator<int>( oss, "," ) );
-                            oss << std::to_string( enginePIDs.back() );
-                        }
-                        OBDModule->mLogger.trace( "OBDOverCANModule::doWork",
-                                                  "Engine ECU supports PIDs for SID " +
-                                                      std::to_string( toUType( SID::CURRENT_STATS ) ) + oss.str() );
-                        // Take the common PIDs between the ECU supported PIDs and the PIDs that are requested by
-                        // Decoder Dictionary
-                        OBDModule->updatePIDRequestList( SID::CURRENT_STATS,
-                                                         ECUType::ENGINE,
-                                                         OBDModule->mSupportedPIDsEngine,
-                                                         OBDModule->mPIDsToRequestEngine );
-                    }
-                    else
-                    {
-                        TraceModule::get().incrementVariable( TraceVariable::OBD_ENG_PID_REQ_ERROR );
-                        OBDModule->mLogger.error( "OBDOverCANModule::doWork",
-                                                  "Failed to request/receive Engine ECU PIDs for SID: " +
-                                                      std::to_string( toUType( SID::CURRENT_STATS ) ) );
-                    }
-                }
-                // Transmission ECU
-                if ( OBDModule->mHasTransmission && OBDModule->mSupportedPIDsTransmission.empty() )
+                if ( OBDModule->mPIDScheduleOutdated.exchange( false, std::memory_order_relaxed ) )
                 {
-                    OBDModule->mLogger.trace( "OBDOverCANModule::doWork",
-                                              "Requesting Supported PIDs from Transmission ECU" );
-                    // Send the Supported PID request
-                    SupportedPIDs transmissionPIDs;
-                    if ( OBDModule->requestReceiveSupportedPIDs(
-                             SID::CURRENT_STATS, OBDModule->mTransmissionECUSenderReceiver, transmissionPIDs ) )
-                    {
-                        std::sort( transmissionPIDs.begin(), transmissionPIDs.end() );
-                        OBDModule->mSupportedPIDsTransmission.emplace( SID::CURRENT_STATS, transmissionPIDs );
-                        std::ostringstream oss;
-                        oss << ": ";
-                        if ( !transmissionPIDs.empty() )
-                        {
-                            std::copy( transmissionPIDs.begin(),
-                                       transmissionPIDs.end() - 1,
-                                       std::ostream_iterator<int>( oss, "," ) );
-                            oss << std::to_string( transmissionPIDs.back() );
-                        }
-                        OBDModule->mLogger.trace( "OBDOverCANModule::doWork",
-                                                  "Transmission ECU supports PIDs for SID " +
-                                                      std::to_string( toUType( SID::CURRENT_STATS ) ) + oss.str() );
-                        // Take the common PIDs between the ECU supported PIDs and the PIDs that are requested by
-                        // Decoder Dictionary
-                        OBDModule->updatePIDRequestList( SID::CURRENT_STATS,
-                                                         ECUType::TRANSMISSION,
-                                                         OBDModule->mSupportedPIDsTransmission,
-                                                         OBDModule->mPIDsToRequestTransmission );
-                    }
-                    else
-                    {
-                        TraceModule::get().incrementVariable( TraceVariable::OBD_TRA_PID_REQ_ERROR );
-                        OBDModule->mLogger.error( "OBDOverCANModule::doWork",
-                                                  "Failed to request/receive Transmission ECU PIDs for SID: " +
-                                                      std::to_string( toUType( SID::CURRENT_STATS ) ) );
-                    }
+                    OBDModule->updatePIDSchedule( FastClock::monotonicTimeMs() );
                 }
-
-                // Request the PIDs ( up to 6 at a time )
-                // To not overwhelm the bus, we split the PIDs into group of 6
-                // and wait for the response.
-                // Start with the ECM
-                if ( OBDModule->getPIDsToRequest( SID::CURRENT_STATS, ECUType::ENGINE, enginePIDs ) &&
-                     !enginePIDs.empty() )
+                OBDModule->popDuePIDs( FastClock::monotonicTimeMs(), OBDModule->mDuePIDs );
+                if ( !OBDModule->mDuePIDs.empty() )
                 {
-                    OBDModule->mLogger.trace( "OBDOverCANModule::doWork", "Requesting Emission PIDs from the ECM" );
-                    if ( OBDModule->requestReceiveEmissionPIDs(
-                             SID::CURRENT_STATS, enginePIDs, OBDModule->mEngineECUSenderReceiver, enginePIDInfo ) )
-                    {
-                        auto receptionTime = OBDModule->mClock->timeSinceEpochMs();
-                        for ( auto const &signals : enginePIDInfo.mPIDsToValues )
-                        {
-                            // Note Signal buffer is a multi producer single consumer queue. Besides current thread,
-                            // Vehicle Data Consumer will also push signals onto this buffer
-                            TraceModule::get().incrementAtomicVariable(
-                                TraceAtomicVariable::QUEUE_CONSUMER_TO_INSPECTION_SIGNALS );
-                            if ( !OBDModule->mSignalBufferPtr->push(
-                                     CollectedSignal( signals.first, receptionTime, signals.second ) ) )
-                            {
-                                TraceModule::get().decrementAtomicVariable(
-                                    TraceAtomicVariable::QUEUE_CONSUMER_TO_INSPECTION_SIGNALS );
-                                OBDModule->mLogger.warn( "OBDOverCANModule::doWork", "Signal Buffer full!" );
-                            }
-                            OBDModule->mLogger.trace( "OBDOverCANModule::doWork",
-                                                      "Received Signal " + std::to_string( signals.first ) + " : " +
-                                                          std::to_string( signals.second ) );
-                        }
-                        OBDModule->mLogger.trace( "OBDOverCANModule::doWork",
-                                                  "Received Emission PIDs data from the ECM" );
-                    }
-                    else
+                    // All ECUs are requested concurrently, so a slow ECU does not delay the others
+                    OBDModule->requestSupportedPIDs( SID::CURRENT_STATS, false );
+                    OBDModule->requestEmissionPIDs( SID::CURRENT_STATS, OBDModule->mDuePIDs );
+                    // Cached data is confirmed in the background, after the PIDs of this cycle were collected
+                    if ( OBDModule->mVINFromCache )
                     {
-                        OBDModule->mLogger.warn( "OBDOverCANModule::doWork",
-                                                 "Emission PIDs data from the ECM was not received" );
+                        OBDModule->revalidateCachedVIN();
                     }
-                }
-                // TCM
-                if ( OBDModule->mHasTransmission &&
-                     OBDModule->getPIDsToRequest( SID::CURRENT_STATS, ECUType::TRANSMISSION, transmissionPIDs ) &&
-                     !transmissionPIDs.empty() )
-                {
-                    OBDModule->mLogger.trace( "OBDOverCANModule::doWork", "Requesting Emission PIDs from the TCM" );
-                    if ( OBDModule->requestReceiveEmissionPIDs( SID::CURRENT_STATS,
-                                                                transmissionPIDs,
-                                                                OBDModule->mTransmissionECUSenderReceiver,
-                                                                transmissionPIDInfo ) )
+                    if ( !OBDModule->mVINFromCache )
                     {
-                        auto receptionTime = OBDModule->mClock->timeSinceEpochMs();
-                        for ( auto const &signals : transmissionPIDInfo.mPIDsToValues )
-                        {
-                            // Note Signal buffer is a multi producer single consumer queue. Besides current thread,
-                            // Vehicle Data Consumer will also push signals onto this buffer
-                            TraceModule::get().incrementAtomicVariable(
-                                TraceAtomicVariable::QUEUE_CONSUMER_TO_INSPECTION_SIGNALS );
-                            if ( !OBDModule->mSignalBufferPtr->push(
-                                     CollectedSignal( signals.first, receptionTime, signals.second ) ) )
-                            {
-                                TraceModule::get().decrementAtomicVariable(
-                                    TraceAtomicVariable::QUEUE_CONSUMER_TO_INSPECTION_SIGNALS );
-                                OBDModule->mLogger.warn( "OBDOverCANModule::doWork", "Signal Buffer full!" );
-                            }
-                        }
-                        OBDModule->mLogger.trace( "OBDOverCANModule::doWork",
-                                                  "Received Emission PIDs data from the TCM" );
+                        OBDModule->requestSupportedPIDs( SID::CURRENT_STATS, true );
                     }
-                    else
+                    if ( OBDModule->mECUCacheOutdated )
                     {
-                        OBDModule->mLogger.warn( "OBDOverCANModule::doWork",
-                                                 "Emission PIDs data from the TCM was not received" );
+                        OBDModule->storeECUCache();
                     }
                 }
-                // Reschedule
-                OBDModule->mPIDTimer.reset();
             }
         }
         // Execute the DTC flow if enabled
         if ( OBDModule->mShouldRequestDTCs.load( std::memory_order_relaxed ) )
         {
-            bool successfulDTCRequest = false;
             DTCInfo dtcInfo;
             dtcInfo.receiveTime = OBDModule->mClock->timeSinceEpochMs();
             // Request then reschedule DTC requests stored DTCs from each ECU
             if ( OBDModule->mDTCRequestIntervalSeconds > 0 &&
                  OBDModule->mDTCTimer.getElapsedSeconds() >= OBDModule->mDTCRequestIntervalSeconds )
             {
-                // ECM
-                if ( OBDModule->requestReceiveDTCs( SID::STORED_DTC, OBDModule->mEngineECUSenderReceiver, dtcInfo ) )
-                {
-                    successfulDTCRequest = true;
-                    OBDModule->mLogger.trace( "OBDOverCANModule::doWork", "Received DTC data from the ECM" );
-                }
-                else
-                {
-                    OBDModule->mLogger.warn( "OBDOverCANModule::doWork", "Failed to receive DTCs from the ECM" );
-                }
-                // TCM
-                if ( OBDModule->mHasTransmission )
-                {
-                    if ( OBDModule->requestReceiveDTCs(
-                             SID::STORED_DTC, OBDModule->mTransmissionECUSenderReceiver, dtcInfo ) )
-                    {
-                        successfulDTCRequest = true;
-                        OBDModule->mLogger.trace( "OBDOverCANModule::doWork", "Received DTC data from the TCM" );
-                    }
-                    else
-                    {
-                        OBDModule->mLogger.warn( "OBDOverCANModule::doWork", "Failed to receive DTCs from the TCM" );
-                    }
-                }
-                // Also DTCInfo strutcs without any DTCs must be pushed to the queue because it means
+                // Also a response without any DTCs is a change if DTCs were active before, as it means
                 // there was a OBD request that did not return any SID::STORED_DTCs
-                if ( successfulDTCRequest )
+                if ( OBDModule->requestReceiveDTCs( SID::STORED_DTC, dtcInfo ) )
                 {
-                    // Note DTC buffer is a single producer single consumer queue. This is the only
-                    // thread to push DTC Info to the queue
-                    if ( !OBDModule->mActiveDTCBufferPtr->push( dtcInfo ) )
-                    {
-                        OBDModule->mLogger.warn( "OBDOverCANModule::doWork", "DTC Buffer full!" );
-                    }
+                    OBDModule->pushDTCChanges( dtcInfo );
                 }
 
                 // Reschedule
@@ -473,128 +401,687 @@ OBDOverCANModule::doWork( void *data )
             }
         }
 
-        // Wait for the next cycle
-        uint32_t sleepTime =
+        // Wait for the next cycle, which is the next DTC request or the next due PID, whatever comes first
+        uint32_t sleepTimeMs =
             OBDModule->mDTCRequestIntervalSeconds > 0
-                ? std::min( OBDModule->mPIDRequestIntervalSeconds, OBDModule->mDTCRequestIntervalSeconds )
-                : OBDModule->mPIDRequestIntervalSeconds;
+                ? std::min( OBDModule->mPIDRequestIntervalSeconds, OBDModule->mDTCRequestIntervalSeconds ) * 1000
+                : OBDModule->mPIDRequestIntervalSeconds * 1000;
+        if ( OBDModule->mPIDRequestIntervalSeconds > 0 && !OBDModule->mPIDSchedule.empty() )
+        {
+            auto now = FastClock::monotonicTimeMs();
+            for ( const auto &pidSchedule : OBDModule->mPIDSchedule )
+            {
+                auto delayMs = pidSchedule.second.nextRequestTime > now ? pidSchedule.second.nextRequestTime - now : 0;
+                sleepTimeMs = static_cast<uint32_t>( std::min<Timestamp>( sleepTimeMs, delayMs ) );
+            }
+        }
+
+        if ( OBDModule->mPIDRequestIntervalSeconds > 0 && OBDModule->mDIDsRequested )
+        {
+            auto elapsedMs = static_cast<uint64_t>( OBDModule->mDIDTimer.getElapsedMs().count() );
+            auto intervalMs = static_cast<uint64_t>( OBDModule->mPIDRequestIntervalSeconds ) * 1000;
+            sleepTimeMs = static_cast<uint32_t>(
+                std::min<uint64_t>( sleepTimeMs, elapsedMs < intervalMs ? intervalMs - elapsedMs : 0 ) );
+        }
 
         OBDModule->mLogger.trace( "OBDOverCANModule::doWork",
-                                  " Waiting for :" + std::to_string( sleepTime ) + " seconds" );
-        OBDModule->mWait.wait( static_cast<uint32_t>( sleepTime * 1000 ) );
+                                  " Waiting for :" + std::to_string( sleepTimeMs ) + " ms" );
+        OBDModule->mWait.wait( sleepTimeMs );
+    }
+    // The ECUs would keep streaming the periodic DIDs after the module stopped
+    if ( OBDModule->mPeriodicDIDsStarted )
+    {
+        OBDModule->configurePeriodicDataIdentifiers( false );
+        OBDModule->mPeriodicDIDsStarted = false;
     }
 }
 
-bool
-OBDOverCANModule::requestReceiveEmissionPIDs( const SID &sid,
-                                              const SupportedPIDs &pids,
-                                              ISOTPOverCANSenderReceiver &isoTPSendReceive,
-                                              EmissionInfo &info )
+void
+OBDOverCANModule::discoverECUs()
 {
-    size_t rangeCount = pids.size() / MAX_PID_RANGE;
-    size_t rangeLeft = pids.size() % MAX_PID_RANGE;
+    int rawSocket = socket( PF_CAN, SOCK_RAW, CAN_RAW );
+    if ( rawSocket < 0 )
+    {
+        mLogger.error( "OBDOverCANModule::discoverECUs", "Failed to create the CAN socket" );
+        return;
+    }
+    // Only receive the physical responses of the ECUs
+    struct can_filter filter = {};
+    if ( mUseExtendedIDs )
+    {
+        filter.can_id = PHYSICAL_RESPONSE_ID_BASE_EXTENDED | CAN_EFF_FLAG;
+        filter.can_mask = PHYSICAL_RESPONSE_ID_MASK_EXTENDED | CAN_EFF_FLAG;
+    }
+    else
+    {
+        filter.can_id = PHYSICAL_RESPONSE_ID_BASE;
+        filter.can_mask = PHYSICAL_RESPONSE_ID_MASK | CAN_EFF_FLAG;
+    }
+    struct sockaddr_can interfaceAddress = {};
+    interfaceAddress.can_family = AF_CAN;
+    interfaceAddress.can_ifindex = static_cast<int>( if_nametoindex( mGatewayCanInterfaceName.c_str() ) );
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-cstyle-cast)
+    if ( ( setsockopt( rawSocket, SOL_CAN_RAW, CAN_RAW_FILTER, &filter, sizeof( filter ) ) < 0 ) ||
+         ( bind( rawSocket, (struct sockaddr *)&interfaceAddress, sizeof( interfaceAddress ) ) < 0 ) )
+    {
+        mLogger.error( "OBDOverCANModule::discoverECUs",
+                       "Failed to bind the CAN socket to IF:" + mGatewayCanInterfaceName );
+        close( rawSocket );
+        return;
+    }
+
+    // Supported PIDs request of SID 1 as single frame, padded like the ISO-TP frames
+    struct can_frame request = {};
+    request.can_id = mUseExtendedIDs ? ( FUNCTIONAL_REQUEST_ID_EXTENDED | CAN_EFF_FLAG ) : FUNCTIONAL_REQUEST_ID;
+    request.can_dlc = CAN_MAX_DLEN;
+    std::memset( request.data, 0xCC, CAN_MAX_DLEN );
+    request.data[0] = 0x02;
+    request.data[1] = static_cast<uint8_t>( SID::CURRENT_STATS );
+    request.data[2] = 0x00;
+    if ( write( rawSocket, &request, sizeof( request ) ) != static_cast<ssize_t>( sizeof( request ) ) )
+    {
+        mLogger.error( "OBDOverCANModule::discoverECUs", "Failed to send the functional request" );
+        close( rawSocket );
+        return;
+    }
 
-    while ( rangeCount > 0 )
+    // Collect the response IDs. A response longer than a single frame is not completed, as no flow control is
+    // sent, but its first frame is enough to know the ECU exists.
+    std::set<uint32_t> responseCANIds;
+    auto deadline = FastClock::monotonicTimeMs() + ECU_DISCOVERY_TIMEOUT_MS;
+    auto now = FastClock::monotonicTimeMs();
+    while ( now < deadline )
     {
-        auto pidList = std::vector<PID>( pids.begin() + static_cast<uint32_t>( rangeCount - 1U ) * MAX_PID_RANGE,
-                                         pids.begin() + static_cast<uint32_t>( rangeCount ) * MAX_PID_RANGE );
-        // start from the tail and walk backwards.
-        if ( requestPIDs( sid, pidList, isoTPSendReceive ) )
+        struct pollfd pfd = { rawSocket, POLLIN, 0 };
+        if ( poll( &pfd, 1U, static_cast<int>( deadline - now ) ) <= 0 )
         {
-            if ( receivePIDs( sid, pidList, isoTPSendReceive, info ) )
+            break;
+        }
+        struct can_frame response = {};
+        if ( read( rawSocket, &response, sizeof( response ) ) == static_cast<ssize_t>( sizeof( response ) ) )
+        {
+            // Positive response of SID 1 in a single frame or a first frame
+            bool isSingleFrame = ( response.data[0] & 0xF0 ) == 0x00;
+            uint8_t responseSID = isSingleFrame ? response.data[1] : response.data[2];
+            if ( responseSID == ( static_cast<uint8_t>( SID::CURRENT_STATS ) | 0x40 ) )
             {
-                mLogger.trace( "OBDOverCANModule::doWork",
-                               "Received Emission PID data for SID: " + std::to_string( toUType( sid ) ) );
+                responseCANIds.insert( response.can_id & CAN_EFF_MASK );
             }
-            else
+        }
+        now = FastClock::monotonicTimeMs();
+    }
+    close( rawSocket );
+
+    for ( auto responseCANId : responseCANIds )
+    {
+        bool known = false;
+        {
+            std::lock_guard<std::mutex> lock( mECUsMutex );
+            for ( const auto &ecu : mECUs )
+            {
+                known = known || ( ecu->isoTPSendReceive.getOptions().mDestinationCANId == responseCANId );
+            }
+        }
+        if ( known )
+        {
+            continue;
+        }
+        // The ECU is requested with the physical request ID matching its response ID
+        uint32_t requestCANId = mUseExtendedIDs
+                                    ? ( PHYSICAL_REQUEST_ID_BASE_EXTENDED | ( ( responseCANId & 0xFFU ) << 8U ) )
+                                    : ( responseCANId - PHYSICAL_REQUEST_ID_OFFSET );
+        if ( addECU( ECUType::OTHER, requestCANId, responseCANId, mGatewayCanInterfaceName, true ) )
+        {
+            mECUCacheOutdated = true;
+            mLogger.info( "OBDOverCANModule::discoverECUs",
+                          "Discovered ECU with response CAN ID: " + std::to_string( responseCANId ) );
+        }
+        else
+        {
+            mLogger.error( "OBDOverCANModule::discoverECUs",
+                           "Failed to connect to ECU with response CAN ID: " + std::to_string( responseCANId ) );
+        }
+    }
+}
+
+void
+OBDOverCANModule::clearRequests()
+{
+    for ( auto &ecu : mECUs )
+    {
+        ecu->requestCount = 0;
+        ecu->nextRequest = 0;
+    }
+}
+
+OBDOverCANModule::ECURequest &
+OBDOverCANModule::addRequest( ECUSession &ecu )
+{
+    if ( ecu.requestCount == ecu.requests.size() )
+    {
+        ecu.requests.emplace_back();
+    }
+    auto &request = ecu.requests[ecu.requestCount++];
+    request.pdu.clear();
+    return request;
+}
+
+void
+OBDOverCANModule::sendReceiveConcurrently()
+{
+    const auto noDeadline = std::numeric_limits<Timestamp>::max();
+    // Sends the next request of the ECU. Requests that fail to be sent are dropped. The deadline is noDeadline if the
+    // ECU has no outstanding request.
+    auto sendNext = [&]( ECUSession &ecu ) {
+        ecu.deadline = noDeadline;
+        for ( ; ecu.nextRequest < ecu.requestCount; ecu.nextRequest++ )
+        {
+            const auto &pdu = ecu.requests[ecu.nextRequest].pdu;
+            tracePDU( "OBDOverCANModule::sendReceiveConcurrently", "TxPDU: ", pdu.data(), pdu.size() );
+            if ( ecu.isoTPSendReceive.sendPDU( pdu.data(), pdu.size() ) )
             {
-                mLogger.warn( "OBDOverCANModule::doWork",
-                              "Emission PID data for SID: " + std::to_string( toUType( sid ) ) + " Not received" );
+                ecu.deadline = FastClock::monotonicTimeMs() + ecu.isoTPSendReceive.getOptions().mP2TimeoutMs;
+                return;
             }
         }
-        rangeCount--;
+    };
+    for ( auto &ecu : mECUs )
+    {
+        sendNext( *ecu );
     }
-    // request the remaining PIDs if any.
-    if ( rangeLeft > 0 )
+
+    while ( !shouldStop() )
     {
-        auto pidList = std::vector<PID>( pids.end() - static_cast<uint32_t>( rangeLeft ), pids.end() );
-        if ( requestPIDs( sid, pidList, isoTPSendReceive ) )
+        mPollFDs.clear();
+        mPollECUs.clear();
+        Timestamp nextDeadline = noDeadline;
+        for ( size_t i = 0; i < mECUs.size(); i++ )
         {
-            if ( receivePIDs( sid, pidList, isoTPSendReceive, info ) )
+            if ( mECUs[i]->deadline != noDeadline )
             {
-                mLogger.trace( "OBDOverCANModule::doWork",
-                               "Received Emission PID data for SID: " + std::to_string( toUType( sid ) ) );
+                mPollFDs.push_back( { mECUs[i]->isoTPSendReceive.getSocket(), POLLIN, 0 } );
+                mPollECUs.push_back( i );
+                nextDeadline = std::min( nextDeadline, mECUs[i]->deadline );
+            }
+        }
+        if ( mPollFDs.empty() )
+        {
+            // All requests are done
+            return;
+        }
+        auto now = FastClock::monotonicTimeMs();
+        int timeout = nextDeadline > now ? static_cast<int>( nextDeadline - now ) : 0;
+        if ( poll( mPollFDs.data(), mPollFDs.size(), timeout ) < 0 )
+        {
+            mLogger.error( "OBDOverCANModule::sendReceiveConcurrently", "Failed to poll the ISO-TP sockets" );
+            return;
+        }
+        now = FastClock::monotonicTimeMs();
+        for ( size_t j = 0; j < mPollFDs.size(); j++ )
+        {
+            auto ecuIndex = mPollECUs[j];
+            auto &ecu = *mECUs[ecuIndex];
+            if ( ( mPollFDs[j].revents & ( POLLIN | POLLERR | POLLHUP ) ) != 0 )
+            {
+                // The socket is readable, so the receive does not block
+                size_t responseSize = 0;
+                if ( ecu.isoTPSendReceive.receivePDU(
+                         ecu.responseBuffer.data(), ecu.responseBuffer.size(), responseSize ) )
+                {
+                    tracePDU( "OBDOverCANModule::sendReceiveConcurrently",
+                              "ECU Response: ",
+                              ecu.responseBuffer.data(),
+                              responseSize );
+                    const auto &request = ecu.requests[ecu.nextRequest];
+                    request.onResponse( ecuIndex, request, ecu.responseBuffer.data(), responseSize );
+                }
+            }
+            else if ( now < ecu.deadline )
+            {
+                continue;
             }
             else
             {
-                mLogger.warn( "OBDOverCANModule::doWork",
-                              "Emission PID data for SID: " + std::to_string( toUType( sid ) ) + " Not received" );
+                mLogger.warn( "OBDOverCANModule::sendReceiveConcurrently",
+                              "Request to ECU " + std::to_string( ecuIndex ) + " timed out" );
             }
+            ecu.nextRequest++;
+            sendNext( ecu );
+        }
+    }
+}
+
+void
+OBDOverCANModule::requestSupportedPIDs( const SID &sid, bool revalidateCache )
+{
+    clearRequests();
+    for ( size_t i = 0; i < mECUs.size(); i++ )
+    {
+        bool supportedPIDsKnown = mECUs[i]->supportedPIDs.find( sid ) != mECUs[i]->supportedPIDs.end();
+        if ( !mECUs[i]->isoTPSendReceive.isAlive() ||
+             ( revalidateCache ? !mECUs[i]->supportedPIDsFromCache : supportedPIDsKnown ) )
+        {
+            continue;
         }
+        mLogger.trace( "OBDOverCANModule::requestSupportedPIDs",
+                       "Requesting Supported PIDs from ECU " + std::to_string( i ) );
+        // Every ECU should support such kind of request.
+        // J1979 8.1
+        // First insert the SID, then insert the PID ranges
+        auto &request = addRequest( *mECUs[i] );
+        request.pdu.emplace_back( static_cast<uint8_t>( sid ) );
+        request.pdu.insert( request.pdu.end(), std::begin( supportedPIDRange ), std::end( supportedPIDRange ) );
+        request.onResponse = [this, sid]( size_t i, const ECURequest &, const uint8_t *response, size_t size ) {
+            // Decoded according to J1979 8.1.2.2
+            SupportedPIDs supportedPIDs;
+            if ( !mOBDDataDecoder->decodeSupportedPIDs( sid, response, size, supportedPIDs ) )
+            {
+                return;
+            }
+            std::sort( supportedPIDs.begin(), supportedPIDs.end() );
+            std::ostringstream oss;
+            oss << ": ";
+            if ( !supportedPIDs.empty() )
+            {
+                std::copy( supportedPIDs.begin(), supportedPIDs.end() - 1, std::ostream_iterator<int>( oss, "," ) );
+                oss << std::to_string( supportedPIDs.back() );
+            }
+            mLogger.trace( "OBDOverCANModule::requestSupportedPIDs",
+                           "ECU " + std::to_string( i ) + " supports PIDs for SID " +
+                               std::to_string( toUType( sid ) ) + oss.str() );
+            std::lock_guard<std::mutex> lock( mECUsMutex );
+            mECUs[i]->supportedPIDsFromCache = false;
+            auto knownPIDs = mECUs[i]->supportedPIDs.find( sid );
+            if ( ( knownPIDs != mECUs[i]->supportedPIDs.end() ) && ( knownPIDs->second == supportedPIDs ) )
+            {
+                return;
+            }
+            mECUs[i]->supportedPIDs[sid] = supportedPIDs;
+            mECUCacheOutdated = true;
+            // Take the common PIDs between the ECU supported PIDs and the PIDs that are requested by
+            // Decoder Dictionary
+            updatePIDRequestList( sid, *mECUs[i] );
+        };
     }
+    sendReceiveConcurrently();
 
-    return !info.mPIDsToValues.empty();
+    for ( size_t i = 0; i < mECUs.size(); i++ )
+    {
+        // The request is done once it was answered or timed out
+        if ( ( mECUs[i]->nextRequest == mECUs[i]->requestCount ) &&
+             mECUs[i]->supportedPIDs.find( sid ) == mECUs[i]->supportedPIDs.end() &&
+             mECUs[i]->isoTPSendReceive.isAlive() )
+        {
+            if ( mECUs[i]->type == ECUType::ENGINE )
+            {
+                TraceModule::get().incrementVariable( TraceVariable::OBD_ENG_PID_REQ_ERROR );
+            }
+            else if ( mECUs[i]->type == ECUType::TRANSMISSION )
+            {
+                TraceModule::get().incrementVariable( TraceVariable::OBD_TRA_PID_REQ_ERROR );
+            }
+            mLogger.error( "OBDOverCANModule::requestSupportedPIDs",
+                           "Failed to request/receive PIDs of ECU " + std::to_string( i ) +
+                               " for SID: " + std::to_string( toUType( sid ) ) );
+        }
+    }
 }
 
-bool
-OBDOverCANModule::requestReceiveSupportedPIDs( const SID &sid,
-                                               ISOTPOverCANSenderReceiver &isoTPSendReceive,
-                                               SupportedPIDs &supportedPIDs )
+void
+OBDOverCANModule::requestEmissionPIDs( const SID &sid, const std::vector<PID> &duePIDs )
 {
+    clearRequests();
+    // The requested PIDs are the PDU without the SID, so the handler only needs this and is stored without
+    // allocation
+    auto onResponse = [this]( size_t i, const ECURequest &request, const uint8_t *response, size_t size ) {
+        auto requestSID = static_cast<SID>( request.pdu[0] );
+        mEmissionInfo.mSignals.clear();
+        if ( !mOBDDataDecoder->decodeEmissionPIDs(
+                 requestSID, &request.pdu[1], request.pdu.size() - 1U, response, size, mEmissionInfo ) )
+        {
+            mLogger.warn( "OBDOverCANModule::requestEmissionPIDs",
+                          "Emission PID data for SID: " + std::to_string( toUType( requestSID ) ) + " of ECU " +
+                              std::to_string( i ) + " Not decoded" );
+            return;
+        }
+        pushDecodedSignals( mEmissionInfo, mClock->timeSinceEpochMs() );
+    };
+    for ( auto &ecu : mECUs )
+    {
+        // Only the due PIDs that the ECU supports are requested. Both lists are sorted.
+        auto &pids = mECUDuePIDs;
+        pids.clear();
+        {
+            std::lock_guard<std::mutex> lock( mECUsMutex );
+            auto pidIterator = ecu->pidsToRequest.find( sid );
+            if ( pidIterator != ecu->pidsToRequest.end() )
+            {
+                std::set_intersection( pidIterator->second.begin(),
+                                       pidIterator->second.end(),
+                                       duePIDs.begin(),
+                                       duePIDs.end(),
+                                       std::back_inserter( pids ) );
+            }
+        }
+        // To not overwhelm the ECU, we split the PIDs into group of 6 and wait for each response.
+        // Start from the tail and walk backwards, then request the remaining PIDs if any.
+        // First insert the SID, then the PIDs. They belong to the SID and are supported by the ECU.
+        auto addPIDRequest = [&]( size_t first, size_t count ) {
+            auto &request = addRequest( *ecu );
+            request.pdu.emplace_back( static_cast<uint8_t>( sid ) );
+            request.pdu.insert( request.pdu.end(),
+                                pids.begin() + static_cast<std::ptrdiff_t>( first ),
+                                pids.begin() + static_cast<std::ptrdiff_t>( first + count ) );
+            request.onResponse = onResponse;
+        };
+        for ( size_t rangeCount = pids.size() / MAX_PID_RANGE; rangeCount > 0; rangeCount-- )
+        {
+            addPIDRequest( ( rangeCount - 1U ) * MAX_PID_RANGE, MAX_PID_RANGE );
+        }
+        size_t rangeLeft = pids.size() % MAX_PID_RANGE;
+        if ( rangeLeft > 0 )
+        {
+            addPIDRequest( pids.size() - rangeLeft, rangeLeft );
+        }
+    }
+    sendReceiveConcurrently();
+}
 
-    // Request and try to receive within the time interval
-    if ( requestSupportedPIDs( sid, isoTPSendReceive ) )
+void
+OBDOverCANModule::pushDecodedSignals( const EmissionInfo &info, Timestamp receptionTime )
+{
+    mPendingSignals.clear();
+    for ( auto const &signal : info.mSignals )
+    {
+        mPendingSignals.emplace_back( signal.first, receptionTime, signal.second );
+        mLogger.trace( "OBDOverCANModule::pushDecodedSignals", [&signal]() {
+            return "Received Signal " + std::to_string( signal.first ) + " : " + std::to_string( signal.second );
+        } );
+    }
+    if ( mPendingSignals.empty() )
+    {
+        return;
+    }
+    // Note Signal buffer is a multi producer single consumer queue. Besides current thread,
+    // Vehicle Data Consumer will also push signals onto this buffer, each to an own ring. All signals of the response
+    // are pushed at once, so the ring indices and the queue counter are only updated once.
+    TraceModule::get().addToAtomicVariable( TraceAtomicVariable::QUEUE_CONSUMER_TO_INSPECTION_SIGNALS,
+                                            mPendingSignals.size() );
+    auto pushed = mSignalProducer->push( mPendingSignals.data(), mPendingSignals.size() );
+    if ( pushed < mPendingSignals.size() )
     {
-        // Wait and process the response
-        if ( receiveSupportedPIDs( sid, isoTPSendReceive, supportedPIDs ) )
+        auto dropped = mPendingSignals.size() - pushed;
+        TraceModule::get().subtractFromAtomicVariable( TraceAtomicVariable::QUEUE_CONSUMER_TO_INSPECTION_SIGNALS,
+                                                       dropped );
+        TraceModule::get().addToAtomicVariable( TraceAtomicVariable::QUEUE_FULL_DROPPED_SIGNALS, dropped );
+        mLogger.warn( "OBDOverCANModule::pushDecodedSignals", "Signal Buffer full!" );
+    }
+}
+
+std::map<uint32_t, OBDOverCANModule::UDSDataIdentifiers>
+OBDOverCANModule::toUDSDataIdentifiers( const CANDecoderDictionary &dictionary )
+{
+    std::map<uint32_t, UDSDataIdentifiers> dataIdentifiers;
+    // The channel is the request CAN ID of the ECU and the key holds the DID and its transmission mode
+    for ( const auto &ecu : dictionary.canMessageDecoderMethod )
+    {
+        auto &ecuDataIdentifiers = dataIdentifiers[ecu.first];
+        for ( const auto &didDecoderMethod : ecu.second )
         {
-            return true;
+            auto did = static_cast<DID>( didDecoderMethod.first & UINT16_MAX );
+            auto transmissionMode = static_cast<uint8_t>( didDecoderMethod.first >> 16U );
+            if ( transmissionMode == 0 )
+            {
+                ecuDataIdentifiers.polledDIDs.emplace_back( did, didDecoderMethod.second.format );
+            }
+            else
+            {
+                ecuDataIdentifiers.periodicDIDs[transmissionMode].emplace_back( static_cast<uint8_t>( did ) );
+            }
         }
+        std::sort( ecuDataIdentifiers.polledDIDs.begin(),
+                   ecuDataIdentifiers.polledDIDs.end(),
+                   []( const std::pair<DID, CANMessageFormat> &left, const std::pair<DID, CANMessageFormat> &right ) {
+                       return left.first < right.first;
+                   } );
     }
-    return false;
+    return dataIdentifiers;
+}
+
+void
+OBDOverCANModule::requestDataIdentifiers()
+{
+    clearRequests();
+    for ( size_t i = 0; i < mECUs.size(); i++ )
+    {
+        auto ecuDataIdentifiers =
+            mActiveUDSDataIdentifiers.find( mECUs[i]->isoTPSendReceive.getOptions().mSourceCANId );
+        if ( ecuDataIdentifiers == mActiveUDSDataIdentifiers.end() )
+        {
+            continue;
+        }
+        for ( const auto &didFormat : ecuDataIdentifiers->second.polledDIDs )
+        {
+            auto &request = addRequest( *mECUs[i] );
+            request.pdu.insert( request.pdu.end(),
+                                { UDS_READ_DATA_BY_IDENTIFIER,
+                                  static_cast<uint8_t>( didFormat.first >> 8U ),
+                                  static_cast<uint8_t>( didFormat.first ) } );
+            const auto *didFormatPtr = &didFormat;
+            request.onResponse =
+                [this, didFormatPtr]( size_t, const ECURequest &, const uint8_t *response, size_t size ) {
+                    mEmissionInfo.mSignals.clear();
+                    if ( mOBDDataDecoder->decodeDataIdentifier(
+                             didFormatPtr->first, response, size, didFormatPtr->second, mEmissionInfo ) )
+                    {
+                        pushDecodedSignals( mEmissionInfo, mClock->timeSinceEpochMs() );
+                    }
+                };
+        }
+    }
+    sendReceiveConcurrently();
+}
+
+void
+OBDOverCANModule::configurePeriodicDataIdentifiers( bool start )
+{
+    clearRequests();
+    for ( size_t i = 0; i < mECUs.size(); i++ )
+    {
+        auto ecuDataIdentifiers =
+            mActiveUDSDataIdentifiers.find( mECUs[i]->isoTPSendReceive.getOptions().mSourceCANId );
+        if ( ecuDataIdentifiers == mActiveUDSDataIdentifiers.end() )
+        {
+            continue;
+        }
+        // One request per transmission mode to start, and one request for all DIDs to stop
+        ECURequest *request = nullptr;
+        for ( const auto &modeDIDs : ecuDataIdentifiers->second.periodicDIDs )
+        {
+            if ( start || ( request == nullptr ) )
+            {
+                request = &addRequest( *mECUs[i] );
+                request->pdu.insert(
+                    request->pdu.end(),
+                    { UDS_READ_DATA_BY_PERIODIC_IDENTIFIER, start ? modeDIDs.first : UDS_PERIODIC_STOP_SENDING } );
+                request->onResponse =
+                    [this, start]( size_t ecuIndex, const ECURequest &, const uint8_t *response, size_t ) {
+                        if ( response[0] != POSITIVE_UDS_RESPONSE_BASE + UDS_READ_DATA_BY_PERIODIC_IDENTIFIER )
+                        {
+                            mLogger.warn( "OBDOverCANModule::configurePeriodicDataIdentifiers",
+                                          std::string( start ? "Start" : "Stop" ) +
+                                              " of periodic DIDs rejected by ECU " + std::to_string( ecuIndex ) );
+                        }
+                    };
+            }
+            request->pdu.insert( request->pdu.end(), modeDIDs.second.begin(), modeDIDs.second.end() );
+        }
+    }
+    sendReceiveConcurrently();
 }
 
 bool
-OBDOverCANModule::connect()
+OBDOverCANModule::requestReceiveDTCs( const SID &sid, DTCInfo &info )
 {
-    if ( mHasTransmission )
+    bool successfulDTCRequest = false;
+    clearRequests();
+    for ( auto &ecu : mECUs )
     {
-        mTransmissionECUSenderReceiver.connect();
+        // Only SID is required for DTC requests
+        auto &request = addRequest( *ecu );
+        request.pdu.emplace_back( static_cast<uint8_t>( sid ) );
+        // The info structure will be appended with the new decoded DTCs
+        request.onResponse = [this, sid, &info, &successfulDTCRequest](
+                                 size_t i, const ECURequest &, const uint8_t *response, size_t size ) {
+            if ( mOBDDataDecoder->decodeDTCs( sid, response, size, info ) )
+            {
+                successfulDTCRequest = true;
+                mLogger.trace( "OBDOverCANModule::requestReceiveDTCs",
+                               "Received DTC data from ECU " + std::to_string( i ) );
+            }
+        };
+    }
+    sendReceiveConcurrently();
+    if ( !successfulDTCRequest )
+    {
+        mLogger.warn( "OBDOverCANModule::requestReceiveDTCs", "Failed to receive DTCs from the ECUs" );
     }
+    return successfulDTCRequest;
+}
 
-    return mEngineECUSenderReceiver.connect() && start();
+void
+OBDOverCANModule::pushDTCChanges( DTCInfo &dtcInfo )
+{
+    auto &codes = dtcInfo.mDTCCodes;
+    std::sort( codes.begin(), codes.end() );
+    codes.erase( std::unique( codes.begin(), codes.end() ), codes.end() );
+    if ( ( !mDTCResyncRequired ) && ( codes == mLastDTCCodes ) )
+    {
+        return;
+    }
+
+    DTCInfo update;
+    update.mSID = dtcInfo.mSID;
+    update.receiveTime = dtcInfo.receiveTime;
+    update.mSequenceNumber = ++mDTCSequenceNumber;
+    if ( mDTCResyncRequired )
+    {
+        update.mDTCCodes = codes;
+    }
+    else
+    {
+        update.mIsDelta = true;
+        std::set_difference( codes.begin(),
+                             codes.end(),
+                             mLastDTCCodes.begin(),
+                             mLastDTCCodes.end(),
+                             std::back_inserter( update.mDTCCodes ) );
+        std::set_difference( mLastDTCCodes.begin(),
+                             mLastDTCCodes.end(),
+                             codes.begin(),
+                             codes.end(),
+                             std::back_inserter( update.mRemovedDTCCodes ) );
+    }
+    mLastDTCCodes = std::move( codes );
+
+    // Note DTC buffer is a single producer single consumer queue. This is the only
+    // thread to push DTC Info to the queue
+    mDTCResyncRequired = !mActiveDTCBufferPtr->push( update );
+    if ( mDTCResyncRequired )
+    {
+        mLogger.warn( "OBDOverCANModule::pushDTCChanges", "DTC Buffer full! The full DTC set is sent next time" );
+    }
+    else
+    {
+        mLogger.trace( "OBDOverCANModule::pushDTCChanges",
+                       "Pushed DTC set " + std::to_string( update.mSequenceNumber ) + " with " +
+                           std::to_string( mLastDTCCodes.size() ) + " DTCs" );
+    }
 }
 
 bool
-OBDOverCANModule::disconnect()
+OBDOverCANModule::connect()
 {
-    if ( mHasTransmission )
+    bool connected = true;
     {
-        mTransmissionECUSenderReceiver.disconnect();
+        std::lock_guard<std::mutex> lock( mECUsMutex );
+        // Discovered ECUs of a previous connection are discovered again
+        while ( mECUs.size() > 1U && mECUs.back()->type == ECUType::OTHER )
+        {
+            mECUs.pop_back();
+        }
+        for ( auto &ecu : mECUs )
+        {
+            connected = ecu->isoTPSendReceive.connect() && connected;
+        }
     }
-    return mEngineECUSenderReceiver.disconnect() && stop();
+    mECUDiscoveryDone = false;
+    return connected && start();
 }
 
 bool
-OBDOverCANModule::isAlive()
+OBDOverCANModule::disconnect()
 {
-    if ( mHasTransmission )
+    // Stop the thread first, so that no request is ongoing while the sockets are closed
+    bool stopped = stop();
+    bool disconnected = true;
+    std::lock_guard<std::mutex> lock( mECUsMutex );
+    for ( auto &ecu : mECUs )
     {
-        return mThread.isValid() && mThread.isActive() && mEngineECUSenderReceiver.isAlive() &&
-               mTransmissionECUSenderReceiver.isAlive();
+        disconnected = ecu->isoTPSendReceive.disconnect() && disconnected;
     }
-    else
+    return disconnected && stopped;
+}
+
+bool
+OBDOverCANModule::isAlive()
+{
+    if ( !mThread.isValid() || !mThread.isActive() )
     {
-        return mThread.isValid() && mThread.isActive() && mEngineECUSenderReceiver.isAlive();
+        return false;
     }
+    std::lock_guard<std::mutex> lock( mECUsMutex );
+    return std::all_of( mECUs.begin(), mECUs.end(), []( const std::unique_ptr<ECUSession> &ecu ) {
+        return ecu->isoTPSendReceive.isAlive();
+    } );
+}
+
+size_t
+OBDOverCANModule::getECUCount() const
+{
+    std::lock_guard<std::mutex> lock( mECUsMutex );
+    return mECUs.size();
 }
 
 void
 OBDOverCANModule::onChangeInspectionMatrix( const std::shared_ptr<const InspectionMatrix> &activeConditions )
 {
-    // We check here that at least one condition needs DTCs. If yes, we activate that.
     if ( activeConditions )
     {
+        // Collect the smallest sample interval of every signal, which defines the request interval of its PID
+        std::unordered_map<SignalID, uint32_t> signalSampleIntervalsMs;
+        for ( auto const &condition : activeConditions->conditions )
+        {
+            for ( auto const &signal : condition.signals )
+            {
+                if ( signal.minimumSampleIntervalMs == 0 )
+                {
+                    continue;
+                }
+                auto interval = signalSampleIntervalsMs.emplace( signal.signalID, signal.minimumSampleIntervalMs );
+                if ( !interval.second )
+                {
+                    interval.first->second = std::min( interval.first->second, signal.minimumSampleIntervalMs );
+                }
+            }
+        }
+        {
+            std::lock_guard<InstrumentedMutex> lock( mDecoderDictMutex );
+            mSignalSampleIntervalsMs = std::move( signalSampleIntervalsMs );
+        }
+        mPIDScheduleOutdated.store( true, std::memory_order_relaxed );
+
+        // We check here that at least one condition needs DTCs. If yes, we activate that.
         for ( auto const &condition : activeConditions->conditions )
         {
             if ( condition.includeActiveDtcs )
@@ -619,7 +1106,7 @@ OBDOverCANModule::onChangeOfActiveDictionary( ConstDecoderDictionaryConstPtr &di
     {
         {
 
-            std::lock_guard<std::mutex> lock( mDecoderDictMutex );
+            std::lock_guard<InstrumentedMutex> lock( mDecoderDictMutex );
             mDecoderDictionaryPtr = std::make_shared<OBDDecoderDictionary>();
             // Here we up cast the decoder dictionary to CAN Decoder Dictionary to extract can decoder method
             auto canDecoderDictionaryPtr = std::dynamic_pointer_cast<const CANDecoderDictionary>( dictionary );
@@ -670,11 +1157,16 @@ OBDOverCANModule::onChangeOfActiveDictionary( ConstDecoderDictionaryConstPtr &di
                                "Decoder Dictionary requests PIDs: " + oss.str() );
                 // For now we only support OBD Service Mode 1 PID
                 mPIDsRequestedByDecoderDict[SID::CURRENT_STATS] = pidsRequestedByDecoderDict;
-                // If the program already know the supported PIDs from ECU, below two update will update
-                // the PIDs list to request from ECU. Otherwise, the two function below will not perform anything.
-                updatePIDRequestList( SID::CURRENT_STATS, ECUType::ENGINE, mSupportedPIDsEngine, mPIDsToRequestEngine );
-                updatePIDRequestList(
-                    SID::CURRENT_STATS, ECUType::TRANSMISSION, mSupportedPIDsTransmission, mPIDsToRequestTransmission );
+                mPIDScheduleOutdated.store( true, std::memory_order_relaxed );
+                // If the program already know the supported PIDs from an ECU, below update will update
+                // the PIDs list to request from the ECU. Otherwise, it will not perform anything.
+                {
+                    std::lock_guard<std::mutex> ecusLock( mECUsMutex );
+                    for ( auto &ecu : mECUs )
+                    {
+                        updatePIDRequestList( SID::CURRENT_STATS, *ecu );
+                    }
+                }
                 // Pass on the decoder manifest to the OBD Decoder and wake up the thread.
                 // Before that we should interrupt the thread so that no further decoding
                 // is done using the previous decoder, then assign the new decoder manifest,
@@ -694,28 +1186,43 @@ OBDOverCANModule::onChangeOfActiveDictionary( ConstDecoderDictionaryConstPtr &di
             }
         }
     }
+    else if ( networkProtocol == VehicleDataSourceProtocol::UDS )
+    {
+        auto canDecoderDictionaryPtr = std::dynamic_pointer_cast<const CANDecoderDictionary>( dictionary );
+        {
+            std::lock_guard<InstrumentedMutex> lock( mDecoderDictMutex );
+            mUDSDataIdentifiers.clear();
+            if ( canDecoderDictionaryPtr != nullptr )
+            {
+                mUDSDataIdentifiers = toUDSDataIdentifiers( *canDecoderDictionaryPtr );
+            }
+        }
+        // The worker thread takes over the DIDs, which also stops the streaming of the previous periodic DIDs
+        mUDSDictionaryAvailable.store( true, std::memory_order_relaxed );
+        mDataAvailableWait.notify();
+        mWait.notify();
+        mLogger.info( "OBDOverCANModule::onChangeOfActiveDictionary", "UDS Decoder Dictionary Updated" );
+    }
 }
 
 void
-OBDOverCANModule::updatePIDRequestList( const SID &sid,
-                                        const ECUType &type,
-                                        std::map<SID, SupportedPIDs> &supportedPIDs,
-                                        std::map<SID, std::vector<PID>> &pidsToRequestPerService )
+OBDOverCANModule::updatePIDRequestList( const SID &sid, ECUSession &ecu )
 {
     // Update the PID Request List with PIDs that are common between decoder dictionary and the PIDs supported by ECU
-    if ( supportedPIDs.find( sid ) != supportedPIDs.end() &&
-         mPIDsRequestedByDecoderDict.find( sid ) != mPIDsRequestedByDecoderDict.end() )
+    auto supportedPIDs = ecu.supportedPIDs.find( sid );
+    auto requestedPIDs = mPIDsRequestedByDecoderDict.find( sid );
+    if ( supportedPIDs != ecu.supportedPIDs.end() && requestedPIDs != mPIDsRequestedByDecoderDict.end() )
     {
         std::vector<PID> pidsToRequest{};
         // Note that the two vector has to be sorted previously to use the function below properly
-        std::set_intersection( supportedPIDs[sid].begin(),
-                               supportedPIDs[sid].end(),
-                               mPIDsRequestedByDecoderDict[sid].begin(),
-                               mPIDsRequestedByDecoderDict[sid].end(),
+        std::set_intersection( supportedPIDs->second.begin(),
+                               supportedPIDs->second.end(),
+                               requestedPIDs->second.begin(),
+                               requestedPIDs->second.end(),
                                std::back_inserter( pidsToRequest ) );
         std::ostringstream oss;
         oss << "The PIDs to Request from ";
-        switch ( type )
+        switch ( ecu.type )
         {
         case ECUType::ENGINE:
             oss << "Engine ECU are: ";
@@ -732,159 +1239,259 @@ OBDOverCANModule::updatePIDRequestList( const SID &sid,
             oss << std::to_string( pidsToRequest.back() );
         }
         mLogger.trace( "OBDOverCANModule::updatePIDRequestList", oss.str() );
-        pidsToRequestPerService[sid] = pidsToRequest;
+        ecu.pidsToRequest[sid] = pidsToRequest;
     }
 }
 
-bool
-OBDOverCANModule::requestSupportedPIDs( const SID &sid, ISOTPOverCANSenderReceiver &isoTPSendReceive )
+void
+OBDOverCANModule::updatePIDSchedule( Timestamp now )
 {
-    mTxPDU.clear();
-    // Every ECU should support such kind of request.
-    // J1979 8.1
-    // First insert the SID
-    mTxPDU.emplace_back( static_cast<uint8_t>( sid ) );
-    // Then insert the PID ranges
-    mTxPDU.insert( mTxPDU.end(), std::begin( supportedPIDRange ), std::end( supportedPIDRange ) );
-    mLogger.trace( "OBDOverCANModule::requestSupportedPIDs", "send supported PID requests" );
-
-    std::ostringstream oss;
-    std::copy( mTxPDU.begin(), mTxPDU.end() - 1, std::ostream_iterator<int>( oss, "," ) );
-    oss << std::to_string( mTxPDU.back() );
-    mLogger.trace( "OBDOverCANModule::requestSupportedPIDs", "TxPDU: " + oss.str() );
-    return isoTPSendReceive.sendPDU( mTxPDU );
-}
+    std::map<PID, PIDSchedule> pidSchedule;
+    {
+        std::lock_guard<InstrumentedMutex> lock( mDecoderDictMutex );
+        auto requestedPIDs = mPIDsRequestedByDecoderDict.find( SID::CURRENT_STATS );
+        if ( requestedPIDs == mPIDsRequestedByDecoderDict.end() || !mDecoderDictionaryPtr )
+        {
+            mPIDSchedule.clear();
+            return;
+        }
+        for ( auto pid : requestedPIDs->second )
+        {
+            uint32_t intervalMs = 0;
+            auto format = mDecoderDictionaryPtr->find( pid );
+            if ( format != mDecoderDictionaryPtr->end() )
+            {
+                for ( const auto &signal : format->second.mSignals )
+                {
+                    auto signalInterval = mSignalSampleIntervalsMs.find( signal.mSignalID );
+                    if ( ( signalInterval != mSignalSampleIntervalsMs.end() ) &&
+                         ( ( intervalMs == 0 ) || ( signalInterval->second < intervalMs ) ) )
+                    {
+                        intervalMs = signalInterval->second;
+                    }
+                }
+            }
+            pidSchedule[pid].intervalMs =
+                intervalMs == 0 ? mPIDRequestIntervalSeconds * 1000 : std::max( intervalMs, MIN_PID_REQUEST_INTERVAL_MS );
+        }
+    }
 
-bool
-OBDOverCANModule::receiveSupportedPIDs( const SID &sid,
-                                        ISOTPOverCANSenderReceiver &isoTPSendReceive,
-                                        SupportedPIDs &supportedPIDs )
-{
-    supportedPIDs.clear();
-    std::vector<uint8_t> ecuResponse;
-    // Receive the PDU that has the Supported PIDs for this SID
-    // decoded according to J1979 8.1.2.2
-    if ( !isoTPSendReceive.receivePDU( ecuResponse ) )
+    // PIDs at the default interval are all due together as before. PIDs with an own interval are grouped by interval,
+    // and the groups of up to 6 PIDs get evenly spread offsets within the interval.
+    std::map<uint32_t, std::vector<PID>> pidsByInterval;
+    for ( auto &entry : pidSchedule )
     {
-        return false;
+        auto previous = mPIDSchedule.find( entry.first );
+        if ( ( previous != mPIDSchedule.end() ) && ( previous->second.intervalMs == entry.second.intervalMs ) )
+        {
+            // Keep the phase of PIDs that did not change
+            entry.second.nextRequestTime = previous->second.nextRequestTime;
+        }
+        else if ( entry.second.intervalMs == mPIDRequestIntervalSeconds * 1000 )
+        {
+            entry.second.nextRequestTime = now;
+        }
+        else
+        {
+            pidsByInterval[entry.second.intervalMs].emplace_back( entry.first );
+        }
     }
-    if ( !ecuResponse.empty() )
+    for ( const auto &pids : pidsByInterval )
     {
-        std::ostringstream oss;
-        std::copy( ecuResponse.begin(), ecuResponse.end() - 1, std::ostream_iterator<int>( oss, "," ) );
-        oss << std::to_string( ecuResponse.back() );
-        mLogger.trace( "OBDOverCANModule::receiveSupportedPIDs", "ECU Response: " + oss.str() );
-        return mOBDDataDecoder->decodeSupportedPIDs( sid, ecuResponse, supportedPIDs );
+        size_t groupCount = ( pids.second.size() + MAX_PID_RANGE - 1 ) / MAX_PID_RANGE;
+        for ( size_t i = 0; i < pids.second.size(); i++ )
+        {
+            pidSchedule[pids.second[i]].nextRequestTime = now + ( pids.first * ( i / MAX_PID_RANGE ) ) / groupCount;
+        }
     }
-    return false;
+    mPIDSchedule = std::move( pidSchedule );
 }
 
-bool
-OBDOverCANModule::requestPIDs( const SID &sid,
-                               const std::vector<PID> &pids,
-                               ISOTPOverCANSenderReceiver &isoTPSendReceive )
+void
+OBDOverCANModule::popDuePIDs( Timestamp now, std::vector<PID> &duePIDs )
 {
-    mTxPDU.clear();
-    // Assume that the PIDs belong to the SID, and that they are
-    // supported by the ECU
-    // ECUs do not support more than 6 PIDs at a time.
-    if ( pids.size() > MAX_PID_RANGE )
+    duePIDs.clear();
+    for ( auto &entry : mPIDSchedule )
     {
-        return false;
+        if ( entry.second.nextRequestTime > now )
+        {
+            continue;
+        }
+        duePIDs.emplace_back( entry.first );
+        // Keep the phase unless the request is overdue by more than one interval
+        entry.second.nextRequestTime += entry.second.intervalMs;
+        if ( entry.second.nextRequestTime <= now )
+        {
+            entry.second.nextRequestTime = now + entry.second.intervalMs;
+        }
     }
-    // First insert the SID
-    mTxPDU.emplace_back( static_cast<uint8_t>( sid ) );
-    // Then insert the items of the PIDs
-    mTxPDU.insert( std::end( mTxPDU ), std::begin( pids ), std::end( pids ) );
-    std::ostringstream oss;
-    std::copy( mTxPDU.begin(), mTxPDU.end() - 1, std::ostream_iterator<int>( oss, "," ) );
-    oss << std::to_string( mTxPDU.back() );
-    mLogger.trace( "OBDOverCANModule::requestPIDs", "Transmit PDU: " + oss.str() );
-    // Send
-    return isoTPSendReceive.sendPDU( mTxPDU );
 }
 
-bool
-OBDOverCANModule::receivePIDs( const SID &sid,
-                               const std::vector<PID> &pids,
-                               ISOTPOverCANSenderReceiver &isoTPSendReceive,
-                               EmissionInfo &info )
+void
+OBDOverCANModule::loadECUCache()
 {
-    std::vector<uint8_t> ecuResponse;
-    // Receive the PDU that has the Supported PIDs for this SID
-    // decoded according to J1979 8.1.2.2
-    if ( !isoTPSendReceive.receivePDU( ecuResponse ) )
+    if ( mPersistency == nullptr )
     {
-        return false;
+        return;
     }
-    // The info structure will be appended with the new decoded PIDs
-    if ( !ecuResponse.empty() )
+    size_t size = mPersistency->getSize( DataType::OBD_ECU_CACHE );
+    if ( ( size == 0 ) || ( size == INVALID_FILE_SIZE ) )
     {
-        std::ostringstream oss;
-        std::copy( ecuResponse.begin(), ecuResponse.end() - 1, std::ostream_iterator<int>( oss, "," ) );
-        oss << std::to_string( ecuResponse.back() );
-        mLogger.trace( "OBDOverCANModule::receivePIDs", "ECU Response: " + oss.str() );
-        return mOBDDataDecoder->decodeEmissionPIDs( sid, pids, ecuResponse, info );
+        return;
+    }
+    std::vector<uint8_t> cacheData( size );
+    OBDECUCache cache;
+    if ( ( mPersistency->read( cacheData.data(), size, DataType::OBD_ECU_CACHE ) != ErrorCode::SUCCESS ) ||
+         ( !cache.deserialize( cacheData.data(), size ) ) || cache.vin.empty() )
+    {
+        mLogger.warn( "OBDOverCANModule::loadECUCache", "Ignoring an invalid cache or a cache of another version" );
+        return;
     }
 
-    return false;
-}
-
-bool
-OBDOverCANModule::requestReceiveVIN( std::string &vin )
-{
-    mTxPDU.clear();
-    mTxPDU = { static_cast<uint8_t>( vehicleIdentificationNumberRequest.mSID ),
-               static_cast<uint8_t>( vehicleIdentificationNumberRequest.mPID ) };
-    // Send
-    if ( mEngineECUSenderReceiver.sendPDU( mTxPDU ) )
+    for ( const auto &cachedECU : cache.ecus )
     {
-        std::vector<uint8_t> ecuResponse;
-        // Receive the PDU and extract the VIN
-        if ( mEngineECUSenderReceiver.receivePDU( ecuResponse ) && !ecuResponse.empty() &&
-             mOBDDataDecoder->decodeVIN( ecuResponse, vin ) )
+        // Discovered ECUs are only taken over if the discovery is still enabled
+        bool known = false;
         {
-            return true;
+            std::lock_guard<std::mutex> lock( mECUsMutex );
+            for ( const auto &ecu : mECUs )
+            {
+                known = known || ( ecu->isoTPSendReceive.getOptions().mDestinationCANId == cachedECU.responseCANId );
+            }
+        }
+        if ( ( !known ) &&
+             ( ( !mDiscoverECUs ) || ( !addECU( ECUType::OTHER,
+                                                cachedECU.requestCANId,
+                                                cachedECU.responseCANId,
+                                                mGatewayCanInterfaceName,
+                                                true ) ) ) )
+        {
+            continue;
+        }
+        std::lock_guard<std::mutex> lock( mECUsMutex );
+        for ( auto &ecu : mECUs )
+        {
+            if ( ecu->isoTPSendReceive.getOptions().mDestinationCANId == cachedECU.responseCANId )
+            {
+                ecu->supportedPIDs = cachedECU.supportedPIDs;
+                ecu->supportedPIDsFromCache = true;
+                updatePIDRequestList( SID::CURRENT_STATS, *ecu );
+            }
         }
     }
-    return false;
+    // The cache contains the ECUs discovered before
+    mECUDiscoveryDone = mDiscoverECUs;
+    mVIN = cache.vin;
+    mVINFromCache = true;
+    mECUCacheOutdated = false;
+    mLogger.info( "OBDOverCANModule::loadECUCache",
+                  "Loaded " + std::to_string( cache.ecus.size() ) + " ECUs from the cache of VIN " + mVIN );
 }
 
-bool
-OBDOverCANModule::requestDTCs( const SID &sid, ISOTPOverCANSenderReceiver &isoTPSendReceive )
+void
+OBDOverCANModule::storeECUCache()
 {
-    mTxPDU.clear();
-    // Only SID is required for DTC requests
-    mTxPDU.emplace_back( static_cast<uint8_t>( sid ) );
-    // Send
-    return isoTPSendReceive.sendPDU( mTxPDU );
+    if ( ( mPersistency == nullptr ) || mVIN.empty() )
+    {
+        return;
+    }
+    OBDECUCache cache;
+    cache.vin = mVIN;
+    {
+        std::lock_guard<std::mutex> lock( mECUsMutex );
+        for ( const auto &ecu : mECUs )
+        {
+            OBDECUCache::ECU cachedECU;
+            cachedECU.type = ecu->type;
+            cachedECU.requestCANId = ecu->isoTPSendReceive.getOptions().mSourceCANId;
+            cachedECU.responseCANId = ecu->isoTPSendReceive.getOptions().mDestinationCANId;
+            cachedECU.supportedPIDs = ecu->supportedPIDs;
+            cache.ecus.emplace_back( std::move( cachedECU ) );
+        }
+    }
+    std::vector<uint8_t> cacheData;
+    cache.serialize( cacheData );
+    auto ret = mPersistency->write( cacheData.data(), cacheData.size(), DataType::OBD_ECU_CACHE );
+    if ( ret != ErrorCode::SUCCESS )
+    {
+        mLogger.warn( "OBDOverCANModule::storeECUCache",
+                      "Failed to persist the cache: " + std::string( mPersistency->getErrorString( ret ) ) );
+        static_cast<void>( mPersistency->erase( DataType::OBD_ECU_CACHE ) );
+        return;
+    }
+    mECUCacheOutdated = false;
 }
 
-bool
-OBDOverCANModule::receiveDTCs( const SID &sid, ISOTPOverCANSenderReceiver &isoTPSendReceive, DTCInfo &info )
+void
+OBDOverCANModule::revalidateCachedVIN()
 {
-    std::vector<uint8_t> ecuResponse;
-    if ( !isoTPSendReceive.receivePDU( ecuResponse ) )
+    std::string vin;
+    if ( !requestReceiveVIN( vin ) )
     {
-        return false;
+        // Keep the cached data and retry in the next cycle
+        return;
     }
-    // The info structure will be appended with the new decoded DTCs
-    if ( !ecuResponse.empty() && mOBDDataDecoder->decodeDTCs( sid, ecuResponse, info ) )
+    mVINFromCache = false;
+    if ( vin == mVIN )
     {
-        return true;
+        mLogger.trace( "OBDOverCANModule::revalidateCachedVIN", "Cached VIN confirmed" );
+        return;
     }
+    mLogger.info( "OBDOverCANModule::revalidateCachedVIN", "VIN changed, dropping the cached ECUs and PIDs" );
+    mVIN = vin;
+    mECUCacheOutdated = true;
+    std::lock_guard<std::mutex> lock( mECUsMutex );
+    // The discovered ECUs belong to another vehicle. The configured ECUs are kept, without their cached PIDs.
+    while ( ( mECUs.size() > 1U ) && ( mECUs.back()->type == ECUType::OTHER ) )
+    {
+        static_cast<void>( mECUs.back()->isoTPSendReceive.disconnect() );
+        mECUs.pop_back();
+    }
+    for ( auto &ecu : mECUs )
+    {
+        if ( ecu->supportedPIDsFromCache )
+        {
+            ecu->supportedPIDs.clear();
+            ecu->pidsToRequest.clear();
+            ecu->supportedPIDsFromCache = false;
+        }
+    }
+    mECUDiscoveryDone = false;
+}
 
-    return false;
+void
+OBDOverCANModule::tracePDU( const char *function, const char *prefix, const uint8_t *pdu, size_t size )
+{
+    if ( size == 0 )
+    {
+        return;
+    }
+    mLogger.trace( function, [prefix, pdu, size]() {
+        std::ostringstream oss;
+        oss << prefix;
+        std::copy( pdu, pdu + size - 1, std::ostream_iterator<int>( oss, "," ) );
+        oss << std::to_string( pdu[size - 1] );
+        return oss.str();
+    } );
 }
 
 bool
-OBDOverCANModule::requestReceiveDTCs( const SID &sid, ISOTPOverCANSenderReceiver &isoTPSendReceive, DTCInfo &info )
+OBDOverCANModule::requestReceiveVIN( std::string &vin )
 {
-    // Request and try to receive within the time interval
-    if ( requestDTCs( sid, isoTPSendReceive ) )
+    if ( mECUs.empty() )
     {
-        // Wait and process the response
-        if ( receiveDTCs( sid, isoTPSendReceive, info ) )
+        return false;
+    }
+    auto &engineECU = mECUs.front()->isoTPSendReceive;
+    std::vector<uint8_t> txPDU = { static_cast<uint8_t>( vehicleIdentificationNumberRequest.mSID ),
+                                   static_cast<uint8_t>( vehicleIdentificationNumberRequest.mPID ) };
+    // Send
+    if ( engineECU.sendPDU( txPDU ) )
+    {
+        std::vector<uint8_t> ecuResponse;
+        // Receive the PDU and extract the VIN
+        if ( engineECU.receivePDU( ecuResponse ) && !ecuResponse.empty() &&
+             mOBDDataDecoder->decodeVIN( ecuResponse, vin ) )
         {
             return true;
         }
@@ -895,20 +1502,15 @@ OBDOverCANModule::requestReceiveDTCs( const SID &sid, ISOTPOverCANSenderReceiver
 bool
 OBDOverCANModule::getPIDsToRequest( const SID &sid, const ECUType &type, SupportedPIDs &supportedPIDs ) const
 {
-    if ( type == ECUType::ENGINE )
+    std::lock_guard<std::mutex> lock( mECUsMutex );
+    for ( const auto &ecu : mECUs )
     {
-        auto pidIterator = mPIDsToRequestEngine.find( sid );
-        if ( pidIterator == mPIDsToRequestEngine.end() )
+        if ( ecu->type != type )
         {
-            return false;
+            continue;
         }
-        supportedPIDs = pidIterator->second;
-        return true;
-    }
-    else if ( type == ECUType::TRANSMISSION )
-    {
-        auto pidIterator = mPIDsToRequestTransmission.find( sid );
-        if ( pidIterator == mPIDsToRequestTransmission.end() )
+        auto pidIterator = ecu->pidsToRequest.find( sid );
+        if ( pidIterator == ecu->pidsToRequest.end() )
         {
             return false;
         }
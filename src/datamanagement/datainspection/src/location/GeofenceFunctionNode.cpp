@@ -0,0 +1,52 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "GeofenceFunctionNode.h"
+#include "GeohashFunctionNode.h"
+#include <utility>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataInspection
+{
+
+GeofenceFunctionNode::GeofenceFunctionNode( std::shared_ptr<const GeofenceIndex> geofences )
+    : mGeofences( std::move( geofences ) )
+{
+}
+
+bool
+GeofenceFunctionNode::evaluateGeofence( double latitude, double longitude, GeohashFunction::GPSUnitType gpsUnitType )
+{
+    // Vehicles often stand still or the GPS signals arrive slower than the conditions are evaluated
+    if ( mLastResultValid && ( latitude == mLastLatitude ) && ( longitude == mLastLongitude ) &&
+         ( gpsUnitType == mLastGpsUnitType ) )
+    {
+        return mLastResult;
+    }
+    mLastResult = ( mGeofences != nullptr ) &&
+                  mGeofences->contains( GeohashFunctionNode::convertToDecimalDegree( latitude, gpsUnitType ),
+                                        GeohashFunctionNode::convertToDecimalDegree( longitude, gpsUnitType ) );
+    mLastLatitude = latitude;
+    mLastLongitude = longitude;
+    mLastGpsUnitType = gpsUnitType;
+    mLastResultValid = true;
+    return mLastResult;
+}
+
+} // namespace DataInspection
+} // namespace IoTFleetWise
+} // namespace Aws
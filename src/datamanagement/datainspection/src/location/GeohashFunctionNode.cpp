@@ -38,9 +38,20 @@ GeohashFunctionNode::evaluateGeohash( double latitude,
     {
         precision = Geohash::MAX_PRECISION;
     }
-    std::string currentGeohashString{};
-    if ( Geohash::encode( latitude, longitude, Geohash::MAX_PRECISION, currentGeohashString ) )
+    // Still in the cell of the last Geohash, so the Geohash is unchanged at any precision
+    if ( mCellValid && ( latitude >= mCellLatMin ) && ( latitude < mCellLatMax ) && ( longitude >= mCellLonMin ) &&
+         ( longitude < mCellLonMax ) )
     {
+        return false;
+    }
+    uint64_t currentGeohashBits = 0;
+    if ( Geohash::encode( latitude, longitude, Geohash::MAX_PRECISION, currentGeohashBits ) )
+    {
+        std::string currentGeohashString{};
+        Geohash::toString( currentGeohashBits, Geohash::MAX_PRECISION, currentGeohashString );
+        Geohash::getCellBounds(
+            currentGeohashBits, Geohash::MAX_PRECISION, mCellLatMin, mCellLatMax, mCellLonMin, mCellLonMax );
+        mCellValid = true;
         // mLogger.info( "GeohashFunctionNode::evaluateGeohash", "Geohash calculated: " + currentGeohashString );
         // First we want to make sure both geohash string has the valid format for comparison
         if ( this->mGeohashInfo.mGeohashString.length() >= precision && currentGeohashString.length() >= precision )
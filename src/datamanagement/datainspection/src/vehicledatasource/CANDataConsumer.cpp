@@ -13,6 +13,9 @@
 
 // Includes
 #include "CANDataConsumer.h"
+#include "LatencyTracer.h"
+#include "LowActivityMode.h"
+#include "StallWatchdog.h"
 #include "TraceModule.h"
 #include <boost/lockfree/spsc_queue.hpp>
 #include <cstring>
@@ -24,6 +27,20 @@ namespace IoTFleetWise
 {
 namespace DataInspection
 {
+namespace
+{
+// Upper bound of the number of signals decoded from a frame of a decoder method
+size_t
+getMaxDecodedSignals( const CANMessageDecoderMethod &decoderMethod, const StaticCANDecodePlan *staticPlan )
+{
+    // A frame too short for the static decoder is decoded with the decoder method
+    size_t count = decoderMethod.decodePlan.isValid() ? decoderMethod.decodePlan.mSteps.size()
+                                                      : decoderMethod.format.mSignals.size();
+    return ( staticPlan != nullptr ) ? std::max( count, staticPlan->mSignals.size() ) : count;
+}
+} // namespace
+
+constexpr size_t CANDataConsumer::NO_RAW_FRAME;
 
 CANDataConsumer::~CANDataConsumer()
 {
@@ -39,6 +56,10 @@ CANDataConsumer::init( VehicleDataSourceID canChannelID, SignalBufferPtr signalB
 {
     mID = generateConsumerID();
     mCANDecoder = std::make_unique<CANDecoder>();
+    mMessageBatch.resize( MAX_DECODE_BATCH_SIZE );
+    mFrameDataBatch.resize( MAX_DECODE_BATCH_SIZE );
+    mPendingRawFrames.reserve( MAX_DECODE_BATCH_SIZE );
+    mBatchRawFrames.resize( MAX_DECODE_BATCH_SIZE, NO_RAW_FRAME );
     if ( signalBufferPtr.get() == nullptr )
     {
         mLogger.trace( "CANDataConsumer::init", " Init Failed due to bufferPtr as nullptr " );
@@ -50,6 +71,12 @@ CANDataConsumer::init( VehicleDataSourceID canChannelID, SignalBufferPtr signalB
                        "Init Network channel consumer with id: " + std::to_string( canChannelID ) );
         mDataSourceID = canChannelID;
         mSignalBufferPtr = signalBufferPtr;
+        mSignalProducer = mSignalBufferPtr->addProducer();
+        if ( mSignalProducer == nullptr )
+        {
+            mLogger.error( "CANDataConsumer::init", "Too many producers for the Signal Buffer" );
+            return false;
+        }
     }
     if ( idleTimeMs != 0 )
     {
@@ -73,17 +100,34 @@ CANDataConsumer::resumeDataConsumption( ConstDecoderDictionaryConstPtr &dictiona
     if ( dictionary.get() != nullptr )
     {
         {
-            // As this function can be asynchronously invoked by other module in the middle of
-            // CAN message Decoding, a mutex has to be used to avoid decoding race condition in which
-            // a single CAN message could got decoded by two different formula. This mutex ensure
-            // the shared pointer assignment is atomic
-            std::lock_guard<std::mutex> lock( mDecoderDictMutex );
+            // This function can be invoked concurrently by other modules. The worker thread never takes this
+            // mutex, it picks up the new lookup published below between two frames, so that a single CAN
+            // message is never decoded by two different formula.
+            std::lock_guard<InstrumentedMutex> lock( mDecoderDictMutex );
             // Convert the Generic Decoder Dictionary to CAN Decoder Dictionary
-            // TODO : This downcast is done three times in this entity. One time when the generic decoder is
-            // provider and another one on every work iteration. As we plan to consolidate all decoding
+            // TODO : This downcast is done two times in this entity. As we plan to consolidate all decoding
             // rules for different data source types in one single decoder instance, this down cast
             // shall be removed.
-            mDecoderDictionaryConstPtr = std::dynamic_pointer_cast<const CANDecoderDictionary>( dictionary );
+            auto decoderDictPtr = std::dynamic_pointer_cast<const CANDecoderDictionary>( dictionary );
+            mDecoderDictionaryConstPtr = decoderDictPtr;
+            // The lookup of this channel is built once here so that resolving a frame costs a single probe
+            std::shared_ptr<CANDecoderMethodLookup> decoderMethodLookup;
+            if ( decoderDictPtr != nullptr )
+            {
+                decoderMethodLookup = std::make_shared<CANDecoderMethodLookup>( decoderDictPtr, mDataSourceID );
+                // The decoders generated at build time take precedence for the CAN IDs whose format they match
+                size_t staticDecoderCount = 0;
+                const auto *staticDecoders = getStaticCANDecoders( staticDecoderCount );
+                auto staticCANIDs = decoderMethodLookup->registerStaticDecoders( staticDecoders, staticDecoderCount );
+                if ( staticCANIDs > 0 )
+                {
+                    mLogger.info( "CANDataConsumer::resumeDataConsumption",
+                                  "Decoding " + std::to_string( staticCANIDs ) + " of " +
+                                      std::to_string( decoderMethodLookup->size() ) +
+                                      " CAN IDs with static decoders on Consumer :" + std::to_string( mID ) );
+                }
+            }
+            mDecoderMethodLookup.store( decoderMethodLookup );
         }
         if ( mDecoderDictionaryConstPtr != nullptr )
         {
@@ -105,7 +149,7 @@ CANDataConsumer::resumeDataConsumption( ConstDecoderDictionaryConstPtr &dictiona
             // Make sure the thread does not sleep anymore
             mShouldSleep.store( false );
             // Wake up the worker thread.
-            mWait.notify();
+            mWait->notify();
         }
         else
         {
@@ -126,14 +170,14 @@ CANDataConsumer::start()
     // Make sure the thread goes into sleep immediately to wait for
     // the manifest to be available
     mShouldSleep.store( true );
-    if ( !mThread.create( doWork, this ) )
+    mIgnitionSignalId = LowActivityMode::get().getIgnitionSignalId();
+    if ( !mThread.create( doWork, this, "fwDIConsumer" + std::to_string( mID ) ) )
     {
         mLogger.trace( "CANDataConsumer::start", " Consumer Thread failed to start " );
     }
     else
     {
         mLogger.trace( "CANDataConsumer::start", " Consumer Thread started " );
-        mThread.setThreadName( "fwDIConsumer" + std::to_string( mID ) );
     }
 
     return mThread.isActive() && mThread.isValid();
@@ -144,7 +188,7 @@ CANDataConsumer::stop()
 {
     std::lock_guard<std::mutex> lock( mThreadMutex );
     mShouldStop.store( true, std::memory_order_relaxed );
-    mWait.notify();
+    mWait->notify();
     mThread.release();
     mShouldStop.store( false, std::memory_order_relaxed );
     mLogger.trace( "CANDataConsumer::stop", " Consumer Thread stopped " );
@@ -171,237 +215,563 @@ CANDataConsumer::doWork( void *data )
 
     uint32_t activations = 0;
     Timer logTimer;
-
-    // Only used for TRACE log level logging
-    std::array<std::pair<uint32_t, uint32_t>, 8> lastFrameIds{}; // .first=can id, .second=counter
-    uint8_t lastFrameIdPos = 0;
-    uint32_t processedFramesCounter = 0;
+    StallWatchdog::Heartbeat heartbeat;
     do
     {
         activations++;
         if ( consumer->shouldSleep() )
         {
+            heartbeat.idle();
             // We either just started or there was a decoder manifest update that we can't use.
             // We should sleep
             consumer->mLogger.trace( "CANDataConsumer::doWork",
                                      "No valid decoding dictionary available, Consumer going to sleep " );
-            // Wait here for the decoder Manifest to come.
-            consumer->mWait.wait( Platform::Linux::Signal::WaitWithPredicate );
+            // Wait here for the decoder Manifest to come. The data source also notifies the signal,
+            // so keep waiting until a resume or stop.
+            do
+            {
+                consumer->mWait->wait( Platform::Linux::Signal::WaitWithPredicate );
+            } while ( consumer->shouldSleep() && !consumer->shouldStop() );
             // At this point, we should be able to see events coming as the channel is also
             // woken up.
         }
-        // Below section utilize decoder dictionary to perform CAN message decoding and collection.
-        // Use a Mutex to prevent updating decoder dictionary in the middle of CAN Frame processing.
-        std::shared_ptr<const CANDecoderDictionary> decoderDictPtr;
+        heartbeat.enter( "dictionaryUpdate" );
+        consumer->refreshDecoderDictionary();
+        heartbeat.enter( "decodeFrame" );
+        if ( consumer->decodeNextFrame() == 0 )
+        {
+            if ( logTimer.getElapsedMs().count() > static_cast<int64_t>( LoggingModule::LOG_AGGREGATION_TIME_MS ) )
+            {
+                // Nothing is in the ring buffer to consume. Go to idle mode for some time.
+                consumer->mLogger.trace( "CANDataConsumer::doWork", [&]() {
+                    std::stringstream logMessage;
+                    logMessage << "Channel Id: " << consumer->mDataSourceID
+                               << ". Activations since last print: " << std::to_string( activations )
+                               << ". Number of frames over all processed " << consumer->mProcessedFramesCounter
+                               << ".Last CAN IDs processed:";
+                    for ( auto id : consumer->mLastFrameIds )
+                    {
+                        logMessage << id.first << " (x " << id.second << "), ";
+                    }
+                    logMessage << ". Waiting for some data to come. Idling for :" +
+                                      std::to_string( consumer->mIdleTime ) + " ms";
+                    return logMessage.str();
+                } );
+                activations = 0;
+                logTimer.reset();
+            }
+            // While the vehicle is parked the thread waits without timeout, the data source wakes it up
+            LowActivityMode::get().checkBusSilence();
+            heartbeat.idle();
+            consumer->mWait->wait( LowActivityMode::get().getIdleWaitTimeMs( consumer->mIdleTime ) );
+        }
+    } while ( !consumer->shouldStop() );
+}
+
+bool
+CANDataConsumer::consumeFrames( size_t maxFrames )
+{
+    // Frames are left in the input buffer until a decoder dictionary is available, like the thread does
+    if ( ( !mDirectConnected.load( std::memory_order_relaxed ) ) || shouldSleep() )
+    {
+        return true;
+    }
+    refreshDecoderDictionary();
+    size_t decodedFrames = 0;
+    while ( decodedFrames < maxFrames )
+    {
+        auto frames = decodeNextFrame();
+        if ( frames == 0 )
         {
-            std::lock_guard<std::mutex> lock( consumer->mDecoderDictMutex );
-            decoderDictPtr =
-                std::dynamic_pointer_cast<const CANDecoderDictionary>( consumer->mDecoderDictionaryConstPtr );
+            LowActivityMode::get().checkBusSilence();
+            return true;
         }
+        decodedFrames += frames;
+    }
+    return false;
+}
 
-        // Pop any message from the Input Buffer
-        VehicleDataMessage message;
-        if ( consumer->mInputBufferPtr->pop( message ) )
+void
+CANDataConsumer::refreshDecoderDictionary()
+{
+    // Below section utilize decoder dictionary to perform CAN message decoding and collection.
+    // The lookup is only exchanged between two frames and costs a single atomic load if it did not change.
+    if ( mDecoderMethodLookup.refresh( mActiveDecoderMethodLookup, mActiveDecoderMethodLookupVersion ) )
+    {
+        // Values passed on with the previous dictionary are not compared against anymore
+        mSheddableSignals.clear();
+        if ( mActiveDecoderMethodLookup != nullptr )
         {
-            TraceVariable traceQueue = static_cast<TraceVariable>(
-                consumer->mDataSourceID + toUType( TraceVariable::QUEUE_SOCKET_TO_CONSUMER_0 ) );
-            TraceModule::get().setVariable( ( traceQueue < TraceVariable::QUEUE_SOCKET_TO_CONSUMER_MAX )
-                                                ? traceQueue
-                                                : TraceVariable::QUEUE_SOCKET_TO_CONSUMER_MAX,
-                                            consumer->mInputBufferPtr->read_available() + 1 );
-            CANDecodedMessage decodedMessage;
-            decodedMessage.mChannelProtocol = consumer->mDataSourceProtocol;
-            decodedMessage.mChannelType = consumer->mType;
-            decodedMessage.mChannelIfName = consumer->mIfName;
-            decodedMessage.mReceptionTime = message.getReceptionTimestamp();
-            decodedMessage.mFrameInfo.mFrameID = static_cast<uint32_t>( message.getMessageID() );
-            decodedMessage.mFrameInfo.mFrameRawData.assign( message.getRawData().data(),
-                                                            message.getRawData().size() + message.getRawData().data() );
-            // get decoderMethod from the decoder dictionary
-            const auto &decoderMethod = decoderDictPtr->canMessageDecoderMethod;
-            // a set of signalID specifying which signal to collect
-            const auto &signalIDsToCollect = decoderDictPtr->signalIDsToCollect;
-            // check if this CAN message ID on this CAN Channel has the decoder method
-            if ( decoderMethod.find( consumer->mDataSourceID ) != decoderMethod.cend() &&
-                 decoderMethod.at( consumer->mDataSourceID ).find( static_cast<uint32_t>( message.getMessageID() ) ) !=
-                     decoderMethod.at( consumer->mDataSourceID ).cend() )
+            const auto &dictionary = *mActiveDecoderMethodLookup->getDictionary();
+            mEmissionFilter.setPolicies( dictionary.signalEmissionPolicies, dictionary.signalMinimumSampleIntervalsMs );
+            updateSheddableSignals( dictionary );
+        }
+        else
+        {
+            mEmissionFilter.setPolicies( std::unordered_map<SignalID, SignalEmissionPolicy>() );
+        }
+    }
+}
+
+size_t
+CANDataConsumer::decodeNextFrame()
+{
+    // Pop any message from the Input Buffer
+    VehicleDataMessage message;
+    if ( !mInputBufferPtr->pop( message ) )
+    {
+        return 0;
+    }
+    size_t batchSize = 1;
+    LowActivityMode::get().onBusActivity( message.getReceptionTimestamp() );
+    mLoadSheddingLevel = ( mLoadController != nullptr ) ? mLoadController->getLevel() : LoadSheddingLevel::NONE;
+    TraceVariable traceQueue =
+        static_cast<TraceVariable>( mDataSourceID + toUType( TraceVariable::QUEUE_SOCKET_TO_CONSUMER_0 ) );
+    TraceModule::get().setVariable( ( traceQueue < TraceVariable::QUEUE_SOCKET_TO_CONSUMER_MAX )
+                                        ? traceQueue
+                                        : TraceVariable::QUEUE_SOCKET_TO_CONSUMER_MAX,
+                                    mInputBufferPtr->read_available() + 1 );
+    CANDecodedMessage decodedMessage;
+    decodedMessage.mChannelProtocol = mDataSourceProtocol;
+    decodedMessage.mChannelType = mType;
+    decodedMessage.mChannelIfName = mIfName;
+    decodedMessage.mReceptionTime = message.getReceptionTimestamp();
+    decodedMessage.mReceptionTimeFractionUs = message.getReceptionTimestampFractionUs();
+    decodedMessage.mFrameInfo.mFrameID = static_cast<uint32_t>( message.getMessageID() );
+    decodedMessage.mFrameInfo.mFrameRawData.assign( message.getRawData(),
+                                                    message.getRawData() + message.getRawDataSize() );
+    // get decoderMethod of this CAN message ID on this CAN Channel from the decoder dictionary
+    const CANMessageDecoderMethod *decoderMethod =
+        ( mActiveDecoderMethodLookup != nullptr )
+            ? mActiveDecoderMethodLookup->find( static_cast<uint32_t>( message.getMessageID() ) )
+            : nullptr;
+    if ( decoderMethod != nullptr )
+    {
+        TraceScopedTimer decodeTimer( TraceHistogram::CAN_DECODE_NS );
+        TraceModule::get().incrementVariable( TraceVariable::CAN_DECODED_FRAMES );
+        // format to be used for decoding
+        const auto &format = decoderMethod->format;
+        const auto &collectType = decoderMethod->collectType;
+        const auto &decodePlan = decoderMethod->decodePlan;
+        const StaticCANDecodePlan *staticPlan =
+            mActiveDecoderMethodLookup->findStatic( static_cast<uint32_t>( message.getMessageID() ) );
+
+        // Bursts of the same CAN ID are decoded together, so gather the directly following frames with
+        // the same CAN ID and size
+        if ( mSignalProducer.get() != nullptr &&
+             ( collectType == CANMessageCollectType::DECODE ||
+               collectType == CANMessageCollectType::RAW_AND_DECODE ) &&
+             format.isValid() && decodePlan.isValid() && ( !decodePlan.mIsMultiplexed ) && ( staticPlan == nullptr ) )
+        {
+            while ( ( batchSize < MAX_DECODE_BATCH_SIZE ) && ( mInputBufferPtr->read_available() > 0 ) &&
+                    ( mInputBufferPtr->front().getMessageID() == message.getMessageID() ) &&
+                    ( mInputBufferPtr->front().getRawDataSize() == message.getRawDataSize() ) )
             {
-                // format to be used for decoding
-                const auto &format = decoderMethod.at( consumer->mDataSourceID )
-                                         .at( static_cast<uint32_t>( message.getMessageID() ) )
-                                         .format;
-                const auto &collectType = decoderMethod.at( consumer->mDataSourceID )
-                                              .at( static_cast<uint32_t>( message.getMessageID() ) )
-                                              .collectType;
-
-                // Only used for TRACE log level logging
-                if ( collectType == CANMessageCollectType::RAW ||
-                     collectType == CANMessageCollectType::RAW_AND_DECODE ||
-                     collectType == CANMessageCollectType::DECODE )
+                if ( batchSize == 1 )
                 {
-                    bool found = false;
-                    for ( auto &p : lastFrameIds )
-                    {
-                        if ( p.first == static_cast<uint32_t>( message.getMessageID() ) )
-                        {
-                            found = true;
-                            p.second++;
-                            break;
-                        }
-                    }
-                    if ( !found )
-                    {
-                        lastFrameIdPos++;
-                        if ( lastFrameIdPos >= lastFrameIds.size() )
-                        {
-                            lastFrameIdPos = 0;
-                        }
-                        lastFrameIds[lastFrameIdPos] =
-                            std::pair<uint32_t, uint32_t>( static_cast<uint32_t>( message.getMessageID() ), 1 );
-                    }
-                    processedFramesCounter++;
+                    mMessageBatch[0] = message;
                 }
+                mInputBufferPtr->pop( mMessageBatch[batchSize] );
+                batchSize++;
+            }
+        }
 
-                // Check if we want to collect RAW CAN Frame; If so we also need to ensure Buffer is valid
-                if ( consumer->mCANBufferPtr.get() != nullptr &&
-                     ( collectType == CANMessageCollectType::RAW ||
-                       collectType == CANMessageCollectType::RAW_AND_DECODE ) )
+        // The decoded signals of a RAW_AND_DECODE message are queued together with its raw frame if they fit
+        bool attachSignals =
+            ( mSignalProducer.get() != nullptr ) && ( collectType == CANMessageCollectType::RAW_AND_DECODE ) &&
+            ( getMaxDecodedSignals( *decoderMethod, staticPlan ) <=
+              static_cast<size_t>( CollectedCanFrameWithSignals::MAX_DECODED_SIGNALS ) );
+        for ( size_t frameIndex = 0; frameIndex < batchSize; frameIndex++ )
+        {
+            const auto &frame = ( batchSize > 1 ) ? mMessageBatch[frameIndex] : message;
+            // Only used for TRACE log level logging
+            if ( collectType == CANMessageCollectType::RAW ||
+                 collectType == CANMessageCollectType::RAW_AND_DECODE ||
+                 collectType == CANMessageCollectType::DECODE )
+            {
+                bool found = false;
+                for ( auto &p : mLastFrameIds )
                 {
-                    // prepare the raw CAN Frame
-                    struct CollectedCanRawFrame canRawFrame;
-                    canRawFrame.frameID = static_cast<uint32_t>( message.getMessageID() );
-                    canRawFrame.channelId = consumer->mDataSourceID;
-                    canRawFrame.receiveTime = message.getReceptionTimestamp();
-                    // CollectedCanRawFrame only receive 8 CAN Raw Bytes
-                    canRawFrame.size =
-                        std::min( static_cast<uint8_t>( message.getRawData().size() ), MAX_CAN_FRAME_BYTE_SIZE );
-                    std::copy( message.getRawData().begin(),
-                               message.getRawData().begin() + canRawFrame.size,
-                               canRawFrame.data.begin() );
-                    // Push raw CAN Frame to the Buffer for next stage to consume
-                    // Note buffer is lock_free buffer and multiple Vehicle Data Source Instance could push
-                    // data to it.
-                    TraceModule::get().incrementAtomicVariable( TraceAtomicVariable::QUEUE_CONSUMER_TO_INSPECTION_CAN );
-                    if ( !consumer->mCANBufferPtr->push( canRawFrame ) )
+                    if ( p.first == static_cast<uint32_t>( frame.getMessageID() ) )
                     {
-                        TraceModule::get().decrementAtomicVariable(
-                            TraceAtomicVariable::QUEUE_CONSUMER_TO_INSPECTION_CAN );
-                        consumer->mLogger.warn( "CANDataConsumer::doWork", "RAW CAN Frame Buffer Full! " );
+                        found = true;
+                        p.second++;
+                        break;
                     }
-                    else
+                }
+                if ( !found )
+                {
+                    mLastFrameIdPos++;
+                    if ( mLastFrameIdPos >= mLastFrameIds.size() )
                     {
-                        // Enable below logging for debugging
-                        // consumer->mLogger.trace( "CANDataConsumer::doWork",
-                        //                             "Collect RAW CAN Frame ID: " +
-                        //                                 std::to_string( static_cast<uint32_t>(
-                        //                                 message.getMessageID() ) ) );
+                        mLastFrameIdPos = 0;
                     }
+                    mLastFrameIds[mLastFrameIdPos] =
+                        std::pair<uint32_t, uint32_t>( static_cast<uint32_t>( frame.getMessageID() ), 1 );
+                }
+                mProcessedFramesCounter++;
+            }
+
+            // Check if we want to collect RAW CAN Frame; If so we also need to ensure Buffer is valid
+            mBatchRawFrames[frameIndex] = NO_RAW_FRAME;
+            if ( mCANProducer.get() != nullptr &&
+                 ( collectType == CANMessageCollectType::RAW ||
+                   collectType == CANMessageCollectType::RAW_AND_DECODE ) &&
+                 ( !shedRawFrame() ) )
+            {
+                addRawFrame( frame );
+                if ( attachSignals )
+                {
+                    mBatchRawFrames[frameIndex] = mPendingRawFrames.size() - 1U;
+                }
+            }
+        }
+        // check if we want to decode can frame into signals and collect signals
+        if ( mSignalProducer.get() != nullptr &&
+             ( collectType == CANMessageCollectType::DECODE ||
+               collectType == CANMessageCollectType::RAW_AND_DECODE ) )
+        {
+            mSignalsRawFrame = mBatchRawFrames[0];
+            if ( ( staticPlan != nullptr ) && decodeStatic( *staticPlan, message ) )
+            {
+                // Decoded by the fast path generated at build time
+            }
+            else if ( batchSize > 1 )
+            {
+                for ( size_t frameIndex = 0; frameIndex < batchSize; frameIndex++ )
+                {
+                    mFrameDataBatch[frameIndex] = mMessageBatch[frameIndex].getRawData();
                 }
-                // check if we want to decode can frame into signals and collect signals
-                if ( consumer->mSignalBufferPtr.get() != nullptr &&
-                     ( collectType == CANMessageCollectType::DECODE ||
-                       collectType == CANMessageCollectType::RAW_AND_DECODE ) )
+                if ( mCANDecoder->decodeCANMessages(
+                         mFrameDataBatch.data(), batchSize, message.getRawDataSize(), decodePlan, mDecodedColumns ) )
                 {
-                    if ( format.isValid() )
+                    // Keep the order of decoding the frames one by one
+                    for ( size_t frameIndex = 0; frameIndex < batchSize; frameIndex++ )
                     {
-                        if ( consumer->mCANDecoder->decodeCANMessage( message.getRawData().data(),
-                                                                      message.getRawData().size(),
-                                                                      format,
-                                                                      signalIDsToCollect,
-                                                                      decodedMessage ) )
+                        const auto &frame = mMessageBatch[frameIndex];
+                        auto traceId = traceDecodedFrame( frame );
+                        mSignalsRawFrame = mBatchRawFrames[frameIndex];
+                        for ( const auto &column : mDecodedColumns )
                         {
-                            for ( auto const &signal : decodedMessage.mFrameInfo.mSignals )
-                            {
-                                // Create Collected Signal Object
-                                struct CollectedSignal collectedSignal(
-                                    signal.mSignalID, decodedMessage.mReceptionTime, signal.mPhysicalValue );
-                                // Push collected signal to the Signal Buffer
-                                TraceModule::get().incrementAtomicVariable(
-                                    TraceAtomicVariable::QUEUE_CONSUMER_TO_INSPECTION_SIGNALS );
-                                if ( !consumer->mSignalBufferPtr->push( collectedSignal ) )
-                                {
-                                    TraceModule::get().decrementAtomicVariable(
-                                        TraceAtomicVariable::QUEUE_CONSUMER_TO_INSPECTION_SIGNALS );
-                                    consumer->mLogger.warn( "CANDataConsumer::doWork", "Signal Buffer Full! " );
-                                }
-                                else
-                                {
-                                    // Enable below logging for debugging
-                                    // consumer->mLogger.trace( "CANDataConsumer::doWork",
-                                    //                             "Acquire Signal ID: " +
-                                    //                                 std::to_string( signal.mSignalID )
-                                    //                                 );
-                                }
-                            }
+                            struct CollectedSignal collectedSignal( column.mSignalID,
+                                                                    frame.getReceptionTimestamp(),
+                                                                    column.mPhysicalValues[frameIndex] );
+                            collectedSignal.signalIndex = column.mSignalIndex;
+                            collectedSignal.receiveTimeFractionUs = frame.getReceptionTimestampFractionUs();
+                            collectedSignal.traceId = traceId;
+                            pushCollectedSignal( collectedSignal );
                         }
-                        else
-                        {
-                            // The decoding was not fully successful
-                            consumer->mLogger.warn(
-                                "CANDataConsumer::doWork",
-                                "CAN Frame " + std::to_string( static_cast<uint32_t>( message.getMessageID() ) ) +
-                                    " decoding failed! " );
-                        }
-                    }
-                    else
-                    {
-                        // The CAN Message format is not valid, report as warning
-                        consumer->mLogger.warn(
-                            "CANDataConsumer::doWork",
-                            "CANMessageFormat Invalid for format message id: " + std::to_string( format.mMessageID ) +
-                                " can message id: " +
-                                std::to_string( static_cast<uint32_t>( message.getMessageID() ) ) +
-                                " on CAN Channel Id: " + std::to_string( consumer->mDataSourceID ) );
                     }
                 }
+                else
+                {
+                    // The decoding was not fully successful
+                    mLogger.warn( "CANDataConsumer::decodeNextFrame", [&]() {
+                        return "CAN Frame " + std::to_string( static_cast<uint32_t>( message.getMessageID() ) ) +
+                               " decoding of " + std::to_string( batchSize ) + " frames failed! ";
+                    } );
+                }
             }
-        }
-        else
-        {
-            if ( logTimer.getElapsedMs().count() > static_cast<int64_t>( LoggingModule::LOG_AGGREGATION_TIME_MS ) )
+            else if ( format.isValid() )
             {
-                // Nothing is in the ring buffer to consume. Go to idle mode for some time.
-                std::stringstream logMessage;
-                logMessage << "Channel Id: " << consumer->mDataSourceID
-                           << ". Activations since last print: " << std::to_string( activations )
-                           << ". Number of frames over all processed " << processedFramesCounter
-                           << ".Last CAN IDs processed:";
-                for ( auto id : lastFrameIds )
+                // The plan is compiled when the dictionary is built and only contains the signals to
+                // collect, dictionaries without a plan are decoded from the format
+                bool decodingSuccessful =
+                    decodePlan.isValid()
+                        ? mCANDecoder->decodeCANMessage(
+                              message.getRawData(), message.getRawDataSize(), decodePlan, decodedMessage )
+                        : mCANDecoder->decodeCANMessage(
+                              message.getRawData(),
+                              message.getRawDataSize(),
+                              format,
+                              mActiveDecoderMethodLookup->getDictionary()->signalIDsToCollect,
+                              decodedMessage );
+                if ( decodingSuccessful )
+                {
+                    auto traceId = traceDecodedFrame( message );
+                    for ( auto const &signal : decodedMessage.mFrameInfo.mSignals )
+                    {
+                        // Create Collected Signal Object
+                        struct CollectedSignal collectedSignal(
+                            signal.mSignalID, decodedMessage.mReceptionTime, signal.mPhysicalValue );
+                        collectedSignal.signalIndex = signal.mSignalIndex;
+                        collectedSignal.receiveTimeFractionUs = decodedMessage.mReceptionTimeFractionUs;
+                        collectedSignal.traceId = traceId;
+                        pushCollectedSignal( collectedSignal );
+                    }
+                }
+                else
                 {
-                    logMessage << id.first << " (x " << id.second << "), ";
+                    // The decoding was not fully successful
+                    mLogger.warn( "CANDataConsumer::decodeNextFrame", [&]() {
+                        return "CAN Frame " + std::to_string( static_cast<uint32_t>( message.getMessageID() ) ) +
+                               " decoding failed! ";
+                    } );
                 }
-                logMessage << ". Waiting for some data to come. Idling for :" + std::to_string( consumer->mIdleTime ) +
-                                  " ms";
-                consumer->mLogger.trace( "CANDataConsumer::doWork", logMessage.str() );
-                activations = 0;
-                logTimer.reset();
             }
-            consumer->mWait.wait( consumer->mIdleTime );
+            else
+            {
+                // The CAN Message format is not valid, report as warning
+                mLogger.warn( "CANDataConsumer::decodeNextFrame", [&]() {
+                    return "CANMessageFormat Invalid for format message id: " + std::to_string( format.mMessageID ) +
+                           " can message id: " + std::to_string( static_cast<uint32_t>( message.getMessageID() ) ) +
+                           " on CAN Channel Id: " + std::to_string( mDataSourceID );
+                } );
+            }
+            mSignalsRawFrame = NO_RAW_FRAME;
         }
-    } while ( !consumer->shouldStop() );
+    }
+    flushCollectedSignals();
+    // Wake up the inspection as soon as there is something new for it
+    if ( mPushedSignals && ( mOutputDataAvailableSignal != nullptr ) )
+    {
+        mOutputDataAvailableSignal->notify();
+    }
+    mPushedSignals = false;
+    if ( mEmissionDroppedSignals > 0 )
+    {
+        // Added once per frame instead of for every dropped value as all consumers share the counter
+        TraceModule::get().addToAtomicVariable( TraceAtomicVariable::EMISSION_POLICY_DROPPED_SIGNALS,
+                                                mEmissionDroppedSignals );
+        mEmissionDroppedSignals = 0;
+    }
+    if ( mShedSignals > 0 )
+    {
+        TraceModule::get().addToAtomicVariable( TraceAtomicVariable::LOAD_SHEDDING_DROPPED_SIGNALS, mShedSignals );
+        mShedSignals = 0;
+    }
+    if ( mShedRawFrames > 0 )
+    {
+        TraceModule::get().addToAtomicVariable( TraceAtomicVariable::LOAD_SHEDDING_DROPPED_RAW_FRAMES,
+                                                mShedRawFrames );
+        mShedRawFrames = 0;
+    }
+    return batchSize;
+}
+
+bool
+CANDataConsumer::decodeStatic( const StaticCANDecodePlan &plan, const VehicleDataMessage &frame )
+{
+    const auto &decoder = *plan.mDecoder;
+    mStaticDecodedValues.resize( decoder.mSignalCount );
+    if ( !decoder.mDecode( frame.getRawData(), frame.getRawDataSize(), mStaticDecodedValues.data() ) )
+    {
+        // The frame is shorter than the message was generated for, the generic decoder reports the signals
+        return false;
+    }
+    auto traceId = traceDecodedFrame( frame );
+    for ( const auto &signal : plan.mSignals )
+    {
+        struct CollectedSignal collectedSignal(
+            signal.mSignalID, frame.getReceptionTimestamp(), mStaticDecodedValues[signal.mValueIndex] );
+        collectedSignal.signalIndex = signal.mSignalIndex;
+        collectedSignal.receiveTimeFractionUs = frame.getReceptionTimestampFractionUs();
+        collectedSignal.traceId = traceId;
+        pushCollectedSignal( collectedSignal );
+    }
+    return true;
+}
+
+uint32_t
+CANDataConsumer::traceDecodedFrame( const VehicleDataMessage &frame )
+{
+    // A single relaxed atomic load if the latency tracing is disabled
+    auto traceId = LatencyTracer::get().startTrace(
+        toMicroseconds( frame.getReceptionTimestamp(), frame.getReceptionTimestampFractionUs() ) );
+    LatencyTracer::get().mark( traceId, LatencyStage::DECODE );
+    return traceId;
+}
+
+void
+CANDataConsumer::updateSheddableSignals( const CANDecoderDictionary &dictionary )
+{
+    if ( mLoadController == nullptr )
+    {
+        return;
+    }
+    for ( const auto &signalPriority : dictionary.signalPriorities )
+    {
+        if ( mLoadController->isSheddable( signalPriority.second,
+                                           dictionary.conditionSignalIDs.count( signalPriority.first ) > 0 ) )
+        {
+            mSheddableSignals.insert( signalPriority.first );
+        }
+    }
+}
+
+bool
+CANDataConsumer::shedRawFrame()
+{
+    if ( mLoadSheddingLevel < LoadSheddingLevel::RAW_CAN_FRAMES )
+    {
+        mRawFramesSinceKept = 0;
+        return false;
+    }
+    // Keep evenly spaced frames instead of dropping whole bursts
+    mRawFramesSinceKept++;
+    if ( mRawFramesSinceKept >= mLoadController->getConfig().rawFrameKeepInterval )
+    {
+        mRawFramesSinceKept = 0;
+        return false;
+    }
+    mShedRawFrames++;
+    return true;
+}
+
+void
+CANDataConsumer::pushCollectedSignal( const CollectedSignal &collectedSignal )
+{
+    if ( collectedSignal.signalID == mIgnitionSignalId )
+    {
+        LowActivityMode::get().onIgnition( collectedSignal.value != 0.0 );
+    }
+    // Signals of low priority collection schemes are dropped first when the pipeline falls behind
+    if ( ( mLoadSheddingLevel >= LoadSheddingLevel::LOW_PRIORITY_SIGNALS ) && ( !mSheddableSignals.empty() ) &&
+         ( mSheddableSignals.count( collectedSignal.signalID ) > 0 ) )
+    {
+        mShedSignals++;
+        return;
+    }
+    // Values dropped by the emission policy or the minimum sample interval of their signal never reach the Signal
+    // Buffer
+    if ( ( !mEmissionFilter.isEmpty() ) && ( !mEmissionFilter.shouldEmit( collectedSignal.signalID,
+                                                                          collectedSignal.value,
+                                                                          collectedSignal.receiveTime,
+                                                                          collectedSignal.receiveTimeFractionUs ) ) )
+    {
+        mEmissionDroppedSignals++;
+        return;
+    }
+    if ( mSignalsRawFrame != NO_RAW_FRAME )
+    {
+        auto &rawFrame = mPendingRawFrames[mSignalsRawFrame];
+        if ( rawFrame.decodedSignalCount < CollectedCanFrameWithSignals::MAX_DECODED_SIGNALS )
+        {
+            auto &decodedSignal = rawFrame.decodedSignals[rawFrame.decodedSignalCount];
+            decodedSignal.signalID = collectedSignal.signalID;
+            decodedSignal.signalIndex = collectedSignal.signalIndex;
+            decodedSignal.value = collectedSignal.value;
+            rawFrame.decodedSignalCount++;
+            rawFrame.traceId = collectedSignal.traceId;
+            return;
+        }
+    }
+    mPendingSignals.push_back( collectedSignal );
+}
+
+void
+CANDataConsumer::addRawFrame( const VehicleDataMessage &frame )
+{
+    mPendingRawFrames.emplace_back();
+    auto &canRawFrame = mPendingRawFrames.back();
+    canRawFrame.frameID = static_cast<uint32_t>( frame.getMessageID() );
+    canRawFrame.channelId = mDataSourceID;
+    canRawFrame.receiveTime = frame.getReceptionTimestamp();
+    canRawFrame.receiveTimeFractionUs = frame.getReceptionTimestampFractionUs();
+    // CollectedCanRawFrame receives up to 64 CAN FD Raw Bytes
+    canRawFrame.size = std::min( static_cast<uint8_t>( frame.getRawDataSize() ), MAX_CANFD_FRAME_BYTE_SIZE );
+    std::copy( frame.getRawData(), frame.getRawData() + canRawFrame.size, canRawFrame.data.begin() );
+}
+
+void
+CANDataConsumer::flushCollectedSignals()
+{
+    if ( mDirectOutput != nullptr )
+    {
+        // Handed to the inspection on this thread, the raw frames first like they are pushed to the buffers
+        if ( !mPendingRawFrames.empty() )
+        {
+            mDirectOutput->addRawFrames( mPendingRawFrames.data(), mPendingRawFrames.size() );
+            mPendingRawFrames.clear();
+        }
+        if ( !mPendingSignals.empty() )
+        {
+            mDirectOutput->addSignals( mPendingSignals.data(), mPendingSignals.size() );
+            mPendingSignals.clear();
+        }
+        return;
+    }
+    if ( !mPendingRawFrames.empty() )
+    {
+        // Note every consumer pushes to its own ring of the buffer, so there is no contention with other Vehicle
+        // Data Source Instances.
+        TraceModule::get().addToAtomicVariable( TraceAtomicVariable::QUEUE_CONSUMER_TO_INSPECTION_CAN,
+                                                mPendingRawFrames.size() );
+        auto pushed = mCANProducer->push( mPendingRawFrames.data(), mPendingRawFrames.size() );
+        if ( pushed < mPendingRawFrames.size() )
+        {
+            auto dropped = mPendingRawFrames.size() - pushed;
+            TraceModule::get().subtractFromAtomicVariable( TraceAtomicVariable::QUEUE_CONSUMER_TO_INSPECTION_CAN,
+                                                           dropped );
+            TraceModule::get().addToAtomicVariable( TraceAtomicVariable::QUEUE_FULL_DROPPED_RAW_FRAMES, dropped );
+            mLogger.warn( "CANDataConsumer::doWork", []() { return "RAW CAN Frame Buffer Full! "; } );
+        }
+        if ( pushed > 0 )
+        {
+            mPushedSignals = true;
+        }
+        mPendingRawFrames.clear();
+    }
+    if ( mPendingSignals.empty() )
+    {
+        return;
+    }
+    // All signals of the frame are pushed at once, so the ring indices and the queue counter are only updated once
+    // instead of once per signal
+    TraceModule::get().addToAtomicVariable( TraceAtomicVariable::QUEUE_CONSUMER_TO_INSPECTION_SIGNALS,
+                                            mPendingSignals.size() );
+    auto pushed = mSignalProducer->push( mPendingSignals.data(), mPendingSignals.size() );
+    if ( pushed < mPendingSignals.size() )
+    {
+        auto dropped = mPendingSignals.size() - pushed;
+        TraceModule::get().subtractFromAtomicVariable( TraceAtomicVariable::QUEUE_CONSUMER_TO_INSPECTION_SIGNALS,
+                                                       dropped );
+        TraceModule::get().addToAtomicVariable( TraceAtomicVariable::QUEUE_FULL_DROPPED_SIGNALS, dropped );
+        mLogger.warn( "CANDataConsumer::doWork", []() { return "Signal Buffer Full! "; } );
+    }
+    if ( pushed > 0 )
+    {
+        mPushedSignals = true;
+    }
+    mPendingSignals.clear();
 }
 
 bool
 CANDataConsumer::connect()
 {
-    if ( mInputBufferPtr.get() != nullptr && mSignalBufferPtr.get() != nullptr && mCANBufferPtr.get() != nullptr &&
-         start() )
+    if ( mInputBufferPtr.get() == nullptr || mSignalProducer.get() == nullptr || mCANProducer.get() == nullptr )
+    {
+        return false;
+    }
+    if ( mDirectOutput != nullptr )
     {
+        // No own thread, the frames are decoded by the caller of consumeFrames once a dictionary is available
+        mShouldSleep.store( true );
+        mIgnitionSignalId = LowActivityMode::get().getIgnitionSignalId();
+        mDirectConnected.store( true );
         return true;
     }
-
-    return false;
+    return start();
 }
 
 bool
 CANDataConsumer::disconnect()
 {
+    if ( mDirectOutput != nullptr )
+    {
+        mDirectConnected.store( false );
+        return true;
+    }
     return stop();
 }
 
 bool
 CANDataConsumer::isAlive()
 {
+    if ( mDirectOutput != nullptr )
+    {
+        return mDirectConnected.load();
+    }
     return mThread.isValid() && mThread.isActive();
 }
 
@@ -0,0 +1,240 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "RemoteInspectionProtocol.h"
+#include <algorithm>
+#include <cstring>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataInspection
+{
+
+constexpr uint32_t RemoteInspectionBatch::MAGIC;
+constexpr uint8_t RemoteInspectionBatch::VERSION;
+constexpr size_t RemoteInspectionBatch::HEADER_SIZE;
+constexpr size_t RemoteInspectionBatch::SIGNAL_SIZE;
+constexpr size_t RemoteInspectionBatch::FRAME_HEADER_SIZE;
+constexpr size_t RemoteInspectionBatch::DECODED_SIGNAL_SIZE;
+constexpr size_t RemoteInspectionBatch::DEFAULT_MAX_SIZE;
+constexpr size_t RemoteInspectionBatch::MAX_SIZE;
+
+namespace
+{
+constexpr size_t MAX_FRAME_SIZE = RemoteInspectionBatch::FRAME_HEADER_SIZE + MAX_CANFD_FRAME_BYTE_SIZE +
+                                  ( CollectedCanFrameWithSignals::MAX_DECODED_SIGNALS *
+                                    RemoteInspectionBatch::DECODED_SIGNAL_SIZE );
+
+template <typename T>
+void
+put( std::vector<uint8_t> &buffer, T value )
+{
+    for ( size_t i = 0; i < sizeof( T ); i++ )
+    {
+        buffer.push_back( static_cast<uint8_t>( value >> ( 8U * i ) ) );
+    }
+}
+
+void
+putDouble( std::vector<uint8_t> &buffer, double value )
+{
+    uint64_t bits = 0;
+    memcpy( &bits, &value, sizeof( bits ) );
+    put( buffer, bits );
+}
+
+template <typename T>
+void
+set( std::vector<uint8_t> &buffer, size_t offset, T value )
+{
+    for ( size_t i = 0; i < sizeof( T ); i++ )
+    {
+        buffer[offset + i] = static_cast<uint8_t>( value >> ( 8U * i ) );
+    }
+}
+
+// Reads from a buffer of which the size was checked before
+template <typename T>
+T
+get( const uint8_t *&data )
+{
+    T value = 0;
+    for ( size_t i = 0; i < sizeof( T ); i++ )
+    {
+        value = static_cast<T>( value | ( static_cast<T>( data[i] ) << ( 8U * i ) ) );
+    }
+    data += sizeof( T );
+    return value;
+}
+
+double
+getDouble( const uint8_t *&data )
+{
+    auto bits = get<uint64_t>( data );
+    double value = 0.0;
+    memcpy( &value, &bits, sizeof( value ) );
+    return value;
+}
+} // namespace
+
+RemoteInspectionBatch::RemoteInspectionBatch( size_t maxSize )
+    : mMaxSize( std::min( std::max( maxSize, HEADER_SIZE + MAX_FRAME_SIZE ), MAX_SIZE ) )
+{
+    mBuffer.reserve( mMaxSize );
+    clear();
+}
+
+void
+RemoteInspectionBatch::clear()
+{
+    mBuffer.assign( HEADER_SIZE, 0 );
+    mSignalCount = 0;
+    mFrameCount = 0;
+}
+
+bool
+RemoteInspectionBatch::addSignal( const CollectedSignal &signal )
+{
+    if ( ( mBuffer.size() + SIGNAL_SIZE > mMaxSize ) || ( mSignalCount == UINT16_MAX ) )
+    {
+        return false;
+    }
+    put( mBuffer, signal.signalID );
+    put( mBuffer, signal.receiveTime );
+    put( mBuffer, signal.receiveTimeFractionUs );
+    putDouble( mBuffer, signal.value );
+    mSignalCount++;
+    return true;
+}
+
+bool
+RemoteInspectionBatch::addFrame( const CollectedCanFrameWithSignals &frame )
+{
+    auto size = std::min( frame.size, MAX_CANFD_FRAME_BYTE_SIZE );
+    uint8_t decodedSignalCount = frame.decodedSignalCount < CollectedCanFrameWithSignals::MAX_DECODED_SIGNALS
+                                     ? frame.decodedSignalCount
+                                     : CollectedCanFrameWithSignals::MAX_DECODED_SIGNALS;
+    if ( ( mBuffer.size() + FRAME_HEADER_SIZE + size + ( decodedSignalCount * DECODED_SIGNAL_SIZE ) > mMaxSize ) ||
+         ( mFrameCount == UINT16_MAX ) )
+    {
+        return false;
+    }
+    put( mBuffer, frame.frameID );
+    put( mBuffer, frame.channelId );
+    put( mBuffer, frame.receiveTime );
+    put( mBuffer, frame.receiveTimeFractionUs );
+    put( mBuffer, size );
+    put( mBuffer, decodedSignalCount );
+    mBuffer.insert( mBuffer.end(), frame.data.begin(), frame.data.begin() + size );
+    for ( uint8_t i = 0; i < decodedSignalCount; i++ )
+    {
+        put( mBuffer, frame.decodedSignals[i].signalID );
+        putDouble( mBuffer, frame.decodedSignals[i].value );
+    }
+    mFrameCount++;
+    return true;
+}
+
+const std::vector<uint8_t> &
+RemoteInspectionBatch::finish( uint32_t sequence )
+{
+    set( mBuffer, 0, MAGIC );
+    set( mBuffer, 4, VERSION );
+    set( mBuffer, 6, mSignalCount );
+    set( mBuffer, 8, sequence );
+    set( mBuffer, 12, mFrameCount );
+    return mBuffer;
+}
+
+bool
+RemoteInspectionBatch::decode( const uint8_t *data,
+                               size_t size,
+                               uint32_t &sequence,
+                               std::vector<CollectedSignal> &signals,
+                               std::vector<CollectedCanFrameWithSignals> &frames )
+{
+    if ( ( data == nullptr ) || ( size < HEADER_SIZE ) )
+    {
+        return false;
+    }
+    const auto *end = data + size;
+    const auto *position = data;
+    auto magic = get<uint32_t>( position );
+    auto version = get<uint8_t>( position );
+    position++;
+    auto signalCount = get<uint16_t>( position );
+    auto batchSequence = get<uint32_t>( position );
+    auto frameCount = get<uint16_t>( position );
+    position += 2;
+    if ( ( magic != MAGIC ) || ( version != VERSION ) ||
+         ( static_cast<size_t>( end - position ) < ( signalCount * SIGNAL_SIZE ) ) )
+    {
+        return false;
+    }
+    auto signalsBefore = signals.size();
+    auto framesBefore = frames.size();
+    for ( uint16_t i = 0; i < signalCount; i++ )
+    {
+        CollectedSignal signal;
+        signal.signalID = get<uint32_t>( position );
+        signal.receiveTime = get<uint64_t>( position );
+        signal.receiveTimeFractionUs = get<uint16_t>( position );
+        signal.value = getDouble( position );
+        signals.emplace_back( signal );
+    }
+    for ( uint16_t i = 0; i < frameCount; i++ )
+    {
+        if ( static_cast<size_t>( end - position ) < FRAME_HEADER_SIZE )
+        {
+            break;
+        }
+        CollectedCanFrameWithSignals frame;
+        frame.frameID = get<uint32_t>( position );
+        frame.channelId = get<uint32_t>( position );
+        frame.receiveTime = get<uint64_t>( position );
+        frame.receiveTimeFractionUs = get<uint16_t>( position );
+        frame.size = get<uint8_t>( position );
+        frame.decodedSignalCount = get<uint8_t>( position );
+        if ( ( frame.size > MAX_CANFD_FRAME_BYTE_SIZE ) ||
+             ( frame.decodedSignalCount > CollectedCanFrameWithSignals::MAX_DECODED_SIGNALS ) ||
+             ( static_cast<size_t>( end - position ) <
+               ( frame.size + ( frame.decodedSignalCount * DECODED_SIGNAL_SIZE ) ) ) )
+        {
+            break;
+        }
+        std::copy( position, position + frame.size, frame.data.begin() );
+        position += frame.size;
+        for ( uint8_t j = 0; j < frame.decodedSignalCount; j++ )
+        {
+            frame.decodedSignals[j].signalID = get<uint32_t>( position );
+            frame.decodedSignals[j].value = getDouble( position );
+        }
+        frames.emplace_back( frame );
+    }
+    if ( ( frames.size() - framesBefore != frameCount ) || ( position != end ) )
+    {
+        // Truncated or corrupted, a partial batch is not passed on
+        signals.resize( signalsBefore );
+        frames.resize( framesBefore );
+        return false;
+    }
+    sequence = batchSequence;
+    return true;
+}
+
+} // namespace DataInspection
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -0,0 +1,267 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "RemoteInspectionReceiver.h"
+#include "TraceModule.h"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataInspection
+{
+
+constexpr uint32_t RemoteInspectionReceiver::POLL_TIMEOUT_MS;
+constexpr uint32_t RemoteInspectionReceiver::REORDER_WINDOW;
+
+RemoteInspectionReceiver::~RemoteInspectionReceiver()
+{
+    // To make sure the thread stops during teardown of tests.
+    if ( isAlive() )
+    {
+        disconnect();
+    }
+}
+
+bool
+RemoteInspectionReceiver::init( SignalBufferPtr signalBufferPtr,
+                                CANBufferPtr canBufferPtr,
+                                const std::string &listenAddress,
+                                uint16_t port )
+{
+    if ( ( signalBufferPtr == nullptr ) || ( canBufferPtr == nullptr ) )
+    {
+        mLogger.error( "RemoteInspectionReceiver::init", " Init Failed due to bufferPtr as nullptr " );
+        return false;
+    }
+    struct in_addr parsedAddress
+    {
+    };
+    if ( inet_pton( AF_INET, listenAddress.c_str(), &parsedAddress ) != 1 )
+    {
+        mLogger.error( "RemoteInspectionReceiver::init",
+                       " Invalid listen address " + listenAddress + ":" + std::to_string( port ) );
+        return false;
+    }
+    mSignalBufferPtr = std::move( signalBufferPtr );
+    mCANBufferPtr = std::move( canBufferPtr );
+    mSignalProducer = mSignalBufferPtr->addProducer();
+    mCANProducer = mCANBufferPtr->addProducer();
+    if ( ( mSignalProducer == nullptr ) || ( mCANProducer == nullptr ) )
+    {
+        mLogger.error( "RemoteInspectionReceiver::init", " Too many producers for the Signal or CAN Buffer " );
+        return false;
+    }
+    mListenAddress = listenAddress;
+    mPort = port;
+    return true;
+}
+
+bool
+RemoteInspectionReceiver::connect()
+{
+    if ( mSignalProducer == nullptr )
+    {
+        mLogger.error( "RemoteInspectionReceiver::connect", " Not initialized " );
+        return false;
+    }
+    // Prevent concurrent stop/init
+    std::lock_guard<std::mutex> lock( mThreadMutex );
+    mSocket = socket( AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0 );
+    if ( mSocket < 0 )
+    {
+        mLogger.error( "RemoteInspectionReceiver::connect",
+                       " Failed to open the socket: " + std::string( strerror( errno ) ) );
+        return false;
+    }
+    struct sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons( mPort );
+    inet_pton( AF_INET, mListenAddress.c_str(), &address.sin_addr );
+    if ( bind( mSocket, reinterpret_cast<struct sockaddr *>( &address ), sizeof( address ) ) != 0 )
+    {
+        mLogger.error( "RemoteInspectionReceiver::connect",
+                       " Failed to bind to " + mListenAddress + ":" + std::to_string( mPort ) + ": " +
+                           std::string( strerror( errno ) ) );
+        close( mSocket );
+        mSocket = -1;
+        return false;
+    }
+    // With port 0 the kernel chose the port
+    socklen_t addressLength = sizeof( address );
+    if ( getsockname( mSocket, reinterpret_cast<struct sockaddr *>( &address ), &addressLength ) == 0 )
+    {
+        mPort = ntohs( address.sin_port );
+    }
+    // On multi core systems the shared variable mShouldStop must be updated for
+    // all cores before starting the thread otherwise thread will directly end
+    mShouldStop.store( false );
+    if ( !mThread.create( doWork, this, "fwDIRemoteRecv" ) )
+    {
+        mLogger.error( "RemoteInspectionReceiver::connect", " Thread failed to start " );
+        close( mSocket );
+        mSocket = -1;
+        return false;
+    }
+    mLogger.info( "RemoteInspectionReceiver::connect",
+                  " Receiving the decoded data on " + mListenAddress + ":" + std::to_string( mPort ) );
+    return mThread.isActive() && mThread.isValid();
+}
+
+bool
+RemoteInspectionReceiver::disconnect()
+{
+    std::lock_guard<std::mutex> lock( mThreadMutex );
+    mShouldStop.store( true, std::memory_order_relaxed );
+    mThread.release();
+    mShouldStop.store( false, std::memory_order_relaxed );
+    if ( mSocket >= 0 )
+    {
+        close( mSocket );
+        mSocket = -1;
+    }
+    mLogger.trace( "RemoteInspectionReceiver::disconnect", " Thread stopped " );
+    return !mThread.isActive();
+}
+
+bool
+RemoteInspectionReceiver::isAlive()
+{
+    return mThread.isValid() && mThread.isActive();
+}
+
+bool
+RemoteInspectionReceiver::shouldStop() const
+{
+    return mShouldStop.load( std::memory_order_relaxed );
+}
+
+void
+RemoteInspectionReceiver::handleDatagram( const uint8_t *data, size_t size )
+{
+    mSignals.clear();
+    mFrames.clear();
+    uint32_t sequence = 0;
+    if ( !RemoteInspectionBatch::decode( data, size, sequence, mSignals, mFrames ) )
+    {
+        if ( mInvalidDatagrams.fetch_add( 1, std::memory_order_relaxed ) == 0 )
+        {
+            mLogger.warn( "RemoteInspectionReceiver::handleDatagram",
+                          " Ignoring an invalid datagram of " + std::to_string( size ) + " bytes" );
+        }
+        return;
+    }
+    if ( ( !mSequenceKnown ) || ( ( sequence == 0 ) && ( mExpectedSequence != 0 ) ) )
+    {
+        if ( mSequenceKnown )
+        {
+            mLogger.info( "RemoteInspectionReceiver::handleDatagram",
+                          " Sender restarted, expected sequence " + std::to_string( mExpectedSequence ) );
+        }
+        // Senders start at 0, so that a restart is not mistaken for a late batch
+        mSequenceKnown = true;
+        mExpectedSequence = sequence + 1U;
+    }
+    else if ( sequence - mExpectedSequence < ( UINT32_MAX / 2U ) )
+    {
+        // Batches were skipped, they count as lost until they arrive late
+        auto gap = sequence - mExpectedSequence;
+        if ( gap > 0 )
+        {
+            mLostBatches.fetch_add( gap, std::memory_order_relaxed );
+            TraceModule::get().addToAtomicVariable( TraceAtomicVariable::REMOTE_INSPECTION_LOST_BATCHES, gap );
+        }
+        mExpectedSequence = sequence + 1U;
+    }
+    else if ( mExpectedSequence - sequence <= REORDER_WINDOW )
+    {
+        // A batch that was overtaken is still passed on and no longer lost
+        if ( mLostBatches.load( std::memory_order_relaxed ) > 0 )
+        {
+            mLostBatches.fetch_sub( 1, std::memory_order_relaxed );
+            TraceModule::get().subtractFromAtomicVariable( TraceAtomicVariable::REMOTE_INSPECTION_LOST_BATCHES, 1 );
+        }
+    }
+    else
+    {
+        mLogger.info( "RemoteInspectionReceiver::handleDatagram",
+                      " Sequence jumped back to " + std::to_string( sequence ) + ", expected " +
+                          std::to_string( mExpectedSequence ) );
+        mExpectedSequence = sequence + 1U;
+    }
+    mReceivedBatches.fetch_add( 1, std::memory_order_relaxed );
+
+    uint64_t dropped = 0;
+    for ( const auto &signal : mSignals )
+    {
+        if ( !mSignalProducer->push( signal ) )
+        {
+            dropped++;
+        }
+    }
+    for ( const auto &frame : mFrames )
+    {
+        if ( !mCANProducer->push( frame ) )
+        {
+            dropped++;
+        }
+    }
+    if ( dropped > 0 )
+    {
+        if ( mDroppedData.fetch_add( dropped, std::memory_order_relaxed ) == 0 )
+        {
+            mLogger.warn( "RemoteInspectionReceiver::handleDatagram",
+                          " Signal or CAN Buffer full, dropping the received data" );
+        }
+    }
+    if ( ( mOutputDataAvailableSignal != nullptr ) && ( ( !mSignals.empty() ) || ( !mFrames.empty() ) ) )
+    {
+        mOutputDataAvailableSignal->notify();
+    }
+}
+
+void
+RemoteInspectionReceiver::doWork( void *data )
+{
+    auto *receiver = static_cast<RemoteInspectionReceiver *>( data );
+    std::vector<uint8_t> buffer( RemoteInspectionBatch::MAX_SIZE );
+    struct pollfd pollFd = {};
+    pollFd.fd = receiver->mSocket;
+    pollFd.events = POLLIN;
+    while ( !receiver->shouldStop() )
+    {
+        if ( poll( &pollFd, 1, static_cast<int>( POLL_TIMEOUT_MS ) ) <= 0 )
+        {
+            continue;
+        }
+        // Receive all queued datagrams before polling again
+        ssize_t received = 0;
+        while ( ( !receiver->shouldStop() ) &&
+                ( ( received = recv( receiver->mSocket, buffer.data(), buffer.size(), MSG_DONTWAIT ) ) >= 0 ) )
+        {
+            receiver->handleDatagram( buffer.data(), static_cast<size_t>( received ) );
+        }
+    }
+}
+
+} // namespace DataInspection
+} // namespace IoTFleetWise
+} // namespace Aws
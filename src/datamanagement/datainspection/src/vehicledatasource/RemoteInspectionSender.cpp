@@ -0,0 +1,255 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "RemoteInspectionSender.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataInspection
+{
+
+constexpr uint32_t RemoteInspectionSender::IDLE_TIME_MS;
+constexpr size_t RemoteInspectionSender::POP_BATCH_SIZE;
+
+RemoteInspectionSender::~RemoteInspectionSender()
+{
+    // To make sure the thread stops during teardown of tests.
+    if ( isAlive() )
+    {
+        disconnect();
+    }
+}
+
+bool
+RemoteInspectionSender::init( SignalBufferPtr signalBufferPtr,
+                              CANBufferPtr canBufferPtr,
+                              const std::string &address,
+                              uint16_t port,
+                              size_t maxDatagramSize,
+                              uint32_t flushIntervalMs )
+{
+    if ( ( signalBufferPtr == nullptr ) || ( canBufferPtr == nullptr ) )
+    {
+        mLogger.error( "RemoteInspectionSender::init", " Init Failed due to bufferPtr as nullptr " );
+        return false;
+    }
+    struct in_addr parsedAddress
+    {
+    };
+    if ( ( inet_pton( AF_INET, address.c_str(), &parsedAddress ) != 1 ) || ( port == 0 ) )
+    {
+        mLogger.error( "RemoteInspectionSender::init",
+                       " Invalid receiver address " + address + ":" + std::to_string( port ) );
+        return false;
+    }
+    mSignalBufferPtr = std::move( signalBufferPtr );
+    mCANBufferPtr = std::move( canBufferPtr );
+    mAddress = address;
+    mPort = port;
+    mFlushIntervalMs = flushIntervalMs;
+    mBatch = std::make_unique<RemoteInspectionBatch>(
+        maxDatagramSize == 0 ? RemoteInspectionBatch::DEFAULT_MAX_SIZE : maxDatagramSize );
+    return true;
+}
+
+bool
+RemoteInspectionSender::connect()
+{
+    if ( mBatch == nullptr )
+    {
+        mLogger.error( "RemoteInspectionSender::connect", " Not initialized " );
+        return false;
+    }
+    // Prevent concurrent stop/init
+    std::lock_guard<std::mutex> lock( mThreadMutex );
+    mSocket = socket( AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0 );
+    if ( mSocket < 0 )
+    {
+        mLogger.error( "RemoteInspectionSender::connect",
+                       " Failed to open the socket: " + std::string( strerror( errno ) ) );
+        return false;
+    }
+    // A connected UDP socket only needs the address once and reports ICMP errors of the receiver
+    struct sockaddr_in receiverAddress = {};
+    receiverAddress.sin_family = AF_INET;
+    receiverAddress.sin_port = htons( mPort );
+    inet_pton( AF_INET, mAddress.c_str(), &receiverAddress.sin_addr );
+    if ( ::connect( mSocket, reinterpret_cast<struct sockaddr *>( &receiverAddress ), sizeof( receiverAddress ) ) !=
+         0 )
+    {
+        mLogger.error( "RemoteInspectionSender::connect",
+                       " Failed to connect to " + mAddress + ": " + std::string( strerror( errno ) ) );
+        close( mSocket );
+        mSocket = -1;
+        return false;
+    }
+    // On multi core systems the shared variable mShouldStop must be updated for
+    // all cores before starting the thread otherwise thread will directly end
+    mShouldStop.store( false );
+    if ( !mThread.create( doWork, this, "fwDIRemoteSend" ) )
+    {
+        mLogger.error( "RemoteInspectionSender::connect", " Thread failed to start " );
+        close( mSocket );
+        mSocket = -1;
+        return false;
+    }
+    mLogger.info( "RemoteInspectionSender::connect",
+                  " Sending the decoded data to " + mAddress + ":" + std::to_string( mPort ) );
+    return mThread.isActive() && mThread.isValid();
+}
+
+bool
+RemoteInspectionSender::disconnect()
+{
+    std::lock_guard<std::mutex> lock( mThreadMutex );
+    mShouldStop.store( true, std::memory_order_relaxed );
+    mDataAvailableSignal->notify();
+    mThread.release();
+    mShouldStop.store( false, std::memory_order_relaxed );
+    if ( mSocket >= 0 )
+    {
+        close( mSocket );
+        mSocket = -1;
+    }
+    mLogger.trace( "RemoteInspectionSender::disconnect", " Thread stopped " );
+    return !mThread.isActive();
+}
+
+bool
+RemoteInspectionSender::isAlive()
+{
+    return mThread.isValid() && mThread.isActive();
+}
+
+bool
+RemoteInspectionSender::shouldStop() const
+{
+    return mShouldStop.load( std::memory_order_relaxed );
+}
+
+void
+RemoteInspectionSender::sendBatch()
+{
+    const auto &datagram = mBatch->finish( mSequence );
+    // The sequence also advances for failed sends, so the receiver counts the batch as lost
+    mSequence++;
+    if ( send( mSocket, datagram.data(), datagram.size(), 0 ) == static_cast<ssize_t>( datagram.size() ) )
+    {
+        mSentBatches.fetch_add( 1, std::memory_order_relaxed );
+    }
+    else
+    {
+        if ( mFailedBatches.fetch_add( 1, std::memory_order_relaxed ) == 0 )
+        {
+            mLogger.warn( "RemoteInspectionSender::sendBatch",
+                          " Failed to send to " + mAddress + ": " + std::string( strerror( errno ) ) );
+        }
+    }
+    mBatch->clear();
+}
+
+void
+RemoteInspectionSender::addSignal( const CollectedSignal &signal )
+{
+    if ( mBatch->empty() )
+    {
+        mBatchStartTime = FastClock::monotonicTimeMs();
+    }
+    if ( !mBatch->addSignal( signal ) )
+    {
+        sendBatch();
+        mBatchStartTime = FastClock::monotonicTimeMs();
+        mBatch->addSignal( signal );
+    }
+}
+
+void
+RemoteInspectionSender::addFrame( const CollectedCanFrameWithSignals &frame )
+{
+    if ( mBatch->empty() )
+    {
+        mBatchStartTime = FastClock::monotonicTimeMs();
+    }
+    if ( !mBatch->addFrame( frame ) )
+    {
+        sendBatch();
+        mBatchStartTime = FastClock::monotonicTimeMs();
+        mBatch->addFrame( frame );
+    }
+}
+
+void
+RemoteInspectionSender::consumeBuffers()
+{
+    std::array<CollectedSignal, POP_BATCH_SIZE> signals;
+    std::array<CollectedCanFrameWithSignals, POP_BATCH_SIZE> frames;
+    size_t poppedSignals = 0;
+    size_t poppedFrames = 0;
+    do
+    {
+        poppedSignals = mSignalBufferPtr->pop( signals.data(), signals.size() );
+        for ( size_t i = 0; i < poppedSignals; i++ )
+        {
+            addSignal( signals[i] );
+        }
+        poppedFrames = mCANBufferPtr->pop( frames.data(), frames.size() );
+        for ( size_t i = 0; i < poppedFrames; i++ )
+        {
+            addFrame( frames[i] );
+        }
+    } while ( ( ( poppedSignals > 0 ) || ( poppedFrames > 0 ) ) && ( !shouldStop() ) );
+}
+
+void
+RemoteInspectionSender::doWork( void *data )
+{
+    auto *sender = static_cast<RemoteInspectionSender *>( data );
+    while ( !sender->shouldStop() )
+    {
+        sender->consumeBuffers();
+        uint32_t waitTimeMs = IDLE_TIME_MS;
+        if ( !sender->mBatch->empty() )
+        {
+            auto waitedMs = FastClock::monotonicTimeMs() - sender->mBatchStartTime;
+            if ( waitedMs >= sender->mFlushIntervalMs )
+            {
+                sender->sendBatch();
+            }
+            else
+            {
+                waitTimeMs = static_cast<uint32_t>( sender->mFlushIntervalMs - waitedMs );
+            }
+        }
+        sender->mDataAvailableSignal->wait( waitTimeMs );
+    }
+    // Do not hold back the data popped before the stop
+    if ( !sender->mBatch->empty() )
+    {
+        sender->sendBatch();
+    }
+}
+
+} // namespace DataInspection
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -0,0 +1,277 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "SharedMemorySignalSource.h"
+#include <cerrno>
+#include <cstring>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataInspection
+{
+
+// The layout is shared with producers compiled by other compilers, so it must not depend on the padding rules
+static_assert( sizeof( fwe_shm_signal_record ) == 24, "Unexpected shared memory record size" );
+static_assert( sizeof( fwe_shm_signal_ring_header ) == 256, "Unexpected shared memory header size" );
+static_assert( offsetof( fwe_shm_signal_ring_header, write_index ) == 64, "write_index not in its own cache line" );
+static_assert( offsetof( fwe_shm_signal_ring_header, read_index ) == 128, "read_index not in its own cache line" );
+
+SharedMemorySignalSource::~SharedMemorySignalSource()
+{
+    // To make sure the thread stops during teardown of tests.
+    if ( isAlive() )
+    {
+        disconnect();
+    }
+    unmapRing();
+}
+
+bool
+SharedMemorySignalSource::init( SignalBufferPtr signalBufferPtr,
+                                const std::string &shmName,
+                                uint32_t capacity,
+                                uint32_t idleTimeMs )
+{
+    if ( signalBufferPtr == nullptr )
+    {
+        mLogger.error( "SharedMemorySignalSource::init", " Init Failed due to bufferPtr as nullptr " );
+        return false;
+    }
+    if ( ( shmName.size() < 2 ) || ( shmName[0] != '/' ) || ( shmName.find( '/', 1 ) != std::string::npos ) )
+    {
+        mLogger.error( "SharedMemorySignalSource::init", " Invalid shared memory name " + shmName );
+        return false;
+    }
+    if ( ( capacity == 0 ) || ( ( capacity & ( capacity - 1 ) ) != 0 ) )
+    {
+        mLogger.error( "SharedMemorySignalSource::init",
+                       " Capacity " + std::to_string( capacity ) + " is not a power of two " );
+        return false;
+    }
+    mSignalBufferPtr = std::move( signalBufferPtr );
+    mSignalProducer = mSignalBufferPtr->addProducer();
+    if ( mSignalProducer == nullptr )
+    {
+        mLogger.error( "SharedMemorySignalSource::init", "Too many producers for the Signal Buffer" );
+        return false;
+    }
+    mShmName = shmName;
+    mCapacity = capacity;
+    if ( idleTimeMs != 0 )
+    {
+        mIdleTimeMs = idleTimeMs;
+    }
+    return true;
+}
+
+bool
+SharedMemorySignalSource::mapRing()
+{
+    const auto size = fwe_shm_signal_ring_size( mCapacity );
+    int fd = shm_open( mShmName.c_str(), O_RDWR | O_CREAT, S_IRUSR | S_IWUSR );
+    if ( fd < 0 )
+    {
+        mLogger.error( "SharedMemorySignalSource::mapRing",
+                       " Failed to open " + mShmName + ": " + std::string( strerror( errno ) ) );
+        return false;
+    }
+    struct stat fileStat
+    {
+    };
+    bool reuse = false;
+    if ( ( fstat( fd, &fileStat ) == 0 ) && ( static_cast<size_t>( fileStat.st_size ) == size ) )
+    {
+        // Keep a ring of an earlier run together with its unread records if the layout matches
+        auto *mapping = mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+        if ( mapping != MAP_FAILED )
+        {
+            auto *ring = static_cast<fwe_shm_signal_ring_header *>( mapping );
+            reuse = ( __atomic_load_n( &ring->magic, __ATOMIC_ACQUIRE ) == FWE_SHM_SIGNAL_RING_MAGIC ) &&
+                    ( ring->version == FWE_SHM_SIGNAL_RING_VERSION ) &&
+                    ( ring->record_size == sizeof( fwe_shm_signal_record ) ) && ( ring->capacity == mCapacity );
+            if ( reuse )
+            {
+                mRing = ring;
+            }
+            else
+            {
+                munmap( mapping, size );
+            }
+        }
+    }
+    if ( !reuse )
+    {
+        // Producers still mapping an incompatible ring would write into memory of a different layout, so the old
+        // object is unlinked and a new one is created. The producers keep their orphaned mapping until they reopen.
+        close( fd );
+        shm_unlink( mShmName.c_str() );
+        fd = shm_open( mShmName.c_str(), O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR );
+        if ( ( fd < 0 ) || ( ftruncate( fd, static_cast<off_t>( size ) ) != 0 ) )
+        {
+            mLogger.error( "SharedMemorySignalSource::mapRing",
+                           " Failed to create " + mShmName + ": " + std::string( strerror( errno ) ) );
+            if ( fd >= 0 )
+            {
+                close( fd );
+            }
+            return false;
+        }
+        auto *mapping = mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+        if ( mapping == MAP_FAILED )
+        {
+            mLogger.error( "SharedMemorySignalSource::mapRing", " Failed to map " + mShmName );
+            close( fd );
+            return false;
+        }
+        mRing = static_cast<fwe_shm_signal_ring_header *>( mapping );
+        // ftruncate zeroed the memory, so the indexes and the drop counter start at 0
+        mRing->version = FWE_SHM_SIGNAL_RING_VERSION;
+        mRing->capacity = mCapacity;
+        mRing->record_size = sizeof( fwe_shm_signal_record );
+        __atomic_store_n( &mRing->magic, FWE_SHM_SIGNAL_RING_MAGIC, __ATOMIC_RELEASE );
+    }
+    close( fd );
+    mLogger.info( "SharedMemorySignalSource::mapRing",
+                  std::string( reuse ? " Reusing " : " Created " ) + mShmName + " with capacity " +
+                      std::to_string( mCapacity ) );
+    return true;
+}
+
+void
+SharedMemorySignalSource::unmapRing()
+{
+    if ( mRing != nullptr )
+    {
+        munmap( mRing, fwe_shm_signal_ring_size( mCapacity ) );
+        mRing = nullptr;
+    }
+}
+
+bool
+SharedMemorySignalSource::connect()
+{
+    if ( mSignalProducer == nullptr )
+    {
+        mLogger.error( "SharedMemorySignalSource::connect", " Not initialized " );
+        return false;
+    }
+    // Prevent concurrent stop/init
+    std::lock_guard<std::mutex> lock( mThreadMutex );
+    if ( ( mRing == nullptr ) && ( !mapRing() ) )
+    {
+        return false;
+    }
+    // On multi core systems the shared variable mShouldStop must be updated for
+    // all cores before starting the thread otherwise thread will directly end
+    mShouldStop.store( false );
+    if ( !mThread.create( doWork, this, "fwDIShmSignals" ) )
+    {
+        mLogger.error( "SharedMemorySignalSource::connect", " Thread failed to start " );
+        return false;
+    }
+    mLogger.trace( "SharedMemorySignalSource::connect", " Thread started " );
+    return mThread.isActive() && mThread.isValid();
+}
+
+bool
+SharedMemorySignalSource::disconnect()
+{
+    std::lock_guard<std::mutex> lock( mThreadMutex );
+    mShouldStop.store( true, std::memory_order_relaxed );
+    mWait.notify();
+    mThread.release();
+    mShouldStop.store( false, std::memory_order_relaxed );
+    unmapRing();
+    mLogger.trace( "SharedMemorySignalSource::disconnect", " Thread stopped " );
+    return !mThread.isActive();
+}
+
+bool
+SharedMemorySignalSource::isAlive()
+{
+    return mThread.isValid() && mThread.isActive();
+}
+
+bool
+SharedMemorySignalSource::shouldStop() const
+{
+    return mShouldStop.load( std::memory_order_relaxed );
+}
+
+size_t
+SharedMemorySignalSource::consumeRecords()
+{
+    const auto writeIndex = __atomic_load_n( &mRing->write_index, __ATOMIC_ACQUIRE );
+    auto readIndex = __atomic_load_n( &mRing->read_index, __ATOMIC_RELAXED );
+    const auto *records = fwe_shm_signal_ring_records( mRing );
+    Timestamp receiveTime = 0;
+    size_t count = 0;
+    while ( ( readIndex != writeIndex ) && ( count < MAX_BATCH_SIZE ) )
+    {
+        const auto &record = records[readIndex & ( mCapacity - 1U )];
+        CollectedSignal signal( record.signal_id, record.timestamp_ms, record.value );
+        if ( signal.receiveTime == 0 )
+        {
+            if ( receiveTime == 0 )
+            {
+                receiveTime = mClock->timeSinceEpochMs();
+            }
+            signal.receiveTime = receiveTime;
+        }
+        // The record stays in the shared ring until there is space, so that the producer sees the back pressure
+        if ( ( signal.signalID != INVALID_SIGNAL_ID ) && ( !mSignalProducer->push( signal ) ) )
+        {
+            break;
+        }
+        readIndex++;
+        count++;
+    }
+    if ( count > 0 )
+    {
+        __atomic_store_n( &mRing->read_index, readIndex, __ATOMIC_RELEASE );
+        mReceivedSignals.fetch_add( count, std::memory_order_relaxed );
+    }
+    mDroppedSignals.store( __atomic_load_n( &mRing->dropped, __ATOMIC_RELAXED ), std::memory_order_relaxed );
+    return count;
+}
+
+void
+SharedMemorySignalSource::doWork( void *data )
+{
+    auto *source = static_cast<SharedMemorySignalSource *>( data );
+    while ( !source->shouldStop() )
+    {
+        auto count = source->consumeRecords();
+        if ( count > 0 )
+        {
+            if ( source->mOutputDataAvailableSignal != nullptr )
+            {
+                source->mOutputDataAvailableSignal->notify();
+            }
+            if ( count == MAX_BATCH_SIZE )
+            {
+                // More records are probably waiting
+                continue;
+            }
+        }
+        // The producer cannot wake up this process, so the ring is polled
+        source->mWait.wait( source->mIdleTimeMs );
+    }
+}
+
+} // namespace DataInspection
+} // namespace IoTFleetWise
+} // namespace Aws
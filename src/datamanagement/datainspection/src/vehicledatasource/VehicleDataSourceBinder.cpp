@@ -21,16 +21,16 @@ namespace IoTFleetWise
 namespace DataInspection
 {
 
+constexpr uint32_t VehicleDataSourceBinder::RECONNECT_START_BACKOFF_MS;
+constexpr uint32_t VehicleDataSourceBinder::RECONNECT_MAX_BACKOFF_MS;
+
 VehicleDataSourceBinder::~VehicleDataSourceBinder()
 {
+    // To make sure no retry runs on a destroyed binder during teardown of tests.
+    mConnected.store( false );
+    cancelReconnects();
     mDataSourcesToConsumers.clear();
     mIdsToDataSources.clear();
-    mDataSourceStates.clear();
-    // To make sure the thread stops during teardown of tests.
-    if ( isAlive() )
-    {
-        stop();
-    }
 }
 
 bool
@@ -134,22 +134,28 @@ VehicleDataSourceBinder::bindConsumerToVehicleDataSource( VehicleDataConsumerPtr
         mLogger.error( "VehicleDataSourceBinder::bindConsumerToVehicleDataSource", "Source not found" );
         return false;
     }
-    // Insert the consumer/ID pair
+    // Insert the consumer/ID pair. Sources that split their messages over multiple buffers get one consumer
+    // per buffer, in the order of binding
+    size_t bufferIndex = 0;
     {
         std::lock_guard<std::mutex> lock( mConsumersMutex );
-        auto consumerIterator = mDataSourcesToConsumers.emplace( id, consumer );
-
-        if ( !consumerIterator.second )
+        bufferIndex = mDataSourcesToConsumers.count( id );
+        if ( bufferIndex >= dataSourceIterator->second->getBufferCount() )
         {
+            mLogger.error( "VehicleDataSourceBinder::bindConsumerToVehicleDataSource",
+                           "All buffers of the source are already bound" );
             return false;
         }
+        mDataSourcesToConsumers.emplace( id, consumer );
     }
     // Propagate the data source metadata
     consumer->setChannelMetadata( std::make_tuple( dataSourceIterator->second->getVehicleDataSourceType(),
                                                    dataSourceIterator->second->getVehicleDataSourceProtocol(),
                                                    dataSourceIterator->second->getVehicleDataSourceIfName() ) );
     // Assign the circular buffer of the data source to the consumer
-    consumer->setInputBuffer( dataSourceIterator->second->getBuffer() );
+    consumer->setInputBuffer( dataSourceIterator->second->getBuffer( bufferIndex ) );
+    // Let the source wake up the consumer instead of the consumer polling the buffer
+    dataSourceIterator->second->setDataAvailableSignal( consumer->getDataAvailableSignal(), bufferIndex );
     // Start the consumer worker
     return consumer->connect();
 }
@@ -165,247 +171,229 @@ VehicleDataSourceBinder::unBindConsumerFromVehicleDataSource( const VehicleDataS
         return false;
     }
 
-    auto backupConsumer = VehicleDataConsumerPtr();
-    // Lookup the consumer registered to this data source
+    std::vector<VehicleDataConsumerPtr> backupConsumers;
+    // Lookup the consumers registered to this data source
     {
         std::lock_guard<std::mutex> lock( mConsumersMutex );
-        auto consumerIterator = mDataSourcesToConsumers.find( id );
+        auto consumerRange = mDataSourcesToConsumers.equal_range( id );
         // Something went wrong... No consumer is registered for this data source
-        if ( consumerIterator == mDataSourcesToConsumers.end() )
+        if ( consumerRange.first == consumerRange.second )
         {
             mLogger.error( "VehicleDataSourceBinder::unBindConsumerFromVehicleDataSource", "Consumer not found" );
             return false;
         }
-        backupConsumer = consumerIterator->second;
-        mDataSourcesToConsumers.erase( consumerIterator );
+        for ( auto consumerIterator = consumerRange.first; consumerIterator != consumerRange.second;
+              consumerIterator++ )
+        {
+            backupConsumers.emplace_back( consumerIterator->second );
+        }
+        mDataSourcesToConsumers.erase( consumerRange.first, consumerRange.second );
     }
-    // Disconnect the consumer.
-    if ( backupConsumer != nullptr )
+    // Stop the source from waking up the consumers
     {
-        return backupConsumer->disconnect();
+        std::lock_guard<std::mutex> lock( mVehicleDataSourcesMutex );
+        auto dataSourceIterator = mIdsToDataSources.find( id );
+        if ( dataSourceIterator != mIdsToDataSources.end() )
+        {
+            for ( size_t bufferIndex = 0; bufferIndex < backupConsumers.size(); bufferIndex++ )
+            {
+                dataSourceIterator->second->setDataAvailableSignal( nullptr, bufferIndex );
+            }
+        }
     }
-    else
+    // Disconnect the consumers.
+    bool disconnected = true;
+    for ( const auto &backupConsumer : backupConsumers )
     {
-        return false;
+        disconnected = ( backupConsumer != nullptr ) && backupConsumer->disconnect() && disconnected;
     }
+    return disconnected;
 }
 
 bool
 VehicleDataSourceBinder::disconnectConsumer( const VehicleDataSourceID &id )
 {
-    auto backupConsumer = VehicleDataConsumerPtr();
-    // Lookup the consumer registered to this data source
-    // release the Mutex after this context to allow addition of consumers.
+    auto backupConsumers = getConsumers( id );
+    // Something went wrong... No consumer is registered for this data source
+    if ( backupConsumers.empty() )
     {
-        std::lock_guard<std::mutex> lock( mConsumersMutex );
-        auto consumerIterator = mDataSourcesToConsumers.find( id );
-        // Something went wrong... No consumer is registered for this data source
-        if ( consumerIterator == mDataSourcesToConsumers.end() )
-        {
-            mLogger.error( "VehicleDataSourceBinder::disconnectConsumer", "Consumer not found" );
-            return false;
-        }
-        backupConsumer = consumerIterator->second;
-    }
-    // Disconnect the consumer.
-    if ( backupConsumer != nullptr )
-    {
-        return backupConsumer->disconnect();
+        mLogger.error( "VehicleDataSourceBinder::disconnectConsumer", "Consumer not found" );
+        return false;
     }
-    else
+    // Disconnect the consumers.
+    bool disconnected = true;
+    for ( const auto &backupConsumer : backupConsumers )
     {
-        return false;
+        disconnected = ( backupConsumer != nullptr ) && backupConsumer->disconnect() && disconnected;
     }
+    return disconnected;
 }
 
 bool
 VehicleDataSourceBinder::reConnectConsumer( const VehicleDataSourceID &id )
 {
-    auto backupConsumer = VehicleDataConsumerPtr();
-    // Lookup the consumer registered to this data source
-    // release the Mutex after this context to allow addition of consumers.
+    auto backupConsumers = getConsumers( id );
+    // On bootstrap the source connects before its consumers are bound, there is nothing to reconnect
+    if ( backupConsumers.empty() )
     {
-        std::lock_guard<std::mutex> lock( mConsumersMutex );
-        auto consumerIterator = mDataSourcesToConsumers.find( id );
-        // Something went wrong... No consumer is registered for this data source
-        if ( consumerIterator == mDataSourcesToConsumers.end() )
-        {
-            mLogger.error( "VehicleDataSourceBinder::reConnectConsumer", "Consumer not found" );
-            return false;
-        }
-        backupConsumer = consumerIterator->second;
-    }
-    // reConnect the consumer. Make sure that the consumer is not alive already
-    if ( backupConsumer != nullptr && !backupConsumer->isAlive() )
-    {
-        return backupConsumer->connect();
+        mLogger.trace( "VehicleDataSourceBinder::reConnectConsumer", "No consumer bound yet" );
+        return true;
     }
-    else
+    // reConnect the consumers. Consumers that are alive already are left running
+    bool connected = true;
+    for ( const auto &backupConsumer : backupConsumers )
     {
-        return false;
+        connected = ( backupConsumer != nullptr ) && ( backupConsumer->isAlive() || backupConsumer->connect() ) &&
+                    connected;
     }
+    return connected;
 }
 
-bool
-VehicleDataSourceBinder::start()
+std::vector<VehicleDataConsumerPtr>
+VehicleDataSourceBinder::getConsumers( const VehicleDataSourceID &id )
 {
-    // Prevent concurrent stop/init
-    std::lock_guard<std::mutex> lock( mThreadMutex );
-    // On multi core systems the shared variable mShouldStop must be updated for
-    // all cores before starting the thread otherwise thread will directly end
-    mShouldStop.store( false );
-    if ( !mThread.create( doWork, this ) )
-    {
-        mLogger.trace( "VehicleDataSourceBinder::start", " Binder Thread failed to start " );
-    }
-    else
+    std::vector<VehicleDataConsumerPtr> consumers;
+    // Release the Mutex after this context to allow addition of consumers.
+    std::lock_guard<std::mutex> lock( mConsumersMutex );
+    auto consumerRange = mDataSourcesToConsumers.equal_range( id );
+    for ( auto consumerIterator = consumerRange.first; consumerIterator != consumerRange.second; consumerIterator++ )
     {
-        mLogger.trace( "VehicleDataSourceBinder::start", " Binder Thread started " );
-        mThread.setThreadName( "fwDIBinder" );
+        consumers.emplace_back( consumerIterator->second );
     }
-
-    return mThread.isActive() && mThread.isValid();
+    return consumers;
 }
 
 bool
-VehicleDataSourceBinder::stop()
+VehicleDataSourceBinder::isAlive()
 {
-    std::lock_guard<std::mutex> lock( mThreadMutex );
-    mShouldStop.store( true, std::memory_order_relaxed );
-    mWait.notify();
-    mThread.release();
-    mShouldStop.store( false, std::memory_order_relaxed );
-    return !mThread.isActive();
+    return mConnected.load();
 }
 
-bool
-VehicleDataSourceBinder::shouldStop() const
+// This callback arrives from the context of the data source, which has been disconnected before
+// and got externally re-connected. The consumers are rebound right away.
+void
+VehicleDataSourceBinder::onVehicleDataSourceConnected( const VehicleDataSourceID &id )
 {
-    return mShouldStop.load( std::memory_order_relaxed );
+    // Check if the data source ID is valid, should not happen
+    if ( ( id == INVALID_DATA_SOURCE_ID ) || ( !mConnected.load() ) )
+    {
+        return;
+    }
+    if ( reConnectConsumer( id ) )
+    {
+        mLogger.trace( "VehicleDataSourceBinder::onVehicleDataSourceConnected",
+                       "Reconnected Source ID : " + std::to_string( id ) );
+        return;
+    }
+    // Retry with backoff on the shared retry workers instead of blocking the data source
+    std::lock_guard<std::mutex> lock( mReconnectMutex );
+    mPendingReconnects.emplace( id );
+    if ( mReconnectRetryId == 0U )
+    {
+        mReconnectRetryId =
+            RetryScheduler::getInstance().schedule( *this, RECONNECT_START_BACKOFF_MS, RECONNECT_MAX_BACKOFF_MS );
+    }
 }
 
-bool
-VehicleDataSourceBinder::isAlive()
+// This callback arrives from the context of the data source. The consumers are disconnected right away.
+void
+VehicleDataSourceBinder::onVehicleDataSourceDisconnected( const VehicleDataSourceID &id )
 {
-    return mThread.isValid() && mThread.isActive();
+    // Check if the data source ID is valid, should not happen
+    if ( ( id == INVALID_DATA_SOURCE_ID ) || ( !mConnected.load() ) )
+    {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock( mReconnectMutex );
+        mPendingReconnects.erase( id );
+    }
+    // Data source is disconnected, we need to make sure the consumer is also disconnected
+    if ( disconnectConsumer( id ) )
+    {
+        mLogger.trace( "VehicleDataSourceBinder::onVehicleDataSourceDisconnected",
+                       "Disconnected Source ID : " + std::to_string( id ) );
+    }
 }
 
-void
-VehicleDataSourceBinder::doWork( void *data )
+RetryStatus
+VehicleDataSourceBinder::attempt()
 {
-
-    VehicleDataSourceBinder *binder = static_cast<VehicleDataSourceBinder *>( data );
-    while ( !binder->shouldStop() )
+    std::set<VehicleDataSourceID> pendingReconnects;
     {
-        // The idea of this thread is to actively monitor all the channels and
-        // connect / disconnect them according to their states.
-        // We can think of running this in the main Engine thread in polling mode
-        // instead of Interrupt mode if the engine knows exactly when Channels get disconnected.
-
-        binder->mTimer.reset();
-        uint32_t elapsedTimeUs = 0;
-        binder->mWait.wait( Platform::Linux::Signal::WaitWithPredicate );
-        elapsedTimeUs += static_cast<uint32_t>( binder->mTimer.getElapsedMs().count() );
-        binder->mLogger.trace( "VehicleDataSourceBinder::doWork",
-                               "Time Elapsed waiting for the interrupt : " + std::to_string( elapsedTimeUs ) );
-
-        // Some Channels have been either connected or disconnected.
-        // Copy the updates and release the lock so that other channels can
-        // signal their updates.
-        IdsToStates sourceStatesCopy;
-        {
-            std::lock_guard<std::mutex> lock( binder->mVehicleDataSourceUpdatesMutex );
-            if ( !binder->mDataSourceStates.empty() )
-            {
-                sourceStatesCopy.swap( binder->mDataSourceStates );
-            }
-        }
-        for ( auto &sourceID : sourceStatesCopy )
+        std::lock_guard<std::mutex> lock( mReconnectMutex );
+        pendingReconnects = mPendingReconnects;
+    }
+    std::set<VehicleDataSourceID> reconnected;
+    for ( const auto &id : pendingReconnects )
+    {
+        if ( reConnectConsumer( id ) )
         {
-            if ( sourceID.second == VehicleDataSourceState::CONNECTED )
-            {
-                // This is only successful if the source has been disconnected and reconnected.
-                // On bootstrap, this will be simply ignored, as the data source is started
-                // by the binder.
-                if ( binder->reConnectConsumer( sourceID.first ) )
-                {
-                    binder->mLogger.trace( "VehicleDataSourceBinder::doWork",
-                                           "Reconnected Source ID : " + std::to_string( sourceID.first ) );
-                }
-            }
-            else if ( sourceID.second == VehicleDataSourceState::DISCONNECTED )
-            {
-                // Data source is disconnected, we need to make sure the consumer is also disconnected
-                if ( binder->disconnectConsumer( sourceID.first ) )
-                {
-                    binder->mLogger.trace( "VehicleDataSourceBinder::doWork",
-                                           "Disconnected Source ID : " + std::to_string( sourceID.first ) );
-                }
-            }
+            mLogger.trace( "VehicleDataSourceBinder::attempt", "Reconnected Source ID : " + std::to_string( id ) );
+            reconnected.emplace( id );
         }
     }
+    std::lock_guard<std::mutex> lock( mReconnectMutex );
+    for ( const auto &id : reconnected )
+    {
+        mPendingReconnects.erase( id );
+    }
+    // Sources that fail to reconnect while the retries finish schedule new retries
+    if ( mPendingReconnects.empty() )
+    {
+        mReconnectRetryId = 0;
+        return RetryStatus::SUCCESS;
+    }
+    return RetryStatus::RETRY;
 }
 
-// This callback/Interrupt arrives from a different thread context. We just copy the
-// interrupt and wake up this worker thread.
 void
-VehicleDataSourceBinder::onVehicleDataSourceConnected( const VehicleDataSourceID &id )
+VehicleDataSourceBinder::onFinished( RetryStatus code )
 {
-    // Check if the data source ID is valid, should not happen
-    if ( id == INVALID_DATA_SOURCE_ID )
+    if ( code == RetryStatus::ABORT )
     {
-        return;
+        mLogger.trace( "VehicleDataSourceBinder::onFinished", "Pending reconnects cancelled" );
     }
-    // This event happens if the data source has been disconnected before and got
-    // externally re-connected. We should signal to this worker thread to rebind the
-    // data source to underlying consumer
-    {
-        std::lock_guard<std::mutex> lock( mVehicleDataSourceUpdatesMutex );
-        mDataSourceStates.emplace( id, VehicleDataSourceState::CONNECTED );
-    }
-    // Send an Interrupt
-    mWait.notify();
 }
 
-// This callback/Interrupt arrives from a different thread context. We just copy the
-// interrupt and wake up this worker thread.
 void
-VehicleDataSourceBinder::onVehicleDataSourceDisconnected( const VehicleDataSourceID &id )
+VehicleDataSourceBinder::cancelReconnects()
 {
-    // Check if the data source ID is valid, should not happen
-    if ( id == INVALID_DATA_SOURCE_ID )
+    RetryScheduler::RetryId id = 0;
     {
-        return;
+        std::lock_guard<std::mutex> lock( mReconnectMutex );
+        id = mReconnectRetryId;
+        mReconnectRetryId = 0;
+        mPendingReconnects.clear();
     }
-    // This event happens if the data source has been disconnected.
-    // We should signal to this worker thread to unbind the underlying consumer
+    // Cancel without holding the lock, as it waits for a running attempt that takes it
+    if ( id != 0U )
     {
-        std::lock_guard<std::mutex> lock( mVehicleDataSourceUpdatesMutex );
-        mDataSourceStates.emplace( id, VehicleDataSourceState::DISCONNECTED );
+        RetryScheduler::getInstance().cancel( id );
     }
-    // Send an Interrupt
-    mWait.notify();
 }
 
 bool
 VehicleDataSourceBinder::connect()
 {
-    // Limiting the connect call to only starting the thread.
+    // Limiting the connect call to only enabling the handling of the source events.
     // We could move the connect of all channels in this function, however it will limit
     // the runtime addition of channels, which might be a wanted feature in the future.
-    // At this point, only the binder thread will start.
-    return start();
+    mConnected.store( true );
+    return true;
 }
 
 bool
 VehicleDataSourceBinder::disconnect()
 {
+    // Stop reflecting the source events, so that the consumers are not reconnected while
+    // they are disconnected below
+    mConnected.store( false );
+    cancelReconnects();
     // In the disconnect, we need to make sure we disconnect all channels and consumers
     // in a safe way.
     // We start first disconnecting the consumers as they hold references to channels buffers.
     {
-        // This mutex guarantees that when the consumers are disconnected,
-        // this thread does not accidentally tries to reconnect them.
         std::lock_guard<std::mutex> lock( mConsumersMutex );
         for ( auto const &consumer : mDataSourcesToConsumers )
         {
@@ -424,12 +412,9 @@ VehicleDataSourceBinder::disconnect()
     // In the disconnect, we need to make sure we disconnect all channels and consumers
     // in a safe way.
     {
-        // This mutex guarantees that when the channels are disconnected,
-        // this thread does not accidentally tries to reconnect them.
         std::lock_guard<std::mutex> lock( mVehicleDataSourcesMutex );
         for ( auto const &source : mIdsToDataSources )
         {
-            //            if ( !source.second->unSubscribeListener( this ) || !source.second->disconnect() )
             if ( !source.second->disconnect() )
             {
                 mLogger.error( "VehicleDataSourceBinder::disconnect",
@@ -443,8 +428,7 @@ VehicleDataSourceBinder::disconnect()
             }
         }
     }
-    // Finally, stop the thread
-    return stop();
+    return true;
 }
 
 void
@@ -467,13 +451,17 @@ VehicleDataSourceBinder::onChangeOfActiveDictionary( ConstDecoderDictionaryConst
     std::lock_guard<std::mutex> lockConsumer( mConsumersMutex );
     if ( dictionary.get() != nullptr )
     {
+        // For CAN let the kernel drop all frames that are not in the dictionary before they are
+        // copied to user space
+        auto canDictionary = std::dynamic_pointer_cast<const CANDecoderDictionary>( dictionary );
 
         std::for_each( mDataSourcesToConsumers.begin(),
                        mDataSourcesToConsumers.end(),
                        [&]( const std::pair<VehicleDataSourceID, VehicleDataConsumerPtr> &consumer ) {
                            if ( networkProtocol == consumer.second->getVehicleDataSourceProtocol() )
                            {
-                               consumer.second->resumeDataConsumption( dictionary );
+                               consumer.second->resumeDataConsumption(
+                                   getChannelDictionary( dictionary, canDictionary, consumer.first ) );
                                mLogger.trace( "VehicleDataSourceBinder::onChangeOfActiveDictionary",
                                               "Resuming Consumption on Consumer :" +
                                                   std::to_string( consumer.second->getConsumerID() ) );
@@ -485,6 +473,10 @@ VehicleDataSourceBinder::onChangeOfActiveDictionary( ConstDecoderDictionaryConst
                        [&]( const std::pair<VehicleDataSourceID, VehicleDataSourcePtr> &source ) {
                            if ( networkProtocol == source.second->getVehicleDataSourceProtocol() )
                            {
+                               if ( canDictionary != nullptr )
+                               {
+                                   setMessageFilter( *canDictionary, source.second );
+                               }
                                source.second->resumeDataAcquisition();
                                mLogger.trace( "VehicleDataSourceBinder::onChangeOfActiveDictionary",
                                               "Resuming Consumption on Data source : " +
@@ -520,6 +512,81 @@ VehicleDataSourceBinder::onChangeOfActiveDictionary( ConstDecoderDictionaryConst
                        } );
     }
 }
+
+void
+VehicleDataSourceBinder::onIncrementalChangeOfActiveDictionary( ConstDecoderDictionaryConstPtr &dictionary,
+                                                                VehicleDataSourceProtocol networkProtocol,
+                                                                const DecoderDictionaryDiff &diff )
+{
+    auto canDictionary = std::dynamic_pointer_cast<const CANDecoderDictionary>( dictionary );
+    if ( canDictionary == nullptr )
+    {
+        onChangeOfActiveDictionary( dictionary, networkProtocol );
+        return;
+    }
+    std::lock_guard<std::mutex> lockChannel( mVehicleDataSourcesMutex );
+    std::lock_guard<std::mutex> lockConsumer( mConsumersMutex );
+    for ( const auto &channel : diff.channels )
+    {
+        // The consumers swap to the new decoding rules between two frames, without suspending
+        auto consumers = mDataSourcesToConsumers.equal_range( channel.first );
+        auto channelDictionary = getChannelDictionary( dictionary, canDictionary, channel.first );
+        for ( auto consumer = consumers.first; consumer != consumers.second; consumer++ )
+        {
+            if ( networkProtocol == consumer->second->getVehicleDataSourceProtocol() )
+            {
+                consumer->second->resumeDataConsumption( channelDictionary );
+            }
+        }
+        auto source = mIdsToDataSources.find( channel.first );
+        if ( ( source != mIdsToDataSources.end() ) &&
+             ( networkProtocol == source->second->getVehicleDataSourceProtocol() ) &&
+             channel.second.framesAddedOrRemoved() )
+        {
+            setMessageFilter( *canDictionary, source->second );
+        }
+        mLogger.trace( "VehicleDataSourceBinder::onIncrementalChangeOfActiveDictionary",
+                       "Updated Data source : " + std::to_string( channel.first ) + " with " +
+                           std::to_string( channel.second.addedFrameIDs.size() ) + " added, " +
+                           std::to_string( channel.second.removedFrameIDs.size() ) + " removed and " +
+                           std::to_string( channel.second.changedFrameIDs.size() ) + " changed frames" );
+    }
+}
+
+void
+VehicleDataSourceBinder::setMessageFilter( const CANDecoderDictionary &dictionary, const VehicleDataSourcePtr &source )
+{
+    std::vector<uint32_t> frameIDs;
+    auto channel = dictionary.canMessageDecoderMethod.find( source->getVehicleDataSourceID() );
+    if ( channel != dictionary.canMessageDecoderMethod.end() )
+    {
+        frameIDs.reserve( channel->second.size() );
+        for ( const auto &frame : channel->second )
+        {
+            frameIDs.emplace_back( frame.first );
+        }
+    }
+    source->setMessageFilter( frameIDs );
+}
+
+std::shared_ptr<const DecoderDictionary>
+VehicleDataSourceBinder::getChannelDictionary( ConstDecoderDictionaryConstPtr &dictionary,
+                                               const std::shared_ptr<const CANDecoderDictionary> &canDictionary,
+                                               VehicleDataSourceID channelID )
+{
+    // Only the dictionaries of the CollectionSchemeManager with at least one channel have slices
+    if ( ( canDictionary == nullptr ) || canDictionary->channelSlices.empty() )
+    {
+        return dictionary;
+    }
+    auto slice = canDictionary->channelSlices.find( channelID );
+    if ( slice == canDictionary->channelSlices.end() )
+    {
+        // No decoding rules for this channel
+        return std::make_shared<const CANDecoderDictionary>();
+    }
+    return slice->second;
+}
 } // namespace DataInspection
 } // namespace IoTFleetWise
 } // namespace Aws
@@ -0,0 +1,193 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "CollectionInspectionEngine.h"
+#include <benchmark/benchmark.h>
+
+using namespace Aws::IoTFleetWise::DataInspection;
+using namespace Aws::IoTFleetWise::DataManagement;
+
+static constexpr uint32_t SIGNALS_PER_CONDITION = 10;
+static constexpr uint64_t START_TIME = 1600000000000;
+
+/**
+ * Every condition is "signal a > 50 AND signal b > 50" on two of its own signals and collects its 10 signals with
+ * the last 100 samples each, like a campaign per vehicle function. With alwaysTrue the conditions are
+ * "true" instead.
+ */
+static std::shared_ptr<const InspectionMatrix>
+createInspectionMatrix( uint32_t conditionCount, bool alwaysTrue )
+{
+    auto matrix = std::make_shared<InspectionMatrix>();
+    const uint32_t nodesPerCondition = 7;
+    // The conditions point into the storage, so it must not be reallocated
+    matrix->expressionNodeStorage.resize( conditionCount * nodesPerCondition );
+    matrix->conditions.resize( conditionCount );
+    for ( uint32_t c = 0; c < conditionCount; c++ )
+    {
+        // Depth first postorder
+        auto *nodes = &matrix->expressionNodeStorage[c * nodesPerCondition];
+        for ( uint32_t i = 0; i < 2; i++ )
+        {
+            auto &signal = nodes[i * 3];
+            auto &threshold = nodes[( i * 3 ) + 1];
+            auto &bigger = nodes[( i * 3 ) + 2];
+            signal.nodeType = ExpressionNodeType::SIGNAL;
+            signal.signalID = ( c * SIGNALS_PER_CONDITION ) + i;
+            threshold.nodeType = ExpressionNodeType::FLOAT;
+            threshold.floatingValue = 50.0;
+            bigger.nodeType = ExpressionNodeType::OPERATOR_BIGGER;
+            bigger.left = &signal;
+            bigger.right = &threshold;
+        }
+        auto &root = nodes[6];
+        if ( alwaysTrue )
+        {
+            root.nodeType = ExpressionNodeType::BOOLEAN;
+            root.booleanValue = true;
+        }
+        else
+        {
+            root.nodeType = ExpressionNodeType::OPERATOR_LOGICAL_AND;
+            root.left = &nodes[2];
+            root.right = &nodes[5];
+        }
+        auto &condition = matrix->conditions[c];
+        condition.condition = &root;
+        condition.minimumPublishInterval = 0;
+        condition.afterDuration = 0;
+        condition.includeActiveDtcs = false;
+        condition.triggerOnlyOnRisingEdge = false;
+        condition.probabilityToSend = 1.0;
+        condition.includeImageCapture = false;
+        for ( uint32_t i = 0; i < SIGNALS_PER_CONDITION; i++ )
+        {
+            InspectionMatrixSignalCollectionInfo signal{};
+            signal.signalID = ( c * SIGNALS_PER_CONDITION ) + i;
+            signal.sampleBufferSize = 100;
+            signal.minimumSampleIntervalMs = 0;
+            signal.fixedWindowPeriod = 0;
+            signal.isConditionOnlySignal = false;
+            condition.signals.emplace_back( signal );
+        }
+    }
+    return matrix;
+}
+
+static void
+fillSignalBuffers( CollectionInspectionEngine &engine, uint32_t conditionCount, uint64_t &time )
+{
+    for ( uint32_t sample = 0; sample < 100; sample++ )
+    {
+        time++;
+        for ( SignalID id = 0; id < conditionCount * SIGNALS_PER_CONDITION; id++ )
+        {
+            engine.addNewSignal( id, time, static_cast<double>( sample % 40 ) );
+        }
+    }
+}
+
+static void
+BM_addNewSignal( benchmark::State &state )
+{
+    auto conditionCount = static_cast<uint32_t>( state.range( 0 ) );
+    CollectionInspectionEngine engine;
+    engine.onChangeInspectionMatrix( createInspectionMatrix( conditionCount, false ) );
+    auto signalCount = conditionCount * SIGNALS_PER_CONDITION;
+    uint64_t time = START_TIME;
+    SignalID id = 0;
+    for ( auto _ : state )
+    {
+        engine.addNewSignal( id, time, 42.0 );
+        id++;
+        if ( id >= signalCount )
+        {
+            id = 0;
+            time++;
+        }
+    }
+    state.SetItemsProcessed( state.iterations() );
+}
+BENCHMARK( BM_addNewSignal )->Arg( 10 )->Arg( 100 );
+
+static void
+evaluateConditions( benchmark::State &state, bool nativeConditions )
+{
+    // A new value of one condition signal per evaluation, the conditions stay false
+    auto conditionCount = static_cast<uint32_t>( state.range( 0 ) );
+    CollectionInspectionEngine engine;
+#ifdef FWE_FEATURE_CONDITION_JIT
+    engine.setNativeConditionsEnabled( nativeConditions );
+#else
+    static_cast<void>( nativeConditions );
+#endif // FWE_FEATURE_CONDITION_JIT
+    engine.onChangeInspectionMatrix( createInspectionMatrix( conditionCount, false ) );
+    uint64_t time = START_TIME;
+    fillSignalBuffers( engine, conditionCount, time );
+    uint32_t condition = 0;
+    for ( auto _ : state )
+    {
+        time++;
+        engine.addNewSignal( condition * SIGNALS_PER_CONDITION, time, 10.0 );
+        engine.evaluateConditions( time );
+        condition = ( condition + 1 ) % conditionCount;
+    }
+    state.SetItemsProcessed( state.iterations() );
+}
+
+static void
+BM_evaluateConditions( benchmark::State &state )
+{
+    // Natively with FWE_FEATURE_CONDITION_JIT on x86-64 Linux
+    evaluateConditions( state, true );
+}
+BENCHMARK( BM_evaluateConditions )->Arg( 10 )->Arg( 100 );
+
+#ifdef FWE_FEATURE_CONDITION_JIT
+static void
+BM_evaluateConditionsInterpreted( benchmark::State &state )
+{
+    evaluateConditions( state, false );
+}
+BENCHMARK( BM_evaluateConditionsInterpreted )->Arg( 10 )->Arg( 100 );
+#endif // FWE_FEATURE_CONDITION_JIT
+
+static void
+BM_collectData( benchmark::State &state )
+{
+    // Every evaluation triggers all conditions, which then collect their 10 signals with 100 samples each
+    auto conditionCount = static_cast<uint32_t>( state.range( 0 ) );
+    CollectionInspectionEngine engine( false );
+    engine.onChangeInspectionMatrix( createInspectionMatrix( conditionCount, true ) );
+    uint64_t time = START_TIME;
+    fillSignalBuffers( engine, conditionCount, time );
+    uint64_t collectedSignals = 0;
+    for ( auto _ : state )
+    {
+        time++;
+        engine.evaluateConditions( time );
+        uint32_t waitTimeMs = 0;
+        for ( auto data = engine.collectNextDataToSend( time, waitTimeMs ); data != nullptr;
+              data = engine.collectNextDataToSend( time, waitTimeMs ) )
+        {
+            collectedSignals += data->signals.size();
+            benchmark::DoNotOptimize( data.get() );
+        }
+    }
+    state.counters["signalsPerIteration"] =
+        static_cast<double>( collectedSignals ) / static_cast<double>( std::max<int64_t>( state.iterations(), 1 ) );
+    state.SetItemsProcessed( state.iterations() * state.range( 0 ) );
+}
+BENCHMARK( BM_collectData )->Arg( 1 )->Arg( 10 );
+
+BENCHMARK_MAIN();
@@ -12,12 +12,19 @@
  */
 
 #include "CollectionInspectionEngine.h"
+#include "TraceModule.h"
+#include <algorithm>
+#include <array>
+#include <cstdio>
 #include <cstring>
 #include <gtest/gtest.h>
+#include <limits>
 #include <random>
+#include <unistd.h>
 
 using namespace Aws::IoTFleetWise::DataInspection;
 using namespace Aws::IoTFleetWise::DataManagement;
+using namespace Aws::IoTFleetWise::Platform::Linux;
 
 class CollectionInspectionEngineTest : public ::testing::Test
 {
@@ -107,6 +114,18 @@ protected:
         return function;
     }
 
+    std::shared_ptr<ExpressionNode>
+    getGeofenceFunctionCondition( SignalID latID, SignalID lonID, std::shared_ptr<const GeofenceIndex> geofences )
+    {
+        expressionNodes.push_back( std::make_shared<ExpressionNode>() );
+        auto function = expressionNodes.back();
+        function->nodeType = ExpressionNodeType::GEOFENCEFUNCTION;
+        function->function.geofenceFunction.latitudeSignalID = latID;
+        function->function.geofenceFunction.longitudeSignalID = lonID;
+        function->function.geofenceFunction.geofences = std::move( geofences );
+        return function;
+    }
+
     std::shared_ptr<ExpressionNode>
     getMultiFixedWindowCondition( SignalID id1 )
     {
@@ -310,6 +329,30 @@ protected:
         return bigger1;
     }
 
+    std::shared_ptr<ExpressionNode>
+    getSlidingWindowBiggerCondition( SignalID id1, WindowFunction function, double threshold1 )
+    {
+        expressionNodes.push_back( std::make_shared<ExpressionNode>() );
+        auto bigger1 = expressionNodes.back();
+        expressionNodes.push_back( std::make_shared<ExpressionNode>() );
+        auto function1 = expressionNodes.back();
+        expressionNodes.push_back( std::make_shared<ExpressionNode>() );
+        auto value1 = expressionNodes.back();
+
+        bigger1->nodeType = ExpressionNodeType::OPERATOR_BIGGER;
+        bigger1->left = function1.get();
+        bigger1->right = value1.get();
+
+        function1->nodeType = ExpressionNodeType::WINDOWFUNCTION;
+        function1->signalID = id1;
+        function1->function.windowFunction = function;
+
+        value1->nodeType = ExpressionNodeType::FLOAT;
+        value1->floatingValue = threshold1;
+
+        return bigger1;
+    }
+
     void
     SetUp() override
     {
@@ -358,6 +401,145 @@ TEST_F( CollectionInspectionEngineTest, EndlessCondition )
     EXPECT_EQ( engine.collectNextDataToSend( timestamp, waitTimeMs ), nullptr );
 }
 
+TEST_F( CollectionInspectionEngineTest, SampleTimestampsFarApart )
+{
+    CollectionInspectionEngine engine;
+    InspectionMatrixSignalCollectionInfo s1{};
+    s1.signalID = 1234;
+    s1.sampleBufferSize = 50;
+    s1.minimumSampleIntervalMs = 0;
+    s1.fixedWindowPeriod = 77777;
+    addSignalToCollect( collectionSchemes->conditions[0], s1 );
+    collectionSchemes->conditions[0].condition = getAlwaysTrueCondition().get();
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+
+    // Timestamps are stored relative to the first sample, 30 days does not fit into the 32 bit offset
+    uint64_t timestamp = 160000000;
+    uint64_t tenDaysMs = 10ULL * 24 * 60 * 60 * 1000;
+    uint64_t thirtyDaysMs = 3 * tenDaysMs;
+    engine.addNewSignal( s1.signalID, timestamp, 1.0, 100 );
+    engine.addNewSignal( s1.signalID, timestamp + tenDaysMs, 2.0 );
+    engine.addNewSignal( s1.signalID, timestamp + thirtyDaysMs, 3.0, 200 );
+    engine.addNewSignal( s1.signalID, timestamp + thirtyDaysMs - 5, 4.0 );
+    engine.evaluateConditions( timestamp + thirtyDaysMs );
+
+    uint32_t waitTimeMs = 0;
+    auto collectedData = engine.collectNextDataToSend( timestamp + thirtyDaysMs, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+    ASSERT_EQ( collectedData->signals.size(), 4 );
+    EXPECT_EQ( collectedData->signals[0].receiveTime, timestamp + thirtyDaysMs - 5 );
+    EXPECT_EQ( collectedData->signals[0].value, 4.0 );
+    EXPECT_EQ( collectedData->signals[1].receiveTime, timestamp + thirtyDaysMs );
+    EXPECT_EQ( collectedData->signals[1].receiveTimeFractionUs, 200 );
+    EXPECT_EQ( collectedData->signals[2].receiveTime, timestamp + tenDaysMs );
+    // Older samples that are too far away from the new epoch are clamped
+    EXPECT_LT( collectedData->signals[3].receiveTime, collectedData->signals[2].receiveTime );
+    EXPECT_EQ( collectedData->signals[3].value, 1.0 );
+    EXPECT_EQ( collectedData->signals[3].receiveTimeFractionUs, 100 );
+}
+
+TEST_F( CollectionInspectionEngineTest, SubsamplingWithMicrosecondTimestamps )
+{
+    CollectionInspectionEngine engine;
+    InspectionMatrixSignalCollectionInfo s1{};
+    s1.signalID = 1234;
+    s1.sampleBufferSize = 50;
+    s1.minimumSampleIntervalMs = 3;
+    s1.fixedWindowPeriod = 77777;
+    addSignalToCollect( collectionSchemes->conditions[0], s1 );
+    collectionSchemes->conditions[0].condition = getAlwaysTrueCondition().get();
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+
+    uint64_t timestamp = 160000000;
+    engine.addNewSignal( s1.signalID, timestamp, 0.1, 0 );
+    // 2.900 ms later, dropped although the millisecond difference would be 2
+    engine.addNewSignal( s1.signalID, timestamp + 2, 0.2, 900 );
+    // exactly 3 ms later
+    engine.addNewSignal( s1.signalID, timestamp + 3, 0.3, 0 );
+    // 5.999 ms after the first sample, only 2.999 ms after the last
+    engine.addNewSignal( s1.signalID, timestamp + 5, 0.4, 999 );
+    engine.addNewSignal( s1.signalID, timestamp + 6, 0.5, 500 );
+
+    engine.evaluateConditions( timestamp + 10 );
+
+    uint32_t waitTimeMs = 0;
+    auto collectedData = engine.collectNextDataToSend( timestamp + 10, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+    ASSERT_EQ( collectedData->signals.size(), 3 );
+    // Newest sample first
+    EXPECT_EQ( collectedData->signals[0].value, 0.5 );
+    EXPECT_EQ( collectedData->signals[0].receiveTime, timestamp + 6 );
+    EXPECT_EQ( collectedData->signals[0].receiveTimeFractionUs, 500 );
+    EXPECT_EQ( collectedData->signals[1].value, 0.3 );
+    EXPECT_EQ( collectedData->signals[1].receiveTimeFractionUs, 0 );
+    EXPECT_EQ( collectedData->signals[2].value, 0.1 );
+}
+
+TEST_F( CollectionInspectionEngineTest, SubsampledBufferIsViewOfFullRateBuffer )
+{
+    CollectionInspectionEngine engine( false );
+    InspectionMatrixSignalCollectionInfo s1{};
+    s1.signalID = 1234;
+    s1.sampleBufferSize = 10;
+    s1.minimumSampleIntervalMs = 0;
+    addSignalToCollect( collectionSchemes->conditions[0], s1 );
+    // Every second sample, over a longer time than the full rate buffer keeps
+    InspectionMatrixSignalCollectionInfo s2{};
+    s2.signalID = s1.signalID;
+    s2.sampleBufferSize = 6;
+    s2.minimumSampleIntervalMs = 20;
+    addSignalToCollect( collectionSchemes->conditions[1], s2 );
+    collectionSchemes->conditions[1].condition = getAlwaysTrueCondition().get();
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+
+    uint64_t timestamp = 160000000;
+    uint32_t waitTimeMs = 0;
+    for ( uint32_t i = 0; i < 6; i++ )
+    {
+        engine.addNewSignal( s1.signalID, timestamp + ( i * 10 ), i );
+    }
+    engine.evaluateConditions( timestamp + 60 );
+    auto collectedData = engine.collectNextDataToSend( timestamp + 60, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+    ASSERT_EQ( collectedData->signals.size(), 3 );
+    EXPECT_EQ( collectedData->signals[0].value, 4.0 );
+    EXPECT_EQ( collectedData->signals[0].receiveTime, timestamp + 40 );
+    EXPECT_EQ( collectedData->signals[1].value, 2.0 );
+    EXPECT_EQ( collectedData->signals[2].value, 0.0 );
+
+    // The view is taken over together with the full rate buffer
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+    engine.evaluateConditions( timestamp + 70 );
+    collectedData = engine.collectNextDataToSend( timestamp + 70, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+    ASSERT_EQ( collectedData->signals.size(), 3 );
+    EXPECT_EQ( collectedData->signals[0].value, 4.0 );
+    EXPECT_EQ( collectedData->signals[2].value, 0.0 );
+
+    // The full rate buffer overwrites the oldest sample of the view, which keeps its samples in chunks from then on
+    for ( uint32_t i = 6; i < 20; i++ )
+    {
+        engine.addNewSignal( s1.signalID, timestamp + ( i * 10 ), i );
+        if ( i == 11 )
+        {
+            engine.evaluateConditions( timestamp + ( i * 10 ) );
+            collectedData = engine.collectNextDataToSend( timestamp + ( i * 10 ), waitTimeMs );
+            ASSERT_NE( collectedData, nullptr );
+            ASSERT_EQ( collectedData->signals.size(), 6 );
+            EXPECT_EQ( collectedData->signals[0].value, 10.0 );
+            EXPECT_EQ( collectedData->signals[5].value, 0.0 );
+            EXPECT_EQ( collectedData->signals[5].receiveTime, timestamp );
+        }
+    }
+    engine.evaluateConditions( timestamp + 200 );
+    collectedData = engine.collectNextDataToSend( timestamp + 200, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+    ASSERT_EQ( collectedData->signals.size(), 6 );
+    EXPECT_EQ( collectedData->signals[0].value, 18.0 );
+    EXPECT_EQ( collectedData->signals[0].receiveTime, timestamp + 180 );
+    EXPECT_EQ( collectedData->signals[5].value, 8.0 );
+}
+
 TEST_F( CollectionInspectionEngineTest, TooBigForSignalBuffer )
 {
     CollectionInspectionEngine engine;
@@ -365,7 +547,7 @@ TEST_F( CollectionInspectionEngineTest, TooBigForSignalBuffer )
     InspectionMatrixSignalCollectionInfo s1{};
     s1.signalID = 3072;
     s1.sampleBufferSize =
-        500000000; // this number of samples should exceed the maximum buffer size defined in MAX_SAMPLE_MEMORY
+        500000000; // this number of samples should exceed DEFAULT_SAMPLE_MEMORY_BUDGET, so the buffer is shrunk
     s1.minimumSampleIntervalMs = 5;
     s1.fixedWindowPeriod = 77777;
     addSignalToCollect( collectionSchemes->conditions[0], s1 );
@@ -382,7 +564,10 @@ TEST_F( CollectionInspectionEngineTest, TooBigForSignalBuffer )
     uint32_t waitTimeMs = 0;
     auto collectedData = engine.collectNextDataToSend( timestamp + 5000, waitTimeMs );
     ASSERT_NE( collectedData, nullptr );
-    ASSERT_EQ( collectedData->signals.size(), 0 );
+    ASSERT_EQ( collectedData->signals.size(), 3 );
+    auto &usage = engine.getSampleMemoryUsage();
+    EXPECT_EQ( usage.shrunkBuffers, 1 );
+    EXPECT_LE( usage.usedBytes, size_t{ CollectionInspectionEngine::DEFAULT_SAMPLE_MEMORY_BUDGET } );
 }
 
 TEST_F( CollectionInspectionEngineTest, TooBigForSignalBufferOverflow )
@@ -417,10 +602,262 @@ TEST_F( CollectionInspectionEngineTest, TooBigForSignalBufferOverflow )
     uint32_t waitTimeMs = 0;
     auto collectedData = engine.collectNextDataToSend( timestamp + 4000, waitTimeMs );
     ASSERT_NE( collectedData, nullptr );
-    ASSERT_EQ( collectedData->signals.size(), 0 );
+    // Signal and CAN frame buffer are shrunk to share the budget
+    ASSERT_EQ( collectedData->signals.size(), 3 );
+    auto &usage = engine.getSampleMemoryUsage();
+    EXPECT_EQ( usage.shrunkBuffers, 2 );
+    EXPECT_LE( usage.usedBytes, size_t{ CollectionInspectionEngine::DEFAULT_SAMPLE_MEMORY_BUDGET } );
+}
+
+TEST_F( CollectionInspectionEngineTest, SampleMemoryBudgetShrinksLowPriorityFirst )
+{
+    CollectionInspectionEngine engine;
+    InspectionMatrixSignalCollectionInfo s1{};
+    s1.signalID = 1234;
+    s1.sampleBufferSize = 1000;
+    s1.minimumSampleIntervalMs = 0;
+    s1.fixedWindowPeriod = 77777;
+    addSignalToCollect( collectionSchemes->conditions[0], s1 );
+    collectionSchemes->conditions[0].metaData.collectionSchemeID = "important";
+    collectionSchemes->conditions[0].metaData.priority = 0;
+    collectionSchemes->conditions[0].condition = getAlwaysTrueCondition().get();
+    InspectionMatrixSignalCollectionInfo s2 = s1;
+    s2.signalID = 5678;
+    addSignalToCollect( collectionSchemes->conditions[1], s2 );
+    collectionSchemes->conditions[1].metaData.collectionSchemeID = "unimportant";
+    collectionSchemes->conditions[1].metaData.priority = 5;
+    collectionSchemes->conditions[1].condition = getAlwaysTrueCondition().get();
+
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+    auto &usage = engine.getSampleMemoryUsage();
+    EXPECT_EQ( usage.shrunkBuffers, 0 );
+    auto bytesPerSample = usage.usedBytes / 2000;
+    ASSERT_GT( bytesPerSample, 0 );
+
+    // Room for the full important buffer and 100 samples of the other one
+    engine.setSampleMemoryBudget( 1100 * bytesPerSample );
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+
+    EXPECT_EQ( usage.shrunkBuffers, 1 );
+    EXPECT_LE( usage.usedBytes, usage.budgetBytes );
+    EXPECT_EQ( usage.bytesPerCampaign.at( "important" ), 1000 * bytesPerSample );
+    auto unimportantSamples = usage.bytesPerCampaign.at( "unimportant" ) / bytesPerSample;
+    EXPECT_GE( unimportantSamples, 99 );
+    EXPECT_LE( unimportantSamples, 100 );
+    EXPECT_EQ( usage.bytesPerSignal.at( 5678 ), usage.bytesPerCampaign.at( "unimportant" ) );
+    EXPECT_EQ( TraceModule::get().getNamedVariable( "sampleMemoryUsed" ), static_cast<int64_t>( usage.usedBytes ) );
+    EXPECT_EQ( TraceModule::get().getNamedVariable( "sampleMemoryCampaign_important" ),
+               static_cast<int64_t>( usage.bytesPerCampaign.at( "important" ) ) );
+
+    uint64_t timestamp = 160000000;
+    for ( uint32_t i = 0; i < 200; i++ )
+    {
+        engine.addNewSignal( s1.signalID, timestamp + i, i );
+        engine.addNewSignal( s2.signalID, timestamp + i, i );
+    }
+    engine.evaluateConditions( timestamp + 200 );
+
+    uint32_t waitTimeMs = 0;
+    auto collectedData = engine.collectNextDataToSend( timestamp + 200, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+    EXPECT_EQ( collectedData->signals.size(), 200 );
+    collectedData = engine.collectNextDataToSend( timestamp + 200, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+    EXPECT_EQ( collectedData->signals.size(), unimportantSamples );
+}
+
+TEST_F( CollectionInspectionEngineTest, DeepHistoryCollectedFromMemoryAndFile )
+{
+    CollectionInspectionEngine engine( true );
+    InspectionMatrixSignalCollectionInfo s1{};
+    s1.signalID = 1234;
+    s1.sampleBufferSize = 3000;
+    s1.minimumSampleIntervalMs = 0;
+    s1.fixedWindowPeriod = 77777;
+    s1.deepHistory = true;
+    addSignalToCollect( collectionSchemes->conditions[0], s1 );
+    collectionSchemes->conditions[0].condition = getAlwaysTrueCondition().get();
+    collectionSchemes->conditions[0].minimumPublishInterval = 0;
+    // Without a directory all samples are kept in memory
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+    auto &usage = engine.getSampleMemoryUsage();
+    auto bytesPerSample = usage.usedBytes / 3000;
+    ASSERT_GT( bytesPerSample, 0 );
+
+    // Only the newest samples count into the memory budget
+    engine.setDeepHistoryDirectory( "/tmp" );
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+    EXPECT_EQ( usage.usedBytes, CollectionInspectionEngine::DEEP_HISTORY_MEMORY_SAMPLES * bytesPerSample );
+
+    uint64_t timestamp = 160000000;
+    for ( uint32_t i = 0; i < 3500; i++ )
+    {
+        engine.addNewSignal( s1.signalID, timestamp + i, i );
+    }
+    engine.evaluateConditions( timestamp + 3500 );
+    uint32_t waitTimeMs = 0;
+    auto collectedData = engine.collectNextDataToSend( timestamp + 3500, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+    ASSERT_EQ( collectedData->signals.size(), 3000 );
+    for ( uint32_t i = 0; i < 3000; i++ )
+    {
+        ASSERT_EQ( collectedData->signals[i].receiveTime, timestamp + 3499 - i );
+        ASSERT_DOUBLE_EQ( collectedData->signals[i].value, 3499 - i );
+    }
+
+    // Samples collected already are not sent again, also not from the file
+    for ( uint32_t i = 3500; i < 5000; i++ )
+    {
+        engine.addNewSignal( s1.signalID, timestamp + i, i );
+    }
+    engine.evaluateConditions( timestamp + 5000 );
+    collectedData = engine.collectNextDataToSend( timestamp + 5000, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+    ASSERT_EQ( collectedData->signals.size(), 1500 );
+    EXPECT_DOUBLE_EQ( collectedData->signals.back().value, 3500 );
+}
+
+TEST_F( CollectionInspectionEngineTest, DeepHistoryCollectedFromMemoryAndCompressedHistory )
+{
+    CollectionInspectionEngine engine( true );
+    InspectionMatrixSignalCollectionInfo s1{};
+    s1.signalID = 1234;
+    s1.sampleBufferSize = 3000;
+    s1.minimumSampleIntervalMs = 0;
+    s1.fixedWindowPeriod = 77777;
+    s1.deepHistory = true;
+    addSignalToCollect( collectionSchemes->conditions[0], s1 );
+    collectionSchemes->conditions[0].condition = getAlwaysTrueCondition().get();
+    collectionSchemes->conditions[0].minimumPublishInterval = 0;
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+    auto &usage = engine.getSampleMemoryUsage();
+    auto bytesPerSample = usage.usedBytes / 3000;
+
+    // Only the newest samples count into the memory budget, the older ones are compressed
+    engine.setDeepHistoryCompressionEnabled( true );
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+    EXPECT_EQ( usage.usedBytes, CollectionInspectionEngine::DEEP_HISTORY_MEMORY_SAMPLES * bytesPerSample );
+
+    uint64_t timestamp = 160000000;
+    for ( uint32_t i = 0; i < 3500; i++ )
+    {
+        engine.addNewSignal( s1.signalID, timestamp + i, i * 0.25 );
+    }
+    engine.evaluateConditions( timestamp + 3500 );
+    uint32_t waitTimeMs = 0;
+    auto collectedData = engine.collectNextDataToSend( timestamp + 3500, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+    ASSERT_EQ( collectedData->signals.size(), 3000 );
+    for ( uint32_t i = 0; i < 3000; i++ )
+    {
+        ASSERT_EQ( collectedData->signals[i].receiveTime, timestamp + 3499 - i );
+        ASSERT_DOUBLE_EQ( collectedData->signals[i].value, ( 3499 - i ) * 0.25 );
+    }
+
+    // Samples collected already are not sent again, also not from the compressed history
+    for ( uint32_t i = 3500; i < 5000; i++ )
+    {
+        engine.addNewSignal( s1.signalID, timestamp + i, i * 0.25 );
+    }
+    engine.evaluateConditions( timestamp + 5000 );
+    collectedData = engine.collectNextDataToSend( timestamp + 5000, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+    ASSERT_EQ( collectedData->signals.size(), 1500 );
+    EXPECT_DOUBLE_EQ( collectedData->signals.back().value, 3500 * 0.25 );
+}
+
+TEST_F( CollectionInspectionEngineTest, StateRestoredAfterRestart )
+{
+    InspectionMatrixSignalCollectionInfo s1{};
+    s1.signalID = 1234;
+    s1.sampleBufferSize = 10;
+    s1.minimumSampleIntervalMs = 0;
+    s1.fixedWindowPeriod = 0;
+    addSignalToCollect( collectionSchemes->conditions[0], s1 );
+    InspectionMatrixCanFrameCollectionInfo c1{};
+    c1.frameID = 0x380;
+    c1.channelID = 3;
+    c1.sampleBufferSize = 10;
+    c1.minimumSampleIntervalMs = 0;
+    collectionSchemes->conditions[0].canFrames.push_back( c1 );
+    collectionSchemes->conditions[0].condition = getAlwaysTrueCondition().get();
+    collectionSchemes->conditions[0].minimumPublishInterval = 10000;
+    const std::string path = "/tmp/fwe-inspection-state-test";
+
+    uint64_t timestamp = 160000000;
+    uint32_t waitTimeMs = 0;
+    {
+        CollectionInspectionEngine engine( true );
+        engine.onChangeInspectionMatrix( consCollectionSchemes );
+        for ( uint32_t i = 0; i < 3; i++ )
+        {
+            engine.addNewSignal( s1.signalID, timestamp + i, i );
+        }
+        engine.evaluateConditions( timestamp + 2 );
+        auto collectedData = engine.collectNextDataToSend( timestamp + 2, waitTimeMs );
+        ASSERT_NE( collectedData, nullptr );
+        ASSERT_EQ( collectedData->signals.size(), 3 );
+        engine.addNewSignal( s1.signalID, timestamp + 3, 3 );
+        engine.addNewSignal( s1.signalID, timestamp + 4, 4 );
+        std::array<uint8_t, MAX_CAN_FRAME_BYTE_SIZE> buf = { 0xDE, 0xAD, 0xBE, 0xEF, 0x0, 0x0, 0x0, 0x0 };
+        engine.addNewRawCanFrame( c1.frameID, c1.channelID, timestamp + 4, buf, sizeof( buf ) );
+        ASSERT_TRUE( engine.saveState( path ) );
+    }
+
+    CollectionInspectionEngine engine( true );
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+    ASSERT_TRUE( engine.restoreState( path ) );
+    // The last trigger is kept, so the minimum publish interval did not pass yet
+    engine.evaluateConditions( timestamp + 100 );
+    ASSERT_EQ( engine.collectNextDataToSend( timestamp + 100, waitTimeMs ), nullptr );
+    // Only the samples that were not sent before the restart are sent
+    engine.evaluateConditions( timestamp + 10002 );
+    auto collectedData = engine.collectNextDataToSend( timestamp + 10002, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+    ASSERT_EQ( collectedData->signals.size(), 2 );
+    EXPECT_DOUBLE_EQ( collectedData->signals[0].value, 4 );
+    EXPECT_EQ( collectedData->signals[1].receiveTime, timestamp + 3 );
+    ASSERT_EQ( collectedData->canFrames.size(), 1 );
+    EXPECT_EQ( collectedData->canFrames[0].data[1], 0xAD );
+
+    // A corrupt count is rejected before anything is allocated for it
+    std::vector<uint8_t> content( 1 << 16 );
+    auto *file = fopen( path.c_str(), "rb" );
+    ASSERT_NE( file, nullptr );
+    content.resize( fread( content.data(), 1, content.size(), file ) );
+    fclose( file );
+    CollectionInspectionEngine corruptEngine( true );
+    corruptEngine.onChangeInspectionMatrix( consCollectionSchemes );
+    const std::string corruptPath = path + "-corrupt";
+    for ( size_t offset = 0; ( offset + sizeof( uint32_t ) ) <= content.size(); offset += sizeof( uint32_t ) )
+    {
+        auto corrupt = content;
+        std::memset( corrupt.data() + offset, 0xFF, sizeof( uint32_t ) );
+        file = fopen( corruptPath.c_str(), "wb" );
+        ASSERT_NE( file, nullptr );
+        ASSERT_EQ( fwrite( corrupt.data(), 1, corrupt.size(), file ), corrupt.size() );
+        fclose( file );
+        EXPECT_NO_THROW( corruptEngine.restoreState( corruptPath ) ) << offset;
+    }
+    unlink( corruptPath.c_str() );
+
+    // A file that is cut off is not applied
+    CollectionInspectionEngine truncatedEngine( true );
+    truncatedEngine.onChangeInspectionMatrix( consCollectionSchemes );
+    ASSERT_EQ( truncate( path.c_str(), 40 ), 0 );
+    EXPECT_FALSE( truncatedEngine.restoreState( path ) );
+
+    // Neither is the state of a different inspection matrix
+    ASSERT_TRUE( engine.saveState( path ) );
+    collectionSchemes->conditions[0].signals[0].sampleBufferSize = 20;
+    CollectionInspectionEngine changedEngine( true );
+    changedEngine.onChangeInspectionMatrix( consCollectionSchemes );
+    EXPECT_FALSE( changedEngine.restoreState( path ) );
+    EXPECT_FALSE( changedEngine.restoreState( path + "-missing" ) );
+    unlink( path.c_str() );
 }
 
-TEST_F( CollectionInspectionEngineTest, SignalBufferErasedAfterNewConditions )
+TEST_F( CollectionInspectionEngineTest, SignalBufferKeptAfterNewConditions )
 {
     CollectionInspectionEngine engine;
     // minimumSampleIntervalMs=0 means no subsampling
@@ -439,8 +876,7 @@ TEST_F( CollectionInspectionEngineTest, SignalBufferErasedAfterNewConditions )
     engine.addNewSignal( s1.signalID, timestamp + 1, 0.2 );
     engine.addNewSignal( s1.signalID, timestamp + 2, 0.3 );
 
-    // This call will flush the signal history buffer even when
-    // exactly the same conditions are handed over.
+    // The signal is still collected with the same sample interval so the history is kept
     engine.onChangeInspectionMatrix( consCollectionSchemes );
 
     engine.addNewSignal( s1.signalID, timestamp + 3, 0.4 );
@@ -450,9 +886,97 @@ TEST_F( CollectionInspectionEngineTest, SignalBufferErasedAfterNewConditions )
     uint32_t waitTimeMs = 0;
     auto collectedData = engine.collectNextDataToSend( timestamp + 3, waitTimeMs );
     ASSERT_NE( collectedData, nullptr );
-    ASSERT_EQ( collectedData->signals.size(), 1 );
+    ASSERT_EQ( collectedData->signals.size(), 4 );
 
     EXPECT_EQ( collectedData->signals[0].value, 0.4 );
+    EXPECT_EQ( collectedData->signals[3].value, 0.1 );
+}
+
+TEST_F( CollectionInspectionEngineTest, HistoryTakenOverWhenConditionAdded )
+{
+    CollectionInspectionEngine engine;
+    InspectionMatrixSignalCollectionInfo s1{};
+    s1.signalID = 1234;
+    s1.sampleBufferSize = 3;
+    s1.minimumSampleIntervalMs = 0;
+    InspectionMatrixSignalCollectionInfo s2{};
+    s2.signalID = 5678;
+    s2.sampleBufferSize = 10;
+    s2.minimumSampleIntervalMs = 0;
+    InspectionMatrixCanFrameCollectionInfo c1{};
+    c1.frameID = 0x380;
+    c1.channelID = 3;
+    c1.sampleBufferSize = 2;
+    c1.minimumSampleIntervalMs = 0;
+    addSignalToCollect( collectionSchemes->conditions[0], s1 );
+    collectionSchemes->conditions[0].canFrames.push_back( c1 );
+    collectionSchemes->conditions[0].condition = getAlwaysTrueCondition().get();
+    collectionSchemes->conditions[0].metaData.collectionSchemeID = "scheme0";
+    // The second condition is removed by the next matrix, its signal buffer is freed
+    addSignalToCollect( collectionSchemes->conditions[1], s2 );
+    collectionSchemes->conditions[1].metaData.collectionSchemeID = "scheme1";
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+
+    uint64_t timestamp = 160000000;
+    uint32_t waitTimeMs = 0;
+    std::array<uint8_t, 8> frame = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    for ( uint32_t i = 0; i < 5; i++ )
+    {
+        engine.addNewSignal( s1.signalID, timestamp + i, i );
+        engine.addNewSignal( s2.signalID, timestamp + i, i );
+        frame[0] = static_cast<uint8_t>( i );
+        engine.addNewRawCanFrame(
+            c1.frameID, c1.channelID, timestamp + i, frame.data(), static_cast<uint8_t>( frame.size() ) );
+    }
+    engine.evaluateConditions( timestamp + 5 );
+    auto collectedData = engine.collectNextDataToSend( timestamp + 5, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+    ASSERT_EQ( collectedData->signals.size(), 3 );
+    ASSERT_EQ( collectedData->canFrames.size(), 2 );
+
+    // A new scheme before the existing one needs a bigger buffer for the same signal
+    auto newCollectionSchemes = std::make_shared<InspectionMatrix>();
+    newCollectionSchemes->conditions.resize( 2 );
+    auto &newCondition = newCollectionSchemes->conditions[0];
+    s1.sampleBufferSize = 10;
+    addSignalToCollect( newCondition, s1 );
+    // Another sample interval of the same signal is a new buffer without history
+    s2.minimumSampleIntervalMs = 1;
+    addSignalToCollect( newCondition, s2 );
+    c1.sampleBufferSize = 10;
+    newCondition.canFrames.push_back( c1 );
+    newCondition.condition = getAlwaysTrueCondition().get();
+    newCondition.probabilityToSend = 1.0;
+    newCondition.metaData.collectionSchemeID = "scheme2";
+    newCollectionSchemes->conditions[1] = collectionSchemes->conditions[0];
+    engine.onChangeInspectionMatrix( newCollectionSchemes );
+
+    engine.addNewSignal( s1.signalID, timestamp + 10, 10 );
+    engine.addNewSignal( s2.signalID, timestamp + 10, 10 );
+    engine.evaluateConditions( timestamp + 10 );
+    // The new condition also gets the samples from before it was added, as far as they were kept
+    collectedData = engine.collectNextDataToSend( timestamp + 10, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+    EXPECT_EQ( collectedData->metaData.collectionSchemeID, "scheme2" );
+    std::vector<double> s1Values;
+    std::vector<double> s2Values;
+    for ( const auto &signal : collectedData->signals )
+    {
+        ( signal.signalID == s1.signalID ? s1Values : s2Values ).push_back( signal.value );
+    }
+    EXPECT_EQ( s1Values, std::vector<double>( { 10, 4, 3, 2 } ) );
+    EXPECT_EQ( s2Values, std::vector<double>( { 10 } ) );
+    ASSERT_EQ( collectedData->canFrames.size(), 2 );
+    EXPECT_EQ( collectedData->canFrames[0].data[0], 4 );
+    EXPECT_EQ( collectedData->canFrames[1].data[0], 3 );
+
+    // The existing condition keeps what it already consumed
+    collectedData = engine.collectNextDataToSend( timestamp + 10, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+    EXPECT_EQ( collectedData->metaData.collectionSchemeID, "scheme0" );
+    ASSERT_EQ( collectedData->signals.size(), 1 );
+    EXPECT_EQ( collectedData->signals[0].value, 10 );
+    EXPECT_EQ( collectedData->canFrames.size(), 0 );
 }
 
 TEST_F( CollectionInspectionEngineTest, CollectBurstWithoutSubsampling )
@@ -535,37 +1059,138 @@ TEST_F( CollectionInspectionEngineTest, ZeroSignalsOnlyDTCCollection )
     EXPECT_EQ( collectedData->mDTCInfo.mDTCCodes[0], "B1217" );
 }
 
-TEST_F( CollectionInspectionEngineTest, CollectRawCanFrames )
+TEST_F( CollectionInspectionEngineTest, DTCDeltasAndUnchangedDTCReference )
 {
     CollectionInspectionEngine engine;
-    // minimumSampleIntervalMs=0 means no subsampling
-    InspectionMatrixCanFrameCollectionInfo c1;
-    c1.frameID = 0x380;
-    c1.channelID = 3;
-    c1.sampleBufferSize = 10;
-    c1.minimumSampleIntervalMs = 0;
-    collectionSchemes->conditions[0].canFrames.push_back( c1 );
-
+    collectionSchemes->conditions[0].includeActiveDtcs = true;
     collectionSchemes->conditions[0].condition = getAlwaysTrueCondition().get();
     engine.onChangeInspectionMatrix( consCollectionSchemes );
 
     uint64_t timestamp = 160000000;
-    std::array<uint8_t, MAX_CAN_FRAME_BYTE_SIZE> buf = { 0xDE, 0xAD, 0xBE, 0xEF, 0x0, 0x0, 0x0, 0x0 };
-    engine.addNewRawCanFrame( c1.frameID, c1.channelID, timestamp, buf, sizeof( buf ) );
-
+    DTCInfo dtcInfo;
+    dtcInfo.mDTCCodes = { "B1217", "P0143" };
+    dtcInfo.mSID = SID::STORED_DTC;
+    dtcInfo.receiveTime = timestamp;
+    dtcInfo.mSequenceNumber = 1;
+    engine.setActiveDTCs( dtcInfo );
+    timestamp += 1000;
     engine.evaluateConditions( timestamp );
-
     uint32_t waitTimeMs = 0;
     auto collectedData = engine.collectNextDataToSend( timestamp, waitTimeMs );
     ASSERT_NE( collectedData, nullptr );
-    ASSERT_EQ( collectedData->canFrames.size(), 1 );
+    ASSERT_EQ( collectedData->mDTCInfo.mDTCCodes, dtcInfo.mDTCCodes );
+    ASSERT_EQ( collectedData->mDTCInfo.mSequenceNumber, 1 );
+    ASSERT_FALSE( collectedData->mDTCInfo.mIsUnchanged );
 
-    EXPECT_EQ( collectedData->canFrames[0].frameID, c1.frameID );
+    // The same set is only referenced by the next trigger
+    timestamp += 1000;
+    engine.evaluateConditions( timestamp );
+    collectedData = engine.collectNextDataToSend( timestamp, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+    ASSERT_TRUE( collectedData->mDTCInfo.hasItems() );
+    ASSERT_TRUE( collectedData->mDTCInfo.mDTCCodes.empty() );
+    ASSERT_EQ( collectedData->mDTCInfo.mSequenceNumber, 1 );
+    ASSERT_TRUE( collectedData->mDTCInfo.mIsUnchanged );
+
+    // A delta is applied to the current set
+    DTCInfo delta;
+    delta.mSID = SID::STORED_DTC;
+    delta.receiveTime = timestamp;
+    delta.mSequenceNumber = 2;
+    delta.mIsDelta = true;
+    delta.mDTCCodes = { "U0148" };
+    delta.mRemovedDTCCodes = { "B1217" };
+    engine.setActiveDTCs( delta );
+    timestamp += 1000;
+    engine.evaluateConditions( timestamp );
+    collectedData = engine.collectNextDataToSend( timestamp, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+    ASSERT_EQ( collectedData->mDTCInfo.mDTCCodes, std::vector<std::string>( { "P0143", "U0148" } ) );
+    ASSERT_EQ( collectedData->mDTCInfo.mSequenceNumber, 2 );
+    ASSERT_FALSE( collectedData->mDTCInfo.mIsUnchanged );
+
+    // A delta that does not follow the current set is ignored
+    delta.mSequenceNumber = 4;
+    delta.mDTCCodes = { "C0196" };
+    delta.mRemovedDTCCodes.clear();
+    engine.setActiveDTCs( delta );
+    timestamp += 1000;
+    engine.evaluateConditions( timestamp );
+    collectedData = engine.collectNextDataToSend( timestamp, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+    ASSERT_EQ( collectedData->mDTCInfo.mSequenceNumber, 2 );
+    ASSERT_TRUE( collectedData->mDTCInfo.mIsUnchanged );
+}
+
+TEST_F( CollectionInspectionEngineTest, CollectRawCanFrames )
+{
+    CollectionInspectionEngine engine;
+    // minimumSampleIntervalMs=0 means no subsampling
+    InspectionMatrixCanFrameCollectionInfo c1;
+    c1.frameID = 0x380;
+    c1.channelID = 3;
+    c1.sampleBufferSize = 10;
+    c1.minimumSampleIntervalMs = 0;
+    collectionSchemes->conditions[0].canFrames.push_back( c1 );
+
+    collectionSchemes->conditions[0].condition = getAlwaysTrueCondition().get();
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+
+    uint64_t timestamp = 160000000;
+    std::array<uint8_t, MAX_CAN_FRAME_BYTE_SIZE> buf = { 0xDE, 0xAD, 0xBE, 0xEF, 0x0, 0x0, 0x0, 0x0 };
+    engine.addNewRawCanFrame( c1.frameID, c1.channelID, timestamp, buf, sizeof( buf ) );
+
+    engine.evaluateConditions( timestamp );
+
+    uint32_t waitTimeMs = 0;
+    auto collectedData = engine.collectNextDataToSend( timestamp, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+    ASSERT_EQ( collectedData->canFrames.size(), 1 );
+
+    EXPECT_EQ( collectedData->canFrames[0].frameID, c1.frameID );
     EXPECT_EQ( collectedData->canFrames[0].channelId, c1.channelID );
     EXPECT_EQ( collectedData->canFrames[0].size, sizeof( buf ) );
     EXPECT_TRUE( 0 == std::memcmp( collectedData->canFrames[0].data.data(), buf.data(), sizeof( buf ) ) );
 }
 
+TEST_F( CollectionInspectionEngineTest, CollectRawCanFdFrames )
+{
+    CollectionInspectionEngine engine;
+    InspectionMatrixCanFrameCollectionInfo c1;
+    c1.frameID = 0x380;
+    c1.channelID = 3;
+    c1.sampleBufferSize = 10;
+    c1.minimumSampleIntervalMs = 0;
+    collectionSchemes->conditions[0].canFrames.push_back( c1 );
+
+    collectionSchemes->conditions[0].condition = getAlwaysTrueCondition().get();
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+
+    uint64_t timestamp = 160000000;
+    // A classic frame first, then a CAN FD frame that widens the payload slots of the ring buffer
+    std::array<uint8_t, MAX_CAN_FRAME_BYTE_SIZE> classicBuf = { 0xDE, 0xAD, 0xBE, 0xEF, 0x1, 0x2, 0x3, 0x4 };
+    engine.addNewRawCanFrame( c1.frameID, c1.channelID, timestamp, classicBuf, sizeof( classicBuf ) );
+    std::array<uint8_t, MAX_CANFD_FRAME_BYTE_SIZE> fdBuf{};
+    for ( size_t i = 0; i < fdBuf.size(); i++ )
+    {
+        fdBuf[i] = static_cast<uint8_t>( i );
+    }
+    engine.addNewRawCanFrame( c1.frameID, c1.channelID, timestamp + 1, fdBuf, sizeof( fdBuf ) );
+
+    engine.evaluateConditions( timestamp + 1 );
+
+    uint32_t waitTimeMs = 0;
+    auto collectedData = engine.collectNextDataToSend( timestamp + 1, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+    ASSERT_EQ( collectedData->canFrames.size(), 2 );
+
+    EXPECT_EQ( collectedData->canFrames[0].size, sizeof( fdBuf ) );
+    EXPECT_TRUE( 0 == std::memcmp( collectedData->canFrames[0].data.data(), fdBuf.data(), sizeof( fdBuf ) ) );
+    EXPECT_EQ( collectedData->canFrames[1].size, sizeof( classicBuf ) );
+    EXPECT_TRUE(
+        0 == std::memcmp( collectedData->canFrames[1].data.data(), classicBuf.data(), sizeof( classicBuf ) ) );
+}
+
 TEST_F( CollectionInspectionEngineTest, MultipleCanSubsampling )
 {
     CollectionInspectionEngine engine;
@@ -611,6 +1236,42 @@ TEST_F( CollectionInspectionEngineTest, MultipleCanSubsampling )
     ASSERT_EQ( collectedData->canFrames.size(), 8 );
 }
 
+TEST_F( CollectionInspectionEngineTest, SameCanFrameIDOnDifferentChannels )
+{
+    CollectionInspectionEngine engine;
+    InspectionMatrixCanFrameCollectionInfo c1;
+    c1.frameID = 0x380;
+    c1.channelID = 3;
+    c1.sampleBufferSize = 10;
+    c1.minimumSampleIntervalMs = 0;
+    collectionSchemes->conditions[0].canFrames.push_back( c1 );
+    InspectionMatrixCanFrameCollectionInfo c2 = c1;
+    c2.channelID = 4;
+    collectionSchemes->conditions[0].canFrames.push_back( c2 );
+    collectionSchemes->conditions[0].condition = getAlwaysTrueCondition().get();
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+
+    uint64_t timestamp = 160000000;
+    std::array<uint8_t, MAX_CAN_FRAME_BYTE_SIZE> buf = { 0xDE, 0xAD, 0xBE, 0xEF, 0x0, 0x0, 0x0, 0x0 };
+    engine.addNewRawCanFrame( c1.frameID, c1.channelID, timestamp, buf, sizeof( buf ) );
+    engine.addNewRawCanFrame( c2.frameID, c2.channelID, timestamp + 1, buf, sizeof( buf ) );
+    engine.addNewRawCanFrame( c2.frameID, c2.channelID, timestamp + 2, buf, sizeof( buf ) );
+    // Not collected
+    engine.addNewRawCanFrame( c1.frameID, 5, timestamp + 3, buf, sizeof( buf ) );
+    engine.addNewRawCanFrame( 0x381, c1.channelID, timestamp + 4, buf, sizeof( buf ) );
+
+    engine.evaluateConditions( timestamp + 5 );
+
+    uint32_t waitTimeMs = 0;
+    auto collectedData = engine.collectNextDataToSend( timestamp + 5, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+    ASSERT_EQ( collectedData->canFrames.size(), 3 );
+    EXPECT_EQ( collectedData->canFrames[0].channelId, c1.channelID );
+    EXPECT_EQ( collectedData->canFrames[1].channelId, c2.channelID );
+    EXPECT_EQ( collectedData->canFrames[1].receiveTime, timestamp + 2 );
+    EXPECT_EQ( collectedData->canFrames[2].channelId, c2.channelID );
+}
+
 TEST_F( CollectionInspectionEngineTest, MultipleSubsamplingOfSameSignalUsedInConditions )
 {
     CollectionInspectionEngine engine;
@@ -853,6 +1514,409 @@ TEST_F( CollectionInspectionEngineTest, SendoutEverySignalOnlyOnce )
     EXPECT_EQ( res3->signals.size(), 1 );
 }
 
+TEST_F( CollectionInspectionEngineTest, SignalSnapshotsReferenceSamples )
+{
+    CollectionInspectionEngine engine;
+    CollectionInspectionEngine copyingEngine;
+    engine.setSignalSnapshotsEnabled( true );
+    InspectionMatrixSignalCollectionInfo s1{};
+    s1.signalID = 1234;
+    // More than one chunk of samples
+    s1.sampleBufferSize = 100;
+    s1.minimumSampleIntervalMs = 0;
+    addSignalToCollect( collectionSchemes->conditions[0], s1 );
+    collectionSchemes->conditions[0].minimumPublishInterval = 10000;
+    collectionSchemes->conditions[0].condition = getAlwaysTrueCondition().get();
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+    copyingEngine.onChangeInspectionMatrix( consCollectionSchemes );
+
+    uint64_t timestamp = 160000000;
+    uint32_t waitTimeMs = 0;
+    for ( uint32_t i = 0; i < 70; i++ )
+    {
+        engine.addNewSignal( s1.signalID, timestamp + i, i, static_cast<TimestampFractionUs>( i ) );
+        copyingEngine.addNewSignal( s1.signalID, timestamp + i, i, static_cast<TimestampFractionUs>( i ) );
+    }
+    engine.evaluateConditions( timestamp + 70 );
+    copyingEngine.evaluateConditions( timestamp + 70 );
+    auto snapshotData = engine.collectNextDataToSend( timestamp + 70, waitTimeMs );
+    auto copiedData = copyingEngine.collectNextDataToSend( timestamp + 70, waitTimeMs );
+    ASSERT_NE( snapshotData, nullptr );
+    ASSERT_NE( copiedData, nullptr );
+    EXPECT_EQ( snapshotData->signals.size(), 0 );
+    ASSERT_EQ( snapshotData->signalSnapshots.size(), 1 );
+    const auto &snapshot = snapshotData->signalSnapshots[0];
+    ASSERT_EQ( snapshot.sampleCount, copiedData->signals.size() );
+    auto checkSnapshot = [&]() {
+        for ( uint32_t i = 0; i < snapshot.sampleCount; i++ )
+        {
+            auto sample = snapshot.getSample( i );
+            EXPECT_EQ( sample.signalID, copiedData->signals[i].signalID );
+            EXPECT_EQ( sample.receiveTime, copiedData->signals[i].receiveTime );
+            EXPECT_EQ( sample.receiveTimeFractionUs, copiedData->signals[i].receiveTimeFractionUs );
+            EXPECT_EQ( sample.value, copiedData->signals[i].value );
+        }
+    };
+    checkSnapshot();
+
+    // Overwriting all samples of the ring buffer does not change the snapshot
+    for ( uint32_t i = 70; i < 250; i++ )
+    {
+        engine.addNewSignal( s1.signalID, timestamp + i, i + 1000 );
+    }
+    checkSnapshot();
+    engine.evaluateConditions( timestamp + 10070 );
+    auto nextData = engine.collectNextDataToSend( timestamp + 10070, waitTimeMs );
+    ASSERT_NE( nextData, nullptr );
+    ASSERT_EQ( nextData->signalSnapshots.size(), 1 );
+    ASSERT_EQ( nextData->signalSnapshots[0].sampleCount, 100 );
+    EXPECT_EQ( nextData->signalSnapshots[0].getSample( 0 ).value, 1249 );
+    EXPECT_EQ( nextData->signalSnapshots[0].getSample( 99 ).value, 1150 );
+    checkSnapshot();
+}
+
+TEST_F( CollectionInspectionEngineTest, CollectedDataIsRecycled )
+{
+    CollectionInspectionEngine engine;
+    InspectionMatrixSignalCollectionInfo s1{};
+    s1.signalID = 1234;
+    s1.sampleBufferSize = 50;
+    s1.minimumSampleIntervalMs = 0;
+    addSignalToCollect( collectionSchemes->conditions[0], s1 );
+    collectionSchemes->conditions[0].minimumPublishInterval = 10;
+    collectionSchemes->conditions[0].condition = getAlwaysTrueCondition().get();
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+
+    uint64_t timestamp = 160000000;
+    uint32_t waitTimeMs = 0;
+    engine.addNewSignal( s1.signalID, timestamp, 1 );
+    engine.evaluateConditions( timestamp );
+    auto collectedData = engine.collectNextDataToSend( timestamp, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+    ASSERT_EQ( collectedData->signals.size(), 1 );
+    EXPECT_GE( collectedData->signals.capacity(), 50 );
+    auto *rawData = collectedData.get();
+    collectedData.reset();
+
+    engine.addNewSignal( s1.signalID, timestamp + 20, 2 );
+    engine.evaluateConditions( timestamp + 20 );
+    collectedData = engine.collectNextDataToSend( timestamp + 20, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+    // The data released by the sender is used again without any leftovers of the previous trigger
+    EXPECT_EQ( collectedData.get(), rawData );
+    ASSERT_EQ( collectedData->signals.size(), 1 );
+    EXPECT_EQ( collectedData->signals[0].value, 2 );
+}
+
+TEST_F( CollectionInspectionEngineTest, AggregatedSignalSendsSummariesOfCompleteWindows )
+{
+    CollectionInspectionEngine engine;
+    InspectionMatrixSignalCollectionInfo s1{};
+    s1.signalID = 1234;
+    s1.sampleBufferSize = 1;
+    s1.minimumSampleIntervalMs = 0;
+    s1.fixedWindowPeriod = 100;
+    auto aggregation = std::make_shared<SignalAggregationInfo>();
+    aggregation->count = true;
+    aggregation->min = true;
+    aggregation->max = true;
+    aggregation->mean = true;
+    aggregation->histogramBounds = { 4.5 };
+    s1.aggregation = aggregation;
+    addSignalToCollect( collectionSchemes->conditions[0], s1 );
+    collectionSchemes->conditions[0].minimumPublishInterval = 1000;
+    collectionSchemes->conditions[0].condition = getAlwaysTrueCondition().get();
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+
+    uint64_t timestamp = 160000000;
+    uint32_t waitTimeMs = 0;
+    // Ten samples in each of the first two windows
+    for ( uint32_t i = 0; i < 20; i++ )
+    {
+        engine.addNewSignal( s1.signalID, timestamp + i * 10, i % 10 );
+        engine.evaluateConditions( timestamp + i * 10 );
+        if ( i == 0 )
+        {
+            auto collectedData = engine.collectNextDataToSend( timestamp, waitTimeMs );
+            ASSERT_NE( collectedData, nullptr );
+            // No window is complete yet and the samples are not sent
+            ASSERT_TRUE( collectedData->signals.empty() );
+            ASSERT_TRUE( collectedData->signalSummaries.empty() );
+        }
+    }
+    engine.addNewSignal( s1.signalID, timestamp + 1000, 100.0 );
+    engine.evaluateConditions( timestamp + 1000 );
+    auto collectedData = engine.collectNextDataToSend( timestamp + 1000, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+    ASSERT_TRUE( collectedData->signals.empty() );
+    ASSERT_EQ( collectedData->signalSummaries.size(), 2 );
+    for ( uint32_t i = 0; i < 2; i++ )
+    {
+        const auto &summary = collectedData->signalSummaries[i];
+        ASSERT_EQ( summary.signalID, s1.signalID );
+        ASSERT_EQ( summary.windowStartTime, timestamp + i * 100 );
+        ASSERT_EQ( summary.windowSizeMs, 100 );
+        ASSERT_EQ( summary.count, 10 );
+        ASSERT_DOUBLE_EQ( summary.min, 0.0 );
+        ASSERT_DOUBLE_EQ( summary.max, 9.0 );
+        ASSERT_DOUBLE_EQ( summary.mean, 4.5 );
+        ASSERT_EQ( summary.histogramCounts, ( std::vector<uint32_t>{ 5, 5 } ) );
+        ASSERT_TRUE( summary.percentileValues.empty() );
+    }
+}
+
+TEST_F( CollectionInspectionEngineTest, DecimatedSignalKeepsPeaks )
+{
+    CollectionInspectionEngine engine;
+    // Decimated signals are copied from the buffer even if the others are only referenced
+    engine.setSignalSnapshotsEnabled( true );
+    InspectionMatrixSignalCollectionInfo s1{};
+    s1.signalID = 1234;
+    s1.sampleBufferSize = 1000;
+    s1.minimumSampleIntervalMs = 0;
+    auto decimation = std::make_shared<SignalDecimationInfo>();
+    decimation->method = SignalDecimationMethod::MIN_MAX;
+    decimation->maxSamples = 10;
+    s1.decimation = decimation;
+    InspectionMatrixSignalCollectionInfo s2{};
+    s2.signalID = 5678;
+    s2.sampleBufferSize = 10;
+    s2.minimumSampleIntervalMs = 0;
+    addSignalToCollect( collectionSchemes->conditions[0], s1 );
+    addSignalToCollect( collectionSchemes->conditions[0], s2 );
+    collectionSchemes->conditions[0].condition = getAlwaysTrueCondition().get();
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+
+    uint64_t timestamp = 160000000;
+    uint32_t waitTimeMs = 0;
+    for ( uint32_t i = 0; i < 1000; i++ )
+    {
+        engine.addNewSignal( s1.signalID, timestamp + i * 10, ( i == 123 ) ? 1000.0 : 1.0 );
+    }
+    engine.addNewSignal( s2.signalID, timestamp, 2.0 );
+    engine.evaluateConditions( timestamp + 10000 );
+    auto collectedData = engine.collectNextDataToSend( timestamp + 10000, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+    ASSERT_TRUE( collectedData->signals.size() <= 10 );
+    ASSERT_FALSE( collectedData->signals.empty() );
+    for ( uint32_t i = 0; i < collectedData->signals.size(); i++ )
+    {
+        ASSERT_EQ( collectedData->signals[i].signalID, s1.signalID );
+        if ( i > 0 )
+        {
+            ASSERT_LT( collectedData->signals[i - 1].receiveTime, collectedData->signals[i].receiveTime );
+        }
+    }
+    ASSERT_TRUE( std::any_of( collectedData->signals.begin(),
+                              collectedData->signals.end(),
+                              []( const CollectedSignal &signal ) {
+                                  return ( signal.value == 1000.0 ) && ( signal.receiveTime == 160000000 + 1230 );
+                              } ) );
+    ASSERT_EQ( collectedData->signalSnapshots.size(), 1 );
+    ASSERT_EQ( collectedData->signalSnapshots[0].signalID, s2.signalID );
+}
+
+TEST_F( CollectionInspectionEngineTest, CollectInOrderOfAfterDuration )
+{
+    CollectionInspectionEngine engine;
+    collectionSchemes->conditions.resize( 3 );
+    std::vector<uint32_t> afterDurations = { 300, 100, 100 };
+    for ( size_t i = 0; i < collectionSchemes->conditions.size(); i++ )
+    {
+        auto &condition = collectionSchemes->conditions[i];
+        condition.condition = getAlwaysTrueCondition().get();
+        condition.probabilityToSend = 1.0;
+        condition.minimumPublishInterval = 10000;
+        condition.afterDuration = afterDurations[i];
+        condition.metaData.collectionSchemeID = std::to_string( i );
+    }
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+
+    uint64_t timestamp = 160000000;
+    uint32_t waitTimeMs = 0;
+    engine.evaluateConditions( timestamp );
+    ASSERT_EQ( engine.collectNextDataToSend( timestamp, waitTimeMs ), nullptr );
+    // The wait time comes from the earliest afterDuration
+    EXPECT_EQ( waitTimeMs, 100 );
+
+    timestamp += 100;
+    auto collectedData = engine.collectNextDataToSend( timestamp, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+    EXPECT_EQ( collectedData->metaData.collectionSchemeID, "1" );
+    collectedData = engine.collectNextDataToSend( timestamp, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+    EXPECT_EQ( collectedData->metaData.collectionSchemeID, "2" );
+    ASSERT_EQ( engine.collectNextDataToSend( timestamp, waitTimeMs ), nullptr );
+    EXPECT_EQ( waitTimeMs, 200 );
+
+    timestamp += 250;
+    collectedData = engine.collectNextDataToSend( timestamp, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+    EXPECT_EQ( collectedData->metaData.collectionSchemeID, "0" );
+    ASSERT_EQ( engine.collectNextDataToSend( timestamp, waitTimeMs ), nullptr );
+    EXPECT_EQ( waitTimeMs, std::numeric_limits<uint32_t>::max() );
+}
+
+TEST_F( CollectionInspectionEngineTest, ThresholdComparisonsOfManyConditions )
+{
+    CollectionInspectionEngine engine;
+    InspectionMatrixSignalCollectionInfo s1{};
+    s1.signalID = 1;
+    s1.sampleBufferSize = 50;
+    s1.minimumSampleIntervalMs = 0;
+    s1.fixedWindowPeriod = 77777;
+    s1.isConditionOnlySignal = true;
+    // signal > 50, signal < 20, signal >= 50, 20 >= signal, signal == 35
+    std::vector<std::pair<ExpressionNodeType, double>> comparisons = {
+        { ExpressionNodeType::OPERATOR_BIGGER, 50 },
+        { ExpressionNodeType::OPERATOR_SMALLER, 20 },
+        { ExpressionNodeType::OPERATOR_BIGGER_EQUAL, 50 },
+        { ExpressionNodeType::OPERATOR_BIGGER_EQUAL, 20 },
+        { ExpressionNodeType::OPERATOR_EQUAL, 35 } };
+    collectionSchemes->conditions.resize( comparisons.size() );
+    for ( size_t i = 0; i < comparisons.size(); i++ )
+    {
+        expressionNodes.push_back( std::make_shared<ExpressionNode>() );
+        auto comparison = expressionNodes.back();
+        expressionNodes.push_back( std::make_shared<ExpressionNode>() );
+        auto signal = expressionNodes.back();
+        expressionNodes.push_back( std::make_shared<ExpressionNode>() );
+        auto value = expressionNodes.back();
+        comparison->nodeType = comparisons[i].first;
+        comparison->left = signal.get();
+        comparison->right = value.get();
+        signal->nodeType = ExpressionNodeType::SIGNAL;
+        signal->signalID = s1.signalID;
+        value->nodeType = ExpressionNodeType::FLOAT;
+        value->floatingValue = comparisons[i].second;
+        if ( i == 3 )
+        {
+            // Constant on the left side
+            std::swap( comparison->left, comparison->right );
+        }
+        auto &condition = collectionSchemes->conditions[i];
+        condition = ConditionWithCollectedData();
+        condition.probabilityToSend = 1.0;
+        condition.metaData.collectionSchemeID = std::to_string( i );
+        condition.condition = comparison.get();
+        addSignalToCollect( condition, s1 );
+    }
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+
+    uint64_t timestamp = 160000000;
+    auto triggeredConditions = [&]( double value ) {
+        timestamp += 1000;
+        engine.addNewSignal( s1.signalID, timestamp, value );
+        engine.evaluateConditions( timestamp );
+        std::string triggered;
+        uint32_t waitTimeMs = 0;
+        auto collectedData = engine.collectNextDataToSend( timestamp, waitTimeMs );
+        while ( collectedData != nullptr )
+        {
+            triggered += collectedData->metaData.collectionSchemeID;
+            collectedData = engine.collectNextDataToSend( timestamp, waitTimeMs );
+        }
+        std::sort( triggered.begin(), triggered.end() );
+        return triggered;
+    };
+    EXPECT_EQ( triggeredConditions( 10 ), "13" );
+    EXPECT_EQ( triggeredConditions( 35 ), "4" );
+    EXPECT_EQ( triggeredConditions( 50 ), "2" );
+    EXPECT_EQ( triggeredConditions( 60 ), "02" );
+    EXPECT_EQ( triggeredConditions( 20 ), "3" );
+    EXPECT_EQ( triggeredConditions( 35.0001 ), "4" );
+    EXPECT_EQ( triggeredConditions( std::nan( "" ) ), "" );
+    EXPECT_EQ( triggeredConditions( 19 ), "13" );
+
+    // The comparisons of the new matrix start with the latest sample taken over from the previous one
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+    engine.evaluateConditions( timestamp );
+    uint32_t waitTimeMs = 0;
+    auto collectedData = engine.collectNextDataToSend( timestamp, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+    EXPECT_TRUE( ( collectedData->metaData.collectionSchemeID == "1" ) ||
+                 ( collectedData->metaData.collectionSchemeID == "3" ) );
+}
+
+TEST_F( CollectionInspectionEngineTest, SharedSubExpressions )
+{
+    CollectionInspectionEngine engine;
+    InspectionMatrixSignalCollectionInfo s1{};
+    s1.signalID = 1;
+    s1.sampleBufferSize = 50;
+    s1.minimumSampleIntervalMs = 0;
+    s1.fixedWindowPeriod = 77777;
+    s1.isConditionOnlySignal = true;
+    InspectionMatrixSignalCollectionInfo s2 = s1;
+    s2.signalID = 2;
+    // Both conditions are (signal1 + signal2) > 10 with the same nodes, the third one uses only the sum
+    expressionNodes.push_back( std::make_shared<ExpressionNode>() );
+    auto bigger = expressionNodes.back();
+    expressionNodes.push_back( std::make_shared<ExpressionNode>() );
+    auto plus = expressionNodes.back();
+    expressionNodes.push_back( std::make_shared<ExpressionNode>() );
+    auto signal1 = expressionNodes.back();
+    expressionNodes.push_back( std::make_shared<ExpressionNode>() );
+    auto signal2 = expressionNodes.back();
+    expressionNodes.push_back( std::make_shared<ExpressionNode>() );
+    auto value = expressionNodes.back();
+    expressionNodes.push_back( std::make_shared<ExpressionNode>() );
+    auto smaller = expressionNodes.back();
+    bigger->nodeType = ExpressionNodeType::OPERATOR_BIGGER;
+    bigger->left = plus.get();
+    bigger->right = value.get();
+    smaller->nodeType = ExpressionNodeType::OPERATOR_SMALLER;
+    smaller->left = plus.get();
+    smaller->right = value.get();
+    plus->nodeType = ExpressionNodeType::OPERATOR_ARITHMETIC_PLUS;
+    plus->left = signal1.get();
+    plus->right = signal2.get();
+    signal1->nodeType = ExpressionNodeType::SIGNAL;
+    signal1->signalID = s1.signalID;
+    signal2->nodeType = ExpressionNodeType::SIGNAL;
+    signal2->signalID = s2.signalID;
+    value->nodeType = ExpressionNodeType::FLOAT;
+    value->floatingValue = 10;
+
+    collectionSchemes->conditions.resize( 3 );
+    for ( size_t i = 0; i < collectionSchemes->conditions.size(); i++ )
+    {
+        auto &condition = collectionSchemes->conditions[i];
+        condition = ConditionWithCollectedData();
+        condition.probabilityToSend = 1.0;
+        condition.metaData.collectionSchemeID = std::to_string( i );
+        condition.condition = ( i == 2 ) ? smaller.get() : bigger.get();
+        addSignalToCollect( condition, s1 );
+        addSignalToCollect( condition, s2 );
+    }
+    // The second condition sees signal1 only once per second, so it can not share the first condition's result
+    collectionSchemes->conditions[1].signals[0].minimumSampleIntervalMs = 1000;
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+
+    uint64_t timestamp = 160000000;
+    auto triggeredConditions = [&]( SignalID signalID, double signalValue ) {
+        timestamp += 100;
+        engine.addNewSignal( signalID, timestamp, signalValue );
+        engine.evaluateConditions( timestamp );
+        std::string triggered;
+        uint32_t waitTimeMs = 0;
+        auto collectedData = engine.collectNextDataToSend( timestamp, waitTimeMs );
+        while ( collectedData != nullptr )
+        {
+            triggered += collectedData->metaData.collectionSchemeID;
+            collectedData = engine.collectNextDataToSend( timestamp, waitTimeMs );
+        }
+        std::sort( triggered.begin(), triggered.end() );
+        return triggered;
+    };
+    EXPECT_EQ( triggeredConditions( s1.signalID, 1 ), "" );
+    EXPECT_EQ( triggeredConditions( s2.signalID, 2 ), "2" );
+    // Within the sample interval of the second condition
+    EXPECT_EQ( triggeredConditions( s1.signalID, 20 ), "0" );
+    EXPECT_EQ( triggeredConditions( s2.signalID, 3 ), "0" );
+    EXPECT_EQ( triggeredConditions( s2.signalID, -30 ), "2" );
+}
+
 TEST_F( CollectionInspectionEngineTest, HearbeatInterval )
 {
     CollectionInspectionEngine engine;
@@ -889,6 +1953,154 @@ TEST_F( CollectionInspectionEngineTest, HearbeatInterval )
     EXPECT_NE( engine.collectNextDataToSend( timestamp + 10000, waitTimeMs ), nullptr );
 }
 
+TEST_F( CollectionInspectionEngineTest, NextEvaluationTimeOfRepeatedTrigger )
+{
+    CollectionInspectionEngine engine;
+    InspectionMatrixSignalCollectionInfo s1{};
+    s1.signalID = 1234;
+    s1.sampleBufferSize = 50;
+    s1.minimumSampleIntervalMs = 10;
+    s1.fixedWindowPeriod = 0;
+    addSignalToCollect( collectionSchemes->conditions[0], s1 );
+    collectionSchemes->conditions[0].minimumPublishInterval = 10000;
+    collectionSchemes->conditions[0].condition = getAlwaysTrueCondition().get();
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+
+    uint64_t timestamp = 160000000;
+    // Every condition is evaluated once after the inspection matrix changed
+    ASSERT_EQ( engine.getNextEvaluationTime( timestamp ), timestamp );
+    engine.addNewSignal( s1.signalID, timestamp, 0.1 );
+    ASSERT_TRUE( engine.evaluateConditions( timestamp ) );
+    // Nothing to evaluate until the triggered data is collected
+    ASSERT_EQ( engine.getNextEvaluationTime( timestamp ),
+               std::numeric_limits<CollectionInspectionEngine::InspectionTimestamp>::max() );
+    uint32_t waitTimeMs = 0;
+    ASSERT_NE( engine.collectNextDataToSend( timestamp, waitTimeMs ), nullptr );
+    // The condition triggers again once the minimum publish interval is over, with or without new input
+    ASSERT_EQ( engine.getNextEvaluationTime( timestamp ), timestamp + 10000 );
+    engine.addNewSignal( s1.signalID, timestamp + 500, 0.1 );
+    ASSERT_EQ( engine.getNextEvaluationTime( timestamp + 500 ), timestamp + 10000 );
+    ASSERT_EQ( engine.getNextEvaluationTime( timestamp + 10001 ), timestamp + 10001 );
+}
+
+TEST_F( CollectionInspectionEngineTest, NextEvaluationTimeOfWindowFunction )
+{
+    CollectionInspectionEngine engine;
+    InspectionMatrixSignalCollectionInfo s1{};
+    s1.signalID = 1234;
+    s1.sampleBufferSize = 50;
+    s1.minimumSampleIntervalMs = 10;
+    s1.fixedWindowPeriod = 100;
+    addSignalToCollect( collectionSchemes->conditions[0], s1 );
+    collectionSchemes->conditions[0].condition = getLastAvgWindowBiggerCondition( s1.signalID, 150.0 ).get();
+    collectionSchemes->conditions[0].triggerOnlyOnRisingEdge = true;
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+
+    uint64_t timestamp = 160000000;
+    engine.addNewSignal( s1.signalID, timestamp, 1.0 );
+    ASSERT_FALSE( engine.evaluateConditions( timestamp ) );
+    // The false condition is only evaluated again when the window times out
+    auto nextTime = engine.getNextEvaluationTime( timestamp );
+    ASSERT_GT( nextTime, timestamp );
+    ASSERT_LE( nextTime, timestamp + 100 );
+    ASSERT_FALSE( engine.evaluateConditions( nextTime ) );
+    ASSERT_GT( engine.getNextEvaluationTime( nextTime ), nextTime );
+    // New input is evaluated directly
+    engine.addNewSignal( s1.signalID, nextTime + 1, 1.0 );
+    ASSERT_EQ( engine.getNextEvaluationTime( nextTime + 1 ), nextTime + 1 );
+}
+
+TEST_F( CollectionInspectionEngineTest, PeriodicConditionsTriggerAtTheTicksOfTheirPeriod )
+{
+    CollectionInspectionEngine engine;
+    engine.setConditionProfilingEnabled( true );
+    InspectionMatrixSignalCollectionInfo s1{};
+    s1.signalID = 1234;
+    s1.sampleBufferSize = 10;
+    addSignalToCollect( collectionSchemes->conditions[0], s1 );
+    collectionSchemes->conditions[0].condition = getAlwaysTrueCondition().get();
+    collectionSchemes->conditions[0].minimumPublishInterval = 1000;
+    collectionSchemes->conditions[0].metaData.collectionSchemeID = "slow";
+    addSignalToCollect( collectionSchemes->conditions[1], s1 );
+    collectionSchemes->conditions[1].condition = getAlwaysTrueCondition().get();
+    collectionSchemes->conditions[1].minimumPublishInterval = 300;
+    collectionSchemes->conditions[1].metaData.collectionSchemeID = "fast";
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+
+    uint64_t timestamp = 160000000;
+    uint32_t waitTimeMs = 0;
+    // The first evaluation starts the ticks of both periods
+    ASSERT_EQ( engine.getNextEvaluationTime( timestamp ), timestamp );
+    engine.addNewSignal( s1.signalID, timestamp, 1.0 );
+    ASSERT_TRUE( engine.evaluateConditions( timestamp ) );
+    ASSERT_NE( engine.collectNextDataToSend( timestamp, waitTimeMs ), nullptr );
+    ASSERT_NE( engine.collectNextDataToSend( timestamp, waitTimeMs ), nullptr );
+    ASSERT_EQ( engine.getNextEvaluationTime( timestamp ), timestamp + 300 );
+    // A late evaluation does not shift the phase
+    ASSERT_TRUE( engine.evaluateConditions( timestamp + 350 ) );
+    auto collectedData = engine.collectNextDataToSend( timestamp + 350, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+    ASSERT_EQ( collectedData->metaData.collectionSchemeID, "fast" );
+    ASSERT_EQ( engine.getNextEvaluationTime( timestamp + 350 ), timestamp + 600 );
+    ASSERT_FALSE( engine.evaluateConditions( timestamp + 400 ) );
+
+    // A condition added with the same period triggers with the next tick of the period
+    auto newCollectionSchemes = std::make_shared<InspectionMatrix>();
+    newCollectionSchemes->conditions = collectionSchemes->conditions;
+    newCollectionSchemes->conditions.emplace_back( collectionSchemes->conditions[0] );
+    newCollectionSchemes->conditions[2].metaData.collectionSchemeID = "new";
+    engine.onChangeInspectionMatrix( newCollectionSchemes );
+    ASSERT_EQ( engine.getNextEvaluationTime( timestamp + 400 ), timestamp + 600 );
+    ASSERT_TRUE( engine.evaluateConditions( timestamp + 600 ) );
+    ASSERT_NE( engine.collectNextDataToSend( timestamp + 600, waitTimeMs ), nullptr );
+    ASSERT_EQ( engine.collectNextDataToSend( timestamp + 600, waitTimeMs ), nullptr );
+    ASSERT_TRUE( engine.evaluateConditions( timestamp + 1000 ) );
+    std::vector<std::string> collectedSchemes;
+    while ( ( collectedData = engine.collectNextDataToSend( timestamp + 1000, waitTimeMs ) ) != nullptr )
+    {
+        collectedSchemes.push_back( collectedData->metaData.collectionSchemeID );
+    }
+    std::sort( collectedSchemes.begin(), collectedSchemes.end() );
+    // The tick at 900 of the short period is due as well
+    ASSERT_EQ( collectedSchemes, ( std::vector<std::string>{ "fast", "new", "slow" } ) );
+
+    // The periodic conditions are triggered without being evaluated
+    for ( const auto &profile : engine.takeHotConditions( 3 ) )
+    {
+        EXPECT_EQ( profile.evaluations, 0 );
+        EXPECT_GT( profile.triggers, 0 );
+    }
+}
+
+TEST_F( CollectionInspectionEngineTest, PeriodicConditionsStartAfterTheOffsetOfTheDevice )
+{
+    CollectionInspectionEngine engine;
+    DeviceJitter jitter( "vehicle1", 30000 );
+    engine.setDeviceJitter( jitter );
+    InspectionMatrixSignalCollectionInfo s1{};
+    s1.signalID = 1234;
+    s1.sampleBufferSize = 10;
+    addSignalToCollect( collectionSchemes->conditions[0], s1 );
+    collectionSchemes->conditions[0].condition = getAlwaysTrueCondition().get();
+    collectionSchemes->conditions[0].minimumPublishInterval = 1000;
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+
+    auto offsetMs = jitter.getOffsetMs( "periodicCollection", 1000 );
+    ASSERT_GT( offsetMs, 0 );
+    ASSERT_LT( offsetMs, 1000 );
+    uint64_t timestamp = 160000000;
+    uint32_t waitTimeMs = 0;
+    // The first evaluation only schedules the first tick
+    engine.addNewSignal( s1.signalID, timestamp, 1.0 );
+    ASSERT_FALSE( engine.evaluateConditions( timestamp ) );
+    ASSERT_EQ( engine.collectNextDataToSend( timestamp, waitTimeMs ), nullptr );
+    ASSERT_EQ( engine.getNextEvaluationTime( timestamp ), timestamp + offsetMs );
+    ASSERT_TRUE( engine.evaluateConditions( timestamp + offsetMs ) );
+    ASSERT_NE( engine.collectNextDataToSend( timestamp + offsetMs, waitTimeMs ), nullptr );
+    // The following ticks keep the phase
+    ASSERT_EQ( engine.getNextEvaluationTime( timestamp + offsetMs ), timestamp + offsetMs + 1000 );
+}
+
 TEST_F( CollectionInspectionEngineTest, TwoCollectionSchemesWithDifferentNumberOfSamplesToCollect )
 {
     CollectionInspectionEngine engine;
@@ -947,6 +2159,124 @@ TEST_F( CollectionInspectionEngineTest, TwoCollectionSchemesWithDifferentNumberO
     // twice by different collection schemes, otherwise this would have only 720 samples
 }
 
+TEST_F( CollectionInspectionEngineTest, SharedPayloadsOfConditionsDueAtTheSameTime )
+{
+    CollectionInspectionEngine engine;
+    CollectionInspectionEngine snapshotEngine;
+    engine.setSharedPayloadsEnabled( true );
+    snapshotEngine.setSharedPayloadsEnabled( true );
+    snapshotEngine.setSignalSnapshotsEnabled( true );
+    collectionSchemes->conditions.resize( 3 );
+    for ( size_t i = 0; i < collectionSchemes->conditions.size(); i++ )
+    {
+        auto &condition = collectionSchemes->conditions[i];
+        condition.condition = getAlwaysTrueCondition().get();
+        condition.probabilityToSend = 1.0;
+        condition.minimumPublishInterval = 10000;
+        condition.metaData.collectionSchemeID = std::to_string( i );
+    }
+    InspectionMatrixSignalCollectionInfo s1{};
+    s1.signalID = 1234;
+    s1.sampleBufferSize = 50;
+    s1.minimumSampleIntervalMs = 10;
+    addSignalToCollect( collectionSchemes->conditions[0], s1 );
+    // Condition 1 collects more samples of the same signal and another signal
+    s1.sampleBufferSize = 100;
+    addSignalToCollect( collectionSchemes->conditions[1], s1 );
+    InspectionMatrixSignalCollectionInfo s2{};
+    s2.signalID = 1235;
+    s2.sampleBufferSize = 30;
+    s2.minimumSampleIntervalMs = 10;
+    addSignalToCollect( collectionSchemes->conditions[1], s2 );
+    // Condition 2 has another priority, so its data is sent separately
+    addSignalToCollect( collectionSchemes->conditions[2], s2 );
+    collectionSchemes->conditions[2].metaData.priority = 1;
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+    snapshotEngine.onChangeInspectionMatrix( consCollectionSchemes );
+
+    uint64_t timestamp = 160000000;
+    for ( int i = 0; i < 2000; i++ )
+    {
+        timestamp++;
+        engine.addNewSignal( s1.signalID, timestamp, i );
+        engine.addNewSignal( s2.signalID, timestamp, i + 2 );
+        snapshotEngine.addNewSignal( s1.signalID, timestamp, i );
+        snapshotEngine.addNewSignal( s2.signalID, timestamp, i + 2 );
+    }
+    engine.evaluateConditions( timestamp );
+    snapshotEngine.evaluateConditions( timestamp );
+
+    uint32_t waitTimeMs = 0;
+    auto sharedData = engine.collectNextDataToSend( timestamp, waitTimeMs );
+    ASSERT_NE( sharedData, nullptr );
+    EXPECT_EQ( sharedData->metaData.collectionSchemeID, "0" );
+    // The 50 samples of condition 0 are contained in the 100 samples of condition 1
+    EXPECT_EQ( sharedData->signals.size(), 130 );
+    ASSERT_EQ( sharedData->sharedEvents.size(), 1 );
+    EXPECT_EQ( sharedData->sharedEvents[0].collectionSchemeID, "1" );
+    EXPECT_NE( sharedData->sharedEvents[0].eventID, sharedData->eventID );
+    EXPECT_EQ( sharedData->sharedEvents[0].signalIDs, std::vector<SignalID>( { s1.signalID, s2.signalID } ) );
+    auto separateData = engine.collectNextDataToSend( timestamp, waitTimeMs );
+    ASSERT_NE( separateData, nullptr );
+    EXPECT_EQ( separateData->metaData.collectionSchemeID, "2" );
+    EXPECT_EQ( separateData->signals.size(), 30 );
+    EXPECT_TRUE( separateData->sharedEvents.empty() );
+    ASSERT_EQ( engine.collectNextDataToSend( timestamp, waitTimeMs ), nullptr );
+
+    // Snapshots of the same history buffer are merged to the longest one
+    auto sharedSnapshots = snapshotEngine.collectNextDataToSend( timestamp, waitTimeMs );
+    ASSERT_NE( sharedSnapshots, nullptr );
+    ASSERT_EQ( sharedSnapshots->signalSnapshots.size(), 2 );
+    EXPECT_EQ( sharedSnapshots->signalSnapshots[0].signalID, s1.signalID );
+    EXPECT_EQ( sharedSnapshots->signalSnapshots[0].sampleCount, 100 );
+    EXPECT_EQ( sharedSnapshots->signalSnapshots[1].signalID, s2.signalID );
+    EXPECT_EQ( sharedSnapshots->signalSnapshots[1].sampleCount, 30 );
+    EXPECT_EQ( sharedSnapshots->sharedEvents.size(), 1 );
+}
+
+TEST_F( CollectionInspectionEngineTest, ConditionProfilingReportsHotConditions )
+{
+    CollectionInspectionEngine engine;
+    engine.setConditionProfilingEnabled( true );
+    InspectionMatrixSignalCollectionInfo s1{};
+    s1.signalID = 1234;
+    s1.sampleBufferSize = 10;
+    addSignalToCollect( collectionSchemes->conditions[0], s1 );
+    collectionSchemes->conditions[0].condition = getAlwaysTrueCondition().get();
+    collectionSchemes->conditions[0].metaData.collectionSchemeID = "hot";
+    collectionSchemes->conditions[1].metaData.collectionSchemeID = "cold";
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+
+    uint64_t timestamp = 160000000;
+    uint32_t waitTimeMs = 0;
+    for ( uint32_t i = 0; i < 20; i++ )
+    {
+        engine.addNewSignal( s1.signalID, timestamp + i, i );
+        engine.evaluateConditions( timestamp + i );
+        ASSERT_NE( engine.collectNextDataToSend( timestamp + i, waitTimeMs ), nullptr );
+    }
+    auto hotConditions = engine.takeHotConditions( 1 );
+    ASSERT_EQ( hotConditions.size(), 1 );
+    EXPECT_EQ( hotConditions[0].collectionSchemeID, "hot" );
+    EXPECT_EQ( hotConditions[0].evaluations, 20 );
+    // Every CONDITION_PROFILING_SAMPLING_INTERVAL-th evaluation is timed
+    EXPECT_EQ( hotConditions[0].sampledEvaluations, 2 );
+    EXPECT_EQ( hotConditions[0].triggers, 20 );
+    EXPECT_GT( hotConditions[0].collectedBytes, 0 );
+    EXPECT_GT( hotConditions[0].getEstimatedCostNs(), 0 );
+    // The counters start again after the profile was taken
+    EXPECT_TRUE( engine.takeHotConditions( 10 ).empty() );
+
+    engine.addNewSignal( s1.signalID, timestamp + 20, 20 );
+    engine.evaluateConditions( timestamp + 20 );
+    engine.reportHotConditions( 10 );
+    EXPECT_EQ( TraceModule::get().getNamedVariable( "conditionTriggers_hot" ), 1 );
+    EXPECT_EQ( TraceModule::get().getNamedVariable( "conditionEvaluations_hot" ), 1 );
+    // A condition that is not reported again has its variables removed
+    engine.reportHotConditions( 10 );
+    EXPECT_EQ( TraceModule::get().getNamedVariable( "conditionTriggers_hot" ), 0 );
+}
+
 TEST_F( CollectionInspectionEngineTest, TwoSignalsInConditionAndOneSignalToCollect )
 {
     CollectionInspectionEngine engine;
@@ -1011,6 +2341,207 @@ TEST_F( CollectionInspectionEngineTest, TwoSignalsInConditionAndOneSignalToColle
     ASSERT_EQ( collectedData->triggerTime, timestamp );
 }
 
+TEST_F( CollectionInspectionEngineTest, LargeSignalIDsBesideSmallSignalIDs )
+{
+    CollectionInspectionEngine engine;
+    InspectionMatrixSignalCollectionInfo s1{};
+    // Bigger than the signal ID table so the hash map is used
+    s1.signalID = 0x10000000;
+    s1.sampleBufferSize = 50;
+    s1.minimumSampleIntervalMs = 0;
+    s1.fixedWindowPeriod = 77777;
+    s1.isConditionOnlySignal = false;
+    InspectionMatrixSignalCollectionInfo s2{};
+    s2.signalID = 7;
+    s2.sampleBufferSize = 50;
+    s2.minimumSampleIntervalMs = 0;
+    s2.fixedWindowPeriod = 77777;
+    s2.isConditionOnlySignal = false;
+    addSignalToCollect( collectionSchemes->conditions[0], s1 );
+    addSignalToCollect( collectionSchemes->conditions[0], s2 );
+
+    // The condition is (signalID(0x10000000)>-100) && (signalID(7)>-500)
+    collectionSchemes->conditions[0].condition =
+        getTwoSignalsBiggerCondition( s1.signalID, -100.0, s2.signalID, -500.0 ).get();
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+
+    uint64_t timestamp = 160000000;
+    // Signals not part of the matrix are ignored
+    engine.addNewSignal( 0x10000001, timestamp, 1.0 );
+    engine.addNewSignal( 8, timestamp, 1.0 );
+    engine.addNewSignal( s1.signalID, timestamp, -90.0 );
+    engine.evaluateConditions( timestamp );
+    uint32_t waitTimeMs = 0;
+    ASSERT_EQ( engine.collectNextDataToSend( timestamp, waitTimeMs ), nullptr );
+
+    timestamp += 1000;
+    engine.addNewSignal( s2.signalID, timestamp, -480.0 );
+    engine.evaluateConditions( timestamp );
+    auto collectedData = engine.collectNextDataToSend( timestamp, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+    ASSERT_EQ( collectedData->signals.size(), 2 );
+    ASSERT_EQ( collectedData->signals[0].signalID, s1.signalID );
+    ASSERT_EQ( collectedData->signals[1].signalID, s2.signalID );
+}
+
+TEST_F( CollectionInspectionEngineTest, SignalsFoundByDecoderManifestIndex )
+{
+    CollectionInspectionEngine engine;
+    InspectionMatrixSignalCollectionInfo s1{};
+    // Bigger than the signal ID table, found through the Decoder Manifest index instead of the hash map
+    s1.signalID = 0x10000000;
+    s1.sampleBufferSize = 50;
+    s1.minimumSampleIntervalMs = 0;
+    s1.fixedWindowPeriod = 77777;
+    s1.isConditionOnlySignal = false;
+    s1.signalIndex = 1;
+    InspectionMatrixSignalCollectionInfo s2{};
+    s2.signalID = 7;
+    s2.sampleBufferSize = 50;
+    s2.minimumSampleIntervalMs = 0;
+    s2.fixedWindowPeriod = 77777;
+    s2.isConditionOnlySignal = false;
+    s2.signalIndex = 0;
+    addSignalToCollect( collectionSchemes->conditions[0], s1 );
+    addSignalToCollect( collectionSchemes->conditions[0], s2 );
+
+    // The condition is (signalID(0x10000000)>-100) && (signalID(7)>-500)
+    collectionSchemes->conditions[0].condition =
+        getTwoSignalsBiggerCondition( s1.signalID, -100.0, s2.signalID, -500.0 ).get();
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+
+    uint64_t timestamp = 160000000;
+    // An index of another signal, e.g. from a newer Decoder Manifest, is ignored and the ID is used
+    engine.addNewSignal( 8, timestamp, 1.0, 0, s2.signalIndex );
+    engine.addNewSignal( s1.signalID, timestamp, -90.0, 0, s1.signalIndex );
+    engine.evaluateConditions( timestamp );
+    uint32_t waitTimeMs = 0;
+    ASSERT_EQ( engine.collectNextDataToSend( timestamp, waitTimeMs ), nullptr );
+
+    timestamp += 1000;
+    engine.addNewSignal( s2.signalID, timestamp, -480.0, 0, 5 );
+    engine.addNewSignal( s1.signalID, timestamp, -80.0, 0, s1.signalIndex );
+    engine.evaluateConditions( timestamp );
+    auto collectedData = engine.collectNextDataToSend( timestamp, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+    ASSERT_EQ( collectedData->signals.size(), 3 );
+    ASSERT_EQ( collectedData->signals[0].signalID, s1.signalID );
+    ASSERT_EQ( collectedData->signals[1].signalID, s1.signalID );
+    ASSERT_EQ( collectedData->signals[2].signalID, s2.signalID );
+}
+
+TEST_F( CollectionInspectionEngineTest, LogicalOrSkipsRightOperandIfLeftIsTrue )
+{
+    CollectionInspectionEngine engine;
+    InspectionMatrixSignalCollectionInfo s1{};
+    s1.signalID = 1;
+    s1.sampleBufferSize = 50;
+    s1.minimumSampleIntervalMs = 0;
+    s1.fixedWindowPeriod = 77777;
+    s1.isConditionOnlySignal = false;
+    InspectionMatrixSignalCollectionInfo s2{};
+    s2.signalID = 2;
+    s2.sampleBufferSize = 50;
+    s2.minimumSampleIntervalMs = 0;
+    s2.fixedWindowPeriod = 77777;
+    s2.isConditionOnlySignal = true;
+    addSignalToCollect( collectionSchemes->conditions[0], s1 );
+    addSignalToCollect( collectionSchemes->conditions[0], s2 );
+
+    // The condition is (signalID(1)>(2*3)) || (signalID(2)>0), the constant product is folded
+    expressionNodes.push_back( std::make_shared<ExpressionNode>() );
+    auto boolOr = expressionNodes.back();
+    auto bigger2 = getTwoSignalsBiggerCondition( s2.signalID, 0.0, s2.signalID, 0.0 );
+    expressionNodes.push_back( std::make_shared<ExpressionNode>() );
+    auto bigger1 = expressionNodes.back();
+    expressionNodes.push_back( std::make_shared<ExpressionNode>() );
+    auto signal1 = expressionNodes.back();
+    expressionNodes.push_back( std::make_shared<ExpressionNode>() );
+    auto multiply = expressionNodes.back();
+    expressionNodes.push_back( std::make_shared<ExpressionNode>() );
+    auto value1 = expressionNodes.back();
+    expressionNodes.push_back( std::make_shared<ExpressionNode>() );
+    auto value2 = expressionNodes.back();
+    boolOr->nodeType = ExpressionNodeType::OPERATOR_LOGICAL_OR;
+    boolOr->left = bigger1.get();
+    boolOr->right = bigger2->left;
+    bigger1->nodeType = ExpressionNodeType::OPERATOR_BIGGER;
+    bigger1->left = signal1.get();
+    bigger1->right = multiply.get();
+    signal1->nodeType = ExpressionNodeType::SIGNAL;
+    signal1->signalID = s1.signalID;
+    multiply->nodeType = ExpressionNodeType::OPERATOR_ARITHMETIC_MULTIPLY;
+    multiply->left = value1.get();
+    multiply->right = value2.get();
+    value1->nodeType = ExpressionNodeType::FLOAT;
+    value1->floatingValue = 2.0;
+    value2->nodeType = ExpressionNodeType::FLOAT;
+    value2->floatingValue = 3.0;
+    collectionSchemes->conditions[0].condition = boolOr.get();
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+
+    uint64_t timestamp = 160000000;
+    engine.addNewSignal( s1.signalID, timestamp, 5.0 );
+    // Left operand is false and the right one has no sample yet
+    engine.evaluateConditions( timestamp );
+    uint32_t waitTimeMs = 0;
+    ASSERT_EQ( engine.collectNextDataToSend( timestamp, waitTimeMs ), nullptr );
+
+    timestamp += 1000;
+    engine.addNewSignal( s1.signalID, timestamp, 7.0 );
+    // Left operand is true so the missing right operand is not evaluated
+    engine.evaluateConditions( timestamp );
+    auto collectedData = engine.collectNextDataToSend( timestamp, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+    ASSERT_EQ( collectedData->signals.size(), 2 );
+    ASSERT_EQ( collectedData->triggerTime, timestamp );
+}
+
+TEST_F( CollectionInspectionEngineTest, RisingEdgeConditionOnlyEvaluatedOnInputChange )
+{
+    CollectionInspectionEngine engine;
+    InspectionMatrixSignalCollectionInfo s1{};
+    s1.signalID = 1;
+    s1.sampleBufferSize = 50;
+    s1.minimumSampleIntervalMs = 0;
+    s1.fixedWindowPeriod = 77777;
+    s1.isConditionOnlySignal = false;
+    addSignalToCollect( collectionSchemes->conditions[0], s1 );
+    // The condition is (signalID(1)>0) && (signalID(1)>0)
+    collectionSchemes->conditions[0].condition =
+        getTwoSignalsBiggerCondition( s1.signalID, 0.0, s1.signalID, 0.0 ).get();
+    collectionSchemes->conditions[0].triggerOnlyOnRisingEdge = true;
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+
+    uint64_t timestamp = 160000000;
+    uint32_t waitTimeMs = 0;
+    engine.addNewSignal( s1.signalID, timestamp, -1.0 );
+    ASSERT_FALSE( engine.evaluateConditions( timestamp ) );
+
+    timestamp += 1000;
+    engine.addNewSignal( s1.signalID, timestamp, 1.0 );
+    ASSERT_TRUE( engine.evaluateConditions( timestamp ) );
+    ASSERT_NE( engine.collectNextDataToSend( timestamp, waitTimeMs ), nullptr );
+
+    // No input changed so the true condition is not evaluated again
+    timestamp += 1000;
+    ASSERT_FALSE( engine.evaluateConditions( timestamp ) );
+
+    // Still true after the input change but no rising edge
+    timestamp += 1000;
+    engine.addNewSignal( s1.signalID, timestamp, 2.0 );
+    ASSERT_TRUE( engine.evaluateConditions( timestamp ) );
+    ASSERT_EQ( engine.collectNextDataToSend( timestamp, waitTimeMs ), nullptr );
+
+    timestamp += 1000;
+    engine.addNewSignal( s1.signalID, timestamp, -2.0 );
+    ASSERT_FALSE( engine.evaluateConditions( timestamp ) );
+    timestamp += 1000;
+    engine.addNewSignal( s1.signalID, timestamp, 3.0 );
+    ASSERT_TRUE( engine.evaluateConditions( timestamp ) );
+    ASSERT_NE( engine.collectNextDataToSend( timestamp, waitTimeMs ), nullptr );
+}
+
 // Default is to send data only out once per collectionScheme
 TEST_F( CollectionInspectionEngineTest, SendOutEverySignalOnlyOncePerCollectionScheme )
 {
@@ -1099,23 +2630,60 @@ TEST_F( CollectionInspectionEngineTest, MoreCollectionSchemesThanSupported )
     collectionSchemes->conditions.resize( MAX_NUMBER_OF_ACTIVE_CONDITION + 1 );
     for ( uint32_t i = 0; i < MAX_NUMBER_OF_ACTIVE_CONDITION; i++ )
     {
-        collectionSchemes->conditions[i].condition = getAlwaysTrueCondition().get();
+        collectionSchemes->conditions[i].condition = getAlwaysTrueCondition().get();
+        collectionSchemes->conditions[i].probabilityToSend = 1.0;
+        addSignalToCollect( collectionSchemes->conditions[i], s1 );
+    }
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+
+    uint64_t timestamp = 160000000;
+    uint32_t waitTimeMs = 0;
+    engine.addNewSignal( s1.signalID, timestamp, 0.1 );
+    engine.evaluateConditions( timestamp );
+    engine.collectNextDataToSend( timestamp, waitTimeMs );
+    timestamp += 10000;
+    engine.evaluateConditions( timestamp );
+    engine.collectNextDataToSend( timestamp, waitTimeMs );
+    timestamp += 10000;
+    engine.evaluateConditions( timestamp );
+    engine.collectNextDataToSend( timestamp, waitTimeMs );
+}
+
+TEST_F( CollectionInspectionEngineTest, ThousandConditions )
+{
+    CollectionInspectionEngine engine;
+    InspectionMatrixSignalCollectionInfo s1{};
+    s1.signalID = 1234;
+    s1.sampleBufferSize = 50;
+    s1.minimumSampleIntervalMs = 0;
+    s1.fixedWindowPeriod = 77777;
+    collectionSchemes->conditions.resize( 1000 );
+    for ( uint32_t i = 0; i < 1000; i++ )
+    {
+        collectionSchemes->conditions[i].condition = getAlwaysFalseCondition().get();
         collectionSchemes->conditions[i].probabilityToSend = 1.0;
-        addSignalToCollect( collectionSchemes->conditions[i], s1 );
     }
+    // Only one condition far beyond the first 256 depends on the signal
+    addSignalToCollect( collectionSchemes->conditions[700], s1 );
+    collectionSchemes->conditions[700].condition =
+        getTwoSignalsBiggerCondition( s1.signalID, 10.0, s1.signalID, 10.0 ).get();
+    collectionSchemes->conditions[700].triggerOnlyOnRisingEdge = true;
     engine.onChangeInspectionMatrix( consCollectionSchemes );
 
     uint64_t timestamp = 160000000;
     uint32_t waitTimeMs = 0;
-    engine.addNewSignal( s1.signalID, timestamp, 0.1 );
-    engine.evaluateConditions( timestamp );
-    engine.collectNextDataToSend( timestamp, waitTimeMs );
-    timestamp += 10000;
-    engine.evaluateConditions( timestamp );
-    engine.collectNextDataToSend( timestamp, waitTimeMs );
-    timestamp += 10000;
-    engine.evaluateConditions( timestamp );
-    engine.collectNextDataToSend( timestamp, waitTimeMs );
+    engine.addNewSignal( s1.signalID, timestamp, 5.0 );
+    ASSERT_FALSE( engine.evaluateConditions( timestamp ) );
+    ASSERT_EQ( engine.collectNextDataToSend( timestamp, waitTimeMs ), nullptr );
+
+    timestamp += 1000;
+    engine.addNewSignal( s1.signalID, timestamp, 20.0 );
+    ASSERT_TRUE( engine.evaluateConditions( timestamp ) );
+    auto collectedData = engine.collectNextDataToSend( timestamp, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+    ASSERT_EQ( collectedData->signals.size(), 2 );
+    ASSERT_EQ( collectedData->signals[0].value, 20.0 );
+    ASSERT_EQ( engine.collectNextDataToSend( timestamp, waitTimeMs ), nullptr );
 }
 
 /**
@@ -1206,6 +2774,145 @@ TEST_F( CollectionInspectionEngineTest, GeohashFunctionNodeTrigger )
     ASSERT_EQ( collectedData, nullptr );
 }
 
+/**
+ * @brief This test checks that a geofence function node evaluates to true while the position is inside one of the
+ * fences and that missing or invalid GPS signals evaluate to false.
+ */
+TEST_F( CollectionInspectionEngineTest, GeofenceFunctionNodeTrigger )
+{
+    CollectionInspectionEngine engine;
+    InspectionMatrixSignalCollectionInfo lat{};
+    lat.signalID = 1;
+    lat.sampleBufferSize = 50;
+    lat.minimumSampleIntervalMs = 0;
+    lat.fixedWindowPeriod = 77777;
+    lat.isConditionOnlySignal = true;
+    InspectionMatrixSignalCollectionInfo lon{};
+    lon.signalID = 2;
+    lon.sampleBufferSize = 50;
+    lon.minimumSampleIntervalMs = 0;
+    lon.fixedWindowPeriod = 77777;
+    lon.isConditionOnlySignal = true;
+    addSignalToCollect( collectionSchemes->conditions[0], lat );
+    addSignalToCollect( collectionSchemes->conditions[0], lon );
+
+    auto geofences = std::make_shared<GeofenceIndex>();
+    // 200 m around a site and a triangular depot
+    ASSERT_TRUE( geofences->addCircle( 47.620623, -122.348920, 200 ) );
+    ASSERT_TRUE( geofences->addPolygon( { { 37.37, -122.05 }, { 37.37, -122.04 }, { 37.38, -122.04 } } ) );
+    geofences->build();
+    collectionSchemes->conditions[0].condition =
+        getGeofenceFunctionCondition( lat.signalID, lon.signalID, geofences ).get();
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+
+    uint64_t timestamp = 160000000;
+    // Without GPS signal the condition is false
+    ASSERT_FALSE( engine.evaluateConditions( timestamp ) );
+
+    timestamp += 1000;
+    engine.addNewSignal( lat.signalID, timestamp, 47.620623 );
+    engine.addNewSignal( lon.signalID, timestamp, -122.348920 + 0.001 );
+    ASSERT_TRUE( engine.evaluateConditions( timestamp ) );
+    uint32_t waitTimeMs = 0;
+    auto collectedData = engine.collectNextDataToSend( timestamp, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+
+    // Outside of the circle
+    timestamp += 1000;
+    engine.addNewSignal( lat.signalID, timestamp, 47.620623 );
+    engine.addNewSignal( lon.signalID, timestamp, -122.348920 + 0.01 );
+    ASSERT_FALSE( engine.evaluateConditions( timestamp ) );
+
+    // Inside of the depot
+    timestamp += 1000;
+    engine.addNewSignal( lat.signalID, timestamp, 37.371392 );
+    engine.addNewSignal( lon.signalID, timestamp, -122.046208 );
+    ASSERT_TRUE( engine.evaluateConditions( timestamp ) );
+    collectedData = engine.collectNextDataToSend( timestamp, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+
+    // Outside of the triangle but inside of its bounding box
+    timestamp += 1000;
+    engine.addNewSignal( lat.signalID, timestamp, 37.379 );
+    engine.addNewSignal( lon.signalID, timestamp, -122.049 );
+    ASSERT_FALSE( engine.evaluateConditions( timestamp ) );
+
+    // Invalid latitude
+    timestamp += 1000;
+    engine.addNewSignal( lat.signalID, timestamp, 137.371392 );
+    engine.addNewSignal( lon.signalID, timestamp, -122.046208 );
+    ASSERT_FALSE( engine.evaluateConditions( timestamp ) );
+}
+
+TEST_F( CollectionInspectionEngineTest, RawFrameFieldTrigger )
+{
+    CollectionInspectionEngine engine;
+    InspectionMatrixSignalCollectionInfo s1{};
+    s1.signalID = 1;
+    s1.sampleBufferSize = 10;
+    s1.minimumSampleIntervalMs = 0;
+    s1.fixedWindowPeriod = 77777;
+    addSignalToCollect( collectionSchemes->conditions[0], s1 );
+    // Only captured for the condition
+    InspectionMatrixCanFrameCollectionInfo c1{};
+    c1.frameID = 0x380;
+    c1.channelID = 3;
+    c1.sampleBufferSize = 1;
+    c1.minimumSampleIntervalMs = 0;
+    c1.isConditionOnlyFrame = true;
+    collectionSchemes->conditions[0].canFrames.push_back( c1 );
+
+    // The signed big endian 12 bit field of byte 1 and the upper half of byte 2 is smaller than -100
+    expressionNodes.push_back( std::make_shared<ExpressionNode>() );
+    auto smaller = expressionNodes.back();
+    expressionNodes.push_back( std::make_shared<ExpressionNode>() );
+    auto field = expressionNodes.back();
+    expressionNodes.push_back( std::make_shared<ExpressionNode>() );
+    auto threshold = expressionNodes.back();
+    smaller->nodeType = ExpressionNodeType::OPERATOR_SMALLER;
+    smaller->left = field.get();
+    smaller->right = threshold.get();
+    field->nodeType = ExpressionNodeType::RAWFRAMEFIELD;
+    field->function.rawFrameField.channelID = c1.channelID;
+    field->function.rawFrameField.frameID = c1.frameID;
+    field->function.rawFrameField.startBit = 20;
+    field->function.rawFrameField.length = 12;
+    field->function.rawFrameField.isBigEndian = true;
+    field->function.rawFrameField.isSigned = true;
+    threshold->nodeType = ExpressionNodeType::FLOAT;
+    threshold->floatingValue = -100;
+    collectionSchemes->conditions[0].condition = smaller.get();
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+
+    uint64_t timestamp = 160000000;
+    // Without a frame the condition is false
+    engine.addNewSignal( s1.signalID, timestamp, 1 );
+    ASSERT_FALSE( engine.evaluateConditions( timestamp ) );
+
+    // 0xFF9 is -7
+    timestamp += 1000;
+    std::array<uint8_t, MAX_CAN_FRAME_BYTE_SIZE> buf = { 0x00, 0xFF, 0x90, 0x00, 0x00, 0x00, 0x00, 0x00 };
+    engine.addNewRawCanFrame( c1.frameID, c1.channelID, timestamp, buf, sizeof( buf ) );
+    ASSERT_FALSE( engine.evaluateConditions( timestamp ) );
+
+    // 0xF38 is -200. The frame alone changes the input of the condition, the frame is not sent.
+    timestamp += 1000;
+    buf[1] = 0xF3;
+    buf[2] = 0x80;
+    engine.addNewRawCanFrame( c1.frameID, c1.channelID, timestamp, buf, sizeof( buf ) );
+    ASSERT_TRUE( engine.evaluateConditions( timestamp ) );
+    uint32_t waitTimeMs = 0;
+    auto collectedData = engine.collectNextDataToSend( timestamp, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+    ASSERT_EQ( collectedData->signals.size(), 1 );
+    ASSERT_EQ( collectedData->canFrames.size(), 0 );
+
+    // A frame too short to contain the field
+    timestamp += 1000;
+    engine.addNewRawCanFrame( c1.frameID, c1.channelID, timestamp, buf, 2 );
+    ASSERT_FALSE( engine.evaluateConditions( timestamp ) );
+}
+
 TEST_F( CollectionInspectionEngineTest, CollectWithAfterTime )
 {
     CollectionInspectionEngine engine;
@@ -1299,6 +3006,69 @@ TEST_F( CollectionInspectionEngineTest, CollectWithAfterTime )
     ASSERT_EQ( collectedData->triggerTime, timestamp0 );
 }
 
+TEST_F( CollectionInspectionEngineTest, StreamingCollectionWithAfterTime )
+{
+    CollectionInspectionEngine engine( true );
+    engine.setStreamingCollectionEnabled( true );
+    InspectionMatrixSignalCollectionInfo s1{};
+    s1.signalID = 1;
+    s1.sampleBufferSize = 2;
+    s1.minimumSampleIntervalMs = 0;
+    s1.fixedWindowPeriod = 77777;
+    s1.isConditionOnlySignal = false;
+    addSignalToCollect( collectionSchemes->conditions[0], s1 );
+    InspectionMatrixCanFrameCollectionInfo c1{};
+    c1.frameID = 0x380;
+    c1.channelID = 3;
+    c1.sampleBufferSize = 1;
+    c1.minimumSampleIntervalMs = 0;
+    collectionSchemes->conditions[0].canFrames.push_back( c1 );
+    collectionSchemes->conditions[0].condition = getAlwaysTrueCondition().get();
+    collectionSchemes->conditions[0].minimumPublishInterval = 0;
+    collectionSchemes->conditions[0].afterDuration = 2000;
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+
+    uint64_t timestamp = 160000000;
+    Timestamp triggerTime = timestamp + 1;
+    engine.addNewSignal( s1.signalID, timestamp, 1.0 );
+    engine.addNewSignal( s1.signalID, triggerTime, 2.0 );
+    std::array<uint8_t, MAX_CAN_FRAME_BYTE_SIZE> buf = { 0xDE, 0xAD, 0xBE, 0xEF, 0x0, 0x0, 0x0, 0x0 };
+    engine.addNewRawCanFrame( c1.frameID, c1.channelID, triggerTime, buf, sizeof( buf ) );
+    engine.evaluateConditions( triggerTime );
+    uint32_t waitTimeMs = 0;
+    ASSERT_EQ( engine.collectNextDataToSend( triggerTime, waitTimeMs ), nullptr );
+
+    // More samples than the buffers hold arrive while the afterDuration passes
+    for ( uint32_t i = 1; i <= 4; i++ )
+    {
+        engine.addNewSignal( s1.signalID, triggerTime + ( i * 500 ), 2.0 + i );
+        buf[0] = static_cast<uint8_t>( i );
+        engine.addNewRawCanFrame( c1.frameID, c1.channelID, triggerTime + ( i * 500 ), buf, sizeof( buf ) );
+        engine.evaluateConditions( triggerTime + ( i * 500 ) );
+    }
+    auto collectedData = engine.collectNextDataToSend( triggerTime + 2000, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+    EXPECT_EQ( collectedData->triggerTime, triggerTime );
+    EXPECT_NE( collectedData->eventID, 0 );
+    // The samples before the trigger newest first, followed by the streamed samples
+    std::vector<double> values;
+    for ( const auto &signal : collectedData->signals )
+    {
+        values.push_back( signal.value );
+    }
+    EXPECT_EQ( values, std::vector<double>( { 2.0, 1.0, 3.0, 4.0, 5.0, 6.0 } ) );
+    ASSERT_EQ( collectedData->canFrames.size(), 5 );
+    EXPECT_EQ( collectedData->canFrames[0].data[0], 0xDE );
+    EXPECT_EQ( collectedData->canFrames[4].data[0], 4 );
+
+    // The streamed samples are not collected again by the next trigger
+    engine.evaluateConditions( triggerTime + 2000 );
+    collectedData = engine.collectNextDataToSend( triggerTime + 4000, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+    EXPECT_TRUE( collectedData->signals.empty() );
+    EXPECT_TRUE( collectedData->canFrames.empty() );
+}
+
 TEST_F( CollectionInspectionEngineTest, ProbabilityToSendTest )
 {
 
@@ -1425,6 +3195,113 @@ TEST_F( CollectionInspectionEngineTest, PrevLastAvgWindowCondition )
     ASSERT_NE( engine.collectNextDataToSend( timestamp, waitTimeMs ), nullptr );
 }
 
+TEST_F( CollectionInspectionEngineTest, SlidingWindowMaxCondition )
+{
+    CollectionInspectionEngine engine;
+    // the sliding window covers the samples of the last 2 seconds
+    InspectionMatrixSignalCollectionInfo s1{};
+    s1.signalID = 1234;
+    s1.sampleBufferSize = 50;
+    s1.minimumSampleIntervalMs = 0;
+    s1.fixedWindowPeriod = 2000;
+    addSignalToCollect( collectionSchemes->conditions[0], s1 );
+    collectionSchemes->conditions[0].triggerOnlyOnRisingEdge = true;
+
+    // function is: SLIDING_WINDOW_MAX(SignalID(1234)) > 50.0
+    collectionSchemes->conditions[0].condition =
+        getSlidingWindowBiggerCondition( s1.signalID, WindowFunction::SLIDING_WINDOW_MAX, 50.0 ).get();
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+
+    uint64_t timestamp = 160000000;
+    uint32_t waitTimeMs = 0;
+    engine.addNewSignal( s1.signalID, timestamp, 10.0 );
+    engine.evaluateConditions( timestamp );
+    ASSERT_EQ( engine.collectNextDataToSend( timestamp, waitTimeMs ), nullptr );
+    engine.addNewSignal( s1.signalID, timestamp + 100, 60.0 );
+    engine.evaluateConditions( timestamp + 100 );
+    ASSERT_NE( engine.collectNextDataToSend( timestamp + 100, waitTimeMs ), nullptr );
+    // The maximum stays in the window for 2 seconds although smaller samples arrive
+    for ( uint64_t time = timestamp + 200; time <= timestamp + 2000; time += 100 )
+    {
+        engine.addNewSignal( s1.signalID, time, 10.0 );
+        engine.evaluateConditions( time );
+        ASSERT_EQ( engine.collectNextDataToSend( time, waitTimeMs ), nullptr );
+    }
+    // Without a new sample the maximum leaves the window and the condition gets false
+    engine.evaluateConditions( timestamp + 2100 );
+    ASSERT_EQ( engine.collectNextDataToSend( timestamp + 2100, waitTimeMs ), nullptr );
+    engine.addNewSignal( s1.signalID, timestamp + 2200, 70.0 );
+    engine.evaluateConditions( timestamp + 2200 );
+    ASSERT_NE( engine.collectNextDataToSend( timestamp + 2200, waitTimeMs ), nullptr );
+}
+
+TEST_F( CollectionInspectionEngineTest, SlidingWindowStddevCondition )
+{
+    CollectionInspectionEngine engine;
+    InspectionMatrixSignalCollectionInfo s1{};
+    s1.signalID = 1234;
+    s1.sampleBufferSize = 50;
+    s1.minimumSampleIntervalMs = 0;
+    s1.fixedWindowPeriod = 1000;
+    addSignalToCollect( collectionSchemes->conditions[0], s1 );
+
+    // function is: SLIDING_WINDOW_STDDEV(SignalID(1234)) > 1.0
+    collectionSchemes->conditions[0].condition =
+        getSlidingWindowBiggerCondition( s1.signalID, WindowFunction::SLIDING_WINDOW_STDDEV, 1.0 ).get();
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+
+    uint64_t timestamp = 160000000;
+    uint32_t waitTimeMs = 0;
+    // No deviation of equal values
+    for ( uint64_t i = 0; i < 3; i++ )
+    {
+        engine.addNewSignal( s1.signalID, timestamp + i * 100, 5.0 );
+        engine.evaluateConditions( timestamp + i * 100 );
+        ASSERT_EQ( engine.collectNextDataToSend( timestamp + i * 100, waitTimeMs ), nullptr );
+    }
+    // 5, 5, 5, 8 has a standard deviation of 1.3
+    engine.addNewSignal( s1.signalID, timestamp + 300, 8.0 );
+    engine.evaluateConditions( timestamp + 300 );
+    ASSERT_NE( engine.collectNextDataToSend( timestamp + 300, waitTimeMs ), nullptr );
+}
+
+TEST_F( CollectionInspectionEngineTest, SlidingWindowRateOfChangeAndCountCondition )
+{
+    CollectionInspectionEngine engine;
+    InspectionMatrixSignalCollectionInfo s1{};
+    s1.signalID = 1234;
+    s1.sampleBufferSize = 50;
+    s1.minimumSampleIntervalMs = 0;
+    s1.fixedWindowPeriod = 2000;
+    addSignalToCollect( collectionSchemes->conditions[0], s1 );
+    addSignalToCollect( collectionSchemes->conditions[1], s1 );
+    collectionSchemes->conditions[0].triggerOnlyOnRisingEdge = true;
+    collectionSchemes->conditions[1].triggerOnlyOnRisingEdge = true;
+
+    // function is: SLIDING_WINDOW_RATE_OF_CHANGE(SignalID(1234)) > 5.0
+    collectionSchemes->conditions[0].condition =
+        getSlidingWindowBiggerCondition( s1.signalID, WindowFunction::SLIDING_WINDOW_RATE_OF_CHANGE, 5.0 ).get();
+    // function is: SLIDING_WINDOW_COUNT(SignalID(1234)) > 3.0
+    collectionSchemes->conditions[1].condition =
+        getSlidingWindowBiggerCondition( s1.signalID, WindowFunction::SLIDING_WINDOW_COUNT, 3.0 ).get();
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+
+    uint64_t timestamp = 160000000;
+    uint32_t waitTimeMs = 0;
+    // 0 per second for one sample, 2 per second, then 5 per second
+    engine.addNewSignal( s1.signalID, timestamp, 0.0 );
+    engine.addNewSignal( s1.signalID, timestamp + 500, 1.0 );
+    engine.addNewSignal( s1.signalID, timestamp + 1000, 5.0 );
+    engine.evaluateConditions( timestamp + 1000 );
+    ASSERT_EQ( engine.collectNextDataToSend( timestamp + 1000, waitTimeMs ), nullptr );
+    // 10 within 1.5 seconds and the fourth sample in the window fulfill both conditions
+    engine.addNewSignal( s1.signalID, timestamp + 1500, 10.0 );
+    engine.evaluateConditions( timestamp + 1500 );
+    ASSERT_NE( engine.collectNextDataToSend( timestamp + 1500, waitTimeMs ), nullptr );
+    ASSERT_NE( engine.collectNextDataToSend( timestamp + 1500, waitTimeMs ), nullptr );
+    ASSERT_EQ( engine.collectNextDataToSend( timestamp + 1500, waitTimeMs ), nullptr );
+}
+
 TEST_F( CollectionInspectionEngineTest, MultiWindowCondition )
 {
     CollectionInspectionEngine engine;
@@ -1507,6 +3384,56 @@ TEST_F( CollectionInspectionEngineTest, TwoSignalsRatioCondition )
     ASSERT_NE( engine.collectNextDataToSend( timestamp, waitTimeMs ), nullptr );
 }
 
+#ifdef FWE_FEATURE_CONDITION_JIT
+TEST_F( CollectionInspectionEngineTest, NativeConditionsMatchInterpreter )
+{
+    if ( !ConditionJit::isSupported() )
+    {
+        GTEST_SKIP() << "No native code generation for this target";
+    }
+    InspectionMatrixSignalCollectionInfo s1{};
+    s1.signalID = 123;
+    s1.sampleBufferSize = 50;
+    s1.minimumSampleIntervalMs = 0;
+    s1.fixedWindowPeriod = 100;
+    InspectionMatrixSignalCollectionInfo s2 = s1;
+    s2.signalID = 456;
+    addSignalToCollect( collectionSchemes->conditions[0], s1 );
+    addSignalToCollect( collectionSchemes->conditions[0], s2 );
+    // function is: !(!(SignalID(123) <= 0.001) && !((SignalID(123) / SignalID(456)) >= 0.5))
+    collectionSchemes->conditions[0].condition =
+        getTwoSignalsRatioCondition( s1.signalID, 0.001, s2.signalID, 0.5 ).get();
+
+    CollectionInspectionEngine nativeEngine;
+    CollectionInspectionEngine interpretingEngine;
+    interpretingEngine.setNativeConditionsEnabled( false );
+    nativeEngine.onChangeInspectionMatrix( consCollectionSchemes );
+    interpretingEngine.onChangeInspectionMatrix( consCollectionSchemes );
+    ASSERT_EQ( nativeEngine.getNativeConditionCount(), collectionSchemes->conditions.size() );
+
+    uint64_t timestamp = 160000000;
+    std::vector<std::pair<double, double>> values{
+        { 1.0, 100.0 }, { 0.001, 100.0 }, { 1.0, 100.0 }, { 50.0, 100.0 }, { 2.0, 0.0 }, { -1.0, -1.0 } };
+    uint32_t triggers = 0;
+    for ( const auto &value : values )
+    {
+        timestamp++;
+        uint32_t waitTimeMs = 0;
+        for ( auto engine : { &nativeEngine, &interpretingEngine } )
+        {
+            engine->addNewSignal( s1.signalID, timestamp, value.first );
+            engine->addNewSignal( s2.signalID, timestamp, value.second );
+            engine->evaluateConditions( timestamp );
+        }
+        bool triggered = nativeEngine.collectNextDataToSend( timestamp, waitTimeMs ) != nullptr;
+        ASSERT_EQ( triggered, interpretingEngine.collectNextDataToSend( timestamp, waitTimeMs ) != nullptr )
+            << value.first << " " << value.second;
+        triggers += triggered ? 1 : 0;
+    }
+    ASSERT_EQ( triggers, 4 );
+}
+#endif // FWE_FEATURE_CONDITION_JIT
+
 TEST_F( CollectionInspectionEngineTest, UnknownExpressionNode )
 {
     CollectionInspectionEngine engine;
@@ -1681,3 +3608,108 @@ TEST_F( CollectionInspectionEngineTest, NoCollectionSchemes )
     engine.onChangeInspectionMatrix( consCollectionSchemes );
     ASSERT_FALSE( engine.evaluateConditions( timestamp ) );
 }
+
+TEST_F( CollectionInspectionEngineTest, ConditionEvaluationInterval )
+{
+    CollectionInspectionEngine engine;
+    InspectionMatrixSignalCollectionInfo s1{};
+    s1.signalID = 1234;
+    s1.sampleBufferSize = 10;
+    s1.minimumSampleIntervalMs = 0;
+    s1.fixedWindowPeriod = 0;
+    addSignalToCollect( collectionSchemes->conditions[0], s1 );
+    collectionSchemes->conditions[0].condition = getTwoSignalsBiggerCondition( 1234, 1.0, 1234, 1.0 ).get();
+    collectionSchemes->conditions[0].minimumPublishInterval = 0;
+    collectionSchemes->conditions[0].evaluationIntervalMs = 100;
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+
+    uint64_t timestamp = 160000000;
+    engine.addNewSignal( s1.signalID, timestamp, 0 );
+    ASSERT_FALSE( engine.evaluateConditions( timestamp ) );
+
+    // The input change is kept until the interval passed
+    engine.addNewSignal( s1.signalID, timestamp + 10, 5 );
+    ASSERT_FALSE( engine.evaluateConditions( timestamp + 10 ) );
+    ASSERT_EQ( engine.getNextEvaluationTime( timestamp + 10 ), timestamp + 100 );
+    uint32_t waitTimeMs = 0;
+    ASSERT_EQ( engine.collectNextDataToSend( timestamp + 10, waitTimeMs ), nullptr );
+
+    ASSERT_TRUE( engine.evaluateConditions( timestamp + 100 ) );
+    auto collectedData = engine.collectNextDataToSend( timestamp + 100, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+    ASSERT_EQ( collectedData->signals.size(), 2 );
+}
+
+TEST_F( CollectionInspectionEngineTest, ConditionEvaluationBudget )
+{
+    ASSERT_EQ( CollectionInspectionEngine::getDeferredEvaluationPasses( 5000000, 0 ), 0 );
+    ASSERT_EQ( CollectionInspectionEngine::getDeferredEvaluationPasses( 999, 1 ), 0 );
+    ASSERT_EQ( CollectionInspectionEngine::getDeferredEvaluationPasses( 1000, 1 ), 1 );
+    // An evaluation that took four times the budget skips the next four passes
+    ASSERT_EQ( CollectionInspectionEngine::getDeferredEvaluationPasses( 400000, 100 ), 4 );
+
+    // A budget that is never exceeded does not change the evaluation
+    CollectionInspectionEngine engine;
+    collectionSchemes->conditions[0].condition = getAlwaysTrueCondition().get();
+    collectionSchemes->conditions[0].minimumPublishInterval = 0;
+    collectionSchemes->conditions[0].evaluationBudgetUs = 1000000;
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+    ASSERT_TRUE( engine.evaluateConditions( 160000000 ) );
+    uint32_t waitTimeMs = 0;
+    ASSERT_NE( engine.collectNextDataToSend( 160000000, waitTimeMs ), nullptr );
+}
+
+TEST_F( CollectionInspectionEngineTest, CollectAcrossRingBufferWrapAndChunks )
+{
+    CollectionInspectionEngine engine;
+    // Not a multiple of the chunk size, so that the last chunk is only used partially
+    InspectionMatrixSignalCollectionInfo s1{};
+    s1.signalID = 1234;
+    s1.sampleBufferSize = 100;
+    s1.minimumSampleIntervalMs = 0;
+    s1.fixedWindowPeriod = 0;
+    addSignalToCollect( collectionSchemes->conditions[0], s1 );
+    InspectionMatrixCanFrameCollectionInfo c1{};
+    c1.frameID = 0x380;
+    c1.channelID = 3;
+    c1.sampleBufferSize = 10;
+    c1.minimumSampleIntervalMs = 0;
+    collectionSchemes->conditions[0].canFrames.push_back( c1 );
+    collectionSchemes->conditions[0].condition = getAlwaysTrueCondition().get();
+    collectionSchemes->conditions[0].minimumPublishInterval = 0;
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+
+    uint64_t timestamp = 160000000;
+    uint32_t sampleCount = 0;
+    auto addSamples = [&]( uint32_t count ) {
+        for ( uint32_t i = 0; i < count; i++ )
+        {
+            engine.addNewSignal( s1.signalID, timestamp + sampleCount, sampleCount );
+            std::array<uint8_t, 8> buf{ static_cast<uint8_t>( sampleCount ) };
+            engine.addNewRawCanFrame( c1.frameID, c1.channelID, timestamp + sampleCount, buf, sizeof( buf ) );
+            sampleCount++;
+        }
+    };
+    uint32_t waitTimeMs = 0;
+    for ( uint32_t newSamples : { 250U, 30U, 170U } )
+    {
+        addSamples( newSamples );
+        auto now = timestamp + sampleCount;
+        ASSERT_TRUE( engine.evaluateConditions( now ) );
+        auto collectedData = engine.collectNextDataToSend( now, waitTimeMs );
+        ASSERT_NE( collectedData, nullptr );
+        // Only the samples not collected before, newest first
+        ASSERT_EQ( collectedData->signals.size(), std::min( newSamples, 100U ) );
+        for ( uint32_t i = 0; i < collectedData->signals.size(); i++ )
+        {
+            ASSERT_EQ( collectedData->signals[i].receiveTime, now - 1 - i );
+            ASSERT_DOUBLE_EQ( collectedData->signals[i].value, sampleCount - 1 - i );
+        }
+        ASSERT_EQ( collectedData->canFrames.size(), std::min( newSamples, 10U ) );
+        for ( uint32_t i = 0; i < collectedData->canFrames.size(); i++ )
+        {
+            ASSERT_EQ( collectedData->canFrames[i].receiveTime, now - 1 - i );
+            ASSERT_EQ( collectedData->canFrames[i].data[0], static_cast<uint8_t>( sampleCount - 1 - i ) );
+        }
+    }
+}
@@ -0,0 +1,197 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+
+#include "CollectionInspectionRouter.h"
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace Aws::IoTFleetWise::DataInspection;
+using namespace Aws::IoTFleetWise::DataManagement;
+
+class CollectionInspectionRouterTest : public ::testing::Test
+{
+protected:
+    std::shared_ptr<InspectionMatrix> collectionSchemes;
+    SignalBufferPtr signalBufferPtr;
+    CANBufferPtr canRawBufferPtr;
+    ActiveDTCBufferPtr activeDTCBufferPtr;
+    std::shared_ptr<const Clock> fClock = ClockHandler::getClock();
+    std::shared_ptr<CollectedDataReadyToPublish> outputCollectedData;
+
+    // Adds a condition that collects the signal, buildExpressions adds its expression signalID > 1
+    void
+    addSignalBiggerCondition( SignalID signalID )
+    {
+        ConditionWithCollectedData condition{};
+        condition.probabilityToSend = 1.0;
+        condition.triggerOnlyOnRisingEdge = true;
+        InspectionMatrixSignalCollectionInfo s{};
+        s.signalID = signalID;
+        s.sampleBufferSize = 10;
+        condition.signals.push_back( s );
+        collectionSchemes->conditions.push_back( condition );
+    }
+
+    // Builds the expression nodes of all conditions added by addSignalBiggerCondition
+    void
+    buildExpressions()
+    {
+        auto &nodes = collectionSchemes->expressionNodeStorage;
+        nodes.resize( collectionSchemes->conditions.size() * 3 );
+        for ( size_t i = 0; i < collectionSchemes->conditions.size(); i++ )
+        {
+            auto &condition = collectionSchemes->conditions[i];
+            auto *bigger = &nodes[i * 3];
+            auto *signal = &nodes[( i * 3 ) + 1];
+            auto *value = &nodes[( i * 3 ) + 2];
+            bigger->nodeType = ExpressionNodeType::OPERATOR_BIGGER;
+            bigger->left = signal;
+            bigger->right = value;
+            signal->nodeType = ExpressionNodeType::SIGNAL;
+            signal->signalID = condition.signals[0].signalID;
+            value->nodeType = ExpressionNodeType::FLOAT;
+            value->floatingValue = 1.0;
+            condition.condition = bigger;
+        }
+    }
+
+    void
+    SetUp() override
+    {
+        collectionSchemes = std::make_shared<InspectionMatrix>();
+        signalBufferPtr.reset( new SignalBuffer( 1000 ) );
+        canRawBufferPtr.reset( new CANBuffer( 1000 ) );
+        activeDTCBufferPtr.reset( new ActiveDTCBuffer( 10 ) );
+        outputCollectedData = std::make_shared<CollectedDataReadyToPublish>( 10 );
+    }
+
+    std::vector<SignalID>
+    getCollectedSignalIDs()
+    {
+        std::vector<SignalID> ids;
+        std::shared_ptr<const TriggeredCollectionSchemeData> collectedData;
+        while ( outputCollectedData->pop( collectedData ) )
+        {
+            for ( const auto &signal : collectedData->signals )
+            {
+                ids.push_back( signal.signalID );
+            }
+        }
+        std::sort( ids.begin(), ids.end() );
+        return ids;
+    }
+};
+
+TEST_F( CollectionInspectionRouterTest, PartitionKeepsConditionsOnSameSignalsTogether )
+{
+    addSignalBiggerCondition( 1 );
+    addSignalBiggerCondition( 2 );
+    addSignalBiggerCondition( 1 );
+    addSignalBiggerCondition( 2 );
+    buildExpressions();
+    auto partitions = CollectionInspectionRouter::partitionInspectionMatrix( collectionSchemes, 2 );
+    ASSERT_EQ( partitions.size(), 2 );
+    ASSERT_EQ( partitions[0]->conditions.size(), 2 );
+    ASSERT_EQ( partitions[1]->conditions.size(), 2 );
+    for ( const auto &condition : partitions[0]->conditions )
+    {
+        EXPECT_EQ( condition.signals[0].signalID, 1 );
+    }
+    for ( const auto &condition : partitions[1]->conditions )
+    {
+        EXPECT_EQ( condition.signals[0].signalID, 2 );
+    }
+}
+
+TEST_F( CollectionInspectionRouterTest, PartitionBalancesConditionsOnSameSignal )
+{
+    for ( int i = 0; i < 5; i++ )
+    {
+        addSignalBiggerCondition( 1 );
+    }
+    buildExpressions();
+    auto partitions = CollectionInspectionRouter::partitionInspectionMatrix( collectionSchemes, 3 );
+    ASSERT_EQ( partitions.size(), 3 );
+    EXPECT_EQ( partitions[0]->conditions.size(), 2 );
+    EXPECT_EQ( partitions[1]->conditions.size(), 2 );
+    EXPECT_EQ( partitions[2]->conditions.size(), 1 );
+    EXPECT_EQ( CollectionInspectionRouter::partitionInspectionMatrix( nullptr, 3 )[0], nullptr );
+}
+
+TEST_F( CollectionInspectionRouterTest, PartitionKeepsExpressionNodesAlive )
+{
+    addSignalBiggerCondition( 1 );
+    buildExpressions();
+    auto partitions = CollectionInspectionRouter::partitionInspectionMatrix( collectionSchemes, 2 );
+    const auto *condition = collectionSchemes->conditions[0].condition;
+    collectionSchemes.reset();
+    ASSERT_EQ( partitions[0]->conditions.size(), 1 );
+    EXPECT_EQ( partitions[0]->conditions[0].condition, condition );
+    EXPECT_EQ( partitions[0]->conditions[0].condition->left->signalID, 1 );
+}
+
+TEST_F( CollectionInspectionRouterTest, RouteSignalsToPartitions )
+{
+    CollectionInspectionRouter router;
+    ASSERT_FALSE(
+        router.init( signalBufferPtr, canRawBufferPtr, activeDTCBufferPtr, outputCollectedData, 1000, false, 0, 100 ) );
+    ASSERT_TRUE(
+        router.init( signalBufferPtr, canRawBufferPtr, activeDTCBufferPtr, outputCollectedData, 1000, false, 3, 100 ) );
+    ASSERT_TRUE( router.start() );
+    ASSERT_TRUE( router.isAlive() );
+    addSignalBiggerCondition( 1 );
+    addSignalBiggerCondition( 2 );
+    addSignalBiggerCondition( 3 );
+    buildExpressions();
+    router.onChangeInspectionMatrix( collectionSchemes );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+
+    Timestamp timestamp = fClock->timeSinceEpochMs();
+    signalBufferPtr->push( CollectedSignal( 1, timestamp, 0.5 ) );
+    signalBufferPtr->push( CollectedSignal( 2, timestamp, 0.5 ) );
+    signalBufferPtr->push( CollectedSignal( 3, timestamp, 0.5 ) );
+    // Not used by any condition
+    signalBufferPtr->push( CollectedSignal( 4, timestamp, 5.0 ) );
+    signalBufferPtr->push( CollectedSignal( 1, timestamp + 1, 5.0 ) );
+    signalBufferPtr->push( CollectedSignal( 3, timestamp + 1, 5.0 ) );
+    router.onNewDataAvailable();
+    std::this_thread::sleep_for( std::chrono::milliseconds( 500 ) );
+
+    // Conditions on signal 1 and 3 triggered in different partitions, each collected both samples of its signal
+    ASSERT_EQ( getCollectedSignalIDs(), std::vector<SignalID>( { 1, 1, 3, 3 } ) );
+    ASSERT_TRUE( router.stop() );
+}
+
+TEST_F( CollectionInspectionRouterTest, SinglePartitionUsesInputQueuesDirectly )
+{
+    CollectionInspectionRouter router;
+    ASSERT_TRUE(
+        router.init( signalBufferPtr, canRawBufferPtr, activeDTCBufferPtr, outputCollectedData, 1000, false, 1, 100 ) );
+    ASSERT_TRUE( router.start() );
+    addSignalBiggerCondition( 1 );
+    addSignalBiggerCondition( 2 );
+    buildExpressions();
+    router.onChangeInspectionMatrix( collectionSchemes );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+
+    Timestamp timestamp = fClock->timeSinceEpochMs();
+    signalBufferPtr->push( CollectedSignal( 2, timestamp, 0.5 ) );
+    signalBufferPtr->push( CollectedSignal( 2, timestamp + 1, 5.0 ) );
+    router.getDataAvailableSignal()->notify();
+    std::this_thread::sleep_for( std::chrono::milliseconds( 500 ) );
+
+    ASSERT_EQ( getCollectedSignalIDs(), std::vector<SignalID>( { 2, 2 } ) );
+    ASSERT_TRUE( router.stop() );
+}
@@ -12,6 +12,7 @@
  */
 
 #include "CollectionInspectionWorkerThread.h"
+#include <algorithm>
 #include <cstring>
 #include <gtest/gtest.h>
 #include <random>
@@ -147,9 +148,10 @@ TEST_F( CollectionInspectionWorkerThreadTest, CollectBurstWithoutSubsampling )
 
     ASSERT_EQ( collectedData->canFrames.size(), 3 );
 
-    EXPECT_EQ( collectedData->canFrames[0].data, buf3 );
-    EXPECT_EQ( collectedData->canFrames[1].data, buf2 );
-    EXPECT_EQ( collectedData->canFrames[2].data, buf1 );
+    ASSERT_EQ( collectedData->canFrames[0].size, sizeof( buf3 ) );
+    EXPECT_TRUE( std::equal( buf3.begin(), buf3.end(), collectedData->canFrames[0].data.begin() ) );
+    EXPECT_TRUE( std::equal( buf2.begin(), buf2.end(), collectedData->canFrames[1].data.begin() ) );
+    EXPECT_TRUE( std::equal( buf1.begin(), buf1.end(), collectedData->canFrames[2].data.begin() ) );
 
     ASSERT_FALSE( outputCollectedData->pop( collectedData ) );
 
@@ -160,6 +162,87 @@ TEST_F( CollectionInspectionWorkerThreadTest, CollectBurstWithoutSubsampling )
     worker.stop();
 }
 
+TEST_F( CollectionInspectionWorkerThreadTest, CollectSignalsQueuedWithRawFrame )
+{
+    CollectionInspectionWorkerThread worker;
+    ASSERT_TRUE( worker.init( signalBufferPtr, canRawBufferPtr, activeDTCBufferPtr, outputCollectedData, 1000 ) );
+    ASSERT_TRUE( worker.start() );
+    InspectionMatrixSignalCollectionInfo s1{};
+    s1.signalID = 1234;
+    s1.sampleBufferSize = 50;
+    s1.minimumSampleIntervalMs = 0;
+    s1.fixedWindowPeriod = 77777;
+    s1.isConditionOnlySignal = false;
+    InspectionMatrixCanFrameCollectionInfo c1;
+    c1.frameID = 0x380;
+    c1.channelID = 3;
+    c1.sampleBufferSize = 10;
+    c1.minimumSampleIntervalMs = 0;
+    collectionSchemes->conditions[0].canFrames.push_back( c1 );
+    collectionSchemes->conditions[0].triggerOnlyOnRisingEdge = false;
+    collectionSchemes->conditions[0].signals.push_back( s1 );
+    collectionSchemes->conditions[0].condition = getSignalsBiggerCondition( s1.signalID, 1 ).get();
+    worker.onChangeInspectionMatrix( consCollectionSchemes );
+    Timestamp timestamp = fClock->timeSinceEpochMs();
+    // A RAW_AND_DECODE frame carries the signals decoded from it
+    std::array<uint8_t, MAX_CAN_FRAME_BYTE_SIZE> buf1 = { 0xDE, 0xAD, 0xBE, 0xEF, 0x0, 0x0, 0x0, 0x0 };
+    CollectedCanFrameWithSignals frame(
+        CollectedCanRawFrame( c1.frameID, c1.channelID, timestamp, buf1, sizeof( buf1 ) ) );
+    frame.decodedSignals[0].signalID = s1.signalID;
+    frame.decodedSignals[0].value = 1.5;
+    frame.decodedSignalCount = 1;
+    canRawBufferPtr->push( frame );
+
+    worker.onNewDataAvailable();
+
+    std::this_thread::sleep_for( std::chrono::milliseconds( 1000 ) );
+
+    std::shared_ptr<const TriggeredCollectionSchemeData> collectedData;
+    ASSERT_TRUE( outputCollectedData->pop( collectedData ) );
+    ASSERT_EQ( collectedData->signals.size(), 1 );
+    EXPECT_EQ( collectedData->signals[0].value, 1.5 );
+    EXPECT_EQ( collectedData->signals[0].receiveTime, timestamp );
+    ASSERT_EQ( collectedData->canFrames.size(), 1 );
+    EXPECT_TRUE( std::equal( buf1.begin(), buf1.end(), collectedData->canFrames[0].data.begin() ) );
+
+    worker.stop();
+}
+
+TEST_F( CollectionInspectionWorkerThreadTest, ConsumeMoreThanOneDrainBatch )
+{
+    CollectionInspectionWorkerThread worker;
+    ASSERT_TRUE( worker.init( signalBufferPtr, canRawBufferPtr, activeDTCBufferPtr, outputCollectedData, 1000 ) );
+    ASSERT_TRUE( worker.start() );
+    InspectionMatrixSignalCollectionInfo s1{};
+    s1.signalID = 1234;
+    s1.sampleBufferSize = 1000;
+    s1.minimumSampleIntervalMs = 0;
+    s1.fixedWindowPeriod = 77777;
+    s1.isConditionOnlySignal = false;
+    collectionSchemes->conditions[0].triggerOnlyOnRisingEdge = true;
+    collectionSchemes->conditions[0].signals.push_back( s1 );
+    collectionSchemes->conditions[0].condition = getSignalsBiggerCondition( s1.signalID, 1 ).get();
+    worker.onChangeInspectionMatrix( consCollectionSchemes );
+    Timestamp timestamp = fClock->timeSinceEpochMs();
+    const size_t signalCount = ( CollectionInspectionWorkerThread::MAX_DRAIN_BATCH_SIZE * 2 ) + 10;
+    for ( size_t i = 0; i < signalCount - 1; i++ )
+    {
+        ASSERT_TRUE( signalBufferPtr->push( CollectedSignal( s1.signalID, timestamp, 0.1 ) ) );
+    }
+    ASSERT_TRUE( signalBufferPtr->push( CollectedSignal( s1.signalID, timestamp, 1.5 ) ) );
+    worker.onNewDataAvailable();
+
+    std::this_thread::sleep_for( std::chrono::milliseconds( 500 ) );
+
+    std::shared_ptr<const TriggeredCollectionSchemeData> collectedData;
+    ASSERT_TRUE( outputCollectedData->pop( collectedData ) );
+    ASSERT_EQ( collectedData->signals.size(), signalCount );
+    EXPECT_EQ( collectedData->signals[0].value, 1.5 );
+    ASSERT_FALSE( outputCollectedData->pop( collectedData ) );
+
+    worker.stop();
+}
+
 TEST_F( CollectionInspectionWorkerThreadTest, CollectionQueueFull )
 {
     CollectionInspectionWorkerThread worker;
@@ -195,6 +278,52 @@ TEST_F( CollectionInspectionWorkerThreadTest, CollectionQueueFull )
     worker.stop();
 }
 
+TEST_F( CollectionInspectionWorkerThreadTest, ExpressDataBypassesOutputQueue )
+{
+    CollectionInspectionWorkerThread worker;
+    auto expressCollectedData = std::make_shared<ExpressCollectedData>( 1 );
+    worker.setExpressOutput( expressCollectedData );
+    ASSERT_TRUE( worker.init( signalBufferPtr, canRawBufferPtr, activeDTCBufferPtr, outputCollectedData, 1000 ) );
+    ASSERT_TRUE( worker.start() );
+    InspectionMatrixSignalCollectionInfo s1{};
+    s1.signalID = 1234;
+    s1.sampleBufferSize = 50;
+    s1.minimumSampleIntervalMs = 0;
+    s1.fixedWindowPeriod = 77777;
+    s1.isConditionOnlySignal = false;
+    for ( size_t i = 0; i < 3; i++ )
+    {
+        collectionSchemes->conditions[i].signals.push_back( s1 );
+        collectionSchemes->conditions[i].condition = getAlwaysTrueCondition().get();
+        collectionSchemes->conditions[i].probabilityToSend = 1.0;
+        // Triggered once
+        collectionSchemes->conditions[i].minimumPublishInterval = 100000;
+        collectionSchemes->conditions[i].metaData.collectionSchemeID = std::to_string( i );
+    }
+    collectionSchemes->conditions[0].metaData.express = true;
+    collectionSchemes->conditions[2].metaData.express = true;
+    auto expressQueueFull = TraceModule::get().getAtomicVariable( TraceAtomicVariable::EXPRESS_QUEUE_FULL );
+    worker.onChangeInspectionMatrix( consCollectionSchemes );
+    Timestamp timestamp = fClock->timeSinceEpochMs();
+    signalBufferPtr->push( CollectedSignal( s1.signalID, timestamp, 1 ) );
+    worker.onNewDataAvailable();
+    std::this_thread::sleep_for( std::chrono::milliseconds( 100 ) );
+
+    // The first express data is taken by the express queue, the second goes the normal way as the queue is full
+    std::shared_ptr<const TriggeredCollectionSchemeData> collectedData;
+    ASSERT_EQ( expressCollectedData->size(), 1 );
+    ASSERT_TRUE( expressCollectedData->pop( collectedData, 0 ) );
+    ASSERT_EQ( collectedData->metaData.collectionSchemeID, "0" );
+    ASSERT_TRUE( outputCollectedData->pop( collectedData ) );
+    ASSERT_EQ( collectedData->metaData.collectionSchemeID, "1" );
+    ASSERT_TRUE( outputCollectedData->pop( collectedData ) );
+    ASSERT_EQ( collectedData->metaData.collectionSchemeID, "2" );
+    ASSERT_FALSE( outputCollectedData->pop( collectedData ) );
+    ASSERT_EQ( TraceModule::get().getAtomicVariable( TraceAtomicVariable::EXPRESS_QUEUE_FULL ), expressQueueFull + 1 );
+
+    worker.stop();
+}
+
 TEST_F( CollectionInspectionWorkerThreadTest, ConsumeDataWithoutNotify )
 {
     CollectionInspectionWorkerThread worker;
@@ -367,3 +496,67 @@ TEST_F( CollectionInspectionWorkerThreadTest, StartWithoutInit )
     CollectionInspectionWorkerThread worker;
     worker.onChangeInspectionMatrix( consCollectionSchemes );
 }
+
+TEST_F( CollectionInspectionWorkerThreadTest, RunToCompletionCycles )
+{
+    CollectionInspectionWorkerThread worker;
+    uint32_t wakeups = 0;
+    worker.setRunToCompletion( [&wakeups]() { wakeups++; } );
+    ASSERT_TRUE( worker.init( signalBufferPtr, canRawBufferPtr, activeDTCBufferPtr, outputCollectedData, 1000 ) );
+    // No own thread is started
+    ASSERT_TRUE( worker.start() );
+    ASSERT_TRUE( worker.isAlive() );
+    // Without an inspection matrix the input is dropped
+    ASSERT_FALSE( worker.beginCycle() );
+    CollectedSignal dropped( 1234, fClock->timeSinceEpochMs(), 5.0 );
+    worker.addSignals( &dropped, 1 );
+    ASSERT_EQ( worker.endCycle(), 1000 );
+
+    InspectionMatrixSignalCollectionInfo s1{};
+    s1.signalID = 1234;
+    s1.sampleBufferSize = 50;
+    s1.minimumSampleIntervalMs = 0;
+    s1.fixedWindowPeriod = 77777;
+    s1.isConditionOnlySignal = false;
+    InspectionMatrixCanFrameCollectionInfo c1;
+    c1.frameID = 0x380;
+    c1.channelID = 3;
+    c1.sampleBufferSize = 10;
+    c1.minimumSampleIntervalMs = 0;
+    collectionSchemes->conditions[0].canFrames.push_back( c1 );
+    collectionSchemes->conditions[0].triggerOnlyOnRisingEdge = true;
+    collectionSchemes->conditions[0].signals.push_back( s1 );
+    collectionSchemes->conditions[0].condition = getSignalsBiggerCondition( s1.signalID, 1 ).get();
+    worker.onChangeInspectionMatrix( consCollectionSchemes );
+    ASSERT_EQ( wakeups, 1 );
+
+    // The decoded input is handed over directly
+    ASSERT_TRUE( worker.beginCycle() );
+    Timestamp timestamp = fClock->timeSinceEpochMs();
+    std::vector<CollectedSignal> signals{ CollectedSignal( s1.signalID, timestamp, 0.1 ),
+                                          CollectedSignal( s1.signalID, timestamp, 0.2 ) };
+    worker.addSignals( signals.data(), signals.size() );
+    std::array<uint8_t, MAX_CAN_FRAME_BYTE_SIZE> buf = { 0xDE, 0xAD, 0xBE, 0xEF, 0x0, 0x0, 0x0, 0x0 };
+    CollectedCanFrameWithSignals frame( CollectedCanRawFrame( c1.frameID, c1.channelID, timestamp, buf, 8 ) );
+    worker.addRawFrames( &frame, 1 );
+    // Other data sources still push to the input queues
+    signalBufferPtr->push( CollectedSignal( s1.signalID, timestamp, 1.5 ) );
+    worker.onNewDataAvailable();
+    ASSERT_EQ( wakeups, 2 );
+    worker.endCycle();
+
+    // The conditions are evaluated at most once per minimum spacing
+    std::shared_ptr<const TriggeredCollectionSchemeData> collectedData;
+    for ( int i = 0; ( i < 100 ) && ( !outputCollectedData->pop( collectedData ) ); i++ )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+        ASSERT_TRUE( worker.beginCycle() );
+        worker.endCycle();
+    }
+    ASSERT_NE( collectedData, nullptr );
+    ASSERT_EQ( collectedData->signals.size(), 3 );
+    ASSERT_EQ( collectedData->canFrames.size(), 1 );
+    ASSERT_EQ( collectedData->canFrames[0].data[0], 0xDE );
+    ASSERT_TRUE( worker.stop() );
+    ASSERT_FALSE( worker.isAlive() );
+}
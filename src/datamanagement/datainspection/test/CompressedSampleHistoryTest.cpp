@@ -0,0 +1,116 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "CompressedSampleHistory.h"
+#include <cmath>
+#include <gtest/gtest.h>
+#include <limits>
+
+using namespace Aws::IoTFleetWise::DataInspection;
+
+TEST( CompressedSampleHistoryTest, InvalidParameters )
+{
+    CompressedSampleHistory history;
+    ASSERT_FALSE( history.init( 0 ) );
+    history.push( 1000, 1.0, 0 );
+    EXPECT_EQ( history.size(), 0 );
+    std::vector<CollectedSignal> output;
+    history.collectNewest( 1, 10, output );
+    EXPECT_TRUE( output.empty() );
+}
+
+TEST( CompressedSampleHistoryTest, ReadNewestFirstAcrossBlocks )
+{
+    CompressedSampleHistory history;
+    ASSERT_TRUE( history.init( 1000 ) );
+    EXPECT_EQ( history.getCapacity(), 1000 );
+    // Irregular times and values that need every size of delta of delta and XOR window
+    std::vector<uint64_t> timestamps;
+    std::vector<double> values;
+    std::vector<TimestampFractionUs> fractions;
+    uint64_t timestamp = 1600000000000;
+    for ( uint32_t i = 0; i < CompressedSampleHistory::BLOCK_SAMPLES * 2 + 10; i++ )
+    {
+        timestamp += ( i % 7 == 0 ) ? ( i * 1000 ) : 10;
+        timestamps.push_back( timestamp );
+        fractions.push_back( static_cast<TimestampFractionUs>( ( i * 37 ) % 1000 ) );
+        values.push_back( ( ( i % 5 == 0 ) && ( i > 0 ) ) ? values.back() : std::sin( i ) * i );
+    }
+    values[100] = std::numeric_limits<double>::quiet_NaN();
+    values[101] = -std::numeric_limits<double>::infinity();
+    values[102] = std::numeric_limits<double>::max();
+    for ( size_t i = 0; i < timestamps.size(); i++ )
+    {
+        history.push( timestamps[i], values[i], fractions[i] );
+    }
+    ASSERT_EQ( history.size(), timestamps.size() );
+    std::vector<CollectedSignal> output;
+    history.collectNewest( 5, history.size(), output );
+    ASSERT_EQ( output.size(), timestamps.size() );
+    for ( size_t index = 0; index < output.size(); index++ )
+    {
+        auto i = timestamps.size() - 1 - index;
+        ASSERT_EQ( output[index].signalID, 5 );
+        ASSERT_EQ( output[index].receiveTime, timestamps[i] );
+        ASSERT_EQ( output[index].receiveTimeFractionUs, fractions[i] );
+        if ( std::isnan( values[i] ) )
+        {
+            ASSERT_TRUE( std::isnan( output[index].value ) );
+        }
+        else
+        {
+            ASSERT_EQ( output[index].value, values[i] );
+        }
+    }
+
+    // Only the newest ones are decompressed, appended behind existing samples
+    output.resize( 1 );
+    history.collectNewest( 5, 3, output );
+    ASSERT_EQ( output.size(), 4 );
+    ASSERT_EQ( output[1].receiveTime, timestamps.back() );
+    ASSERT_EQ( output[3].receiveTime, timestamps[timestamps.size() - 3] );
+}
+
+TEST( CompressedSampleHistoryTest, OldestBlocksDropped )
+{
+    CompressedSampleHistory history;
+    ASSERT_TRUE( history.init( CompressedSampleHistory::BLOCK_SAMPLES + 1 ) );
+    uint32_t pushed = CompressedSampleHistory::BLOCK_SAMPLES * 5 + 3;
+    for ( uint32_t i = 0; i < pushed; i++ )
+    {
+        history.push( i, i, 0 );
+    }
+    ASSERT_EQ( history.size(), CompressedSampleHistory::BLOCK_SAMPLES + 1 );
+    std::vector<CollectedSignal> output;
+    history.collectNewest( 1, pushed, output );
+    ASSERT_EQ( output.size(), CompressedSampleHistory::BLOCK_SAMPLES + 1 );
+    for ( uint32_t index = 0; index < output.size(); index++ )
+    {
+        ASSERT_EQ( output[index].receiveTime, pushed - 1 - index );
+        ASSERT_DOUBLE_EQ( output[index].value, pushed - 1 - index );
+    }
+}
+
+TEST( CompressedSampleHistoryTest, FixedRateSamplesCompressed )
+{
+    CompressedSampleHistory history;
+    uint32_t samples = CompressedSampleHistory::BLOCK_SAMPLES * 40;
+    ASSERT_TRUE( history.init( samples ) );
+    for ( uint32_t i = 0; i < samples; i++ )
+    {
+        // 100 Hz with a value that rarely changes
+        history.push( 1600000000000 + i * 10, 20.0 + ( i / 100 ), 0 );
+    }
+    // Uncompressed a sample has a timestamp, a value and the fraction
+    EXPECT_LT( history.getCompressedBytes() * 10, samples * ( sizeof( uint64_t ) + sizeof( double ) ) );
+}
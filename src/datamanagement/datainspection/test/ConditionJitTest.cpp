@@ -0,0 +1,276 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "ConditionJit.h"
+#include <array>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <limits>
+#include <vector>
+
+using namespace Aws::IoTFleetWise::DataInspection;
+
+namespace
+{
+using Operation = ConditionJit::Operation;
+using Type = ConditionJit::Operation::Type;
+
+// A leaf is a double the test changes between the calls
+struct LeafContext
+{
+    uint32_t calls{ 0 };
+    const double *failingLeaf{ nullptr }; /**< fails with error 7 */
+};
+
+uint32_t
+readLeaf( void *context, const void *leaf, ConditionJit::Slot *slot )
+{
+    auto leafContext = static_cast<LeafContext *>( context );
+    leafContext->calls++;
+    if ( leaf == leafContext->failingLeaf )
+    {
+        return 7;
+    }
+    auto value = *static_cast<const double *>( leaf );
+    slot->mDouble = value;
+    slot->mBool = value != 0.0;
+    return 0;
+}
+
+Operation
+constant( double value, bool boolValue = false )
+{
+    Operation operation;
+    operation.type = Type::CONSTANT;
+    operation.value = value;
+    operation.boolValue = boolValue;
+    return operation;
+}
+
+Operation
+leaf( const double *value )
+{
+    Operation operation;
+    operation.type = Type::LEAF;
+    operation.leaf = value;
+    return operation;
+}
+
+Operation
+op( Type type, uint32_t target = 0 )
+{
+    Operation operation;
+    operation.type = type;
+    operation.target = target;
+    return operation;
+}
+
+// Compiles a single program and runs it
+class ConditionJitTest : public ::testing::Test
+{
+protected:
+    void
+    SetUp() override
+    {
+        if ( !ConditionJit::isSupported() )
+        {
+            GTEST_SKIP() << "No native code generation for this target";
+        }
+    }
+
+    ConditionJit::Function
+    compile( const std::vector<Operation> &program )
+    {
+        auto handle = mJit.add( program, mStack.size() );
+        if ( ( handle == ConditionJit::INVALID_HANDLE ) || ( !mJit.finalize() ) )
+        {
+            return nullptr;
+        }
+        return mJit.getFunction( handle );
+    }
+
+    uint32_t
+    run( ConditionJit::Function function )
+    {
+        return function( &mContext, mStack.data() );
+    }
+
+    ConditionJit mJit{ readLeaf, 0.001 };
+    LeafContext mContext;
+    std::array<ConditionJit::Slot, 10> mStack{};
+};
+} // namespace
+
+TEST_F( ConditionJitTest, Comparisons )
+{
+    double left = 0;
+    double right = 0;
+    std::vector<Type> types{ Type::SMALLER, Type::BIGGER, Type::SMALLER_EQUAL, Type::BIGGER_EQUAL, Type::EQUAL };
+    std::vector<ConditionJit::Function> functions;
+    std::vector<uint32_t> handles;
+    for ( auto type : types )
+    {
+        handles.push_back( mJit.add( { leaf( &left ), leaf( &right ), op( type ) }, mStack.size() ) );
+        ASSERT_NE( handles.back(), ConditionJit::INVALID_HANDLE );
+    }
+    ASSERT_TRUE( mJit.finalize() );
+    for ( auto handle : handles )
+    {
+        functions.push_back( mJit.getFunction( handle ) );
+        ASSERT_NE( functions.back(), nullptr );
+    }
+    std::vector<std::pair<double, double>> operands{
+        { 1, 2 }, { 2, 1 }, { 2, 2 }, { 2, 2.0005 }, { -3, 5 }, { std::numeric_limits<double>::quiet_NaN(), 1 } };
+    for ( const auto &operand : operands )
+    {
+        left = operand.first;
+        right = operand.second;
+        std::vector<bool> expected{ left < right,
+                                    left > right,
+                                    left <= right,
+                                    left >= right,
+                                    std::abs( left - right ) < 0.001 };
+        for ( size_t i = 0; i < functions.size(); i++ )
+        {
+            mStack[0].mDouble = 42.0;
+            ASSERT_EQ( run( functions[i] ), 0 );
+            ASSERT_EQ( mStack[0].mBool, expected[i] ) << i << " " << left << " " << right;
+            ASSERT_EQ( mStack[0].mDouble, 0.0 );
+        }
+    }
+}
+
+TEST_F( ConditionJitTest, Arithmetic )
+{
+    double a = 6;
+    double b = 4;
+    // ( a + b ) * ( a - b ) / b > 4
+    auto function = compile( { leaf( &a ),
+                               leaf( &b ),
+                               op( Type::PLUS ),
+                               leaf( &a ),
+                               leaf( &b ),
+                               op( Type::MINUS ),
+                               op( Type::MULTIPLY ),
+                               leaf( &b ),
+                               op( Type::DIVIDE ),
+                               constant( 4 ),
+                               op( Type::BIGGER ) } );
+    ASSERT_NE( function, nullptr );
+    ASSERT_EQ( run( function ), 0 );
+    ASSERT_TRUE( mStack[0].mBool );
+    b = 5;
+    ASSERT_EQ( run( function ), 0 );
+    ASSERT_FALSE( mStack[0].mBool );
+    ASSERT_EQ( mContext.calls, 10 );
+}
+
+TEST_F( ConditionJitTest, ArithmeticResult )
+{
+    double a = 6;
+    auto function = compile( { leaf( &a ), constant( 1.5 ), op( Type::MULTIPLY ) } );
+    ASSERT_NE( function, nullptr );
+    mStack[0].mBool = true;
+    ASSERT_EQ( run( function ), 0 );
+    ASSERT_DOUBLE_EQ( mStack[0].mDouble, 9.0 );
+    ASSERT_FALSE( mStack[0].mBool );
+}
+
+TEST_F( ConditionJitTest, ShortCircuitLogicalOperators )
+{
+    double a = 1;
+    double b = 1;
+    // a AND b: the right operand is skipped if a is false
+    auto andHandle = mJit.add( { leaf( &a ), op( Type::JUMP_IF_FALSE, 4 ), leaf( &b ), op( Type::AND ) },
+                               mStack.size() );
+    // NOT ( a OR b )
+    auto orHandle = mJit.add(
+        { leaf( &a ), op( Type::JUMP_IF_TRUE, 4 ), leaf( &b ), op( Type::OR ), op( Type::NOT ) }, mStack.size() );
+    ASSERT_NE( andHandle, ConditionJit::INVALID_HANDLE );
+    ASSERT_NE( orHandle, ConditionJit::INVALID_HANDLE );
+    ASSERT_TRUE( mJit.finalize() );
+    auto andFunction = mJit.getFunction( andHandle );
+    auto orFunction = mJit.getFunction( orHandle );
+
+    ASSERT_EQ( run( andFunction ), 0 );
+    ASSERT_TRUE( mStack[0].mBool );
+    ASSERT_EQ( mContext.calls, 2 );
+    a = 0;
+    ASSERT_EQ( run( andFunction ), 0 );
+    ASSERT_FALSE( mStack[0].mBool );
+    ASSERT_EQ( mStack[0].mDouble, 0.0 );
+    ASSERT_EQ( mContext.calls, 3 );
+
+    ASSERT_EQ( run( orFunction ), 0 );
+    ASSERT_FALSE( mStack[0].mBool );
+    ASSERT_EQ( mContext.calls, 5 );
+    a = 1;
+    ASSERT_EQ( run( orFunction ), 0 );
+    ASSERT_FALSE( mStack[0].mBool );
+    ASSERT_EQ( mContext.calls, 6 );
+    a = 0;
+    b = 0;
+    ASSERT_EQ( run( orFunction ), 0 );
+    ASSERT_TRUE( mStack[0].mBool );
+}
+
+TEST_F( ConditionJitTest, Errors )
+{
+    double a = 0;
+    double b = 1;
+    mContext.failingLeaf = &a;
+    auto leafHandle = mJit.add( { leaf( &b ), leaf( &a ), op( Type::BIGGER ) }, mStack.size() );
+    Operation fail;
+    fail.type = Type::FAIL;
+    fail.error = 4;
+    auto failHandle = mJit.add( { leaf( &b ), fail, op( Type::PLUS ) }, mStack.size() );
+    ASSERT_TRUE( mJit.finalize() );
+    ASSERT_EQ( run( mJit.getFunction( leafHandle ) ), 7 );
+    ASSERT_EQ( run( mJit.getFunction( failHandle ) ), 4 );
+}
+
+TEST_F( ConditionJitTest, MalformedProgramsAreRejected )
+{
+    double a = 1;
+    // Operator without operands
+    ASSERT_EQ( mJit.add( { leaf( &a ), op( Type::PLUS ) }, mStack.size() ), ConditionJit::INVALID_HANDLE );
+    // Two values left on the stack
+    ASSERT_EQ( mJit.add( { leaf( &a ), leaf( &a ) }, mStack.size() ), ConditionJit::INVALID_HANDLE );
+    // Backward jump
+    ASSERT_EQ( mJit.add( { leaf( &a ), op( Type::JUMP_IF_TRUE, 0 ) }, mStack.size() ), ConditionJit::INVALID_HANDLE );
+    // Jump arriving with another depth than the fall through
+    ASSERT_EQ( mJit.add( { leaf( &a ), op( Type::JUMP_IF_TRUE, 3 ), leaf( &a ), leaf( &a ), op( Type::AND ) },
+                         mStack.size() ),
+               ConditionJit::INVALID_HANDLE );
+    // More slots than available
+    ASSERT_EQ( mJit.add( { leaf( &a ), leaf( &a ), op( Type::AND ) }, 1 ), ConditionJit::INVALID_HANDLE );
+    ASSERT_EQ( mJit.add( {}, mStack.size() ), ConditionJit::INVALID_HANDLE );
+    ASSERT_EQ( mJit.getCodeSize(), 0 );
+    ASSERT_EQ( mJit.getFunction( 0 ), nullptr );
+}
+
+TEST_F( ConditionJitTest, ClearAllowsNewPrograms )
+{
+    double a = 3;
+    auto function = compile( { leaf( &a ), constant( 2 ), op( Type::BIGGER ) } );
+    ASSERT_NE( function, nullptr );
+    // No programs can be added to the executable code
+    ASSERT_EQ( mJit.add( { constant( 1, true ) }, mStack.size() ), ConditionJit::INVALID_HANDLE );
+    mJit.clear();
+    ASSERT_EQ( mJit.getCodeSize(), 0 );
+    ASSERT_EQ( mJit.getFunction( 0 ), nullptr );
+    function = compile( { constant( 1, true ) } );
+    ASSERT_NE( function, nullptr );
+    ASSERT_EQ( run( function ), 0 );
+    ASSERT_TRUE( mStack[0].mBool );
+}
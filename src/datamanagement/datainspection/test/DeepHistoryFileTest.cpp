@@ -0,0 +1,64 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "DeepHistoryFile.h"
+#include <gtest/gtest.h>
+
+using namespace Aws::IoTFleetWise::DataInspection;
+
+TEST( DeepHistoryFileTest, InvalidParameters )
+{
+    DeepHistoryFile file;
+    ASSERT_FALSE( file.open( "/tmp", 0 ) );
+    ASSERT_FALSE( file.open( "/tmp/DeepHistoryFileTestMissingDirectory", 100 ) );
+    EXPECT_EQ( file.size(), 0 );
+}
+
+TEST( DeepHistoryFileTest, ReadNewestFirstAcrossBlocks )
+{
+    DeepHistoryFile file;
+    ASSERT_TRUE( file.open( "/tmp", 1000 ) );
+    EXPECT_EQ( file.getCapacity(), 1000 );
+    EXPECT_EQ( file.size(), 0 );
+    // One full block in the file and the rest still in memory
+    for ( uint32_t i = 0; i < DeepHistoryFile::BLOCK_SAMPLES + 10; i++ )
+    {
+        file.push( 1000 + i, i * 0.5, static_cast<TimestampFractionUs>( i % 1000 ) );
+    }
+    ASSERT_EQ( file.size(), DeepHistoryFile::BLOCK_SAMPLES + 10 );
+    for ( uint32_t index = 0; index < file.size(); index++ )
+    {
+        auto i = DeepHistoryFile::BLOCK_SAMPLES + 9 - index;
+        const auto &sample = file.get( index );
+        ASSERT_EQ( sample.timestamp, 1000 + i );
+        ASSERT_DOUBLE_EQ( sample.value, i * 0.5 );
+        ASSERT_EQ( sample.timestampFractionUs, i % 1000 );
+    }
+}
+
+TEST( DeepHistoryFileTest, OldestSamplesOverwritten )
+{
+    DeepHistoryFile file;
+    // Rounded up to two blocks
+    ASSERT_TRUE( file.open( "/tmp", DeepHistoryFile::BLOCK_SAMPLES + 1 ) );
+    uint32_t pushed = DeepHistoryFile::BLOCK_SAMPLES * 5 + 3;
+    for ( uint32_t i = 0; i < pushed; i++ )
+    {
+        file.push( i, i, 0 );
+    }
+    ASSERT_EQ( file.size(), DeepHistoryFile::BLOCK_SAMPLES + 1 );
+    for ( uint32_t index = 0; index < file.size(); index++ )
+    {
+        ASSERT_EQ( file.get( index ).timestamp, pushed - 1 - index );
+    }
+}
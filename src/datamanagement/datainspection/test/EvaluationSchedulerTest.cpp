@@ -0,0 +1,100 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "EvaluationScheduler.h"
+#include <gtest/gtest.h>
+
+using namespace Aws::IoTFleetWise::DataInspection;
+
+TEST( EvaluationSchedulerTest, EvaluateWhenWorkIsDue )
+{
+    EvaluationScheduler scheduler( 5, 1000 );
+    // Nothing to do before the first evaluation
+    ASSERT_FALSE( scheduler.isEvaluationDue( 100, EvaluationScheduler::NO_DEADLINE ) );
+    ASSERT_FALSE( scheduler.isEvaluationDue( 100, 101 ) );
+    ASSERT_TRUE( scheduler.isEvaluationDue( 100, 100 ) );
+    scheduler.onEvaluated( 100 );
+    // Work that is due directly again is delayed by the minimum spacing
+    ASSERT_FALSE( scheduler.isEvaluationDue( 104, 100 ) );
+    ASSERT_EQ( scheduler.getWaitTimeMs( 101, 101 ), 4 );
+    ASSERT_TRUE( scheduler.isEvaluationDue( 105, 100 ) );
+    // A deadline after the minimum spacing is kept
+    ASSERT_FALSE( scheduler.isEvaluationDue( 119, 120 ) );
+    ASSERT_EQ( scheduler.getWaitTimeMs( 110, 120 ), 10 );
+    ASSERT_TRUE( scheduler.isEvaluationDue( 120, 120 ) );
+}
+
+TEST( EvaluationSchedulerTest, EvaluateOncePerIdleTime )
+{
+    EvaluationScheduler scheduler( 1, 1000 );
+    scheduler.onEvaluated( 100 );
+    ASSERT_FALSE( scheduler.isEvaluationDue( 1099, EvaluationScheduler::NO_DEADLINE ) );
+    ASSERT_TRUE( scheduler.isEvaluationDue( 1100, EvaluationScheduler::NO_DEADLINE ) );
+    ASSERT_EQ( scheduler.getWaitTimeMs( 100, EvaluationScheduler::NO_DEADLINE ), 1000 );
+    ASSERT_EQ( scheduler.getWaitTimeMs( 600, 5000 ), 500 );
+    ASSERT_EQ( scheduler.getWaitTimeMs( 2000, EvaluationScheduler::NO_DEADLINE ), 0 );
+}
+
+TEST( EvaluationSchedulerTest, ChangeMinimumSpacing )
+{
+    EvaluationScheduler scheduler( 1, 1000 );
+    scheduler.onEvaluated( 100 );
+    ASSERT_TRUE( scheduler.isEvaluationDue( 101, 100 ) );
+    scheduler.setMinimumSpacing( 50 );
+    ASSERT_FALSE( scheduler.isEvaluationDue( 101, 100 ) );
+    ASSERT_EQ( scheduler.getWaitTimeMs( 101, 100 ), 49 );
+    ASSERT_TRUE( scheduler.isEvaluationDue( 150, 100 ) );
+}
+
+TEST( EvaluationSchedulerTest, LatencyHistogram )
+{
+    EvaluationScheduler scheduler( 1, 1000 );
+    // Evaluations without input are not counted
+    scheduler.onEvaluated( 100 );
+    for ( auto count : scheduler.getLatencyHistogram() )
+    {
+        ASSERT_EQ( count, 0 );
+    }
+    scheduler.onInput( 200 );
+    scheduler.onEvaluated( 200 );
+    // The oldest input of an evaluation counts
+    scheduler.onInput( 203 );
+    scheduler.onInput( 201 );
+    scheduler.onInput( 204 );
+    scheduler.onEvaluated( 204 );
+    scheduler.onInput( 300 );
+    scheduler.onEvaluated( 500 );
+    // Inputs with a receive time after the evaluation time count as 0 ms
+    scheduler.onInput( 510 );
+    scheduler.onEvaluated( 505 );
+    const auto &histogram = scheduler.getLatencyHistogram();
+    ASSERT_EQ( histogram[0], 2 );
+    ASSERT_EQ( histogram[2], 1 );
+    ASSERT_EQ( histogram[EvaluationScheduler::LATENCY_BUCKETS - 1], 1 );
+    scheduler.publishLatencyHistogram();
+}
+
+TEST( EvaluationSchedulerTest, LatencyBuckets )
+{
+    ASSERT_EQ( EvaluationScheduler::getLatencyBucket( 0 ), 0 );
+    ASSERT_EQ( EvaluationScheduler::getLatencyBucket( 1 ), 1 );
+    ASSERT_EQ( EvaluationScheduler::getLatencyBucket( 2 ), 2 );
+    ASSERT_EQ( EvaluationScheduler::getLatencyBucket( 3 ), 2 );
+    ASSERT_EQ( EvaluationScheduler::getLatencyBucket( 63 ), 6 );
+    ASSERT_EQ( EvaluationScheduler::getLatencyBucket( 64 ), 7 );
+    ASSERT_EQ( EvaluationScheduler::getLatencyBucket( 100000 ), 7 );
+    ASSERT_EQ( EvaluationScheduler::getLatencyBucketName( 0 ), "inspectionLatency_0ms" );
+    ASSERT_EQ( EvaluationScheduler::getLatencyBucketName( 1 ), "inspectionLatency_below2ms" );
+    ASSERT_EQ( EvaluationScheduler::getLatencyBucketName( 6 ), "inspectionLatency_below64ms" );
+    ASSERT_EQ( EvaluationScheduler::getLatencyBucketName( 7 ), "inspectionLatency_64msOrMore" );
+}
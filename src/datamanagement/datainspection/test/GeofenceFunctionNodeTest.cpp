@@ -0,0 +1,59 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "GeofenceFunctionNode.h"
+#include <gtest/gtest.h>
+#include <memory>
+
+using namespace Aws::IoTFleetWise::DataInspection;
+
+/** @brief This test aims to check Geofence function node to evaluate whether the position
+ * is inside the fences in all supported GPS units.
+ */
+TEST( GeofenceFunctionNodeTest, EvaluateGeofence )
+{
+    auto geofences = std::make_shared<GeofenceIndex>();
+    ASSERT_TRUE( geofences->addCircle( 37.371392, -122.046208, 100 ) );
+    geofences->build();
+    GeofenceFunctionNode geofenceFunctionNode( geofences );
+    ASSERT_TRUE(
+        geofenceFunctionNode.evaluateGeofence( 37.371392, -122.046208, GeohashFunction::GPSUnitType::DECIMAL_DEGREE ) );
+    // Same position again is answered from the cache
+    ASSERT_TRUE(
+        geofenceFunctionNode.evaluateGeofence( 37.371392, -122.046208, GeohashFunction::GPSUnitType::DECIMAL_DEGREE ) );
+    ASSERT_FALSE(
+        geofenceFunctionNode.evaluateGeofence( 37.381392, -122.046208, GeohashFunction::GPSUnitType::DECIMAL_DEGREE ) );
+    ASSERT_TRUE( geofenceFunctionNode.evaluateGeofence(
+        37.371392 * 3600000.0, -122.046208 * 3600000.0, GeohashFunction::GPSUnitType::MILLIARCSECOND ) );
+    ASSERT_TRUE( geofenceFunctionNode.evaluateGeofence(
+        37.371392 * 3600.0, -122.046208 * 3600.0, GeohashFunction::GPSUnitType::ARCSECOND ) );
+    // The same value in other units is a different position
+    ASSERT_FALSE(
+        geofenceFunctionNode.evaluateGeofence( 37.371392, -122.046208, GeohashFunction::GPSUnitType::ARCSECOND ) );
+    ASSERT_TRUE(
+        geofenceFunctionNode.evaluateGeofence( 37.371392, -122.046208, GeohashFunction::GPSUnitType::DECIMAL_DEGREE ) );
+}
+
+/** @brief This test aims to check Geofence function node without fences to evaluate to false
+ */
+TEST( GeofenceFunctionNodeTest, EvaluateWithoutGeofences )
+{
+    GeofenceFunctionNode geofenceFunctionNode( nullptr );
+    ASSERT_FALSE(
+        geofenceFunctionNode.evaluateGeofence( 37.371392, -122.046208, GeohashFunction::GPSUnitType::DECIMAL_DEGREE ) );
+    auto geofences = std::make_shared<GeofenceIndex>();
+    geofences->build();
+    GeofenceFunctionNode emptyGeofenceFunctionNode( geofences );
+    ASSERT_FALSE( emptyGeofenceFunctionNode.evaluateGeofence(
+        37.371392, -122.046208, GeohashFunction::GPSUnitType::DECIMAL_DEGREE ) );
+}
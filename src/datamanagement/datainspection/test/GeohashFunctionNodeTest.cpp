@@ -95,6 +95,38 @@ TEST( GeohashFunctionNodeTest, hasNewGeohashReturnFalseIfAlreadyRead )
     ASSERT_FALSE( geohashFunctionNode.hasNewGeohash() );
 }
 
+/** @brief This test aims to check Geohash function node to report no change while the
+ * position stays within the cell of the last Geohash and a change as soon as it leaves the cell.
+ */
+TEST( GeohashFunctionNodeTest, EvaluateGeohashWithinSameCell )
+{
+    GeohashFunctionNode geohashFunctionNode;
+    GeohashInfo geohashInfo;
+    // Start at Geohash "9q9hwg28j" which spans from 37.371368 to 37.371411 latitude
+    double lat = 37.371392;
+    double lon = -122.046208;
+    ASSERT_TRUE( geohashFunctionNode.evaluateGeohash( lat, lon, 9, GeohashFunction::GPSUnitType::DECIMAL_DEGREE ) );
+    geohashFunctionNode.consumeGeohash( geohashInfo );
+    // Moving a few centimeters stays in the cell
+    ASSERT_FALSE( geohashFunctionNode.evaluateGeohash(
+        lat - 0.000001, lon, 9, GeohashFunction::GPSUnitType::DECIMAL_DEGREE ) );
+    ASSERT_FALSE( geohashFunctionNode.evaluateGeohash(
+        lat - 0.00002, lon, 9, GeohashFunction::GPSUnitType::DECIMAL_DEGREE ) );
+    ASSERT_FALSE( geohashFunctionNode.hasNewGeohash() );
+    ASSERT_FALSE( geohashFunctionNode.evaluateGeohash(
+        lat + 0.000015, lon, 9, GeohashFunction::GPSUnitType::DECIMAL_DEGREE ) );
+    // Moving a few centimeters further north leaves the cell
+    ASSERT_TRUE( geohashFunctionNode.evaluateGeohash(
+        lat + 0.00002, lon, 9, GeohashFunction::GPSUnitType::DECIMAL_DEGREE ) );
+    geohashFunctionNode.consumeGeohash( geohashInfo );
+    ASSERT_EQ( geohashInfo.mPrevReportedGeohashString, "9q9hwg28j" );
+    ASSERT_NE( geohashInfo.mGeohashString, "9q9hwg28j" );
+    // Back in the first cell
+    ASSERT_TRUE( geohashFunctionNode.evaluateGeohash( lat, lon, 9, GeohashFunction::GPSUnitType::DECIMAL_DEGREE ) );
+    geohashFunctionNode.consumeGeohash( geohashInfo );
+    ASSERT_EQ( geohashInfo.mGeohashString, "9q9hwg28j" );
+}
+
 /** @brief This test aims to check Geohash function node to gracefully
  *  handle corner case if GPS Signal is out of bound
  */
@@ -0,0 +1,89 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "OBDECUCache.h"
+#include "EnumUtility.h"
+#include <cstring>
+#include <gtest/gtest.h>
+
+using namespace Aws::IoTFleetWise::DataInspection;
+
+namespace
+{
+OBDECUCache
+createCache()
+{
+    OBDECUCache cache;
+    cache.vin = "1G1JC5444R7252367";
+    OBDECUCache::ECU engine;
+    engine.type = ECUType::ENGINE;
+    engine.requestCANId = toUType( ECUID::ENGINE_ECU_TX );
+    engine.responseCANId = toUType( ECUID::ENGINE_ECU_RX );
+    engine.supportedPIDs[SID::CURRENT_STATS] = { 0x04, 0x05, 0x0C };
+    cache.ecus.push_back( engine );
+    OBDECUCache::ECU other;
+    other.type = ECUType::OTHER;
+    other.requestCANId = toUType( ECUID::ECU3_TX );
+    other.responseCANId = toUType( ECUID::ECU3_RX );
+    other.supportedPIDs[SID::CURRENT_STATS] = {};
+    cache.ecus.push_back( other );
+    return cache;
+}
+} // namespace
+
+/** @brief
+ * This test validates that a serialized cache is loaded with the same content
+ */
+TEST( OBDECUCacheTest, SerializeAndDeserialize )
+{
+    auto cache = createCache();
+    std::vector<uint8_t> binary;
+    cache.serialize( binary );
+
+    OBDECUCache loaded;
+    ASSERT_TRUE( loaded.deserialize( binary.data(), binary.size() ) );
+    ASSERT_EQ( loaded.vin, cache.vin );
+    ASSERT_EQ( loaded.ecus.size(), 2 );
+    ASSERT_EQ( loaded.ecus[0].type, ECUType::ENGINE );
+    ASSERT_EQ( loaded.ecus[0].requestCANId, toUType( ECUID::ENGINE_ECU_TX ) );
+    ASSERT_EQ( loaded.ecus[0].responseCANId, toUType( ECUID::ENGINE_ECU_RX ) );
+    ASSERT_EQ( loaded.ecus[0].supportedPIDs, cache.ecus[0].supportedPIDs );
+    ASSERT_EQ( loaded.ecus[1].type, ECUType::OTHER );
+    ASSERT_EQ( loaded.ecus[1].responseCANId, toUType( ECUID::ECU3_RX ) );
+    ASSERT_EQ( loaded.ecus[1].supportedPIDs, cache.ecus[1].supportedPIDs );
+}
+
+/** @brief
+ * This test validates that corrupted caches and caches of another version are rejected
+ */
+TEST( OBDECUCacheTest, RejectInvalidBinary )
+{
+    std::vector<uint8_t> binary;
+    createCache().serialize( binary );
+    OBDECUCache loaded;
+
+    ASSERT_FALSE( loaded.deserialize( nullptr, 0 ) );
+    ASSERT_FALSE( loaded.deserialize( binary.data(), 8 ) );
+    ASSERT_FALSE( loaded.deserialize( binary.data(), binary.size() - 1 ) );
+
+    auto corrupted = binary;
+    corrupted.back() ^= 0xFF;
+    ASSERT_FALSE( loaded.deserialize( corrupted.data(), corrupted.size() ) );
+
+    auto otherVersion = binary;
+    uint32_t version = OBDECUCache::VERSION + 1;
+    std::memcpy( otherVersion.data() + sizeof( uint32_t ), &version, sizeof( version ) );
+    ASSERT_FALSE( loaded.deserialize( otherVersion.data(), otherVersion.size() ) );
+
+    ASSERT_TRUE( loaded.deserialize( binary.data(), binary.size() ) );
+}
@@ -0,0 +1,630 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "OBDOverCANModule.h"
+#include "AllocationCounter.h"
+#include "EnumUtility.h"
+#include "OBDDataTypes.h"
+#include "businterfaces/ISOTPOverCANSenderReceiver.h"
+#include <algorithm>
+#include <atomic>
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <dirent.h>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <linux/can.h>
+#include <linux/can/isotp.h>
+#include <linux/can/raw.h>
+#include <net/if.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace Aws::IoTFleetWise::DataInspection;
+using namespace Aws::IoTFleetWise::Platform::Linux;
+using namespace Aws::IoTFleetWise::VehicleNetwork;
+
+namespace
+{
+
+const char *const INTERFACE_NAME = "vcan0";
+// The module requests a PID at most every 100 ms, so this is the shortest possible cycle
+constexpr uint32_t PID_REQUEST_INTERVAL_MS = 100;
+// Real time measured per benchmark iteration
+constexpr uint32_t MEASUREMENT_TIME_MS = 500;
+// Time for the VIN, the ECU discovery and the supported PIDs before the measurement starts
+constexpr uint32_t STARTUP_TIMEOUT_MS = 5000;
+// Lets the threads of the simulated ECUs check for the stop every 100 ms
+constexpr uint32_t ECU_RECEIVE_TIMEOUT_MS = 100;
+constexpr uint32_t FUNCTIONAL_REQUEST_ID = 0x7DF;
+
+bool
+isoTPSocketAvailable()
+{
+    if ( if_nametoindex( INTERFACE_NAME ) == 0 )
+    {
+        return false;
+    }
+    auto sock = socket( PF_CAN, SOCK_DGRAM, CAN_ISOTP );
+    if ( sock < 0 )
+    {
+        return false;
+    }
+    close( sock );
+    return true;
+}
+
+uint64_t
+readClockUs( clockid_t clock )
+{
+    struct timespec time = {};
+    clock_gettime( clock, &time );
+    return ( static_cast<uint64_t>( time.tv_sec ) * 1000000U ) + ( static_cast<uint64_t>( time.tv_nsec ) / 1000U );
+}
+
+uint64_t
+getMonotonicTimeUs()
+{
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now().time_since_epoch() )
+            .count() );
+}
+
+/**
+ * Returns the ID of the thread of this process with the given name, 0 if there is none
+ */
+uint64_t
+findThreadId( const std::string &threadName )
+{
+    uint64_t threadId = 0;
+    auto *dir = opendir( "/proc/self/task" );
+    if ( dir == nullptr )
+    {
+        return 0;
+    }
+    for ( auto *entry = readdir( dir ); ( entry != nullptr ) && ( threadId == 0 ); entry = readdir( dir ) )
+    {
+        std::string name;
+        std::ifstream comm( std::string( "/proc/self/task/" ) + entry->d_name + "/comm" );
+        if ( std::getline( comm, name ) && ( name == threadName ) )
+        {
+            threadId = std::strtoull( entry->d_name, nullptr, 10 );
+        }
+    }
+    closedir( dir );
+    return threadId;
+}
+
+/**
+ * The first count emission PIDs of the software table, without the supported PID ranges
+ */
+std::vector<PID>
+selectPIDs( size_t count )
+{
+    std::vector<PID> pids;
+    for ( PID pid = toUType( EmissionPIDs::FUEL_SYSTEM_STATUS );
+          ( pid <= toUType( EmissionPIDs::ODOMETER ) ) && ( pids.size() < count );
+          ++pid )
+    {
+        if ( ( std::find( supportedPIDRange.begin(), supportedPIDRange.end(), pid ) == supportedPIDRange.end() ) &&
+             ( mode1PIDs[pid].retLen > 0 ) && ( !mode1PIDs[pid].formulas.empty() ) )
+        {
+            pids.emplace_back( pid );
+        }
+    }
+    return pids;
+}
+
+/**
+ * Decoder dictionary with a signal per formula of every PID, the signal ID is PID | ( formula index << 8 )
+ */
+std::shared_ptr<CANDecoderDictionary>
+createDecoderDictionary( const std::vector<PID> &pids )
+{
+    auto decoderDictPtr = std::make_shared<CANDecoderDictionary>();
+    decoderDictPtr->canMessageDecoderMethod.emplace( 0, std::unordered_map<CANRawFrameID, CANMessageDecoderMethod>() );
+    for ( auto pid : pids )
+    {
+        CANMessageFormat format;
+        format.mMessageID = pid;
+        format.mSizeInBytes = static_cast<uint8_t>( mode1PIDs[pid].retLen );
+        format.mSignals = std::vector<CANSignalFormat>( mode1PIDs[pid].formulas.size() );
+        for ( uint32_t idx = 0; idx < mode1PIDs[pid].formulas.size(); ++idx )
+        {
+            const auto &formula = mode1PIDs[pid].formulas[idx];
+            format.mSignals[idx].mSignalID = pid | ( idx << 8 );
+            format.mSignals[idx].mFirstBitPosition =
+                static_cast<uint16_t>( formula.byteOffset * BYTE_SIZE + formula.bitShift );
+            format.mSignals[idx].mSizeInBits =
+                static_cast<uint16_t>( ( formula.numOfBytes - 1 ) * BYTE_SIZE + formula.bitMaskLen );
+            format.mSignals[idx].mFactor = formula.scaling;
+            format.mSignals[idx].mOffset = formula.offset;
+            decoderDictPtr->signalIDsToCollect.insert( pid | ( idx << 8 ) );
+        }
+        decoderDictPtr->canMessageDecoderMethod[0].emplace( pid, CANMessageDecoderMethod() );
+        decoderDictPtr->canMessageDecoderMethod[0][pid].format = format;
+    }
+    return decoderDictPtr;
+}
+
+/**
+ * Collects all signals of the dictionary at PID_REQUEST_INTERVAL_MS, so every PID is requested at that interval
+ */
+std::shared_ptr<const InspectionMatrix>
+createInspectionMatrix( const CANDecoderDictionary &dictionary, ExpressionNode &alwaysTrue )
+{
+    auto matrix = std::make_shared<InspectionMatrix>();
+    ConditionWithCollectedData condition;
+    for ( auto signalID : dictionary.signalIDsToCollect )
+    {
+        InspectionMatrixSignalCollectionInfo signal{};
+        signal.signalID = signalID;
+        signal.sampleBufferSize = 10;
+        signal.minimumSampleIntervalMs = PID_REQUEST_INTERVAL_MS;
+        signal.isConditionOnlySignal = false;
+        condition.signals.push_back( signal );
+    }
+    alwaysTrue.nodeType = ExpressionNodeType::BOOLEAN;
+    alwaysTrue.booleanValue = true;
+    condition.condition = &alwaysTrue;
+    condition.probabilityToSend = 1.0;
+    condition.includeActiveDtcs = false;
+    matrix->conditions.emplace_back( condition );
+    return matrix;
+}
+
+/**
+ * ECU answering the OBD requests of SID 1 and 9 on its own thread through a kernel ISO-TP socket, after a
+ * configurable latency. It counts the PIDs it answered and the time between two requests of its first PID, which
+ * is the cycle time of the PID.
+ */
+class SimulatedECU
+{
+public:
+    SimulatedECU( uint32_t requestCANId, uint32_t responseCANId, std::vector<PID> pids, uint32_t latencyMs )
+        : mRequestCANId( requestCANId )
+        , mResponseCANId( responseCANId )
+        , mPIDs( std::move( pids ) )
+        , mLatencyMs( latencyMs )
+    {
+    }
+
+    ~SimulatedECU()
+    {
+        stop();
+    }
+
+    SimulatedECU( const SimulatedECU & ) = delete;
+    SimulatedECU &operator=( const SimulatedECU & ) = delete;
+    SimulatedECU( SimulatedECU && ) = delete;
+    SimulatedECU &operator=( SimulatedECU && ) = delete;
+
+    bool
+    start()
+    {
+        ISOTPOverCANSenderReceiverOptions options(
+            INTERFACE_NAME, mResponseCANId, mRequestCANId, false, 0, 0, ECU_RECEIVE_TIMEOUT_MS );
+        if ( ( !mSocket.init( options ) ) || ( !mSocket.connect() ) )
+        {
+            return false;
+        }
+        mThread = std::thread( [this]() {
+            run();
+        } );
+        return true;
+    }
+
+    void
+    stop()
+    {
+        if ( mThread.joinable() )
+        {
+            mShouldStop.store( true );
+            mThread.join();
+            mSocket.disconnect();
+        }
+    }
+
+    uint32_t
+    getResponseCANId() const
+    {
+        return mResponseCANId;
+    }
+
+    uint64_t
+    getAnsweredPIDs() const
+    {
+        return mAnsweredPIDs.load();
+    }
+
+    uint64_t
+    getCpuTimeUs() const
+    {
+        return mCpuTimeUs.load();
+    }
+
+    // Returns the cycle times since the previous call
+    std::vector<double>
+    takeCycleTimesMs()
+    {
+        std::lock_guard<std::mutex> lock( mCycleTimesMutex );
+        std::vector<double> cycleTimes;
+        cycleTimes.swap( mCycleTimesMs );
+        return cycleTimes;
+    }
+
+private:
+    void
+    run()
+    {
+        std::vector<uint8_t> request;
+        uint64_t lastFirstPIDRequestUs = 0;
+        while ( !mShouldStop.load() )
+        {
+            if ( mSocket.receivePDU( request ) && ( request.size() >= 2 ) )
+            {
+                if ( ( request[0] == toUType( SID::CURRENT_STATS ) ) && ( !mPIDs.empty() ) &&
+                     ( std::find( request.begin() + 1, request.end(), mPIDs.front() ) != request.end() ) )
+                {
+                    auto nowUs = getMonotonicTimeUs();
+                    if ( lastFirstPIDRequestUs != 0 )
+                    {
+                        std::lock_guard<std::mutex> lock( mCycleTimesMutex );
+                        mCycleTimesMs.emplace_back( static_cast<double>( nowUs - lastFirstPIDRequestUs ) / 1000.0 );
+                    }
+                    lastFirstPIDRequestUs = nowUs;
+                }
+                if ( mLatencyMs > 0 )
+                {
+                    std::this_thread::sleep_for( std::chrono::milliseconds( mLatencyMs ) );
+                }
+                mSocket.sendPDU( respond( request ) );
+            }
+            mCpuTimeUs.store( readClockUs( CLOCK_THREAD_CPUTIME_ID ) );
+        }
+    }
+
+    std::vector<uint8_t>
+    respond( const std::vector<uint8_t> &request )
+    {
+        std::vector<uint8_t> response;
+        if ( ( request[0] == toUType( SID::VEHICLE_INFO ) ) && ( request[1] == 0x02 ) )
+        {
+            return { 0x49, 0x02, 0x01, 0x31, 0x47, 0x31, 0x4A, 0x43, 0x35, 0x34,
+                     0x34, 0x34, 0x52, 0x37, 0x32, 0x35, 0x32, 0x33, 0x36, 0x37 };
+        }
+        if ( request[0] != toUType( SID::CURRENT_STATS ) )
+        {
+            // Service not supported
+            return { 0x7F, request[0], 0x11 };
+        }
+        response.emplace_back( static_cast<uint8_t>( 0x40 | request[0] ) );
+        bool isSupportedPIDsRequest =
+            std::find( supportedPIDRange.begin(), supportedPIDRange.end(), request[1] ) != supportedPIDRange.end();
+        for ( size_t i = 1; i < request.size(); i++ )
+        {
+            auto pid = request[i];
+            if ( isSupportedPIDsRequest )
+            {
+                appendSupportedPIDs( pid, response );
+            }
+            else if ( std::find( mPIDs.begin(), mPIDs.end(), pid ) != mPIDs.end() )
+            {
+                response.emplace_back( pid );
+                response.insert( response.end(), mode1PIDs[pid].retLen, 0x10 );
+                mAnsweredPIDs++;
+            }
+        }
+        return response;
+    }
+
+    // Appends the range and the J1979 bit mask of the supported PIDs of the range, the last bit is set if a PID
+    // of a following range is supported
+    void
+    appendSupportedPIDs( PID range, std::vector<uint8_t> &response ) const
+    {
+        uint8_t mask[4] = {};
+        for ( auto pid : mPIDs )
+        {
+            uint32_t bit = static_cast<uint32_t>( pid ) - range - 1U;
+            if ( pid > range + 0x20U )
+            {
+                bit = 0x1FU;
+            }
+            else if ( pid <= range )
+            {
+                continue;
+            }
+            mask[bit / 8U] = static_cast<uint8_t>( mask[bit / 8U] | ( 0x80U >> ( bit % 8U ) ) );
+        }
+        response.emplace_back( range );
+        response.insert( response.end(), std::begin( mask ), std::end( mask ) );
+    }
+
+    uint32_t mRequestCANId;
+    uint32_t mResponseCANId;
+    std::vector<PID> mPIDs;
+    uint32_t mLatencyMs;
+    ISOTPOverCANSenderReceiver mSocket;
+    std::thread mThread;
+    std::atomic<bool> mShouldStop{ false };
+    std::atomic<uint64_t> mAnsweredPIDs{ 0 };
+    std::atomic<uint64_t> mCpuTimeUs{ 0 };
+    std::mutex mCycleTimesMutex;
+    std::vector<double> mCycleTimesMs;
+};
+
+/**
+ * Answers the functional Supported PIDs request of the ECU discovery on behalf of the simulated ECUs that are not
+ * configured in the module, with a single frame from their response IDs
+ */
+class FunctionalResponder
+{
+public:
+    explicit FunctionalResponder( std::vector<uint32_t> responseCANIds )
+        : mResponseCANIds( std::move( responseCANIds ) )
+    {
+    }
+
+    ~FunctionalResponder()
+    {
+        if ( mThread.joinable() )
+        {
+            mShouldStop.store( true );
+            mThread.join();
+        }
+        if ( mSocket >= 0 )
+        {
+            close( mSocket );
+        }
+    }
+
+    FunctionalResponder( const FunctionalResponder & ) = delete;
+    FunctionalResponder &operator=( const FunctionalResponder & ) = delete;
+    FunctionalResponder( FunctionalResponder && ) = delete;
+    FunctionalResponder &operator=( FunctionalResponder && ) = delete;
+
+    bool
+    start()
+    {
+        mSocket = socket( PF_CAN, SOCK_RAW, CAN_RAW );
+        if ( mSocket < 0 )
+        {
+            return false;
+        }
+        struct can_filter filter = {};
+        filter.can_id = FUNCTIONAL_REQUEST_ID;
+        filter.can_mask = CAN_SFF_MASK | CAN_EFF_FLAG;
+        struct sockaddr_can interfaceAddress = {};
+        interfaceAddress.can_family = AF_CAN;
+        interfaceAddress.can_ifindex = static_cast<int>( if_nametoindex( INTERFACE_NAME ) );
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-cstyle-cast)
+        if ( ( setsockopt( mSocket, SOL_CAN_RAW, CAN_RAW_FILTER, &filter, sizeof( filter ) ) < 0 ) ||
+             ( bind( mSocket, (struct sockaddr *)&interfaceAddress, sizeof( interfaceAddress ) ) < 0 ) )
+        {
+            return false;
+        }
+        mThread = std::thread( [this]() {
+            run();
+        } );
+        return true;
+    }
+
+    uint64_t
+    getCpuTimeUs() const
+    {
+        return mCpuTimeUs.load();
+    }
+
+private:
+    void
+    run()
+    {
+        while ( !mShouldStop.load() )
+        {
+            struct pollfd pfd = { mSocket, POLLIN, 0 };
+            struct can_frame request = {};
+            if ( ( poll( &pfd, 1U, static_cast<int>( ECU_RECEIVE_TIMEOUT_MS ) ) > 0 ) &&
+                 ( read( mSocket, &request, sizeof( request ) ) == static_cast<ssize_t>( sizeof( request ) ) ) &&
+                 ( request.data[1] == toUType( SID::CURRENT_STATS ) ) && ( request.data[2] == 0x00 ) )
+            {
+                for ( auto responseCANId : mResponseCANIds )
+                {
+                    struct can_frame response = {};
+                    response.can_id = responseCANId;
+                    response.can_dlc = CAN_MAX_DLEN;
+                    const uint8_t data[CAN_MAX_DLEN] = { 0x06, 0x41, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xCC };
+                    std::copy( std::begin( data ), std::end( data ), response.data );
+                    (void)write( mSocket, &response, sizeof( response ) );
+                }
+            }
+            mCpuTimeUs.store( readClockUs( CLOCK_THREAD_CPUTIME_ID ) );
+        }
+    }
+
+    std::vector<uint32_t> mResponseCANIds;
+    int mSocket{ -1 };
+    std::thread mThread;
+    std::atomic<bool> mShouldStop{ false };
+    std::atomic<uint64_t> mCpuTimeUs{ 0 };
+};
+
+double
+getPercentile( std::vector<double> &values, double percentile )
+{
+    if ( values.empty() )
+    {
+        return 0.0;
+    }
+    auto index = static_cast<size_t>( percentile * static_cast<double>( values.size() - 1 ) );
+    std::nth_element( values.begin(), values.begin() + static_cast<std::ptrdiff_t>( index ), values.end() );
+    return values[index];
+}
+
+} // namespace
+
+/**
+ * Polls simulated ECUs on vcan0 with the OBD module. The ECUs answer after the given latency, all of them support
+ * the same PIDs, which are requested every 100 ms. The first ECU is the engine ECU and the second the transmission
+ * ECU, further ECUs are found by the ECU discovery. Only the cyclic PID requests are measured.
+ *
+ * Reported are the PIDs answered per second by all ECUs, the percentiles of the time between two requests of the
+ * same PID and the CPU time of the module in percent of one core, which is the CPU time of the process without the
+ * threads of the simulated ECUs. Builds with FWE_ALLOCATION_COUNTING also report the heap allocations of the module
+ * thread per polling cycle.
+ */
+static void
+BM_OBDPollingCycle( benchmark::State &state )
+{
+    if ( !isoTPSocketAvailable() )
+    {
+        state.SkipWithError( "ISO-TP sockets on vcan0 are not available" );
+        return;
+    }
+    auto ecuCount = static_cast<uint32_t>( state.range( 0 ) );
+    auto latencyMs = static_cast<uint32_t>( state.range( 1 ) );
+    auto pids = selectPIDs( static_cast<size_t>( state.range( 2 ) ) );
+
+    std::vector<std::unique_ptr<SimulatedECU>> ecus;
+    std::vector<uint32_t> discoveredResponseCANIds;
+    for ( uint32_t i = 0; i < ecuCount; i++ )
+    {
+        ecus.emplace_back( std::make_unique<SimulatedECU>( toUType( ECUID::ENGINE_ECU_TX ) + i,
+                                                           toUType( ECUID::ENGINE_ECU_RX ) + i,
+                                                           pids,
+                                                           latencyMs ) );
+        if ( !ecus.back()->start() )
+        {
+            state.SkipWithError( "Failed to start the simulated ECU" );
+            return;
+        }
+        if ( i >= 2 )
+        {
+            discoveredResponseCANIds.emplace_back( ecus.back()->getResponseCANId() );
+        }
+    }
+    FunctionalResponder functionalResponder( discoveredResponseCANIds );
+    if ( !functionalResponder.start() )
+    {
+        state.SkipWithError( "Failed to start the functional responder" );
+        return;
+    }
+
+    auto signalBufferPtr = std::make_shared<SignalBuffer>( 10000 );
+    auto activeDTCBufferPtr = std::make_shared<ActiveDTCBuffer>( 256 );
+    OBDOverCANModule obdModule;
+    if ( ( !obdModule.init(
+             signalBufferPtr, activeDTCBufferPtr, INTERFACE_NAME, 1, 0, false, ecuCount > 1, ecuCount > 2 ) ) ||
+         ( !obdModule.connect() ) )
+    {
+        state.SkipWithError( "Failed to start the OBD module" );
+        return;
+    }
+    auto decoderDictPtr = createDecoderDictionary( pids );
+    ExpressionNode alwaysTrue;
+    obdModule.onChangeInspectionMatrix( createInspectionMatrix( *decoderDictPtr, alwaysTrue ) );
+    obdModule.onChangeOfActiveDictionary( decoderDictPtr, VehicleDataSourceProtocol::OBD );
+
+    // The VIN, the discovery and the supported PIDs are done before all ECUs answer their first PIDs
+    auto startupDeadlineUs = getMonotonicTimeUs() + ( STARTUP_TIMEOUT_MS * 1000U );
+    while ( std::any_of( ecus.begin(), ecus.end(), []( const std::unique_ptr<SimulatedECU> &ecu ) {
+        return ecu->getAnsweredPIDs() == 0;
+    } ) )
+    {
+        if ( getMonotonicTimeUs() > startupDeadlineUs )
+        {
+            obdModule.disconnect();
+            state.SkipWithError( "Not all simulated ECUs were polled" );
+            return;
+        }
+        std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+    }
+
+    CollectedSignal signal;
+    while ( signalBufferPtr->pop( signal ) )
+    {
+    }
+    auto sumOverECUs = [&ecus]( uint64_t ( SimulatedECU::*getter )() const ) {
+        uint64_t sum = 0;
+        for ( const auto &ecu : ecus )
+        {
+            sum += ( ( *ecu ).*getter )();
+        }
+        return sum;
+    };
+    for ( auto &ecu : ecus )
+    {
+        ecu->takeCycleTimesMs();
+    }
+    auto startAnsweredPIDs = sumOverECUs( &SimulatedECU::getAnsweredPIDs );
+    auto startSimulationCpuUs = sumOverECUs( &SimulatedECU::getCpuTimeUs ) + functionalResponder.getCpuTimeUs();
+    auto startProcessCpuUs = readClockUs( CLOCK_PROCESS_CPUTIME_ID );
+    auto moduleThreadId = findThreadId( "fwDIOBDModule" );
+    auto startAllocations = AllocationCounter::getAllocations( moduleThreadId );
+    auto startUs = getMonotonicTimeUs();
+    uint64_t signalCount = 0;
+    for ( auto _ : state )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( MEASUREMENT_TIME_MS ) );
+        while ( signalBufferPtr->pop( signal ) )
+        {
+            signalCount++;
+        }
+    }
+    auto elapsedSeconds = static_cast<double>( getMonotonicTimeUs() - startUs ) / 1e6;
+    auto answeredPIDs = sumOverECUs( &SimulatedECU::getAnsweredPIDs ) - startAnsweredPIDs;
+    auto simulationCpuUs =
+        sumOverECUs( &SimulatedECU::getCpuTimeUs ) + functionalResponder.getCpuTimeUs() - startSimulationCpuUs;
+    auto processCpuUs = readClockUs( CLOCK_PROCESS_CPUTIME_ID ) - startProcessCpuUs;
+    auto allocations = AllocationCounter::getAllocations( moduleThreadId ) - startAllocations;
+    std::vector<double> cycleTimesMs;
+    for ( auto &ecu : ecus )
+    {
+        auto ecuCycleTimesMs = ecu->takeCycleTimesMs();
+        cycleTimesMs.insert( cycleTimesMs.end(), ecuCycleTimesMs.begin(), ecuCycleTimesMs.end() );
+    }
+    obdModule.disconnect();
+
+    state.counters["pidsPerSecond"] = static_cast<double>( answeredPIDs ) / elapsedSeconds;
+    state.counters["signalsPerSecond"] = static_cast<double>( signalCount ) / elapsedSeconds;
+    state.counters["cycleP50Ms"] = getPercentile( cycleTimesMs, 0.5 );
+    state.counters["cycleP90Ms"] = getPercentile( cycleTimesMs, 0.9 );
+    state.counters["cycleP99Ms"] = getPercentile( cycleTimesMs, 0.99 );
+    state.counters["cycleMaxMs"] = getPercentile( cycleTimesMs, 1.0 );
+    state.counters["moduleCpuPercent"] =
+        static_cast<double>( processCpuUs - std::min( processCpuUs, simulationCpuUs ) ) / ( elapsedSeconds * 1e4 );
+    if ( AllocationCounter::isEnabled() && ( moduleThreadId != 0 ) )
+    {
+        // Heap allocations of the module thread per polling cycle, 0 once the buffers are warmed up
+        state.counters["allocationsPerCycle"] =
+            static_cast<double>( allocations ) / ( elapsedSeconds * 1000.0 / PID_REQUEST_INTERVAL_MS );
+    }
+}
+BENCHMARK( BM_OBDPollingCycle )
+    ->ArgNames( { "ecus", "latencyMs", "pids" } )
+    ->Args( { 1, 0, 6 } )
+    ->Args( { 1, 0, 24 } )
+    ->Args( { 2, 5, 24 } )
+    ->Args( { 4, 5, 24 } )
+    ->Args( { 4, 20, 24 } )
+    ->Iterations( 4 )
+    ->Unit( benchmark::kMillisecond )
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -17,6 +17,7 @@
 #include "OBDDataTypes.h"
 #include "OBDOverCANSessionManager.h"
 #include "businterfaces/ISOTPOverCANReceiver.h"
+#include <cstring>
 #include <gtest/gtest.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -24,6 +25,8 @@
 
 #include <linux/can.h>
 #include <linux/can/isotp.h>
+#include <linux/can/raw.h>
+#include <net/if.h>
 #include <sys/socket.h>
 
 using namespace Aws::IoTFleetWise::DataInspection;
@@ -998,3 +1001,131 @@ TEST_F( OBDOverCANModuleTest, OBDOverCANModuleRequestPIDAndDTCsTest )
     ASSERT_TRUE( transmissionECU.disconnect() );
     ASSERT_TRUE( obdModule.disconnect() );
 }
+
+TEST_F( OBDOverCANModuleTest, OBDOverCANModuleDiscoverECUsTest )
+{
+    const uint32_t obdPIDRequestInterval = 2; // 2 seconds
+    const uint32_t obdDTCRequestInterval = 2; // 2 seconds
+    // Simulate a further ECU on the bus that answers the functional request
+    auto ecuSocket = socket( PF_CAN, SOCK_RAW, CAN_RAW );
+    ASSERT_GE( ecuSocket, 0 );
+    struct can_filter filter = {};
+    filter.can_id = 0x7DF;
+    filter.can_mask = CAN_SFF_MASK | CAN_EFF_FLAG;
+    ASSERT_EQ( setsockopt( ecuSocket, SOL_CAN_RAW, CAN_RAW_FILTER, &filter, sizeof( filter ) ), 0 );
+    struct sockaddr_can interfaceAddress = {};
+    interfaceAddress.can_family = AF_CAN;
+    interfaceAddress.can_ifindex = static_cast<int>( if_nametoindex( "vcan0" ) );
+    ASSERT_EQ( bind( ecuSocket, (struct sockaddr *)&interfaceAddress, sizeof( interfaceAddress ) ), 0 );
+
+    OBDOverCANModule obdModule;
+    auto signalBufferPtr = std::make_shared<SignalBuffer>( 256 );
+    auto activeDTCBufferPtr = std::make_shared<ActiveDTCBuffer>( 256 );
+    ASSERT_TRUE( obdModule.init( signalBufferPtr,
+                                 activeDTCBufferPtr,
+                                 "vcan0",
+                                 obdPIDRequestInterval,
+                                 obdDTCRequestInterval,
+                                 false,
+                                 false,
+                                 true ) );
+    ASSERT_EQ( obdModule.getECUCount(), 1 );
+    ASSERT_TRUE( obdModule.connect() );
+    obdModule.onChangeOfActiveDictionary( initDecoderDictionary(), VehicleDataSourceProtocol::OBD );
+
+    // Receive the functional request for the supported PIDs of SID 1
+    struct can_frame frame = {};
+    ASSERT_EQ( read( ecuSocket, &frame, sizeof( frame ) ), static_cast<ssize_t>( sizeof( frame ) ) );
+    ASSERT_EQ( frame.can_id, 0x7DF );
+    ASSERT_EQ( frame.data[1], toUType( SID::CURRENT_STATS ) );
+    ASSERT_EQ( frame.data[2], 0x00 );
+    // Respond as the third ECU in a single frame
+    frame.can_id = toUType( ECUID::ECU3_RX );
+    frame.can_dlc = 8;
+    uint8_t response[] = { 0x06, 0x41, 0x00, 0x80, 0x08, 0x00, 0x00, 0xCC };
+    std::memcpy( frame.data, response, sizeof( response ) );
+    ASSERT_EQ( write( ecuSocket, &frame, sizeof( frame ) ), static_cast<ssize_t>( sizeof( frame ) ) );
+    // Make sure the OBDModule thread has processed the response.
+    std::this_thread::sleep_for( std::chrono::milliseconds( 500 ) );
+    ASSERT_EQ( obdModule.getECUCount(), 2 );
+
+    // Cleanup
+    close( ecuSocket );
+    ASSERT_TRUE( obdModule.disconnect() );
+}
+
+TEST_F( OBDOverCANModuleTest, OBDOverCANModuleRequestPIDsAtSampleIntervalTest )
+{
+    std::vector<uint8_t> ecmRxPDUData;
+    std::vector<uint8_t> ecmTxPDUData;
+    std::vector<uint8_t> expectedECMPIDs;
+    // Request PIDs by default every 2 seconds, and no DTCs
+    const uint32_t obdPIDRequestInterval = 2; // 2 seconds
+    const uint32_t obdDTCRequestInterval = 0;
+
+    ISOTPOverCANSenderReceiver engineECU;
+    ISOTPOverCANSenderReceiverOptions engineECUOptions;
+    // Engine ECU
+    engineECUOptions.mSocketCanIFName = "vcan0";
+    engineECUOptions.mSourceCANId = toUType( ECUID::ENGINE_ECU_RX );
+    engineECUOptions.mDestinationCANId = toUType( ECUID::ENGINE_ECU_TX );
+    engineECUOptions.mP2TimeoutMs = P2_TIMEOUT_INFINITE;
+    ASSERT_TRUE( engineECU.init( engineECUOptions ) );
+    ASSERT_TRUE( engineECU.connect() );
+    // OBD Module
+    OBDOverCANModule obdModule;
+    auto signalBufferPtr = std::make_shared<SignalBuffer>( 256 );
+    auto activeDTCBufferPtr = std::make_shared<ActiveDTCBuffer>( 256 );
+    ASSERT_TRUE( obdModule.init(
+        signalBufferPtr, activeDTCBufferPtr, "vcan0", obdPIDRequestInterval, obdDTCRequestInterval, false, false ) );
+    ASSERT_TRUE( obdModule.connect() );
+    obdModule.onChangeOfActiveDictionary( initDecoderDictionary(), VehicleDataSourceProtocol::OBD );
+    // The engine load is sampled every 500 ms, all other signals at the default interval
+    auto matrix = std::make_shared<InspectionMatrix>();
+    ConditionWithCollectedData condition;
+    InspectionMatrixSignalCollectionInfo matrixCollectInfo;
+    matrixCollectInfo.signalID = toUType( EmissionPIDs::ENGINE_LOAD );
+    matrixCollectInfo.sampleBufferSize = 50;
+    matrixCollectInfo.minimumSampleIntervalMs = 500;
+    condition.signals.push_back( matrixCollectInfo );
+    ExpressionNode node;
+    node.nodeType = ExpressionNodeType::BOOLEAN;
+    node.booleanValue = true;
+    condition.condition = &node;
+    matrix->conditions.emplace_back( condition );
+    obdModule.onChangeInspectionMatrix( matrix );
+
+    // Respond to VIN request
+    ASSERT_TRUE( engineECU.receivePDU( ecmRxPDUData ) );
+    ASSERT_TRUE( ecmRxPDUData[0] == toUType( vehicleIdentificationNumberRequest.mSID ) );
+    ecmTxPDUData = { 0x49, 0x02, 0x01, 0x31, 0x47, 0x31, 0x4A, 0x43, 0x35, 0x34,
+                     0x34, 0x34, 0x52, 0x37, 0x32, 0x35, 0x32, 0x33, 0x36, 0x37 };
+    ASSERT_TRUE( engineECU.sendPDU( ecmTxPDUData ) );
+    // Respond to the Supported PID request: Support PID 0x04,0x05
+    ASSERT_TRUE( engineECU.receivePDU( ecmRxPDUData ) );
+    ASSERT_TRUE( ecmRxPDUData[0] == toUType( SID::CURRENT_STATS ) );
+    ASSERT_TRUE( ecmRxPDUData[1] == 0x00 );
+    ecmTxPDUData = { 0x41, 0x00, 0x18, 0x00, 0x00, 0x00 };
+    ASSERT_TRUE( engineECU.sendPDU( ecmTxPDUData ) );
+    // Both PIDs are due in the first cycle
+    ecmRxPDUData.clear();
+    ASSERT_TRUE( engineECU.receivePDU( ecmRxPDUData ) );
+    expectedECMPIDs = { 0x01, 0x04, 0x05 };
+    ASSERT_EQ( expectedECMPIDs, ecmRxPDUData );
+    ecmTxPDUData = { 0x41, 0x04, 0x99, 0x05, 0x6E };
+    ASSERT_TRUE( engineECU.sendPDU( ecmTxPDUData ) );
+    // The engine load is requested alone before the default interval elapsed
+    for ( int i = 0; i < 2; i++ )
+    {
+        ecmRxPDUData.clear();
+        ASSERT_TRUE( engineECU.receivePDU( ecmRxPDUData ) );
+        expectedECMPIDs = { 0x01, 0x04 };
+        ASSERT_EQ( expectedECMPIDs, ecmRxPDUData );
+        ecmTxPDUData = { 0x41, 0x04, 0x99 };
+        ASSERT_TRUE( engineECU.sendPDU( ecmTxPDUData ) );
+    }
+
+    // Cleanup
+    ASSERT_TRUE( engineECU.disconnect() );
+    ASSERT_TRUE( obdModule.disconnect() );
+}
@@ -0,0 +1,139 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "PipelineLoadController.h"
+#include <atomic>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <memory>
+#include <thread>
+
+using namespace Aws::IoTFleetWise::DataInspection;
+
+namespace
+{
+// Waits up to a second for the controller thread to reach the level
+LoadSheddingLevel
+waitForLevel( const PipelineLoadController &controller, LoadSheddingLevel level )
+{
+    for ( int i = 0; ( i < 1000 ) && ( controller.getLevel() != level ); i++ )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+    return controller.getLevel();
+}
+} // namespace
+
+/**
+ * @brief Validates that the level follows the fullest queue with hysteresis between the watermarks
+ */
+TEST( PipelineLoadControllerTest, LevelFollowsFullestQueue )
+{
+    LoadSheddingConfig config;
+    config.lowWatermark = 0.5;
+    config.highWatermark = 0.8;
+    config.criticalWatermark = 0.9;
+    PipelineLoadController controller( config );
+    size_t signals = 0;
+    size_t frames = 0;
+    controller.registerQueue( "Signals", [&signals]() { return signals; }, 100 );
+    controller.registerQueue( "Frames", [&frames]() { return frames; }, 10 );
+    // Ignored, it would divide by zero
+    controller.registerQueue( "Empty", []() { return 1; }, 0 );
+
+    ASSERT_EQ( controller.evaluate(), LoadSheddingLevel::NONE );
+    frames = 8;
+    ASSERT_EQ( controller.evaluate(), LoadSheddingLevel::LOW_PRIORITY_SIGNALS );
+    frames = 0;
+    signals = 95;
+    ASSERT_EQ( controller.evaluate(), LoadSheddingLevel::RAW_CAN_FRAMES );
+    // Raw frames are thinned out until the fullest queue is below the high watermark
+    signals = 85;
+    ASSERT_EQ( controller.evaluate(), LoadSheddingLevel::RAW_CAN_FRAMES );
+    signals = 60;
+    ASSERT_EQ( controller.evaluate(), LoadSheddingLevel::LOW_PRIORITY_SIGNALS );
+    // Signals are shed until the fullest queue is below the low watermark
+    signals = 50;
+    ASSERT_EQ( controller.evaluate(), LoadSheddingLevel::LOW_PRIORITY_SIGNALS );
+    signals = 49;
+    ASSERT_EQ( controller.evaluate(), LoadSheddingLevel::NONE );
+    signals = 60;
+    ASSERT_EQ( controller.evaluate(), LoadSheddingLevel::NONE );
+    ASSERT_EQ( controller.getLevel(), LoadSheddingLevel::NONE );
+}
+
+/**
+ * @brief Validates that signals used in conditions and of high priority collection schemes are never shed
+ */
+TEST( PipelineLoadControllerTest, SheddableSignals )
+{
+    LoadSheddingConfig config;
+    config.sheddingPriorityThreshold = 2;
+    config.rawFrameKeepInterval = 0;
+    PipelineLoadController controller( config );
+    ASSERT_FALSE( controller.isSheddable( 1, false ) );
+    ASSERT_FALSE( controller.isSheddable( 2, false ) );
+    ASSERT_TRUE( controller.isSheddable( 3, false ) );
+    ASSERT_FALSE( controller.isSheddable( 3, true ) );
+    // At least every frame is kept
+    ASSERT_EQ( controller.getConfig().rawFrameKeepInterval, 1 );
+}
+
+/**
+ * @brief Validates that the thread evaluates the queues periodically and the level is reset when it stops
+ */
+TEST( PipelineLoadControllerTest, EvaluatePeriodically )
+{
+    LoadSheddingConfig config;
+    config.samplingPeriodMs = 1;
+    PipelineLoadController controller( config );
+    std::atomic<size_t> occupancy{ 0 };
+    controller.registerQueue( "Queue", [&occupancy]() { return occupancy.load(); }, 10 );
+    ASSERT_TRUE( controller.start() );
+    ASSERT_TRUE( controller.isAlive() );
+    occupancy = 10;
+    ASSERT_EQ( waitForLevel( controller, LoadSheddingLevel::RAW_CAN_FRAMES ), LoadSheddingLevel::RAW_CAN_FRAMES );
+    occupancy = 0;
+    ASSERT_EQ( waitForLevel( controller, LoadSheddingLevel::NONE ), LoadSheddingLevel::NONE );
+    occupancy = 10;
+    ASSERT_EQ( waitForLevel( controller, LoadSheddingLevel::RAW_CAN_FRAMES ), LoadSheddingLevel::RAW_CAN_FRAMES );
+    ASSERT_TRUE( controller.stop() );
+    ASSERT_FALSE( controller.isAlive() );
+    ASSERT_EQ( controller.getLevel(), LoadSheddingLevel::NONE );
+}
+
+TEST( PipelineLoadControllerTest, EvaluatePeriodicallyOnExecutor )
+{
+    LoadSheddingConfig config;
+    config.samplingPeriodMs = 1;
+    PipelineLoadController controller( config );
+    std::atomic<size_t> occupancy{ 0 };
+    controller.registerQueue( "Queue", [&occupancy]() { return occupancy.load(); }, 10 );
+    auto executor = std::make_shared<SerialTaskExecutor>( 1U );
+    ASSERT_TRUE( executor->start() );
+    controller.setExecutor( executor );
+    ASSERT_TRUE( controller.start() );
+    ASSERT_TRUE( controller.isAlive() );
+    occupancy = 10;
+    ASSERT_EQ( waitForLevel( controller, LoadSheddingLevel::RAW_CAN_FRAMES ), LoadSheddingLevel::RAW_CAN_FRAMES );
+    occupancy = 0;
+    ASSERT_EQ( waitForLevel( controller, LoadSheddingLevel::NONE ), LoadSheddingLevel::NONE );
+    occupancy = 10;
+    ASSERT_EQ( waitForLevel( controller, LoadSheddingLevel::RAW_CAN_FRAMES ), LoadSheddingLevel::RAW_CAN_FRAMES );
+    ASSERT_TRUE( controller.stop() );
+    ASSERT_FALSE( controller.isAlive() );
+    ASSERT_EQ( controller.getLevel(), LoadSheddingLevel::NONE );
+    // The executor keeps running for the other modules
+    ASSERT_TRUE( executor->isAlive() );
+    ASSERT_TRUE( executor->stop() );
+}
@@ -0,0 +1,148 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "QueueSizeAdvisor.h"
+#include "CacheAndPersist.h"
+#include "TraceModule.h"
+#include <boost/filesystem.hpp>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace Aws::IoTFleetWise::DataInspection;
+
+class QueueSizeAdvisorTest : public ::testing::Test
+{
+protected:
+    void
+    SetUp() override
+    {
+        mPersistency = std::make_shared<CacheAndPersist>( boost::filesystem::temp_directory_path().string(), 131072 );
+        ASSERT_TRUE( mPersistency->init() );
+        mPersistency->erase( DataType::QUEUE_SIZES );
+    }
+
+    void
+    TearDown() override
+    {
+        mPersistency->erase( DataType::QUEUE_SIZES );
+    }
+
+    std::shared_ptr<CacheAndPersist> mPersistency;
+};
+
+/**
+ * @brief Validates the size derived from the high-water mark, the drops and the shrink limit
+ */
+TEST_F( QueueSizeAdvisorTest, RecommendsFromHighWaterAndDrops )
+{
+    QueueSizingConfig config;
+    config.headroom = 2.0;
+    config.growthFactor = 2.0;
+    config.maxShrinkFactor = 0.5;
+    config.minimumSize = 10;
+    QueueSizeAdvisor advisor( config, nullptr );
+    uint64_t busyOccupancy = 0;
+    uint64_t busyDropped = 5;
+    advisor.registerQueue(
+        "Busy", [&busyOccupancy]() { return busyOccupancy; }, [&busyDropped]() { return busyDropped; }, 100, 8 );
+    uint64_t quietOccupancy = 0;
+    advisor.registerQueue( "Quiet", [&quietOccupancy]() { return quietOccupancy; }, nullptr, 1000, 8 );
+    advisor.registerQueue( "Idle", []() { return 0; }, nullptr, 4, 8 );
+
+    busyOccupancy = 80;
+    quietOccupancy = 300;
+    advisor.sample();
+    busyOccupancy = 10;
+    quietOccupancy = 30;
+    advisor.sample();
+
+    auto sizes = advisor.recommend();
+    // High-water mark with headroom
+    ASSERT_EQ( sizes["Busy"], 160U );
+    ASSERT_EQ( sizes["Quiet"], 600U );
+    ASSERT_EQ( sizes["Idle"], 10U );
+    ASSERT_EQ( TraceModule::get().getNamedVariable( "queueHighWater_Busy" ), 80 );
+    // Drops before the registration are not counted
+    ASSERT_EQ( TraceModule::get().getNamedVariable( "queueDropped_Busy" ), 0 );
+
+    // Dropped data grows the queue at least by the growth factor
+    busyDropped = 6;
+    quietOccupancy = 0;
+    sizes = advisor.recommend();
+    ASSERT_EQ( sizes["Busy"], 200U );
+    ASSERT_EQ( TraceModule::get().getNamedVariable( "queueDropped_Busy" ), 1 );
+    ASSERT_EQ( TraceModule::get().getNamedVariable( "queueRecommendedSize_Busy" ), 200 );
+
+    // Shrinking is limited per run
+    QueueSizeAdvisor oversized( config, nullptr );
+    oversized.registerQueue( "Oversized", []() { return 1; }, nullptr, 10000, 8 );
+    oversized.sample();
+    ASSERT_EQ( oversized.recommend()["Oversized"], 5000U );
+}
+
+/**
+ * @brief Validates that all queues are scaled down together to stay within the memory ceiling
+ */
+TEST_F( QueueSizeAdvisorTest, MemoryCeiling )
+{
+    QueueSizingConfig config;
+    config.headroom = 1.0;
+    config.maxShrinkFactor = 0.0;
+    config.minimumSize = 10;
+    config.memoryCeilingBytes = 1000;
+    QueueSizeAdvisor advisor( config, nullptr );
+    advisor.registerQueue( "A", []() { return 100; }, nullptr, 100, 8 );
+    advisor.registerQueue( "B", []() { return 300; }, nullptr, 300, 1 );
+    advisor.sample();
+
+    auto sizes = advisor.recommend();
+    // 1100 bytes are scaled to the 1000 bytes of the ceiling
+    ASSERT_EQ( sizes["A"], 90U );
+    ASSERT_EQ( sizes["B"], 272U );
+    ASSERT_LE( sizes["A"] * 8 + sizes["B"], config.memoryCeilingBytes );
+}
+
+/**
+ * @brief Validates that the sizes of one run are used on the next start
+ */
+TEST_F( QueueSizeAdvisorTest, SizesPersistedForNextStart )
+{
+    QueueSizingConfig config;
+    config.minimumSize = 1;
+    {
+        QueueSizeAdvisor advisor( config, mPersistency );
+        ASSERT_FALSE( advisor.load() );
+        ASSERT_EQ( advisor.getSize( "Signals", 10000 ), 10000U );
+        advisor.registerQueue( "Signals", []() { return 3000; }, nullptr, 10000, 8 );
+        advisor.registerQueue( "Frames", []() { return 200; }, nullptr, 100, 8 );
+        ASSERT_TRUE( advisor.start() );
+        // Samples at least once before stopping
+        std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+        ASSERT_TRUE( advisor.stop() );
+    }
+
+    QueueSizeAdvisor advisor( config, mPersistency );
+    ASSERT_TRUE( advisor.load() );
+    ASSERT_EQ( advisor.getSize( "Signals", 10000 ), 6000U );
+    ASSERT_EQ( advisor.getSize( "Frames", 100 ), 400U );
+    ASSERT_EQ( advisor.getSize( "Unknown", 123 ), 123U );
+
+    // Sizes of another format are ignored
+    std::string invalid = "QueueSizes 0\nSignals 1\n";
+    ASSERT_EQ( mPersistency->write(
+                   reinterpret_cast<const uint8_t *>( invalid.data() ), invalid.size(), DataType::QUEUE_SIZES ),
+               ErrorCode::SUCCESS );
+    ASSERT_FALSE( advisor.load() );
+    ASSERT_EQ( advisor.getSize( "Signals", 10000 ), 10000U );
+}
@@ -0,0 +1,268 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "RemoteInspectionProtocol.h"
+#include "RemoteInspectionReceiver.h"
+#include "RemoteInspectionSender.h"
+#include <chrono>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+using namespace Aws::IoTFleetWise::DataInspection;
+
+static CollectedCanFrameWithSignals
+makeFrame( CANRawFrameID frameID, uint8_t size, uint8_t decodedSignalCount )
+{
+    std::array<uint8_t, MAX_CANFD_FRAME_BYTE_SIZE> data{};
+    for ( uint8_t i = 0; i < size; i++ )
+    {
+        data[i] = static_cast<uint8_t>( frameID + i );
+    }
+    CollectedCanFrameWithSignals frame( CollectedCanRawFrame( frameID, 3, 1000 + frameID, data, size ) );
+    frame.receiveTimeFractionUs = 999;
+    frame.decodedSignalCount = decodedSignalCount;
+    for ( uint8_t i = 0; i < decodedSignalCount; i++ )
+    {
+        frame.decodedSignals[i].signalID = 100 + i;
+        frame.decodedSignals[i].value = -0.5 * i;
+    }
+    return frame;
+}
+
+TEST( RemoteInspectionTest, BatchRoundTrip )
+{
+    RemoteInspectionBatch batch;
+    ASSERT_TRUE( batch.empty() );
+    CollectedSignal signal( 7, 1234567890123, 3.25 );
+    signal.receiveTimeFractionUs = 456;
+    ASSERT_TRUE( batch.addSignal( signal ) );
+    ASSERT_TRUE( batch.addFrame( makeFrame( 0x123, 8, 2 ) ) );
+    ASSERT_TRUE( batch.addFrame( makeFrame( 0x7FF, MAX_CANFD_FRAME_BYTE_SIZE, 0 ) ) );
+    ASSERT_FALSE( batch.empty() );
+    auto datagram = batch.finish( 0xFFFFFFFE );
+    ASSERT_EQ( datagram.size(),
+               RemoteInspectionBatch::HEADER_SIZE + RemoteInspectionBatch::SIGNAL_SIZE +
+                   ( 2 * RemoteInspectionBatch::FRAME_HEADER_SIZE ) + 8 + MAX_CANFD_FRAME_BYTE_SIZE +
+                   ( 2 * RemoteInspectionBatch::DECODED_SIGNAL_SIZE ) );
+
+    uint32_t sequence = 0;
+    std::vector<CollectedSignal> signals;
+    std::vector<CollectedCanFrameWithSignals> frames;
+    ASSERT_TRUE( RemoteInspectionBatch::decode( datagram.data(), datagram.size(), sequence, signals, frames ) );
+    ASSERT_EQ( sequence, 0xFFFFFFFE );
+    ASSERT_EQ( signals.size(), 1 );
+    EXPECT_EQ( signals[0].signalID, 7 );
+    EXPECT_EQ( signals[0].receiveTime, 1234567890123 );
+    EXPECT_EQ( signals[0].receiveTimeFractionUs, 456 );
+    EXPECT_DOUBLE_EQ( signals[0].value, 3.25 );
+    // The index of the local manifest is not sent
+    EXPECT_EQ( signals[0].signalIndex, INVALID_MANIFEST_SIGNAL_INDEX );
+    ASSERT_EQ( frames.size(), 2 );
+    EXPECT_EQ( frames[0].frameID, 0x123 );
+    EXPECT_EQ( frames[0].channelId, 3 );
+    EXPECT_EQ( frames[0].receiveTime, 1000 + 0x123 );
+    EXPECT_EQ( frames[0].receiveTimeFractionUs, 999 );
+    ASSERT_EQ( frames[0].size, 8 );
+    EXPECT_EQ( frames[0].data[7], static_cast<uint8_t>( 0x123 + 7 ) );
+    ASSERT_EQ( frames[0].decodedSignalCount, 2 );
+    EXPECT_EQ( frames[0].decodedSignals[1].signalID, 101 );
+    EXPECT_DOUBLE_EQ( frames[0].decodedSignals[1].value, -0.5 );
+    ASSERT_EQ( frames[1].size, MAX_CANFD_FRAME_BYTE_SIZE );
+    EXPECT_EQ( frames[1].data[63], static_cast<uint8_t>( 0x7FF + 63 ) );
+    EXPECT_EQ( frames[1].decodedSignalCount, 0 );
+
+    batch.clear();
+    ASSERT_TRUE( batch.empty() );
+}
+
+TEST( RemoteInspectionTest, BatchFull )
+{
+    RemoteInspectionBatch batch( RemoteInspectionBatch::HEADER_SIZE + 20 * RemoteInspectionBatch::SIGNAL_SIZE );
+    // The batch can always take the largest frame
+    ASSERT_TRUE( batch.addFrame( makeFrame( 1, MAX_CANFD_FRAME_BYTE_SIZE, 8 ) ) );
+    batch.clear();
+    size_t count = 0;
+    while ( batch.addSignal( CollectedSignal( 1, 1, 1.0 ) ) )
+    {
+        count++;
+    }
+    ASSERT_EQ( count, 20 );
+    ASSERT_EQ( batch.finish( 0 ).size(), RemoteInspectionBatch::HEADER_SIZE + 20 * RemoteInspectionBatch::SIGNAL_SIZE );
+}
+
+TEST( RemoteInspectionTest, InvalidDatagrams )
+{
+    RemoteInspectionBatch batch;
+    ASSERT_TRUE( batch.addSignal( CollectedSignal( 1, 1, 1.0 ) ) );
+    ASSERT_TRUE( batch.addFrame( makeFrame( 2, 8, 1 ) ) );
+    auto datagram = batch.finish( 1 );
+    uint32_t sequence = 0;
+    std::vector<CollectedSignal> signals;
+    std::vector<CollectedCanFrameWithSignals> frames;
+    // Truncated
+    ASSERT_FALSE( RemoteInspectionBatch::decode( datagram.data(), datagram.size() - 1, sequence, signals, frames ) );
+    ASSERT_FALSE( RemoteInspectionBatch::decode( datagram.data(), 10, sequence, signals, frames ) );
+    ASSERT_TRUE( signals.empty() );
+    ASSERT_TRUE( frames.empty() );
+    // Trailing bytes
+    auto longer = datagram;
+    longer.push_back( 0 );
+    ASSERT_FALSE( RemoteInspectionBatch::decode( longer.data(), longer.size(), sequence, signals, frames ) );
+    // Other protocol
+    auto otherMagic = datagram;
+    otherMagic[0]++;
+    ASSERT_FALSE( RemoteInspectionBatch::decode( otherMagic.data(), otherMagic.size(), sequence, signals, frames ) );
+    auto otherVersion = datagram;
+    otherVersion[4]++;
+    ASSERT_FALSE(
+        RemoteInspectionBatch::decode( otherVersion.data(), otherVersion.size(), sequence, signals, frames ) );
+    ASSERT_TRUE( signals.empty() );
+    ASSERT_TRUE( frames.empty() );
+
+    auto signalBuffer = std::make_shared<SignalBuffer>( 10 );
+    auto canBuffer = std::make_shared<CANBuffer>( 10 );
+    RemoteInspectionReceiver receiver;
+    ASSERT_TRUE( receiver.init( signalBuffer, canBuffer, "127.0.0.1", 1 ) );
+    receiver.handleDatagram( longer.data(), longer.size() );
+    ASSERT_EQ( receiver.getInvalidDatagrams(), 1 );
+    ASSERT_EQ( receiver.getReceivedBatches(), 0 );
+    ASSERT_TRUE( signalBuffer->empty() );
+}
+
+TEST( RemoteInspectionTest, InvalidConfig )
+{
+    auto signalBuffer = std::make_shared<SignalBuffer>( 10 );
+    auto canBuffer = std::make_shared<CANBuffer>( 10 );
+    RemoteInspectionSender sender;
+    ASSERT_FALSE( sender.init( nullptr, canBuffer, "127.0.0.1", 1, 0, 0 ) );
+    ASSERT_FALSE( sender.init( signalBuffer, canBuffer, "localhost", 1, 0, 0 ) );
+    ASSERT_FALSE( sender.init( signalBuffer, canBuffer, "127.0.0.1", 0, 0, 0 ) );
+    ASSERT_FALSE( sender.connect() );
+    RemoteInspectionReceiver receiver;
+    ASSERT_FALSE( receiver.init( signalBuffer, nullptr, "0.0.0.0", 1 ) );
+    ASSERT_FALSE( receiver.init( signalBuffer, canBuffer, "::1", 1 ) );
+    ASSERT_FALSE( receiver.connect() );
+}
+
+TEST( RemoteInspectionTest, LostAndReorderedBatches )
+{
+    auto signalBuffer = std::make_shared<SignalBuffer>( 100 );
+    auto canBuffer = std::make_shared<CANBuffer>( 100 );
+    auto dataAvailable = std::make_shared<Aws::IoTFleetWise::Platform::Linux::Signal>();
+    RemoteInspectionReceiver receiver;
+    ASSERT_TRUE( receiver.init( signalBuffer, canBuffer, "127.0.0.1", 1 ) );
+    receiver.setOutputDataAvailableSignal( dataAvailable );
+
+    RemoteInspectionBatch batch;
+    auto receive = [&]( uint32_t sequence ) {
+        batch.clear();
+        batch.addSignal( CollectedSignal( sequence, 1, 1.0 ) );
+        const auto &datagram = batch.finish( sequence );
+        receiver.handleDatagram( datagram.data(), datagram.size() );
+    };
+    receive( 10 );
+    receive( 11 );
+    ASSERT_EQ( receiver.getLostBatches(), 0 );
+    receive( 14 );
+    ASSERT_EQ( receiver.getLostBatches(), 2 );
+    // Overtaken by 14
+    receive( 13 );
+    ASSERT_EQ( receiver.getLostBatches(), 1 );
+    receive( 15 );
+    ASSERT_EQ( receiver.getLostBatches(), 1 );
+    // The sender restarted
+    receive( 0 );
+    receive( 1 );
+    ASSERT_EQ( receiver.getLostBatches(), 1 );
+    ASSERT_EQ( receiver.getReceivedBatches(), 7 );
+
+    std::vector<SignalID> signalIDs;
+    CollectedSignal signal;
+    while ( signalBuffer->pop( signal ) )
+    {
+        signalIDs.push_back( signal.signalID );
+    }
+    ASSERT_EQ( signalIDs, std::vector<SignalID>( { 10, 11, 14, 13, 15, 0, 1 } ) );
+}
+
+TEST( RemoteInspectionTest, SendAndReceive )
+{
+    // Inspection side, on a port chosen by the kernel so that parallel runs do not collide
+    auto signalBuffer = std::make_shared<SignalBuffer>( 1000 );
+    auto canBuffer = std::make_shared<CANBuffer>( 1000 );
+    auto dataAvailable = std::make_shared<Aws::IoTFleetWise::Platform::Linux::Signal>();
+    RemoteInspectionReceiver receiver;
+    ASSERT_TRUE( receiver.init( signalBuffer, canBuffer, "127.0.0.1", 0 ) );
+    receiver.setOutputDataAvailableSignal( dataAvailable );
+    ASSERT_TRUE( receiver.connect() );
+    ASSERT_NE( receiver.getPort(), 0 );
+    // Acquisition side
+    auto gatewaySignalBuffer = std::make_shared<SignalBuffer>( 1000 );
+    auto gatewayCANBuffer = std::make_shared<CANBuffer>( 1000 );
+    RemoteInspectionSender sender;
+    ASSERT_TRUE( sender.init( gatewaySignalBuffer, gatewayCANBuffer, "127.0.0.1", receiver.getPort(), 0, 5 ) );
+    ASSERT_TRUE( sender.connect() );
+    ASSERT_TRUE( sender.isAlive() );
+    ASSERT_TRUE( receiver.isAlive() );
+
+    // More than fit into one datagram
+    for ( uint32_t i = 0; i < 200; i++ )
+    {
+        ASSERT_TRUE( gatewaySignalBuffer->push( CollectedSignal( i, 5000 + i, i * 0.5 ) ) );
+    }
+    ASSERT_TRUE( gatewayCANBuffer->push( makeFrame( 0x100, 8, 1 ) ) );
+    sender.getDataAvailableSignal()->notify();
+
+    std::vector<CollectedSignal> signals;
+    std::vector<CollectedCanFrameWithSignals> frames;
+    for ( int i = 0; ( i < 1000 ) && ( ( signals.size() < 200 ) || frames.empty() ); i++ )
+    {
+        dataAvailable->wait( 1 );
+        CollectedSignal signal;
+        while ( signalBuffer->pop( signal ) )
+        {
+            signals.emplace_back( signal );
+        }
+        CollectedCanFrameWithSignals frame;
+        while ( canBuffer->pop( frame ) )
+        {
+            frames.emplace_back( frame );
+        }
+    }
+    ASSERT_EQ( signals.size(), 200 );
+    for ( uint32_t i = 0; i < 200; i++ )
+    {
+        EXPECT_EQ( signals[i].signalID, i );
+        EXPECT_EQ( signals[i].receiveTime, 5000 + i );
+        EXPECT_DOUBLE_EQ( signals[i].value, i * 0.5 );
+    }
+    ASSERT_EQ( frames.size(), 1 );
+    EXPECT_EQ( frames[0].frameID, 0x100 );
+    EXPECT_EQ( frames[0].decodedSignals[0].signalID, 100 );
+
+    // The sender counts a batch after the receiver may already have passed on its data
+    ASSERT_TRUE( sender.disconnect() );
+    EXPECT_GE( sender.getSentBatches(), 4 );
+    EXPECT_EQ( sender.getFailedBatches(), 0 );
+    for ( int i = 0; ( i < 1000 ) && ( receiver.getReceivedBatches() < sender.getSentBatches() ); i++ )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+    EXPECT_EQ( receiver.getReceivedBatches(), sender.getSentBatches() );
+    EXPECT_EQ( receiver.getLostBatches(), 0 );
+    EXPECT_EQ( receiver.getDroppedData(), 0 );
+    ASSERT_TRUE( receiver.disconnect() );
+    ASSERT_FALSE( sender.isAlive() );
+    ASSERT_FALSE( receiver.isAlive() );
+}
@@ -0,0 +1,181 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "SharedMemorySignalSource.h"
+#include <chrono>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+using namespace Aws::IoTFleetWise::DataInspection;
+
+class SharedMemorySignalSourceTest : public ::testing::Test
+{
+protected:
+    void
+    SetUp() override
+    {
+        shm_unlink( SHM_NAME );
+    }
+
+    void
+    TearDown() override
+    {
+        shm_unlink( SHM_NAME );
+    }
+
+    static std::vector<CollectedSignal>
+    popSignals( const SignalBufferPtr &signalBuffer, size_t expectedSignals )
+    {
+        std::vector<CollectedSignal> signals;
+        for ( int i = 0; ( i < 1000 ) && ( signals.size() < expectedSignals ); i++ )
+        {
+            CollectedSignal signal;
+            while ( signalBuffer->pop( signal ) )
+            {
+                signals.emplace_back( signal );
+            }
+            std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+        }
+        return signals;
+    }
+
+    static constexpr const char *SHM_NAME = "/fwe-shared-memory-signal-source-test";
+};
+
+TEST_F( SharedMemorySignalSourceTest, InvalidConfig )
+{
+    SharedMemorySignalSource source;
+    auto signalBuffer = std::make_shared<SignalBuffer>( 10 );
+    ASSERT_FALSE( source.init( nullptr, SHM_NAME, 16, 1 ) );
+    ASSERT_FALSE( source.init( signalBuffer, "no-slash", 16, 1 ) );
+    ASSERT_FALSE( source.init( signalBuffer, "/a/b", 16, 1 ) );
+    ASSERT_FALSE( source.init( signalBuffer, SHM_NAME, 0, 1 ) );
+    ASSERT_FALSE( source.init( signalBuffer, SHM_NAME, 12, 1 ) );
+    ASSERT_FALSE( source.connect() );
+}
+
+TEST_F( SharedMemorySignalSourceTest, ProducerNotConnected )
+{
+    ASSERT_EQ( fwe_shm_signal_ring_open( SHM_NAME ), nullptr );
+}
+
+TEST_F( SharedMemorySignalSourceTest, ReceiveSignals )
+{
+    auto signalBuffer = std::make_shared<SignalBuffer>( 100 );
+    auto dataAvailable = std::make_shared<Aws::IoTFleetWise::Platform::Linux::Signal>();
+    SharedMemorySignalSource source;
+    ASSERT_TRUE( source.init( signalBuffer, SHM_NAME, 16, 1 ) );
+    source.setOutputDataAvailableSignal( dataAvailable );
+    ASSERT_TRUE( source.connect() );
+    ASSERT_TRUE( source.isAlive() );
+
+    auto *ring = fwe_shm_signal_ring_open( SHM_NAME );
+    ASSERT_NE( ring, nullptr );
+    ASSERT_EQ( ring->capacity, 16 );
+    ASSERT_EQ( fwe_shm_signal_ring_push( ring, 1, 1000, 1.5 ), 1 );
+    ASSERT_EQ( fwe_shm_signal_ring_push( ring, 2, 0, -2.0 ), 1 );
+    ASSERT_EQ( fwe_shm_signal_ring_push( ring, 3, 1001, 3.0 ), 1 );
+
+    auto signals = popSignals( signalBuffer, 3 );
+    ASSERT_EQ( signals.size(), 3 );
+    EXPECT_EQ( signals[0].signalID, 1 );
+    EXPECT_EQ( signals[0].receiveTime, 1000 );
+    EXPECT_DOUBLE_EQ( signals[0].value, 1.5 );
+    EXPECT_EQ( signals[1].signalID, 2 );
+    // Without a producer timestamp the time of the read is used
+    EXPECT_GT( signals[1].receiveTime, 1001 );
+    EXPECT_DOUBLE_EQ( signals[1].value, -2.0 );
+    EXPECT_EQ( signals[2].signalID, 3 );
+    EXPECT_EQ( source.getReceivedSignals(), 3 );
+    EXPECT_EQ( source.getDroppedSignals(), 0 );
+
+    fwe_shm_signal_ring_close( ring );
+    ASSERT_TRUE( source.disconnect() );
+}
+
+TEST_F( SharedMemorySignalSourceTest, BackPressure )
+{
+    // The Signal Buffer can only take 4 signals, the rest stays in the shared ring until it is full
+    auto signalBuffer = std::make_shared<SignalBuffer>( 4 );
+    SharedMemorySignalSource source;
+    ASSERT_TRUE( source.init( signalBuffer, SHM_NAME, 8, 1 ) );
+    ASSERT_TRUE( source.connect() );
+    auto *ring = fwe_shm_signal_ring_open( SHM_NAME );
+    ASSERT_NE( ring, nullptr );
+    for ( uint32_t i = 0; i < 4; i++ )
+    {
+        ASSERT_EQ( fwe_shm_signal_ring_push( ring, i, 1000 + i, i ), 1 );
+    }
+    for ( int i = 0; ( i < 1000 ) && ( source.getReceivedSignals() < 4 ); i++ )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+    ASSERT_EQ( source.getReceivedSignals(), 4 );
+    for ( uint32_t i = 4; i < 12; i++ )
+    {
+        ASSERT_EQ( fwe_shm_signal_ring_push( ring, i, 1000 + i, i ), 1 );
+    }
+    ASSERT_EQ( fwe_shm_signal_ring_push( ring, 12, 1012, 12 ), 0 );
+    ASSERT_EQ( ring->dropped, 1 );
+
+    // Nothing is lost once the inspection catches up
+    auto signals = popSignals( signalBuffer, 12 );
+    ASSERT_EQ( signals.size(), 12 );
+    for ( uint32_t i = 0; i < 12; i++ )
+    {
+        EXPECT_EQ( signals[i].signalID, i );
+    }
+    EXPECT_EQ( source.getDroppedSignals(), 1 );
+    fwe_shm_signal_ring_close( ring );
+    ASSERT_TRUE( source.disconnect() );
+}
+
+TEST_F( SharedMemorySignalSourceTest, ReuseRingAfterReconnect )
+{
+    auto signalBuffer = std::make_shared<SignalBuffer>( 100 );
+    {
+        SharedMemorySignalSource source;
+        ASSERT_TRUE( source.init( signalBuffer, SHM_NAME, 16, 1 ) );
+        ASSERT_TRUE( source.connect() );
+        ASSERT_TRUE( source.disconnect() );
+    }
+    // The producer keeps pushing while FWE is not running
+    auto *ring = fwe_shm_signal_ring_open( SHM_NAME );
+    ASSERT_NE( ring, nullptr );
+    ASSERT_EQ( fwe_shm_signal_ring_push( ring, 7, 1000, 7.0 ), 1 );
+
+    SharedMemorySignalSource source;
+    ASSERT_TRUE( source.init( signalBuffer, SHM_NAME, 16, 1 ) );
+    ASSERT_TRUE( source.connect() );
+    auto signals = popSignals( signalBuffer, 1 );
+    ASSERT_EQ( signals.size(), 1 );
+    EXPECT_EQ( signals[0].signalID, 7 );
+    ASSERT_EQ( fwe_shm_signal_ring_push( ring, 8, 1001, 8.0 ), 1 );
+    signals = popSignals( signalBuffer, 1 );
+    ASSERT_EQ( signals.size(), 1 );
+    EXPECT_EQ( signals[0].signalID, 8 );
+    fwe_shm_signal_ring_close( ring );
+    ASSERT_TRUE( source.disconnect() );
+
+    // A ring with another capacity is replaced
+    SharedMemorySignalSource otherSource;
+    ASSERT_TRUE( otherSource.init( signalBuffer, SHM_NAME, 32, 1 ) );
+    ASSERT_TRUE( otherSource.connect() );
+    ring = fwe_shm_signal_ring_open( SHM_NAME );
+    ASSERT_NE( ring, nullptr );
+    EXPECT_EQ( ring->capacity, 32 );
+    EXPECT_EQ( ring->write_index, 0 );
+    fwe_shm_signal_ring_close( ring );
+    ASSERT_TRUE( otherSource.disconnect() );
+}
@@ -0,0 +1,149 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "SignalAggregation.h"
+#include <gtest/gtest.h>
+#include <limits>
+
+using namespace Aws::IoTFleetWise::DataInspection;
+
+TEST( SignalAggregationTest, QuantileSketchRelativeAccuracy )
+{
+    QuantileSketch sketch;
+    ASSERT_DOUBLE_EQ( sketch.getQuantile( 0.5 ), 0.0 );
+    for ( int i = 1; i <= 10000; i++ )
+    {
+        sketch.add( static_cast<double>( i ) );
+    }
+    sketch.add( std::numeric_limits<double>::quiet_NaN() );
+    ASSERT_EQ( sketch.getCount(), 10000 );
+    for ( auto quantile : { 0.0, 0.1, 0.5, 0.9, 0.99, 1.0 } )
+    {
+        auto exact = 1.0 + quantile * 9999.0;
+        ASSERT_NEAR( sketch.getQuantile( quantile ), exact, exact * QuantileSketch::RELATIVE_ACCURACY + 1.0 );
+    }
+    sketch.clear();
+    ASSERT_EQ( sketch.getCount(), 0 );
+}
+
+TEST( SignalAggregationTest, QuantileSketchNegativeAndZeroValues )
+{
+    QuantileSketch sketch;
+    for ( int i = -50; i <= 50; i++ )
+    {
+        sketch.add( static_cast<double>( i ) );
+    }
+    ASSERT_NEAR( sketch.getQuantile( 0.0 ), -50.0, 0.5 );
+    ASSERT_DOUBLE_EQ( sketch.getQuantile( 0.5 ), 0.0 );
+    ASSERT_NEAR( sketch.getQuantile( 0.25 ), -25.0, 0.5 );
+    ASSERT_NEAR( sketch.getQuantile( 1.0 ), 50.0, 0.5 );
+}
+
+TEST( SignalAggregationTest, QuantileSketchBucketsBounded )
+{
+    QuantileSketch sketch;
+    // Spans far more buckets than MAX_BUCKETS, the lowest ones are merged
+    double value = 1e-6;
+    for ( int i = 0; i < 5000; i++ )
+    {
+        sketch.add( value );
+        value *= 1.05;
+    }
+    ASSERT_EQ( sketch.getCount(), 5000 );
+    auto max = value / 1.05;
+    ASSERT_NEAR( sketch.getQuantile( 1.0 ), max, max * QuantileSketch::RELATIVE_ACCURACY );
+}
+
+TEST( SignalAggregationTest, SelectedSummaryValues )
+{
+    auto info = std::make_shared<SignalAggregationInfo>();
+    info->count = true;
+    info->mean = true;
+    info->variance = true;
+    info->histogramBounds = { 2.0, 4.0 };
+    info->percentiles = { 50.0 };
+    SignalAggregator aggregator( 5, 0, info );
+    for ( auto value : { 1.0, 2.0, 3.0, 4.0, 5.0 } )
+    {
+        aggregator.addValue( value );
+    }
+    aggregator.finishWindow( 1000, 100, 5, 1.0, 5.0, 15.0 );
+    // Empty windows do not add a summary
+    aggregator.finishWindow( 1100, 100, 0, 0.0, 0.0, 0.0 );
+    std::vector<SignalSummary> summaries;
+    aggregator.takeSummaries( summaries );
+    ASSERT_EQ( summaries.size(), 1 );
+    const auto &summary = summaries[0];
+    ASSERT_EQ( summary.signalID, 5 );
+    ASSERT_EQ( summary.windowStartTime, 1000 );
+    ASSERT_EQ( summary.windowSizeMs, 100 );
+    ASSERT_EQ( summary.count, 5 );
+    // Not selected
+    ASSERT_DOUBLE_EQ( summary.min, 0.0 );
+    ASSERT_DOUBLE_EQ( summary.max, 0.0 );
+    ASSERT_DOUBLE_EQ( summary.mean, 3.0 );
+    ASSERT_DOUBLE_EQ( summary.variance, 2.0 );
+    ASSERT_EQ( summary.histogramCounts, ( std::vector<uint32_t>{ 2, 2, 1 } ) );
+    ASSERT_EQ( summary.percentileValues.size(), 1 );
+    ASSERT_NEAR( summary.percentileValues[0], 3.0, 3.0 * QuantileSketch::RELATIVE_ACCURACY );
+
+    // The next window starts from scratch
+    aggregator.addValue( 10.0 );
+    aggregator.finishWindow( 1200, 100, 1, 10.0, 10.0, 10.0 );
+    summaries.clear();
+    aggregator.takeSummaries( summaries );
+    ASSERT_EQ( summaries.size(), 1 );
+    ASSERT_DOUBLE_EQ( summaries[0].variance, 0.0 );
+    ASSERT_EQ( summaries[0].histogramCounts, ( std::vector<uint32_t>{ 0, 0, 1 } ) );
+    aggregator.takeSummaries( summaries );
+    ASSERT_EQ( summaries.size(), 1 );
+}
+
+TEST( SignalAggregationTest, SkipAndTakeOver )
+{
+    auto info = std::make_shared<SignalAggregationInfo>();
+    info->max = true;
+    SignalAggregator aggregator( 1, 0, info );
+    aggregator.skipCurrentWindow();
+    aggregator.finishWindow( 0, 100, 3, 1.0, 3.0, 6.0 );
+    aggregator.finishWindow( 100, 100, 2, 1.0, 7.0, 8.0 );
+
+    auto sameInfo = std::make_shared<SignalAggregationInfo>( *info );
+    ASSERT_TRUE( SignalAggregator::isSameAggregation( *info, *sameInfo ) );
+    sameInfo->percentiles = { 90.0 };
+    ASSERT_FALSE( SignalAggregator::isSameAggregation( *info, *sameInfo ) );
+
+    SignalAggregator next( 1, 3, info );
+    next.takeOver( aggregator );
+    ASSERT_EQ( next.getConditionIndex(), 3 );
+    std::vector<SignalSummary> summaries;
+    next.takeSummaries( summaries );
+    ASSERT_EQ( summaries.size(), 1 );
+    ASSERT_EQ( summaries[0].windowStartTime, 100 );
+    ASSERT_DOUBLE_EQ( summaries[0].max, 7.0 );
+}
+
+TEST( SignalAggregationTest, PendingSummariesBounded )
+{
+    auto info = std::make_shared<SignalAggregationInfo>();
+    info->count = true;
+    SignalAggregator aggregator( 1, 0, info );
+    for ( uint32_t i = 0; i < SignalAggregator::MAX_PENDING_SUMMARIES + 5; i++ )
+    {
+        aggregator.finishWindow( i * 10, 10, 1, 0.0, 0.0, 0.0 );
+    }
+    std::vector<SignalSummary> summaries;
+    aggregator.takeSummaries( summaries );
+    ASSERT_EQ( summaries.size(), SignalAggregator::MAX_PENDING_SUMMARIES );
+    ASSERT_EQ( summaries.front().windowStartTime, 50 );
+}
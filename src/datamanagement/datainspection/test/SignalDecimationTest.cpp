@@ -0,0 +1,128 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "SignalDecimation.h"
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace Aws::IoTFleetWise::DataInspection;
+
+namespace
+{
+// A slowly rising signal every 10 ms with a single peak, newest sample first as collected from the buffers
+std::vector<CollectedSignal>
+getSamplesWithPeak( uint32_t count, uint32_t peakIndex )
+{
+    std::vector<CollectedSignal> samples;
+    for ( uint32_t i = count; i > 0; i-- )
+    {
+        auto index = i - 1;
+        samples.emplace_back( 1, 1000000 + ( index * 10 ), ( index == peakIndex ) ? 1000.0 : index * 0.01 );
+    }
+    return samples;
+}
+
+bool
+isSortedByTime( const std::vector<CollectedSignal> &samples, size_t first )
+{
+    return std::is_sorted( samples.begin() + static_cast<std::ptrdiff_t>( first ),
+                           samples.end(),
+                           []( const CollectedSignal &a, const CollectedSignal &b ) {
+                               return a.receiveTime < b.receiveTime;
+                           } );
+}
+
+bool
+hasValue( const std::vector<CollectedSignal> &samples, double value )
+{
+    return std::any_of( samples.begin(), samples.end(), [value]( const CollectedSignal &sample ) {
+        return sample.value == value;
+    } );
+}
+} // namespace
+
+TEST( SignalDecimationTest, LargestTriangleThreeBucketsKeepsPeakAndEnds )
+{
+    auto samples = getSamplesWithPeak( 1000, 437 );
+    SignalDecimationInfo info;
+    info.maxSamples = 50;
+    decimateSignalSamples( info, samples, 0 );
+    ASSERT_EQ( samples.size(), 50 );
+    ASSERT_TRUE( isSortedByTime( samples, 0 ) );
+    ASSERT_EQ( samples.front().receiveTime, 1000000 );
+    ASSERT_EQ( samples.back().receiveTime, 1000000 + 999 * 10 );
+    ASSERT_TRUE( hasValue( samples, 1000.0 ) );
+}
+
+TEST( SignalDecimationTest, MinMaxKeepsExtremesPerBucket )
+{
+    auto samples = getSamplesWithPeak( 1000, 3 );
+    SignalDecimationInfo info;
+    info.method = SignalDecimationMethod::MIN_MAX;
+    info.maxSamples = 20;
+    decimateSignalSamples( info, samples, 0 );
+    ASSERT_EQ( samples.size(), 20 );
+    ASSERT_TRUE( isSortedByTime( samples, 0 ) );
+    ASSERT_TRUE( hasValue( samples, 1000.0 ) );
+    // The smallest and largest sample of each bucket of 100 samples
+    ASSERT_EQ( samples[0].receiveTime, 1000000 );
+    ASSERT_EQ( samples[1].receiveTime, 1000000 + 3 * 10 );
+    ASSERT_EQ( samples[2].receiveTime, 1000000 + 100 * 10 );
+    ASSERT_EQ( samples[3].receiveTime, 1000000 + 199 * 10 );
+}
+
+TEST( SignalDecimationTest, UniformKeepsClosestSamplesOfGrid )
+{
+    // Irregular timestamps, the grid points are 0, 100, 200, ... ms after the first sample
+    std::vector<CollectedSignal> samples;
+    for ( uint32_t i = 0; i < 500; i++ )
+    {
+        samples.emplace_back( 1, 5000 + ( i * 2 ) + ( i % 2 ), static_cast<double>( i ) );
+    }
+    samples.back().receiveTime = 5000 + 1000;
+    std::reverse( samples.begin(), samples.end() );
+    SignalDecimationInfo info;
+    info.method = SignalDecimationMethod::UNIFORM;
+    info.maxSamples = 11;
+    decimateSignalSamples( info, samples, 0 );
+    ASSERT_EQ( samples.size(), 11 );
+    ASSERT_TRUE( isSortedByTime( samples, 0 ) );
+    for ( uint32_t i = 0; i < samples.size(); i++ )
+    {
+        ASSERT_NEAR( static_cast<double>( samples[i].receiveTime ), 5000.0 + i * 100.0, 1.0 );
+    }
+}
+
+TEST( SignalDecimationTest, OnlyTheRangeOfTheSignalIsDecimated )
+{
+    std::vector<CollectedSignal> samples;
+    samples.emplace_back( 2, 10, 1.0 );
+    samples.emplace_back( 2, 5, 2.0 );
+    auto decimated = getSamplesWithPeak( 100, 50 );
+    samples.insert( samples.end(), decimated.begin(), decimated.end() );
+    SignalDecimationInfo info;
+    info.maxSamples = 10;
+    decimateSignalSamples( info, samples, 2 );
+    ASSERT_EQ( samples.size(), 12 );
+    ASSERT_EQ( samples[0].receiveTime, 10 );
+    ASSERT_EQ( samples[1].receiveTime, 5 );
+    ASSERT_TRUE( isSortedByTime( samples, 2 ) );
+
+    // Fewer samples than the maximum are only sorted
+    info.maxSamples = 20;
+    decimateSignalSamples( info, samples, 2 );
+    ASSERT_EQ( samples.size(), 12 );
+    decimateSignalSamples( info, samples, 12 );
+    ASSERT_EQ( samples.size(), 12 );
+}
@@ -0,0 +1,99 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "TriggeredCollectionSchemeDataPool.h"
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace Aws::IoTFleetWise::DataInspection;
+
+TEST( TriggeredCollectionSchemeDataPoolTest, ReleasedDataIsClearedAndReused )
+{
+    auto pool = std::make_shared<TriggeredCollectionSchemeDataPool>();
+    pool->resize( 2, 100, 10 );
+    ASSERT_EQ( pool->getFreeCount(), 2 );
+    auto data = pool->acquire();
+    ASSERT_NE( data, nullptr );
+    EXPECT_GE( data->signals.capacity(), 100 );
+    EXPECT_GE( data->canFrames.capacity(), 10 );
+    EXPECT_EQ( pool->getUsedCount(), 1 );
+    data->metaData.collectionSchemeID = "scheme";
+    data->triggerTime = 1000;
+    data->eventID = 5;
+    for ( uint32_t i = 0; i < 200; i++ )
+    {
+        data->signals.emplace_back( 1, i, i );
+    }
+    data->mDTCInfo.mDTCCodes.emplace_back( "P0143" );
+    data->mGeohashInfo.mGeohashString = "9q9hwg28j";
+    auto *rawData = data.get();
+    data.reset();
+    EXPECT_EQ( pool->getUsedCount(), 0 );
+    EXPECT_EQ( pool->getFreeCount(), 2 );
+
+    data = pool->acquire();
+    EXPECT_EQ( data.get(), rawData );
+    EXPECT_TRUE( data->metaData.collectionSchemeID.empty() );
+    EXPECT_EQ( data->triggerTime, 0 );
+    EXPECT_EQ( data->eventID, 0 );
+    EXPECT_TRUE( data->signals.empty() );
+    // The capacity grown by the previous user is kept
+    EXPECT_GE( data->signals.capacity(), 200 );
+    EXPECT_FALSE( data->mDTCInfo.hasItems() );
+    EXPECT_FALSE( data->mGeohashInfo.hasItems() );
+}
+
+TEST( TriggeredCollectionSchemeDataPoolTest, ExhaustedPoolAllocatesUnpooledData )
+{
+    auto pool = std::make_shared<TriggeredCollectionSchemeDataPool>();
+    pool->resize( 1, 0, 0 );
+    auto first = pool->acquire();
+    auto second = pool->acquire();
+    ASSERT_NE( second, nullptr );
+    EXPECT_NE( first.get(), second.get() );
+    EXPECT_EQ( pool->getUsedCount(), 1 );
+    second.reset();
+    // The unpooled object does not go into the pool
+    EXPECT_EQ( pool->getFreeCount(), 0 );
+    first.reset();
+    EXPECT_EQ( pool->getFreeCount(), 1 );
+}
+
+TEST( TriggeredCollectionSchemeDataPoolTest, ShrinkWhileInUse )
+{
+    auto pool = std::make_shared<TriggeredCollectionSchemeDataPool>();
+    pool->resize( 3, 0, 0 );
+    auto first = pool->acquire();
+    auto second = pool->acquire();
+    pool->resize( 1, 0, 0 );
+    EXPECT_EQ( pool->getFreeCount(), 0 );
+    EXPECT_EQ( pool->getUsedCount(), 2 );
+    first.reset();
+    EXPECT_EQ( pool->getFreeCount(), 0 );
+    second.reset();
+    EXPECT_EQ( pool->getFreeCount(), 1 );
+    EXPECT_EQ( pool->getUsedCount(), 0 );
+}
+
+TEST( TriggeredCollectionSchemeDataPoolTest, DataOutlivesPoolOwner )
+{
+    auto pool = std::make_shared<TriggeredCollectionSchemeDataPool>();
+    pool->resize( 1, 0, 0 );
+    auto data = pool->acquire();
+    pool.reset();
+    data->signals.emplace_back( 1, 1, 1.0 );
+    // Releasing from another thread, as the sender does, frees the pool with the last object
+    std::thread releaseThread( [&data]() { data.reset(); } );
+    releaseThread.join();
+    EXPECT_EQ( data, nullptr );
+}
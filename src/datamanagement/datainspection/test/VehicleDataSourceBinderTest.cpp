@@ -116,6 +116,7 @@ generateDecoderDictionary1()
     struct CANMessageDecoderMethod decodeMethod = {
         CANMessageCollectType::RAW,
         canMessageFormat,
+        CANDecoder::compileDecodePlan( canMessageFormat, { 0x123 } ),
     };
     std::unordered_map<CANRawFrameID, CANMessageDecoderMethod> canIdToDecode{ { 0x224, decodeMethod } };
     CANDecoderDictionary dict = { { { 0, canIdToDecode }, { 1, canIdToDecode } }, { 0x123 } };
@@ -147,6 +148,7 @@ generateDecoderDictionary2()
     struct CANMessageDecoderMethod decodeMethod = {
         CANMessageCollectType::DECODE,
         canMessageFormat,
+        CANDecoder::compileDecodePlan( canMessageFormat, { 0x123 } ),
     };
     std::unordered_map<CANRawFrameID, CANMessageDecoderMethod> canIdToDecode{ { 0x224, decodeMethod } };
     CANDecoderDictionary dict = { { { 0, canIdToDecode }, { 1, canIdToDecode } }, { 0x123 } };
@@ -178,6 +180,7 @@ generateDecoderDictionary3()
     struct CANMessageDecoderMethod decodeMethod = {
         CANMessageCollectType::DECODE,
         canMessageFormat,
+        CANDecoder::compileDecodePlan( canMessageFormat, { 0x111 } ),
     };
     std::unordered_map<CANRawFrameID, CANMessageDecoderMethod> canIdToDecode{ { 0x224, decodeMethod } };
     CANDecoderDictionary dict = { { { 0, canIdToDecode }, { 1, canIdToDecode } }, { 0x111 } };
@@ -218,6 +221,7 @@ generateDecoderDictionary4()
     struct CANMessageDecoderMethod decodeMethod0 = {
         CANMessageCollectType::DECODE,
         canMessageFormat0,
+        CANDecoder::compileDecodePlan( canMessageFormat0, { 0x111, 0x528 } ),
     };
 
     struct CANMessageFormat canMessageFormat1;
@@ -250,6 +254,7 @@ generateDecoderDictionary4()
     struct CANMessageDecoderMethod decodeMethod1 = {
         CANMessageCollectType::DECODE,
         canMessageFormat1,
+        CANDecoder::compileDecodePlan( canMessageFormat1, { 0x111, 0x528 } ),
     };
 
     std::unordered_map<CANRawFrameID, CANMessageDecoderMethod> canIdToDecodeBus0{ { 0x224, decodeMethod0 } };
@@ -292,6 +297,7 @@ generateDecoderDictionary5()
     struct CANMessageDecoderMethod decodeMethod0 = {
         CANMessageCollectType::DECODE,
         canMessageFormat0,
+        CANDecoder::compileDecodePlan( canMessageFormat0, { 0x111, 0x123, 0x528, 0x411 } ),
     };
 
     struct CANMessageFormat canMessageFormat1;
@@ -324,6 +330,7 @@ generateDecoderDictionary5()
     struct CANMessageDecoderMethod decodeMethod1 = {
         CANMessageCollectType::DECODE,
         canMessageFormat1,
+        CANDecoder::compileDecodePlan( canMessageFormat1, { 0x111, 0x123, 0x528, 0x411 } ),
     };
 
     std::unordered_map<CANRawFrameID, CANMessageDecoderMethod> canIdToDecodeBus0{ { 0x224, decodeMethod0 } };
@@ -369,6 +376,7 @@ generateDecoderDictionary6()
     struct CANMessageDecoderMethod decodeMethod0 = {
         CANMessageCollectType::RAW_AND_DECODE,
         canMessageFormat0,
+        CANDecoder::compileDecodePlan( canMessageFormat0, { 0x111, 0x123, 0x528, 0x411 } ),
     };
 
     struct CANMessageFormat canMessageFormat1;
@@ -401,6 +409,7 @@ generateDecoderDictionary6()
     struct CANMessageDecoderMethod decodeMethod1 = {
         CANMessageCollectType::RAW_AND_DECODE,
         canMessageFormat1,
+        CANDecoder::compileDecodePlan( canMessageFormat1, { 0x111, 0x123, 0x528, 0x411 } ),
     };
 
     std::unordered_map<CANRawFrameID, CANMessageDecoderMethod> canIdToDecodeBus0{ { 0x224, decodeMethod0 } };
@@ -495,7 +504,7 @@ TEST_F( VehicleDataSourceBinderTest, VehicleDataSourceBinderTestCollectCANFrame
     std::this_thread::sleep_for( std::chrono::seconds( 3 ) );
 
     // Verify raw CAN Frames are collected correctly
-    CollectedCanRawFrame rawCANMsg;
+    CollectedCanFrameWithSignals rawCANMsg;
     ASSERT_TRUE( canConsumerPtr->getCANBufferPtr()->pop( rawCANMsg ) );
     ASSERT_EQ( 8, rawCANMsg.size );
     for ( int i = 0; i < rawCANMsg.size; ++i )
@@ -536,6 +545,46 @@ TEST_F( VehicleDataSourceBinderTest, VehicleDataSourceBinderTestCollectSelectedS
     ASSERT_DOUBLE_EQ( 0x0804, signal.value );
 }
 
+/** @brief In this test, a burst of frames with the same CAN ID is decoded together and
+ * all signals are collected in the order of the frames
+ */
+TEST_F( VehicleDataSourceBinderTest, VehicleDataSourceBinderTestCollectSignalsOfFrameBurst )
+{
+    canDictionarySharedPtr = std::make_shared<const CANDecoderDictionary>( generateDecoderDictionary2() );
+
+    binder.onChangeOfActiveDictionary( canDictionarySharedPtr, VehicleDataSourceProtocol::RAW_SOCKET );
+
+    const uint8_t FRAME_COUNT = 30;
+    for ( uint8_t i = 0; i < FRAME_COUNT; i++ )
+    {
+        struct can_frame frame = {};
+        frame.can_id = 0x224;
+        frame.can_dlc = 8;
+        frame.data[0] = i;
+        frame.data[1] = 0x08;
+        ASSERT_TRUE( write( socketFD, &frame, sizeof( struct can_frame ) ) > 0 );
+    }
+    std::this_thread::sleep_for( std::chrono::seconds( 3 ) );
+
+    // Both consumers receive every frame, the signals of one consumer are in the order of the frames
+    std::vector<uint32_t> nextValue( 2, 0 );
+    CollectedSignal signal;
+    uint32_t signalCount = 0;
+    while ( canConsumerPtr->getSignalBufferPtr()->pop( signal ) )
+    {
+        ASSERT_EQ( 0x123, signal.signalID );
+        signalCount++;
+        auto value = static_cast<uint32_t>( signal.value );
+        auto consumer = ( nextValue[0] == ( value & 0xFF ) ) ? 0U : 1U;
+        ASSERT_EQ( nextValue[consumer], value & 0xFF );
+        ASSERT_EQ( 0x0800, value & 0xFF00 );
+        nextValue[consumer]++;
+    }
+    ASSERT_EQ( signalCount, FRAME_COUNT * 2U );
+    ASSERT_EQ( nextValue[0], FRAME_COUNT );
+    ASSERT_EQ( nextValue[1], FRAME_COUNT );
+}
+
 /** @brief In this test, no signals in the CAN Frame will be collected based on decoder dictionary
  */
 TEST_F( VehicleDataSourceBinderTest, VehicleDataSourceBinderTestNotCollectSignalBuffer )
@@ -639,7 +688,7 @@ TEST_F( VehicleDataSourceBinderTest, VehicleDataSourceBinderTestCollectSignalBuf
 }
 
 /** @brief In this test, two RAW CAN Frames and two signals from the CAN Frame on Both two Channels
- * to be collected based on decoder dictionary
+ * to be collected based on decoder dictionary. The signals are queued together with their raw frame.
  */
 TEST_F( VehicleDataSourceBinderTest, VehicleDataSourceBinderTestCollectSignalBufferAndRawFrame )
 {
@@ -654,38 +703,45 @@ TEST_F( VehicleDataSourceBinderTest, VehicleDataSourceBinderTestCollectSignalBuf
     // wait more than 2 seconds here
     std::this_thread::sleep_for( std::chrono::seconds( 3 ) );
 
-    // Verify signals are decoded and collected correctly
-    std::unordered_map<SignalID, double> collectedSignals;
-    CollectedSignal signal;
-    while ( !canConsumerPtr->getSignalBufferPtr()->empty() )
-    {
-        canConsumerPtr->getSignalBufferPtr()->pop( signal );
-        collectedSignals[signal.signalID] = signal.value;
-    }
-    ASSERT_EQ( 4, collectedSignals.size() );
-    ASSERT_EQ( 1, collectedSignals.count( 0x111 ) );
-    ASSERT_EQ( 0x0040, collectedSignals[0x111] );
-    ASSERT_EQ( 1, collectedSignals.count( 0x528 ) );
-    ASSERT_EQ( 0x0804, collectedSignals[0x528] );
-    ASSERT_EQ( 1, collectedSignals.count( 0x411 ) );
-    ASSERT_EQ( 0x0040, collectedSignals[0x411] );
-    ASSERT_EQ( 1, collectedSignals.count( 0x123 ) );
-    ASSERT_EQ( 0x0804, collectedSignals[0x123] );
+    // The decoded signals do not go through the Signal Buffer
+    ASSERT_TRUE( canConsumerPtr->getSignalBufferPtr()->empty() );
 
-    // Verify CAN RAW Frame is collected as well
-    CollectedCanRawFrame rawCANMsg;
+    // Verify CAN RAW Frame is collected with its decoded signals
+    std::unordered_map<SignalID, double> collectedSignals;
+    CollectedCanFrameWithSignals rawCANMsg;
     ASSERT_TRUE( canConsumerPtr->getCANBufferPtr()->pop( rawCANMsg ) );
     ASSERT_EQ( 8, rawCANMsg.size );
     for ( int i = 0; i < rawCANMsg.size; ++i )
     {
         ASSERT_EQ( frame.data[i], rawCANMsg.data[i] );
     }
+    ASSERT_EQ( 2, rawCANMsg.decodedSignalCount );
+    for ( uint8_t i = 0; i < rawCANMsg.decodedSignalCount; ++i )
+    {
+        collectedSignals[rawCANMsg.decodedSignals[i].signalID] = rawCANMsg.decodedSignals[i].value;
+    }
     ASSERT_TRUE( canConsumerPtr2->getCANBufferPtr()->pop( rawCANMsg ) );
     ASSERT_EQ( 8, rawCANMsg.size );
     for ( int i = 0; i < rawCANMsg.size; ++i )
     {
         ASSERT_EQ( frame.data[i], rawCANMsg.data[i] );
     }
+    ASSERT_EQ( 2, rawCANMsg.decodedSignalCount );
+    for ( uint8_t i = 0; i < rawCANMsg.decodedSignalCount; ++i )
+    {
+        collectedSignals[rawCANMsg.decodedSignals[i].signalID] = rawCANMsg.decodedSignals[i].value;
+    }
+
+    // Verify signals are decoded correctly
+    ASSERT_EQ( 4, collectedSignals.size() );
+    ASSERT_EQ( 1, collectedSignals.count( 0x111 ) );
+    ASSERT_EQ( 0x0040, collectedSignals[0x111] );
+    ASSERT_EQ( 1, collectedSignals.count( 0x528 ) );
+    ASSERT_EQ( 0x0804, collectedSignals[0x528] );
+    ASSERT_EQ( 1, collectedSignals.count( 0x411 ) );
+    ASSERT_EQ( 0x0040, collectedSignals[0x411] );
+    ASSERT_EQ( 1, collectedSignals.count( 0x123 ) );
+    ASSERT_EQ( 0x0804, collectedSignals[0x123] );
 }
 
 /** @brief In this test, decoder dictionary update invoked in the middle of message decoding
@@ -821,3 +877,56 @@ TEST_F( VehicleDataSourceBinderTest, VehicleDataSourceBinderStartupAndShutdownCy
     ASSERT_FALSE( canConsumer->getCANBufferPtr()->empty() );
     ASSERT_TRUE( networkBinder.disconnect() );
 }
+
+/** @brief  A source with multiple decoder threads gets one consumer per buffer, all of them decoding its frames
+ */
+TEST_F( VehicleDataSourceBinderTest, VehicleDataSourceBinderBindsOneConsumerPerDecoderThread )
+{
+    VehicleDataSourceBinder networkBinder;
+    auto canSource = std::make_shared<CANDataSource>();
+    VehicleDataSourceConfig canSourceConfig;
+    canSourceConfig.transportProperties.emplace( "interfaceName", "vcan0" );
+    canSourceConfig.transportProperties.emplace( "threadIdleTimeMs", "1000" );
+    canSourceConfig.transportProperties.emplace( "decoderThreads", "2" );
+    canSourceConfig.maxNumberOfVehicleDataMessages = 1000;
+    ASSERT_TRUE( canSource->init( { canSourceConfig } ) );
+    ASSERT_EQ( canSource->getBufferCount(), 2 );
+    auto id = canSource->getVehicleDataSourceID();
+
+    auto signalBufferPtr = std::make_shared<SignalBuffer>( 256 );
+    auto canRawBufferPtr = std::make_shared<CANBuffer>( 256 );
+    std::vector<std::shared_ptr<CANDataConsumer>> consumers;
+    for ( size_t i = 0; i < 3; i++ )
+    {
+        consumers.emplace_back( std::make_shared<CANDataConsumer>() );
+        ASSERT_TRUE( consumers.back()->init( 0, signalBufferPtr, 1000 ) );
+        consumers.back()->setCANBufferPtr( canRawBufferPtr );
+    }
+    ASSERT_TRUE( networkBinder.connect() );
+    ASSERT_TRUE( networkBinder.addVehicleDataSource( canSource ) );
+    ASSERT_TRUE( networkBinder.bindConsumerToVehicleDataSource( consumers[0], id ) );
+    ASSERT_TRUE( networkBinder.bindConsumerToVehicleDataSource( consumers[1], id ) );
+    // Both buffers are taken
+    ASSERT_FALSE( networkBinder.bindConsumerToVehicleDataSource( consumers[2], id ) );
+
+    auto dictionary = std::make_shared<const CANDecoderDictionary>( generateDecoderDictionary1() );
+    networkBinder.onChangeOfActiveDictionary( dictionary, VehicleDataSourceProtocol::RAW_SOCKET );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 100 ) );
+    struct can_frame frame = {};
+    sendTestMessage( socketFD, frame );
+    std::this_thread::sleep_for( std::chrono::seconds( 1 ) );
+    ASSERT_FALSE( canRawBufferPtr->empty() );
+    ASSERT_TRUE( networkBinder.unBindConsumerFromVehicleDataSource( id ) );
+    ASSERT_TRUE( networkBinder.disconnect() );
+}
+
+/** @brief  The consumers follow the connection state of their source right away, without a binder thread
+ */
+TEST_F( VehicleDataSourceBinderTest, VehicleDataSourceBinderReconnectsConsumerImmediately )
+{
+    ASSERT_TRUE( canConsumerPtr->isAlive() );
+    ASSERT_TRUE( canSourcePtr->disconnect() );
+    ASSERT_FALSE( canConsumerPtr->isAlive() );
+    ASSERT_TRUE( canSourcePtr->connect() );
+    ASSERT_TRUE( canConsumerPtr->isAlive() );
+}
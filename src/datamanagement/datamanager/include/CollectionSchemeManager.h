@@ -17,6 +17,9 @@
 #include "CANInterfaceIDTranslator.h"
 #include "ClockHandler.h"
 #include "CollectionSchemeManagementListener.h"
+#include "CollectionSchemeTimeLine.h"
+#include "DecoderDictionarySnapshot.h"
+#include "DeviceJitter.h"
 #include "IActiveConditionProcessor.h"
 #include "IActiveDecoderDictionaryListener.h"
 #include "ICollectionSchemeList.h"
@@ -31,7 +34,6 @@
 #include <atomic>
 #include <map>
 #include <mutex>
-#include <queue>
 #include <vector>
 namespace Aws
 {
@@ -43,9 +45,6 @@ using namespace Aws::IoTFleetWise::Platform::Linux;
 
 using SchemaListenerPtr = std::shared_ptr<SchemaListener>;
 
-/* TimeData is used in mTimeline, the second parameter in the pair is a CollectionScheme ID */
-using TimeData = std::pair<TimePointInMsec, std::string>;
-
 /**
  * @brief main CollectionScheme Management entity - responsible for the following:
  * 1. Listens to collectionScheme ingestion to get CollectionSchemeList and DecoderManifest
@@ -169,6 +168,33 @@ public:
         currentDecoderManifestID = std::move( currentDecoderManifestIDIn );
     }
 
+    /**
+     * @brief Used by the bootstrap to make the collectionSchemes up to a priority number express collectionSchemes.
+     * Their conditions are put first into the inspection matrix, so they are evaluated and collected first, and
+     * their data is marked with PassThroughMetaData::express. Must be called before connect.
+     *
+     * @param maxPriority collectionSchemes with this or a more important, lower, priority number are express
+     */
+    inline void
+    setExpressMaxPriority( uint32_t maxPriority )
+    {
+        mExpressLaneEnabled = true;
+        mExpressMaxPriority = maxPriority;
+    }
+
+    /**
+     * @brief Used by the bootstrap to spread the checkins of a fleet. The first checkin is delayed by the offset of
+     * the device, which keeps the phase of the following checkins, and the retries of a failed checkin are delayed
+     * by another offset. Must be called before connect.
+     *
+     * @param jitter offsets of this device
+     */
+    inline void
+    setDeviceJitter( const DeviceJitter &jitter )
+    {
+        mDeviceJitter = jitter;
+    }
+
 private:
     using ThreadListeners<IActiveDecoderDictionaryListener>::notifyListeners;
     using ThreadListeners<IActiveConditionProcessor>::notifyListeners;
@@ -245,6 +271,17 @@ private:
     void addConditionData( const ICollectionSchemePtr &collectionScheme,
                            struct ConditionWithCollectedData &conditionData );
 
+    /**
+     * @brief Replaces an operator node with constant operands by its result
+     * To be called by inspectionMatrixExtractor
+     *
+     * @param node copy of the node to fold, replaced by a FLOAT or BOOLEAN node if folded
+     * @param left the already extracted left operand or nullptr
+     * @param right the already extracted right operand or nullptr
+     * @return true if the node was folded
+     */
+    static bool foldConstantNode( ExpressionNode &node, const ExpressionNode *left, const ExpressionNode *right );
+
     /**
      * @brief initialize in mTimeLine to send checkin message
      */
@@ -256,6 +293,12 @@ private:
      */
     bool isCollectionSchemeLoaded();
 
+    /**
+     * @brief Builds a collectionScheme whose build was deferred while it was idle, before it is enabled
+     * returns false when the build fails, the collectionScheme must then not be enabled
+     */
+    bool buildDeferredCollectionScheme( const ICollectionSchemePtr &collectionScheme );
+
 protected:
     bool rebuildMapsandTimeLine( const TimePointInMsec &currTime ) override;
 
@@ -272,6 +315,15 @@ protected:
     void decoderDictionaryExtractor(
         std::map<VehicleDataSourceProtocol, std::shared_ptr<CANDecoderDictionary>> &decoderDictionaryMap );
 
+    /**
+     * @brief Adds the signal of a periodic UDS DID to the raw CAN decoder dictionary, as a signal multiplexed by the
+     * low byte of the DID in the frames on the periodic response CAN ID
+     */
+    void addPeriodicDIDSignal(
+        SignalID signalID,
+        const DIDSignalDecoderFormat &didDecoderFormat,
+        std::map<VehicleDataSourceProtocol, std::shared_ptr<CANDecoderDictionary>> &decoderDictionaryMap );
+
     /**
      * @brief This function invoke all the listener for decoder dictionary update. The listener can be any types of
      * Networks
@@ -282,6 +334,24 @@ protected:
     void decoderDictionaryUpdater(
         std::map<VehicleDataSourceProtocol, std::shared_ptr<CANDecoderDictionary>> &decoderDictionaryMap );
 
+    /**
+     * @brief Computes the changes of the decoding rules per channel between two CAN decoder dictionaries
+     *
+     * @param previous dictionary notified before
+     * @param current new dictionary
+     * @return the changed channels, empty if the decoding rules did not change
+     */
+    static DecoderDictionaryDiff decoderDictionaryDiff( const CANDecoderDictionary &previous,
+                                                        const CANDecoderDictionary &current );
+
+    /**
+     * @brief Builds the immutable slice of every channel of a CAN decoder dictionary with its version, replacing the
+     * previous slices. Must be called after the signal sets and maps of the dictionary are complete.
+     *
+     * @param dictionary dictionary whose channelSlices are built
+     */
+    static void buildChannelSlices( CANDecoderDictionary &dictionary );
+
     void inspectionMatrixExtractor( const std::shared_ptr<InspectionMatrix> &inspectionMatrix ) override;
 
     void inspectionMatrixUpdater( const std::shared_ptr<const InspectionMatrix> &inspectionMatrix ) override;
@@ -290,6 +360,40 @@ protected:
 
     void store( DataType storeType ) override;
 
+    /**
+     * @brief Loads the persisted decoder dictionary snapshot if it was extracted from the retrieved documents. The
+     * decoder manifest ID of the snapshot is then used, so that the collection schemes can be enabled before the
+     * decoder manifest is built.
+     *
+     * @return true if the snapshot is loaded and the build of the decoder manifest can be deferred
+     */
+    bool loadDecoderDictionarySnapshot();
+
+    /**
+     * @brief Takes the decoder dictionaries from the loaded snapshot if it was extracted for the enabled collection
+     * schemes
+     *
+     * @param decoderDictionaryMap filled with the dictionaries of the snapshot
+     * @return false if no snapshot is loaded or it does not match, then the dictionaries need to be extracted
+     */
+    bool useDecoderDictionarySnapshot(
+        std::map<VehicleDataSourceProtocol, std::shared_ptr<CANDecoderDictionary>> &decoderDictionaryMap );
+
+    /**
+     * @brief Persists the extracted decoder dictionaries for the next boot
+     *
+     * @param decoderDictionaryMap dictionaries extracted for the enabled collection schemes
+     */
+    void storeDecoderDictionarySnapshot(
+        const std::map<VehicleDataSourceProtocol, std::shared_ptr<CANDecoderDictionary>> &decoderDictionaryMap );
+
+    /**
+     * @brief Builds the retrieved decoder manifest whose build was deferred because of a loaded snapshot
+     *
+     * @return true when mEnabledCollectionSchemeMap changes
+     */
+    bool buildDeferredDecoderManifest();
+
     bool processDecoderManifest() override;
 
     bool processCollectionScheme() override;
@@ -306,8 +410,8 @@ private:
     // checkIn ID in parallel to collectionScheme IDs
     static const std::string CHECKIN;
     // Supported Network Protocol. This list will expand when new protocol added
-    static constexpr std::array<VehicleDataSourceProtocol, 2> SUPPORTED_NETWORK_PROTOCOL = {
-        VehicleDataSourceProtocol::RAW_SOCKET, VehicleDataSourceProtocol::OBD };
+    static constexpr std::array<VehicleDataSourceProtocol, 3> SUPPORTED_NETWORK_PROTOCOL = {
+        VehicleDataSourceProtocol::RAW_SOCKET, VehicleDataSourceProtocol::OBD, VehicleDataSourceProtocol::UDS };
 
     Thread mThread;
     // Atomic flag to signal the state of main thread. If true, we should stop
@@ -334,6 +438,8 @@ private:
 
     // Time interval in ms to send checkin message
     uint64_t mCheckinIntervalInMsec{ DEFAULT_CHECKIN_INTERVAL_IN_MILLISECOND };
+    // Offsets of the checkins of this device
+    DeviceJitter mDeviceJitter;
 
 protected:
     /*
@@ -342,8 +448,8 @@ protected:
      */
     ICollectionSchemeListPtr mCollectionSchemeList;
     IDecoderManifestPtr mDecoderManifest;
-    /* Timeline keeps track on StartTime and StopTime of all existing collectionSchemes */
-    std::priority_queue<TimeData, std::vector<TimeData>, std::greater<TimeData>> mTimeLine;
+    /* Timeline keeps track of the StartTime of idle and the StopTime of enabled collectionSchemes */
+    CollectionSchemeTimeLine mTimeLine;
     /* lock used in callback functions onCollectionSchemeAvailable and onDecoderManifest */
     std::mutex mSchemaUpdateMutex;
 
@@ -377,6 +483,16 @@ protected:
     std::shared_ptr<ICacheAndPersist> mSchemaPersistency;
     // flag used to check if local dictionary is available
     bool mUseLocalDictionary{ false };
+    bool mExpressLaneEnabled{ false };
+    uint32_t mExpressMaxPriority{ 0 };
+    // Dictionaries last notified to the listeners, the next update is notified as a diff to them
+    std::map<VehicleDataSourceProtocol, std::shared_ptr<const CANDecoderDictionary>> mActiveDecoderDictionaryMap;
+
+    // Snapshot loaded on boot, released once the deferred decoder manifest is built
+    std::shared_ptr<const DecoderDictionarySnapshot> mDecoderDictionarySnapshot;
+    // CRC32C of the persisted documents, 0 if unknown
+    uint32_t mDecoderManifestDigest{ 0 };
+    uint32_t mCollectionSchemeListDigest{ 0 };
 
     CANInterfaceIDTranslator mCANIDTranslator;
 };
@@ -0,0 +1,139 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "ICollectionSchemeManager.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataManagement
+{
+
+/**
+ * @brief Min heap of the next time point of every collectionScheme and of the checkin
+ *
+ * Each ID has at most one time point. The IDs are interned to a handle while they are scheduled, and the heap is
+ * indexed by the handle, so that a time point is moved or cancelled in O(log n) instead of leaving an obsolete
+ * entry behind. The heap therefore only contains live schedules, and comparing entries never compares strings.
+ * Entries with the same time point are ordered by handle.
+ */
+class CollectionSchemeTimeLine
+{
+public:
+    /**
+     * @brief Schedules the ID at the time point, replacing its previous time point
+     * @param id collectionScheme ID or checkin
+     * @param timePoint time point in ms since epoch
+     */
+    void schedule( const std::string &id, TimePointInMsec timePoint );
+
+    /**
+     * @brief Removes the time point of the ID, if it is scheduled
+     * @param id collectionScheme ID or checkin
+     */
+    void cancel( const std::string &id );
+
+    /**
+     * @brief Checks if the ID has a time point
+     * @param id collectionScheme ID or checkin
+     * @return true if scheduled
+     */
+    bool isScheduled( const std::string &id ) const;
+
+    /**
+     * @brief Time point of the ID
+     * @param id collectionScheme ID or checkin
+     * @param timePoint set to the time point if scheduled
+     * @return false if the ID is not scheduled
+     */
+    bool getTimePoint( const std::string &id, TimePointInMsec &timePoint ) const;
+
+    bool
+    empty() const
+    {
+        return mHeap.empty();
+    }
+
+    size_t
+    size() const
+    {
+        return mHeap.size();
+    }
+
+    /**
+     * @brief Earliest time point, must not be called if empty
+     */
+    TimePointInMsec
+    topTime() const
+    {
+        return mHeap.front().timePoint;
+    }
+
+    /**
+     * @brief ID of the earliest time point, must not be called if empty. Only valid until the timeline is modified
+     */
+    const std::string &
+    topID() const
+    {
+        return mIDs[mHeap.front().handle];
+    }
+
+    /**
+     * @brief Removes the earliest time point, must not be called if empty
+     */
+    void pop();
+
+    void clear();
+
+private:
+    using Handle = uint32_t;
+
+    struct Entry
+    {
+        TimePointInMsec timePoint;
+        Handle handle;
+    };
+
+    static bool
+    isEarlier( const Entry &left, const Entry &right )
+    {
+        return ( left.timePoint < right.timePoint ) ||
+               ( ( left.timePoint == right.timePoint ) && ( left.handle < right.handle ) );
+    }
+
+    void placeEntry( size_t position, const Entry &entry );
+    void siftUp( size_t position );
+    void siftDown( size_t position );
+    void removeAt( size_t position );
+
+    std::vector<Entry> mHeap;
+    // Indexed by handle: position of the handle in mHeap and its ID
+    std::vector<size_t> mPositions;
+    std::vector<std::string> mIDs;
+    // Handles of cancelled IDs, reused before new handles are created
+    std::vector<Handle> mFreeHandles;
+    std::unordered_map<std::string, Handle> mHandles;
+};
+
+} // namespace DataManagement
+} // namespace IoTFleetWise
+} // namespace Aws
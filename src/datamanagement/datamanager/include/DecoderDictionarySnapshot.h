@@ -0,0 +1,78 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "CANInterfaceIDTranslator.h"
+#include "IDecoderDictionary.h"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataManagement
+{
+
+/**
+ * @brief Compiled decoder dictionaries of the enabled collection schemes, persisted to start the data collection on
+ * boot without parsing and building the decoder manifest first.
+ *
+ * The snapshot is only valid for the persisted documents it was extracted from, which is checked with the CRC32C of
+ * the persisted decoder manifest and collection scheme list, and for the same enabled collection schemes. CAN channels
+ * are stored with their interface ID, so that a changed interface configuration invalidates the snapshot. The decode
+ * plans are derived data and compiled again when the snapshot is loaded.
+ */
+class DecoderDictionarySnapshot
+{
+public:
+    /**
+     * @brief Version of the binary format, snapshots of other versions are ignored
+     */
+    static constexpr uint32_t VERSION = 1;
+
+    std::string decoderManifestID;
+    uint32_t decoderManifestDigest{ 0 };     /**< CRC32C of the persisted decoder manifest */
+    uint32_t collectionSchemeListDigest{ 0 }; /**< CRC32C of the persisted collection scheme list */
+    std::vector<std::string> enabledCollectionSchemeIDs; /**< sorted */
+    std::shared_ptr<const std::string> compressionDictionary;
+    std::map<VehicleDataSourceProtocol, std::shared_ptr<CANDecoderDictionary>> decoderDictionaries;
+
+    /**
+     * @brief Serializes the snapshot into a versioned binary with a CRC32C
+     *
+     * @param canIDTranslator translates the CAN channels to the interface IDs
+     * @param output the binary, replaced
+     * @return false if a CAN channel has no interface ID
+     */
+    bool serialize( CANInterfaceIDTranslator &canIDTranslator, std::vector<uint8_t> &output ) const;
+
+    /**
+     * @brief Validates and loads a binary written by serialize()
+     *
+     * @param data pointer to the binary
+     * @param size size of the binary
+     * @param canIDTranslator translates the interface IDs to the CAN channels
+     * @return false if the binary is corrupted, of another version, or an interface ID is not configured anymore
+     */
+    bool deserialize( const uint8_t *data, size_t size, CANInterfaceIDTranslator &canIDTranslator );
+};
+
+} // namespace DataManagement
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -68,7 +68,7 @@ protected:
     virtual bool updateMapsandTimeLine( const TimePointInMsec &currTime ) = 0;
 
     /**
-     * @brief works on TimeData popped from mTimeLine to decide whether to disable/enable a collectionScheme
+     * @brief works on the expired time points of mTimeLine to decide whether to disable/enable a collectionScheme
      *
      * @param currTime time in seconds when main thread wakes up;
      * @return true when enabled collectionScheme map is updated.
@@ -21,6 +21,7 @@
 #include "IReceiver.h"
 #include "ISender.h"
 #include "LoggingModule.h"
+#include "LowActivityMode.h"
 #include "SchemaListener.h"
 #include "Thread.h"
 #include "checkin.pb.h"
@@ -115,6 +116,8 @@ public:
         void
         onDataReceived( const uint8_t *buf, size_t size ) override
         {
+            // Wakes up the pipeline threads in case the vehicle is parked
+            LowActivityMode::get().onCloudMessage();
             // Check for a empty input data
             if ( buf == nullptr || size == 0 )
             {
@@ -123,6 +126,13 @@ public:
                 return;
             }
 
+            // Large Decoder Manifests are delivered in chunks, which are built as they arrive
+            if ( DecoderManifestIngestion::isChunk( buf, size ) )
+            {
+                onChunkReceived( buf, size );
+                return;
+            }
+
             // Create an empty shared pointer which we'll copy the data to
             DecoderManifestPtr decoderManifestPtr = std::make_shared<DecoderManifestIngestion>();
 
@@ -137,6 +147,35 @@ public:
             mSchema.setDecoderManifest( decoderManifestPtr );
             mLogger.trace( "DecoderManifestCb::onDataReceived", "Received Decoder Manifest in PI DecoderManifestCb" );
         }
+
+        void
+        onChunkReceived( const uint8_t *buf, size_t size )
+        {
+            if ( mChunkedDecoderManifest == nullptr )
+            {
+                mChunkedDecoderManifest = std::make_shared<DecoderManifestIngestion>();
+            }
+
+            switch ( mChunkedDecoderManifest->addChunk( buf, size ) )
+            {
+            case DecoderManifestChunkStatus::INCOMPLETE:
+                break;
+            case DecoderManifestChunkStatus::COMPLETE:
+                mSchema.setDecoderManifest( mChunkedDecoderManifest );
+                mChunkedDecoderManifest.reset();
+                mLogger.trace( "DecoderManifestCb::onChunkReceived", "Received all chunks of Decoder Manifest" );
+                break;
+            default:
+                mChunkedDecoderManifest.reset();
+                mLogger.error( "DecoderManifestCb::onChunkReceived", "Decoder Manifest chunk rejected" );
+                break;
+            }
+        }
+
+        /**
+         * @brief Decoder Manifest being received in chunks. Only accessed from the MQTT callback thread.
+         */
+        DecoderManifestPtr mChunkedDecoderManifest;
     } mDecoderManifestCb;
 
     /**
@@ -163,6 +202,8 @@ public:
         void
         onDataReceived( const uint8_t *buf, size_t size ) override
         {
+            // Wakes up the pipeline threads in case the vehicle is parked
+            LowActivityMode::get().onCloudMessage();
             // Check for a empty input data
             if ( buf == nullptr || size == 0 )
             {
@@ -14,8 +14,10 @@
 // Includes
 #include "CollectionSchemeIngestionList.h"
 #include "CollectionSchemeManager.h"
+#include "Crc32c.h"
 #include "DecoderManifestIngestion.h"
 #include "EnumUtility.h"
+#include "TraceModule.h"
 #include <string>
 #include <utility>
 
@@ -26,12 +28,13 @@ namespace IoTFleetWise
 namespace DataManagement
 {
 using namespace Aws::IoTFleetWise::Platform::Utility;
+using Aws::IoTFleetWise::Platform::Linux::PersistencyManagement::crc32c;
+
 void
 CollectionSchemeManager::prepareCheckinTimer()
 {
     TimePointInMsec currTime = mClock->timeSinceEpochMs();
-    TimeData checkinData = std::make_pair( currTime, CHECKIN );
-    mTimeLine.push( checkinData );
+    mTimeLine.schedule( CHECKIN, currTime + mDeviceJitter.getOffsetMs( "checkin", mCheckinIntervalInMsec ) );
 }
 
 bool
@@ -115,6 +118,7 @@ CollectionSchemeManager::retrieve( DataType retrieveType )
     mLogger.info( "CollectionSchemeManager::retrieve", infoStr + std::to_string( protoSize ) + " successfully." );
     if ( retrieveType == DataType::COLLECTION_SCHEME_LIST )
     {
+        mCollectionSchemeListDigest = crc32c( 0, protoOutput.data(), protoSize );
         // updating mCollectionSchemeList
         if ( mCollectionSchemeList == nullptr )
         {
@@ -125,6 +129,7 @@ CollectionSchemeManager::retrieve( DataType retrieveType )
     }
     else if ( retrieveType == DataType::DECODER_MANIFEST )
     {
+        mDecoderManifestDigest = crc32c( 0, protoOutput.data(), protoSize );
         // updating mDecoderManifest
         if ( mDecoderManifest == nullptr )
         {
@@ -140,7 +145,10 @@ void
 CollectionSchemeManager::store( DataType storeType )
 {
     ErrorCode ret = ErrorCode::SUCCESS;
-    std::vector<uint8_t> protoInput;
+    // Points to the binary data of the document, which can be several MB big, so it is not copied
+    const std::vector<uint8_t> *protoInput = nullptr;
+    // Digest of the persisted document, which keys the decoder dictionary snapshot
+    uint32_t *digest = nullptr;
     std::string logStr;
 
     if ( mSchemaPersistency == nullptr )
@@ -162,11 +170,13 @@ CollectionSchemeManager::store( DataType storeType )
     switch ( storeType )
     {
     case DataType::COLLECTION_SCHEME_LIST:
-        protoInput = mCollectionSchemeList->getData();
+        protoInput = &mCollectionSchemeList->getData();
+        digest = &mCollectionSchemeListDigest;
         logStr = "The CollectionSchemeList";
         break;
     case DataType::DECODER_MANIFEST:
-        protoInput = mDecoderManifest->getData();
+        protoInput = &mDecoderManifest->getData();
+        digest = &mDecoderManifestDigest;
         logStr = "The DecoderManifest";
         break;
     default:
@@ -175,12 +185,14 @@ CollectionSchemeManager::store( DataType storeType )
         return;
     }
 
-    if ( protoInput.empty() )
+    // Until the write succeeded the persisted document is unknown
+    *digest = 0;
+    if ( protoInput->empty() )
     {
         mLogger.error( "CollectionSchemeManager::store", logStr + " data size is zero." );
         return;
     }
-    ret = mSchemaPersistency->write( protoInput.data(), protoInput.size(), storeType );
+    ret = mSchemaPersistency->write( protoInput->data(), protoInput->size(), storeType );
     if ( ret != ErrorCode::SUCCESS )
     {
         mLogger.error( "CollectionSchemeManager::store",
@@ -189,9 +201,136 @@ CollectionSchemeManager::store( DataType storeType )
     }
     else
     {
+        *digest = crc32c( 0, protoInput->data(), protoInput->size() );
         mLogger.trace( "CollectionSchemeManager::store", logStr + " persisted successfully." );
     }
 }
+
+bool
+CollectionSchemeManager::loadDecoderDictionarySnapshot()
+{
+    if ( ( mSchemaPersistency == nullptr ) || ( mDecoderManifestDigest == 0 ) || ( mCollectionSchemeListDigest == 0 ) )
+    {
+        return false;
+    }
+    size_t size = mSchemaPersistency->getSize( DataType::DECODER_DICTIONARY_SNAPSHOT );
+    if ( size == 0 )
+    {
+        return false;
+    }
+    std::vector<uint8_t> snapshotData( size );
+    if ( mSchemaPersistency->read( snapshotData.data(), size, DataType::DECODER_DICTIONARY_SNAPSHOT ) !=
+         ErrorCode::SUCCESS )
+    {
+        mLogger.error( "CollectionSchemeManager::loadDecoderDictionarySnapshot", "Failed to read the snapshot" );
+        return false;
+    }
+    auto snapshot = std::make_shared<DecoderDictionarySnapshot>();
+    if ( !snapshot->deserialize( snapshotData.data(), size, mCANIDTranslator ) )
+    {
+        mLogger.warn( "CollectionSchemeManager::loadDecoderDictionarySnapshot",
+                      "Ignoring an invalid snapshot or a snapshot of another version" );
+        return false;
+    }
+    if ( ( snapshot->decoderManifestDigest != mDecoderManifestDigest ) ||
+         ( snapshot->collectionSchemeListDigest != mCollectionSchemeListDigest ) )
+    {
+        mLogger.info( "CollectionSchemeManager::loadDecoderDictionarySnapshot",
+                      "Ignoring the snapshot of other documents than the persisted ones" );
+        return false;
+    }
+    currentDecoderManifestID = snapshot->decoderManifestID;
+    mDecoderDictionarySnapshot = snapshot;
+    mLogger.info( "CollectionSchemeManager::loadDecoderDictionarySnapshot",
+                  "Loaded the decoder dictionary snapshot of decoder manifest " + currentDecoderManifestID );
+    return true;
+}
+
+bool
+CollectionSchemeManager::useDecoderDictionarySnapshot(
+    std::map<VehicleDataSourceProtocol, std::shared_ptr<CANDecoderDictionary>> &decoderDictionaryMap )
+{
+    if ( mDecoderDictionarySnapshot == nullptr )
+    {
+        return false;
+    }
+    // mEnabledCollectionSchemeMap is ordered, as are the IDs of the snapshot
+    std::vector<std::string> enabledCollectionSchemeIDs;
+    for ( const auto &enabledCollectionScheme : mEnabledCollectionSchemeMap )
+    {
+        enabledCollectionSchemeIDs.emplace_back( enabledCollectionScheme.first );
+    }
+    if ( enabledCollectionSchemeIDs != mDecoderDictionarySnapshot->enabledCollectionSchemeIDs )
+    {
+        mLogger.info( "CollectionSchemeManager::useDecoderDictionarySnapshot",
+                      "The snapshot was extracted for other enabled collection schemes" );
+        return false;
+    }
+    decoderDictionaryMap = mDecoderDictionarySnapshot->decoderDictionaries;
+    // Like the decode plans the channel slices are not persisted but built on the first use of the snapshot
+    auto canDictionary = decoderDictionaryMap.find( VehicleDataSourceProtocol::RAW_SOCKET );
+    if ( ( canDictionary != decoderDictionaryMap.end() ) && ( canDictionary->second != nullptr ) &&
+         canDictionary->second->channelSlices.empty() )
+    {
+        buildChannelSlices( *canDictionary->second );
+    }
+    return true;
+}
+
+void
+CollectionSchemeManager::storeDecoderDictionarySnapshot(
+    const std::map<VehicleDataSourceProtocol, std::shared_ptr<CANDecoderDictionary>> &decoderDictionaryMap )
+{
+    if ( mSchemaPersistency == nullptr )
+    {
+        return;
+    }
+    if ( ( mDecoderManifestDigest == 0 ) || ( mCollectionSchemeListDigest == 0 ) )
+    {
+        // The persisted documents are unknown, so a snapshot could be matched with the wrong documents on boot
+        static_cast<void>( mSchemaPersistency->erase( DataType::DECODER_DICTIONARY_SNAPSHOT ) );
+        return;
+    }
+    DecoderDictionarySnapshot snapshot;
+    snapshot.decoderManifestID = currentDecoderManifestID;
+    snapshot.decoderManifestDigest = mDecoderManifestDigest;
+    snapshot.collectionSchemeListDigest = mCollectionSchemeListDigest;
+    for ( const auto &enabledCollectionScheme : mEnabledCollectionSchemeMap )
+    {
+        snapshot.enabledCollectionSchemeIDs.emplace_back( enabledCollectionScheme.first );
+    }
+    if ( mDecoderManifest != nullptr )
+    {
+        snapshot.compressionDictionary = mDecoderManifest->getCompressionDictionary();
+    }
+    snapshot.decoderDictionaries = decoderDictionaryMap;
+
+    std::vector<uint8_t> snapshotData;
+    ErrorCode ret = ErrorCode::INVALID_DATA;
+    if ( snapshot.serialize( mCANIDTranslator, snapshotData ) )
+    {
+        ret = mSchemaPersistency->write(
+            snapshotData.data(), snapshotData.size(), DataType::DECODER_DICTIONARY_SNAPSHOT );
+    }
+    if ( ret != ErrorCode::SUCCESS )
+    {
+        mLogger.warn( "CollectionSchemeManager::storeDecoderDictionarySnapshot",
+                      "Failed to persist the snapshot: " + std::string( mSchemaPersistency->getErrorString( ret ) ) );
+        static_cast<void>( mSchemaPersistency->erase( DataType::DECODER_DICTIONARY_SNAPSHOT ) );
+    }
+}
+
+bool
+CollectionSchemeManager::buildDeferredDecoderManifest()
+{
+    mProcessDecoderManifest = false;
+    TraceModule::get().sectionBegin( TraceSection::MANAGER_DECODER_BUILD );
+    // The decoder manifest ID is already the one of the snapshot, so the enabled collection schemes are kept
+    bool enabledCollectionSchemeMapChanged = processDecoderManifest();
+    TraceModule::get().sectionEnd( TraceSection::MANAGER_DECODER_BUILD );
+    mDecoderDictionarySnapshot.reset();
+    return enabledCollectionSchemeMapChanged;
+}
 } // namespace DataManagement
 } // namespace IoTFleetWise
 } // namespace Aws
@@ -48,10 +48,7 @@ CollectionSchemeManager::~CollectionSchemeManager()
     }
     mEnabledCollectionSchemeMap.clear();
     mIdleCollectionSchemeMap.clear();
-    while ( !mTimeLine.empty() )
-    {
-        mTimeLine.pop();
-    }
+    mTimeLine.clear();
 }
 
 bool
@@ -59,14 +56,13 @@ CollectionSchemeManager::start()
 {
     std::lock_guard<std::mutex> lock( mThreadMutex );
     mShouldStop.store( false );
-    if ( !mThread.create( doWork, this ) )
+    if ( !mThread.create( doWork, this, "fwDMColSchMngr" ) )
     {
         mLogger.error( "CollectionSchemeManager::start", " Collection Scheme Thread failed to start " );
     }
     else
     {
         mLogger.info( "CollectionSchemeManager::start", " Collection Scheme Thread started " );
-        mThread.setThreadName( "fwDMColSchMngr" );
     }
     return mThread.isValid();
 }
@@ -136,7 +132,7 @@ CollectionSchemeManager::printWakeupStatus( std::string &wakeupStr ) const
 }
 
 // Clears both enabled collectionScheme map and idle collectionScheme map
-// removes all dataPair from mTimeLine except for CHECKIN
+// removes all time points from mTimeLine except for CHECKIN
 void
 CollectionSchemeManager::cleanupCollectionSchemes()
 {
@@ -145,23 +141,16 @@ CollectionSchemeManager::cleanupCollectionSchemes()
         // already cleaned up
         return;
     }
-    mEnabledCollectionSchemeMap.clear();
-    mIdleCollectionSchemeMap.clear();
-
-    // when cleaning up mTimeLine checkIn event needs to be preserved
-    TimeData saveTimeData = { 0, "" };
-    while ( !mTimeLine.empty() )
+    for ( const auto &collectionScheme : mEnabledCollectionSchemeMap )
     {
-        if ( mTimeLine.top().second == CHECKIN )
-        {
-            saveTimeData = mTimeLine.top();
-        }
-        mTimeLine.pop();
+        mTimeLine.cancel( collectionScheme.first );
     }
-    if ( saveTimeData.first != 0 )
+    for ( const auto &collectionScheme : mIdleCollectionSchemeMap )
     {
-        mTimeLine.push( saveTimeData );
+        mTimeLine.cancel( collectionScheme.first );
     }
+    mEnabledCollectionSchemeMap.clear();
+    mIdleCollectionSchemeMap.clear();
 }
 
 void
@@ -174,11 +163,14 @@ CollectionSchemeManager::doWork( void *data )
     collectionSchemeManager->prepareCheckinTimer();
     // Retrieve collectionSchemeList and decoderManifest from persistent storage
     static_cast<void>( collectionSchemeManager->retrieve( DataType::COLLECTION_SCHEME_LIST ) );
+    // With a snapshot of the decoder dictionaries the data collection starts before the decoder manifest is built
+    bool deferDecoderManifestBuild = false;
     // If we have an injected Decoder Manifest, we shall not try to load another one from
     // the persistency module
     if ( !collectionSchemeManager->mUseLocalDictionary )
     {
         static_cast<void>( collectionSchemeManager->retrieve( DataType::DECODER_MANIFEST ) );
+        deferDecoderManifestBuild = collectionSchemeManager->loadDecoderDictionarySnapshot();
     }
     else
     {
@@ -187,7 +179,7 @@ CollectionSchemeManager::doWork( void *data )
     }
     do
     {
-        if ( collectionSchemeManager->mProcessDecoderManifest )
+        if ( collectionSchemeManager->mProcessDecoderManifest && ( !deferDecoderManifestBuild ) )
         {
             collectionSchemeManager->mProcessDecoderManifest = false;
             TraceModule::get().sectionBegin( TraceSection::MANAGER_DECODER_BUILD );
@@ -232,7 +224,17 @@ CollectionSchemeManager::doWork( void *data )
             if ( !collectionSchemeManager->mUseLocalDictionary )
             {
                 std::map<VehicleDataSourceProtocol, std::shared_ptr<CANDecoderDictionary>> decoderDictionaryMap;
-                collectionSchemeManager->decoderDictionaryExtractor( decoderDictionaryMap );
+                if ( !collectionSchemeManager->useDecoderDictionarySnapshot( decoderDictionaryMap ) )
+                {
+                    if ( deferDecoderManifestBuild )
+                    {
+                        // The snapshot does not match, so the decoder manifest is needed right now
+                        deferDecoderManifestBuild = false;
+                        static_cast<void>( collectionSchemeManager->buildDeferredDecoderManifest() );
+                    }
+                    collectionSchemeManager->decoderDictionaryExtractor( decoderDictionaryMap );
+                    collectionSchemeManager->storeDecoderDictionarySnapshot( decoderDictionaryMap );
+                }
                 // Publish decoder dictionaries update to all listeners
                 collectionSchemeManager->decoderDictionaryUpdater( decoderDictionaryMap );
                 // coverity[check_return : SUPPRESS]
@@ -269,23 +271,28 @@ CollectionSchemeManager::doWork( void *data )
                     std::to_string( inspectionMatrixOutput->conditions.size() ) + " inspection conditions" );
             TraceModule::get().sectionEnd( TraceSection::MANAGER_EXTRACTION );
         }
+        if ( deferDecoderManifestBuild )
+        {
+            // The data collection runs with the snapshot, build the decoder manifest for the next extractions
+            deferDecoderManifestBuild = false;
+            enabledCollectionSchemeMapChanged |= collectionSchemeManager->buildDeferredDecoderManifest();
+        }
         /*
          * get next timePoint from the minHeap top
-         * check if it is a valid timePoint, it can be obsoleted if start Time or stop Time gets updated
-         * It should be always valid because Checkin is default to be running all the time
+         * It is always valid because time points are moved or cancelled when start Time or stop Time gets updated
          */
         auto currentTime = collectionSchemeManager->mClock->timeSinceEpochMs();
         if ( collectionSchemeManager->mTimeLine.empty() )
         {
             collectionSchemeManager->mWait.wait( Platform::Linux::Signal::WaitWithPredicate );
         }
-        else if ( currentTime >= collectionSchemeManager->mTimeLine.top().first )
+        else if ( currentTime >= collectionSchemeManager->mTimeLine.topTime() )
         {
             // Next checkin time has already expired
         }
         else
         {
-            uint32_t waitTime = static_cast<uint32_t>( collectionSchemeManager->mTimeLine.top().first - currentTime );
+            uint32_t waitTime = static_cast<uint32_t>( collectionSchemeManager->mTimeLine.topTime() - currentTime );
             collectionSchemeManager->mWait.wait( waitTime );
         }
         /* now it is either timer expires, an update arrives from PI, or stop() is called */
@@ -407,6 +414,7 @@ CollectionSchemeManager::processDecoderManifest()
         mLogger.trace( "CollectionSchemeManager::processDecoderManifest",
                        "Ignoring new decoder manifest with same name: " + currentDecoderManifestID );
         // no change in decoder manifest
+        mDecoderManifest->releaseData();
         return false;
     }
     mLogger.trace( "CollectionSchemeManager::processDecoderManifest",
@@ -416,6 +424,8 @@ CollectionSchemeManager::processDecoderManifest()
     // store the new DM, update currentDecoderManifestID
     currentDecoderManifestID = mDecoderManifest->getID();
     store( DataType::DECODER_MANIFEST );
+    // The binary data is only needed to persist the document, the built decoder manifest holds everything else
+    mDecoderManifest->releaseData();
     // when DM changes, check if we have collectionScheme loaded
     if ( isCollectionSchemeLoaded() )
     {
@@ -449,6 +459,7 @@ CollectionSchemeManager::processCollectionScheme()
     }
     // Build is successful. Store collectionScheme
     store( DataType::COLLECTION_SCHEME_LIST );
+    mCollectionSchemeList->releaseData();
     if ( isCollectionSchemeLoaded() )
     {
         // there are existing collectionSchemes, try to update the existing one
@@ -498,15 +509,14 @@ CollectionSchemeManager::rebuildMapsandTimeLine( const TimePointInMsec &currTime
         std::string id = collectionScheme->getCollectionSchemeID();
         if ( startTime > currTime )
         {
-            /* for idleCollectionSchemes, push both startTime and stopTime to timeLine */
+            /* for idleCollectionSchemes, schedule the startTime, the stopTime is scheduled when enabled */
             mIdleCollectionSchemeMap[id] = collectionScheme;
-            mTimeLine.push( std::make_pair( startTime, id ) );
-            mTimeLine.push( std::make_pair( stopTime, id ) );
+            mTimeLine.schedule( id, startTime );
         }
-        else if ( stopTime > currTime )
+        else if ( ( stopTime > currTime ) && buildDeferredCollectionScheme( collectionScheme ) )
         { /* At rebuild, if a collectionScheme's startTime has already passed, enable collectionScheme immediately */
             mEnabledCollectionSchemeMap[id] = collectionScheme;
-            mTimeLine.push( std::make_pair( stopTime, id ) );
+            mTimeLine.schedule( id, stopTime );
             ret = true;
         }
     }
@@ -581,17 +591,19 @@ CollectionSchemeManager::updateMapsandTimeLine( const TimePointInMsec &currTime
             {
                 /* This collectionScheme needs to stop immediately */
                 mEnabledCollectionSchemeMap.erase( id );
+                mTimeLine.cancel( id );
                 ret = true;
                 std::string completedStr;
                 completedStr = "Stopping enabled CollectionScheme: ";
                 printEventLogMsg( completedStr, id, startTime, stopTime, currTime );
                 mLogger.trace( "collectionSchemeManager::updateMapsandTimeLine ", completedStr );
             }
-            else if ( stopTime != currCollectionScheme->getExpiryTime() )
+            else if ( ( stopTime != currCollectionScheme->getExpiryTime() ) &&
+                      buildDeferredCollectionScheme( collectionScheme ) )
             {
                 /* StopTime changes on that collectionScheme, update with new CollectionScheme */
                 mEnabledCollectionSchemeMap[id] = collectionScheme;
-                mTimeLine.push( std::make_pair( stopTime, id ) );
+                mTimeLine.schedule( id, stopTime );
             }
         }
         else if ( itIdle != mIdleCollectionSchemeMap.end() )
@@ -602,9 +614,14 @@ CollectionSchemeManager::updateMapsandTimeLine( const TimePointInMsec &currTime
             {
                 /* this collectionScheme needs to start immediately */
                 mIdleCollectionSchemeMap.erase( id );
+                if ( !buildDeferredCollectionScheme( collectionScheme ) )
+                {
+                    mTimeLine.cancel( id );
+                    continue;
+                }
                 mEnabledCollectionSchemeMap[id] = collectionScheme;
                 ret = true;
-                mTimeLine.push( std::make_pair( stopTime, id ) );
+                mTimeLine.schedule( id, stopTime );
                 std::string startStr;
                 startStr = "Starting idle collectionScheme now: ";
                 printEventLogMsg( startStr, id, startTime, stopTime, currTime );
@@ -616,8 +633,7 @@ CollectionSchemeManager::updateMapsandTimeLine( const TimePointInMsec &currTime
                 // this collectionScheme is an idle collectionScheme, and its startTime or ExpiryTime
                 // or both need updated
                 mIdleCollectionSchemeMap[id] = collectionScheme;
-                mTimeLine.push( make_pair( startTime, id ) );
-                mTimeLine.push( make_pair( stopTime, id ) );
+                mTimeLine.schedule( id, startTime );
             }
         }
         else
@@ -632,15 +648,17 @@ CollectionSchemeManager::updateMapsandTimeLine( const TimePointInMsec &currTime
             mLogger.trace( "collectionSchemeManager::updateMapsandTimeLine ", addStr );
             if ( startTime <= currTime && stopTime > currTime )
             {
-                mEnabledCollectionSchemeMap[id] = collectionScheme;
-                mTimeLine.push( std::make_pair( stopTime, id ) );
-                ret = true;
+                if ( buildDeferredCollectionScheme( collectionScheme ) )
+                {
+                    mEnabledCollectionSchemeMap[id] = collectionScheme;
+                    mTimeLine.schedule( id, stopTime );
+                    ret = true;
+                }
             }
             else if ( startTime > currTime )
             {
                 mIdleCollectionSchemeMap[id] = collectionScheme;
-                mTimeLine.push( std::make_pair( startTime, id ) );
-                mTimeLine.push( std::make_pair( stopTime, id ) );
+                mTimeLine.schedule( id, startTime );
             }
         }
     }
@@ -651,6 +669,7 @@ CollectionSchemeManager::updateMapsandTimeLine( const TimePointInMsec &currTime
         if ( newCollectionSchemeIDs.find( it->first ) == newCollectionSchemeIDs.end() )
         {
             removeStr += it->first;
+            mTimeLine.cancel( it->first );
             it = mIdleCollectionSchemeMap.erase( it );
         }
         else
@@ -664,6 +683,7 @@ CollectionSchemeManager::updateMapsandTimeLine( const TimePointInMsec &currTime
         if ( newCollectionSchemeIDs.find( it->first ) == newCollectionSchemeIDs.end() )
         {
             removeStr += it->first;
+            mTimeLine.cancel( it->first );
             it = mEnabledCollectionSchemeMap.erase( it );
             ret = true;
         }
@@ -684,23 +704,33 @@ CollectionSchemeManager::updateMapsandTimeLine( const TimePointInMsec &currTime
     return ret;
 }
 
+bool
+CollectionSchemeManager::buildDeferredCollectionScheme( const ICollectionSchemePtr &collectionScheme )
+{
+    // The ID is not available anymore if the build fails, buildIfDeferred logs it
+    if ( !collectionScheme->buildIfDeferred() )
+    {
+        mLogger.error( "CollectionSchemeManager::buildDeferredCollectionScheme",
+                       "A deferred CollectionScheme failed to build. Dropping it." );
+        return false;
+    }
+    return true;
+}
+
 /*
  * This function checks timeline,
  * 1. Timer has not expired but main thread wakes up because of PI updates,
  * this function always checks if it is a timer expiration first.
  * If not, simply exit, return false;
- * 2. Otherwise,
- *      get topTime and topCollectionSchemeID from top of MINheap,
- *      if it is checkin event, simply send out checkin, this is false case;
- *      if collectionScheme in Enabled Map, and stopTime equal to topTime, time to disable this collectionScheme, this
- * is a true case; else if CollectionScheme in idle map, and startTime equals to topTime, time to enable this
- * collectionScheme, this is a true case; for the rest of the cases, all false;
+ * 2. Otherwise, for every expired time point on top of the MINheap,
+ *      if it is checkin event, send out checkin and schedule the next one, this is false case;
+ *      if collectionScheme in Enabled Map, its stopTime expired, time to disable this collectionScheme, this
+ * is a true case; else if CollectionScheme in idle map, its startTime expired, time to enable this
+ * collectionScheme and schedule its stopTime, this is a true case;
  *
- * 3. search for the next valid timePoint to set up timer;
- *  Because client may update existing collectionSchemes with new start and stop time, the timepoint
- *  in mTimeline needs to be scanned to make sure next timer is set up for a valid collectionScheme at
- *  a valid time.
- *  The will save us from waking up at an obsolete timePoint and waste context switch.
+ *  Every collectionScheme has at most one time point on the timeline: the startTime while idle and the stopTime
+ *  while enabled. Time points are moved or cancelled when a collectionScheme is updated or removed, so the top of
+ *  the timeline is always a valid timePoint to set up the next timer.
  *
  * returns true when enabled map changes;
  */
@@ -708,27 +738,13 @@ bool
 CollectionSchemeManager::checkTimeLine( const TimePointInMsec &currTime )
 {
     bool ret = false;
-    if ( mTimeLine.empty() || currTime < mTimeLine.top().first )
-    {
-        // Timer has not expired, do nothing
-        return ret;
-    }
-    while ( !mTimeLine.empty() )
+    while ( ( !mTimeLine.empty() ) && ( mTimeLine.topTime() <= currTime ) )
     {
-        const auto &topPair = mTimeLine.top();
-        const std::string &topCollectionSchemeID = topPair.second;
-        const TimePointInMsec &topTime = topPair.first;
+        // Copied as the timeline is modified below
+        const std::string topCollectionSchemeID = mTimeLine.topID();
+        const TimePointInMsec topTime = mTimeLine.topTime();
         if ( topCollectionSchemeID == CHECKIN )
         {
-            // for checkin, we are about to
-            // either serve current checkin event, and move on to search for next timePoint to set up timer;
-            // or we find current checkin for setting up next timer, then we are done here;
-            if ( currTime < topTime )
-            {
-                // Successfully locate next checkin as timePoint to set up timer
-                // time to exit
-                break;
-            }
             // Try to send the checkin message.
             // If it succeeds, we will schedule the next checkin cycle using the provided interval.
             // If it does not succeed ( e.g. no offboardconnectivity), we schedule for a retry immediately.
@@ -738,134 +754,79 @@ CollectionSchemeManager::checkTimeLine( const TimePointInMsec &currTime )
             {
                 if ( mCheckinIntervalInMsec > 0 )
                 {
-                    TimePointInMsec nextCheckinTime = currTime + mCheckinIntervalInMsec;
-                    TimeData newPair = std::make_pair( nextCheckinTime, CHECKIN );
-                    mTimeLine.push( newPair );
+                    mTimeLine.schedule( CHECKIN, currTime + mCheckinIntervalInMsec );
+                }
+                else
+                {
+                    // no checkin message is scheduled.
+                    mTimeLine.pop();
                 }
-                // else, no checkin message is scheduled.
             }
             else
             {
                 // Schedule with for a quick retry
-                // Calculate the minimum retry interval
+                // Calculate the minimum retry interval, a failure of many vehicles at once is retried spread out
                 uint64_t minimumCheckinInterval =
                     std::min( static_cast<uint64_t>( RETRY_CHECKIN_INTERVAL_IN_MILLISECOND ), mCheckinIntervalInMsec );
-                TimePointInMsec nextCheckinTime = currTime + minimumCheckinInterval;
-                TimeData newPair = std::make_pair( nextCheckinTime, CHECKIN );
-                mTimeLine.push( newPair );
+                minimumCheckinInterval += mDeviceJitter.getOffsetMs( "checkinRetry", minimumCheckinInterval );
+                mTimeLine.schedule( CHECKIN, currTime + minimumCheckinInterval );
                 mLogger.warn( "CollectionSchemeManager::checkTimeLine",
                               "The checkin message sending failed. Rescheduling the operation in : " +
                                   std::to_string( minimumCheckinInterval ) + " ms" );
             }
-
-            // after sending checkin, the work on this dataPair is done, move to next dataPair
-            // to look for next valid timePoint to set up timer
-            mTimeLine.pop();
             continue;
         }
 
         // in case of non-checkin
         // first find topCollectionSchemeID in mEnabledCollectionSchemeMap then mIdleCollectionSchemeMap
-        // if we find a match in collectionScheme ID, check further if topTime matches this collectionScheme's
-        // start/stop time
-        bool foundInEnabled = true;
         auto it = mEnabledCollectionSchemeMap.find( topCollectionSchemeID );
-        if ( it == mEnabledCollectionSchemeMap.end() )
-        {
-            it = mIdleCollectionSchemeMap.find( topCollectionSchemeID );
-            if ( it == mIdleCollectionSchemeMap.end() )
-            {
-                // Could not find it in Enabled map nor in Idle map,
-                // this collectionScheme must have been disabled earlier per
-                // client request, this dataPair is obsolete, just drop it
-                // keep searching for next valid TimePoint
-                // to set up timer
-                mLogger.trace( "CollectionSchemeManager::checkTimeLine ",
-                               "CollectionScheme not found: " + topCollectionSchemeID );
-                mTimeLine.pop();
-                continue;
-            }
-            foundInEnabled = false;
-        }
-        // found it, continue examining topTime
-        ICollectionSchemePtr currCollectionScheme;
-        TimePointInMsec timeOfInterest = 0ULL;
-        if ( foundInEnabled )
-        {
-            // This collectionScheme is found in mEnabledCollectionSchemeMap
-            // topCollectionSchemeID has been enabled, check if stop time matches
-            currCollectionScheme = mEnabledCollectionSchemeMap[topCollectionSchemeID];
-            timeOfInterest = currCollectionScheme->getExpiryTime();
-        }
-        else
+        if ( it != mEnabledCollectionSchemeMap.end() )
         {
-            // This collectionScheme is found in mIdleCollectionSchemeMap
-            // topCollectionSchemeID has not been enabled, check if start time matches
-            currCollectionScheme = mIdleCollectionSchemeMap[topCollectionSchemeID];
-            timeOfInterest = currCollectionScheme->getStartTime();
+            // it is time to disable the collectionScheme
+            ret = true;
+            std::string disableStr;
+            disableStr = "Disabling enabled collectionScheme: ";
+            printEventLogMsg( disableStr,
+                              topCollectionSchemeID,
+                              it->second->getStartTime(),
+                              it->second->getExpiryTime(),
+                              topTime );
+            mLogger.info( "CollectionSchemeManager::checkTimeLine ", disableStr );
+            mEnabledCollectionSchemeMap.erase( it );
+            mTimeLine.pop();
+            continue;
         }
-        if ( timeOfInterest != topTime )
+        it = mIdleCollectionSchemeMap.find( topCollectionSchemeID );
+        if ( it == mIdleCollectionSchemeMap.end() )
         {
-            // this dataPair has a valid collectionScheme ID, but the start time or stop time is already updated
-            // not equal to topTime any more; This is an obsolete dataPair. Simply drop it and move on
-            // to next pair
+            // Could not find it in Enabled map nor in Idle map, drop the time point
             mLogger.trace( "CollectionSchemeManager::checkTimeLine ",
-                           "found collectionScheme: " + topCollectionSchemeID +
-                               " but time does not match: "
-                               "topTime " +
-                               std::to_string( topTime ) + " timeFromCollectionScheme " +
-                               std::to_string( timeOfInterest ) );
+                           "CollectionScheme not found: " + topCollectionSchemeID );
             mTimeLine.pop();
             continue;
         }
-        // now we have a dataPair with valid collectionScheme ID, and valid start/stop time
-        // Check if it is time to enable/disable this collectionScheme, or else
-        // topTime is far down the timeline, it is a timePoint to set up next timer.
-        if ( topTime <= currTime )
-        {
-            ret = true;
-            // it is time to enable or disable this collectionScheme
-            if ( !foundInEnabled )
-            {
-                // enable the collectionScheme
-                mEnabledCollectionSchemeMap[topCollectionSchemeID] = currCollectionScheme;
-                mIdleCollectionSchemeMap.erase( topCollectionSchemeID );
-                std::string enableStr;
-                enableStr = "Enabling idle collectionScheme: ";
-                printEventLogMsg( enableStr,
-                                  topCollectionSchemeID,
-                                  currCollectionScheme->getStartTime(),
-                                  currCollectionScheme->getExpiryTime(),
-                                  topTime );
-                mLogger.info( "CollectionSchemeManager::checkTimeLine ", enableStr );
-            }
-            else
-            {
-                // disable the collectionScheme
-                std::string disableStr;
-                disableStr = "Disabling enabled collectionScheme: ";
-                printEventLogMsg( disableStr,
-                                  topCollectionSchemeID,
-                                  currCollectionScheme->getStartTime(),
-                                  currCollectionScheme->getExpiryTime(),
-                                  topTime );
-                mLogger.info( "CollectionSchemeManager::checkTimeLine ", disableStr );
-                mEnabledCollectionSchemeMap.erase( topCollectionSchemeID );
-            }
-        }
-        else
+        // it is time to enable the collectionScheme, from now on its stop time is of interest
+        ICollectionSchemePtr currCollectionScheme = it->second;
+        mIdleCollectionSchemeMap.erase( it );
+        if ( !buildDeferredCollectionScheme( currCollectionScheme ) )
         {
-            // Successfully locate the next valid TimePoint
-            // stop searching
-            break;
+            mTimeLine.pop();
+            continue;
         }
-        // continue searching for next valid timepoint to set up timer
-        mTimeLine.pop();
+        ret = true;
+        mEnabledCollectionSchemeMap[topCollectionSchemeID] = currCollectionScheme;
+        TimePointInMsec stopTime = currCollectionScheme->getExpiryTime();
+        mTimeLine.schedule( topCollectionSchemeID, stopTime );
+        std::string enableStr;
+        enableStr = "Enabling idle collectionScheme: ";
+        printEventLogMsg(
+            enableStr, topCollectionSchemeID, currCollectionScheme->getStartTime(), stopTime, topTime );
+        mLogger.info( "CollectionSchemeManager::checkTimeLine ", enableStr );
     }
     if ( !mTimeLine.empty() )
     {
         mLogger.trace( "CollectionSchemeManager::checkTimeLine ",
-                       "top pair: " + std::to_string( mTimeLine.top().first ) + " " + mTimeLine.top().second +
+                       "top time point: " + std::to_string( mTimeLine.topTime() ) + " " + mTimeLine.topID() +
                            " currTime: " + std::to_string( currTime ) );
     }
     return ret;
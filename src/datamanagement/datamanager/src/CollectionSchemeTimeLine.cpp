@@ -0,0 +1,185 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "CollectionSchemeTimeLine.h"
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataManagement
+{
+
+void
+CollectionSchemeTimeLine::schedule( const std::string &id, TimePointInMsec timePoint )
+{
+    auto handle = mHandles.find( id );
+    if ( handle != mHandles.end() )
+    {
+        // Move the existing time point up or down the heap
+        auto position = mPositions[handle->second];
+        auto previousTimePoint = mHeap[position].timePoint;
+        mHeap[position].timePoint = timePoint;
+        if ( timePoint < previousTimePoint )
+        {
+            siftUp( position );
+        }
+        else
+        {
+            siftDown( position );
+        }
+        return;
+    }
+
+    Handle newHandle = 0;
+    if ( !mFreeHandles.empty() )
+    {
+        newHandle = mFreeHandles.back();
+        mFreeHandles.pop_back();
+        mIDs[newHandle] = id;
+    }
+    else
+    {
+        newHandle = static_cast<Handle>( mIDs.size() );
+        mIDs.emplace_back( id );
+        mPositions.emplace_back( 0 );
+    }
+    mHandles.emplace( id, newHandle );
+    mHeap.emplace_back( Entry{ timePoint, newHandle } );
+    mPositions[newHandle] = mHeap.size() - 1;
+    siftUp( mHeap.size() - 1 );
+}
+
+void
+CollectionSchemeTimeLine::cancel( const std::string &id )
+{
+    auto handle = mHandles.find( id );
+    if ( handle != mHandles.end() )
+    {
+        removeAt( mPositions[handle->second] );
+    }
+}
+
+bool
+CollectionSchemeTimeLine::isScheduled( const std::string &id ) const
+{
+    return mHandles.find( id ) != mHandles.end();
+}
+
+bool
+CollectionSchemeTimeLine::getTimePoint( const std::string &id, TimePointInMsec &timePoint ) const
+{
+    auto handle = mHandles.find( id );
+    if ( handle == mHandles.end() )
+    {
+        return false;
+    }
+    timePoint = mHeap[mPositions[handle->second]].timePoint;
+    return true;
+}
+
+void
+CollectionSchemeTimeLine::pop()
+{
+    removeAt( 0 );
+}
+
+void
+CollectionSchemeTimeLine::clear()
+{
+    mHeap.clear();
+    mPositions.clear();
+    mIDs.clear();
+    mFreeHandles.clear();
+    mHandles.clear();
+}
+
+void
+CollectionSchemeTimeLine::placeEntry( size_t position, const Entry &entry )
+{
+    mHeap[position] = entry;
+    mPositions[entry.handle] = position;
+}
+
+void
+CollectionSchemeTimeLine::siftUp( size_t position )
+{
+    Entry entry = mHeap[position];
+    while ( position > 0 )
+    {
+        size_t parent = ( position - 1 ) / 2;
+        if ( !isEarlier( entry, mHeap[parent] ) )
+        {
+            break;
+        }
+        placeEntry( position, mHeap[parent] );
+        position = parent;
+    }
+    placeEntry( position, entry );
+}
+
+void
+CollectionSchemeTimeLine::siftDown( size_t position )
+{
+    Entry entry = mHeap[position];
+    while ( true )
+    {
+        size_t child = ( 2 * position ) + 1;
+        if ( child >= mHeap.size() )
+        {
+            break;
+        }
+        if ( ( child + 1 < mHeap.size() ) && isEarlier( mHeap[child + 1], mHeap[child] ) )
+        {
+            child++;
+        }
+        if ( !isEarlier( mHeap[child], entry ) )
+        {
+            break;
+        }
+        placeEntry( position, mHeap[child] );
+        position = child;
+    }
+    placeEntry( position, entry );
+}
+
+void
+CollectionSchemeTimeLine::removeAt( size_t position )
+{
+    Handle handle = mHeap[position].handle;
+    mHandles.erase( mIDs[handle] );
+    mIDs[handle].clear();
+    mFreeHandles.emplace_back( handle );
+
+    Entry last = mHeap.back();
+    mHeap.pop_back();
+    if ( position == mHeap.size() )
+    {
+        return;
+    }
+    // Fill the gap with the last entry and restore the heap in the direction it violates
+    placeEntry( position, last );
+    if ( ( position > 0 ) && isEarlier( last, mHeap[( position - 1 ) / 2] ) )
+    {
+        siftUp( position );
+    }
+    else
+    {
+        siftDown( position );
+    }
+}
+
+} // namespace DataManagement
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -12,10 +12,16 @@
  */
 
 // Includes
+#include "CANDecoder.h"
 #include "CollectionSchemeManager.h"
 #include "TraceModule.h"
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <set>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace Aws
 {
@@ -23,7 +29,190 @@ namespace IoTFleetWise
 {
 namespace DataManagement
 {
-constexpr std::array<VehicleDataSourceProtocol, 2> CollectionSchemeManager::SUPPORTED_NETWORK_PROTOCOL;
+namespace
+{
+using CANFrameDecoderMethods = std::unordered_map<CANRawFrameID, CANMessageDecoderMethod>;
+
+const CANFrameDecoderMethods &
+getChannelDecoderMethods( const CANDecoderDictionary &dictionary, CANChannelNumericID channelID )
+{
+    static const CANFrameDecoderMethods NO_DECODER_METHODS;
+    auto channel = dictionary.canMessageDecoderMethod.find( channelID );
+    return channel == dictionary.canMessageDecoderMethod.end() ? NO_DECODER_METHODS : channel->second;
+}
+
+uint64_t
+getChannelSliceVersion( const CANDecoderDictionary &dictionary, CANChannelNumericID channelID )
+{
+    auto slice = dictionary.channelSlices.find( channelID );
+    return slice == dictionary.channelSlices.end() ? 0 : slice->second->version;
+}
+
+// FNV-1a, stable across builds and restarts unlike std::hash
+void
+addToFingerprint( uint64_t &hash, const void *data, size_t size )
+{
+    const auto *bytes = static_cast<const uint8_t *>( data );
+    for ( size_t i = 0; i < size; i++ )
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001B3ULL;
+    }
+}
+
+template <typename T>
+void
+addToFingerprint( uint64_t &hash, const T &value )
+{
+    addToFingerprint( hash, &value, sizeof( T ) );
+}
+
+void
+addToFingerprint( uint64_t &hash, const SignalEmissionPolicy &policy )
+{
+    addToFingerprint( hash, static_cast<uint32_t>( policy.mType ) );
+    addToFingerprint( hash, policy.mDeadband );
+    addToFingerprint( hash, policy.mMaxSilenceMs );
+}
+
+// The frames are added in the order of their IDs and the signals in the given order, so that equal rules give the
+// same fingerprint regardless of the iteration order of the maps
+uint64_t
+getChannelSliceFingerprint( const CANDecoderDictionary &slice,
+                            const CANFrameDecoderMethods &frames,
+                            const std::set<SignalID> &signalIDs )
+{
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    std::vector<CANRawFrameID> frameIDs;
+    frameIDs.reserve( frames.size() );
+    for ( const auto &frame : frames )
+    {
+        frameIDs.emplace_back( frame.first );
+    }
+    std::sort( frameIDs.begin(), frameIDs.end() );
+    for ( auto frameID : frameIDs )
+    {
+        const auto &decoderMethod = frames.at( frameID );
+        addToFingerprint( hash, frameID );
+        addToFingerprint( hash, static_cast<uint32_t>( decoderMethod.collectType ) );
+        addToFingerprint( hash, decoderMethod.format.mMessageID );
+        addToFingerprint( hash, decoderMethod.format.mSizeInBytes );
+        addToFingerprint( hash, decoderMethod.format.mIsMultiplexed );
+        addToFingerprint( hash, static_cast<uint64_t>( decoderMethod.format.mSignals.size() ) );
+        for ( const auto &signal : decoderMethod.format.mSignals )
+        {
+            addToFingerprint( hash, signal.mSignalID );
+            addToFingerprint( hash, signal.mSignalIndex );
+            addToFingerprint( hash, signal.mIsBigEndian );
+            addToFingerprint( hash, signal.mIsSigned );
+            addToFingerprint( hash, signal.mFirstBitPosition );
+            addToFingerprint( hash, signal.mSizeInBits );
+            addToFingerprint( hash, signal.mOffset );
+            addToFingerprint( hash, signal.mFactor );
+            addToFingerprint( hash, signal.mIsMultiplexorSignal );
+            addToFingerprint( hash, signal.mMultiplexorValue );
+            addToFingerprint( hash, signal.mEmissionPolicy );
+        }
+    }
+    for ( auto signalID : signalIDs )
+    {
+        addToFingerprint( hash, signalID );
+        addToFingerprint( hash, slice.signalIDsToCollect.count( signalID ) > 0 );
+        addToFingerprint( hash, slice.conditionSignalIDs.count( signalID ) > 0 );
+        auto policy = slice.signalEmissionPolicies.find( signalID );
+        addToFingerprint( hash, policy != slice.signalEmissionPolicies.end() );
+        if ( policy != slice.signalEmissionPolicies.end() )
+        {
+            addToFingerprint( hash, policy->second );
+        }
+        auto interval = slice.signalMinimumSampleIntervalsMs.find( signalID );
+        addToFingerprint( hash, interval == slice.signalMinimumSampleIntervalsMs.end() ? 0U : interval->second );
+        auto priority = slice.signalPriorities.find( signalID );
+        addToFingerprint( hash, priority != slice.signalPriorities.end() );
+        if ( priority != slice.signalPriorities.end() )
+        {
+            addToFingerprint( hash, priority->second );
+        }
+    }
+    // 0 is the version of a channel without a slice
+    return hash == 0 ? 1 : hash;
+}
+
+void
+addCollectedSignals( const CANMessageDecoderMethod &decoderMethod,
+                     const std::unordered_set<SignalID> &signalIDsToCollect,
+                     std::set<SignalID> &collectedSignalIDs )
+{
+    for ( const auto &signal : decoderMethod.format.mSignals )
+    {
+        if ( signalIDsToCollect.find( signal.mSignalID ) != signalIDsToCollect.end() )
+        {
+            collectedSignalIDs.insert( signal.mSignalID );
+        }
+    }
+}
+
+CANChannelDecoderDiff
+channelDecoderDiff( const CANDecoderDictionary &previous,
+                    const CANDecoderDictionary &current,
+                    CANChannelNumericID channelID )
+{
+    CANChannelDecoderDiff diff;
+    const auto &previousFrames = getChannelDecoderMethods( previous, channelID );
+    const auto &currentFrames = getChannelDecoderMethods( current, channelID );
+    std::set<SignalID> previousSignalIDs;
+    std::set<SignalID> currentSignalIDs;
+    for ( const auto &frame : currentFrames )
+    {
+        std::set<SignalID> frameSignalIDs;
+        addCollectedSignals( frame.second, current.signalIDsToCollect, frameSignalIDs );
+        auto previousFrame = previousFrames.find( frame.first );
+        if ( previousFrame == previousFrames.end() )
+        {
+            diff.addedFrameIDs.emplace_back( frame.first );
+        }
+        else
+        {
+            std::set<SignalID> previousFrameSignalIDs;
+            addCollectedSignals( previousFrame->second, previous.signalIDsToCollect, previousFrameSignalIDs );
+            if ( ( previousFrame->second.collectType != frame.second.collectType ) ||
+                 ( !( previousFrame->second.format == frame.second.format ) ) ||
+                 ( previousFrameSignalIDs != frameSignalIDs ) )
+            {
+                diff.changedFrameIDs.emplace_back( frame.first );
+            }
+            previousSignalIDs.insert( previousFrameSignalIDs.begin(), previousFrameSignalIDs.end() );
+        }
+        currentSignalIDs.insert( frameSignalIDs.begin(), frameSignalIDs.end() );
+    }
+    for ( const auto &frame : previousFrames )
+    {
+        if ( currentFrames.find( frame.first ) == currentFrames.end() )
+        {
+            diff.removedFrameIDs.emplace_back( frame.first );
+            addCollectedSignals( frame.second, previous.signalIDsToCollect, previousSignalIDs );
+        }
+    }
+    std::set_difference( currentSignalIDs.begin(),
+                         currentSignalIDs.end(),
+                         previousSignalIDs.begin(),
+                         previousSignalIDs.end(),
+                         std::back_inserter( diff.addedSignalIDs ) );
+    std::set_difference( previousSignalIDs.begin(),
+                         previousSignalIDs.end(),
+                         currentSignalIDs.begin(),
+                         currentSignalIDs.end(),
+                         std::back_inserter( diff.removedSignalIDs ) );
+    std::sort( diff.addedFrameIDs.begin(), diff.addedFrameIDs.end() );
+    std::sort( diff.removedFrameIDs.begin(), diff.removedFrameIDs.end() );
+    std::sort( diff.changedFrameIDs.begin(), diff.changedFrameIDs.end() );
+    diff.versionChanged =
+        getChannelSliceVersion( previous, channelID ) != getChannelSliceVersion( current, channelID );
+    return diff;
+}
+} // namespace
+
+constexpr std::array<VehicleDataSourceProtocol, 3> CollectionSchemeManager::SUPPORTED_NETWORK_PROTOCOL;
 void
 CollectionSchemeManager::decoderDictionaryExtractor(
     std::map<VehicleDataSourceProtocol, std::shared_ptr<CANDecoderDictionary>> &decoderDictionaryMap )
@@ -67,6 +256,12 @@ CollectionSchemeManager::decoderDictionaryExtractor(
                     auto &canDecoderDictionaryPtr = decoderDictionaryMap[networkType];
                     // Add signalID to the set of this decoder dictionary
                     canDecoderDictionaryPtr->signalIDsToCollect.insert( signalInfo.signalID );
+                    auto priority = canDecoderDictionaryPtr->signalPriorities.emplace(
+                        signalInfo.signalID, collectionSchemePtr->getPriority() );
+                    priority.first->second = std::min( priority.first->second, collectionSchemePtr->getPriority() );
+                    auto interval = canDecoderDictionaryPtr->signalMinimumSampleIntervalsMs.emplace(
+                        signalInfo.signalID, signalInfo.minimumSampleIntervalMs );
+                    interval.first->second = std::min( interval.first->second, signalInfo.minimumSampleIntervalMs );
                     // firstly check if we have canChannelID entry at dictionary top layer
                     if ( canDecoderDictionaryPtr->canMessageDecoderMethod.find( canChannelID ) ==
                          canDecoderDictionaryPtr->canMessageDecoderMethod.end() )
@@ -144,6 +339,39 @@ CollectionSchemeManager::decoderDictionaryExtractor(
                     .at( pidDecoderFormat.mPID )
                     .format.mSignals.emplace_back( format );
             }
+            else if ( networkType == VehicleDataSourceProtocol::UDS )
+            {
+                auto didDecoderFormat = mDecoderManifest->getDIDSignalDecoderFormat( signalInfo.signalID );
+                auto &udsDecoderDictionaryPtr = decoderDictionaryMap[networkType];
+                if ( !udsDecoderDictionaryPtr->signalIDsToCollect.insert( signalInfo.signalID ).second )
+                {
+                    // Already added by another collectionScheme
+                    continue;
+                }
+                // The channel is the ECU the DID is requested from, see toUDSDictionaryKey
+                auto key = toUDSDictionaryKey( didDecoderFormat.mDID, didDecoderFormat.mPeriodicTransmissionMode );
+                auto &decoderMethod =
+                    udsDecoderDictionaryPtr->canMessageDecoderMethod[didDecoderFormat.mRequestMessageID][key];
+                decoderMethod.collectType = CANMessageCollectType::DECODE;
+                decoderMethod.format.mMessageID = didDecoderFormat.mDID;
+                decoderMethod.format.mSizeInBytes = static_cast<uint8_t>( didDecoderFormat.mDidResponseLength );
+                // Same generic representation as for the OBD signals, relative to the data record of the DID
+                CANSignalFormat format;
+                format.mSignalID = signalInfo.signalID;
+                format.mFirstBitPosition =
+                    static_cast<uint16_t>( didDecoderFormat.mStartByte * BYTE_SIZE + didDecoderFormat.mBitRightShift );
+                format.mSizeInBits = static_cast<uint16_t>( ( didDecoderFormat.mByteLength - 1 ) * BYTE_SIZE +
+                                                            didDecoderFormat.mBitMaskLength );
+                format.mFactor = didDecoderFormat.mScaling;
+                format.mOffset = didDecoderFormat.mOffset;
+                decoderMethod.format.mSignals.emplace_back( format );
+                if ( didDecoderFormat.mPeriodicTransmissionMode != 0 )
+                {
+                    // The ECU streams periodic DIDs without further requests, they are decoded from the raw CAN
+                    // frames like any broadcast signal
+                    addPeriodicDIDSignal( signalInfo.signalID, didDecoderFormat, decoderDictionaryMap );
+                }
+            }
         }
         // Next let's iterate through the CAN Frames that collectionScheme wants to collect.
         // If some CAN Frame has signals to be decoded, we will set its collectType as RAW_AND_DECODE.
@@ -196,6 +424,49 @@ CollectionSchemeManager::decoderDictionaryExtractor(
             }
         }
     }
+    // Validate and precompute the decoding of every CAN message once instead of on every received frame. The plan
+    // only contains the signals to collect so that no lookup in signalIDsToCollect is needed per frame
+    auto canDictionary = decoderDictionaryMap.find( VehicleDataSourceProtocol::RAW_SOCKET );
+    if ( canDictionary != decoderDictionaryMap.end() )
+    {
+        for ( auto &channel : canDictionary->second->canMessageDecoderMethod )
+        {
+            for ( auto &frame : channel.second )
+            {
+                frame.second.decodePlan = CANDecoder::compileDecodePlan(
+                    frame.second.format, canDictionary->second->signalIDsToCollect );
+                // The emission policies are enforced by the CAN consumers right after decoding
+                for ( const auto &signal : frame.second.format.mSignals )
+                {
+                    if ( ( !signal.mEmissionPolicy.isAlways() ) &&
+                         ( canDictionary->second->signalIDsToCollect.count( signal.mSignalID ) > 0 ) )
+                    {
+                        canDictionary->second->signalEmissionPolicies[signal.mSignalID] = signal.mEmissionPolicy;
+                    }
+                }
+            }
+        }
+        // Signals needed with every sample are not rate limited by the CAN consumers
+        auto &intervals = canDictionary->second->signalMinimumSampleIntervalsMs;
+        for ( auto interval = intervals.begin(); interval != intervals.end(); )
+        {
+            interval = ( interval->second == 0 ) ? intervals.erase( interval ) : std::next( interval );
+        }
+        // Signals used in conditions are kept by the load shedding of the CAN consumers
+        for ( const auto &collectionScheme : mEnabledCollectionSchemeMap )
+        {
+            for ( const auto &node : collectionScheme.second->getAllExpressionNodes() )
+            {
+                if ( ( ( node.nodeType == ExpressionNodeType::SIGNAL ) ||
+                       ( node.nodeType == ExpressionNodeType::WINDOWFUNCTION ) ) &&
+                     ( canDictionary->second->signalIDsToCollect.count( node.signalID ) > 0 ) )
+                {
+                    canDictionary->second->conditionSignalIDs.insert( node.signalID );
+                }
+            }
+        }
+        buildChannelSlices( *canDictionary->second );
+    }
     for ( VehicleDataSourceProtocol networkType : SUPPORTED_NETWORK_PROTOCOL )
     {
         // check if the decoder dictionary has been created for this network type. If not, we need to explicity create
@@ -208,6 +479,67 @@ CollectionSchemeManager::decoderDictionaryExtractor(
     }
 }
 
+void
+CollectionSchemeManager::addPeriodicDIDSignal(
+    SignalID signalID,
+    const DIDSignalDecoderFormat &didDecoderFormat,
+    std::map<VehicleDataSourceProtocol, std::shared_ptr<CANDecoderDictionary>> &decoderDictionaryMap )
+{
+    auto canChannelID = mCANIDTranslator.getChannelNumericID( didDecoderFormat.mInterfaceID );
+    if ( canChannelID == INVALID_CAN_SOURCE_NUMERIC_ID )
+    {
+        mLogger.warn( "CollectionSchemeManager::addPeriodicDIDSignal",
+                      "Invalid Interface ID provided: " + didDecoderFormat.mInterfaceID );
+        return;
+    }
+    auto &canDecoderDictionaryPtr = decoderDictionaryMap[VehicleDataSourceProtocol::RAW_SOCKET];
+    if ( canDecoderDictionaryPtr == nullptr )
+    {
+        canDecoderDictionaryPtr = std::make_shared<CANDecoderDictionary>();
+    }
+    auto &frames = canDecoderDictionaryPtr->canMessageDecoderMethod[canChannelID];
+    auto frame = frames.find( didDecoderFormat.mPeriodicResponseMessageID );
+    if ( frame == frames.end() )
+    {
+        // All periodic DIDs of a response CAN ID share the frame, multiplexed by the low byte of the DID in byte 0
+        CANMessageDecoderMethod decoderMethod;
+        decoderMethod.collectType = CANMessageCollectType::DECODE;
+        decoderMethod.format.mMessageID = didDecoderFormat.mPeriodicResponseMessageID;
+        decoderMethod.format.mSizeInBytes = 8;
+        decoderMethod.format.mIsMultiplexed = true;
+        CANSignalFormat multiplexor;
+        multiplexor.mSignalID = INVALID_SIGNAL_ID;
+        multiplexor.mSizeInBits = BYTE_SIZE;
+        multiplexor.mFactor = 1.0;
+        multiplexor.mIsMultiplexorSignal = true;
+        decoderMethod.format.mSignals.emplace_back( multiplexor );
+        frame = frames.emplace( didDecoderFormat.mPeriodicResponseMessageID, decoderMethod ).first;
+    }
+    else if ( !frame->second.format.isMultiplexed() || frame->second.format.mSignals.empty() ||
+              ( frame->second.format.mSignals.front().mSignalID != INVALID_SIGNAL_ID ) )
+    {
+        mLogger.warn( "CollectionSchemeManager::addPeriodicDIDSignal",
+                      "CAN ID " + std::to_string( didDecoderFormat.mPeriodicResponseMessageID ) +
+                          " of periodic DID signal " + std::to_string( signalID ) + " is used by another message" );
+        return;
+    }
+    canDecoderDictionaryPtr->signalIDsToCollect.insert( signalID );
+    // Multi byte DID signals are big endian, so the first bit is the least significant bit in the last byte. The data
+    // record starts after the byte of the DID.
+    CANSignalFormat format;
+    format.mSignalID = signalID;
+    format.mIsBigEndian = true;
+    format.mMultiplexorValue = static_cast<uint8_t>( didDecoderFormat.mDID & 0xFFU );
+    format.mFirstBitPosition = static_cast<uint16_t>( ( didDecoderFormat.mStartByte + didDecoderFormat.mByteLength ) *
+                                                          BYTE_SIZE +
+                                                      didDecoderFormat.mBitRightShift );
+    format.mSizeInBits =
+        static_cast<uint16_t>( ( didDecoderFormat.mByteLength - 1 ) * BYTE_SIZE + didDecoderFormat.mBitMaskLength );
+    format.mFactor = didDecoderFormat.mScaling;
+    format.mOffset = didDecoderFormat.mOffset;
+    frame->second.format.mSignals.emplace_back( format );
+}
+
 // TODO: The collection scheme manager shall support generic decoder dictionary other than only can
 // SIM: https://issues.amazon.com/issues/IoTAutobahn-3800
 void
@@ -219,9 +551,102 @@ CollectionSchemeManager::decoderDictionaryUpdater(
         // Down cast the CAN Decoder Dictionary to base Decoder Dictionary. We will support more
         // types of Decoder Dictionary in later releases
         auto dictPtr = std::static_pointer_cast<const DecoderDictionary>( dict.second );
-        notifyListeners<const std::shared_ptr<const DecoderDictionary> &>(
-            &IActiveDecoderDictionaryListener::onChangeOfActiveDictionary, dictPtr, dict.first );
+        auto activeDictionary = mActiveDecoderDictionaryMap.find( dict.first );
+        if ( ( activeDictionary == mActiveDecoderDictionaryMap.end() ) || ( activeDictionary->second == nullptr ) ||
+             ( dict.second == nullptr ) )
+        {
+            mActiveDecoderDictionaryMap[dict.first] = dict.second;
+            notifyListeners<const std::shared_ptr<const DecoderDictionary> &>(
+                &IActiveDecoderDictionaryListener::onChangeOfActiveDictionary, dictPtr, dict.first );
+            continue;
+        }
+        // Only wake up the sources and consumers of the channels whose decoding rules changed
+        auto diff = decoderDictionaryDiff( *activeDictionary->second, *dict.second );
+        if ( diff.empty() )
+        {
+            mLogger.trace( "CollectionSchemeManager::decoderDictionaryUpdater",
+                           "Decoder dictionary of protocol " + std::to_string( static_cast<uint32_t>( dict.first ) ) +
+                               " unchanged" );
+            continue;
+        }
+        activeDictionary->second = dict.second;
+        notifyListeners<const std::shared_ptr<const DecoderDictionary> &,
+                        VehicleDataSourceProtocol,
+                        const DecoderDictionaryDiff &>(
+            &IActiveDecoderDictionaryListener::onIncrementalChangeOfActiveDictionary, dictPtr, dict.first, diff );
+    }
+}
+
+void
+CollectionSchemeManager::buildChannelSlices( CANDecoderDictionary &dictionary )
+{
+    dictionary.channelSlices.clear();
+    for ( const auto &channel : dictionary.canMessageDecoderMethod )
+    {
+        auto slice = std::make_shared<CANDecoderDictionary>();
+        auto &frames = slice->canMessageDecoderMethod.emplace( channel.first, channel.second ).first->second;
+        std::set<SignalID> signalIDs;
+        for ( const auto &frame : frames )
+        {
+            for ( const auto &signal : frame.second.format.mSignals )
+            {
+                signalIDs.insert( signal.mSignalID );
+            }
+        }
+        for ( auto signalID : signalIDs )
+        {
+            if ( dictionary.signalIDsToCollect.count( signalID ) > 0 )
+            {
+                slice->signalIDsToCollect.insert( signalID );
+            }
+            if ( dictionary.conditionSignalIDs.count( signalID ) > 0 )
+            {
+                slice->conditionSignalIDs.insert( signalID );
+            }
+            auto policy = dictionary.signalEmissionPolicies.find( signalID );
+            if ( policy != dictionary.signalEmissionPolicies.end() )
+            {
+                slice->signalEmissionPolicies.emplace( *policy );
+            }
+            auto interval = dictionary.signalMinimumSampleIntervalsMs.find( signalID );
+            if ( interval != dictionary.signalMinimumSampleIntervalsMs.end() )
+            {
+                slice->signalMinimumSampleIntervalsMs.emplace( *interval );
+            }
+            auto priority = dictionary.signalPriorities.find( signalID );
+            if ( priority != dictionary.signalPriorities.end() )
+            {
+                slice->signalPriorities.emplace( *priority );
+            }
+        }
+        slice->version = getChannelSliceFingerprint( *slice, frames, signalIDs );
+        dictionary.channelSlices.emplace( channel.first, std::move( slice ) );
+    }
+}
+
+DecoderDictionaryDiff
+CollectionSchemeManager::decoderDictionaryDiff( const CANDecoderDictionary &previous,
+                                                const CANDecoderDictionary &current )
+{
+    DecoderDictionaryDiff diff;
+    std::set<CANChannelNumericID> channelIDs;
+    for ( const auto &channel : previous.canMessageDecoderMethod )
+    {
+        channelIDs.insert( channel.first );
+    }
+    for ( const auto &channel : current.canMessageDecoderMethod )
+    {
+        channelIDs.insert( channel.first );
+    }
+    for ( auto channelID : channelIDs )
+    {
+        auto channelDiff = channelDecoderDiff( previous, current, channelID );
+        if ( !channelDiff.empty() )
+        {
+            diff.channels.emplace( channelID, std::move( channelDiff ) );
+        }
     }
+    return diff;
 }
 } // namespace DataManagement
 } // namespace IoTFleetWise
@@ -0,0 +1,410 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "DecoderDictionarySnapshot.h"
+#include "CANDecoder.h"
+#include "Crc32c.h"
+#include <cstring>
+#include <type_traits>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataManagement
+{
+constexpr uint32_t DecoderDictionarySnapshot::VERSION;
+
+namespace
+{
+constexpr uint32_t SNAPSHOT_MAGIC = 0x53444446U; // "FDDS"
+
+struct SnapshotHeader
+{
+    uint32_t magic{ 0 };
+    uint32_t version{ 0 };
+    uint32_t crc{ 0 }; /**< CRC32C of the data behind the header */
+    uint32_t size{ 0 };
+};
+
+/**
+ * @brief Appends values in the byte order of the device, as the snapshot is never read by another device
+ */
+class SnapshotWriter
+{
+public:
+    explicit SnapshotWriter( std::vector<uint8_t> &output )
+        : mOutput( output )
+    {
+    }
+
+    template <typename T>
+    void
+    write( T value )
+    {
+        static_assert( std::is_arithmetic<T>::value, "only arithmetic values" );
+        const auto *bytes = reinterpret_cast<const uint8_t *>( &value );
+        mOutput.insert( mOutput.end(), bytes, bytes + sizeof( T ) );
+    }
+
+    void
+    writeString( const std::string &value )
+    {
+        write( static_cast<uint32_t>( value.size() ) );
+        mOutput.insert( mOutput.end(), value.begin(), value.end() );
+    }
+
+private:
+    std::vector<uint8_t> &mOutput;
+};
+
+/**
+ * @brief Reads the values written by SnapshotWriter, failing instead of reading beyond the end
+ */
+class SnapshotReader
+{
+public:
+    SnapshotReader( const uint8_t *data, size_t size )
+        : mData( data )
+        , mSize( size )
+    {
+    }
+
+    template <typename T>
+    bool
+    read( T &value )
+    {
+        static_assert( std::is_arithmetic<T>::value, "only arithmetic values" );
+        if ( mSize - mOffset < sizeof( T ) )
+        {
+            return false;
+        }
+        std::memcpy( &value, mData + mOffset, sizeof( T ) );
+        mOffset += sizeof( T );
+        return true;
+    }
+
+    bool
+    readString( std::string &value )
+    {
+        uint32_t length = 0;
+        if ( ( !read( length ) ) || ( mSize - mOffset < length ) )
+        {
+            return false;
+        }
+        value.assign( reinterpret_cast<const char *>( mData + mOffset ), length );
+        mOffset += length;
+        return true;
+    }
+
+    bool
+    isAtEnd() const
+    {
+        return mOffset == mSize;
+    }
+
+private:
+    const uint8_t *mData;
+    size_t mSize;
+    size_t mOffset{ 0 };
+};
+
+void
+writeEmissionPolicy( SnapshotWriter &writer, const SignalEmissionPolicy &policy )
+{
+    writer.write( static_cast<uint8_t>( policy.mType ) );
+    writer.write( policy.mDeadband );
+    writer.write( policy.mMaxSilenceMs );
+}
+
+bool
+readEmissionPolicy( SnapshotReader &reader, SignalEmissionPolicy &policy )
+{
+    uint8_t type = 0;
+    if ( ( !reader.read( type ) ) || ( type > static_cast<uint8_t>( SignalEmissionPolicyType::RELATIVE_DEADBAND ) ) )
+    {
+        return false;
+    }
+    policy.mType = static_cast<SignalEmissionPolicyType>( type );
+    return reader.read( policy.mDeadband ) && reader.read( policy.mMaxSilenceMs );
+}
+
+void
+writeMessageFormat( SnapshotWriter &writer, const CANMessageFormat &format )
+{
+    writer.write( format.mMessageID );
+    writer.write( format.mSizeInBytes );
+    writer.write( static_cast<uint8_t>( format.mIsMultiplexed ) );
+    writer.write( static_cast<uint32_t>( format.mSignals.size() ) );
+    for ( const auto &signal : format.mSignals )
+    {
+        writer.write( signal.mSignalID );
+        writer.write( static_cast<uint8_t>( signal.mIsBigEndian ) );
+        writer.write( static_cast<uint8_t>( signal.mIsSigned ) );
+        writer.write( signal.mFirstBitPosition );
+        writer.write( signal.mSizeInBits );
+        writer.write( signal.mOffset );
+        writer.write( signal.mFactor );
+        writer.write( static_cast<uint8_t>( signal.mIsMultiplexorSignal ) );
+        writer.write( signal.mMultiplexorValue );
+        writeEmissionPolicy( writer, signal.mEmissionPolicy );
+    }
+}
+
+bool
+readBool( SnapshotReader &reader, bool &value )
+{
+    uint8_t byte = 0;
+    if ( !reader.read( byte ) )
+    {
+        return false;
+    }
+    value = byte != 0U;
+    return true;
+}
+
+bool
+readMessageFormat( SnapshotReader &reader, CANMessageFormat &format )
+{
+    uint32_t signalCount = 0;
+    if ( ( !reader.read( format.mMessageID ) ) || ( !reader.read( format.mSizeInBytes ) ) ||
+         ( !readBool( reader, format.mIsMultiplexed ) ) || ( !reader.read( signalCount ) ) )
+    {
+        return false;
+    }
+    for ( uint32_t i = 0; i < signalCount; i++ )
+    {
+        CANSignalFormat signal;
+        if ( ( !reader.read( signal.mSignalID ) ) || ( !readBool( reader, signal.mIsBigEndian ) ) ||
+             ( !readBool( reader, signal.mIsSigned ) ) || ( !reader.read( signal.mFirstBitPosition ) ) ||
+             ( !reader.read( signal.mSizeInBits ) ) || ( !reader.read( signal.mOffset ) ) ||
+             ( !reader.read( signal.mFactor ) ) || ( !readBool( reader, signal.mIsMultiplexorSignal ) ) ||
+             ( !reader.read( signal.mMultiplexorValue ) ) || ( !readEmissionPolicy( reader, signal.mEmissionPolicy ) ) )
+        {
+            return false;
+        }
+        format.mSignals.emplace_back( signal );
+    }
+    return true;
+}
+} // namespace
+
+bool
+DecoderDictionarySnapshot::serialize( CANInterfaceIDTranslator &canIDTranslator, std::vector<uint8_t> &output ) const
+{
+    output.assign( sizeof( SnapshotHeader ), 0 );
+    SnapshotWriter writer( output );
+    writer.writeString( decoderManifestID );
+    writer.write( decoderManifestDigest );
+    writer.write( collectionSchemeListDigest );
+    writer.write( static_cast<uint32_t>( enabledCollectionSchemeIDs.size() ) );
+    for ( const auto &id : enabledCollectionSchemeIDs )
+    {
+        writer.writeString( id );
+    }
+    writer.writeString( compressionDictionary == nullptr ? std::string() : *compressionDictionary );
+
+    writer.write( static_cast<uint32_t>( decoderDictionaries.size() ) );
+    for ( const auto &protocolDictionary : decoderDictionaries )
+    {
+        const auto &dictionary = *protocolDictionary.second;
+        writer.write( static_cast<uint32_t>( protocolDictionary.first ) );
+        writer.write( static_cast<uint32_t>( dictionary.signalIDsToCollect.size() ) );
+        for ( auto signalID : dictionary.signalIDsToCollect )
+        {
+            writer.write( signalID );
+        }
+        writer.write( static_cast<uint32_t>( dictionary.signalEmissionPolicies.size() ) );
+        for ( const auto &policy : dictionary.signalEmissionPolicies )
+        {
+            writer.write( policy.first );
+            writeEmissionPolicy( writer, policy.second );
+        }
+        writer.write( static_cast<uint32_t>( dictionary.canMessageDecoderMethod.size() ) );
+        for ( const auto &channel : dictionary.canMessageDecoderMethod )
+        {
+            // Only the channels of raw CAN are numbered by the interface configuration
+            std::string interfaceID;
+            if ( protocolDictionary.first == VehicleDataSourceProtocol::RAW_SOCKET )
+            {
+                interfaceID = canIDTranslator.getInterfaceID( channel.first );
+                if ( interfaceID == INVALID_CAN_INTERFACE_ID )
+                {
+                    return false;
+                }
+            }
+            writer.write( channel.first );
+            writer.writeString( interfaceID );
+            writer.write( static_cast<uint32_t>( channel.second.size() ) );
+            for ( const auto &frame : channel.second )
+            {
+                writer.write( frame.first );
+                writer.write( static_cast<uint8_t>( frame.second.collectType ) );
+                writeMessageFormat( writer, frame.second.format );
+            }
+        }
+    }
+
+    SnapshotHeader header;
+    header.magic = SNAPSHOT_MAGIC;
+    header.version = VERSION;
+    header.size = static_cast<uint32_t>( output.size() - sizeof( SnapshotHeader ) );
+    header.crc = Platform::Linux::PersistencyManagement::crc32c(
+        0, output.data() + sizeof( SnapshotHeader ), output.size() - sizeof( SnapshotHeader ) );
+    std::memcpy( output.data(), &header, sizeof( SnapshotHeader ) );
+    return true;
+}
+
+bool
+DecoderDictionarySnapshot::deserialize( const uint8_t *data,
+                                        size_t size,
+                                        CANInterfaceIDTranslator &canIDTranslator )
+{
+    SnapshotHeader header;
+    if ( ( data == nullptr ) || ( size < sizeof( SnapshotHeader ) ) )
+    {
+        return false;
+    }
+    std::memcpy( &header, data, sizeof( SnapshotHeader ) );
+    if ( ( header.magic != SNAPSHOT_MAGIC ) || ( header.version != VERSION ) ||
+         ( header.size != size - sizeof( SnapshotHeader ) ) ||
+         ( header.crc !=
+           Platform::Linux::PersistencyManagement::crc32c( 0, data + sizeof( SnapshotHeader ), header.size ) ) )
+    {
+        return false;
+    }
+
+    SnapshotReader reader( data + sizeof( SnapshotHeader ), header.size );
+    uint32_t count = 0;
+    if ( ( !reader.readString( decoderManifestID ) ) || ( !reader.read( decoderManifestDigest ) ) ||
+         ( !reader.read( collectionSchemeListDigest ) ) || ( !reader.read( count ) ) )
+    {
+        return false;
+    }
+    enabledCollectionSchemeIDs.clear();
+    for ( uint32_t i = 0; i < count; i++ )
+    {
+        std::string id;
+        if ( !reader.readString( id ) )
+        {
+            return false;
+        }
+        enabledCollectionSchemeIDs.emplace_back( std::move( id ) );
+    }
+    std::string dictionaryBytes;
+    if ( !reader.readString( dictionaryBytes ) )
+    {
+        return false;
+    }
+    compressionDictionary.reset();
+    if ( !dictionaryBytes.empty() )
+    {
+        compressionDictionary = std::make_shared<const std::string>( std::move( dictionaryBytes ) );
+    }
+
+    decoderDictionaries.clear();
+    uint32_t dictionaryCount = 0;
+    if ( !reader.read( dictionaryCount ) )
+    {
+        return false;
+    }
+    for ( uint32_t d = 0; d < dictionaryCount; d++ )
+    {
+        uint32_t protocol = 0;
+        auto dictionary = std::make_shared<CANDecoderDictionary>();
+        if ( ( !reader.read( protocol ) ) || ( !reader.read( count ) ) )
+        {
+            return false;
+        }
+        for ( uint32_t i = 0; i < count; i++ )
+        {
+            SignalID signalID = 0;
+            if ( !reader.read( signalID ) )
+            {
+                return false;
+            }
+            dictionary->signalIDsToCollect.insert( signalID );
+        }
+        if ( !reader.read( count ) )
+        {
+            return false;
+        }
+        for ( uint32_t i = 0; i < count; i++ )
+        {
+            SignalID signalID = 0;
+            SignalEmissionPolicy policy;
+            if ( ( !reader.read( signalID ) ) || ( !readEmissionPolicy( reader, policy ) ) )
+            {
+                return false;
+            }
+            dictionary->signalEmissionPolicies[signalID] = policy;
+        }
+        uint32_t channelCount = 0;
+        if ( !reader.read( channelCount ) )
+        {
+            return false;
+        }
+        for ( uint32_t c = 0; c < channelCount; c++ )
+        {
+            CANChannelNumericID channelID = 0;
+            std::string interfaceID;
+            uint32_t frameCount = 0;
+            if ( ( !reader.read( channelID ) ) || ( !reader.readString( interfaceID ) ) ||
+                 ( !reader.read( frameCount ) ) )
+            {
+                return false;
+            }
+            if ( static_cast<VehicleDataSourceProtocol>( protocol ) == VehicleDataSourceProtocol::RAW_SOCKET )
+            {
+                channelID = canIDTranslator.getChannelNumericID( interfaceID );
+                if ( channelID == INVALID_CAN_SOURCE_NUMERIC_ID )
+                {
+                    return false;
+                }
+            }
+            auto &frames = dictionary->canMessageDecoderMethod[channelID];
+            for ( uint32_t f = 0; f < frameCount; f++ )
+            {
+                CANRawFrameID frameID = 0;
+                uint8_t collectType = 0;
+                CANMessageDecoderMethod decoderMethod;
+                if ( ( !reader.read( frameID ) ) || ( !reader.read( collectType ) ) ||
+                     ( collectType > static_cast<uint8_t>( CANMessageCollectType::RAW_AND_DECODE ) ) ||
+                     ( !readMessageFormat( reader, decoderMethod.format ) ) )
+                {
+                    return false;
+                }
+                decoderMethod.collectType = static_cast<CANMessageCollectType>( collectType );
+                frames[frameID] = std::move( decoderMethod );
+            }
+        }
+        if ( static_cast<VehicleDataSourceProtocol>( protocol ) == VehicleDataSourceProtocol::RAW_SOCKET )
+        {
+            for ( auto &channel : dictionary->canMessageDecoderMethod )
+            {
+                for ( auto &frame : channel.second )
+                {
+                    frame.second.decodePlan =
+                        CANDecoder::compileDecodePlan( frame.second.format, dictionary->signalIDsToCollect );
+                }
+            }
+        }
+        decoderDictionaries[static_cast<VehicleDataSourceProtocol>( protocol )] = dictionary;
+    }
+    return reader.isAtEnd();
+}
+
+} // namespace DataManagement
+} // namespace IoTFleetWise
+} // namespace Aws
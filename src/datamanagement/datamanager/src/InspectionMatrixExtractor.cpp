@@ -14,8 +14,14 @@
 // Includes
 #include "CollectionSchemeManager.h"
 #include "TraceModule.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
 #include <stack>
 #include <string>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 
 namespace Aws
@@ -33,6 +39,8 @@ CollectionSchemeManager::addConditionData( const ICollectionSchemePtr &collectio
     conditionData.includeActiveDtcs = collectionScheme->isActiveDTCsIncluded();
     conditionData.triggerOnlyOnRisingEdge = collectionScheme->isTriggerOnlyOnRisingEdge();
     conditionData.probabilityToSend = collectionScheme->getProbabilityToSend();
+    conditionData.evaluationIntervalMs = collectionScheme->getConditionEvaluationIntervalMs();
+    conditionData.evaluationBudgetUs = collectionScheme->getConditionEvaluationBudgetUs();
 
     /*
      * use for loop to copy signalInfo and CANframe over to avoid error or memory issue
@@ -40,16 +48,32 @@ CollectionSchemeManager::addConditionData( const ICollectionSchemePtr &collectio
      * since the object is not big, so not really slow
      */
     const std::vector<SignalCollectionInfo> &collectionSignals = collectionScheme->getCollectSignals();
+    std::shared_ptr<SignalUploadResolutions> uploadResolutions;
     for ( uint32_t i = 0; i < collectionSignals.size(); i++ )
     {
+        if ( collectionSignals[i].uploadResolution > 0.0 )
+        {
+            if ( uploadResolutions == nullptr )
+            {
+                uploadResolutions = std::make_shared<SignalUploadResolutions>();
+            }
+            uploadResolutions->emplace( collectionSignals[i].signalID, collectionSignals[i].uploadResolution );
+        }
         InspectionMatrixSignalCollectionInfo inspectionSignal = {};
         inspectionSignal.signalID = collectionSignals[i].signalID;
         inspectionSignal.sampleBufferSize = collectionSignals[i].sampleBufferSize;
         inspectionSignal.minimumSampleIntervalMs = collectionSignals[i].minimumSampleIntervalMs;
         inspectionSignal.fixedWindowPeriod = collectionSignals[i].fixedWindowPeriod;
         inspectionSignal.isConditionOnlySignal = collectionSignals[i].isConditionOnlySignal;
+        inspectionSignal.deepHistory = collectionSignals[i].deepHistory;
+        inspectionSignal.aggregation = collectionSignals[i].aggregation;
+        inspectionSignal.decimation = collectionSignals[i].decimation;
+        inspectionSignal.signalIndex = ( mDecoderManifest != nullptr )
+                                           ? mDecoderManifest->getSignalIndex( inspectionSignal.signalID )
+                                           : INVALID_MANIFEST_SIGNAL_INDEX;
         conditionData.signals.emplace_back( inspectionSignal );
     }
+    conditionData.metaData.uploadResolutions = std::move( uploadResolutions );
 
     const std::vector<CanFrameCollectionInfo> &collectionCANFrames = collectionScheme->getCollectRawCanFrames();
     for ( uint32_t i = 0; i < collectionCANFrames.size(); i++ )
@@ -59,6 +83,7 @@ CollectionSchemeManager::addConditionData( const ICollectionSchemePtr &collectio
         CANFrame.channelID = mCANIDTranslator.getChannelNumericID( collectionCANFrames[i].interfaceID );
         CANFrame.sampleBufferSize = collectionCANFrames[i].sampleBufferSize;
         CANFrame.minimumSampleIntervalMs = collectionCANFrames[i].minimumSampleIntervalMs;
+        CANFrame.isConditionOnlyFrame = collectionCANFrames[i].isConditionOnlyFrame;
         if ( CANFrame.channelID == INVALID_CAN_SOURCE_NUMERIC_ID )
         {
             mLogger.warn( "CollectionSchemeManager::addConditionData",
@@ -89,104 +114,318 @@ CollectionSchemeManager::addConditionData( const ICollectionSchemePtr &collectio
             break;
         }
         imageSettings.imageFormat = imageInfo.imageFormat;
+        imageSettings.captureOptions = imageInfo.captureOptions;
         conditionData.imageCollectionInfos.emplace_back( imageSettings );
     }
     conditionData.includeImageCapture = !conditionData.imageCollectionInfos.empty();
     // The rest
     conditionData.metaData.compress = collectionScheme->isCompressionNeeded();
+    conditionData.metaData.compressionCodec = collectionScheme->getCompressionCodec();
+    if ( ( conditionData.metaData.compressionCodec == CompressionCodecType::ZSTD ) && ( mDecoderManifest != nullptr ) )
+    {
+        conditionData.metaData.compressionDictionary = mDecoderManifest->getCompressionDictionary();
+    }
+    if ( ( conditionData.metaData.compressionCodec == CompressionCodecType::ZSTD ) &&
+         ( conditionData.metaData.compressionDictionary == nullptr ) && ( mDecoderDictionarySnapshot != nullptr ) )
+    {
+        // The build of the decoder manifest is deferred on boot, the snapshot holds its dictionary
+        conditionData.metaData.compressionDictionary = mDecoderDictionarySnapshot->compressionDictionary;
+    }
+    conditionData.metaData.rawCanLog = collectionScheme->isRawCanLogNeeded();
     conditionData.metaData.persist = collectionScheme->isPersistNeeded();
     conditionData.metaData.priority = collectionScheme->getPriority();
+    conditionData.metaData.express = mExpressLaneEnabled && ( collectionScheme->getPriority() <= mExpressMaxPriority );
     conditionData.metaData.decoderID = collectionScheme->getDecoderManifestID();
     conditionData.metaData.collectionSchemeID = collectionScheme->getCollectionSchemeID();
 }
 
+bool
+CollectionSchemeManager::foldConstantNode( ExpressionNode &node,
+                                           const ExpressionNode *left,
+                                           const ExpressionNode *right )
+{
+    auto isFloat = []( const ExpressionNode *operand ) {
+        return ( operand != nullptr ) && ( operand->nodeType == ExpressionNodeType::FLOAT ) &&
+               ( operand->left == nullptr ) && ( operand->right == nullptr );
+    };
+    auto isBoolean = []( const ExpressionNode *operand ) {
+        return ( operand != nullptr ) && ( operand->nodeType == ExpressionNodeType::BOOLEAN ) &&
+               ( operand->left == nullptr ) && ( operand->right == nullptr );
+    };
+    bool floatOperands = isFloat( left ) && isFloat( right );
+    bool booleanOperands = isBoolean( left ) && isBoolean( right );
+    bool constantOperands = floatOperands;
+    ExpressionNode result;
+    result.nodeType = ExpressionNodeType::BOOLEAN;
+    // OPERATOR_EQUAL is left to the inspection engine which defines the distance of equal values
+    switch ( node.nodeType )
+    {
+    case ExpressionNodeType::OPERATOR_SMALLER:
+        result.booleanValue = floatOperands && ( left->floatingValue < right->floatingValue );
+        break;
+    case ExpressionNodeType::OPERATOR_BIGGER:
+        result.booleanValue = floatOperands && ( left->floatingValue > right->floatingValue );
+        break;
+    case ExpressionNodeType::OPERATOR_SMALLER_EQUAL:
+        result.booleanValue = floatOperands && ( left->floatingValue <= right->floatingValue );
+        break;
+    case ExpressionNodeType::OPERATOR_BIGGER_EQUAL:
+        result.booleanValue = floatOperands && ( left->floatingValue >= right->floatingValue );
+        break;
+    case ExpressionNodeType::OPERATOR_LOGICAL_AND:
+        result.booleanValue = booleanOperands && left->booleanValue && right->booleanValue;
+        constantOperands = booleanOperands;
+        break;
+    case ExpressionNodeType::OPERATOR_LOGICAL_OR:
+        result.booleanValue = booleanOperands && ( left->booleanValue || right->booleanValue );
+        constantOperands = booleanOperands;
+        break;
+    case ExpressionNodeType::OPERATOR_LOGICAL_NOT:
+        // The logical not has only the left operand
+        constantOperands = isBoolean( left );
+        result.booleanValue = constantOperands && ( !left->booleanValue );
+        break;
+    case ExpressionNodeType::OPERATOR_ARITHMETIC_PLUS:
+        result.nodeType = ExpressionNodeType::FLOAT;
+        result.floatingValue = floatOperands ? ( left->floatingValue + right->floatingValue ) : 0.0;
+        break;
+    case ExpressionNodeType::OPERATOR_ARITHMETIC_MINUS:
+        result.nodeType = ExpressionNodeType::FLOAT;
+        result.floatingValue = floatOperands ? ( left->floatingValue - right->floatingValue ) : 0.0;
+        break;
+    case ExpressionNodeType::OPERATOR_ARITHMETIC_MULTIPLY:
+        result.nodeType = ExpressionNodeType::FLOAT;
+        result.floatingValue = floatOperands ? ( left->floatingValue * right->floatingValue ) : 0.0;
+        break;
+    case ExpressionNodeType::OPERATOR_ARITHMETIC_DIVIDE:
+        result.nodeType = ExpressionNodeType::FLOAT;
+        result.floatingValue = floatOperands ? ( left->floatingValue / right->floatingValue ) : 0.0;
+        break;
+    default:
+        return false;
+    }
+    if ( !constantOperands )
+    {
+        // Not all operands are constant
+        return false;
+    }
+    node = result;
+    return true;
+}
+
 void
 CollectionSchemeManager::inspectionMatrixExtractor( const std::shared_ptr<InspectionMatrix> &inspectionMatrix )
 {
-    std::stack<const ExpressionNode *> nodeStack;
-    std::map<const ExpressionNode *, uint32_t> nodeToIndexMap;
-    std::vector<const ExpressionNode *> nodes;
-    uint32_t index = 0;
-    const ExpressionNode *currNode = nullptr;
+    // Key of a node that identifies identical sub expressions: node type, the bits of the floating value, the
+    // boolean value, signal ID, window function, index of the left and the right child. Geohash functions keep
+    // state across evaluations, so they get the address of the original node as additional key and are never shared.
+    // Geofence functions get the address of their fences, so that only copies of the same node are shared. Raw frame
+    // fields get the address of the original node too, as their bit field is not part of the key.
+    using NodeKey =
+        std::tuple<ExpressionNodeType, uint64_t, bool, SignalID, WindowFunction, uint32_t, uint32_t, const void *>;
+    static constexpr uint32_t NO_CHILD = std::numeric_limits<uint32_t>::max();
+    std::map<NodeKey, uint32_t> keyToIndexMap;
+    std::unordered_map<const ExpressionNode *, uint32_t> nodeToIndexMap;
+    std::vector<std::pair<uint32_t, uint32_t>> children;
+    std::stack<std::pair<const ExpressionNode *, bool>> nodeStack;
+    uint32_t foldedNodes = 0;
 
-    for ( auto it = mEnabledCollectionSchemeMap.begin(); it != mEnabledCollectionSchemeMap.end(); it++ )
+    /*
+     * The nodes are deduplicated directly into the storage of the matrix and compacted in place afterwards. The
+     * collectionSchemes of one list share an arena, so the arenas give an upper bound of the number of nodes.
+     */
+    auto &nodes = inspectionMatrix->expressionNodeStorage;
+    std::unordered_set<const ICollectionScheme::ExpressionNode_t *> arenas;
+    size_t maxNodes = 0;
+    for ( const auto &enabledCollectionScheme : mEnabledCollectionSchemeMap )
+    {
+        const auto &arena = enabledCollectionScheme.second->getAllExpressionNodes();
+        if ( arenas.insert( &arena ).second )
+        {
+            maxNodes += arena.size();
+        }
+    }
+    nodes.clear();
+    nodes.reserve( maxNodes );
+    children.reserve( maxNodes );
+    nodeToIndexMap.reserve( maxNodes );
+
+    // The conditions of the express collectionSchemes come first, so they are evaluated and collected first
+    std::vector<ICollectionSchemePtr> collectionSchemes;
+    collectionSchemes.reserve( mEnabledCollectionSchemeMap.size() );
+    for ( const auto &enabledCollectionScheme : mEnabledCollectionSchemeMap )
+    {
+        collectionSchemes.push_back( enabledCollectionScheme.second );
+    }
+    if ( mExpressLaneEnabled )
+    {
+        std::stable_partition( collectionSchemes.begin(),
+                               collectionSchemes.end(),
+                               [this]( const ICollectionSchemePtr &collectionScheme ) {
+                                   return collectionScheme->getPriority() <= mExpressMaxPriority;
+                               } );
+    }
+
+    for ( const auto &collectionScheme : collectionSchemes )
     {
-        ICollectionSchemePtr collectionScheme = it->second;
         ConditionWithCollectedData conditionData;
         addConditionData( collectionScheme, conditionData );
 
-        currNode = collectionScheme->getCondition();
-        /* save the old root of this tree */
-        conditionData.condition = currNode;
+        /* save the old root of this tree, it is replaced by the shared node at the end */
+        conditionData.condition = collectionScheme->getCondition();
         inspectionMatrix->conditions.emplace_back( conditionData );
 
         /*
-         * The following lines traverse each tree and pack the node addresses into a vector
-         * and build a map
-         * any order to traverse the tree is OK, here we use in-order.
+         * Traverse the tree post-order, so that the children of a node are already in the shared storage when the
+         * node is added. Identical sub expressions of all collectionSchemes are stored only once and sub expressions
+         * with only constant operands are folded to their result.
          */
-        while ( currNode != nullptr )
+        if ( conditionData.condition != nullptr )
         {
-            nodeStack.push( currNode );
-            currNode = currNode->left;
+            nodeStack.push( std::make_pair( conditionData.condition, false ) );
         }
         while ( !nodeStack.empty() )
         {
-            currNode = nodeStack.top();
-            nodeStack.pop();
-            nodeToIndexMap[currNode] = index;
-            nodes.emplace_back( currNode );
-            index++;
-            if ( currNode->right != nullptr )
+            auto currNode = nodeStack.top().first;
+            bool childrenDone = nodeStack.top().second;
+            if ( nodeToIndexMap.find( currNode ) != nodeToIndexMap.end() )
+            {
+                nodeStack.pop();
+                continue;
+            }
+            if ( !childrenDone )
             {
-                currNode = currNode->right;
-                while ( currNode != nullptr )
+                nodeStack.top().second = true;
+                if ( currNode->right != nullptr )
                 {
-                    nodeStack.push( currNode );
-                    currNode = currNode->left;
+                    nodeStack.push( std::make_pair( currNode->right, false ) );
                 }
+                if ( currNode->left != nullptr )
+                {
+                    nodeStack.push( std::make_pair( currNode->left, false ) );
+                }
+                continue;
+            }
+            nodeStack.pop();
+
+            ExpressionNode node = *currNode;
+            uint32_t leftIndex = ( currNode->left != nullptr ) ? nodeToIndexMap[currNode->left] : NO_CHILD;
+            uint32_t rightIndex = ( currNode->right != nullptr ) ? nodeToIndexMap[currNode->right] : NO_CHILD;
+            if ( foldConstantNode( node,
+                                   ( leftIndex != NO_CHILD ) ? &nodes[leftIndex] : nullptr,
+                                   ( rightIndex != NO_CHILD ) ? &nodes[rightIndex] : nullptr ) )
+            {
+                leftIndex = NO_CHILD;
+                rightIndex = NO_CHILD;
+                foldedNodes++;
+            }
+            uint64_t floatingBits = 0;
+            static_assert( sizeof( floatingBits ) == sizeof( node.floatingValue ), "Unexpected size of double" );
+            std::memcpy( &floatingBits, &node.floatingValue, sizeof( floatingBits ) );
+            const void *identity = nullptr;
+            if ( node.nodeType == ExpressionNodeType::GEOHASHFUNCTION )
+            {
+                identity = currNode;
+            }
+            else if ( node.nodeType == ExpressionNodeType::RAWFRAMEFIELD )
+            {
+                identity = currNode;
+                node.function.rawFrameField.channelID =
+                    mCANIDTranslator.getChannelNumericID( node.function.rawFrameField.interfaceID );
+            }
+            else if ( node.nodeType == ExpressionNodeType::GEOFENCEFUNCTION )
+            {
+                identity = node.function.geofenceFunction.geofences.get();
+            }
+            NodeKey key( node.nodeType,
+                         floatingBits,
+                         node.booleanValue,
+                         node.signalID,
+                         node.function.windowFunction,
+                         leftIndex,
+                         rightIndex,
+                         identity );
+            auto sharedNode = keyToIndexMap.find( key );
+            if ( sharedNode != keyToIndexMap.end() )
+            {
+                nodeToIndexMap[currNode] = sharedNode->second;
+                continue;
             }
+            auto index = static_cast<uint32_t>( nodes.size() );
+            keyToIndexMap[key] = index;
+            nodeToIndexMap[currNode] = index;
+            nodes.emplace_back( node );
+            children.emplace_back( leftIndex, rightIndex );
         }
     }
 
-    size_t count = nodes.size();
-    /* now we have the count of all nodes from all collectionSchemes, allocate a vector for the output */
-    inspectionMatrix->expressionNodeStorage.resize( count );
-    /* copy from the old tree node and update left and right children pointers */
-    for ( uint32_t i = 0; i < count; i++ )
+    /*
+     * The operands of folded nodes are only needed if they are shared with other expressions. Children are stored
+     * before their parents, so walking backwards from the roots finds all nodes still used.
+     */
+    std::vector<uint32_t> newIndices( nodes.size(), NO_CHILD );
+    for ( const auto &conditionData : inspectionMatrix->conditions )
     {
-        inspectionMatrix->expressionNodeStorage[i].nodeType = nodes[i]->nodeType;
-        inspectionMatrix->expressionNodeStorage[i].floatingValue = nodes[i]->floatingValue;
-        inspectionMatrix->expressionNodeStorage[i].booleanValue = nodes[i]->booleanValue;
-        inspectionMatrix->expressionNodeStorage[i].signalID = nodes[i]->signalID;
-        inspectionMatrix->expressionNodeStorage[i].function = nodes[i]->function;
-
-        if ( nodes[i]->left != nullptr )
+        if ( conditionData.condition != nullptr )
         {
-            uint32_t leftIndex = nodeToIndexMap[nodes[i]->left];
-            inspectionMatrix->expressionNodeStorage[i].left = &inspectionMatrix->expressionNodeStorage[leftIndex];
+            newIndices[nodeToIndexMap[conditionData.condition]] = 0;
         }
-        else
+    }
+    for ( auto i = static_cast<uint32_t>( nodes.size() ); i > 0; i-- )
+    {
+        if ( newIndices[i - 1] == NO_CHILD )
         {
-            inspectionMatrix->expressionNodeStorage[i].left = nullptr;
+            continue;
         }
-
-        if ( nodes[i]->right != nullptr )
+        if ( children[i - 1].first != NO_CHILD )
         {
-            uint32_t rightIndex = nodeToIndexMap[nodes[i]->right];
-            inspectionMatrix->expressionNodeStorage[i].right = &inspectionMatrix->expressionNodeStorage[rightIndex];
+            newIndices[children[i - 1].first] = 0;
         }
-        else
+        if ( children[i - 1].second != NO_CHILD )
         {
-            inspectionMatrix->expressionNodeStorage[i].right = nullptr;
+            newIndices[children[i - 1].second] = 0;
         }
     }
+    uint32_t count = 0;
+    for ( auto &newIndex : newIndices )
+    {
+        if ( newIndex != NO_CHILD )
+        {
+            newIndex = count;
+            count++;
+        }
+    }
+    /*
+     * Move the used nodes to the front. A node never moves behind its old position, so the nodes are compacted in
+     * place. The vector only shrinks afterwards, so the addresses of the nodes are final and the left and right
+     * children pointers can be set.
+     */
+    for ( uint32_t i = 0; i < nodes.size(); i++ )
+    {
+        if ( ( newIndices[i] != NO_CHILD ) && ( newIndices[i] != i ) )
+        {
+            nodes[newIndices[i]] = std::move( nodes[i] );
+            children[newIndices[i]] = children[i];
+        }
+    }
+    nodes.resize( count );
+    for ( uint32_t i = 0; i < count; i++ )
+    {
+        nodes[i].left = ( children[i].first != NO_CHILD ) ? &nodes[newIndices[children[i].first]] : nullptr;
+        nodes[i].right = ( children[i].second != NO_CHILD ) ? &nodes[newIndices[children[i].second]] : nullptr;
+    }
     /* update the root of tree with new address */
     for ( uint32_t i = 0; i < inspectionMatrix->conditions.size(); i++ )
     {
-        uint32_t newIndex = nodeToIndexMap[inspectionMatrix->conditions[i].condition];
-        inspectionMatrix->conditions[i].condition = &inspectionMatrix->expressionNodeStorage[newIndex];
+        if ( inspectionMatrix->conditions[i].condition != nullptr )
+        {
+            uint32_t newIndex = newIndices[nodeToIndexMap[inspectionMatrix->conditions[i].condition]];
+            inspectionMatrix->conditions[i].condition = &nodes[newIndex];
+        }
     }
+    mLogger.trace( "CollectionSchemeManager::inspectionMatrixExtractor",
+                   std::to_string( nodeToIndexMap.size() ) + " expression nodes stored as " + std::to_string( count ) +
+                       " shared nodes, " + std::to_string( foldedNodes ) + " constant sub expressions folded" );
 }
 
 void
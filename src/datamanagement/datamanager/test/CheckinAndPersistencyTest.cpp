@@ -45,18 +45,17 @@ TEST( CollectionSchemeManagerTest2, checkInScheduleLogicTest )
     std::shared_ptr<const Clock> testClock = ClockHandler::getClock();
     TimePointInMsec currTime = testClock->timeSinceEpochMs();
     // create mTimeLine
-    std::priority_queue<TimeData, std::vector<TimeData>, std::greater<TimeData>> testTimeLine;
-    TimeData dataPair = std::make_pair( currTime, "Checkin" );
-    testTimeLine.push( dataPair );
+    CollectionSchemeTimeLine testTimeLine;
+    testTimeLine.schedule( "Checkin", currTime );
     // test code
     CANInterfaceIDTranslator canIDTranslator;
     gmocktest.init( 200, nullptr, canIDTranslator );
     gmocktest.setTimeLine( testTimeLine );
     gmocktest.checkTimeLine( currTime );
-    // We should have popped one item from the TimeLine, but also scheduled another one for the next cycle.
-    TimeData topPair = gmocktest.getTimeLine().top();
-    ASSERT_EQ( topPair.first, currTime + 200 );
-    ASSERT_EQ( topPair.second, "Checkin" );
+    // The checkin should have been moved to the next cycle.
+    ASSERT_EQ( gmocktest.getTimeLine().size(), 1 );
+    ASSERT_EQ( gmocktest.getTimeLine().topTime(), currTime + 200 );
+    ASSERT_EQ( gmocktest.getTimeLine().topID(), "Checkin" );
 }
 
 /** @brief
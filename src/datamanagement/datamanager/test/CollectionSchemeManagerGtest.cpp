@@ -449,31 +449,35 @@ TEST( CollectionSchemeManagerGtest, checkTimeLineTest_CHECKIN_UNFOUNDCOLLECTIONS
     // setup maps
     NiceMock<mockCollectionSchemeManagerTest> gmocktest( strDecoderManifestID1, mapEmpty, mapIdle );
     EXPECT_CALL( *collectionScheme2, getStartTime() ).WillOnce( Return( currTime + 20 ) );
+    EXPECT_CALL( *collectionScheme2, getExpiryTime() ).WillOnce( Return( currTime + 300 ) );
 
     // create mTimeLine
-    std::priority_queue<TimeData, std::vector<TimeData>, std::greater<TimeData>> testTimeLine;
-    TimeData dataPair = std::make_pair( currTime, "Checkin" );
-    testTimeLine.push( dataPair );
-    dataPair = std::make_pair( currTime, strCollectionSchemeIDCollectionScheme1 );
-    testTimeLine.push( dataPair );
-    dataPair = std::make_pair( currTime, strCollectionSchemeIDCollectionScheme2 );
-    testTimeLine.push( dataPair );
+    CollectionSchemeTimeLine testTimeLine;
+    testTimeLine.schedule( "Checkin", currTime );
+    testTimeLine.schedule( strCollectionSchemeIDCollectionScheme1, currTime );
+    testTimeLine.schedule( strCollectionSchemeIDCollectionScheme2, currTime + 20 );
 
     // test code
     CANInterfaceIDTranslator canIDTranslator;
     gmocktest.init( 200, nullptr, canIDTranslator );
     gmocktest.setTimeLine( testTimeLine );
     gmocktest.sendCheckin();
-    // first case collectionScheme1 not found
+    // first case collectionScheme1 not found, its time point is dropped and the checkin is rescheduled
     ASSERT_FALSE( gmocktest.checkTimeLine( currTime ) );
-    // second case collectionScheme2 does not have time matched
-    ASSERT_FALSE( gmocktest.checkTimeLine( currTime + 200 ) );
-    // branch out startTime > currTime
-    ASSERT_FALSE( gmocktest.checkTimeLine( currTime + 200 ) );
+    ASSERT_FALSE( gmocktest.getTimeLine().isScheduled( strCollectionSchemeIDCollectionScheme1 ) );
+    ASSERT_EQ( gmocktest.getTimeLine().size(), 2 );
+    // second case startTime of collectionScheme2 > currTime
+    ASSERT_FALSE( gmocktest.checkTimeLine( currTime + 10 ) );
+    // collectionScheme2 is enabled and its stop time replaces its start time
+    ASSERT_TRUE( gmocktest.checkTimeLine( currTime + 20 ) );
+    TimePointInMsec timePoint = 0;
+    ASSERT_TRUE( gmocktest.getTimeLine().getTimePoint( strCollectionSchemeIDCollectionScheme2, timePoint ) );
+    ASSERT_EQ( timePoint, currTime + 300 );
+    ASSERT_EQ( gmocktest.getTimeLine().size(), 2 );
 }
 
 /** @brief
- * This test validates the checkin interval when no active collection schemes are in the system
+ * This test validates the state transition from idle to active and from active to expired of Collection Schemes.
  */
 TEST( CollectionSchemeManagerGtest, checkTimeLineTest_IDLE_BRANCHES )
 {
@@ -495,26 +499,24 @@ TEST( CollectionSchemeManagerGtest, checkTimeLineTest_IDLE_BRANCHES )
 
     // setup maps
     NiceMock<mockCollectionSchemeManagerTest> gmocktest( strDecoderManifestID1, mapEmpty, mapIdle );
+    // Each collectionScheme is enabled once and disabled once
     EXPECT_CALL( *collectionScheme1, getStartTime() ).WillOnce( Return( currTime ) ).WillOnce( Return( currTime ) );
-    EXPECT_CALL( *collectionScheme1, getExpiryTime() ).WillOnce( Return( currTime + 100 ) );
+    EXPECT_CALL( *collectionScheme1, getExpiryTime() )
+        .WillOnce( Return( currTime + 100 ) )
+        .WillOnce( Return( currTime + 100 ) );
 
     EXPECT_CALL( *collectionScheme2, getStartTime() )
-        .WillOnce( Return( currTime + 20 ) )
-        .WillOnce( Return( currTime + 20 ) )
         .WillOnce( Return( currTime + 20 ) )
         .WillOnce( Return( currTime + 20 ) );
-    EXPECT_CALL( *collectionScheme2, getExpiryTime() ).WillOnce( Return( currTime + 200 ) );
+    EXPECT_CALL( *collectionScheme2, getExpiryTime() )
+        .WillOnce( Return( currTime + 200 ) )
+        .WillOnce( Return( currTime + 200 ) );
 
     // create mTimeLine
-    std::priority_queue<TimeData, std::vector<TimeData>, std::greater<TimeData>> testTimeLine;
-    TimeData dataPair = std::make_pair( currTime, "Checkin" );
-    testTimeLine.push( dataPair );
-    dataPair = std::make_pair( currTime, strCollectionSchemeIDCollectionScheme1 );
-    testTimeLine.push( dataPair );
-    dataPair = std::make_pair( currTime + 10, strCollectionSchemeIDCollectionScheme2 );
-    testTimeLine.push( dataPair );
-    dataPair = std::make_pair( currTime + 20, strCollectionSchemeIDCollectionScheme2 );
-    testTimeLine.push( dataPair );
+    CollectionSchemeTimeLine testTimeLine;
+    testTimeLine.schedule( "Checkin", currTime );
+    testTimeLine.schedule( strCollectionSchemeIDCollectionScheme1, currTime );
+    testTimeLine.schedule( strCollectionSchemeIDCollectionScheme2, currTime + 20 );
 
     // test code
     CANInterfaceIDTranslator canIDTranslator;
@@ -524,11 +526,16 @@ TEST( CollectionSchemeManagerGtest, checkTimeLineTest_IDLE_BRANCHES )
     ASSERT_TRUE( gmocktest.checkTimeLine( currTime ) );
     ASSERT_TRUE( gmocktest.checkTimeLine( currTime + 20 ) );
     // branch out startTime > currTime
-    ASSERT_FALSE( gmocktest.checkTimeLine( currTime + 400 ) );
+    ASSERT_FALSE( gmocktest.checkTimeLine( currTime + 50 ) );
+    ASSERT_EQ( gmocktest.getTimeLine().size(), 3 );
+    // both collectionSchemes expire, only the checkin is left
+    ASSERT_TRUE( gmocktest.checkTimeLine( currTime + 400 ) );
+    ASSERT_EQ( gmocktest.getTimeLine().size(), 1 );
+    ASSERT_EQ( gmocktest.getTimeLine().topID(), "Checkin" );
 }
 
 /** @brief
- * This test validates the state transition from non active to active of a Collection Scheme.
+ * This test validates the state transition from active to expired of Collection Schemes.
  */
 TEST( CollectionSchemeManagerGtest, checkTimeLineTest_ENABLED_BRANCHES )
 {
@@ -550,26 +557,17 @@ TEST( CollectionSchemeManagerGtest, checkTimeLineTest_ENABLED_BRANCHES )
 
     // setup maps
     NiceMock<mockCollectionSchemeManagerTest> gmocktest( strDecoderManifestID1, mapEnable, mapEmpty );
-    EXPECT_CALL( *collectionScheme1, getExpiryTime() ).WillOnce( Return( currTime ) ).WillOnce( Return( currTime ) );
+    EXPECT_CALL( *collectionScheme1, getExpiryTime() ).WillOnce( Return( currTime ) );
     EXPECT_CALL( *collectionScheme1, getStartTime() ).WillOnce( Return( currTime - 100 ) );
 
-    EXPECT_CALL( *collectionScheme2, getExpiryTime() )
-        .WillOnce( Return( currTime + 20 ) )
-        .WillOnce( Return( currTime + 20 ) )
-        .WillOnce( Return( currTime + 20 ) )
-        .WillOnce( Return( currTime + 20 ) );
+    EXPECT_CALL( *collectionScheme2, getExpiryTime() ).WillOnce( Return( currTime + 20 ) );
     EXPECT_CALL( *collectionScheme2, getStartTime() ).WillOnce( Return( currTime - 200 ) );
 
     // create mTimeLine
-    std::priority_queue<TimeData, std::vector<TimeData>, std::greater<TimeData>> testTimeLine;
-    TimeData dataPair = std::make_pair( currTime, "Checkin" );
-    testTimeLine.push( dataPair );
-    dataPair = std::make_pair( currTime, strCollectionSchemeIDCollectionScheme1 );
-    testTimeLine.push( dataPair );
-    dataPair = std::make_pair( currTime + 10, strCollectionSchemeIDCollectionScheme2 );
-    testTimeLine.push( dataPair );
-    dataPair = std::make_pair( currTime + 20, strCollectionSchemeIDCollectionScheme2 );
-    testTimeLine.push( dataPair );
+    CollectionSchemeTimeLine testTimeLine;
+    testTimeLine.schedule( "Checkin", currTime );
+    testTimeLine.schedule( strCollectionSchemeIDCollectionScheme1, currTime );
+    testTimeLine.schedule( strCollectionSchemeIDCollectionScheme2, currTime + 20 );
 
     // test code
     CANInterfaceIDTranslator canIDTranslator;
@@ -577,7 +575,45 @@ TEST( CollectionSchemeManagerGtest, checkTimeLineTest_ENABLED_BRANCHES )
     gmocktest.setTimeLine( testTimeLine );
     gmocktest.sendCheckin();
     ASSERT_TRUE( gmocktest.checkTimeLine( currTime ) );
+    // branch out stopTime > currTime
+    ASSERT_FALSE( gmocktest.checkTimeLine( currTime + 10 ) );
     ASSERT_TRUE( gmocktest.checkTimeLine( currTime + 20 ) );
-    // branch out startTime > currTime
     ASSERT_FALSE( gmocktest.checkTimeLine( currTime + 400 ) );
+    ASSERT_EQ( gmocktest.getTimeLine().size(), 1 );
+}
+
+/** @brief
+ * This test validates that a collection scheme failing its deferred build is dropped instead of enabled
+ */
+TEST( CollectionSchemeManagerGtest, checkTimeLineTest_DEFERRED_BUILD_FAILS )
+{
+    // prepare input
+    std::string strDecoderManifestID1 = "DM1";
+    std::string strCollectionSchemeIDCollectionScheme1 = "COLLECTIONSCHEME1";
+
+    std::shared_ptr<const Clock> testClock = ClockHandler::getClock();
+    TimePointInMsec currTime = testClock->timeSinceEpochMs();
+
+    std::shared_ptr<mockDeferredCollectionScheme> collectionScheme1 =
+        std::make_shared<mockDeferredCollectionScheme>();
+    std::map<std::string, ICollectionSchemePtr> mapEmpty;
+    std::map<std::string, ICollectionSchemePtr> mapIdle = {
+        { strCollectionSchemeIDCollectionScheme1, collectionScheme1 } };
+
+    // setup maps
+    NiceMock<mockCollectionSchemeManagerTest> gmocktest( strDecoderManifestID1, mapEmpty, mapIdle );
+    EXPECT_CALL( *collectionScheme1, buildIfDeferred() ).WillOnce( Return( false ) );
+    // Neither the ID is read nor the stop time scheduled, as it is for an enabled collectionScheme
+    EXPECT_CALL( *collectionScheme1, getCollectionSchemeID() ).Times( 0 );
+    EXPECT_CALL( *collectionScheme1, getExpiryTime() ).Times( 0 );
+
+    // create mTimeLine
+    CollectionSchemeTimeLine testTimeLine;
+    testTimeLine.schedule( strCollectionSchemeIDCollectionScheme1, currTime );
+
+    // test code
+    gmocktest.setTimeLine( testTimeLine );
+    ASSERT_FALSE( gmocktest.checkTimeLine( currTime ) );
+    ASSERT_FALSE( gmocktest.getTimeLine().isScheduled( strCollectionSchemeIDCollectionScheme1 ) );
+    ASSERT_FALSE( gmocktest.checkTimeLine( currTime + 10 ) );
 }
@@ -0,0 +1,108 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "CollectionSchemeTimeLine.h"
+#include <gtest/gtest.h>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+
+using namespace Aws::IoTFleetWise::DataManagement;
+
+/** @brief
+ * This test validates that every ID has a single time point that can be moved and cancelled
+ */
+TEST( CollectionSchemeTimeLineTest, ScheduleMoveAndCancel )
+{
+    CollectionSchemeTimeLine timeLine;
+    ASSERT_TRUE( timeLine.empty() );
+    timeLine.schedule( "Checkin", 100 );
+    timeLine.schedule( "CS1", 50 );
+    timeLine.schedule( "CS2", 200 );
+    ASSERT_EQ( timeLine.size(), 3 );
+    ASSERT_EQ( timeLine.topID(), "CS1" );
+    ASSERT_EQ( timeLine.topTime(), 50 );
+
+    // Moving a time point does not add an entry
+    timeLine.schedule( "CS1", 300 );
+    ASSERT_EQ( timeLine.size(), 3 );
+    ASSERT_EQ( timeLine.topID(), "Checkin" );
+    timeLine.schedule( "CS2", 10 );
+    ASSERT_EQ( timeLine.topID(), "CS2" );
+    TimePointInMsec timePoint = 0;
+    ASSERT_TRUE( timeLine.getTimePoint( "CS1", timePoint ) );
+    ASSERT_EQ( timePoint, 300 );
+
+    timeLine.cancel( "CS2" );
+    timeLine.cancel( "CS3" );
+    ASSERT_EQ( timeLine.size(), 2 );
+    ASSERT_FALSE( timeLine.isScheduled( "CS2" ) );
+    ASSERT_FALSE( timeLine.getTimePoint( "CS2", timePoint ) );
+    ASSERT_EQ( timeLine.topID(), "Checkin" );
+
+    timeLine.pop();
+    ASSERT_EQ( timeLine.topID(), "CS1" );
+    timeLine.pop();
+    ASSERT_TRUE( timeLine.empty() );
+
+    // IDs can be scheduled again after they were removed
+    timeLine.schedule( "CS2", 20 );
+    ASSERT_EQ( timeLine.topID(), "CS2" );
+    timeLine.clear();
+    ASSERT_TRUE( timeLine.empty() );
+    ASSERT_FALSE( timeLine.isScheduled( "CS2" ) );
+}
+
+/** @brief
+ * This test validates the order of the time points after random schedules and cancellations
+ */
+TEST( CollectionSchemeTimeLineTest, RandomOperationsKeepOrder )
+{
+    CollectionSchemeTimeLine timeLine;
+    std::map<std::string, TimePointInMsec> expected;
+    std::mt19937 generator( 1234 );
+    std::uniform_int_distribution<uint32_t> idDistribution( 0, 199 );
+    std::uniform_int_distribution<uint32_t> timeDistribution( 0, 10000 );
+    for ( int i = 0; i < 5000; i++ )
+    {
+        std::string id = "CS" + std::to_string( idDistribution( generator ) );
+        if ( ( i % 3 ) == 0 )
+        {
+            timeLine.cancel( id );
+            expected.erase( id );
+        }
+        else
+        {
+            TimePointInMsec timePoint = timeDistribution( generator );
+            timeLine.schedule( id, timePoint );
+            expected[id] = timePoint;
+        }
+        ASSERT_EQ( timeLine.size(), expected.size() );
+    }
+    std::set<std::pair<TimePointInMsec, std::string>> expectedOrder;
+    for ( const auto &entry : expected )
+    {
+        expectedOrder.emplace( entry.second, entry.first );
+    }
+    TimePointInMsec previousTime = 0;
+    while ( !timeLine.empty() )
+    {
+        ASSERT_GE( timeLine.topTime(), previousTime );
+        ASSERT_EQ( expected[timeLine.topID()], timeLine.topTime() );
+        previousTime = timeLine.topTime();
+        expectedOrder.erase( std::make_pair( timeLine.topTime(), timeLine.topID() ) );
+        timeLine.pop();
+    }
+    ASSERT_TRUE( expectedOrder.empty() );
+}
@@ -11,6 +11,7 @@
  * permissions and limitations under the License.
  */
 
+#include "CANDecoder.h"
 #include "CollectionSchemeManagerTest.h"
 
 /** @brief
@@ -126,6 +127,10 @@ TEST( CollectionSchemeManagerTest, DecoderDictionaryExtractorTest )
 
         CANSignalFormat sigFormat;
         sigFormat.mSignalID = i;
+        if ( i == 3 )
+        {
+            sigFormat.mEmissionPolicy.mType = SignalEmissionPolicyType::ON_CHANGE;
+        }
         signals0.emplace_back( sigFormat );
     }
     canMessageFormat0x100.mMessageID = 0x100;
@@ -138,6 +143,7 @@ TEST( CollectionSchemeManagerTest, DecoderDictionaryExtractorTest )
     // Signal 8 will be part of CAN Frame 0x110 at Node 10
     SignalCollectionInfo signal8;
     signal8.signalID = 8;
+    signal8.minimumSampleIntervalMs = 500;
     signalInfo1.emplace_back( signal8 );
     // CAN Frame 0x110 will only be decoded, its raw frame will not be collected
     signalToFrameAndNodeID[signal8.signalID] = { 0x110, "10" };
@@ -168,6 +174,9 @@ TEST( CollectionSchemeManagerTest, DecoderDictionaryExtractorTest )
         signalInfo2.emplace_back( signal );
         signalToFrameAndNodeID[signal.signalID] = { 0x200, "20" };
     }
+    // CollectionScheme2 needs signal 8 more often than CollectionScheme1
+    signal8.minimumSampleIntervalMs = 200;
+    signalInfo2.emplace_back( signal8 );
 
     // This vector defines a list of raw CAN Frame CollectionScheme2 wants to collect
     ICollectionScheme::RawCanFrames_t canFrameInfo2 = ICollectionScheme::RawCanFrames_t();
@@ -297,7 +306,20 @@ TEST( CollectionSchemeManagerTest, DecoderDictionaryExtractorTest )
         {
             ASSERT_EQ( signalID, decoderMethod.format.mSignals[signalID].mSignalID );
         }
+        // The decode plan shall be precompiled with one step per signal
+        ASSERT_TRUE( decoderMethod.decodePlan.isValid() );
+        ASSERT_EQ( decoderMethod.decodePlan.mSteps.size(), decoderMethod.format.mSignals.size() );
     }
+    // Only the signal with an emission policy dropping values is listed
+    ASSERT_EQ( decoderDictionary->signalEmissionPolicies.size(), 1 );
+    ASSERT_EQ( decoderDictionary->signalEmissionPolicies[3].mType, SignalEmissionPolicyType::ON_CHANGE );
+    // The signals take the priority of the collection schemes, which have no conditions
+    ASSERT_EQ( decoderDictionary->signalPriorities.size(), decoderDictionary->signalIDsToCollect.size() );
+    ASSERT_EQ( decoderDictionary->signalPriorities[0], collectionScheme1->getPriority() );
+    ASSERT_TRUE( decoderDictionary->conditionSignalIDs.empty() );
+    // Only signal 8 is rate limited, with the smallest interval of both collection schemes
+    ASSERT_EQ( decoderDictionary->signalMinimumSampleIntervalsMs.size(), 1 );
+    ASSERT_EQ( decoderDictionary->signalMinimumSampleIntervalsMs[8], 200 );
     // Although 0x101 exit in Decoder Manifest but no CollectionScheme is interested in 0x101, hence decoder dictionary
     // will not include 0x101
     ASSERT_EQ( decoderDictionary->canMessageDecoderMethod[firstChannelId].count( 0x101 ), 0 );
@@ -328,9 +350,9 @@ TEST( CollectionSchemeManagerTest, DecoderDictionaryExtractorTest )
     // CAN Frame 0x300 at Node 20 shall not exist in dictionary as CollectionScheme3 is not enabled yet
     ASSERT_EQ( decoderDictionary->canMessageDecoderMethod[secondChannelId].count( 0x300 ), 0 );
     // check the signalIDsToCollect from CAN decoder dictionary shall contain all the targeted CAN signals from
-    // collectionSchemes Note minus 5 because 4 signals are OBD signals which will be included in OBD decoder dictionary
-    // and one invalid signal
-    ASSERT_EQ( decoderDictionary->signalIDsToCollect.size(), signalInfo1.size() + signalInfo2.size() - 5 );
+    // collectionSchemes Note minus 6 because 4 signals are OBD signals which will be included in OBD decoder dictionary,
+    // one invalid signal and signal 8 is collected by both collectionSchemes
+    ASSERT_EQ( decoderDictionary->signalIDsToCollect.size(), signalInfo1.size() + signalInfo2.size() - 6 );
     for ( auto const &signal : signalInfo1 )
     {
         ASSERT_EQ( decoderDictionary->signalIDsToCollect.count( signal.signalID ), 1 );
@@ -539,6 +561,96 @@ TEST( CollectionSchemeManagerTest, DecoderDictionaryExtractorNoSignalsTest )
     ASSERT_TRUE( decoderDictionaryMap.find( VehicleDataSourceProtocol::RAW_SOCKET ) != decoderDictionaryMap.end() );
 }
 
+/** @brief
+ * This test validates that UDS DID signals are extracted into the UDS decoder dictionary per ECU, and that periodic
+ * DIDs are also decoded from the raw CAN frames they are streamed on
+ */
+TEST( CollectionSchemeManagerTest, DecoderDictionaryExtractorUDSTest )
+{
+    CollectionSchemeManagerTest test( "DM1" );
+    CANInterfaceIDTranslator canIDTranslator;
+    canIDTranslator.add( "10" );
+    test.init( 0, nullptr, canIDTranslator );
+    TimePointInMsec currTime = ClockHandler::getClock()->timeSinceEpochMs();
+
+    DIDSignalDecoderFormat polledDID;
+    polledDID.mInterfaceID = "10";
+    polledDID.mRequestMessageID = 0x7E0;
+    polledDID.mDID = 0xF40D;
+    polledDID.mDidResponseLength = 2;
+    polledDID.mScaling = 1.0;
+    polledDID.mByteLength = 2;
+    polledDID.mBitMaskLength = 8;
+    DIDSignalDecoderFormat periodicDID = polledDID;
+    periodicDID.mDID = 0xF210;
+    periodicDID.mPeriodicTransmissionMode = 3;
+    periodicDID.mPeriodicResponseMessageID = 0x5E8;
+    periodicDID.mStartByte = 1;
+    periodicDID.mByteLength = 1;
+    periodicDID.mBitRightShift = 4;
+    periodicDID.mBitMaskLength = 4;
+
+    ICollectionScheme::Signals_t signalInfo;
+    SignalCollectionInfo signal;
+    signal.signalID = 0x20000;
+    signalInfo.emplace_back( signal );
+    signal.signalID = 0x20001;
+    signalInfo.emplace_back( signal );
+    std::vector<ICollectionSchemePtr> list1;
+    list1.emplace_back( std::make_shared<ICollectionSchemeTest>( "COLLECTIONSCHEME1",
+                                                                 "DM1",
+                                                                 currTime,
+                                                                 currTime + SECOND_TO_MILLISECOND( 5 ),
+                                                                 signalInfo,
+                                                                 ICollectionScheme::RawCanFrames_t() ) );
+
+    std::unordered_map<CANInterfaceID, std::unordered_map<CANRawFrameID, CANMessageFormat>> formatMap;
+    auto DM1 = std::make_shared<IDecoderManifestTest>(
+        "DM1",
+        formatMap,
+        std::unordered_map<SignalID, std::pair<CANRawFrameID, CANInterfaceID>>(),
+        std::unordered_map<SignalID, PIDSignalDecoderFormat>() );
+    DM1->setDIDDecoderFormats( { { 0x20000, polledDID }, { 0x20001, periodicDID } } );
+    test.setDecoderManifest( DM1 );
+    test.setCollectionSchemeList( std::make_shared<ICollectionSchemeListTest>( list1 ) );
+    ASSERT_TRUE( test.updateMapsandTimeLine( currTime ) );
+    std::map<VehicleDataSourceProtocol, std::shared_ptr<CANDecoderDictionary>> decoderDictionaryMap;
+    test.decoderDictionaryExtractor( decoderDictionaryMap );
+
+    const auto &udsDictionary = decoderDictionaryMap.at( VehicleDataSourceProtocol::UDS );
+    ASSERT_EQ( udsDictionary->signalIDsToCollect.size(), 2 );
+    const auto &ecuDIDs = udsDictionary->canMessageDecoderMethod.at( 0x7E0 );
+    ASSERT_EQ( ecuDIDs.size(), 2 );
+    const auto &polledFormat = ecuDIDs.at( toUDSDictionaryKey( 0xF40D, 0 ) ).format;
+    ASSERT_EQ( polledFormat.mMessageID, 0xF40D );
+    ASSERT_EQ( polledFormat.mSizeInBytes, 2 );
+    ASSERT_EQ( polledFormat.mSignals[0].mFirstBitPosition, 0 );
+    ASSERT_EQ( polledFormat.mSignals[0].mSizeInBits, 16 );
+    ASSERT_NE( ecuDIDs.find( toUDSDictionaryKey( 0xF210, 3 ) ), ecuDIDs.end() );
+
+    // The periodic DID is multiplexed by its low byte in the frames of the periodic response CAN ID
+    const auto &canDictionary = decoderDictionaryMap.at( VehicleDataSourceProtocol::RAW_SOCKET );
+    ASSERT_EQ( canDictionary->signalIDsToCollect.count( 0x20001 ), 1 );
+    const auto &periodicFrame =
+        canDictionary->canMessageDecoderMethod.at( canIDTranslator.getChannelNumericID( "10" ) ).at( 0x5E8 );
+    ASSERT_TRUE( periodicFrame.format.isMultiplexed() );
+    ASSERT_EQ( periodicFrame.format.mSignals.size(), 2 );
+    ASSERT_TRUE( periodicFrame.format.mSignals[0].isMultiplexor() );
+    ASSERT_EQ( periodicFrame.format.mSignals[1].mMultiplexorValue, 0x10 );
+    ASSERT_EQ( periodicFrame.format.mSignals[1].mFirstBitPosition, 2 * 8 + 4 );
+    ASSERT_EQ( periodicFrame.format.mSignals[1].mSizeInBits, 4 );
+
+    // A frame with the DID 0xF210, signal in the high nibble of the second data byte
+    std::vector<uint8_t> frameData = { 0x10, 0x00, 0xA0, 0x00, 0x00, 0x00, 0x00, 0x00 };
+    CANDecoder decoder;
+    CANDecodedMessage decodedMessage;
+    ASSERT_TRUE(
+        decoder.decodeCANMessage( frameData.data(), frameData.size(), periodicFrame.decodePlan, decodedMessage ) );
+    ASSERT_EQ( decodedMessage.mFrameInfo.mSignals.size(), 1 );
+    ASSERT_EQ( decodedMessage.mFrameInfo.mSignals[0].mSignalID, 0x20001 );
+    ASSERT_DOUBLE_EQ( decodedMessage.mFrameInfo.mSignals[0].mPhysicalValue, 0x0A );
+}
+
 /** @brief
  * This test aims to test CollectionScheme Manager's Dececoder Dictionary Extractor functionality
  * when first a raw can frame is collected and then from the same frame a signal
@@ -636,3 +748,148 @@ TEST( CollectionSchemeManagerTest, DecoderDictionaryExtractorFirstRawFrameThenSi
     ASSERT_EQ( decoderMethod->second.find( 0x100 )->second.collectType, CANMessageCollectType::RAW_AND_DECODE );
     ASSERT_EQ( decoderMethod->second.find( 0x100 )->second.format.mSignals[0].mOffset, 17 );
 }
+
+/**  @brief
+ * This test validates the per channel diff of two decoder dictionaries
+ */
+TEST( CollectionSchemeManagerTest, DecoderDictionaryDiffTest )
+{
+    CANMessageFormat format1;
+    format1.mMessageID = 0x100;
+    CANSignalFormat signal1;
+    signal1.mSignalID = 1;
+    CANSignalFormat signal2;
+    signal2.mSignalID = 2;
+    format1.mSignals = { signal1, signal2 };
+    CANMessageFormat format2;
+    format2.mMessageID = 0x200;
+    CANSignalFormat signal3;
+    signal3.mSignalID = 3;
+    format2.mSignals = { signal3 };
+
+    CANDecoderDictionary previous;
+    previous.canMessageDecoderMethod[1][0x100] = { CANMessageCollectType::DECODE, format1, {} };
+    previous.canMessageDecoderMethod[2][0x200] = { CANMessageCollectType::DECODE, format2, {} };
+    previous.signalIDsToCollect = { 1, 3 };
+
+    // Identical rules result in an empty diff
+    ASSERT_TRUE( CollectionSchemeManagerTest::decoderDictionaryDiff( previous, previous ).empty() );
+
+    // Collect another signal of a frame on channel 1 and a new frame on channel 2
+    CANDecoderDictionary current = previous;
+    current.signalIDsToCollect = { 1, 2, 3 };
+    CANMessageFormat format3;
+    format3.mMessageID = 0x300;
+    CANSignalFormat signal4;
+    signal4.mSignalID = 4;
+    format3.mSignals = { signal4 };
+    current.canMessageDecoderMethod[2][0x300] = { CANMessageCollectType::RAW, format3, {} };
+    auto diff = CollectionSchemeManagerTest::decoderDictionaryDiff( previous, current );
+    ASSERT_EQ( diff.channels.size(), 2 );
+    ASSERT_EQ( diff.channels[1].changedFrameIDs, std::vector<CANRawFrameID>{ 0x100 } );
+    ASSERT_EQ( diff.channels[1].addedSignalIDs, std::vector<SignalID>{ 2 } );
+    ASSERT_FALSE( diff.channels[1].framesAddedOrRemoved() );
+    ASSERT_EQ( diff.channels[2].addedFrameIDs, std::vector<CANRawFrameID>{ 0x300 } );
+    ASSERT_TRUE( diff.channels[2].addedSignalIDs.empty() );
+    ASSERT_TRUE( diff.channels[2].framesAddedOrRemoved() );
+
+    // Remove channel 2
+    current = previous;
+    current.canMessageDecoderMethod.erase( 2 );
+    diff = CollectionSchemeManagerTest::decoderDictionaryDiff( previous, current );
+    ASSERT_EQ( diff.channels.size(), 1 );
+    ASSERT_EQ( diff.channels[2].removedFrameIDs, std::vector<CANRawFrameID>{ 0x200 } );
+    ASSERT_EQ( diff.channels[2].removedSignalIDs, std::vector<SignalID>{ 3 } );
+}
+
+/**  @brief
+ * This test validates that every channel gets a slice with only its rules, whose version only changes with them
+ */
+TEST( CollectionSchemeManagerTest, DecoderDictionaryChannelSlicesTest )
+{
+    CANMessageFormat format1;
+    format1.mMessageID = 0x100;
+    CANSignalFormat signal1;
+    signal1.mSignalID = 1;
+    format1.mSignals = { signal1 };
+    CANMessageFormat format2;
+    format2.mMessageID = 0x200;
+    CANSignalFormat signal2;
+    signal2.mSignalID = 2;
+    format2.mSignals = { signal2 };
+
+    CANDecoderDictionary previous;
+    previous.canMessageDecoderMethod[1][0x100] = { CANMessageCollectType::DECODE, format1, {} };
+    previous.canMessageDecoderMethod[2][0x200] = { CANMessageCollectType::DECODE, format2, {} };
+    previous.signalIDsToCollect = { 1, 2 };
+    previous.signalPriorities = { { 1, 0 }, { 2, 5 } };
+    previous.conditionSignalIDs = { 2 };
+    CollectionSchemeManagerTest::buildChannelSlices( previous );
+    ASSERT_EQ( previous.channelSlices.size(), 2 );
+    const auto &slice1 = *previous.channelSlices.at( 1 );
+    ASSERT_EQ( slice1.canMessageDecoderMethod.size(), 1 );
+    ASSERT_EQ( slice1.canMessageDecoderMethod.count( 1 ), 1 );
+    ASSERT_EQ( slice1.signalIDsToCollect, std::unordered_set<SignalID>{ 1 } );
+    ASSERT_EQ( slice1.signalPriorities.size(), 1 );
+    ASSERT_TRUE( slice1.conditionSignalIDs.empty() );
+    const auto &slice2 = *previous.channelSlices.at( 2 );
+    ASSERT_EQ( slice2.conditionSignalIDs, std::unordered_set<SignalID>{ 2 } );
+    ASSERT_NE( slice1.version, 0U );
+    ASSERT_NE( slice1.version, slice2.version );
+
+    // Equal rules built again give the same versions
+    CANDecoderDictionary current = previous;
+    CollectionSchemeManagerTest::buildChannelSlices( current );
+    ASSERT_EQ( current.channelSlices.at( 1 )->version, slice1.version );
+    ASSERT_TRUE( CollectionSchemeManagerTest::decoderDictionaryDiff( previous, current ).empty() );
+
+    // A changed minimum sample interval of a signal of channel 2 only changes the version of its slice
+    current.signalMinimumSampleIntervalsMs[2] = 100;
+    CollectionSchemeManagerTest::buildChannelSlices( current );
+    ASSERT_EQ( current.channelSlices.at( 1 )->version, slice1.version );
+    ASSERT_NE( current.channelSlices.at( 2 )->version, slice2.version );
+    auto diff = CollectionSchemeManagerTest::decoderDictionaryDiff( previous, current );
+    ASSERT_EQ( diff.channels.size(), 1 );
+    ASSERT_TRUE( diff.channels[2].versionChanged );
+    ASSERT_FALSE( diff.channels[2].framesAddedOrRemoved() );
+}
+
+/**  @brief
+ * This test validates that an active decoder dictionary is only notified again if it changed, and then as a diff
+ */
+TEST( CollectionSchemeManagerTest, DecoderDictionaryUpdaterDiffTest )
+{
+    auto testPtr = std::make_shared<CollectionSchemeManagerTest>();
+    CANInterfaceIDTranslator canIDTranslator;
+    testPtr->init( 0, nullptr, canIDTranslator );
+    auto binderMockPtr = std::make_shared<VehicleDataSourceBinderMock>();
+    testPtr->subscribeListener( binderMockPtr.get() );
+
+    CANMessageFormat format;
+    format.mMessageID = 0x100;
+    CANSignalFormat signal;
+    signal.mSignalID = 1;
+    format.mSignals = { signal };
+    auto dictionary = std::make_shared<CANDecoderDictionary>();
+    dictionary->canMessageDecoderMethod[1][0x100] = { CANMessageCollectType::DECODE, format, {} };
+    dictionary->signalIDsToCollect = { 1 };
+    std::map<VehicleDataSourceProtocol, std::shared_ptr<CANDecoderDictionary>> decoderDictionaryMap;
+    decoderDictionaryMap[VehicleDataSourceProtocol::RAW_SOCKET] = dictionary;
+    testPtr->decoderDictionaryUpdater( decoderDictionaryMap );
+    ASSERT_TRUE( binderMockPtr->getUpdateFlag() );
+
+    // An equal dictionary extracted again is not notified
+    binderMockPtr->setUpdateFlag( false );
+    decoderDictionaryMap[VehicleDataSourceProtocol::RAW_SOCKET] = std::make_shared<CANDecoderDictionary>( *dictionary );
+    testPtr->decoderDictionaryUpdater( decoderDictionaryMap );
+    ASSERT_FALSE( binderMockPtr->getUpdateFlag() );
+
+    // A changed dictionary is notified with the changed channels only
+    auto changedDictionary = std::make_shared<CANDecoderDictionary>( *dictionary );
+    changedDictionary->canMessageDecoderMethod[2][0x200] = { CANMessageCollectType::RAW, CANMessageFormat(), {} };
+    decoderDictionaryMap[VehicleDataSourceProtocol::RAW_SOCKET] = changedDictionary;
+    testPtr->decoderDictionaryUpdater( decoderDictionaryMap );
+    ASSERT_TRUE( binderMockPtr->getUpdateFlag() );
+    ASSERT_EQ( binderMockPtr->getLastDiff().channels.size(), 1 );
+    ASSERT_EQ( binderMockPtr->getLastDiff().channels.count( 2 ), 1 );
+}
@@ -0,0 +1,131 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "DecoderDictionarySnapshot.h"
+#include <cstring>
+#include <gtest/gtest.h>
+
+using namespace Aws::IoTFleetWise::DataManagement;
+
+namespace
+{
+DecoderDictionarySnapshot
+createSnapshot( CANInterfaceIDTranslator &canIDTranslator )
+{
+    DecoderDictionarySnapshot snapshot;
+    snapshot.decoderManifestID = "DM1";
+    snapshot.decoderManifestDigest = 0x12345678;
+    snapshot.collectionSchemeListDigest = 0x9ABCDEF0;
+    snapshot.enabledCollectionSchemeIDs = { "CS1", "CS2" };
+    snapshot.compressionDictionary = std::make_shared<const std::string>( "dictionary" );
+
+    CANSignalFormat signal;
+    signal.mSignalID = 1;
+    signal.mFirstBitPosition = 8;
+    signal.mSizeInBits = 16;
+    signal.mFactor = 0.5;
+    signal.mOffset = -10;
+    signal.mEmissionPolicy.mType = SignalEmissionPolicyType::ABSOLUTE_DEADBAND;
+    signal.mEmissionPolicy.mDeadband = 2.0;
+    CANMessageDecoderMethod decoderMethod;
+    decoderMethod.collectType = CANMessageCollectType::DECODE;
+    decoderMethod.format.mMessageID = 0x100;
+    decoderMethod.format.mSizeInBytes = 8;
+    decoderMethod.format.mSignals.push_back( signal );
+
+    auto dictionary = std::make_shared<CANDecoderDictionary>();
+    dictionary->canMessageDecoderMethod[canIDTranslator.getChannelNumericID( "vcan0" )][0x100] = decoderMethod;
+    dictionary->signalIDsToCollect.insert( 1 );
+    dictionary->signalEmissionPolicies[1] = signal.mEmissionPolicy;
+    snapshot.decoderDictionaries[VehicleDataSourceProtocol::RAW_SOCKET] = dictionary;
+    return snapshot;
+}
+} // namespace
+
+/** @brief
+ * This test validates that a serialized snapshot is loaded with the same content
+ */
+TEST( DecoderDictionarySnapshotTest, SerializeAndDeserialize )
+{
+    CANInterfaceIDTranslator canIDTranslator;
+    canIDTranslator.add( "vcan0" );
+    auto snapshot = createSnapshot( canIDTranslator );
+    std::vector<uint8_t> binary;
+    ASSERT_TRUE( snapshot.serialize( canIDTranslator, binary ) );
+
+    DecoderDictionarySnapshot loaded;
+    ASSERT_TRUE( loaded.deserialize( binary.data(), binary.size(), canIDTranslator ) );
+    ASSERT_EQ( loaded.decoderManifestID, "DM1" );
+    ASSERT_EQ( loaded.decoderManifestDigest, 0x12345678U );
+    ASSERT_EQ( loaded.collectionSchemeListDigest, 0x9ABCDEF0U );
+    ASSERT_EQ( loaded.enabledCollectionSchemeIDs, snapshot.enabledCollectionSchemeIDs );
+    ASSERT_NE( loaded.compressionDictionary, nullptr );
+    ASSERT_EQ( *loaded.compressionDictionary, "dictionary" );
+    ASSERT_EQ( loaded.decoderDictionaries.size(), 1 );
+    auto dictionary = loaded.decoderDictionaries[VehicleDataSourceProtocol::RAW_SOCKET];
+    ASSERT_NE( dictionary, nullptr );
+    ASSERT_EQ( dictionary->signalIDsToCollect, std::unordered_set<SignalID>{ 1 } );
+    ASSERT_EQ( dictionary->signalEmissionPolicies[1].mType, SignalEmissionPolicyType::ABSOLUTE_DEADBAND );
+    ASSERT_DOUBLE_EQ( dictionary->signalEmissionPolicies[1].mDeadband, 2.0 );
+    const auto &decoderMethod =
+        dictionary->canMessageDecoderMethod.at( canIDTranslator.getChannelNumericID( "vcan0" ) ).at( 0x100 );
+    ASSERT_EQ( decoderMethod.collectType, CANMessageCollectType::DECODE );
+    ASSERT_EQ( decoderMethod.format,
+               snapshot.decoderDictionaries[VehicleDataSourceProtocol::RAW_SOCKET]
+                   ->canMessageDecoderMethod.at( canIDTranslator.getChannelNumericID( "vcan0" ) )
+                   .at( 0x100 )
+                   .format );
+}
+
+/** @brief
+ * This test validates that corrupted snapshots and snapshots of another version are rejected
+ */
+TEST( DecoderDictionarySnapshotTest, RejectInvalidBinary )
+{
+    CANInterfaceIDTranslator canIDTranslator;
+    canIDTranslator.add( "vcan0" );
+    std::vector<uint8_t> binary;
+    ASSERT_TRUE( createSnapshot( canIDTranslator ).serialize( canIDTranslator, binary ) );
+    DecoderDictionarySnapshot loaded;
+
+    ASSERT_FALSE( loaded.deserialize( nullptr, 0, canIDTranslator ) );
+    ASSERT_FALSE( loaded.deserialize( binary.data(), 8, canIDTranslator ) );
+    ASSERT_FALSE( loaded.deserialize( binary.data(), binary.size() - 1, canIDTranslator ) );
+
+    auto corrupted = binary;
+    corrupted.back() ^= 0xFF;
+    ASSERT_FALSE( loaded.deserialize( corrupted.data(), corrupted.size(), canIDTranslator ) );
+
+    auto otherVersion = binary;
+    uint32_t version = DecoderDictionarySnapshot::VERSION + 1;
+    std::memcpy( otherVersion.data() + sizeof( uint32_t ), &version, sizeof( version ) );
+    ASSERT_FALSE( loaded.deserialize( otherVersion.data(), otherVersion.size(), canIDTranslator ) );
+
+    ASSERT_TRUE( loaded.deserialize( binary.data(), binary.size(), canIDTranslator ) );
+}
+
+/** @brief
+ * This test validates that a snapshot is rejected if its CAN interfaces are not configured anymore
+ */
+TEST( DecoderDictionarySnapshotTest, RejectChangedInterfaces )
+{
+    CANInterfaceIDTranslator canIDTranslator;
+    canIDTranslator.add( "vcan0" );
+    std::vector<uint8_t> binary;
+    ASSERT_TRUE( createSnapshot( canIDTranslator ).serialize( canIDTranslator, binary ) );
+
+    CANInterfaceIDTranslator otherCanIDTranslator;
+    otherCanIDTranslator.add( "vcan1" );
+    DecoderDictionarySnapshot loaded;
+    ASSERT_FALSE( loaded.deserialize( binary.data(), binary.size(), otherCanIDTranslator ) );
+}
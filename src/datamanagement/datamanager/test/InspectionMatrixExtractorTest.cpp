@@ -241,3 +241,137 @@ TEST( CollectionSchemeManager, InpsectionMatrixExtractorConditionDataTest )
         ASSERT_EQ( conditionData.metaData.collectionSchemeID, collectionScheme->getCollectionSchemeID() );
     }
 }
+
+TEST( CollectionSchemeManager, InspectionMatrixExtractorSharesSubExpressions )
+{
+    // Tree 1 is (signal1 > 2 * 50) && (signal2 < 5), tree 2 is (signal1 > 100) || (signal3 < 5)
+    std::vector<ExpressionNode> tree1( 9 );
+    tree1[0].nodeType = ExpressionNodeType::OPERATOR_LOGICAL_AND;
+    tree1[0].left = &tree1[1];
+    tree1[0].right = &tree1[6];
+    tree1[1].nodeType = ExpressionNodeType::OPERATOR_BIGGER;
+    tree1[1].left = &tree1[2];
+    tree1[1].right = &tree1[3];
+    tree1[2].nodeType = ExpressionNodeType::SIGNAL;
+    tree1[2].signalID = 1;
+    tree1[3].nodeType = ExpressionNodeType::OPERATOR_ARITHMETIC_MULTIPLY;
+    tree1[3].left = &tree1[4];
+    tree1[3].right = &tree1[5];
+    tree1[4].floatingValue = 2;
+    tree1[5].floatingValue = 50;
+    tree1[6].nodeType = ExpressionNodeType::OPERATOR_SMALLER;
+    tree1[6].left = &tree1[7];
+    tree1[6].right = &tree1[8];
+    tree1[7].nodeType = ExpressionNodeType::SIGNAL;
+    tree1[7].signalID = 2;
+    tree1[8].floatingValue = 5;
+    std::vector<ExpressionNode> tree2( 7 );
+    tree2[0].nodeType = ExpressionNodeType::OPERATOR_LOGICAL_OR;
+    tree2[0].left = &tree2[1];
+    tree2[0].right = &tree2[4];
+    tree2[1].nodeType = ExpressionNodeType::OPERATOR_BIGGER;
+    tree2[1].left = &tree2[2];
+    tree2[1].right = &tree2[3];
+    tree2[2].nodeType = ExpressionNodeType::SIGNAL;
+    tree2[2].signalID = 1;
+    tree2[3].floatingValue = 100;
+    tree2[4].nodeType = ExpressionNodeType::OPERATOR_SMALLER;
+    tree2[4].left = &tree2[5];
+    tree2[4].right = &tree2[6];
+    tree2[5].nodeType = ExpressionNodeType::SIGNAL;
+    tree2[5].signalID = 3;
+    tree2[6].floatingValue = 5;
+
+    std::vector<ICollectionSchemePtr> list1;
+    list1.emplace_back( std::make_shared<ICollectionSchemeTest>( "COLLECTIONSCHEME1", "DM1", 0, 10, &tree1[0] ) );
+    list1.emplace_back( std::make_shared<ICollectionSchemeTest>( "COLLECTIONSCHEME2", "DM1", 0, 10, &tree2[0] ) );
+    CollectionSchemeManagerTest test( "DM1" );
+    test.setDecoderManifest( std::make_shared<IDecoderManifestTest>( "DM1" ) );
+    test.setCollectionSchemeList( std::make_shared<ICollectionSchemeListTest>( list1 ) );
+    ASSERT_TRUE( test.updateMapsandTimeLine( 0 ) );
+    std::shared_ptr<InspectionMatrix> output = std::make_shared<struct InspectionMatrix>();
+    test.inspectionMatrixExtractor( output );
+
+    // signal1, 100, >, signal2, 5, <, &&, signal3, <, ||
+    ASSERT_EQ( output->expressionNodeStorage.size(), 10 );
+    ASSERT_EQ( output->conditions.size(), 2 );
+    const ExpressionNode *root1 = output->conditions[0].condition;
+    const ExpressionNode *root2 = output->conditions[1].condition;
+    if ( root1->nodeType != ExpressionNodeType::OPERATOR_LOGICAL_AND )
+    {
+        std::swap( root1, root2 );
+    }
+    ASSERT_EQ( root1->nodeType, ExpressionNodeType::OPERATOR_LOGICAL_AND );
+    ASSERT_EQ( root2->nodeType, ExpressionNodeType::OPERATOR_LOGICAL_OR );
+    // The constant product is folded, so the comparison with signal1 is shared
+    ASSERT_EQ( root1->left, root2->left );
+    ASSERT_EQ( root1->left->right->nodeType, ExpressionNodeType::FLOAT );
+    ASSERT_EQ( root1->left->right->floatingValue, 100 );
+    ASSERT_EQ( root1->left->right->left, nullptr );
+    ASSERT_NE( root1->right, root2->right );
+    ASSERT_EQ( root1->right->right, root2->right->right );
+    ASSERT_EQ( root1->right->left->signalID, 2 );
+    ASSERT_EQ( root2->right->left->signalID, 3 );
+}
+
+TEST( CollectionSchemeManager, InspectionMatrixExtractorDoesNotShareGeohash )
+{
+    std::vector<ExpressionNode> geohash( 2 );
+    for ( auto &node : geohash )
+    {
+        node.nodeType = ExpressionNodeType::GEOHASHFUNCTION;
+        node.function.geohashFunction.latitudeSignalID = 1;
+        node.function.geohashFunction.longitudeSignalID = 2;
+        node.function.geohashFunction.precision = 5;
+    }
+    std::vector<ICollectionSchemePtr> list1;
+    list1.emplace_back( std::make_shared<ICollectionSchemeTest>( "COLLECTIONSCHEME1", "DM1", 0, 10, &geohash[0] ) );
+    list1.emplace_back( std::make_shared<ICollectionSchemeTest>( "COLLECTIONSCHEME2", "DM1", 0, 10, &geohash[1] ) );
+    CollectionSchemeManagerTest test( "DM1" );
+    test.setDecoderManifest( std::make_shared<IDecoderManifestTest>( "DM1" ) );
+    test.setCollectionSchemeList( std::make_shared<ICollectionSchemeListTest>( list1 ) );
+    ASSERT_TRUE( test.updateMapsandTimeLine( 0 ) );
+    std::shared_ptr<InspectionMatrix> output = std::make_shared<struct InspectionMatrix>();
+    test.inspectionMatrixExtractor( output );
+
+    // The geohash function keeps the last geohash to detect changes, every condition needs its own node
+    ASSERT_EQ( output->expressionNodeStorage.size(), 2 );
+    ASSERT_NE( output->conditions[0].condition, output->conditions[1].condition );
+    ASSERT_EQ( output->conditions[0].condition->function.geohashFunction.precision, 5 );
+}
+
+TEST( CollectionSchemeManager, InspectionMatrixExtractorPutsExpressFirst )
+{
+    std::vector<ExpressionNode> conditions( 3 );
+    for ( size_t i = 0; i < conditions.size(); i++ )
+    {
+        conditions[i].nodeType = ExpressionNodeType::FLOAT;
+        conditions[i].floatingValue = static_cast<double>( i + 1 );
+    }
+    auto collectionScheme1 =
+        std::make_shared<ICollectionSchemeTest>( "COLLECTIONSCHEME1", "DM1", 0, 10, &conditions[0] );
+    auto collectionScheme2 =
+        std::make_shared<ICollectionSchemeTest>( "COLLECTIONSCHEME2", "DM1", 0, 10, &conditions[1] );
+    auto collectionScheme3 =
+        std::make_shared<ICollectionSchemeTest>( "COLLECTIONSCHEME3", "DM1", 0, 10, &conditions[2] );
+    collectionScheme1->setPriority( 5 );
+    collectionScheme2->setPriority( 1 );
+    collectionScheme3->setPriority( 7 );
+    std::vector<ICollectionSchemePtr> list1 = { collectionScheme1, collectionScheme2, collectionScheme3 };
+    CollectionSchemeManagerTest test( "DM1" );
+    test.setExpressMaxPriority( 2 );
+    test.setDecoderManifest( std::make_shared<IDecoderManifestTest>( "DM1" ) );
+    test.setCollectionSchemeList( std::make_shared<ICollectionSchemeListTest>( list1 ) );
+    ASSERT_TRUE( test.updateMapsandTimeLine( 0 ) );
+    std::shared_ptr<InspectionMatrix> output = std::make_shared<struct InspectionMatrix>();
+    test.inspectionMatrixExtractor( output );
+
+    // The express collection scheme is evaluated first, the others keep their order
+    ASSERT_EQ( output->conditions.size(), 3 );
+    ASSERT_EQ( output->conditions[0].metaData.collectionSchemeID, "COLLECTIONSCHEME2" );
+    ASSERT_TRUE( output->conditions[0].metaData.express );
+    ASSERT_EQ( output->conditions[1].metaData.collectionSchemeID, "COLLECTIONSCHEME1" );
+    ASSERT_FALSE( output->conditions[1].metaData.express );
+    ASSERT_EQ( output->conditions[2].metaData.collectionSchemeID, "COLLECTIONSCHEME3" );
+    ASSERT_FALSE( output->conditions[2].metaData.express );
+}
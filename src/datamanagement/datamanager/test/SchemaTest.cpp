@@ -17,13 +17,17 @@
 #include "ClockHandler.h"
 #include "CollectionSchemeIngestion.h"
 #include "CollectionSchemeIngestionList.h"
+#include "Crc32c.h"
 #include "DecoderManifestIngestion.h"
 #include "ICollectionScheme.h"
+#include <cmath>
 #include <functional>
 #include <gtest/gtest.h>
 #include <iostream>
 #include <set>
 #include <string>
+#include <utility>
+#include <vector>
 
 using namespace Aws::IoTFleetWise::Platform::Linux;
 using namespace Aws::IoTFleetWise::DataManagement;
@@ -217,6 +221,9 @@ TEST( SchemaTest, DecoderManifestIngestion )
     protoCANSignalB->set_offset( 100 );
     protoCANSignalB->set_factor( 10 );
     protoCANSignalB->set_length( 8 );
+    protoCANSignalB->mutable_emission_policy()->set_type( DecoderManifestMsg::EmissionPolicy::ABSOLUTE_DEADBAND );
+    protoCANSignalB->mutable_emission_policy()->set_deadband( 0.5 );
+    protoCANSignalB->mutable_emission_policy()->set_max_silence_ms( 1000 );
 
     DecoderManifestMsg::CANSignal *protoCANSignalC = protoDM.add_can_signals();
 
@@ -301,6 +308,14 @@ TEST( SchemaTest, DecoderManifestIngestion )
             ASSERT_EQ( protoCANSignalA->offset(), sigFormat.mOffset );
             ASSERT_EQ( protoCANSignalA->factor(), sigFormat.mFactor );
             ASSERT_EQ( protoCANSignalA->length(), sigFormat.mSizeInBits );
+            // Without an emission policy every value is passed on
+            ASSERT_TRUE( sigFormat.mEmissionPolicy.isAlways() );
+        }
+        else if ( sigFormat.mSignalID == protoCANSignalB->signal_id() )
+        {
+            ASSERT_EQ( sigFormat.mEmissionPolicy.mType, SignalEmissionPolicyType::ABSOLUTE_DEADBAND );
+            ASSERT_EQ( sigFormat.mEmissionPolicy.mDeadband, 0.5 );
+            ASSERT_EQ( sigFormat.mEmissionPolicy.mMaxSilenceMs, 1000 );
         }
     }
     // Assert that the one signal was found
@@ -344,6 +359,25 @@ TEST( SchemaTest, DecoderManifestIngestion )
     ASSERT_EQ( testPIDM.getNetworkProtocol( 50000 ), VehicleDataSourceProtocol::RAW_SOCKET );
     ASSERT_EQ( testPIDM.getNetworkProtocol( 123 ), VehicleDataSourceProtocol::OBD );
     ASSERT_EQ( testPIDM.getNetworkProtocol( 567 ), VehicleDataSourceProtocol::OBD );
+
+    // Every signal gets a dense index in the order of the Decoder Manifest, which is also set in the CAN formats
+    ASSERT_EQ( testPIDM.getSignalIndex( 3908 ), 0 );
+    ASSERT_EQ( testPIDM.getSignalIndex( 2987 ), 1 );
+    ASSERT_EQ( testPIDM.getSignalIndex( 50000 ), 2 );
+    ASSERT_EQ( testPIDM.getSignalIndex( 123 ), 3 );
+    ASSERT_EQ( testPIDM.getSignalIndex( 567 ), 4 );
+    ASSERT_EQ( testPIDM.getSignalIndex( 890 ), INVALID_MANIFEST_SIGNAL_INDEX );
+    for ( auto &sigFormat : testCMF.mSignals )
+    {
+        ASSERT_EQ( sigFormat.mSignalIndex, testPIDM.getSignalIndex( sigFormat.mSignalID ) );
+    }
+
+    // The binary data is not needed anymore once persisted, the built decoder manifest stays usable
+    ASSERT_FALSE( testPIDM.getData().empty() );
+    testPIDM.releaseData();
+    ASSERT_TRUE( testPIDM.getData().empty() );
+    ASSERT_EQ( testPIDM.getID(), protoDM.arn() );
+    ASSERT_EQ( testPIDM.getNetworkProtocol( 123 ), VehicleDataSourceProtocol::OBD );
 }
 
 /**
@@ -382,6 +416,190 @@ TEST( SchemaTest, SchemaInvalidDecoderManifestTest )
     ASSERT_FALSE( testPIDM.isReady() );
 }
 
+/**
+ * @brief This test builds a DecoderManifest big enough to be built in parallel across the CAN interfaces and checks
+ * that the result is the same as a build on one thread.
+ */
+TEST( SchemaTest, DecoderManifestParallelBuild )
+{
+    DecoderManifestMsg::DecoderManifest protoDM;
+    protoDM.set_arn( "arn:aws:iam::123456789012:user/Development/product_1234/*" );
+    const uint32_t interfaceCount = 4;
+    const uint32_t signalCount = 12000;
+    for ( uint32_t i = 0; i < signalCount; i++ )
+    {
+        DecoderManifestMsg::CANSignal *protoCANSignal = protoDM.add_can_signals();
+        protoCANSignal->set_signal_id( i );
+        protoCANSignal->set_interface_id( std::to_string( i % interfaceCount ) );
+        // 3 signals per message, the last signal of each message is beyond byte 8
+        protoCANSignal->set_message_id( i / ( interfaceCount * 3 ) );
+        protoCANSignal->set_start_bit( 32 * ( ( i / interfaceCount ) % 3 ) );
+        protoCANSignal->set_length( 16 );
+        protoCANSignal->set_factor( 1.0 );
+    }
+
+    std::string protoSerializedBuffer;
+    ASSERT_TRUE( protoDM.SerializeToString( &protoSerializedBuffer ) );
+    DecoderManifestIngestion testPIDM;
+    ASSERT_TRUE( testPIDM.copyData( reinterpret_cast<const uint8_t *>( protoSerializedBuffer.data() ),
+                                    protoSerializedBuffer.length() ) );
+    ASSERT_TRUE( testPIDM.build() );
+
+    for ( uint32_t i = 0; i < signalCount; i++ )
+    {
+        auto interfaceID = std::to_string( i % interfaceCount );
+        CANRawFrameID messageID = i / ( interfaceCount * 3 );
+        ASSERT_EQ( testPIDM.getCANFrameAndInterfaceID( i ), std::make_pair( messageID, interfaceID ) );
+        const auto &messageFormat = testPIDM.getCANMessageFormat( messageID, interfaceID );
+        ASSERT_EQ( messageFormat.mSignals.size(), 3 );
+        ASSERT_EQ( messageFormat.mSizeInBytes, MAX_CANFD_FRAME_BYTE_SIZE );
+        // The signals keep the order of the proto
+        ASSERT_EQ( messageFormat.mSignals[( i / interfaceCount ) % 3].mSignalID, i );
+    }
+}
+
+/**
+ * @brief This test checks that UDS DID signals are ingested and that invalid periodic DIDs are rejected
+ */
+TEST( SchemaTest, DecoderManifestUDSDIDSignals )
+{
+    DecoderManifestMsg::DecoderManifest protoDM;
+    protoDM.set_arn( "arn:aws:iam::123456789012:user/Development/product_1234/*" );
+    auto addDIDSignal = [&]( uint32_t signalID, uint32_t did, uint32_t transmissionMode ) {
+        DecoderManifestMsg::UDSDIDSignal *protoDIDSignal = protoDM.add_uds_did_signals();
+        protoDIDSignal->set_signal_id( signalID );
+        protoDIDSignal->set_interface_id( "1" );
+        protoDIDSignal->set_request_message_id( 0x7E0 );
+        protoDIDSignal->set_did( did );
+        protoDIDSignal->set_did_response_length( 4 );
+        protoDIDSignal->set_periodic_transmission_mode( transmissionMode );
+        protoDIDSignal->set_periodic_response_message_id( 0x5E8 );
+        protoDIDSignal->set_scaling( 0.1 );
+        protoDIDSignal->set_offset( -40 );
+        protoDIDSignal->set_start_byte( 1 );
+        protoDIDSignal->set_byte_length( 2 );
+        protoDIDSignal->set_bit_right_shift( 0 );
+        protoDIDSignal->set_bit_mask_length( 8 );
+    };
+    addDIDSignal( 300, 0xF40D, 0 );
+    addDIDSignal( 301, 0xF210, 3 );
+    // Periodic DIDs must be in the range 0xF200 to 0xF2FE
+    addDIDSignal( 302, 0xF40D, 1 );
+    addDIDSignal( 303, 0xF2FF, 1 );
+
+    std::string protoSerializedBuffer;
+    ASSERT_TRUE( protoDM.SerializeToString( &protoSerializedBuffer ) );
+    DecoderManifestIngestion testPIDM;
+    ASSERT_TRUE( testPIDM.copyData( reinterpret_cast<const uint8_t *>( protoSerializedBuffer.data() ),
+                                    protoSerializedBuffer.length() ) );
+    ASSERT_TRUE( testPIDM.build() );
+
+    ASSERT_EQ( testPIDM.getNetworkProtocol( 300 ), VehicleDataSourceProtocol::UDS );
+    auto didDecoderFormat = testPIDM.getDIDSignalDecoderFormat( 300 );
+    ASSERT_EQ( didDecoderFormat.mInterfaceID, "1" );
+    ASSERT_EQ( didDecoderFormat.mRequestMessageID, 0x7E0 );
+    ASSERT_EQ( didDecoderFormat.mDID, 0xF40D );
+    ASSERT_EQ( didDecoderFormat.mDidResponseLength, 4 );
+    ASSERT_EQ( didDecoderFormat.mPeriodicTransmissionMode, 0 );
+    ASSERT_DOUBLE_EQ( didDecoderFormat.mScaling, 0.1 );
+    ASSERT_DOUBLE_EQ( didDecoderFormat.mOffset, -40 );
+    ASSERT_EQ( didDecoderFormat.mStartByte, 1 );
+    ASSERT_EQ( didDecoderFormat.mByteLength, 2 );
+    ASSERT_EQ( didDecoderFormat.mBitMaskLength, 8 );
+
+    ASSERT_EQ( testPIDM.getDIDSignalDecoderFormat( 301 ).mPeriodicTransmissionMode, 3 );
+    ASSERT_EQ( testPIDM.getDIDSignalDecoderFormat( 301 ).mPeriodicResponseMessageID, 0x5E8 );
+
+    ASSERT_EQ( testPIDM.getNetworkProtocol( 302 ), VehicleDataSourceProtocol::INVALID_PROTOCOL );
+    ASSERT_EQ( testPIDM.getDIDSignalDecoderFormat( 302 ), NOT_FOUND_DID_DECODER_FORMAT );
+    ASSERT_EQ( testPIDM.getNetworkProtocol( 303 ), VehicleDataSourceProtocol::INVALID_PROTOCOL );
+}
+
+/**
+ * @brief This test splits a DecoderManifest into chunks, as Cloud does for big decoder manifests, and checks that the
+ * decoder manifest is built incrementally from the chunks and that invalid chunks are rejected.
+ */
+TEST( SchemaTest, DecoderManifestChunks )
+{
+    const std::string arn = "arn:aws:iam::123456789012:user/Development/product_1234/*";
+    std::vector<std::string> fragments;
+    for ( uint32_t i = 0; i < 3; i++ )
+    {
+        DecoderManifestMsg::DecoderManifest protoFragment;
+        protoFragment.set_arn( arn );
+        DecoderManifestMsg::CANSignal *protoCANSignal = protoFragment.add_can_signals();
+        protoCANSignal->set_signal_id( 100 + i );
+        protoCANSignal->set_interface_id( "123" );
+        protoCANSignal->set_message_id( 600 );
+        protoCANSignal->set_start_bit( 8 * i );
+        protoCANSignal->set_length( 8 );
+        protoCANSignal->set_factor( 1.0 );
+        DecoderManifestMsg::OBDPIDSignal *protoOBDSignal = protoFragment.add_obd_pid_signals();
+        protoOBDSignal->set_signal_id( 200 + i );
+        protoOBDSignal->set_pid_response_length( 1 );
+        protoOBDSignal->set_service_mode( 1 );
+        protoOBDSignal->set_pid( 0x10 + i );
+        protoOBDSignal->set_scaling( 1.0 );
+        protoOBDSignal->set_byte_length( 1 );
+        protoOBDSignal->set_bit_mask_length( 8 );
+        fragments.emplace_back( protoFragment.SerializeAsString() );
+    }
+    uint32_t digest = 0;
+    for ( const auto &fragment : fragments )
+    {
+        digest = PersistencyManagement::crc32c(
+            digest, reinterpret_cast<const uint8_t *>( fragment.data() ), fragment.size() );
+    }
+    auto makeChunk = [&]( uint32_t sequenceNumber, uint32_t chunkDigest ) {
+        DecoderManifestMsg::DecoderManifest protoChunk;
+        protoChunk.set_arn( arn );
+        protoChunk.mutable_chunk()->set_sequence_number( sequenceNumber );
+        protoChunk.mutable_chunk()->set_total_chunks( static_cast<uint32_t>( fragments.size() ) );
+        protoChunk.mutable_chunk()->set_fragment( fragments[sequenceNumber] );
+        protoChunk.mutable_chunk()->set_digest( chunkDigest );
+        return protoChunk.SerializeAsString();
+    };
+    auto addChunk = [&]( DecoderManifestIngestion &decoderManifest, const std::string &chunk ) {
+        return decoderManifest.addChunk( reinterpret_cast<const uint8_t *>( chunk.data() ), chunk.size() );
+    };
+
+    ASSERT_TRUE( DecoderManifestIngestion::isChunk( reinterpret_cast<const uint8_t *>( makeChunk( 0, 0 ).data() ),
+                                                    makeChunk( 0, 0 ).size() ) );
+    ASSERT_FALSE( DecoderManifestIngestion::isChunk( reinterpret_cast<const uint8_t *>( fragments[0].data() ),
+                                                     fragments[0].size() ) );
+
+    // A chunk out of order discards the incomplete decoder manifest
+    DecoderManifestIngestion testPIDM;
+    ASSERT_EQ( addChunk( testPIDM, makeChunk( 0, digest ) ), DecoderManifestChunkStatus::INCOMPLETE );
+    ASSERT_EQ( addChunk( testPIDM, makeChunk( 2, digest ) ), DecoderManifestChunkStatus::INVALID );
+    ASSERT_EQ( addChunk( testPIDM, makeChunk( 1, digest ) ), DecoderManifestChunkStatus::INVALID );
+
+    // A wrong digest is detected on the last chunk
+    ASSERT_EQ( addChunk( testPIDM, makeChunk( 0, digest + 1 ) ), DecoderManifestChunkStatus::INCOMPLETE );
+    ASSERT_EQ( addChunk( testPIDM, makeChunk( 1, digest + 1 ) ), DecoderManifestChunkStatus::INCOMPLETE );
+    ASSERT_EQ( addChunk( testPIDM, makeChunk( 2, digest + 1 ) ), DecoderManifestChunkStatus::INVALID );
+
+    ASSERT_EQ( addChunk( testPIDM, makeChunk( 0, digest ) ), DecoderManifestChunkStatus::INCOMPLETE );
+    ASSERT_EQ( addChunk( testPIDM, makeChunk( 1, digest ) ), DecoderManifestChunkStatus::INCOMPLETE );
+    ASSERT_EQ( addChunk( testPIDM, makeChunk( 2, digest ) ), DecoderManifestChunkStatus::COMPLETE );
+    ASSERT_FALSE( testPIDM.isReady() );
+    ASSERT_TRUE( testPIDM.build() );
+    ASSERT_TRUE( testPIDM.isReady() );
+    ASSERT_EQ( testPIDM.getID(), arn );
+    ASSERT_EQ( testPIDM.getCANMessageFormat( 600, "123" ).mSignals.size(), 3 );
+    ASSERT_EQ( testPIDM.getNetworkProtocol( 102 ), VehicleDataSourceProtocol::RAW_SOCKET );
+    ASSERT_EQ( testPIDM.getNetworkProtocol( 201 ), VehicleDataSourceProtocol::OBD );
+    ASSERT_EQ( testPIDM.getPIDSignalDecoderFormat( 202 ).mPID, 0x12 );
+
+    // The concatenated fragments are the complete decoder manifest, which is persisted and built after a restart
+    DecoderManifestIngestion restoredPIDM;
+    ASSERT_TRUE( restoredPIDM.copyData( testPIDM.getData().data(), testPIDM.getData().size() ) );
+    ASSERT_TRUE( restoredPIDM.build() );
+    ASSERT_EQ( restoredPIDM.getID(), arn );
+    ASSERT_EQ( restoredPIDM.getCANMessageFormat( 600, "123" ).mSignals.size(), 3 );
+    ASSERT_EQ( restoredPIDM.getNetworkProtocol( 200 ), VehicleDataSourceProtocol::OBD );
+}
+
 TEST( SchemaTest, CollectionSchemeIngestionList )
 {
     // Create our CollectionSchemeIngestionList object or PIPL for short
@@ -437,6 +655,93 @@ TEST( SchemaTest, CollectionSchemeIngestionList )
     ASSERT_TRUE( testPIPL.isReady() );
 
     ASSERT_EQ( testPIPL.getCollectionSchemes().size(), 0 );
+
+    testPIPL.releaseData();
+    ASSERT_TRUE( testPIPL.getData().empty() );
+    ASSERT_TRUE( testPIPL.isReady() );
+}
+
+TEST( SchemaTest, CollectionSchemeIngestionListSharedArena )
+{
+    CollectionSchemesMsg::CollectionSchemes protoCollectionSchemesMsg;
+    for ( const auto &campaignARN : { "P1", "P2", "P3" } )
+    {
+        auto collectionSchemeMsg = protoCollectionSchemesMsg.add_collection_schemes();
+        collectionSchemeMsg->set_campaign_arn( campaignARN );
+        collectionSchemeMsg->set_decoder_manifest_arn( "model_manifest_12" );
+        collectionSchemeMsg->set_start_time_ms_epoch( 1621448160000 );
+        collectionSchemeMsg->set_expiry_time_ms_epoch( 2621448160000 );
+        collectionSchemeMsg->mutable_time_based_collection_scheme()->set_time_based_collection_scheme_period_ms( 5000 );
+    }
+    // P2 fails to build, its node must not stay in the arena
+    protoCollectionSchemesMsg.mutable_collection_schemes( 1 )->set_expiry_time_ms_epoch( 0 );
+
+    std::string protoSerializedBuffer;
+    ASSERT_TRUE( protoCollectionSchemesMsg.SerializeToString( &protoSerializedBuffer ) );
+    CollectionSchemeIngestionList testPIPL;
+    testPIPL.copyData( reinterpret_cast<const uint8_t *>( protoSerializedBuffer.data() ),
+                       protoSerializedBuffer.length() );
+    ASSERT_TRUE( testPIPL.build() );
+
+    const auto &collectionSchemes = testPIPL.getCollectionSchemes();
+    ASSERT_EQ( collectionSchemes.size(), 2 );
+    // Both collectionSchemes allocate their nodes from the same arena
+    const auto &arena = collectionSchemes[0]->getAllExpressionNodes();
+    ASSERT_EQ( &arena, &collectionSchemes[1]->getAllExpressionNodes() );
+    ASSERT_EQ( arena.size(), 2 );
+    ASSERT_EQ( collectionSchemes[0]->getCondition(), &arena[0] );
+    ASSERT_EQ( collectionSchemes[1]->getCondition(), &arena[1] );
+    ASSERT_EQ( collectionSchemes[1]->getCondition()->nodeType, ExpressionNodeType::BOOLEAN );
+    ASSERT_TRUE( collectionSchemes[1]->getCondition()->booleanValue );
+}
+
+TEST( SchemaTest, CollectionSchemeIngestionListDefersIdleBuild )
+{
+    CollectionSchemesMsg::CollectionSchemes protoCollectionSchemesMsg;
+    for ( const auto &campaignARN : { "Started", "Idle" } )
+    {
+        auto collectionSchemeMsg = protoCollectionSchemesMsg.add_collection_schemes();
+        collectionSchemeMsg->set_campaign_arn( campaignARN );
+        collectionSchemeMsg->set_decoder_manifest_arn( "model_manifest_12" );
+        collectionSchemeMsg->set_start_time_ms_epoch( 1621448160000 );
+        collectionSchemeMsg->set_expiry_time_ms_epoch( 4621448160000 );
+        collectionSchemeMsg->mutable_time_based_collection_scheme()->set_time_based_collection_scheme_period_ms( 5000 );
+        collectionSchemeMsg->add_signal_information()->set_signal_id( 19 );
+    }
+    // Starts far in the future
+    protoCollectionSchemesMsg.mutable_collection_schemes( 1 )->set_start_time_ms_epoch( 3621448160000 );
+
+    std::string protoSerializedBuffer;
+    ASSERT_TRUE( protoCollectionSchemesMsg.SerializeToString( &protoSerializedBuffer ) );
+    CollectionSchemeIngestionList testPIPL;
+    testPIPL.copyData( reinterpret_cast<const uint8_t *>( protoSerializedBuffer.data() ),
+                       protoSerializedBuffer.length() );
+    ASSERT_TRUE( testPIPL.build() );
+
+    const auto &collectionSchemes = testPIPL.getCollectionSchemes();
+    ASSERT_EQ( collectionSchemes.size(), 2 );
+    ASSERT_TRUE( collectionSchemes[0]->isReady() );
+    ASSERT_EQ( collectionSchemes[0]->getAllExpressionNodes().size(), 1 );
+
+    // Only the IDs and times of the idle collectionScheme are available until it is built
+    auto idle = collectionSchemes[1];
+    ASSERT_FALSE( idle->isReady() );
+    ASSERT_EQ( idle->getCollectionSchemeID(), "Idle" );
+    ASSERT_EQ( idle->getDecoderManifestID(), "model_manifest_12" );
+    ASSERT_EQ( idle->getStartTime(), 3621448160000 );
+    ASSERT_EQ( idle->getExpiryTime(), 4621448160000 );
+    ASSERT_TRUE( idle->getCollectSignals().empty() );
+
+    ASSERT_TRUE( idle->buildIfDeferred() );
+    ASSERT_TRUE( idle->isReady() );
+    ASSERT_EQ( idle->getCollectionSchemeID(), "Idle" );
+    ASSERT_EQ( idle->getStartTime(), 3621448160000 );
+    ASSERT_EQ( idle->getCollectSignals().size(), 1 );
+    ASSERT_EQ( idle->getCollectSignals()[0].signalID, 19 );
+    ASSERT_NE( idle->getCondition(), nullptr );
+    // A second call does not build it again
+    ASSERT_TRUE( idle->buildIfDeferred() );
+    ASSERT_EQ( idle->getCollectSignals().size(), 1 );
 }
 
 TEST( SchemaTest, CollectionSchemeIngestionHeartBeat )
@@ -458,6 +763,9 @@ TEST( SchemaTest, CollectionSchemeIngestionHeartBeat )
     collectionSchemeTestMessage.set_persist_all_collected_data( true );
     collectionSchemeTestMessage.set_compress_collected_data( true );
     collectionSchemeTestMessage.set_priority( 9 );
+    collectionSchemeTestMessage.set_raw_can_log( true );
+    collectionSchemeTestMessage.set_condition_evaluation_interval_ms( 100 );
+    collectionSchemeTestMessage.set_condition_evaluation_budget_us( 500 );
 
     // Add 3 Signals
     CollectionSchemesMsg::SignalInformation *signal1 = collectionSchemeTestMessage.add_signal_information();
@@ -518,6 +826,9 @@ TEST( SchemaTest, CollectionSchemeIngestionHeartBeat )
     ASSERT_TRUE( collectionSchemeTest.getCollectRawCanFrames().size() == 0 );
     ASSERT_TRUE( collectionSchemeTest.isPersistNeeded() == false );
     ASSERT_TRUE( collectionSchemeTest.isCompressionNeeded() == false );
+    ASSERT_TRUE( collectionSchemeTest.isRawCanLogNeeded() == false );
+    ASSERT_TRUE( collectionSchemeTest.getConditionEvaluationIntervalMs() == 0 );
+    ASSERT_TRUE( collectionSchemeTest.getConditionEvaluationBudgetUs() == 0 );
     ASSERT_TRUE( collectionSchemeTest.getPriority() == std::numeric_limits<uint32_t>::max() );
     ASSERT_TRUE( collectionSchemeTest.getCondition() == nullptr );
     ASSERT_TRUE( collectionSchemeTest.getMinimumPublishIntervalMs() == std::numeric_limits<uint32_t>::max() );
@@ -573,6 +884,9 @@ TEST( SchemaTest, CollectionSchemeIngestionHeartBeat )
 
     ASSERT_TRUE( collectionSchemeTest.isPersistNeeded() == true );
     ASSERT_TRUE( collectionSchemeTest.isCompressionNeeded() == true );
+    ASSERT_TRUE( collectionSchemeTest.isRawCanLogNeeded() == true );
+    ASSERT_TRUE( collectionSchemeTest.getConditionEvaluationIntervalMs() == 100 );
+    ASSERT_TRUE( collectionSchemeTest.getConditionEvaluationBudgetUs() == 500 );
     ASSERT_TRUE( collectionSchemeTest.getPriority() == 9 );
     // For time based collectionScheme the condition is always set to true hence: currentNode.booleanValue=true
     ASSERT_TRUE( collectionSchemeTest.getCondition()->booleanValue == true );
@@ -583,6 +897,151 @@ TEST( SchemaTest, CollectionSchemeIngestionHeartBeat )
     ASSERT_EQ( collectionSchemeTest.getAllExpressionNodes().size(), 1 );
 }
 
+TEST( SchemaTest, CollectionSchemeIngestionSignalAggregation )
+{
+    CollectionSchemesMsg::CollectionScheme collectionSchemeTestMessage;
+    collectionSchemeTestMessage.set_campaign_arn( "arn:aws:iam::2.23606797749:user/Development/product_1234/*" );
+    collectionSchemeTestMessage.set_decoder_manifest_arn( "model_manifest_12" );
+    collectionSchemeTestMessage.set_start_time_ms_epoch( 1621448160000 );
+    collectionSchemeTestMessage.set_expiry_time_ms_epoch( 2621448160000 );
+    collectionSchemeTestMessage.mutable_time_based_collection_scheme()->set_time_based_collection_scheme_period_ms(
+        60000 );
+
+    CollectionSchemesMsg::SignalInformation *signal1 = collectionSchemeTestMessage.add_signal_information();
+    signal1->set_signal_id( 1 );
+    signal1->set_sample_buffer_size( 1 );
+    signal1->set_fixed_window_period_ms( 10000 );
+    auto *aggregation = signal1->mutable_aggregation();
+    aggregation->set_count( true );
+    aggregation->set_mean( true );
+    aggregation->set_variance( true );
+    aggregation->add_histogram_bucket_bounds( 10.0 );
+    aggregation->add_histogram_bucket_bounds( 20.0 );
+    aggregation->add_percentiles( 50.0 );
+    aggregation->add_percentiles( 99.0 );
+    CollectionSchemesMsg::SignalInformation *signal2 = collectionSchemeTestMessage.add_signal_information();
+    signal2->set_signal_id( 2 );
+    signal2->set_sample_buffer_size( 10 );
+
+    CollectionSchemeIngestion collectionSchemeTest;
+    ASSERT_TRUE( collectionSchemeTest.copyData(
+        std::make_shared<CollectionSchemesMsg::CollectionScheme>( collectionSchemeTestMessage ) ) );
+    ASSERT_TRUE( collectionSchemeTest.build() );
+    ASSERT_EQ( collectionSchemeTest.getCollectSignals().size(), 2 );
+    const auto &info = collectionSchemeTest.getCollectSignals().at( 0 ).aggregation;
+    ASSERT_NE( info, nullptr );
+    ASSERT_TRUE( info->count );
+    ASSERT_FALSE( info->min );
+    ASSERT_FALSE( info->max );
+    ASSERT_TRUE( info->mean );
+    ASSERT_TRUE( info->variance );
+    ASSERT_EQ( info->histogramBounds, ( std::vector<double>{ 10.0, 20.0 } ) );
+    ASSERT_EQ( info->percentiles, ( std::vector<double>{ 50.0, 99.0 } ) );
+    ASSERT_EQ( collectionSchemeTest.getCollectSignals().at( 1 ).aggregation, nullptr );
+
+    // Unsorted bounds, percentiles out of range and a missing window period are rejected
+    auto invalidMessage = collectionSchemeTestMessage;
+    invalidMessage.mutable_signal_information( 0 )->mutable_aggregation()->set_histogram_bucket_bounds( 1, 5.0 );
+    CollectionSchemeIngestion unsortedBounds;
+    ASSERT_TRUE(
+        unsortedBounds.copyData( std::make_shared<CollectionSchemesMsg::CollectionScheme>( invalidMessage ) ) );
+    ASSERT_FALSE( unsortedBounds.build() );
+    invalidMessage = collectionSchemeTestMessage;
+    invalidMessage.mutable_signal_information( 0 )->mutable_aggregation()->add_percentiles( 101.0 );
+    CollectionSchemeIngestion invalidPercentile;
+    ASSERT_TRUE(
+        invalidPercentile.copyData( std::make_shared<CollectionSchemesMsg::CollectionScheme>( invalidMessage ) ) );
+    ASSERT_FALSE( invalidPercentile.build() );
+    invalidMessage = collectionSchemeTestMessage;
+    invalidMessage.mutable_signal_information( 0 )->set_fixed_window_period_ms( 0 );
+    CollectionSchemeIngestion noWindow;
+    ASSERT_TRUE( noWindow.copyData( std::make_shared<CollectionSchemesMsg::CollectionScheme>( invalidMessage ) ) );
+    ASSERT_FALSE( noWindow.build() );
+}
+
+TEST( SchemaTest, CollectionSchemeIngestionSignalDecimation )
+{
+    CollectionSchemesMsg::CollectionScheme collectionSchemeTestMessage;
+    collectionSchemeTestMessage.set_campaign_arn( "arn:aws:iam::2.23606797749:user/Development/product_1234/*" );
+    collectionSchemeTestMessage.set_decoder_manifest_arn( "model_manifest_12" );
+    collectionSchemeTestMessage.set_start_time_ms_epoch( 1621448160000 );
+    collectionSchemeTestMessage.set_expiry_time_ms_epoch( 2621448160000 );
+    collectionSchemeTestMessage.mutable_time_based_collection_scheme()->set_time_based_collection_scheme_period_ms(
+        60000 );
+
+    CollectionSchemesMsg::SignalInformation *signal1 = collectionSchemeTestMessage.add_signal_information();
+    signal1->set_signal_id( 1 );
+    signal1->set_sample_buffer_size( 1000 );
+    signal1->mutable_decimation()->set_method( CollectionSchemesMsg::SignalDecimation::MIN_MAX );
+    signal1->mutable_decimation()->set_max_samples( 100 );
+    CollectionSchemesMsg::SignalInformation *signal2 = collectionSchemeTestMessage.add_signal_information();
+    signal2->set_signal_id( 2 );
+    signal2->set_sample_buffer_size( 1000 );
+    signal2->mutable_decimation()->set_max_samples( 50 );
+
+    CollectionSchemeIngestion collectionSchemeTest;
+    ASSERT_TRUE( collectionSchemeTest.copyData(
+        std::make_shared<CollectionSchemesMsg::CollectionScheme>( collectionSchemeTestMessage ) ) );
+    ASSERT_TRUE( collectionSchemeTest.build() );
+    ASSERT_EQ( collectionSchemeTest.getCollectSignals().size(), 2 );
+    const auto &info = collectionSchemeTest.getCollectSignals().at( 0 ).decimation;
+    ASSERT_NE( info, nullptr );
+    ASSERT_EQ( info->method, Aws::IoTFleetWise::DataInspection::SignalDecimationMethod::MIN_MAX );
+    ASSERT_EQ( info->maxSamples, 100 );
+    ASSERT_EQ( collectionSchemeTest.getCollectSignals().at( 1 ).decimation->method,
+               Aws::IoTFleetWise::DataInspection::SignalDecimationMethod::LARGEST_TRIANGLE_THREE_BUCKETS );
+
+    // Fewer than 2 samples and a decimated aggregation are rejected
+    auto invalidMessage = collectionSchemeTestMessage;
+    invalidMessage.mutable_signal_information( 0 )->mutable_decimation()->set_max_samples( 1 );
+    CollectionSchemeIngestion tooFewSamples;
+    ASSERT_TRUE( tooFewSamples.copyData( std::make_shared<CollectionSchemesMsg::CollectionScheme>( invalidMessage ) ) );
+    ASSERT_FALSE( tooFewSamples.build() );
+    invalidMessage = collectionSchemeTestMessage;
+    invalidMessage.mutable_signal_information( 0 )->set_fixed_window_period_ms( 10000 );
+    invalidMessage.mutable_signal_information( 0 )->mutable_aggregation()->set_mean( true );
+    CollectionSchemeIngestion aggregated;
+    ASSERT_TRUE( aggregated.copyData( std::make_shared<CollectionSchemesMsg::CollectionScheme>( invalidMessage ) ) );
+    ASSERT_FALSE( aggregated.build() );
+}
+
+TEST( SchemaTest, CollectionSchemeIngestionUploadResolution )
+{
+    CollectionSchemesMsg::CollectionScheme collectionSchemeTestMessage;
+    collectionSchemeTestMessage.set_campaign_arn( "arn:aws:iam::2.23606797749:user/Development/product_1234/*" );
+    collectionSchemeTestMessage.set_decoder_manifest_arn( "model_manifest_12" );
+    collectionSchemeTestMessage.set_start_time_ms_epoch( 1621448160000 );
+    collectionSchemeTestMessage.set_expiry_time_ms_epoch( 2621448160000 );
+    collectionSchemeTestMessage.mutable_time_based_collection_scheme()->set_time_based_collection_scheme_period_ms(
+        60000 );
+
+    CollectionSchemesMsg::SignalInformation *signal1 = collectionSchemeTestMessage.add_signal_information();
+    signal1->set_signal_id( 1 );
+    signal1->set_sample_buffer_size( 100 );
+    signal1->set_upload_resolution( 0.1 );
+    CollectionSchemesMsg::SignalInformation *signal2 = collectionSchemeTestMessage.add_signal_information();
+    signal2->set_signal_id( 2 );
+    signal2->set_sample_buffer_size( 100 );
+
+    CollectionSchemeIngestion collectionSchemeTest;
+    ASSERT_TRUE( collectionSchemeTest.copyData(
+        std::make_shared<CollectionSchemesMsg::CollectionScheme>( collectionSchemeTestMessage ) ) );
+    ASSERT_TRUE( collectionSchemeTest.build() );
+    ASSERT_EQ( collectionSchemeTest.getCollectSignals().at( 0 ).uploadResolution, 0.1 );
+    ASSERT_EQ( collectionSchemeTest.getCollectSignals().at( 1 ).uploadResolution, 0.0 );
+
+    // Negative and not finite resolutions are rejected
+    auto invalidMessage = collectionSchemeTestMessage;
+    invalidMessage.mutable_signal_information( 0 )->set_upload_resolution( -1.0 );
+    CollectionSchemeIngestion negative;
+    ASSERT_TRUE( negative.copyData( std::make_shared<CollectionSchemesMsg::CollectionScheme>( invalidMessage ) ) );
+    ASSERT_FALSE( negative.build() );
+    invalidMessage.mutable_signal_information( 0 )->set_upload_resolution( std::nan( "" ) );
+    CollectionSchemeIngestion notANumber;
+    ASSERT_TRUE( notANumber.copyData( std::make_shared<CollectionSchemesMsg::CollectionScheme>( invalidMessage ) ) );
+    ASSERT_FALSE( notANumber.build() );
+}
+
 TEST( SchemaTest, SchemaCollectionEventBased )
 {
     // Create a  collection scheme Proto Message
@@ -672,6 +1131,11 @@ TEST( SchemaTest, SchemaCollectionEventBased )
     CollectionSchemesMsg::ImageData::TimeBasedImageData *timeImageCaptureData =
         imageCaptureData->mutable_time_based_image_data();
     timeImageCaptureData->set_before_duration_ms( 3 );
+    auto *captureOptions = imageCaptureData->mutable_capture_options();
+    captureOptions->set_keep_every_nth_frame( 5 );
+    captureOptions->set_key_frames_only( true );
+    captureOptions->set_similarity_threshold( 0.9 );
+    captureOptions->set_encoding( CollectionSchemesMsg::ImageData::CaptureOptions::JPEG );
     // Second device with an unsupported collection type
     CollectionSchemesMsg::ImageData *imageCaptureData2 = collectionSchemeTestMessage.add_image_data();
     imageCaptureData2->set_image_type( CollectionSchemesMsg::ImageData_ImageType::ImageData_ImageType_COMPRESSED_JPG );
@@ -759,6 +1223,13 @@ TEST( SchemaTest, SchemaCollectionEventBased )
     ASSERT_EQ( collectionSchemeTest.getImageCaptureData()[0].collectionType, ImageCollectionType::TIME_BASED );
     ASSERT_EQ( collectionSchemeTest.getImageCaptureData()[0].deviceID, 1 );
     ASSERT_EQ( collectionSchemeTest.getImageCaptureData()[0].imageFormat, 0 ); // Enum is mapped to int
+    const auto &imageCaptureOptions = collectionSchemeTest.getImageCaptureData()[0].captureOptions;
+    ASSERT_EQ( imageCaptureOptions.keepEveryNthFrame, 5 );
+    ASSERT_TRUE( imageCaptureOptions.keyFramesOnly );
+    ASSERT_DOUBLE_EQ( imageCaptureOptions.similarityThreshold, 0.9 );
+    ASSERT_EQ( imageCaptureOptions.encoding, Aws::IoTFleetWise::VehicleNetwork::ImageEncoding::JPEG );
+    // The quality is not set, so the default is kept
+    ASSERT_EQ( imageCaptureOptions.encodingQuality, 90 );
     // Signals
     ASSERT_TRUE( collectionSchemeTest.getCollectSignals().size() == 3 );
     ASSERT_TRUE( collectionSchemeTest.getCollectSignals().at( 0 ).signalID == 19 );
@@ -794,34 +1265,27 @@ TEST( SchemaTest, SchemaCollectionEventBased )
 
     // Verify the AST
     // Verify Left Side
-    ASSERT_EQ( collectionSchemeTest.getAllExpressionNodes().size(), 22 );
-    ASSERT_EQ( collectionSchemeTest.getAllExpressionNodes().at( 0 ).nodeType,
-               ExpressionNodeType::OPERATOR_LOGICAL_AND );
-    ASSERT_EQ( collectionSchemeTest.getAllExpressionNodes().at( 0 ).left->nodeType,
-               ExpressionNodeType::OPERATOR_LOGICAL_AND );
-    ASSERT_EQ( collectionSchemeTest.getAllExpressionNodes().at( 0 ).left->left->nodeType,
-               ExpressionNodeType::OPERATOR_EQUAL );
-    ASSERT_EQ( collectionSchemeTest.getAllExpressionNodes().at( 0 ).left->left->left->nodeType,
-               ExpressionNodeType::SIGNAL );
-    ASSERT_EQ( collectionSchemeTest.getAllExpressionNodes().at( 0 ).left->left->right->nodeType,
-               ExpressionNodeType::FLOAT );
-    ASSERT_EQ( collectionSchemeTest.getAllExpressionNodes().at( 0 ).left->left->left->signalID, 19 );
-    ASSERT_EQ( collectionSchemeTest.getAllExpressionNodes().at( 0 ).left->left->right->floatingValue, 1 );
-    ASSERT_EQ( collectionSchemeTest.getAllExpressionNodes().at( 0 ).left->right->nodeType,
-               ExpressionNodeType::OPERATOR_EQUAL );
-    ASSERT_EQ( collectionSchemeTest.getAllExpressionNodes().at( 0 ).left->right->left->nodeType,
-               ExpressionNodeType::SIGNAL );
-    ASSERT_EQ( collectionSchemeTest.getAllExpressionNodes().at( 0 ).left->right->right->nodeType,
-               ExpressionNodeType::FLOAT );
-    ASSERT_EQ( collectionSchemeTest.getAllExpressionNodes().at( 0 ).left->right->left->signalID, 17 );
-    ASSERT_EQ( collectionSchemeTest.getAllExpressionNodes().at( 0 ).left->right->right->floatingValue, 1 );
+    ASSERT_EQ( collectionSchemeTest.getAllExpressionNodes().size(), 11 );
+    // Nodes are in evaluation order, so the root is the last node
+    ASSERT_EQ( &collectionSchemeTest.getAllExpressionNodes().back(), collectionSchemeTest.getCondition() );
+    ASSERT_EQ( collectionSchemeTest.getCondition()->nodeType, ExpressionNodeType::OPERATOR_LOGICAL_AND );
+    ASSERT_EQ( collectionSchemeTest.getCondition()->left->nodeType, ExpressionNodeType::OPERATOR_LOGICAL_AND );
+    ASSERT_EQ( collectionSchemeTest.getCondition()->left->left->nodeType, ExpressionNodeType::OPERATOR_EQUAL );
+    ASSERT_EQ( collectionSchemeTest.getCondition()->left->left->left->nodeType, ExpressionNodeType::SIGNAL );
+    ASSERT_EQ( collectionSchemeTest.getCondition()->left->left->right->nodeType, ExpressionNodeType::FLOAT );
+    ASSERT_EQ( collectionSchemeTest.getCondition()->left->left->left->signalID, 19 );
+    ASSERT_EQ( collectionSchemeTest.getCondition()->left->left->right->floatingValue, 1 );
+    ASSERT_EQ( collectionSchemeTest.getCondition()->left->right->nodeType, ExpressionNodeType::OPERATOR_EQUAL );
+    ASSERT_EQ( collectionSchemeTest.getCondition()->left->right->left->nodeType, ExpressionNodeType::SIGNAL );
+    ASSERT_EQ( collectionSchemeTest.getCondition()->left->right->right->nodeType, ExpressionNodeType::FLOAT );
+    ASSERT_EQ( collectionSchemeTest.getCondition()->left->right->left->signalID, 17 );
+    ASSERT_EQ( collectionSchemeTest.getCondition()->left->right->right->floatingValue, 1 );
     // Verify Right Side
-    ASSERT_EQ( collectionSchemeTest.getAllExpressionNodes().at( 0 ).right->nodeType,
-               ExpressionNodeType::OPERATOR_SMALLER );
-    ASSERT_EQ( collectionSchemeTest.getAllExpressionNodes().at( 0 ).right->right->nodeType, ExpressionNodeType::FLOAT );
-    ASSERT_EQ( collectionSchemeTest.getAllExpressionNodes().at( 0 ).right->right->floatingValue, 30 );
-    ASSERT_EQ( collectionSchemeTest.getAllExpressionNodes().at( 0 ).right->left->nodeType, ExpressionNodeType::SIGNAL );
-    ASSERT_EQ( collectionSchemeTest.getAllExpressionNodes().at( 0 ).right->left->signalID, 3 );
+    ASSERT_EQ( collectionSchemeTest.getCondition()->right->nodeType, ExpressionNodeType::OPERATOR_SMALLER );
+    ASSERT_EQ( collectionSchemeTest.getCondition()->right->right->nodeType, ExpressionNodeType::FLOAT );
+    ASSERT_EQ( collectionSchemeTest.getCondition()->right->right->floatingValue, 30 );
+    ASSERT_EQ( collectionSchemeTest.getCondition()->right->left->nodeType, ExpressionNodeType::SIGNAL );
+    ASSERT_EQ( collectionSchemeTest.getCondition()->right->left->signalID, 3 );
 
     ASSERT_TRUE( collectionSchemeTest.getCondition()->booleanValue == false );
 }
@@ -893,19 +1357,135 @@ TEST( SchemaTest, SchemaGeohashFunctionNode )
 
     // Verify the AST
     // Verify Left Side
-    ASSERT_EQ( collectionSchemeTest.getAllExpressionNodes().size(), 6 );
-    ASSERT_EQ( collectionSchemeTest.getAllExpressionNodes().at( 0 ).nodeType, ExpressionNodeType::OPERATOR_EQUAL );
-    ASSERT_EQ( collectionSchemeTest.getAllExpressionNodes().at( 0 ).left->nodeType,
-               ExpressionNodeType::GEOHASHFUNCTION );
-    ASSERT_EQ( collectionSchemeTest.getAllExpressionNodes().at( 0 ).left->function.geohashFunction.latitudeSignalID,
-               0x01 );
-    ASSERT_EQ( collectionSchemeTest.getAllExpressionNodes().at( 0 ).left->function.geohashFunction.longitudeSignalID,
-               0x02 );
-    ASSERT_EQ( collectionSchemeTest.getAllExpressionNodes().at( 0 ).left->function.geohashFunction.precision, 6 );
-    ASSERT_EQ( collectionSchemeTest.getAllExpressionNodes().at( 0 ).left->function.geohashFunction.gpsUnitType,
+    ASSERT_EQ( collectionSchemeTest.getAllExpressionNodes().size(), 3 );
+    ASSERT_EQ( collectionSchemeTest.getCondition()->nodeType, ExpressionNodeType::OPERATOR_EQUAL );
+    ASSERT_EQ( collectionSchemeTest.getCondition()->left->nodeType, ExpressionNodeType::GEOHASHFUNCTION );
+    ASSERT_EQ( collectionSchemeTest.getCondition()->left->function.geohashFunction.latitudeSignalID, 0x01 );
+    ASSERT_EQ( collectionSchemeTest.getCondition()->left->function.geohashFunction.longitudeSignalID, 0x02 );
+    ASSERT_EQ( collectionSchemeTest.getCondition()->left->function.geohashFunction.precision, 6 );
+    ASSERT_EQ( collectionSchemeTest.getCondition()->left->function.geohashFunction.gpsUnitType,
                GeohashFunction::GPSUnitType::MILLIARCSECOND );
 
     // Verify Right Side
-    ASSERT_EQ( collectionSchemeTest.getAllExpressionNodes().at( 0 ).right->nodeType, ExpressionNodeType::FLOAT );
-    ASSERT_EQ( collectionSchemeTest.getAllExpressionNodes().at( 0 ).right->floatingValue, 1.0 );
+    ASSERT_EQ( collectionSchemeTest.getCondition()->right->nodeType, ExpressionNodeType::FLOAT );
+    ASSERT_EQ( collectionSchemeTest.getCondition()->right->floatingValue, 1.0 );
+}
+
+TEST( SchemaTest, SchemaGeofenceFunctionNode )
+{
+    CollectionSchemesMsg::CollectionScheme collectionSchemeTestMessage;
+    collectionSchemeTestMessage.set_campaign_arn( "arn:aws:iam::2.23606797749:user/Development/product_1235/*" );
+    collectionSchemeTestMessage.set_decoder_manifest_arn( "model_manifest_13" );
+    collectionSchemeTestMessage.set_start_time_ms_epoch( 162144816000 );
+    collectionSchemeTestMessage.set_expiry_time_ms_epoch( 262144816000 );
+    CollectionSchemesMsg::ConditionBasedCollectionScheme *message =
+        collectionSchemeTestMessage.mutable_condition_based_collection_scheme();
+    message->set_condition_minimum_interval_ms( 650 );
+    message->set_condition_language_version( 20 );
+
+    // Root: GeofenceFunction with a circle, a triangle and an invalid polygon
+    auto *geofenceFunction = message->mutable_condition_tree()->mutable_node_function()->mutable_geofence_function();
+    geofenceFunction->set_latitude_signal_id( 0x1 );
+    geofenceFunction->set_longitude_signal_id( 0x2 );
+    geofenceFunction->set_gps_unit(
+        CollectionSchemesMsg::ConditionNode_NodeFunction_GeohashFunction_GPSUnitType_DECIMAL_DEGREE );
+    auto *circle = geofenceFunction->add_geofences()->mutable_circle();
+    circle->mutable_center()->set_latitude( 47.620623 );
+    circle->mutable_center()->set_longitude( -122.348920 );
+    circle->set_radius_meters( 200 );
+    auto *triangle = geofenceFunction->add_geofences()->mutable_polygon();
+    for ( const auto &corner : std::vector<std::pair<double, double>>{
+              { 37.37, -122.05 }, { 37.37, -122.04 }, { 37.38, -122.04 } } )
+    {
+        auto *vertex = triangle->add_vertices();
+        vertex->set_latitude( corner.first );
+        vertex->set_longitude( corner.second );
+    }
+    geofenceFunction->add_geofences()->mutable_polygon()->add_vertices()->set_latitude( 1 );
+
+    std::string protoSerializedBuffer;
+    ASSERT_TRUE( collectionSchemeTestMessage.SerializeToString( &protoSerializedBuffer ) );
+    CollectionSchemeIngestion collectionSchemeTest;
+    ASSERT_TRUE( collectionSchemeTest.copyData(
+        std::make_shared<CollectionSchemesMsg::CollectionScheme>( collectionSchemeTestMessage ) ) );
+    ASSERT_TRUE( collectionSchemeTest.build() );
+    ASSERT_TRUE( collectionSchemeTest.isReady() );
+
+    const auto *condition = collectionSchemeTest.getCondition();
+    ASSERT_NE( condition, nullptr );
+    ASSERT_EQ( condition->nodeType, ExpressionNodeType::GEOFENCEFUNCTION );
+    ASSERT_EQ( condition->function.geofenceFunction.latitudeSignalID, 0x01 );
+    ASSERT_EQ( condition->function.geofenceFunction.longitudeSignalID, 0x02 );
+    ASSERT_EQ( condition->function.geofenceFunction.gpsUnitType, GeohashFunction::GPSUnitType::DECIMAL_DEGREE );
+    const auto &geofences = condition->function.geofenceFunction.geofences;
+    ASSERT_NE( geofences, nullptr );
+    // The invalid polygon is ignored
+    ASSERT_EQ( geofences->size(), 2 );
+    ASSERT_TRUE( geofences->contains( 47.620623, -122.348920 ) );
+    ASSERT_TRUE( geofences->contains( 37.371392, -122.046208 ) );
+    ASSERT_FALSE( geofences->contains( 37.379, -122.049 ) );
+}
+
+TEST( SchemaTest, SchemaRawFrameFieldNode )
+{
+    CollectionSchemesMsg::CollectionScheme collectionSchemeTestMessage;
+    collectionSchemeTestMessage.set_campaign_arn( "arn:aws:iam::2.23606797749:user/Development/product_1235/*" );
+    collectionSchemeTestMessage.set_decoder_manifest_arn( "model_manifest_13" );
+    collectionSchemeTestMessage.set_start_time_ms_epoch( 162144816000 );
+    collectionSchemeTestMessage.set_expiry_time_ms_epoch( 262144816000 );
+    auto *rawCanFrame = collectionSchemeTestMessage.add_raw_can_frames_to_collect();
+    rawCanFrame->set_can_interface_id( "1" );
+    rawCanFrame->set_can_message_id( 0x380 );
+    rawCanFrame->set_sample_buffer_size( 10 );
+    CollectionSchemesMsg::ConditionBasedCollectionScheme *message =
+        collectionSchemeTestMessage.mutable_condition_based_collection_scheme();
+    message->set_condition_minimum_interval_ms( 650 );
+    message->set_condition_language_version( 20 );
+
+    // Root: a field of the collected frame 0x380 is bigger than a field of the frame 0x381
+    auto *root = message->mutable_condition_tree()->mutable_node_operator();
+    root->set_operator_( CollectionSchemesMsg::ConditionNode_NodeOperator_Operator_COMPARE_BIGGER );
+    auto *left = root->mutable_left_child()->mutable_node_raw_frame_field();
+    left->set_can_interface_id( "1" );
+    left->set_can_message_id( 0x380 );
+    left->set_start_bit( 8 );
+    left->set_length( 16 );
+    auto *right = root->mutable_right_child()->mutable_node_raw_frame_field();
+    right->set_can_interface_id( "1" );
+    right->set_can_message_id( 0x381 );
+    right->set_start_bit( 7 );
+    right->set_length( 4 );
+    right->set_is_big_endian( true );
+    right->set_is_signed( true );
+
+    CollectionSchemeIngestion collectionSchemeTest;
+    ASSERT_TRUE( collectionSchemeTest.copyData(
+        std::make_shared<CollectionSchemesMsg::CollectionScheme>( collectionSchemeTestMessage ) ) );
+    ASSERT_TRUE( collectionSchemeTest.build() );
+    ASSERT_TRUE( collectionSchemeTest.isReady() );
+
+    const auto *condition = collectionSchemeTest.getCondition();
+    ASSERT_NE( condition, nullptr );
+    ASSERT_EQ( condition->nodeType, ExpressionNodeType::OPERATOR_BIGGER );
+    ASSERT_EQ( condition->left->nodeType, ExpressionNodeType::RAWFRAMEFIELD );
+    ASSERT_EQ( condition->left->function.rawFrameField.interfaceID, "1" );
+    ASSERT_EQ( condition->left->function.rawFrameField.frameID, 0x380 );
+    ASSERT_EQ( condition->left->function.rawFrameField.startBit, 8 );
+    ASSERT_EQ( condition->left->function.rawFrameField.length, 16 );
+    ASSERT_FALSE( condition->left->function.rawFrameField.isBigEndian );
+    ASSERT_EQ( condition->right->nodeType, ExpressionNodeType::RAWFRAMEFIELD );
+    ASSERT_EQ( condition->right->function.rawFrameField.frameID, 0x381 );
+    ASSERT_TRUE( condition->right->function.rawFrameField.isBigEndian );
+    ASSERT_TRUE( condition->right->function.rawFrameField.isSigned );
+
+    // The frame that is not collected by the scheme is captured for the condition only
+    const auto &rawCanFrames = collectionSchemeTest.getCollectRawCanFrames();
+    ASSERT_EQ( rawCanFrames.size(), 2 );
+    ASSERT_EQ( rawCanFrames[0].frameID, 0x380 );
+    ASSERT_EQ( rawCanFrames[0].sampleBufferSize, 10 );
+    ASSERT_FALSE( rawCanFrames[0].isConditionOnlyFrame );
+    ASSERT_EQ( rawCanFrames[1].frameID, 0x381 );
+    ASSERT_EQ( rawCanFrames[1].interfaceID, "1" );
+    ASSERT_EQ( rawCanFrames[1].sampleBufferSize, 1 );
+    ASSERT_TRUE( rawCanFrames[1].isConditionOnlyFrame );
 }
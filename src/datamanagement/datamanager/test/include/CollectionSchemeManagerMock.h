@@ -79,12 +79,12 @@ public:
     }
 
     void
-    setTimeLine( const std::priority_queue<TimeData, std::vector<TimeData>, std::greater<TimeData>> &TimeLine )
+    setTimeLine( const CollectionSchemeTimeLine &TimeLine )
     {
         mTimeLine = TimeLine;
     }
 
-    std::priority_queue<TimeData, std::vector<TimeData>, std::greater<TimeData>>
+    const CollectionSchemeTimeLine &
     getTimeLine()
     {
         return mTimeLine;
@@ -155,6 +155,13 @@ public:
     MOCK_METHOD( uint64_t, getExpiryTime, (), ( const ) );
 };
 
+class mockDeferredCollectionScheme : public mockCollectionScheme
+{
+public:
+    // bool buildIfDeferred() override;
+    MOCK_METHOD( bool, buildIfDeferred, () );
+};
+
 class mockDecoderManifest : public DecoderManifestIngestion
 {
 public:
@@ -89,6 +89,10 @@ public:
     VehicleDataSourceProtocol
     getNetworkProtocol( SignalID signalID ) const override
     {
+        if ( mSignalIDToDIDDecoderFormat.count( signalID ) > 0 )
+        {
+            return VehicleDataSourceProtocol::UDS;
+        }
         // a simple logic to assign network protocol type to signalID for testing purpose.
         if ( signalID < 0x1000 )
         {
@@ -112,12 +116,27 @@ public:
         }
         return NOT_FOUND_PID_DECODER_FORMAT;
     }
+    DIDSignalDecoderFormat
+    getDIDSignalDecoderFormat( SignalID signalId ) const override
+    {
+        if ( mSignalIDToDIDDecoderFormat.count( signalId ) > 0 )
+        {
+            return mSignalIDToDIDDecoderFormat.at( signalId );
+        }
+        return NOT_FOUND_DID_DECODER_FORMAT;
+    }
+    void
+    setDIDDecoderFormats( const std::unordered_map<SignalID, DIDSignalDecoderFormat> &signalIDToDIDDecoderFormat )
+    {
+        mSignalIDToDIDDecoderFormat = signalIDToDIDDecoderFormat;
+    }
 
 private:
     std::string ID;
     std::unordered_map<CANInterfaceID, std::unordered_map<CANRawFrameID, CANMessageFormat>> mFormatMap;
     std::unordered_map<SignalID, std::pair<CANRawFrameID, CANInterfaceID>> mSignalToFrameAndNodeID;
     std::unordered_map<SignalID, PIDSignalDecoderFormat> mSignalIDToPIDDecoderFormat;
+    std::unordered_map<SignalID, DIDSignalDecoderFormat> mSignalIDToDIDDecoderFormat;
 };
 class ICollectionSchemeTest : public CollectionSchemeIngestion
 {
@@ -211,6 +230,16 @@ public:
     {
         return root;
     }
+    uint32_t
+    getPriority() const override
+    {
+        return priority;
+    }
+    void
+    setPriority( uint32_t priorityIn )
+    {
+        priority = priorityIn;
+    }
     bool
     build() override
     {
@@ -218,6 +247,7 @@ public:
     }
 
 private:
+    uint32_t priority{ 0 };
     std::string collectionSchemeID;
     std::string decoderManifestID;
     uint64_t startTime;
@@ -284,6 +314,22 @@ public:
         mUpdateFlag = true;
     }
 
+    void
+    onIncrementalChangeOfActiveDictionary( ConstDecoderDictionaryConstPtr &dictionary,
+                                           VehicleDataSourceProtocol networkProtocol,
+                                           const DecoderDictionaryDiff &diff ) override
+    {
+        VehicleDataSourceBinder::onIncrementalChangeOfActiveDictionary( dictionary, networkProtocol, diff );
+        mLastDiff = diff;
+        mUpdateFlag = true;
+    }
+
+    const DecoderDictionaryDiff &
+    getLastDiff() const
+    {
+        return mLastDiff;
+    }
+
     void
     setUpdateFlag( bool flag )
     {
@@ -299,6 +345,7 @@ public:
 private:
     // This flag is used for testing whether Vehicle Data Binder received the update
     bool mUpdateFlag;
+    DecoderDictionaryDiff mLastDiff;
 };
 
 /* mock OBDOverCANModule class that receive decoder dictionary update from PM */
@@ -428,7 +475,17 @@ public:
     {
         return CollectionSchemeManager::decoderDictionaryUpdater( decoderDictionaryMap );
     }
-    const std::priority_queue<TimeData, std::vector<TimeData>, std::greater<TimeData>> &
+    static DecoderDictionaryDiff
+    decoderDictionaryDiff( const CANDecoderDictionary &previous, const CANDecoderDictionary &current )
+    {
+        return CollectionSchemeManager::decoderDictionaryDiff( previous, current );
+    }
+    static void
+    buildChannelSlices( CANDecoderDictionary &dictionary )
+    {
+        CollectionSchemeManager::buildChannelSlices( dictionary );
+    }
+    const CollectionSchemeTimeLine &
     getTimeLine()
     {
         return CollectionSchemeManager::mTimeLine;
@@ -14,6 +14,7 @@
 #pragma once
 
 // Includes
+#include "SignalTypes.h"
 #include "TimeTypes.h"
 #include "datatypes/VehicleDataSourceTypes.h"
 #include <memory>
@@ -30,18 +31,33 @@ using namespace Aws::IoTFleetWise::Platform::Linux;
 
 struct CANDecodedSignal
 {
-    CANDecodedSignal( uint32_t signalID, int64_t rawValue, double physicalValue )
+    CANDecodedSignal( uint32_t signalID,
+                      int64_t rawValue,
+                      double physicalValue,
+                      ManifestSignalIndex signalIndex = INVALID_MANIFEST_SIGNAL_INDEX )
         : mSignalID( signalID )
+        , mSignalIndex( signalIndex )
         , mRawValue( rawValue )
         , mPhysicalValue( physicalValue )
     {
     }
 
     uint32_t mSignalID;
+    ManifestSignalIndex mSignalIndex;
     int64_t mRawValue;
     double mPhysicalValue;
 };
 
+/**
+ * @brief One signal decoded from a run of frames with the same CAN ID, mPhysicalValues[i] belongs to the i-th frame
+ */
+struct CANDecodedSignalColumn
+{
+    uint32_t mSignalID{ 0 };
+    ManifestSignalIndex mSignalIndex{ INVALID_MANIFEST_SIGNAL_INDEX };
+    std::vector<double> mPhysicalValues;
+};
+
 struct CANFrameInfo
 {
     uint32_t mFrameID{ 0 };
@@ -52,11 +68,16 @@ struct CANFrameInfo
  * @brief Cloud does not send information about each CAN message, so we set every CAN message size to the maximum.
  */
 static constexpr uint8_t MAX_CAN_FRAME_BYTE_SIZE = 8;
+/**
+ * @brief Maximum payload of a CAN FD frame.
+ */
+static constexpr uint8_t MAX_CANFD_FRAME_BYTE_SIZE = 64;
 
 struct CANDecodedMessage
 {
     CANFrameInfo mFrameInfo;
     Timestamp mReceptionTime{ 0 };
+    TimestampFractionUs mReceptionTimeFractionUs{ 0 };
     Timestamp mDecodingTime{ 0 };
     VehicleDataSourceIfName mChannelIfName;
     VehicleDataSourceType mChannelType;
@@ -12,17 +12,24 @@
  */
 #pragma once
 
+#include "BoundedQueue.h"
 #include "CANDataTypes.h"
 #include "EventTypes.h"
+#include "FootprintProfile.h"
+#include "FanInQueue.h"
 #include "GeohashInfo.h"
+#include "InternedString.h"
 #include "MessageTypes.h"
 #include "OBDDataTypes.h"
 #include "SensorTypes.h"
 #include "SignalTypes.h"
-// multi producer queue:
-#include <boost/lockfree/queue.hpp>
+#include "datatypes/ImageCaptureOptions.h"
+#include <algorithm>
+#include <array>
 // single producer queue:
 #include <boost/lockfree/spsc_queue.hpp>
+#include <memory>
+#include <unordered_map>
 #include <vector>
 
 namespace Aws
@@ -39,12 +46,14 @@ namespace DataInspection
 {
 using namespace Aws::IoTFleetWise::DataManagement;
 
-static constexpr uint32_t MAX_NUMBER_OF_ACTIVE_CONDITION = 256; /**< More active conditions will be ignored */
+static constexpr uint32_t MAX_NUMBER_OF_ACTIVE_CONDITION =
+    Platform::Linux::FootprintProfile::MAX_NUMBER_OF_ACTIVE_CONDITION; /**< More active conditions will be ignored */
 static constexpr uint32_t ALL_CONDITIONS = 0xFFFFFFFF;
 static constexpr uint32_t MAX_EQUATION_DEPTH =
     10; /**< If the AST of the expression is deeper than this value the equation is not accepted */
 static constexpr uint32_t MAX_DIFFERENT_SIGNAL_IDS =
-    50000; /**< Signal IDs can be distributed over the whole range but never more than 50.000 signals in parallel */
+    Platform::Linux::FootprintProfile::MAX_DIFFERENT_SIGNAL_IDS; /**< Signal IDs can be distributed over the whole
+                                                                    range but never more signals in parallel */
 
 static constexpr double MIN_PROBABILITY = 0.0;
 static constexpr double MAX_PROBABILITY = 1.0;
@@ -54,13 +63,38 @@ static constexpr double MAX_PROBABILITY = 1.0;
 
 // The following structs describe an inspection view on all active collection conditions
 // As a start these structs are mainly a copy of the data defined in ICollectionScheme
+/**
+ * @brief Codec the collected data is compressed with if compression is enabled, the values are the codec IDs in the
+ *        compressed payload header
+ */
+enum class CompressionCodecType : uint8_t
+{
+    SNAPPY = 0,
+    LZ4 = 1,
+    ZSTD = 2
+};
+
+// Resolution per collected signal, see upload_resolution of the collection scheme
+using SignalUploadResolutions = std::unordered_map<SignalID, double>;
+
 struct PassThroughMetaData
 {
     bool compress{ false };
+    CompressionCodecType compressionCodec{ CompressionCodecType::SNAPPY };
+    // Zstandard dictionary of the decoder manifest, nullptr if the decoder manifest has none
+    std::shared_ptr<const std::string> compressionDictionary;
+    // Raw CAN frames are packed into one block instead of one message per frame
+    bool rawCanLog{ false };
     bool persist{ false };
     uint32_t priority{ 0 };
-    std::string decoderID;
-    std::string collectionSchemeID;
+    // Evaluated first and sent by the ExpressDataSender, see CollectionSchemeManager::setExpressMaxPriority
+    bool express{ false };
+    // Interned when the inspection matrix is built, so that copying the metadata into the triggered data of every
+    // event does not copy the strings
+    InternedString decoderID;
+    InternedString collectionSchemeID;
+    // Resolutions the samples are rounded to before they are sent, nullptr if no signal is rounded
+    std::shared_ptr<const SignalUploadResolutions> uploadResolutions;
 };
 
 // Camera Data collection related types
@@ -82,9 +116,42 @@ struct InspectionMatrixImageCollectionInfo
     uint32_t beforeDurationMs;                          // Amount of time in ms to be collected from the
                                                         // image sensor buffer. This time is counted before the
                                                         // condition is met. This is not relevant when the
+    VehicleNetwork::ImageCaptureOptions captureOptions; // Selection and re-encoding of the frames before they are
+                                                        // persisted
 };
 
 // As a start these structs are mainly a copy of the data defined in ICollectionScheme but as plain old data structures
+/**
+ * @brief Summaries a signal is aggregated to per fixed window instead of collecting its samples. Only the selected
+ * summaries are computed and sent.
+ */
+struct SignalAggregationInfo
+{
+    bool count{ false };
+    bool min{ false };
+    bool max{ false };
+    bool mean{ false };
+    bool variance{ false };
+    std::vector<double> histogramBounds; /**< ascending upper bounds of all buckets but the last, which is open */
+    std::vector<double> percentiles;     /**< between 0 and 100, estimated with a QuantileSketch */
+};
+
+enum class SignalDecimationMethod
+{
+    LARGEST_TRIANGLE_THREE_BUCKETS, /**< per bucket the sample spanning the largest triangle with its neighbours */
+    MIN_MAX,                        /**< per bucket the smallest and the largest sample */
+    UNIFORM                         /**< the sample closest to each point of a uniform time grid */
+};
+
+/**
+ * @brief Reduction of the collected samples of a signal to at most maxSamples that keep the shape of the waveform
+ */
+struct SignalDecimationInfo
+{
+    SignalDecimationMethod method{ SignalDecimationMethod::LARGEST_TRIANGLE_THREE_BUCKETS };
+    uint32_t maxSamples{ 0 }; /**< at least 2, collections with fewer samples are sent unchanged */
+};
+
 struct InspectionMatrixSignalCollectionInfo
 {
     SignalID signalID;
@@ -94,6 +161,11 @@ struct InspectionMatrixSignalCollectionInfo
     bool isConditionOnlySignal;       /**< Should the collected signals be sent to cloud or are the number
                                        * of samples in the buffer only necessary for condition evaluation
                                        */
+    ManifestSignalIndex signalIndex{ INVALID_MANIFEST_SIGNAL_INDEX }; /**< index in the Decoder Manifest */
+    bool deepHistory{ false }; /**< samples that do not fit into memory may be kept in a file on flash */
+    std::shared_ptr<const SignalAggregationInfo> aggregation; /**< if set, summaries per fixed window of
+                                                                 fixedWindowPeriod are collected instead of samples */
+    std::shared_ptr<const SignalDecimationInfo> decimation; /**< if set, the collected samples are decimated */
 };
 
 struct InspectionMatrixCanFrameCollectionInfo
@@ -102,6 +174,7 @@ struct InspectionMatrixCanFrameCollectionInfo
     CANChannelNumericID channelID;
     uint32_t sampleBufferSize;        /**<  at least this amount of last x raw can frames will be kept in buffer */
     uint32_t minimumSampleIntervalMs; /**<  0 which all frames are recording as seen on the bus */
+    bool isConditionOnlyFrame{ false }; /**<  only captured for the RAWFRAMEFIELD nodes of the condition, not sent */
 };
 
 struct ConditionWithCollectedData
@@ -119,6 +192,8 @@ struct ConditionWithCollectedData
     PassThroughMetaData metaData;
     std::vector<InspectionMatrixImageCollectionInfo> imageCollectionInfos;
     bool includeImageCapture;
+    uint32_t evaluationIntervalMs{ 0 }; /**< 0: evaluated with every evaluation of the inspection */
+    uint32_t evaluationBudgetUs{ 0 };   /**< 0: no CPU budget per evaluation of the inspection */
 };
 
 struct InspectionMatrix
@@ -127,29 +202,43 @@ struct InspectionMatrix
     std::vector<ExpressionNode> expressionNodeStorage; /**< A list of Expression nodes from all conditions;
                                                         * to increase performance the expressionNodes from one
                                                         * collectionScheme should be close to each other (memory
-                                                        * locality). The traversal is depth first preorder */
+                                                        * locality). The traversal is depth first postorder.
+                                                        * Identical sub expressions are stored once and can be
+                                                        * shared by multiple conditions */
 };
 
 // These values are provided by the CANDataConsumers
+// Big enough for classic CAN and CAN FD frames, only the first size bytes of data are valid
 struct CollectedCanRawFrame
 {
     CollectedCanRawFrame() = default;
     CollectedCanRawFrame( CANRawFrameID frameIDIn,
                           CANChannelNumericID channelIdIn,
                           Timestamp receiveTimeIn,
-                          std::array<uint8_t, MAX_CAN_FRAME_BYTE_SIZE> &dataIn,
+                          const uint8_t *dataIn,
                           uint8_t sizeIn )
         : frameID( frameIDIn )
         , channelId( channelIdIn )
         , receiveTime( receiveTimeIn )
-        , data( dataIn )
-        , size( sizeIn )
+        , size( std::min( sizeIn, MAX_CANFD_FRAME_BYTE_SIZE ) )
+    {
+        std::copy( dataIn, dataIn + size, data.begin() );
+    }
+    template <size_t N>
+    CollectedCanRawFrame( CANRawFrameID frameIDIn,
+                          CANChannelNumericID channelIdIn,
+                          Timestamp receiveTimeIn,
+                          const std::array<uint8_t, N> &dataIn,
+                          uint8_t sizeIn )
+        : CollectedCanRawFrame(
+              frameIDIn, channelIdIn, receiveTimeIn, dataIn.data(), std::min( sizeIn, static_cast<uint8_t>( N ) ) )
     {
     }
     CANRawFrameID frameID{ INVALID_CAN_FRAME_ID };
     CANChannelNumericID channelId{ INVALID_CAN_SOURCE_NUMERIC_ID };
     Timestamp receiveTime{ 0 };
-    std::array<uint8_t, MAX_CAN_FRAME_BYTE_SIZE> data{};
+    TimestampFractionUs receiveTimeFractionUs{ 0 }; /**< microseconds within the millisecond of receiveTime */
+    std::array<uint8_t, MAX_CANFD_FRAME_BYTE_SIZE> data{};
     uint8_t size{ 0 };
 };
 
@@ -175,19 +264,55 @@ struct CollectedSignal
 
     MessageID messageID{ INVALID_MESSAGE_ID }; // Note that this is a vehicle message ID in the AbstractDataSouce.
     SignalID signalID{ INVALID_SIGNAL_ID };
+    ManifestSignalIndex signalIndex{
+        INVALID_MANIFEST_SIGNAL_INDEX }; /**< set by sources decoding with the Decoder Manifest, the inspection then
+                                            finds the signal without looking up the sparse signalID */
     Timestamp receiveTime{ 0 };
+    TimestampFractionUs receiveTimeFractionUs{ 0 }; /**< microseconds within the millisecond of receiveTime */
+    uint32_t traceId{ 0 }; /**< LatencyTracer trace of the frame the signal was decoded from, 0 if not traced */
     double value{ 0.0 };
 };
 
+/**
+ * @brief Raw frame of a RAW_AND_DECODE CAN message together with the signals decoded from it. The frame and its
+ * signals are pushed to the CAN Buffer as one element, so they are queued once and the inspection gets them at
+ * the same time. Messages with more collected signals than MAX_DECODED_SIGNALS push their signals to the Signal
+ * Buffer instead.
+ */
+struct CollectedCanFrameWithSignals : public CollectedCanRawFrame
+{
+    static constexpr uint8_t MAX_DECODED_SIGNALS = 8;
+
+    struct DecodedSignal
+    {
+        SignalID signalID{ INVALID_SIGNAL_ID };
+        ManifestSignalIndex signalIndex{ INVALID_MANIFEST_SIGNAL_INDEX };
+        double value{ 0.0 };
+    };
+
+    CollectedCanFrameWithSignals() = default;
+    // Frames of RAW messages are pushed without signals
+    CollectedCanFrameWithSignals( const CollectedCanRawFrame &frame ) // NOLINT(google-explicit-constructor)
+        : CollectedCanRawFrame( frame )
+    {
+    }
+
+    uint32_t traceId{ 0 }; /**< LatencyTracer trace of the frame, 0 if not traced */
+    uint8_t decodedSignalCount{ 0 };
+    std::array<DecodedSignal, MAX_DECODED_SIGNALS> decodedSignals{}; /**< only the first decodedSignalCount are valid,
+                                                                        they have the receive time of the frame */
+};
+
 using SignalBuffer =
-    boost::lockfree::queue<CollectedSignal>; /**<  multi NetworkChannel Consumers fill this queue and only one instance
-                                                of the Inspection and Collection Engine consumes it. It is used for Can
-                                                and OBD based signals */
+    FanInQueue<CollectedSignal>; /**<  multi NetworkChannel Consumers fill this queue and only one instance
+                                    of the Inspection and Collection Engine consumes it. It is used for Can
+                                    and OBD based signals. Each producer pushes to an own ring */
 using CANBuffer =
-    boost::lockfree::queue<CollectedCanRawFrame>; /**<  contains only raw can messages which at least one
-                                                     collectionScheme needs to publish in a raw format. multi
-                                                     NetworkChannel Consumers fill this queue and only one instance of
-                                                     the Inspection and Collection Engine consumes it */
+    FanInQueue<CollectedCanFrameWithSignals>; /**<  contains only raw can messages which at least one
+                                                 collectionScheme needs to publish in a raw format, with the decoded
+                                                 signals of RAW_AND_DECODE messages. multi NetworkChannel Consumers
+                                                 fill this queue and only one instance of the Inspection and
+                                                 Collection Engine consumes it. Each producer pushes to an own ring */
 using ActiveDTCBuffer =
     boost::lockfree::spsc_queue<DTCInfo>; /**<  Set of currently active DTCs. produced by OBD NetworkChannel Consumer
                                              and consumed by Inspection and CollectionEngine */
@@ -195,20 +320,105 @@ using ActiveDTCBuffer =
 // Shared Pointer type to the buffer that send data to Collection Engine
 using SignalBufferPtr = std::shared_ptr<SignalBuffer>;
 using CANBufferPtr = std::shared_ptr<CANBuffer>;
+// Ring of a single producer of the Signal or CAN Buffer
+using SignalBufferProducerPtr = SignalBuffer::RingPtr;
+using CANBufferProducerPtr = CANBuffer::RingPtr;
 using ActiveDTCBufferPtr = std::shared_ptr<ActiveDTCBuffer>;
 
 // Output of collection Inspection Engine
 
+/**
+ * @brief Samples of a signal history buffer of the inspection engine, shared with the triggered data that references
+ * them. The engine copies a chunk before it writes into it while the chunk is still referenced, so referenced chunks
+ * never change.
+ */
+struct SignalSampleChunk
+{
+    static constexpr uint32_t SIZE = 64;
+    std::array<double, SIZE> values{};
+    std::array<int32_t, SIZE> timestampOffsets{}; /**< relative to the timestamp epoch of the buffer */
+    std::array<TimestampFractionUs, SIZE> timestampFractionsUs{};
+};
+
+/**
+ * @brief The newest samples of one signal, referencing the chunks of the history buffer instead of copying them
+ */
+struct SignalSnapshot
+{
+    SignalID signalID{ INVALID_SIGNAL_ID };
+    Timestamp timestampEpoch{ 0 };
+    uint32_t bufferSize{ 0 };     /**< number of samples in the ring buffer */
+    uint32_t newestPosition{ 0 }; /**< position of the newest sample in the ring buffer */
+    uint32_t sampleCount{ 0 };
+    std::vector<std::shared_ptr<const SignalSampleChunk>> chunks; /**< only the chunks holding the samples are set */
+
+    /**
+     * @brief Returns a sample of the snapshot
+     * @param index 0 for the newest sample up to sampleCount - 1 for the oldest
+     * @return the sample
+     */
+    CollectedSignal
+    getSample( uint32_t index ) const
+    {
+        auto position = ( newestPosition + bufferSize - index ) % bufferSize;
+        const auto &chunk = *chunks[position / SignalSampleChunk::SIZE];
+        auto offset = position % SignalSampleChunk::SIZE;
+        CollectedSignal sample(
+            signalID,
+            static_cast<Timestamp>( static_cast<int64_t>( timestampEpoch ) + chunk.timestampOffsets[offset] ),
+            chunk.values[offset] );
+        sample.receiveTimeFractionUs = chunk.timestampFractionsUs[offset];
+        return sample;
+    }
+};
+
+/**
+ * @brief A collection event whose data is merged into the data of another event triggered at the same time, so that
+ * the samples both events collect are only sent once
+ */
+struct SharedCollectionEvent
+{
+    InternedString collectionSchemeID;
+    Timestamp triggerTime{ 0 };
+    EventID eventID{ 0 };
+    std::vector<SignalID> signalIDs;         /**< signals collected by the event */
+    std::vector<CANRawFrameID> canFrameIDs; /**< raw CAN frames collected by the event */
+};
+
+/**
+ * @brief Summary of the samples of a signal in one fixed window, the fields not selected by the
+ * SignalAggregationInfo are 0 or empty
+ */
+struct SignalSummary
+{
+    SignalID signalID{ INVALID_SIGNAL_ID };
+    Timestamp windowStartTime{ 0 }; /**< milliseconds since epoch */
+    uint32_t windowSizeMs{ 0 };
+    uint32_t count{ 0 };
+    double min{ 0.0 };
+    double max{ 0.0 };
+    double mean{ 0.0 };
+    double variance{ 0.0 }; /**< population variance */
+    std::vector<uint32_t> histogramCounts;
+    std::vector<double> percentileValues;
+};
+
 struct TriggeredCollectionSchemeData
 {
     PassThroughMetaData metaData;
     Timestamp triggerTime;
     std::vector<CollectedSignal> signals;
+    std::vector<SignalSnapshot> signalSnapshots; /**< only used if the engine references signal samples instead of
+                                                  * copying them to signals */
     std::vector<CollectedCanRawFrame> canFrames;
+    std::vector<SignalSummary> signalSummaries; /**< of the aggregated signals, which have no samples in signals */
     DTCInfo mDTCInfo;
     GeohashInfo mGeohashInfo; // Because Geohash is not a physical signal from VSS, we decided to not using SignalID for
     // geohash. In future we might introduce virtual signal concept which will include geohash.
     EventID eventID;
+    uint32_t traceId{ 0 }; /**< LatencyTracer trace of a collected signal, 0 if none of them is traced */
+    std::vector<SharedCollectionEvent> sharedEvents; /**< further events the samples are also collected for, only used
+                                                      * if the engine shares payloads */
 };
 
 using TriggeredCollectionSchemeDataPtr = std::shared_ptr<const TriggeredCollectionSchemeData>;
@@ -216,6 +426,10 @@ using CollectedDataReadyToPublish =
     boost::lockfree::spsc_queue<TriggeredCollectionSchemeDataPtr>; /**< produced by Inspection and Collection Engine
                                                                       consumed by Sender to cloud. As the data can be
                                                                       big only a shared_ptr is handed over*/
+using ExpressCollectedData =
+    Platform::Linux::BoundedQueue<TriggeredCollectionSchemeDataPtr>; /**< collected data of the express collection
+                                                                        schemes, produced by all inspection threads
+                                                                        and consumed by the ExpressDataSender */
 
 } // namespace DataInspection
 } // namespace IoTFleetWise
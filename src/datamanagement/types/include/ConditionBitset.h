@@ -0,0 +1,199 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataInspection
+{
+/**
+ * @brief Bitset with one bit per condition that is sized at runtime.
+ *
+ * The bits are stored in 64 bit words that can be accessed directly, so that a combination of multiple sets
+ * can be walked word by word and only the set bits are visited. Bits beyond size() are always zero.
+ */
+class ConditionBitset
+{
+public:
+    using Word = uint64_t;
+    static constexpr size_t BITS_PER_WORD = 64;
+
+    ConditionBitset() = default;
+    explicit ConditionBitset( size_t size )
+    {
+        resize( size );
+    }
+
+    /**
+     * @brief Changes the number of bits, new bits are zero
+     */
+    void
+    resize( size_t size )
+    {
+        mSize = size;
+        mWords.resize( ( size + BITS_PER_WORD - 1 ) / BITS_PER_WORD, 0 );
+        clearUnusedBits();
+    }
+
+    size_t
+    size() const
+    {
+        return mSize;
+    }
+
+    size_t
+    wordCount() const
+    {
+        return mWords.size();
+    }
+
+    Word
+    word( size_t index ) const
+    {
+        return mWords[index];
+    }
+
+    bool
+    test( size_t bit ) const
+    {
+        return ( bit < mSize ) && ( ( mWords[bit / BITS_PER_WORD] & mask( bit ) ) != 0 );
+    }
+
+    void
+    set( size_t bit )
+    {
+        if ( bit < mSize )
+        {
+            mWords[bit / BITS_PER_WORD] |= mask( bit );
+        }
+    }
+
+    void
+    reset( size_t bit )
+    {
+        if ( bit < mSize )
+        {
+            mWords[bit / BITS_PER_WORD] &= ~mask( bit );
+        }
+    }
+
+    /**
+     * @brief Sets all bits
+     */
+    void
+    set()
+    {
+        for ( auto &w : mWords )
+        {
+            w = ~Word{ 0 };
+        }
+        clearUnusedBits();
+    }
+
+    /**
+     * @brief Resets all bits
+     */
+    void
+    reset()
+    {
+        for ( auto &w : mWords )
+        {
+            w = 0;
+        }
+    }
+
+    bool
+    none() const
+    {
+        for ( auto w : mWords )
+        {
+            if ( w != 0 )
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool
+    all() const
+    {
+        for ( size_t i = 0; i < mWords.size(); i++ )
+        {
+            if ( mWords[i] != usedBits( i ) )
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Index of the lowest bit set in a word
+     * @param w word that must not be 0
+     */
+    static uint32_t
+    lowestSetBit( Word w )
+    {
+#if defined( __GNUC__ )
+        return static_cast<uint32_t>( __builtin_ctzll( w ) );
+#else
+        uint32_t bit = 0;
+        while ( ( w & 1U ) == 0 )
+        {
+            w >>= 1U;
+            bit++;
+        }
+        return bit;
+#endif
+    }
+
+private:
+    static Word
+    mask( size_t bit )
+    {
+        return Word{ 1 } << ( bit % BITS_PER_WORD );
+    }
+
+    // The bits of word index that are below size
+    Word
+    usedBits( size_t index ) const
+    {
+        size_t bits = mSize - ( index * BITS_PER_WORD );
+        return ( bits >= BITS_PER_WORD ) ? ~Word{ 0 } : ( ( Word{ 1 } << bits ) - 1 );
+    }
+
+    void
+    clearUnusedBits()
+    {
+        if ( !mWords.empty() )
+        {
+            mWords.back() &= usedBits( mWords.size() - 1 );
+        }
+    }
+
+    std::vector<Word> mWords;
+    size_t mSize{ 0 };
+};
+
+} // namespace DataInspection
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -0,0 +1,224 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+#include "MemoryArena.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <boost/lockfree/spsc_queue.hpp>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataInspection
+{
+/**
+ * @brief Bounded multi producer, single consumer queue built from one wait-free SPSC ring per producer.
+ *
+ * Every producer thread registers once with addProducer and pushes into its own ring, so producers never
+ * contend on a shared queue head. The single consumer pops round robin over all rings. The order of elements
+ * is kept per producer, elements of different producers are interleaved.
+ */
+template <typename T>
+class FanInQueue
+{
+public:
+    // The rings are allocated from the MemoryArena if one is reserved. They hold decoded data, so they count into
+    // the decoding memory
+    using Allocator = Platform::Linux::ArenaAllocator<T, Platform::Linux::MemorySubsystem::DECODING>;
+    using Ring = boost::lockfree::spsc_queue<T, boost::lockfree::allocator<Allocator>>;
+    using RingPtr = std::shared_ptr<Ring>;
+
+    // Maximum number of producers that can register
+    static constexpr size_t MAX_PRODUCERS = 64;
+
+    /**
+     * @param capacity maximum number of elements in the ring of each producer
+     */
+    explicit FanInQueue( size_t capacity )
+        : mCapacity( capacity )
+    {
+    }
+
+    FanInQueue( const FanInQueue & ) = delete;
+    FanInQueue &operator=( const FanInQueue & ) = delete;
+    FanInQueue( FanInQueue && ) = delete;
+    FanInQueue &operator=( FanInQueue && ) = delete;
+
+    /**
+     * @brief Creates the ring of a new producer. Can be called from any thread, also while the consumer pops.
+     * @return the ring to push to from exactly one thread, nullptr if MAX_PRODUCERS rings exist already
+     */
+    RingPtr
+    addProducer()
+    {
+        std::lock_guard<std::mutex> lock( mProducersMutex );
+        auto count = mProducerCount.load( std::memory_order_relaxed );
+        if ( count >= MAX_PRODUCERS )
+        {
+            return nullptr;
+        }
+        mRings[count] = std::allocate_shared<Ring>( typename Allocator::template rebind<Ring>::other(), mCapacity );
+        mProducerCount.store( count + 1, std::memory_order_release );
+        return mRings[count];
+    }
+
+    /**
+     * @brief Pushes to a ring that is registered on the first call. Only for a single producer that has no own
+     * ring, all threads that push concurrently must register with addProducer.
+     * @param element element to push
+     * @return False if the ring is full or no ring can be registered
+     */
+    bool
+    push( const T &element )
+    {
+        if ( mDefaultRing == nullptr )
+        {
+            mDefaultRing = addProducer();
+            if ( mDefaultRing == nullptr )
+            {
+                return false;
+            }
+        }
+        return mDefaultRing->push( element );
+    }
+
+    /**
+     * @brief Pops the next element, continuing with the ring after the one of the last popped element.
+     * Must only be called from the consumer thread.
+     * @param element the popped element
+     * @return False if all rings are empty
+     */
+    bool
+    pop( T &element )
+    {
+        auto count = mProducerCount.load( std::memory_order_acquire );
+        for ( size_t i = 0; i < count; i++ )
+        {
+            auto index = mNextRing;
+            mNextRing = ( index + 1 < count ) ? ( index + 1 ) : 0;
+            if ( mRings[index]->pop( element ) )
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Pops up to maxCount elements of one ring at once, continuing with the ring after the one of the last
+     * popped elements. The ring indices are only updated once for all elements, so producers that push several
+     * elements at once with Ring::push( const T *, size_t ) are consumed without a queue operation per element.
+     * Must only be called from the consumer thread.
+     * @param elements array of at least maxCount elements for the popped elements
+     * @param maxCount maximum number of elements to pop
+     * @return number of popped elements, 0 if all rings are empty
+     */
+    size_t
+    pop( T *elements, size_t maxCount )
+    {
+        auto count = mProducerCount.load( std::memory_order_acquire );
+        for ( size_t i = 0; i < count; i++ )
+        {
+            auto index = mNextRing;
+            mNextRing = ( index + 1 < count ) ? ( index + 1 ) : 0;
+            auto popped = mRings[index]->pop( elements, maxCount );
+            if ( popped > 0 )
+            {
+                return popped;
+            }
+        }
+        return 0;
+    }
+
+    /**
+     * @brief Checks if all rings are empty. Must only be called from the consumer thread.
+     * @return True if there is nothing to pop
+     */
+    bool
+    empty() const
+    {
+        auto count = mProducerCount.load( std::memory_order_acquire );
+        for ( size_t i = 0; i < count; i++ )
+        {
+            if ( mRings[i]->read_available() > 0 )
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Returns the number of registered producers
+     * @return number of rings
+     */
+    /**
+     * @brief Returns the number of elements in all rings. Can be called from any thread for monitoring, the result
+     * is only approximate while elements are pushed and popped.
+     * @return number of queued elements
+     */
+    size_t
+    getOccupancy() const
+    {
+        size_t occupancy = 0;
+        auto count = mProducerCount.load( std::memory_order_acquire );
+        for ( size_t i = 0; i < count; i++ )
+        {
+            occupancy += mRings[i]->read_available();
+        }
+        return occupancy;
+    }
+
+    /**
+     * @brief Returns the number of elements in the fullest ring. Like getOccupancy only approximate, but comparable
+     * to the capacity as every producer is limited by its own ring.
+     * @return number of elements queued by the producer with the most elements
+     */
+    size_t
+    getMaxRingOccupancy() const
+    {
+        size_t occupancy = 0;
+        auto count = mProducerCount.load( std::memory_order_acquire );
+        for ( size_t i = 0; i < count; i++ )
+        {
+            occupancy = std::max( occupancy, mRings[i]->read_available() );
+        }
+        return occupancy;
+    }
+
+    size_t
+    getProducerCount() const
+    {
+        return mProducerCount.load( std::memory_order_acquire );
+    }
+
+private:
+    size_t mCapacity;
+    std::mutex mProducersMutex;
+    // Rings are only appended and never replaced, so the consumer reads the first mProducerCount without a lock
+    std::array<RingPtr, MAX_PRODUCERS> mRings;
+    std::atomic<size_t> mProducerCount{ 0 };
+    size_t mNextRing{ 0 };
+    RingPtr mDefaultRing;
+};
+
+} // namespace DataInspection
+} // namespace IoTFleetWise
+} // namespace Aws
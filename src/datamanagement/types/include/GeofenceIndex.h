@@ -0,0 +1,157 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataInspection
+{
+
+/**
+ * @brief Set of geofences, circles and polygons, with a spatial index to find out whether a position is inside
+ * any of them.
+ *
+ * The fences are first added with addCircle and addPolygon, then build packs their bounding boxes into an R-tree
+ * with the Sort-Tile-Recursive algorithm. A lookup with contains only checks the fences whose bounding box
+ * contains the position, which takes O(log n) for fences that do not overlap each other.
+ *
+ * Polygons are defined in the latitude / longitude plane and must not cross the antimeridian.
+ */
+class GeofenceIndex
+{
+public:
+    /**
+     * @brief Position in Decimal Degree
+     */
+    struct Coordinate
+    {
+        double latitude{ 0 };
+        double longitude{ 0 };
+    };
+
+    // Maximum number of children of a node of the R-tree
+    static constexpr size_t NODE_CAPACITY = 8;
+    // Mean earth radius used for the distance to the center of circles
+    static constexpr double EARTH_RADIUS_METERS = 6371008.8;
+
+    /**
+     * @brief Adds a circular fence. Must be called before build.
+     * @param centerLatitude latitude of the center in Decimal Degree
+     * @param centerLongitude longitude of the center in Decimal Degree
+     * @param radiusMeters radius of the circle in meters
+     * @return false if the center is not a valid position or the radius is not positive
+     */
+    bool addCircle( double centerLatitude, double centerLongitude, double radiusMeters );
+
+    /**
+     * @brief Adds a polygon fence. Must be called before build.
+     * @param vertices corners of the polygon in Decimal Degree, the last corner is connected to the first one
+     * @return false if the polygon has less than 3 corners or one of them is not a valid position
+     */
+    bool addPolygon( const std::vector<Coordinate> &vertices );
+
+    /**
+     * @brief Builds the spatial index over all added fences. Must be called once after all fences are added and
+     * before the first call to contains.
+     */
+    void build();
+
+    /**
+     * @brief Checks whether a position is inside any of the fences
+     * @param latitude latitude in Decimal Degree
+     * @param longitude longitude in Decimal Degree
+     * @return true if the position is inside at least one fence
+     */
+    bool contains( double latitude, double longitude ) const;
+
+    /**
+     * @brief Returns the number of fences
+     */
+    size_t
+    size() const
+    {
+        return mFences.size();
+    }
+
+private:
+    struct BoundingBox
+    {
+        double latMin{ 0 };
+        double latMax{ 0 };
+        double lonMin{ 0 };
+        double lonMax{ 0 };
+
+        bool
+        contains( double latitude, double longitude ) const
+        {
+            return ( latitude >= latMin ) && ( latitude <= latMax ) && ( longitude >= lonMin ) &&
+                   ( longitude <= lonMax );
+        }
+    };
+
+    struct Fence
+    {
+        BoundingBox box;
+        bool isCircle{ false };
+        Coordinate center;
+        double radiusMeters{ 0 };
+        // Range of the corners of a polygon in mVertices
+        uint32_t firstVertex{ 0 };
+        uint32_t vertexCount{ 0 };
+    };
+
+    /**
+     * @brief Node of the R-tree. The children of a node on level 0 are the fences firstChild to
+     * firstChild + childCount - 1, the children of a node on a higher level are nodes of the level below.
+     */
+    struct TreeNode
+    {
+        BoundingBox box;
+        uint32_t firstChild{ 0 };
+        uint32_t childCount{ 0 };
+    };
+
+    /**
+     * @brief Sorts the boxes into the Sort-Tile-Recursive order: vertical slices by longitude, each slice by
+     * latitude, so that each run of NODE_CAPACITY boxes is spatially close.
+     * @return the indices of the boxes in this order
+     */
+    static std::vector<uint32_t> sortTileRecursive( const std::vector<BoundingBox> &boxes );
+
+    /**
+     * @brief Groups consecutive runs of NODE_CAPACITY boxes into nodes
+     */
+    static std::vector<TreeNode> packNodes( const std::vector<BoundingBox> &boxes );
+
+    bool nodeContains( size_t level, uint32_t nodeIndex, double latitude, double longitude ) const;
+
+    bool fenceContains( const Fence &fence, double latitude, double longitude ) const;
+
+    static bool isValidPosition( double latitude, double longitude );
+
+    std::vector<Fence> mFences;
+    std::vector<Coordinate> mVertices;
+    // Levels of the R-tree, the leaves are level 0 and the last level holds only the root
+    std::vector<std::vector<TreeNode>> mLevels;
+};
+
+} // namespace DataInspection
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -13,6 +13,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <string>
 
 namespace Aws
@@ -42,6 +43,18 @@ public:
      * @return True if encode is successful, false is encode failed due to input
      */
     static bool encode( double lat, double lon, uint8_t precision, uint64_t &hashBits );
+    /**
+     * @brief Reference encoding function producing the same hash bits as encode by bisecting the latitude and
+     * longitude ranges with floating point midpoints one bit at a time.
+     * encode instead quantizes both coordinates to fixed point integers and interleaves their bits, which gives
+     * the same result apart from positions within rounding error of a cell edge.
+     * @param lat: latitude in Decimal Degree
+     * @param lon: longitude in Decimal Degree
+     * @param precision: In Geohash, precision is the length of hash character.
+     * @param hashBits: pass by reference. Function will set its value with the calculated Geohash
+     * @return True if encode is successful, false is encode failed due to input
+     */
+    static bool encodeWithBisection( double lat, double lon, uint8_t precision, uint64_t &hashBits );
     /**
      * @brief Encoding function that takes latitude and longitude and precision and output Geohash
      * in String (base 32) format.
@@ -52,12 +65,44 @@ public:
      * @return True if encode is successful, false is encode failed due to input
      */
     static bool encode( double lat, double lon, uint8_t precision, std::string &hashString );
+    /**
+     * @brief Converts Geohash bits as returned by encode to the Geohash String (base 32) format.
+     * @param hashBits: Geohash in bits format
+     * @param precision: number of hash characters contained in hashBits
+     * @param hashString: pass by reference. Function will set its value with the Geohash string
+     */
+    static void toString( uint64_t hashBits, uint8_t precision, std::string &hashString );
+    /**
+     * @brief Calculates the rectangle covered by a Geohash cell. All positions with
+     * latMin <= lat < latMax and lonMin <= lon < lonMax are encoded to this cell.
+     * @param hashBits: Geohash in bits format as returned by encode
+     * @param precision: number of hash characters contained in hashBits
+     * @param latMin: pass by reference. Set to the southern edge of the cell
+     * @param latMax: pass by reference. Set to the northern edge of the cell
+     * @param lonMin: pass by reference. Set to the western edge of the cell
+     * @param lonMax: pass by reference. Set to the eastern edge of the cell
+     */
+    static void getCellBounds(
+        uint64_t hashBits, uint8_t precision, double &latMin, double &latMax, double &lonMin, double &lonMax );
 
     // In GeoHash, precision is specified by the length of hash. 9 characters hash can specify a
     // rectangle area of 4.77m X 4.77m. Here we defined the maximum precision as 9 characters.
     static constexpr uint8_t MAX_PRECISION = 9;
 
 private:
+    /**
+     * @brief Spreads the 32 bits of value to the even bit positions of the result
+     */
+    static uint64_t spreadBits( uint32_t value );
+    /**
+     * @brief Reverse of spreadBits, collects the even bit positions of value
+     */
+    static uint32_t compactBits( uint64_t value );
+    /**
+     * @brief Quantizes value in [min, max] to a 32 bit fixed point fraction of the range
+     */
+    static uint32_t quantize( double value, double min, double max );
+
     // number of bits in Base32 character
     static constexpr uint8_t BASE32_BITS = 5;
     // minimum Latitude
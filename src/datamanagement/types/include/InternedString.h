@@ -0,0 +1,147 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <string>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataInspection
+{
+/**
+ * @brief Immutable string that is stored once per distinct value in a process wide table.
+ *
+ * Copies share the stored string, so copying it only changes a reference count. Constructing one from a string looks
+ * it up in the table under a lock, which should happen when a configuration like the inspection matrix is built and
+ * not per collected sample. Equal values always share the same stored string, so they are compared by pointer. The
+ * stored string is released with its last copy.
+ */
+class InternedString
+{
+public:
+    /**
+     * @brief Empty string, does not lock the table
+     */
+    InternedString();
+
+    // Implicit, so that the strings of a configuration can be assigned directly
+    InternedString( const std::string &value ); // NOLINT(google-explicit-constructor)
+    InternedString( const char *value );        // NOLINT(google-explicit-constructor)
+
+    const std::string &
+    str() const
+    {
+        return *mValue;
+    }
+
+    operator const std::string &() const // NOLINT(google-explicit-constructor)
+    {
+        return *mValue;
+    }
+
+    const char *
+    c_str() const
+    {
+        return mValue->c_str();
+    }
+
+    const char *
+    data() const
+    {
+        return mValue->data();
+    }
+
+    size_t
+    size() const
+    {
+        return mValue->size();
+    }
+
+    bool
+    empty() const
+    {
+        return mValue->empty();
+    }
+
+    /**
+     * @brief Number of distinct strings in the table, including released ones not yet purged. Only for testing.
+     */
+    static size_t getTableSize();
+
+    friend bool
+    operator==( const InternedString &a, const InternedString &b )
+    {
+        return a.mValue == b.mValue;
+    }
+
+private:
+    std::shared_ptr<const std::string> mValue;
+};
+
+inline bool
+operator!=( const InternedString &a, const InternedString &b )
+{
+    return !( a == b );
+}
+
+inline bool
+operator==( const InternedString &a, const std::string &b )
+{
+    return a.str() == b;
+}
+
+inline bool
+operator==( const std::string &a, const InternedString &b )
+{
+    return a == b.str();
+}
+
+inline bool
+operator==( const InternedString &a, const char *b )
+{
+    return a.str() == b;
+}
+
+inline bool
+operator!=( const InternedString &a, const std::string &b )
+{
+    return !( a == b );
+}
+
+inline bool
+operator!=( const std::string &a, const InternedString &b )
+{
+    return !( a == b );
+}
+
+inline bool
+operator!=( const InternedString &a, const char *b )
+{
+    return !( a == b );
+}
+
+inline std::ostream &
+operator<<( std::ostream &stream, const InternedString &value )
+{
+    return stream << value.str();
+}
+
+} // namespace DataInspection
+} // namespace IoTFleetWise
+} // namespace Aws
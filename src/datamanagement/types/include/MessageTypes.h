@@ -88,6 +88,66 @@ public:
     }
 };
 
+/**
+ * @brief Decoding rule of one signal with all constants needed to extract it from a frame precomputed.
+ *
+ * The signal is extracted from one 64 bit word loaded at mLoadOffset from the frame, in Motorola byte order
+ * for big endian signals: raw = ( ( word >> mShift ) & mMask ), followed by sign extension with mSignMask.
+ */
+struct CANSignalDecodeStep
+{
+    SignalID mSignalID{ INVALID_SIGNAL_ID };
+    ManifestSignalIndex mSignalIndex{ INVALID_MANIFEST_SIGNAL_INDEX };
+    uint8_t mLoadOffset{ 0 };   /**< first byte of the frame loaded into the 64 bit word */
+    uint8_t mShift{ 0 };        /**< position of the least significant bit of the signal in the word */
+    bool mIsBigEndian{ false }; /**< the word is loaded in Motorola byte order */
+    bool mUseSlowPath{ false }; /**< the signal spans more than 8 bytes and is extracted byte by byte */
+    uint8_t mMultiplexorValue{ UINT8_MAX };
+    bool mIsSigned{ false };
+    bool mCollect{ true }; /**< false for a multiplexor which is not collected itself */
+    uint16_t mFirstBitPosition{ 0 }; /**< only used by the slow path */
+    uint16_t mSizeInBits{ 0 };       /**< only used by the slow path */
+    uint16_t mMinFrameSize{ 0 };     /**< frames with less bytes do not contain the signal. UINT16_MAX if the signal
+                                         layout is invalid */
+    uint64_t mMask{ 0 };
+    uint64_t mSignMask{ 0 }; /**< 0 for unsigned signals */
+    double mFactor{ 0 };
+    double mOffset{ 0 };
+};
+
+/**
+ * @brief CANMessageFormat compiled once for fast decoding of every received frame.
+ *
+ * mSteps only contains the signals to be collected, in the order of CANMessageFormat::mSignals. The
+ * multiplexor is always contained, if it is not collected its mCollect is false.
+ */
+struct CANMessageDecodePlan
+{
+    static constexpr size_t NO_MULTIPLEXOR = SIZE_MAX;
+    static constexpr size_t MULTIPLEXOR_VALUE_COUNT = UINT8_MAX + 1;
+
+    uint32_t mMessageID{ 0x0 };
+    bool mIsMultiplexed{ false };
+    size_t mMultiplexorStep{ NO_MULTIPLEXOR }; /**< index of the multiplexor signal in mSteps */
+    std::vector<CANSignalDecodeStep> mSteps;
+    /** Only filled if there is a multiplexor. Indices into mSteps of the collected signals, grouped by their
+         MUX value and in the order of mSteps inside a group */
+    std::vector<uint32_t> mMultiplexedSteps;
+    /** MULTIPLEXOR_VALUE_COUNT + 1 offsets into mMultiplexedSteps, the signals of MUX value v are in
+         [mMultiplexedStepsBegin[v], mMultiplexedStepsBegin[v + 1]) */
+    std::vector<uint32_t> mMultiplexedStepsBegin;
+
+    /**
+     * @brief Check if the plan contains at least one signal
+     * @return True if valid, false otherwise.
+     */
+    inline bool
+    isValid() const
+    {
+        return !mSteps.empty();
+    }
+};
+
 } // namespace DataManagement
 } // namespace IoTFleetWise
 } // namespace Aws
\ No newline at end of file
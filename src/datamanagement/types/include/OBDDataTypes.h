@@ -21,6 +21,7 @@
 #include <map>
 #include <memory>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 // Default Keep Alive Interval.
 #define OBD_KEEP_ALIVE_SECONDS 2
@@ -753,10 +754,20 @@ struct DTCInfo
     SID mSID{ SID::INVALID_SERVICE_MODE };
     Timestamp receiveTime{ 0 };
     std::vector<std::string> mDTCCodes;
+    // Version of the set of active DTCs, incremented by the OBD module every time the set changes. 0 if the set is
+    // not versioned.
+    uint32_t mSequenceNumber{ 0 };
+    // Only in the Active DTC Buffer: if set, mDTCCodes are the codes added and mRemovedDTCCodes the codes removed
+    // since the set with mSequenceNumber - 1
+    bool mIsDelta{ false };
+    std::vector<std::string> mRemovedDTCCodes;
+    // Only in collected data: if set, the codes are omitted because the set with mSequenceNumber was already
+    // collected by the same condition
+    bool mIsUnchanged{ false };
     bool
     hasItems() const
     {
-        return !mDTCCodes.empty();
+        return !mDTCCodes.empty() || ( mSequenceNumber != 0 );
     }
 };
 
@@ -766,7 +777,9 @@ struct DTCInfo
 struct EmissionInfo
 {
     SID mSID;
-    std::map<uint32_t, SignalValue> mPIDsToValues;
+    // Signal IDs and physical values in the order they were decoded. A flat vector, so that an EmissionInfo reused
+    // for every response only allocates until its capacity fits the largest response.
+    std::vector<std::pair<uint32_t, SignalValue>> mSignals;
 };
 
 // A collection of OBD Data per ECU ( DTC + E
@@ -803,6 +816,25 @@ enum class DTCDomains
 // VIN Request
 static constexpr OBDRequest vehicleIdentificationNumberRequest = { static_cast<SID>( 0x09 ), static_cast<PID>( 0x02 ) };
 
+// UDS data identifier and the services to read it
+using DID = uint16_t;
+static constexpr uint8_t UDS_READ_DATA_BY_IDENTIFIER = 0x22;
+static constexpr uint8_t UDS_READ_DATA_BY_PERIODIC_IDENTIFIER = 0x2A;
+static constexpr uint8_t UDS_PERIODIC_STOP_SENDING = 0x04;
+// Periodic DIDs are in the range 0xF200 to 0xF2FF and identified on the bus by their low byte
+static constexpr DID UDS_PERIODIC_DID_BASE = 0xF200;
+
+/**
+ * @brief Key of a DID in the UDS decoder dictionary. The channel of the UDS decoder dictionary is the request CAN ID
+ * of the ECU holding the DID. The key holds the DID in the low 16 bits and the ReadDataByPeriodicIdentifier
+ * transmission mode above, which is 0 for DIDs that are read on request.
+ */
+inline constexpr uint32_t
+toUDSDictionaryKey( DID did, uint8_t transmissionMode )
+{
+    return ( static_cast<uint32_t>( transmissionMode ) << 16U ) | did;
+}
+
 } // namespace DataManagement
 } // namespace IoTFleetWise
 } // namespace Aws
@@ -47,6 +47,76 @@ const CANInterfaceID INVALID_CAN_INTERFACE_ID{};
 using SignalID = uint32_t;
 static constexpr SignalID INVALID_SIGNAL_ID = 0xFFFFFFFF;
 
+/**
+ * @brief Dense index of a signal assigned when the Decoder Manifest is built, from 0 to the number of signals - 1.
+ * Unlike the sparse Signal ID it can index flat arrays. It is only valid together with the Signal ID it was assigned
+ * to, as a new Decoder Manifest assigns new indexes.
+ */
+using ManifestSignalIndex = uint32_t;
+static constexpr ManifestSignalIndex INVALID_MANIFEST_SIGNAL_INDEX = 0xFFFFFFFF;
+
+/**
+ * @brief Decides which decoded values of a signal are passed on to the inspection
+ */
+enum class SignalEmissionPolicyType
+{
+    ALWAYS,            /**< every decoded value */
+    ON_CHANGE,         /**< values different from the last passed on value */
+    ABSOLUTE_DEADBAND, /**< values differing by more than mDeadband from the last passed on value */
+    RELATIVE_DEADBAND  /**< values differing by more than mDeadband * |last passed on value| */
+};
+
+/**
+ * @brief Emission policy of a signal, applied directly after decoding
+ */
+struct SignalEmissionPolicy
+{
+    SignalEmissionPolicyType mType{ SignalEmissionPolicyType::ALWAYS };
+
+    /**
+     * @brief Absolute or relative deadband, only used by the deadband types
+     */
+    double mDeadband{ 0 };
+
+    /**
+     * @brief If not 0 a value is passed on regardless of mType if the last passed on value is at least
+     * this many milliseconds old
+     */
+    uint32_t mMaxSilenceMs{ 0 };
+
+    /**
+     * @brief Check if values can be dropped at all
+     * @return True if every value is passed on, false otherwise.
+     */
+    inline bool
+    isAlways() const
+    {
+        return mType == SignalEmissionPolicyType::ALWAYS;
+    }
+
+    /**
+     * @brief Overloaded == operator for SignalEmissionPolicy.
+     * @param other Other SignalEmissionPolicy to compare to.
+     * @return True if ==, false otherwise.
+     */
+    bool
+    operator==( const SignalEmissionPolicy &other ) const
+    {
+        return mType == other.mType && mDeadband == other.mDeadband && mMaxSilenceMs == other.mMaxSilenceMs;
+    }
+
+    /**
+     * @brief Overloaded != operator for SignalEmissionPolicy.
+     * @param other Other SignalEmissionPolicy to compare to.
+     * @return True if !=, false otherwise.
+     */
+    bool
+    operator!=( const SignalEmissionPolicy &other ) const
+    {
+        return !( *this == other );
+    }
+};
+
 /**
  * @brief Format that defines a CAN Signal Format
  */
@@ -57,6 +127,12 @@ struct CANSignalFormat
      */
     uint32_t mSignalID{ 0x0 };
 
+    /**
+     * @brief Index of the signal in the Decoder Manifest. Not part of the decoding rule, so not compared and not
+     * persisted with the decoder dictionary.
+     */
+    ManifestSignalIndex mSignalIndex{ INVALID_MANIFEST_SIGNAL_INDEX };
+
     /**
      * @brief Bool specifying endianness of data
      */
@@ -97,6 +173,11 @@ struct CANSignalFormat
      */
     uint8_t mMultiplexorValue{ UINT8_MAX };
 
+    /**
+     * @brief Which decoded values are passed on to the inspection
+     */
+    SignalEmissionPolicy mEmissionPolicy;
+
     /**
      * @brief Check if Signal is a multiplexer signal.
      * @return True if multiplier signal, false otherwise.
@@ -118,7 +199,8 @@ struct CANSignalFormat
         return mSignalID == other.mSignalID && mIsBigEndian == other.mIsBigEndian && mIsSigned == other.mIsSigned &&
                mFirstBitPosition == other.mFirstBitPosition && mSizeInBits == other.mSizeInBits &&
                mOffset == other.mOffset && mFactor == other.mFactor &&
-               mIsMultiplexorSignal == other.mIsMultiplexorSignal && mMultiplexorValue == other.mMultiplexorValue;
+               mIsMultiplexorSignal == other.mIsMultiplexorSignal && mMultiplexorValue == other.mMultiplexorValue &&
+               mEmissionPolicy == other.mEmissionPolicy;
     }
 
     /**
@@ -0,0 +1,279 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "GeofenceIndex.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataInspection
+{
+
+constexpr size_t GeofenceIndex::NODE_CAPACITY;
+
+static constexpr double PI = 3.14159265358979323846;
+
+static double
+toRadians( double degrees )
+{
+    return degrees * PI / 180.0;
+}
+
+static double
+toDegrees( double radians )
+{
+    return radians * 180.0 / PI;
+}
+
+bool
+GeofenceIndex::isValidPosition( double latitude, double longitude )
+{
+    // All comparisons with NaN are false, so NaN is rejected as well
+    return ( latitude >= -90.0 ) && ( latitude <= 90.0 ) && ( longitude >= -180.0 ) && ( longitude <= 180.0 );
+}
+
+bool
+GeofenceIndex::addCircle( double centerLatitude, double centerLongitude, double radiusMeters )
+{
+    if ( ( !isValidPosition( centerLatitude, centerLongitude ) ) || ( !( radiusMeters > 0.0 ) ) )
+    {
+        return false;
+    }
+    Fence fence;
+    fence.isCircle = true;
+    fence.center.latitude = centerLatitude;
+    fence.center.longitude = centerLongitude;
+    fence.radiusMeters = radiusMeters;
+    auto angularRadius = radiusMeters / EARTH_RADIUS_METERS;
+    auto latitudeRadius = toDegrees( angularRadius );
+    fence.box.latMin = std::max( -90.0, centerLatitude - latitudeRadius );
+    fence.box.latMax = std::min( 90.0, centerLatitude + latitudeRadius );
+    fence.box.lonMin = -180.0;
+    fence.box.lonMax = 180.0;
+    // Circles around a pole or across the antimeridian keep the full longitude range
+    auto sinLongitudeRadius = std::sin( angularRadius ) / std::cos( toRadians( centerLatitude ) );
+    if ( ( fence.box.latMin > -90.0 ) && ( fence.box.latMax < 90.0 ) && ( angularRadius < PI / 2 ) &&
+         ( sinLongitudeRadius < 1.0 ) )
+    {
+        auto longitudeRadius = toDegrees( std::asin( sinLongitudeRadius ) );
+        if ( ( centerLongitude - longitudeRadius >= -180.0 ) && ( centerLongitude + longitudeRadius <= 180.0 ) )
+        {
+            fence.box.lonMin = centerLongitude - longitudeRadius;
+            fence.box.lonMax = centerLongitude + longitudeRadius;
+        }
+    }
+    mFences.push_back( fence );
+    return true;
+}
+
+bool
+GeofenceIndex::addPolygon( const std::vector<Coordinate> &vertices )
+{
+    if ( vertices.size() < 3 )
+    {
+        return false;
+    }
+    Fence fence;
+    fence.box.latMin = 90.0;
+    fence.box.latMax = -90.0;
+    fence.box.lonMin = 180.0;
+    fence.box.lonMax = -180.0;
+    for ( const auto &vertex : vertices )
+    {
+        if ( !isValidPosition( vertex.latitude, vertex.longitude ) )
+        {
+            return false;
+        }
+        fence.box.latMin = std::min( fence.box.latMin, vertex.latitude );
+        fence.box.latMax = std::max( fence.box.latMax, vertex.latitude );
+        fence.box.lonMin = std::min( fence.box.lonMin, vertex.longitude );
+        fence.box.lonMax = std::max( fence.box.lonMax, vertex.longitude );
+    }
+    fence.firstVertex = static_cast<uint32_t>( mVertices.size() );
+    fence.vertexCount = static_cast<uint32_t>( vertices.size() );
+    mVertices.insert( mVertices.end(), vertices.begin(), vertices.end() );
+    mFences.push_back( fence );
+    return true;
+}
+
+std::vector<uint32_t>
+GeofenceIndex::sortTileRecursive( const std::vector<BoundingBox> &boxes )
+{
+    std::vector<uint32_t> order( boxes.size() );
+    for ( uint32_t i = 0; i < order.size(); i++ )
+    {
+        order[i] = i;
+    }
+    auto nodeCount = ( boxes.size() + NODE_CAPACITY - 1 ) / NODE_CAPACITY;
+    auto sliceCount = static_cast<size_t>( std::ceil( std::sqrt( static_cast<double>( nodeCount ) ) ) );
+    auto sliceSize = std::max<size_t>( 1, sliceCount ) * NODE_CAPACITY;
+    std::sort( order.begin(), order.end(), [&boxes]( uint32_t a, uint32_t b ) {
+        return ( boxes[a].lonMin + boxes[a].lonMax ) < ( boxes[b].lonMin + boxes[b].lonMax );
+    } );
+    for ( size_t sliceStart = 0; sliceStart < order.size(); sliceStart += sliceSize )
+    {
+        auto sliceEnd = std::min( order.size(), sliceStart + sliceSize );
+        std::sort( order.begin() + static_cast<std::ptrdiff_t>( sliceStart ),
+                   order.begin() + static_cast<std::ptrdiff_t>( sliceEnd ),
+                   [&boxes]( uint32_t a, uint32_t b ) {
+                       return ( boxes[a].latMin + boxes[a].latMax ) < ( boxes[b].latMin + boxes[b].latMax );
+                   } );
+    }
+    return order;
+}
+
+std::vector<GeofenceIndex::TreeNode>
+GeofenceIndex::packNodes( const std::vector<BoundingBox> &boxes )
+{
+    std::vector<TreeNode> nodes;
+    for ( size_t first = 0; first < boxes.size(); first += NODE_CAPACITY )
+    {
+        TreeNode node;
+        node.firstChild = static_cast<uint32_t>( first );
+        node.childCount = static_cast<uint32_t>( std::min( NODE_CAPACITY, boxes.size() - first ) );
+        node.box = boxes[first];
+        for ( size_t i = first + 1; i < first + node.childCount; i++ )
+        {
+            node.box.latMin = std::min( node.box.latMin, boxes[i].latMin );
+            node.box.latMax = std::max( node.box.latMax, boxes[i].latMax );
+            node.box.lonMin = std::min( node.box.lonMin, boxes[i].lonMin );
+            node.box.lonMax = std::max( node.box.lonMax, boxes[i].lonMax );
+        }
+        nodes.push_back( node );
+    }
+    return nodes;
+}
+
+void
+GeofenceIndex::build()
+{
+    mLevels.clear();
+    if ( mFences.empty() )
+    {
+        return;
+    }
+    // Leaves: sort the fences themselves, so that the fences of a leaf are consecutive
+    std::vector<BoundingBox> boxes;
+    for ( const auto &fence : mFences )
+    {
+        boxes.push_back( fence.box );
+    }
+    auto order = sortTileRecursive( boxes );
+    std::vector<Fence> sortedFences;
+    sortedFences.reserve( mFences.size() );
+    boxes.clear();
+    for ( auto i : order )
+    {
+        sortedFences.push_back( mFences[i] );
+        boxes.push_back( mFences[i].box );
+    }
+    mFences = std::move( sortedFences );
+    mLevels.push_back( packNodes( boxes ) );
+    // Upper levels: sort the nodes of the level below in the same way until only the root is left
+    while ( mLevels.back().size() > 1 )
+    {
+        auto &level = mLevels.back();
+        boxes.clear();
+        for ( const auto &node : level )
+        {
+            boxes.push_back( node.box );
+        }
+        order = sortTileRecursive( boxes );
+        std::vector<TreeNode> sortedNodes;
+        sortedNodes.reserve( level.size() );
+        boxes.clear();
+        for ( auto i : order )
+        {
+            sortedNodes.push_back( level[i] );
+            boxes.push_back( level[i].box );
+        }
+        level = std::move( sortedNodes );
+        auto parents = packNodes( boxes );
+        mLevels.push_back( std::move( parents ) );
+    }
+}
+
+bool
+GeofenceIndex::contains( double latitude, double longitude ) const
+{
+    if ( mLevels.empty() || ( !isValidPosition( latitude, longitude ) ) )
+    {
+        return false;
+    }
+    return nodeContains( mLevels.size() - 1, 0, latitude, longitude );
+}
+
+bool
+GeofenceIndex::nodeContains( size_t level, uint32_t nodeIndex, double latitude, double longitude ) const
+{
+    const auto &node = mLevels[level][nodeIndex];
+    if ( !node.box.contains( latitude, longitude ) )
+    {
+        return false;
+    }
+    for ( uint32_t child = node.firstChild; child < node.firstChild + node.childCount; child++ )
+    {
+        // The recursion depth is the height of the tree
+        if ( level == 0 ? fenceContains( mFences[child], latitude, longitude )
+                        : nodeContains( level - 1, child, latitude, longitude ) )
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool
+GeofenceIndex::fenceContains( const Fence &fence, double latitude, double longitude ) const
+{
+    if ( !fence.box.contains( latitude, longitude ) )
+    {
+        return false;
+    }
+    if ( fence.isCircle )
+    {
+        // Haversine formula for the great circle distance to the center
+        auto sinHalfLatitude = std::sin( toRadians( latitude - fence.center.latitude ) / 2 );
+        auto sinHalfLongitude = std::sin( toRadians( longitude - fence.center.longitude ) / 2 );
+        auto a = ( sinHalfLatitude * sinHalfLatitude ) + ( std::cos( toRadians( latitude ) ) *
+                                                           std::cos( toRadians( fence.center.latitude ) ) *
+                                                           sinHalfLongitude * sinHalfLongitude );
+        auto distance = 2 * EARTH_RADIUS_METERS * std::asin( std::min( 1.0, std::sqrt( a ) ) );
+        return distance <= fence.radiusMeters;
+    }
+    // Even-odd rule: count the edges crossed by a ray from the position towards east
+    bool inside = false;
+    const auto *vertices = &mVertices[fence.firstVertex];
+    for ( uint32_t i = 0, j = fence.vertexCount - 1; i < fence.vertexCount; j = i++ )
+    {
+        if ( ( vertices[i].latitude > latitude ) != ( vertices[j].latitude > latitude ) )
+        {
+            auto crossingLongitude = vertices[i].longitude + ( ( latitude - vertices[i].latitude ) *
+                                                               ( vertices[j].longitude - vertices[i].longitude ) /
+                                                               ( vertices[j].latitude - vertices[i].latitude ) );
+            if ( longitude < crossingLongitude )
+            {
+                inside = !inside;
+            }
+        }
+    }
+    return inside;
+}
+
+} // namespace DataInspection
+} // namespace IoTFleetWise
+} // namespace Aws
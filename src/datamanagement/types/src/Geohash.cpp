@@ -13,6 +13,9 @@
 
 // Includes
 #include "Geohash.h"
+#include <cmath>
+#include <limits>
+
 namespace Aws
 {
 namespace IoTFleetWise
@@ -25,13 +28,104 @@ static constexpr char base32Map[32] = { '0', '1', '2', '3', '4', '5', '6', '7',
                                         'c', 'd', 'e', 'f', 'g', 'h', 'j', 'k', 'm', 'n', 'p',
                                         'q', 'r', 's', 't', 'u', 'v', 'w', 'x', 'y', 'z' };
 
+// Number of values of a 32 bit fixed point fraction
+static constexpr double FIXED_POINT_SCALE = 4294967296.0;
+
+uint64_t
+Geohash::spreadBits( uint32_t value )
+{
+    // Classic magic number bit spreading: each step moves the upper half of every group apart by the group size
+    uint64_t bits = value;
+    bits = ( bits | ( bits << 16 ) ) & 0x0000FFFF0000FFFFULL;
+    bits = ( bits | ( bits << 8 ) ) & 0x00FF00FF00FF00FFULL;
+    bits = ( bits | ( bits << 4 ) ) & 0x0F0F0F0F0F0F0F0FULL;
+    bits = ( bits | ( bits << 2 ) ) & 0x3333333333333333ULL;
+    bits = ( bits | ( bits << 1 ) ) & 0x5555555555555555ULL;
+    return bits;
+}
+
+uint32_t
+Geohash::compactBits( uint64_t value )
+{
+    uint64_t bits = value & 0x5555555555555555ULL;
+    bits = ( bits | ( bits >> 1 ) ) & 0x3333333333333333ULL;
+    bits = ( bits | ( bits >> 2 ) ) & 0x0F0F0F0F0F0F0F0FULL;
+    bits = ( bits | ( bits >> 4 ) ) & 0x00FF00FF00FF00FFULL;
+    bits = ( bits | ( bits >> 8 ) ) & 0x0000FFFF0000FFFFULL;
+    bits = ( bits | ( bits >> 16 ) ) & 0x00000000FFFFFFFFULL;
+    return static_cast<uint32_t>( bits );
+}
+
+uint32_t
+Geohash::quantize( double value, double min, double max )
+{
+    auto scaled = ( value - min ) / ( max - min ) * FIXED_POINT_SCALE;
+    // The upper edge of the range belongs to the last cell like in the bisection
+    if ( scaled >= FIXED_POINT_SCALE )
+    {
+        return std::numeric_limits<uint32_t>::max();
+    }
+    return static_cast<uint32_t>( scaled );
+}
+
 bool
 Geohash::encode( double lat, double lon, uint8_t precision, uint64_t &hashBits )
 {
     // check MAX_PRECISION and BASE32_BITS validity at compile time.
-    static_assert( sizeof( hashBits ) * 8 >= MAX_PRECISION * BASE32_BITS,
-                   "Not enough bits to support maximum precision" );
+    static_assert( MAX_PRECISION * BASE32_BITS <= 64, "Not enough bits to support maximum precision" );
+
+    // Written as negated range check so that NaN is rejected as well
+    if ( precision > MAX_PRECISION || !( ( lat >= LAT_MIN ) && ( lat <= LAT_MAX ) ) ||
+         !( ( lon >= LON_MIN ) && ( lon <= LON_MAX ) ) )
+    {
+        // INVALID INPUT, need to return as we cannot proceed for calculation
+        return false;
+    }
+    if ( precision == 0 )
+    {
+        hashBits = 0;
+        return true;
+    }
+    // Each quantized coordinate holds the results of 32 bisection steps in its bits, MSb first. In Geohash the
+    // first bit is a longitude bit, so the longitude bits go to the odd positions of the interleaved word.
+    uint64_t interleaved =
+        ( spreadBits( quantize( lon, LON_MIN, LON_MAX ) ) << 1 ) | spreadBits( quantize( lat, LAT_MIN, LAT_MAX ) );
+    // Keep the first precision * 5 bits
+    hashBits = interleaved >> ( 64 - ( precision * BASE32_BITS ) );
+    return true;
+}
+
+void
+Geohash::getCellBounds(
+    uint64_t hashBits, uint8_t precision, double &latMin, double &latMax, double &lonMin, double &lonMax )
+{
+    latMin = LAT_MIN;
+    latMax = LAT_MAX;
+    lonMin = LON_MIN;
+    lonMax = LON_MAX;
+    if ( ( precision == 0 ) || ( precision > MAX_PRECISION ) )
+    {
+        return;
+    }
+    int numOfHashBits = precision * BASE32_BITS;
+    // The first bit is a longitude bit, so longitude gets the extra bit for an odd number of bits
+    int numOfLonBits = ( numOfHashBits + 1 ) / 2;
+    int numOfLatBits = numOfHashBits / 2;
+    uint64_t interleaved = hashBits << ( 64 - numOfHashBits );
+    uint32_t lonIndex = compactBits( interleaved >> 1 ) >> ( 32 - numOfLonBits );
+    uint32_t latIndex = compactBits( interleaved ) >> ( 32 - numOfLatBits );
+    // The cell sizes are powers of two fractions of the ranges, so all edges are exact
+    auto lonSize = std::ldexp( LON_MAX - LON_MIN, -numOfLonBits );
+    auto latSize = std::ldexp( LAT_MAX - LAT_MIN, -numOfLatBits );
+    lonMin = LON_MIN + lonIndex * lonSize;
+    lonMax = lonMin + lonSize;
+    latMin = LAT_MIN + latIndex * latSize;
+    latMax = latMin + latSize;
+}
 
+bool
+Geohash::encodeWithBisection( double lat, double lon, uint8_t precision, uint64_t &hashBits )
+{
     if ( precision > MAX_PRECISION || lat < LAT_MIN || lat > LAT_MAX || lon < LON_MIN || lon > LON_MAX )
     {
         // INVALID INPUT, need to return as we cannot proceed for calculation
@@ -101,10 +195,20 @@ Geohash::encode( double lat, double lon, uint8_t precision, std::string &hashStr
         // INVALID INPUT, need to return as we cannot proceed for calculation
         return false;
     }
-    hashString = "";
     uint64_t hashBits = 0;
     // First we get the Geohash in raw bits format.
-    encode( lat, lon, precision, hashBits );
+    if ( !encode( lat, lon, precision, hashBits ) )
+    {
+        return false;
+    }
+    toString( hashBits, precision, hashString );
+    return true;
+}
+
+void
+Geohash::toString( uint64_t hashBits, uint8_t precision, std::string &hashString )
+{
+    hashString.clear();
     for ( uint8_t i = 0; i < precision; ++i )
     {
         // we iterate the hash bits from left to right
@@ -113,7 +217,6 @@ Geohash::encode( double lat, double lon, uint8_t precision, std::string &hashStr
         // Convert 5-bit to base 32 format
         hashString.append( 1, base32Map[base32Num] );
     }
-    return true;
 }
 
 } // namespace DataInspection
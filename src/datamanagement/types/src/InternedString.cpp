@@ -0,0 +1,108 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "InternedString.h"
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataInspection
+{
+
+namespace
+{
+// Released strings are purged from the table once it grows beyond this size, and then twice its remaining size
+constexpr size_t MIN_PURGE_TABLE_SIZE = 64;
+
+struct InternTable
+{
+    std::mutex mutex;
+    std::unordered_map<std::string, std::weak_ptr<const std::string>> strings;
+    size_t purgeSize{ MIN_PURGE_TABLE_SIZE };
+};
+
+InternTable &
+getTable()
+{
+    // Never destroyed, so that strings held by static objects can still be released at exit
+    static auto *table = new InternTable();
+    return *table;
+}
+
+const std::shared_ptr<const std::string> &
+getEmptyString()
+{
+    static const auto *emptyString = new std::shared_ptr<const std::string>( std::make_shared<const std::string>() );
+    return *emptyString;
+}
+
+std::shared_ptr<const std::string>
+intern( const std::string &value )
+{
+    if ( value.empty() )
+    {
+        return getEmptyString();
+    }
+    auto &table = getTable();
+    std::lock_guard<std::mutex> lock( table.mutex );
+    auto &entry = table.strings[value];
+    auto interned = entry.lock();
+    if ( interned != nullptr )
+    {
+        return interned;
+    }
+    interned = std::make_shared<const std::string>( value );
+    entry = interned;
+    if ( table.strings.size() >= table.purgeSize )
+    {
+        for ( auto it = table.strings.begin(); it != table.strings.end(); )
+        {
+            it = it->second.expired() ? table.strings.erase( it ) : std::next( it );
+        }
+        table.purgeSize = std::max( MIN_PURGE_TABLE_SIZE, table.strings.size() * 2 );
+    }
+    return interned;
+}
+} // namespace
+
+InternedString::InternedString()
+    : mValue( getEmptyString() )
+{
+}
+
+InternedString::InternedString( const std::string &value )
+    : mValue( intern( value ) )
+{
+}
+
+InternedString::InternedString( const char *value )
+    : mValue( intern( value ) )
+{
+}
+
+size_t
+InternedString::getTableSize()
+{
+    auto &table = getTable();
+    std::lock_guard<std::mutex> lock( table.mutex );
+    return table.strings.size();
+}
+
+} // namespace DataInspection
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -0,0 +1,70 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+
+#include "ConditionBitset.h"
+#include <gtest/gtest.h>
+
+using namespace Aws::IoTFleetWise::DataInspection;
+
+TEST( ConditionBitsetTest, SetAndResetSingleBits )
+{
+    ConditionBitset bits( 130 );
+    ASSERT_EQ( bits.size(), 130 );
+    ASSERT_EQ( bits.wordCount(), 3 );
+    ASSERT_TRUE( bits.none() );
+    bits.set( 0 );
+    bits.set( 64 );
+    bits.set( 129 );
+    // Out of range bits are ignored
+    bits.set( 130 );
+    ASSERT_TRUE( bits.test( 0 ) );
+    ASSERT_TRUE( bits.test( 64 ) );
+    ASSERT_TRUE( bits.test( 129 ) );
+    ASSERT_FALSE( bits.test( 1 ) );
+    ASSERT_FALSE( bits.test( 130 ) );
+    ASSERT_EQ( bits.word( 2 ), 2U );
+    bits.reset( 64 );
+    ASSERT_FALSE( bits.test( 64 ) );
+    ASSERT_EQ( bits.word( 1 ), 0U );
+    ASSERT_FALSE( bits.none() );
+}
+
+TEST( ConditionBitsetTest, SetAllOnlySetsBitsBelowSize )
+{
+    ConditionBitset bits( 70 );
+    bits.set();
+    ASSERT_TRUE( bits.all() );
+    ASSERT_EQ( bits.word( 1 ), 0x3FU );
+    bits.reset( 69 );
+    ASSERT_FALSE( bits.all() );
+    bits.reset();
+    ASSERT_TRUE( bits.none() );
+
+    // Growing keeps the bits and adds zero bits
+    bits.set( 3 );
+    bits.resize( 200 );
+    ASSERT_TRUE( bits.test( 3 ) );
+    ASSERT_FALSE( bits.test( 150 ) );
+
+    ConditionBitset empty;
+    ASSERT_TRUE( empty.none() );
+    ASSERT_TRUE( empty.all() );
+}
+
+TEST( ConditionBitsetTest, LowestSetBit )
+{
+    ASSERT_EQ( ConditionBitset::lowestSetBit( 1 ), 0U );
+    ASSERT_EQ( ConditionBitset::lowestSetBit( 0x8000000000000000ULL ), 63U );
+    ASSERT_EQ( ConditionBitset::lowestSetBit( 0x30 ), 4U );
+}
@@ -0,0 +1,142 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+
+#include "FanInQueue.h"
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+using namespace Aws::IoTFleetWise::DataInspection;
+
+TEST( FanInQueueTest, PopsRoundRobinOverProducers )
+{
+    FanInQueue<int> queue( 4 );
+    ASSERT_TRUE( queue.empty() );
+    int element = 0;
+    ASSERT_FALSE( queue.pop( element ) );
+
+    auto producer1 = queue.addProducer();
+    auto producer2 = queue.addProducer();
+    ASSERT_NE( producer1, nullptr );
+    ASSERT_NE( producer2, nullptr );
+    ASSERT_EQ( queue.getProducerCount(), 2 );
+    ASSERT_TRUE( producer1->push( 10 ) );
+    ASSERT_TRUE( producer1->push( 11 ) );
+    ASSERT_TRUE( producer2->push( 20 ) );
+    ASSERT_FALSE( queue.empty() );
+
+    ASSERT_TRUE( queue.pop( element ) );
+    ASSERT_EQ( element, 10 );
+    ASSERT_TRUE( queue.pop( element ) );
+    ASSERT_EQ( element, 20 );
+    ASSERT_TRUE( queue.pop( element ) );
+    ASSERT_EQ( element, 11 );
+    ASSERT_FALSE( queue.pop( element ) );
+    ASSERT_TRUE( queue.empty() );
+}
+
+TEST( FanInQueueTest, CapacityIsBoundedPerProducer )
+{
+    FanInQueue<int> queue( 2 );
+    auto producer = queue.addProducer();
+    ASSERT_TRUE( producer->push( 1 ) );
+    ASSERT_TRUE( producer->push( 2 ) );
+    ASSERT_FALSE( producer->push( 3 ) );
+    // A full ring does not block other producers
+    ASSERT_TRUE( queue.push( 4 ) );
+    ASSERT_EQ( queue.getProducerCount(), 2 );
+}
+
+TEST( FanInQueueTest, ProducerLimit )
+{
+    FanInQueue<int> queue( 1 );
+    std::vector<FanInQueue<int>::RingPtr> producers;
+    for ( size_t i = 0; i < FanInQueue<int>::MAX_PRODUCERS; i++ )
+    {
+        producers.emplace_back( queue.addProducer() );
+        ASSERT_NE( producers.back(), nullptr );
+    }
+    ASSERT_EQ( queue.addProducer(), nullptr );
+    ASSERT_FALSE( queue.push( 1 ) );
+}
+
+TEST( FanInQueueTest, ConcurrentProducersKeepTheirOrder )
+{
+    constexpr int PRODUCERS = 4;
+    constexpr int ELEMENTS = 10000;
+    FanInQueue<int> queue( 128 );
+    std::vector<std::thread> threads;
+    for ( int p = 0; p < PRODUCERS; p++ )
+    {
+        threads.emplace_back( [&queue, p]() {
+            auto producer = queue.addProducer();
+            for ( int i = 0; i < ELEMENTS; i++ )
+            {
+                while ( !producer->push( p * ELEMENTS + i ) )
+                {
+                    std::this_thread::yield();
+                }
+            }
+        } );
+    }
+    std::vector<int> next( PRODUCERS, 0 );
+    int received = 0;
+    bool inOrder = true;
+    while ( received < PRODUCERS * ELEMENTS )
+    {
+        int element = 0;
+        if ( !queue.pop( element ) )
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        auto p = element / ELEMENTS;
+        inOrder = inOrder && ( element % ELEMENTS == next[static_cast<size_t>( p )] );
+        next[static_cast<size_t>( p )]++;
+        received++;
+    }
+    for ( auto &thread : threads )
+    {
+        thread.join();
+    }
+    ASSERT_TRUE( inOrder );
+    ASSERT_TRUE( queue.empty() );
+}
+
+TEST( FanInQueueTest, PopsBatchesOfOneProducer )
+{
+    FanInQueue<int> queue( 8 );
+    auto producer1 = queue.addProducer();
+    auto producer2 = queue.addProducer();
+    const int frame1[] = { 10, 11, 12 };
+    const int frame2[] = { 20, 21 };
+    ASSERT_EQ( producer1->push( frame1, 3 ), 3U );
+    ASSERT_EQ( producer2->push( frame2, 2 ), 2U );
+
+    int elements[8];
+    ASSERT_EQ( queue.pop( elements, 2 ), 2U );
+    ASSERT_EQ( elements[0], 10 );
+    ASSERT_EQ( elements[1], 11 );
+    // Continues with the next producer
+    ASSERT_EQ( queue.pop( elements, 8 ), 2U );
+    ASSERT_EQ( elements[0], 20 );
+    ASSERT_EQ( elements[1], 21 );
+    ASSERT_EQ( queue.pop( elements, 8 ), 1U );
+    ASSERT_EQ( elements[0], 12 );
+    ASSERT_EQ( queue.pop( elements, 8 ), 0U );
+
+    // A push that does not fit completely pushes what fits
+    const int large[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+    ASSERT_EQ( producer1->push( large, 10 ), 8U );
+}
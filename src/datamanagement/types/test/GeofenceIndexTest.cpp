@@ -0,0 +1,128 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "GeofenceIndex.h"
+#include <cmath>
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace Aws::IoTFleetWise::DataInspection;
+
+TEST( GeofenceIndexTest, EmptyIndex )
+{
+    GeofenceIndex index;
+    index.build();
+    ASSERT_EQ( index.size(), 0 );
+    ASSERT_FALSE( index.contains( 0, 0 ) );
+}
+
+TEST( GeofenceIndexTest, InvalidFences )
+{
+    GeofenceIndex index;
+    ASSERT_FALSE( index.addCircle( 91, 0, 100 ) );
+    ASSERT_FALSE( index.addCircle( 0, -181, 100 ) );
+    ASSERT_FALSE( index.addCircle( 0, 0, 0 ) );
+    ASSERT_FALSE( index.addCircle( 0, 0, std::nan( "" ) ) );
+    ASSERT_FALSE( index.addPolygon( { { 0, 0 }, { 1, 1 } } ) );
+    ASSERT_FALSE( index.addPolygon( { { 0, 0 }, { 1, 1 }, { 100, 0 } } ) );
+    index.build();
+    ASSERT_EQ( index.size(), 0 );
+}
+
+TEST( GeofenceIndexTest, Circle )
+{
+    GeofenceIndex index;
+    // 200 m around a site in Seattle
+    ASSERT_TRUE( index.addCircle( 47.620623, -122.348920, 200 ) );
+    index.build();
+    ASSERT_TRUE( index.contains( 47.620623, -122.348920 ) );
+    // One degree of latitude is about 111.2 km
+    ASSERT_TRUE( index.contains( 47.620623 + 0.0017, -122.348920 ) );
+    ASSERT_FALSE( index.contains( 47.620623 + 0.0019, -122.348920 ) );
+    // One degree of longitude is about 75 km at this latitude
+    ASSERT_TRUE( index.contains( 47.620623, -122.348920 - 0.0026 ) );
+    ASSERT_FALSE( index.contains( 47.620623, -122.348920 - 0.0028 ) );
+    ASSERT_FALSE( index.contains( std::nan( "" ), -122.348920 ) );
+}
+
+TEST( GeofenceIndexTest, CircleAcrossAntimeridianAndPole )
+{
+    GeofenceIndex index;
+    ASSERT_TRUE( index.addCircle( 0, 179.999, 1000 ) );
+    ASSERT_TRUE( index.addCircle( 89.999, 0, 1000 ) );
+    index.build();
+    ASSERT_TRUE( index.contains( 0, -179.999 ) );
+    ASSERT_FALSE( index.contains( 0, -179.9 ) );
+    ASSERT_TRUE( index.contains( 89.999, 180 ) );
+    ASSERT_FALSE( index.contains( 89.9, 90 ) );
+}
+
+TEST( GeofenceIndexTest, ConcavePolygon )
+{
+    GeofenceIndex index;
+    // L shaped depot: the square from 0 to 2 without the upper right quarter
+    ASSERT_TRUE( index.addPolygon( { { 0, 0 }, { 2, 0 }, { 2, 1 }, { 1, 1 }, { 1, 2 }, { 0, 2 } } ) );
+    index.build();
+    ASSERT_TRUE( index.contains( 0.5, 0.5 ) );
+    ASSERT_TRUE( index.contains( 1.5, 0.5 ) );
+    ASSERT_TRUE( index.contains( 0.5, 1.5 ) );
+    ASSERT_FALSE( index.contains( 1.5, 1.5 ) );
+    ASSERT_FALSE( index.contains( -0.5, 0.5 ) );
+    ASSERT_FALSE( index.contains( 2.5, 2.5 ) );
+}
+
+/** @brief Compares the lookup in the R-tree with checking every fence for hundreds of sites
+ */
+TEST( GeofenceIndexTest, ManyFences )
+{
+    GeofenceIndex index;
+    std::vector<GeofenceIndex> singleFences( 500 );
+    for ( size_t i = 0; i < singleFences.size(); i++ )
+    {
+        // Sites on a 0.1 degree grid, every other site is a square polygon, the others are circles of 500 m
+        double latitude = 40.0 + static_cast<double>( i / 50 ) * 0.1;
+        double longitude = -100.0 + static_cast<double>( i % 50 ) * 0.1;
+        if ( i % 2 == 0 )
+        {
+            ASSERT_TRUE( index.addCircle( latitude, longitude, 500 ) );
+            ASSERT_TRUE( singleFences[i].addCircle( latitude, longitude, 500 ) );
+        }
+        else
+        {
+            std::vector<GeofenceIndex::Coordinate> square = { { latitude - 0.01, longitude - 0.01 },
+                                                              { latitude - 0.01, longitude + 0.01 },
+                                                              { latitude + 0.01, longitude + 0.01 },
+                                                              { latitude + 0.01, longitude - 0.01 } };
+            ASSERT_TRUE( index.addPolygon( square ) );
+            ASSERT_TRUE( singleFences[i].addPolygon( square ) );
+        }
+        singleFences[i].build();
+    }
+    index.build();
+    ASSERT_EQ( index.size(), singleFences.size() );
+    size_t insideCount = 0;
+    for ( double latitude = 39.95; latitude < 41.05; latitude += 0.0093 )
+    {
+        for ( double longitude = -100.05; longitude < -95.05; longitude += 0.0473 )
+        {
+            bool expected = false;
+            for ( const auto &fence : singleFences )
+            {
+                expected = expected || fence.contains( latitude, longitude );
+            }
+            ASSERT_EQ( index.contains( latitude, longitude ), expected ) << latitude << ", " << longitude;
+            insideCount += expected ? 1 : 0;
+        }
+    }
+    ASSERT_GT( insideCount, 0 );
+}
@@ -0,0 +1,86 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "Geohash.h"
+#include <benchmark/benchmark.h>
+#include <utility>
+#include <vector>
+
+using namespace Aws::IoTFleetWise::DataInspection;
+
+static std::vector<std::pair<double, double>>
+createPositions( size_t positionCount )
+{
+    // A vehicle driving north east in small steps
+    std::vector<std::pair<double, double>> positions;
+    for ( size_t i = 0; i < positionCount; i++ )
+    {
+        positions.emplace_back( 37.371392 + static_cast<double>( i ) * 0.0001,
+                                -122.046208 + static_cast<double>( i ) * 0.0001 );
+    }
+    return positions;
+}
+
+static void
+BM_encodeWithBisection( benchmark::State &state )
+{
+    auto positions = createPositions( 1000 );
+    for ( auto _ : state )
+    {
+        for ( const auto &position : positions )
+        {
+            uint64_t hashBits = 0;
+            Geohash::encodeWithBisection(
+                position.first, position.second, static_cast<uint8_t>( state.range( 0 ) ), hashBits );
+            benchmark::DoNotOptimize( hashBits );
+        }
+    }
+    state.SetItemsProcessed( state.iterations() * static_cast<int64_t>( positions.size() ) );
+}
+BENCHMARK( BM_encodeWithBisection )->Arg( 5 )->Arg( Geohash::MAX_PRECISION );
+
+static void
+BM_encode( benchmark::State &state )
+{
+    auto positions = createPositions( 1000 );
+    for ( auto _ : state )
+    {
+        for ( const auto &position : positions )
+        {
+            uint64_t hashBits = 0;
+            Geohash::encode( position.first, position.second, static_cast<uint8_t>( state.range( 0 ) ), hashBits );
+            benchmark::DoNotOptimize( hashBits );
+        }
+    }
+    state.SetItemsProcessed( state.iterations() * static_cast<int64_t>( positions.size() ) );
+}
+BENCHMARK( BM_encode )->Arg( 5 )->Arg( Geohash::MAX_PRECISION );
+
+static void
+BM_encodeString( benchmark::State &state )
+{
+    auto positions = createPositions( 1000 );
+    std::string hashString;
+    for ( auto _ : state )
+    {
+        for ( const auto &position : positions )
+        {
+            Geohash::encode( position.first, position.second, Geohash::MAX_PRECISION, hashString );
+            benchmark::DoNotOptimize( hashString.data() );
+        }
+    }
+    state.SetItemsProcessed( state.iterations() * static_cast<int64_t>( positions.size() ) );
+}
+BENCHMARK( BM_encodeString );
+
+BENCHMARK_MAIN();
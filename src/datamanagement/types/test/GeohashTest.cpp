@@ -12,7 +12,10 @@
  */
 
 #include "Geohash.h"
+#include <cmath>
 #include <gtest/gtest.h>
+#include <utility>
+#include <vector>
 
 using namespace Aws::IoTFleetWise::DataInspection;
 
@@ -85,3 +88,82 @@ TEST( GeohashTest, GeohashEncodeWithValidInput )
     ASSERT_TRUE( Geohash::encode( 90, 180, 8, hashBits ) );
     ASSERT_EQ( hashBits, 1099511627775 );
 }
+
+/** @brief This test aims to check that the fixed point encoder yields the same Geohash bits as the
+ *  bisection encoder for positions all over the world and for all precisions.
+ */
+TEST( GeohashTest, GeohashEncodeMatchesBisection )
+{
+    // Simple linear congruential generator to get reproducible positions
+    uint64_t state = 12345;
+    auto nextRandom = [&state]() {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<double>( state >> 11 ) / 9007199254740992.0;
+    };
+    std::vector<std::pair<double, double>> positions = {
+        { 37.371392, -122.046208 }, { 0, 0 }, { -90, -180 }, { 90, 180 }, { -45, 90 }, { 45, -90 } };
+    for ( int i = 0; i < 10000; ++i )
+    {
+        positions.emplace_back( nextRandom() * 180.0 - 90.0, nextRandom() * 360.0 - 180.0 );
+    }
+    for ( const auto &position : positions )
+    {
+        for ( uint8_t precision = 0; precision <= Geohash::MAX_PRECISION; ++precision )
+        {
+            uint64_t hashBits = 0;
+            uint64_t expectedHashBits = 0;
+            ASSERT_TRUE( Geohash::encode( position.first, position.second, precision, hashBits ) );
+            ASSERT_TRUE( Geohash::encodeWithBisection( position.first, position.second, precision, expectedHashBits ) );
+            ASSERT_EQ( hashBits, expectedHashBits ) << position.first << ", " << position.second;
+        }
+    }
+}
+
+/** @brief This test aims to check that NaN coordinates are rejected
+ */
+TEST( GeohashTest, GeohashEncodeWithNaN )
+{
+    uint64_t hashBits = 0;
+    ASSERT_FALSE( Geohash::encode( std::nan( "" ), -4.329004883, 9, hashBits ) );
+    ASSERT_FALSE( Geohash::encode( -23, std::nan( "" ), 9, hashBits ) );
+}
+
+/** @brief This test aims to check that the cell bounds of a Geohash contain the encoded position
+ *  and that the edges of the cell are encoded to the right cells.
+ */
+TEST( GeohashTest, GeohashCellBounds )
+{
+    uint64_t hashBits = 0;
+    double latMin = 0;
+    double latMax = 0;
+    double lonMin = 0;
+    double lonMax = 0;
+    ASSERT_TRUE( Geohash::encode( 37.371392, -122.046208, 9, hashBits ) );
+    Geohash::getCellBounds( hashBits, 9, latMin, latMax, lonMin, lonMax );
+    ASSERT_LE( latMin, 37.371392 );
+    ASSERT_GT( latMax, 37.371392 );
+    ASSERT_LE( lonMin, -122.046208 );
+    ASSERT_GT( lonMax, -122.046208 );
+    // 9 characters have 23 longitude and 22 latitude bits
+    ASSERT_DOUBLE_EQ( lonMax - lonMin, 360.0 / ( 1 << 23 ) );
+    ASSERT_DOUBLE_EQ( latMax - latMin, 180.0 / ( 1 << 22 ) );
+
+    uint64_t edgeHashBits = 0;
+    ASSERT_TRUE( Geohash::encode( latMin, lonMin, 9, edgeHashBits ) );
+    ASSERT_EQ( edgeHashBits, hashBits );
+    ASSERT_TRUE( Geohash::encode( latMax, lonMin, 9, edgeHashBits ) );
+    ASSERT_NE( edgeHashBits, hashBits );
+    ASSERT_TRUE( Geohash::encode( latMin, lonMax, 9, edgeHashBits ) );
+    ASSERT_NE( edgeHashBits, hashBits );
+
+    std::string hash;
+    Geohash::toString( hashBits, 9, hash );
+    ASSERT_EQ( hash, "9q9hwg28j" );
+
+    // Precision 0 covers the whole world
+    Geohash::getCellBounds( 0, 0, latMin, latMax, lonMin, lonMax );
+    ASSERT_EQ( latMin, -90.0 );
+    ASSERT_EQ( latMax, 90.0 );
+    ASSERT_EQ( lonMin, -180.0 );
+    ASSERT_EQ( lonMax, 180.0 );
+}
@@ -0,0 +1,73 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "InternedString.h"
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace Aws::IoTFleetWise::DataInspection;
+
+TEST( InternedStringTest, EqualValuesShareOneString )
+{
+    InternedString a( std::string( "arn:aws:iotfleetwise:campaign/1" ) );
+    InternedString b( "arn:aws:iotfleetwise:campaign/1" );
+    InternedString c( "arn:aws:iotfleetwise:campaign/2" );
+    ASSERT_EQ( a, b );
+    ASSERT_EQ( a.c_str(), b.c_str() );
+    ASSERT_NE( a, c );
+    ASSERT_EQ( a, "arn:aws:iotfleetwise:campaign/1" );
+    ASSERT_EQ( std::string( "arn:aws:iotfleetwise:campaign/2" ), c );
+    ASSERT_NE( c, std::string( "arn:aws:iotfleetwise:campaign/1" ) );
+
+    // Copies only share the string
+    auto copy = a;
+    ASSERT_EQ( copy.c_str(), a.c_str() );
+    const std::string &value = copy;
+    ASSERT_EQ( value, "arn:aws:iotfleetwise:campaign/1" );
+    ASSERT_EQ( copy.size(), value.size() );
+
+    std::ostringstream stream;
+    stream << c;
+    ASSERT_EQ( stream.str(), "arn:aws:iotfleetwise:campaign/2" );
+}
+
+TEST( InternedStringTest, EmptyString )
+{
+    InternedString empty;
+    ASSERT_TRUE( empty.empty() );
+    ASSERT_EQ( empty, InternedString( "" ) );
+    ASSERT_EQ( empty, std::string() );
+    ASSERT_NE( empty, InternedString( "decoder" ) );
+}
+
+TEST( InternedStringTest, ReleasedStringsArePurged )
+{
+    {
+        std::vector<InternedString> strings;
+        for ( int i = 0; i < 1000; i++ )
+        {
+            strings.emplace_back( "temporary" + std::to_string( i ) );
+        }
+        ASSERT_GE( InternedString::getTableSize(), 1000 );
+    }
+    InternedString kept( "kept" );
+    // Interning new strings purges the released ones, so the table stays bounded
+    for ( int i = 0; i < 1000; i++ )
+    {
+        InternedString temporary( "other" + std::to_string( i ) );
+    }
+    ASSERT_LT( InternedString::getTableSize(), 1000 );
+    ASSERT_EQ( kept, InternedString( "kept" ) );
+}
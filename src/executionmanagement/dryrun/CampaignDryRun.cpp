@@ -0,0 +1,543 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "CampaignDryRun.h"
+#include "CANDataConsumer.h"
+#include "businterfaces/CANLogReplayDataSource.h"
+#include "CollectionInspectionEngine.h"
+#include "CollectionSchemeIngestionList.h"
+#include "CollectionSchemeManager.h"
+#include "DataCollectionProtoWriter.h"
+#include "DecoderManifestIngestion.h"
+#include "FastClock.h"
+#include "IInspectionInput.h"
+#include "Signal.h"
+#include "Thread.h"
+#include "collection_schemes.pb.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <thread>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace ExecutionManagement
+{
+using namespace Aws::IoTFleetWise::VehicleNetwork;
+
+namespace
+{
+// All campaigns are active from the epoch until the year 2100
+constexpr uint64_t CAMPAIGN_EXPIRY_TIME_MS = 4102444800000U;
+constexpr uint64_t MS_PER_HOUR = 3600000U;
+
+bool
+readFile( const std::string &filename, std::string &content )
+{
+    std::ifstream file( filename, std::ios::binary );
+    if ( !file )
+    {
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    content = buffer.str();
+    return true;
+}
+
+// Takes the decoder dictionary and the inspection matrix the CollectionSchemeManager extracts
+class DocumentCollector : public IActiveDecoderDictionaryListener, public IActiveConditionProcessor
+{
+public:
+    void
+    onChangeOfActiveDictionary( ConstDecoderDictionaryConstPtr &dictionary,
+                                VehicleDataSourceProtocol networkProtocol ) override
+    {
+        if ( networkProtocol != VehicleDataSourceProtocol::RAW_SOCKET )
+        {
+            return;
+        }
+        std::lock_guard<std::mutex> lock( mMutex );
+        mDictionary = dictionary;
+        mSignal.notify();
+    }
+
+    void
+    onChangeInspectionMatrix( const std::shared_ptr<const InspectionMatrix> &activeConditions ) override
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        mInspectionMatrix = activeConditions;
+        mSignal.notify();
+    }
+
+    // Returns false if the dictionary or the matrix is still missing after the timeout
+    bool
+    waitForDocuments( uint32_t timeoutMs,
+                      std::shared_ptr<const DecoderDictionary> &dictionary,
+                      std::shared_ptr<const InspectionMatrix> &inspectionMatrix )
+    {
+        auto endTimeMs = FastClock::monotonicTimeMs() + timeoutMs;
+        while ( true )
+        {
+            {
+                std::lock_guard<std::mutex> lock( mMutex );
+                if ( ( mDictionary != nullptr ) && ( mInspectionMatrix != nullptr ) &&
+                     ( !mInspectionMatrix->conditions.empty() ) )
+                {
+                    dictionary = mDictionary;
+                    inspectionMatrix = mInspectionMatrix;
+                    return true;
+                }
+            }
+            auto nowMs = FastClock::monotonicTimeMs();
+            if ( nowMs >= endTimeMs )
+            {
+                return false;
+            }
+            mSignal.wait( static_cast<uint32_t>( endTimeMs - nowMs ) );
+        }
+    }
+
+private:
+    std::mutex mMutex;
+    Platform::Linux::Signal mSignal;
+    std::shared_ptr<const DecoderDictionary> mDictionary;
+    std::shared_ptr<const InspectionMatrix> mInspectionMatrix;
+};
+
+// There is no cloud to check in with
+class CheckinSink : public SchemaListener
+{
+public:
+    bool
+    sendCheckin( const std::vector<std::string> &documentARNs ) override
+    {
+        static_cast<void>( documentARNs );
+        return true;
+    }
+};
+
+// Inspection of one log with the log time as clock, fed directly by the CANDataConsumer
+class DryRunInspection : public IInspectionInput
+{
+public:
+    DryRunInspection( const std::shared_ptr<const InspectionMatrix> &inspectionMatrix,
+                      CANInterfaceIDTranslator &canIDTranslator )
+        : mProtoWriter( canIDTranslator )
+    {
+        mEngine.setConditionProfilingEnabled( true );
+        mEngine.onChangeInspectionMatrix( inspectionMatrix );
+    }
+
+    void
+    addSignals( const CollectedSignal *signals, size_t count ) override
+    {
+        for ( size_t i = 0; i < count; i++ )
+        {
+            const auto &signal = signals[i];
+            mEngine.addNewSignal(
+                signal.signalID, signal.receiveTime, signal.value, signal.receiveTimeFractionUs, signal.signalIndex );
+            evaluateIfDue( signal.receiveTime );
+        }
+    }
+
+    void
+    addRawFrames( const CollectedCanFrameWithSignals *frames, size_t count ) override
+    {
+        for ( size_t i = 0; i < count; i++ )
+        {
+            const auto &frame = frames[i];
+            mEngine.addNewRawCanFrame( frame.frameID,
+                                       frame.channelId,
+                                       frame.receiveTime,
+                                       frame.data,
+                                       frame.size,
+                                       frame.receiveTimeFractionUs );
+            for ( uint8_t j = 0; j < frame.decodedSignalCount; j++ )
+            {
+                const auto &decodedSignal = frame.decodedSignals[j];
+                mEngine.addNewSignal( decodedSignal.signalID,
+                                      frame.receiveTime,
+                                      decodedSignal.value,
+                                      frame.receiveTimeFractionUs,
+                                      decodedSignal.signalIndex );
+            }
+            evaluateIfDue( frame.receiveTime );
+        }
+    }
+
+    // Advances the clock to the time of the frames replayed so far and takes the collected data that is ready
+    void
+    advanceTo( Timestamp time )
+    {
+        evaluateIfDue( time );
+        collect();
+    }
+
+    // Takes the data of the triggers whose after duration ends before the given time, without evaluating again
+    void
+    finish( Timestamp time )
+    {
+        mTime = std::max( mTime, time );
+        collect();
+    }
+
+    // Adds the cost of the conditions and the collected data to the results
+    void
+    takeResults( std::map<std::string, CampaignDryRunResult> &results )
+    {
+        for ( const auto &profile : mEngine.takeHotConditions( std::numeric_limits<size_t>::max() ) )
+        {
+            auto &result = results[profile.collectionSchemeID];
+            result.evaluations += profile.evaluations;
+            result.triggers += profile.triggers;
+            result.costNs += profile.getEstimatedCostNs();
+        }
+        for ( const auto &payloads : mPayloads )
+        {
+            auto &result = results[payloads.first];
+            result.payloads += payloads.second.payloads;
+            result.payloadBytes += payloads.second.payloadBytes;
+            result.signals += payloads.second.signals;
+            result.rawFrames += payloads.second.rawFrames;
+        }
+        mPayloads.clear();
+    }
+
+private:
+    void
+    evaluateIfDue( Timestamp time )
+    {
+        mTime = std::max( mTime, time );
+        if ( mEngine.getNextEvaluationTime( mTime ) <= mTime )
+        {
+            mEngine.evaluateConditions( mTime );
+        }
+    }
+
+    void
+    collect()
+    {
+        uint32_t waitTimeMs = 0;
+        for ( auto data = mEngine.collectNextDataToSend( mTime, waitTimeMs ); data != nullptr;
+              data = mEngine.collectNextDataToSend( mTime, waitTimeMs ) )
+        {
+            addPayload( data );
+        }
+    }
+
+    void
+    addPayload( const TriggeredCollectionSchemeDataPtr &data )
+    {
+        // Serialized like by the DataCollectionSender, the estimate is exact for the payload format version 0
+        mProtoWriter.setupVehicleData( data, mCollectionEventID++ );
+        for ( const auto &signal : data->signals )
+        {
+            mProtoWriter.append( signal );
+        }
+        for ( const auto &canFrame : data->canFrames )
+        {
+            mProtoWriter.append( canFrame );
+        }
+        for ( const auto &summary : data->signalSummaries )
+        {
+            mProtoWriter.append( summary );
+        }
+        auto &result = mPayloads[data->metaData.collectionSchemeID.str()];
+        result.payloads++;
+        result.payloadBytes += mProtoWriter.getEstimatedSize();
+        result.signals += data->signals.size();
+        result.rawFrames += data->canFrames.size();
+    }
+
+    CollectionInspectionEngine mEngine;
+    DataCollectionProtoWriter mProtoWriter;
+    uint32_t mCollectionEventID{ 0 };
+    Timestamp mTime{ 0 };
+    std::map<std::string, CampaignDryRunResult> mPayloads;
+};
+
+} // namespace
+
+constexpr size_t CampaignDryRun::DECODE_BATCH_SIZE;
+constexpr uint32_t CampaignDryRun::REPLAY_BUFFER_SIZE;
+constexpr uint32_t CampaignDryRun::REPLAY_WAIT_MS;
+constexpr uint32_t CampaignDryRun::DOCUMENTS_TIMEOUT_MS;
+constexpr uint32_t CampaignDryRun::END_OF_LOG_COLLECT_MS;
+
+CampaignDryRun::CampaignDryRun( CampaignDryRunConfig config )
+    : mConfig( std::move( config ) )
+{
+}
+
+bool
+CampaignDryRun::extractDocuments( const std::string &decoderManifest, const std::string &collectionSchemes )
+{
+    // The campaigns are evaluated regardless of when they are scheduled
+    Schemas::CollectionSchemesMsg::CollectionSchemes collectionSchemesMsg;
+    if ( !collectionSchemesMsg.ParseFromString( collectionSchemes ) )
+    {
+        mLogger.error( "CampaignDryRun::extractDocuments", "Failed to parse the collection schemes" );
+        return false;
+    }
+    for ( int i = 0; i < collectionSchemesMsg.collection_schemes_size(); i++ )
+    {
+        auto *collectionScheme = collectionSchemesMsg.mutable_collection_schemes( i );
+        collectionScheme->set_start_time_ms_epoch( 0 );
+        collectionScheme->set_expiry_time_ms_epoch( CAMPAIGN_EXPIRY_TIME_MS );
+    }
+    std::string activeCollectionSchemes;
+    if ( !collectionSchemesMsg.SerializeToString( &activeCollectionSchemes ) )
+    {
+        return false;
+    }
+
+    auto decoderManifestPtr = std::make_shared<DecoderManifestIngestion>();
+    auto collectionSchemeListPtr = std::make_shared<CollectionSchemeIngestionList>();
+    if ( ( !decoderManifestPtr->copyData( reinterpret_cast<const uint8_t *>( decoderManifest.data() ),
+                                          decoderManifest.size() ) ) ||
+         ( !collectionSchemeListPtr->copyData( reinterpret_cast<const uint8_t *>( activeCollectionSchemes.data() ),
+                                               activeCollectionSchemes.size() ) ) )
+    {
+        mLogger.error( "CampaignDryRun::extractDocuments", "Failed to copy the documents" );
+        return false;
+    }
+
+    auto collector = std::make_shared<DocumentCollector>();
+    CollectionSchemeManager collectionSchemeManager;
+    // Without persistency nothing is loaded from or written to the disk
+    if ( ( !collectionSchemeManager.init( 0, nullptr, mCANIDTranslator ) ) ||
+         ( !collectionSchemeManager.subscribeListener(
+             static_cast<IActiveDecoderDictionaryListener *>( collector.get() ) ) ) ||
+         ( !collectionSchemeManager.subscribeListener( static_cast<IActiveConditionProcessor *>( collector.get() ) ) ) )
+    {
+        return false;
+    }
+    collectionSchemeManager.setSchemaListenerPtr( std::make_shared<CheckinSink>() );
+    if ( !collectionSchemeManager.connect() )
+    {
+        mLogger.error( "CampaignDryRun::extractDocuments", "Failed to start the CollectionScheme Manager" );
+        return false;
+    }
+    collectionSchemeManager.onDecoderManifestUpdate( decoderManifestPtr );
+    collectionSchemeManager.onCollectionSchemeUpdate( collectionSchemeListPtr );
+    bool extracted = collector->waitForDocuments( DOCUMENTS_TIMEOUT_MS, mDecoderDictionary, mInspectionMatrix );
+    static_cast<void>( collectionSchemeManager.disconnect() );
+    if ( !extracted )
+    {
+        mLogger.error( "CampaignDryRun::extractDocuments",
+                       "No CAN decoder dictionary or campaign was extracted, check that the collection schemes "
+                       "refer to the decoder manifest and the interface IDs of the logs" );
+    }
+    return extracted;
+}
+
+bool
+CampaignDryRun::run()
+{
+    std::string decoderManifest;
+    std::string collectionSchemes;
+    if ( !readFile( mConfig.decoderManifestFilename, decoderManifest ) ||
+         !readFile( mConfig.collectionSchemesFilename, collectionSchemes ) )
+    {
+        mLogger.error( "CampaignDryRun::run", "Failed to read the decoder manifest or the collection schemes" );
+        return false;
+    }
+    for ( const auto &log : mConfig.logs )
+    {
+        if ( mCANIDTranslator.getChannelNumericID( log.interfaceId ) == INVALID_CAN_SOURCE_NUMERIC_ID )
+        {
+            mCANIDTranslator.add( log.interfaceId );
+        }
+    }
+    if ( mConfig.logs.empty() || !extractDocuments( decoderManifest, collectionSchemes ) )
+    {
+        return false;
+    }
+
+    auto threadCount = static_cast<size_t>( mConfig.threads );
+    if ( threadCount == 0 )
+    {
+        threadCount = std::max( std::thread::hardware_concurrency(), 1U );
+    }
+    threadCount = std::min( threadCount, mConfig.logs.size() );
+    auto startTimeUs = FastClock::monotonicTimeUs();
+    std::vector<Thread> workers( threadCount );
+    for ( size_t i = 0; i < workers.size(); i++ )
+    {
+        if ( !workers[i].create( doWork, this, "fwDryRun" + std::to_string( i ) ) )
+        {
+            mLogger.error( "CampaignDryRun::run", "Failed to create a worker thread" );
+        }
+    }
+    for ( auto &worker : workers )
+    {
+        static_cast<void>( worker.release() );
+    }
+    mWallTimeUs = FastClock::monotonicTimeUs() - startTimeUs;
+    return mReplayedLogs > 0;
+}
+
+void
+CampaignDryRun::doWork( void *data )
+{
+    auto *dryRun = static_cast<CampaignDryRun *>( data );
+    for ( auto index = dryRun->mNextLog++; index < dryRun->mConfig.logs.size(); index = dryRun->mNextLog++ )
+    {
+        const auto &log = dryRun->mConfig.logs[index];
+        if ( !dryRun->replayLog( log ) )
+        {
+            dryRun->mLogger.error( "CampaignDryRun::doWork", "Failed to replay " + log.filename );
+        }
+    }
+}
+
+bool
+CampaignDryRun::replayLog( const CampaignDryRunLog &log )
+{
+    auto canIDTranslator = mCANIDTranslator;
+    auto channelId = canIDTranslator.getChannelNumericID( log.interfaceId );
+
+    VehicleDataSourceConfig sourceConfig;
+    sourceConfig.maxNumberOfVehicleDataMessages = REPLAY_BUFFER_SIZE;
+    sourceConfig.transportProperties["logFile"] = log.filename;
+    sourceConfig.transportProperties["replayMode"] = "asFastAsPossible";
+    sourceConfig.transportProperties["preserveTimestamps"] = "true";
+    if ( !log.channel.empty() )
+    {
+        sourceConfig.transportProperties["channel"] = log.channel;
+    }
+    CANLogReplayDataSource source;
+    auto dataAvailable = std::make_shared<Platform::Linux::Signal>();
+    if ( !source.init( { sourceConfig } ) )
+    {
+        return false;
+    }
+    source.setDataAvailableSignal( dataAvailable );
+    auto replayBuffer = source.getBuffer();
+
+    // The frames are moved to the input of the consumer on the way, so the clock also advances with frames that are
+    // not decoded
+    DryRunInspection inspection( mInspectionMatrix, canIDTranslator );
+    auto inputBuffer = std::make_shared<VehicleMessageCircularBuffer>( DECODE_BATCH_SIZE );
+    CANDataConsumer consumer;
+    if ( !consumer.init( static_cast<VehicleDataSourceID>( channelId ),
+                         std::make_shared<SignalBuffer>( DECODE_BATCH_SIZE ),
+                         0 ) )
+    {
+        return false;
+    }
+    consumer.setInputBuffer( inputBuffer );
+    consumer.setCANBufferPtr( std::make_shared<CANBuffer>( DECODE_BATCH_SIZE ) );
+    consumer.setDirectOutput( &inspection );
+    ConstDecoderDictionaryConstPtr dictionary = mDecoderDictionary;
+    if ( !consumer.connect() )
+    {
+        return false;
+    }
+    consumer.resumeDataConsumption( dictionary );
+    if ( !source.connect() )
+    {
+        static_cast<void>( consumer.disconnect() );
+        return false;
+    }
+    source.resumeDataAcquisition();
+
+    Timestamp firstTime = 0;
+    Timestamp lastTime = 0;
+    uint64_t frames = 0;
+    while ( true )
+    {
+        // Read before the buffer, so an empty buffer afterwards means all frames were processed
+        bool finished = source.isReplayFinished();
+        VehicleDataMessage message;
+        size_t batchSize = 0;
+        while ( ( batchSize < DECODE_BATCH_SIZE ) && replayBuffer->pop( message ) )
+        {
+            if ( frames == 0 )
+            {
+                firstTime = message.getReceptionTimestamp();
+            }
+            lastTime = std::max( lastTime, message.getReceptionTimestamp() );
+            frames++;
+            inputBuffer->push( message );
+            batchSize++;
+        }
+        if ( batchSize == 0 )
+        {
+            if ( finished )
+            {
+                break;
+            }
+            dataAvailable->wait( REPLAY_WAIT_MS );
+            continue;
+        }
+        static_cast<void>( consumer.consumeFrames( DECODE_BATCH_SIZE ) );
+        inspection.advanceTo( lastTime );
+    }
+    static_cast<void>( source.disconnect() );
+    static_cast<void>( consumer.disconnect() );
+    inspection.finish( lastTime + END_OF_LOG_COLLECT_MS );
+
+    std::lock_guard<std::mutex> lock( mResultsMutex );
+    inspection.takeResults( mResults );
+    for ( auto &result : mResults )
+    {
+        result.second.collectionSchemeID = result.first;
+    }
+    mReplayedFrames += frames;
+    mDriveDurationMs += lastTime - firstTime;
+    mReplayedLogs++;
+    return true;
+}
+
+void
+CampaignDryRun::printReport() const
+{
+    auto driveHours = static_cast<double>( std::max<uint64_t>( mDriveDurationMs, 1 ) ) / MS_PER_HOUR;
+    std::cout << "Replayed " << mReplayedLogs << " of " << mConfig.logs.size() << " logs with " << mReplayedFrames
+              << " frames and " << std::fixed << std::setprecision( 2 ) << driveHours << " hours of driving in "
+              << ( static_cast<double>( mWallTimeUs ) / 1e6 ) << " s" << std::endl;
+    CampaignDryRunResult total;
+    for ( const auto &entry : mResults )
+    {
+        const auto &result = entry.second;
+        std::cout << result.collectionSchemeID << ":" << std::endl
+                  << "  " << result.triggers << " triggers, " << result.evaluations << " evaluations, "
+                  << result.payloads << " payloads with " << result.signals << " signals and " << result.rawFrames
+                  << " raw frames" << std::endl
+                  << "  " << result.payloadBytes << " bytes, "
+                  << ( static_cast<double>( result.payloadBytes ) / driveHours ) << " bytes per hour of driving"
+                  << std::endl
+                  << "  " << ( static_cast<double>( result.costNs ) / 1e6 ) << " ms CPU, "
+                  << ( static_cast<double>( result.costNs ) / 1e6 / driveHours ) << " ms CPU per hour of driving"
+                  << std::endl;
+        total.triggers += result.triggers;
+        total.payloadBytes += result.payloadBytes;
+        total.costNs += result.costNs;
+    }
+    std::cout << "Total: " << total.triggers << " triggers, "
+              << ( static_cast<double>( total.payloadBytes ) / driveHours ) << " bytes and "
+              << ( static_cast<double>( total.costNs ) / 1e6 / driveHours ) << " ms CPU per hour of driving"
+              << std::endl;
+}
+
+} // namespace ExecutionManagement
+} // namespace IoTFleetWise
+} // namespace Aws
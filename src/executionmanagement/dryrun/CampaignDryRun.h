@@ -0,0 +1,168 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "CANInterfaceIDTranslator.h"
+#include "CollectionInspectionAPITypes.h"
+#include "IDecoderDictionary.h"
+#include "LoggingModule.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace ExecutionManagement
+{
+using namespace Aws::IoTFleetWise::DataManagement;
+using namespace Aws::IoTFleetWise::DataInspection;
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+struct CampaignDryRunLog
+{
+    // candump or ASC log, see CANLogReplayDataSource
+    std::string filename;
+    // Interface ID of the decoder manifest the frames of the log were received on
+    std::string interfaceId;
+    // Only the frames of this candump interface name or ASC channel number are replayed, empty for all
+    std::string channel;
+};
+
+struct CampaignDryRunConfig
+{
+    // Serialized DecoderManifest message as sent by the cloud
+    std::string decoderManifestFilename;
+    // Serialized CollectionSchemes message as sent by the cloud
+    std::string collectionSchemesFilename;
+    std::vector<CampaignDryRunLog> logs;
+    // Logs replayed in parallel, 0 for one per CPU
+    uint32_t threads{ 0 };
+};
+
+/**
+ * @brief Results of one campaign over all logs
+ */
+struct CampaignDryRunResult
+{
+    std::string collectionSchemeID;
+    uint64_t evaluations{ 0 };
+    uint64_t triggers{ 0 };
+    // Collected data taken from the inspection, every payload is the data of one trigger
+    uint64_t payloads{ 0 };
+    // Serialized size of the payloads before compression
+    uint64_t payloadBytes{ 0 };
+    uint64_t signals{ 0 };
+    uint64_t rawFrames{ 0 };
+    // CPU time of the evaluations, extrapolated from the sampled ones, plus the collection time
+    uint64_t costNs{ 0 };
+};
+
+/**
+ * @brief Evaluates campaigns offline against recorded CAN logs before they are deployed to a fleet.
+ *
+ * The decoder manifest and the collection schemes are turned into the decoder dictionary and the inspection matrix by
+ * the CollectionSchemeManager, with all campaigns active regardless of their start and expiry time. Every log is then
+ * replayed as fast as possible and decoded by a CANDataConsumer, which hands the signals and raw frames directly to an
+ * own CollectionInspectionEngine. The clock of the inspection is the timestamp of the frames in the log, so periodic
+ * conditions, window functions and after durations behave as in the vehicle. Multiple logs are replayed in parallel,
+ * each on its own thread with its own inspection.
+ *
+ * The collected data is serialized like by the DataCollectionSender, without splitting into multiple payloads and
+ * without compression. OBD signals, DTCs and the load shedding are not simulated.
+ */
+class CampaignDryRun
+{
+public:
+    // Frames moved from the replay to the decoding at once
+    static constexpr size_t DECODE_BATCH_SIZE = 64;
+    static constexpr uint32_t REPLAY_BUFFER_SIZE = 10000;
+    // Time to wait for the replay when all its frames are processed
+    static constexpr uint32_t REPLAY_WAIT_MS = 10;
+    // Time the CollectionSchemeManager gets to extract the decoder dictionary and the inspection matrix
+    static constexpr uint32_t DOCUMENTS_TIMEOUT_MS = 10000;
+    // The collected data is taken until this time after the last frame of a log, so that the after duration of
+    // late triggers ends
+    static constexpr uint32_t END_OF_LOG_COLLECT_MS = 3600000;
+
+    explicit CampaignDryRun( CampaignDryRunConfig config );
+
+    /**
+     * @brief Extracts the documents and replays all logs
+     * @return False if the documents could not be read or extracted, or no log could be replayed
+     */
+    bool run();
+
+    /**
+     * @brief Prints the results of every campaign and the totals
+     */
+    void printReport() const;
+
+    /**
+     * @return the results of the campaigns that were evaluated at least once, by collection scheme ID
+     */
+    const std::map<std::string, CampaignDryRunResult> &
+    getResults() const
+    {
+        return mResults;
+    }
+
+    uint64_t
+    getReplayedFrames() const
+    {
+        return mReplayedFrames;
+    }
+
+    /**
+     * @return the sum of the times between the first and the last frame of every log
+     */
+    uint64_t
+    getDriveDurationMs() const
+    {
+        return mDriveDurationMs;
+    }
+
+private:
+    // Extracts the decoder dictionary and the inspection matrix, false if the manager did not provide both in time
+    bool extractDocuments( const std::string &decoderManifest, const std::string &collectionSchemes );
+    static void doWork( void *data );
+    // Replays one log and adds its results
+    bool replayLog( const CampaignDryRunLog &log );
+
+    CampaignDryRunConfig mConfig;
+    CANInterfaceIDTranslator mCANIDTranslator;
+    std::shared_ptr<const DecoderDictionary> mDecoderDictionary;
+    std::shared_ptr<const InspectionMatrix> mInspectionMatrix;
+    // Index of the next log a worker takes
+    std::atomic<size_t> mNextLog{ 0 };
+
+    std::mutex mResultsMutex;
+    std::map<std::string, CampaignDryRunResult> mResults;
+    uint64_t mReplayedFrames{ 0 };
+    uint64_t mDriveDurationMs{ 0 };
+    uint64_t mWallTimeUs{ 0 };
+    uint32_t mReplayedLogs{ 0 };
+    LoggingModule mLogger;
+};
+
+} // namespace ExecutionManagement
+} // namespace IoTFleetWise
+} // namespace Aws
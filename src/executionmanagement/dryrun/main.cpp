@@ -0,0 +1,73 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "CampaignDryRun.h"
+#include "IoTFleetWiseConfig.h"
+#include "LogLevel.h"
+#include <cstdlib>
+#include <iostream>
+
+using namespace Aws::IoTFleetWise::ExecutionManagement;
+
+static CampaignDryRunConfig
+readDryRunConfig( const Json::Value &config )
+{
+    CampaignDryRunConfig dryRunConfig;
+    dryRunConfig.decoderManifestFilename = config["decoderManifestFile"].asString();
+    dryRunConfig.collectionSchemesFilename = config["collectionSchemesFile"].asString();
+    for ( const auto &logConfig : config["logs"] )
+    {
+        CampaignDryRunLog log;
+        log.filename = logConfig["file"].asString();
+        log.interfaceId = logConfig["interfaceId"].asString();
+        log.channel = logConfig["channel"].asString();
+        dryRunConfig.logs.emplace_back( log );
+    }
+    if ( config.isMember( "threads" ) )
+    {
+        dryRunConfig.threads = config["threads"].asUInt();
+    }
+    return dryRunConfig;
+}
+
+int
+main( int argc, char *argv[] )
+{
+    if ( argc != 2 )
+    {
+        std::cout << "usage: fwe-campaign-dry-run <config file>" << std::endl
+                  << "The config file lists the decoder manifest, the collection schemes and the CAN logs"
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::string configFilename = argv[1];
+    Json::Value config;
+    if ( !IoTFleetWiseConfig::read( configFilename, config ) )
+    {
+        std::cout << "Failed to read config file: " + configFilename << std::endl;
+        return EXIT_FAILURE;
+    }
+    Aws::IoTFleetWise::Platform::Linux::LogLevel logLevel = Aws::IoTFleetWise::Platform::Linux::LogLevel::Warning;
+    stringToLogLevel( config["systemWideLogLevel"].asString(), logLevel );
+    gSystemWideLogLevel = logLevel;
+
+    CampaignDryRun dryRun( readDryRunConfig( config ) );
+    if ( !dryRun.run() )
+    {
+        std::cout << "Campaign dry run failed" << std::endl;
+        return EXIT_FAILURE;
+    }
+    dryRun.printReport();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,207 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "CANFrameGenerator.h"
+#include "FastClock.h"
+#include <cstring>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace ExecutionManagement
+{
+constexpr uint32_t CANFrameGenerator::SEND_INTERVAL_MS;
+
+CANFrameGenerator::CANFrameGenerator( std::string interfaceName, std::vector<DbcMessage> messages )
+    : mInterfaceName( std::move( interfaceName ) )
+    , mMessages( std::move( messages ) )
+{
+}
+
+CANFrameGenerator::~CANFrameGenerator()
+{
+    if ( isAlive() )
+    {
+        stop();
+    }
+    if ( mSocket >= 0 )
+    {
+        close( mSocket );
+    }
+}
+
+bool
+CANFrameGenerator::connect()
+{
+    struct sockaddr_can interfaceAddress = {};
+    struct ifreq interfaceRequest = {};
+    if ( mMessages.empty() || ( mInterfaceName.size() >= sizeof( interfaceRequest.ifr_name ) ) )
+    {
+        return false;
+    }
+    mSocket = socket( PF_CAN, SOCK_RAW | SOCK_NONBLOCK, CAN_RAW );
+    if ( mSocket < 0 )
+    {
+        return false;
+    }
+    (void)strncpy( interfaceRequest.ifr_name, mInterfaceName.c_str(), sizeof( interfaceRequest.ifr_name ) - 1U );
+    if ( ioctl( mSocket, SIOCGIFINDEX, &interfaceRequest ) != 0 )
+    {
+        mLogger.error( "CANFrameGenerator::connect", " CAN Interface with name " + mInterfaceName + " is not accessible" );
+        close( mSocket );
+        mSocket = -1;
+        return false;
+    }
+    // The generator only writes
+    if ( setsockopt( mSocket, SOL_CAN_RAW, CAN_RAW_FILTER, nullptr, 0 ) != 0 )
+    {
+        mLogger.warn( "CANFrameGenerator::connect", " Could not disable the receive filter of " + mInterfaceName );
+    }
+    const int enableCanFdFrames = 1;
+    if ( setsockopt( mSocket, SOL_CAN_RAW, CAN_RAW_FD_FRAMES, &enableCanFdFrames, sizeof( enableCanFdFrames ) ) != 0 )
+    {
+        mLogger.warn( "CANFrameGenerator::connect", " CAN FD frames not supported on interface " + mInterfaceName );
+    }
+    interfaceAddress.can_family = AF_CAN;
+    interfaceAddress.can_ifindex = interfaceRequest.ifr_ifindex;
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-cstyle-cast)
+    if ( bind( mSocket, (struct sockaddr *)&interfaceAddress, sizeof( interfaceAddress ) ) < 0 )
+    {
+        close( mSocket );
+        mSocket = -1;
+        return false;
+    }
+    return true;
+}
+
+bool
+CANFrameGenerator::start()
+{
+    // Prevent concurrent stop/init
+    std::lock_guard<std::mutex> lock( mThreadMutex );
+    if ( mSocket < 0 )
+    {
+        mLogger.error( "CANFrameGenerator::start", " Not connected to " + mInterfaceName );
+        return false;
+    }
+    mShouldStop.store( false );
+    if ( !mThread.create( doWork, this, "fwHarnessCANGen" ) )
+    {
+        mLogger.trace( "CANFrameGenerator::start", " Generator thread failed to start " );
+        return false;
+    }
+    return true;
+}
+
+bool
+CANFrameGenerator::stop()
+{
+    std::lock_guard<std::mutex> lock( mThreadMutex );
+    mShouldStop.store( true, std::memory_order_relaxed );
+    mWait.notify();
+    mThread.release();
+    mShouldStop.store( false, std::memory_order_relaxed );
+    return !mThread.isActive();
+}
+
+bool
+CANFrameGenerator::isAlive()
+{
+    return mThread.isValid() && mThread.isActive();
+}
+
+bool
+CANFrameGenerator::shouldStop() const
+{
+    return mShouldStop.load( std::memory_order_relaxed );
+}
+
+void
+CANFrameGenerator::setFramesPerSecond( uint32_t framesPerSecond )
+{
+    std::lock_guard<std::mutex> lock( mRateMutex );
+    mFramesPerSecond = framesPerSecond;
+    mRateStartTimeUs = FastClock::monotonicTimeUs();
+    mFramesSinceRateStart = 0;
+}
+
+bool
+CANFrameGenerator::sendFrame( const DbcMessage &message )
+{
+    struct canfd_frame frame = {};
+    frame.can_id = message.isExtendedId ? ( message.id | CAN_EFF_FLAG ) : message.id;
+    frame.len = message.sizeInBytes;
+    for ( size_t i = 0; i < frame.len; i++ )
+    {
+        // xorshift64, the values only need to change from frame to frame
+        mRandomState ^= mRandomState << 13U;
+        mRandomState ^= mRandomState >> 7U;
+        mRandomState ^= mRandomState << 17U;
+        frame.data[i] = static_cast<uint8_t>( mRandomState );
+    }
+    // Classic frames are written with the smaller MTU, so that interfaces without CAN FD accept them
+    const size_t frameSize = ( frame.len > CAN_MAX_DLEN ) ? CANFD_MTU : CAN_MTU;
+    return write( mSocket, &frame, frameSize ) == static_cast<ssize_t>( frameSize );
+}
+
+bool
+CANFrameGenerator::sendDueFrames()
+{
+    std::lock_guard<std::mutex> lock( mRateMutex );
+    const uint64_t MICROSECONDS_PER_SECOND = 1000000;
+    auto elapsedUs = FastClock::monotonicTimeUs() - mRateStartTimeUs;
+    auto dueFrames = ( ( static_cast<uint64_t>( mFramesPerSecond ) * elapsedUs ) / MICROSECONDS_PER_SECOND );
+    if ( dueFrames <= mFramesSinceRateStart )
+    {
+        return true;
+    }
+    dueFrames -= mFramesSinceRateStart;
+    mFramesSinceRateStart += dueFrames;
+    for ( uint64_t i = 0; i < dueFrames; i++ )
+    {
+        const auto &message = mMessages[mNextMessage];
+        if ( !sendFrame( message ) )
+        {
+            // Typically ENOBUFS if the transmit queue of the interface is full
+            mFailedFrames.fetch_add( dueFrames - i, std::memory_order_relaxed );
+            return false;
+        }
+        mNextMessage = ( mNextMessage + 1 ) % mMessages.size();
+        mSentFrames.fetch_add( 1, std::memory_order_relaxed );
+        mSentSignals.fetch_add( message.signals.size(), std::memory_order_relaxed );
+    }
+    return true;
+}
+
+void
+CANFrameGenerator::doWork( void *data )
+{
+    auto *generator = static_cast<CANFrameGenerator *>( data );
+    while ( !generator->shouldStop() )
+    {
+        generator->sendDueFrames();
+        generator->mWait.wait( SEND_INTERVAL_MS );
+    }
+}
+
+} // namespace ExecutionManagement
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -0,0 +1,123 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "DbcFile.h"
+#include "LoggingModule.h"
+#include "Signal.h"
+#include "Thread.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace ExecutionManagement
+{
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+/**
+ * @brief Writes the messages of a DBC file round robin with random payloads to a SocketCAN interface at a given
+ * rate. The frames are written every millisecond in bursts of the frames due since the rate was set, so the rate
+ * is kept on average even if the thread is scheduled late. Frames the socket does not accept are counted as
+ * failed and not retried, so a generator that cannot keep up does not build up a backlog.
+ */
+class CANFrameGenerator
+{
+public:
+    static constexpr uint32_t SEND_INTERVAL_MS = 1;
+
+    CANFrameGenerator( std::string interfaceName, std::vector<DbcMessage> messages );
+    ~CANFrameGenerator();
+
+    CANFrameGenerator( const CANFrameGenerator & ) = delete;
+    CANFrameGenerator &operator=( const CANFrameGenerator & ) = delete;
+    CANFrameGenerator( CANFrameGenerator && ) = delete;
+    CANFrameGenerator &operator=( CANFrameGenerator && ) = delete;
+
+    /**
+     * @brief Opens the raw CAN socket of the interface
+     * @return False if the interface does not exist
+     */
+    bool connect();
+
+    bool start();
+
+    bool stop();
+
+    bool isAlive();
+
+    /**
+     * @brief Sets the frames per second written from now on, 0 stops writing
+     */
+    void setFramesPerSecond( uint32_t framesPerSecond );
+
+    uint64_t
+    getSentFrames() const
+    {
+        return mSentFrames.load( std::memory_order_relaxed );
+    }
+
+    /**
+     * @brief Returns the number of signals in the sent frames
+     */
+    uint64_t
+    getSentSignals() const
+    {
+        return mSentSignals.load( std::memory_order_relaxed );
+    }
+
+    uint64_t
+    getFailedFrames() const
+    {
+        return mFailedFrames.load( std::memory_order_relaxed );
+    }
+
+private:
+    static void doWork( void *data );
+    bool shouldStop() const;
+    // Writes the frames due, returns false if the socket did not accept a frame
+    bool sendDueFrames();
+    bool sendFrame( const DbcMessage &message );
+
+    std::string mInterfaceName;
+    std::vector<DbcMessage> mMessages;
+    int mSocket{ -1 };
+    size_t mNextMessage{ 0 };
+    uint64_t mRandomState{ 0x9E3779B97F4A7C15U };
+
+    std::mutex mRateMutex;
+    uint32_t mFramesPerSecond{ 0 };
+    uint64_t mRateStartTimeUs{ 0 };
+    uint64_t mFramesSinceRateStart{ 0 };
+
+    std::atomic<uint64_t> mSentFrames{ 0 };
+    std::atomic<uint64_t> mSentSignals{ 0 };
+    std::atomic<uint64_t> mFailedFrames{ 0 };
+
+    Thread mThread;
+    std::atomic<bool> mShouldStop{ false };
+    std::mutex mThreadMutex;
+    Signal mWait;
+    LoggingModule mLogger;
+};
+
+} // namespace ExecutionManagement
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -0,0 +1,86 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "CollectedDataSink.h"
+#include "LatencyTracer.h"
+#include "vehicle_data.pb.h"
+#include <limits>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace ExecutionManagement
+{
+namespace
+{
+uint64_t
+countSignals( const Schemas::VehicleDataMsg::VehicleData &vehicleData )
+{
+    uint64_t signals = static_cast<uint64_t>( vehicleData.captured_signals_size() );
+    for ( const auto &column : vehicleData.signal_columns() )
+    {
+        signals += static_cast<uint64_t>( column.relative_time_ms_deltas_size() );
+    }
+    for ( const auto &aggregated : vehicleData.aggregated_vehicle_data() )
+    {
+        signals += countSignals( aggregated );
+    }
+    return signals;
+}
+} // namespace
+
+constexpr size_t CollectedDataSink::MAX_SEND_SIZE;
+
+bool
+CollectedDataSink::isAlive()
+{
+    return true;
+}
+
+size_t
+CollectedDataSink::getMaxSendSize() const
+{
+    return MAX_SEND_SIZE;
+}
+
+ConnectivityError
+CollectedDataSink::send( const std::uint8_t *buf, size_t size, struct CollectionSchemeParams collectionSchemeParams )
+{
+    if ( ( buf == nullptr ) || ( size == 0U ) || ( size > MAX_SEND_SIZE ) )
+    {
+        return ConnectivityError::WrongInputData;
+    }
+    Platform::Linux::LatencyTracer::get().mark( collectionSchemeParams.traceId,
+                                                Platform::Linux::LatencyStage::PUBLISH );
+    Schemas::VehicleDataMsg::VehicleData vehicleData;
+    if ( ( size > static_cast<size_t>( std::numeric_limits<int>::max() ) ) ||
+         ( !vehicleData.ParseFromArray( buf, static_cast<int>( size ) ) ) )
+    {
+        mInvalidPayloads.fetch_add( 1, std::memory_order_relaxed );
+    }
+    else
+    {
+        mSignals.fetch_add( countSignals( vehicleData ), std::memory_order_relaxed );
+    }
+    mPayloads.fetch_add( 1, std::memory_order_relaxed );
+    mBytes.fetch_add( size, std::memory_order_relaxed );
+    Platform::Linux::LatencyTracer::get().mark( collectionSchemeParams.traceId,
+                                                Platform::Linux::LatencyStage::PUBACK );
+    return ConnectivityError::Success;
+}
+
+} // namespace ExecutionManagement
+} // namespace IoTFleetWise
+} // namespace Aws
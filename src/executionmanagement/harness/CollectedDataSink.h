@@ -0,0 +1,82 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "ISender.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace ExecutionManagement
+{
+using namespace Aws::IoTFleetWise::OffboardConnectivity;
+
+/**
+ * @brief In-process replacement of the AWS IoT channel of the collected data. Every payload is parsed as
+ * uncompressed VehicleData and its signal samples are counted. As the publish completes immediately, the
+ * publish and the publish completion of a traced payload are marked at the same time.
+ */
+class CollectedDataSink : public ISender
+{
+public:
+    // Same as the maximum MQTT message size of AWS IoT
+    static constexpr size_t MAX_SEND_SIZE = 131072;
+
+    bool isAlive() override;
+
+    size_t getMaxSendSize() const override;
+
+    ConnectivityError send( const std::uint8_t *buf,
+                            size_t size,
+                            struct CollectionSchemeParams collectionSchemeParams = CollectionSchemeParams() ) override;
+
+    uint64_t
+    getPayloads() const
+    {
+        return mPayloads.load( std::memory_order_relaxed );
+    }
+
+    uint64_t
+    getBytes() const
+    {
+        return mBytes.load( std::memory_order_relaxed );
+    }
+
+    uint64_t
+    getSignals() const
+    {
+        return mSignals.load( std::memory_order_relaxed );
+    }
+
+    uint64_t
+    getInvalidPayloads() const
+    {
+        return mInvalidPayloads.load( std::memory_order_relaxed );
+    }
+
+private:
+    std::atomic<uint64_t> mPayloads{ 0 };
+    std::atomic<uint64_t> mBytes{ 0 };
+    std::atomic<uint64_t> mSignals{ 0 };
+    std::atomic<uint64_t> mInvalidPayloads{ 0 };
+};
+
+} // namespace ExecutionManagement
+} // namespace IoTFleetWise
+} // namespace Aws
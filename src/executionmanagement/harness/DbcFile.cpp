@@ -0,0 +1,167 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "DbcFile.h"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace ExecutionManagement
+{
+namespace
+{
+constexpr uint32_t DBC_EXTENDED_ID_FLAG = 0x80000000U;
+constexpr uint32_t EXTENDED_ID_MASK = 0x1FFFFFFFU;
+constexpr uint32_t BYTE_SIZE = 8;
+
+bool
+parseMessage( const std::string &line, DbcMessage &message )
+{
+    std::istringstream stream( line );
+    std::string tag;
+    uint64_t id = 0;
+    uint32_t sizeInBytes = 0;
+    if ( !( stream >> tag >> id >> message.name >> sizeInBytes ) )
+    {
+        return false;
+    }
+    if ( ( !message.name.empty() ) && ( message.name.back() == ':' ) )
+    {
+        message.name.pop_back();
+    }
+    message.isExtendedId = ( id & DBC_EXTENDED_ID_FLAG ) != 0U;
+    message.id = static_cast<uint32_t>( id ) & EXTENDED_ID_MASK;
+    message.sizeInBytes = static_cast<uint8_t>( sizeInBytes );
+    return true;
+}
+
+bool
+parseSignal( const std::string &line, DbcSignal &signal, bool &isMultiplexed )
+{
+    std::istringstream stream( line );
+    std::string tag;
+    std::string token;
+    if ( !( stream >> tag >> signal.name >> token ) )
+    {
+        return false;
+    }
+    // "M" marks the multiplexor, "m<value>" a signal only present for one multiplexor value
+    isMultiplexed = ( !token.empty() ) && ( token[0] == 'm' );
+    if ( token != ":" )
+    {
+        stream >> token;
+    }
+    std::string layout;
+    std::string scaling;
+    if ( !( stream >> layout >> scaling ) )
+    {
+        return false;
+    }
+    uint32_t startBit = 0;
+    char byteOrder = 0;
+    char sign = 0;
+    if ( sscanf( layout.c_str(), "%u|%u@%c%c", &startBit, &signal.length, &byteOrder, &sign ) != 4 )
+    {
+        return false;
+    }
+    if ( sscanf( scaling.c_str(), "(%lf,%lf)", &signal.factor, &signal.offset ) != 2 )
+    {
+        return false;
+    }
+    signal.isBigEndian = byteOrder == '0';
+    signal.isSigned = sign == '-';
+    signal.startBit = startBit;
+    if ( signal.isBigEndian )
+    {
+        // Walk from the most significant bit down to the least significant one in the sawtooth bit numbering
+        for ( uint32_t i = 1; i < signal.length; i++ )
+        {
+            signal.startBit =
+                ( ( signal.startBit % BYTE_SIZE ) == 0U ) ? ( signal.startBit + ( 2 * BYTE_SIZE ) - 1 ) : signal.startBit - 1;
+        }
+    }
+    return ( signal.length > 0U ) && ( signal.length <= 64U );
+}
+} // namespace
+
+bool
+parseDbc( const std::string &contents, std::vector<DbcMessage> &messages )
+{
+    messages.clear();
+    std::istringstream stream( contents );
+    std::string line;
+    bool inMessage = false;
+    while ( std::getline( stream, line ) )
+    {
+        auto begin = line.find_first_not_of( " \t" );
+        if ( begin == std::string::npos )
+        {
+            inMessage = false;
+            continue;
+        }
+        if ( line.compare( begin, 4, "BO_ " ) == 0 )
+        {
+            DbcMessage message;
+            inMessage = parseMessage( line, message );
+            if ( inMessage )
+            {
+                messages.emplace_back( std::move( message ) );
+            }
+        }
+        else if ( inMessage && ( line.compare( begin, 4, "SG_ " ) == 0 ) )
+        {
+            DbcSignal signal;
+            bool isMultiplexed = false;
+            if ( parseSignal( line, signal, isMultiplexed ) && ( !isMultiplexed ) )
+            {
+                messages.back().signals.emplace_back( std::move( signal ) );
+            }
+        }
+        else
+        {
+            inMessage = false;
+        }
+    }
+    std::vector<DbcMessage> messagesWithSignals;
+    for ( auto &message : messages )
+    {
+        if ( !message.signals.empty() )
+        {
+            messagesWithSignals.emplace_back( std::move( message ) );
+        }
+    }
+    messages = std::move( messagesWithSignals );
+    return !messages.empty();
+}
+
+bool
+readDbcFile( const std::string &filename, std::vector<DbcMessage> &messages )
+{
+    std::ifstream file( filename );
+    if ( !file )
+    {
+        return false;
+    }
+    std::stringstream contents;
+    contents << file.rdbuf();
+    return parseDbc( contents.str(), messages );
+}
+
+} // namespace ExecutionManagement
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -0,0 +1,68 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace ExecutionManagement
+{
+
+/**
+ * @brief Signal of a DBC message, with the start bit in the convention of the decoder manifest
+ */
+struct DbcSignal
+{
+    std::string name;
+    // For big endian signals the DBC start bit is the most significant bit, here it is the least significant bit
+    uint32_t startBit{ 0 };
+    uint32_t length{ 0 };
+    bool isBigEndian{ false };
+    bool isSigned{ false };
+    double factor{ 1.0 };
+    double offset{ 0.0 };
+};
+
+struct DbcMessage
+{
+    std::string name;
+    uint32_t id{ 0 };
+    bool isExtendedId{ false };
+    uint8_t sizeInBytes{ 0 };
+    std::vector<DbcSignal> signals;
+};
+
+/**
+ * @brief Reads the messages and signals of a DBC file, which is enough to generate CAN traffic and a matching
+ * decoder manifest. Multiplexed signals are skipped, the multiplexor itself is read as a normal signal.
+ * @param filename path of the DBC file
+ * @param messages the messages with at least one signal
+ * @return False if the file could not be read or has no message with signals
+ */
+bool readDbcFile( const std::string &filename, std::vector<DbcMessage> &messages );
+
+/**
+ * @brief Parses the DBC contents, see readDbcFile
+ */
+bool parseDbc( const std::string &contents, std::vector<DbcMessage> &messages );
+
+} // namespace ExecutionManagement
+} // namespace IoTFleetWise
+} // namespace Aws
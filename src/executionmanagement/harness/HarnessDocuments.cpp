@@ -0,0 +1,106 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "HarnessDocuments.h"
+#include "collection_schemes.pb.h"
+#include "decoder_manifest.pb.h"
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace ExecutionManagement
+{
+namespace
+{
+// The campaign is active from the epoch until the year 2100
+constexpr uint64_t CAMPAIGN_EXPIRY_TIME_MS = 4102444800000U;
+} // namespace
+
+std::string
+createHarnessDecoderManifest( const std::string &arn,
+                              const std::vector<DbcMessage> &messages,
+                              const std::vector<std::string> &interfaceIds )
+{
+    Schemas::DecoderManifestMsg::DecoderManifest decoderManifest;
+    decoderManifest.set_arn( arn );
+    uint32_t signalId = 1;
+    for ( const auto &interfaceId : interfaceIds )
+    {
+        for ( const auto &message : messages )
+        {
+            for ( const auto &signal : message.signals )
+            {
+                auto *canSignal = decoderManifest.add_can_signals();
+                canSignal->set_signal_id( signalId );
+                canSignal->set_interface_id( interfaceId );
+                canSignal->set_message_id( message.id );
+                canSignal->set_is_big_endian( signal.isBigEndian );
+                canSignal->set_is_signed( signal.isSigned );
+                canSignal->set_start_bit( signal.startBit );
+                canSignal->set_offset( signal.offset );
+                canSignal->set_factor( signal.factor );
+                canSignal->set_length( signal.length );
+                signalId++;
+            }
+        }
+    }
+    std::string serialized;
+    if ( !decoderManifest.SerializeToString( &serialized ) )
+    {
+        return std::string();
+    }
+    return serialized;
+}
+
+std::string
+createHarnessCollectionSchemeList( const std::string &decoderManifestArn,
+                                   uint32_t signalCount,
+                                   uint32_t triggerIntervalMs,
+                                   uint32_t sampleBufferSize )
+{
+    Schemas::CollectionSchemesMsg::CollectionSchemes collectionSchemes;
+    auto *collectionScheme = collectionSchemes.add_collection_schemes();
+    collectionScheme->set_campaign_arn( "arn:aws:iotfleetwise:::campaign/throughput-harness" );
+    collectionScheme->set_decoder_manifest_arn( decoderManifestArn );
+    collectionScheme->set_start_time_ms_epoch( 0 );
+    collectionScheme->set_expiry_time_ms_epoch( CAMPAIGN_EXPIRY_TIME_MS );
+    auto *conditionBased = collectionScheme->mutable_condition_based_collection_scheme();
+    conditionBased->set_condition_minimum_interval_ms( triggerIntervalMs );
+    conditionBased->set_condition_language_version( 1 );
+    conditionBased->set_condition_trigger_mode(
+        Schemas::CollectionSchemesMsg::ConditionBasedCollectionScheme_ConditionTriggerMode_TRIGGER_ALWAYS );
+    conditionBased->mutable_condition_tree()->set_node_boolean_value( true );
+    for ( uint32_t signalId = 1; signalId <= signalCount; signalId++ )
+    {
+        auto *signalInformation = collectionScheme->add_signal_information();
+        signalInformation->set_signal_id( signalId );
+        signalInformation->set_sample_buffer_size( sampleBufferSize );
+        signalInformation->set_minimum_sample_period_ms( 0 );
+        signalInformation->set_fixed_window_period_ms( 0 );
+        signalInformation->set_condition_only_signal( false );
+    }
+    collectionScheme->set_persist_all_collected_data( false );
+    collectionScheme->set_compress_collected_data( false );
+    std::string serialized;
+    if ( !collectionSchemes.SerializeToString( &serialized ) )
+    {
+        return std::string();
+    }
+    return serialized;
+}
+
+} // namespace ExecutionManagement
+} // namespace IoTFleetWise
+} // namespace Aws
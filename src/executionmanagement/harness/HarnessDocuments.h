@@ -0,0 +1,58 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "DbcFile.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace ExecutionManagement
+{
+
+/**
+ * @brief Serializes a decoder manifest with all signals of the messages on every interface. The signal IDs are
+ * numbered from 1 in the order interface, message, signal.
+ * @param arn ARN of the decoder manifest
+ * @param messages the messages of the DBC file
+ * @param interfaceIds the interface IDs of the CAN interfaces of the config
+ * @return the serialized DecoderManifest message, empty on error
+ */
+std::string createHarnessDecoderManifest( const std::string &arn,
+                                          const std::vector<DbcMessage> &messages,
+                                          const std::vector<std::string> &interfaceIds );
+
+/**
+ * @brief Serializes a collection scheme list with one campaign that collects all signals of the decoder manifest.
+ * Its condition is always true, so it triggers every triggerIntervalMs and then sends all samples received since
+ * the last trigger.
+ * @param decoderManifestArn ARN of the decoder manifest
+ * @param signalCount number of signals of the decoder manifest
+ * @param triggerIntervalMs minimum interval of the condition
+ * @param sampleBufferSize sample buffer size of every signal
+ * @return the serialized CollectionSchemes message, empty on error
+ */
+std::string createHarnessCollectionSchemeList( const std::string &decoderManifestArn,
+                                               uint32_t signalCount,
+                                               uint32_t triggerIntervalMs,
+                                               uint32_t sampleBufferSize );
+
+} // namespace ExecutionManagement
+} // namespace IoTFleetWise
+} // namespace Aws
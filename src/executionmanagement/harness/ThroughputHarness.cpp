@@ -0,0 +1,473 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "ThroughputHarness.h"
+#include "AllocationCounter.h"
+#include "CacheAndPersist.h"
+#include "FastClock.h"
+#include "HarnessDocuments.h"
+#include "TraceModule.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace ExecutionManagement
+{
+namespace
+{
+const std::string DECODER_MANIFEST_ARN = "arn:aws:iotfleetwise:::decoder-manifest/throughput-harness";
+// The queues registered by the engine at its ThreadTelemetrySampler
+const std::vector<std::string> WATCHED_QUEUES = { "DecodedSignals", "RawCANFrames", "ReadyToPublish" };
+// A step in which the generators wrote less than this ratio of the target frames was limited by the generators
+constexpr double MIN_SENT_RATIO = 0.95;
+
+// Matches the name like the thread configurations, see Thread::setThreadConfigs
+bool
+matchesThreadName( const std::string &pattern, const std::string &name )
+{
+    if ( ( !pattern.empty() ) && ( pattern.back() == '*' ) )
+    {
+        return name.compare( 0, pattern.size() - 1, pattern, 0, pattern.size() - 1 ) == 0;
+    }
+    return name == pattern;
+}
+} // namespace
+
+constexpr uint32_t ThroughputHarness::POLL_INTERVAL_MS;
+constexpr uint32_t ThroughputHarness::DEFAULT_LATENCY_TRACE_SAMPLING_INTERVAL;
+
+ThroughputHarness::ThroughputHarness( ThroughputHarnessConfig config )
+    : mConfig( std::move( config ) )
+    , mSink( std::make_shared<CollectedDataSink>() )
+    , mThreadSampler( std::make_unique<ThreadTelemetrySampler>( POLL_INTERVAL_MS ) )
+{
+    mConfig.rateFactor = std::max( mConfig.rateFactor, 1.01 );
+    mConfig.startFramesPerSecond = std::max( mConfig.startFramesPerSecond, 1U );
+}
+
+bool
+ThroughputHarness::prepare( Json::Value &engineConfig )
+{
+    if ( !readDbcFile( mConfig.dbcFilename, mMessages ) )
+    {
+        mLogger.error( "ThroughputHarness::prepare", " Could not read any message from " + mConfig.dbcFilename );
+        return false;
+    }
+    std::vector<std::string> interfaceIds;
+    for ( const auto &networkInterface : engineConfig["networkInterfaces"] )
+    {
+        if ( networkInterface["type"].asString() != "canInterface" )
+        {
+            continue;
+        }
+        std::unique_ptr<CANFrameGenerator> generator( new CANFrameGenerator(
+            networkInterface["canInterface"]["interfaceName"].asString(), mMessages ) );
+        if ( !generator->connect() )
+        {
+            return false;
+        }
+        interfaceIds.emplace_back( networkInterface["interfaceId"].asString() );
+        mGenerators.emplace_back( std::move( generator ) );
+    }
+    if ( mGenerators.empty() )
+    {
+        mLogger.error( "ThroughputHarness::prepare", " The config has no CAN interface " );
+        return false;
+    }
+    uint32_t signalCount = 0;
+    for ( const auto &message : mMessages )
+    {
+        signalCount += static_cast<uint32_t>( message.signals.size() );
+    }
+    signalCount *= static_cast<uint32_t>( interfaceIds.size() );
+
+    // Every run starts from an empty persistency, so that neither old data nor old documents are loaded
+    char persistencyPath[] = "/tmp/fwe-throughput-harness-XXXXXX";
+    if ( mkdtemp( persistencyPath ) == nullptr )
+    {
+        mLogger.error( "ThroughputHarness::prepare", " Could not create the persistency directory " );
+        return false;
+    }
+    auto &staticConfig = engineConfig["staticConfig"];
+    staticConfig["persistency"]["persistencyPath"] = std::string( persistencyPath ) + "/";
+    {
+        PersistencyManagement::CacheAndPersist persistency(
+            staticConfig["persistency"]["persistencyPath"].asString(),
+            staticConfig["persistency"]["persistencyPartitionMaxSize"].asUInt() );
+        auto decoderManifest = createHarnessDecoderManifest( DECODER_MANIFEST_ARN, mMessages, interfaceIds );
+        auto collectionSchemeList = createHarnessCollectionSchemeList(
+            DECODER_MANIFEST_ARN, signalCount, mConfig.triggerIntervalMs, mConfig.sampleBufferSize );
+        if ( ( !persistency.init() ) || decoderManifest.empty() || collectionSchemeList.empty() ||
+             ( persistency.write( reinterpret_cast<const uint8_t *>( decoderManifest.data() ),
+                                  decoderManifest.size(),
+                                  PersistencyManagement::DataType::DECODER_MANIFEST ) !=
+               PersistencyManagement::ErrorCode::SUCCESS ) ||
+             ( persistency.write( reinterpret_cast<const uint8_t *>( collectionSchemeList.data() ),
+                                  collectionSchemeList.size(),
+                                  PersistencyManagement::DataType::COLLECTION_SCHEME_LIST ) !=
+               PersistencyManagement::ErrorCode::SUCCESS ) )
+        {
+            mLogger.error( "ThroughputHarness::prepare", " Could not persist the decoder manifest and campaign " );
+            return false;
+        }
+    }
+
+    auto &internalParameters = staticConfig["internalParameters"];
+    if ( !internalParameters.isMember( "latencyTraceSamplingInterval" ) )
+    {
+        internalParameters["latencyTraceSamplingInterval"] = DEFAULT_LATENCY_TRACE_SAMPLING_INTERVAL;
+    }
+    // The queue occupancies are read from the TraceModule variables of the engine's sampler
+    if ( ( !internalParameters.isMember( "threadTelemetrySamplingPeriodMs" ) ) ||
+         ( internalParameters["threadTelemetrySamplingPeriodMs"].asUInt() == 0U ) )
+    {
+        internalParameters["threadTelemetrySamplingPeriodMs"] = POLL_INTERVAL_MS;
+    }
+    // The profiler would start new observation windows of the TraceModule in the middle of a step
+    staticConfig.removeMember( "remoteProfilerDefaultValues" );
+    mLogger.info( "ThroughputHarness::prepare",
+                  " " + std::to_string( mMessages.size() ) + " messages with " + std::to_string( signalCount ) +
+                      " signals on " + std::to_string( mGenerators.size() ) + " interfaces, persistency in " +
+                      persistencyPath );
+    return true;
+}
+
+ThroughputHarness::Counters
+ThroughputHarness::readCounters() const
+{
+    Counters counters;
+    for ( const auto &generator : mGenerators )
+    {
+        counters.sentFrames += generator->getSentFrames();
+        counters.failedFrames += generator->getFailedFrames();
+        counters.sentSignals += generator->getSentSignals();
+    }
+    counters.receivedSignals = mSink->getSignals();
+    counters.payloads = mSink->getPayloads();
+    counters.payloadBytes = mSink->getBytes();
+    auto &trace = TraceModule::get();
+    counters.kernelDroppedFrames = trace.getAtomicVariable( TraceAtomicVariable::KERNEL_DROPPED_CAN_FRAMES );
+    counters.discardedFrames = trace.getVariable( TraceVariable::DISCARDED_FRAMES );
+    counters.emissionPolicyDroppedSignals =
+        trace.getAtomicVariable( TraceAtomicVariable::EMISSION_POLICY_DROPPED_SIGNALS );
+    counters.loadSheddingDroppedSignals = trace.getAtomicVariable( TraceAtomicVariable::LOAD_SHEDDING_DROPPED_SIGNALS );
+    counters.loadSheddingDroppedRawFrames =
+        trace.getAtomicVariable( TraceAtomicVariable::LOAD_SHEDDING_DROPPED_RAW_FRAMES );
+    counters.triggeredDataPoolExhausted =
+        trace.getAtomicVariable( TraceAtomicVariable::TRIGGERED_DATA_POOL_EXHAUSTED );
+    return counters;
+}
+
+void
+ThroughputHarness::setFramesPerSecond( uint32_t framesPerSecond )
+{
+    auto generatorCount = static_cast<uint32_t>( mGenerators.size() );
+    for ( uint32_t i = 0; i < generatorCount; i++ )
+    {
+        // The first generators write the remainder
+        mGenerators[i]->setFramesPerSecond( ( framesPerSecond / generatorCount ) +
+                                            ( ( i < ( framesPerSecond % generatorCount ) ) ? 1U : 0U ) );
+    }
+}
+
+void
+ThroughputHarness::poll( uint32_t durationMs, ThroughputStepResult *result )
+{
+    std::map<uint64_t, ThreadTelemetrySampler::ThreadSample> threads;
+    // The first sample is the baseline of the CPU times
+    mThreadSampler->sample();
+    auto endTimeMs = FastClock::monotonicTimeMs() + durationMs;
+    while ( FastClock::monotonicTimeMs() < endTimeMs )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( POLL_INTERVAL_MS ) );
+        if ( result == nullptr )
+        {
+            continue;
+        }
+        mThreadSampler->sample();
+        for ( const auto &sample : mThreadSampler->getThreadSamples() )
+        {
+            auto &thread = threads[sample.threadId];
+            thread.threadId = sample.threadId;
+            thread.threadName = sample.threadName;
+            thread.cpuTimeUs += sample.cpuTimeUs;
+            thread.runQueueWaitUs += sample.runQueueWaitUs;
+            thread.contextSwitches += sample.contextSwitches;
+            thread.allocations += sample.allocations;
+        }
+        for ( const auto &queue : WATCHED_QUEUES )
+        {
+            auto &maxOccupancy = result->maxQueueOccupancy[queue];
+            maxOccupancy = std::max( maxOccupancy, TraceModule::get().getNamedVariable( "queueOccupancy_" + queue ) );
+        }
+    }
+    if ( result != nullptr )
+    {
+        for ( const auto &thread : threads )
+        {
+            result->threads.emplace_back( thread.second );
+            if ( ( thread.second.allocations > 0U ) &&
+                 std::any_of( mConfig.zeroAllocationThreads.begin(),
+                              mConfig.zeroAllocationThreads.end(),
+                              [&thread]( const std::string &pattern ) {
+                                  return matchesThreadName( pattern, thread.second.threadName );
+                              } ) )
+            {
+                result->allocatingThreads.emplace_back( thread.second );
+            }
+        }
+        std::sort( result->threads.begin(),
+                   result->threads.end(),
+                   []( const ThreadTelemetrySampler::ThreadSample &a, const ThreadTelemetrySampler::ThreadSample &b ) {
+                       return a.cpuTimeUs > b.cpuTimeUs;
+                   } );
+    }
+}
+
+ThroughputStepResult
+ThroughputHarness::runStep( uint32_t framesPerSecond )
+{
+    ThroughputStepResult result;
+    result.targetFramesPerSecond = framesPerSecond;
+    auto before = readCounters();
+    TraceModule::get().startNewObservationWindow();
+
+    auto startTimeUs = FastClock::monotonicTimeUs();
+    setFramesPerSecond( framesPerSecond );
+    poll( mConfig.stepDurationMs, &result );
+    setFramesPerSecond( 0 );
+    result.stepDurationUs = FastClock::monotonicTimeUs() - startTimeUs;
+    poll( mConfig.drainDurationMs, nullptr );
+
+    auto after = readCounters();
+    result.sentFrames = after.sentFrames - before.sentFrames;
+    result.failedFrames = after.failedFrames - before.failedFrames;
+    result.sentSignals = after.sentSignals - before.sentSignals;
+    result.receivedSignals = after.receivedSignals - before.receivedSignals;
+    result.payloads = after.payloads - before.payloads;
+    result.payloadBytes = after.payloadBytes - before.payloadBytes;
+    result.kernelDroppedFrames = after.kernelDroppedFrames - before.kernelDroppedFrames;
+    result.discardedFrames = after.discardedFrames - before.discardedFrames;
+    result.emissionPolicyDroppedSignals = after.emissionPolicyDroppedSignals - before.emissionPolicyDroppedSignals;
+    result.loadSheddingDroppedSignals = after.loadSheddingDroppedSignals - before.loadSheddingDroppedSignals;
+    result.loadSheddingDroppedRawFrames = after.loadSheddingDroppedRawFrames - before.loadSheddingDroppedRawFrames;
+    result.triggeredDataPoolExhausted = after.triggeredDataPoolExhausted - before.triggeredDataPoolExhausted;
+    result.sentFramesPerSecond =
+        static_cast<double>( result.sentFrames ) * 1e6 / static_cast<double>( std::max<uint64_t>( result.stepDurationUs, 1 ) );
+    auto &trace = TraceModule::get();
+    result.latencyP50Us = trace.getHistogramWindowPercentile( TraceHistogram::E2E_TOTAL_US, 0.5 );
+    result.latencyP90Us = trace.getHistogramWindowPercentile( TraceHistogram::E2E_TOTAL_US, 0.9 );
+    result.latencyP99Us = trace.getHistogramWindowPercentile( TraceHistogram::E2E_TOTAL_US, 0.99 );
+    result.latencyMaxUs = trace.getHistogramWindowPercentile( TraceHistogram::E2E_TOTAL_US, 1.0 );
+    result.saturationReason = getSaturationReason( result );
+    return result;
+}
+
+std::string
+ThroughputHarness::getSaturationReason( const ThroughputStepResult &result ) const
+{
+    auto targetFrames = static_cast<double>( result.targetFramesPerSecond ) *
+                        static_cast<double>( result.stepDurationUs ) / 1e6;
+    if ( ( result.failedFrames > 0U ) || ( static_cast<double>( result.sentFrames ) < targetFrames * MIN_SENT_RATIO ) )
+    {
+        return "frame generator could not keep up";
+    }
+    if ( result.kernelDroppedFrames > 0U )
+    {
+        return "frames dropped by the kernel";
+    }
+    if ( result.discardedFrames > 0U )
+    {
+        return "frames discarded at full consumer queues";
+    }
+    if ( ( result.loadSheddingDroppedSignals > 0U ) || ( result.loadSheddingDroppedRawFrames > 0U ) )
+    {
+        return "load shedding";
+    }
+    if ( result.triggeredDataPoolExhausted > 0U )
+    {
+        return "triggered data pool exhausted";
+    }
+    // Signals not emitted by the decoder were not expected at the sink
+    auto expectedSignals = result.sentSignals - std::min( result.sentSignals, result.emissionPolicyDroppedSignals );
+    if ( ( expectedSignals > 0U ) &&
+         ( ( static_cast<double>( expectedSignals ) - static_cast<double>( result.receivedSignals ) ) >
+           ( static_cast<double>( expectedSignals ) * mConfig.maxLossRatio ) ) )
+    {
+        return "signals lost, e.g. in full signal queues or overwritten in the sample buffers";
+    }
+    if ( ( mConfig.maxLatencyP99Us > 0U ) && ( result.latencyP99Us > mConfig.maxLatencyP99Us ) )
+    {
+        return "p99 latency above " + std::to_string( mConfig.maxLatencyP99Us ) + " us";
+    }
+    return std::string();
+}
+
+void
+ThroughputHarness::printResult( const ThroughputStepResult &result )
+{
+    std::cout << std::fixed << std::setprecision( 1 );
+    std::cout << "Step " << result.targetFramesPerSecond << " frames/s: sent " << result.sentFramesPerSecond
+              << " frames/s, " << result.sentFrames << " frames, " << result.failedFrames << " failed" << std::endl;
+    std::cout << "  signals sent " << result.sentSignals << ", received " << result.receivedSignals << " in "
+              << result.payloads << " payloads with " << result.payloadBytes << " bytes" << std::endl;
+    std::cout << "  drops: kernel " << result.kernelDroppedFrames << ", consumer queue " << result.discardedFrames
+              << ", emission policy " << result.emissionPolicyDroppedSignals << ", load shedding signals "
+              << result.loadSheddingDroppedSignals << ", load shedding raw frames "
+              << result.loadSheddingDroppedRawFrames << ", data pool exhausted " << result.triggeredDataPoolExhausted
+              << std::endl;
+    std::cout << "  max queue occupancy:";
+    for ( const auto &queue : result.maxQueueOccupancy )
+    {
+        std::cout << " " << queue.first << " " << queue.second;
+    }
+    std::cout << std::endl;
+    std::cout << "  latency from frame reception to publish: p50 " << result.latencyP50Us << " us, p90 "
+              << result.latencyP90Us << " us, p99 " << result.latencyP99Us << " us, max " << result.latencyMaxUs
+              << " us" << std::endl;
+    std::cout << "  CPU per thread:";
+    for ( const auto &thread : result.threads )
+    {
+        if ( thread.cpuTimeUs == 0U )
+        {
+            continue;
+        }
+        std::cout << " " << thread.threadName << "(" << thread.threadId << ") "
+                  << ( static_cast<double>( thread.cpuTimeUs ) * 100.0 /
+                       static_cast<double>( std::max<uint64_t>( result.stepDurationUs, 1 ) ) )
+                  << "%";
+    }
+    std::cout << std::endl;
+    if ( AllocationCounter::isEnabled() )
+    {
+        std::cout << "  allocations per thread:";
+        for ( const auto &thread : result.threads )
+        {
+            if ( thread.allocations > 0U )
+            {
+                std::cout << " " << thread.threadName << "(" << thread.threadId << ") " << thread.allocations;
+            }
+        }
+        std::cout << std::endl;
+    }
+    std::cout << "  " << ( result.saturationReason.empty() ? "not saturated" : "saturated: " + result.saturationReason )
+              << std::endl;
+}
+
+bool
+ThroughputHarness::checkAllocations( const ThroughputStepResult &result )
+{
+    for ( const auto &thread : result.allocatingThreads )
+    {
+        mLogger.error( "ThroughputHarness::checkAllocations",
+                       " Thread " + thread.threadName + " allocated " + std::to_string( thread.allocations ) +
+                           " times after the warm-up" );
+    }
+    return !result.allocatingThreads.empty();
+}
+
+bool
+ThroughputHarness::run( Json::Value engineConfig )
+{
+    if ( !prepare( engineConfig ) )
+    {
+        return false;
+    }
+    IoTFleetWiseEngine engine;
+    engine.setCollectedDataSender( mSink );
+    if ( ( !engine.connect( engineConfig ) ) || ( !engine.start() ) )
+    {
+        mLogger.error( "ThroughputHarness::run", " The engine failed to start " );
+        return false;
+    }
+    bool success = true;
+    for ( auto &generator : mGenerators )
+    {
+        success = success && generator->start();
+    }
+    if ( success )
+    {
+        // The campaign is only active once the decoder manifest was built and the inspection matrix updated
+        setFramesPerSecond( mConfig.startFramesPerSecond );
+        poll( mConfig.warmUpDurationMs, nullptr );
+        setFramesPerSecond( 0 );
+        poll( mConfig.drainDurationMs, nullptr );
+        if ( mSink->getSignals() == 0U )
+        {
+            mLogger.error( "ThroughputHarness::run",
+                           " No data was collected, check that the CAN interfaces are up and the campaign is active" );
+            success = false;
+        }
+    }
+    // Number of steps before the first saturated one
+    size_t unsaturatedSteps = 0;
+    bool allocated = false;
+    for ( uint64_t framesPerSecond = mConfig.startFramesPerSecond;
+          success && ( framesPerSecond <= mConfig.maxFramesPerSecond );
+          framesPerSecond = std::max( framesPerSecond + 1,
+                                      static_cast<uint64_t>( static_cast<double>( framesPerSecond ) * mConfig.rateFactor ) ) )
+    {
+        mResults.emplace_back( runStep( static_cast<uint32_t>( framesPerSecond ) ) );
+        printResult( mResults.back() );
+        if ( !mResults.back().saturationReason.empty() )
+        {
+            // A saturated step may allocate, e.g. for the warnings about dropped data
+            break;
+        }
+        unsaturatedSteps = mResults.size();
+        if ( checkAllocations( mResults.back() ) )
+        {
+            allocated = true;
+        }
+    }
+    for ( auto &generator : mGenerators )
+    {
+        generator->stop();
+    }
+    engine.stop();
+    engine.disconnect();
+    if ( !success )
+    {
+        return false;
+    }
+    if ( unsaturatedSteps == 0U )
+    {
+        std::cout << "Saturated below " << mConfig.startFramesPerSecond << " frames/s" << std::endl;
+    }
+    else if ( mResults.back().saturationReason.empty() )
+    {
+        std::cout << "Not saturated up to " << mResults.back().targetFramesPerSecond << " frames/s" << std::endl;
+    }
+    else
+    {
+        const auto &step = mResults[unsaturatedSteps - 1];
+        std::cout << "Saturation point: " << step.targetFramesPerSecond << " frames/s, "
+                  << ( static_cast<double>( step.receivedSignals ) * 1e6 /
+                       static_cast<double>( std::max<uint64_t>( step.stepDurationUs, 1 ) ) )
+                  << " signals/s, " << step.payloads << " payloads, next step "
+                  << mResults.back().saturationReason << std::endl;
+    }
+    return !allocated;
+}
+
+} // namespace ExecutionManagement
+} // namespace IoTFleetWise
+} // namespace Aws
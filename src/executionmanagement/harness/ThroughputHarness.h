@@ -0,0 +1,169 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "CANFrameGenerator.h"
+#include "CollectedDataSink.h"
+#include "DbcFile.h"
+#include "IoTFleetWiseEngine.h"
+#include "ThreadTelemetrySampler.h"
+#include <json/json.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace ExecutionManagement
+{
+
+struct ThroughputHarnessConfig
+{
+    // DBC file whose messages are written to every CAN interface, e.g. tools/cansim/hscan.dbc
+    std::string dbcFilename;
+    // Frames per second over all interfaces of the first step
+    uint32_t startFramesPerSecond{ 1000 };
+    // Every step multiplies the frame rate by this factor
+    double rateFactor{ 2.0 };
+    uint32_t maxFramesPerSecond{ 1000000 };
+    uint32_t warmUpDurationMs{ 5000 };
+    uint32_t stepDurationMs{ 10000 };
+    // Time after every step without new frames, in which the collected data of the step is sent
+    uint32_t drainDurationMs{ 3000 };
+    uint32_t triggerIntervalMs{ 1000 };
+    uint32_t sampleBufferSize{ 10000 };
+    // A step with more signals lost than this ratio is saturated
+    double maxLossRatio{ 0.001 };
+    // A step with a higher p99 latency from the frame reception to the publish is saturated, 0 for no limit
+    uint64_t maxLatencyP99Us{ 0 };
+    // Threads that must not allocate from the heap during a step, a name ending with '*' matches all threads starting
+    // with the part before it. Only checked if the allocations are counted, see AllocationCounter.
+    std::vector<std::string> zeroAllocationThreads{ "fwDIConsumer*", "fwDICollInsEng" };
+};
+
+/**
+ * @brief Results of one frame rate
+ */
+struct ThroughputStepResult
+{
+    uint32_t targetFramesPerSecond{ 0 };
+    double sentFramesPerSecond{ 0.0 };
+    uint64_t sentFrames{ 0 };
+    // Frames the CAN sockets did not accept, the generator could not keep up
+    uint64_t failedFrames{ 0 };
+    uint64_t sentSignals{ 0 };
+    uint64_t receivedSignals{ 0 };
+    uint64_t payloads{ 0 };
+    uint64_t payloadBytes{ 0 };
+    uint64_t kernelDroppedFrames{ 0 };
+    uint64_t discardedFrames{ 0 };
+    uint64_t emissionPolicyDroppedSignals{ 0 };
+    uint64_t loadSheddingDroppedSignals{ 0 };
+    uint64_t loadSheddingDroppedRawFrames{ 0 };
+    uint64_t triggeredDataPoolExhausted{ 0 };
+    std::map<std::string, int64_t> maxQueueOccupancy;
+    // CPU time and allocations of every thread while the frames were written
+    std::vector<ThreadTelemetrySampler::ThreadSample> threads;
+    // Threads of ThroughputHarnessConfig::zeroAllocationThreads that allocated during the step
+    std::vector<ThreadTelemetrySampler::ThreadSample> allocatingThreads;
+    uint64_t stepDurationUs{ 0 };
+    uint64_t latencyP50Us{ 0 };
+    uint64_t latencyP90Us{ 0 };
+    uint64_t latencyP99Us{ 0 };
+    uint64_t latencyMaxUs{ 0 };
+    // Empty if the pipeline kept up with the frame rate
+    std::string saturationReason;
+};
+
+/**
+ * @brief Measures the sustained throughput of the whole pipeline of IoTFleetWiseEngine on the CAN interfaces of
+ * the config, which are typically vcan interfaces.
+ *
+ * A decoder manifest with the messages of a DBC file on every CAN interface and a campaign collecting all its
+ * signals are persisted in a temporary persistency directory, from where the engine loads them. The collected data
+ * is sent to a CollectedDataSink instead of AWS IoT. The frame rate is then raised step by step until the pipeline
+ * drops or loses data, or exceeds the latency limit. The last rate before is the saturation point.
+ *
+ * After the warm-up the data plane is expected to run without heap allocations. If the allocations are counted, an
+ * allocation of the zeroAllocationThreads during a step that is not saturated is reported and fails the run.
+ */
+class ThroughputHarness
+{
+public:
+    // Interval in which the thread CPU times and queue occupancies are sampled during a step
+    static constexpr uint32_t POLL_INTERVAL_MS = 100;
+    // Frames of one in this many are traced through the pipeline, unless configured otherwise
+    static constexpr uint32_t DEFAULT_LATENCY_TRACE_SAMPLING_INTERVAL = 100;
+
+    explicit ThroughputHarness( ThroughputHarnessConfig config );
+
+    /**
+     * @brief Runs the engine with the given config and all steps until the saturation point. The results of every
+     * step are printed when it is done.
+     * @param engineConfig config of the engine, with at least one CAN interface
+     * @return False if the engine could not be started, did not send any data or a zeroAllocationThread allocated
+     */
+    bool run( Json::Value engineConfig );
+
+    const std::vector<ThroughputStepResult> &
+    getResults() const
+    {
+        return mResults;
+    }
+
+private:
+    struct Counters
+    {
+        uint64_t sentFrames{ 0 };
+        uint64_t failedFrames{ 0 };
+        uint64_t sentSignals{ 0 };
+        uint64_t receivedSignals{ 0 };
+        uint64_t payloads{ 0 };
+        uint64_t payloadBytes{ 0 };
+        uint64_t kernelDroppedFrames{ 0 };
+        uint64_t discardedFrames{ 0 };
+        uint64_t emissionPolicyDroppedSignals{ 0 };
+        uint64_t loadSheddingDroppedSignals{ 0 };
+        uint64_t loadSheddingDroppedRawFrames{ 0 };
+        uint64_t triggeredDataPoolExhausted{ 0 };
+    };
+
+    // Persists the documents and points the config to them, creates the frame generators
+    bool prepare( Json::Value &engineConfig );
+    Counters readCounters() const;
+    void setFramesPerSecond( uint32_t framesPerSecond );
+    // Samples the threads and queues every POLL_INTERVAL_MS for the given time
+    void poll( uint32_t durationMs, ThroughputStepResult *result );
+    ThroughputStepResult runStep( uint32_t framesPerSecond );
+    std::string getSaturationReason( const ThroughputStepResult &result ) const;
+    static void printResult( const ThroughputStepResult &result );
+    // Logs the zeroAllocationThreads that allocated in the step, returns true if there is any
+    bool checkAllocations( const ThroughputStepResult &result );
+
+    ThroughputHarnessConfig mConfig;
+    std::vector<DbcMessage> mMessages;
+    std::vector<std::unique_ptr<CANFrameGenerator>> mGenerators;
+    std::shared_ptr<CollectedDataSink> mSink;
+    std::unique_ptr<ThreadTelemetrySampler> mThreadSampler;
+    std::vector<ThroughputStepResult> mResults;
+    LoggingModule mLogger;
+};
+
+} // namespace ExecutionManagement
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -0,0 +1,111 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "IoTFleetWiseConfig.h"
+#include "LogLevel.h"
+#include "ThroughputHarness.h"
+#include <cstdlib>
+#include <iostream>
+
+using namespace Aws::IoTFleetWise::ExecutionManagement;
+
+static ThroughputHarnessConfig
+readHarnessConfig( const Json::Value &config )
+{
+    ThroughputHarnessConfig harnessConfig;
+    harnessConfig.dbcFilename = config["dbcFilename"].asString();
+    if ( config.isMember( "startFramesPerSecond" ) )
+    {
+        harnessConfig.startFramesPerSecond = config["startFramesPerSecond"].asUInt();
+    }
+    if ( config.isMember( "rateFactor" ) )
+    {
+        harnessConfig.rateFactor = config["rateFactor"].asDouble();
+    }
+    if ( config.isMember( "maxFramesPerSecond" ) )
+    {
+        harnessConfig.maxFramesPerSecond = config["maxFramesPerSecond"].asUInt();
+    }
+    if ( config.isMember( "warmUpDurationMs" ) )
+    {
+        harnessConfig.warmUpDurationMs = config["warmUpDurationMs"].asUInt();
+    }
+    if ( config.isMember( "stepDurationMs" ) )
+    {
+        harnessConfig.stepDurationMs = config["stepDurationMs"].asUInt();
+    }
+    if ( config.isMember( "drainDurationMs" ) )
+    {
+        harnessConfig.drainDurationMs = config["drainDurationMs"].asUInt();
+    }
+    if ( config.isMember( "triggerIntervalMs" ) )
+    {
+        harnessConfig.triggerIntervalMs = config["triggerIntervalMs"].asUInt();
+    }
+    if ( config.isMember( "sampleBufferSize" ) )
+    {
+        harnessConfig.sampleBufferSize = config["sampleBufferSize"].asUInt();
+    }
+    if ( config.isMember( "maxLossRatio" ) )
+    {
+        harnessConfig.maxLossRatio = config["maxLossRatio"].asDouble();
+    }
+    if ( config.isMember( "maxLatencyP99Us" ) )
+    {
+        harnessConfig.maxLatencyP99Us = config["maxLatencyP99Us"].asUInt64();
+    }
+    if ( config.isMember( "zeroAllocationThreads" ) )
+    {
+        harnessConfig.zeroAllocationThreads.clear();
+        for ( const auto &name : config["zeroAllocationThreads"] )
+        {
+            harnessConfig.zeroAllocationThreads.emplace_back( name.asString() );
+        }
+    }
+    return harnessConfig;
+}
+
+int
+main( int argc, char *argv[] )
+{
+    if ( argc != 2 )
+    {
+        std::cout << "usage: fwe-throughput-harness <config file>" << std::endl
+                  << "The config file is an engine config with an additional throughputHarness section" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::string configFilename = argv[1];
+    Json::Value config;
+    if ( !IoTFleetWiseConfig::read( configFilename, config ) )
+    {
+        std::cout << "Failed to read config file: " + configFilename << std::endl;
+        return EXIT_FAILURE;
+    }
+    if ( !config.isMember( "throughputHarness" ) )
+    {
+        std::cout << "The config file has no throughputHarness section" << std::endl;
+        return EXIT_FAILURE;
+    }
+    Aws::IoTFleetWise::Platform::Linux::LogLevel logLevel = Aws::IoTFleetWise::Platform::Linux::LogLevel::Warning;
+    stringToLogLevel( config["staticConfig"]["internalParameters"]["systemWideLogLevel"].asString(), logLevel );
+    gSystemWideLogLevel = logLevel;
+
+    ThroughputHarness harness( readHarnessConfig( config["throughputHarness"] ) );
+    if ( !harness.run( config ) )
+    {
+        std::cout << "Throughput measurement failed" << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,121 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "AwsIotSharedClient.h"
+#include "IoTFleetWiseEngine.h"
+#include "LoggingModule.h"
+#include "businterfaces/CANDataSourceEventLoop.h"
+#include <cstdint>
+#include <json/json.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace ExecutionManagement
+{
+using namespace Aws::IoTFleetWise::OffboardConnectivityAwsIot;
+using namespace Aws::IoTFleetWise::VehicleNetwork;
+
+/**
+ * @brief Hosts many simulated vehicles in one process, configured by staticConfig.fleetSimulation.
+ *
+ * Every vehicle is a separate IoTFleetWiseEngine with its own decoder, inspection engine, sender, persistency
+ * directory and MQTT client ID. The AWS SDK event loop, the TLS context with the MQTT client and the SocketCAN
+ * reader threads are created once and shared by all vehicles, so that the number of simulated vehicles is not
+ * limited by per vehicle TLS contexts and threads.
+ */
+class FleetSimulator
+{
+public:
+    FleetSimulator() = default;
+    ~FleetSimulator();
+
+    FleetSimulator( const FleetSimulator & ) = delete;
+    FleetSimulator &operator=( const FleetSimulator & ) = delete;
+    FleetSimulator( FleetSimulator && ) = delete;
+    FleetSimulator &operator=( FleetSimulator && ) = delete;
+
+    /**
+     * @brief Checks if the config enables the fleet simulation
+     * @param config the complete FWE config
+     * @return True if staticConfig.fleetSimulation.vehicleCount is greater than zero
+     */
+    static bool isEnabled( const Json::Value &config );
+
+    /**
+     * @brief Derives the config of one simulated vehicle from the fleet config. The client ID is the configured
+     * prefix followed by the vehicle number, which also replaces the original client ID in all MQTT topics. The
+     * persistency path gets a sub directory per vehicle. Process wide features, i.e. the remote profiler, thread
+     * telemetry and latency tracing, are only kept for the vehicle with index 0.
+     * @param config the complete FWE config
+     * @param vehicleIndex index of the vehicle in the fleet, starting with 0
+     * @param vehicleConfig the resulting config
+     * @return True if the fleet simulation config is valid
+     */
+    static bool createVehicleConfig( const Json::Value &config, uint32_t vehicleIndex, Json::Value &vehicleConfig );
+
+    /**
+     * @brief Creates the shared resources and connects one engine per simulated vehicle
+     * @param config the complete FWE config
+     * @return True if all vehicles were connected
+     */
+    bool connect( const Json::Value &config );
+
+    /**
+     * @brief Starts all vehicles
+     * @return True if all vehicles were started
+     */
+    bool start();
+
+    /**
+     * @brief Stops all vehicles
+     * @return True if all vehicles were stopped
+     */
+    bool stop();
+
+    /**
+     * @brief Disconnects all vehicles and stops the shared SocketCAN reader threads
+     * @return True if all vehicles were disconnected
+     */
+    bool disconnect();
+
+    /**
+     * @brief Checks that all vehicles are running
+     */
+    bool isAlive();
+
+    size_t
+    getVehicleCount() const
+    {
+        return mEngines.size();
+    }
+
+private:
+    static const std::string DEFAULT_CLIENT_ID_PREFIX;
+
+    std::vector<std::unique_ptr<IoTFleetWiseEngine>> mEngines;
+    std::shared_ptr<AwsIotSharedClient> mSharedMqttClient;
+    std::vector<std::shared_ptr<CANDataSourceEventLoop>> mCANDataSourceEventLoops;
+    LoggingModule mLogger;
+};
+
+} // namespace ExecutionManagement
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -14,7 +14,9 @@
 #pragma once
 
 // Includes
+#include "Thread.h"
 #include <json/json.h>
+#include <map>
 #include <string>
 
 namespace Aws
@@ -32,6 +34,13 @@ public:
     IoTFleetWiseConfig() = delete;
     static bool read( const std::string &filename, Json::Value &config );
 
+    /**
+     * @brief Reads the configurations per thread name of the threads section
+     * @return false if a scheduling policy is unknown
+     */
+    static bool readThreadConfigs( const Json::Value &threads,
+                                   std::map<std::string, Platform::Linux::ThreadConfig> &threadConfigs );
+
 private:
 };
 
@@ -16,30 +16,48 @@
 // Includes
 #include "AwsIotChannel.h"
 #include "AwsIotConnectivityModule.h"
+#include "CANDataConsumer.h"
 #include "CacheAndPersist.h"
 #include "ClockHandler.h"
-#include "CollectionInspectionWorkerThread.h"
+#include "CollectionInspectionRouter.h"
 #include "CollectionScheme.h"
 #include "CollectionSchemeListener.h"
 #include "CollectionSchemeManager.h"
 #include "DataCollectionSender.h"
+#include "DataSenderPipeline.h"
+#include "DeviceJitter.h"
+#include "ExpressDataSender.h"
 #ifdef FWE_FEATURE_CAMERA
 #include "DataOverDDSModule.h"
 #endif // FWE_FEATURE_CAMERA
 #include "IDataReadyToPublishListener.h"
+#include "IReceiver.h"
+#include "LinkMonitor.h"
+#include "LocalRecorder.h"
 #include "LoggingModule.h"
 #include "OBDOverCANModule.h"
+#include "PersistedDataCompactor.h"
+#include "PipelineLoadController.h"
+#include "QueueSizeAdvisor.h"
+#include "RemoteInspectionReceiver.h"
+#include "RemoteInspectionSender.h"
 #include "RemoteProfiler.h"
 #include "Schema.h"
+#include "SerialTaskExecutor.h"
+#include "SharedMemorySignalSource.h"
 #include "Signal.h"
 #include "Thread.h"
+#include "ThreadTelemetrySampler.h"
 #include "Timer.h"
+#include "TraceSharedMemoryExporter.h"
 #include "VehicleDataSourceBinder.h"
 #include "businterfaces/AbstractVehicleDataSource.h"
+#include "businterfaces/CANDataSourceEventLoop.h"
 #include <atomic>
 #include <json/json.h>
 #include <map>
 #include <mutex>
+#include <vector>
 
 namespace Aws
 {
@@ -63,8 +81,10 @@ using namespace Aws::IoTFleetWise::OffboardConnectivityAwsIot;
  * The bootstrap executes a worker thread that listens to the Inspection
  * Engine notification, upon which the offboardconnectivity module is invoked to
  * send the data to the cloud.
+ * It also receives the runtime configuration documents, which change a subset of
+ * the performance settings without restart, see applyRuntimeConfig.
  */
-class IoTFleetWiseEngine : public IDataReadyToPublishListener
+class IoTFleetWiseEngine : public IDataReadyToPublishListener, public OffboardConnectivity::IReceiverCallback
 {
 public:
     static const uint32_t MAX_NUMBER_OF_SIGNAL_TO_TRACE_LOG;
@@ -91,13 +111,47 @@ public:
      */
     void onDataReadyToPublish() override;
 
+    /**
+     * @brief Callback from the runtime configuration channel. The document is applied by the engine thread.
+     */
+    void onDataReceived( const std::uint8_t *buf, size_t size ) override;
+
+    /**
+     * @brief Applies the performance settings of a runtime configuration document to the running pipeline.
+     *
+     * The document can contain:
+     * - publishToCloudParameters.maxPublishMessageCount
+     * - persistency.persistencyUploadRetryIntervalMs
+     * - threadIdleTimes with the spin and yield counts of the inspection and CAN decoder threads
+     * - threads with configurations per thread name like the static configuration. They replace the
+     *   configurations of the same names and are applied to the running threads, except the stack size
+     * - uploadRateLimits with the link limit and the limits of the topics, if the static configuration has
+     *   uploadRateLimits. The link limit is only changed if one of its members is given.
+     *
+     * The document is validated completely before anything is applied, unknown members are rejected. Must be
+     * called on the engine thread or while it is not running.
+     *
+     * @return false if the document is invalid, nothing is changed then
+     */
+    bool applyRuntimeConfig( const Json::Value &runtimeConfig );
+
     /**
      * @brief Check if the data was persisted in the last cycle due to no offboardconnectivity,
      *        retrieve all the data and send
-     * @return true if either no data persisted or all persisted data was handed over to connectivity
+     *        in the order of the drain policy. While live data is waiting the persisted data only gets its
+     *        configured share of the uploaded bytes.
+     * @return true if either no data persisted or all persisted data was handed over to connectivity, or the
+     *         upload gave way to live data and continues on the next cycle
      */
     bool checkAndSendRetrievedData();
 
+    /**
+     * @brief Earns upload credit for the persisted data with the live data uploaded since the last call
+     * @param liveDataWaiting set to true if live data is waiting to be sent, so the next chunk uses up credit
+     * @return true if the next chunk of persisted data may be uploaded
+     */
+    bool mayUploadPersistedData( bool &liveDataWaiting );
+
     /**
      * @brief Attach a vehicle data source to IoTFleetWise. All functions in the data source must be
      * thread safe. The source instance is needed so that FleetWise can access its output data
@@ -116,12 +170,35 @@ public:
      */
     static void detachVehicleDataSource( VehicleDataSourcePtr vehicleDataSource );
 
+    /**
+     * @brief Sends the collected data to the given sender instead of AWS IoT, for example to measure the throughput
+     * of the pipeline without a cloud connection. The MQTT connection is then not established, so the decoder
+     * manifest and the collection schemes are only read from the persistency. Has to be called before connect.
+     */
+    void setCollectedDataSender( std::shared_ptr<ISender> sender );
+
+    /**
+     * @brief Creates the MQTT connection from the given shared client instead of building an own TLS context and
+     * MQTT client, so that many engines in one process use a single one. Has to be called before connect.
+     */
+    void setSharedMqttClient( std::shared_ptr<AwsIotSharedClient> sharedClient );
+
+    /**
+     * @brief Services the SocketCAN interfaces from the given reader threads, which are shared with other engines
+     * in the same process. The socketCANReaderThreads config is then ignored and the threads are not stopped by
+     * disconnect, the caller has to stop them after all engines are disconnected. Has to be called before connect.
+     */
+    void setSharedCANDataSourceEventLoops( std::vector<std::shared_ptr<CANDataSourceEventLoop>> eventLoops );
+
 private:
     // atomic state of the bus. If true, we should stop
     bool shouldStop() const;
     // Main work function for the thread
     static void doWork( void *data );
 
+    // Channels which publish, with their topic key in mqttConnection. Channels of disabled topics are nullptr.
+    std::vector<std::pair<std::string, std::shared_ptr<AwsIotChannel>>> getSendingChannels() const;
+
 public:
     std::shared_ptr<CollectedDataReadyToPublish> mCollectedDataReadyToPublish;
     // Object for handling persistency for decoder manifest, collectionSchemes and edge to cloud payload
@@ -129,6 +206,13 @@ public:
 
 private:
     static constexpr uint64_t DEFAULT_PERSISTENCY_UPLOAD_RETRY_INTERVAL_MS = 0;
+    static constexpr uint32_t DEFAULT_HOT_CONDITION_COUNT = 10;
+    // Upper bound of the per device offsets of the periodic activities, see DeviceJitter
+    static constexpr uint64_t DEFAULT_PERIODIC_JITTER_MAX_MS = 30000;
+    // Share of the SDK memory only the payloads of the express collection schemes may use
+    static constexpr double DEFAULT_EXPRESS_RESERVED_MEMORY_RATIO = 0.1;
+    // Upper bound of the connections of the MQTT connection pool
+    static constexpr uint32_t MAX_MQTT_CONNECTIONS = 8;
     Thread mThread;
     std::atomic<bool> mShouldStop{ false };
     mutable std::mutex mThreadMutex;
@@ -137,34 +221,87 @@ private:
     Timer mTimer;
     Timer mRetrySendingPersistedDataTimer;
     uint64_t mPersistencyUploadRetryIntervalMs{ DEFAULT_PERSISTENCY_UPLOAD_RETRY_INTERVAL_MS };
+    // Time after the start until the persisted data is uploaded the first time, includes the offset of the device
+    uint64_t mFirstPersistedDataUploadDelayMs{ FAST_RETRY_UPLOAD_PERSISTED_INTERVAL_MS };
+    // Share of the uploaded bytes the persisted data may take while live data is waiting, 1 for no limit
+    double mPersistedDataDrainShare{ 1.0 };
+    // Bytes of persisted data that may still be uploaded while live data is waiting, earned by uploaded live data
+    double mPersistedDataDrainCredit{ 0.0 };
+    uint64_t mLastUploadedLiveBytes{ 0 };
+    // True if the upload of the persisted data gave way to live data and is not finished
+    bool mPersistedDataDrainPending{ false };
 
     LoggingModule mLogger;
     std::shared_ptr<const Clock> mClock = ClockHandler::getClock();
     std::unique_ptr<VehicleDataSourceBinder> mVehicleDataSourceBinder;
+    // Shared SocketCAN reader threads, empty if every CAN interface has its own thread
+    std::vector<std::shared_ptr<CANDataSourceEventLoop>> mCANDataSourceEventLoops;
+    // True if mCANDataSourceEventLoops are owned by the caller of setSharedCANDataSourceEventLoops
+    bool mCANDataSourceEventLoopsShared{ false };
+    // True if the only reader thread also decodes the CAN frames and runs the inspection
+    bool mRunToCompletion{ false };
     CollectionSchemePtr mCollectionScheme;
 
     std::shared_ptr<OBDOverCANModule> mOBDOverCANModule;
+    std::vector<std::shared_ptr<SharedMemorySignalSource>> mSharedMemorySignalSources;
+    std::vector<std::shared_ptr<RemoteInspectionReceiver>> mRemoteInspectionReceivers;
+    // Sends the decoded data to the inspection on another ECU instead of the local inspection if enabled
+    std::unique_ptr<RemoteInspectionSender> mRemoteInspectionSender;
     std::shared_ptr<DataCollectionSender> mDataCollectionSender;
+    // Kept for changing their wait strategy at runtime, owned by the binder
+    std::vector<std::shared_ptr<CANDataConsumer>> mCANDataConsumers;
+    // Serializes and publishes the collected data if enabled, otherwise this is done by mDataCollectionSender
+    std::unique_ptr<DataSenderPipeline> mDataSenderPipeline;
+    // Serializes and publishes the data of the express collection schemes if enabled
+    std::unique_ptr<ExpressDataSender> mExpressDataSender;
+    // Records the collected data to local files if enabled
+    std::unique_ptr<LocalRecorder> mLocalRecorder;
 
-    std::shared_ptr<AwsIotConnectivityModule> mAwsIotModule;
+    // The MQTT connections of the pool, the first one carries all topics not assigned to another one
+    std::vector<std::shared_ptr<AwsIotConnectivityModule>> mAwsIotModules;
+    std::shared_ptr<AwsIotSharedClient> mSharedMqttClient;
     std::shared_ptr<AwsIotChannel> mAwsIotChannelSendCanData;
+    // Publishes the express payloads on their own connection if configured
+    std::shared_ptr<AwsIotChannel> mAwsIotChannelSendExpressData;
+    // Replaces mAwsIotChannelSendCanData for the collected data if set
+    std::shared_ptr<ISender> mCollectedDataSender;
     std::shared_ptr<AwsIotChannel> mAwsIotChannelSendCheckin;
     std::shared_ptr<AwsIotChannel> mAwsIotChannelReceiveCollectionSchemeList;
     std::shared_ptr<AwsIotChannel> mAwsIotChannelReceiveDecoderManifest;
+    std::shared_ptr<AwsIotChannel> mAwsIotChannelReceiveRuntimeConfig;
+    // Last runtime configuration document received, applied by the engine thread
+    std::mutex mRuntimeConfigMutex;
+    std::string mPendingRuntimeConfig;
+    bool mRuntimeConfigPending{ false };
+    std::shared_ptr<UploadShaper> mUploadShaper;
+    // Reconnects the interrupted MQTT connection when the link of the modem comes up
+    std::unique_ptr<LinkMonitor> mLinkMonitor;
     std::shared_ptr<PayloadManager> mPayloadManager;
+    // Compresses the persisted payloads in the background, only started with deferred compression
+    std::unique_ptr<PersistedDataCompactor> mPersistedDataCompactor;
+    bool mPersistedDataCompressionDeferred{ false };
 
     std::shared_ptr<Schema> mSchemaPtr;
     std::shared_ptr<CollectionSchemeManager> mCollectionSchemeManagerPtr;
 
-    std::shared_ptr<CollectionInspectionWorkerThread> mCollectionInspectionWorkerThread;
+    std::shared_ptr<CollectionInspectionRouter> mCollectionInspectionRouter;
 
     std::unique_ptr<RemoteProfiler> mRemoteProfiler;
+    std::unique_ptr<ThreadTelemetrySampler> mThreadTelemetrySampler;
+    std::unique_ptr<TraceSharedMemoryExporter> mTraceSharedMemoryExporter;
+    std::shared_ptr<PipelineLoadController> mPipelineLoadController;
+    std::shared_ptr<QueueSizeAdvisor> mQueueSizeAdvisor;
+    // Runs the periodic tasks of the control plane modules on one shared thread instead of one thread per module
+    std::shared_ptr<SerialTaskExecutor> mControlPlaneExecutor;
     std::shared_ptr<AwsIotChannel> mAwsIotChannelMetricsUpload;
     std::shared_ptr<AwsIotChannel> mAwsIotChannelLogsUpload;
+    std::shared_ptr<AwsIotChannel> mAwsIotChannelArtifactUpload;
     VehicleDataSourcePtr mVehicleDataSource;
 #ifdef FWE_FEATURE_CAMERA
     // DDS Module
     std::shared_ptr<DataOverDDSModule> mDataOverDDSModule;
+    // Uploads the artifacts of the DDS sources, only with an artifact upload topic
+    std::shared_ptr<ArtifactUploader> mArtifactUploader;
 #endif // FWE_FEATURE_CAMERA
 };
 } // namespace ExecutionManagement
@@ -0,0 +1,275 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "FleetSimulator.h"
+#include "AwsBootstrap.h"
+#include <cerrno>
+#include <fstream>
+#include <sys/stat.h>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace ExecutionManagement
+{
+
+const std::string FleetSimulator::DEFAULT_CLIENT_ID_PREFIX = "vehicle";
+
+namespace
+{
+
+std::string
+getFileContents( const std::string &p )
+{
+    constexpr auto NUM_CHARS = 1;
+    std::string ret;
+    std::ifstream fs{ p };
+    while ( fs.good() )
+    {
+        auto c = static_cast<char>( fs.get() );
+        ret.append( NUM_CHARS, c );
+    }
+
+    return ret;
+}
+
+void
+replaceAll( std::string &str, const std::string &from, const std::string &to )
+{
+    if ( from.empty() )
+    {
+        return;
+    }
+    size_t pos = 0;
+    while ( ( pos = str.find( from, pos ) ) != std::string::npos )
+    {
+        str.replace( pos, from.size(), to );
+        pos += to.size();
+    }
+}
+
+bool
+endsWith( const std::string &str, const std::string &suffix )
+{
+    return ( str.size() >= suffix.size() ) && ( str.compare( str.size() - suffix.size(), suffix.size(), suffix ) == 0 );
+}
+
+} // namespace
+
+FleetSimulator::~FleetSimulator()
+{
+    // Every engine stops its own threads on destruction. The first vehicle owns the process wide features, so it
+    // is destroyed last.
+    while ( !mEngines.empty() )
+    {
+        mEngines.pop_back();
+    }
+}
+
+bool
+FleetSimulator::isEnabled( const Json::Value &config )
+{
+    return config["staticConfig"].isMember( "fleetSimulation" ) &&
+           ( config["staticConfig"]["fleetSimulation"]["vehicleCount"].asUInt() > 0U );
+}
+
+bool
+FleetSimulator::createVehicleConfig( const Json::Value &config, uint32_t vehicleIndex, Json::Value &vehicleConfig )
+{
+    const auto &fleetConfig = config["staticConfig"]["fleetSimulation"];
+    if ( vehicleIndex >= fleetConfig["vehicleCount"].asUInt() )
+    {
+        return false;
+    }
+    std::string clientIdPrefix = DEFAULT_CLIENT_ID_PREFIX;
+    if ( fleetConfig.isMember( "clientIdPrefix" ) )
+    {
+        clientIdPrefix = fleetConfig["clientIdPrefix"].asString();
+    }
+    const auto vehicleNumber = fleetConfig["firstVehicleIndex"].asUInt() + vehicleIndex;
+    const auto clientId = clientIdPrefix + std::to_string( vehicleNumber );
+
+    vehicleConfig = config;
+    auto &staticConfig = vehicleConfig["staticConfig"];
+    staticConfig.removeMember( "fleetSimulation" );
+
+    // The topics usually contain the thing name, which is the client ID
+    auto &mqttConnection = staticConfig["mqttConnection"];
+    const auto originalClientId = mqttConnection["clientId"].asString();
+    for ( const auto &name : mqttConnection.getMemberNames() )
+    {
+        if ( endsWith( name, "Topic" ) && mqttConnection[name].isString() )
+        {
+            auto topic = mqttConnection[name].asString();
+            replaceAll( topic, originalClientId, clientId );
+            mqttConnection[name] = topic;
+        }
+    }
+    mqttConnection["clientId"] = clientId;
+
+    auto persistencyPath = staticConfig["persistency"]["persistencyPath"].asString();
+    if ( ( !persistencyPath.empty() ) && ( persistencyPath.back() != '/' ) )
+    {
+        persistencyPath += "/";
+    }
+    staticConfig["persistency"]["persistencyPath"] = persistencyPath + clientId;
+
+    if ( vehicleIndex > 0 )
+    {
+        staticConfig.removeMember( "remoteProfilerDefaultValues" );
+        staticConfig["internalParameters"].removeMember( "threadTelemetrySamplingPeriodMs" );
+        staticConfig["internalParameters"].removeMember( "latencyTraceSamplingInterval" );
+        staticConfig["internalParameters"].removeMember( "traceSharedMemoryName" );
+        // The vehicles would record into the same files
+        staticConfig.removeMember( "localRecording" );
+    }
+    return true;
+}
+
+bool
+FleetSimulator::connect( const Json::Value &config )
+{
+    if ( !isEnabled( config ) )
+    {
+        mLogger.error( "FleetSimulator::connect", " No vehicles configured " );
+        return false;
+    }
+    const auto &fleetConfig = config["staticConfig"]["fleetSimulation"];
+    const auto vehicleCount = fleetConfig["vehicleCount"].asUInt();
+
+    const auto &mqttConnection = config["staticConfig"]["mqttConnection"];
+    mSharedMqttClient = std::make_shared<AwsIotSharedClient>();
+    if ( !mSharedMqttClient->init( getFileContents( mqttConnection["privateKeyFilename"].asString() ),
+                                   getFileContents( mqttConnection["certificateFilename"].asString() ),
+                                   mqttConnection["endpointUrl"].asString(),
+                                   AwsBootstrap::getInstance().getClientBootStrap() ) )
+    {
+        mLogger.error( "FleetSimulator::connect", " Failed to create the shared MQTT client " );
+        return false;
+    }
+
+    // Without shared reader threads every CAN interface of every vehicle would have its own thread
+    uint32_t socketCANReaderThreads = 1;
+    if ( fleetConfig.isMember( "socketCANReaderThreads" ) )
+    {
+        socketCANReaderThreads = fleetConfig["socketCANReaderThreads"].asUInt();
+    }
+    for ( uint32_t i = 0; i < socketCANReaderThreads; i++ )
+    {
+        auto eventLoop = std::make_shared<CANDataSourceEventLoop>();
+        if ( !eventLoop->start() )
+        {
+            mLogger.error( "FleetSimulator::connect", " Failed to start the SocketCAN reader thread " );
+            return false;
+        }
+        mCANDataSourceEventLoops.emplace_back( eventLoop );
+    }
+
+    for ( uint32_t i = 0; i < vehicleCount; i++ )
+    {
+        Json::Value vehicleConfig;
+        if ( !createVehicleConfig( config, i, vehicleConfig ) )
+        {
+            return false;
+        }
+        const auto persistencyPath = vehicleConfig["staticConfig"]["persistency"]["persistencyPath"].asString();
+        if ( ( mkdir( persistencyPath.c_str(), S_IRWXU ) != 0 ) && ( errno != EEXIST ) )
+        {
+            mLogger.error( "FleetSimulator::connect",
+                           " Failed to create the persistency directory " + persistencyPath );
+            return false;
+        }
+        std::unique_ptr<IoTFleetWiseEngine> engine( new IoTFleetWiseEngine() );
+        engine->setSharedMqttClient( mSharedMqttClient );
+        if ( !mCANDataSourceEventLoops.empty() )
+        {
+            engine->setSharedCANDataSourceEventLoops( mCANDataSourceEventLoops );
+        }
+        if ( !engine->connect( vehicleConfig ) )
+        {
+            mLogger.error( "FleetSimulator::connect",
+                           " Failed to connect vehicle " +
+                               vehicleConfig["staticConfig"]["mqttConnection"]["clientId"].asString() );
+            return false;
+        }
+        mEngines.emplace_back( std::move( engine ) );
+    }
+    mLogger.info( "FleetSimulator::connect", " Connected " + std::to_string( mEngines.size() ) + " vehicles " );
+    return true;
+}
+
+bool
+FleetSimulator::start()
+{
+    for ( auto &engine : mEngines )
+    {
+        if ( !engine->start() )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool
+FleetSimulator::stop()
+{
+    bool success = true;
+    for ( auto &engine : mEngines )
+    {
+        success = engine->stop() && success;
+    }
+    return success;
+}
+
+bool
+FleetSimulator::disconnect()
+{
+    bool success = true;
+    for ( auto &engine : mEngines )
+    {
+        success = engine->disconnect() && success;
+    }
+    // Only stopped after all vehicles removed their CAN sockets
+    for ( auto &eventLoop : mCANDataSourceEventLoops )
+    {
+        if ( !eventLoop->stop() )
+        {
+            mLogger.error( "FleetSimulator::disconnect", " Could not stop the SocketCAN reader thread " );
+            success = false;
+        }
+    }
+    return success;
+}
+
+bool
+FleetSimulator::isAlive()
+{
+    if ( mEngines.empty() )
+    {
+        return false;
+    }
+    for ( auto &engine : mEngines )
+    {
+        if ( !engine->isAlive() )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace ExecutionManagement
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -37,6 +37,51 @@ IoTFleetWiseConfig::read( const std::string &filename, Json::Value &config )
     return true;
 }
 
+bool
+IoTFleetWiseConfig::readThreadConfigs( const Json::Value &threads,
+                                       std::map<std::string, Platform::Linux::ThreadConfig> &threadConfigs )
+{
+    using namespace Aws::IoTFleetWise::Platform::Linux;
+    for ( const auto &name : threads.getMemberNames() )
+    {
+        const auto &threadConfig = threads[name];
+        ThreadConfig parsedConfig;
+        for ( const auto &cpu : threadConfig["cpuAffinity"] )
+        {
+            parsedConfig.cpuAffinity.push_back( cpu.asUInt() );
+        }
+        if ( threadConfig.isMember( "schedulingPolicy" ) )
+        {
+            auto policy = threadConfig["schedulingPolicy"].asString();
+            if ( policy == "SCHED_OTHER" )
+            {
+                parsedConfig.schedulingPolicy = ThreadSchedulingPolicy::OTHER;
+            }
+            else if ( policy == "SCHED_FIFO" )
+            {
+                parsedConfig.schedulingPolicy = ThreadSchedulingPolicy::FIFO;
+            }
+            else if ( policy == "SCHED_RR" )
+            {
+                parsedConfig.schedulingPolicy = ThreadSchedulingPolicy::RR;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        parsedConfig.priority = threadConfig["priority"].asInt();
+        if ( threadConfig.isMember( "nice" ) )
+        {
+            parsedConfig.hasNice = true;
+            parsedConfig.nice = threadConfig["nice"].asInt();
+        }
+        parsedConfig.stackSizeBytes = threadConfig["stackSizeBytes"].asUInt();
+        threadConfigs[name] = parsedConfig;
+    }
+    return true;
+}
+
 } // namespace ExecutionManagement
 } // namespace IoTFleetWise
 } // namespace Aws
@@ -17,10 +17,22 @@
 #include "CANDataConsumer.h"
 #include "CollectionInspectionAPITypes.h"
 #include "CollectionSchemeJSONParser.h"
+#include "InstrumentedMutex.h"
+#include "IoTFleetWiseConfig.h"
+#include "LatencyTracer.h"
+#include "LowActivityMode.h"
+#include "MemoryAccounting.h"
+#include "MemoryArena.h"
+#include "StallWatchdog.h"
 #include "TraceModule.h"
 #include "businterfaces/AbstractVehicleDataSource.h"
 #include "businterfaces/CANDataSource.h"
+#include "businterfaces/CANDataSourceEventLoop.h"
+#include "businterfaces/CANLogReplayDataSource.h"
 #include <boost/lockfree/spsc_queue.hpp>
+#include <future>
+#include <set>
+#include <sstream>
 
 namespace Aws
 {
@@ -38,7 +50,10 @@ const uint64_t IoTFleetWiseEngine::FAST_RETRY_UPLOAD_PERSISTED_INTERVAL_MS = 100
 const uint64_t IoTFleetWiseEngine::DEFAULT_RETRY_UPLOAD_PERSISTED_INTERVAL_MS = 10000;
 
 static const std::string CAN_INTERFACE_TYPE = "canInterface";
+static const std::string CAN_LOG_REPLAY_INTERFACE_TYPE = "canLogReplayInterface";
 static const std::string OBD_INTERFACE_TYPE = "obdInterface";
+static const std::string SHARED_MEMORY_SIGNAL_INTERFACE_TYPE = "sharedMemorySignalInterface";
+static const std::string REMOTE_INSPECTION_INTERFACE_TYPE = "remoteInspectionInterface";
 
 namespace
 {
@@ -66,6 +81,170 @@ getFileContents( const std::string &p )
     return ret;
 }
 
+/**
+ * @brief Reads the optional publishToCloudParameters.payloadAggregation classes
+ *
+ * @param publishToCloudParameters the publishToCloudParameters section of the static config
+ * @return the aggregation classes, empty if small payloads are not aggregated
+ */
+std::vector<PayloadAggregationClass>
+getPayloadAggregationClasses( const Json::Value &publishToCloudParameters )
+{
+    std::vector<PayloadAggregationClass> classes;
+    for ( const auto &aggregationClass : publishToCloudParameters["payloadAggregation"] )
+    {
+        PayloadAggregationClass parsedClass;
+        parsedClass.maxPriority = aggregationClass["maxPriority"].asUInt();
+        parsedClass.maxBytes = aggregationClass["maxBytes"].asUInt();
+        parsedClass.maxDelayMs = aggregationClass["maxDelayMs"].asUInt();
+        classes.emplace_back( parsedClass );
+    }
+    return classes;
+}
+
+std::vector<SendPriorityLevel>
+getSendPriorityLevels( const Json::Value &publishToCloudParameters )
+{
+    std::vector<SendPriorityLevel> levels;
+    for ( const auto &level : publishToCloudParameters["sendPriorityLevels"] )
+    {
+        SendPriorityLevel parsedLevel;
+        parsedLevel.maxPriority = level["maxPriority"].asUInt();
+        parsedLevel.maxInFlight = level["maxInFlight"].asUInt();
+        levels.emplace_back( parsedLevel );
+    }
+    return levels;
+}
+
+/**
+ * @brief Reads the optional publishToCloudParameters.adaptiveCompression section, absent values keep their default
+ *
+ * @param adaptiveCompression the adaptiveCompression section
+ * @param config the parsed config
+ * @return false if a codec name is unknown
+ */
+bool
+getAdaptiveCompressionConfig( const Json::Value &adaptiveCompression, AdaptiveCompressionConfig &config )
+{
+    if ( ( adaptiveCompression.isMember( "fastestCodec" ) &&
+           ( !getCompressionCodecType( adaptiveCompression["fastestCodec"].asString(), config.fastest.codec ) ) ) ||
+         ( adaptiveCompression.isMember( "strongestCodec" ) &&
+           ( !getCompressionCodecType( adaptiveCompression["strongestCodec"].asString(), config.strongest.codec ) ) ) )
+    {
+        return false;
+    }
+    config.fastest.level = adaptiveCompression.get( "fastestLevel", config.fastest.level ).asInt();
+    config.strongest.level = adaptiveCompression.get( "strongestLevel", config.strongest.level ).asInt();
+    config.maxCpuPercent = adaptiveCompression.get( "maxSenderCpuPercent", config.maxCpuPercent ).asDouble();
+    config.targetBacklogSeconds =
+        adaptiveCompression.get( "targetBacklogSeconds", config.targetBacklogSeconds ).asDouble();
+    config.intervalMs = adaptiveCompression.get( "intervalMs", config.intervalMs ).asUInt();
+    return true;
+}
+
+bool
+hasOnlyMembers( const Json::Value &object, const std::set<std::string> &allowedMembers )
+{
+    if ( !object.isObject() )
+    {
+        return false;
+    }
+    for ( const auto &name : object.getMemberNames() )
+    {
+        if ( allowedMembers.find( name ) == allowedMembers.end() )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+const std::set<std::string> UPLOAD_RATE_LIMIT_MEMBERS = {
+    "bytesPerSecond", "burstBytes", "publishesPerSecond", "burstPublishes" };
+
+bool
+isUploadRateLimitValid( const Json::Value &rateLimit, const std::set<std::string> &allowedMembers )
+{
+    if ( !hasOnlyMembers( rateLimit, allowedMembers ) )
+    {
+        return false;
+    }
+    for ( const auto &name : UPLOAD_RATE_LIMIT_MEMBERS )
+    {
+        if ( rateLimit.isMember( name ) &&
+             ( ( !rateLimit[name].isNumeric() ) || ( rateLimit[name].asDouble() < 0.0 ) ) )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+UploadRateLimit
+getUploadRateLimit( const Json::Value &rateLimit )
+{
+    UploadRateLimit parsedLimit;
+    parsedLimit.bytesPerSecond = rateLimit["bytesPerSecond"].asDouble();
+    parsedLimit.burstBytes = rateLimit["burstBytes"].asDouble();
+    parsedLimit.publishesPerSecond = rateLimit["publishesPerSecond"].asDouble();
+    parsedLimit.burstPublishes = rateLimit["burstPublishes"].asDouble();
+    return parsedLimit;
+}
+
+// Topics which can be assigned to a connection of the MQTT connection pool
+const std::set<std::string> CONNECTION_POOL_TOPICS = { "canDataTopic",
+                                                       "checkinTopic",
+                                                       "collectionSchemeListTopic",
+                                                       "decoderManifestTopic",
+                                                       "runtimeConfigTopic",
+                                                       "metricsUploadTopic",
+                                                       "loggingUploadTopic",
+                                                       "artifactUploadTopic" };
+
+bool
+isConnectionIndexValid( const Json::Value &index, uint32_t connectionCount )
+{
+    return index.isUInt() && ( index.asUInt() < connectionCount );
+}
+
+bool
+isConnectionPoolValid( const Json::Value &connectionPool, uint32_t connectionCount )
+{
+    if ( connectionPool.isNull() )
+    {
+        return true;
+    }
+    if ( ( !hasOnlyMembers( connectionPool, { "connections", "topics", "expressConnection" } ) ) ||
+         ( connectionPool.isMember( "topics" ) &&
+           ( !hasOnlyMembers( connectionPool["topics"], CONNECTION_POOL_TOPICS ) ) ) )
+    {
+        return false;
+    }
+    for ( const auto &topic : connectionPool["topics"].getMemberNames() )
+    {
+        if ( !isConnectionIndexValid( connectionPool["topics"][topic], connectionCount ) )
+        {
+            return false;
+        }
+    }
+    return ( !connectionPool.isMember( "expressConnection" ) ) ||
+           isConnectionIndexValid( connectionPool["expressConnection"], connectionCount );
+}
+
+// Returns the index of the pool connection a topic is published or subscribed on, by default the first one
+uint32_t
+getTopicConnection( const Json::Value &connectionPool, const std::string &topic )
+{
+    return connectionPool["topics"].isMember( topic ) ? connectionPool["topics"][topic].asUInt() : 0;
+}
+
+// Every connection of the pool needs its own client ID, otherwise the broker disconnects the previous one
+std::string
+getConnectionClientId( const std::string &clientId, size_t connectionIndex )
+{
+    return connectionIndex == 0 ? clientId : clientId + "-" + std::to_string( connectionIndex );
+}
+
 } // namespace
 
 IoTFleetWiseEngine::IoTFleetWiseEngine()
@@ -87,6 +266,25 @@ IoTFleetWiseEngine::~IoTFleetWiseEngine()
     setLogForwarding( nullptr );
 }
 
+void
+IoTFleetWiseEngine::setCollectedDataSender( std::shared_ptr<ISender> sender )
+{
+    mCollectedDataSender = std::move( sender );
+}
+
+void
+IoTFleetWiseEngine::setSharedMqttClient( std::shared_ptr<AwsIotSharedClient> sharedClient )
+{
+    mSharedMqttClient = std::move( sharedClient );
+}
+
+void
+IoTFleetWiseEngine::setSharedCANDataSourceEventLoops( std::vector<std::shared_ptr<CANDataSourceEventLoop>> eventLoops )
+{
+    mCANDataSourceEventLoops = std::move( eventLoops );
+    mCANDataSourceEventLoopsShared = true;
+}
+
 void
 IoTFleetWiseEngine::attachVehicleDataSource( VehicleDataSourcePtr vehicleDataSource )
 {
@@ -103,19 +301,134 @@ IoTFleetWiseEngine::detachVehicleDataSource( VehicleDataSourcePtr vehicleDataSou
 bool
 IoTFleetWiseEngine::connect( const Json::Value &config )
 {
-    // Main bootstrap sequence.
+    // Main bootstrap sequence. The modules are brought up in the order of their dependencies:
+    // - Loading the persisted data runs in parallel to the bring-up of the other modules, only the OBD module
+    //   (ECU cache) and the CollectionScheme Manager (persisted decoder manifest and collection schemes) wait for it
+    // - The CollectionScheme Manager starts last, after all its listeners subscribed, so data acquisition starts
+    //   from the persisted collection schemes
+    // - The MQTT connection is set up after that, so a slow TLS handshake does not delay the data acquisition
     try
     {
+        // Optionally reserve one region for the queues and history buffers before any of them is created
+        const auto &internalParameters = config["staticConfig"]["internalParameters"];
+        if ( internalParameters.isMember( "memoryArenaSizeBytes" ) && ( MemoryArena::get().getReservedBytes() == 0 ) )
+        {
+            if ( !MemoryArena::get().reserve( internalParameters["memoryArenaSizeBytes"].asUInt64(),
+                                              internalParameters["memoryArenaLocked"].asBool() ) )
+            {
+                mLogger.warn( "IoTFleetWiseEngine::connect", " No memory arena, buffers are allocated on the heap " );
+            }
+        }
+        // Optional ceilings of the memory accounted per subsystem, exceeding them is counted in MemCeil
+        if ( internalParameters.isMember( "memoryCeilingsBytes" ) )
+        {
+            const auto &ceilings = internalParameters["memoryCeilingsBytes"];
+            for ( const auto &name : ceilings.getMemberNames() )
+            {
+                MemorySubsystem subsystem{};
+                if ( !MemoryAccounting::getSubsystem( name, subsystem ) )
+                {
+                    mLogger.warn( "IoTFleetWiseEngine::connect", "Unknown memory subsystem " + name );
+                    continue;
+                }
+                MemoryAccounting::setCeiling( subsystem, static_cast<size_t>( ceilings[name].asUInt64() ) );
+            }
+        }
+        // Optionally save power while the vehicle is parked, the threads read the mode when they start
+        if ( internalParameters.isMember( "lowActivityMode" ) )
+        {
+            const auto &lowActivityConfig = internalParameters["lowActivityMode"];
+            LowActivityMode::Config lowActivityModeConfig;
+            lowActivityModeConfig.busSilenceTimeMs = lowActivityConfig["busSilenceTimeMs"].asUInt();
+            if ( lowActivityConfig.isMember( "ignitionSignalId" ) )
+            {
+                lowActivityModeConfig.ignitionSignalId = lowActivityConfig["ignitionSignalId"].asUInt();
+            }
+            if ( lowActivityConfig.isMember( "wakeupTickMs" ) )
+            {
+                lowActivityModeConfig.wakeupTickMs = lowActivityConfig["wakeupTickMs"].asUInt();
+            }
+            if ( lowActivityConfig.isMember( "timerSlackUs" ) )
+            {
+                lowActivityModeConfig.timerSlackNs = lowActivityConfig["timerSlackUs"].asUInt64() * 1000;
+            }
+            if ( !LowActivityMode::get().init( lowActivityModeConfig ) )
+            {
+                mLogger.error( "IoTFleetWiseEngine::connect", " Invalid low activity mode config " );
+                return false;
+            }
+        }
+        // The periodic traffic of a fleet powered on at the same time is spread by offsets derived from the client ID
+        uint64_t periodicJitterMaxMs = DEFAULT_PERIODIC_JITTER_MAX_MS;
+        if ( internalParameters.isMember( "periodicJitterMaxMs" ) )
+        {
+            periodicJitterMaxMs = internalParameters["periodicJitterMaxMs"].asUInt64();
+        }
+        const DeviceJitter deviceJitter( config["staticConfig"]["mqttConnection"]["clientId"].asString(),
+                                         periodicJitterMaxMs );
         const auto persistencyPath = config["staticConfig"]["persistency"]["persistencyPath"].asString();
         /*************************Payload Manager and Persistency library bootstrap begin*********/
 
         // Create an object for Persistency
-        mPersistDecoderManifestCollectionSchemesAndData = std::make_shared<CacheAndPersist>(
-            persistencyPath, config["staticConfig"]["persistency"]["persistencyPartitionMaxSize"].asInt() );
-        if ( !mPersistDecoderManifestCollectionSchemesAndData->init() )
+        size_t persistencySegmentSize = SegmentedLog::DEFAULT_SEGMENT_SIZE;
+        if ( config["staticConfig"]["persistency"].isMember( "persistencySegmentSize" ) )
+        {
+            persistencySegmentSize = config["staticConfig"]["persistency"]["persistencySegmentSize"].asUInt();
+        }
+        // Optionally buffer the writes of collected data and write them in batches
+        SegmentedLog::WriteBatchConfig writeBatchConfig;
+        const auto &persistencyConfig = config["staticConfig"]["persistency"];
+        if ( persistencyConfig.isMember( "persistencyWriteBatchSize" ) )
+        {
+            writeBatchConfig.batchSize = persistencyConfig["persistencyWriteBatchSize"].asUInt();
+        }
+        if ( persistencyConfig.isMember( "persistencyWriteBatchIntervalMs" ) )
+        {
+            writeBatchConfig.flushIntervalMs = persistencyConfig["persistencyWriteBatchIntervalMs"].asUInt();
+        }
+        if ( persistencyConfig.isMember( "persistencyFsyncPolicy" ) )
+        {
+            const auto fsyncPolicy = persistencyConfig["persistencyFsyncPolicy"].asString();
+            if ( fsyncPolicy == "never" )
+            {
+                writeBatchConfig.fsyncPolicy = SegmentedLog::FsyncPolicy::NEVER;
+            }
+            else if ( fsyncPolicy == "perBatch" )
+            {
+                writeBatchConfig.fsyncPolicy = SegmentedLog::FsyncPolicy::PER_BATCH;
+            }
+            else if ( fsyncPolicy == "interval" )
+            {
+                writeBatchConfig.fsyncPolicy = SegmentedLog::FsyncPolicy::INTERVAL;
+            }
+            else
+            {
+                mLogger.warn( "IoTFleetWiseEngine::connect",
+                              " Unsupported persistencyFsyncPolicy " + fsyncPolicy + ", data is never synced" );
+            }
+        }
+        if ( persistencyConfig.isMember( "persistencyFsyncIntervalMs" ) )
         {
-            mLogger.error( "IoTFleetWiseEngine::connect", " Failed to init persistency library " );
+            writeBatchConfig.fsyncIntervalMs = persistencyConfig["persistencyFsyncIntervalMs"].asUInt();
         }
+        mPersistDecoderManifestCollectionSchemesAndData = std::make_shared<CacheAndPersist>(
+            persistencyPath,
+            config["staticConfig"]["persistency"]["persistencyPartitionMaxSize"].asInt(),
+            persistencySegmentSize,
+            writeBatchConfig );
+        auto persistency = mPersistDecoderManifestCollectionSchemesAndData;
+        auto persistencyInit = std::async( std::launch::async, [persistency]() {
+            TraceModule::get().sectionBegin( TraceSection::STARTUP_PERSISTENCY );
+            auto success = persistency->init();
+            TraceModule::get().sectionEnd( TraceSection::STARTUP_PERSISTENCY );
+            return success;
+        } );
+        auto waitForPersistency = [this, &persistencyInit]() {
+            if ( persistencyInit.valid() && ( !persistencyInit.get() ) )
+            {
+                mLogger.error( "IoTFleetWiseEngine::connect", " Failed to init persistency library " );
+            }
+        };
         if ( config["staticConfig"]["persistency"].isMember( "PersistencyUploadRetryIntervalMs" ) )
         {
             mPersistencyUploadRetryIntervalMs =
@@ -125,18 +438,113 @@ IoTFleetWiseEngine::connect( const Json::Value &config )
         {
             mPersistencyUploadRetryIntervalMs = DEFAULT_RETRY_UPLOAD_PERSISTED_INTERVAL_MS;
         }
+        // The retries keep the phase of the first upload
+        mFirstPersistedDataUploadDelayMs =
+            FAST_RETRY_UPLOAD_PERSISTED_INTERVAL_MS +
+            deviceJitter.getOffsetMs( "persistedDataUpload",
+                                      ( mPersistencyUploadRetryIntervalMs > 0 )
+                                          ? mPersistencyUploadRetryIntervalMs
+                                          : DEFAULT_RETRY_UPLOAD_PERSISTED_INTERVAL_MS );
         // Payload Manager for offline data management
         mPayloadManager = std::make_shared<PayloadManager>( mPersistDecoderManifestCollectionSchemesAndData );
+        // Order in which the persisted data is uploaded after a reconnect
+        PersistedDataDrainPolicy drainPolicy;
+        if ( persistencyConfig.isMember( "persistencyDrainPriorityFirst" ) )
+        {
+            drainPolicy.priorityFirst = persistencyConfig["persistencyDrainPriorityFirst"].asBool();
+        }
+        if ( persistencyConfig.isMember( "persistencyDrainOrder" ) )
+        {
+            const auto drainOrder = persistencyConfig["persistencyDrainOrder"].asString();
+            if ( drainOrder == "newestFirst" )
+            {
+                drainPolicy.newestFirst = true;
+            }
+            else if ( drainOrder != "oldestFirst" )
+            {
+                mLogger.warn( "IoTFleetWiseEngine::connect",
+                              " Unsupported persistencyDrainOrder " + drainOrder + ", oldest data is sent first" );
+            }
+        }
+        mPayloadManager->setDrainPolicy( drainPolicy );
+        // Optionally the payloads are stored uncompressed and compressed in the background while the CPU is idle
+        double compactionMaxCpuPercent = PersistedDataCompactor::DEFAULT_MAX_CPU_PERCENT;
+        if ( persistencyConfig.isMember( "persistencyCompactionMaxCpuPercent" ) )
+        {
+            compactionMaxCpuPercent = persistencyConfig["persistencyCompactionMaxCpuPercent"].asDouble();
+        }
+        // Also created without deferred compression, payloads compacted by an earlier run must still be readable
+        mPersistedDataCompactor = std::make_unique<PersistedDataCompactor>(
+            mPayloadManager, mPersistDecoderManifestCollectionSchemesAndData, compactionMaxCpuPercent );
+        if ( persistencyConfig.isMember( "persistencyDeferredCompression" ) )
+        {
+            mPersistedDataCompressionDeferred = persistencyConfig["persistencyDeferredCompression"].asBool();
+        }
+        mPayloadManager->setDeferredCompression( mPersistedDataCompressionDeferred );
+        if ( persistencyConfig.isMember( "persistencyDrainShare" ) )
+        {
+            const auto drainShare = persistencyConfig["persistencyDrainShare"].asDouble();
+            if ( ( drainShare > 0.0 ) && ( drainShare <= 1.0 ) )
+            {
+                mPersistedDataDrainShare = drainShare;
+            }
+            else
+            {
+                mLogger.warn( "IoTFleetWiseEngine::connect",
+                              " Invalid persistencyDrainShare " + std::to_string( drainShare ) +
+                                  ", persisted data is not limited" );
+            }
+        }
 
         /*************************Payload Manager and Persistency library bootstrap end************/
 
         /*************************CAN InterfaceID to InternalID Translator begin*********/
         CANInterfaceIDTranslator canIDTranslator;
 
+        // Optionally service all CAN sockets from a fixed number of threads instead of one thread per interface
+        uint32_t socketCANReaderThreads = 0;
+        if ( ( !mCANDataSourceEventLoopsShared ) &&
+             config["staticConfig"]["internalParameters"].isMember( "socketCANReaderThreads" ) )
+        {
+            socketCANReaderThreads = config["staticConfig"]["internalParameters"]["socketCANReaderThreads"].asUInt();
+        }
+        // Optionally receive, decode and inspect the frames of all CAN interfaces on a single thread without the
+        // queues in between, e.g. on single core targets with one CAN bus
+        if ( config["staticConfig"]["internalParameters"]["runToCompletion"].asBool() )
+        {
+            if ( mCANDataSourceEventLoopsShared )
+            {
+                mLogger.warn( "IoTFleetWiseEngine::connect",
+                              " The run to completion mode is not supported with shared SocketCAN reader threads" );
+            }
+            else if ( config["staticConfig"].isMember( "remoteInspection" ) )
+            {
+                mLogger.warn( "IoTFleetWiseEngine::connect",
+                              " The run to completion mode is not supported with the remote inspection" );
+            }
+            else
+            {
+                mRunToCompletion = true;
+                socketCANReaderThreads = 1;
+            }
+        }
+        for ( uint32_t i = 0; i < socketCANReaderThreads; i++ )
+        {
+            auto eventLoop = std::make_shared<CANDataSourceEventLoop>();
+            if ( !eventLoop->start() )
+            {
+                mLogger.error( "IoTFleetWiseEngine::connect", " Failed to start the SocketCAN reader thread " );
+                return false;
+            }
+            mCANDataSourceEventLoops.emplace_back( eventLoop );
+        }
+        size_t canInterfaceCount = 0;
+
         // Initialize
         for ( const auto &interfaceName : config["networkInterfaces"] )
         {
-            if ( interfaceName["type"].asString() == CAN_INTERFACE_TYPE )
+            if ( ( interfaceName["type"].asString() == CAN_INTERFACE_TYPE ) ||
+                 ( interfaceName["type"].asString() == CAN_LOG_REPLAY_INTERFACE_TYPE ) )
             {
                 canIDTranslator.add( interfaceName["interfaceId"].asString() );
             }
@@ -144,19 +552,92 @@ IoTFleetWiseEngine::connect( const Json::Value &config )
         /*************************CAN InterfaceID to InternalID Translator end*********/
 
         /**************************Connectivity bootstrap begin*******************************/
+        TraceModule::get().sectionBegin( TraceSection::STARTUP_CONNECTIVITY );
 
-        mAwsIotModule = std::make_shared<AwsIotConnectivityModule>();
+        // Optionally spread the topics over a small pool of MQTT connections, so that the large publishes on one
+        // connection do not delay the publishes and subscriptions on the others
+        const auto &connectionPool = config["staticConfig"]["mqttConnection"]["connectionPool"];
+        uint32_t connectionCount = 1;
+        if ( connectionPool.isMember( "connections" ) )
+        {
+            connectionCount = connectionPool["connections"].isUInt() ? connectionPool["connections"].asUInt() : 0;
+        }
+        if ( ( connectionCount == 0 ) || ( connectionCount > MAX_MQTT_CONNECTIONS ) ||
+             ( !isConnectionPoolValid( connectionPool, connectionCount ) ) )
+        {
+            mLogger.error( "IoTFleetWiseEngine::connect",
+                           " Invalid MQTT connection pool, at most " + std::to_string( MAX_MQTT_CONNECTIONS ) +
+                               " connections are supported and the topics must be assigned to one of them " );
+            return false;
+        }
+        mAwsIotModules.clear();
+        for ( uint32_t i = 0; i < connectionCount; i++ )
+        {
+            auto awsIotModule = std::make_shared<AwsIotConnectivityModule>();
+            if ( mSharedMqttClient != nullptr )
+            {
+                awsIotModule->setSharedClient( mSharedMqttClient );
+            }
+            mAwsIotModules.push_back( awsIotModule );
+        }
+        // Optionally reconnect faster on links which often lose coverage for a few seconds, like cellular links
+        if ( config["staticConfig"]["mqttConnection"].isMember( "reconnect" ) )
+        {
+            const auto &reconnect = config["staticConfig"]["mqttConnection"]["reconnect"];
+            MqttReconnectConfig reconnectConfig;
+            if ( reconnect.isMember( "minBackoffSeconds" ) )
+            {
+                reconnectConfig.minBackoffSeconds = reconnect["minBackoffSeconds"].asUInt();
+            }
+            if ( reconnect.isMember( "maxBackoffSeconds" ) )
+            {
+                reconnectConfig.maxBackoffSeconds = reconnect["maxBackoffSeconds"].asUInt();
+            }
+            if ( reconnect.isMember( "keepAliveSeconds" ) )
+            {
+                reconnectConfig.keepAliveSeconds = static_cast<uint16_t>( reconnect["keepAliveSeconds"].asUInt() );
+            }
+            if ( reconnect.isMember( "pingTimeoutMs" ) )
+            {
+                reconnectConfig.pingTimeoutMs = reconnect["pingTimeoutMs"].asUInt();
+            }
+            for ( auto &awsIotModule : mAwsIotModules )
+            {
+                awsIotModule->setReconnectConfig( reconnectConfig );
+            }
+            // The link up events of the modem interface end the backoff of all interrupted connections
+            if ( reconnect.isMember( "linkInterface" ) )
+            {
+                std::vector<std::weak_ptr<AwsIotConnectivityModule>> awsIotModules( mAwsIotModules.begin(),
+                                                                                    mAwsIotModules.end() );
+                mLinkMonitor =
+                    std::make_unique<LinkMonitor>( reconnect["linkInterface"].asString(), [awsIotModules]() {
+                        for ( const auto &awsIotModule : awsIotModules )
+                        {
+                            auto module = awsIotModule.lock();
+                            if ( module != nullptr )
+                            {
+                                module->onLinkUp();
+                            }
+                        }
+                    } );
+            }
+        }
 
         // Only CAN data channel needs a payloadManager object for persistency and compression support,
         // for other components this will be nullptr
-        mAwsIotChannelSendCanData = mAwsIotModule->createNewChannel( mPayloadManager );
+        mAwsIotChannelSendCanData =
+            mAwsIotModules[getTopicConnection( connectionPool, "canDataTopic" )]->createNewChannel( mPayloadManager );
         mAwsIotChannelSendCanData->setTopic( config["staticConfig"]["mqttConnection"]["canDataTopic"].asString() );
 
-        mAwsIotChannelReceiveCollectionSchemeList = mAwsIotModule->createNewChannel( nullptr );
+        mAwsIotChannelReceiveCollectionSchemeList =
+            mAwsIotModules[getTopicConnection( connectionPool, "collectionSchemeListTopic" )]->createNewChannel(
+                nullptr );
         mAwsIotChannelReceiveCollectionSchemeList->setTopic(
             config["staticConfig"]["mqttConnection"]["collectionSchemeListTopic"].asString(), true );
 
-        mAwsIotChannelReceiveDecoderManifest = mAwsIotModule->createNewChannel( nullptr );
+        mAwsIotChannelReceiveDecoderManifest =
+            mAwsIotModules[getTopicConnection( connectionPool, "decoderManifestTopic" )]->createNewChannel( nullptr );
         mAwsIotChannelReceiveDecoderManifest->setTopic(
             config["staticConfig"]["mqttConnection"]["decoderManifestTopic"].asString(), true );
 
@@ -167,7 +648,8 @@ IoTFleetWiseEngine::connect( const Json::Value &config )
          */
         if ( config["staticConfig"]["mqttConnection"]["metricsUploadTopic"].asString().length() > 0 )
         {
-            mAwsIotChannelMetricsUpload = mAwsIotModule->createNewChannel( nullptr );
+            mAwsIotChannelMetricsUpload =
+                mAwsIotModules[getTopicConnection( connectionPool, "metricsUploadTopic" )]->createNewChannel( nullptr );
             mAwsIotChannelMetricsUpload->setTopic(
                 config["staticConfig"]["mqttConnection"]["metricsUploadTopic"].asString() );
         }
@@ -177,43 +659,275 @@ IoTFleetWiseEngine::connect( const Json::Value &config )
          */
         if ( config["staticConfig"]["mqttConnection"]["loggingUploadTopic"].asString().length() > 0 )
         {
-            mAwsIotChannelLogsUpload = mAwsIotModule->createNewChannel( nullptr );
+            mAwsIotChannelLogsUpload =
+                mAwsIotModules[getTopicConnection( connectionPool, "loggingUploadTopic" )]->createNewChannel( nullptr );
             mAwsIotChannelLogsUpload->setTopic(
                 config["staticConfig"]["mqttConnection"]["loggingUploadTopic"].asString() );
         }
 
+        // Optionally upload the artifacts of the sensors, e.g. camera recordings, in chunks
+        if ( config["staticConfig"]["mqttConnection"]["artifactUploadTopic"].asString().length() > 0 )
+        {
+            mAwsIotChannelArtifactUpload = mAwsIotModules[getTopicConnection( connectionPool, "artifactUploadTopic" )]
+                                               ->createNewChannel( nullptr );
+            mAwsIotChannelArtifactUpload->setTopic(
+                config["staticConfig"]["mqttConnection"]["artifactUploadTopic"].asString() );
+        }
+
         // Create an ISender for sending Checkins
-        mAwsIotChannelSendCheckin = mAwsIotModule->createNewChannel( nullptr );
+        mAwsIotChannelSendCheckin =
+            mAwsIotModules[getTopicConnection( connectionPool, "checkinTopic" )]->createNewChannel( nullptr );
         mAwsIotChannelSendCheckin->setTopic( config["staticConfig"]["mqttConnection"]["checkinTopic"].asString() );
 
+        // Optionally receive performance settings which are applied without restart
+        if ( config["staticConfig"]["mqttConnection"]["runtimeConfigTopic"].asString().length() > 0 )
+        {
+            mAwsIotChannelReceiveRuntimeConfig =
+                mAwsIotModules[getTopicConnection( connectionPool, "runtimeConfigTopic" )]->createNewChannel( nullptr );
+            mAwsIotChannelReceiveRuntimeConfig->setTopic(
+                config["staticConfig"]["mqttConnection"]["runtimeConfigTopic"].asString(), true );
+            if ( !mAwsIotChannelReceiveRuntimeConfig->subscribeListener( this ) )
+            {
+                mLogger.error( "IoTFleetWiseEngine::connect", " Failed to register the runtime config listener " );
+                return false;
+            }
+        }
+
+        // Optionally limit the upload rate per topic and for the whole link, for example on cellular links
+        if ( config["staticConfig"]["mqttConnection"].isMember( "uploadRateLimits" ) )
+        {
+            const auto &uploadRateLimits = config["staticConfig"]["mqttConnection"]["uploadRateLimits"];
+            size_t maxQueuedBytes = UploadShaper::DEFAULT_MAX_QUEUED_BYTES;
+            if ( uploadRateLimits.isMember( "maxQueuedBytes" ) )
+            {
+                maxQueuedBytes = uploadRateLimits["maxQueuedBytes"].asUInt();
+            }
+            // On links with a high round trip time the window keeps the publishes queued here instead of in the SDK
+            size_t maxInFlightPublishes = 0;
+            if ( uploadRateLimits.isMember( "maxInFlightPublishes" ) )
+            {
+                maxInFlightPublishes = uploadRateLimits["maxInFlightPublishes"].asUInt();
+            }
+            mUploadShaper = std::make_shared<UploadShaper>(
+                getUploadRateLimit( uploadRateLimits ), maxQueuedBytes, maxInFlightPublishes );
+            // The topics are identified by their key in mqttConnection
+            for ( const auto &channel : getSendingChannels() )
+            {
+                if ( channel.second != nullptr )
+                {
+                    channel.second->setUploadShaper( mUploadShaper,
+                                                     getUploadRateLimit( uploadRateLimits["topics"][channel.first] ) );
+                }
+            }
+            if ( !mUploadShaper->start() )
+            {
+                mLogger.error( "IoTFleetWiseEngine::connect", " Upload shaper failed to start " );
+                return false;
+            }
+        }
+
+        std::shared_ptr<ISender> collectedDataSender = mAwsIotChannelSendCanData;
+        if ( mCollectedDataSender != nullptr )
+        {
+            collectedDataSender = mCollectedDataSender;
+        }
         // These parameters need to be added to the Config file to enable the feature :
         // useJsonBasedCollectionScheme
         mDataCollectionSender = std::make_shared<DataCollectionSender>(
-            mAwsIotChannelSendCanData,
+            collectedDataSender,
             config["staticConfig"]["internalParameters"]["useJsonBasedCollection"].asBool(),
             config["staticConfig"]["publishToCloudParameters"]["maxPublishMessageCount"].asUInt(),
             canIDTranslator,
             persistencyPath );
-
-        // Pass on the AWS SDK Bootsrap handle to the IoTModule.
-        auto bootstrapPtr = AwsBootstrap::getInstance().getClientBootStrap();
-
-        const auto privateKey =
-            getFileContents( config["staticConfig"]["mqttConnection"]["privateKeyFilename"].asString() );
-        const auto certificate =
-            getFileContents( config["staticConfig"]["mqttConnection"]["certificateFilename"].asString() );
-        // For asynchronous connect the call needs to be done after all channels created and setTopic calls
-        mAwsIotModule->connect( privateKey,
-                                certificate,
-                                config["staticConfig"]["mqttConnection"]["endpointUrl"].asString(),
-                                config["staticConfig"]["mqttConnection"]["clientId"].asString(),
-                                bootstrapPtr,
-                                true );
+        // Optionally send the samples grouped per signal, see payload_format_version in vehicle_data.proto
+        if ( config["staticConfig"]["publishToCloudParameters"].isMember( "payloadFormatVersion" ) &&
+             ( !mDataCollectionSender->setPayloadFormatVersion(
+                 config["staticConfig"]["publishToCloudParameters"]["payloadFormatVersion"].asUInt() ) ) )
+        {
+            mLogger.error( "IoTFleetWiseEngine::connect", " Unsupported payload format version " );
+            return false;
+        }
+        if ( config["staticConfig"]["publishToCloudParameters"].isMember( "payloadTargetFillRatio" ) &&
+             ( !mDataCollectionSender->setTargetFillRatio(
+                 config["staticConfig"]["publishToCloudParameters"]["payloadTargetFillRatio"].asDouble() ) ) )
+        {
+            mLogger.error( "IoTFleetWiseEngine::connect", " Payload target fill ratio must be in (0, 1] " );
+            return false;
+        }
+        // Optionally aggregate small payloads of different triggers into one publish per priority class
+        const auto aggregationClasses =
+            getPayloadAggregationClasses( config["staticConfig"]["publishToCloudParameters"] );
+        if ( !mDataCollectionSender->setAggregationClasses( aggregationClasses ) )
+        {
+            mLogger.error( "IoTFleetWiseEngine::connect", " Payload aggregation maxBytes and maxDelayMs must be > 0 " );
+            return false;
+        }
+        // Optionally pick the codec and level of every payload according to the CPU load and the uplink
+        const auto &publishToCloudParameters = config["staticConfig"]["publishToCloudParameters"];
+        const bool adaptiveCompressionEnabled = publishToCloudParameters.isMember( "adaptiveCompression" );
+        AdaptiveCompressionConfig adaptiveCompressionConfig;
+        if ( adaptiveCompressionEnabled &&
+             ( ( !getAdaptiveCompressionConfig( publishToCloudParameters["adaptiveCompression"],
+                                                adaptiveCompressionConfig ) ) ||
+               ( !mDataCollectionSender->setAdaptiveCompression( adaptiveCompressionConfig ) ) ) )
+        {
+            mLogger.error( "IoTFleetWiseEngine::connect", " Invalid adaptive compression configuration " );
+            return false;
+        }
+        // Optionally publish the payloads of the most important priority level first
+        const auto sendPriorityLevels = getSendPriorityLevels( config["staticConfig"]["publishToCloudParameters"] );
+        if ( config["staticConfig"]["publishToCloudParameters"].isMember( "lowPriorityMemoryRatio" ) )
+        {
+            auto lowPriorityMemoryRatio =
+                config["staticConfig"]["publishToCloudParameters"]["lowPriorityMemoryRatio"].asDouble();
+            if ( ( lowPriorityMemoryRatio <= 0.0 ) || ( lowPriorityMemoryRatio > 1.0 ) )
+            {
+                mLogger.error( "IoTFleetWiseEngine::connect", " Low priority memory ratio must be in (0, 1] " );
+                return false;
+            }
+            // Only the payloads of the first level may use the SDK memory above the ratio
+            mAwsIotChannelSendCanData->setLowPriorityMemoryLimit(
+                sendPriorityLevels.empty() ? 0U : sendPriorityLevels.front().maxPriority,
+                static_cast<size_t>( lowPriorityMemoryRatio *
+                                     static_cast<double>( AwsIotChannel::MAXIMUM_IOT_SDK_HEAP_MEMORY_BYTES ) ) );
+        }
+        // Optionally serialize, compress and publish the collected data on a pool of threads instead of this thread
+        uint32_t senderWorkerThreads = 0;
+        if ( config["staticConfig"]["publishToCloudParameters"].isMember( "senderWorkerThreads" ) )
+        {
+            senderWorkerThreads = config["staticConfig"]["publishToCloudParameters"]["senderWorkerThreads"].asUInt();
+        }
+        if ( senderWorkerThreads > 0 )
+        {
+            size_t senderQueueSize = DataSenderPipeline::DEFAULT_QUEUE_SIZE;
+            if ( config["staticConfig"]["publishToCloudParameters"].isMember( "senderQueueSize" ) )
+            {
+                senderQueueSize =
+                    std::max( 1U, config["staticConfig"]["publishToCloudParameters"]["senderQueueSize"].asUInt() );
+            }
+            // Every worker has its own sender, configured like mDataCollectionSender which validated the parameters
+            mDataSenderPipeline = std::make_unique<DataSenderPipeline>(
+                collectedDataSender,
+                senderWorkerThreads,
+                senderQueueSize,
+                [&]( std::shared_ptr<ISender> sender ) {
+                    auto dataCollectionSender = std::make_unique<DataCollectionSender>(
+                        std::move( sender ),
+                        config["staticConfig"]["internalParameters"]["useJsonBasedCollection"].asBool(),
+                        config["staticConfig"]["publishToCloudParameters"]["maxPublishMessageCount"].asUInt(),
+                        canIDTranslator,
+                        persistencyPath );
+                    if ( config["staticConfig"]["publishToCloudParameters"].isMember( "payloadFormatVersion" ) )
+                    {
+                        dataCollectionSender->setPayloadFormatVersion(
+                            config["staticConfig"]["publishToCloudParameters"]["payloadFormatVersion"].asUInt() );
+                    }
+                    if ( config["staticConfig"]["publishToCloudParameters"].isMember( "payloadTargetFillRatio" ) )
+                    {
+                        dataCollectionSender->setTargetFillRatio(
+                            config["staticConfig"]["publishToCloudParameters"]["payloadTargetFillRatio"]
+                                .asDouble() );
+                    }
+                    dataCollectionSender->setAggregationClasses( aggregationClasses );
+                    if ( adaptiveCompressionEnabled )
+                    {
+                        dataCollectionSender->setAdaptiveCompression( adaptiveCompressionConfig );
+                    }
+                    return dataCollectionSender;
+                },
+                sendPriorityLevels );
+        }
+        // Optionally publish the data of the most important collection schemes on a dedicated thread with reserved
+        // SDK memory, without aggregation and adaptive compression
+        bool expressLaneEnabled = publishToCloudParameters.isMember( "expressLane" );
+        uint32_t expressMaxPriority = 0;
+        if ( expressLaneEnabled )
+        {
+            const auto &expressLane = publishToCloudParameters["expressLane"];
+            expressMaxPriority = expressLane["maxPriority"].asUInt();
+            double reservedMemoryRatio = DEFAULT_EXPRESS_RESERVED_MEMORY_RATIO;
+            if ( expressLane.isMember( "reservedMemoryRatio" ) )
+            {
+                reservedMemoryRatio = expressLane["reservedMemoryRatio"].asDouble();
+            }
+            if ( ( reservedMemoryRatio < 0.0 ) || ( reservedMemoryRatio >= 1.0 ) )
+            {
+                mLogger.error( "IoTFleetWiseEngine::connect", " Express reserved memory ratio must be in [0, 1) " );
+                return false;
+            }
+            mAwsIotChannelSendCanData->setExpressMemoryReservation(
+                static_cast<size_t>( reservedMemoryRatio *
+                                     static_cast<double>( AwsIotChannel::MAXIMUM_IOT_SDK_HEAP_MEMORY_BYTES ) ) );
+            size_t expressQueueSize = DataSenderPipeline::DEFAULT_QUEUE_SIZE;
+            if ( expressLane.isMember( "queueSize" ) )
+            {
+                expressQueueSize = std::max( 1U, expressLane["queueSize"].asUInt() );
+            }
+            // Optionally isolate the express payloads on their own connection of the pool, so that they are not
+            // queued behind the large payloads of the other collection schemes
+            std::shared_ptr<ISender> expressSender = collectedDataSender;
+            if ( ( mCollectedDataSender == nullptr ) && connectionPool.isMember( "expressConnection" ) )
+            {
+                mAwsIotChannelSendExpressData =
+                    mAwsIotModules[connectionPool["expressConnection"].asUInt()]->createNewChannel( mPayloadManager );
+                mAwsIotChannelSendExpressData->setTopic(
+                    config["staticConfig"]["mqttConnection"]["canDataTopic"].asString() );
+                expressSender = mAwsIotChannelSendExpressData;
+            }
+            auto expressDataCollectionSender = std::make_unique<DataCollectionSender>(
+                expressSender,
+                config["staticConfig"]["internalParameters"]["useJsonBasedCollection"].asBool(),
+                publishToCloudParameters["maxPublishMessageCount"].asUInt(),
+                canIDTranslator,
+                persistencyPath );
+            if ( publishToCloudParameters.isMember( "payloadFormatVersion" ) )
+            {
+                expressDataCollectionSender->setPayloadFormatVersion(
+                    publishToCloudParameters["payloadFormatVersion"].asUInt() );
+            }
+            mExpressDataSender =
+                std::make_unique<ExpressDataSender>( std::move( expressDataCollectionSender ), expressQueueSize );
+        }
+        // Optionally record the collected signals and raw CAN frames to local files, next to the upload
+        if ( config["staticConfig"].isMember( "localRecording" ) )
+        {
+            const auto &localRecording = config["staticConfig"]["localRecording"];
+            LocalRecorder::Config recorderConfig;
+            recorderConfig.directory = localRecording["directory"].asString();
+            if ( localRecording.isMember( "codec" ) &&
+                 ( !getCompressionCodecType( localRecording["codec"].asString(), recorderConfig.codec ) ) )
+            {
+                mLogger.error( "IoTFleetWiseEngine::connect",
+                               " Unknown local recording codec " + localRecording["codec"].asString() );
+                return false;
+            }
+            recorderConfig.blockRows = localRecording.get( "blockRows", recorderConfig.blockRows ).asUInt();
+            recorderConfig.writeChunkBytes =
+                localRecording.get( "writeChunkBytes", static_cast<Json::UInt64>( recorderConfig.writeChunkBytes ) )
+                    .asUInt64();
+            recorderConfig.maxFileBytes =
+                localRecording.get( "maxFileBytes", static_cast<Json::UInt64>( recorderConfig.maxFileBytes ) )
+                    .asUInt64();
+            recorderConfig.maxFileDurationMs =
+                localRecording
+                    .get( "maxFileDurationMs", static_cast<Json::UInt64>( recorderConfig.maxFileDurationMs ) )
+                    .asUInt64();
+            recorderConfig.maxTotalBytes =
+                localRecording.get( "maxTotalBytes", static_cast<Json::UInt64>( recorderConfig.maxTotalBytes ) )
+                    .asUInt64();
+            recorderConfig.flushIntervalMs =
+                localRecording.get( "flushIntervalMs", recorderConfig.flushIntervalMs ).asUInt();
+            recorderConfig.queueSize = std::max(
+                1U, localRecording.get( "queueSize", static_cast<Json::UInt>( recorderConfig.queueSize ) ).asUInt() );
+            mLocalRecorder = std::make_unique<LocalRecorder>( recorderConfig );
+        }
+        TraceModule::get().sectionEnd( TraceSection::STARTUP_CONNECTIVITY );
         /*************************Connectivity `bootstrap end***************************************/
 
         /*************************Remote Profiling bootstrap begin**********************************/
         if ( config["staticConfig"].isMember( "remoteProfilerDefaultValues" ) )
         {
+            TraceModule::get().sectionBegin( TraceSection::STARTUP_REMOTE_PROFILER );
             LogLevel logThreshold = LogLevel::Off;
             /*
              * logging-upload-level-threshold specifies which log messages normally output to STDOUT are also
@@ -247,6 +961,41 @@ IoTFleetWiseEngine::connect( const Json::Value &config )
                 config["staticConfig"]["remoteProfilerDefaultValues"]["loggingUploadMaxWaitBeforeUploadMs"].asUInt(),
                 logThreshold,
                 config["staticConfig"]["remoteProfilerDefaultValues"]["profilerPrefix"].asString() );
+            /*
+             * Optional: metricsEncoding "binary" uploads the metrics sampled every metricsUploadIntervalMs in
+             * compressed batches every metricsBatchUploadIntervalMs. metricsSeriesPrefixes limits the uploaded
+             * metrics to the names starting with one of the prefixes.
+             */
+            const auto &remoteProfilerConfig = config["staticConfig"]["remoteProfilerDefaultValues"];
+            if ( remoteProfilerConfig.isMember( "metricsEncoding" ) &&
+                 ( remoteProfilerConfig["metricsEncoding"].asString() == "binary" ) )
+            {
+                std::vector<std::string> seriesPrefixes;
+                if ( remoteProfilerConfig.isMember( "metricsSeriesPrefixes" ) )
+                {
+                    for ( const auto &prefix : remoteProfilerConfig["metricsSeriesPrefixes"] )
+                    {
+                        seriesPrefixes.push_back( prefix.asString() );
+                    }
+                }
+                mRemoteProfiler->enableBinaryMetrics( remoteProfilerConfig["metricsBatchUploadIntervalMs"].asUInt(),
+                                                      std::move( seriesPrefixes ) );
+            }
+            /*
+             * Optional: loggingUploadCompression uploads the log batches snappy compressed and
+             * loggingUploadRateLimit caps the bytes per second and the burst of the log uploads. Batches over
+             * the cap are dropped and their messages counted in the next uploaded batch.
+             */
+            if ( remoteProfilerConfig["loggingUploadCompression"].asBool() )
+            {
+                mRemoteProfiler->enableLogCompression();
+            }
+            if ( remoteProfilerConfig.isMember( "loggingUploadRateLimit" ) )
+            {
+                mRemoteProfiler->setLogUplinkLimit(
+                    remoteProfilerConfig["loggingUploadRateLimit"]["bytesPerSecond"].asDouble(),
+                    remoteProfilerConfig["loggingUploadRateLimit"]["burstBytes"].asDouble() );
+            }
             if ( !mRemoteProfiler->start() )
             {
                 mLogger.warn(
@@ -254,51 +1003,412 @@ IoTFleetWiseEngine::connect( const Json::Value &config )
                     " Failed to start the Remote Profiler - No remote profiling available until FWE restart " );
             }
             setLogForwarding( mRemoteProfiler.get() );
+            TraceModule::get().sectionEnd( TraceSection::STARTUP_REMOTE_PROFILER );
         }
         /*************************Remote Profiling bootstrap ends**********************************/
 
         /*************************Inspection Engine bootstrap begin*********************************/
+        TraceModule::get().sectionBegin( TraceSection::STARTUP_INSPECTION );
+
+        size_t decodedSignalsBufferSize = config["staticConfig"]["bufferSizes"]["decodedSignalsBufferSize"].asUInt();
+        size_t rawCANFrameBufferSize = config["staticConfig"]["bufferSizes"]["rawCANFrameBufferSize"].asUInt();
+        size_t socketCANBufferSize = config["staticConfig"]["bufferSizes"]["socketCANBufferSize"].asUInt();
+        size_t readyToPublishDataBufferSize =
+            config["staticConfig"]["internalParameters"]["readyToPublishDataBufferSize"].asUInt();
+        // Optionally size the queues from the traffic observed in the previous run instead of the static values
+        if ( config["staticConfig"]["bufferSizes"].isMember( "adaptiveSizing" ) )
+        {
+            const auto &adaptiveSizingConfig = config["staticConfig"]["bufferSizes"]["adaptiveSizing"];
+            QueueSizingConfig queueSizing;
+            if ( adaptiveSizingConfig.isMember( "headroom" ) )
+            {
+                queueSizing.headroom = adaptiveSizingConfig["headroom"].asDouble();
+            }
+            if ( adaptiveSizingConfig.isMember( "growthFactor" ) )
+            {
+                queueSizing.growthFactor = adaptiveSizingConfig["growthFactor"].asDouble();
+            }
+            if ( adaptiveSizingConfig.isMember( "maxShrinkFactor" ) )
+            {
+                queueSizing.maxShrinkFactor = adaptiveSizingConfig["maxShrinkFactor"].asDouble();
+            }
+            if ( adaptiveSizingConfig.isMember( "minimumSize" ) )
+            {
+                queueSizing.minimumSize = adaptiveSizingConfig["minimumSize"].asUInt();
+            }
+            if ( adaptiveSizingConfig.isMember( "memoryCeilingBytes" ) )
+            {
+                queueSizing.memoryCeilingBytes = adaptiveSizingConfig["memoryCeilingBytes"].asUInt64();
+            }
+            if ( adaptiveSizingConfig.isMember( "samplingPeriodMs" ) )
+            {
+                queueSizing.samplingPeriodMs = adaptiveSizingConfig["samplingPeriodMs"].asUInt();
+            }
+            if ( adaptiveSizingConfig.isMember( "persistIntervalMs" ) )
+            {
+                queueSizing.persistIntervalMs = adaptiveSizingConfig["persistIntervalMs"].asUInt();
+            }
+            mQueueSizeAdvisor =
+                std::make_shared<QueueSizeAdvisor>( queueSizing, mPersistDecoderManifestCollectionSchemesAndData );
+            // The sizes of the previous run are needed before the queues are created
+            waitForPersistency();
+            mQueueSizeAdvisor->load();
+            decodedSignalsBufferSize = mQueueSizeAdvisor->getSize( "DecodedSignals", decodedSignalsBufferSize );
+            rawCANFrameBufferSize = mQueueSizeAdvisor->getSize( "RawCANFrames", rawCANFrameBufferSize );
+            socketCANBufferSize = mQueueSizeAdvisor->getSize( "SocketCAN", socketCANBufferSize );
+            readyToPublishDataBufferSize = mQueueSizeAdvisor->getSize( "ReadyToPublish", readyToPublishDataBufferSize );
+        }
 
         // Below are three buffers to be shared between Vehicle Data Consumer and Collection Engine
         // Signal Buffer are a lock-free multi-producer single consumer buffer
-        auto signalBufferPtr =
-            std::make_shared<SignalBuffer>( config["staticConfig"]["bufferSizes"]["decodedSignalsBufferSize"].asInt() );
+        auto signalBufferPtr = std::make_shared<SignalBuffer>( decodedSignalsBufferSize );
         // CAN Buffer are a lock-free multi-producer single consumer buffer
-        auto canRawBufferPtr =
-            std::make_shared<CANBuffer>( config["staticConfig"]["bufferSizes"]["rawCANFrameBufferSize"].asInt() );
+        auto canRawBufferPtr = std::make_shared<CANBuffer>( rawCANFrameBufferSize );
         // DTC Buffer are a single producer single consumer buffer
         auto activeDTCBufferPtr =
             std::make_shared<ActiveDTCBuffer>( config["staticConfig"]["bufferSizes"]["dtcBufferSize"].asInt() );
         // Create the Data Inspection Queue
-        mCollectedDataReadyToPublish = std::make_shared<CollectedDataReadyToPublish>(
-            config["staticConfig"]["internalParameters"]["readyToPublishDataBufferSize"].asInt() );
-
-        // Init and start the Inspection Engine
-        mCollectionInspectionWorkerThread = std::make_shared<CollectionInspectionWorkerThread>();
-        if ( !mCollectionInspectionWorkerThread->init(
-                 signalBufferPtr,
-                 canRawBufferPtr,
+        mCollectedDataReadyToPublish = std::make_shared<CollectedDataReadyToPublish>( readyToPublishDataBufferSize );
+
+        // Optionally the decoded signals and raw frames are sent to the inspection on another ECU. The local
+        // inspection then gets own buffers that stay empty, it only processes the DTCs of the OBD module.
+        auto inspectionSignalBufferPtr = signalBufferPtr;
+        auto inspectionCANBufferPtr = canRawBufferPtr;
+        if ( config["staticConfig"].isMember( "remoteInspection" ) )
+        {
+            const auto &remoteInspectionConfig = config["staticConfig"]["remoteInspection"];
+            auto port = remoteInspectionConfig["port"].asUInt();
+            mRemoteInspectionSender = std::make_unique<RemoteInspectionSender>();
+            if ( !mRemoteInspectionSender->init( signalBufferPtr,
+                                                 canRawBufferPtr,
+                                                 remoteInspectionConfig["address"].asString(),
+                                                 port > UINT16_MAX ? 0 : static_cast<uint16_t>( port ),
+                                                 remoteInspectionConfig["maxDatagramBytes"].asUInt(),
+                                                 remoteInspectionConfig["flushIntervalMs"].asUInt() ) ||
+                 !mRemoteInspectionSender->connect() )
+            {
+                mLogger.error( "IoTFleetWiseEngine::connect", " Failed to start the remote inspection sender " );
+                return false;
+            }
+            inspectionSignalBufferPtr = std::make_shared<SignalBuffer>( 1 );
+            inspectionCANBufferPtr = std::make_shared<CANBuffer>( 1 );
+        }
+
+        // Init and start the Inspection Engine, optionally with the conditions partitioned over multiple threads
+        uint32_t inspectionThreads = 1;
+        if ( config["staticConfig"]["internalParameters"].isMember( "inspectionThreads" ) )
+        {
+            inspectionThreads =
+                std::max( 1U, config["staticConfig"]["internalParameters"]["inspectionThreads"].asUInt() );
+        }
+        mCollectionInspectionRouter = std::make_shared<CollectionInspectionRouter>();
+        // Optionally spin and yield before blocking to pick up new data with sub millisecond latency
+        mCollectionInspectionRouter->setWaitStrategy(
+            config["staticConfig"]["threadIdleTimes"]["inspectionThreadSpinCount"].asUInt(),
+            config["staticConfig"]["threadIdleTimes"]["inspectionThreadYieldCount"].asUInt() );
+        // Optionally reference the collected signal samples instead of copying them on the inspection thread
+        mCollectionInspectionRouter->setSignalSnapshotsEnabled(
+            config["staticConfig"]["internalParameters"]["signalSnapshotsEnabled"].asBool() );
+        // Optionally send the samples of conditions triggered at the same time only once
+        mCollectionInspectionRouter->setSharedPayloadsEnabled(
+            config["staticConfig"]["internalParameters"]["sharedPayloadsEnabled"].asBool() );
+        mCollectionInspectionRouter->setDeviceJitter( deviceJitter );
+        // Optionally collect the samples after a trigger as they arrive instead of at the end of the afterDuration
+        mCollectionInspectionRouter->setStreamingCollectionEnabled(
+            config["staticConfig"]["internalParameters"]["streamingCollectionEnabled"].asBool() );
+        // Memory for the signal and CAN frame history, shared by all inspection threads
+        if ( config["staticConfig"]["internalParameters"].isMember( "sampleMemoryBudgetBytes" ) )
+        {
+            mCollectionInspectionRouter->setSampleMemoryBudget( static_cast<size_t>(
+                config["staticConfig"]["internalParameters"]["sampleMemoryBudgetBytes"].asUInt64() ) );
+        }
+        // Older samples of deep history signals are kept on flash instead of in the sample memory
+        if ( config["staticConfig"]["internalParameters"].isMember( "deepHistoryDirectory" ) )
+        {
+            mCollectionInspectionRouter->setDeepHistoryDirectory(
+                config["staticConfig"]["internalParameters"]["deepHistoryDirectory"].asString() );
+        }
+        // Without a directory the older samples can be kept compressed in memory instead
+        if ( config["staticConfig"]["internalParameters"].isMember( "deepHistoryCompression" ) )
+        {
+            mCollectionInspectionRouter->setDeepHistoryCompressionEnabled(
+                config["staticConfig"]["internalParameters"]["deepHistoryCompression"].asBool() );
+        }
+        // Optionally keep the history buffers, windows and trigger times of the conditions across restarts
+        if ( config["staticConfig"]["internalParameters"].isMember( "inspectionStateDirectory" ) )
+        {
+            mCollectionInspectionRouter->setStateDirectory(
+                config["staticConfig"]["internalParameters"]["inspectionStateDirectory"].asString() );
+        }
+        // Conditions are evaluated when new input or a deadline is due, but at most once per spacing
+        if ( config["staticConfig"]["internalParameters"].isMember( "minimumEvaluationSpacingMs" ) )
+        {
+            mCollectionInspectionRouter->setMinimumEvaluationSpacing(
+                config["staticConfig"]["internalParameters"]["minimumEvaluationSpacingMs"].asUInt() );
+        }
+        // Optionally report the most expensive conditions to find the campaigns that load the inspection threads
+        if ( config["staticConfig"]["internalParameters"].isMember( "conditionProfilingReportIntervalMs" ) )
+        {
+            uint32_t hotConditionCount = DEFAULT_HOT_CONDITION_COUNT;
+            if ( config["staticConfig"]["internalParameters"].isMember( "conditionProfilingTopCount" ) )
+            {
+                hotConditionCount = config["staticConfig"]["internalParameters"]["conditionProfilingTopCount"].asUInt();
+            }
+            mCollectionInspectionRouter->setConditionProfiling(
+                config["staticConfig"]["internalParameters"]["conditionProfilingReportIntervalMs"].asUInt(),
+                hotConditionCount );
+        }
+        if ( mExpressDataSender != nullptr )
+        {
+            mCollectionInspectionRouter->setExpressOutput( mExpressDataSender->getQueue() );
+        }
+        if ( mRunToCompletion )
+        {
+            // The reader thread runs the inspection when it is woken up for new input or a new inspection matrix
+            auto eventLoop = mCANDataSourceEventLoops.front();
+            mCollectionInspectionRouter->setRunToCompletion( [eventLoop]() { eventLoop->wakeup(); } );
+        }
+        if ( !mCollectionInspectionRouter->init(
+                 inspectionSignalBufferPtr,
+                 inspectionCANBufferPtr,
                  activeDTCBufferPtr,
                  mCollectedDataReadyToPublish,
                  config["staticConfig"]["threadIdleTimes"]["inspectionThreadIdleTimeMs"].asUInt(),
-                 config["staticConfig"]["internalParameters"]["dataReductionProbabilityDisabled"].asBool() ) ||
-             !mCollectionInspectionWorkerThread->start() )
+                 config["staticConfig"]["internalParameters"]["dataReductionProbabilityDisabled"].asBool(),
+                 inspectionThreads,
+                 static_cast<uint32_t>( decodedSignalsBufferSize ) ) ||
+             !mCollectionInspectionRouter->start() )
         {
             mLogger.error( "IoTFleetWiseEngine::connect", " Failed to init and start the Inspection Engine " );
             return false;
         }
         // Make sure the Inspection Engine can notify the Bootstrap thread about ready to be
         // published data.
-        if ( !mCollectionInspectionWorkerThread->subscribeListener( this ) )
+        if ( !mCollectionInspectionRouter->subscribeListener( this ) )
         {
             mLogger.error( "IoTFleetWiseEngine::connect",
                            " Failed register the Engine Thread to the Inspection Module " );
             return false;
         }
+        TraceModule::get().sectionEnd( TraceSection::STARTUP_INSPECTION );
 
         /*************************Inspection Engine bootstrap end***********************************/
 
+        /*************************Thread Telemetry bootstrap begin**********************************/
+        if ( config["staticConfig"]["internalParameters"].isMember( "threadTelemetrySamplingPeriodMs" ) &&
+             ( config["staticConfig"]["internalParameters"]["threadTelemetrySamplingPeriodMs"].asUInt() > 0U ) )
+        {
+            mThreadTelemetrySampler = std::make_unique<ThreadTelemetrySampler>(
+                config["staticConfig"]["internalParameters"]["threadTelemetrySamplingPeriodMs"].asUInt() );
+            mThreadTelemetrySampler->registerQueue( "DecodedSignals",
+                                                    [signalBufferPtr]() { return signalBufferPtr->getOccupancy(); } );
+            mThreadTelemetrySampler->registerQueue( "RawCANFrames",
+                                                    [canRawBufferPtr]() { return canRawBufferPtr->getOccupancy(); } );
+            mThreadTelemetrySampler->registerQueue(
+                "ActiveDTCs", [activeDTCBufferPtr]() { return activeDTCBufferPtr->read_available(); } );
+            auto collectedDataReadyToPublish = mCollectedDataReadyToPublish;
+            mThreadTelemetrySampler->registerQueue( "ReadyToPublish", [collectedDataReadyToPublish]() {
+                return collectedDataReadyToPublish->read_available();
+            } );
+            if ( mExpressDataSender != nullptr )
+            {
+                auto expressCollectedData = mExpressDataSender->getQueue();
+                mThreadTelemetrySampler->registerQueue( "ExpressReadyToPublish", [expressCollectedData]() {
+                    return expressCollectedData->size();
+                } );
+            }
+            if ( !mThreadTelemetrySampler->start() )
+            {
+                mLogger.error( "IoTFleetWiseEngine::connect", " Failed to start the Thread Telemetry Sampler " );
+                return false;
+            }
+            // The sampler reports the CPU usage per thread through the TraceModule
+            if ( mRemoteProfiler != nullptr )
+            {
+                mRemoteProfiler->setPerThreadCPUUsageEnabled( false );
+            }
+        }
+        /*************************Thread Telemetry bootstrap end************************************/
+
+        /*************************Trace Shared Memory bootstrap begin*******************************/
+        // Optionally export the trace values to shared memory for local tools like fwe-top
+        if ( config["staticConfig"]["internalParameters"].isMember( "traceSharedMemoryName" ) )
+        {
+            uint32_t updateIntervalMs = 1000;
+            if ( config["staticConfig"]["internalParameters"].isMember( "traceSharedMemoryUpdateIntervalMs" ) )
+            {
+                updateIntervalMs =
+                    config["staticConfig"]["internalParameters"]["traceSharedMemoryUpdateIntervalMs"].asUInt();
+            }
+            mTraceSharedMemoryExporter = std::make_unique<TraceSharedMemoryExporter>(
+                config["staticConfig"]["internalParameters"]["traceSharedMemoryName"].asString(), updateIntervalMs );
+            if ( !mTraceSharedMemoryExporter->start() )
+            {
+                mLogger.error( "IoTFleetWiseEngine::connect", " Failed to start the Trace Shared Memory Exporter " );
+                return false;
+            }
+        }
+        /*************************Trace Shared Memory bootstrap end*********************************/
+
+        /*************************Control Plane Executor bootstrap begin****************************/
+        // The periodic control plane modules share one worker instead of sleeping on their own threads
+        if ( ( mQueueSizeAdvisor != nullptr ) ||
+             config["staticConfig"]["internalParameters"].isMember( "loadShedding" ) )
+        {
+            mControlPlaneExecutor = std::make_shared<SerialTaskExecutor>( 1U, "fwEMControl" );
+            if ( !mControlPlaneExecutor->start() )
+            {
+                mLogger.error( "IoTFleetWiseEngine::connect", " Failed to start the Control Plane Executor " );
+                return false;
+            }
+        }
+        /*************************Control Plane Executor bootstrap end******************************/
+
+        /*************************Load Shedding bootstrap begin*************************************/
+        // Optionally shed low priority signals and raw CAN frames centrally when the queues fill up, instead of
+        // dropping data at random wherever a queue overflows
+        if ( config["staticConfig"]["internalParameters"].isMember( "loadShedding" ) )
+        {
+            const auto &loadSheddingConfig = config["staticConfig"]["internalParameters"]["loadShedding"];
+            LoadSheddingConfig loadShedding;
+            if ( loadSheddingConfig.isMember( "lowWatermark" ) )
+            {
+                loadShedding.lowWatermark = loadSheddingConfig["lowWatermark"].asDouble();
+            }
+            if ( loadSheddingConfig.isMember( "highWatermark" ) )
+            {
+                loadShedding.highWatermark = loadSheddingConfig["highWatermark"].asDouble();
+            }
+            if ( loadSheddingConfig.isMember( "criticalWatermark" ) )
+            {
+                loadShedding.criticalWatermark = loadSheddingConfig["criticalWatermark"].asDouble();
+            }
+            if ( loadSheddingConfig.isMember( "sheddingPriorityThreshold" ) )
+            {
+                loadShedding.sheddingPriorityThreshold = loadSheddingConfig["sheddingPriorityThreshold"].asUInt();
+            }
+            if ( loadSheddingConfig.isMember( "rawFrameKeepInterval" ) )
+            {
+                loadShedding.rawFrameKeepInterval = loadSheddingConfig["rawFrameKeepInterval"].asUInt();
+            }
+            if ( loadSheddingConfig.isMember( "samplingPeriodMs" ) )
+            {
+                loadShedding.samplingPeriodMs = loadSheddingConfig["samplingPeriodMs"].asUInt();
+            }
+            mPipelineLoadController = std::make_shared<PipelineLoadController>( loadShedding );
+            mPipelineLoadController->setExecutor( mControlPlaneExecutor );
+            mPipelineLoadController->registerQueue(
+                "DecodedSignals",
+                [signalBufferPtr]() { return signalBufferPtr->getOccupancy(); },
+                decodedSignalsBufferSize );
+            mPipelineLoadController->registerQueue(
+                "RawCANFrames",
+                [canRawBufferPtr]() { return canRawBufferPtr->getOccupancy(); },
+                rawCANFrameBufferSize );
+            auto collectedDataReadyToPublish = mCollectedDataReadyToPublish;
+            mPipelineLoadController->registerQueue(
+                "ReadyToPublish",
+                [collectedDataReadyToPublish]() { return collectedDataReadyToPublish->read_available(); },
+                readyToPublishDataBufferSize );
+            if ( !mPipelineLoadController->start() )
+            {
+                mLogger.error( "IoTFleetWiseEngine::connect", " Failed to start the Pipeline Load Controller " );
+                return false;
+            }
+        }
+        /*************************Load Shedding bootstrap end***************************************/
+
+        /*************************Adaptive Queue Sizing bootstrap begin*****************************/
+        if ( mQueueSizeAdvisor != nullptr )
+        {
+            // Every producer has its own ring of the fan-in queues, so the fullest ring is compared to the size
+            mQueueSizeAdvisor->registerQueue(
+                "DecodedSignals",
+                [signalBufferPtr]() { return signalBufferPtr->getMaxRingOccupancy(); },
+                []() {
+                    return TraceModule::get().getAtomicVariable( TraceAtomicVariable::QUEUE_FULL_DROPPED_SIGNALS );
+                },
+                decodedSignalsBufferSize,
+                sizeof( CollectedSignal ) );
+            mQueueSizeAdvisor->registerQueue(
+                "RawCANFrames",
+                [canRawBufferPtr]() { return canRawBufferPtr->getMaxRingOccupancy(); },
+                []() {
+                    return TraceModule::get().getAtomicVariable( TraceAtomicVariable::QUEUE_FULL_DROPPED_RAW_FRAMES );
+                },
+                rawCANFrameBufferSize,
+                sizeof( CollectedCanFrameWithSignals ) );
+            // The buffers of the CAN sources are only visible through the occupancy the consumers trace
+            mQueueSizeAdvisor->registerQueue(
+                "SocketCAN",
+                []() {
+                    uint64_t occupancy = 0;
+                    for ( auto i = toUType( TraceVariable::QUEUE_SOCKET_TO_CONSUMER_0 );
+                          i <= toUType( TraceVariable::QUEUE_SOCKET_TO_CONSUMER_MAX );
+                          i++ )
+                    {
+                        occupancy =
+                            std::max( occupancy, TraceModule::get().getVariableMax( static_cast<TraceVariable>( i ) ) );
+                    }
+                    return occupancy;
+                },
+                []() { return TraceModule::get().getVariable( TraceVariable::DISCARDED_FRAMES ); },
+                socketCANBufferSize,
+                sizeof( VehicleDataMessage ) );
+            auto collectedDataReadyToPublish = mCollectedDataReadyToPublish;
+            mQueueSizeAdvisor->registerQueue(
+                "ReadyToPublish",
+                [collectedDataReadyToPublish]() { return collectedDataReadyToPublish->read_available(); },
+                []() {
+                    return TraceModule::get().getAtomicVariable(
+                        TraceAtomicVariable::QUEUE_FULL_DROPPED_COLLECTED_DATA );
+                },
+                readyToPublishDataBufferSize,
+                sizeof( TriggeredCollectionSchemeDataPtr ) );
+            mQueueSizeAdvisor->setExecutor( mControlPlaneExecutor );
+            if ( !mQueueSizeAdvisor->start() )
+            {
+                mLogger.error( "IoTFleetWiseEngine::connect", " Failed to start the Queue Size Advisor " );
+                return false;
+            }
+        }
+        /*************************Adaptive Queue Sizing bootstrap end*******************************/
+
+        // Optionally follow a sample of the CAN frames from their kernel timestamp until the publish completed
+        if ( config["staticConfig"]["internalParameters"].isMember( "latencyTraceSamplingInterval" ) )
+        {
+            LatencyTracer::get().setSamplingInterval(
+                config["staticConfig"]["internalParameters"]["latencyTraceSamplingInterval"].asUInt() );
+        }
+
+        // Optionally count the acquisitions and contention of the instrumented mutexes, reported per mutex name
+        if ( config["staticConfig"]["internalParameters"].isMember( "mutexContentionTracing" ) )
+        {
+            bool mutexContentionTracing =
+                config["staticConfig"]["internalParameters"]["mutexContentionTracing"].asBool();
+            MutexContention::get().setEnabled( mutexContentionTracing );
+            if ( mutexContentionTracing && ( !MutexContention::isCompiledIn() ) )
+            {
+                mLogger.warn( "IoTFleetWiseEngine::connect",
+                              " Mutex contention tracing requires a build with FWE_MUTEX_CONTENTION_TRACING" );
+            }
+        }
+
+        // Optionally record the iterations of the main loops which take longer than the threshold
+        if ( config["staticConfig"]["internalParameters"].isMember( "stallWatchdogThresholdMs" ) &&
+             ( config["staticConfig"]["internalParameters"]["stallWatchdogThresholdMs"].asUInt() > 0U ) )
+        {
+            StallWatchdog::get().setThreshold(
+                config["staticConfig"]["internalParameters"]["stallWatchdogThresholdMs"].asUInt() );
+            if ( !StallWatchdog::get().start() )
+            {
+                mLogger.error( "IoTFleetWiseEngine::connect", " Failed to start the Stall Watchdog " );
+                return false;
+            }
+        }
+
         /*************************CollectionScheme Ingestion bootstrap begin*********************************/
+        TraceModule::get().sectionBegin( TraceSection::STARTUP_COLLECTION_SCHEME_MANAGER );
 
         // These parameters need to be added to the Config file to enable the feature :
         // jsonBasedCollectionSchemeFilename
@@ -331,6 +1441,11 @@ IoTFleetWiseEngine::connect( const Json::Value &config )
 
         // Create and connect the CollectionScheme Manager
         mCollectionSchemeManagerPtr = std::make_shared<CollectionSchemeManager>();
+        mCollectionSchemeManagerPtr->setDeviceJitter( deviceJitter );
+        if ( expressLaneEnabled )
+        {
+            mCollectionSchemeManagerPtr->setExpressMaxPriority( expressMaxPriority );
+        }
 
         if ( !mCollectionSchemeManagerPtr->init(
                  config["staticConfig"]["publishToCloudParameters"]["collectionSchemeManagementCheckinIntervalMs"]
@@ -355,7 +1470,7 @@ IoTFleetWiseEngine::connect( const Json::Value &config )
         // Make sure the CollectionScheme Manager can notify the Inspection Engine about the availability of
         // a new set of collection CollectionSchemes.
         if ( !mCollectionSchemeManagerPtr->subscribeListener(
-                 static_cast<IActiveConditionProcessor *>( mCollectionInspectionWorkerThread.get() ) ) )
+                 static_cast<IActiveConditionProcessor *>( mCollectionInspectionRouter.get() ) ) )
         {
             mLogger.error( "IoTFleetWiseEngine::connect",
                            " Failed register the Inspection Engine to the CollectionScheme Manager Module " );
@@ -364,8 +1479,10 @@ IoTFleetWiseEngine::connect( const Json::Value &config )
 
         // Allow CollectionSchemeManagement to send checkins through the Schema Object Callback
         mCollectionSchemeManagerPtr->setSchemaListenerPtr( mSchemaPtr );
+        TraceModule::get().sectionEnd( TraceSection::STARTUP_COLLECTION_SCHEME_MANAGER );
 
         /********************************Vehicle Data Source Binder bootstrap start*******************************/
+        TraceModule::get().sectionBegin( TraceSection::STARTUP_VEHICLE_DATA_SOURCES );
 
         auto obdOverCANModuleInit = false;
         // Start the vehicle data source binder
@@ -376,49 +1493,122 @@ IoTFleetWiseEngine::connect( const Json::Value &config )
             return false;
         }
 
+        // Consumers decoding on the reader thread in the run to completion mode
+        std::vector<std::shared_ptr<CANDataConsumer>> runToCompletionConsumers;
+        // Wakes up the consumer of the Signal Buffer and the CAN Buffer
+        auto dataAvailableSignal = ( mRemoteInspectionSender != nullptr )
+                                       ? mRemoteInspectionSender->getDataAvailableSignal()
+                                       : mCollectionInspectionRouter->getDataAvailableSignal();
         // Initialize
         for ( const auto &interfaceName : config["networkInterfaces"] )
         {
             const auto &interfaceType = interfaceName["type"].asString();
 
-            if ( interfaceType == CAN_INTERFACE_TYPE )
+            if ( ( interfaceType == CAN_INTERFACE_TYPE ) || ( interfaceType == CAN_LOG_REPLAY_INTERFACE_TYPE ) )
             {
                 std::vector<VehicleDataSourceConfig> canSourceConfigs( 1 );
                 auto &canSourceConfig = canSourceConfigs.back();
-                canSourceConfig.transportProperties.emplace(
-                    "interfaceName", interfaceName[CAN_INTERFACE_TYPE]["interfaceName"].asString() );
-                canSourceConfig.transportProperties.emplace(
-                    "threadIdleTimeMs",
-                    config["staticConfig"]["threadIdleTimes"]["socketCANThreadIdleTimeMs"].asString() );
-                canSourceConfig.maxNumberOfVehicleDataMessages =
-                    config["staticConfig"]["bufferSizes"]["socketCANBufferSize"].asUInt();
-                auto canSourcePtr = std::make_shared<CANDataSource>();
-                auto canConsumerPtr = std::make_shared<CANDataConsumer>();
-
-                if ( canSourcePtr == nullptr || canConsumerPtr == nullptr )
+                canSourceConfig.maxNumberOfVehicleDataMessages = static_cast<uint32_t>( socketCANBufferSize );
+                std::shared_ptr<AbstractVehicleDataSource> canSourcePtr;
+                if ( interfaceType == CAN_LOG_REPLAY_INTERFACE_TYPE )
+                {
+                    // Recorded traffic is replayed instead of received from a socket
+                    for ( const auto &key : { "logFile",
+                                              "logFormat",
+                                              "channel",
+                                              "replayMode",
+                                              "replaySpeed",
+                                              "preserveTimestamps",
+                                              "loop" } )
+                    {
+                        if ( interfaceName[CAN_LOG_REPLAY_INTERFACE_TYPE].isMember( key ) )
+                        {
+                            canSourceConfig.transportProperties.emplace(
+                                key, interfaceName[CAN_LOG_REPLAY_INTERFACE_TYPE][key].asString() );
+                        }
+                    }
+                    canSourcePtr = std::make_shared<CANLogReplayDataSource>();
+                }
+                else
+                {
+                    canSourceConfig.transportProperties.emplace(
+                        "interfaceName", interfaceName[CAN_INTERFACE_TYPE]["interfaceName"].asString() );
+                    canSourceConfig.transportProperties.emplace(
+                        "threadIdleTimeMs",
+                        config["staticConfig"]["threadIdleTimes"]["socketCANThreadIdleTimeMs"].asString() );
+                    // Optional per interface receive tuning
+                    for ( const auto &key : { "receiveBatchSize",
+                                              "busyPollUs",
+                                              "idleSpinCount",
+                                              "microsecondTimestamps",
+                                              "decoderThreads" } )
+                    {
+                        if ( interfaceName[CAN_INTERFACE_TYPE].isMember( key ) )
+                        {
+                            canSourceConfig.transportProperties.emplace(
+                                key, interfaceName[CAN_INTERFACE_TYPE][key].asString() );
+                        }
+                    }
+                    auto socketCANSourcePtr = std::make_shared<CANDataSource>();
+                    if ( ( socketCANSourcePtr != nullptr ) && !mCANDataSourceEventLoops.empty() )
+                    {
+                        // Distribute the interfaces round robin over the reader threads
+                        socketCANSourcePtr->setEventLoop(
+                            mCANDataSourceEventLoops[canInterfaceCount % mCANDataSourceEventLoops.size()] );
+                    }
+                    canInterfaceCount++;
+                    canSourcePtr = socketCANSourcePtr;
+                }
+
+                if ( canSourcePtr == nullptr )
                 {
                     mLogger.error( "IoTFleetWiseEngine::connect", " Failed to create consumer/producer " );
                     return false;
                 }
-                // Initialize the consumer/producers
-                // Currently we limit 1 channel to a single consumer. We can always extend this
-                // if we want to process the data coming from 1 channel to multiple consumers.
-                if ( !canSourcePtr->init( canSourceConfigs ) ||
-                     !canConsumerPtr->init(
-                         static_cast<VehicleDataSourceID>(
-                             canIDTranslator.getChannelNumericID( interfaceName["interfaceId"].asString() ) ),
-                         signalBufferPtr,
-                         config["staticConfig"]["threadIdleTimes"]["canDecoderThreadIdleTimeMs"].asUInt() ) )
+                if ( !canSourcePtr->init( canSourceConfigs ) )
                 {
                     mLogger.error( "IoTFleetWiseEngine::connect", " Failed to initialize the producers/consumers " );
                     return false;
                 }
-                else
+                // Initialize the consumers. Usually one channel has a single consumer, with decoderThreads the
+                // source splits the frames by CAN ID over multiple buffers and each buffer gets an own consumer.
+                std::vector<std::shared_ptr<CANDataConsumer>> canConsumers;
+                for ( size_t i = 0; i < canSourcePtr->getBufferCount(); i++ )
                 {
+                    auto canConsumerPtr = std::make_shared<CANDataConsumer>();
+                    if ( canConsumerPtr == nullptr )
+                    {
+                        mLogger.error( "IoTFleetWiseEngine::connect", " Failed to create consumer/producer " );
+                        return false;
+                    }
+                    if ( !canConsumerPtr->init(
+                             static_cast<VehicleDataSourceID>(
+                                 canIDTranslator.getChannelNumericID( interfaceName["interfaceId"].asString() ) ),
+                             signalBufferPtr,
+                             config["staticConfig"]["threadIdleTimes"]["canDecoderThreadIdleTimeMs"].asUInt() ) )
+                    {
+                        mLogger.error( "IoTFleetWiseEngine::connect",
+                                       " Failed to initialize the producers/consumers " );
+                        return false;
+                    }
                     // CAN Consumers require a RAW Buffer after init
                     // TODO: This is temporary change . Will need to think how this can be abstracted for all data
                     // sources.
                     canConsumerPtr->setCANBufferPtr( canRawBufferPtr );
+                    canConsumerPtr->setLoadController( mPipelineLoadController );
+                    // Wake up the inspection directly after decoded data was pushed
+                    canConsumerPtr->setOutputDataAvailableSignal( dataAvailableSignal );
+                    canConsumerPtr->setWaitStrategy(
+                        config["staticConfig"]["threadIdleTimes"]["canDecoderThreadSpinCount"].asUInt(),
+                        config["staticConfig"]["threadIdleTimes"]["canDecoderThreadYieldCount"].asUInt() );
+                    // Replayed logs are read by an own thread, so only the SocketCAN frames bypass the queues
+                    if ( mRunToCompletion && ( interfaceType == CAN_INTERFACE_TYPE ) )
+                    {
+                        canConsumerPtr->setDirectOutput( mCollectionInspectionRouter->getRunToCompletionWorker() );
+                        runToCompletionConsumers.emplace_back( canConsumerPtr );
+                    }
+                    canConsumers.emplace_back( canConsumerPtr );
+                    mCANDataConsumers.emplace_back( canConsumerPtr );
                 }
 
                 // Handshake the binder and the channel
@@ -428,11 +1618,14 @@ IoTFleetWiseEngine::connect( const Json::Value &config )
                     return false;
                 }
 
-                if ( !mVehicleDataSourceBinder->bindConsumerToVehicleDataSource(
-                         canConsumerPtr, canSourcePtr->getVehicleDataSourceID() ) )
+                for ( const auto &canConsumerPtr : canConsumers )
                 {
-                    mLogger.error( "IoTFleetWiseEngine::connect", " Failed to Bind Consumers to Producers " );
-                    return false;
+                    if ( !mVehicleDataSourceBinder->bindConsumerToVehicleDataSource(
+                             canConsumerPtr, canSourcePtr->getVehicleDataSourceID() ) )
+                    {
+                        mLogger.error( "IoTFleetWiseEngine::connect", " Failed to Bind Consumers to Producers " );
+                        return false;
+                    }
                 }
             }
             else if ( interfaceType == OBD_INTERFACE_TYPE )
@@ -441,6 +1634,8 @@ IoTFleetWiseEngine::connect( const Json::Value &config )
                 {
                     auto obdOverCANModule = std::make_shared<OBDOverCANModule>();
                     obdOverCANModuleInit = true;
+                    // The ECUs discovered before are read from the persistency
+                    waitForPersistency();
                     // Init returns false if no collection is configured:
                     if ( obdOverCANModule->init(
                              signalBufferPtr,
@@ -449,7 +1644,10 @@ IoTFleetWiseEngine::connect( const Json::Value &config )
                              interfaceName[OBD_INTERFACE_TYPE]["pidRequestIntervalSeconds"].asUInt(),
                              interfaceName[OBD_INTERFACE_TYPE]["dtcRequestIntervalSeconds"].asUInt(),
                              interfaceName[OBD_INTERFACE_TYPE]["useExtendedIds"].asBool(),
-                             interfaceName[OBD_INTERFACE_TYPE]["hasTransmissionEcu"].asBool() ) )
+                             interfaceName[OBD_INTERFACE_TYPE]["hasTransmissionEcu"].asBool(),
+                             interfaceName[OBD_INTERFACE_TYPE].isMember( "discoverEcus" ) &&
+                                 interfaceName[OBD_INTERFACE_TYPE]["discoverEcus"].asBool(),
+                             mPersistDecoderManifestCollectionSchemesAndData ) )
                     {
                         // Connect the OBD Module
                         mOBDOverCANModule = obdOverCANModule;
@@ -475,16 +1673,87 @@ IoTFleetWiseEngine::connect( const Json::Value &config )
                         }
                     }
                 }
-                else
+                else
+                {
+                    mLogger.error( "IoTFleetWiseEngine::connect", "obdOverCANModule already initialised" );
+                }
+            }
+            else if ( interfaceType == SHARED_MEMORY_SIGNAL_INTERFACE_TYPE )
+            {
+                // Pre-decoded signals of other processes bypass the binder and the decoding
+                const auto &shmConfig = interfaceName[SHARED_MEMORY_SIGNAL_INTERFACE_TYPE];
+                auto sharedMemorySignalSource = std::make_shared<SharedMemorySignalSource>();
+                if ( !sharedMemorySignalSource->init(
+                         signalBufferPtr,
+                         shmConfig["shmName"].asString(),
+                         shmConfig["capacity"].asUInt(),
+                         config["staticConfig"]["threadIdleTimes"]["sharedMemorySignalThreadIdleTimeMs"].asUInt() ) )
+                {
+                    mLogger.error( "IoTFleetWiseEngine::connect", " Failed to initialize the shared memory source " );
+                    return false;
+                }
+                sharedMemorySignalSource->setOutputDataAvailableSignal( dataAvailableSignal );
+                if ( !sharedMemorySignalSource->connect() )
+                {
+                    mLogger.error( "IoTFleetWiseEngine::connect", " Failed to connect the shared memory source " );
+                    return false;
+                }
+                mSharedMemorySignalSources.emplace_back( sharedMemorySignalSource );
+            }
+            else if ( interfaceType == REMOTE_INSPECTION_INTERFACE_TYPE )
+            {
+                // Signals and raw frames decoded on another ECU bypass the binder and the decoding
+                const auto &remoteConfig = interfaceName[REMOTE_INSPECTION_INTERFACE_TYPE];
+                auto port = remoteConfig["port"].asUInt();
+                auto remoteInspectionReceiver = std::make_shared<RemoteInspectionReceiver>();
+                if ( ( port == 0 ) || ( port > UINT16_MAX ) ||
+                     ( !remoteInspectionReceiver->init( signalBufferPtr,
+                                                        canRawBufferPtr,
+                                                        remoteConfig.isMember( "listenAddress" )
+                                                            ? remoteConfig["listenAddress"].asString()
+                                                            : "0.0.0.0",
+                                                        static_cast<uint16_t>( port ) ) ) )
                 {
-                    mLogger.error( "IoTFleetWiseEngine::connect", "obdOverCANModule already initialised" );
+                    mLogger.error( "IoTFleetWiseEngine::connect",
+                                   " Failed to initialize the remote inspection receiver " );
+                    return false;
+                }
+                remoteInspectionReceiver->setOutputDataAvailableSignal( dataAvailableSignal );
+                if ( !remoteInspectionReceiver->connect() )
+                {
+                    mLogger.error( "IoTFleetWiseEngine::connect",
+                                   " Failed to connect the remote inspection receiver " );
+                    return false;
                 }
+                mRemoteInspectionReceivers.emplace_back( remoteInspectionReceiver );
             }
             else
             {
                 mLogger.error( "IoTFleetWiseEngine::connect", interfaceName["type"].asString() + " is not supported" );
             }
         }
+        if ( mRunToCompletion )
+        {
+            // Every wake up of the reader thread receives a recvmmsg batch per signaled socket, decodes the frames,
+            // hands them to the inspection and evaluates the conditions. The collected data is still uploaded by the
+            // thread of this engine.
+            auto *inspection = mCollectionInspectionRouter->getRunToCompletionWorker();
+            mCANDataSourceEventLoops.front()->setCycleHandler( [inspection, runToCompletionConsumers]() {
+                // Without an inspection matrix the decoded input is dropped
+                (void)inspection->beginCycle();
+                bool drained = true;
+                for ( const auto &consumer : runToCompletionConsumers )
+                {
+                    drained = consumer->consumeFrames( CollectionInspectionWorkerThread::MAX_DRAIN_BATCH_SIZE ) &&
+                              drained;
+                }
+                auto waitTimeMs = inspection->endCycle();
+                return drained ? waitTimeMs : 0U;
+            } );
+            mLogger.info( "IoTFleetWiseEngine::connect",
+                          " Running " + std::to_string( runToCompletionConsumers.size() ) +
+                              " CAN consumers and the inspection to completion on the SocketCAN reader thread" );
+        }
         // Register Vehicle Data Source Binder as listener for CollectionScheme Manager
         if ( !mCollectionSchemeManagerPtr->subscribeListener( mVehicleDataSourceBinder.get() ) )
         {
@@ -493,21 +1762,13 @@ IoTFleetWiseEngine::connect( const Json::Value &config )
                 "Could not register the vehicle data source binder as a listener to the collection campaign manager" );
             return false;
         }
+        TraceModule::get().sectionEnd( TraceSection::STARTUP_VEHICLE_DATA_SOURCES );
 
         /********************************Vehicle Data Source Binder bootstrap end*******************************/
 
-        // Only start the CollectionSchemeManager after all listeners have subscribed, otherwise
-        // they will not be notified of the initial decoder manifest and collection schemes that are
-        // read from persistent memory:
-        if ( !mCollectionSchemeManagerPtr->connect() )
-        {
-            mLogger.error( "IoTFleetWiseEngine::connect", " Failed to start the CollectionScheme Manager " );
-            return false;
-        }
-        /****************************CollectionScheme Manager bootstrap end*************************/
-
 #ifdef FWE_FEATURE_CAMERA
         /********************************DDS Module bootstrap start*********************************/
+        TraceModule::get().sectionBegin( TraceSection::STARTUP_DDS );
         // First we need to parse the configuration
         // and extract all the node(s) settings our DDS module needs. Those are per node( device):
         // - The device unique ID.
@@ -560,6 +1821,17 @@ IoTFleetWiseEngine::connect( const Json::Value &config )
             nodeConfig.subscribeTopicName = ddsNode["downstream-dds-topic-name"].asString();
             nodeConfig.topicQoS = ddsNode["dds-topics-qos"].asString();
             nodeConfig.temporaryCacheLocation = ddsNode["dds-tmp-cache-location"].asString();
+            // The pre-trigger buffer is optional
+            if ( ddsNode.isMember( "dds-pre-trigger-buffer-size-bytes" ) )
+            {
+                nodeConfig.preTriggerBufferSizeBytes = ddsNode["dds-pre-trigger-buffer-size-bytes"].asUInt();
+            }
+            // The size of raw frames is optional, it is needed to re-encode them
+            if ( ddsNode.isMember( "dds-frame-width" ) && ddsNode.isMember( "dds-frame-height" ) )
+            {
+                nodeConfig.frameWidth = ddsNode["dds-frame-width"].asUInt();
+                nodeConfig.frameHeight = ddsNode["dds-frame-height"].asUInt();
+            }
             ddsNodes.emplace_back( nodeConfig );
         }
         // Only if there is at least one DDS Node, we should create the DDS Module
@@ -572,23 +1844,99 @@ IoTFleetWiseEngine::connect( const Json::Value &config )
                 mLogger.error( "IoTFleetWiseEngine::connect", " Failed to initialize the DDS Module " );
                 return false;
             }
+            // Without an artifact upload topic the artifacts stay in the cache locations of the nodes
+            if ( mAwsIotChannelArtifactUpload != nullptr )
+            {
+                uint32_t chunkSizeBytes = ArtifactUploader::DEFAULT_CHUNK_SIZE_BYTES;
+                if ( config["staticConfig"]["mqttConnection"].isMember( "artifactUploadChunkSizeBytes" ) )
+                {
+                    chunkSizeBytes = config["staticConfig"]["mqttConnection"]["artifactUploadChunkSizeBytes"].asUInt();
+                }
+                mArtifactUploader = std::make_shared<ArtifactUploader>( mAwsIotChannelArtifactUpload, chunkSizeBytes );
+                if ( !mArtifactUploader->start() )
+                {
+                    mLogger.error( "IoTFleetWiseEngine::connect", " Failed to start the Artifact Uploader " );
+                    return false;
+                }
+                mDataOverDDSModule->setArtifactUploader( mArtifactUploader );
+            }
             // Register the DDS Module as a listener to the Inspection Engine and connect it.
-            if ( !mCollectionInspectionWorkerThread->subscribeToEvents(
+            if ( !mCollectionInspectionRouter->subscribeToEvents(
                      static_cast<InspectionEventListener *>( mDataOverDDSModule.get() ) ) ||
                  !mDataOverDDSModule->connect() )
             {
                 mLogger.error( "IoTFleetWiseEngine::connect", " Failed to connect the DDS Module " );
                 return false;
             }
+            // The DDS Module sizes the pre-trigger buffers of the sources according to the active conditions
+            if ( !mCollectionSchemeManagerPtr->subscribeListener(
+                     static_cast<IActiveConditionProcessor *>( mDataOverDDSModule.get() ) ) )
+            {
+                mLogger.error( "IoTFleetWiseEngine::connect",
+                               " Failed to register the DDS Module to the CollectionScheme Manager" );
+                return false;
+            }
             mLogger.info( "IoTFleetWiseEngine::connect", " DDS Module connected " );
         }
         else
         {
             mLogger.info( "IoTFleetWiseEngine::connect", " DDS Module disabled   " );
         }
+        TraceModule::get().sectionEnd( TraceSection::STARTUP_DDS );
 
         /********************************DDS Module bootstrap end*********************************/
 #endif // FWE_FEATURE_CAMERA
+
+        // Only start the CollectionSchemeManager after all listeners have subscribed, otherwise
+        // they will not be notified of the initial decoder manifest and collection schemes that are
+        // read from persistent memory:
+        waitForPersistency();
+        if ( !mCollectionSchemeManagerPtr->connect() )
+        {
+            mLogger.error( "IoTFleetWiseEngine::connect", " Failed to start the CollectionScheme Manager " );
+            return false;
+        }
+        if ( mPersistedDataCompressionDeferred && ( !mPersistedDataCompactor->start() ) )
+        {
+            mLogger.error( "IoTFleetWiseEngine::connect", " Failed to start the Persisted Data Compactor " );
+            return false;
+        }
+        /****************************CollectionScheme Manager bootstrap end*************************/
+
+        /*************************MQTT connection bootstrap begin***********************************/
+        if ( mCollectedDataSender != nullptr )
+        {
+            mLogger.info( "IoTFleetWiseEngine::connect", " Collected data is not sent to AWS IoT, not connecting " );
+        }
+        else
+        {
+            TraceModule::get().sectionBegin( TraceSection::STARTUP_MQTT_CONNECT );
+            // Pass on the AWS SDK Bootsrap handle to the IoTModule.
+            auto bootstrapPtr = AwsBootstrap::getInstance().getClientBootStrap();
+
+            const auto privateKey =
+                getFileContents( config["staticConfig"]["mqttConnection"]["privateKeyFilename"].asString() );
+            const auto certificate =
+                getFileContents( config["staticConfig"]["mqttConnection"]["certificateFilename"].asString() );
+            // For asynchronous connect the call needs to be done after all channels created and setTopic calls
+            for ( size_t i = 0; i < mAwsIotModules.size(); i++ )
+            {
+                mAwsIotModules[i]->connect(
+                    privateKey,
+                    certificate,
+                    config["staticConfig"]["mqttConnection"]["endpointUrl"].asString(),
+                    getConnectionClientId( config["staticConfig"]["mqttConnection"]["clientId"].asString(), i ),
+                    bootstrapPtr,
+                    true );
+            }
+            TraceModule::get().sectionEnd( TraceSection::STARTUP_MQTT_CONNECT );
+            if ( ( mLinkMonitor != nullptr ) && ( !mLinkMonitor->start() ) )
+            {
+                mLogger.error( "IoTFleetWiseEngine::connect", " Failed to start the Link Monitor " );
+                return false;
+            }
+        }
+        /*************************MQTT connection bootstrap end*************************************/
     }
     catch ( const std::exception &e )
     {
@@ -608,7 +1956,7 @@ IoTFleetWiseEngine::disconnect()
 #ifdef FWE_FEATURE_CAMERA
     if ( mDataOverDDSModule )
     {
-        if ( !mCollectionInspectionWorkerThread->unSubscribeFromEvents(
+        if ( !mCollectionInspectionRouter->unSubscribeFromEvents(
                  static_cast<InspectionEventListener *>( mDataOverDDSModule.get() ) ) ||
              !mDataOverDDSModule->disconnect() )
         {
@@ -617,8 +1965,19 @@ IoTFleetWiseEngine::disconnect()
             return false;
         }
     }
+    // Stopped after the DDS Module, which hands the artifacts to it
+    if ( mArtifactUploader && !mArtifactUploader->stop() )
+    {
+        mLogger.error( "IoTFleetWiseEngine::disconnect", "Could not stop the Artifact Uploader" );
+        return false;
+    }
 #endif // FWE_FEATURE_CAMERA
 
+    if ( mAwsIotChannelReceiveRuntimeConfig != nullptr )
+    {
+        mAwsIotChannelReceiveRuntimeConfig->unSubscribeListener( this );
+    }
+
     if ( mOBDOverCANModule )
     {
         if ( !mOBDOverCANModule->disconnect() )
@@ -628,12 +1987,77 @@ IoTFleetWiseEngine::disconnect()
         }
     }
 
-    if ( !mCollectionInspectionWorkerThread->stop() )
+    for ( auto &sharedMemorySignalSource : mSharedMemorySignalSources )
+    {
+        if ( !sharedMemorySignalSource->disconnect() )
+        {
+            mLogger.error( "IoTFleetWiseEngine::disconnect", "Could not disconnect the shared memory source" );
+            return false;
+        }
+    }
+
+    for ( auto &remoteInspectionReceiver : mRemoteInspectionReceivers )
+    {
+        if ( !remoteInspectionReceiver->disconnect() )
+        {
+            mLogger.error( "IoTFleetWiseEngine::disconnect", "Could not disconnect the remote inspection receiver" );
+            return false;
+        }
+    }
+
+    if ( ( mRemoteInspectionSender != nullptr ) && ( !mRemoteInspectionSender->disconnect() ) )
+    {
+        mLogger.error( "IoTFleetWiseEngine::disconnect", "Could not disconnect the remote inspection sender" );
+        return false;
+    }
+
+    // The reader thread must not run the inspection anymore when it saves its state
+    if ( mRunToCompletion )
+    {
+        mCANDataSourceEventLoops.front()->setCycleHandler( nullptr );
+    }
+    if ( !mCollectionInspectionRouter->stop() )
     {
         mLogger.error( "IoTFleetWiseEngine::disconnect", "Could not stop the Inspection Engine" );
         return false;
     }
 
+    if ( mThreadTelemetrySampler != nullptr && !mThreadTelemetrySampler->stop() )
+    {
+        mLogger.error( "IoTFleetWiseEngine::disconnect", "Could not stop the Thread Telemetry Sampler" );
+        return false;
+    }
+
+    if ( mTraceSharedMemoryExporter != nullptr && !mTraceSharedMemoryExporter->stop() )
+    {
+        mLogger.error( "IoTFleetWiseEngine::disconnect", "Could not stop the Trace Shared Memory Exporter" );
+        return false;
+    }
+
+    if ( mPipelineLoadController != nullptr && !mPipelineLoadController->stop() )
+    {
+        mLogger.error( "IoTFleetWiseEngine::disconnect", "Could not stop the Pipeline Load Controller" );
+        return false;
+    }
+
+    if ( mQueueSizeAdvisor != nullptr && !mQueueSizeAdvisor->stop() )
+    {
+        mLogger.error( "IoTFleetWiseEngine::disconnect", "Could not stop the Queue Size Advisor" );
+        return false;
+    }
+
+    if ( mControlPlaneExecutor != nullptr && !mControlPlaneExecutor->stop() )
+    {
+        mLogger.error( "IoTFleetWiseEngine::disconnect", "Could not stop the Control Plane Executor" );
+        return false;
+    }
+
+    if ( StallWatchdog::get().isAlive() && !StallWatchdog::get().stop() )
+    {
+        mLogger.error( "IoTFleetWiseEngine::disconnect", "Could not stop the Stall Watchdog" );
+        return false;
+    }
+
     setLogForwarding( nullptr );
     if ( mRemoteProfiler != nullptr && !mRemoteProfiler->stop() )
     {
@@ -653,6 +2077,33 @@ IoTFleetWiseEngine::disconnect()
         mLogger.error( "IoTFleetWiseEngine::disconnect", "Could not disconnect the Binder" );
         return false;
     }
+    // Shared reader threads are stopped by their owner after all engines using them are disconnected
+    for ( auto &eventLoop : mCANDataSourceEventLoops )
+    {
+        if ( ( !mCANDataSourceEventLoopsShared ) && ( !eventLoop->stop() ) )
+        {
+            mLogger.error( "IoTFleetWiseEngine::disconnect", "Could not stop the SocketCAN reader thread" );
+            return false;
+        }
+    }
+
+    // No reconnects once the remaining payloads are published or persisted
+    if ( mLinkMonitor && !mLinkMonitor->stop() )
+    {
+        mLogger.error( "IoTFleetWiseEngine::disconnect", "Could not stop the Link Monitor" );
+        return false;
+    }
+    // Publishes the remaining queued payloads or persists them if there is no connection
+    if ( mUploadShaper && !mUploadShaper->stop() )
+    {
+        mLogger.error( "IoTFleetWiseEngine::disconnect", "Could not stop the Upload Shaper" );
+        return false;
+    }
+    if ( mPersistedDataCompactor && !mPersistedDataCompactor->stop() )
+    {
+        mLogger.error( "IoTFleetWiseEngine::disconnect", "Could not stop the Persisted Data Compactor" );
+        return false;
+    }
     mLogger.info( "IoTFleetWiseEngine::disconnect", "Engine Disconnected" );
     TraceModule::get().sectionEnd( TraceSection::FWE_SHUTDOWN );
     TraceModule::get().print();
@@ -667,14 +2118,30 @@ IoTFleetWiseEngine::start()
     // On multi core systems the shared variable mShouldStop must be updated for
     // all cores before starting the thread otherwise thread will directly end
     mShouldStop.store( false );
-    if ( !mThread.create( doWork, this ) )
+    if ( ( mDataSenderPipeline != nullptr ) && ( !mDataSenderPipeline->start() ) )
+    {
+        mLogger.error( "IoTFleetWiseEngine::start", " Sender pipeline failed to start " );
+        return false;
+    }
+    if ( ( mExpressDataSender != nullptr ) && ( !mExpressDataSender->start() ) )
+    {
+        mLogger.error( "IoTFleetWiseEngine::start", " Express sender failed to start " );
+        return false;
+    }
+    if ( ( mLocalRecorder != nullptr ) && ( !mLocalRecorder->start() ) )
+    {
+        mLogger.error( "IoTFleetWiseEngine::start", " Local recorder failed to start " );
+        return false;
+    }
+    // Persisted data is retried again when the vehicle wakes up
+    LowActivityMode::get().addWakeUpSignal( mWait );
+    if ( !mThread.create( doWork, this, "fwEMEngine" ) )
     {
         mLogger.trace( "IoTFleetWiseEngine::start", " Engine Thread failed to start " );
     }
     else
     {
         mLogger.trace( "IoTFleetWiseEngine::start", " Engine Thread started " );
-        mThread.setThreadName( "fwEMEngine" );
     }
 
     return mThread.isActive() && mThread.isValid();
@@ -687,9 +2154,15 @@ IoTFleetWiseEngine::stop()
     std::lock_guard<std::mutex> lock( mThreadMutex );
     mShouldStop.store( true, std::memory_order_relaxed );
     mWait.notify();
+    // Stopping the pipeline first also wakes up the thread if it waits for space in the pipeline
+    bool pipelineStopped = ( mDataSenderPipeline == nullptr ) || mDataSenderPipeline->stop();
+    bool expressStopped = ( mExpressDataSender == nullptr ) || mExpressDataSender->stop();
     mThread.release();
+    // Records the data submitted by the thread and closes the recording file
+    bool recorderStopped = ( mLocalRecorder == nullptr ) || mLocalRecorder->stop();
+    LowActivityMode::get().removeWakeUpSignal( mWait );
     mShouldStop.store( false, std::memory_order_relaxed );
-    return !mThread.isActive();
+    return pipelineStopped && expressStopped && recorderStopped && !mThread.isActive();
 }
 
 bool
@@ -712,9 +2185,12 @@ IoTFleetWiseEngine::doWork( void *data )
     // Time in seconds
     double timeTrigger = 0;
     bool uploadedPersistedDataOnce = false;
+    // Time until the next aggregate of small payloads has to be sent, 0 if there is none
+    uint32_t timeToFlushAggregatesMs = 0;
     TraceModule::get().sectionEnd( TraceSection::FWE_STARTUP );
 
     engine->mRetrySendingPersistedDataTimer.reset();
+    StallWatchdog::Heartbeat heartbeat;
 
     while ( !engine->shouldStop() )
     {
@@ -732,13 +2208,19 @@ IoTFleetWiseEngine::doWork( void *data )
         {
             // Minimum delay one tenth of FAST_RETRY_UPLOAD_PERSISTED_INTERVAL_MS
             uint64_t timeToWaitMs =
-                IoTFleetWiseEngine::FAST_RETRY_UPLOAD_PERSISTED_INTERVAL_MS -
+                engine->mFirstPersistedDataUploadDelayMs -
                 std::min( static_cast<uint64_t>( engine->mRetrySendingPersistedDataTimer.getElapsedMs().count() ),
-                          IoTFleetWiseEngine::FAST_RETRY_UPLOAD_PERSISTED_INTERVAL_MS );
+                          engine->mFirstPersistedDataUploadDelayMs );
             timeTrigger = static_cast<double>( std::max(
                               IoTFleetWiseEngine::FAST_RETRY_UPLOAD_PERSISTED_INTERVAL_MS / 10, timeToWaitMs ) ) /
                           1000.0;
         }
+        else if ( engine->mPersistedDataDrainPending )
+        {
+            // Continue the upload of the persisted data as soon as more live data was sent
+            timeTrigger =
+                static_cast<double>( IoTFleetWiseEngine::FAST_RETRY_UPLOAD_PERSISTED_INTERVAL_MS / 10 ) / 1000.0;
+        }
         else if ( engine->mPersistencyUploadRetryIntervalMs > 0 )
         {
             uint64_t timeToWaitMs =
@@ -749,14 +2231,28 @@ IoTFleetWiseEngine::doWork( void *data )
                               std::max( IoTFleetWiseEngine::FAST_RETRY_UPLOAD_PERSISTED_INTERVAL_MS, timeToWaitMs ) ) /
                           1000.0;
         }
-        if ( timeTrigger > 0 )
+        double waitTime = timeTrigger;
+        if ( timeToFlushAggregatesMs > 0 )
+        {
+            auto timeToFlushAggregates = static_cast<double>( timeToFlushAggregatesMs ) / 1000.0;
+            waitTime = ( waitTime > 0 ) ? std::min( waitTime, timeToFlushAggregates ) : timeToFlushAggregates;
+        }
+        auto waitTimeMs =
+            ( waitTime > 0 ) ? static_cast<uint32_t>( waitTime * 1000 ) : Platform::Linux::Signal::WaitWithPredicate;
+        // While the vehicle is parked only the aggregates are flushed in time, persisted data is retried after the
+        // next bus traffic or cloud message
+        waitTimeMs = LowActivityMode::get().getDeadlineWaitTimeMs(
+            ( timeToFlushAggregatesMs > 0 ) ? timeToFlushAggregatesMs : std::numeric_limits<uint32_t>::max(),
+            waitTimeMs );
+        heartbeat.idle();
+        if ( waitTimeMs != Platform::Linux::Signal::WaitWithPredicate )
         {
             engine->mLogger.trace(
                 "IoTFleetWiseEngine::doWork",
-                "Waiting for :" + std::to_string( timeTrigger ) + " seconds " +
+                "Waiting for :" + std::to_string( waitTimeMs ) + " ms " +
                     std::to_string( engine->mPersistencyUploadRetryIntervalMs ) + " config" +
                     std::to_string( engine->mRetrySendingPersistedDataTimer.getElapsedMs().count() ) + " timer" );
-            engine->mWait.wait( static_cast<uint32_t>( timeTrigger * 1000 ) );
+            engine->mWait.wait( waitTimeMs );
         }
         else
         {
@@ -767,7 +2263,33 @@ IoTFleetWiseEngine::doWork( void *data )
                                    "Time Elapsed waiting for the Event : " + std::to_string( elapsedTimeUs ) );
         }
 
+        // Apply the runtime configuration received since the last cycle
+        std::string runtimeConfigDocument;
+        bool runtimeConfigPending = false;
+        {
+            std::lock_guard<std::mutex> lock( engine->mRuntimeConfigMutex );
+            std::swap( runtimeConfigPending, engine->mRuntimeConfigPending );
+            runtimeConfigDocument.swap( engine->mPendingRuntimeConfig );
+        }
+        if ( runtimeConfigPending )
+        {
+            heartbeat.enter( "applyRuntimeConfig" );
+            Json::Value runtimeConfig;
+            Json::CharReaderBuilder builder;
+            JSONCPP_STRING errors;
+            std::istringstream runtimeConfigStream( runtimeConfigDocument );
+            if ( !parseFromStream( builder, runtimeConfigStream, &runtimeConfig, &errors ) )
+            {
+                engine->mLogger.error( "IoTFleetWiseEngine::doWork", "Failed to parse the runtime configuration" );
+            }
+            else
+            {
+                engine->applyRuntimeConfig( runtimeConfig );
+            }
+        }
+
         // Dequeues the collected data queue and sends the data to cloud
+        heartbeat.enter( "sendCollectedData" );
         auto consumedElements = engine->mCollectedDataReadyToPublish->consume_all(
             [&]( const TriggeredCollectionSchemeDataPtr triggeredCollectionSchemeDataPtr ) {
                 // Only used for trace logging
@@ -788,29 +2310,61 @@ IoTFleetWiseEngine::doWork( void *data )
                     "IoTFleetWiseEngine::doWork",
                     "FWE data ready to send with eventID " +
                         std::to_string( triggeredCollectionSchemeDataPtr->eventID ) + " from " +
-                        triggeredCollectionSchemeDataPtr->metaData.collectionSchemeID + " Signals:" +
+                        triggeredCollectionSchemeDataPtr->metaData.collectionSchemeID.str() + " Signals:" +
                         std::to_string( triggeredCollectionSchemeDataPtr->signals.size() ) + " " + firstSignalValues +
+                        " signal snapshots:" +
+                        std::to_string( triggeredCollectionSchemeDataPtr->signalSnapshots.size() ) +
                         " raw CAN frames:" + std::to_string( triggeredCollectionSchemeDataPtr->canFrames.size() ) +
                         " DTCs:" + std::to_string( triggeredCollectionSchemeDataPtr->mDTCInfo.mDTCCodes.size() ) +
                         " Geohash:" + triggeredCollectionSchemeDataPtr->mGeohashInfo.mGeohashString );
-                engine->mDataCollectionSender->send( triggeredCollectionSchemeDataPtr );
+                // Dropped and counted if the recorder falls behind, the upload is never delayed
+                if ( engine->mLocalRecorder != nullptr )
+                {
+                    engine->mLocalRecorder->submit( triggeredCollectionSchemeDataPtr );
+                }
+                if ( engine->mDataSenderPipeline != nullptr )
+                {
+                    // Waits if the pipeline is full, the persisted data is retried once the burst was queued
+                    engine->mDataSenderPipeline->submit( triggeredCollectionSchemeDataPtr );
+                }
+                else
+                {
+                    engine->mDataCollectionSender->send( triggeredCollectionSchemeDataPtr );
+                }
             } );
         TraceModule::get().setVariable( TraceVariable::QUEUE_INSPECTION_TO_SENDER, consumedElements );
+        // With the pipeline its workers send their aggregates
+        if ( engine->mDataSenderPipeline == nullptr )
+        {
+            heartbeat.enter( "flushAggregates" );
+            timeToFlushAggregatesMs = engine->mDataCollectionSender->flushAggregates();
+        }
 
         if ( ( engine->mPersistencyUploadRetryIntervalMs > 0 &&
                ( static_cast<uint64_t>( engine->mRetrySendingPersistedDataTimer.getElapsedMs().count() ) >=
                  engine->mPersistencyUploadRetryIntervalMs ) ) ||
              ( !uploadedPersistedDataOnce &&
                ( static_cast<uint64_t>( engine->mRetrySendingPersistedDataTimer.getElapsedMs().count() ) >=
-                 IoTFleetWiseEngine::FAST_RETRY_UPLOAD_PERSISTED_INTERVAL_MS ) ) )
+                 engine->mFirstPersistedDataUploadDelayMs ) ) )
         {
             engine->mRetrySendingPersistedDataTimer.reset();
-            if ( engine->mAwsIotModule->isAlive() )
+            heartbeat.enter( "sendPersistedData" );
+            if ( engine->mAwsIotChannelSendCanData->isAlive() )
             {
                 // Check if data was persisted, Retrieve all the data and send
                 uploadedPersistedDataOnce |= engine->checkAndSendRetrievedData();
             }
         }
+        else if ( engine->mPersistedDataDrainPending && engine->mAwsIotChannelSendCanData->isAlive() )
+        {
+            heartbeat.enter( "sendPersistedData" );
+            engine->checkAndSendRetrievedData();
+        }
+    }
+    if ( engine->mDataSenderPipeline == nullptr )
+    {
+        heartbeat.enter( "flushAggregates" );
+        engine->mDataCollectionSender->flushAggregates( true );
     }
 }
 
@@ -820,30 +2374,230 @@ IoTFleetWiseEngine::onDataReadyToPublish()
     mWait.notify();
 }
 
+void
+IoTFleetWiseEngine::onDataReceived( const std::uint8_t *buf, size_t size )
+{
+    {
+        std::lock_guard<std::mutex> lock( mRuntimeConfigMutex );
+        // Only the latest document is applied if several arrive within one cycle
+        mPendingRuntimeConfig.assign( reinterpret_cast<const char *>( buf ), size );
+        mRuntimeConfigPending = true;
+    }
+    mWait.notify();
+}
+
+std::vector<std::pair<std::string, std::shared_ptr<AwsIotChannel>>>
+IoTFleetWiseEngine::getSendingChannels() const
+{
+    return { { "canDataTopic", mAwsIotChannelSendCanData },
+             { "checkinTopic", mAwsIotChannelSendCheckin },
+             { "metricsUploadTopic", mAwsIotChannelMetricsUpload },
+             { "loggingUploadTopic", mAwsIotChannelLogsUpload },
+             { "artifactUploadTopic", mAwsIotChannelArtifactUpload } };
+}
+
 bool
-IoTFleetWiseEngine::checkAndSendRetrievedData()
+IoTFleetWiseEngine::applyRuntimeConfig( const Json::Value &runtimeConfig )
 {
-    std::vector<std::string> payloads;
+    static const std::set<std::string> sections = {
+        "publishToCloudParameters", "persistency", "threadIdleTimes", "threads", "uploadRateLimits" };
+    static const std::set<std::string> waitStrategyMembers = { "inspectionThreadSpinCount",
+                                                               "inspectionThreadYieldCount",
+                                                               "canDecoderThreadSpinCount",
+                                                               "canDecoderThreadYieldCount" };
+    const auto &publishToCloudParameters = runtimeConfig["publishToCloudParameters"];
+    const auto &persistency = runtimeConfig["persistency"];
+    const auto &threadIdleTimes = runtimeConfig["threadIdleTimes"];
+    const auto &uploadRateLimits = runtimeConfig["uploadRateLimits"];
+
+    // Validate everything first, so that an invalid document changes nothing
+    bool valid = hasOnlyMembers( runtimeConfig, sections );
+    if ( valid && runtimeConfig.isMember( "publishToCloudParameters" ) )
+    {
+        valid = hasOnlyMembers( publishToCloudParameters, { "maxPublishMessageCount" } ) &&
+                ( ( !publishToCloudParameters.isMember( "maxPublishMessageCount" ) ) ||
+                  publishToCloudParameters["maxPublishMessageCount"].isUInt() );
+    }
+    if ( valid && runtimeConfig.isMember( "persistency" ) )
+    {
+        valid = hasOnlyMembers( persistency, { "persistencyUploadRetryIntervalMs" } ) &&
+                ( ( !persistency.isMember( "persistencyUploadRetryIntervalMs" ) ) ||
+                  persistency["persistencyUploadRetryIntervalMs"].isUInt() );
+    }
+    if ( valid && runtimeConfig.isMember( "threadIdleTimes" ) )
+    {
+        valid = hasOnlyMembers( threadIdleTimes, waitStrategyMembers );
+        for ( const auto &name : waitStrategyMembers )
+        {
+            valid = valid && ( ( !threadIdleTimes.isMember( name ) ) || threadIdleTimes[name].isUInt() );
+        }
+    }
+    std::map<std::string, ThreadConfig> threadConfigs;
+    if ( valid && runtimeConfig.isMember( "threads" ) )
+    {
+        valid = runtimeConfig["threads"].isObject() &&
+                IoTFleetWiseConfig::readThreadConfigs( runtimeConfig["threads"], threadConfigs );
+    }
+    if ( valid && runtimeConfig.isMember( "uploadRateLimits" ) )
+    {
+        // The shaper is only created with the static configuration, as it is in the path of every publish
+        auto linkMembers = UPLOAD_RATE_LIMIT_MEMBERS;
+        linkMembers.insert( "topics" );
+        valid = ( mUploadShaper != nullptr ) && isUploadRateLimitValid( uploadRateLimits, linkMembers );
+        if ( valid && uploadRateLimits.isMember( "topics" ) )
+        {
+            std::set<std::string> topics;
+            for ( const auto &channel : getSendingChannels() )
+            {
+                if ( channel.second != nullptr )
+                {
+                    topics.insert( channel.first );
+                }
+            }
+            valid = hasOnlyMembers( uploadRateLimits["topics"], topics );
+            for ( const auto &topic : uploadRateLimits["topics"].getMemberNames() )
+            {
+                valid = valid && isUploadRateLimitValid( uploadRateLimits["topics"][topic], UPLOAD_RATE_LIMIT_MEMBERS );
+            }
+        }
+    }
+    if ( !valid )
+    {
+        mLogger.error( "IoTFleetWiseEngine::applyRuntimeConfig", "Invalid runtime configuration, nothing changed" );
+        return false;
+    }
+
+    if ( publishToCloudParameters.isMember( "maxPublishMessageCount" ) )
+    {
+        auto maxPublishMessageCount = publishToCloudParameters["maxPublishMessageCount"].asUInt();
+        mDataCollectionSender->setMaxMessageCount( maxPublishMessageCount );
+        if ( mDataSenderPipeline != nullptr )
+        {
+            mDataSenderPipeline->setMaxMessageCount( maxPublishMessageCount );
+        }
+    }
+    if ( persistency.isMember( "persistencyUploadRetryIntervalMs" ) )
+    {
+        // Read by the engine thread only, the next wait uses the new interval
+        mPersistencyUploadRetryIntervalMs = persistency["persistencyUploadRetryIntervalMs"].asUInt();
+    }
+    if ( threadIdleTimes.isMember( "inspectionThreadSpinCount" ) ||
+         threadIdleTimes.isMember( "inspectionThreadYieldCount" ) )
+    {
+        mCollectionInspectionRouter->setWaitStrategy( threadIdleTimes["inspectionThreadSpinCount"].asUInt(),
+                                                      threadIdleTimes["inspectionThreadYieldCount"].asUInt() );
+    }
+    if ( threadIdleTimes.isMember( "canDecoderThreadSpinCount" ) ||
+         threadIdleTimes.isMember( "canDecoderThreadYieldCount" ) )
+    {
+        for ( auto &canDataConsumer : mCANDataConsumers )
+        {
+            canDataConsumer->setWaitStrategy( threadIdleTimes["canDecoderThreadSpinCount"].asUInt(),
+                                              threadIdleTimes["canDecoderThreadYieldCount"].asUInt() );
+        }
+    }
+    if ( !threadConfigs.empty() )
+    {
+        auto configs = Thread::getConfigs();
+        for ( auto &threadConfig : threadConfigs )
+        {
+            configs[threadConfig.first] = threadConfig.second;
+        }
+        Thread::setConfigs( std::move( configs ) );
+        if ( !Thread::applyConfigsToRunningThreads() )
+        {
+            mLogger.warn( "IoTFleetWiseEngine::applyRuntimeConfig",
+                          "Could not apply the complete thread configuration, a real-time policy or negative nice "
+                          "value needs CAP_SYS_NICE" );
+        }
+    }
+    if ( runtimeConfig.isMember( "uploadRateLimits" ) )
+    {
+        bool linkLimitGiven = false;
+        for ( const auto &name : UPLOAD_RATE_LIMIT_MEMBERS )
+        {
+            linkLimitGiven = linkLimitGiven || uploadRateLimits.isMember( name );
+        }
+        if ( linkLimitGiven )
+        {
+            mUploadShaper->setLinkLimit( getUploadRateLimit( uploadRateLimits ) );
+        }
+        for ( const auto &channel : getSendingChannels() )
+        {
+            if ( uploadRateLimits["topics"].isMember( channel.first ) )
+            {
+                channel.second->setUploadRateLimit( getUploadRateLimit( uploadRateLimits["topics"][channel.first] ) );
+            }
+        }
+    }
+    mLogger.info( "IoTFleetWiseEngine::applyRuntimeConfig",
+                  "Applied runtime configuration of " + std::to_string( runtimeConfig.getMemberNames().size() ) +
+                      " sections" );
+    return true;
+}
 
-    // Retrieve the data from persistency library
-    ErrorCode status = mPayloadManager->retrieveData( payloads );
+bool
+IoTFleetWiseEngine::checkAndSendRetrievedData()
+{
+    // The persisted payloads are retrieved in chunks of at most the maximum send size, so the memory used does
+    // not grow with the amount of persisted data. Each chunk is freed from disk once all its payloads are sent.
+    PersistedPayloadChunk chunk;
+    size_t sentPayloads = 0;
+    bool continuesDrain = mPersistedDataDrainPending;
+    mPersistedDataDrainPending = false;
+    ErrorCode status = mPayloadManager->retrieveNext( chunk, MAX_DATA_RD_SIZE );
+    if ( status == ErrorCode::EMPTY )
+    {
+        mLogger.trace( "IoTFleetWiseEngine::checkAndSendRetrievedData", "No Payloads to Retrieve" );
+        return true;
+    }
+    if ( !continuesDrain )
+    {
+        // Live data sent while no persisted data was waiting does not earn credit
+        mLastUploadedLiveBytes = TraceModule::get().getAtomicVariable( TraceAtomicVariable::UPLOADED_LIVE_BYTES );
+    }
 
-    if ( status == ErrorCode::SUCCESS )
+    while ( status != ErrorCode::EMPTY )
     {
-        ConnectivityError res = ConnectivityError::Success;
+        if ( status == ErrorCode::INVALID_DATA )
+        {
+            // Would fail again on every retry and block the payloads behind it
+            mLogger.error( "IoTFleetWiseEngine::checkAndSendRetrievedData",
+                           "Corrupted payloads in segment " + std::to_string( chunk.segmentId ) +
+                               " will be deleted" );
+        }
+        else if ( status != ErrorCode::SUCCESS )
+        {
+            mLogger.error( "IoTFleetWiseEngine::checkAndSendRetrievedData", "Payload Retrieval Failed" );
+            return false;
+        }
+
         mLogger.trace( "IoTFleetWiseEngine::checkAndSendRetrievedData",
-                       "Number of Payloads to transmit : " + std::to_string( payloads.size() ) );
+                       "Number of Payloads to transmit : " + std::to_string( chunk.payloads.size() ) +
+                           " of priority " + std::to_string( chunk.segmentPriority ) );
 
-        for ( const auto &payload : payloads )
+        bool liveDataWaiting = false;
+        if ( !mayUploadPersistedData( liveDataWaiting ) )
         {
-            // transmit the retrieved payload
-            res = mDataCollectionSender->transmit( payload );
+            // The chunk is not acknowledged, so it is retrieved again on the next cycle
+            mPersistedDataDrainPending = true;
+            mLogger.trace( "IoTFleetWiseEngine::checkAndSendRetrievedData",
+                           "Persisted data gives way to live data after " + std::to_string( sentPayloads ) +
+                               " payloads" );
+            return true;
+        }
+        size_t chunkBytes = 0;
+        for ( auto &payload : chunk.payloads )
+        {
+            chunkBytes += ( payload != nullptr ) ? payload->size() : 0;
+            // transmit the retrieved payload, the buffer is handed over without copying
+            ConnectivityError res = mDataCollectionSender->transmitPersisted( std::move( payload ) );
             if ( res != ConnectivityError::Success )
             {
-                // Error occurred in the transmission
+                // Error occurred in the transmission, the chunk stays on disk
                 mLogger.error( "IoTFleetWiseEngine::checkAndSendRetrievedData",
                                "Payload transmission failed, will be retried on the next bootup" );
-                break;
+                return false;
             }
             else
             {
@@ -851,26 +2605,39 @@ IoTFleetWiseEngine::checkAndSendRetrievedData()
                                "Payload has been successfully sent to the backend" );
             }
         }
-        if ( res == ConnectivityError::Success )
+        sentPayloads += chunk.payloads.size();
+        if ( liveDataWaiting )
         {
-            // All the stored data has been transmitted, erase the file contents
-            mPersistDecoderManifestCollectionSchemesAndData->erase( DataType::EDGE_TO_CLOUD_PAYLOAD );
-            mLogger.info( "IoTFleetWiseEngine::checkAndSendRetrievedData",
-                          "All " + std::to_string( payloads.size() ) + " Payloads successfully sent to the backend" );
-            return true;
+            mPersistedDataDrainCredit -= static_cast<double>( chunkBytes );
         }
-        return false;
+        // All the payloads of the chunk have been transmitted, free them from disk
+        mPayloadManager->acknowledge( chunk );
+        status = mPayloadManager->retrieveNext( chunk, MAX_DATA_RD_SIZE );
     }
-    else if ( status == ErrorCode::EMPTY )
+    mLogger.info( "IoTFleetWiseEngine::checkAndSendRetrievedData",
+                  "All " + std::to_string( sentPayloads ) + " Payloads successfully sent to the backend" );
+    return true;
+}
+
+bool
+IoTFleetWiseEngine::mayUploadPersistedData( bool &liveDataWaiting )
+{
+    liveDataWaiting = false;
+    if ( mPersistedDataDrainShare >= 1.0 )
     {
-        mLogger.trace( "IoTFleetWiseEngine::checkAndSendRetrievedData", "No Payloads to Retrieve" );
         return true;
     }
-    else
-    {
-        mLogger.error( "IoTFleetWiseEngine::checkAndSendRetrievedData", "Payload Retrieval Failed" );
-        return false;
-    }
+    // For every live byte uploaded share / ( 1 - share ) persisted bytes may follow
+    auto liveBytes = TraceModule::get().getAtomicVariable( TraceAtomicVariable::UPLOADED_LIVE_BYTES );
+    auto earned = static_cast<double>( liveBytes - mLastUploadedLiveBytes ) * mPersistedDataDrainShare /
+                  ( 1.0 - mPersistedDataDrainShare );
+    mLastUploadedLiveBytes = liveBytes;
+    // At most one chunk can be earned in advance, so that no burst of persisted data delays the live data
+    mPersistedDataDrainCredit =
+        std::min( mPersistedDataDrainCredit + earned, static_cast<double>( MAX_DATA_RD_SIZE ) );
+    // Without live data waiting the persisted data uses the idle connection
+    liveDataWaiting = mCollectedDataReadyToPublish->read_available() > 0;
+    return ( !liveDataWaiting ) || ( mPersistedDataDrainCredit > 0.0 );
 }
 
 } // namespace ExecutionManagement
@@ -12,13 +12,18 @@
  */
 
 // Includes
+#include "AsyncLogger.h"
+#include "FleetSimulator.h"
 #include "IoTFleetWiseConfig.h"
 #include "IoTFleetWiseEngine.h"
 #include "IoTFleetWiseVersion.h"
 #include "LogLevel.h"
+#include "Thread.h"
 #include <csignal>
 #include <cstdlib>
 #include <iostream>
+#include <map>
+#include <memory>
 
 using namespace Aws::IoTFleetWise::ExecutionManagement;
 
@@ -48,30 +53,54 @@ setSystemWideLogLevel( const Json::Value &config )
     gSystemWideLogLevel = logLevel;
 }
 
-int
-main( int argc, char *argv[] )
+static bool
+setThreadConfigs( const Json::Value &config )
 {
-    printVersion();
-    if ( argc != 2 )
+    using namespace Aws::IoTFleetWise::Platform::Linux;
+    if ( !config["staticConfig"].isMember( "threads" ) )
     {
-        std::cout << "error: invalid argument - only a config file is required" << std::endl;
-        return EXIT_FAILURE;
+        return true;
+    }
+    std::map<std::string, ThreadConfig> threadConfigs;
+    if ( !IoTFleetWiseConfig::readThreadConfigs( config["staticConfig"]["threads"], threadConfigs ) )
+    {
+        std::cout << "error: invalid scheduling policy in the thread configuration" << std::endl;
+        return false;
     }
+    Thread::setConfigs( std::move( threadConfigs ) );
+    return true;
+}
 
-    IoTFleetWiseEngine engine;
-    signal( SIGINT, signalHandler );
-    std::string configFilename = argv[1];
-    Json::Value config;
-    if ( !IoTFleetWiseConfig::read( configFilename, config ) )
+static std::unique_ptr<Aws::IoTFleetWise::Platform::Linux::AsyncLogger>
+startAsyncLogging( const Json::Value &config )
+{
+    const auto &internalParameters = config["staticConfig"]["internalParameters"];
+    if ( ( !internalParameters.isMember( "asyncLogBufferSize" ) ) ||
+         ( internalParameters["asyncLogBufferSize"].asUInt() == 0U ) )
     {
-        std::cout << " AWS IoT FleetWise Edge Service failed to read config file: " + configFilename << std::endl;
-        return EXIT_FAILURE;
+        return nullptr;
     }
-    // Set system wide log level
-    setSystemWideLogLevel( config );
+    std::unique_ptr<Aws::IoTFleetWise::Platform::Linux::AsyncLogger> asyncLogger(
+        new Aws::IoTFleetWise::Platform::Linux::AsyncLogger( internalParameters["asyncLogBufferSize"].asUInt() ) );
+    if ( !asyncLogger->start() )
+    {
+        std::cout << "Failed to start the log writer thread, logging synchronously" << std::endl;
+        return nullptr;
+    }
+    return asyncLogger;
+}
 
-    // Connect the Engine
-    if ( engine.connect( config ) && engine.start() )
+/**
+ * @brief Runs the engine, or the fleet simulator, until SIGINT is received
+ */
+template <typename Service>
+static int
+runService( Service &service,
+            const Json::Value &config,
+            std::unique_ptr<Aws::IoTFleetWise::Platform::Linux::AsyncLogger> &asyncLogger )
+{
+    // Connect the Service
+    if ( service.connect( config ) && service.start() )
     {
         std::cout << " AWS IoT FleetWise Edge Service Started successfully " << std::endl;
     }
@@ -84,7 +113,12 @@ main( int argc, char *argv[] )
     {
         sleep( 1 );
     }
-    if ( engine.stop() && engine.disconnect() )
+    bool stopped = service.stop() && service.disconnect();
+    if ( asyncLogger != nullptr )
+    {
+        asyncLogger->stop();
+    }
+    if ( stopped )
     {
         std::cout << " AWS IoT FleetWise Edge Service Stopped successfully " << std::endl;
         return EXIT_SUCCESS;
@@ -93,3 +127,41 @@ main( int argc, char *argv[] )
     std::cout << " AWS IoT FleetWise Edge Service Stopped with errors " << std::endl;
     return EXIT_FAILURE;
 }
+
+int
+main( int argc, char *argv[] )
+{
+    printVersion();
+    if ( argc != 2 )
+    {
+        std::cout << "error: invalid argument - only a config file is required" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    signal( SIGINT, signalHandler );
+    std::string configFilename = argv[1];
+    Json::Value config;
+    if ( !IoTFleetWiseConfig::read( configFilename, config ) )
+    {
+        std::cout << " AWS IoT FleetWise Edge Service failed to read config file: " + configFilename << std::endl;
+        return EXIT_FAILURE;
+    }
+    // Set system wide log level
+    setSystemWideLogLevel( config );
+    // Set the thread configurations before any thread is created
+    if ( !setThreadConfigs( config ) )
+    {
+        return EXIT_FAILURE;
+    }
+    // Log writer thread, stopped after the engine so that all messages of the engine threads are written
+    auto asyncLogger = startAsyncLogging( config );
+
+    // Simulates many vehicles sharing the connectivity and reader threads if configured
+    if ( FleetSimulator::isEnabled( config ) )
+    {
+        FleetSimulator fleetSimulator;
+        return runService( fleetSimulator, config, asyncLogger );
+    }
+    IoTFleetWiseEngine engine;
+    return runService( engine, config, asyncLogger );
+}
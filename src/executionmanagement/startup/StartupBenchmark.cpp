@@ -0,0 +1,337 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "StartupBenchmark.h"
+#include "CacheAndPersist.h"
+#include "FastClock.h"
+#include "HarnessDocuments.h"
+#include "IoTFleetWiseEngine.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <thread>
+#include <unistd.h>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace ExecutionManagement
+{
+namespace
+{
+const std::string DECODER_MANIFEST_ARN = "arn:aws:iotfleetwise:::decoder-manifest/startup-benchmark";
+
+double
+toMs( uint64_t us )
+{
+    return static_cast<double>( us ) / 1000.0;
+}
+
+uint64_t
+median( std::vector<uint64_t> values )
+{
+    if ( values.empty() )
+    {
+        return 0;
+    }
+    std::sort( values.begin(), values.end() );
+    return values[values.size() / 2];
+}
+} // namespace
+
+constexpr uint32_t StartupBenchmark::POLL_INTERVAL_MS;
+
+StartupBenchmark::StartupBenchmark( StartupBenchmarkConfig config )
+    : mConfig( std::move( config ) )
+{
+    mConfig.coldRuns = std::max( mConfig.coldRuns, 1U );
+}
+
+bool
+StartupBenchmark::prepare( const Json::Value &engineConfig )
+{
+    if ( !readDbcFile( mConfig.dbcFilename, mMessages ) )
+    {
+        mLogger.error( "StartupBenchmark::prepare", " Could not read any message from " + mConfig.dbcFilename );
+        return false;
+    }
+    for ( const auto &networkInterface : engineConfig["networkInterfaces"] )
+    {
+        if ( networkInterface["type"].asString() != "canInterface" )
+        {
+            continue;
+        }
+        std::unique_ptr<CANFrameGenerator> generator( new CANFrameGenerator(
+            networkInterface["canInterface"]["interfaceName"].asString(), mMessages ) );
+        if ( !generator->connect() )
+        {
+            return false;
+        }
+        mInterfaceIds.emplace_back( networkInterface["interfaceId"].asString() );
+        mGenerators.emplace_back( std::move( generator ) );
+    }
+    if ( mGenerators.empty() )
+    {
+        mLogger.error( "StartupBenchmark::prepare", " The config has no CAN interface " );
+        return false;
+    }
+    for ( const auto &message : mMessages )
+    {
+        mSignalCount += static_cast<uint32_t>( message.signals.size() );
+    }
+    mSignalCount *= static_cast<uint32_t>( mInterfaceIds.size() );
+    return true;
+}
+
+bool
+StartupBenchmark::preparePersistency( Json::Value &engineConfig )
+{
+    char persistencyPath[] = "/tmp/fwe-startup-benchmark-XXXXXX";
+    if ( mkdtemp( persistencyPath ) == nullptr )
+    {
+        mLogger.error( "StartupBenchmark::preparePersistency", " Could not create the persistency directory " );
+        return false;
+    }
+    auto &staticConfig = engineConfig["staticConfig"];
+    staticConfig["persistency"]["persistencyPath"] = std::string( persistencyPath ) + "/";
+    PersistencyManagement::CacheAndPersist persistency(
+        staticConfig["persistency"]["persistencyPath"].asString(),
+        staticConfig["persistency"]["persistencyPartitionMaxSize"].asUInt() );
+    auto decoderManifest = createHarnessDecoderManifest( DECODER_MANIFEST_ARN, mMessages, mInterfaceIds );
+    auto collectionSchemeList = createHarnessCollectionSchemeList(
+        DECODER_MANIFEST_ARN, mSignalCount, mConfig.triggerIntervalMs, mConfig.sampleBufferSize );
+    if ( ( !persistency.init() ) || decoderManifest.empty() || collectionSchemeList.empty() ||
+         ( persistency.write( reinterpret_cast<const uint8_t *>( decoderManifest.data() ),
+                              decoderManifest.size(),
+                              PersistencyManagement::DataType::DECODER_MANIFEST ) !=
+           PersistencyManagement::ErrorCode::SUCCESS ) ||
+         ( persistency.write( reinterpret_cast<const uint8_t *>( collectionSchemeList.data() ),
+                              collectionSchemeList.size(),
+                              PersistencyManagement::DataType::COLLECTION_SCHEME_LIST ) !=
+           PersistencyManagement::ErrorCode::SUCCESS ) )
+    {
+        mLogger.error( "StartupBenchmark::preparePersistency",
+                       " Could not persist the decoder manifest and campaign " );
+        return false;
+    }
+    mLogger.info( "StartupBenchmark::preparePersistency", " Persistency in " + std::string( persistencyPath ) );
+    return true;
+}
+
+void
+StartupBenchmark::dropPageCache()
+{
+    // The dirty pages are written first, as only clean pages are dropped
+    sync();
+    std::ofstream dropCaches( "/proc/sys/vm/drop_caches" );
+    dropCaches << "1" << std::endl;
+    if ( !dropCaches.good() )
+    {
+        mLogger.warn( "StartupBenchmark::dropPageCache",
+                      " Could not drop the page cache, the cold run may find the files in memory " );
+    }
+}
+
+bool
+StartupBenchmark::runOnce( const Json::Value &engineConfig, bool cold )
+{
+    StartupRunResult result;
+    result.cold = cold;
+    auto &trace = TraceModule::get();
+    auto decodedBefore = trace.getVariable( TraceVariable::CAN_DECODED_FRAMES );
+    uint64_t evaluationsAtFirstDecode = 0;
+    std::map<TraceSection, uint32_t> sectionHitsBefore;
+    for ( auto i = 0U; i < toUType( TraceSection::TRACE_SECTION_SIZE ); i++ )
+    {
+        auto section = static_cast<TraceSection>( i );
+        sectionHitsBefore[section] = trace.getSectionHitCount( section );
+    }
+    auto sink = std::make_shared<CollectedDataSink>();
+    IoTFleetWiseEngine engine;
+    engine.setCollectedDataSender( sink );
+
+    // The engine starts in another thread, so that the frames decoded while it starts are noticed
+    std::atomic<bool> started( false );
+    std::atomic<bool> startFailed( false );
+    auto startTimeUs = FastClock::monotonicTimeUs();
+    std::thread starter( [&]() {
+        if ( ( !engine.connect( engineConfig ) ) || ( !engine.start() ) )
+        {
+            startFailed = true;
+        }
+        result.startedUs = FastClock::monotonicTimeUs() - startTimeUs;
+        started = true;
+    } );
+    bool firstFrameDecoded = false;
+    bool firstEvaluation = false;
+    bool firstPublish = false;
+    while ( ( !startFailed ) && ( !( started && firstPublish ) ) )
+    {
+        auto elapsedUs = FastClock::monotonicTimeUs() - startTimeUs;
+        if ( elapsedUs > static_cast<uint64_t>( mConfig.timeoutMs ) * 1000U )
+        {
+            break;
+        }
+        if ( ( !firstFrameDecoded ) && ( trace.getVariable( TraceVariable::CAN_DECODED_FRAMES ) > decodedBefore ) )
+        {
+            firstFrameDecoded = true;
+            result.firstFrameDecodedUs = elapsedUs;
+            evaluationsAtFirstDecode = trace.getVariable( TraceVariable::INSPECTION_EVALUATIONS );
+        }
+        if ( firstFrameDecoded && ( !firstEvaluation ) &&
+             ( trace.getVariable( TraceVariable::INSPECTION_EVALUATIONS ) > evaluationsAtFirstDecode ) )
+        {
+            firstEvaluation = true;
+            result.firstEvaluationUs = elapsedUs;
+        }
+        if ( ( !firstPublish ) && ( sink->getPayloads() > 0U ) )
+        {
+            firstPublish = true;
+            result.firstPublishUs = elapsedUs;
+        }
+        std::this_thread::sleep_for( std::chrono::milliseconds( POLL_INTERVAL_MS ) );
+    }
+    starter.join();
+    for ( const auto &before : sectionHitsBefore )
+    {
+        if ( trace.getSectionHitCount( before.first ) > before.second )
+        {
+            result.sectionsUs[TraceModule::getSectionName( before.first )] =
+                static_cast<uint64_t>( trace.getSectionLastDuration( before.first ) * 1e6 );
+        }
+    }
+    auto shutdownStartUs = FastClock::monotonicTimeUs();
+    engine.stop();
+    engine.disconnect();
+    result.shutdownUs = FastClock::monotonicTimeUs() - shutdownStartUs;
+    if ( startFailed )
+    {
+        mLogger.error( "StartupBenchmark::runOnce", " The engine failed to start " );
+        return false;
+    }
+    if ( !firstPublish )
+    {
+        mLogger.error( "StartupBenchmark::runOnce",
+                       " No payload was published within " + std::to_string( mConfig.timeoutMs ) +
+                           " ms, check that the CAN interfaces are up" );
+        return false;
+    }
+    mResults.emplace_back( result );
+    printResult( result );
+    return true;
+}
+
+void
+StartupBenchmark::printResult( const StartupRunResult &result )
+{
+    std::cout << std::fixed << std::setprecision( 1 );
+    std::cout << ( result.cold ? "Cold" : "Warm" ) << " start: started " << toMs( result.startedUs )
+              << " ms, first frame decoded " << toMs( result.firstFrameDecodedUs ) << " ms, first evaluation "
+              << toMs( result.firstEvaluationUs ) << " ms, first publish " << toMs( result.firstPublishUs )
+              << " ms, shutdown " << toMs( result.shutdownUs ) << " ms" << std::endl;
+    std::cout << "  sections:";
+    for ( const auto &section : result.sectionsUs )
+    {
+        std::cout << " " << section.first << " " << toMs( section.second ) << " ms";
+    }
+    std::cout << std::endl;
+}
+
+void
+StartupBenchmark::printSummary( bool cold )
+{
+    std::vector<StartupRunResult> runs;
+    std::copy_if( mResults.begin(), mResults.end(), std::back_inserter( runs ), [cold]( const StartupRunResult &r ) {
+        return r.cold == cold;
+    } );
+    if ( runs.empty() )
+    {
+        return;
+    }
+    auto medianOf = [&runs]( uint64_t StartupRunResult::*member ) {
+        std::vector<uint64_t> values;
+        for ( const auto &r : runs )
+        {
+            values.push_back( r.*member );
+        }
+        return toMs( median( values ) );
+    };
+    std::cout << "Median of " << runs.size() << ( cold ? " cold" : " warm" ) << " starts: started "
+              << medianOf( &StartupRunResult::startedUs ) << " ms, first frame decoded "
+              << medianOf( &StartupRunResult::firstFrameDecodedUs ) << " ms, first evaluation "
+              << medianOf( &StartupRunResult::firstEvaluationUs ) << " ms, first publish "
+              << medianOf( &StartupRunResult::firstPublishUs ) << " ms" << std::endl;
+    std::map<std::string, std::vector<uint64_t>> sections;
+    for ( const auto &r : runs )
+    {
+        for ( const auto &section : r.sectionsUs )
+        {
+            sections[section.first].push_back( section.second );
+        }
+    }
+    std::cout << "  sections:";
+    for ( const auto &section : sections )
+    {
+        std::cout << " " << section.first << " " << toMs( median( section.second ) ) << " ms";
+    }
+    std::cout << std::endl;
+}
+
+bool
+StartupBenchmark::run( Json::Value engineConfig )
+{
+    if ( !prepare( engineConfig ) )
+    {
+        return false;
+    }
+    // The profiler would start new observation windows, which do not matter here, and connect to AWS IoT
+    engineConfig["staticConfig"].removeMember( "remoteProfilerDefaultValues" );
+    bool success = true;
+    for ( auto &generator : mGenerators )
+    {
+        success = success && generator->start();
+        generator->setFramesPerSecond( mConfig.framesPerSecond / static_cast<uint32_t>( mGenerators.size() ) );
+    }
+    for ( uint32_t coldRun = 0; success && ( coldRun < mConfig.coldRuns ); coldRun++ )
+    {
+        success = preparePersistency( engineConfig );
+        if ( success && mConfig.dropPageCache )
+        {
+            dropPageCache();
+        }
+        success = success && runOnce( engineConfig, true );
+        for ( uint32_t warmRun = 0; success && ( warmRun < mConfig.warmRuns ); warmRun++ )
+        {
+            success = runOnce( engineConfig, false );
+        }
+    }
+    for ( auto &generator : mGenerators )
+    {
+        generator->setFramesPerSecond( 0 );
+        generator->stop();
+    }
+    printSummary( true );
+    printSummary( false );
+    return success;
+}
+
+} // namespace ExecutionManagement
+} // namespace IoTFleetWise
+} // namespace Aws
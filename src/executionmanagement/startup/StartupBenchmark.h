@@ -0,0 +1,121 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "CANFrameGenerator.h"
+#include "CollectedDataSink.h"
+#include "DbcFile.h"
+#include "LoggingModule.h"
+#include "TraceModule.h"
+#include <json/json.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace ExecutionManagement
+{
+
+struct StartupBenchmarkConfig
+{
+    // DBC file whose messages are written to every CAN interface, e.g. tools/cansim/hscan.dbc
+    std::string dbcFilename;
+    // Frames per second over all interfaces, written from before the engine starts until it stopped
+    uint32_t framesPerSecond{ 1000 };
+    // Runs from a persistency with only the decoder manifest and campaign
+    uint32_t coldRuns{ 1 };
+    // Runs after every cold run with the persistency and the page cache the previous run left behind
+    uint32_t warmRuns{ 3 };
+    // Drops the page cache of the kernel before every cold run, needs root
+    bool dropPageCache{ false };
+    uint32_t triggerIntervalMs{ 100 };
+    uint32_t sampleBufferSize{ 100 };
+    // A run without a published payload after this time fails
+    uint32_t timeoutMs{ 30000 };
+};
+
+/**
+ * @brief Times of one start of the engine, relative to the call of IoTFleetWiseEngine::connect
+ */
+struct StartupRunResult
+{
+    bool cold{ false };
+    uint64_t startedUs{ 0 };           // connect and start returned
+    uint64_t firstFrameDecodedUs{ 0 }; // a CAN frame was decoded with the decoder manifest
+    uint64_t firstEvaluationUs{ 0 };   // the conditions were evaluated after the first decoded frame
+    uint64_t firstPublishUs{ 0 };      // the first payload was handed over to the sender
+    uint64_t shutdownUs{ 0 };          // duration of stop and disconnect
+    // Duration in microseconds of the TraceSections that ended during the run, by section name
+    std::map<std::string, uint64_t> sectionsUs;
+};
+
+/**
+ * @brief Measures how long IoTFleetWiseEngine takes from its start until the first CAN frame is decoded, the
+ * conditions are evaluated and the first payload is published.
+ *
+ * Like the ThroughputHarness, a decoder manifest with the messages of a DBC file on every CAN interface and a
+ * campaign collecting all its signals are persisted, and the collected data is sent to a CollectedDataSink. The
+ * frames are written while the engine starts, like the traffic on the bus at ignition. A cold run starts from a
+ * persistency directory with only these documents, the warm runs after it reuse the directory with everything the
+ * previous run persisted, for example the decoder dictionary snapshot, and find the files in the page cache.
+ */
+class StartupBenchmark
+{
+public:
+    // Interval in which the progress of the engine is polled
+    static constexpr uint32_t POLL_INTERVAL_MS = 1;
+
+    explicit StartupBenchmark( StartupBenchmarkConfig config );
+
+    /**
+     * @brief Runs the cold and warm starts of the engine with the given config. The results of every run and the
+     * medians of the cold and warm runs are printed.
+     * @param engineConfig config of the engine, with at least one CAN interface
+     * @return False if the engine could not be started or a run did not publish within the timeout
+     */
+    bool run( Json::Value engineConfig );
+
+    const std::vector<StartupRunResult> &
+    getResults() const
+    {
+        return mResults;
+    }
+
+private:
+    // Creates the frame generators and counts the signals of the decoder manifest
+    bool prepare( const Json::Value &engineConfig );
+    // Creates a new persistency directory with the decoder manifest and campaign and points the config to it
+    bool preparePersistency( Json::Value &engineConfig );
+    void dropPageCache();
+    bool runOnce( const Json::Value &engineConfig, bool cold );
+    static void printResult( const StartupRunResult &result );
+    void printSummary( bool cold );
+
+    StartupBenchmarkConfig mConfig;
+    std::vector<DbcMessage> mMessages;
+    std::vector<std::string> mInterfaceIds;
+    uint32_t mSignalCount{ 0 };
+    std::vector<std::unique_ptr<CANFrameGenerator>> mGenerators;
+    std::vector<StartupRunResult> mResults;
+    LoggingModule mLogger;
+};
+
+} // namespace ExecutionManagement
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -0,0 +1,91 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "IoTFleetWiseConfig.h"
+#include "LogLevel.h"
+#include "StartupBenchmark.h"
+#include <cstdlib>
+#include <iostream>
+
+using namespace Aws::IoTFleetWise::ExecutionManagement;
+
+static StartupBenchmarkConfig
+readBenchmarkConfig( const Json::Value &config )
+{
+    StartupBenchmarkConfig benchmarkConfig;
+    benchmarkConfig.dbcFilename = config["dbcFilename"].asString();
+    if ( config.isMember( "framesPerSecond" ) )
+    {
+        benchmarkConfig.framesPerSecond = config["framesPerSecond"].asUInt();
+    }
+    if ( config.isMember( "coldRuns" ) )
+    {
+        benchmarkConfig.coldRuns = config["coldRuns"].asUInt();
+    }
+    if ( config.isMember( "warmRuns" ) )
+    {
+        benchmarkConfig.warmRuns = config["warmRuns"].asUInt();
+    }
+    if ( config.isMember( "dropPageCache" ) )
+    {
+        benchmarkConfig.dropPageCache = config["dropPageCache"].asBool();
+    }
+    if ( config.isMember( "triggerIntervalMs" ) )
+    {
+        benchmarkConfig.triggerIntervalMs = config["triggerIntervalMs"].asUInt();
+    }
+    if ( config.isMember( "sampleBufferSize" ) )
+    {
+        benchmarkConfig.sampleBufferSize = config["sampleBufferSize"].asUInt();
+    }
+    if ( config.isMember( "timeoutMs" ) )
+    {
+        benchmarkConfig.timeoutMs = config["timeoutMs"].asUInt();
+    }
+    return benchmarkConfig;
+}
+
+int
+main( int argc, char *argv[] )
+{
+    if ( argc != 2 )
+    {
+        std::cout << "usage: fwe-startup-benchmark <config file>" << std::endl
+                  << "The config file is an engine config with an additional startupBenchmark section" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::string configFilename = argv[1];
+    Json::Value config;
+    if ( !IoTFleetWiseConfig::read( configFilename, config ) )
+    {
+        std::cout << "Failed to read config file: " + configFilename << std::endl;
+        return EXIT_FAILURE;
+    }
+    if ( !config.isMember( "startupBenchmark" ) )
+    {
+        std::cout << "The config file has no startupBenchmark section" << std::endl;
+        return EXIT_FAILURE;
+    }
+    Aws::IoTFleetWise::Platform::Linux::LogLevel logLevel = Aws::IoTFleetWise::Platform::Linux::LogLevel::Warning;
+    stringToLogLevel( config["staticConfig"]["internalParameters"]["systemWideLogLevel"].asString(), logLevel );
+    gSystemWideLogLevel = logLevel;
+
+    StartupBenchmark benchmark( readBenchmarkConfig( config["startupBenchmark"] ) );
+    if ( !benchmark.run( config ) )
+    {
+        std::cout << "Startup benchmark failed" << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
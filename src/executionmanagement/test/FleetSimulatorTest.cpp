@@ -0,0 +1,89 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "FleetSimulator.h"
+#include "IoTFleetWiseConfig.h"
+#include <gtest/gtest.h>
+
+using namespace Aws::IoTFleetWise::ExecutionManagement;
+
+class FleetSimulatorTest : public ::testing::Test
+{
+protected:
+    void
+    SetUp() override
+    {
+        ASSERT_TRUE( IoTFleetWiseConfig::read( "em-example-config.json", mConfig ) );
+        auto &mqttConnection = mConfig["staticConfig"]["mqttConnection"];
+        mqttConnection["clientId"] = "car";
+        mqttConnection["canDataTopic"] = "$aws/iotfleetwise/vehicles/car/signals";
+        mqttConnection["checkinTopic"] = "$aws/iotfleetwise/vehicles/car/checkins";
+        mConfig["staticConfig"]["persistency"]["persistencyPath"] = "./persistency";
+        mConfig["staticConfig"]["internalParameters"]["threadTelemetrySamplingPeriodMs"] = 1000;
+        mConfig["staticConfig"]["internalParameters"]["latencyTraceSamplingInterval"] = 100;
+        mConfig["staticConfig"]["fleetSimulation"]["vehicleCount"] = 3;
+        mConfig["staticConfig"]["fleetSimulation"]["clientIdPrefix"] = "sim-";
+        mConfig["staticConfig"]["fleetSimulation"]["firstVehicleIndex"] = 10;
+    }
+
+    Json::Value mConfig;
+};
+
+TEST_F( FleetSimulatorTest, isEnabled )
+{
+    ASSERT_TRUE( FleetSimulator::isEnabled( mConfig ) );
+    mConfig["staticConfig"]["fleetSimulation"]["vehicleCount"] = 0;
+    ASSERT_FALSE( FleetSimulator::isEnabled( mConfig ) );
+    mConfig["staticConfig"].removeMember( "fleetSimulation" );
+    ASSERT_FALSE( FleetSimulator::isEnabled( mConfig ) );
+}
+
+TEST_F( FleetSimulatorTest, createVehicleConfig )
+{
+    Json::Value vehicleConfig;
+    ASSERT_TRUE( FleetSimulator::createVehicleConfig( mConfig, 0, vehicleConfig ) );
+    const auto &firstStaticConfig = vehicleConfig["staticConfig"];
+    ASSERT_EQ( firstStaticConfig["mqttConnection"]["clientId"].asString(), "sim-10" );
+    ASSERT_EQ( firstStaticConfig["mqttConnection"]["canDataTopic"].asString(),
+               "$aws/iotfleetwise/vehicles/sim-10/signals" );
+    ASSERT_EQ( firstStaticConfig["mqttConnection"]["checkinTopic"].asString(),
+               "$aws/iotfleetwise/vehicles/sim-10/checkins" );
+    ASSERT_EQ( firstStaticConfig["persistency"]["persistencyPath"].asString(), "./persistency/sim-10" );
+    ASSERT_FALSE( firstStaticConfig.isMember( "fleetSimulation" ) );
+    // The first vehicle keeps the process wide features
+    ASSERT_TRUE( firstStaticConfig["internalParameters"].isMember( "threadTelemetrySamplingPeriodMs" ) );
+    ASSERT_TRUE( firstStaticConfig["internalParameters"].isMember( "latencyTraceSamplingInterval" ) );
+
+    ASSERT_TRUE( FleetSimulator::createVehicleConfig( mConfig, 2, vehicleConfig ) );
+    const auto &lastStaticConfig = vehicleConfig["staticConfig"];
+    ASSERT_EQ( lastStaticConfig["mqttConnection"]["clientId"].asString(), "sim-12" );
+    ASSERT_EQ( lastStaticConfig["mqttConnection"]["canDataTopic"].asString(),
+               "$aws/iotfleetwise/vehicles/sim-12/signals" );
+    ASSERT_EQ( lastStaticConfig["persistency"]["persistencyPath"].asString(), "./persistency/sim-12" );
+    ASSERT_FALSE( lastStaticConfig.isMember( "remoteProfilerDefaultValues" ) );
+    ASSERT_FALSE( lastStaticConfig["internalParameters"].isMember( "threadTelemetrySamplingPeriodMs" ) );
+    ASSERT_FALSE( lastStaticConfig["internalParameters"].isMember( "latencyTraceSamplingInterval" ) );
+    // The fleet config itself is not modified
+    ASSERT_EQ( mConfig["staticConfig"]["mqttConnection"]["clientId"].asString(), "car" );
+
+    ASSERT_FALSE( FleetSimulator::createVehicleConfig( mConfig, 3, vehicleConfig ) );
+}
+
+TEST_F( FleetSimulatorTest, connectWithoutVehicles )
+{
+    mConfig["staticConfig"].removeMember( "fleetSimulation" );
+    FleetSimulator fleetSimulator;
+    ASSERT_FALSE( fleetSimulator.connect( mConfig ) );
+    ASSERT_FALSE( fleetSimulator.isAlive() );
+    ASSERT_EQ( fleetSimulator.getVehicleCount(), 0 );
+}
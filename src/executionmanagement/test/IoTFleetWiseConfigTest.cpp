@@ -32,3 +32,26 @@ TEST( IoTFleetWiseConfigTest, ReadOk )
     ASSERT_EQ( 10000, config["staticConfig"]["bufferSizes"]["rawCANFrameBufferSize"].asInt() );
     ASSERT_EQ( "Trace", config["staticConfig"]["internalParameters"]["systemWideLogLevel"].asString() );
 }
+
+TEST( IoTFleetWiseConfigTest, ReadThreadConfigs )
+{
+    Json::Value threads;
+    threads["fwDIConsumer*"]["cpuAffinity"].append( 2 );
+    threads["fwDIConsumer*"]["cpuAffinity"].append( 3 );
+    threads["fwDIConsumer*"]["schedulingPolicy"] = "SCHED_FIFO";
+    threads["fwDIConsumer*"]["priority"] = 10;
+    threads["fwVNReader1"]["nice"] = -5;
+    std::map<std::string, Aws::IoTFleetWise::Platform::Linux::ThreadConfig> threadConfigs;
+    ASSERT_TRUE( IoTFleetWiseConfig::readThreadConfigs( threads, threadConfigs ) );
+    ASSERT_EQ( threadConfigs.size(), 2 );
+    const auto &consumers = threadConfigs["fwDIConsumer*"];
+    ASSERT_EQ( consumers.cpuAffinity, ( std::vector<uint32_t>{ 2, 3 } ) );
+    ASSERT_EQ( consumers.schedulingPolicy, Aws::IoTFleetWise::Platform::Linux::ThreadSchedulingPolicy::FIFO );
+    ASSERT_EQ( consumers.priority, 10 );
+    ASSERT_FALSE( consumers.hasNice );
+    ASSERT_TRUE( threadConfigs["fwVNReader1"].hasNice );
+    ASSERT_EQ( threadConfigs["fwVNReader1"].nice, -5 );
+
+    threads["fwVNReader1"]["schedulingPolicy"] = "SCHED_DEADLINE";
+    ASSERT_FALSE( IoTFleetWiseConfig::readThreadConfigs( threads, threadConfigs ) );
+}
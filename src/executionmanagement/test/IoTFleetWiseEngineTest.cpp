@@ -68,6 +68,73 @@ TEST_F( IoTFleetWiseEngineTest, InitAndStartEngine )
     ASSERT_TRUE( engine.stop() );
 }
 
+TEST_F( IoTFleetWiseEngineTest, ApplyRuntimeConfig )
+{
+    Json::Value config;
+    ASSERT_TRUE( IoTFleetWiseConfig::read( "em-example-config.json", config ) );
+    IoTFleetWiseEngine engine;
+    ASSERT_TRUE( engine.connect( config ) );
+
+    Json::Value runtimeConfig;
+    runtimeConfig["publishToCloudParameters"]["maxPublishMessageCount"] = 100;
+    runtimeConfig["persistency"]["persistencyUploadRetryIntervalMs"] = 5000;
+    runtimeConfig["threadIdleTimes"]["inspectionThreadSpinCount"] = 100;
+    runtimeConfig["threadIdleTimes"]["canDecoderThreadYieldCount"] = 10;
+    runtimeConfig["threads"]["fwTestRuntime*"]["nice"] = 5;
+    ASSERT_TRUE( engine.applyRuntimeConfig( runtimeConfig ) );
+    Aws::IoTFleetWise::Platform::Linux::ThreadConfig threadConfig;
+    ASSERT_TRUE( Aws::IoTFleetWise::Platform::Linux::Thread::findConfig( "fwTestRuntime1", threadConfig ) );
+    ASSERT_EQ( threadConfig.nice, 5 );
+
+    // Unknown members, invalid values and rate limits without upload shaper reject the whole document
+    auto unknownMember = runtimeConfig;
+    unknownMember["publishToCloudParameters"]["senderWorkerThreads"] = 2;
+    unknownMember["threads"]["fwTestRuntime*"]["nice"] = 6;
+    ASSERT_FALSE( engine.applyRuntimeConfig( unknownMember ) );
+    ASSERT_TRUE( Aws::IoTFleetWise::Platform::Linux::Thread::findConfig( "fwTestRuntime1", threadConfig ) );
+    ASSERT_EQ( threadConfig.nice, 5 );
+    Json::Value invalidValue;
+    invalidValue["persistency"]["persistencyUploadRetryIntervalMs"] = -1;
+    ASSERT_FALSE( engine.applyRuntimeConfig( invalidValue ) );
+    Json::Value rateLimits;
+    rateLimits["uploadRateLimits"]["bytesPerSecond"] = 1000;
+    ASSERT_FALSE( engine.applyRuntimeConfig( rateLimits ) );
+
+    ASSERT_TRUE( engine.disconnect() );
+    Aws::IoTFleetWise::Platform::Linux::Thread::setConfigs( {} );
+}
+
+TEST_F( IoTFleetWiseEngineTest, ConnectionPool )
+{
+    Json::Value config;
+    ASSERT_TRUE( IoTFleetWiseConfig::read( "em-example-config.json", config ) );
+    auto &connectionPool = config["staticConfig"]["mqttConnection"]["connectionPool"];
+    connectionPool["connections"] = 2;
+    connectionPool["topics"]["decoderManifestTopic"] = 2;
+    {
+        // Topic assigned to a connection outside of the pool
+        IoTFleetWiseEngine engine;
+        ASSERT_FALSE( engine.connect( config ) );
+    }
+    connectionPool["topics"]["decoderManifestTopic"] = 1;
+    connectionPool["topics"]["unknownTopic"] = 1;
+    {
+        IoTFleetWiseEngine engine;
+        ASSERT_FALSE( engine.connect( config ) );
+    }
+    connectionPool["topics"].removeMember( "unknownTopic" );
+    connectionPool["topics"]["canDataTopic"] = 1;
+    connectionPool["expressConnection"] = 0;
+    config["staticConfig"]["publishToCloudParameters"]["expressLane"]["maxPriority"] = 0;
+
+    IoTFleetWiseEngine engine;
+    ASSERT_TRUE( engine.connect( config ) );
+    ASSERT_TRUE( engine.start() );
+    ASSERT_TRUE( engine.isAlive() );
+    ASSERT_TRUE( engine.disconnect() );
+    ASSERT_TRUE( engine.stop() );
+}
+
 TEST_F( IoTFleetWiseEngineTest, CheckPublishDataQueue )
 {
     Json::Value config;
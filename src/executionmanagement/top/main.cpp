@@ -0,0 +1,186 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+
+// Includes
+#include "TraceSharedMemory.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+constexpr const char *DEFAULT_SHM_NAME = "/fwe-trace";
+
+struct Options
+{
+    std::string shmName{ DEFAULT_SHM_NAME };
+    double delaySeconds{ 1.0 };
+    uint32_t iterations{ 0 }; // 0 to run until interrupted
+    std::string filter;
+};
+
+void
+printUsage()
+{
+    std::printf( "usage: fwe-top [-s shm name] [-d delay seconds] [-n iterations] [filter]\n"
+                 "Shows the trace values AWS IoT FleetWise Edge exports to shared memory, with the change per second\n"
+                 "since the previous refresh. Only values whose name contains the filter are shown.\n"
+                 "  -s  name of the shared memory segment, default %s\n"
+                 "  -d  time between two refreshes, default 1\n"
+                 "  -n  number of refreshes, default 0 to run until interrupted\n",
+                 DEFAULT_SHM_NAME );
+}
+
+bool
+parseOptions( int argc, char *argv[], Options &options )
+{
+    int option = 0;
+    while ( ( option = getopt( argc, argv, "s:d:n:h" ) ) != -1 )
+    {
+        switch ( option )
+        {
+        case 's':
+            options.shmName = optarg;
+            break;
+        case 'd':
+            options.delaySeconds = std::strtod( optarg, nullptr );
+            if ( !( options.delaySeconds > 0.0 ) )
+            {
+                return false;
+            }
+            break;
+        case 'n':
+            options.iterations = static_cast<uint32_t>( std::strtoul( optarg, nullptr, 10 ) );
+            break;
+        default:
+            return false;
+        }
+    }
+    if ( optind < argc )
+    {
+        options.filter = argv[optind];
+    }
+    return true;
+}
+
+void
+printTable( const fwe_shm_trace_header &header,
+            const std::vector<fwe_shm_trace_entry> &entries,
+            const std::map<std::string, double> &rates,
+            const Options &options,
+            bool clearScreen )
+{
+    if ( clearScreen )
+    {
+        std::printf( "\033[H\033[2J" );
+    }
+    std::printf( "fwe-top  %s  pid %d  update %llu every %u ms  %u values  %u dropped\n\n",
+                 options.shmName.c_str(),
+                 header.pid,
+                 static_cast<unsigned long long>( header.update_count ),
+                 header.update_interval_ms,
+                 header.entry_count,
+                 header.dropped_count );
+    std::printf( "%-72s %18s %16s  %s\n", "NAME", "VALUE", "RATE/s", "UNIT" );
+    for ( uint32_t i = 0; i < header.entry_count; i++ )
+    {
+        const auto &entry = entries[i];
+        std::string name = entry.name;
+        if ( ( !options.filter.empty() ) && ( name.find( options.filter ) == std::string::npos ) )
+        {
+            continue;
+        }
+        auto rate = rates.find( name );
+        if ( rate != rates.end() )
+        {
+            std::printf( "%-72s %18.0f %16.1f  %s\n", entry.name, entry.value, rate->second, entry.unit );
+        }
+        else
+        {
+            std::printf( "%-72s %18.0f %16s  %s\n", entry.name, entry.value, "", entry.unit );
+        }
+    }
+    std::fflush( stdout );
+}
+} // namespace
+
+int
+main( int argc, char *argv[] )
+{
+    Options options;
+    if ( !parseOptions( argc, argv, options ) )
+    {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+    const auto *segment = fwe_shm_trace_open( options.shmName.c_str() );
+    if ( segment == nullptr )
+    {
+        std::fprintf( stderr,
+                      "Failed to open %s, is traceSharedMemoryName configured and the device software running?\n",
+                      options.shmName.c_str() );
+        return EXIT_FAILURE;
+    }
+    bool clearScreen = ( isatty( STDOUT_FILENO ) != 0 ) && ( options.iterations != 1U );
+    std::vector<fwe_shm_trace_entry> entries( segment->capacity );
+    std::map<std::string, double> previousValues;
+    std::map<std::string, double> rates;
+    uint64_t previousUpdateCount = 0;
+    uint64_t previousUpdateTimeMs = 0;
+    for ( uint32_t iteration = 0; ( options.iterations == 0U ) || ( iteration < options.iterations ); iteration++ )
+    {
+        if ( iteration > 0U )
+        {
+            std::this_thread::sleep_for( std::chrono::duration<double>( options.delaySeconds ) );
+        }
+        fwe_shm_trace_header header{};
+        if ( fwe_shm_trace_read( segment, entries.data(), &header ) < 0 )
+        {
+            continue;
+        }
+        // The rates are computed over the time between two updates of the device software, so they do not depend
+        // on the refresh delay
+        if ( header.update_count != previousUpdateCount )
+        {
+            double elapsedSeconds = ( header.update_time_ms > previousUpdateTimeMs )
+                                        ? static_cast<double>( header.update_time_ms - previousUpdateTimeMs ) / 1000.0
+                                        : 0.0;
+            rates.clear();
+            for ( uint32_t i = 0; i < header.entry_count; i++ )
+            {
+                auto previous = previousValues.find( entries[i].name );
+                if ( ( previous != previousValues.end() ) && ( elapsedSeconds > 0.0 ) )
+                {
+                    rates[entries[i].name] = ( entries[i].value - previous->second ) / elapsedSeconds;
+                }
+            }
+            previousValues.clear();
+            for ( uint32_t i = 0; i < header.entry_count; i++ )
+            {
+                previousValues[entries[i].name] = entries[i].value;
+            }
+            previousUpdateCount = header.update_count;
+            previousUpdateTimeMs = header.update_time_ms;
+        }
+        printTable( header, entries, rates, options, clearScreen );
+    }
+    fwe_shm_trace_close( segment );
+    return EXIT_SUCCESS;
+}
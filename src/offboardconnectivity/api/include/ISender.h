@@ -14,6 +14,9 @@
 #pragma once
 
 #include "IConnectionTypes.h"
+#include "PayloadBufferPool.h"
+#include <functional>
+#include <vector>
 
 namespace Aws
 {
@@ -31,8 +34,26 @@ struct CollectionSchemeParams
     bool persist{ false };     // specifies if data needs to be persisted in case of connection loss
     bool compression{ false }; // specifies if data needs to be compressed for cloud
     uint32_t priority{ 0 };    // collectionScheme priority specified by the cloud
+    uint32_t traceId{ 0 };     // LatencyTracer trace of a signal in the data, 0 if none of them is traced
+    uint32_t accountId{ 0 };   // UplinkAccounting account of the collectionScheme, 0 for unattributed traffic
+    bool express{ false };     // published right away with the SDK memory reserved for the express collectionSchemes
 };
 
+/**
+ * @brief One payload of a batch, sent as the concatenation of its segments, for example a header and a body
+ */
+struct SendBatchItem
+{
+    std::vector<PayloadBufferPtr> segments; // the caller must not modify the buffers after the call
+    CollectionSchemeParams collectionSchemeParams;
+};
+
+/**
+ * @brief Called once when all payloads of a batch were handed over to the lower layers or failed
+ * @param publishedItems number of payloads of the batch which were handed over
+ */
+using SendBatchCallback = std::function<void( size_t publishedItems )>;
+
 /**
  * @brief This interface will be used by all objects sending data to the cloud
  *
@@ -80,6 +101,124 @@ public:
         const std::uint8_t *buf,
         size_t size,
         struct CollectionSchemeParams collectionSchemeParams = CollectionSchemeParams() ) = 0;
+
+    /**
+     * @brief called to send data to the cloud, taking a reference to the buffer instead of copying it
+     *
+     * Same as send() but the buffer is kept alive by the sender until the data was handed over to the lower
+     * layers, so that implementations can avoid copying it. The caller must not modify the buffer after the call.
+     * The default implementation calls send().
+     *
+     * @param buffer data to send, must not be empty
+     * @param collectionSchemeParams object containing collectionScheme related metadata for data persistency and
+     * transmission
+     *
+     * @return SUCCESS if connection is established.
+     */
+    virtual ConnectivityError
+    sendBuffer( PayloadBufferPtr buffer,
+                struct CollectionSchemeParams collectionSchemeParams = CollectionSchemeParams() )
+    {
+        if ( buffer == nullptr )
+        {
+            return ConnectivityError::WrongInputData;
+        }
+        return send( buffer->data(), buffer->size(), collectionSchemeParams );
+    }
+
+    /**
+     * @brief called to send several payloads to the cloud together, for example all payloads of one trigger
+     *
+     * The segments of each item are sent as one payload, the items are sent in order. Implementations can check and
+     * reserve the resources for the whole batch at once, so that the payloads of a batch are either all sent or all
+     * persisted. The default implementation gathers the segments of each item and calls sendBuffer() for each of
+     * them, and calls onComplete before returning.
+     *
+     * @param items payloads to send, each with at least one non-empty segment
+     * @param onComplete optional, called once from any thread after all items completed, also if an error is returned
+     *
+     * @return SUCCESS if all items were accepted, else the error of the first item which was not
+     */
+    virtual ConnectivityError
+    sendBatch( const std::vector<SendBatchItem> &items, SendBatchCallback onComplete = SendBatchCallback() )
+    {
+        auto result = items.empty() ? ConnectivityError::WrongInputData : ConnectivityError::Success;
+        size_t publishedItems = 0;
+        for ( const auto &item : items )
+        {
+            auto buffer = gatherSegments( item.segments );
+            auto itemResult = ( buffer == nullptr ) ? ConnectivityError::WrongInputData
+                                                    : sendBuffer( std::move( buffer ), item.collectionSchemeParams );
+            if ( itemResult == ConnectivityError::Success )
+            {
+                publishedItems++;
+            }
+            else if ( result == ConnectivityError::Success )
+            {
+                result = itemResult;
+            }
+        }
+        if ( onComplete )
+        {
+            onComplete( publishedItems );
+        }
+        return result;
+    }
+
+    /**
+     * @brief called to store data for a later upload instead of sending it, for example while the connection is
+     * known to be down
+     *
+     * All buffers are stored with a single write and are sent on their own once the connection is back. Nothing is
+     * published and no memory of the connection is reserved. The default implementation has no persistency.
+     *
+     * @param buffers data of one collectionScheme, must not be empty
+     * @param collectionSchemeParams object containing collectionScheme related metadata for data persistency and
+     * transmission
+     *
+     * @return SUCCESS if all buffers were stored, NotConfigured if the sender can not store data
+     */
+    virtual ConnectivityError
+    persistBuffers( const std::vector<PayloadBufferPtr> &buffers,
+                    struct CollectionSchemeParams collectionSchemeParams = CollectionSchemeParams() )
+    {
+        static_cast<void>( buffers );
+        static_cast<void>( collectionSchemeParams );
+        return ConnectivityError::NotConfigured;
+    }
+
+protected:
+    /**
+     * @brief Returns the only segment as it is, or a new buffer holding all segments
+     * @return nullptr if the segments are empty
+     */
+    static PayloadBufferPtr
+    gatherSegments( const std::vector<PayloadBufferPtr> &segments, PayloadBufferPool *pool = nullptr )
+    {
+        size_t size = 0;
+        for ( const auto &segment : segments )
+        {
+            size += ( segment != nullptr ) ? segment->size() : 0U;
+        }
+        if ( size == 0U )
+        {
+            return nullptr;
+        }
+        if ( ( segments.size() == 1U ) && ( segments.front() != nullptr ) )
+        {
+            return segments.front();
+        }
+        auto buffer = ( pool != nullptr ) ? pool->acquire() : std::make_shared<PayloadBuffer>();
+        buffer->reserve( size );
+        for ( const auto &segment : segments )
+        {
+            if ( segment != nullptr )
+            {
+                buffer->insert( buffer->end(), segment->begin(), segment->end() );
+            }
+        }
+        return buffer;
+    }
 };
 } // namespace OffboardConnectivity
 } // namespace IoTFleetWise
@@ -0,0 +1,107 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace OffboardConnectivity
+{
+
+using PayloadBuffer = std::vector<std::uint8_t>;
+using PayloadBufferPtr = std::shared_ptr<PayloadBuffer>;
+
+/**
+ * @brief Thread safe pool of payload buffers
+ *
+ * A buffer acquired from the pool goes back to the pool when its last reference is released, which can happen on
+ * any thread, for example in the publish completion callback of the MQTT client. Returned buffers keep their
+ * capacity, so that in steady state serializing, compressing and publishing a payload does not allocate. The pool
+ * state is shared with the buffers, so buffers can outlive the pool.
+ */
+class PayloadBufferPool
+{
+public:
+    static constexpr size_t DEFAULT_MAX_POOLED_BUFFERS = 4;
+
+    /**
+     * @param maxPooledBuffers buffers returned while this many are already pooled are freed
+     */
+    explicit PayloadBufferPool( size_t maxPooledBuffers = DEFAULT_MAX_POOLED_BUFFERS )
+        : mState( std::make_shared<State>() )
+    {
+        mState->mMaxPooledBuffers = maxPooledBuffers;
+    }
+
+    /**
+     * @brief Gets an empty buffer, reusing a pooled one if available
+     */
+    PayloadBufferPtr
+    acquire()
+    {
+        std::unique_ptr<PayloadBuffer> buffer;
+        {
+            std::lock_guard<std::mutex> lock( mState->mMutex );
+            if ( !mState->mBuffers.empty() )
+            {
+                buffer = std::move( mState->mBuffers.back() );
+                mState->mBuffers.pop_back();
+            }
+        }
+        if ( buffer == nullptr )
+        {
+            buffer.reset( new PayloadBuffer() );
+        }
+        buffer->clear();
+        auto state = mState;
+        return PayloadBufferPtr( buffer.release(), [state]( PayloadBuffer *released ) {
+            std::unique_ptr<PayloadBuffer> returned( released );
+            std::lock_guard<std::mutex> lock( state->mMutex );
+            if ( state->mBuffers.size() < state->mMaxPooledBuffers )
+            {
+                state->mBuffers.push_back( std::move( returned ) );
+            }
+        } );
+    }
+
+    /**
+     * @brief Number of buffers currently waiting in the pool to be reused
+     */
+    size_t
+    getPooledBufferCount() const
+    {
+        std::lock_guard<std::mutex> lock( mState->mMutex );
+        return mState->mBuffers.size();
+    }
+
+private:
+    struct State
+    {
+        std::mutex mMutex;
+        std::vector<std::unique_ptr<PayloadBuffer>> mBuffers;
+        size_t mMaxPooledBuffers{ 0 };
+    };
+    std::shared_ptr<State> mState;
+};
+
+} // namespace OffboardConnectivity
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -11,9 +11,11 @@
  * permissions and limitations under the License.
  */
 
+#include <array>
 #include <atomic>
 #include <aws/core/utils/memory/AWSMemory.h>
 #include <cstddef>
+#include <mutex>
 
 namespace Aws
 {
@@ -27,6 +29,12 @@ namespace OffboardConnectivityAwsIot
  * In this memory manager, we store the size of the requested memory at the beginning of the allocated block
  * and keep track of how much memory we are allocating and deallocating
  *
+ * Small blocks up to MAX_POOLED_BLOCK_SIZE including the size are taken from pools of power of two size classes, as
+ * the SDK allocates many short-lived small buffers per publish. Each thread caches a few free blocks per class, so most
+ * allocations and frees take no lock. The pools take memory from malloc in slabs, which are kept for reuse. Larger
+ * blocks are allocated with malloc. The accounting counts the requested size plus the size field in both cases.
+ * Per size class the allocations and the ones served from the thread cache are published as named trace variables.
+ *
  * NOTE: This allocator does not handle over-aligned types . See
  * https://en.cppreference.com/w/cpp/language/object#Alignment.
  * If you are using over-aligned types, do not use this allocator.
@@ -34,6 +42,11 @@ namespace OffboardConnectivityAwsIot
 class AwsSDKMemoryManager : public Aws::Utils::Memory::MemorySystemInterface
 {
 public:
+    static constexpr std::size_t MIN_POOLED_BLOCK_SIZE = 32;
+    static constexpr std::size_t MAX_POOLED_BLOCK_SIZE = 4096;
+    static constexpr std::size_t SIZE_CLASS_COUNT = 8;
+    static constexpr std::size_t SLAB_SIZE = 64 * 1024;
+
     static AwsSDKMemoryManager &getInstance();
 
     void Begin() override;
@@ -46,6 +59,7 @@ public:
 
     /**
      * @brief Reserve a chunk of memory for usage later
+     * The reservations of all MQTT connections are counted together, so a pool of connections shares one budget.
      *
      * @return std::size_t Memory size currently in use plus reserved
      */
@@ -64,6 +78,53 @@ public:
 private:
     AwsSDKMemoryManager() = default;
 
+    struct FreeBlock
+    {
+        FreeBlock *mNext;
+    };
+
+    /**
+     * @brief Free blocks shared by all threads. The slabs are linked through their first bytes, so they stay
+     *        reachable until the process ends
+     */
+    struct SizeClass
+    {
+        std::mutex mMutex;
+        FreeBlock *mFreeBlocks{ nullptr };
+        void *mSlabs{ nullptr };
+    };
+
+    struct ThreadCache;
+    struct ThreadCacheReleaser;
+
+    static std::size_t getSizeClass( std::size_t size );
+
+    void *allocateFromPool( std::size_t sizeClass );
+
+    void freeToPool( std::size_t sizeClass, void *block );
+
+    /**
+     * @brief Moves up to count blocks from the shared free blocks into the list, carving a new slab if there are none
+     * @return number of moved blocks
+     */
+    std::size_t takeBlocks( std::size_t sizeClass, FreeBlock *&list, std::size_t count );
+
+    /**
+     * @brief Moves count blocks from the list to the shared free blocks
+     */
+    void returnBlocks( std::size_t sizeClass, FreeBlock *&list, std::size_t count );
+
+    /**
+     * @brief Returns the blocks cached by the current thread to the shared free blocks on thread exit
+     */
+    void releaseThreadCache();
+
+    static void publishMetrics( ThreadCache &cache );
+
+    static ThreadCache &getThreadCache();
+
+    std::array<SizeClass, SIZE_CLASS_COUNT> mSizeClasses;
+
     /**
      * @brief Usage tracking in terms of how much memory is in use - allocated but not yet deallocated
      *
@@ -12,7 +12,13 @@
  */
 
 #include "AwsSDKMemoryManager.h"
+#include "MemoryAccounting.h"
+#include "TraceModule.h"
+#include <algorithm>
 #include <aws/core/utils/memory/AWSMemory.h>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
 
 namespace Aws
 {
@@ -21,6 +27,10 @@ namespace IoTFleetWise
 namespace OffboardConnectivityAwsIot
 {
 
+using Aws::IoTFleetWise::Platform::Linux::MemoryAccounting;
+using Aws::IoTFleetWise::Platform::Linux::MemorySubsystem;
+using Aws::IoTFleetWise::Platform::Linux::TraceModule;
+
 namespace
 {
 using Byte = unsigned char;
@@ -33,8 +43,57 @@ using Byte = unsigned char;
 // We are OK at the moment to not handled over-aligned types since we do not have any usage of "alignas"
 constexpr auto offset = alignof( std::max_align_t );
 
+// Bytes of blocks a thread takes from or returns to the shared free blocks of a size class at once
+constexpr std::size_t TRANSFER_BYTES = 16 * 1024;
+
+// Allocations of a thread after which it publishes its counts
+constexpr uint64_t METRICS_PUBLISH_INTERVAL = 1024;
+
+static_assert( ( AwsSDKMemoryManager::MIN_POOLED_BLOCK_SIZE << ( AwsSDKMemoryManager::SIZE_CLASS_COUNT - 1U ) ) ==
+                   AwsSDKMemoryManager::MAX_POOLED_BLOCK_SIZE,
+               "size classes must end at the maximum pooled block size" );
+static_assert( ( AwsSDKMemoryManager::MIN_POOLED_BLOCK_SIZE % offset ) == 0U, "blocks must keep the alignment" );
+
+std::size_t
+getBlockSize( std::size_t sizeClass )
+{
+    return AwsSDKMemoryManager::MIN_POOLED_BLOCK_SIZE << sizeClass;
+}
+
+std::size_t
+getTransferCount( std::size_t sizeClass )
+{
+    return std::max( TRANSFER_BYTES / getBlockSize( sizeClass ), static_cast<std::size_t>( 4 ) );
+}
+
 } // namespace
 
+/**
+ * @brief Free blocks and counts of one thread. Trivially destructible, so it can still be used while other thread
+ *        local objects are destroyed
+ */
+struct AwsSDKMemoryManager::ThreadCache
+{
+    struct Class
+    {
+        FreeBlock *mFreeBlocks;
+        std::size_t mCount;
+        uint64_t mAllocations;
+        uint64_t mHits;
+    };
+    std::array<Class, SIZE_CLASS_COUNT> mClasses;
+    uint64_t mUnpublishedAllocations;
+    bool mReleased; /**< The thread is exiting, blocks go directly to the shared free blocks */
+};
+
+struct AwsSDKMemoryManager::ThreadCacheReleaser
+{
+    ~ThreadCacheReleaser()
+    {
+        AwsSDKMemoryManager::getInstance().releaseThreadCache();
+    }
+};
+
 AwsSDKMemoryManager &
 AwsSDKMemoryManager::getInstance()
 {
@@ -63,7 +122,15 @@ AwsSDKMemoryManager::AllocateMemory( std::size_t blockSize, std::size_t alignmen
     static_assert( offset >= sizeof( std::size_t ), "too big memory size block" );
 
     auto realSize = blockSize + offset;
-    void *pMem = malloc( realSize ); // NOLINT(cppcoreguidelines-no-malloc)
+    void *pMem = nullptr;
+    if ( realSize <= MAX_POOLED_BLOCK_SIZE )
+    {
+        pMem = allocateFromPool( getSizeClass( realSize ) );
+    }
+    else
+    {
+        pMem = malloc( realSize ); // NOLINT(cppcoreguidelines-no-malloc)
+    }
 
     if ( pMem == nullptr )
     {
@@ -73,6 +140,7 @@ AwsSDKMemoryManager::AllocateMemory( std::size_t blockSize, std::size_t alignmen
     // store the allocated memory's size
     *( static_cast<std::size_t *>( pMem ) ) = realSize;
     mMemoryUsedAndReserved += realSize;
+    MemoryAccounting::onAllocate( MemorySubsystem::CONNECTIVITY, realSize );
 
     // return a pointer to the block offset from the size storage location
     return static_cast<Byte *>( pMem ) + offset;
@@ -92,10 +160,18 @@ AwsSDKMemoryManager::FreeMemory( void *memoryPtr )
     auto realSize = *( static_cast<std::size_t *>( pMem ) );
 
     // free the memory
-    free( pMem ); // NOLINT(cppcoreguidelines-no-malloc)
+    if ( realSize <= MAX_POOLED_BLOCK_SIZE )
+    {
+        freeToPool( getSizeClass( realSize ), pMem );
+    }
+    else
+    {
+        free( pMem ); // NOLINT(cppcoreguidelines-no-malloc)
+    }
 
     // update the stats
     mMemoryUsedAndReserved -= realSize;
+    MemoryAccounting::onDeallocate( MemorySubsystem::CONNECTIVITY, realSize );
 }
 
 std::size_t
@@ -112,6 +188,179 @@ AwsSDKMemoryManager::releaseReservedMemory( std::size_t bytes )
     return mMemoryUsedAndReserved;
 }
 
+std::size_t
+AwsSDKMemoryManager::getSizeClass( std::size_t size )
+{
+    std::size_t sizeClass = 0;
+    while ( getBlockSize( sizeClass ) < size )
+    {
+        sizeClass++;
+    }
+    return sizeClass;
+}
+
+AwsSDKMemoryManager::ThreadCache &
+AwsSDKMemoryManager::getThreadCache()
+{
+    thread_local ThreadCache cache{};
+    // Returns the cached blocks when the thread exits
+    thread_local ThreadCacheReleaser releaser;
+    (void)releaser;
+    return cache;
+}
+
+void *
+AwsSDKMemoryManager::allocateFromPool( std::size_t sizeClass )
+{
+    auto &cache = getThreadCache();
+    if ( cache.mReleased )
+    {
+        FreeBlock *block = nullptr;
+        takeBlocks( sizeClass, block, 1 );
+        return block;
+    }
+    auto &cacheClass = cache.mClasses[sizeClass];
+    cacheClass.mAllocations++;
+    if ( cacheClass.mFreeBlocks == nullptr )
+    {
+        cacheClass.mCount += takeBlocks( sizeClass, cacheClass.mFreeBlocks, getTransferCount( sizeClass ) );
+        if ( cacheClass.mFreeBlocks == nullptr )
+        {
+            return nullptr;
+        }
+    }
+    else
+    {
+        cacheClass.mHits++;
+    }
+    auto *block = cacheClass.mFreeBlocks;
+    cacheClass.mFreeBlocks = block->mNext;
+    cacheClass.mCount--;
+
+    cache.mUnpublishedAllocations++;
+    if ( cache.mUnpublishedAllocations >= METRICS_PUBLISH_INTERVAL )
+    {
+        publishMetrics( cache );
+    }
+    return block;
+}
+
+void
+AwsSDKMemoryManager::freeToPool( std::size_t sizeClass, void *block )
+{
+    auto *freeBlock = static_cast<FreeBlock *>( block );
+    auto &cache = getThreadCache();
+    if ( cache.mReleased )
+    {
+        freeBlock->mNext = nullptr;
+        returnBlocks( sizeClass, freeBlock, 1 );
+        return;
+    }
+    auto &cacheClass = cache.mClasses[sizeClass];
+    freeBlock->mNext = cacheClass.mFreeBlocks;
+    cacheClass.mFreeBlocks = freeBlock;
+    cacheClass.mCount++;
+    // Blocks allocated by one thread and freed by another flow back through the shared free blocks
+    auto transferCount = getTransferCount( sizeClass );
+    if ( cacheClass.mCount > ( 2 * transferCount ) )
+    {
+        returnBlocks( sizeClass, cacheClass.mFreeBlocks, transferCount );
+        cacheClass.mCount -= transferCount;
+    }
+}
+
+std::size_t
+AwsSDKMemoryManager::takeBlocks( std::size_t sizeClass, FreeBlock *&list, std::size_t count )
+{
+    auto &shared = mSizeClasses[sizeClass];
+    std::lock_guard<std::mutex> lock( shared.mMutex );
+    if ( shared.mFreeBlocks == nullptr )
+    {
+        // The first bytes link the slabs, the blocks follow with the same alignment
+        void *slab = malloc( offset + SLAB_SIZE ); // NOLINT(cppcoreguidelines-no-malloc)
+        if ( slab == nullptr )
+        {
+            return 0;
+        }
+        *( static_cast<void **>( slab ) ) = shared.mSlabs;
+        shared.mSlabs = slab;
+        auto blockSize = getBlockSize( sizeClass );
+        for ( auto i = SLAB_SIZE / blockSize; i > 0U; i-- )
+        {
+            auto *block =
+                reinterpret_cast<FreeBlock *>( static_cast<Byte *>( slab ) + offset + ( ( i - 1U ) * blockSize ) );
+            block->mNext = shared.mFreeBlocks;
+            shared.mFreeBlocks = block;
+        }
+    }
+    std::size_t taken = 0;
+    while ( ( taken < count ) && ( shared.mFreeBlocks != nullptr ) )
+    {
+        auto *block = shared.mFreeBlocks;
+        shared.mFreeBlocks = block->mNext;
+        block->mNext = list;
+        list = block;
+        taken++;
+    }
+    return taken;
+}
+
+void
+AwsSDKMemoryManager::returnBlocks( std::size_t sizeClass, FreeBlock *&list, std::size_t count )
+{
+    if ( ( list == nullptr ) || ( count == 0U ) )
+    {
+        return;
+    }
+    // Split off the first blocks without the lock
+    auto *first = list;
+    auto *last = first;
+    for ( std::size_t moved = 1; ( moved < count ) && ( last->mNext != nullptr ); moved++ )
+    {
+        last = last->mNext;
+    }
+    list = last->mNext;
+
+    auto &shared = mSizeClasses[sizeClass];
+    std::lock_guard<std::mutex> lock( shared.mMutex );
+    last->mNext = shared.mFreeBlocks;
+    shared.mFreeBlocks = first;
+}
+
+void
+AwsSDKMemoryManager::releaseThreadCache()
+{
+    auto &cache = getThreadCache();
+    publishMetrics( cache );
+    for ( std::size_t sizeClass = 0; sizeClass < SIZE_CLASS_COUNT; sizeClass++ )
+    {
+        auto &cacheClass = cache.mClasses[sizeClass];
+        returnBlocks( sizeClass, cacheClass.mFreeBlocks, cacheClass.mCount );
+        cacheClass.mCount = 0;
+    }
+    cache.mReleased = true;
+}
+
+void
+AwsSDKMemoryManager::publishMetrics( ThreadCache &cache )
+{
+    for ( std::size_t sizeClass = 0; sizeClass < SIZE_CLASS_COUNT; sizeClass++ )
+    {
+        auto &cacheClass = cache.mClasses[sizeClass];
+        if ( cacheClass.mAllocations == 0U )
+        {
+            continue;
+        }
+        // The hit rate of a class is the hits divided by the allocations
+        auto name = "sdkMemoryPool_" + std::to_string( getBlockSize( sizeClass ) ) + "B_";
+        TraceModule::get().addToNamedVariable( name + "allocations", static_cast<int64_t>( cacheClass.mAllocations ) );
+        TraceModule::get().addToNamedVariable( name + "hits", static_cast<int64_t>( cacheClass.mHits ) );
+        cacheClass.mAllocations = 0;
+        cacheClass.mHits = 0;
+    }
+    cache.mUnpublishedAllocations = 0;
+}
+
 } // namespace OffboardConnectivityAwsIot
 } // namespace IoTFleetWise
 } // namespace Aws
\ No newline at end of file
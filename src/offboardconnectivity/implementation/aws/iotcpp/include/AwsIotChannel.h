@@ -18,8 +18,10 @@
 #include "ISender.h"
 #include "LoggingModule.h"
 #include "PayloadManager.h"
+#include "UploadShaper.h"
 #include <atomic>
 #include <aws/crt/Api.h>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -122,6 +124,72 @@ public:
                             size_t size,
                             struct CollectionSchemeParams collectionSchemeParams = CollectionSchemeParams() ) override;
 
+    /**
+     * @brief Publishes the buffer without copying it, the buffer is released in the publish completion callback
+     */
+    ConnectivityError sendBuffer( PayloadBufferPtr buffer,
+                                  struct CollectionSchemeParams collectionSchemeParams = CollectionSchemeParams() )
+        override;
+
+    /**
+     * @brief Stores the buffers with the payload manager as one record, without trying to publish them
+     */
+    ConnectivityError persistBuffers( const std::vector<PayloadBufferPtr> &buffers,
+                                      struct CollectionSchemeParams collectionSchemeParams = CollectionSchemeParams() )
+        override;
+
+    /**
+     * @brief Publishes the items of the batch back to back
+     *
+     * The memory of the whole batch is reserved before the first publish and checked once against the limit of its
+     * most important item, then the publishes are handed to the SDK without waiting for each other. If the memory is
+     * not available or there is no connection, all items are persisted if their collection scheme requests it. Items
+     * which are shaped by the upload shaper are published through it one by one. The segments of an item with more
+     * than one segment are copied into one payload.
+     */
+    ConnectivityError sendBatch( const std::vector<SendBatchItem> &items,
+                                 SendBatchCallback onComplete = SendBatchCallback() ) override;
+
+    /**
+     * @brief Keeps the SDK memory above a limit for the important payloads
+     *
+     * While the memory used by the SDK exceeds limitBytes, payloads with a priority number above maxPriority are
+     * rejected with QuotaReached and persisted if their collection scheme requests it, as if the SDK reached its
+     * maximum memory. More important payloads can still use the memory up to the maximum.
+     *
+     * @param maxPriority least important priority which may use the memory above the limit
+     * @param limitBytes memory the less important payloads may use, 0 to disable the limit
+     */
+    void setLowPriorityMemoryLimit( uint32_t maxPriority, std::size_t limitBytes );
+
+    /**
+     * @brief Reserves SDK memory for the payloads of the express collection schemes
+     *
+     * The other payloads may only use the maximum SDK memory minus the reserved bytes, so that an express payload
+     * does not wait for the memory to be released. Express payloads also bypass the upload shaper.
+     *
+     * @param reservedBytes memory only the express payloads may use, 0 to disable the reservation
+     */
+    void setExpressMemoryReservation( std::size_t reservedBytes );
+
+    /**
+     * @brief Publishes through the upload shaper, which is shared by the channels of one link
+     *
+     * Publishes the rate limits do not allow right away are queued in the shaper and done by its thread, the send
+     * functions do not block. If the queue of the shaper is full the payload is persisted if its collection scheme
+     * requests it and QuotaReached is returned. The shaper must be stopped before the channel is destroyed.
+     *
+     * @param uploadShaper shaper of the link
+     * @param topicLimit rate limit of the topic of this channel
+     */
+    void setUploadShaper( std::shared_ptr<UploadShaper> uploadShaper, const UploadRateLimit &topicLimit );
+
+    /**
+     * @brief Changes the rate limit of the topic of this channel at runtime
+     * @return False if the channel has no upload shaper
+     */
+    bool setUploadRateLimit( const UploadRateLimit &topicLimit );
+
     bool
     isTopicValid()
     {
@@ -145,6 +213,58 @@ public:
 private:
     bool isAliveNotThreadSafe();
 
+    /**
+     * @brief Publishes size bytes from buf. If buffer is set, buf points into it and the buffer is kept alive until
+     *        the publish completed, otherwise the data is copied.
+     */
+    /**
+     * @brief Called once the SDK completed a publish, with true if it was published
+     */
+    using PublishCompletion = std::function<void( bool published )>;
+
+    /**
+     * @brief Publishes size bytes from buf. If buffer is set, buf points into it and the buffer is kept alive until
+     *        the publish completed, otherwise the data is copied.
+     * @param onComplete if Success is returned it is called once the publish completed, otherwise it is not called
+     */
+    ConnectivityError publish( const std::uint8_t *buf,
+                               size_t size,
+                               PayloadBufferPtr buffer,
+                               const struct CollectionSchemeParams &collectionSchemeParams,
+                               bool scheduled = false,
+                               PublishCompletion onComplete = PublishCompletion() );
+
+    /**
+     * @brief Queues the publish in the upload shaper, must be called with mConnectivityMutex held
+     */
+    ConnectivityError schedulePublishNotThreadSafe( const std::uint8_t *buf,
+                                                    size_t size,
+                                                    PayloadBufferPtr buffer,
+                                                    const struct CollectionSchemeParams &collectionSchemeParams,
+                                                    PublishCompletion onComplete );
+
+    /**
+     * @brief SDK memory the payload may use, 0 for no limit
+     */
+    std::size_t getMemoryLimitNotThreadSafe( const struct CollectionSchemeParams &collectionSchemeParams ) const;
+
+    /**
+     * @brief Hands the publish to the SDK, size bytes of memory must be reserved by the caller. If the SDK does not
+     *        accept the publish the memory is released and the in-flight window completed.
+     */
+    ConnectivityError publishReservedNotThreadSafe( const std::uint8_t *buf,
+                                                    size_t size,
+                                                    PayloadBufferPtr buffer,
+                                                    const struct CollectionSchemeParams &collectionSchemeParams,
+                                                    std::shared_ptr<UploadShaper> inFlightWindow,
+                                                    PublishCompletion onComplete );
+
+    /**
+     * @brief Persists the payloads of the batch whose collection scheme requests it
+     */
+    void persistBatchNotThreadSafe( const std::vector<SendBatchItem> &items,
+                                    const std::vector<PayloadBufferPtr> &payloads );
+
     /** See "Message size" : "The payload for every publish request can be no larger
      * than 128 KB. AWS IoT Core rejects publish and connect requests larger than this size."
      * https://docs.aws.amazon.com/general/latest/gr/iot-core.html#limits_iot
@@ -152,10 +272,19 @@ private:
     static const size_t AWS_IOT_MAX_MESSAGE_SIZE = 131072; // = 128 KiB
     std::size_t mMaximumIotSDKHeapMemoryBytes; /**< If the iot device sdk heap memory usage from all channels exceeds
                                                this threshold this channel stops publishing data*/
+    uint32_t mLowPriorityMemoryMaxPriority{ 0 };
+    std::size_t mLowPriorityMemoryLimitBytes{ 0 }; /**< Lower threshold for payloads less important than
+                                                      mLowPriorityMemoryMaxPriority, 0 if disabled */
+    std::size_t mExpressReservedMemoryBytes{ 0 }; /**< Part of mMaximumIotSDKHeapMemoryBytes only the express
+                                                     payloads may use */
     IConnectivityModule *mConnectivityModule;
     std::mutex mConnectivityMutex;
     std::mutex mConnectivityLambdaMutex;
     std::shared_ptr<PayloadManager> mPayloadManager;
+    std::shared_ptr<UploadShaper> mUploadShaper;
+    size_t mUploadShaperTopic{ 0 };
+    // Copies of payloads passed to send() while they are queued in the upload shaper, and gathered batch items
+    PayloadBufferPool mPayloadBufferPool;
     std::string mTopicName;
     std::atomic<bool> mSubscribed;
     Aws::IoTFleetWise::Platform::Linux::LoggingModule mLogger;
@@ -15,11 +15,14 @@
 
 // Includes
 #include "AwsIotChannel.h"
+#include "AwsIotSharedClient.h"
 #include "Listener.h"
 #include "LoggingModule.h"
 #include "RetryThread.h"
+#include "TimeTypes.h"
 #include <atomic>
 #include <future>
+#include <mutex>
 #include <string>
 
 #include <aws/crt/Api.h>
@@ -34,6 +37,21 @@ namespace OffboardConnectivityAwsIot
 {
 using namespace Aws::IoTFleetWise::Platform::Linux;
 
+/**
+ * @brief Settings for keeping the MQTT connection over an unstable link and for getting it back quickly
+ */
+struct MqttReconnectConfig
+{
+    // Backoff of the reconnects the SDK does after the connection was interrupted, doubled after every failure
+    uint32_t minBackoffSeconds{ 1 };
+    uint32_t maxBackoffSeconds{ 128 };
+    // Idle time after which an MQTT PING is sent
+    uint16_t keepAliveSeconds{ 60 };
+    // Time without PING response after which the connection is considered interrupted. A longer timeout lets the TCP
+    // and TLS session survive short coverage gaps, so no new handshake is needed when the coverage comes back.
+    uint32_t pingTimeoutMs{ 3000 };
+};
+
 /**
  * @brief bootstrap of the Aws Iot SDK. Only one object of this should normally exist
  * */
@@ -127,11 +145,34 @@ public:
         const std::shared_ptr<PayloadManager> &payloadManager,
         std::size_t maximumIotSDKHeapMemoryBytes = AwsIotChannel::MAXIMUM_IOT_SDK_HEAP_MEMORY_BYTES );
 
+    /**
+     * @brief Creates the connection from a client shared with other modules instead of an own client and TLS
+     * context. Has to be called before connect, the private key, certificate and endpoint passed to connect are
+     * then ignored and only the client ID is used.
+     * @param sharedClient initialized shared client, nullptr to use an own client
+     */
+    void setSharedClient( std::shared_ptr<AwsIotSharedClient> sharedClient );
+
+    /**
+     * @brief Sets the reconnect backoff and the keep alive of the connection. Must be called before connect
+     */
+    void setReconnectConfig( const MqttReconnectConfig &config );
+
+    /**
+     * @brief Reconnects right away if the connection is interrupted, instead of waiting for the next reconnect of the
+     * SDK, which can be up to maxBackoffSeconds away. Typically called when the link of the modem comes up again.
+     * @return true if a reconnect was started
+     */
+    bool onLinkUp();
+
 private:
     bool createMqttConnection( Aws::Crt::Io::ClientBootstrap *clientBootstrap );
+    bool setReconnectTimeout();
     void setupCallbacks();
     static void renameEventLoopTask();
     bool resetConnection();
+    // Records the time since the connection was interrupted, if it was
+    void recordReconnect();
 
     Aws::Crt::ByteCursor mCertificate{ 0, nullptr };
     Aws::Crt::String mEndpointUrl;
@@ -140,6 +181,7 @@ private:
     Platform::Linux::LoggingModule mLogger;
     std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> mConnection;
     std::unique_ptr<Aws::Iot::MqttClient> mMqttClient;
+    std::shared_ptr<AwsIotSharedClient> mSharedClient;
     RetryThread mRetryThread;
 
     std::promise<bool> mConnectionCompletedPromise;
@@ -147,6 +189,12 @@ private:
     std::atomic<bool> mConnected;
     std::atomic<bool> mConnectionEstablished;
 
+    MqttReconnectConfig mReconnectConfig;
+    // Monotonic time of the interruption, 0 while not interrupted
+    std::atomic<Timestamp> mInterruptedTimeMs{ 0 };
+    // Prevents a reconnect on link up concurrent to a disconnect
+    std::mutex mReconnectMutex;
+
     std::vector<std::shared_ptr<AwsIotChannel>> mChannels;
 };
 } // namespace OffboardConnectivityAwsIot
@@ -0,0 +1,78 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "LoggingModule.h"
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <aws/crt/Api.h>
+
+#include <aws/iot/MqttClient.h>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace OffboardConnectivityAwsIot
+{
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+/**
+ * @brief MQTT client and connection config shared by multiple AwsIotConnectivityModule objects that use the same
+ * credentials and endpoint, for example to simulate many vehicles in one process. The TLS context holding the
+ * parsed certificate and private key is created only once, every module then only owns its MQTT connection,
+ * which is identified by the client ID passed to AwsIotConnectivityModule::connect.
+ */
+class AwsIotSharedClient
+{
+public:
+    AwsIotSharedClient() = default;
+    ~AwsIotSharedClient() = default;
+
+    AwsIotSharedClient( const AwsIotSharedClient & ) = delete;
+    AwsIotSharedClient &operator=( const AwsIotSharedClient & ) = delete;
+    AwsIotSharedClient( AwsIotSharedClient && ) = delete;
+    AwsIotSharedClient &operator=( AwsIotSharedClient && ) = delete;
+
+    /**
+     * @brief Builds the connection config including the TLS context and creates the MQTT client
+     * @param privateKey content of the private key .pem file
+     * @param certificate content of the certificate file
+     * @param endpointUrl the AWS IoT endpoint
+     * @param clientBootstrap AWS client bootstrap, its event loop is shared by all connections
+     * @return True if the client can create connections
+     */
+    bool init( const std::string &privateKey,
+               const std::string &certificate,
+               const std::string &endpointUrl,
+               Aws::Crt::Io::ClientBootstrap *clientBootstrap );
+
+    /**
+     * @brief Creates a new connection using the shared TLS context and client. Thread safe.
+     * @return the connection, nullptr if the client is not initialized or the creation failed
+     */
+    std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> newConnection();
+
+private:
+    std::mutex mMutex;
+    std::unique_ptr<Aws::Iot::MqttClientConnectionConfig> mClientConfig;
+    std::unique_ptr<Aws::Iot::MqttClient> mMqttClient;
+    Platform::Linux::LoggingModule mLogger;
+};
+} // namespace OffboardConnectivityAwsIot
+} // namespace IoTFleetWise
+} // namespace Aws
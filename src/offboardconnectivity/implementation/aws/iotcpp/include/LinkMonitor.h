@@ -0,0 +1,98 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "LoggingModule.h"
+#include "Thread.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace OffboardConnectivityAwsIot
+{
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+/**
+ * @brief Watches the state of a network interface, typically the one of the cellular modem, and reports when its
+ * link comes up
+ *
+ * The link state is taken from the netlink route messages of the kernel, so the event arrives as soon as the modem
+ * driver reports the carrier and not only when a ping or TCP retransmission of the MQTT connection times out. The
+ * interface is matched by name, as modem interfaces are often recreated with a new index.
+ */
+class LinkMonitor
+{
+public:
+    using LinkUpCallback = std::function<void()>;
+
+    // Time the thread waits for netlink messages before it checks whether it should stop
+    static constexpr uint32_t POLL_TIMEOUT_MS = 200;
+    static constexpr size_t RECEIVE_BUFFER_SIZE = 8192;
+
+    /**
+     * @param interfaceName name of the network interface, e.g. wwan0
+     * @param onLinkUp called from the thread of the monitor whenever the link changes from down to up
+     */
+    LinkMonitor( std::string interfaceName, LinkUpCallback onLinkUp );
+    ~LinkMonitor();
+
+    LinkMonitor( const LinkMonitor & ) = delete;
+    LinkMonitor &operator=( const LinkMonitor & ) = delete;
+    LinkMonitor( LinkMonitor && ) = delete;
+    LinkMonitor &operator=( LinkMonitor && ) = delete;
+
+    bool start();
+    bool stop();
+    bool isAlive();
+
+    /**
+     * @brief Handles the netlink messages of one receive, public for testing
+     * @param buffer messages as received from the NETLINK_ROUTE socket
+     * @param size number of bytes received
+     */
+    void handleMessages( const uint8_t *buffer, size_t size );
+
+    /**
+     * @return true if the last known state of the link is up
+     */
+    bool
+    isLinkUp() const
+    {
+        return mLinkUp;
+    }
+
+private:
+    static void doWork( void *data );
+    void updateLinkState( bool linkUp );
+
+    std::string mInterfaceName;
+    LinkUpCallback mOnLinkUp;
+    std::atomic<bool> mLinkUp{ false };
+    int mSocket{ -1 };
+    Thread mThread;
+    std::atomic<bool> mShouldStop{ false };
+    std::mutex mThreadMutex;
+    LoggingModule mLogger;
+};
+} // namespace OffboardConnectivityAwsIot
+} // namespace IoTFleetWise
+} // namespace Aws
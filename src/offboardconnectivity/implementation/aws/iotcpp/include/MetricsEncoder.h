@@ -0,0 +1,151 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "TimeTypes.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace OffboardConnectivity
+{
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+/**
+ * @brief Collects samples of metric series and encodes them in a compact binary format
+ *
+ * A series is identified by its name and gets a small ID when it is registered. Its name, unit and scale are only
+ * sent in the first payload after the registration, or again after resendDefinitions(). The values are stored as
+ * integers, value * scale rounded, and each sample is encoded as the difference to the previous sample of the series,
+ * so slowly changing series need only a few bytes per sample.
+ *
+ * Encoding, all integers are unsigned LEB128 varints, signed integers are zigzag encoded before:
+ * @code
+ * payload    := 'F' 'W' 'M' version:uint8 prefix:string baseTime:varint record*
+ * string     := length:varint byte*
+ * record     := 0x01 definition | 0x02 samples
+ * definition := seriesId:varint scale:varint name:string unit:string
+ * samples    := seriesId:varint count:varint ( timeDelta:varint valueDelta:zigzag )*count
+ * @endcode
+ * The time of the first sample of a series is relative to baseTime in ms, the following ones to the previous sample.
+ * The first value of a series is relative to 0. A definition always comes before the first samples of its series in
+ * the same payload or in an earlier one.
+ */
+class MetricsEncoder
+{
+public:
+    static constexpr uint8_t FORMAT_VERSION = 1;
+    static constexpr uint8_t RECORD_DEFINITION = 1;
+    static constexpr uint8_t RECORD_SAMPLES = 2;
+    static constexpr uint32_t DEFAULT_SCALE = 1000;
+    static constexpr size_t DEFAULT_MAX_SERIES = 1024;
+    static constexpr size_t DEFAULT_MAX_SAMPLES_PER_SERIES = 256;
+
+    /**
+     * @param maxSeries maximum number of registered series, samples of further series are dropped
+     * @param maxSamplesPerSeries samples of a series kept until the next encode, further samples are dropped
+     */
+    explicit MetricsEncoder( size_t maxSeries = DEFAULT_MAX_SERIES,
+                             size_t maxSamplesPerSeries = DEFAULT_MAX_SAMPLES_PER_SERIES );
+
+    /**
+     * @brief Limits the series that are registered automatically by addSample to names starting with one of the
+     * prefixes. An empty list registers all series.
+     */
+    void setSeriesPrefixes( std::vector<std::string> prefixes );
+
+    /**
+     * @brief Registers a series explicitly, also if it does not match the prefixes
+     * @param name name of the series
+     * @param unit unit of the values, e.g. Percent
+     * @param scale the values are encoded as value * scale rounded to an integer, at least 1
+     * @return False if the maximum number of series is reached
+     */
+    bool registerSeries( const std::string &name, const std::string &unit, uint32_t scale = DEFAULT_SCALE );
+
+    /**
+     * @brief Adds a sample, registering the series with the default scale if needed
+     * @return False if the sample is dropped because the series is not registered and does not match the prefixes,
+     * the maximum number of series is reached or the series has too many samples
+     */
+    bool addSample( const std::string &name, Timestamp time, double value, const std::string &unit );
+
+    /**
+     * @brief Encodes the pending definitions and samples into one payload, removing them from the encoder
+     * @param prefix prefix of the names of all series, e.g. to distinguish vehicles
+     * @param maxBytes the payload is not bigger than this. Series which do not fit stay pending for the next payload.
+     * @param payload the encoded payload
+     * @return True if definitions or samples are still pending
+     */
+    bool encode( const std::string &prefix, size_t maxBytes, std::vector<uint8_t> &payload );
+
+    /**
+     * @brief Sends the definitions of all series again with the next payload, e.g. after a payload was lost
+     */
+    void resendDefinitions();
+
+    size_t
+    getSeriesCount() const
+    {
+        return mSeries.size();
+    }
+
+    size_t
+    getPendingSampleCount() const
+    {
+        return mPendingSampleCount;
+    }
+
+    static void appendVarint( uint64_t value, std::vector<uint8_t> &buffer );
+    static void appendZigzag( int64_t value, std::vector<uint8_t> &buffer );
+    static void appendString( const std::string &value, std::vector<uint8_t> &buffer );
+
+private:
+    struct Sample
+    {
+        Timestamp time;
+        int64_t value;
+    };
+
+    struct Series
+    {
+        std::string name;
+        std::string unit;
+        uint32_t scale{ DEFAULT_SCALE };
+        bool definitionPending{ true };
+        std::vector<Sample> samples;
+    };
+
+    bool matchesPrefixes( const std::string &name ) const;
+    static int64_t scaleValue( double value, uint32_t scale );
+
+    size_t mMaxSeries;
+    size_t mMaxSamplesPerSeries;
+    std::vector<std::string> mPrefixes;
+    // Index is the series ID
+    std::vector<Series> mSeries;
+    std::unordered_map<std::string, uint32_t> mSeriesIds;
+    size_t mPendingSampleCount{ 0 };
+};
+
+} // namespace OffboardConnectivity
+} // namespace IoTFleetWise
+} // namespace Aws
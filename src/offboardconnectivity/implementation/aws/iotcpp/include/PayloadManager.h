@@ -17,10 +17,13 @@
 #include "CacheAndPersist.h"
 #include "ISender.h"
 #include "LoggingModule.h"
+#include <functional>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <snappy.h>
 #include <string>
+#include <vector>
 
 namespace Aws
 {
@@ -35,17 +38,58 @@ using namespace Aws::IoTFleetWise::OffboardConnectivity;
 using Aws::IoTFleetWise::OffboardConnectivity::CollectionSchemeParams;
 using namespace Aws::IoTFleetWise::Platform::Linux::PersistencyManagement;
 
+/**
+ * @brief Flags of a persisted payload in PayloadHeader::flags. Without flag the payload was compressed for storage
+ *        with snappy. The field was a bool telling if compression is required before, so payloads persisted by older
+ *        versions are read the same way.
+ */
+constexpr uint8_t PAYLOAD_COMPRESSION_REQUIRED = 0x01U; /**< Stored as sent, the collection scheme compresses */
+constexpr uint8_t PAYLOAD_STORED_UNCOMPRESSED = 0x02U;  /**< Stored uncompressed until it is compacted */
+constexpr uint8_t PAYLOAD_STORED_WITH_CODEC = 0x04U;    /**< Compressed for storage with the storage codec */
+
 #pragma pack( push, 1 )
 struct PayloadHeader
 {
-    bool compressionRequired{ false };
+    uint8_t flags{ 0 };
     size_t size{ 0 };
 };
 
 #pragma pack( pop )
 
+/**
+ * @brief Payloads retrieved from the persisted data by PayloadManager::retrieveNext, which also serves as the position
+ *        to continue from
+ */
+struct PersistedPayloadChunk
+{
+    std::vector<PayloadBufferPtr> payloads;
+    uint64_t segmentId{ 0 };       /**< Segment the payloads were read from, 0 to start from the first segment */
+    size_t endOffset{ 0 };         /**< Offset in the segment behind the record of the last payload */
+    uint32_t segmentPriority{ 0 }; /**< Priority of the segment in the index, to continue in the drain order */
+};
+
+/**
+ * @brief Order in which PayloadManager::retrieveNext drains the persisted payloads. The order applies to whole
+ *        segments of the persisted data, the payloads of a segment are always retrieved in the order they were stored.
+ */
+struct PersistedDataDrainPolicy
+{
+    bool priorityFirst{ true }; /**< Segments with the most important priority first */
+    bool newestFirst{ false };  /**< Segments of the same priority from the newest, else from the oldest */
+};
+
+/**
+ * @brief Compresses or uncompresses a persisted payload, see PayloadManager::setStorageCodec
+ * @return false if the payload could not be processed
+ */
+using PayloadCodecFunction = std::function<bool( const uint8_t *input, size_t size, std::vector<uint8_t> &out )>;
+
 /**
  * @brief Class that handles offline data storage/retrieval and data compression before transmission
+ *
+ * Payloads of collection schemes without compression are compressed for storage with snappy. With deferred
+ * compression they are stored uncompressed instead, so storing adds no latency, and compactSegment() compresses
+ * them later with the storage codec, e.g. from a background thread while the CPU is idle.
  */
 class PayloadManager
 {
@@ -65,35 +109,173 @@ public:
      */
     bool storeData( const std::uint8_t *buf, size_t size, const struct CollectionSchemeParams &collectionSchemeParams );
 
+    /**
+     * @brief Stores the payloads of one trigger with a single write, as one record holding all of them. Payloads of
+     *        collection schemes without compression are compressed for storage like with storeData.
+     *
+     * @param payloads  serialized payloads, each of them is sent on its own once retrieved
+     * @param collectionSchemeParams object containing collectionScheme related metadata for data persistency and
+     * transmission, the same for all payloads
+     *
+     * @return true if all payloads were persisted, else false and none of them is persisted
+     */
+    bool storeBatch( const std::vector<PayloadBufferPtr> &payloads,
+                     const struct CollectionSchemeParams &collectionSchemeParams );
+
     /**
      * @brief Parses the retrieved data from the storage. Separates metadata from the actual payload.
      *
+     * Each payload is stored in a buffer of a pool, which can be handed over to ISender::sendBuffer without copying.
+     * All persisted payloads are loaded at once, prefer retrieveNext() to limit the memory used.
+     *
      * @param data  vector to store parsed payloads
      *
      * @return SUCCESS if true, EMPTY if no data to retrieve, FILESYSTEM_ERROR if other errors
      */
-    ErrorCode retrieveData( std::vector<std::string> &data );
+    ErrorCode retrieveData( std::vector<PayloadBufferPtr> &data );
+
+    /**
+     * @brief Retrieves the next persisted payloads, so that the memory needed does not depend on the amount of
+     *        persisted data
+     *
+     * Reads the payloads behind the given chunk in the order of the drain policy, or from the first data not
+     * acknowledged yet for a default constructed chunk. The payloads of the chunk are replaced. At least one record
+     * is read, further ones as long as the payloads fit into maxBytes. A record with payloads which can not be
+     * uncompressed is skipped. The payloads are read from a mapped segment into buffers of a pool, which can be
+     * handed over to ISender::sendBuffer without copying. Nothing is deleted before acknowledge() is called.
+     *
+     * @param chunk     position to continue from, updated with the retrieved payloads and their position
+     * @param maxBytes  maximum size of the payloads, unless a single payload is larger
+     *
+     * @return SUCCESS if payloads were retrieved, EMPTY if there are no more payloads, INVALID_DATA if a record failed
+     *         its checksum so the rest of the segment should be acknowledged to skip it, FILESYSTEM_ERROR if other
+     *         errors
+     */
+    ErrorCode retrieveNext( PersistedPayloadChunk &chunk, size_t maxBytes );
+
+    /**
+     * @brief Frees the payloads of the chunk and all persisted payloads before them in the same segment from disk,
+     *        call once they were published
+     *
+     * @return SUCCESS, EMPTY if the data was already freed, FILESYSTEM_ERROR if other errors
+     */
+    ErrorCode acknowledge( const PersistedPayloadChunk &chunk );
+
+    /**
+     * @brief Sets the order in which retrieveNext drains the persisted payloads. By default the segments with the
+     *        most important priority are drained first, and segments of the same priority from the oldest.
+     */
+    void
+    setDrainPolicy( const PersistedDataDrainPolicy &policy )
+    {
+        mDrainPolicy = policy;
+    }
+
+    /**
+     * @brief Stores the payloads of collection schemes without compression uncompressed, until they are compressed
+     *        by compactSegment(). Must be called before data is stored.
+     */
+    void
+    setDeferredCompression( bool deferred )
+    {
+        mDeferredCompression = deferred;
+    }
+
+    /**
+     * @brief Sets a stronger codec than snappy to compress the payloads for storage in compactSegment(). Must be
+     *        called before data is retrieved or compacted.
+     *
+     * @param compress      called by compactSegment(), its output must tell the codec for decompress
+     * @param decompress    called by retrieveNext() for the payloads compressed by compress. Has to be set as long as
+     *                      such payloads are persisted, also if compaction is no longer used
+     */
+    void
+    setStorageCodec( PayloadCodecFunction compress, PayloadCodecFunction decompress )
+    {
+        mStorageCompress = std::move( compress );
+        mStorageDecompress = std::move( decompress );
+    }
+
+    /**
+     * @brief Compresses the payloads of a segment which were stored uncompressed, with the storage codec if set and
+     *        otherwise with snappy. With a storage codec payloads compressed with snappy are recompressed. The
+     *        segment of the last retrieved chunk is not compacted, as the chunk position would no longer be valid.
+     *
+     * @param segmentId     segment of the collected data, see CacheAndPersist::getCollectedDataSegments
+     * @param savedBytes    set to the number of bytes the segment became smaller
+     *
+     * @return SUCCESS, also if nothing was compressed, EMPTY if the segment can not be compacted now, because it
+     *         does not exist, is still written to, was partly uploaded or is being retrieved, INVALID_DATA if it is
+     *         corrupted, FILESYSTEM_ERROR on I/O errors
+     */
+    ErrorCode compactSegment( uint64_t segmentId, size_t &savedBytes );
 
 private:
     Aws::IoTFleetWise::Platform::Linux::LoggingModule mLogger;
     std::shared_ptr<CacheAndPersist> mPersistencyPtr;
+    PayloadBufferPool mPayloadBufferPool;
+    PersistedDataDrainPolicy mDrainPolicy;
+    bool mDeferredCompression{ false };
+    PayloadCodecFunction mStorageCompress;
+    PayloadCodecFunction mStorageDecompress;
+    // Serializes the retrieval with the compaction, which changes the offsets in the segment
+    std::mutex mCompactionMutex;
+    // Segment of the last chunk returned by retrieveNext, which must not be compacted
+    uint64_t mRetrievedSegmentId{ 0 };
+
+    /**
+     * @brief Returns true if the segment with the given priority and ID is drained before the other one
+     */
+    bool drainsBefore( uint32_t priority, uint64_t segmentId, uint32_t otherPriority, uint64_t otherSegmentId ) const;
 
     /**
      * @brief Prepare the payload data to be written to storage. Adds a header with metadata consisting
-     *        of compression flag and size of the payload.
+     *        of the payload flags and size of the payload in front of the data already stored in buf.
      *
-     * @param buf  buffer to store encoded payload
-     * @param data proto data to be stored
+     * @param buf  buffer to store encoded payload, with the data stored behind the space for the header
      * @param size size of the buffer being passed
-     * @param collectionSchemeParams object containing collectionScheme related metadata for data persistency and
-     * transmission
+     * @param dataSize size of the data stored behind the header
+     * @param flags how the payload is stored, e.g. PAYLOAD_COMPRESSION_REQUIRED
      *
      * @return true if prep was successful, false if error occurred
      */
-    bool preparePayload( uint8_t *const buf,
-                         size_t size,
-                         const std::string &data,
-                         const struct CollectionSchemeParams &collectionSchemeParams );
+    bool preparePayload( uint8_t *const buf, size_t size, size_t dataSize, uint8_t flags );
+
+    /**
+     * @brief Appends a payload with its header to the record, compressing it if the collection scheme did not and
+     *        compression is not deferred
+     *
+     * @return true if the payload was appended, else the record is unchanged
+     */
+    bool appendPayload( std::vector<uint8_t> &record,
+                        const std::uint8_t *buf,
+                        size_t size,
+                        const struct CollectionSchemeParams &collectionSchemeParams );
+
+    /**
+     * @brief Writes the record with one or more payloads to the persistency, with the priority of the collection
+     *        scheme and the current time in the index
+     */
+    bool writeRecord( const std::vector<uint8_t> &record, const struct CollectionSchemeParams &collectionSchemeParams );
+
+    /**
+     * @brief Separates the payloads stored in one record from their headers and uncompresses them if needed
+     *
+     * @param buf      data of the record
+     * @param size     size of the record data
+     * @param data     vector to store parsed payloads
+     *
+     * @return SUCCESS, or INVALID_DATA if a payload could not be uncompressed or its header is truncated
+     */
+    ErrorCode parsePayloads( const uint8_t *buf, size_t size, std::vector<PayloadBufferPtr> &data );
+
+    /**
+     * @brief Compresses the payloads of one record for compactSegment()
+     *
+     * @param out   the compacted record
+     * @return true if a payload was compressed, false if the record is kept as it is
+     */
+    bool compactRecord( const uint8_t *buf, size_t size, std::vector<uint8_t> &out );
 };
 } // namespace OffboardConnectivityAwsIot
 } // namespace IoTFleetWise
@@ -14,18 +14,25 @@
 #pragma once
 
 #include "CPUUsageInfo.h"
-#include "ClockHandler.h"
+#include "FastClock.h"
 #include "IConnectionTypes.h"
 #include "ILogger.h"
 #include "ISender.h"
+#include "InstrumentedMutex.h"
 #include "LogLevel.h"
 #include "LoggingModule.h"
 #include "MemoryUsageInfo.h"
+#include "MetricsEncoder.h"
 #include "Thread.h"
+#include "TokenBucket.h"
 #include "TraceModule.h"
+#include <atomic>
+#include <cstddef>
 #include <json/json.h>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace Aws
 {
@@ -34,6 +41,17 @@ namespace IoTFleetWise
 namespace OffboardConnectivity
 {
 using namespace Aws::IoTFleetWise::Platform::Linux;
+
+/**
+ * @brief Uploads the metrics of the TraceModule and the execution environment and the log messages over MQTT
+ *
+ * Logging threads only copy the message into a lock-free ring of fixed records, like the AsyncLogger, so they
+ * never wait for another logging thread or for an upload. The profiler thread moves the records into the pending
+ * batch, in which a message repeated with the same level, function and text is only counted. A batch is uploaded
+ * once it is full or loggingUploadMaxWaitBeforeUploadMs passed. Optionally the batches are compressed with snappy and
+ * the uploaded log bytes are capped by a token bucket, batches above the cap are dropped. Messages dropped because the
+ * ring was full or by the cap are counted in the trace variable LogDrop and reported in the next uploaded batch.
+ */
 class RemoteProfiler : public IMetricsReceiver, public ILogger
 {
 public:
@@ -44,6 +62,15 @@ public:
     static const uint32_t MAX_BYTES_FOR_SINGLE_LOG_UPLOAD =
         16384; // 16KiB. Must be << 128KiB because its sent in one MQTT message
     static const uint32_t JSON_MAX_OVERHEAD_BYTES_PER_LOG = 60; // Including LogLevel
+    static const uint32_t JSON_MAX_OVERHEAD_BYTES_PER_LOG_COUNT = 20; // Count of a repeated message
+    static const uint32_t JSON_MAX_OVERHEAD_BYTES_PER_STALL_RECORD = 160;
+    // Log messages waiting for the profiler thread, must be a power of two
+    static constexpr size_t LOG_RING_CAPACITY = 512;
+    static constexpr size_t MAX_LOG_FUNCTION_LENGTH = 63;
+    static constexpr size_t MAX_LOG_ENTRY_LENGTH = 447;
+    static constexpr uint32_t DEFAULT_BINARY_METRICS_BATCH_INTERVAL_MS = 60000;
+    static constexpr uint32_t BINARY_METRICS_DEFINITIONS_REPEAT_UPLOADS =
+        60; // The series definitions are sent again every this many batches, so a lost batch does not lose them
 
     /**
      * @brief Construct the RemoteProfiler which can upload metrics and logs over MQTT
@@ -67,8 +94,8 @@ public:
     /**
      * @brief Implement the ILogger interface
      *
-     * Packs the log string into a json and uploads to the cloud if necessary
-     * Can be called from multiple threads.
+     * Copies the log message into the ring without waiting, the profiler thread packs it into a json and uploads it.
+     * Can be called from multiple threads. Drops the message if the ring is full.
      *
      * @param level the log level used to decide if log entry should be uploaded
      * @param function the name of the function which emitted the log message
@@ -88,6 +115,62 @@ public:
      */
     void setMetric( const std::string &name, double value, const std::string &unit ) override;
 
+    /**
+     * @brief Uploads the metrics in the binary format of MetricsEncoder compressed with snappy instead of JSON.
+     * The metrics are still sampled every metrics upload interval but only uploaded in batches, so that hundreds
+     * of series cost only a few bytes per sample. Must be called before start.
+     *
+     * @param batchUploadIntervalMs interval between two uploads of the collected samples, 0 for the default
+     * @param seriesPrefixes only metrics whose name starts with one of the prefixes are uploaded, all if empty
+     */
+    void enableBinaryMetrics( uint32_t batchUploadIntervalMs, std::vector<std::string> seriesPrefixes );
+
+    /**
+     * @brief Registers a metric series of the binary upload with an explicit unit and scale, also if it does not
+     * match the prefixes. Must be called before start.
+     *
+     * @param name the name of the metric, without the profiler prefix
+     * @param unit the unit of the metric
+     * @param scale the values are uploaded as integers of value * scale
+     * @return false if the maximum number of series is reached
+     */
+    bool registerMetricsSeries( const std::string &name, const std::string &unit, uint32_t scale );
+
+    /**
+     * @brief Compresses the log batches with snappy, which allows batches up to the maximum send size of the log
+     * sender instead of MAX_BYTES_FOR_SINGLE_LOG_UPLOAD. Must be called before start.
+     */
+    void enableLogCompression();
+
+    /**
+     * @brief Caps the uploaded log bytes, after compression. Batches which exceed the cap are dropped. Must be called
+     * before start.
+     *
+     * @param bytesPerSecond average uploaded log bytes per second, 0 for no limit
+     * @param burstBytes log bytes which can be uploaded at once, 0 for one second of bytesPerSecond
+     */
+    void setLogUplinkLimit( double bytesPerSecond, double burstBytes );
+
+    /**
+     * @return the number of log messages which were dropped because the ring was full or by the uplink limit
+     */
+    uint64_t
+    getDroppedLogCount() const
+    {
+        return fDroppedLogs.load( std::memory_order_relaxed );
+    }
+
+    /**
+     * @brief Enables or disables the CpuThread_ metrics read from /proc on every metrics upload. Disabled if a
+     * ThreadTelemetrySampler is running, whose per thread metrics are forwarded through the TraceModule.
+     * @param enabled false to not read the CPU usage per thread
+     */
+    void
+    setPerThreadCPUUsageEnabled( bool enabled )
+    {
+        fPerThreadCPUUsageEnabled.store( enabled, std::memory_order_relaxed );
+    }
+
     /**
      * @brief start the thread
      * @return true if thread starting was successful
@@ -125,12 +208,40 @@ public:
     RemoteProfiler &operator=( RemoteProfiler && ) = delete;
 
 private:
+    struct LogRecord
+    {
+        // Position in the ring the slot can be written at, or position + 1 once the record is complete
+        std::atomic<uint64_t> sequence{ 0 };
+        LogLevel level{ LogLevel::Trace };
+        char function[MAX_LOG_FUNCTION_LENGTH + 1];
+        char logEntry[MAX_LOG_ENTRY_LENGTH + 1];
+    };
+
     static void doWork( void *data );
 
+    /**
+     * @brief Moves the records of the ring into the pending batch. Only called by the profiler thread.
+     */
+    void takeLogRecords();
+
+    /**
+     * @brief Appends a message to the pending batch or counts it if the same message is already pending
+     */
+    void appendLogMessage( LogLevel level, const char *function, const char *logEntry );
+
     void sendMetricsOut();
 
+    void sendBinaryMetricsOut();
+
     void sendLogsOut();
 
+    void appendLogNode( const Json::Value &logNode, uint32_t size );
+
+    /**
+     * @brief Appends the stalls recorded by the StallWatchdog since the previous upload to the logs
+     */
+    void appendStallRecords();
+
     void collectExecutionEnvironmentMetrics();
 
     void initLogStructure();
@@ -140,7 +251,6 @@ private:
     std::shared_ptr<ISender> fMetricsSender;
     std::shared_ptr<ISender> fLogSender;
     std::mutex fThreadMutex;
-    std::mutex loggingMutex;
     LoggingModule fLogger;
     Signal fWait;
     Json::Value fMetricsRoot;
@@ -148,7 +258,6 @@ private:
     uint16_t fCurrentMetricsPending;
     uint32_t fInitialUploadInterval;
     uint32_t fInitialLogMaxInterval;
-    std::shared_ptr<const Clock> fClock = ClockHandler::getClock();
     Timestamp fLastTimeMetricsSentOut;
     Timestamp fLastTimeMLogsSentOut;
     Timestamp fLastTimeExecutionEnvironmentMetricsCollected;
@@ -158,6 +267,26 @@ private:
     MemoryUsageInfo fMemoryUsage;
     std::string fProfilerPrefix;
     uint32_t fCurrentUserPayloadInLogRoot;
+    // Index in the log array of the pending messages, keyed by level, function and text
+    std::unordered_map<std::string, Json::ArrayIndex> fPendingLogIndex;
+    // Messages in the pending batch, including the repeated ones
+    uint64_t fPendingLogMessages{ 0 };
+    std::unique_ptr<LogRecord[]> fLogRecords;
+    // Logging threads and the profiler thread are kept on separate cache lines
+    alignas( 64 ) std::atomic<uint64_t> fLogEnqueuePosition{ 0 };
+    alignas( 64 ) uint64_t fLogDequeuePosition{ 0 };
+    std::atomic<uint64_t> fDroppedLogs{ 0 };
+    uint64_t fReportedDroppedLogs{ 0 };
+    bool fLogCompression{ false };
+    uint32_t fMaxLogBatchBytes{ MAX_BYTES_FOR_SINGLE_LOG_UPLOAD };
+    TokenBucket fLogUplinkLimit;
+    bool fBinaryMetrics{ false };
+    std::atomic<bool> fPerThreadCPUUsageEnabled{ true };
+    uint32_t fBinaryMetricsBatchInterval{ DEFAULT_BINARY_METRICS_BATCH_INTERVAL_MS };
+    Timestamp fLastTimeBinaryMetricsSentOut{ 0 };
+    Timestamp fCurrentSampleTime{ 0 };
+    uint32_t fBinaryMetricsUploads{ 0 };
+    MetricsEncoder fMetricsEncoder;
 };
 } // namespace OffboardConnectivity
 } // namespace IoTFleetWise
@@ -14,7 +14,7 @@
 #pragma once
 
 #include "LoggingModule.h"
-#include "Thread.h"
+#include "RetryScheduler.h"
 #include <atomic>
 
 namespace Aws
@@ -25,60 +25,42 @@ namespace OffboardConnectivityAwsIot
 {
 using namespace Aws::IoTFleetWise::Platform::Linux;
 
-enum class RetryStatus
-{
-    SUCCESS,
-    RETRY,
-    ABORT
-};
-
-class IRetryable
-{
-public:
-    /**
-     * @brief This function will be called for every retry
-     * @return decides if the function can be retried later or succeeded or unrecoverable failed
-     */
-    virtual RetryStatus attempt() = 0;
-
-    /**
-     * @brief Is called after the retries stopped which means it succeeded or is aborted
-     * @param code signals how it finished: if it was aborted or succeeded. retry should be never observed here
-     */
-    virtual void onFinished( RetryStatus code ) = 0;
-    virtual ~IRetryable() = default;
-};
-
+/**
+ * @brief Retries an IRetryable with exponential backoff until it succeeds or aborts
+ *
+ * The attempts run on the workers of the RetryScheduler, which are shared by all retryables.
+ */
 class RetryThread
 {
 public:
     RetryThread( IRetryable &retryable, uint32_t startBackoffMs, uint32_t maxBackoffMs );
 
     /**
-     * @brief start the thread
-     * @return true if thread starting was successful
+     * @brief starts the retries, the first attempt is made right away
+     * @return true if the retries were scheduled
      */
     bool start();
 
     /**
-     * @brief stops the thread
-     * @return true if thread stopping was successful
+     * @brief stops the retries, waits for a running attempt to complete
+     * @return true if the retries were stopped
      */
     bool stop();
 
     /**
-     * @brief check if thread is currently running
-     * @return true if thread is currently running
+     * @brief check if the retries are currently scheduled
+     * @return true if the retries did not finish yet
      */
     bool
     isAlive()
     {
-        return fThread.isValid() && fThread.isActive();
+        auto id = fRetryId.load();
+        return ( id != 0U ) && RetryScheduler::getInstance().isScheduled( id );
     }
 
     ~RetryThread()
     {
-        // To make sure the thread stops during teardown of tests.
+        // To make sure the retries stop during teardown of tests.
         if ( isAlive() )
         {
             stop();
@@ -91,24 +73,15 @@ public:
     RetryThread &operator=( RetryThread && ) = delete;
 
 private:
-    static void doWork( void *data );
-
-    static std::atomic<int> fInstanceCounter;
-    int fInstance;
-
     IRetryable &fRetryable;
 
     const uint32_t fStartBackoffMs;
     const uint32_t fMaxBackoffMs;
 
-    uint32_t fCurrentWaitTime;
-
     LoggingModule fLogger;
 
-    Thread fThread;
-    std::atomic<bool> fShouldStop;
-    std::mutex fThreadMutex;
-    Signal fWait;
+    std::atomic<RetryScheduler::RetryId> fRetryId;
+    std::mutex fMutex;
 };
 } // namespace OffboardConnectivityAwsIot
 } // namespace IoTFleetWise
@@ -0,0 +1,188 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "FastClock.h"
+#include "LoggingModule.h"
+#include "Signal.h"
+#include "Thread.h"
+#include "TokenBucket.h"
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace OffboardConnectivityAwsIot
+{
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+/**
+ * @brief Upload rate of a topic or of the whole link. A rate of 0 is not limited
+ */
+struct UploadRateLimit
+{
+    double bytesPerSecond{ 0.0 };
+    double burstBytes{ 0.0 }; /**< 0 for one second of bytesPerSecond */
+    double publishesPerSecond{ 0.0 };
+    double burstPublishes{ 0.0 }; /**< 0 for one second of publishesPerSecond */
+};
+
+/**
+ * @brief Schedules the publishes of several topics against token buckets per topic and for the whole link
+ *
+ * A publish which the buckets allow right away is done by the caller. Otherwise it is queued and done later by the
+ * thread of the shaper, so that callers are not blocked while the link is throttled. The topics are served round
+ * robin and the publishes of one topic stay in order. The queued bytes are bounded, beyond that schedule() fails and
+ * the caller has to persist or drop the payload. On stop the queued publishes are done without rate limit, so that
+ * the channels can persist them if there is no connection.
+ *
+ * Optionally the publishes which did not complete yet are limited to a window. Publishes above the window are queued
+ * as well, so that on links with a high round trip time the data waits here instead of in the SDK.
+ */
+class UploadShaper
+{
+public:
+    using PublishFunction = std::function<void()>;
+
+    static constexpr size_t DEFAULT_MAX_QUEUED_BYTES = 1024U * 1024U;
+
+    /**
+     * @param linkLimit         rate of all topics together
+     * @param maxQueuedBytes    bytes of all topics waiting for the buckets
+     * @param maxInFlightPublishes publishes of all topics which may wait for their completion, 0 for no limit
+     */
+    explicit UploadShaper( const UploadRateLimit &linkLimit,
+                           size_t maxQueuedBytes = DEFAULT_MAX_QUEUED_BYTES,
+                           size_t maxInFlightPublishes = 0 );
+    ~UploadShaper();
+
+    UploadShaper( const UploadShaper & ) = delete;
+    UploadShaper &operator=( const UploadShaper & ) = delete;
+    UploadShaper( UploadShaper && ) = delete;
+    UploadShaper &operator=( UploadShaper && ) = delete;
+
+    /**
+     * @brief Adds a topic with its own rate limit
+     * @return id of the topic, passed to the other functions
+     */
+    size_t addTopic( const UploadRateLimit &topicLimit );
+
+    /**
+     * @brief Changes the rate of all topics together at runtime, the queued publishes are rescheduled
+     */
+    void setLinkLimit( const UploadRateLimit &linkLimit );
+
+    /**
+     * @brief Changes the rate of a topic at runtime, the queued publishes are rescheduled
+     * @return False if there is no such topic
+     */
+    bool setTopicLimit( size_t topic, const UploadRateLimit &topicLimit );
+
+    /**
+     * @brief Takes the tokens and a place in the in-flight window for a publish which is done right away
+     * @return False if the buckets or the window do not allow it now or earlier publishes of the topic are still
+     *         queued, the publish must then be scheduled
+     */
+    bool tryAcquire( size_t topic, size_t bytes );
+
+    /**
+     * @brief Queues a publish, which the shaper thread calls once the buckets and the window allow it
+     * @return False if the queue is full, the publish function is then not called
+     */
+    bool schedule( size_t topic, size_t bytes, PublishFunction publish );
+
+    /**
+     * @brief Frees the place in the in-flight window taken by tryAcquire or before calling a scheduled publish. Must
+     *        be called once the publish completed or failed
+     */
+    void publishCompleted();
+
+    bool start();
+
+    /**
+     * @brief Does the queued publishes and stops the thread. The publish functions must stay valid until then
+     */
+    bool stop();
+
+    bool isAlive();
+
+    size_t getQueuedBytes() const;
+
+    size_t getInFlightPublishes() const;
+
+private:
+    struct ScheduledPublish
+    {
+        size_t mBytes{ 0 };
+        PublishFunction mPublish;
+    };
+
+    struct Topic
+    {
+        TokenBucket mBytes;
+        TokenBucket mPublishes;
+        std::deque<ScheduledPublish> mQueue;
+        bool mPublishing{ false };
+    };
+
+    static void doWork( void *data );
+
+    static void setLimit( Topic &topic, const UploadRateLimit &limit, Timestamp nowMs );
+
+    /**
+     * @brief Takes the next publish the buckets allow, must be called with mMutex held
+     * @param topicIndex set to the topic of the publish
+     * @param waitTimeMs set to the time until the next queued publish is allowed if there is none now
+     * @return False if no publish is allowed now
+     */
+    bool takeNextPublish( Timestamp nowMs, size_t &topicIndex, ScheduledPublish &publish, uint32_t &waitTimeMs );
+
+    uint32_t getWaitTimeMs( Topic &topic, size_t bytes, Timestamp nowMs );
+
+    void consume( Topic &topic, size_t bytes, Timestamp nowMs );
+
+    void publishDone( size_t topicIndex );
+
+    bool
+    isWindowFull() const
+    {
+        return ( mMaxInFlightPublishes != 0U ) && ( mInFlightPublishes >= mMaxInFlightPublishes );
+    }
+
+    mutable std::mutex mMutex;
+    Topic mLink;
+    std::vector<Topic> mTopics;
+    size_t mNextTopic{ 0 };
+    size_t mQueuedBytes{ 0 };
+    size_t mMaxQueuedBytes;
+    size_t mInFlightPublishes{ 0 };
+    size_t mMaxInFlightPublishes;
+
+    Thread mThread;
+    std::atomic<bool> mShouldStop{ false };
+    std::mutex mThreadMutex;
+    Signal mWait;
+    LoggingModule mLogger;
+};
+
+} // namespace OffboardConnectivityAwsIot
+} // namespace IoTFleetWise
+} // namespace Aws
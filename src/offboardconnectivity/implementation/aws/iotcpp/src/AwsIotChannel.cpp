@@ -13,7 +13,11 @@
 
 #include "AwsIotChannel.h"
 #include "AwsIotConnectivityModule.h"
+#include "LatencyTracer.h"
 #include "TraceModule.h"
+#include "UplinkAccounting.h"
+#include <algorithm>
+#include <chrono>
 #include <sstream>
 
 using namespace Aws::IoTFleetWise::OffboardConnectivityAwsIot;
@@ -149,9 +153,272 @@ AwsIotChannel::getMaxSendSize() const
     return AWS_IOT_MAX_MESSAGE_SIZE;
 }
 
+void
+AwsIotChannel::setLowPriorityMemoryLimit( uint32_t maxPriority, std::size_t limitBytes )
+{
+    std::lock_guard<std::mutex> connectivityLock( mConnectivityMutex );
+    mLowPriorityMemoryMaxPriority = maxPriority;
+    mLowPriorityMemoryLimitBytes = limitBytes;
+}
+
+void
+AwsIotChannel::setExpressMemoryReservation( std::size_t reservedBytes )
+{
+    std::lock_guard<std::mutex> connectivityLock( mConnectivityMutex );
+    mExpressReservedMemoryBytes = reservedBytes;
+}
+
+void
+AwsIotChannel::setUploadShaper( std::shared_ptr<UploadShaper> uploadShaper, const UploadRateLimit &topicLimit )
+{
+    std::lock_guard<std::mutex> connectivityLock( mConnectivityMutex );
+    mUploadShaperTopic = uploadShaper->addTopic( topicLimit );
+    mUploadShaper = std::move( uploadShaper );
+}
+
+bool
+AwsIotChannel::setUploadRateLimit( const UploadRateLimit &topicLimit )
+{
+    std::lock_guard<std::mutex> connectivityLock( mConnectivityMutex );
+    return ( mUploadShaper != nullptr ) && mUploadShaper->setTopicLimit( mUploadShaperTopic, topicLimit );
+}
+
 ConnectivityError
 AwsIotChannel::send( const std::uint8_t *buf, size_t size, struct CollectionSchemeParams collectionSchemeParams )
 {
+    return publish( buf, size, nullptr, collectionSchemeParams );
+}
+
+ConnectivityError
+AwsIotChannel::sendBuffer( PayloadBufferPtr buffer, struct CollectionSchemeParams collectionSchemeParams )
+{
+    if ( buffer == nullptr )
+    {
+        mLogger.warn( "AwsIotChannel::sendBuffer", "No valid data provided" );
+        return ConnectivityError::WrongInputData;
+    }
+    const auto *buf = buffer->data();
+    auto size = buffer->size();
+    return publish( buf, size, std::move( buffer ), collectionSchemeParams );
+}
+
+ConnectivityError
+AwsIotChannel::persistBuffers( const std::vector<PayloadBufferPtr> &buffers,
+                               struct CollectionSchemeParams collectionSchemeParams )
+{
+    if ( mPayloadManager == nullptr )
+    {
+        return ConnectivityError::NotConfigured;
+    }
+    if ( buffers.empty() )
+    {
+        mLogger.warn( "AwsIotChannel::persistBuffers", "No valid data provided" );
+        return ConnectivityError::WrongInputData;
+    }
+    if ( !mPayloadManager->storeBatch( buffers, collectionSchemeParams ) )
+    {
+        mLogger.warn( "AwsIotChannel::persistBuffers", "Data was not persisted and is lost" );
+        return ConnectivityError::WrongInputData;
+    }
+    mLogger.trace( "AwsIotChannel::persistBuffers",
+                   "Batch of " + std::to_string( buffers.size() ) + " payloads persisted successfully" );
+    return ConnectivityError::Success;
+}
+
+namespace
+{
+// Counts the completed publishes of a batch and calls its callback once with the last one
+class BatchCompletion
+{
+public:
+    BatchCompletion( size_t items, SendBatchCallback onComplete )
+        : mRemaining( items )
+        , mOnComplete( std::move( onComplete ) )
+    {
+    }
+
+    void
+    complete( bool published )
+    {
+        if ( published )
+        {
+            mPublished++;
+        }
+        if ( ( mRemaining.fetch_sub( 1 ) == 1 ) && mOnComplete )
+        {
+            mOnComplete( mPublished.load() );
+        }
+    }
+
+private:
+    std::atomic<size_t> mRemaining;
+    std::atomic<size_t> mPublished{ 0 };
+    SendBatchCallback mOnComplete;
+};
+} // namespace
+
+ConnectivityError
+AwsIotChannel::sendBatch( const std::vector<SendBatchItem> &items, SendBatchCallback onComplete )
+{
+    // Segments of an item are gathered before taking the lock, as MQTT publishes one contiguous payload
+    std::vector<PayloadBufferPtr> payloads;
+    payloads.reserve( items.size() );
+    size_t totalSize = 0;
+    for ( const auto &item : items )
+    {
+        auto payload = gatherSegments( item.segments, &mPayloadBufferPool );
+        if ( ( payload == nullptr ) || ( payload->size() > getMaxSendSize() ) )
+        {
+            mLogger.warn( "AwsIotChannel::sendBatch", "No valid data provided" );
+            payloads.clear();
+            break;
+        }
+        totalSize += payload->size();
+        payloads.emplace_back( std::move( payload ) );
+    }
+    if ( payloads.empty() )
+    {
+        if ( onComplete )
+        {
+            onComplete( 0 );
+        }
+        return ConnectivityError::WrongInputData;
+    }
+
+    auto batch = std::make_shared<BatchCompletion>( payloads.size(), std::move( onComplete ) );
+    PublishCompletion itemCompleted = [batch]( bool published ) {
+        batch->complete( published );
+    };
+    auto result = ConnectivityError::Success;
+    size_t failedItems = 0;
+    bool shaped = false;
+    {
+        std::lock_guard<std::mutex> connectivityLock( mConnectivityMutex );
+        for ( const auto &item : items )
+        {
+            shaped = shaped || ( ( mUploadShaper != nullptr ) && ( !item.collectionSchemeParams.express ) );
+        }
+        if ( !isTopicValid() )
+        {
+            mLogger.warn( "AwsIotChannel::sendBatch", "Invalid topic provided" );
+            result = ConnectivityError::NotConfigured;
+            failedItems = payloads.size();
+        }
+        else if ( !isAliveNotThreadSafe() )
+        {
+            mLogger.warn( "AwsIotChannel::sendBatch", "There is no active MQTT Connection." );
+            persistBatchNotThreadSafe( items, payloads );
+            result = ConnectivityError::NoConnection;
+            failedItems = payloads.size();
+        }
+        else if ( !shaped )
+        {
+            // The whole batch is reserved before the first publish and checked once against the limit of its most
+            // important payload. Each payload is reserved on its own, as each completion releases its own memory.
+            std::size_t memoryLimit = 0;
+            bool unlimited = false;
+            for ( const auto &item : items )
+            {
+                auto itemLimit = getMemoryLimitNotThreadSafe( item.collectionSchemeParams );
+                unlimited = unlimited || ( itemLimit == 0 );
+                memoryLimit = std::max( memoryLimit, itemLimit );
+            }
+            memoryLimit = unlimited ? 0 : memoryLimit;
+            uint64_t currentMemoryUsage = 0;
+            for ( const auto &payload : payloads )
+            {
+                currentMemoryUsage = mConnectivityModule->reserveMemoryUsage( payload->size() );
+            }
+            if ( ( memoryLimit != 0 ) && ( currentMemoryUsage > memoryLimit ) )
+            {
+                for ( const auto &payload : payloads )
+                {
+                    mConnectivityModule->releaseMemoryUsage( payload->size() );
+                }
+                mLogger.error( "AwsIotChannel::sendBatch",
+                               "Not sending out the batch of " + std::to_string( payloads.size() ) +
+                                   " messages with size " + std::to_string( totalSize ) +
+                                   " because IoT device SDK allocated the maximum defined memory. Currently "
+                                   "allocated " +
+                                   std::to_string( currentMemoryUsage ) );
+                persistBatchNotThreadSafe( items, payloads );
+                result = ConnectivityError::QuotaReached;
+                failedItems = payloads.size();
+            }
+            else
+            {
+                // Pipelined: all publishes are handed to the SDK before the first one completes. Each completion
+                // releases the memory of its payload, as does each publish the SDK does not accept.
+                for ( size_t i = 0; i < payloads.size(); i++ )
+                {
+                    const auto *buf = payloads[i]->data();
+                    auto size = payloads[i]->size();
+                    auto itemResult = publishReservedNotThreadSafe(
+                        buf, size, payloads[i], items[i].collectionSchemeParams, nullptr, itemCompleted );
+                    if ( itemResult != ConnectivityError::Success )
+                    {
+                        result = ( result == ConnectivityError::Success ) ? itemResult : result;
+                        failedItems++;
+                    }
+                }
+            }
+        }
+    }
+
+    if ( shaped )
+    {
+        // The shaper decides per payload when it is published, so the items go through it one by one
+        for ( size_t i = 0; i < payloads.size(); i++ )
+        {
+            const auto *buf = payloads[i]->data();
+            auto size = payloads[i]->size();
+            auto itemResult =
+                publish( buf, size, payloads[i], items[i].collectionSchemeParams, false, itemCompleted );
+            if ( itemResult != ConnectivityError::Success )
+            {
+                result = ( result == ConnectivityError::Success ) ? itemResult : result;
+                failedItems++;
+            }
+        }
+    }
+    // Completed outside of the lock, as the callback may send again
+    for ( size_t i = 0; i < failedItems; i++ )
+    {
+        itemCompleted( false );
+    }
+    return result;
+}
+
+void
+AwsIotChannel::persistBatchNotThreadSafe( const std::vector<SendBatchItem> &items,
+                                          const std::vector<PayloadBufferPtr> &payloads )
+{
+    if ( mPayloadManager == nullptr )
+    {
+        return;
+    }
+    for ( size_t i = 0; i < payloads.size(); i++ )
+    {
+        if ( mPayloadManager->storeData( payloads[i]->data(), payloads[i]->size(), items[i].collectionSchemeParams ) )
+        {
+            mLogger.trace( "AwsIotChannel::sendBatch", "Payload has persisted successfully on disk" );
+        }
+        else
+        {
+            mLogger.warn( "AwsIotChannel::sendBatch", "Payload has not been persisted" );
+        }
+    }
+}
+
+ConnectivityError
+AwsIotChannel::publish( const std::uint8_t *buf,
+                        size_t size,
+                        PayloadBufferPtr buffer,
+                        const struct CollectionSchemeParams &collectionSchemeParams,
+                        bool scheduled,
+                        PublishCompletion onComplete )
+{
+    TraceScopedTimer publishTimer( TraceHistogram::MQTT_PUBLISH_NS, 1 );
     std::lock_guard<std::mutex> connectivityLock( mConnectivityMutex );
     if ( !isTopicValid() )
     {
@@ -174,6 +441,10 @@ AwsIotChannel::send( const std::uint8_t *buf, size_t size, struct CollectionSche
     if ( !isAliveNotThreadSafe() )
     {
         mLogger.warn( "AwsIotChannel::send", "There is no active MQTT Connection." );
+        if ( scheduled )
+        {
+            mUploadShaper->publishCompleted();
+        }
         if ( mPayloadManager != nullptr )
         {
             bool isDataPersisted = mPayloadManager->storeData( buf, size, collectionSchemeParams );
@@ -190,13 +461,32 @@ AwsIotChannel::send( const std::uint8_t *buf, size_t size, struct CollectionSche
         return ConnectivityError::NoConnection;
     }
 
+    // Publishes the rate limits or the in-flight window do not allow now are done later by the thread of the upload
+    // shaper. A scheduled publish got its place in the window before it was called. Express payloads are not shaped.
+    std::shared_ptr<UploadShaper> inFlightWindow = scheduled ? mUploadShaper : nullptr;
+    if ( ( mUploadShaper != nullptr ) && ( !scheduled ) && ( !collectionSchemeParams.express ) )
+    {
+        if ( !mUploadShaper->tryAcquire( mUploadShaperTopic, size ) )
+        {
+            return schedulePublishNotThreadSafe(
+                buf, size, std::move( buffer ), collectionSchemeParams, std::move( onComplete ) );
+        }
+        inFlightWindow = mUploadShaper;
+    }
+
+    auto memoryLimit = getMemoryLimitNotThreadSafe( collectionSchemeParams );
     uint64_t currentMemoryUsage = mConnectivityModule->reserveMemoryUsage( size );
-    if ( mMaximumIotSDKHeapMemoryBytes != 0 && currentMemoryUsage > mMaximumIotSDKHeapMemoryBytes )
+    if ( memoryLimit != 0 && currentMemoryUsage > memoryLimit )
     {
         mConnectivityModule->releaseMemoryUsage( size );
+        if ( inFlightWindow != nullptr )
+        {
+            inFlightWindow->publishCompleted();
+        }
         mLogger.error( "AwsIotChannel::send",
                        "Not sending out the message  with size " + std::to_string( size ) +
-                           " because IoT device SDK allocated the maximum defined memory. Currently allocated " +
+                           " because IoT device SDK allocated the maximum defined memory for priority " +
+                           std::to_string( collectionSchemeParams.priority ) + ". Currently allocated " +
                            std::to_string( currentMemoryUsage ) );
         if ( mPayloadManager != nullptr )
         {
@@ -213,17 +503,73 @@ AwsIotChannel::send( const std::uint8_t *buf, size_t size, struct CollectionSche
         }
         return ConnectivityError::QuotaReached;
     }
+    return publishReservedNotThreadSafe(
+        buf, size, std::move( buffer ), collectionSchemeParams, inFlightWindow, std::move( onComplete ) );
+}
+
+std::size_t
+AwsIotChannel::getMemoryLimitNotThreadSafe( const struct CollectionSchemeParams &collectionSchemeParams ) const
+{
+    // Less important payloads are spilled before the SDK reaches its maximum, to keep memory for the important ones
+    // and the memory reserved for the express payloads is only used by them
+    auto memoryLimit = mMaximumIotSDKHeapMemoryBytes;
+    if ( ( !collectionSchemeParams.express ) && ( memoryLimit != 0 ) && ( mExpressReservedMemoryBytes != 0 ) )
+    {
+        memoryLimit -= std::min( mExpressReservedMemoryBytes, memoryLimit - 1U );
+    }
+    if ( ( !collectionSchemeParams.express ) && ( mLowPriorityMemoryLimitBytes != 0 ) &&
+         ( collectionSchemeParams.priority > mLowPriorityMemoryMaxPriority ) &&
+         ( ( memoryLimit == 0 ) || ( mLowPriorityMemoryLimitBytes < memoryLimit ) ) )
+    {
+        memoryLimit = mLowPriorityMemoryLimitBytes;
+    }
+    return memoryLimit;
+}
 
+ConnectivityError
+AwsIotChannel::publishReservedNotThreadSafe( const std::uint8_t *buf,
+                                             size_t size,
+                                             PayloadBufferPtr buffer,
+                                             const struct CollectionSchemeParams &collectionSchemeParams,
+                                             std::shared_ptr<UploadShaper> inFlightWindow,
+                                             PublishCompletion onComplete )
+{
     auto connection = mConnectivityModule->getConnection();
 
-    auto payload = ByteBufNewCopy( DefaultAllocator(), (const uint8_t *)buf, size );
+    // A payload in a buffer is referenced by the callback until the publish completed, other payloads are copied
+    bool ownsPayload = ( buffer == nullptr );
+    auto payload = ownsPayload ? ByteBufNewCopy( DefaultAllocator(), (const uint8_t *)buf, size )
+                               : ByteBufFromArray( buf, size );
 
+    auto publishStart = std::chrono::steady_clock::now();
+    auto params = collectionSchemeParams;
     auto onPublishComplete =
-        [payload, size, this]( Mqtt::MqttConnection &mqttConnection, uint16_t packetId, int errorCode ) {
+        [payload, ownsPayload, buffer, size, inFlightWindow, publishStart, params, onComplete, this](
+            Mqtt::MqttConnection &mqttConnection, uint16_t packetId, int errorCode ) {
             /* This call means that the data was handed over to some lower level in the stack but not
                 that the data is actually sent on the bus or removed from RAM*/
             (void)mqttConnection;
-            aws_byte_buf_clean_up( (Aws::Crt::ByteBuf *)&payload ); // NOLINT(cppcoreguidelines-pro-type-cstyle-cast)
+            if ( errorCode == 0 )
+            {
+                LatencyTracer::get().mark( params.traceId, LatencyStage::PUBACK );
+            }
+            auto latencyMs = std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::steady_clock::now() -
+                                                                                    publishStart )
+                                 .count();
+            TraceModule::get().decrementAtomicVariable( TraceAtomicVariable::MQTT_PUBLISHES_IN_FLIGHT );
+            TraceModule::get().subtractFromAtomicVariable( TraceAtomicVariable::UPLOAD_BACKLOG_BYTES, size );
+            if ( errorCode == 0 )
+            {
+                TraceModule::get().addToAtomicVariable( TraceAtomicVariable::MQTT_PUBLISHED_BYTES, size );
+                UplinkAccounting::get().add( params.accountId, UplinkCounter::PUBLISHES, 1 );
+                UplinkAccounting::get().add( params.accountId, UplinkCounter::PUBLISHED_BYTES, size );
+            }
+            TraceModule::get().recordHistogram( TraceHistogram::MQTT_PUBLISH_LATENCY_MS,
+                                                static_cast<uint64_t>( latencyMs ) );
+            if ( inFlightWindow != nullptr )
+            {
+                inFlightWindow->publishCompleted();
+            }
             {
                 std::lock_guard<std::mutex> connectivityLambdaLock( mConnectivityLambdaMutex );
                 if ( mConnectivityModule != nullptr )
@@ -231,6 +577,26 @@ AwsIotChannel::send( const std::uint8_t *buf, size_t size, struct CollectionSche
                     mConnectivityModule->releaseMemoryUsage( size );
                 }
             }
+            // A payload lost because the connection dropped while it was in flight is persisted like one that
+            // could not be published, so that only the missing parts of a trigger are sent after the reconnect. The
+            // payload is still held by the callback, so it is written without blocking the other completions.
+            if ( ( errorCode != 0 ) && params.persist && ( mPayloadManager != nullptr ) )
+            {
+                if ( mPayloadManager->storeData( payload.buffer, payload.len, params ) )
+                {
+                    mLogger.info( "AwsIotChannel::onPublishComplete", "Payload failed in flight and was persisted" );
+                }
+                else
+                {
+                    mLogger.warn( "AwsIotChannel::onPublishComplete",
+                                  "Payload failed in flight and was not persisted" );
+                }
+            }
+            if ( ownsPayload )
+            {
+                // NOLINTNEXTLINE(cppcoreguidelines-pro-type-cstyle-cast)
+                aws_byte_buf_clean_up( (Aws::Crt::ByteBuf *)&payload );
+            }
             if ( packetId != 0U && errorCode == 0 )
             {
                 mLogger.trace( "AwsIotChannel::send",
@@ -241,11 +607,84 @@ AwsIotChannel::send( const std::uint8_t *buf, size_t size, struct CollectionSche
                 mLogger.error( "AwsIotChannel::send",
                                std::string( "Operation failed with error" ) + aws_error_debug_str( errorCode ) );
             }
+            if ( onComplete )
+            {
+                onComplete( errorCode == 0 );
+            }
         };
-    connection->Publish( mTopicName.c_str(), Mqtt::QOS::AWS_MQTT_QOS_AT_MOST_ONCE, false, payload, onPublishComplete );
+    TraceModule::get().incrementAtomicVariable( TraceAtomicVariable::MQTT_PUBLISHES_IN_FLIGHT );
+    TraceModule::get().addToAtomicVariable( TraceAtomicVariable::UPLOAD_BACKLOG_BYTES, size );
+    LatencyTracer::get().mark( params.traceId, LatencyStage::PUBLISH );
+    // MQTT 3.1.1 has no topic aliases, so the full topic is sent with every publish
+    if ( connection->Publish(
+             mTopicName.c_str(), Mqtt::QOS::AWS_MQTT_QOS_AT_MOST_ONCE, false, payload, onPublishComplete ) == 0U )
+    {
+        // The completion callback is not called for a publish the SDK did not accept
+        mLogger.error( "AwsIotChannel::send",
+                       "Publish failed with error " + std::string( ErrorDebugString( connection->LastError() ) ) );
+        TraceModule::get().decrementAtomicVariable( TraceAtomicVariable::MQTT_PUBLISHES_IN_FLIGHT );
+        TraceModule::get().subtractFromAtomicVariable( TraceAtomicVariable::UPLOAD_BACKLOG_BYTES, size );
+        if ( ownsPayload )
+        {
+            aws_byte_buf_clean_up( &payload );
+        }
+        mConnectivityModule->releaseMemoryUsage( size );
+        if ( inFlightWindow != nullptr )
+        {
+            inFlightWindow->publishCompleted();
+        }
+        return ConnectivityError::NoConnection;
+    }
     return ConnectivityError::Success;
 }
 
+ConnectivityError
+AwsIotChannel::schedulePublishNotThreadSafe( const std::uint8_t *buf,
+                                             size_t size,
+                                             PayloadBufferPtr buffer,
+                                             const struct CollectionSchemeParams &collectionSchemeParams,
+                                             PublishCompletion onComplete )
+{
+    if ( buffer == nullptr )
+    {
+        // The caller keeps its data, so it is copied until the publish is done
+        buffer = mPayloadBufferPool.acquire();
+        buffer->assign( buf, buf + size );
+    }
+    // Counted before scheduling, as the shaper thread may publish it right away
+    TraceModule::get().addToAtomicVariable( TraceAtomicVariable::UPLOAD_BACKLOG_BYTES, size );
+    if ( mUploadShaper->schedule( mUploadShaperTopic, size, [this, buffer, collectionSchemeParams, onComplete]() {
+             TraceModule::get().subtractFromAtomicVariable( TraceAtomicVariable::UPLOAD_BACKLOG_BYTES,
+                                                            buffer->size() );
+             // A publish that fails here is never completed by the SDK
+             if ( ( publish( buffer->data(), buffer->size(), buffer, collectionSchemeParams, true, onComplete ) !=
+                    ConnectivityError::Success ) &&
+                  onComplete )
+             {
+                 onComplete( false );
+             }
+         } ) )
+    {
+        return ConnectivityError::Success;
+    }
+    TraceModule::get().subtractFromAtomicVariable( TraceAtomicVariable::UPLOAD_BACKLOG_BYTES, size );
+    mLogger.warn( "AwsIotChannel::send",
+                  "Not sending out the message with size " + std::to_string( size ) +
+                      " because the upload queue is full" );
+    if ( mPayloadManager != nullptr )
+    {
+        if ( mPayloadManager->storeData( buf, size, collectionSchemeParams ) )
+        {
+            mLogger.trace( "AwsIotChannel::send", "Data was persisted successfully" );
+        }
+        else
+        {
+            mLogger.warn( "AwsIotChannel::send", "Data was not persisted and is lost" );
+        }
+    }
+    return ConnectivityError::QuotaReached;
+}
+
 bool
 AwsIotChannel::unsubscribe()
 {
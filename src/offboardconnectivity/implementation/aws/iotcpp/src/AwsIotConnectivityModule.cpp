@@ -14,6 +14,7 @@
 #include "AwsIotConnectivityModule.h"
 #include "AwsBootstrap.h"
 #include "AwsSDKMemoryManager.h"
+#include "FastClock.h"
 
 #include "TraceModule.h"
 
@@ -29,16 +30,6 @@
 
 using namespace Aws::IoTFleetWise::OffboardConnectivityAwsIot;
 using namespace Aws::Crt;
-// Default MQTT Keep alive in seconds.
-// Defines how often an MQTT PING message is sent to the MQTT broker to keep the connection alive
-// Default set to 60 seconds. Every 60 seconds the stack will send an MQTT PING req.
-// The longer this interval is, the more the stack takes to detect the state of the TCP connection
-// at the lower network layers.
-constexpr uint16_t MQTT_CONNECT_KEEP_ALIVE_SECONDS = 60;
-// Default ping timeout value in milliseconds
-// If a response is not received within this interval, the connection will be reestablished.
-// If the PING request does not return within this interval, the stack will create a new one.
-constexpr uint32_t MQTT_PING_TIMOUT_MS = 3000;
 
 AwsIotConnectivityModule::AwsIotConnectivityModule()
     : mRetryThread( *this, RETRY_FIRST_CONNECTION_START_BACKOFF_MS, RETRY_FIRST_CONNECTION_MAX_BACKOFF_MS )
@@ -110,6 +101,47 @@ AwsIotConnectivityModule::createNewChannel( const std::shared_ptr<PayloadManager
     return mChannels.back();
 }
 
+void
+AwsIotConnectivityModule::setSharedClient( std::shared_ptr<AwsIotSharedClient> sharedClient )
+{
+    mSharedClient = std::move( sharedClient );
+}
+
+void
+AwsIotConnectivityModule::setReconnectConfig( const MqttReconnectConfig &config )
+{
+    mReconnectConfig = config;
+}
+
+bool
+AwsIotConnectivityModule::onLinkUp()
+{
+    std::lock_guard<std::mutex> lock( mReconnectMutex );
+    // A first connection is already retried by the retry thread, which also does the reconnect started here
+    if ( mConnected || ( mInterruptedTimeMs == 0 ) || mRetryThread.isAlive() )
+    {
+        return false;
+    }
+    mLogger.info( "AwsIotConnectivityModule::onLinkUp", "Link is up, reconnecting without waiting for the backoff" );
+    // Stops the reconnects of the SDK, the connection is then established like the first one
+    resetConnection();
+    return mRetryThread.start();
+}
+
+void
+AwsIotConnectivityModule::recordReconnect()
+{
+    auto interruptedTimeMs = mInterruptedTimeMs.exchange( 0 );
+    if ( interruptedTimeMs == 0 )
+    {
+        return;
+    }
+    auto reconnectTimeMs = FastClock::monotonicTimeMs() - interruptedTimeMs;
+    TraceModule::get().recordHistogram( TraceHistogram::MQTT_RECONNECT_MS, reconnectTimeMs );
+    mLogger.info( "AwsIotConnectivityModule::recordReconnect",
+                  "Connected again " + std::to_string( reconnectTimeMs ) + " ms after the interruption" );
+}
+
 bool
 AwsIotConnectivityModule::resetConnection()
 {
@@ -131,7 +163,9 @@ AwsIotConnectivityModule::resetConnection()
 bool
 AwsIotConnectivityModule::disconnect()
 {
+    std::lock_guard<std::mutex> lock( mReconnectMutex );
     mRetryThread.stop();
+    mInterruptedTimeMs = 0;
     return resetConnection();
 }
 
@@ -177,6 +211,9 @@ AwsIotConnectivityModule::setupCallbacks()
         errorString.append( ErrorDebugString( error ) );
         mLogger.error( "AwsIotConnectivityModule::setupCallbacks", errorString );
         mConnected = false;
+        // The time to reconnect is measured from the first interruption if the connection fails again
+        Timestamp notInterrupted = 0;
+        mInterruptedTimeMs.compare_exchange_strong( notInterrupted, FastClock::monotonicTimeMs() );
     };
 
     auto onResumed = [&]( Mqtt::MqttConnection &mqttConnection, Mqtt::ReturnCode connectCode, bool sessionPresent ) {
@@ -186,6 +223,7 @@ AwsIotConnectivityModule::setupCallbacks()
         TraceModule::get().incrementAtomicVariable( TraceAtomicVariable::CONNECTION_RESUMED );
         mLogger.info( "AwsIotConnectivityModule::setupCallbacks", "The MQTT Connection has resumed" );
         mConnected = true;
+        recordReconnect();
     };
 
     auto onDisconnect = [&]( Mqtt::MqttConnection &mqttConnection ) {
@@ -235,6 +273,17 @@ AwsIotConnectivityModule::renameEventLoopTask()
 bool
 AwsIotConnectivityModule::createMqttConnection( Aws::Crt::Io::ClientBootstrap *clientBootstrap )
 {
+    if ( mSharedClient != nullptr )
+    {
+        // The TLS context and client are shared, only the connection is owned by this module
+        if ( mClientId.empty() )
+        {
+            mLogger.error( "AwsIotConnectivityModule::connect", " Please provide a client-Id" );
+            return false;
+        }
+        mConnection = mSharedClient->newConnection();
+        return ( mConnection != nullptr ) && setReconnectTimeout();
+    }
     if ( mCertificate.len == 0 || mPrivateKey.len == 0 || mEndpointUrl.empty() || mClientId.empty() )
     {
         mLogger.error( "AwsIotConnectivityModule::connect",
@@ -283,8 +332,6 @@ AwsIotConnectivityModule::createMqttConnection( Aws::Crt::Io::ClientBootstrap *c
 
     mConnection = mMqttClient->NewConnection( clientConfig );
 
-    // No call to SetReconnectTimeout so it uses the SDK reconnect defaults (currently starting at 1 second and max 128
-    // seconds)
     if ( !mConnection )
     {
         mLogger.error( "AwsIotConnectivityModule::connect",
@@ -292,13 +339,27 @@ AwsIotConnectivityModule::createMqttConnection( Aws::Crt::Io::ClientBootstrap *c
                            std::string( ErrorDebugString( mMqttClient->LastError() ) ) );
         return false;
     }
+    return setReconnectTimeout();
+}
+
+bool
+AwsIotConnectivityModule::setReconnectTimeout()
+{
+    if ( !mConnection->SetReconnectTimeout( mReconnectConfig.minBackoffSeconds, mReconnectConfig.maxBackoffSeconds ) )
+    {
+        mLogger.error( "AwsIotConnectivityModule::connect",
+                       "Setting the reconnect backoff failed with error " +
+                           std::string( ErrorDebugString( mConnection->LastError() ) ) );
+        return false;
+    }
     return true;
 }
 
 RetryStatus
 AwsIotConnectivityModule::attempt()
 {
-    if ( !mConnection->Connect( mClientId.c_str(), false, MQTT_CONNECT_KEEP_ALIVE_SECONDS, MQTT_PING_TIMOUT_MS ) )
+    if ( !mConnection->Connect(
+             mClientId.c_str(), false, mReconnectConfig.keepAliveSeconds, mReconnectConfig.pingTimeoutMs ) )
     {
         std::string error = " The MQTT Connection failed due to: ";
         error.append( ErrorDebugString( mConnection->LastError() ) );
@@ -328,6 +389,8 @@ AwsIotConnectivityModule::onFinished( RetryStatus code )
 {
     if ( code == RetryStatus::SUCCESS )
     {
+        // Set if the connection was established again after onLinkUp
+        recordReconnect();
         for ( auto channel : mChannels )
         {
             if ( channel->shouldSubscribeAsynchronously() )
@@ -0,0 +1,81 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "AwsIotSharedClient.h"
+#include "TraceModule.h"
+
+using namespace Aws::IoTFleetWise::OffboardConnectivityAwsIot;
+using namespace Aws::Crt;
+
+bool
+AwsIotSharedClient::init( const std::string &privateKey,
+                          const std::string &certificate,
+                          const std::string &endpointUrl,
+                          Aws::Crt::Io::ClientBootstrap *clientBootstrap )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    if ( privateKey.empty() || certificate.empty() || endpointUrl.empty() )
+    {
+        mLogger.error( "AwsIotSharedClient::init", " Please provide X.509 Certificate, private Key and endpoint" );
+        return false;
+    }
+    if ( ( clientBootstrap == nullptr ) || !( *clientBootstrap ) )
+    {
+        mLogger.error( "AwsIotSharedClient::init", " ClientBootstrap failed with error " );
+        return false;
+    }
+    // The key material is copied into the TLS context by Build, so the cursors only need to live until then
+    Aws::Iot::MqttClientConnectionConfigBuilder builder( Crt::ByteCursorFromCString( certificate.c_str() ),
+                                                         Crt::ByteCursorFromCString( privateKey.c_str() ) );
+    builder.WithEndpoint( endpointUrl.c_str() );
+
+    TraceModule::get().sectionBegin( TraceSection::BUILD_MQTT );
+    auto clientConfig = std::make_unique<Aws::Iot::MqttClientConnectionConfig>( builder.Build() );
+    TraceModule::get().sectionEnd( TraceSection::BUILD_MQTT );
+    if ( !( *clientConfig ) )
+    {
+        mLogger.error( "AwsIotSharedClient::init", "Client Configuration initialization failed with error" );
+        mLogger.error( "AwsIotSharedClient::init", ErrorDebugString( clientConfig->LastError() ) );
+        return false;
+    }
+    auto mqttClient = std::make_unique<Aws::Iot::MqttClient>( *clientBootstrap );
+    if ( !( *mqttClient ) )
+    {
+        mLogger.error( "AwsIotSharedClient::init", "MQTT Client Creation failed with error" );
+        mLogger.error( "AwsIotSharedClient::init", ErrorDebugString( mqttClient->LastError() ) );
+        return false;
+    }
+    mClientConfig = std::move( clientConfig );
+    mMqttClient = std::move( mqttClient );
+    return true;
+}
+
+std::shared_ptr<Aws::Crt::Mqtt::MqttConnection>
+AwsIotSharedClient::newConnection()
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    if ( ( mMqttClient == nullptr ) || ( mClientConfig == nullptr ) )
+    {
+        mLogger.error( "AwsIotSharedClient::newConnection", " Shared client is not initialized" );
+        return nullptr;
+    }
+    auto connection = mMqttClient->NewConnection( *mClientConfig );
+    if ( !connection )
+    {
+        mLogger.error( "AwsIotSharedClient::newConnection",
+                       "MQTT Connection Creation failed with error " +
+                           std::string( ErrorDebugString( mMqttClient->LastError() ) ) );
+        return nullptr;
+    }
+    return connection;
+}
@@ -0,0 +1,201 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "LinkMonitor.h"
+#include <cerrno>
+#include <cstring>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <net/if.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace Aws::IoTFleetWise::OffboardConnectivityAwsIot;
+
+constexpr uint32_t LinkMonitor::POLL_TIMEOUT_MS;
+constexpr size_t LinkMonitor::RECEIVE_BUFFER_SIZE;
+
+namespace
+{
+bool
+isRunning( unsigned int flags )
+{
+    // IFF_RUNNING follows the operational state, i.e. the carrier of the modem
+    return ( ( flags & IFF_UP ) != 0U ) && ( ( flags & IFF_RUNNING ) != 0U );
+}
+
+// Reads the current state, so that only changes after the start are reported
+bool
+readLinkState( const std::string &interfaceName )
+{
+    int fd = socket( AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0 );
+    if ( fd < 0 )
+    {
+        return false;
+    }
+    struct ifreq request = {};
+    strncpy( request.ifr_name, interfaceName.c_str(), IFNAMSIZ - 1 );
+    bool linkUp = false;
+    if ( ioctl( fd, SIOCGIFFLAGS, &request ) == 0 )
+    {
+        linkUp = isRunning( static_cast<unsigned short>( request.ifr_flags ) );
+    }
+    close( fd );
+    return linkUp;
+}
+} // namespace
+
+LinkMonitor::LinkMonitor( std::string interfaceName, LinkUpCallback onLinkUp )
+    : mInterfaceName( std::move( interfaceName ) )
+    , mOnLinkUp( std::move( onLinkUp ) )
+{
+}
+
+LinkMonitor::~LinkMonitor()
+{
+    if ( isAlive() )
+    {
+        stop();
+    }
+}
+
+bool
+LinkMonitor::start()
+{
+    // Prevent concurrent stop/init
+    std::lock_guard<std::mutex> lock( mThreadMutex );
+    mSocket = socket( AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE );
+    if ( mSocket < 0 )
+    {
+        mLogger.error( "LinkMonitor::start", " Failed to open the netlink socket " );
+        return false;
+    }
+    struct sockaddr_nl address = {};
+    address.nl_family = AF_NETLINK;
+    address.nl_groups = RTMGRP_LINK;
+    if ( bind( mSocket, reinterpret_cast<struct sockaddr *>( &address ), sizeof( address ) ) != 0 )
+    {
+        mLogger.error( "LinkMonitor::start", " Failed to subscribe to the link messages " );
+        close( mSocket );
+        mSocket = -1;
+        return false;
+    }
+    mLinkUp = readLinkState( mInterfaceName );
+    // On multi core systems the shared variable mShouldStop must be updated for
+    // all cores before starting the thread otherwise thread will directly end
+    mShouldStop.store( false );
+    if ( !mThread.create( doWork, this, "fwCNLinkMon" ) )
+    {
+        mLogger.error( "LinkMonitor::start", " Link Monitor Thread failed to start " );
+        close( mSocket );
+        mSocket = -1;
+        return false;
+    }
+    mLogger.info( "LinkMonitor::start",
+                  " Monitoring the link of " + mInterfaceName + ", currently " + ( mLinkUp ? "up" : "down" ) );
+    return true;
+}
+
+bool
+LinkMonitor::stop()
+{
+    std::lock_guard<std::mutex> lock( mThreadMutex );
+    mShouldStop.store( true );
+    mThread.release();
+    mShouldStop.store( false, std::memory_order_relaxed );
+    if ( mSocket >= 0 )
+    {
+        close( mSocket );
+        mSocket = -1;
+    }
+    mLogger.trace( "LinkMonitor::stop", " Link Monitor Thread stopped " );
+    return !mThread.isActive();
+}
+
+bool
+LinkMonitor::isAlive()
+{
+    return mThread.isValid() && mThread.isActive();
+}
+
+void
+LinkMonitor::doWork( void *data )
+{
+    auto *monitor = static_cast<LinkMonitor *>( data );
+    std::vector<uint8_t> buffer( RECEIVE_BUFFER_SIZE );
+    struct pollfd pollFd = {};
+    pollFd.fd = monitor->mSocket;
+    pollFd.events = POLLIN;
+    while ( !monitor->mShouldStop )
+    {
+        if ( poll( &pollFd, 1, static_cast<int>( POLL_TIMEOUT_MS ) ) <= 0 )
+        {
+            continue;
+        }
+        auto received = recv( monitor->mSocket, buffer.data(), buffer.size(), MSG_DONTWAIT );
+        if ( received > 0 )
+        {
+            monitor->handleMessages( buffer.data(), static_cast<size_t>( received ) );
+        }
+        else if ( ( received < 0 ) && ( errno == ENOBUFS ) )
+        {
+            // Messages were dropped by the kernel, the state is read again instead
+            monitor->updateLinkState( readLinkState( monitor->mInterfaceName ) );
+        }
+    }
+}
+
+void
+LinkMonitor::handleMessages( const uint8_t *buffer, size_t size )
+{
+    auto remaining = static_cast<int>( size );
+    for ( auto *header = reinterpret_cast<const struct nlmsghdr *>( buffer ); NLMSG_OK( header, remaining );
+          header = NLMSG_NEXT( header, remaining ) )
+    {
+        if ( ( header->nlmsg_type != RTM_NEWLINK ) && ( header->nlmsg_type != RTM_DELLINK ) )
+        {
+            continue;
+        }
+        const auto *info = static_cast<const struct ifinfomsg *>( NLMSG_DATA( header ) );
+        auto attributesSize = static_cast<int>( IFLA_PAYLOAD( header ) );
+        for ( auto *attribute = IFLA_RTA( info ); RTA_OK( attribute, attributesSize );
+              attribute = RTA_NEXT( attribute, attributesSize ) )
+        {
+            if ( ( attribute->rta_type == IFLA_IFNAME ) &&
+                 ( mInterfaceName == static_cast<const char *>( RTA_DATA( attribute ) ) ) )
+            {
+                updateLinkState( ( header->nlmsg_type == RTM_NEWLINK ) && isRunning( info->ifi_flags ) );
+                break;
+            }
+        }
+    }
+}
+
+void
+LinkMonitor::updateLinkState( bool linkUp )
+{
+    bool wasUp = mLinkUp.exchange( linkUp );
+    if ( wasUp == linkUp )
+    {
+        return;
+    }
+    mLogger.info( "LinkMonitor::updateLinkState", " Link of " + mInterfaceName + ( linkUp ? " up" : " down" ) );
+    if ( linkUp && ( mOnLinkUp != nullptr ) )
+    {
+        mOnLinkUp();
+    }
+}
@@ -0,0 +1,244 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "MetricsEncoder.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace OffboardConnectivity
+{
+
+constexpr uint8_t MetricsEncoder::FORMAT_VERSION;
+constexpr uint8_t MetricsEncoder::RECORD_DEFINITION;
+constexpr uint8_t MetricsEncoder::RECORD_SAMPLES;
+
+MetricsEncoder::MetricsEncoder( size_t maxSeries, size_t maxSamplesPerSeries )
+    : mMaxSeries( maxSeries )
+    , mMaxSamplesPerSeries( maxSamplesPerSeries )
+{
+}
+
+void
+MetricsEncoder::setSeriesPrefixes( std::vector<std::string> prefixes )
+{
+    mPrefixes = std::move( prefixes );
+}
+
+bool
+MetricsEncoder::matchesPrefixes( const std::string &name ) const
+{
+    if ( mPrefixes.empty() )
+    {
+        return true;
+    }
+    return std::any_of( mPrefixes.begin(), mPrefixes.end(), [&name]( const std::string &prefix ) {
+        return name.compare( 0, prefix.size(), prefix ) == 0;
+    } );
+}
+
+bool
+MetricsEncoder::registerSeries( const std::string &name, const std::string &unit, uint32_t scale )
+{
+    auto it = mSeriesIds.find( name );
+    if ( it != mSeriesIds.end() )
+    {
+        auto &series = mSeries[it->second];
+        if ( ( series.unit != unit ) || ( series.scale != std::max( 1U, scale ) ) )
+        {
+            // The samples so far were scaled with the old definition
+            series.unit = unit;
+            series.scale = std::max( 1U, scale );
+            series.definitionPending = true;
+            mPendingSampleCount -= series.samples.size();
+            series.samples.clear();
+        }
+        return true;
+    }
+    if ( mSeries.size() >= mMaxSeries )
+    {
+        return false;
+    }
+    Series series;
+    series.name = name;
+    series.unit = unit;
+    series.scale = std::max( 1U, scale );
+    mSeriesIds[name] = static_cast<uint32_t>( mSeries.size() );
+    mSeries.emplace_back( std::move( series ) );
+    return true;
+}
+
+int64_t
+MetricsEncoder::scaleValue( double value, uint32_t scale )
+{
+    auto scaled = value * static_cast<double>( scale );
+    if ( std::isnan( scaled ) )
+    {
+        return 0;
+    }
+    // Saturate, half of the range so that the difference of two values does not overflow
+    const auto limit = static_cast<double>( std::numeric_limits<int64_t>::max() / 2 );
+    return static_cast<int64_t>( std::llround( std::max( -limit, std::min( limit, scaled ) ) ) );
+}
+
+bool
+MetricsEncoder::addSample( const std::string &name, Timestamp time, double value, const std::string &unit )
+{
+    auto it = mSeriesIds.find( name );
+    if ( it == mSeriesIds.end() )
+    {
+        if ( ( !matchesPrefixes( name ) ) || ( !registerSeries( name, unit ) ) )
+        {
+            return false;
+        }
+        it = mSeriesIds.find( name );
+    }
+    auto &series = mSeries[it->second];
+    if ( series.samples.size() >= mMaxSamplesPerSeries )
+    {
+        return false;
+    }
+    // The time deltas are unsigned, a sample older than the previous one gets the time of the previous one
+    if ( ( !series.samples.empty() ) && ( time < series.samples.back().time ) )
+    {
+        time = series.samples.back().time;
+    }
+    series.samples.push_back( Sample{ time, scaleValue( value, series.scale ) } );
+    mPendingSampleCount++;
+    return true;
+}
+
+void
+MetricsEncoder::resendDefinitions()
+{
+    for ( auto &series : mSeries )
+    {
+        series.definitionPending = true;
+    }
+}
+
+void
+MetricsEncoder::appendVarint( uint64_t value, std::vector<uint8_t> &buffer )
+{
+    while ( value >= 0x80U )
+    {
+        buffer.push_back( static_cast<uint8_t>( value | 0x80U ) );
+        value >>= 7U;
+    }
+    buffer.push_back( static_cast<uint8_t>( value ) );
+}
+
+void
+MetricsEncoder::appendZigzag( int64_t value, std::vector<uint8_t> &buffer )
+{
+    appendVarint( ( static_cast<uint64_t>( value ) << 1U ) ^ static_cast<uint64_t>( value >> 63 ), buffer );
+}
+
+void
+MetricsEncoder::appendString( const std::string &value, std::vector<uint8_t> &buffer )
+{
+    appendVarint( value.size(), buffer );
+    buffer.insert( buffer.end(), value.begin(), value.end() );
+}
+
+bool
+MetricsEncoder::encode( const std::string &prefix, size_t maxBytes, std::vector<uint8_t> &payload )
+{
+    Timestamp baseTime = std::numeric_limits<Timestamp>::max();
+    for ( const auto &series : mSeries )
+    {
+        if ( !series.samples.empty() )
+        {
+            baseTime = std::min( baseTime, series.samples.front().time );
+        }
+    }
+    if ( baseTime == std::numeric_limits<Timestamp>::max() )
+    {
+        baseTime = 0;
+    }
+
+    payload.clear();
+    payload.push_back( 'F' );
+    payload.push_back( 'W' );
+    payload.push_back( 'M' );
+    payload.push_back( FORMAT_VERSION );
+    appendString( prefix, payload );
+    appendVarint( baseTime, payload );
+    const auto headerSize = payload.size();
+
+    bool pending = false;
+    std::vector<uint8_t> records;
+    for ( uint32_t seriesId = 0; seriesId < mSeries.size(); seriesId++ )
+    {
+        auto &series = mSeries[seriesId];
+        if ( ( !series.definitionPending ) && series.samples.empty() )
+        {
+            continue;
+        }
+        records.clear();
+        if ( series.definitionPending )
+        {
+            records.push_back( RECORD_DEFINITION );
+            appendVarint( seriesId, records );
+            appendVarint( series.scale, records );
+            appendString( series.name, records );
+            appendString( series.unit, records );
+        }
+        const auto definitionSize = records.size();
+        if ( !series.samples.empty() )
+        {
+            records.push_back( RECORD_SAMPLES );
+            appendVarint( seriesId, records );
+            appendVarint( series.samples.size(), records );
+            Timestamp previousTime = baseTime;
+            int64_t previousValue = 0;
+            for ( const auto &sample : series.samples )
+            {
+                appendVarint( sample.time - previousTime, records );
+                appendZigzag( sample.value - previousValue, records );
+                previousTime = sample.time;
+                previousValue = sample.value;
+            }
+        }
+        if ( payload.size() + records.size() > maxBytes )
+        {
+            if ( ( payload.size() == headerSize ) && ( headerSize + definitionSize <= maxBytes ) )
+            {
+                // The samples of this series never fit in a payload, so they are dropped to not block the others
+                records.resize( definitionSize );
+                mPendingSampleCount -= series.samples.size();
+                series.samples.clear();
+            }
+            else
+            {
+                pending = true;
+                continue;
+            }
+        }
+        payload.insert( payload.end(), records.begin(), records.end() );
+        series.definitionPending = false;
+        mPendingSampleCount -= series.samples.size();
+        series.samples.clear();
+    }
+    // If not even one series fits, the next payload would not be different
+    return pending && ( payload.size() > headerSize );
+}
+
+} // namespace OffboardConnectivity
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -12,8 +12,13 @@
  */
 
 #include "PayloadManager.h"
+#include "ClockHandler.h"
 #include "TraceModule.h"
+#include "UplinkAccounting.h"
+#include <algorithm>
+#include <cstdint>
 #include <cstring>
+#include <iterator>
 #include <memory>
 #include <sstream>
 
@@ -26,10 +31,7 @@ PayloadManager::PayloadManager( std::shared_ptr<CacheAndPersist> persistencyPtr
 }
 
 bool
-PayloadManager::preparePayload( uint8_t *const buf,
-                                size_t size,
-                                const std::string &data,
-                                const struct CollectionSchemeParams &collectionSchemeParams )
+PayloadManager::preparePayload( uint8_t *const buf, size_t size, size_t dataSize, uint8_t flags )
 {
     if ( buf == nullptr )
     {
@@ -42,7 +44,7 @@ PayloadManager::preparePayload( uint8_t *const buf,
     PayloadHeader payloadHdr = {};
     size_t hdrSize = sizeof( PayloadHeader );
 
-    if ( size < ( data.size() + hdrSize ) )
+    if ( size < ( dataSize + hdrSize ) )
     {
         TraceModule::get().incrementVariable( TraceVariable::PM_MEMORY_INSUFFICIENT );
         mLogger.error( "PayloadManager::preparePayload", "Payload Buffer size not sufficient" );
@@ -50,154 +52,434 @@ PayloadManager::preparePayload( uint8_t *const buf,
     }
 
     // Add a payload header before writing to the file
-    payloadHdr.size = data.size();
-    payloadHdr.compressionRequired = collectionSchemeParams.compression;
+    payloadHdr.size = dataSize;
+    payloadHdr.flags = flags;
 
     memcpy( &buf[0], &payloadHdr, hdrSize );
-    memcpy( reinterpret_cast<char *>( &buf[hdrSize] ), data.data(), payloadHdr.size );
 
     return true;
 }
 
+bool
+PayloadManager::appendPayload( std::vector<uint8_t> &record,
+                               const std::uint8_t *buf,
+                               size_t size,
+                               const struct CollectionSchemeParams &collectionSchemeParams )
+{
+    if ( buf == nullptr )
+    {
+        TraceModule::get().incrementVariable( TraceVariable::PM_MEMORY_NULL );
+        mLogger.error( "PayloadManager::appendPayload", "Payload provided is empty" );
+        return false;
+    }
+    // The payload is compressed or copied straight behind its header in the record written to disk
+    size_t hdrPos = record.size();
+    size_t hdrSize = sizeof( PayloadHeader );
+    size_t dataSize = size;
+    uint8_t flags = 0;
+    if ( collectionSchemeParams.compression )
+    {
+        flags = PAYLOAD_COMPRESSION_REQUIRED;
+    }
+    else if ( mDeferredCompression )
+    {
+        // Compressed later by compactSegment, so storing adds no latency
+        flags = PAYLOAD_STORED_UNCOMPRESSED;
+    }
+    // if compression was not specified in the collectionScheme, DCSender did not compress
+    // compress it anyway for storage
+    if ( flags == 0U )
+    {
+        mLogger.trace( "PayloadManager::appendPayload",
+                       "CollectionScheme does not activate compression, but will apply compression for local "
+                       "persistency anyway" );
+        record.resize( hdrPos + hdrSize + snappy::MaxCompressedLength( size ) );
+        snappy::RawCompress( reinterpret_cast<const char *>( buf ),
+                             size,
+                             reinterpret_cast<char *>( &record[hdrPos + hdrSize] ),
+                             &dataSize );
+        if ( dataSize == 0U )
+        {
+            record.resize( hdrPos );
+            TraceModule::get().incrementVariable( TraceVariable::PM_COMPRESS_ERROR );
+            mLogger.error( "PayloadManager::appendPayload",
+                           "Error occurred when compressing the payload. The payload is likely corrupted." );
+            return false;
+        }
+    }
+    else
+    {
+        // the payload was already compressed or its compression is deferred
+        record.resize( hdrPos + hdrSize + size );
+        memcpy( &record[hdrPos + hdrSize], buf, size );
+    }
+    record.resize( hdrPos + hdrSize + dataSize );
+
+    // Add metadata to the payload before storage
+    if ( !preparePayload( &record[hdrPos], hdrSize + dataSize, dataSize, flags ) )
+    {
+        record.resize( hdrPos );
+        mLogger.error( "PayloadManager::appendPayload", "Error occurred during payload preparation" );
+        return false;
+    }
+    return true;
+}
+
+bool
+PayloadManager::writeRecord( const std::vector<uint8_t> &record,
+                             const struct CollectionSchemeParams &collectionSchemeParams )
+{
+    SegmentedLog::RecordInfo info{};
+    info.priority = collectionSchemeParams.priority;
+    info.timestampMs = ClockHandler::getClock()->timeSinceEpochMs();
+    ErrorCode status = mPersistencyPtr->writeCollectedData( record.data(), record.size(), info );
+    if ( status != ErrorCode::SUCCESS )
+    {
+        TraceModule::get().incrementVariable( TraceVariable::PM_STORE_ERROR );
+        mLogger.error( "PayloadManager::writeRecord", "Failed to persist data on disk" );
+        return false;
+    }
+    UplinkAccounting::get().add( collectionSchemeParams.accountId, UplinkCounter::PERSISTED_BYTES, record.size() );
+    mLogger.trace( "PayloadManager::writeRecord",
+                   "Record of size : " + std::to_string( record.size() ) + " Bytes has been successfully persisted" );
+    return true;
+}
+
 bool
 PayloadManager::storeData( const std::uint8_t *buf,
                            size_t size,
                            const struct CollectionSchemeParams &collectionSchemeParams )
 {
-    bool isDataPersisted = false;
-    if ( collectionSchemeParams.persist )
+    if ( !collectionSchemeParams.persist )
     {
-        mLogger.trace( "PayloadManager::storeData", "The schema activates data persistency" );
+        mLogger.trace( "PayloadManager::storeData", "CollectionScheme does not activate persistency on disk" );
+        return false;
+    }
+    mLogger.trace( "PayloadManager::storeData", "The schema activates data persistency" );
+    std::vector<uint8_t> record;
+    return appendPayload( record, buf, size, collectionSchemeParams ) && writeRecord( record, collectionSchemeParams );
+}
 
-        std::string payload( reinterpret_cast<const char *>( buf ), size );
-        std::string compressedData;
-        // if compression was not specified in the collectionScheme, DCSender did not compress
-        // compress it anyway for storage
-        if ( !collectionSchemeParams.compression )
+bool
+PayloadManager::storeBatch( const std::vector<PayloadBufferPtr> &payloads,
+                            const struct CollectionSchemeParams &collectionSchemeParams )
+{
+    if ( !collectionSchemeParams.persist )
+    {
+        mLogger.trace( "PayloadManager::storeBatch", "CollectionScheme does not activate persistency on disk" );
+        return false;
+    }
+    std::vector<uint8_t> record;
+    size_t maxRecordSize = 0;
+    for ( const auto &payload : payloads )
+    {
+        if ( payload != nullptr )
         {
-            mLogger.trace( "PayloadManager::storeData",
-                           "CollectionScheme does not activate compression, but will apply compression for local "
-                           "persistency anyway" );
-            if ( snappy::Compress( payload.data(), payload.size(), &compressedData ) == 0u )
-            {
-                TraceModule::get().incrementVariable( TraceVariable::PM_COMPRESS_ERROR );
-                mLogger.error( "PayloadManager::storeData",
-                               "Error occurred when compressing the payload. The payload is likely corrupted." );
-                return isDataPersisted;
-            }
+            maxRecordSize += sizeof( PayloadHeader ) + snappy::MaxCompressedLength( payload->size() );
         }
-        else
+    }
+    record.reserve( maxRecordSize );
+    for ( const auto &payload : payloads )
+    {
+        if ( ( payload == nullptr ) ||
+             ( !appendPayload( record, payload->data(), payload->size(), collectionSchemeParams ) ) )
         {
-            // the payload was already compressed
-            compressedData = payload;
+            return false;
         }
+    }
+    return ( !record.empty() ) && writeRecord( record, collectionSchemeParams );
+}
 
-        size_t totalWriteSize = compressedData.size() + sizeof( PayloadHeader );
-        // Allocate a bigger buffer to prefix payload header to the payload
-        std::unique_ptr<uint8_t[]> writeBuffer( new uint8_t[totalWriteSize]() );
-        // Add metadata to the payload before storage
-        if ( !preparePayload( writeBuffer.get(), totalWriteSize, compressedData, collectionSchemeParams ) )
+ErrorCode
+PayloadManager::retrieveData( std::vector<PayloadBufferPtr> &data )
+{
+    PersistedPayloadChunk chunk;
+    ErrorCode status = retrieveNext( chunk, SIZE_MAX );
+    if ( status != ErrorCode::SUCCESS )
+    {
+        return status;
+    }
+    while ( status == ErrorCode::SUCCESS )
+    {
+        std::move( chunk.payloads.begin(), chunk.payloads.end(), std::back_inserter( data ) );
+        status = retrieveNext( chunk, SIZE_MAX );
+    }
+    return ( status == ErrorCode::EMPTY ) ? ErrorCode::SUCCESS : status;
+}
+
+bool
+PayloadManager::drainsBefore( uint32_t priority,
+                              uint64_t segmentId,
+                              uint32_t otherPriority,
+                              uint64_t otherSegmentId ) const
+{
+    if ( mDrainPolicy.priorityFirst && ( priority != otherPriority ) )
+    {
+        return priority < otherPriority;
+    }
+    // Segment IDs increase with the time the segments were written
+    return mDrainPolicy.newestFirst ? ( segmentId > otherSegmentId ) : ( segmentId < otherSegmentId );
+}
+
+ErrorCode
+PayloadManager::retrieveNext( PersistedPayloadChunk &chunk, size_t maxBytes )
+{
+    chunk.payloads.clear();
+    std::lock_guard<std::mutex> lock( mCompactionMutex );
+    auto segments = mPersistencyPtr->getCollectedDataSegments();
+    std::sort( segments.begin(),
+               segments.end(),
+               [this]( const SegmentedLog::Segment &a, const SegmentedLog::Segment &b ) {
+                   return drainsBefore( a.priority, a.id, b.priority, b.id );
+               } );
+    for ( const auto &segment : segments )
+    {
+        // Continue behind the previous chunk, skipping the acknowledged data
+        if ( ( chunk.segmentId != 0U ) && ( segment.id != chunk.segmentId ) &&
+             drainsBefore( segment.priority, segment.id, chunk.segmentPriority, chunk.segmentId ) )
         {
-            mLogger.error( "PayloadManager::storeData", "Error occurred during payload preparation" );
-            return isDataPersisted;
+            continue;
+        }
+        size_t pos = segment.acknowledged;
+        if ( segment.id == chunk.segmentId )
+        {
+            pos = std::max( pos, chunk.endOffset );
         }
 
-        ErrorCode status = mPersistencyPtr->write( writeBuffer.get(), totalWriteSize, DataType::EDGE_TO_CLOUD_PAYLOAD );
-
-        if ( status == ErrorCode::SUCCESS )
+        size_t parsedBytes = 0;
+        // The payloads are parsed straight from the mapped segment, each record holds the payloads of one write
+        ErrorCode status = mPersistencyPtr->readCollectedDataRecords(
+            segment.id,
+            pos,
+            [this, &chunk, &parsedBytes, maxBytes]( const uint8_t *buf, size_t size, size_t endOffset ) {
+                std::vector<PayloadBufferPtr> payloads;
+                if ( parsePayloads( buf, size, payloads ) == ErrorCode::SUCCESS )
+                {
+                    for ( auto &payload : payloads )
+                    {
+                        parsedBytes += payload->size();
+                        chunk.payloads.emplace_back( std::move( payload ) );
+                    }
+                }
+                else
+                {
+                    // The record itself is intact, so only its own payloads are skipped
+                    mLogger.warn( "PayloadManager::retrieveNext", "Skipping a persisted record with invalid payloads" );
+                }
+                chunk.endOffset = endOffset;
+                return parsedBytes < maxBytes;
+            } );
+        if ( status == ErrorCode::EMPTY )
         {
-            // set the ErrorCode::SUCCESSful storage flag to true
-            isDataPersisted = true;
-            mLogger.trace( "PayloadManager::storeData",
-                           "Payload of size : " + std::to_string( totalWriteSize ) +
-                               " Bytes (header: " + std::to_string( sizeof( PayloadHeader ) ) +
-                               ") has been ErrorCode::SUCCESSfully persisted" );
+            continue;
         }
-        else
+        chunk.segmentId = segment.id;
+        chunk.segmentPriority = segment.priority;
+        mRetrievedSegmentId = segment.id;
+        if ( status == ErrorCode::INVALID_DATA )
         {
-            TraceModule::get().incrementVariable( TraceVariable::PM_STORE_ERROR );
-            mLogger.error( "PayloadManager::storeData", "Failed to persist data on disk" );
+            if ( !chunk.payloads.empty() )
+            {
+                // The corrupted record is reported with the next chunk
+                return ErrorCode::SUCCESS;
+            }
+            // Nothing behind a corrupted record can be framed, acknowledging the chunk skips the rest of the segment
+            chunk.endOffset = SIZE_MAX;
+            return status;
+        }
+        if ( status != ErrorCode::SUCCESS )
+        {
+            return status;
+        }
+        if ( !chunk.payloads.empty() )
+        {
+            return ErrorCode::SUCCESS;
         }
     }
-    else
-    {
-        mLogger.trace( "PayloadManager::storeData", "CollectionScheme does not activate persistency on disk" );
-    }
-    return isDataPersisted;
+    mRetrievedSegmentId = 0;
+    return ErrorCode::EMPTY;
 }
 
 ErrorCode
-PayloadManager::retrieveData( std::vector<std::string> &data )
+PayloadManager::acknowledge( const PersistedPayloadChunk &chunk )
 {
-    size_t readSize = mPersistencyPtr->getSize( DataType::EDGE_TO_CLOUD_PAYLOAD );
+    return mPersistencyPtr->acknowledgeCollectedData( chunk.segmentId, chunk.endOffset );
+}
 
-    if ( readSize == 0 )
+ErrorCode
+PayloadManager::parsePayloads( const uint8_t *buf, size_t readSize, std::vector<PayloadBufferPtr> &data )
+{
+    size_t pos = 0;
+    while ( pos < readSize )
     {
-        return ErrorCode::EMPTY;
-    }
+        if ( ( readSize - pos ) < sizeof( PayloadHeader ) )
+        {
+            mLogger.error( "PayloadManager::parsePayloads", "Persisted payload header is truncated" );
+            return ErrorCode::INVALID_DATA;
+        }
+        PayloadHeader payloadHdr{};
+        memcpy( &payloadHdr, &buf[pos], sizeof( PayloadHeader ) );
+        size_t payloadPos = pos + sizeof( PayloadHeader );
 
-    // Parsed data will be stored here
-    std::unique_ptr<uint8_t[]> readBuffer( new uint8_t[readSize] );
-    ErrorCode status = mPersistencyPtr->read( readBuffer.get(), readSize, DataType::EDGE_TO_CLOUD_PAYLOAD );
+        // capture the size of the payload, a truncated last payload of legacy data is read up to the record end
+        size_t size = std::min( static_cast<size_t>( payloadHdr.size ), readSize - payloadPos );
+        const auto *stored = reinterpret_cast<const char *>( &buf[payloadPos] );
 
-    if ( status != ErrorCode::SUCCESS )
-    {
-        return status;
+        // Each payload is read into its own buffer, which is then handed over to the sender without copying
+        auto payloadData = mPayloadBufferPool.acquire();
+        if ( ( payloadHdr.flags & ( PAYLOAD_COMPRESSION_REQUIRED | PAYLOAD_STORED_UNCOMPRESSED ) ) != 0U )
+        {
+            payloadData->assign( buf + payloadPos, buf + payloadPos + size );
+        }
+        else if ( ( payloadHdr.flags & PAYLOAD_STORED_WITH_CODEC ) != 0U )
+        {
+            if ( ( !mStorageDecompress ) || ( !mStorageDecompress( &buf[payloadPos], size, *payloadData ) ) )
+            {
+                mLogger.error( "PayloadManager::parsePayloads",
+                               "Error occurred while un-compressing the payload with the storage codec" );
+                return ErrorCode::INVALID_DATA;
+            }
+        }
+        // Since we always compress for storage,
+        // uncompress if the collectionScheme did not require compression
+        else
+        {
+            mLogger.trace( "PayloadManager::parsePayloads",
+                           "CollectionScheme does not require compression, uncompress " + std::to_string( size ) +
+                               " bytes before transmitting the "
+                               "persisted data." );
+            size_t uncompressedSize = 0;
+            bool uncompressed = snappy::GetUncompressedLength( stored, size, &uncompressedSize );
+            if ( uncompressed )
+            {
+                payloadData->resize( uncompressedSize );
+                uncompressed = snappy::RawUncompress( stored, size, reinterpret_cast<char *>( payloadData->data() ) );
+            }
+            if ( !uncompressed )
+            {
+                mLogger.error(
+                    "PayloadManager::parsePayloads",
+                    "Error occurred while un-compressing the payload from disk. The payload is likely corrupted." );
+                return ErrorCode::INVALID_DATA;
+            }
+        }
+
+        data.emplace_back( std::move( payloadData ) );
+        pos = payloadPos + size;
     }
-    else
-    {
-        size_t size = 0U;
-        std::string dataString;
 
-        // Read from the beginning of the buffer
-        size_t pos = 0;
+    return ErrorCode::SUCCESS;
+}
 
-        while ( pos < readSize )
+bool
+PayloadManager::compactRecord( const uint8_t *buf, size_t size, std::vector<uint8_t> &out )
+{
+    bool compressed = false;
+    std::vector<uint8_t> uncompressed;
+    std::vector<uint8_t> compacted;
+    size_t pos = 0;
+    while ( pos < size )
+    {
+        if ( ( size - pos ) < sizeof( PayloadHeader ) )
         {
-            size_t j = 0;
-            PayloadHeader payloadHdr{};
-            memcpy( &payloadHdr, &( readBuffer.get()[pos] ), sizeof( PayloadHeader ) );
-            pos += sizeof( PayloadHeader );
-
-            // capture the size of the payload
-            size = payloadHdr.size;
+            return false;
+        }
+        PayloadHeader payloadHdr{};
+        memcpy( &payloadHdr, &buf[pos], sizeof( PayloadHeader ) );
+        size_t payloadPos = pos + sizeof( PayloadHeader );
+        size_t payloadSize = std::min( static_cast<size_t>( payloadHdr.size ), size - payloadPos );
+        const auto *stored = &buf[payloadPos];
+        pos = payloadPos + payloadSize;
 
-            // Clear the data string before parsing new payload
-            dataString.clear();
-            for ( j = 0; j < size && ( ( pos + j ) < readSize ); ++j )
+        const uint8_t *input = nullptr;
+        size_t inputSize = 0;
+        if ( ( payloadHdr.flags & PAYLOAD_STORED_UNCOMPRESSED ) != 0U )
+        {
+            input = stored;
+            inputSize = payloadSize;
+        }
+        else if ( ( payloadHdr.flags == 0U ) && mStorageCompress )
+        {
+            // Compressed with snappy when stored, the storage codec compresses better
+            size_t uncompressedSize = 0;
+            if ( snappy::GetUncompressedLength(
+                     reinterpret_cast<const char *>( stored ), payloadSize, &uncompressedSize ) )
             {
-                dataString += ( readBuffer.get()[pos + j] ); // NOLINT(clang-diagnostic-sign-conversion)
+                uncompressed.resize( uncompressedSize );
+                if ( snappy::RawUncompress( reinterpret_cast<const char *>( stored ),
+                                            payloadSize,
+                                            reinterpret_cast<char *>( uncompressed.data() ) ) )
+                {
+                    input = uncompressed.data();
+                    inputSize = uncompressed.size();
+                }
             }
+        }
 
-            std::string payloadData;
-            // Since we always compress for storage,
-            // uncompress if the collectionScheme did not require compression
-            if ( !payloadHdr.compressionRequired )
+        PayloadHeader newHdr = payloadHdr;
+        bool compactedPayload = false;
+        if ( input != nullptr )
+        {
+            if ( mStorageCompress )
             {
-                mLogger.trace( "PayloadManager::retrieveData",
-                               "CollectionScheme does not require compression, uncompress " +
-                                   std::to_string( dataString.size() ) +
-                                   " bytes before transmitting the "
-                                   "persisted data." );
-                if ( !snappy::Uncompress( dataString.data(), dataString.size(), &payloadData ) )
-                {
-                    mLogger.error(
-                        "PayloadManager::retrieveData",
-                        "Error occurred while un-compressing the payload from disk. The payload is likely corrupted." );
-                    return ErrorCode::INVALID_DATA;
-                }
+                newHdr.flags = PAYLOAD_STORED_WITH_CODEC;
+                compactedPayload = mStorageCompress( input, inputSize, compacted );
             }
             else
             {
-                payloadData = dataString;
+                newHdr.flags = 0;
+                compacted.resize( snappy::MaxCompressedLength( inputSize ) );
+                size_t compressedSize = 0;
+                snappy::RawCompress( reinterpret_cast<const char *>( input ),
+                                     inputSize,
+                                     reinterpret_cast<char *>( compacted.data() ),
+                                     &compressedSize );
+                compacted.resize( compressedSize );
+                compactedPayload = compressedSize > 0U;
             }
-
-            data.emplace_back( payloadData );
-            pos += j;
         }
+        // Payloads which do not become smaller are kept as they are
+        compactedPayload = compactedPayload && ( compacted.size() < payloadSize );
+        size_t hdrPos = out.size();
+        out.resize( hdrPos + sizeof( PayloadHeader ) );
+        if ( compactedPayload )
+        {
+            newHdr.size = compacted.size();
+            out.insert( out.end(), compacted.begin(), compacted.end() );
+            compressed = true;
+        }
+        else
+        {
+            newHdr = payloadHdr;
+            newHdr.size = payloadSize;
+            out.insert( out.end(), stored, stored + payloadSize );
+        }
+        memcpy( &out[hdrPos], &newHdr, sizeof( PayloadHeader ) );
     }
-    mLogger.info( "PayloadManager::retrieveData",
-                  "Payload of Size : " + std::to_string( readSize ) + " Bytes has been loaded from disk" );
+    return compressed;
+}
 
-    return ErrorCode::SUCCESS;
+ErrorCode
+PayloadManager::compactSegment( uint64_t segmentId, size_t &savedBytes )
+{
+    savedBytes = 0;
+    std::lock_guard<std::mutex> lock( mCompactionMutex );
+    if ( segmentId == mRetrievedSegmentId )
+    {
+        return ErrorCode::EMPTY;
+    }
+    ErrorCode status = mPersistencyPtr->rewriteCollectedDataSegment(
+        segmentId, [this, &savedBytes]( const uint8_t *buf, size_t size, std::vector<uint8_t> &out ) {
+            if ( !compactRecord( buf, size, out ) )
+            {
+                return false;
+            }
+            savedBytes += ( size > out.size() ) ? ( size - out.size() ) : 0U;
+            return true;
+        } );
+    if ( status != ErrorCode::SUCCESS )
+    {
+        savedBytes = 0;
+    }
+    return status;
 }
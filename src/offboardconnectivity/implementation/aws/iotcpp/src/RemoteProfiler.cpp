@@ -12,12 +12,30 @@
  */
 
 #include "RemoteProfiler.h"
+#include "StallWatchdog.h"
 #include "TraceModule.h"
+#include "UplinkAccounting.h"
+#include <cstring>
+#include <snappy.h>
 
 using namespace Aws::IoTFleetWise::OffboardConnectivity;
 
 const char *RemoteProfiler::NAME_TOP_LEVEL_LOG_ARRAY = "LogEvents";
 const char *RemoteProfiler::NAME_TOP_LEVEL_LOG_PREFIX = "Prefix";
+constexpr size_t RemoteProfiler::LOG_RING_CAPACITY;
+constexpr size_t RemoteProfiler::MAX_LOG_FUNCTION_LENGTH;
+constexpr size_t RemoteProfiler::MAX_LOG_ENTRY_LENGTH;
+
+namespace
+{
+void
+copyTruncated( char *destination, const std::string &source, size_t maxLength )
+{
+    auto length = std::min( source.size(), maxLength );
+    std::memcpy( destination, source.data(), length );
+    destination[length] = '\0';
+}
+} // namespace
 
 RemoteProfiler::RemoteProfiler( std::shared_ptr<ISender> metricsSender,
                                 std::shared_ptr<ISender> logSender,
@@ -36,12 +54,16 @@ RemoteProfiler::RemoteProfiler( std::shared_ptr<ISender> metricsSender,
     , fLogLevelThreshold( initialLogLevelThresholdToSend )
     , fProfilerPrefix( std::move( profilerPrefix ) )
     , fCurrentUserPayloadInLogRoot( 0 )
+    , fLogRecords( new LogRecord[LOG_RING_CAPACITY] )
 {
-    std::unique_ptr<ConsoleLogger> consoleLogger( new ConsoleLogger() );
+    for ( size_t i = 0; i < LOG_RING_CAPACITY; i++ )
+    {
+        fLogRecords[i].sequence.store( i, std::memory_order_relaxed );
+    }
     initLogStructure();
     fLastCPURUsage.reportCPUUsageInfo();
     Aws::IoTFleetWise::Platform::Linux::CPUUsageInfo::reportPerThreadUsageData( fLastThreadUsage );
-    fLastTimeExecutionEnvironmentMetricsCollected = fClock->timeSinceEpochMs();
+    fLastTimeExecutionEnvironmentMetricsCollected = FastClock::monotonicTimeMs();
 }
 
 void
@@ -51,6 +73,8 @@ RemoteProfiler::initLogStructure()
     fLogRoot[NAME_TOP_LEVEL_LOG_PREFIX] = fProfilerPrefix;
     fLogRoot[NAME_TOP_LEVEL_LOG_ARRAY] = Json::arrayValue;
     fCurrentUserPayloadInLogRoot = 0;
+    fPendingLogIndex.clear();
+    fPendingLogMessages = 0;
 }
 
 void
@@ -70,69 +94,236 @@ RemoteProfiler::sendMetricsOut()
 }
 
 void
-RemoteProfiler::sendLogsOut()
+RemoteProfiler::sendBinaryMetricsOut()
 {
-    std::string output;
+    if ( ( fBinaryMetricsUploads % BINARY_METRICS_DEFINITIONS_REPEAT_UPLOADS ) == 0 )
     {
-        // No logging in this area as this will deadlock
-        std::lock_guard<std::mutex> lock( loggingMutex );
-        Json::StreamWriterBuilder builder;
-        builder["indentation"] = ""; // If you want whitespace-less output
-        const std::string output = Json::writeString( builder, fLogRoot );
-        initLogStructure();
+        fMetricsEncoder.resendDefinitions();
     }
-
-    if ( fLogSender != nullptr && fCurrentUserPayloadInLogRoot > 0 )
+    fBinaryMetricsUploads++;
+    // Snappy needs up to 32 + n + n / 6 bytes for n bytes in the worst case
+    auto maxSendSize = fMetricsSender->getMaxSendSize();
+    auto maxUncompressedSize = maxSendSize > 32U ? ( ( maxSendSize - 32U ) * 6U ) / 7U : 0U;
+    std::vector<uint8_t> payload;
+    std::string compressedPayload;
+    bool pending = true;
+    while ( pending )
     {
-        auto ret = fLogSender->send( reinterpret_cast<const uint8_t *>( output.c_str() ), output.length() );
+        pending = fMetricsEncoder.encode( fProfilerPrefix, maxUncompressedSize, payload );
+        snappy::Compress( reinterpret_cast<const char *>( payload.data() ), payload.size(), &compressedPayload );
+        auto ret = fMetricsSender->send( reinterpret_cast<const uint8_t *>( compressedPayload.data() ),
+                                         compressedPayload.size() );
         if ( ConnectivityError::Success != ret )
         {
-            fLogger.error( "RemoteProfiler::sendLogsOut",
+            fLogger.error( "RemoteProfiler::sendBinaryMetricsOut",
                            " Send error" + std::to_string( static_cast<uint32_t>( ret ) ) );
+            // The definitions in the lost payload are needed to decode the next ones
+            fMetricsEncoder.resendDefinitions();
+            break;
         }
     }
 }
 
 void
-RemoteProfiler::logMessage( LogLevel level, const std::string &function, const std::string &logEntry )
+RemoteProfiler::sendLogsOut()
 {
-    if ( level < fLogLevelThreshold )
+    if ( ( fLogSender == nullptr ) || ( fCurrentUserPayloadInLogRoot == 0 ) )
     {
+        initLogStructure();
         return;
     }
-    Json::Value logNode;
+    auto droppedLogs = fDroppedLogs.load( std::memory_order_relaxed );
+    if ( droppedLogs != fReportedDroppedLogs )
+    {
+        Json::Value logNode;
+        logNode["logLevel"] = levelToString( LogLevel::Warning );
+        logNode["logFunction"] = "RemoteProfiler::sendLogsOut";
+        logNode["logEntry"] = std::to_string( droppedLogs - fReportedDroppedLogs ) + " log messages were dropped";
+        fLogRoot[NAME_TOP_LEVEL_LOG_ARRAY].append( logNode );
+    }
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = ""; // If you want whitespace-less output
+    std::string output = Json::writeString( builder, fLogRoot );
+    auto messages = fPendingLogMessages;
+    initLogStructure();
 
-    logNode["logLevel"] = levelToString( level );
-    logNode["logFunction"] = function;
-    logNode["logEntry"] = logEntry;
-    uint32_t size = static_cast<uint32_t>( function.length() + logEntry.length() + JSON_MAX_OVERHEAD_BYTES_PER_LOG );
-    bool sendOutBeforeAdding = false;
+    if ( fLogCompression )
+    {
+        std::string compressedOutput;
+        snappy::Compress( output.data(), output.size(), &compressedOutput );
+        output.swap( compressedOutput );
+    }
+    if ( !fLogUplinkLimit.tryConsume( static_cast<double>( output.size() ), FastClock::monotonicTimeMs() ) )
+    {
+        // The dropped messages are reported together with the ones not reported yet by the next batch
+        fDroppedLogs.fetch_add( messages, std::memory_order_relaxed );
+        TraceModule::get().addToAtomicVariable( TraceAtomicVariable::LOG_UPLOAD_DROPPED_MESSAGES, messages );
+        return;
+    }
+    fReportedDroppedLogs = droppedLogs;
+    auto ret = fLogSender->send( reinterpret_cast<const uint8_t *>( output.data() ), output.size() );
+    if ( ConnectivityError::Success != ret )
+    {
+        fLogger.error( "RemoteProfiler::sendLogsOut", " Send error" + std::to_string( static_cast<uint32_t>( ret ) ) );
+    }
+}
+
+void
+RemoteProfiler::logMessage( LogLevel level, const std::string &function, const std::string &logEntry )
+{
+    if ( ( level < fLogLevelThreshold ) || ( fLogSender == nullptr ) )
+    {
+        return;
+    }
+    auto position = fLogEnqueuePosition.load( std::memory_order_relaxed );
+    LogRecord *record = nullptr;
+    for ( ;; )
     {
-        std::lock_guard<std::mutex> lock( loggingMutex );
-        if ( size + fCurrentUserPayloadInLogRoot > MAX_BYTES_FOR_SINGLE_LOG_UPLOAD )
+        record = &fLogRecords[position & ( LOG_RING_CAPACITY - 1 )];
+        auto sequence = record->sequence.load( std::memory_order_acquire );
+        if ( sequence == position )
         {
-            sendOutBeforeAdding = true;
+            // The slot is free, claim it against the other logging threads
+            if ( fLogEnqueuePosition.compare_exchange_weak( position, position + 1, std::memory_order_relaxed ) )
+            {
+                break;
+            }
+        }
+        else if ( sequence < position )
+        {
+            // The profiler thread did not yet take the record of the previous round, the ring is full
+            fDroppedLogs.fetch_add( 1, std::memory_order_relaxed );
+            TraceModule::get().incrementAtomicVariable( TraceAtomicVariable::LOG_UPLOAD_DROPPED_MESSAGES );
+            return;
         }
         else
         {
-            fLogRoot[NAME_TOP_LEVEL_LOG_ARRAY].append( logNode );
-            fCurrentUserPayloadInLogRoot += size;
+            position = fLogEnqueuePosition.load( std::memory_order_relaxed );
         }
     }
-    if ( sendOutBeforeAdding )
+    record->level = level;
+    copyTruncated( record->function, function, MAX_LOG_FUNCTION_LENGTH );
+    copyTruncated( record->logEntry, logEntry, MAX_LOG_ENTRY_LENGTH );
+    record->sequence.store( position + 1, std::memory_order_release );
+    // Wakes up the profiler thread every half ring, so that bursts of messages are not dropped
+    if ( ( position & ( ( LOG_RING_CAPACITY / 2 ) - 1 ) ) == ( ( LOG_RING_CAPACITY / 2 ) - 1 ) )
     {
-        sendLogsOut();
+        fWait.notify();
+    }
+}
+
+void
+RemoteProfiler::takeLogRecords()
+{
+    for ( ;; )
+    {
+        auto &record = fLogRecords[fLogDequeuePosition & ( LOG_RING_CAPACITY - 1 )];
+        if ( record.sequence.load( std::memory_order_acquire ) != fLogDequeuePosition + 1 )
         {
-            std::lock_guard<std::mutex> lock( loggingMutex );
-            fLogRoot[NAME_TOP_LEVEL_LOG_ARRAY].append( logNode );
-            fCurrentUserPayloadInLogRoot += size;
+            break;
         }
+        appendLogMessage( record.level, record.function, record.logEntry );
+        // Hand the slot back to the logging threads for the next round
+        record.sequence.store( fLogDequeuePosition + LOG_RING_CAPACITY, std::memory_order_release );
+        fLogDequeuePosition++;
     }
 }
 
+void
+RemoteProfiler::appendLogMessage( LogLevel level, const char *function, const char *logEntry )
+{
+    std::string key( 1, static_cast<char>( level ) );
+    key.append( function ).append( 1, '\0' ).append( logEntry );
+    auto pending = fPendingLogIndex.find( key );
+    if ( pending != fPendingLogIndex.end() )
+    {
+        auto &logNode = fLogRoot[NAME_TOP_LEVEL_LOG_ARRAY][pending->second];
+        if ( !logNode.isMember( "count" ) )
+        {
+            fCurrentUserPayloadInLogRoot += JSON_MAX_OVERHEAD_BYTES_PER_LOG_COUNT;
+        }
+        logNode["count"] = logNode.get( "count", 1 ).asUInt() + 1U;
+        fPendingLogMessages++;
+        return;
+    }
+    Json::Value logNode;
+    logNode["logLevel"] = levelToString( level );
+    logNode["logFunction"] = function;
+    logNode["logEntry"] = logEntry;
+    appendLogNode( logNode, static_cast<uint32_t>( key.length() + JSON_MAX_OVERHEAD_BYTES_PER_LOG ) );
+    fPendingLogIndex.emplace( std::move( key ), fLogRoot[NAME_TOP_LEVEL_LOG_ARRAY].size() - 1U );
+}
+
+void
+RemoteProfiler::appendLogNode( const Json::Value &logNode, uint32_t size )
+{
+    if ( size + fCurrentUserPayloadInLogRoot > fMaxLogBatchBytes )
+    {
+        sendLogsOut();
+    }
+    fLogRoot[NAME_TOP_LEVEL_LOG_ARRAY].append( logNode );
+    fCurrentUserPayloadInLogRoot += size;
+    fPendingLogMessages++;
+}
+
+void
+RemoteProfiler::appendStallRecords()
+{
+    // The flight recorder of the stall watchdog is uploaded independent of the log level threshold
+    for ( const auto &stallRecord : StallWatchdog::get().takeRecords() )
+    {
+        Json::Value logNode;
+        logNode["logLevel"] = levelToString( LogLevel::Warning );
+        logNode["logFunction"] = "StallWatchdog";
+        logNode["loop"] = stallRecord.loopName;
+        logNode["stage"] = stallRecord.stage;
+        logNode["startTime"] = static_cast<Json::UInt64>( stallRecord.startTimeMs );
+        logNode["durationMs"] = static_cast<Json::UInt64>( stallRecord.durationMs );
+        logNode["ongoing"] = stallRecord.ongoing;
+        appendLogNode( logNode,
+                       static_cast<uint32_t>( stallRecord.loopName.length() + std::strlen( stallRecord.stage ) +
+                                              JSON_MAX_OVERHEAD_BYTES_PER_STALL_RECORD ) );
+    }
+}
+
+void
+RemoteProfiler::enableBinaryMetrics( uint32_t batchUploadIntervalMs, std::vector<std::string> seriesPrefixes )
+{
+    fBinaryMetrics = true;
+    if ( batchUploadIntervalMs > 0 )
+    {
+        fBinaryMetricsBatchInterval = batchUploadIntervalMs;
+    }
+    fMetricsEncoder.setSeriesPrefixes( std::move( seriesPrefixes ) );
+}
+
+void
+RemoteProfiler::enableLogCompression()
+{
+    fLogCompression = true;
+}
+
+void
+RemoteProfiler::setLogUplinkLimit( double bytesPerSecond, double burstBytes )
+{
+    fLogUplinkLimit = TokenBucket( bytesPerSecond, burstBytes, FastClock::monotonicTimeMs() );
+}
+
+bool
+RemoteProfiler::registerMetricsSeries( const std::string &name, const std::string &unit, uint32_t scale )
+{
+    return fMetricsEncoder.registerSeries( name, unit, scale );
+}
+
 void
 RemoteProfiler::setMetric( const std::string &name, double value, const std::string &unit )
 {
+    if ( fBinaryMetrics )
+    {
+        // The prefix is sent once per payload instead of with every name
+        static_cast<void>( fMetricsEncoder.addSample( name, fCurrentSampleTime, value, unit ) );
+        return;
+    }
     if ( fCurrentMetricsPending > MAX_PARALLEL_METRICS )
     {
         sendMetricsOut();
@@ -165,14 +356,24 @@ RemoteProfiler::start()
     // On multi core systems the shared variable fShouldStop must be updated for
     // all cores before starting the thread otherwise thread will directly end
     fShouldStop.store( false );
-    if ( !fThread.create( doWork, this ) )
+    fLastTimeBinaryMetricsSentOut = FastClock::monotonicTimeMs();
+    if ( fLogCompression && ( fLogSender != nullptr ) )
+    {
+        // Snappy needs up to 32 + n + n / 6 bytes for n bytes in the worst case
+        auto maxSendSize = fLogSender->getMaxSendSize();
+        auto maxUncompressedSize = maxSendSize > 32U ? ( ( maxSendSize - 32U ) * 6U ) / 7U : 0U;
+        if ( maxUncompressedSize > MAX_BYTES_FOR_SINGLE_LOG_UPLOAD )
+        {
+            fMaxLogBatchBytes = static_cast<uint32_t>( maxUncompressedSize );
+        }
+    }
+    if ( !fThread.create( doWork, this, "fwCNProfiler" ) )
     {
         fLogger.trace( "RemoteProfiler::start", " Remote Profiler Thread failed to start " );
     }
     else
     {
         fLogger.trace( "RemoteProfiler::start", " Remote Profiler Thread started " );
-        fThread.setThreadName( "fwCNProfiler" );
     }
 
     return fThread.isActive() && fThread.isValid();
@@ -203,7 +404,7 @@ RemoteProfiler::collectExecutionEnvironmentMetrics()
 {
     CPUUsageInfo lastUsage = fLastCPURUsage;
     fLastCPURUsage.reportCPUUsageInfo();
-    Timestamp currentTime = fClock->timeSinceEpochMs();
+    Timestamp currentTime = FastClock::monotonicTimeMs();
     double secondsBetweenCollection =
         static_cast<double>( currentTime - fLastTimeExecutionEnvironmentMetricsCollected ) / 1000.0;
     fLastTimeExecutionEnvironmentMetricsCollected = currentTime;
@@ -214,6 +415,10 @@ RemoteProfiler::collectExecutionEnvironmentMetrics()
     setMetric( "MemoryCurrentResidentRam", static_cast<double>( fMemoryUsage.getResidentMemorySize() ), "Bytes" );
     setMetric( "CpuPercentageSum", totalCPUPercentage, "Percent" );
 
+    if ( !fPerThreadCPUUsageEnabled.load( std::memory_order_relaxed ) )
+    {
+        return;
+    }
     CPUUsageInfo::ThreadCPUUsageInfos threadStatsPrevious = fLastThreadUsage;
     Aws::IoTFleetWise::Platform::Linux::CPUUsageInfo::reportPerThreadUsageData( fLastThreadUsage );
     for ( auto currentThreadCPUUsageInfo : fLastThreadUsage )
@@ -250,19 +455,34 @@ RemoteProfiler::doWork( void *data )
                           profiler->fInitialLogMaxInterval == 0 ? std::numeric_limits<uint32_t>::max()
                                                                 : profiler->fInitialLogMaxInterval ) ) );
         }
-        Timestamp currentTime = profiler->fClock->timeSinceEpochMs();
+        Timestamp currentTime = FastClock::monotonicTimeMs();
         if ( profiler->fShouldStop ||
              ( ( profiler->fLastTimeMetricsSentOut + profiler->fInitialUploadInterval ) < currentTime ) )
         {
             profiler->fLastTimeMetricsSentOut = currentTime;
+            profiler->fCurrentSampleTime = FastClock::systemTimeMs();
             TraceModule::get().forwardAllMetricsToMetricsReceiver( profiler );
+            UplinkAccounting::get().forwardToMetricsReceiver( profiler );
+            MutexContention::get().forwardToMetricsReceiver( profiler );
             profiler->collectExecutionEnvironmentMetrics();
-            profiler->sendMetricsOut();
+            if ( !profiler->fBinaryMetrics )
+            {
+                profiler->sendMetricsOut();
+            }
+            else if ( profiler->fShouldStop ||
+                      ( ( profiler->fLastTimeBinaryMetricsSentOut + profiler->fBinaryMetricsBatchInterval ) <
+                        currentTime ) )
+            {
+                profiler->fLastTimeBinaryMetricsSentOut = currentTime;
+                profiler->sendBinaryMetricsOut();
+            }
         }
+        profiler->takeLogRecords();
         if ( profiler->fShouldStop ||
              ( ( profiler->fLastTimeMLogsSentOut + profiler->fInitialLogMaxInterval ) < currentTime ) )
         {
             profiler->fLastTimeMLogsSentOut = currentTime;
+            profiler->appendStallRecords();
             profiler->sendLogsOut();
         }
     }
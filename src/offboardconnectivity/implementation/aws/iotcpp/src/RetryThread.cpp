@@ -15,78 +15,44 @@
 
 using namespace Aws::IoTFleetWise::OffboardConnectivityAwsIot;
 
-std::atomic<int> RetryThread::fInstanceCounter( 0 );
-
 RetryThread::RetryThread( IRetryable &retryable, uint32_t startBackoffMs, uint32_t maxBackoffMs )
     : fRetryable( retryable )
     , fStartBackoffMs( startBackoffMs )
     , fMaxBackoffMs( maxBackoffMs )
-    , fCurrentWaitTime( 0 )
-    , fShouldStop( false )
+    , fRetryId( 0 )
 {
-    fInstance = fInstanceCounter++;
 }
 
 bool
 RetryThread::start()
 {
     // Prevent concurrent stop/init
-    std::lock_guard<std::mutex> lock( fThreadMutex );
-    // On multi core systems the shared variable fShouldStop must be updated for
-    // all cores before starting the thread otherwise thread will directly end
-    fShouldStop.store( false );
-    if ( !fThread.create( doWork, this ) )
+    std::lock_guard<std::mutex> lock( fMutex );
+    if ( isAlive() )
     {
-        fLogger.trace( "RetryThread::start", " Retry Thread failed to start " );
+        return true;
     }
-    else
+    auto id = RetryScheduler::getInstance().schedule( fRetryable, fStartBackoffMs, fMaxBackoffMs );
+    if ( id == 0U )
     {
-        fLogger.trace( "RetryThread::start", " Retry Thread started " );
-        fThread.setThreadName( "fwCNRetry" + std::to_string( fInstance ) );
+        fLogger.trace( "RetryThread::start", " Retries failed to start " );
+        return false;
     }
-
-    return fThread.isValid();
+    fRetryId.store( id );
+    fLogger.trace( "RetryThread::start", " Retries started " );
+    return true;
 }
 
 bool
 RetryThread::stop()
 {
-    if ( !fThread.isValid() )
+    std::lock_guard<std::mutex> lock( fMutex );
+    auto id = fRetryId.exchange( 0 );
+    if ( id == 0U )
     {
         return true;
     }
-
-    std::lock_guard<std::mutex> lock( fThreadMutex );
-    fShouldStop.store( true );
     fLogger.trace( "RetryThread::stop", " Request stop " );
-    fWait.notify();
-    fThread.release();
-    fShouldStop.store( false, std::memory_order_relaxed );
-    return !fThread.isActive();
+    RetryScheduler::getInstance().cancel( id );
+    return true;
 }
-
-void
-RetryThread::doWork( void *data )
-{
-    RetryThread *retryThread = static_cast<RetryThread *>( data );
-    retryThread->fCurrentWaitTime = retryThread->fStartBackoffMs;
-    while ( !retryThread->fShouldStop )
-    {
-        RetryStatus result = retryThread->fRetryable.attempt();
-        if ( result != RetryStatus::RETRY )
-        {
-            retryThread->fLogger.trace( "RetryThread::doWork",
-                                        " Finished with code " + std::to_string( static_cast<int>( result ) ) );
-            retryThread->fRetryable.onFinished( result );
-            return;
-        }
-        retryThread->fLogger.trace( "RetryThread::doWork",
-                                    " Current retry time is: " + std::to_string( retryThread->fCurrentWaitTime ) );
-        retryThread->fWait.wait( retryThread->fCurrentWaitTime );
-        // exponential backoff
-        retryThread->fCurrentWaitTime = std::min( retryThread->fCurrentWaitTime * 2, retryThread->fMaxBackoffMs );
-    }
-    // If thread is shutdown without succeeding signal abort
-    retryThread->fLogger.trace( "RetryThread::doWork", " Stop thread with ABORT" );
-    retryThread->fRetryable.onFinished( RetryStatus::ABORT );
-}
\ No newline at end of file
@@ -0,0 +1,298 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "UploadShaper.h"
+#include <algorithm>
+#include <iterator>
+
+using namespace Aws::IoTFleetWise::OffboardConnectivityAwsIot;
+
+constexpr size_t UploadShaper::DEFAULT_MAX_QUEUED_BYTES;
+
+UploadShaper::UploadShaper( const UploadRateLimit &linkLimit, size_t maxQueuedBytes, size_t maxInFlightPublishes )
+    : mMaxQueuedBytes( maxQueuedBytes )
+    , mMaxInFlightPublishes( maxInFlightPublishes )
+{
+    auto nowMs = FastClock::monotonicTimeMs();
+    mLink.mBytes = TokenBucket( linkLimit.bytesPerSecond, linkLimit.burstBytes, nowMs );
+    mLink.mPublishes = TokenBucket( linkLimit.publishesPerSecond, linkLimit.burstPublishes, nowMs );
+}
+
+UploadShaper::~UploadShaper()
+{
+    // To make sure the thread stops during teardown of tests.
+    if ( isAlive() )
+    {
+        stop();
+    }
+}
+
+size_t
+UploadShaper::addTopic( const UploadRateLimit &topicLimit )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    auto nowMs = FastClock::monotonicTimeMs();
+    Topic topic;
+    topic.mBytes = TokenBucket( topicLimit.bytesPerSecond, topicLimit.burstBytes, nowMs );
+    topic.mPublishes = TokenBucket( topicLimit.publishesPerSecond, topicLimit.burstPublishes, nowMs );
+    mTopics.emplace_back( std::move( topic ) );
+    return mTopics.size() - 1U;
+}
+
+void
+UploadShaper::setLimit( Topic &topic, const UploadRateLimit &limit, Timestamp nowMs )
+{
+    topic.mBytes.setRate( limit.bytesPerSecond, limit.burstBytes, nowMs );
+    topic.mPublishes.setRate( limit.publishesPerSecond, limit.burstPublishes, nowMs );
+}
+
+void
+UploadShaper::setLinkLimit( const UploadRateLimit &linkLimit )
+{
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        setLimit( mLink, linkLimit, FastClock::monotonicTimeMs() );
+    }
+    // The thread may wait for tokens at the old rate
+    mWait.notify();
+}
+
+bool
+UploadShaper::setTopicLimit( size_t topic, const UploadRateLimit &topicLimit )
+{
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        if ( topic >= mTopics.size() )
+        {
+            return false;
+        }
+        setLimit( mTopics[topic], topicLimit, FastClock::monotonicTimeMs() );
+    }
+    mWait.notify();
+    return true;
+}
+
+uint32_t
+UploadShaper::getWaitTimeMs( Topic &topic, size_t bytes, Timestamp nowMs )
+{
+    auto size = static_cast<double>( bytes );
+    return std::max( { topic.mBytes.getWaitTimeMs( size, nowMs ),
+                       topic.mPublishes.getWaitTimeMs( 1.0, nowMs ),
+                       mLink.mBytes.getWaitTimeMs( size, nowMs ),
+                       mLink.mPublishes.getWaitTimeMs( 1.0, nowMs ) } );
+}
+
+void
+UploadShaper::consume( Topic &topic, size_t bytes, Timestamp nowMs )
+{
+    auto size = static_cast<double>( bytes );
+    topic.mBytes.consume( size, nowMs );
+    topic.mPublishes.consume( 1.0, nowMs );
+    mLink.mBytes.consume( size, nowMs );
+    mLink.mPublishes.consume( 1.0, nowMs );
+}
+
+bool
+UploadShaper::tryAcquire( size_t topicIndex, size_t bytes )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    auto &topic = mTopics[topicIndex];
+    // Queued publishes of the topic go first
+    if ( ( !topic.mQueue.empty() ) || topic.mPublishing || isWindowFull() )
+    {
+        return false;
+    }
+    auto nowMs = FastClock::monotonicTimeMs();
+    if ( getWaitTimeMs( topic, bytes, nowMs ) > 0U )
+    {
+        return false;
+    }
+    consume( topic, bytes, nowMs );
+    mInFlightPublishes++;
+    return true;
+}
+
+bool
+UploadShaper::schedule( size_t topicIndex, size_t bytes, PublishFunction publish )
+{
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        if ( ( mQueuedBytes + bytes ) > mMaxQueuedBytes )
+        {
+            mLogger.warn( "UploadShaper::schedule",
+                          "Upload queue is full with " + std::to_string( mQueuedBytes ) + " bytes" );
+            return false;
+        }
+        mTopics[topicIndex].mQueue.push_back( ScheduledPublish{ bytes, std::move( publish ) } );
+        mQueuedBytes += bytes;
+    }
+    mWait.notify();
+    return true;
+}
+
+bool
+UploadShaper::takeNextPublish( Timestamp nowMs, size_t &topicIndex, ScheduledPublish &publish, uint32_t &waitTimeMs )
+{
+    waitTimeMs = Signal::WaitWithPredicate;
+    // Wait for publishCompleted()
+    if ( isWindowFull() )
+    {
+        return false;
+    }
+    for ( size_t i = 0; i < mTopics.size(); i++ )
+    {
+        auto index = ( mNextTopic + i ) % mTopics.size();
+        auto &topic = mTopics[index];
+        if ( topic.mQueue.empty() || topic.mPublishing )
+        {
+            continue;
+        }
+        auto topicWaitTimeMs = getWaitTimeMs( topic, topic.mQueue.front().mBytes, nowMs );
+        if ( topicWaitTimeMs > 0U )
+        {
+            waitTimeMs = std::min( waitTimeMs, topicWaitTimeMs );
+            continue;
+        }
+        publish = std::move( topic.mQueue.front() );
+        topic.mQueue.pop_front();
+        topic.mPublishing = true;
+        mQueuedBytes -= publish.mBytes;
+        consume( topic, publish.mBytes, nowMs );
+        mInFlightPublishes++;
+        topicIndex = index;
+        // Round robin, so one busy topic does not starve the others
+        mNextTopic = ( index + 1U ) % mTopics.size();
+        return true;
+    }
+    return false;
+}
+
+void
+UploadShaper::publishDone( size_t topicIndex )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    mTopics[topicIndex].mPublishing = false;
+}
+
+void
+UploadShaper::publishCompleted()
+{
+    bool wasFull = false;
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        if ( mInFlightPublishes == 0U )
+        {
+            return;
+        }
+        wasFull = isWindowFull();
+        mInFlightPublishes--;
+    }
+    if ( wasFull )
+    {
+        mWait.notify();
+    }
+}
+
+bool
+UploadShaper::start()
+{
+    // Prevent concurrent stop/init
+    std::lock_guard<std::mutex> lock( mThreadMutex );
+    // On multi core systems the shared variable mShouldStop must be updated for
+    // all cores before starting the thread otherwise thread will directly end
+    mShouldStop.store( false );
+    if ( !mThread.create( doWork, this, "fwCNShaper" ) )
+    {
+        mLogger.error( "UploadShaper::start", " Upload Shaper Thread failed to start " );
+        return false;
+    }
+    mLogger.trace( "UploadShaper::start", " Upload Shaper Thread started " );
+    return true;
+}
+
+bool
+UploadShaper::stop()
+{
+    std::lock_guard<std::mutex> lock( mThreadMutex );
+    mShouldStop.store( true );
+    mWait.notify();
+    mThread.release();
+    mShouldStop.store( false, std::memory_order_relaxed );
+    mLogger.trace( "UploadShaper::stop", " Upload Shaper Thread stopped " );
+    return !mThread.isActive();
+}
+
+bool
+UploadShaper::isAlive()
+{
+    return mThread.isValid() && mThread.isActive();
+}
+
+size_t
+UploadShaper::getQueuedBytes() const
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    return mQueuedBytes;
+}
+
+size_t
+UploadShaper::getInFlightPublishes() const
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    return mInFlightPublishes;
+}
+
+void
+UploadShaper::doWork( void *data )
+{
+    auto *shaper = static_cast<UploadShaper *>( data );
+    while ( !shaper->mShouldStop )
+    {
+        size_t topicIndex = 0;
+        ScheduledPublish publish;
+        uint32_t waitTimeMs = 0;
+        bool ready = false;
+        {
+            std::lock_guard<std::mutex> lock( shaper->mMutex );
+            ready = shaper->takeNextPublish( FastClock::monotonicTimeMs(), topicIndex, publish, waitTimeMs );
+        }
+        if ( ready )
+        {
+            // Called without the lock, as the publish can schedule again
+            publish.mPublish();
+            shaper->publishDone( topicIndex );
+        }
+        else
+        {
+            shaper->mWait.wait( waitTimeMs );
+        }
+    }
+    // Hand over the remaining publishes regardless of the rate, so that they can be persisted if needed
+    std::vector<ScheduledPublish> remaining;
+    {
+        std::lock_guard<std::mutex> lock( shaper->mMutex );
+        for ( auto &topic : shaper->mTopics )
+        {
+            std::move( topic.mQueue.begin(), topic.mQueue.end(), std::back_inserter( remaining ) );
+            topic.mQueue.clear();
+        }
+        shaper->mQueuedBytes = 0;
+        // Each of them completes like any other publish
+        shaper->mInFlightPublishes += remaining.size();
+    }
+    for ( auto &publish : remaining )
+    {
+        publish.mPublish();
+    }
+}
@@ -49,6 +49,7 @@ public:
                    MqttConnection::OnSubAckHandler &&onSubAck ),
                  ( noexcept ) );
     MOCK_METHOD( (bool), Disconnect, (), ( noexcept ) );
+    MOCK_METHOD( (bool), SetReconnectTimeout, ( uint64_t min_seconds, uint64_t max_seconds ), ( noexcept ) );
     MOCK_METHOD( (bool), SetOnMessageHandler, ( MqttConnection::OnMessageReceivedHandler && onMessage ), ( noexcept ) );
     MOCK_METHOD( (int), LastError, (), ( const, noexcept ) );
     MOCK_METHOD( (bool),
@@ -45,6 +45,12 @@ ByteBufNewCopy( Allocator *alloc, const uint8_t *array, size_t len )
     return getSdkMock()->ByteBufNewCopy( alloc, array, len );
 }
 
+inline ByteBuf
+ByteBufFromArray( const uint8_t *array, size_t len )
+{
+    return { len, const_cast<uint8_t *>( array ), len, nullptr };
+}
+
 inline ByteCursor
 ByteCursorFromCString( const char *str )
 {
@@ -74,6 +74,8 @@ public:
 
     virtual bool Disconnect() noexcept = 0;
 
+    virtual bool SetReconnectTimeout( uint64_t min_seconds, uint64_t max_seconds ) noexcept = 0;
+
     virtual bool SetOnMessageHandler( OnMessageReceivedHandler &&onMessage ) noexcept = 0;
 
     OnConnectionInterruptedHandler OnConnectionInterrupted;
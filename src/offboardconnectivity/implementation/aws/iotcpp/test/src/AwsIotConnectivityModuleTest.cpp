@@ -15,11 +15,15 @@
 #include "AwsIotChannel.h"
 #include "AwsIotSdkMock.h"
 #include "AwsSDKMemoryManager.h"
+#include <chrono>
+#include <climits>
 #include <cstddef>
+#include <cstdint>
 #include <gtest/gtest.h>
 #include <linux/can.h>
 #include <linux/can/raw.h>
 #include <list>
+#include <mutex>
 #include <net/if.h>
 #include <snappy.h>
 #include <stdio.h>
@@ -33,6 +37,7 @@
 using namespace Aws::IoTFleetWise::OffboardConnectivityAwsIot;
 using namespace Aws::IoTFleetWise::OffboardConnectivityAwsIot::Testing;
 using namespace Aws::Crt::Mqtt;
+using namespace Aws::IoTFleetWise::Platform::Linux::PersistencyManagement;
 using ::testing::_;
 using ::testing::AnyNumber;
 using ::testing::AtLeast;
@@ -87,6 +92,7 @@ protected:
         std::shared_ptr<NiceMock<MqttConnectionMock>> con = std::make_shared<NiceMock<MqttConnectionMock>>();
         ON_CALL( clientMock, NewConnection( _ ) ).WillByDefault( Return( con ) );
         ON_CALL( *con, SetOnMessageHandler( _ ) ).WillByDefault( Return( true ) );
+        ON_CALL( *con, SetReconnectTimeout( _, _ ) ).WillByDefault( Return( true ) );
         ON_CALL( *con, Connect( _, _, _, _ ) )
             .WillByDefault( Invoke( [&con]( const char *, bool, uint16_t, uint32_t ) noexcept -> bool {
                 con->OnConnectionCompleted( *con, 0, ReturnCode::AWS_MQTT_CONNECT_ACCEPTED, true );
@@ -147,6 +153,54 @@ TEST_F( AwsIotConnectivityModuleTest, connectSuccessfull )
     ASSERT_EQ( endpoint, requestedEndpoint );
 }
 
+/** @brief Test connecting two modules with one shared client, which builds the TLS context only once */
+TEST_F( AwsIotConnectivityModuleTest, connectWithSharedClient )
+{
+    setupValidConnection();
+    std::vector<std::string> clientIds;
+    std::vector<std::shared_ptr<NiceMock<MqttConnectionMock>>> cons;
+    for ( int i = 0; i < 2; i++ )
+    {
+        auto con = std::make_shared<NiceMock<MqttConnectionMock>>();
+        ON_CALL( *con, SetOnMessageHandler( _ ) ).WillByDefault( Return( true ) );
+        ON_CALL( *con, SetReconnectTimeout( _, _ ) ).WillByDefault( Return( true ) );
+        ON_CALL( *con, Disconnect() ).WillByDefault( Return( true ) );
+        MqttConnectionMock *conPtr = con.get();
+        ON_CALL( *con, Connect( _, _, _, _ ) )
+            .WillByDefault( Invoke( [conPtr, &clientIds]( const char *clientId, bool, uint16_t, uint32_t ) noexcept {
+                clientIds.emplace_back( clientId );
+                conPtr->OnConnectionCompleted( *conPtr, 0, ReturnCode::AWS_MQTT_CONNECT_ACCEPTED, true );
+                return true;
+            } ) );
+        cons.emplace_back( con );
+    }
+    EXPECT_CALL( confBuilder, Build() ).Times( 1 );
+    EXPECT_CALL( clientMock, NewConnection( _ ) )
+        .Times( 2 )
+        .WillOnce( Return( cons[0] ) )
+        .WillOnce( Return( cons[1] ) );
+
+    ASSERT_FALSE( std::make_shared<AwsIotSharedClient>()->init( "", "", "", bootstrap ) );
+    auto sharedClient = std::make_shared<AwsIotSharedClient>();
+    ASSERT_TRUE( sharedClient->init( "key", "cert", "endpoint", bootstrap ) );
+
+    std::shared_ptr<AwsIotConnectivityModule> m1 = std::make_shared<AwsIotConnectivityModule>();
+    std::shared_ptr<AwsIotConnectivityModule> m2 = std::make_shared<AwsIotConnectivityModule>();
+    m1->setSharedClient( sharedClient );
+    m2->setSharedClient( sharedClient );
+    // The credentials are taken from the shared client
+    ASSERT_TRUE( m1->connect( "", "", "", "vehicle1", bootstrap ) );
+    ASSERT_TRUE( m2->connect( "", "", "", "vehicle2", bootstrap ) );
+    ASSERT_EQ( clientIds, std::vector<std::string>( { "vehicle1", "vehicle2" } ) );
+
+    for ( auto &con : cons )
+    {
+        con->OnDisconnect( *con );
+    }
+    m1->disconnect();
+    m2->disconnect();
+}
+
 /** @brief Test trying to connect, where creation of the bootstrap fails */
 TEST_F( AwsIotConnectivityModuleTest, connectFailsOnClientBootstrapCreation )
 {
@@ -180,6 +234,62 @@ TEST_F( AwsIotConnectivityModuleTest, connectionInterrupted )
     con->OnDisconnect( *con );
 }
 
+/** @brief Test that the reconnect backoff and the keep alive are passed to the SDK */
+TEST_F( AwsIotConnectivityModuleTest, connectWithReconnectConfig )
+{
+    auto con = setupValidConnection();
+    MqttReconnectConfig config;
+    config.minBackoffSeconds = 2;
+    config.maxBackoffSeconds = 30;
+    config.keepAliveSeconds = 120;
+    config.pingTimeoutMs = 10000;
+
+    EXPECT_CALL( *con, SetReconnectTimeout( 2, 30 ) ).Times( 1 ).WillOnce( Return( true ) );
+    EXPECT_CALL( *con, Connect( _, false, 120, 10000 ) )
+        .Times( 1 )
+        .WillOnce( Invoke( [&con]( const char *, bool, uint16_t, uint32_t ) noexcept -> bool {
+            con->OnConnectionCompleted( *con, 0, ReturnCode::AWS_MQTT_CONNECT_ACCEPTED, true );
+            return true;
+        } ) );
+
+    std::shared_ptr<AwsIotConnectivityModule> m = std::make_shared<AwsIotConnectivityModule>();
+    m->setReconnectConfig( config );
+    ASSERT_TRUE( m->connect( "key", "cert", "endpoint", "clientIdTest", bootstrap ) );
+
+    con->OnDisconnect( *con );
+}
+
+/** @brief Test that an interrupted connection is established again right away when the link comes up */
+TEST_F( AwsIotConnectivityModuleTest, reconnectOnLinkUp )
+{
+    auto con = setupValidConnection();
+    ON_CALL( *con, Disconnect() ).WillByDefault( Invoke( [&con]() noexcept -> bool {
+        con->OnDisconnect( *con );
+        return true;
+    } ) );
+
+    std::shared_ptr<AwsIotConnectivityModule> m = std::make_shared<AwsIotConnectivityModule>();
+    ASSERT_TRUE( m->connect( "key", "cert", "endpoint", "clientIdTest", bootstrap ) );
+    // Nothing to do while connected
+    ASSERT_FALSE( m->onLinkUp() );
+
+    con->OnConnectionInterrupted( *con, 10 );
+    ASSERT_FALSE( m->isAlive() );
+
+    EXPECT_CALL( *con, Disconnect() ).Times( 1 );
+    EXPECT_CALL( *con, Connect( _, _, _, _ ) ).Times( 1 );
+    ASSERT_TRUE( m->onLinkUp() );
+    for ( int i = 0; ( i < 100 ) && !m->isAlive(); i++ )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+    }
+    ASSERT_TRUE( m->isAlive() );
+    ASSERT_FALSE( m->onLinkUp() );
+
+    EXPECT_CALL( *con, Disconnect() ).Times( 1 );
+    m->disconnect();
+}
+
 /** @brief Test connecting when it fails after a delay */
 TEST_F( AwsIotConnectivityModuleTest, connectFailsServerUnavailableWithDelay )
 {
@@ -367,6 +477,286 @@ TEST_F( AwsIotConnectivityModuleTest, sendMultiple )
     c.invalidateConnection();
 }
 
+/** @brief Test publishes over the rate limit are queued in the upload shaper instead of blocking the caller */
+TEST_F( AwsIotConnectivityModuleTest, sendThroughUploadShaper )
+{
+    auto con = setupValidConnection();
+    std::shared_ptr<AwsIotConnectivityModule> m = std::make_shared<AwsIotConnectivityModule>();
+    AwsIotChannel c( m.get(), nullptr );
+    ASSERT_TRUE( m->connect( "key", "cert", "endpoint", "clientIdTest", bootstrap ) );
+    std::uint8_t input[] = { 0xca, 0xfe };
+    c.setTopic( "topic" );
+    UploadRateLimit topicLimit;
+    topicLimit.publishesPerSecond = 0.1;
+    topicLimit.burstPublishes = 1;
+    auto uploadShaper = std::make_shared<UploadShaper>( UploadRateLimit(), 2 );
+    c.setUploadShaper( uploadShaper, topicLimit );
+    ASSERT_TRUE( uploadShaper->start() );
+
+    std::list<MqttConnection::OnOperationCompleteHandler> completeHandlers;
+    EXPECT_CALL( *con, Publish( _, _, _, _, _ ) )
+        .Times( 2 )
+        .WillRepeatedly(
+            Invoke( [&completeHandlers]( const char *,
+                                         aws_mqtt_qos,
+                                         bool,
+                                         const struct aws_byte_buf &,
+                                         MqttConnection::OnOperationCompleteHandler &&onOpComplete ) noexcept -> bool {
+                completeHandlers.push_back( std::move( onOpComplete ) );
+                return true;
+            } ) );
+
+    // The first publish uses the burst, the second waits in the shaper
+    ASSERT_EQ( c.send( input, sizeof( input ) ), ConnectivityError::Success );
+    ASSERT_EQ( c.send( input, sizeof( input ) ), ConnectivityError::Success );
+    ASSERT_EQ( completeHandlers.size(), 1U );
+    ASSERT_EQ( uploadShaper->getQueuedBytes(), sizeof( input ) );
+    // The queue of the shaper is full
+    ASSERT_EQ( c.send( input, sizeof( input ) ), ConnectivityError::QuotaReached );
+
+    // Stopping the shaper publishes the queued payload
+    ASSERT_TRUE( uploadShaper->stop() );
+    ASSERT_EQ( completeHandlers.size(), 2U );
+    while ( !completeHandlers.empty() )
+    {
+        completeHandlers.front().operator()( *con, 1, 0 );
+        completeHandlers.pop_front();
+    }
+
+    con->OnDisconnect( *con );
+    c.invalidateConnection();
+}
+
+/** @brief Test publishes above the in-flight window wait in the upload shaper until earlier ones completed */
+TEST_F( AwsIotConnectivityModuleTest, sendThroughInFlightWindow )
+{
+    auto con = setupValidConnection();
+    std::shared_ptr<AwsIotConnectivityModule> m = std::make_shared<AwsIotConnectivityModule>();
+    AwsIotChannel c( m.get(), nullptr );
+    ASSERT_TRUE( m->connect( "key", "cert", "endpoint", "clientIdTest", bootstrap ) );
+    std::uint8_t input[] = { 0xca, 0xfe };
+    c.setTopic( "topic" );
+    auto uploadShaper = std::make_shared<UploadShaper>( UploadRateLimit(), UploadShaper::DEFAULT_MAX_QUEUED_BYTES, 1 );
+    c.setUploadShaper( uploadShaper, UploadRateLimit() );
+    ASSERT_TRUE( uploadShaper->start() );
+
+    std::mutex mutex;
+    std::list<MqttConnection::OnOperationCompleteHandler> completeHandlers;
+    EXPECT_CALL( *con, Publish( _, _, _, _, _ ) )
+        .Times( 2 )
+        .WillRepeatedly( Invoke(
+            [&completeHandlers, &mutex]( const char *,
+                                         aws_mqtt_qos,
+                                         bool,
+                                         const struct aws_byte_buf &,
+                                         MqttConnection::OnOperationCompleteHandler &&onOpComplete ) noexcept -> bool {
+                std::lock_guard<std::mutex> lock( mutex );
+                completeHandlers.push_back( std::move( onOpComplete ) );
+                return true;
+            } ) );
+    auto getCompleteHandlerCount = [&]() {
+        std::lock_guard<std::mutex> lock( mutex );
+        return completeHandlers.size();
+    };
+
+    ASSERT_EQ( c.send( input, sizeof( input ) ), ConnectivityError::Success );
+    ASSERT_EQ( c.send( input, sizeof( input ) ), ConnectivityError::Success );
+    ASSERT_EQ( getCompleteHandlerCount(), 1U );
+    ASSERT_EQ( uploadShaper->getInFlightPublishes(), 1U );
+
+    // The completion of the first publish lets the queued one go
+    MqttConnection::OnOperationCompleteHandler first;
+    {
+        std::lock_guard<std::mutex> lock( mutex );
+        first = std::move( completeHandlers.front() );
+        completeHandlers.pop_front();
+    }
+    first( *con, 1, 0 );
+    while ( getCompleteHandlerCount() == 0U )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+    ASSERT_EQ( uploadShaper->getInFlightPublishes(), 1U );
+    completeHandlers.front().operator()( *con, 2, 0 );
+    completeHandlers.pop_front();
+    ASSERT_EQ( uploadShaper->getInFlightPublishes(), 0U );
+    ASSERT_TRUE( uploadShaper->stop() );
+
+    con->OnDisconnect( *con );
+    c.invalidateConnection();
+}
+
+/** @brief Test publishing a pooled buffer without copying it, the buffer goes back to the pool on completion */
+TEST_F( AwsIotConnectivityModuleTest, sendBufferWithoutCopy )
+{
+    auto con = setupValidConnection();
+    std::shared_ptr<AwsIotConnectivityModule> m = std::make_shared<AwsIotConnectivityModule>();
+    AwsIotChannel c( m.get(), nullptr );
+    ASSERT_TRUE( m->connect( "key", "cert", "endpoint", "clientIdTest", bootstrap ) );
+    c.setTopic( "topic" );
+    ASSERT_EQ( c.sendBuffer( nullptr ), ConnectivityError::WrongInputData );
+
+    PayloadBufferPool pool;
+    auto buffer = pool.acquire();
+    *buffer = { 0xca, 0xfe };
+    const auto *data = buffer->data();
+    std::list<MqttConnection::OnOperationCompleteHandler> completeHandlers;
+    EXPECT_CALL( sdkMock, ByteBufNewCopy( _, _, _ ) ).Times( 0 );
+    EXPECT_CALL( sdkMock, aws_byte_buf_clean_up( _ ) ).Times( 0 );
+    auto publish = [&completeHandlers, data]( const char *,
+                                              aws_mqtt_qos,
+                                              bool,
+                                              const struct aws_byte_buf &payload,
+                                              MqttConnection::OnOperationCompleteHandler &&onOpComplete ) noexcept
+        -> bool {
+        EXPECT_EQ( payload.buffer, data );
+        EXPECT_EQ( payload.len, 2U );
+        completeHandlers.push_back( std::move( onOpComplete ) );
+        return true;
+    };
+    EXPECT_CALL( *con, Publish( _, _, _, _, _ ) ).Times( 1 ).WillOnce( Invoke( publish ) );
+
+    ASSERT_EQ( c.sendBuffer( std::move( buffer ) ), ConnectivityError::Success );
+    // The buffer is referenced until the publish completed
+    ASSERT_EQ( pool.getPooledBufferCount(), 0U );
+    completeHandlers.front().operator()( *con, 1, 0 );
+    completeHandlers.pop_front();
+    ASSERT_EQ( pool.getPooledBufferCount(), 1U );
+    // The memory is reused for the next payload
+    ASSERT_EQ( pool.acquire()->capacity(), 2U );
+
+    con->OnDisconnect( *con );
+    c.invalidateConnection();
+}
+
+/** @brief Test a payload failing in flight is persisted once if its collection scheme persists its data */
+TEST_F( AwsIotConnectivityModuleTest, persistPayloadFailedInFlight )
+{
+    auto con = setupValidConnection();
+    std::shared_ptr<AwsIotConnectivityModule> m = std::make_shared<AwsIotConnectivityModule>();
+    char cwd[PATH_MAX];
+    ASSERT_NE( getcwd( cwd, sizeof( cwd ) ), nullptr );
+    auto persistency = std::make_shared<CacheAndPersist>( std::string( cwd ), 131072 );
+    ASSERT_TRUE( persistency->init() );
+    persistency->erase( DataType::EDGE_TO_CLOUD_PAYLOAD );
+    auto payloadManager = std::make_shared<PayloadManager>( persistency );
+    AwsIotChannel c( m.get(), payloadManager );
+    ASSERT_TRUE( m->connect( "key", "cert", "endpoint", "clientIdTest", bootstrap ) );
+    c.setTopic( "topic" );
+
+    std::list<MqttConnection::OnOperationCompleteHandler> completeHandlers;
+    EXPECT_CALL( *con, Publish( _, _, _, _, _ ) )
+        .Times( 2 )
+        .WillRepeatedly( Invoke(
+            [&completeHandlers]( const char *,
+                                 aws_mqtt_qos,
+                                 bool,
+                                 const struct aws_byte_buf &,
+                                 MqttConnection::OnOperationCompleteHandler &&onOpComplete ) noexcept -> bool {
+                completeHandlers.push_back( std::move( onOpComplete ) );
+                return true;
+            } ) );
+
+    PayloadBufferPool pool;
+    CollectionSchemeParams collectionSchemeParams;
+    collectionSchemeParams.persist = true;
+    auto persisted = pool.acquire();
+    *persisted = { 0xca, 0xfe };
+    ASSERT_EQ( c.sendBuffer( std::move( persisted ), collectionSchemeParams ), ConnectivityError::Success );
+    collectionSchemeParams.persist = false;
+    auto notPersisted = pool.acquire();
+    *notPersisted = { 0xbe, 0xef };
+    ASSERT_EQ( c.sendBuffer( std::move( notPersisted ), collectionSchemeParams ), ConnectivityError::Success );
+    // The connection drops while both publishes are in flight
+    while ( !completeHandlers.empty() )
+    {
+        completeHandlers.front().operator()( *con, 1, 1 );
+        completeHandlers.pop_front();
+    }
+
+    std::vector<PayloadBufferPtr> payloads;
+    ASSERT_EQ( payloadManager->retrieveData( payloads ), ErrorCode::SUCCESS );
+    ASSERT_EQ( payloads.size(), 1U );
+    ASSERT_EQ( *payloads[0], std::vector<uint8_t>( { 0xca, 0xfe } ) );
+    persistency->erase( DataType::EDGE_TO_CLOUD_PAYLOAD );
+
+    con->OnDisconnect( *con );
+    c.invalidateConnection();
+}
+
+/** @brief Test the items of a batch are published back to back and completed with one callback */
+TEST_F( AwsIotConnectivityModuleTest, sendBatchPipelined )
+{
+    auto con = setupValidConnection();
+    std::shared_ptr<AwsIotConnectivityModule> m = std::make_shared<AwsIotConnectivityModule>();
+    AwsIotChannel c( m.get(), nullptr );
+    ASSERT_TRUE( m->connect( "key", "cert", "endpoint", "clientIdTest", bootstrap ) );
+    c.setTopic( "topic" );
+
+    std::vector<size_t> completions;
+    auto onComplete = [&completions]( size_t publishedItems ) {
+        completions.push_back( publishedItems );
+    };
+    ASSERT_EQ( c.sendBatch( {}, onComplete ), ConnectivityError::WrongInputData );
+    ASSERT_EQ( completions, std::vector<size_t>{ 0 } );
+    completions.clear();
+
+    PayloadBufferPool pool;
+    std::vector<SendBatchItem> items( 3 );
+    for ( size_t i = 0; i < items.size(); i++ )
+    {
+        auto buffer = pool.acquire();
+        *buffer = { 0xca, 0xfe, static_cast<uint8_t>( i ) };
+        items[i].segments.push_back( buffer );
+    }
+    // The segments of the last item are gathered into one payload
+    auto secondSegment = pool.acquire();
+    *secondSegment = { 0xbe, 0xef };
+    items[2].segments.push_back( secondSegment );
+
+    std::list<MqttConnection::OnOperationCompleteHandler> completeHandlers;
+    std::vector<size_t> publishedSizes;
+    EXPECT_CALL( *con, Publish( _, _, _, _, _ ) )
+        .Times( 3 )
+        .WillRepeatedly(
+            Invoke( [&completeHandlers, &publishedSizes](
+                        const char *,
+                        aws_mqtt_qos,
+                        bool,
+                        const struct aws_byte_buf &payload,
+                        MqttConnection::OnOperationCompleteHandler &&onOpComplete ) noexcept -> bool {
+                publishedSizes.push_back( payload.len );
+                completeHandlers.push_back( std::move( onOpComplete ) );
+                return true;
+            } ) );
+    auto getMemoryUsage = [&m]() {
+        auto usage = m->reserveMemoryUsage( 0 );
+        m->releaseMemoryUsage( 0 );
+        return usage;
+    };
+    auto memoryUsage = getMemoryUsage();
+    ASSERT_EQ( c.sendBatch( items, onComplete ), ConnectivityError::Success );
+    // All publishes were handed to the SDK before the first one completed
+    ASSERT_EQ( publishedSizes, ( std::vector<size_t>{ 3, 3, 5 } ) );
+    ASSERT_TRUE( completions.empty() );
+    completeHandlers.front().operator()( *con, 1, 0 );
+    completeHandlers.pop_front();
+    completeHandlers.front().operator()( *con, 2, 1 );
+    completeHandlers.pop_front();
+    ASSERT_TRUE( completions.empty() );
+    completeHandlers.front().operator()( *con, 3, 0 );
+    completeHandlers.pop_front();
+    ASSERT_EQ( completions, std::vector<size_t>{ 2 } );
+    // Each completion released the memory of its payload
+    ASSERT_EQ( getMemoryUsage(), memoryUsage );
+    completions.clear();
+
+    con->OnDisconnect( *con );
+    c.invalidateConnection();
+    ASSERT_EQ( c.sendBatch( items, onComplete ), ConnectivityError::NoConnection );
+    ASSERT_EQ( completions, std::vector<size_t>{ 0 } );
+}
+
 /** @brief Test SDK exceeds RAM and Channel stops sending */
 TEST_F( AwsIotConnectivityModuleTest, sdkRAMExceeded )
 {
@@ -437,6 +827,142 @@ TEST_F( AwsIotConnectivityModuleTest, sdkRAMExceeded )
     c.invalidateConnection();
 }
 
+/** @brief Test small SDK allocations are served from the pools with the same accounting as large ones */
+TEST_F( AwsIotConnectivityModuleTest, sdkMemoryPoolReusesSmallBlocks )
+{
+    auto &memMgr = AwsSDKMemoryManager::getInstance();
+    constexpr auto offset = alignof( std::max_align_t );
+    const auto usedBefore = memMgr.reserveMemory( 0 );
+    memMgr.releaseReservedMemory( 0 );
+
+    void *small = memMgr.AllocateMemory( 100, alignof( std::size_t ) );
+    ASSERT_NE( small, nullptr );
+    ASSERT_EQ( reinterpret_cast<std::uintptr_t>( small ) % offset, 0 );
+    ASSERT_EQ( memMgr.reserveMemory( 0 ), usedBefore + 100 + offset );
+    memMgr.releaseReservedMemory( 0 );
+    memMgr.FreeMemory( small );
+
+    // The freed block is cached by the thread and handed out again
+    void *again = memMgr.AllocateMemory( 90, alignof( std::size_t ) );
+    ASSERT_EQ( again, small );
+    void *large = memMgr.AllocateMemory( AwsSDKMemoryManager::MAX_POOLED_BLOCK_SIZE, alignof( std::size_t ) );
+    ASSERT_NE( large, nullptr );
+    memMgr.FreeMemory( again );
+    memMgr.FreeMemory( large );
+
+    // Blocks freed by another thread can be reused
+    std::thread allocator( [&memMgr]() {
+        for ( int i = 0; i < 1000; i++ )
+        {
+            memMgr.FreeMemory( memMgr.AllocateMemory( 1000, alignof( std::size_t ) ) );
+        }
+    } );
+    allocator.join();
+    ASSERT_EQ( memMgr.reserveMemory( 0 ), usedBefore );
+    memMgr.releaseReservedMemory( 0 );
+}
+
+/** @brief Test less important payloads are not sent when the SDK memory exceeds their lower limit */
+TEST_F( AwsIotConnectivityModuleTest, sdkRAMReservedForImportantPayloads )
+{
+    auto con = setupValidConnection();
+
+    std::shared_ptr<AwsIotConnectivityModule> m = std::make_shared<AwsIotConnectivityModule>();
+    ASSERT_TRUE( m->connect( "key", "cert", "endpoint", "clientIdTest", bootstrap ) );
+
+    auto &memMgr = AwsSDKMemoryManager::getInstance();
+    AwsIotChannel c( m.get(), nullptr );
+    c.setTopic( "topic" );
+    c.setLowPriorityMemoryLimit( 1, AwsIotChannel::MAXIMUM_IOT_SDK_HEAP_MEMORY_BYTES / 2 );
+    std::array<std::uint8_t, 2> input = { 0xCA, 0xFE };
+
+    std::list<MqttConnection::OnOperationCompleteHandler> completeHandlers;
+    EXPECT_CALL( *con, Publish( _, _, _, _, _ ) )
+        .Times( AnyNumber() )
+        .WillRepeatedly( Invoke(
+            [&completeHandlers]( const char *,
+                                 aws_mqtt_qos,
+                                 bool,
+                                 const struct aws_byte_buf &,
+                                 MqttConnection::OnOperationCompleteHandler &&onOpComplete ) noexcept -> bool {
+                completeHandlers.push_back( std::move( onOpComplete ) );
+                return true;
+            } ) );
+
+    void *alloc = memMgr.AllocateMemory( ( AwsIotChannel::MAXIMUM_IOT_SDK_HEAP_MEMORY_BYTES * 3 ) / 4,
+                                         alignof( std::size_t ) );
+    ASSERT_NE( alloc, nullptr );
+    CollectionSchemeParams collectionSchemeParams;
+    collectionSchemeParams.priority = 2;
+    ASSERT_EQ( c.send( input.data(), input.size(), collectionSchemeParams ), ConnectivityError::QuotaReached );
+    // Important payloads can still use the memory up to the maximum
+    collectionSchemeParams.priority = 1;
+    ASSERT_EQ( c.send( input.data(), input.size(), collectionSchemeParams ), ConnectivityError::Success );
+    memMgr.FreeMemory( alloc );
+
+    // Below the limit less important payloads are sent again
+    collectionSchemeParams.priority = 2;
+    ASSERT_EQ( c.send( input.data(), input.size(), collectionSchemeParams ), ConnectivityError::Success );
+    while ( !completeHandlers.empty() )
+    {
+        completeHandlers.front().operator()( *con, 1, 0 );
+        completeHandlers.pop_front();
+    }
+
+    con->OnDisconnect( *con );
+    c.invalidateConnection();
+}
+
+/** @brief Test the SDK memory reserved for the express payloads is not used by the other payloads */
+TEST_F( AwsIotConnectivityModuleTest, sdkRAMReservedForExpressPayloads )
+{
+    auto con = setupValidConnection();
+
+    std::shared_ptr<AwsIotConnectivityModule> m = std::make_shared<AwsIotConnectivityModule>();
+    ASSERT_TRUE( m->connect( "key", "cert", "endpoint", "clientIdTest", bootstrap ) );
+
+    auto &memMgr = AwsSDKMemoryManager::getInstance();
+    AwsIotChannel c( m.get(), nullptr );
+    c.setTopic( "topic" );
+    c.setExpressMemoryReservation( AwsIotChannel::MAXIMUM_IOT_SDK_HEAP_MEMORY_BYTES / 2 );
+    std::array<std::uint8_t, 2> input = { 0xCA, 0xFE };
+
+    std::list<MqttConnection::OnOperationCompleteHandler> completeHandlers;
+    EXPECT_CALL( *con, Publish( _, _, _, _, _ ) )
+        .Times( AnyNumber() )
+        .WillRepeatedly( Invoke(
+            [&completeHandlers]( const char *,
+                                 aws_mqtt_qos,
+                                 bool,
+                                 const struct aws_byte_buf &,
+                                 MqttConnection::OnOperationCompleteHandler &&onOpComplete ) noexcept -> bool {
+                completeHandlers.push_back( std::move( onOpComplete ) );
+                return true;
+            } ) );
+
+    void *alloc = memMgr.AllocateMemory( ( AwsIotChannel::MAXIMUM_IOT_SDK_HEAP_MEMORY_BYTES * 3 ) / 4,
+                                         alignof( std::size_t ) );
+    ASSERT_NE( alloc, nullptr );
+    // Even the most important payloads which are not express do not use the reserved memory
+    CollectionSchemeParams collectionSchemeParams;
+    collectionSchemeParams.priority = 0;
+    ASSERT_EQ( c.send( input.data(), input.size(), collectionSchemeParams ), ConnectivityError::QuotaReached );
+    collectionSchemeParams.express = true;
+    ASSERT_EQ( c.send( input.data(), input.size(), collectionSchemeParams ), ConnectivityError::Success );
+    memMgr.FreeMemory( alloc );
+
+    collectionSchemeParams.express = false;
+    ASSERT_EQ( c.send( input.data(), input.size(), collectionSchemeParams ), ConnectivityError::Success );
+    while ( !completeHandlers.empty() )
+    {
+        completeHandlers.front().operator()( *con, 1, 0 );
+        completeHandlers.pop_front();
+    }
+
+    con->OnDisconnect( *con );
+    c.invalidateConnection();
+}
+
 /** @brief Test the separate thread with exponential backoff that tries to connect until connection succeeds */
 TEST_F( AwsIotConnectivityModuleTest, asyncConnect )
 {
@@ -0,0 +1,84 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "LinkMonitor.h"
+#include <cstring>
+#include <gtest/gtest.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <net/if.h>
+#include <string>
+#include <vector>
+
+using namespace Aws::IoTFleetWise::OffboardConnectivityAwsIot;
+
+// Appends a link message as sent by the kernel for the interface
+static void
+appendLinkMessage( std::vector<uint8_t> &buffer, uint16_t type, const std::string &interfaceName, unsigned int flags )
+{
+    auto nameSize = interfaceName.size() + 1;
+    auto messageSize = NLMSG_LENGTH( sizeof( struct ifinfomsg ) ) + RTA_SPACE( nameSize );
+    auto offset = buffer.size();
+    buffer.resize( offset + NLMSG_ALIGN( messageSize ), 0 );
+    auto *header = reinterpret_cast<struct nlmsghdr *>( &buffer[offset] );
+    header->nlmsg_len = static_cast<uint32_t>( messageSize );
+    header->nlmsg_type = type;
+    auto *info = static_cast<struct ifinfomsg *>( NLMSG_DATA( header ) );
+    info->ifi_flags = flags;
+    auto *attribute = IFLA_RTA( info );
+    attribute->rta_type = IFLA_IFNAME;
+    attribute->rta_len = static_cast<unsigned short>( RTA_LENGTH( nameSize ) );
+    memcpy( RTA_DATA( attribute ), interfaceName.c_str(), nameSize );
+}
+
+TEST( LinkMonitorTest, LinkUpReportedOnceForTheInterface )
+{
+    int linkUps = 0;
+    LinkMonitor monitor( "wwan0", [&linkUps]() { linkUps++; } );
+    ASSERT_FALSE( monitor.isLinkUp() );
+
+    std::vector<uint8_t> buffer;
+    // Other interfaces and an interface without carrier are ignored
+    appendLinkMessage( buffer, RTM_NEWLINK, "eth0", IFF_UP | IFF_RUNNING );
+    appendLinkMessage( buffer, RTM_NEWLINK, "wwan0", IFF_UP );
+    monitor.handleMessages( buffer.data(), buffer.size() );
+    ASSERT_EQ( linkUps, 0 );
+
+    buffer.clear();
+    appendLinkMessage( buffer, RTM_NEWLINK, "wwan0", IFF_UP | IFF_RUNNING );
+    appendLinkMessage( buffer, RTM_NEWLINK, "wwan0", IFF_UP | IFF_RUNNING );
+    monitor.handleMessages( buffer.data(), buffer.size() );
+    ASSERT_EQ( linkUps, 1 );
+    ASSERT_TRUE( monitor.isLinkUp() );
+
+    // A removed interface is down, so it is reported again when it is created again
+    buffer.clear();
+    appendLinkMessage( buffer, RTM_DELLINK, "wwan0", IFF_UP | IFF_RUNNING );
+    monitor.handleMessages( buffer.data(), buffer.size() );
+    ASSERT_FALSE( monitor.isLinkUp() );
+    buffer.clear();
+    appendLinkMessage( buffer, RTM_NEWLINK, "wwan0", IFF_UP | IFF_RUNNING );
+    monitor.handleMessages( buffer.data(), buffer.size() );
+    ASSERT_EQ( linkUps, 2 );
+}
+
+TEST( LinkMonitorTest, StartAndStop )
+{
+    LinkMonitor monitor( "fwe-missing0", nullptr );
+    ASSERT_TRUE( monitor.start() );
+    ASSERT_TRUE( monitor.isAlive() );
+    // The state of an interface that does not exist is down
+    ASSERT_FALSE( monitor.isLinkUp() );
+    ASSERT_TRUE( monitor.stop() );
+    ASSERT_FALSE( monitor.isAlive() );
+}
@@ -0,0 +1,209 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "MetricsEncoder.h"
+#include <gtest/gtest.h>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace Aws::IoTFleetWise::OffboardConnectivity;
+
+namespace
+{
+struct DecodedSeries
+{
+    std::string name;
+    std::string unit;
+    uint32_t scale{ 0 };
+    std::vector<std::pair<Timestamp, double>> samples;
+};
+
+class Decoder
+{
+public:
+    // Decodes a payload, keeping the definitions for the following payloads
+    bool
+    decode( const std::vector<uint8_t> &payload, std::string &prefix )
+    {
+        mData = &payload;
+        mPosition = 0;
+        if ( ( payload.size() < 4 ) || ( payload[0] != 'F' ) || ( payload[1] != 'W' ) || ( payload[2] != 'M' ) ||
+             ( payload[3] != MetricsEncoder::FORMAT_VERSION ) )
+        {
+            return false;
+        }
+        mPosition = 4;
+        prefix = readString();
+        auto baseTime = readVarint();
+        while ( mPosition < payload.size() )
+        {
+            auto type = payload[mPosition++];
+            auto seriesId = static_cast<uint32_t>( readVarint() );
+            if ( type == MetricsEncoder::RECORD_DEFINITION )
+            {
+                auto &series = mSeries[seriesId];
+                series.scale = static_cast<uint32_t>( readVarint() );
+                series.name = readString();
+                series.unit = readString();
+            }
+            else if ( type == MetricsEncoder::RECORD_SAMPLES )
+            {
+                if ( mSeries.find( seriesId ) == mSeries.end() )
+                {
+                    return false;
+                }
+                auto &series = mSeries[seriesId];
+                auto count = readVarint();
+                Timestamp time = baseTime;
+                int64_t value = 0;
+                for ( uint64_t i = 0; i < count; i++ )
+                {
+                    time += readVarint();
+                    auto zigzag = readVarint();
+                    value += static_cast<int64_t>( zigzag >> 1U ) ^ -static_cast<int64_t>( zigzag & 1U );
+                    series.samples.emplace_back( time,
+                                                 static_cast<double>( value ) / static_cast<double>( series.scale ) );
+                }
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::map<uint32_t, DecodedSeries> mSeries;
+
+private:
+    uint64_t
+    readVarint()
+    {
+        uint64_t value = 0;
+        for ( uint32_t shift = 0; mPosition < mData->size(); shift += 7 )
+        {
+            auto byte = ( *mData )[mPosition++];
+            value |= static_cast<uint64_t>( byte & 0x7FU ) << shift;
+            if ( ( byte & 0x80U ) == 0 )
+            {
+                break;
+            }
+        }
+        return value;
+    }
+
+    std::string
+    readString()
+    {
+        auto length = readVarint();
+        std::string value( mData->begin() + static_cast<long>( mPosition ),
+                           mData->begin() + static_cast<long>( mPosition + length ) );
+        mPosition += length;
+        return value;
+    }
+
+    const std::vector<uint8_t> *mData{ nullptr };
+    size_t mPosition{ 0 };
+};
+} // namespace
+
+/**
+ * @brief Validates that the samples are delta encoded and the definitions are only sent once
+ */
+TEST( MetricsEncoderTest, EncodeAndDecode )
+{
+    MetricsEncoder encoder;
+    ASSERT_TRUE( encoder.registerSeries( "Latency", "Microseconds", 10 ) );
+    for ( Timestamp time = 1000; time < 1600; time += 100 )
+    {
+        ASSERT_TRUE( encoder.addSample( "CpuPercentageSum", time, 12.5 + static_cast<double>( time / 100 ), "Percent" ) );
+        ASSERT_TRUE( encoder.addSample( "Latency", time, -1.24, "Microseconds" ) );
+    }
+    ASSERT_EQ( encoder.getSeriesCount(), 2 );
+    ASSERT_EQ( encoder.getPendingSampleCount(), 12 );
+
+    std::vector<uint8_t> payload;
+    ASSERT_FALSE( encoder.encode( "Vehicle1_", 10000, payload ) );
+    ASSERT_EQ( encoder.getPendingSampleCount(), 0 );
+    // Header, two definitions and 12 samples with at most two bytes per time and value delta
+    ASSERT_LT( payload.size(), 120 );
+
+    Decoder decoder;
+    std::string prefix;
+    ASSERT_TRUE( decoder.decode( payload, prefix ) );
+    ASSERT_EQ( prefix, "Vehicle1_" );
+    ASSERT_EQ( decoder.mSeries.size(), 2 );
+    ASSERT_EQ( decoder.mSeries[0].name, "Latency" );
+    ASSERT_EQ( decoder.mSeries[0].scale, 10 );
+    // Rounded to the scale
+    ASSERT_DOUBLE_EQ( decoder.mSeries[0].samples[0].second, -1.2 );
+    ASSERT_EQ( decoder.mSeries[1].name, "CpuPercentageSum" );
+    ASSERT_EQ( decoder.mSeries[1].unit, "Percent" );
+    ASSERT_EQ( decoder.mSeries[1].samples.size(), 6 );
+    ASSERT_EQ( decoder.mSeries[1].samples[5].first, 1500 );
+    ASSERT_DOUBLE_EQ( decoder.mSeries[1].samples[5].second, 27.5 );
+
+    // The next payload only has samples
+    ASSERT_TRUE( encoder.addSample( "Latency", 2000, 3.0, "Microseconds" ) );
+    ASSERT_FALSE( encoder.encode( "Vehicle1_", 10000, payload ) );
+    decoder.mSeries[0].samples.clear();
+    decoder.mSeries[0].name.clear();
+    ASSERT_TRUE( decoder.decode( payload, prefix ) );
+    ASSERT_TRUE( decoder.mSeries[0].name.empty() );
+    ASSERT_EQ( decoder.mSeries[0].samples.size(), 1 );
+    ASSERT_EQ( decoder.mSeries[0].samples[0].first, 2000 );
+    ASSERT_DOUBLE_EQ( decoder.mSeries[0].samples[0].second, 3.0 );
+
+    encoder.resendDefinitions();
+    ASSERT_FALSE( encoder.encode( "Vehicle1_", 10000, payload ) );
+    ASSERT_TRUE( decoder.decode( payload, prefix ) );
+    ASSERT_EQ( decoder.mSeries[0].name, "Latency" );
+}
+
+/**
+ * @brief Validates the series prefixes and the limits of series and payload size
+ */
+TEST( MetricsEncoderTest, PrefixesAndLimits )
+{
+    MetricsEncoder encoder( 3, 2 );
+    encoder.setSeriesPrefixes( { "Cpu", "Memory" } );
+    ASSERT_FALSE( encoder.addSample( "variableMaxSinceLast_x", 1, 1.0, "Count" ) );
+    ASSERT_TRUE( encoder.addSample( "CpuThread_1", 1, 1.0, "Percent" ) );
+    ASSERT_TRUE( encoder.addSample( "CpuThread_1", 2, 1.0, "Percent" ) );
+    ASSERT_FALSE( encoder.addSample( "CpuThread_1", 3, 1.0, "Percent" ) );
+    ASSERT_TRUE( encoder.addSample( "CpuThread_2", 1, 1.0, "Percent" ) );
+    // Explicitly registered series do not need to match the prefixes
+    ASSERT_TRUE( encoder.registerSeries( "QueueDepth", "Count" ) );
+    ASSERT_FALSE( encoder.addSample( "MemoryCurrentResidentRam", 1, 1.0, "Bytes" ) );
+    ASSERT_EQ( encoder.getSeriesCount(), 3 );
+
+    // Only one series fits per payload, the others stay pending
+    Decoder decoder;
+    std::string prefix;
+    std::vector<uint8_t> payload;
+    size_t payloads = 0;
+    bool pending = true;
+    while ( pending )
+    {
+        pending = encoder.encode( "", 45, payload );
+        ASSERT_LE( payload.size(), 45 );
+        ASSERT_TRUE( decoder.decode( payload, prefix ) );
+        payloads++;
+    }
+    ASSERT_EQ( payloads, 3 );
+    ASSERT_EQ( decoder.mSeries.size(), 3 );
+    ASSERT_EQ( decoder.mSeries[0].samples.size(), 2 );
+    ASSERT_EQ( decoder.mSeries[1].samples.size(), 1 );
+    ASSERT_TRUE( decoder.mSeries[2].samples.empty() );
+}
@@ -49,11 +49,12 @@ TEST( PayloadManagerTest, TestNoConnectionDataPersistency )
 
         ASSERT_EQ( testSend.storeData( stringData, size, collectionSchemeParams ), true );
 
-        std::vector<std::string> payloads;
+        std::vector<PayloadBufferPtr> payloads;
         testSend.retrieveData( payloads );
         ASSERT_EQ( payloads.size(), 1 );
 
-        ASSERT_TRUE( 0 == std::memcmp( payloads[0].c_str(), testData.c_str(), testData.size() ) );
+        ASSERT_EQ( payloads[0]->size(), testData.size() );
+        ASSERT_TRUE( 0 == std::memcmp( payloads[0]->data(), testData.c_str(), testData.size() ) );
         persistencyPtr->erase( DataType::EDGE_TO_CLOUD_PAYLOAD );
     }
 }
@@ -110,14 +111,243 @@ TEST( PayloadManagerTest, TestCompression )
                                        collectionSchemeParams ),
                    true );
 
-        std::vector<std::string> payloads;
+        std::vector<PayloadBufferPtr> payloads;
         testSend.retrieveData( payloads );
         ASSERT_EQ( payloads.size(), 1 );
-        ASSERT_STRNE( payloads[0].c_str(), testData.c_str() );
+        std::string retrievedData( payloads[0]->begin(), payloads[0]->end() );
+        ASSERT_STRNE( retrievedData.c_str(), testData.c_str() );
 
-        ASSERT_TRUE( snappy::Uncompress( payloads[0].c_str(), payloads[0].size(), &payloadData ) );
+        ASSERT_TRUE( snappy::Uncompress( retrievedData.c_str(), retrievedData.size(), &payloadData ) );
         ASSERT_STREQ( payloadData.c_str(), testData.c_str() );
 
         persistencyPtr->erase( DataType::EDGE_TO_CLOUD_PAYLOAD );
     }
 }
+
+TEST( PayloadManagerTest, TestRetrieveNextAndAcknowledge )
+{
+    char buffer[PATH_MAX];
+    if ( getcwd( buffer, sizeof( buffer ) ) != NULL )
+    {
+        // Segments of two payloads each
+        const std::shared_ptr<CacheAndPersist> persistencyPtr = std::make_shared<CacheAndPersist>(
+            std::string( buffer ), 131072, 2 * ( SegmentedLog::RECORD_HEADER_SIZE + sizeof( PayloadHeader ) + 9 ) );
+        persistencyPtr->init();
+        persistencyPtr->erase( DataType::EDGE_TO_CLOUD_PAYLOAD );
+        PayloadManager testSend( persistencyPtr );
+
+        CollectionSchemeParams collectionSchemeParams;
+        collectionSchemeParams.persist = true;
+        collectionSchemeParams.compression = true;
+
+        std::vector<std::string> testData = { "payload 1", "payload 2", "payload 3" };
+        for ( const auto &data : testData )
+        {
+            ASSERT_TRUE( testSend.storeData(
+                reinterpret_cast<const uint8_t *>( data.data() ), data.size(), collectionSchemeParams ) );
+        }
+        ASSERT_EQ( persistencyPtr->getCollectedDataSegments().size(), 2 );
+
+        // One payload at a time
+        PersistedPayloadChunk chunk;
+        ASSERT_EQ( testSend.retrieveNext( chunk, 1 ), ErrorCode::SUCCESS );
+        ASSERT_EQ( chunk.payloads.size(), 1 );
+        ASSERT_EQ( std::string( chunk.payloads[0]->begin(), chunk.payloads[0]->end() ), testData[0] );
+        ASSERT_EQ( testSend.acknowledge( chunk ), ErrorCode::SUCCESS );
+
+        // Not acknowledged, read again on the next retrieval
+        ASSERT_EQ( testSend.retrieveNext( chunk, 1 ), ErrorCode::SUCCESS );
+        ASSERT_EQ( std::string( chunk.payloads[0]->begin(), chunk.payloads[0]->end() ), testData[1] );
+
+        PersistedPayloadChunk retry;
+        ASSERT_EQ( testSend.retrieveNext( retry, 1000 ), ErrorCode::SUCCESS );
+        ASSERT_EQ( retry.payloads.size(), 1 );
+        ASSERT_EQ( std::string( retry.payloads[0]->begin(), retry.payloads[0]->end() ), testData[1] );
+        ASSERT_EQ( testSend.acknowledge( retry ), ErrorCode::SUCCESS );
+        // The segment was acknowledged up to its end
+        ASSERT_EQ( persistencyPtr->getCollectedDataSegments().size(), 1 );
+
+        ASSERT_EQ( testSend.retrieveNext( retry, 1000 ), ErrorCode::SUCCESS );
+        ASSERT_EQ( std::string( retry.payloads[0]->begin(), retry.payloads[0]->end() ), testData[2] );
+        ASSERT_EQ( testSend.retrieveNext( retry, 1000 ), ErrorCode::EMPTY );
+        ASSERT_TRUE( retry.payloads.empty() );
+
+        persistencyPtr->erase( DataType::EDGE_TO_CLOUD_PAYLOAD );
+        std::vector<PayloadBufferPtr> payloads;
+        ASSERT_EQ( testSend.retrieveData( payloads ), ErrorCode::EMPTY );
+    }
+}
+
+TEST( PayloadManagerTest, TestRetrieveNextDrainOrder )
+{
+    char buffer[PATH_MAX];
+    if ( getcwd( buffer, sizeof( buffer ) ) != NULL )
+    {
+        // Segments of one payload each
+        const std::shared_ptr<CacheAndPersist> persistencyPtr = std::make_shared<CacheAndPersist>(
+            std::string( buffer ), 131072, SegmentedLog::RECORD_HEADER_SIZE + sizeof( PayloadHeader ) + 9 );
+        persistencyPtr->init();
+        persistencyPtr->erase( DataType::EDGE_TO_CLOUD_PAYLOAD );
+        PayloadManager testSend( persistencyPtr );
+
+        CollectionSchemeParams collectionSchemeParams;
+        collectionSchemeParams.persist = true;
+        collectionSchemeParams.compression = false;
+        std::vector<std::pair<std::string, uint32_t>> testData = {
+            { "payload 0", 3 }, { "payload 1", 1 }, { "payload 2", 3 }, { "payload 3", 1 } };
+        for ( const auto &data : testData )
+        {
+            collectionSchemeParams.priority = data.second;
+            ASSERT_TRUE( testSend.storeData( reinterpret_cast<const uint8_t *>( data.first.data() ),
+                                             data.first.size(),
+                                             collectionSchemeParams ) );
+        }
+        ASSERT_EQ( persistencyPtr->getCollectedDataSegments().size(), 4 );
+
+        auto drain = [&testSend]() {
+            std::vector<std::string> order;
+            PersistedPayloadChunk chunk;
+            while ( testSend.retrieveNext( chunk, 1 ) == ErrorCode::SUCCESS )
+            {
+                order.emplace_back( chunk.payloads[0]->begin(), chunk.payloads[0]->end() );
+            }
+            return order;
+        };
+        // By default the most important priority first, from the oldest
+        ASSERT_EQ( drain(), std::vector<std::string>( { "payload 1", "payload 3", "payload 0", "payload 2" } ) );
+        PersistedDataDrainPolicy policy;
+        policy.newestFirst = true;
+        testSend.setDrainPolicy( policy );
+        ASSERT_EQ( drain(), std::vector<std::string>( { "payload 3", "payload 1", "payload 2", "payload 0" } ) );
+        policy.priorityFirst = false;
+        testSend.setDrainPolicy( policy );
+        ASSERT_EQ( drain(), std::vector<std::string>( { "payload 3", "payload 2", "payload 1", "payload 0" } ) );
+
+        persistencyPtr->erase( DataType::EDGE_TO_CLOUD_PAYLOAD );
+    }
+}
+
+TEST( PayloadManagerTest, TestDeferredCompression )
+{
+    char buffer[PATH_MAX];
+    if ( getcwd( buffer, sizeof( buffer ) ) != NULL )
+    {
+        std::string testData( 100, 'a' );
+        // Segments of one payload each
+        const std::shared_ptr<CacheAndPersist> persistencyPtr = std::make_shared<CacheAndPersist>(
+            std::string( buffer ),
+            131072,
+            SegmentedLog::RECORD_HEADER_SIZE + sizeof( PayloadHeader ) + testData.size() );
+        persistencyPtr->init();
+        persistencyPtr->erase( DataType::EDGE_TO_CLOUD_PAYLOAD );
+        PayloadManager testSend( persistencyPtr );
+        testSend.setDeferredCompression( true );
+        // Run length encoding of a byte repeated up to 255 times
+        testSend.setStorageCodec(
+            []( const uint8_t *input, size_t size, std::vector<uint8_t> &out ) {
+                out.clear();
+                for ( size_t i = 0; i < size; )
+                {
+                    size_t count = 1;
+                    while ( ( i + count < size ) && ( count < 255 ) && ( input[i + count] == input[i] ) )
+                    {
+                        count++;
+                    }
+                    out.push_back( static_cast<uint8_t>( count ) );
+                    out.push_back( input[i] );
+                    i += count;
+                }
+                return true;
+            },
+            []( const uint8_t *input, size_t size, std::vector<uint8_t> &out ) {
+                out.clear();
+                for ( size_t i = 0; i + 1 < size; i += 2 )
+                {
+                    out.insert( out.end(), input[i], input[i + 1] );
+                }
+                return true;
+            } );
+
+        CollectionSchemeParams collectionSchemeParams;
+        collectionSchemeParams.persist = true;
+        collectionSchemeParams.compression = false;
+        for ( int i = 0; i < 2; i++ )
+        {
+            ASSERT_TRUE( testSend.storeData(
+                reinterpret_cast<const uint8_t *>( testData.data() ), testData.size(), collectionSchemeParams ) );
+        }
+        auto segments = persistencyPtr->getCollectedDataSegments();
+        ASSERT_EQ( segments.size(), 2 );
+        // Stored uncompressed
+        auto sizeBefore = persistencyPtr->getSize( DataType::EDGE_TO_CLOUD_PAYLOAD );
+        ASSERT_EQ( sizeBefore, 2 * ( SegmentedLog::RECORD_HEADER_SIZE + sizeof( PayloadHeader ) + testData.size() ) );
+
+        size_t savedBytes = 0;
+        ASSERT_EQ( testSend.compactSegment( segments[0].id, savedBytes ), ErrorCode::SUCCESS );
+        ASSERT_EQ( savedBytes, testData.size() - 2 );
+        ASSERT_EQ( persistencyPtr->getSize( DataType::EDGE_TO_CLOUD_PAYLOAD ), sizeBefore - savedBytes );
+        // Already compacted, nothing left to save
+        ASSERT_EQ( testSend.compactSegment( segments[0].id, savedBytes ), ErrorCode::SUCCESS );
+        ASSERT_EQ( savedBytes, 0 );
+
+        PersistedPayloadChunk chunk;
+        ASSERT_EQ( testSend.retrieveNext( chunk, 1 ), ErrorCode::SUCCESS );
+        ASSERT_EQ( chunk.segmentId, segments[0].id );
+        ASSERT_EQ( std::string( chunk.payloads[0]->begin(), chunk.payloads[0]->end() ), testData );
+        // The segment of the retrieved chunk is not compacted until the next retrieval
+        ASSERT_EQ( testSend.compactSegment( segments[0].id, savedBytes ), ErrorCode::EMPTY );
+        ASSERT_EQ( testSend.acknowledge( chunk ), ErrorCode::SUCCESS );
+
+        // Still written to until the next payload is stored
+        ASSERT_EQ( testSend.compactSegment( segments[1].id, savedBytes ), ErrorCode::EMPTY );
+        ASSERT_TRUE( testSend.storeData(
+            reinterpret_cast<const uint8_t *>( testData.data() ), testData.size(), collectionSchemeParams ) );
+        ASSERT_EQ( testSend.compactSegment( segments[1].id, savedBytes ), ErrorCode::SUCCESS );
+        ASSERT_EQ( savedBytes, testData.size() - 2 );
+        ASSERT_EQ( testSend.retrieveNext( chunk, 1 ), ErrorCode::SUCCESS );
+        ASSERT_EQ( std::string( chunk.payloads[0]->begin(), chunk.payloads[0]->end() ), testData );
+
+        persistencyPtr->erase( DataType::EDGE_TO_CLOUD_PAYLOAD );
+    }
+}
+
+TEST( PayloadManagerTest, TestStoreBatch )
+{
+    char buffer[PATH_MAX];
+    if ( getcwd( buffer, sizeof( buffer ) ) != NULL )
+    {
+        const std::shared_ptr<CacheAndPersist> persistencyPtr =
+            std::make_shared<CacheAndPersist>( std::string( buffer ), 131072 );
+        persistencyPtr->init();
+        persistencyPtr->erase( DataType::EDGE_TO_CLOUD_PAYLOAD );
+        PayloadManager testSend( persistencyPtr );
+
+        CollectionSchemeParams collectionSchemeParams;
+        collectionSchemeParams.persist = true;
+        collectionSchemeParams.compression = false;
+
+        PayloadBufferPool pool;
+        std::vector<PayloadBufferPtr> batch;
+        std::vector<std::string> testData = { "payload 1", "payload 22", "payload 333" };
+        for ( const auto &data : testData )
+        {
+            batch.emplace_back( pool.acquire() );
+            batch.back()->assign( data.begin(), data.end() );
+        }
+        ASSERT_FALSE( testSend.storeBatch( {}, collectionSchemeParams ) );
+        ASSERT_TRUE( testSend.storeBatch( batch, collectionSchemeParams ) );
+
+        // All payloads are read back from the one record on their own
+        std::vector<PayloadBufferPtr> payloads;
+        ASSERT_EQ( testSend.retrieveData( payloads ), ErrorCode::SUCCESS );
+        ASSERT_EQ( payloads.size(), testData.size() );
+        for ( size_t i = 0; i < testData.size(); i++ )
+        {
+            ASSERT_EQ( std::string( payloads[i]->begin(), payloads[i]->end() ), testData[i] );
+        }
+
+        collectionSchemeParams.persist = false;
+        ASSERT_FALSE( testSend.storeBatch( batch, collectionSchemeParams ) );
+        persistencyPtr->erase( DataType::EDGE_TO_CLOUD_PAYLOAD );
+    }
+}
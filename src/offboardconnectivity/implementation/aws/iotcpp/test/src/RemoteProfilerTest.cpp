@@ -12,12 +12,17 @@
  */
 
 #include "RemoteProfiler.h"
+#include "StallWatchdog.h"
 #include <chrono>
 #include <functional>
 #include <gtest/gtest.h>
 #include <iostream>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <snappy.h>
 #include <thread>
+#include <vector>
 
 using namespace Aws::IoTFleetWise::OffboardConnectivity;
 
@@ -85,4 +90,184 @@ TEST( RemoteProfilerTest, MetricsUpload )
     }
 
     std::this_thread::sleep_for( std::chrono::milliseconds( 1500 ) );
-}
\ No newline at end of file
+}
+TEST( RemoteProfilerTest, BinaryMetricsUpload )
+{
+    auto mockMetricsSender = std::make_shared<MockSender>();
+    std::atomic<int> payloads( 0 );
+    mockMetricsSender->mCallback = [&]( const std::uint8_t *buf, size_t size ) -> ConnectivityError {
+        std::string payload;
+        EXPECT_TRUE( snappy::Uncompress( reinterpret_cast<const char *>( buf ), size, &payload ) );
+        EXPECT_EQ( payload.substr( 0, 3 ), "FWM" );
+        // The prefix is sent once in the header
+        EXPECT_NE( payload.find( "Test" ), std::string::npos );
+        // The names are only sent in the first payload
+        EXPECT_EQ( payload.find( "CpuPercentageSum" ) != std::string::npos, payloads == 0 );
+        EXPECT_EQ( payload.find( "MemoryMaxResidentRam" ), std::string::npos );
+        payloads++;
+        return ConnectivityError::Success;
+    };
+    RemoteProfiler profiler( mockMetricsSender, nullptr, 50, 0, LogLevel::Off, "Test" );
+    profiler.enableBinaryMetrics( 200, { "Cpu" } );
+    ASSERT_TRUE( profiler.start() );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 500 ) );
+    ASSERT_TRUE( profiler.stop() );
+    // Samples every 50 ms are uploaded in about two batches plus the one on stop
+    ASSERT_GE( payloads, 1 );
+    ASSERT_LE( payloads, 4 );
+}
+
+TEST( RemoteProfilerTest, StallRecordsUploadedWithLogs )
+{
+    auto mockMetricsSender = std::make_shared<MockSender>();
+    mockMetricsSender->mCallback = []( const std::uint8_t *, size_t ) -> ConnectivityError {
+        return ConnectivityError::Success;
+    };
+    auto mockLogSender = std::make_shared<MockSender>();
+    std::mutex logsMutex;
+    std::vector<Json::Value> stallLogs;
+    mockLogSender->mCallback = [&]( const std::uint8_t *buf, size_t size ) -> ConnectivityError {
+        Json::Reader reader;
+        Json::Value root;
+        EXPECT_TRUE( reader.parse( std::string( reinterpret_cast<const char *>( buf ), size ), root ) );
+        std::lock_guard<std::mutex> lock( logsMutex );
+        for ( const auto &log : root[RemoteProfiler::NAME_TOP_LEVEL_LOG_ARRAY] )
+        {
+            if ( log["logFunction"].asString() == "StallWatchdog" )
+            {
+                stallLogs.push_back( log );
+            }
+        }
+        return ConnectivityError::Success;
+    };
+
+    auto &watchdog = StallWatchdog::get();
+    watchdog.takeRecords();
+    watchdog.setThreshold( 10 );
+    auto loopId = watchdog.registerLoop( "fwTestLoop" );
+    watchdog.enter( loopId, "slowStage" );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 30 ) );
+    watchdog.idle( loopId );
+    watchdog.unregisterLoop( loopId );
+    watchdog.setThreshold( 0 );
+
+    // Uploaded even though the log level threshold filters all other logs
+    RemoteProfiler profiler( mockMetricsSender, mockLogSender, 1000, 50, LogLevel::Error, "Test" );
+    ASSERT_TRUE( profiler.start() );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 200 ) );
+    ASSERT_TRUE( profiler.stop() );
+
+    std::lock_guard<std::mutex> lock( logsMutex );
+    ASSERT_EQ( stallLogs.size(), 1 );
+    ASSERT_EQ( stallLogs[0]["loop"].asString(), "fwTestLoop" );
+    ASSERT_EQ( stallLogs[0]["stage"].asString(), "slowStage" );
+    ASSERT_GE( stallLogs[0]["durationMs"].asUInt64(), 10 );
+    ASSERT_FALSE( stallLogs[0]["ongoing"].asBool() );
+}
+
+TEST( RemoteProfilerTest, RepeatedLogsCountedInCompressedBatch )
+{
+    auto mockMetricsSender = std::make_shared<MockSender>();
+    mockMetricsSender->mCallback = []( const std::uint8_t *, size_t ) -> ConnectivityError {
+        return ConnectivityError::Success;
+    };
+    auto mockLogSender = std::make_shared<MockSender>();
+    std::mutex logsMutex;
+    std::vector<Json::Value> logs;
+    mockLogSender->mCallback = [&]( const std::uint8_t *buf, size_t size ) -> ConnectivityError {
+        std::string payload;
+        EXPECT_TRUE( snappy::Uncompress( reinterpret_cast<const char *>( buf ), size, &payload ) );
+        Json::Reader reader;
+        Json::Value root;
+        EXPECT_TRUE( reader.parse( payload, root ) );
+        std::lock_guard<std::mutex> lock( logsMutex );
+        for ( const auto &log : root[RemoteProfiler::NAME_TOP_LEVEL_LOG_ARRAY] )
+        {
+            logs.push_back( log );
+        }
+        return ConnectivityError::Success;
+    };
+
+    RemoteProfiler profiler( mockMetricsSender, mockLogSender, 50, 10000, LogLevel::Warning, "Test" );
+    profiler.enableLogCompression();
+    // Filled before the start, the messages above the capacity of the ring are dropped
+    for ( size_t i = 0; i < RemoteProfiler::LOG_RING_CAPACITY + 10; i++ )
+    {
+        profiler.logMessage( LogLevel::Error, "Test::repeated", "same message" );
+    }
+    profiler.logMessage( LogLevel::Info, "Test::filtered", "below the threshold" );
+    ASSERT_EQ( profiler.getDroppedLogCount(), 10 );
+    ASSERT_TRUE( profiler.start() );
+    // Give the thread of the profiler the time to empty the ring
+    std::this_thread::sleep_for( std::chrono::milliseconds( 100 ) );
+    profiler.logMessage( LogLevel::Error, "Test::repeated", "same message" );
+    // Logged from several threads at once, fewer than the capacity of the ring so that none is dropped
+    std::vector<std::thread> threads;
+    for ( int i = 0; i < 3; i++ )
+    {
+        threads.emplace_back( [&profiler, i]() {
+            for ( int j = 0; j < 100; j++ )
+            {
+                profiler.logMessage( LogLevel::Warning, "Test::thread", "message " + std::to_string( i ) );
+            }
+        } );
+    }
+    for ( auto &thread : threads )
+    {
+        thread.join();
+    }
+    ASSERT_EQ( profiler.getDroppedLogCount(), 10 );
+    ASSERT_TRUE( profiler.stop() );
+
+    std::lock_guard<std::mutex> lock( logsMutex );
+    std::map<std::string, uint32_t> counts;
+    std::map<std::string, uint32_t> nodes;
+    for ( const auto &log : logs )
+    {
+        auto key = log["logFunction"].asString() + ":" + log["logEntry"].asString();
+        counts[key] += log.get( "count", 1 ).asUInt();
+        nodes[key]++;
+    }
+    ASSERT_EQ( counts.size(), 5 );
+    ASSERT_EQ( counts["Test::repeated:same message"], RemoteProfiler::LOG_RING_CAPACITY + 1 );
+    for ( int i = 0; i < 3; i++ )
+    {
+        // All were logged between two uploads, so each distinct message is uploaded once with its count
+        ASSERT_EQ( counts["Test::thread:message " + std::to_string( i )], 100 );
+        ASSERT_EQ( nodes["Test::thread:message " + std::to_string( i )], 1 );
+    }
+    ASSERT_EQ( counts["RemoteProfiler::sendLogsOut:10 log messages were dropped"], 1 );
+}
+
+TEST( RemoteProfilerTest, LogUplinkLimitDropsBatches )
+{
+    auto mockMetricsSender = std::make_shared<MockSender>();
+    mockMetricsSender->mCallback = []( const std::uint8_t *, size_t ) -> ConnectivityError {
+        return ConnectivityError::Success;
+    };
+    auto mockLogSender = std::make_shared<MockSender>();
+    std::atomic<int> batches( 0 );
+    mockLogSender->mCallback = [&]( const std::uint8_t *, size_t ) -> ConnectivityError {
+        batches++;
+        return ConnectivityError::Success;
+    };
+
+    RemoteProfiler profiler( mockMetricsSender, mockLogSender, 1000, 50, LogLevel::Trace, "Test" );
+    // The first batch empties the bucket and leaves it in debt for several seconds
+    profiler.setLogUplinkLimit( 100, 100 );
+    ASSERT_TRUE( profiler.start() );
+    for ( int i = 0; i < 10; i++ )
+    {
+        profiler.logMessage( LogLevel::Info, "Test::first", "message " + std::to_string( i ) );
+    }
+    std::this_thread::sleep_for( std::chrono::milliseconds( 200 ) );
+    ASSERT_EQ( batches, 1 );
+    for ( int i = 0; i < 10; i++ )
+    {
+        profiler.logMessage( LogLevel::Info, "Test::second", "message " + std::to_string( i ) );
+    }
+    std::this_thread::sleep_for( std::chrono::milliseconds( 200 ) );
+    ASSERT_TRUE( profiler.stop() );
+    ASSERT_EQ( batches, 1 );
+    ASSERT_EQ( profiler.getDroppedLogCount(), 10 );
+}
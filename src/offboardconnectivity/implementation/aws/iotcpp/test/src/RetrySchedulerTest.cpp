@@ -0,0 +1,140 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "RetryScheduler.h"
+#include "RetryThread.h"
+#include <atomic>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace Aws::IoTFleetWise::OffboardConnectivityAwsIot;
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+class CountingRetryable : public IRetryable
+{
+public:
+    CountingRetryable( int failures, RetryStatus result = RetryStatus::SUCCESS )
+        : mFailures( failures )
+        , mResult( result )
+    {
+    }
+
+    RetryStatus
+    attempt() override
+    {
+        if ( mAttempts++ < mFailures )
+        {
+            return RetryStatus::RETRY;
+        }
+        return mResult;
+    }
+
+    void
+    onFinished( RetryStatus code ) override
+    {
+        mFinishedCode = code;
+        mFinished++;
+    }
+
+    const int mFailures;
+    const RetryStatus mResult;
+    std::atomic<int> mAttempts{ 0 };
+    std::atomic<int> mFinished{ 0 };
+    std::atomic<RetryStatus> mFinishedCode{ RetryStatus::RETRY };
+};
+
+static void
+waitUntilFinished( const CountingRetryable &retryable )
+{
+    for ( int i = 0; ( i < 500 ) && ( retryable.mFinished == 0 ); i++ )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+    }
+}
+
+TEST( RetrySchedulerTest, RetriesUntilSuccess )
+{
+    CountingRetryable retryable( 3 );
+    RetryThread retryThread( retryable, 10, 40 );
+    ASSERT_TRUE( retryThread.start() );
+    waitUntilFinished( retryable );
+    ASSERT_EQ( retryable.mAttempts, 4 );
+    ASSERT_EQ( retryable.mFinished, 1 );
+    ASSERT_EQ( retryable.mFinishedCode, RetryStatus::SUCCESS );
+    ASSERT_FALSE( retryThread.isAlive() );
+    ASSERT_TRUE( retryThread.stop() );
+    ASSERT_EQ( retryable.mFinished, 1 );
+}
+
+TEST( RetrySchedulerTest, UnrecoverableFailureAborts )
+{
+    CountingRetryable retryable( 1, RetryStatus::ABORT );
+    RetryThread retryThread( retryable, 10, 10 );
+    ASSERT_TRUE( retryThread.start() );
+    waitUntilFinished( retryable );
+    ASSERT_EQ( retryable.mAttempts, 2 );
+    ASSERT_EQ( retryable.mFinishedCode, RetryStatus::ABORT );
+}
+
+TEST( RetrySchedulerTest, StopAbortsWaitingRetries )
+{
+    CountingRetryable retryable( 1000 );
+    RetryThread retryThread( retryable, 10000, 10000 );
+    ASSERT_TRUE( retryThread.start() );
+    while ( retryable.mAttempts == 0 )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+    ASSERT_TRUE( retryThread.isAlive() );
+    ASSERT_TRUE( retryThread.stop() );
+    ASSERT_FALSE( retryThread.isAlive() );
+    ASSERT_EQ( retryable.mFinished, 1 );
+    ASSERT_EQ( retryable.mFinishedCode, RetryStatus::ABORT );
+    ASSERT_EQ( retryable.mAttempts, 1 );
+}
+
+TEST( RetrySchedulerTest, ManyRetryablesShareTheWorkers )
+{
+    std::vector<std::unique_ptr<CountingRetryable>> retryables;
+    std::vector<std::unique_ptr<RetryThread>> retryThreads;
+    for ( int i = 0; i < 50; i++ )
+    {
+        retryables.emplace_back( new CountingRetryable( 2 ) );
+        retryThreads.emplace_back( new RetryThread( *retryables.back(), 10, 20 ) );
+        ASSERT_TRUE( retryThreads.back()->start() );
+    }
+    for ( auto &retryable : retryables )
+    {
+        waitUntilFinished( *retryable );
+        ASSERT_EQ( retryable->mAttempts, 3 );
+        ASSERT_EQ( retryable->mFinishedCode, RetryStatus::SUCCESS );
+    }
+}
+
+TEST( RetrySchedulerTest, BackoffIsJittered )
+{
+    auto &scheduler = RetryScheduler::getInstance();
+    bool differs = false;
+    auto first = scheduler.getJitteredBackoffMs( 1000 );
+    for ( int i = 0; i < 100; i++ )
+    {
+        auto backoff = scheduler.getJitteredBackoffMs( 1000 );
+        ASSERT_GE( backoff, 500 );
+        ASSERT_LE( backoff, 1000 );
+        differs = differs || ( backoff != first );
+    }
+    ASSERT_TRUE( differs );
+}
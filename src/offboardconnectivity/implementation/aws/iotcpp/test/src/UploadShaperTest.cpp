@@ -0,0 +1,177 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "UploadShaper.h"
+#include <atomic>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace Aws::IoTFleetWise::OffboardConnectivityAwsIot;
+
+TEST( UploadShaperTest, UnlimitedTopicIsNotQueued )
+{
+    UploadShaper shaper{ UploadRateLimit() };
+    auto topic = shaper.addTopic( UploadRateLimit() );
+    for ( int i = 0; i < 100; i++ )
+    {
+        ASSERT_TRUE( shaper.tryAcquire( topic, 100000 ) );
+    }
+}
+
+TEST( UploadShaperTest, PublishesScheduledInOrderWithoutBlocking )
+{
+    // Burst of 2 publishes, then 20 publishes per second
+    UploadRateLimit topicLimit;
+    topicLimit.publishesPerSecond = 20;
+    topicLimit.burstPublishes = 2;
+    UploadShaper shaper{ UploadRateLimit() };
+    auto topic = shaper.addTopic( topicLimit );
+    ASSERT_TRUE( shaper.start() );
+    ASSERT_TRUE( shaper.isAlive() );
+
+    ASSERT_TRUE( shaper.tryAcquire( topic, 10 ) );
+    ASSERT_TRUE( shaper.tryAcquire( topic, 10 ) );
+    ASSERT_FALSE( shaper.tryAcquire( topic, 10 ) );
+
+    std::mutex mutex;
+    std::vector<int> published;
+    auto start = std::chrono::steady_clock::now();
+    for ( int i = 0; i < 4; i++ )
+    {
+        ASSERT_TRUE( shaper.schedule( topic, 10, [&, i]() {
+            std::lock_guard<std::mutex> lock( mutex );
+            published.push_back( i );
+        } ) );
+    }
+    // Scheduling returns right away
+    ASSERT_LT( std::chrono::steady_clock::now() - start, std::chrono::milliseconds( 40 ) );
+    ASSERT_EQ( shaper.getQueuedBytes(), 40 );
+    // Later publishes of the topic wait behind the queued ones
+    ASSERT_FALSE( shaper.tryAcquire( topic, 10 ) );
+
+    while ( shaper.getQueuedBytes() > 0 )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+    }
+    // 4 publishes at 20 per second take at least 150 ms
+    ASSERT_GE( std::chrono::steady_clock::now() - start, std::chrono::milliseconds( 150 ) );
+    ASSERT_TRUE( shaper.stop() );
+    ASSERT_EQ( published, std::vector<int>( { 0, 1, 2, 3 } ) );
+}
+
+TEST( UploadShaperTest, LinkLimitSharedByTopics )
+{
+    UploadRateLimit linkLimit;
+    linkLimit.bytesPerSecond = 1000;
+    linkLimit.burstBytes = 1000;
+    UploadShaper shaper( linkLimit );
+    auto topic1 = shaper.addTopic( UploadRateLimit() );
+    auto topic2 = shaper.addTopic( UploadRateLimit() );
+    ASSERT_TRUE( shaper.tryAcquire( topic1, 800 ) );
+    ASSERT_FALSE( shaper.tryAcquire( topic2, 800 ) );
+    ASSERT_TRUE( shaper.tryAcquire( topic2, 100 ) );
+}
+
+TEST( UploadShaperTest, ChangeLimitsAtRuntime )
+{
+    UploadRateLimit linkLimit;
+    linkLimit.bytesPerSecond = 1;
+    UploadShaper shaper( linkLimit );
+    auto topic = shaper.addTopic( UploadRateLimit() );
+    ASSERT_TRUE( shaper.start() );
+    ASSERT_TRUE( shaper.tryAcquire( topic, 1 ) );
+    std::atomic<int> published{ 0 };
+    ASSERT_TRUE( shaper.schedule( topic, 60, [&]() { published++; } ) );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+    ASSERT_EQ( published, 0 );
+
+    // The waiting publish is done right after the link limit is lifted
+    shaper.setLinkLimit( UploadRateLimit() );
+    for ( int i = 0; ( i < 100 ) && ( published == 0 ); i++ )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+    }
+    ASSERT_EQ( published, 1 );
+
+    UploadRateLimit topicLimit;
+    topicLimit.bytesPerSecond = 1000;
+    topicLimit.burstBytes = 1000;
+    ASSERT_TRUE( shaper.setTopicLimit( topic, topicLimit ) );
+    ASSERT_FALSE( shaper.setTopicLimit( topic + 1, topicLimit ) );
+    ASSERT_TRUE( shaper.tryAcquire( topic, 800 ) );
+    ASSERT_FALSE( shaper.tryAcquire( topic, 800 ) );
+    ASSERT_TRUE( shaper.stop() );
+}
+
+TEST( UploadShaperTest, QueueFullAndStopHandsOverRemaining )
+{
+    UploadRateLimit linkLimit;
+    linkLimit.bytesPerSecond = 1;
+    UploadShaper shaper( linkLimit, 100 );
+    auto topic = shaper.addTopic( UploadRateLimit() );
+    ASSERT_TRUE( shaper.start() );
+    ASSERT_TRUE( shaper.tryAcquire( topic, 1 ) );
+
+    std::atomic<int> published{ 0 };
+    ASSERT_TRUE( shaper.schedule( topic, 60, [&]() { published++; } ) );
+    ASSERT_FALSE( shaper.schedule( topic, 60, [&]() { published++; } ) );
+    ASSERT_TRUE( shaper.schedule( topic, 40, [&]() { published++; } ) );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+    ASSERT_EQ( published, 0 );
+
+    ASSERT_TRUE( shaper.stop() );
+    ASSERT_EQ( published, 2 );
+    ASSERT_EQ( shaper.getQueuedBytes(), 0 );
+}
+
+TEST( UploadShaperTest, InFlightWindowQueuesPublishesUntilCompleted )
+{
+    UploadShaper shaper( UploadRateLimit(), UploadShaper::DEFAULT_MAX_QUEUED_BYTES, 2 );
+    auto topic = shaper.addTopic( UploadRateLimit() );
+    ASSERT_TRUE( shaper.start() );
+    ASSERT_TRUE( shaper.tryAcquire( topic, 10 ) );
+    ASSERT_TRUE( shaper.tryAcquire( topic, 10 ) );
+    // The window is full
+    ASSERT_FALSE( shaper.tryAcquire( topic, 10 ) );
+    ASSERT_EQ( shaper.getInFlightPublishes(), 2 );
+
+    std::atomic<int> published{ 0 };
+    ASSERT_TRUE( shaper.schedule( topic, 10, [&]() { published++; } ) );
+    ASSERT_TRUE( shaper.schedule( topic, 10, [&]() { published++; } ) );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+    ASSERT_EQ( published, 0 );
+
+    // Each completion lets one queued publish go
+    shaper.publishCompleted();
+    while ( published < 1 )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+    std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+    ASSERT_EQ( published, 1 );
+    ASSERT_EQ( shaper.getInFlightPublishes(), 2 );
+
+    shaper.publishCompleted();
+    while ( published < 2 )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+    ASSERT_TRUE( shaper.stop() );
+    shaper.publishCompleted();
+    shaper.publishCompleted();
+    ASSERT_EQ( shaper.getInFlightPublishes(), 0 );
+    ASSERT_TRUE( shaper.tryAcquire( topic, 10 ) );
+}
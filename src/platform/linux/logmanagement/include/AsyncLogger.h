@@ -0,0 +1,153 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+#if defined( IOTFLEETWISE_LINUX )
+// Includes
+#include "ILogger.h"
+#include "LogLevel.h"
+#include "Signal.h"
+#include "Thread.h"
+#include "TimeTypes.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace Platform
+{
+namespace Linux
+{
+/**
+ * @brief Writes log messages to the standard output on its own thread
+ *
+ * The logging thread only copies a compact record, i.e. level, time, thread ID and the truncated function and
+ * message, into a fixed ring of records. Multiple threads can log at the same time without a lock. The writer thread
+ * formats the records and writes them to the standard output in the same format as ConsoleLogger, so a thread
+ * reading from a bus never waits for console I/O. If the ring is full, the record is dropped and the drop counter
+ * increments instead of blocking the logging thread. The writer reports the number of dropped records with the next
+ * message it writes.
+ *
+ * While the writer is running, all messages of ConsoleLogger are routed through it.
+ */
+class AsyncLogger : public ILogger
+{
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 1024;
+    static constexpr size_t MAX_FUNCTION_LENGTH = 63;
+    static constexpr size_t MAX_LOG_ENTRY_LENGTH = 447;
+    static constexpr uint32_t IDLE_TIME_MS = 100;
+
+    /**
+     * @param capacity number of records the ring can hold, rounded up to a power of two
+     */
+    explicit AsyncLogger( size_t capacity = DEFAULT_CAPACITY );
+    ~AsyncLogger() override;
+
+    AsyncLogger( const AsyncLogger & ) = delete;
+    AsyncLogger &operator=( const AsyncLogger & ) = delete;
+    AsyncLogger( AsyncLogger && ) = delete;
+    AsyncLogger &operator=( AsyncLogger && ) = delete;
+
+    /**
+     * @brief Starts the writer thread and routes the messages of ConsoleLogger through this logger
+     * @return True if the thread is running
+     */
+    bool start();
+
+    /**
+     * @brief Routes the messages of ConsoleLogger back to the standard output, writes the queued records and stops
+     * the thread. Messages logged by other threads while they stop might not be written.
+     * @return True if the thread stopped
+     */
+    bool stop();
+
+    bool isAlive();
+
+    /**
+     * @brief Copies the message into the ring without waiting. Drops it if the ring is full.
+     * The level is not checked again, ConsoleLogger filters the messages before.
+     * @param level log level
+     * @param function calling function, truncated to MAX_FUNCTION_LENGTH characters
+     * @param logEntry actual message, truncated to MAX_LOG_ENTRY_LENGTH characters
+     */
+    void logMessage( LogLevel level, const std::string &function, const std::string &logEntry ) override;
+
+    /**
+     * @brief Number of records dropped because the ring was full since the logger was created
+     */
+    uint64_t
+    getDroppedCount() const
+    {
+        return mDroppedCount.load( std::memory_order_relaxed );
+    }
+
+    size_t
+    getCapacity() const
+    {
+        return mCapacity;
+    }
+
+    /**
+     * @brief Writes all records currently in the ring. Only called by the writer thread, or if it is not running.
+     * @return number of written records
+     */
+    size_t flush();
+
+private:
+    struct Record
+    {
+        // Position in the ring the slot can be written at, or position + 1 once the record is complete
+        std::atomic<uint64_t> sequence{ 0 };
+        LogLevel level{ LogLevel::Trace };
+        uint64_t threadId{ 0 };
+        Timestamp time{ 0 };
+        char function[MAX_FUNCTION_LENGTH + 1];
+        char logEntry[MAX_LOG_ENTRY_LENGTH + 1];
+    };
+
+    static void doWork( void *data );
+    static void writeRecord( const Record &record );
+    void reportDropped();
+    bool shouldStop() const;
+
+    size_t mCapacity;
+    std::unique_ptr<Record[]> mRecords;
+    // Producers and the writer thread are kept on separate cache lines
+    alignas( 64 ) std::atomic<uint64_t> mEnqueuePosition{ 0 };
+    alignas( 64 ) uint64_t mDequeuePosition{ 0 };
+    std::atomic<uint64_t> mDroppedCount{ 0 };
+    uint64_t mReportedDroppedCount{ 0 };
+    Thread mThread;
+    std::atomic<bool> mShouldStop{ false };
+    std::mutex mThreadMutex;
+    Signal mWait;
+};
+
+/**
+ * @brief Routes the messages of ConsoleLogger through the async logger, or back to the standard output if nullptr
+ */
+extern void setAsyncLogging( AsyncLogger *asyncLogger );
+
+} // namespace Linux
+} // namespace Platform
+} // namespace IoTFleetWise
+} // namespace Aws
+#endif // IOTFLEETWISE_LINUX
@@ -55,6 +55,7 @@ public:
  * @param logForwarder the instance that should be receive Logs
  */
 extern void setLogForwarding( ILogger *logForwarder );
+extern void forwardLog( LogLevel level, const std::string &function, const std::string &logEntry );
 
 } // namespace Linux
 } // namespace Platform
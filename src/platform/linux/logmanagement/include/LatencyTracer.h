@@ -0,0 +1,130 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "FastClock.h"
+#include <atomic>
+#include <cstdint>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace Platform
+{
+namespace Linux
+{
+/**
+ * @brief Stages a sampled frame passes on its way to the cloud, in the order they are passed
+ */
+enum class LatencyStage : uint8_t
+{
+    START = 0, // kernel reception timestamp of the frame
+    DECODE,    // frame decoded into signals
+    QUEUE_POP, // signal popped by the inspection thread
+    TRIGGER,   // signal collected for a triggered condition
+    SERIALIZE, // payload with the signal serialized
+    PUBLISH,   // payload handed over to the MQTT client
+    PUBACK     // publish completed
+};
+
+/**
+ * @brief Follows a sample of the received frames through the whole pipeline
+ *
+ * Every samplingInterval-th frame of a consumer thread gets a trace ID, which is passed on with its signals and the
+ * payload they end up in. Every stage records the time since the stage before in a TraceHistogram E2E_*_US, so the
+ * distributions are printed and sent to the RemoteProfiler with the other histograms. A stage that is not passed
+ * adds its time to the next one. The trace ID 0 means not traced, so with a sampling interval of 0 the cost is a
+ * relaxed atomic load per frame.
+ *
+ * The traces are kept in a small table indexed by the trace ID. A trace whose slot was taken by a newer trace is
+ * not followed anymore.
+ */
+class LatencyTracer
+{
+public:
+    static LatencyTracer &get();
+
+    /**
+     * @brief Sets how often frames are traced
+     * @param interval 1 traces every frame of a consumer thread, 0 disables the tracing
+     */
+    void
+    setSamplingInterval( uint32_t interval )
+    {
+        mSamplingInterval.store( interval, std::memory_order_relaxed );
+    }
+
+    bool
+    isEnabled() const
+    {
+        return mSamplingInterval.load( std::memory_order_relaxed ) != 0U;
+    }
+
+    /**
+     * @brief Starts a trace if the frame is sampled
+     * @param startTimeUs kernel reception timestamp of the frame, system time in microseconds
+     * @return the trace ID, or 0 if the frame is not traced
+     */
+    uint32_t
+    startTrace( uint64_t startTimeUs )
+    {
+        auto interval = mSamplingInterval.load( std::memory_order_relaxed );
+        if ( interval == 0U )
+        {
+            return 0U;
+        }
+        return startSampledTrace( startTimeUs, interval );
+    }
+
+    /**
+     * @brief Records that a traced frame reached a stage. Stages before the last recorded one are ignored.
+     * @param traceId ID from startTrace, nothing is done for 0
+     * @param stage the stage reached
+     * @param timeUs system time in microseconds
+     */
+    void mark( uint32_t traceId, LatencyStage stage, uint64_t timeUs );
+
+    void
+    mark( uint32_t traceId, LatencyStage stage )
+    {
+        if ( traceId != 0U )
+        {
+            mark( traceId, stage, FastClock::systemTimeUs() );
+        }
+    }
+
+    static constexpr uint32_t SLOT_COUNT = 64;
+
+private:
+    struct Slot
+    {
+        std::atomic<uint32_t> mTraceId{ 0 };
+        std::atomic<uint8_t> mStage{ 0 };
+        std::atomic<uint64_t> mStartTimeUs{ 0 };
+        std::atomic<uint64_t> mLastTimeUs{ 0 };
+    };
+
+    uint32_t startSampledTrace( uint64_t startTimeUs, uint32_t interval );
+
+    std::atomic<uint32_t> mSamplingInterval{ 0 };
+    std::atomic<uint32_t> mLastTraceId{ 0 };
+    Slot mSlots[SLOT_COUNT];
+};
+
+} // namespace Linux
+} // namespace Platform
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -16,7 +16,10 @@
 // Includes
 
 #include "ConsoleLogger.h"
+#include "LogLevel.h"
 #include <memory>
+#include <string>
+#include <utility>
 
 namespace Aws
 {
@@ -63,6 +66,75 @@ public:
      */
     void trace( const std::string &function, const std::string &logEntry );
 
+    /**
+     * @brief Whether messages of the level are logged. The level is checked before any string is built.
+     * @param level log level
+     */
+    static bool
+    isLevelEnabled( LogLevel level )
+    {
+        return level >= gSystemWideLogLevel;
+    }
+
+    /**
+     * @brief Logs an Error whose message is only built if errors are logged.
+     * Use this form on the data plane, where messages are built for every frame or evaluation, e.g.
+     * @code mLogger.warn( "Class::function", [&]() { return "Frame " + std::to_string( id ) + " invalid"; } );
+     * @param function Calling function
+     * @param buildLogEntry callable returning the actual message
+     */
+    template <typename LogEntryBuilder, typename = decltype( std::string( std::declval<LogEntryBuilder &>()() ) )>
+    void
+    error( const char *function, LogEntryBuilder &&buildLogEntry )
+    {
+        if ( isLevelEnabled( LogLevel::Error ) )
+        {
+            error( function, std::string( buildLogEntry() ) );
+        }
+    }
+    /**
+     * @brief Logs a Warning whose message is only built if warnings are logged
+     * @param function Calling function
+     * @param buildLogEntry callable returning the actual message
+     */
+    template <typename LogEntryBuilder, typename = decltype( std::string( std::declval<LogEntryBuilder &>()() ) )>
+    void
+    warn( const char *function, LogEntryBuilder &&buildLogEntry )
+    {
+        if ( isLevelEnabled( LogLevel::Warning ) )
+        {
+            warn( function, std::string( buildLogEntry() ) );
+        }
+    }
+    /**
+     * @brief Logs an Info whose message is only built if infos are logged
+     * @param function Calling function
+     * @param buildLogEntry callable returning the actual message
+     */
+    template <typename LogEntryBuilder, typename = decltype( std::string( std::declval<LogEntryBuilder &>()() ) )>
+    void
+    info( const char *function, LogEntryBuilder &&buildLogEntry )
+    {
+        if ( isLevelEnabled( LogLevel::Info ) )
+        {
+            info( function, std::string( buildLogEntry() ) );
+        }
+    }
+    /**
+     * @brief Logs a Trace whose message is only built if traces are logged
+     * @param function Calling function
+     * @param buildLogEntry callable returning the actual message
+     */
+    template <typename LogEntryBuilder, typename = decltype( std::string( std::declval<LogEntryBuilder &>()() ) )>
+    void
+    trace( const char *function, LogEntryBuilder &&buildLogEntry )
+    {
+        if ( isLevelEnabled( LogLevel::Trace ) )
+        {
+            trace( function, std::string( buildLogEntry() ) );
+        }
+    }
+
 private:
     ConsoleLogger mLogger;
 };
@@ -19,7 +19,13 @@
 #include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <time.h>
+#include <vector>
 
 namespace Aws
 {
@@ -87,6 +93,8 @@ enum class TraceVariable
     CE_TOO_MANY_CONDITIONS,
     CE_SIGNAL_ID_OUTBOUND,
     CE_SAMPLE_SIZE_ZERO,
+    CE_SAMPLE_MEMORY_SHRUNK_BUFFERS,
+    CE_CONDITION_EVALUATIONS_DEFERRED,
     GE_COMPARE_PRECISION_ERROR,
     GE_EVALUATE_ERROR_LAT_LON,
     OBD_VIN_ERROR,
@@ -94,6 +102,11 @@ enum class TraceVariable
     OBD_TRA_PID_REQ_ERROR,
     OBD_KEEP_ALIVE_ERROR,
     DISCARDED_FRAMES,
+    CAN_FRAMES_PER_SYSCALL,
+    PERSISTENCY_BYTES_WRITTEN,
+    LOAD_SHEDDING_LEVEL,
+    CAN_DECODED_FRAMES,
+    INSPECTION_EVALUATIONS,
     TRACE_VARIABLE_SIZE
 };
 
@@ -108,6 +121,39 @@ enum class TraceAtomicVariable
     CONNECTION_REJECTED,
     CONNECTION_INTERRUPTED,
     CONNECTION_RESUMED,
+    KERNEL_DROPPED_CAN_FRAMES,
+    EMISSION_POLICY_DROPPED_SIGNALS,
+    TRIGGERED_DATA_POOL_USED,
+    TRIGGERED_DATA_POOL_EXHAUSTED,
+    MQTT_PUBLISHES_IN_FLIGHT,
+    LOAD_SHEDDING_DROPPED_SIGNALS,
+    LOAD_SHEDDING_DROPPED_RAW_FRAMES,
+    QUEUE_FULL_DROPPED_SIGNALS,
+    QUEUE_FULL_DROPPED_RAW_FRAMES,
+    QUEUE_FULL_DROPPED_COLLECTED_DATA,
+    // Bytes and allocations per MemorySubsystem in its order, see MemoryAccounting
+    MEMORY_DECODING_BYTES,
+    MEMORY_DECODING_ALLOCATIONS,
+    MEMORY_INSPECTION_BYTES,
+    MEMORY_INSPECTION_ALLOCATIONS,
+    MEMORY_COLLECTION_BYTES,
+    MEMORY_COLLECTION_ALLOCATIONS,
+    MEMORY_PERSISTENCY_BYTES,
+    MEMORY_PERSISTENCY_ALLOCATIONS,
+    MEMORY_CONNECTIVITY_BYTES,
+    MEMORY_CONNECTIVITY_ALLOCATIONS,
+    MEMORY_CEILING_EXCEEDED,
+    UPLOADED_LIVE_BYTES,
+    UPLOADED_PERSISTED_BYTES,
+    PERSISTENCY_COMPACTED_BYTES,
+    MQTT_PUBLISHED_BYTES,
+    UPLOAD_BACKLOG_BYTES,
+    EXPRESS_QUEUE_FULL,
+    LOOP_STALLS,
+    RECORDER_WRITTEN_BYTES,
+    RECORDER_DROPPED_DATA,
+    LOG_UPLOAD_DROPPED_MESSAGES,
+    REMOTE_INSPECTION_LOST_BATCHES,
     TRACE_ATOMIC_VARIABLE_SIZE
 };
 
@@ -123,8 +169,44 @@ enum class TraceSection
     MANAGER_DECODER_BUILD,
     MANAGER_COLLECTION_BUILD,
     MANAGER_EXTRACTION,
+    PERSISTENCY_FSYNC,
+    DECODER_MANIFEST_BUILD,
+    STARTUP_PERSISTENCY,
+    STARTUP_CONNECTIVITY,
+    STARTUP_REMOTE_PROFILER,
+    STARTUP_INSPECTION,
+    STARTUP_COLLECTION_SCHEME_MANAGER,
+    STARTUP_VEHICLE_DATA_SOURCES,
+    STARTUP_DDS,
+    STARTUP_MQTT_CONNECT,
     TRACE_SECTION_SIZE
 };
+
+/**
+ * Latency distributions defined at compile time used by all other modules
+ * For verbose print to work it needs to be also added to getHistogramName() and getHistogramUnit()
+ * */
+enum class TraceHistogram
+{
+    INSPECTION_EVALUATION_NS = 0, // Time to evaluate all conditions once
+    MQTT_PUBLISH_LATENCY_MS,      // Time from a publish until its completion
+    CAN_DECODE_NS,                // Time to decode a CAN frame or a burst of frames with the same ID
+    CAN_FRAMES_PER_BURST,         // Frames received from the socket with one recvmmsg call
+    INSPECTION_COLLECT_DATA_NS,   // Time to collect the data of a triggered condition
+    PROTO_SERIALIZE_NS,           // Time to serialize a payload
+    COMPRESSION_NS,               // Time to compress a payload
+    MQTT_PUBLISH_NS,              // Time to hand a payload over to the MQTT client
+    MQTT_RECONNECT_MS,            // Time from an interruption of the MQTT connection until it is connected again
+    // Stages of the frames sampled by the LatencyTracer, each from the end of the stage before
+    E2E_DECODE_US,    // From the kernel reception timestamp until the frame is decoded
+    E2E_QUEUE_US,     // Until the decoded signal is popped by the inspection thread
+    E2E_TRIGGER_US,   // Until the signal is collected for a triggered condition
+    E2E_SERIALIZE_US, // Until the payload with the signal is serialized
+    E2E_PUBLISH_US,   // Until the payload is handed over to the MQTT client
+    E2E_PUBACK_US,    // Until the publish completed
+    E2E_TOTAL_US,     // From the kernel reception timestamp until the publish completed
+    TRACE_HISTOGRAM_SIZE
+};
 /**
  * @brief An interface that can be implemented by different classes to store or upload metrics
  */
@@ -168,7 +250,8 @@ public:
      * The inline call is fast and can be used everywhere. Eventually a cache miss
      * can occur.
      *
-     * not thread safe for the same variable being set from different threads
+     * not thread safe for the same variable being set from different threads.
+     * A variable should either be set or added to, the current value is the set value plus everything added.
      * @param variable the variable define in enum TraceVariable
      * @param value the uint64_t value that should be traced
      *
@@ -186,10 +269,11 @@ public:
 
     /**
      * @brief Add to a variable defined in enum TraceVariable to trace its value
-     * The inline call is fast and can be used everywhere. Eventually a cache miss
-     * can occur.
+     * The inline call is fast and can be used everywhere from any thread. The value is added to
+     * a counter owned by the calling thread, so threads adding to the same variable do not contend.
+     * The counters of all threads are summed up when the variables are printed or forwarded, so the
+     * max value of an added variable is the max seen at these times.
      *
-     * not thread safe for the same variable being set from different threads
      * @param variable the variable define in enum TraceVariable
      * @param value the uint64_t value that should be added
      *
@@ -199,16 +283,14 @@ public:
     {
         if ( variable < TraceVariable::TRACE_VARIABLE_SIZE )
         {
-            setVariable( variable, mVariableData[toUType( variable )].mCurrentValue + value );
+            addToShardValue( getThreadShard().mVariableAdded[toUType( variable )], value );
         }
     }
 
     /**
      * @brief Increment a variable defined in enum TraceVariable to trace its value
-     * The inline call is fast and can be used everywhere. Eventually a cache miss
-     * can occur.
+     * The inline call is fast and can be used everywhere from any thread, see addToVariable.
      *
-     * not thread safe for the same variable being set from different threads
      * @param variable the variable define in enum TraceVariable
      *
      */
@@ -308,16 +390,109 @@ public:
      * @return the max value of the current observation window
      *
      */
-    uint64_t
-    getVariableMax( TraceVariable variable )
+    uint64_t getVariableMax( TraceVariable variable );
+
+    /**
+     * @brief Get the current value of a TraceVariable, summed up over all threads
+     * @param variable the TraceVariable which content should be returned.
+     *
+     * @return the current value
+     */
+    uint64_t getVariable( TraceVariable variable );
+
+    /**
+     * @brief Get the current value of a TraceAtomicVariable
+     * @param variable the TraceAtomicVariable which content should be returned.
+     *
+     * @return the current value
+     */
+    uint64_t getAtomicVariable( TraceAtomicVariable variable );
+
+    /**
+     * @brief Record a value, typically a latency, in the distribution of a TraceHistogram
+     *
+     * The value is counted in a log-linear bucket, so the percentiles derived from it are accurate
+     * to 12.5%. Like addToVariable the buckets are owned by the calling thread, so this is cheap enough
+     * for hot paths and can be called from any thread. Values above HISTOGRAM_MAX_VALUE are counted
+     * as HISTOGRAM_MAX_VALUE.
+     *
+     * @param histogram the histogram defined in enum TraceHistogram
+     * @param value the value in the unit of the histogram
+     */
+    void
+    recordHistogram( TraceHistogram histogram, uint64_t value )
     {
-        if ( variable < TraceVariable::TRACE_VARIABLE_SIZE )
+        if ( histogram < TraceHistogram::TRACE_HISTOGRAM_SIZE )
         {
-            return mVariableData[toUType( variable )].mMaxValue;
+            auto &data = getThreadShard().mHistograms[toUType( histogram )];
+            value = std::min( value, HISTOGRAM_MAX_VALUE );
+            addToShardValue( data.mBuckets[getHistogramBucket( value )], 1 );
+            addToShardValue( data.mCount, 1 );
+            addToShardValue( data.mSum, value );
+            if ( value > data.mMax.load( std::memory_order_relaxed ) )
+            {
+                data.mMax.store( value, std::memory_order_relaxed );
+            }
         }
-        return 0;
     }
 
+    /**
+     * @brief Get a percentile of all values recorded in a TraceHistogram since startup
+     * @param histogram the histogram defined in enum TraceHistogram
+     * @param quantile the quantile between 0 and 1, e.g. 0.99 for p99
+     *
+     * @return the upper bound of the bucket containing the percentile, not more than the max recorded value.
+     * 0 if no value was recorded.
+     */
+    uint64_t getHistogramPercentile( TraceHistogram histogram, double quantile );
+
+    /**
+     * @brief Get a percentile of the values recorded in a TraceHistogram since the last startNewObservationWindow
+     * @param histogram the histogram defined in enum TraceHistogram
+     * @param quantile the quantile between 0 and 1, e.g. 0.99 for p99
+     *
+     * @return the upper bound of the bucket containing the percentile. 0 if no value was recorded.
+     */
+    uint64_t getHistogramWindowPercentile( TraceHistogram histogram, double quantile );
+
+    /**
+     * @brief Adds to a variable whose name is only known at runtime, for example because it contains a campaign ID
+     *
+     * Other than the variables of the enums this takes a lock, so it should not be called for every sample.
+     * Variables that reach 0 are removed.
+     *
+     * @param name the name of the variable, forwarded to the IMetricsReceiver with the prefix namedVariable_
+     * @param value the value to add, negative to subtract
+     * @param unit the unit forwarded to the IMetricsReceiver
+     */
+    void addToNamedVariable( const std::string &name, int64_t value, const std::string &unit = "Count" );
+
+    /**
+     * @brief Sets a variable whose name is only known at runtime, for example a value sampled per thread
+     *
+     * Like addToNamedVariable this takes a lock. Other than with addToNamedVariable the variable is also kept if it
+     * is set to 0, until it is removed with removeNamedVariable.
+     *
+     * @param name the name of the variable, forwarded to the IMetricsReceiver with the prefix namedVariable_
+     * @param value the new value
+     * @param unit the unit forwarded to the IMetricsReceiver
+     */
+    void setNamedVariable( const std::string &name, int64_t value, const std::string &unit = "Count" );
+
+    /**
+     * @brief Removes a variable set with setNamedVariable or addToNamedVariable
+     * @param name the name of the variable
+     */
+    void removeNamedVariable( const std::string &name );
+
+    /**
+     * @brief Get the current value of a variable set with addToNamedVariable
+     * @param name the name of the variable
+     *
+     * @return the current value, 0 if the variable is not set
+     */
+    int64_t getNamedVariable( const std::string &name );
+
     /**
      * @brief Start a section which starts a timer until sectionEnd is called
      * The time between sectionBegin and sectionEnd will be traced. So the
@@ -348,6 +523,28 @@ public:
      */
     void sectionEnd( TraceSection section );
 
+    /**
+     * @brief Get the number of times a TraceSection ended since startup
+     * @param section the section defined in enum TraceSection
+     *
+     * @return the number of completed executions
+     */
+    uint32_t getSectionHitCount( TraceSection section ) const;
+
+    /**
+     * @brief Get the duration of the last completed execution of a TraceSection
+     * @param section the section defined in enum TraceSection
+     *
+     * @return the duration in seconds, 0 if the section never ended
+     */
+    double getSectionLastDuration( TraceSection section ) const;
+
+    /**
+     * @brief Get the short name of a TraceSection as it is printed and forwarded
+     * @param section the section defined in enum TraceSection
+     */
+    static const char *getSectionName( TraceSection section );
+
     /**
      * @brief Starts a new observation window for all variables and sections
      *
@@ -374,12 +571,108 @@ public:
      */
     void forwardAllMetricsToMetricsReceiver( IMetricsReceiver *profiler );
 
+    // Values recorded in a TraceHistogram are capped to this
+    static constexpr uint64_t HISTOGRAM_MAX_VALUE = UINT32_MAX;
+
+    class HistogramBaseline;
+
+    /**
+     * @brief Calls for all variables, histograms and named variables the receiver->setMetric with their current
+     * values, independent of the observation windows of print and forwardAllMetricsToMetricsReceiver
+     *
+     * The names are variable_<name>, atomic_<name> and namedVariable_<name> with the current value,
+     * histogramCount_<name> and histogramMax_<name> since startup, and histogramP50_<name>, histogramP99_<name> and
+     * histogramP999_<name> of the values recorded since the previous call with the same baseline.
+     * @param receiver The instance that all data should be sent.
+     * @param baseline The histograms at the previous call of the caller, updated to the current ones
+     */
+    void forwardCurrentValuesToMetricsReceiver( IMetricsReceiver *receiver, HistogramBaseline &baseline );
+
 private:
+    // Every power of two is split into 2^HISTOGRAM_SUB_BUCKET_BITS linear buckets
+    static constexpr uint32_t HISTOGRAM_SUB_BUCKET_BITS = 3;
+    static constexpr uint32_t HISTOGRAM_SUB_BUCKET_COUNT = 1U << HISTOGRAM_SUB_BUCKET_BITS;
+    static constexpr uint32_t HISTOGRAM_BUCKET_COUNT = ( 32U - HISTOGRAM_SUB_BUCKET_BITS + 1U ) *
+                                                       HISTOGRAM_SUB_BUCKET_COUNT;
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    struct HistogramShard
+    {
+        std::atomic<uint64_t> mBuckets[HISTOGRAM_BUCKET_COUNT];
+        std::atomic<uint64_t> mCount;
+        std::atomic<uint64_t> mSum;
+        std::atomic<uint64_t> mMax;
+    };
+
+    /**
+     * @brief The counters of one thread. Only the owning thread writes them, so the writes need no atomic
+     * read-modify-write, the atomics only make the reads while aggregating well defined. The padding keeps
+     * other allocations off the cache lines of the thread.
+     */
+    struct ThreadShard
+    {
+        char mPaddingBegin[CACHE_LINE_SIZE];
+        std::atomic<uint64_t> mVariableAdded[toUType( TraceVariable::TRACE_VARIABLE_SIZE )];
+        HistogramShard mHistograms[toUType( TraceHistogram::TRACE_HISTOGRAM_SIZE )];
+        char mPaddingEnd[CACHE_LINE_SIZE];
+    };
+
+    // Returns the shard of the thread to the free shards when the thread exits, so that its counts are kept and
+    // the shard is reused by the next thread
+    struct ThreadShardReleaser
+    {
+        ThreadShard *mShard{ nullptr };
+        ~ThreadShardReleaser();
+    };
+
+    struct HistogramData
+    {
+        std::vector<uint64_t> mBuckets = std::vector<uint64_t>( HISTOGRAM_BUCKET_COUNT, 0 );
+        uint64_t mCount{ 0 };
+        uint64_t mSum{ 0 };
+        uint64_t mMax{ 0 };
+    };
+
+    static void
+    addToShardValue( std::atomic<uint64_t> &shardValue, uint64_t add )
+    {
+        shardValue.store( shardValue.load( std::memory_order_relaxed ) + add, std::memory_order_relaxed );
+    }
+
+    static uint32_t
+    getHistogramBucket( uint64_t value )
+    {
+        if ( value < HISTOGRAM_SUB_BUCKET_COUNT )
+        {
+            return static_cast<uint32_t>( value );
+        }
+        auto msb = static_cast<uint32_t>( 63 - __builtin_clzll( value ) );
+        auto shift = msb - HISTOGRAM_SUB_BUCKET_BITS;
+        return ( ( shift + 1U ) * HISTOGRAM_SUB_BUCKET_COUNT ) +
+               static_cast<uint32_t>( ( value >> shift ) & ( HISTOGRAM_SUB_BUCKET_COUNT - 1U ) );
+    }
+
+    static uint64_t getHistogramBucketUpperBound( uint32_t bucket );
+
+    ThreadShard &getThreadShard();
+
+    // Sums up the set value and the added values of all threads and updates the max value
+    uint64_t aggregateVariable( TraceVariable variable );
+
+    HistogramData aggregateHistogram( TraceHistogram histogram );
+
+    static uint64_t getPercentile( const HistogramData &data, double quantile );
+
+    // The values recorded since the start of the current observation window, without max
+    HistogramData getHistogramWindow( TraceHistogram histogram, const HistogramData &sinceStartup ) const;
+
     static const char *getVariableName( TraceVariable variable );
 
     static const char *getAtomicVariableName( TraceAtomicVariable variable );
 
-    static const char *getSectionName( TraceSection section );
+    static const char *getHistogramName( TraceHistogram histogram );
+
+    static const char *getHistogramUnit( TraceHistogram histogram );
 
     void updateAllTimeData();
 
@@ -390,7 +683,8 @@ private:
         uint64_t mMaxValueAllTime;
     };
 
-    struct AtomicVariableData
+    // Each atomic variable has its own cache line, so that threads using different variables do not contend
+    struct alignas( CACHE_LINE_SIZE ) AtomicVariableData
     {
         std::atomic<uint64_t> mCurrentValue;
         uint64_t mMaxValue; // The maximum in the current observation window
@@ -417,7 +711,98 @@ private:
 
     struct SectionData mSectionData[toUType( TraceSection::TRACE_SECTION_SIZE )];
 
+    struct NamedVariableData
+    {
+        int64_t mCurrentValue;
+        std::string mUnit;
+    };
+
+    std::mutex mNamedVariablesMutex;
+    std::map<std::string, NamedVariableData> mNamedVariables;
+
+    // Protects the lists of shards and the aggregated values of the variables and histograms
+    std::mutex mShardsMutex;
+    std::vector<std::unique_ptr<ThreadShard>> mShards;
+    std::vector<ThreadShard *> mFreeShards;
+    // The aggregated histograms at the start of the current observation window
+    HistogramData mHistogramWindowStart[toUType( TraceHistogram::TRACE_HISTOGRAM_SIZE )];
+
     LoggingModule mLogger;
+
+public:
+    /**
+     * @brief The histograms a caller of forwardCurrentValuesToMetricsReceiver saw at its previous call, so that
+     * every caller gets the percentiles of its own interval
+     */
+    class HistogramBaseline
+    {
+    private:
+        friend class TraceModule;
+        HistogramData mHistograms[toUType( TraceHistogram::TRACE_HISTOGRAM_SIZE )];
+    };
+};
+
+/**
+ * @brief Times the scope it lives in and records the duration in nanoseconds in a TraceHistogram
+ *
+ * Only 1 in samplingInterval scopes per thread and histogram are timed, so that per-frame or per-evaluation
+ * sections can be timed without reading the clock every time. Not sampled scopes cost a thread local increment.
+ * The clock is CLOCK_MONOTONIC_RAW, which is read through the vDSO without a system call and is not slewed by NTP.
+ */
+class TraceScopedTimer
+{
+public:
+    static constexpr uint32_t DEFAULT_SAMPLING_INTERVAL = 64;
+
+    explicit TraceScopedTimer( TraceHistogram histogram, uint32_t samplingInterval = DEFAULT_SAMPLING_INTERVAL )
+        : mHistogram( histogram )
+    {
+        if ( ( histogram < TraceHistogram::TRACE_HISTOGRAM_SIZE ) && shouldSample( histogram, samplingInterval ) )
+        {
+            mStartTimeNs = getMonotonicRawTimeNs();
+            mSampled = true;
+        }
+    }
+
+    ~TraceScopedTimer()
+    {
+        if ( mSampled )
+        {
+            TraceModule::get().recordHistogram( mHistogram, getMonotonicRawTimeNs() - mStartTimeNs );
+        }
+    }
+
+    TraceScopedTimer( const TraceScopedTimer & ) = delete;
+    TraceScopedTimer &operator=( const TraceScopedTimer & ) = delete;
+    TraceScopedTimer( TraceScopedTimer && ) = delete;
+    TraceScopedTimer &operator=( TraceScopedTimer && ) = delete;
+
+    static uint64_t
+    getMonotonicRawTimeNs()
+    {
+        struct timespec time = {};
+        (void)clock_gettime( CLOCK_MONOTONIC_RAW, &time );
+        return ( static_cast<uint64_t>( time.tv_sec ) * 1000000000U ) + static_cast<uint64_t>( time.tv_nsec );
+    }
+
+private:
+    static bool
+    shouldSample( TraceHistogram histogram, uint32_t samplingInterval )
+    {
+        thread_local uint32_t scopeCounters[toUType( TraceHistogram::TRACE_HISTOGRAM_SIZE )] = {};
+        auto &counter = scopeCounters[toUType( histogram )];
+        counter++;
+        if ( counter >= samplingInterval )
+        {
+            counter = 0;
+            return true;
+        }
+        return false;
+    }
+
+    TraceHistogram mHistogram;
+    uint64_t mStartTimeNs{ 0 };
+    bool mSampled{ false };
 };
 } // namespace Linux
 } // namespace Platform
@@ -0,0 +1,186 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/*
+ * Layout of the shared memory segment the TraceSharedMemoryExporter publishes the trace values to, and the
+ * functions for processes reading it, like fwe-top. The header only depends on the C library and the GCC atomic
+ * builtins, so that it can be copied into C and C++ readers.
+ *
+ * The segment is created by AWS IoT FleetWise Edge under the configured name in /dev/shm and can only be written by
+ * its owner. It holds a table of named values that is rewritten completely at every update. A sequence counter
+ * which is odd during an update lets readers detect that they copied the table while it was written.
+ */
+
+#ifndef FWE_TRACE_SHARED_MEMORY_H
+#define FWE_TRACE_SHARED_MEMORY_H
+
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define FWE_SHM_TRACE_MAGIC 0x46574554U /* "FWET" */
+#define FWE_SHM_TRACE_VERSION 1U
+#define FWE_SHM_TRACE_NAME_SIZE 96U
+#define FWE_SHM_TRACE_UNIT_SIZE 24U
+/* Attempts of fwe_shm_trace_read to copy a table that is not written at the same time */
+#define FWE_SHM_TRACE_READ_ATTEMPTS 100U
+
+/* A named value, the strings are always terminated */
+struct fwe_shm_trace_entry
+{
+    char name[FWE_SHM_TRACE_NAME_SIZE];
+    char unit[FWE_SHM_TRACE_UNIT_SIZE];
+    double value;
+};
+
+struct fwe_shm_trace_header
+{
+    uint32_t magic;              /* written last by the creator, the segment is valid once it is FWE_SHM_TRACE_MAGIC */
+    uint32_t version;            /* FWE_SHM_TRACE_VERSION */
+    uint32_t capacity;           /* number of entries */
+    uint32_t entry_size;         /* sizeof( struct fwe_shm_trace_entry ) */
+    uint32_t sequence;           /* incremented before and after every update, odd while the table is written */
+    uint32_t entry_count;        /* valid entries of the last update */
+    uint32_t dropped_count;      /* values of the last update that did not fit into the capacity */
+    uint32_t update_interval_ms; /* time between two updates */
+    uint64_t update_time_ms;     /* milliseconds since Epoch of the last update */
+    uint64_t update_count;       /* number of updates since the segment was created */
+    int32_t pid;                 /* process writing the segment */
+    uint8_t padding[12];
+    /* followed by capacity entries */
+};
+
+/* Size of the shared memory object of a segment with the given capacity */
+static inline size_t
+fwe_shm_trace_size( uint32_t capacity )
+{
+    return sizeof( struct fwe_shm_trace_header ) + ( (size_t)capacity * sizeof( struct fwe_shm_trace_entry ) );
+}
+
+static inline struct fwe_shm_trace_entry *
+fwe_shm_trace_entries( struct fwe_shm_trace_header *segment )
+{
+    return (struct fwe_shm_trace_entry *)( segment + 1 );
+}
+
+/*
+ * Maps the segment created by AWS IoT FleetWise Edge read-only.
+ * name: the shared memory object name, e.g. "/fwe-trace"
+ * Returns the segment, or NULL if it does not exist or has an incompatible layout. Unmap it with
+ * fwe_shm_trace_close.
+ */
+static inline const struct fwe_shm_trace_header *
+fwe_shm_trace_open( const char *name )
+{
+    struct stat fileStat;
+    const struct fwe_shm_trace_header *segment;
+    void *mapping;
+    int fd = shm_open( name, O_RDONLY, 0 );
+    if ( fd < 0 )
+    {
+        return NULL;
+    }
+    if ( ( fstat( fd, &fileStat ) != 0 ) || ( (size_t)fileStat.st_size < sizeof( struct fwe_shm_trace_header ) ) )
+    {
+        close( fd );
+        return NULL;
+    }
+    mapping = mmap( NULL, (size_t)fileStat.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+    close( fd );
+    if ( mapping == MAP_FAILED )
+    {
+        return NULL;
+    }
+    segment = (const struct fwe_shm_trace_header *)mapping;
+    if ( ( __atomic_load_n( &segment->magic, __ATOMIC_ACQUIRE ) != FWE_SHM_TRACE_MAGIC ) ||
+         ( segment->version != FWE_SHM_TRACE_VERSION ) ||
+         ( segment->entry_size != sizeof( struct fwe_shm_trace_entry ) ) ||
+         ( fwe_shm_trace_size( segment->capacity ) > (size_t)fileStat.st_size ) )
+    {
+        munmap( mapping, (size_t)fileStat.st_size );
+        return NULL;
+    }
+    return segment;
+}
+
+static inline void
+fwe_shm_trace_close( const struct fwe_shm_trace_header *segment )
+{
+    if ( segment != NULL )
+    {
+        munmap( (void *)segment, fwe_shm_trace_size( segment->capacity ) );
+    }
+}
+
+/*
+ * Copies the table of the last update.
+ * entries: array of at least capacity entries of the segment
+ * header: receives the header of the copied update, may be NULL
+ * Returns the number of copied entries, or -1 if every attempt overlapped with an update.
+ */
+static inline int
+fwe_shm_trace_read( const struct fwe_shm_trace_header *segment,
+                    struct fwe_shm_trace_entry *entries,
+                    struct fwe_shm_trace_header *header )
+{
+    uint32_t attempt;
+    for ( attempt = 0U; attempt < FWE_SHM_TRACE_READ_ATTEMPTS; attempt++ )
+    {
+        uint32_t count;
+        uint32_t sequenceAfter;
+        uint32_t sequence = __atomic_load_n( &segment->sequence, __ATOMIC_ACQUIRE );
+        if ( ( sequence & 1U ) != 0U )
+        {
+            usleep( 1000U );
+            continue;
+        }
+        count = segment->entry_count;
+        if ( count > segment->capacity )
+        {
+            count = segment->capacity;
+        }
+        if ( header != NULL )
+        {
+            memcpy( header, segment, sizeof( struct fwe_shm_trace_header ) );
+        }
+        memcpy( entries,
+                fwe_shm_trace_entries( (struct fwe_shm_trace_header *)segment ),
+                (size_t)count * sizeof( struct fwe_shm_trace_entry ) );
+        __atomic_thread_fence( __ATOMIC_ACQUIRE );
+        sequenceAfter = __atomic_load_n( &segment->sequence, __ATOMIC_RELAXED );
+        if ( sequenceAfter == sequence )
+        {
+            if ( header != NULL )
+            {
+                header->entry_count = count;
+            }
+            return (int)count;
+        }
+    }
+    return -1;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FWE_TRACE_SHARED_MEMORY_H */
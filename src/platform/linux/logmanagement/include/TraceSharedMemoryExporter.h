@@ -0,0 +1,112 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+
+#pragma once
+
+#if defined( IOTFLEETWISE_LINUX )
+// Includes
+#include "LoggingModule.h"
+#include "Signal.h"
+#include "Thread.h"
+#include "TraceModule.h"
+#include "TraceSharedMemory.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace Platform
+{
+namespace Linux
+{
+/**
+ * @brief Publishes the current values of the TraceModule into a shared memory segment, so that a local tool like
+ * fwe-top can watch the device software live without any logging.
+ *
+ * Once per update interval the own thread rewrites the table of the segment, see TraceSharedMemory.h, with the
+ * values of TraceModule::forwardCurrentValuesToMetricsReceiver: all trace variables, the histogram counts and
+ * percentiles and the named variables, which include the CPU time per thread and the queue occupancies of the
+ * ThreadTelemetrySampler if it runs. The hot paths are not involved, they keep recording into the TraceModule.
+ * The segment is created only readable for other users and removed when the exporter stops.
+ */
+class TraceSharedMemoryExporter : public IMetricsReceiver
+{
+public:
+    static constexpr uint32_t DEFAULT_CAPACITY = 1024;
+
+    /**
+     * @param shmName name of the shared memory object starting with '/', e.g. "/fwe-trace"
+     * @param updateIntervalMs time between two updates
+     * @param capacity maximum number of values, further values are counted as dropped
+     */
+    TraceSharedMemoryExporter( std::string shmName, uint32_t updateIntervalMs, uint32_t capacity = DEFAULT_CAPACITY );
+    ~TraceSharedMemoryExporter() override;
+
+    TraceSharedMemoryExporter( const TraceSharedMemoryExporter & ) = delete;
+    TraceSharedMemoryExporter &operator=( const TraceSharedMemoryExporter & ) = delete;
+    TraceSharedMemoryExporter( TraceSharedMemoryExporter && ) = delete;
+    TraceSharedMemoryExporter &operator=( TraceSharedMemoryExporter && ) = delete;
+
+    /**
+     * @brief Creates the segment, replacing one of an earlier run, and starts the thread
+     */
+    bool start();
+
+    /**
+     * @brief Stops the thread and removes the segment
+     */
+    bool stop();
+
+    bool isAlive();
+
+    /**
+     * @brief Rewrites the table with the current values. Only called by the exporter thread, or if it is not
+     * running.
+     */
+    void update();
+
+    /**
+     * @brief Writes one value into the table of the current update
+     */
+    void setMetric( const std::string &name, double value, const std::string &unit ) override;
+
+private:
+    static void doWork( void *data );
+    bool shouldStop() const;
+    bool createSegment();
+    void removeSegment();
+
+    std::string mShmName;
+    uint32_t mUpdateIntervalMs;
+    uint32_t mCapacity;
+    fwe_shm_trace_header *mSegment{ nullptr };
+    uint32_t mEntryCount{ 0 };
+    uint32_t mDroppedCount{ 0 };
+    TraceModule::HistogramBaseline mHistogramBaseline;
+    Thread mThread;
+    std::atomic<bool> mShouldStop{ false };
+    std::mutex mThreadMutex;
+    Signal mWait;
+    LoggingModule mLogger;
+};
+
+} // namespace Linux
+} // namespace Platform
+} // namespace IoTFleetWise
+} // namespace Aws
+#endif // IOTFLEETWISE_LINUX
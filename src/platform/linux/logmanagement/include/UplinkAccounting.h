@@ -0,0 +1,112 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "TraceModule.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace Platform
+{
+namespace Linux
+{
+/**
+ * @brief What is counted per collection scheme on the way to the cloud
+ */
+enum class UplinkCounter : uint8_t
+{
+    SERIALIZED_BYTES = 0, // payload size after serialization
+    COMPRESSED_BYTES,     // payload size handed over to the sender, after the compression if it is enabled
+    PUBLISHES,            // completed publishes
+    PUBLISHED_BYTES,      // bytes of the completed publishes
+    PERSISTED_BYTES,      // bytes written to the persistency because the data could not be published
+    UPLINK_COUNTER_SIZE
+};
+
+/**
+ * @brief Accounts the uplink traffic per collection scheme, so that the cost of a campaign can be seen
+ *
+ * Every collection scheme gets an account ID which is passed on with the CollectionSchemeParams of its payloads,
+ * like the trace ID of the LatencyTracer. The counters are relaxed atomics, only looking up an account takes a lock.
+ * The account ID 0 collects the traffic that is not attributed to a collection scheme, for example checkins, metrics,
+ * the upload of persisted data and the collection schemes once MAX_ACCOUNTS are in use.
+ *
+ * forwardToMetricsReceiver reports the counters of the period since its previous call, so the RemoteProfiler sends
+ * the traffic per metrics upload interval.
+ */
+class UplinkAccounting
+{
+public:
+    static UplinkAccounting &get();
+
+    /**
+     * @brief Returns the account of a collection scheme, creating it on first use
+     * @param collectionSchemeID the ID of the collection scheme
+     * @return the account ID, 0 if the ID is empty or all accounts are in use
+     */
+    uint32_t getAccountId( const std::string &collectionSchemeID );
+
+    void
+    add( uint32_t accountId, UplinkCounter counter, uint64_t value )
+    {
+        if ( ( accountId < MAX_ACCOUNTS ) && ( counter < UplinkCounter::UPLINK_COUNTER_SIZE ) )
+        {
+            mAccounts[accountId].mCounters[static_cast<uint8_t>( counter )].fetch_add( value,
+                                                                                       std::memory_order_relaxed );
+        }
+    }
+
+    /**
+     * @brief Total of a counter of an account since startup
+     */
+    uint64_t getTotal( uint32_t accountId, UplinkCounter counter ) const;
+
+    /**
+     * @brief Calls for every account with traffic in the period the receiver->setMetric with the counters of the
+     * period since the previous call
+     *
+     * The names are uplinkSerializedBytes_<id>, uplinkCompressedBytes_<id>, uplinkPublishes_<id>,
+     * uplinkPublishedBytes_<id> and uplinkPersistedBytes_<id>, with the collection scheme ID or unattributed as id.
+     */
+    void forwardToMetricsReceiver( IMetricsReceiver *receiver );
+
+    // Account 0 is the unattributed traffic
+    static constexpr uint32_t MAX_ACCOUNTS = 256;
+
+private:
+    static constexpr size_t COUNTER_COUNT = static_cast<size_t>( UplinkCounter::UPLINK_COUNTER_SIZE );
+
+    struct Account
+    {
+        std::atomic<uint64_t> mCounters[COUNTER_COUNT]{};
+        uint64_t mReported[COUNTER_COUNT]{}; // totals at the previous forwardToMetricsReceiver
+        std::string mCollectionSchemeID;
+    };
+
+    std::mutex mMutex;
+    uint32_t mAccountCount{ 1 };
+    Account mAccounts[MAX_ACCOUNTS];
+};
+
+} // namespace Linux
+} // namespace Platform
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -0,0 +1,248 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#if defined( IOTFLEETWISE_LINUX )
+// Includes
+#include "AsyncLogger.h"
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace Platform
+{
+namespace Linux
+{
+namespace
+{
+// The thread ID is a system call, so it is only requested once per thread
+uint64_t
+cachedThreadId()
+{
+    static thread_local uint64_t threadId = static_cast<uint64_t>( syscall( SYS_gettid ) );
+    return threadId;
+}
+
+std::string
+timeAsString( Timestamp time )
+{
+    auto seconds = static_cast<time_t>( time / 1000 );
+    struct tm localTime;
+    char buffer[32] = {};
+    if ( localtime_r( &seconds, &localTime ) != nullptr )
+    {
+        (void)std::strftime( buffer, sizeof( buffer ), "%Y-%m-%d %I:%M:%S %p", &localTime );
+    }
+    return buffer;
+}
+
+Timestamp
+timeSinceEpochMs()
+{
+    return static_cast<Timestamp>(
+        std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::system_clock::now().time_since_epoch() )
+            .count() );
+}
+
+void
+copyTruncated( char *destination, const std::string &source, size_t maxLength )
+{
+    auto length = std::min( source.size(), maxLength );
+    std::memcpy( destination, source.data(), length );
+    destination[length] = '\0';
+}
+} // namespace
+
+AsyncLogger::AsyncLogger( size_t capacity )
+{
+    mCapacity = 1;
+    while ( mCapacity < capacity )
+    {
+        mCapacity <<= 1U;
+    }
+    mRecords.reset( new Record[mCapacity] );
+    for ( size_t i = 0; i < mCapacity; i++ )
+    {
+        mRecords[i].sequence.store( i, std::memory_order_relaxed );
+    }
+}
+
+AsyncLogger::~AsyncLogger()
+{
+    // To make sure the thread stops during teardown of tests.
+    if ( isAlive() )
+    {
+        stop();
+    }
+}
+
+bool
+AsyncLogger::start()
+{
+    // Prevent concurrent stop/init
+    std::lock_guard<std::mutex> lock( mThreadMutex );
+    // On multi core systems the shared variable mShouldStop must be updated for
+    // all cores before starting the thread otherwise thread will directly end
+    mShouldStop.store( false );
+    if ( !mThread.create( doWork, this, "fwLogWriter" ) )
+    {
+        return false;
+    }
+    setAsyncLogging( this );
+    return true;
+}
+
+bool
+AsyncLogger::stop()
+{
+    std::lock_guard<std::mutex> lock( mThreadMutex );
+    setAsyncLogging( nullptr );
+    mShouldStop.store( true, std::memory_order_relaxed );
+    mWait.notify();
+    mThread.release();
+    mShouldStop.store( false, std::memory_order_relaxed );
+    return !mThread.isActive();
+}
+
+bool
+AsyncLogger::isAlive()
+{
+    return mThread.isValid() && mThread.isActive();
+}
+
+bool
+AsyncLogger::shouldStop() const
+{
+    return mShouldStop.load( std::memory_order_relaxed );
+}
+
+void
+AsyncLogger::logMessage( LogLevel level, const std::string &function, const std::string &logEntry )
+{
+    auto position = mEnqueuePosition.load( std::memory_order_relaxed );
+    Record *record = nullptr;
+    for ( ;; )
+    {
+        record = &mRecords[position & ( mCapacity - 1 )];
+        auto sequence = record->sequence.load( std::memory_order_acquire );
+        if ( sequence == position )
+        {
+            // The slot is free, claim it against the other logging threads
+            if ( mEnqueuePosition.compare_exchange_weak( position, position + 1, std::memory_order_relaxed ) )
+            {
+                break;
+            }
+        }
+        else if ( sequence < position )
+        {
+            // The writer did not yet consume the record of the previous round, the ring is full
+            mDroppedCount.fetch_add( 1, std::memory_order_relaxed );
+            return;
+        }
+        else
+        {
+            position = mEnqueuePosition.load( std::memory_order_relaxed );
+        }
+    }
+    record->level = level;
+    record->threadId = cachedThreadId();
+    record->time = timeSinceEpochMs();
+    copyTruncated( record->function, function, MAX_FUNCTION_LENGTH );
+    copyTruncated( record->logEntry, logEntry, MAX_LOG_ENTRY_LENGTH );
+    record->sequence.store( position + 1, std::memory_order_release );
+    // Only makes a system call if the writer thread is blocked
+    mWait.notify();
+}
+
+size_t
+AsyncLogger::flush()
+{
+    size_t count = 0;
+    for ( ;; )
+    {
+        auto &record = mRecords[mDequeuePosition & ( mCapacity - 1 )];
+        if ( record.sequence.load( std::memory_order_acquire ) != mDequeuePosition + 1 )
+        {
+            break;
+        }
+        reportDropped();
+        writeRecord( record );
+        // Hand the slot back to the logging threads for the next round
+        record.sequence.store( mDequeuePosition + mCapacity, std::memory_order_release );
+        mDequeuePosition++;
+        count++;
+    }
+    reportDropped();
+    if ( count > 0U )
+    {
+        std::fflush( stdout );
+    }
+    return count;
+}
+
+void
+AsyncLogger::reportDropped()
+{
+    auto droppedCount = getDroppedCount();
+    if ( droppedCount != mReportedDroppedCount )
+    {
+        std::printf( "[Thread : %" PRIu64 "] [%s] [%s] [%s]: [%" PRIu64 " log messages were dropped] \n",
+                     cachedThreadId(),
+                     timeAsString( timeSinceEpochMs() ).c_str(),
+                     levelToString( LogLevel::Warning ).c_str(),
+                     "AsyncLogger::flush",
+                     droppedCount - mReportedDroppedCount );
+        mReportedDroppedCount = droppedCount;
+    }
+}
+
+void
+AsyncLogger::writeRecord( const Record &record )
+{
+    std::printf( "[Thread : %" PRIu64 "] [%s] [%s] [%s]: [%s] \n",
+                 record.threadId,
+                 timeAsString( record.time ).c_str(),
+                 levelToString( record.level ).c_str(),
+                 record.function,
+                 record.logEntry );
+    forwardLog( record.level, record.function, record.logEntry );
+}
+
+void
+AsyncLogger::doWork( void *data )
+{
+    auto *logger = static_cast<AsyncLogger *>( data );
+    while ( !logger->shouldStop() )
+    {
+        if ( logger->flush() == 0U )
+        {
+            logger->mWait.wait( IDLE_TIME_MS );
+        }
+    }
+    // Write what was logged until the routing was switched back
+    (void)logger->flush();
+}
+
+} // namespace Linux
+} // namespace Platform
+} // namespace IoTFleetWise
+} // namespace Aws
+#endif // IOTFLEETWISE_LINUX
@@ -15,7 +15,9 @@
 // Includes
 
 #include "ConsoleLogger.h"
+#include "AsyncLogger.h"
 #include "ClockHandler.h"
+#include <atomic>
 #include <chrono>
 #include <cinttypes>
 #include <iomanip>
@@ -36,6 +38,13 @@ LogLevel gSystemWideLogLevel;
 
 static std::mutex gLogForwardingMutex;
 static ILogger *gLogForwarder = nullptr;
+static std::atomic<AsyncLogger *> gAsyncLogger{ nullptr };
+
+void
+setAsyncLogging( AsyncLogger *asyncLogger )
+{
+    gAsyncLogger.store( asyncLogger, std::memory_order_release );
+}
 
 void
 setLogForwarding( ILogger *logForwarder )
@@ -67,6 +76,12 @@ ConsoleLogger::logMessage( LogLevel level, const std::string &function, const st
 {
     if ( level >= gSystemWideLogLevel )
     {
+        auto *asyncLogger = gAsyncLogger.load( std::memory_order_acquire );
+        if ( asyncLogger != nullptr )
+        {
+            asyncLogger->logMessage( level, function, logEntry );
+            return;
+        }
         std::printf( "[Thread : %" PRIu64 "] [%s] [%s] [%s]: [%s] ",
                      currentThreadId(),
                      timeAsString().c_str(),
@@ -0,0 +1,128 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "LatencyTracer.h"
+#include "EnumUtility.h"
+#include "TraceModule.h"
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace Platform
+{
+namespace Linux
+{
+namespace
+{
+TraceHistogram
+getStageHistogram( LatencyStage stage )
+{
+    switch ( stage )
+    {
+    case LatencyStage::DECODE:
+        return TraceHistogram::E2E_DECODE_US;
+    case LatencyStage::QUEUE_POP:
+        return TraceHistogram::E2E_QUEUE_US;
+    case LatencyStage::TRIGGER:
+        return TraceHistogram::E2E_TRIGGER_US;
+    case LatencyStage::SERIALIZE:
+        return TraceHistogram::E2E_SERIALIZE_US;
+    case LatencyStage::PUBLISH:
+        return TraceHistogram::E2E_PUBLISH_US;
+    case LatencyStage::PUBACK:
+        return TraceHistogram::E2E_PUBACK_US;
+    default:
+        return TraceHistogram::TRACE_HISTOGRAM_SIZE;
+    }
+}
+
+uint64_t
+elapsedUs( uint64_t fromUs, uint64_t toUs )
+{
+    // The system time can be set back between two stages
+    return ( toUs > fromUs ) ? ( toUs - fromUs ) : 0U;
+}
+} // namespace
+
+constexpr uint32_t LatencyTracer::SLOT_COUNT;
+
+LatencyTracer &
+LatencyTracer::get()
+{
+    static LatencyTracer tracer;
+    return tracer;
+}
+
+uint32_t
+LatencyTracer::startSampledTrace( uint64_t startTimeUs, uint32_t interval )
+{
+    // Counted per consumer thread, so that the frames are not counted with a contended atomic
+    thread_local uint32_t framesSinceLastTrace = 0;
+    framesSinceLastTrace++;
+    if ( framesSinceLastTrace < interval )
+    {
+        return 0U;
+    }
+    framesSinceLastTrace = 0;
+    auto traceId = mLastTraceId.fetch_add( 1, std::memory_order_relaxed ) + 1U;
+    if ( traceId == 0U )
+    {
+        traceId = mLastTraceId.fetch_add( 1, std::memory_order_relaxed ) + 1U;
+    }
+    auto &slot = mSlots[traceId % SLOT_COUNT];
+    // The previous trace of the slot is not followed anymore from here on
+    slot.mTraceId.store( 0, std::memory_order_relaxed );
+    slot.mStage.store( toUType( LatencyStage::START ), std::memory_order_relaxed );
+    slot.mStartTimeUs.store( startTimeUs, std::memory_order_relaxed );
+    slot.mLastTimeUs.store( startTimeUs, std::memory_order_relaxed );
+    slot.mTraceId.store( traceId, std::memory_order_release );
+    return traceId;
+}
+
+void
+LatencyTracer::mark( uint32_t traceId, LatencyStage stage, uint64_t timeUs )
+{
+    if ( traceId == 0U )
+    {
+        return;
+    }
+    auto &slot = mSlots[traceId % SLOT_COUNT];
+    if ( slot.mTraceId.load( std::memory_order_acquire ) != traceId )
+    {
+        return;
+    }
+    // Only the first thread reaching a stage records it, e.g. for a signal collected by two conditions
+    auto lastStage = slot.mStage.load( std::memory_order_relaxed );
+    do
+    {
+        if ( lastStage >= toUType( stage ) )
+        {
+            return;
+        }
+    } while ( !slot.mStage.compare_exchange_weak( lastStage, toUType( stage ), std::memory_order_relaxed ) );
+    auto lastTimeUs = slot.mLastTimeUs.exchange( timeUs, std::memory_order_relaxed );
+    TraceModule::get().recordHistogram( getStageHistogram( stage ), elapsedUs( lastTimeUs, timeUs ) );
+    if ( stage == LatencyStage::PUBACK )
+    {
+        TraceModule::get().recordHistogram(
+            TraceHistogram::E2E_TOTAL_US,
+            elapsedUs( slot.mStartTimeUs.load( std::memory_order_relaxed ), timeUs ) );
+    }
+}
+
+} // namespace Linux
+} // namespace Platform
+} // namespace IoTFleetWise
+} // namespace Aws
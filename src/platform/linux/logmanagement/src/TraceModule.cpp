@@ -14,6 +14,7 @@
 // Includes
 
 #include "TraceModule.h"
+#include <cmath>
 #include <cstdio>
 #include <string>
 
@@ -26,6 +27,169 @@ namespace Platform
 namespace Linux
 {
 
+constexpr uint64_t TraceModule::HISTOGRAM_MAX_VALUE;
+constexpr uint32_t TraceScopedTimer::DEFAULT_SAMPLING_INTERVAL;
+
+TraceModule::ThreadShardReleaser::~ThreadShardReleaser()
+{
+    if ( mShard != nullptr )
+    {
+        auto &traceModule = TraceModule::get();
+        std::lock_guard<std::mutex> lock( traceModule.mShardsMutex );
+        traceModule.mFreeShards.push_back( mShard );
+    }
+}
+
+TraceModule::ThreadShard &
+TraceModule::getThreadShard()
+{
+    thread_local ThreadShardReleaser releaser;
+    if ( releaser.mShard == nullptr )
+    {
+        // Only taken once per thread
+        std::lock_guard<std::mutex> lock( mShardsMutex );
+        if ( mFreeShards.empty() )
+        {
+            mShards.emplace_back( std::make_unique<ThreadShard>() );
+            releaser.mShard = mShards.back().get();
+        }
+        else
+        {
+            releaser.mShard = mFreeShards.back();
+            mFreeShards.pop_back();
+        }
+    }
+    return *releaser.mShard;
+}
+
+uint64_t
+TraceModule::aggregateVariable( TraceVariable variable )
+{
+    auto index = toUType( variable );
+    uint64_t value = mVariableData[index].mCurrentValue;
+    {
+        std::lock_guard<std::mutex> lock( mShardsMutex );
+        for ( const auto &shard : mShards )
+        {
+            value += shard->mVariableAdded[index].load( std::memory_order_relaxed );
+        }
+    }
+    mVariableData[index].mMaxValue = std::max( mVariableData[index].mMaxValue, value );
+    return value;
+}
+
+uint64_t
+TraceModule::getVariableMax( TraceVariable variable )
+{
+    if ( variable < TraceVariable::TRACE_VARIABLE_SIZE )
+    {
+        (void)aggregateVariable( variable );
+        return mVariableData[toUType( variable )].mMaxValue;
+    }
+    return 0;
+}
+
+uint64_t
+TraceModule::getVariable( TraceVariable variable )
+{
+    if ( variable < TraceVariable::TRACE_VARIABLE_SIZE )
+    {
+        return aggregateVariable( variable );
+    }
+    return 0;
+}
+
+uint64_t
+TraceModule::getAtomicVariable( TraceAtomicVariable variable )
+{
+    if ( variable < TraceAtomicVariable::TRACE_ATOMIC_VARIABLE_SIZE )
+    {
+        return mAtomicVariableData[toUType( variable )].mCurrentValue.load( std::memory_order_relaxed );
+    }
+    return 0;
+}
+
+uint64_t
+TraceModule::getHistogramBucketUpperBound( uint32_t bucket )
+{
+    if ( bucket < HISTOGRAM_SUB_BUCKET_COUNT )
+    {
+        return bucket;
+    }
+    auto shift = ( bucket / HISTOGRAM_SUB_BUCKET_COUNT ) - 1U;
+    uint64_t lowerBound = static_cast<uint64_t>( HISTOGRAM_SUB_BUCKET_COUNT + ( bucket % HISTOGRAM_SUB_BUCKET_COUNT ) )
+                          << shift;
+    return lowerBound + ( uint64_t{ 1 } << shift ) - 1U;
+}
+
+TraceModule::HistogramData
+TraceModule::aggregateHistogram( TraceHistogram histogram )
+{
+    HistogramData data;
+    std::lock_guard<std::mutex> lock( mShardsMutex );
+    for ( const auto &shard : mShards )
+    {
+        const auto &shardData = shard->mHistograms[toUType( histogram )];
+        for ( uint32_t i = 0; i < HISTOGRAM_BUCKET_COUNT; i++ )
+        {
+            data.mBuckets[i] += shardData.mBuckets[i].load( std::memory_order_relaxed );
+        }
+        data.mCount += shardData.mCount.load( std::memory_order_relaxed );
+        data.mSum += shardData.mSum.load( std::memory_order_relaxed );
+        data.mMax = std::max( data.mMax, shardData.mMax.load( std::memory_order_relaxed ) );
+    }
+    return data;
+}
+
+uint64_t
+TraceModule::getPercentile( const HistogramData &data, double quantile )
+{
+    // The buckets are read while other threads record, so their sum might differ slightly from the count
+    uint64_t total = 0;
+    for ( auto bucketCount : data.mBuckets )
+    {
+        total += bucketCount;
+    }
+    if ( total == 0 )
+    {
+        return 0;
+    }
+    quantile = std::min( std::max( quantile, 0.0 ), 1.0 );
+    auto rank = std::max( static_cast<uint64_t>( std::ceil( quantile * static_cast<double>( total ) ) ), uint64_t{ 1 } );
+    uint64_t seen = 0;
+    for ( uint32_t i = 0; i < HISTOGRAM_BUCKET_COUNT; i++ )
+    {
+        seen += data.mBuckets[i];
+        if ( seen >= rank )
+        {
+            auto upperBound = getHistogramBucketUpperBound( i );
+            // The max is not known for the difference of two observation windows
+            return ( data.mMax > 0 ) ? std::min( upperBound, data.mMax ) : upperBound;
+        }
+    }
+    return data.mMax;
+}
+
+uint64_t
+TraceModule::getHistogramPercentile( TraceHistogram histogram, double quantile )
+{
+    if ( histogram < TraceHistogram::TRACE_HISTOGRAM_SIZE )
+    {
+        return getPercentile( aggregateHistogram( histogram ), quantile );
+    }
+    return 0;
+}
+
+uint64_t
+TraceModule::getHistogramWindowPercentile( TraceHistogram histogram, double quantile )
+{
+    if ( histogram < TraceHistogram::TRACE_HISTOGRAM_SIZE )
+    {
+        return getPercentile( getHistogramWindow( histogram, aggregateHistogram( histogram ) ), quantile );
+    }
+    return 0;
+}
+
 void
 TraceModule::sectionBegin( TraceSection section )
 {
@@ -61,6 +225,27 @@ TraceModule::sectionEnd( TraceSection section )
     }
 }
 
+uint32_t
+TraceModule::getSectionHitCount( TraceSection section ) const
+{
+    if ( section < TraceSection::TRACE_SECTION_SIZE )
+    {
+        return mSectionData[toUType( section )].mHitCounter;
+    }
+    return 0;
+}
+
+double
+TraceModule::getSectionLastDuration( TraceSection section ) const
+{
+    if ( ( section < TraceSection::TRACE_SECTION_SIZE ) && ( mSectionData[toUType( section )].mHitCounter > 0 ) )
+    {
+        const auto &data = mSectionData[toUType( section )];
+        return std::chrono::duration<double>( data.mLastEndTime - data.mLastStartTime ).count();
+    }
+    return 0.0;
+}
+
 /*
  * return the name that should be as short as possible but still meaningful
  */
@@ -167,6 +352,10 @@ TraceModule::getVariableName( TraceVariable variable )
         return "CeE1";
     case TraceVariable::CE_SAMPLE_SIZE_ZERO:
         return "CeE2";
+    case TraceVariable::CE_SAMPLE_MEMORY_SHRUNK_BUFFERS:
+        return "CeE3";
+    case TraceVariable::CE_CONDITION_EVALUATIONS_DEFERRED:
+        return "CeE4";
     case TraceVariable::GE_COMPARE_PRECISION_ERROR:
         return "GeE0";
     case TraceVariable::GE_EVALUATE_ERROR_LAT_LON:
@@ -181,6 +370,16 @@ TraceModule::getVariableName( TraceVariable variable )
         return "ObdE3";
     case TraceVariable::DISCARDED_FRAMES:
         return "FrmE0";
+    case TraceVariable::CAN_FRAMES_PER_SYSCALL:
+        return "FrmSys";
+    case TraceVariable::PERSISTENCY_BYTES_WRITTEN:
+        return "PerWr";
+    case TraceVariable::LOAD_SHEDDING_LEVEL:
+        return "ShedLvl";
+    case TraceVariable::CAN_DECODED_FRAMES:
+        return "FrmDec";
+    case TraceVariable::INSPECTION_EVALUATIONS:
+        return "CeEval";
     default:
         return "UNKNOWN";
     }
@@ -209,6 +408,70 @@ TraceModule::getAtomicVariableName( TraceAtomicVariable variable )
         return "ConInt";
     case TraceAtomicVariable::CONNECTION_RESUMED:
         return "ConRes";
+    case TraceAtomicVariable::KERNEL_DROPPED_CAN_FRAMES:
+        return "KerDrop";
+    case TraceAtomicVariable::EMISSION_POLICY_DROPPED_SIGNALS:
+        return "EmiDrop";
+    case TraceAtomicVariable::TRIGGERED_DATA_POOL_USED:
+        return "PoolUse";
+    case TraceAtomicVariable::TRIGGERED_DATA_POOL_EXHAUSTED:
+        return "PoolEx";
+    case TraceAtomicVariable::MQTT_PUBLISHES_IN_FLIGHT:
+        return "PubFly";
+    case TraceAtomicVariable::LOAD_SHEDDING_DROPPED_SIGNALS:
+        return "ShedSig";
+    case TraceAtomicVariable::LOAD_SHEDDING_DROPPED_RAW_FRAMES:
+        return "ShedRaw";
+    case TraceAtomicVariable::QUEUE_FULL_DROPPED_SIGNALS:
+        return "QFullSig";
+    case TraceAtomicVariable::QUEUE_FULL_DROPPED_RAW_FRAMES:
+        return "QFullRaw";
+    case TraceAtomicVariable::QUEUE_FULL_DROPPED_COLLECTED_DATA:
+        return "QFullData";
+    case TraceAtomicVariable::MEMORY_DECODING_BYTES:
+        return "MemDecB";
+    case TraceAtomicVariable::MEMORY_DECODING_ALLOCATIONS:
+        return "MemDecN";
+    case TraceAtomicVariable::MEMORY_INSPECTION_BYTES:
+        return "MemInsB";
+    case TraceAtomicVariable::MEMORY_INSPECTION_ALLOCATIONS:
+        return "MemInsN";
+    case TraceAtomicVariable::MEMORY_COLLECTION_BYTES:
+        return "MemColB";
+    case TraceAtomicVariable::MEMORY_COLLECTION_ALLOCATIONS:
+        return "MemColN";
+    case TraceAtomicVariable::MEMORY_PERSISTENCY_BYTES:
+        return "MemPerB";
+    case TraceAtomicVariable::MEMORY_PERSISTENCY_ALLOCATIONS:
+        return "MemPerN";
+    case TraceAtomicVariable::MEMORY_CONNECTIVITY_BYTES:
+        return "MemConB";
+    case TraceAtomicVariable::MEMORY_CONNECTIVITY_ALLOCATIONS:
+        return "MemConN";
+    case TraceAtomicVariable::MEMORY_CEILING_EXCEEDED:
+        return "MemCeil";
+    case TraceAtomicVariable::UPLOADED_LIVE_BYTES:
+        return "UpLiveB";
+    case TraceAtomicVariable::UPLOADED_PERSISTED_BYTES:
+        return "UpPersB";
+    case TraceAtomicVariable::PERSISTENCY_COMPACTED_BYTES:
+        return "PmCmpB";
+    case TraceAtomicVariable::MQTT_PUBLISHED_BYTES:
+        return "MqttPubB";
+    case TraceAtomicVariable::UPLOAD_BACKLOG_BYTES:
+        return "UpBklgB";
+    case TraceAtomicVariable::EXPRESS_QUEUE_FULL:
+        return "ExpQFull";
+    case TraceAtomicVariable::LOOP_STALLS:
+        return "Stalls";
+    case TraceAtomicVariable::RECORDER_WRITTEN_BYTES:
+        return "RecB";
+    case TraceAtomicVariable::RECORDER_DROPPED_DATA:
+        return "RecDrop";
+    case TraceAtomicVariable::LOG_UPLOAD_DROPPED_MESSAGES:
+        return "LogDrop";
+    case TraceAtomicVariable::REMOTE_INSPECTION_LOST_BATCHES:
+        return "RemLost";
     default:
         return "UNKNOWN";
     }
@@ -231,16 +494,149 @@ TraceModule::getSectionName( TraceSection section )
         return "COL_BUILD";
     case TraceSection::MANAGER_EXTRACTION:
         return "EXTRACT";
+    case TraceSection::PERSISTENCY_FSYNC:
+        return "PER_FSYNC";
+    case TraceSection::DECODER_MANIFEST_BUILD:
+        return "DM_BUILD";
+    case TraceSection::STARTUP_PERSISTENCY:
+        return "START_PER";
+    case TraceSection::STARTUP_CONNECTIVITY:
+        return "START_CON";
+    case TraceSection::STARTUP_REMOTE_PROFILER:
+        return "START_PROF";
+    case TraceSection::STARTUP_INSPECTION:
+        return "START_INSP";
+    case TraceSection::STARTUP_COLLECTION_SCHEME_MANAGER:
+        return "START_CSM";
+    case TraceSection::STARTUP_VEHICLE_DATA_SOURCES:
+        return "START_VDS";
+    case TraceSection::STARTUP_DDS:
+        return "START_DDS";
+    case TraceSection::STARTUP_MQTT_CONNECT:
+        return "START_MQTT";
+    default:
+        return "UNKNOWN";
+    }
+}
+
+const char *
+TraceModule::getHistogramName( TraceHistogram histogram )
+{
+    switch ( histogram )
+    {
+    case TraceHistogram::INSPECTION_EVALUATION_NS:
+        return "InspEval";
+    case TraceHistogram::MQTT_PUBLISH_LATENCY_MS:
+        return "PubLat";
+    case TraceHistogram::CAN_DECODE_NS:
+        return "CanDec";
+    case TraceHistogram::CAN_FRAMES_PER_BURST:
+        return "CanBurst";
+    case TraceHistogram::INSPECTION_COLLECT_DATA_NS:
+        return "InspCol";
+    case TraceHistogram::PROTO_SERIALIZE_NS:
+        return "ProtoSer";
+    case TraceHistogram::COMPRESSION_NS:
+        return "Compr";
+    case TraceHistogram::MQTT_PUBLISH_NS:
+        return "PubCall";
+    case TraceHistogram::MQTT_RECONNECT_MS:
+        return "Reconn";
+    case TraceHistogram::E2E_DECODE_US:
+        return "E2EDec";
+    case TraceHistogram::E2E_QUEUE_US:
+        return "E2EQue";
+    case TraceHistogram::E2E_TRIGGER_US:
+        return "E2ETrig";
+    case TraceHistogram::E2E_SERIALIZE_US:
+        return "E2ESer";
+    case TraceHistogram::E2E_PUBLISH_US:
+        return "E2EPub";
+    case TraceHistogram::E2E_PUBACK_US:
+        return "E2EAck";
+    case TraceHistogram::E2E_TOTAL_US:
+        return "E2ETot";
     default:
         return "UNKNOWN";
     }
 }
 
+const char *
+TraceModule::getHistogramUnit( TraceHistogram histogram )
+{
+    switch ( histogram )
+    {
+    case TraceHistogram::MQTT_PUBLISH_LATENCY_MS:
+    case TraceHistogram::MQTT_RECONNECT_MS:
+        return "Milliseconds";
+    case TraceHistogram::INSPECTION_EVALUATION_NS:
+    case TraceHistogram::CAN_DECODE_NS:
+    case TraceHistogram::INSPECTION_COLLECT_DATA_NS:
+    case TraceHistogram::PROTO_SERIALIZE_NS:
+    case TraceHistogram::COMPRESSION_NS:
+    case TraceHistogram::MQTT_PUBLISH_NS:
+        return "Nanoseconds";
+    case TraceHistogram::E2E_DECODE_US:
+    case TraceHistogram::E2E_QUEUE_US:
+    case TraceHistogram::E2E_TRIGGER_US:
+    case TraceHistogram::E2E_SERIALIZE_US:
+    case TraceHistogram::E2E_PUBLISH_US:
+    case TraceHistogram::E2E_PUBACK_US:
+    case TraceHistogram::E2E_TOTAL_US:
+        return "Microseconds";
+    case TraceHistogram::CAN_FRAMES_PER_BURST:
+        return "Count";
+    default:
+        return "None";
+    }
+}
+
+void
+TraceModule::addToNamedVariable( const std::string &name, int64_t value, const std::string &unit )
+{
+    std::lock_guard<std::mutex> lock( mNamedVariablesMutex );
+    auto &variable = mNamedVariables[name];
+    variable.mCurrentValue += value;
+    variable.mUnit = unit;
+    if ( variable.mCurrentValue == 0 )
+    {
+        mNamedVariables.erase( name );
+    }
+}
+
+void
+TraceModule::setNamedVariable( const std::string &name, int64_t value, const std::string &unit )
+{
+    std::lock_guard<std::mutex> lock( mNamedVariablesMutex );
+    auto &variable = mNamedVariables[name];
+    variable.mCurrentValue = value;
+    if ( variable.mUnit != unit )
+    {
+        variable.mUnit = unit;
+    }
+}
+
+void
+TraceModule::removeNamedVariable( const std::string &name )
+{
+    std::lock_guard<std::mutex> lock( mNamedVariablesMutex );
+    mNamedVariables.erase( name );
+}
+
+int64_t
+TraceModule::getNamedVariable( const std::string &name )
+{
+    std::lock_guard<std::mutex> lock( mNamedVariablesMutex );
+    auto it = mNamedVariables.find( name );
+    return ( it == mNamedVariables.end() ) ? 0 : it->second.mCurrentValue;
+}
+
 void
 TraceModule::updateAllTimeData()
 {
     for ( auto i = 0; i < toUType( TraceVariable::TRACE_VARIABLE_SIZE ); i++ )
     {
+        (void)aggregateVariable( static_cast<TraceVariable>( i ) );
         auto &v = mVariableData[i];
         v.mMaxValueAllTime = std::max( v.mMaxValueAllTime, v.mMaxValue );
     }
@@ -277,6 +673,24 @@ TraceModule::startNewObservationWindow()
         v.mMaxSpent = 0;
         v.mMaxInterval = 0;
     }
+    for ( auto i = 0; i < toUType( TraceHistogram::TRACE_HISTOGRAM_SIZE ); i++ )
+    {
+        mHistogramWindowStart[i] = aggregateHistogram( static_cast<TraceHistogram>( i ) );
+    }
+}
+
+TraceModule::HistogramData
+TraceModule::getHistogramWindow( TraceHistogram histogram, const HistogramData &sinceStartup ) const
+{
+    const auto &windowStart = mHistogramWindowStart[toUType( histogram )];
+    HistogramData window;
+    for ( uint32_t i = 0; i < HISTOGRAM_BUCKET_COUNT; i++ )
+    {
+        window.mBuckets[i] = sinceStartup.mBuckets[i] - windowStart.mBuckets[i];
+    }
+    window.mCount = sinceStartup.mCount - windowStart.mCount;
+    window.mSum = sinceStartup.mSum - windowStart.mSum;
+    return window;
 }
 
 void
@@ -339,6 +753,89 @@ TraceModule::forwardAllMetricsToMetricsReceiver( IMetricsReceiver *profiler )
                              v.mHitCounter,
                              "Seconds" );
     }
+    for ( auto i = 0; i < toUType( TraceHistogram::TRACE_HISTOGRAM_SIZE ); i++ )
+    {
+        auto histogram = static_cast<TraceHistogram>( i );
+        auto sinceStartup = aggregateHistogram( histogram );
+        auto sinceLast = getHistogramWindow( histogram, sinceStartup );
+        auto suffix = getHistogramName( histogram ) + std::string( "_id" ) + std::to_string( i );
+        std::string unit = getHistogramUnit( histogram );
+        double scale = 1.0;
+        // Nanoseconds is not a unit of the metrics receiver
+        if ( unit == "Nanoseconds" )
+        {
+            unit = "Microseconds";
+            scale = 0.001;
+        }
+        profiler->setMetric(
+            std::string( "histogramCountSinceStartup_" ) + suffix, static_cast<double>( sinceStartup.mCount ), "Count" );
+        profiler->setMetric(
+            std::string( "histogramCountSinceLast_" ) + suffix, static_cast<double>( sinceLast.mCount ), "Count" );
+        profiler->setMetric(
+            std::string( "histogramMaxSinceStartup_" ) + suffix, static_cast<double>( sinceStartup.mMax ) * scale, unit );
+        profiler->setMetric( std::string( "histogramP50SinceLast_" ) + suffix,
+                             static_cast<double>( getPercentile( sinceLast, 0.5 ) ) * scale,
+                             unit );
+        profiler->setMetric( std::string( "histogramP99SinceLast_" ) + suffix,
+                             static_cast<double>( getPercentile( sinceLast, 0.99 ) ) * scale,
+                             unit );
+        profiler->setMetric( std::string( "histogramP999SinceLast_" ) + suffix,
+                             static_cast<double>( getPercentile( sinceLast, 0.999 ) ) * scale,
+                             unit );
+    }
+    std::lock_guard<std::mutex> lock( mNamedVariablesMutex );
+    for ( const auto &v : mNamedVariables )
+    {
+        profiler->setMetric(
+            std::string( "namedVariable_" ) + v.first, static_cast<double>( v.second.mCurrentValue ), v.second.mUnit );
+    }
+}
+
+void
+TraceModule::forwardCurrentValuesToMetricsReceiver( IMetricsReceiver *receiver, HistogramBaseline &baseline )
+{
+    if ( receiver == nullptr )
+    {
+        return;
+    }
+    for ( auto i = 0; i < toUType( TraceVariable::TRACE_VARIABLE_SIZE ); i++ )
+    {
+        auto variable = static_cast<TraceVariable>( i );
+        receiver->setMetric( std::string( "variable_" ) + getVariableName( variable ),
+                             static_cast<double>( aggregateVariable( variable ) ),
+                             "Count" );
+    }
+    for ( auto i = 0; i < toUType( TraceAtomicVariable::TRACE_ATOMIC_VARIABLE_SIZE ); i++ )
+    {
+        receiver->setMetric( std::string( "atomic_" ) + getAtomicVariableName( static_cast<TraceAtomicVariable>( i ) ),
+                             static_cast<double>( mAtomicVariableData[i].mCurrentValue.load() ),
+                             "Count" );
+    }
+    for ( auto i = 0; i < toUType( TraceHistogram::TRACE_HISTOGRAM_SIZE ); i++ )
+    {
+        auto histogram = static_cast<TraceHistogram>( i );
+        auto sinceStartup = aggregateHistogram( histogram );
+        auto &previous = baseline.mHistograms[i];
+        HistogramData interval;
+        for ( uint32_t bucket = 0; bucket < HISTOGRAM_BUCKET_COUNT; bucket++ )
+        {
+            interval.mBuckets[bucket] = sinceStartup.mBuckets[bucket] - previous.mBuckets[bucket];
+        }
+        std::string name = getHistogramName( histogram );
+        std::string unit = getHistogramUnit( histogram );
+        receiver->setMetric( "histogramCount_" + name, static_cast<double>( sinceStartup.mCount ), "Count" );
+        receiver->setMetric( "histogramMax_" + name, static_cast<double>( sinceStartup.mMax ), unit );
+        receiver->setMetric( "histogramP50_" + name, static_cast<double>( getPercentile( interval, 0.5 ) ), unit );
+        receiver->setMetric( "histogramP99_" + name, static_cast<double>( getPercentile( interval, 0.99 ) ), unit );
+        receiver->setMetric( "histogramP999_" + name, static_cast<double>( getPercentile( interval, 0.999 ) ), unit );
+        previous = std::move( sinceStartup );
+    }
+    std::lock_guard<std::mutex> lock( mNamedVariablesMutex );
+    for ( const auto &v : mNamedVariables )
+    {
+        receiver->setMetric(
+            "namedVariable_" + v.first, static_cast<double>( v.second.mCurrentValue ), v.second.mUnit );
+    }
 }
 
 void
@@ -348,10 +845,11 @@ TraceModule::print()
     for ( auto i = 0; i < toUType( TraceVariable::TRACE_VARIABLE_SIZE ); i++ )
     {
         auto &v = mVariableData[i];
+        auto currentValue = aggregateVariable( static_cast<TraceVariable>( i ) );
         mLogger.trace( "TraceModule::print",
                        std::string{ " TraceModule-ConsoleLogging-Variable '" } +
                            getVariableName( static_cast<TraceVariable>( i ) ) + "' [" + std::to_string( i ) +
-                           "] current value: [" + std::to_string( v.mCurrentValue ) +
+                           "] current value: [" + std::to_string( currentValue ) +
                            "] max value since last print: "
                            "[" +
                            std::to_string( v.mMaxValue ) + "] overall max value: [" +
@@ -386,6 +884,34 @@ TraceModule::print()
                 "] max interval since last print: [" + std::to_string( v.mMaxInterval ) + "] overall: [" +
                 std::to_string( v.mMaxIntervalAllTime ) + "]" );
     }
+    for ( auto i = 0; i < toUType( TraceHistogram::TRACE_HISTOGRAM_SIZE ); i++ )
+    {
+        auto histogram = static_cast<TraceHistogram>( i );
+        auto sinceStartup = aggregateHistogram( histogram );
+        auto sinceLast = getHistogramWindow( histogram, sinceStartup );
+        mLogger.trace( "TraceModule::print",
+                       std::string{ " TraceModule-ConsoleLogging-Histogram '" } + getHistogramName( histogram ) +
+                           "' [" + std::to_string( i ) + "] " + getHistogramUnit( histogram ) +
+                           " count since last print: [" + std::to_string( sinceLast.mCount ) + "] p50: [" +
+                           std::to_string( getPercentile( sinceLast, 0.5 ) ) + "] p99: [" +
+                           std::to_string( getPercentile( sinceLast, 0.99 ) ) + "] p999: [" +
+                           std::to_string( getPercentile( sinceLast, 0.999 ) ) + "] overall count: [" +
+                           std::to_string( sinceStartup.mCount ) + "] p50: [" +
+                           std::to_string( getPercentile( sinceStartup, 0.5 ) ) + "] p99: [" +
+                           std::to_string( getPercentile( sinceStartup, 0.99 ) ) + "] p999: [" +
+                           std::to_string( getPercentile( sinceStartup, 0.999 ) ) + "] max: [" +
+                           std::to_string( sinceStartup.mMax ) + "]" );
+    }
+    {
+        std::lock_guard<std::mutex> lock( mNamedVariablesMutex );
+        for ( const auto &v : mNamedVariables )
+        {
+            mLogger.trace( "TraceModule::print",
+                           std::string{ " TraceModule-ConsoleLogging-NamedVariable '" } + v.first +
+                               "' current value: [" + std::to_string( v.second.mCurrentValue ) + "] " +
+                               v.second.mUnit );
+        }
+    }
 
     std::fflush( stdout );
 }
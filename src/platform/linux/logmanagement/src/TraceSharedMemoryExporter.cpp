@@ -0,0 +1,209 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+
+#if defined( IOTFLEETWISE_LINUX )
+// Includes
+#include "TraceSharedMemoryExporter.h"
+#include "FastClock.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace Platform
+{
+namespace Linux
+{
+namespace
+{
+// Copies the string truncated to the size, always terminated
+void
+copyTerminated( char *destination, const std::string &source, size_t size )
+{
+    auto length = std::min( source.size(), size - 1U );
+    std::memcpy( destination, source.data(), length );
+    destination[length] = '\0';
+}
+} // namespace
+
+constexpr uint32_t TraceSharedMemoryExporter::DEFAULT_CAPACITY;
+
+TraceSharedMemoryExporter::TraceSharedMemoryExporter( std::string shmName,
+                                                      uint32_t updateIntervalMs,
+                                                      uint32_t capacity )
+    : mShmName( std::move( shmName ) )
+    , mUpdateIntervalMs( std::max( 1U, updateIntervalMs ) )
+    , mCapacity( std::max( 1U, capacity ) )
+{
+}
+
+TraceSharedMemoryExporter::~TraceSharedMemoryExporter()
+{
+    // To make sure the thread stops during teardown of tests.
+    if ( isAlive() )
+    {
+        stop();
+    }
+    removeSegment();
+}
+
+bool
+TraceSharedMemoryExporter::createSegment()
+{
+    const auto size = fwe_shm_trace_size( mCapacity );
+    // Readers still mapping the segment of an earlier run keep it until they reopen
+    shm_unlink( mShmName.c_str() );
+    int fd = shm_open( mShmName.c_str(), O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH );
+    if ( ( fd < 0 ) || ( ftruncate( fd, static_cast<off_t>( size ) ) != 0 ) )
+    {
+        mLogger.error( "TraceSharedMemoryExporter::createSegment",
+                       " Failed to create " + mShmName + ": " + std::string( strerror( errno ) ) );
+        if ( fd >= 0 )
+        {
+            close( fd );
+        }
+        return false;
+    }
+    auto *mapping = mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+    close( fd );
+    if ( mapping == MAP_FAILED )
+    {
+        mLogger.error( "TraceSharedMemoryExporter::createSegment", " Failed to map " + mShmName );
+        shm_unlink( mShmName.c_str() );
+        return false;
+    }
+    mSegment = static_cast<fwe_shm_trace_header *>( mapping );
+    // ftruncate zeroed the memory, so the table starts empty
+    mSegment->version = FWE_SHM_TRACE_VERSION;
+    mSegment->capacity = mCapacity;
+    mSegment->entry_size = sizeof( fwe_shm_trace_entry );
+    mSegment->update_interval_ms = mUpdateIntervalMs;
+    mSegment->pid = static_cast<int32_t>( getpid() );
+    __atomic_store_n( &mSegment->magic, FWE_SHM_TRACE_MAGIC, __ATOMIC_RELEASE );
+    return true;
+}
+
+void
+TraceSharedMemoryExporter::removeSegment()
+{
+    if ( mSegment != nullptr )
+    {
+        munmap( mSegment, fwe_shm_trace_size( mCapacity ) );
+        mSegment = nullptr;
+        shm_unlink( mShmName.c_str() );
+    }
+}
+
+bool
+TraceSharedMemoryExporter::start()
+{
+    // Prevent concurrent stop/init
+    std::lock_guard<std::mutex> lock( mThreadMutex );
+    if ( ( mSegment == nullptr ) && ( !createSegment() ) )
+    {
+        return false;
+    }
+    // On multi core systems the shared variable mShouldStop must be updated for
+    // all cores before starting the thread otherwise thread will directly end
+    mShouldStop.store( false );
+    if ( !mThread.create( doWork, this, "fwLMTraceExport" ) )
+    {
+        mLogger.error( "TraceSharedMemoryExporter::start", " Thread failed to start " );
+        return false;
+    }
+    mLogger.info( "TraceSharedMemoryExporter::start",
+                  " Exporting the trace values to " + mShmName + " every " + std::to_string( mUpdateIntervalMs ) +
+                      " ms" );
+    return true;
+}
+
+bool
+TraceSharedMemoryExporter::stop()
+{
+    std::lock_guard<std::mutex> lock( mThreadMutex );
+    mShouldStop.store( true, std::memory_order_relaxed );
+    mWait.notify();
+    mThread.release();
+    mShouldStop.store( false, std::memory_order_relaxed );
+    removeSegment();
+    return !mThread.isActive();
+}
+
+bool
+TraceSharedMemoryExporter::isAlive()
+{
+    return mThread.isValid() && mThread.isActive();
+}
+
+bool
+TraceSharedMemoryExporter::shouldStop() const
+{
+    return mShouldStop.load( std::memory_order_relaxed );
+}
+
+void
+TraceSharedMemoryExporter::doWork( void *data )
+{
+    auto *exporter = static_cast<TraceSharedMemoryExporter *>( data );
+    while ( !exporter->shouldStop() )
+    {
+        exporter->update();
+        exporter->mWait.wait( exporter->mUpdateIntervalMs );
+    }
+}
+
+void
+TraceSharedMemoryExporter::update()
+{
+    if ( mSegment == nullptr )
+    {
+        return;
+    }
+    // Readers retry while the sequence is odd or changed during their copy
+    auto sequence = __atomic_load_n( &mSegment->sequence, __ATOMIC_RELAXED );
+    __atomic_store_n( &mSegment->sequence, sequence + 1U, __ATOMIC_RELAXED );
+    __atomic_thread_fence( __ATOMIC_RELEASE );
+    mEntryCount = 0;
+    mDroppedCount = 0;
+    TraceModule::get().forwardCurrentValuesToMetricsReceiver( this, mHistogramBaseline );
+    mSegment->entry_count = mEntryCount;
+    mSegment->dropped_count = mDroppedCount;
+    mSegment->update_time_ms = FastClock::systemTimeMs( ClockPrecision::COARSE );
+    mSegment->update_count++;
+    __atomic_store_n( &mSegment->sequence, sequence + 2U, __ATOMIC_RELEASE );
+}
+
+void
+TraceSharedMemoryExporter::setMetric( const std::string &name, double value, const std::string &unit )
+{
+    if ( mEntryCount >= mCapacity )
+    {
+        mDroppedCount++;
+        return;
+    }
+    auto &entry = fwe_shm_trace_entries( mSegment )[mEntryCount++];
+    copyTerminated( entry.name, name, sizeof( entry.name ) );
+    copyTerminated( entry.unit, unit, sizeof( entry.unit ) );
+    entry.value = value;
+}
+
+} // namespace Linux
+} // namespace Platform
+} // namespace IoTFleetWise
+} // namespace Aws
+#endif // IOTFLEETWISE_LINUX
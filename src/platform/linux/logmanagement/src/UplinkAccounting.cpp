@@ -0,0 +1,116 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "UplinkAccounting.h"
+#include <algorithm>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace Platform
+{
+namespace Linux
+{
+namespace
+{
+const char *const COUNTER_METRIC_NAMES[] = {
+    "uplinkSerializedBytes_", "uplinkCompressedBytes_", "uplinkPublishes_", "uplinkPublishedBytes_",
+    "uplinkPersistedBytes_" };
+const char *const COUNTER_METRIC_UNITS[] = { "Bytes", "Bytes", "Count", "Bytes", "Bytes" };
+static_assert( sizeof( COUNTER_METRIC_NAMES ) / sizeof( COUNTER_METRIC_NAMES[0] ) ==
+                   static_cast<size_t>( UplinkCounter::UPLINK_COUNTER_SIZE ),
+               "A metric name is needed for every counter" );
+} // namespace
+
+constexpr uint32_t UplinkAccounting::MAX_ACCOUNTS;
+
+UplinkAccounting &
+UplinkAccounting::get()
+{
+    static UplinkAccounting accounting;
+    return accounting;
+}
+
+uint32_t
+UplinkAccounting::getAccountId( const std::string &collectionSchemeID )
+{
+    if ( collectionSchemeID.empty() )
+    {
+        return 0U;
+    }
+    std::lock_guard<std::mutex> lock( mMutex );
+    for ( uint32_t i = 1; i < mAccountCount; i++ )
+    {
+        if ( mAccounts[i].mCollectionSchemeID == collectionSchemeID )
+        {
+            return i;
+        }
+    }
+    if ( mAccountCount >= MAX_ACCOUNTS )
+    {
+        return 0U;
+    }
+    mAccounts[mAccountCount].mCollectionSchemeID = collectionSchemeID;
+    return mAccountCount++;
+}
+
+uint64_t
+UplinkAccounting::getTotal( uint32_t accountId, UplinkCounter counter ) const
+{
+    if ( ( accountId >= MAX_ACCOUNTS ) || ( counter >= UplinkCounter::UPLINK_COUNTER_SIZE ) )
+    {
+        return 0U;
+    }
+    return mAccounts[accountId].mCounters[static_cast<uint8_t>( counter )].load( std::memory_order_relaxed );
+}
+
+void
+UplinkAccounting::forwardToMetricsReceiver( IMetricsReceiver *receiver )
+{
+    if ( receiver == nullptr )
+    {
+        return;
+    }
+    std::lock_guard<std::mutex> lock( mMutex );
+    for ( uint32_t i = 0; i < mAccountCount; i++ )
+    {
+        auto &account = mAccounts[i];
+        uint64_t period[COUNTER_COUNT];
+        bool hasTraffic = false;
+        for ( size_t c = 0; c < COUNTER_COUNT; c++ )
+        {
+            auto total = account.mCounters[c].load( std::memory_order_relaxed );
+            period[c] = total - account.mReported[c];
+            account.mReported[c] = total;
+            hasTraffic = hasTraffic || ( period[c] > 0U );
+        }
+        // Campaigns without traffic in the period are not reported, so the metrics of removed campaigns stop
+        if ( !hasTraffic )
+        {
+            continue;
+        }
+        std::string id = ( i == 0U ) ? "unattributed" : account.mCollectionSchemeID;
+        for ( size_t c = 0; c < COUNTER_COUNT; c++ )
+        {
+            receiver->setMetric(
+                COUNTER_METRIC_NAMES[c] + id, static_cast<double>( period[c] ), COUNTER_METRIC_UNITS[c] );
+        }
+    }
+}
+
+} // namespace Linux
+} // namespace Platform
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -0,0 +1,114 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "AsyncLogger.h"
+#include "LoggingModule.h"
+#include <gtest/gtest.h>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+namespace
+{
+class LogCollector : public ILogger
+{
+public:
+    void
+    logMessage( LogLevel level, const std::string &function, const std::string &logEntry ) override
+    {
+        static_cast<void>( level );
+        std::lock_guard<std::mutex> lock( mMutex );
+        mFunctions.push_back( function );
+        mLogEntries.push_back( logEntry );
+    }
+
+    std::mutex mMutex;
+    std::vector<std::string> mFunctions;
+    std::vector<std::string> mLogEntries;
+};
+} // namespace
+
+/**
+ * @brief Validates that records are written in order and dropped instead of blocking when the ring is full
+ */
+TEST( AsyncLoggerTest, DropWhenFull )
+{
+    LogCollector collector;
+    setLogForwarding( &collector );
+    AsyncLogger logger( 3 );
+    ASSERT_EQ( logger.getCapacity(), 4 );
+    for ( int i = 0; i < 6; i++ )
+    {
+        logger.logMessage( LogLevel::Warning, "AsyncLoggerTest::DropWhenFull", "Message " + std::to_string( i ) );
+    }
+    ASSERT_EQ( logger.getDroppedCount(), 2 );
+    ASSERT_TRUE( collector.mLogEntries.empty() );
+
+    ASSERT_EQ( logger.flush(), 4 );
+    ASSERT_EQ( collector.mLogEntries, std::vector<std::string>( { "Message 0", "Message 1", "Message 2", "Message 3" } ) );
+    // The slots are free again after the flush
+    logger.logMessage( LogLevel::Warning, "AsyncLoggerTest::DropWhenFull", std::string( 1000, 'x' ) );
+    ASSERT_EQ( logger.flush(), 1 );
+    ASSERT_EQ( logger.getDroppedCount(), 2 );
+    ASSERT_EQ( collector.mLogEntries.back(), std::string( AsyncLogger::MAX_LOG_ENTRY_LENGTH, 'x' ) );
+    setLogForwarding( nullptr );
+}
+
+/**
+ * @brief Validates that the messages of ConsoleLogger from many threads are written by the writer thread
+ */
+TEST( AsyncLoggerTest, RouteConsoleLoggerThroughWriterThread )
+{
+    auto previousLevel = gSystemWideLogLevel;
+    gSystemWideLogLevel = LogLevel::Trace;
+    LogCollector collector;
+    setLogForwarding( &collector );
+    AsyncLogger asyncLogger( 4096 );
+    ASSERT_TRUE( asyncLogger.start() );
+    ASSERT_TRUE( asyncLogger.isAlive() );
+
+    const int threadCount = 4;
+    const int messageCount = 200;
+    std::vector<std::thread> threads;
+    for ( int i = 0; i < threadCount; i++ )
+    {
+        threads.emplace_back( [i]() {
+            LoggingModule logger;
+            for ( int j = 0; j < messageCount; j++ )
+            {
+                logger.info( "AsyncLoggerTest::Route", std::to_string( i ) + ":" + std::to_string( j ) );
+            }
+        } );
+    }
+    for ( auto &thread : threads )
+    {
+        thread.join();
+    }
+    ASSERT_TRUE( asyncLogger.stop() );
+    ASSERT_FALSE( asyncLogger.isAlive() );
+
+    ASSERT_EQ( asyncLogger.getDroppedCount(), 0 );
+    std::set<std::string> logEntries( collector.mLogEntries.begin(), collector.mLogEntries.end() );
+    ASSERT_EQ( logEntries.size(), threadCount * messageCount );
+
+    // After stop the messages are written directly again
+    LoggingModule logger;
+    logger.info( "AsyncLoggerTest::Route", "Direct" );
+    ASSERT_EQ( collector.mLogEntries.back(), "Direct" );
+    setLogForwarding( nullptr );
+    gSystemWideLogLevel = previousLevel;
+}
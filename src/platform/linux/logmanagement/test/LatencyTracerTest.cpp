@@ -0,0 +1,89 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "LatencyTracer.h"
+#include "TraceModule.h"
+#include <gtest/gtest.h>
+
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+/**
+ * @brief Validates that only every samplingInterval-th frame is traced and nothing while disabled
+ */
+TEST( LatencyTracerTest, Sampling )
+{
+    auto &tracer = LatencyTracer::get();
+    tracer.setSamplingInterval( 0 );
+    ASSERT_FALSE( tracer.isEnabled() );
+    for ( int i = 0; i < 10; i++ )
+    {
+        ASSERT_EQ( tracer.startTrace( 1000 ), 0 );
+    }
+
+    tracer.setSamplingInterval( 3 );
+    ASSERT_TRUE( tracer.isEnabled() );
+    uint32_t traced = 0;
+    uint32_t lastTraceId = 0;
+    for ( int i = 0; i < 9; i++ )
+    {
+        auto traceId = tracer.startTrace( 1000 );
+        if ( traceId != 0 )
+        {
+            ASSERT_NE( traceId, lastTraceId );
+            lastTraceId = traceId;
+            traced++;
+        }
+    }
+    ASSERT_EQ( traced, 3 );
+    tracer.setSamplingInterval( 0 );
+}
+
+/**
+ * @brief Validates that every stage records the time since the stage before and the total at the publish completion
+ */
+TEST( LatencyTracerTest, StageLatencies )
+{
+    auto &tracer = LatencyTracer::get();
+    tracer.setSamplingInterval( 1 );
+    auto traceId = tracer.startTrace( 10000 );
+    ASSERT_NE( traceId, 0 );
+    tracer.mark( traceId, LatencyStage::DECODE, 10100 );
+    tracer.mark( traceId, LatencyStage::QUEUE_POP, 10300 );
+    // Stages already passed are ignored
+    tracer.mark( traceId, LatencyStage::DECODE, 10400 );
+    // The skipped stages add to the next one
+    tracer.mark( traceId, LatencyStage::PUBLISH, 11300 );
+    tracer.mark( traceId, LatencyStage::PUBACK, 12000 );
+    tracer.mark( traceId, LatencyStage::PUBACK, 13000 );
+    // Not traced
+    tracer.mark( 0, LatencyStage::TRIGGER, 13000 );
+
+    auto &trace = TraceModule::get();
+    ASSERT_EQ( trace.getHistogramPercentile( TraceHistogram::E2E_DECODE_US, 1.0 ), 100 );
+    ASSERT_EQ( trace.getHistogramPercentile( TraceHistogram::E2E_QUEUE_US, 1.0 ), 200 );
+    ASSERT_EQ( trace.getHistogramPercentile( TraceHistogram::E2E_TRIGGER_US, 1.0 ), 0 );
+    ASSERT_EQ( trace.getHistogramPercentile( TraceHistogram::E2E_SERIALIZE_US, 1.0 ), 0 );
+    ASSERT_EQ( trace.getHistogramPercentile( TraceHistogram::E2E_PUBLISH_US, 1.0 ), 1000 );
+    ASSERT_EQ( trace.getHistogramPercentile( TraceHistogram::E2E_PUBACK_US, 1.0 ), 700 );
+    ASSERT_EQ( trace.getHistogramPercentile( TraceHistogram::E2E_TOTAL_US, 1.0 ), 2000 );
+
+    // A trace whose slot was taken by a newer one is not followed anymore
+    auto oldTraceId = tracer.startTrace( 20000 );
+    for ( uint32_t i = 0; i < LatencyTracer::SLOT_COUNT; i++ )
+    {
+        tracer.startTrace( 30000 );
+    }
+    tracer.mark( oldTraceId, LatencyStage::DECODE, 90000 );
+    ASSERT_EQ( trace.getHistogramPercentile( TraceHistogram::E2E_DECODE_US, 1.0 ), 100 );
+    tracer.setSamplingInterval( 0 );
+}
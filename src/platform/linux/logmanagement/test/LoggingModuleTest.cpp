@@ -0,0 +1,53 @@
+
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#include "LoggingModule.h"
+
+#include <gtest/gtest.h>
+#include <string>
+
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+/**
+ * @brief Validates that the message of a filtered out level is not built
+ */
+TEST( LoggingModuleTest, LazyMessageOnlyBuiltIfLevelEnabled )
+{
+    auto previousLevel = gSystemWideLogLevel;
+    gSystemWideLogLevel = LogLevel::Warning;
+    LoggingModule logger;
+    int builtMessages = 0;
+    auto buildMessage = [&builtMessages]() {
+        builtMessages++;
+        return "Message " + std::to_string( builtMessages );
+    };
+
+    ASSERT_FALSE( LoggingModule::isLevelEnabled( LogLevel::Trace ) );
+    ASSERT_FALSE( LoggingModule::isLevelEnabled( LogLevel::Info ) );
+    ASSERT_TRUE( LoggingModule::isLevelEnabled( LogLevel::Warning ) );
+    logger.trace( "LoggingModuleTest::LazyMessage", buildMessage );
+    logger.info( "LoggingModuleTest::LazyMessage", buildMessage );
+    ASSERT_EQ( builtMessages, 0 );
+    logger.warn( "LoggingModuleTest::LazyMessage", buildMessage );
+    logger.error( "LoggingModuleTest::LazyMessage", buildMessage );
+    ASSERT_EQ( builtMessages, 2 );
+    // Callables returning a string literal are accepted as well
+    logger.warn( "LoggingModuleTest::LazyMessage", []() { return "Literal"; } );
+    // The eager form is still available
+    logger.warn( "LoggingModuleTest::LazyMessage", "Eager " + std::to_string( builtMessages ) );
+
+    gSystemWideLogLevel = LogLevel::Off;
+    logger.error( "LoggingModuleTest::LazyMessage", buildMessage );
+    ASSERT_EQ( builtMessages, 2 );
+    gSystemWideLogLevel = previousLevel;
+}
@@ -16,6 +16,7 @@
 
 #include <gtest/gtest.h>
 #include <thread>
+#include <vector>
 
 using namespace Aws::IoTFleetWise::Platform::Linux;
 
@@ -47,3 +48,124 @@ TEST( TraceModuleTest, TraceModulePrint )
     TraceModule::get().print();
     TraceModule::get().startNewObservationWindow();
 }
+
+TEST( TraceModuleTest, SectionDuration )
+{
+    auto hits = TraceModule::get().getSectionHitCount( TraceSection::STARTUP_DDS );
+    TraceModule::get().sectionBegin( TraceSection::STARTUP_DDS );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 3 ) );
+    TraceModule::get().sectionEnd( TraceSection::STARTUP_DDS );
+    ASSERT_EQ( TraceModule::get().getSectionHitCount( TraceSection::STARTUP_DDS ), hits + 1 );
+    ASSERT_GE( TraceModule::get().getSectionLastDuration( TraceSection::STARTUP_DDS ), 0.003 );
+    ASSERT_LT( TraceModule::get().getSectionLastDuration( TraceSection::STARTUP_DDS ), 1.0 );
+    ASSERT_STREQ( TraceModule::getSectionName( TraceSection::STARTUP_DDS ), "START_DDS" );
+    ASSERT_EQ( TraceModule::get().getSectionHitCount( TraceSection::TRACE_SECTION_SIZE ), 0 );
+}
+
+TEST( TraceModuleTest, NamedVariables )
+{
+    TraceModule::get().addToNamedVariable( "testBytes", 100, "Bytes" );
+    TraceModule::get().addToNamedVariable( "testBytes", 50, "Bytes" );
+    ASSERT_EQ( TraceModule::get().getNamedVariable( "testBytes" ), 150 );
+    TraceModule::get().print();
+    TraceModule::get().addToNamedVariable( "testBytes", -150, "Bytes" );
+    ASSERT_EQ( TraceModule::get().getNamedVariable( "testBytes" ), 0 );
+    ASSERT_EQ( TraceModule::get().getNamedVariable( "unknown" ), 0 );
+}
+
+TEST( TraceModuleTest, AtomicVariables )
+{
+    auto start = TraceModule::get().getAtomicVariable( TraceAtomicVariable::EMISSION_POLICY_DROPPED_SIGNALS );
+    TraceModule::get().addToAtomicVariable( TraceAtomicVariable::EMISSION_POLICY_DROPPED_SIGNALS, 3 );
+    TraceModule::get().incrementAtomicVariable( TraceAtomicVariable::EMISSION_POLICY_DROPPED_SIGNALS );
+    ASSERT_EQ( TraceModule::get().getAtomicVariable( TraceAtomicVariable::EMISSION_POLICY_DROPPED_SIGNALS ),
+               start + 4 );
+    ASSERT_EQ( TraceModule::get().getAtomicVariable( TraceAtomicVariable::TRACE_ATOMIC_VARIABLE_SIZE ), 0 );
+}
+
+TEST( TraceModuleTest, AddToVariableFromManyThreads )
+{
+    auto start = TraceModule::get().getVariable( TraceVariable::PERSISTENCY_BYTES_WRITTEN );
+    const int threadCount = 8;
+    const int additions = 10000;
+    std::vector<std::thread> threads;
+    for ( int i = 0; i < threadCount; i++ )
+    {
+        threads.emplace_back( []() {
+            for ( int j = 0; j < additions; j++ )
+            {
+                TraceModule::get().addToVariable( TraceVariable::PERSISTENCY_BYTES_WRITTEN, 2 );
+            }
+        } );
+    }
+    for ( auto &thread : threads )
+    {
+        thread.join();
+    }
+    // No addition is lost and the counts of the exited threads are kept
+    ASSERT_EQ( TraceModule::get().getVariable( TraceVariable::PERSISTENCY_BYTES_WRITTEN ),
+               start + ( threadCount * additions * 2 ) );
+    ASSERT_EQ( TraceModule::get().getVariableMax( TraceVariable::PERSISTENCY_BYTES_WRITTEN ),
+               start + ( threadCount * additions * 2 ) );
+    // A new thread reuses the shard of an exited one
+    std::thread( []() { TraceModule::get().incrementVariable( TraceVariable::PERSISTENCY_BYTES_WRITTEN ); } ).join();
+    ASSERT_EQ( TraceModule::get().getVariable( TraceVariable::PERSISTENCY_BYTES_WRITTEN ),
+               start + ( threadCount * additions * 2 ) + 1 );
+}
+
+TEST( TraceModuleTest, HistogramPercentiles )
+{
+    ASSERT_EQ( TraceModule::get().getHistogramPercentile( TraceHistogram::INSPECTION_COLLECT_DATA_NS, 0.5 ), 0 );
+    std::thread( []() {
+        for ( uint64_t i = 1; i <= 900; i++ )
+        {
+            TraceModule::get().recordHistogram( TraceHistogram::INSPECTION_COLLECT_DATA_NS, 5 );
+        }
+    } ).join();
+    for ( uint64_t i = 1; i <= 99; i++ )
+    {
+        TraceModule::get().recordHistogram( TraceHistogram::INSPECTION_COLLECT_DATA_NS, 1000 );
+    }
+    TraceModule::get().recordHistogram( TraceHistogram::INSPECTION_COLLECT_DATA_NS, 100000 );
+
+    // Small values are exact
+    ASSERT_EQ( TraceModule::get().getHistogramPercentile( TraceHistogram::INSPECTION_COLLECT_DATA_NS, 0.5 ), 5 );
+    // Larger values are accurate to the width of their bucket
+    auto p99 = TraceModule::get().getHistogramPercentile( TraceHistogram::INSPECTION_COLLECT_DATA_NS, 0.99 );
+    ASSERT_GE( p99, 1000 );
+    ASSERT_LE( p99, 1125 );
+    // The highest percentile is limited by the max value
+    ASSERT_EQ( TraceModule::get().getHistogramPercentile( TraceHistogram::INSPECTION_COLLECT_DATA_NS, 1.0 ), 100000 );
+    TraceModule::get().recordHistogram( TraceHistogram::INSPECTION_COLLECT_DATA_NS, UINT64_MAX );
+    ASSERT_EQ( TraceModule::get().getHistogramPercentile( TraceHistogram::INSPECTION_COLLECT_DATA_NS, 1.0 ),
+               TraceModule::HISTOGRAM_MAX_VALUE );
+    TraceModule::get().print();
+    TraceModule::get().startNewObservationWindow();
+    TraceModule::get().print();
+
+    // The window only holds the values recorded after it started
+    ASSERT_EQ( TraceModule::get().getHistogramWindowPercentile( TraceHistogram::INSPECTION_COLLECT_DATA_NS, 1.0 ), 0 );
+    TraceModule::get().recordHistogram( TraceHistogram::INSPECTION_COLLECT_DATA_NS, 7 );
+    ASSERT_EQ( TraceModule::get().getHistogramWindowPercentile( TraceHistogram::INSPECTION_COLLECT_DATA_NS, 1.0 ), 7 );
+}
+
+TEST( TraceModuleTest, ScopedTimerSampling )
+{
+    // Timed on its own thread, so that the sampling counters start at 0
+    std::thread( []() {
+        for ( int i = 0; i < 10; i++ )
+        {
+            TraceScopedTimer timer( TraceHistogram::PROTO_SERIALIZE_NS, 5 );
+            std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+        }
+    } ).join();
+    // Only every fifth scope is timed
+    auto p50 = TraceModule::get().getHistogramPercentile( TraceHistogram::PROTO_SERIALIZE_NS, 0.5 );
+    ASSERT_GE( p50, 1000000 );
+    ASSERT_LT( p50, 1000000000 );
+    ASSERT_EQ( TraceModule::get().getHistogramPercentile( TraceHistogram::PROTO_SERIALIZE_NS, 0.0 ), p50 );
+
+    auto before = TraceScopedTimer::getMonotonicRawTimeNs();
+    std::this_thread::sleep_for( std::chrono::milliseconds( 2 ) );
+    ASSERT_GE( TraceScopedTimer::getMonotonicRawTimeNs() - before, 2000000 );
+}
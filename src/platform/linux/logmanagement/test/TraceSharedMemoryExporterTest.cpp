@@ -0,0 +1,102 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+
+#include "TraceSharedMemoryExporter.h"
+#include <gtest/gtest.h>
+#include <map>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+namespace
+{
+std::string
+getShmName()
+{
+    return "/fwe-trace-test-" + std::to_string( getpid() );
+}
+
+std::map<std::string, double>
+readValues( const fwe_shm_trace_header *segment, fwe_shm_trace_header &header )
+{
+    std::vector<fwe_shm_trace_entry> entries( segment->capacity );
+    auto count = fwe_shm_trace_read( segment, entries.data(), &header );
+    EXPECT_GE( count, 0 );
+    std::map<std::string, double> values;
+    for ( int i = 0; i < count; i++ )
+    {
+        values[entries[i].name] = entries[i].value;
+    }
+    return values;
+}
+} // namespace
+
+TEST( TraceSharedMemoryExporterTest, ExportsCurrentValues )
+{
+    TraceSharedMemoryExporter exporter( getShmName(), 10000 );
+    ASSERT_EQ( fwe_shm_trace_open( getShmName().c_str() ), nullptr );
+    ASSERT_TRUE( exporter.start() );
+    ASSERT_TRUE( exporter.isAlive() );
+    const auto *segment = fwe_shm_trace_open( getShmName().c_str() );
+    ASSERT_NE( segment, nullptr );
+    ASSERT_EQ( segment->pid, getpid() );
+    ASSERT_EQ( segment->update_interval_ms, 10000 );
+
+    TraceModule::get().setNamedVariable( "sharedMemoryTest", 42, "Bytes" );
+    TraceModule::get().addToAtomicVariable( TraceAtomicVariable::SUBSCRIBE_ERROR, 3 );
+    auto subscribeErrors =
+        static_cast<double>( TraceModule::get().getAtomicVariable( TraceAtomicVariable::SUBSCRIBE_ERROR ) );
+    for ( int i = 0; i < 100; i++ )
+    {
+        TraceModule::get().recordHistogram( TraceHistogram::MQTT_PUBLISH_LATENCY_MS, 5 );
+    }
+    exporter.update();
+    fwe_shm_trace_header header{};
+    auto values = readValues( segment, header );
+    ASSERT_EQ( header.dropped_count, 0 );
+    ASSERT_GE( header.update_count, 2 );
+    ASSERT_EQ( values["namedVariable_sharedMemoryTest"], 42.0 );
+    ASSERT_EQ( values["atomic_SubErr"], subscribeErrors );
+    ASSERT_GE( values["histogramCount_PubLat"], 100.0 );
+    ASSERT_EQ( values["histogramP50_PubLat"], 5.0 );
+
+    // The percentiles only cover the values recorded since the previous update
+    TraceModule::get().recordHistogram( TraceHistogram::MQTT_PUBLISH_LATENCY_MS, 7 );
+    exporter.update();
+    values = readValues( segment, header );
+    ASSERT_EQ( values["histogramP50_PubLat"], 7.0 );
+    TraceModule::get().removeNamedVariable( "sharedMemoryTest" );
+
+    fwe_shm_trace_close( segment );
+    ASSERT_TRUE( exporter.stop() );
+    ASSERT_EQ( fwe_shm_trace_open( getShmName().c_str() ), nullptr );
+}
+
+TEST( TraceSharedMemoryExporterTest, DropsValuesAboveCapacity )
+{
+    TraceSharedMemoryExporter exporter( getShmName(), 10000, 4 );
+    ASSERT_TRUE( exporter.start() );
+    const auto *segment = fwe_shm_trace_open( getShmName().c_str() );
+    ASSERT_NE( segment, nullptr );
+    exporter.update();
+    fwe_shm_trace_header header{};
+    auto values = readValues( segment, header );
+    ASSERT_EQ( values.size(), 4 );
+    ASSERT_EQ( header.entry_count, 4 );
+    ASSERT_GT( header.dropped_count, 0 );
+    fwe_shm_trace_close( segment );
+    ASSERT_TRUE( exporter.stop() );
+}
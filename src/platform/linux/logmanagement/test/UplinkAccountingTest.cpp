@@ -0,0 +1,92 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "UplinkAccounting.h"
+#include <gtest/gtest.h>
+#include <map>
+#include <string>
+
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+namespace
+{
+class MetricsCollector : public IMetricsReceiver
+{
+public:
+    void
+    setMetric( const std::string &name, double value, const std::string &unit ) override
+    {
+        static_cast<void>( unit );
+        mMetrics[name] = value;
+    }
+
+    std::map<std::string, double> mMetrics;
+};
+} // namespace
+
+TEST( UplinkAccountingTest, AccountsPerCollectionScheme )
+{
+    auto &accounting = UplinkAccounting::get();
+    auto first = accounting.getAccountId( "uplinkTestScheme1" );
+    auto second = accounting.getAccountId( "uplinkTestScheme2" );
+    ASSERT_NE( first, 0 );
+    ASSERT_NE( second, 0 );
+    ASSERT_NE( first, second );
+    ASSERT_EQ( accounting.getAccountId( "uplinkTestScheme1" ), first );
+    ASSERT_EQ( accounting.getAccountId( "" ), 0 );
+
+    accounting.add( first, UplinkCounter::SERIALIZED_BYTES, 1000 );
+    accounting.add( first, UplinkCounter::COMPRESSED_BYTES, 400 );
+    accounting.add( first, UplinkCounter::PUBLISHES, 1 );
+    accounting.add( first, UplinkCounter::PUBLISHED_BYTES, 400 );
+    accounting.add( second, UplinkCounter::PERSISTED_BYTES, 300 );
+    ASSERT_EQ( accounting.getTotal( first, UplinkCounter::PUBLISHED_BYTES ), 400 );
+    ASSERT_EQ( accounting.getTotal( second, UplinkCounter::PUBLISHED_BYTES ), 0 );
+
+    MetricsCollector collector;
+    accounting.forwardToMetricsReceiver( &collector );
+    ASSERT_EQ( collector.mMetrics["uplinkSerializedBytes_uplinkTestScheme1"], 1000.0 );
+    ASSERT_EQ( collector.mMetrics["uplinkCompressedBytes_uplinkTestScheme1"], 400.0 );
+    ASSERT_EQ( collector.mMetrics["uplinkPublishes_uplinkTestScheme1"], 1.0 );
+    ASSERT_EQ( collector.mMetrics["uplinkPublishedBytes_uplinkTestScheme1"], 400.0 );
+    ASSERT_EQ( collector.mMetrics["uplinkPersistedBytes_uplinkTestScheme2"], 300.0 );
+
+    // The next period only reports what was added since, and nothing for an account without traffic
+    accounting.add( first, UplinkCounter::PUBLISHED_BYTES, 100 );
+    collector.mMetrics.clear();
+    accounting.forwardToMetricsReceiver( &collector );
+    ASSERT_EQ( collector.mMetrics["uplinkPublishedBytes_uplinkTestScheme1"], 100.0 );
+    ASSERT_EQ( collector.mMetrics["uplinkSerializedBytes_uplinkTestScheme1"], 0.0 );
+    ASSERT_EQ( collector.mMetrics.count( "uplinkPersistedBytes_uplinkTestScheme2" ), 0 );
+    ASSERT_EQ( accounting.getTotal( first, UplinkCounter::PUBLISHED_BYTES ), 500 );
+}
+
+TEST( UplinkAccountingTest, UnattributedWhenFull )
+{
+    auto &accounting = UplinkAccounting::get();
+    for ( uint32_t i = 0; i < UplinkAccounting::MAX_ACCOUNTS; i++ )
+    {
+        accounting.getAccountId( "uplinkTestFill" + std::to_string( i ) );
+    }
+    ASSERT_EQ( accounting.getAccountId( "uplinkTestOverflow" ), 0 );
+    // Invalid accounts are ignored
+    accounting.add( UplinkAccounting::MAX_ACCOUNTS, UplinkCounter::PUBLISHES, 1 );
+    ASSERT_EQ( accounting.getTotal( UplinkAccounting::MAX_ACCOUNTS, UplinkCounter::PUBLISHES ), 0 );
+
+    auto unattributed = accounting.getTotal( 0, UplinkCounter::PUBLISHES );
+    accounting.add( accounting.getAccountId( "uplinkTestOverflow" ), UplinkCounter::PUBLISHES, 1 );
+    ASSERT_EQ( accounting.getTotal( 0, UplinkCounter::PUBLISHES ), unattributed + 1 );
+    MetricsCollector collector;
+    accounting.forwardToMetricsReceiver( &collector );
+    ASSERT_EQ( collector.mMetrics["uplinkPublishes_unattributed"], 1.0 );
+}
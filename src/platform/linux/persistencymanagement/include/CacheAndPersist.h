@@ -16,6 +16,7 @@
 // Includes
 #include "ICacheAndPersist.h"
 #include "LoggingModule.h"
+#include "SegmentedLog.h"
 #include <map>
 #include <string>
 #include <vector>
@@ -30,7 +31,11 @@ constexpr size_t INVALID_FILE_SIZE = (size_t)-1;
 // Define File names for the components using the lib
 #define DECODER_MANIFEST_FILE "/DecoderManifest.bin"
 #define COLLECTION_SCHEME_LIST_FILE "/CollectionSchemeList.bin"
+#define DECODER_DICTIONARY_SNAPSHOT_FILE "/DecoderDictionarySnapshot.bin"
+#define OBD_ECU_CACHE_FILE "/OBDECUCache.bin"
+#define QUEUE_SIZES_FILE "/QueueSizes.bin"
 #define COLLECTED_DATA_FILE "/CollectedData.bin"
+#define COLLECTED_DATA_SEGMENT_NAME "CollectedData"
 
 namespace Aws
 {
@@ -49,6 +54,9 @@ namespace PersistencyManagement
  * Underlying storage mechanism writes data to a file.
  * Multiple components using this library e.g. CollectionScheme Manager, Payload Manager are operating on its separate
  * files hence are thread safe.
+ * The collected data is appended to a SegmentedLog. If the partition is full, its oldest segments are evicted to make
+ * space for new data, and after an upload only the segments which were sent are deleted. Writes of collected data can
+ * be buffered and written in batches.
  */
 class CacheAndPersist : public ICacheAndPersist
 {
@@ -58,8 +66,14 @@ public:
      * @brief Constructor
      * @param partitionPath    Partition allocated for the NV storage (from config file)
      * @param maxPartitionSize Partition size should not exceed this.
+     * @param collectedDataSegmentSize size of the segment files of the collected data
+     * @param collectedDataWriteBatchConfig buffering of the collected data writes and fsync policy
      */
-    CacheAndPersist( const std::string &partitionPath, size_t maxPartitionSize );
+    CacheAndPersist(
+        const std::string &partitionPath,
+        size_t maxPartitionSize,
+        size_t collectedDataSegmentSize = SegmentedLog::DEFAULT_SEGMENT_SIZE,
+        const SegmentedLog::WriteBatchConfig &collectedDataWriteBatchConfig = SegmentedLog::WriteBatchConfig() );
 
     /**
      * @brief Writes to the non volatile memory(NVM).
@@ -68,6 +82,8 @@ public:
      * @param size       size of the data to be written
      * @param dataType   specifies if the data is an edge to cloud payload, collectionScheme list, etc.
      *
+     * Collected data evicts the oldest collected data if the partition size is reached.
+     *
      * @return ErrorCode   SUCCESS if the write is successful,
      *                     MEMORY_FULL if the partition size is reached,
      *                     INVALID_DATA if the buffer ptr is NULL
@@ -115,11 +131,75 @@ public:
      */
     bool init();
 
+    /**
+     * @brief Appends to the collected data, evicting its oldest segments if the partition is full
+     *
+     * @param info priority and timestamp of the data, kept in the index of the collected data segments
+     *
+     * @return ErrorCode   SUCCESS if the write is successful,
+     *                     MEMORY_FULL if the partition size is reached,
+     *                     INVALID_DATA if the buffer ptr is NULL
+     *                     FILESYSTEM_ERROR in case of any file I/O errors.
+     */
+    ErrorCode writeCollectedData( const uint8_t *bufPtr,
+                                  size_t size,
+                                  const SegmentedLog::RecordInfo &info = SegmentedLog::RecordInfo() );
+
+    /**
+     * @brief Gets the segments of the collected data from the oldest to the newest
+     */
+    std::vector<SegmentedLog::Segment> getCollectedDataSegments() const;
+
+    /**
+     * @brief Passes the records written to the collected data in one segment to the reader, starting at offset or
+     *        behind the acknowledged records. Each record holds the data of one write.
+     *
+     * @return ErrorCode   SUCCESS if the read is successful,
+     *                     EMPTY if the segment does not exist
+     *                     INVALID_DATA if a corrupted record was found, the segment should be acknowledged to skip it
+     *                     FILESYSTEM_ERROR in case of any file I/O errors.
+     */
+    ErrorCode readCollectedDataRecords( uint64_t segmentId, size_t offset, const SegmentedLog::RecordReader &reader );
+
+    /**
+     * @brief Marks the collected data of a segment before offset as processed, e.g. after it was uploaded. The data
+     *        is then not read again and its disk space is freed
+     *
+     * @return ErrorCode   SUCCESS if the acknowledgement is stored,
+     *                     EMPTY if the segment does not exist
+     *                     FILESYSTEM_ERROR in case of any file I/O errors.
+     */
+    ErrorCode acknowledgeCollectedData( uint64_t segmentId, size_t offset );
+
+    /**
+     * @brief Replaces the records of a closed segment of the collected data, e.g. to compress them in the background.
+     *        See SegmentedLog::rewriteSegment
+     *
+     * @return ErrorCode   SUCCESS if the segment was rewritten or the rewriter changed no record,
+     *                     EMPTY if the segment does not exist, is still written to or was acknowledged partially
+     *                     INVALID_DATA if a corrupted record was found
+     *                     FILESYSTEM_ERROR in case of any file I/O errors.
+     */
+    ErrorCode rewriteCollectedDataSegment( uint64_t segmentId, const SegmentedLog::RecordRewriter &rewriter );
+
+    /**
+     * @brief Deletes one segment of the collected data, e.g. after it was uploaded
+     *
+     * @return ErrorCode   SUCCESS if the delete is successful,
+     *                     EMPTY if the segment does not exist
+     *                     FILESYSTEM_ERROR in case of any file I/O errors.
+     */
+    ErrorCode eraseCollectedDataSegment( uint64_t segmentId );
+
 private:
     std::string mDecoderManifestFile;
     std::string mCollectionSchemeListFile;
+    std::string mDecoderDictionarySnapshotFile;
+    std::string mOBDECUCacheFile;
+    std::string mQueueSizesFile;
     std::string mCollectedDataFile;
     size_t mMaxPersistencePartitionSize;
+    SegmentedLog mCollectedData;
     LoggingModule mLogger;
 
     /**
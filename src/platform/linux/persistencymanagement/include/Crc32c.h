@@ -0,0 +1,46 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include <cstddef>
+#include <cstdint>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace Platform
+{
+namespace Linux
+{
+namespace PersistencyManagement
+{
+/**
+ * @brief CRC32C (Castagnoli), which detects more of the errors of storage than the CRC32 of zlib
+ *
+ * The CRC can be computed over several buffers by passing the result of the previous call.
+ *
+ * @param crc CRC of the preceding data, 0 for the start
+ * @param data Pointer to the data
+ * @param size Size of the data in bytes
+ * @return CRC of the preceding data and this data
+ */
+uint32_t crc32c( uint32_t crc, const uint8_t *data, size_t size );
+
+} // namespace PersistencyManagement
+} // namespace Linux
+} // namespace Platform
+} // namespace IoTFleetWise
+} // namespace Aws
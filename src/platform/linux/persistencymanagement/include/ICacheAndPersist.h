@@ -43,6 +43,9 @@ enum class DataType
     EDGE_TO_CLOUD_PAYLOAD = 0,
     COLLECTION_SCHEME_LIST,
     DECODER_MANIFEST,
+    DECODER_DICTIONARY_SNAPSHOT,
+    OBD_ECU_CACHE,
+    QUEUE_SIZES,
     DEFAULT_DATA_TYPE
 };
 
@@ -0,0 +1,375 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "FastClock.h"
+#include "ICacheAndPersist.h"
+#include "LoggingModule.h"
+#include "MemoryAccounting.h"
+#include "Signal.h"
+#include "Thread.h"
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <sys/uio.h>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace Platform
+{
+namespace Linux
+{
+namespace PersistencyManagement
+{
+/**
+ * @brief Append-only log of records split into segment files of about a fixed size
+ *
+ * Every write is appended to the newest segment as one record, a record never spans two segments. Each record is
+ * framed by a header with its size, a sequence number increasing over the whole log and a CRC32C of the header and
+ * the data, so a torn or corrupted record is detected instead of mis-framing the records behind it. Once a segment
+ * reaches the segment size the next write starts a new one.
+ *
+ * The index of the segments with their sizes is kept in memory and rebuilt from the segment file names in init(), so
+ * no index file has to be rewritten on every write. Only the newest segment can hold a torn write after a power
+ * loss, so init() only scans the records of that segment and truncates it behind the last valid record. The startup
+ * time therefore does not grow with the amount of data. Records of the other segments are checked when read.
+ *
+ * Segments are read through mmap and deleted one by one from the oldest, so a partial upload only deletes the
+ * segments which were sent and making space never rewrites the remaining data.
+ *
+ * Data at the start of a segment can be acknowledged once it was processed. The acknowledged offset is stored in a
+ * small <name>.<id>.ack file next to the segment and the acknowledged range is freed on file systems supporting
+ * hole punching. Once a segment is acknowledged up to its end it is deleted.
+ *
+ * A closed segment which was not acknowledged yet can be rewritten record by record, e.g. to compress its data in the
+ * background. The rewritten segment replaces the old file atomically.
+ *
+ * Every record can be appended with the priority and timestamp of its data. The index keeps the most important
+ * (lowest) priority and the oldest and newest timestamp of every segment, so a reader can process the segments in
+ * another order than they were written. They are stored in a small <name>.<id>.idx file once a segment is closed. A
+ * segment without index file, e.g. the newest one after a power loss, gets priority 0 and the modification time of
+ * its file, so it is never processed after less important data.
+ *
+ * Optionally appends are buffered and written in groups, with one write call per batch instead of one per record.
+ * A batch is written once it reaches the batch size, after the flush interval, before the data is read and when the
+ * log is destroyed. Buffered records are lost on a crash and a write error of a batch drops all its records. The fsync
+ * policy controls whether written data is synced after every batch, in an interval or never.
+ *
+ * Segment files are named <directory>/<name>.<id>.seg with increasing ids. The class is thread safe.
+ */
+class SegmentedLog
+{
+public:
+    static constexpr size_t DEFAULT_SEGMENT_SIZE = 64U * 1024U;
+
+    /**
+     * @brief Size of the header in front of the data of every record
+     */
+    static const size_t RECORD_HEADER_SIZE;
+
+    /**
+     * @brief Reader of records. The data is only valid during the call
+     * @param data      data of the record without the header
+     * @param size      size of the data
+     * @param endOffset offset in the segment behind the record, which can be acknowledged once it is processed
+     * @return false to stop reading
+     */
+    using RecordReader = std::function<bool( const uint8_t *data, size_t size, size_t endOffset )>;
+
+    /**
+     * @brief Rewriter of records, see rewriteSegment. The data is only valid during the call
+     * @param data      data of the record without the header
+     * @param size      size of the data
+     * @param out       new data of the record, only used if true is returned
+     * @return true if out replaces the record, false to keep the record unchanged
+     */
+    using RecordRewriter = std::function<bool( const uint8_t *data, size_t size, std::vector<uint8_t> &out )>;
+
+    enum class FsyncPolicy
+    {
+        NEVER,     /**< Leave it to the operating system when written data reaches the disk */
+        PER_BATCH, /**< Sync after every batch, or every record without batching */
+        INTERVAL   /**< Sync at most once per fsync interval */
+    };
+
+    struct WriteBatchConfig
+    {
+        size_t batchSize{ 0 };            /**< Buffer records until this size is reached, 0 writes them directly */
+        uint32_t flushIntervalMs{ 1000 }; /**< Maximum time a record stays buffered */
+        FsyncPolicy fsyncPolicy{ FsyncPolicy::NEVER };
+        uint32_t fsyncIntervalMs{ 1000 }; /**< Time between syncs with FsyncPolicy::INTERVAL */
+    };
+
+    /**
+     * @brief Metadata of a record kept in the index of its segment. Value initialized it is priority 0 without a time.
+     */
+    struct RecordInfo
+    {
+        uint32_t priority;     /**< Smaller values are more important */
+        Timestamp timestampMs; /**< Time the data was produced, in ms since epoch */
+    };
+
+    struct Segment
+    {
+        uint64_t id{ 0 };
+        size_t size{ 0 };                 /**< Size of the file including the record headers */
+        size_t acknowledged{ 0 };         /**< Records before this offset were processed */
+        uint32_t priority{ 0 };           /**< Most important priority of the records */
+        Timestamp oldestTimestampMs{ 0 }; /**< Oldest timestamp of the records */
+        Timestamp newestTimestampMs{ 0 }; /**< Newest timestamp of the records */
+    };
+
+    /**
+     * @param directory     directory of the segment files
+     * @param name          prefix of the segment file names
+     * @param segmentSize   size after which a new segment is started
+     */
+    SegmentedLog( const std::string &directory, const std::string &name, size_t segmentSize = DEFAULT_SEGMENT_SIZE );
+
+    /**
+     * @param directory     directory of the segment files
+     * @param name          prefix of the segment file names
+     * @param segmentSize   size after which a new segment is started
+     * @param writeBatchConfig buffering of the appends and fsync policy
+     */
+    SegmentedLog( const std::string &directory,
+                  const std::string &name,
+                  size_t segmentSize,
+                  const WriteBatchConfig &writeBatchConfig );
+    ~SegmentedLog();
+
+    SegmentedLog( const SegmentedLog & ) = delete;
+    SegmentedLog &operator=( const SegmentedLog & ) = delete;
+    SegmentedLog( SegmentedLog && ) = delete;
+    SegmentedLog &operator=( SegmentedLog && ) = delete;
+
+    /**
+     * @brief Builds the index from the existing segment files. Starts the thread writing the buffered records if
+     *        needed by the write batch config
+     * @param legacyFile file of the former single file storage. If it has data it becomes the oldest segment
+     * @return true if successful
+     */
+    bool init( const std::string &legacyFile = std::string() );
+
+    /**
+     * @brief Appends the data as a record to the newest segment, or to the buffered batch
+     * @param info priority and timestamp of the data, added to the index of the segment
+     * @return SUCCESS, INVALID_DATA if bufPtr is null, FILESYSTEM_ERROR on I/O errors, including the write of a batch
+     *         completed by this record
+     */
+    ErrorCode append( const uint8_t *bufPtr, size_t size, const RecordInfo &info = RecordInfo() );
+
+    /**
+     * @brief Total size of the segments which was not acknowledged, including the record headers
+     */
+    size_t getSize() const;
+
+    /**
+     * @brief Segments from the oldest to the newest
+     */
+    std::vector<Segment> getSegments() const;
+
+    /**
+     * @brief Maps the segment and passes its records to the reader, starting at offset or behind the acknowledged
+     *        records. A read segment receives no further writes, so it can be deleted after it was processed without
+     *        losing later data
+     * @return SUCCESS, EMPTY if the segment does not exist or has no data, INVALID_DATA if a corrupted record was
+     *         found, the records behind it can not be read and the segment should be acknowledged up to its end,
+     *         FILESYSTEM_ERROR on I/O errors
+     */
+    ErrorCode readRecords( uint64_t id, size_t offset, const RecordReader &reader );
+
+    /**
+     * @brief Marks the records of a segment before offset as processed. A segment acknowledged up to its end is
+     *        deleted. The offset must be the end of a record
+     * @return SUCCESS, EMPTY if the segment does not exist, FILESYSTEM_ERROR if the acknowledgement could not be stored
+     */
+    ErrorCode acknowledge( uint64_t id, size_t offset );
+
+    /**
+     * @brief Replaces the records of a closed segment by the data returned by the rewriter, e.g. to compress them.
+     *        The records keep their order, sequence numbers and the index of the segment. The new segment is
+     *        written to a <name>.<id>.new file which then atomically replaces the segment file, so a crash leaves
+     *        either the old or the new records. Offsets read from the segment before are no longer valid, so the
+     *        caller must make sure that no reader holds such offsets
+     * @return SUCCESS, also if the rewriter changed no record, EMPTY if the segment does not exist, is still written
+     *         to or was acknowledged partially, INVALID_DATA if a corrupted record was found, FILESYSTEM_ERROR on I/O
+     *         errors. The segment is unchanged unless SUCCESS is returned
+     */
+    ErrorCode rewriteSegment( uint64_t id, const RecordRewriter &rewriter );
+
+    /**
+     * @brief Copies the data of the oldest records which were not acknowledged into the buffer, up to size bytes
+     * @return SUCCESS, EMPTY if there is no data, INVALID_DATA if readBufPtr is null, FILESYSTEM_ERROR on I/O errors
+     */
+    ErrorCode read( uint8_t *const readBufPtr, size_t size );
+
+    /**
+     * @brief Deletes one segment
+     * @return SUCCESS, EMPTY if the segment does not exist, FILESYSTEM_ERROR if the file could not be deleted
+     */
+    ErrorCode eraseSegment( uint64_t id );
+
+    /**
+     * @brief Deletes the oldest segment
+     * @return size of the data which was not acknowledged in the deleted segment, 0 if there was none
+     */
+    size_t evictOldest();
+
+    /**
+     * @brief Deletes all segments
+     * @return SUCCESS or FILESYSTEM_ERROR if a file could not be deleted
+     */
+    ErrorCode eraseAll();
+
+private:
+    std::string getSegmentFileName( uint64_t id ) const;
+
+    std::string getAcknowledgeFileName( uint64_t id ) const;
+
+    std::string getIndexFileName( uint64_t id ) const;
+
+    std::string getRewriteFileName( uint64_t id ) const;
+
+    /**
+     * @brief Writes the records of the mapped segment data to the file, replaced by the rewriter where it returns true
+     * @return SUCCESS, INVALID_DATA if a corrupted record was found, FILESYSTEM_ERROR on I/O errors
+     */
+    ErrorCode rewriteRecords( int fd,
+                              uint64_t id,
+                              const uint8_t *data,
+                              size_t size,
+                              const RecordRewriter &rewriter,
+                              size_t &newSize,
+                              bool &changed );
+
+    /**
+     * @brief Loads the acknowledged offsets of the segments and deletes acknowledge files without segment. Must be
+     *        called with mMutex held
+     */
+    void loadAcknowledgements( const std::vector<uint64_t> &acknowledgeFileIds );
+
+    /**
+     * @brief Loads the priorities and timestamps of the segments and deletes index files without segment. Must be
+     *        called with mMutex held
+     */
+    void loadIndexes( const std::vector<uint64_t> &indexFileIds );
+
+    /**
+     * @brief Writes the buffered records and closes the newest segment, the next write starts a new one. Must be
+     *        called with mMutex held
+     */
+    void closeActiveSegment();
+
+    /**
+     * @brief Closes the newest segment dropping the buffered records. Must be called with mMutex held
+     */
+    void discardActiveSegment();
+
+    /**
+     * @brief Writes the buffered records to the newest segment. Must be called with mMutex held
+     */
+    ErrorCode flushLocked();
+
+    /**
+     * @brief Syncs the data written to the newest segment to the disk. Must be called with mMutex held
+     */
+    void syncLocked();
+
+    /**
+     * @brief Accounts data written to the newest segment and syncs it with FsyncPolicy::PER_BATCH. Must be called
+     *        with mMutex held
+     */
+    void onWritten( size_t size );
+
+    /**
+     * @brief Drops the newest segment behind durableSize after a failed write. Must be called with mMutex held
+     */
+    void onWriteFailed( size_t durableSize );
+
+    /**
+     * @brief Writes the batch or syncs if their interval is over
+     * @return time until the next interval is over
+     */
+    uint32_t flushDue();
+
+    static void doWork( void *data );
+
+    /**
+     * @brief Truncates the newest segment behind its last valid record and restores the next sequence number from
+     *        it. Segments without valid record behind the acknowledged ones are deleted. Must be called with mMutex
+     *        held after the acknowledgements were loaded
+     */
+    void recoverNewestSegment();
+
+    /**
+     * @brief Writes a record to the end of the file
+     */
+    bool writeRecord( int fd, const uint8_t *bufPtr, size_t size, uint64_t sequence );
+
+    /**
+     * @brief Writes all parts to the end of the file, retrying on partial writes
+     */
+    bool writeParts( int fd, struct iovec *parts, int count );
+
+    /**
+     * @brief Moves the data of the former single file storage into the oldest segment. Must be called with mMutex held
+     */
+    bool takeOverLegacyFile( const std::string &legacyFile );
+
+    ErrorCode eraseSegmentLocked( std::deque<Segment>::iterator segment );
+
+    using MappedReader = std::function<void( const uint8_t *data, size_t size )>;
+
+    /**
+     * @brief Passes the records of mapped segment data from pos on to the reader
+     * @return SUCCESS, or INVALID_DATA if a corrupted record was found
+     */
+    ErrorCode parseRecords( uint64_t id, const uint8_t *data, size_t size, size_t pos, const RecordReader &reader );
+
+    ErrorCode mapSegment( const Segment &segment, const MappedReader &reader );
+
+    std::string mDirectory;
+    std::string mName;
+    size_t mSegmentSize;
+    mutable std::mutex mMutex;
+    std::deque<Segment> mSegments;
+    size_t mTotalSize{ 0 };
+    uint64_t mNextId{ 1 };
+    uint64_t mNextSequence{ 1 };
+    int mActiveFd{ -1 };
+    WriteBatchConfig mWriteBatchConfig;
+    std::vector<uint8_t, TrackedAllocator<uint8_t, MemorySubsystem::PERSISTENCY>> mPendingRecords;
+    Timestamp mPendingSinceMs{ 0 };
+    size_t mUnsyncedBytes{ 0 };
+    Timestamp mLastSyncMs{ 0 };
+    Thread mThread;
+    std::atomic<bool> mShouldStop{ false };
+    Signal mWait;
+    LoggingModule mLogger;
+};
+
+} // namespace PersistencyManagement
+} // namespace Linux
+} // namespace Platform
+} // namespace IoTFleetWise
+} // namespace Aws
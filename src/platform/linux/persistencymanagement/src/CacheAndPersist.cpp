@@ -13,6 +13,7 @@
 
 // Includes
 #include "CacheAndPersist.h"
+#include <algorithm>
 #include <cstdio>
 #include <fstream>
 #include <ios>
@@ -21,11 +22,20 @@
 
 using namespace Aws::IoTFleetWise::Platform::Linux::PersistencyManagement;
 
-CacheAndPersist::CacheAndPersist( const std::string &partitionPath, size_t maxPartitionSize )
+CacheAndPersist::CacheAndPersist( const std::string &partitionPath,
+                                  size_t maxPartitionSize,
+                                  size_t collectedDataSegmentSize,
+                                  const SegmentedLog::WriteBatchConfig &collectedDataWriteBatchConfig )
+    : mCollectedData(
+          partitionPath, COLLECTED_DATA_SEGMENT_NAME, collectedDataSegmentSize, collectedDataWriteBatchConfig )
 {
     // Define the file paths
     mDecoderManifestFile = partitionPath + DECODER_MANIFEST_FILE;
     mCollectionSchemeListFile = partitionPath + COLLECTION_SCHEME_LIST_FILE;
+    mDecoderDictionarySnapshotFile = partitionPath + DECODER_DICTIONARY_SNAPSHOT_FILE;
+    mOBDECUCacheFile = partitionPath + OBD_ECU_CACHE_FILE;
+    mQueueSizesFile = partitionPath + QUEUE_SIZES_FILE;
+    // Only read once to take over data of the former single file storage
     mCollectedDataFile = partitionPath + COLLECTED_DATA_FILE;
 
     mMaxPersistencePartitionSize = maxPartitionSize;
@@ -46,10 +56,27 @@ CacheAndPersist::init()
         return false;
     }
 
-    if ( createFile( mCollectedDataFile ) != ErrorCode::SUCCESS )
+    if ( createFile( mDecoderDictionarySnapshotFile ) != ErrorCode::SUCCESS )
     {
-        mLogger.error( "PersistencyManagement::init", " Failed to create collected data file " );
+        mLogger.error( "PersistencyManagement::init", " Failed to create decoder dictionary snapshot file " );
+        return false;
+    }
+
+    if ( createFile( mOBDECUCacheFile ) != ErrorCode::SUCCESS )
+    {
+        mLogger.error( "PersistencyManagement::init", " Failed to create OBD ECU cache file " );
+        return false;
+    }
 
+    if ( createFile( mQueueSizesFile ) != ErrorCode::SUCCESS )
+    {
+        mLogger.error( "PersistencyManagement::init", " Failed to create queue sizes file " );
+        return false;
+    }
+
+    if ( !mCollectedData.init( mCollectedDataFile ) )
+    {
+        mLogger.error( "PersistencyManagement::init", " Failed to load collected data segments " );
         return false;
     }
 
@@ -100,8 +127,14 @@ CacheAndPersist::write( const uint8_t *bufPtr, size_t size, DataType dataType )
         return ErrorCode::INVALID_DATA;
     }
 
+    if ( dataType == DataType::EDGE_TO_CLOUD_PAYLOAD )
+    {
+        return writeCollectedData( bufPtr, size );
+    }
+
     if ( getSize( DataType::COLLECTION_SCHEME_LIST ) + getSize( DataType::DECODER_MANIFEST ) +
-             getSize( DataType::EDGE_TO_CLOUD_PAYLOAD ) + size >=
+             getSize( DataType::DECODER_DICTIONARY_SNAPSHOT ) + getSize( DataType::OBD_ECU_CACHE ) +
+             getSize( DataType::QUEUE_SIZES ) + getSize( DataType::EDGE_TO_CLOUD_PAYLOAD ) + size >=
          mMaxPersistencePartitionSize )
     {
         return ErrorCode::MEMORY_FULL;
@@ -117,8 +150,16 @@ CacheAndPersist::write( const uint8_t *bufPtr, size_t size, DataType dataType )
         fileName = mDecoderManifestFile;
         break;
 
-    case DataType::EDGE_TO_CLOUD_PAYLOAD:
-        fileName = mCollectedDataFile;
+    case DataType::DECODER_DICTIONARY_SNAPSHOT:
+        fileName = mDecoderDictionarySnapshotFile;
+        break;
+
+    case DataType::OBD_ECU_CACHE:
+        fileName = mOBDECUCacheFile;
+        break;
+
+    case DataType::QUEUE_SIZES:
+        fileName = mQueueSizesFile;
         break;
 
     default:
@@ -127,16 +168,8 @@ CacheAndPersist::write( const uint8_t *bufPtr, size_t size, DataType dataType )
         return status;
     }
 
-    if ( dataType == DataType::EDGE_TO_CLOUD_PAYLOAD )
-    {
-        // Payload is appended to the existing file
-        file.open( fileName.c_str(), std::ios_base::binary | std::ios_base::app );
-    }
-    else
-    {
-        // CollectionScheme list and Decoder Manifest are overwritten
-        file.open( fileName.c_str(), std::ios_base::binary );
-    }
+    // CollectionScheme list, Decoder Manifest, the snapshot, the OBD ECU cache and the queue sizes are overwritten
+    file.open( fileName.c_str(), std::ios_base::binary );
 
     if ( !file.is_open() )
     {
@@ -164,6 +197,11 @@ CacheAndPersist::getSize( DataType dataType )
     size_t size = 0U;
     struct stat res = {};
 
+    if ( dataType == DataType::EDGE_TO_CLOUD_PAYLOAD )
+    {
+        return mCollectedData.getSize();
+    }
+
     switch ( dataType )
     {
     case DataType::COLLECTION_SCHEME_LIST:
@@ -174,8 +212,16 @@ CacheAndPersist::getSize( DataType dataType )
         fileName = mDecoderManifestFile;
         break;
 
-    case DataType::EDGE_TO_CLOUD_PAYLOAD:
-        fileName = mCollectedDataFile;
+    case DataType::DECODER_DICTIONARY_SNAPSHOT:
+        fileName = mDecoderDictionarySnapshotFile;
+        break;
+
+    case DataType::OBD_ECU_CACHE:
+        fileName = mOBDECUCacheFile;
+        break;
+
+    case DataType::QUEUE_SIZES:
+        fileName = mQueueSizesFile;
         break;
 
     default:
@@ -203,6 +249,11 @@ CacheAndPersist::read( uint8_t *const readBufPtr, size_t size, DataType dataType
         return ErrorCode::INVALID_DATA;
     }
 
+    if ( dataType == DataType::EDGE_TO_CLOUD_PAYLOAD )
+    {
+        return mCollectedData.read( readBufPtr, std::min( size, mMaxPersistencePartitionSize ) );
+    }
+
     switch ( dataType )
     {
     case DataType::COLLECTION_SCHEME_LIST:
@@ -213,8 +264,16 @@ CacheAndPersist::read( uint8_t *const readBufPtr, size_t size, DataType dataType
         fileName = mDecoderManifestFile;
         break;
 
-    case DataType::EDGE_TO_CLOUD_PAYLOAD:
-        fileName = mCollectedDataFile;
+    case DataType::DECODER_DICTIONARY_SNAPSHOT:
+        fileName = mDecoderDictionarySnapshotFile;
+        break;
+
+    case DataType::OBD_ECU_CACHE:
+        fileName = mOBDECUCacheFile;
+        break;
+
+    case DataType::QUEUE_SIZES:
+        fileName = mQueueSizesFile;
         break;
 
     default:
@@ -260,6 +319,11 @@ CacheAndPersist::erase( DataType dataType )
     ErrorCode status = ErrorCode::SUCCESS;
     std::string fileName;
 
+    if ( dataType == DataType::EDGE_TO_CLOUD_PAYLOAD )
+    {
+        return mCollectedData.eraseAll();
+    }
+
     switch ( dataType )
     {
     case DataType::COLLECTION_SCHEME_LIST:
@@ -270,8 +334,16 @@ CacheAndPersist::erase( DataType dataType )
         fileName = mDecoderManifestFile;
         break;
 
-    case DataType::EDGE_TO_CLOUD_PAYLOAD:
-        fileName = mCollectedDataFile;
+    case DataType::DECODER_DICTIONARY_SNAPSHOT:
+        fileName = mDecoderDictionarySnapshotFile;
+        break;
+
+    case DataType::OBD_ECU_CACHE:
+        fileName = mOBDECUCacheFile;
+        break;
+
+    case DataType::QUEUE_SIZES:
+        fileName = mQueueSizesFile;
         break;
 
     default:
@@ -297,6 +369,73 @@ CacheAndPersist::erase( DataType dataType )
     return status;
 }
 
+ErrorCode
+CacheAndPersist::writeCollectedData( const uint8_t *bufPtr, size_t size, const SegmentedLog::RecordInfo &info )
+{
+    size_t otherDataSize = getSize( DataType::COLLECTION_SCHEME_LIST ) + getSize( DataType::DECODER_MANIFEST ) +
+                           getSize( DataType::DECODER_DICTIONARY_SNAPSHOT ) + getSize( DataType::OBD_ECU_CACHE ) +
+                           getSize( DataType::QUEUE_SIZES );
+    size_t recordSize = size + SegmentedLog::RECORD_HEADER_SIZE;
+    if ( otherDataSize + recordSize >= mMaxPersistencePartitionSize )
+    {
+        return ErrorCode::MEMORY_FULL;
+    }
+
+    // Make space by dropping the oldest collected data
+    size_t evictedSize = 0;
+    while ( otherDataSize + mCollectedData.getSize() + recordSize >= mMaxPersistencePartitionSize )
+    {
+        auto segmentSize = mCollectedData.evictOldest();
+        if ( segmentSize == 0U )
+        {
+            return ErrorCode::MEMORY_FULL;
+        }
+        evictedSize += segmentSize;
+    }
+    if ( evictedSize > 0U )
+    {
+        mLogger.warn( "PersistencyManagement::write",
+                      " Partition full, evicted " + std::to_string( evictedSize ) + " bytes of the oldest data " );
+    }
+
+    ErrorCode status = mCollectedData.append( bufPtr, size, info );
+    if ( status != ErrorCode::SUCCESS )
+    {
+        mLogger.error( "PersistencyManagement::write", " Error writing the collected data " );
+    }
+    return status;
+}
+
+std::vector<SegmentedLog::Segment>
+CacheAndPersist::getCollectedDataSegments() const
+{
+    return mCollectedData.getSegments();
+}
+
+ErrorCode
+CacheAndPersist::readCollectedDataRecords( uint64_t segmentId, size_t offset, const SegmentedLog::RecordReader &reader )
+{
+    return mCollectedData.readRecords( segmentId, offset, reader );
+}
+
+ErrorCode
+CacheAndPersist::acknowledgeCollectedData( uint64_t segmentId, size_t offset )
+{
+    return mCollectedData.acknowledge( segmentId, offset );
+}
+
+ErrorCode
+CacheAndPersist::rewriteCollectedDataSegment( uint64_t segmentId, const SegmentedLog::RecordRewriter &rewriter )
+{
+    return mCollectedData.rewriteSegment( segmentId, rewriter );
+}
+
+ErrorCode
+CacheAndPersist::eraseCollectedDataSegment( uint64_t segmentId )
+{
+    return mCollectedData.eraseSegment( segmentId );
+}
+
 const char *
 ICacheAndPersist::getErrorString( ErrorCode err )
 {
@@ -0,0 +1,57 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "Crc32c.h"
+#include <array>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace Platform
+{
+namespace Linux
+{
+namespace PersistencyManagement
+{
+
+uint32_t
+crc32c( uint32_t crc, const uint8_t *data, size_t size )
+{
+    static const std::array<uint32_t, 256> table = []() {
+        std::array<uint32_t, 256> entries{};
+        for ( uint32_t i = 0; i < entries.size(); i++ )
+        {
+            uint32_t entry = i;
+            for ( int bit = 0; bit < 8; bit++ )
+            {
+                entry = ( ( entry & 1U ) != 0U ) ? ( ( entry >> 1U ) ^ 0x82F63B78U ) : ( entry >> 1U );
+            }
+            entries[i] = entry;
+        }
+        return entries;
+    }();
+    crc = ~crc;
+    for ( size_t i = 0; i < size; i++ )
+    {
+        crc = table[( crc ^ data[i] ) & 0xFFU] ^ ( crc >> 8U );
+    }
+    return ~crc;
+}
+
+} // namespace PersistencyManagement
+} // namespace Linux
+} // namespace Platform
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -0,0 +1,1101 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "SegmentedLog.h"
+#include "Crc32c.h"
+#include "TraceModule.h"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace Aws::IoTFleetWise::Platform::Linux::PersistencyManagement;
+
+namespace
+{
+constexpr const char *SEGMENT_FILE_SUFFIX = ".seg";
+constexpr const char *ACKNOWLEDGE_FILE_SUFFIX = ".ack";
+constexpr const char *INDEX_FILE_SUFFIX = ".idx";
+constexpr const char *REWRITE_FILE_SUFFIX = ".new";
+constexpr uint32_t RECORD_MAGIC = 0x4C524546U; // "FERL"
+
+#pragma pack( push, 1 )
+struct RecordHeader
+{
+    uint32_t magic{ 0 };
+    uint32_t crc{ 0 }; /**< CRC32C of the header behind this field and the data */
+    uint64_t sequence{ 0 };
+    uint32_t size{ 0 };
+};
+#pragma pack( pop )
+
+constexpr size_t RECORD_CRC_START = offsetof( RecordHeader, sequence );
+
+uint32_t
+getRecordCrc( const RecordHeader &header, const uint8_t *data )
+{
+    uint32_t crc = crc32c(
+        0, reinterpret_cast<const uint8_t *>( &header ) + RECORD_CRC_START, sizeof( RecordHeader ) - RECORD_CRC_START );
+    return crc32c( crc, data, header.size );
+}
+
+RecordHeader
+makeRecordHeader( const uint8_t *data, size_t size, uint64_t sequence )
+{
+    RecordHeader header;
+    header.magic = RECORD_MAGIC;
+    header.sequence = sequence;
+    header.size = static_cast<uint32_t>( size );
+    header.crc = getRecordCrc( header, data );
+    return header;
+}
+
+/**
+ * @brief Checks the record at pos
+ * @param minimumSequence the sequence number of the record must not be lower
+ * @return false if there is no valid record at pos
+ */
+bool
+parseRecord( const uint8_t *data,
+             size_t size,
+             size_t pos,
+             uint64_t minimumSequence,
+             const uint8_t *&recordData,
+             size_t &recordSize,
+             uint64_t &sequence )
+{
+    if ( ( pos > size ) || ( ( size - pos ) < sizeof( RecordHeader ) ) )
+    {
+        return false;
+    }
+    RecordHeader header;
+    memcpy( &header, data + pos, sizeof( RecordHeader ) );
+    if ( ( header.magic != RECORD_MAGIC ) || ( header.size > ( size - pos - sizeof( RecordHeader ) ) ) ||
+         ( header.sequence < minimumSequence ) )
+    {
+        return false;
+    }
+    recordData = data + pos + sizeof( RecordHeader );
+    if ( getRecordCrc( header, recordData ) != header.crc )
+    {
+        return false;
+    }
+    recordSize = header.size;
+    sequence = header.sequence;
+    return true;
+}
+
+/**
+ * @brief Parses the id out of <prefix><id><suffix>
+ * @return false if the file name does not match
+ */
+bool
+parseFileId( const std::string &fileName, const std::string &prefix, const std::string &suffix, uint64_t &id )
+{
+    if ( ( fileName.size() <= ( prefix.size() + suffix.size() ) ) ||
+         ( fileName.compare( 0, prefix.size(), prefix ) != 0 ) ||
+         ( fileName.compare( fileName.size() - suffix.size(), suffix.size(), suffix ) != 0 ) )
+    {
+        return false;
+    }
+    std::string idString = fileName.substr( prefix.size(), fileName.size() - prefix.size() - suffix.size() );
+    if ( idString.find_first_not_of( "0123456789" ) != std::string::npos )
+    {
+        return false;
+    }
+    id = std::strtoull( idString.c_str(), nullptr, 10 );
+    return true;
+}
+} // namespace
+
+const size_t SegmentedLog::RECORD_HEADER_SIZE = sizeof( RecordHeader );
+
+SegmentedLog::SegmentedLog( const std::string &directory, const std::string &name, size_t segmentSize )
+    : SegmentedLog( directory, name, segmentSize, WriteBatchConfig() )
+{
+}
+
+SegmentedLog::SegmentedLog( const std::string &directory,
+                            const std::string &name,
+                            size_t segmentSize,
+                            const WriteBatchConfig &writeBatchConfig )
+    : mDirectory( directory )
+    , mName( name )
+    , mSegmentSize( segmentSize )
+    , mWriteBatchConfig( writeBatchConfig )
+{
+}
+
+SegmentedLog::~SegmentedLog()
+{
+    if ( mThread.isValid() )
+    {
+        mShouldStop.store( true );
+        mWait.notify();
+        mThread.release();
+    }
+    std::lock_guard<std::mutex> lock( mMutex );
+    // Writes the buffered records
+    closeActiveSegment();
+}
+
+std::string
+SegmentedLog::getSegmentFileName( uint64_t id ) const
+{
+    return mDirectory + "/" + mName + "." + std::to_string( id ) + SEGMENT_FILE_SUFFIX;
+}
+
+std::string
+SegmentedLog::getAcknowledgeFileName( uint64_t id ) const
+{
+    return mDirectory + "/" + mName + "." + std::to_string( id ) + ACKNOWLEDGE_FILE_SUFFIX;
+}
+
+std::string
+SegmentedLog::getIndexFileName( uint64_t id ) const
+{
+    return mDirectory + "/" + mName + "." + std::to_string( id ) + INDEX_FILE_SUFFIX;
+}
+
+std::string
+SegmentedLog::getRewriteFileName( uint64_t id ) const
+{
+    return mDirectory + "/" + mName + "." + std::to_string( id ) + REWRITE_FILE_SUFFIX;
+}
+
+bool
+SegmentedLog::init( const std::string &legacyFile )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    closeActiveSegment();
+    mSegments.clear();
+    mTotalSize = 0;
+    mNextId = 1;
+    mNextSequence = 1;
+
+    DIR *dir = opendir( mDirectory.c_str() );
+    if ( dir == nullptr )
+    {
+        mLogger.error( "SegmentedLog::init", " Could not open directory " + mDirectory );
+        return false;
+    }
+    const std::string prefix = mName + ".";
+    std::vector<uint64_t> acknowledgeFileIds;
+    std::vector<uint64_t> indexFileIds;
+    for ( struct dirent *entry = readdir( dir ); entry != nullptr; entry = readdir( dir ) )
+    {
+        std::string fileName( entry->d_name );
+        Segment segment;
+        if ( parseFileId( fileName, prefix, ACKNOWLEDGE_FILE_SUFFIX, segment.id ) )
+        {
+            acknowledgeFileIds.push_back( segment.id );
+            continue;
+        }
+        if ( parseFileId( fileName, prefix, INDEX_FILE_SUFFIX, segment.id ) )
+        {
+            indexFileIds.push_back( segment.id );
+            continue;
+        }
+        if ( parseFileId( fileName, prefix, REWRITE_FILE_SUFFIX, segment.id ) )
+        {
+            // Left over from an interrupted rewrite, the segment file still has the old records
+            unlink( getRewriteFileName( segment.id ).c_str() );
+            continue;
+        }
+        if ( !parseFileId( fileName, prefix, SEGMENT_FILE_SUFFIX, segment.id ) )
+        {
+            continue;
+        }
+        struct stat res = {};
+        if ( stat( getSegmentFileName( segment.id ).c_str(), &res ) != 0 )
+        {
+            continue;
+        }
+        segment.size = static_cast<size_t>( res.st_size );
+        if ( segment.size == 0U )
+        {
+            // Left over from an interrupted write
+            unlink( getSegmentFileName( segment.id ).c_str() );
+            continue;
+        }
+        // Replaced by the index file if there is one
+        segment.oldestTimestampMs = static_cast<Timestamp>( res.st_mtime ) * 1000U;
+        segment.newestTimestampMs = segment.oldestTimestampMs;
+        mSegments.push_back( segment );
+    }
+    closedir( dir );
+
+    std::sort( mSegments.begin(), mSegments.end(), []( const Segment &a, const Segment &b ) { return a.id < b.id; } );
+    if ( !mSegments.empty() )
+    {
+        mNextId = mSegments.back().id + 1U;
+    }
+    // The acknowledged range of the newest segment may be a hole, so the scan starts behind it
+    loadAcknowledgements( acknowledgeFileIds );
+    loadIndexes( indexFileIds );
+    recoverNewestSegment();
+
+    // Data of the former single file storage is kept as the oldest segment
+    if ( !takeOverLegacyFile( legacyFile ) )
+    {
+        return false;
+    }
+
+    for ( const auto &segment : mSegments )
+    {
+        mTotalSize += segment.size - segment.acknowledged;
+    }
+    mLogger.trace( "SegmentedLog::init",
+                   " Found " + std::to_string( mSegments.size() ) + " segments with " + std::to_string( mTotalSize ) +
+                       " bytes" );
+
+    // Buffered records and interval syncs are handled by a thread, so they do not wait for the next append
+    bool needsThread =
+        ( mWriteBatchConfig.batchSize > 0U ) || ( mWriteBatchConfig.fsyncPolicy == FsyncPolicy::INTERVAL );
+    if ( needsThread && ( !mThread.isValid() ) )
+    {
+        mShouldStop.store( false );
+        if ( !mThread.create( doWork, this, "fwPMFlush" ) )
+        {
+            mLogger.error( "SegmentedLog::init", " Flush thread failed to start" );
+            return false;
+        }
+    }
+    return true;
+}
+
+void
+SegmentedLog::recoverNewestSegment()
+{
+    while ( !mSegments.empty() )
+    {
+        auto &segment = mSegments.back();
+        size_t validSize = segment.acknowledged;
+        uint64_t nextSequence = 0;
+        auto status = mapSegment( segment, [&validSize, &nextSequence]( const uint8_t *data, size_t size ) {
+            const uint8_t *recordData = nullptr;
+            size_t recordSize = 0;
+            uint64_t sequence = 0;
+            while ( parseRecord( data, size, validSize, nextSequence, recordData, recordSize, sequence ) )
+            {
+                validSize += sizeof( RecordHeader ) + recordSize;
+                nextSequence = sequence + 1U;
+            }
+        } );
+        if ( status == ErrorCode::FILESYSTEM_ERROR )
+        {
+            return;
+        }
+        if ( validSize == segment.acknowledged )
+        {
+            mLogger.warn( "SegmentedLog::recoverNewestSegment",
+                          " No valid record in segment " + std::to_string( segment.id ) + ", deleting it" );
+            unlink( getSegmentFileName( segment.id ).c_str() );
+            unlink( getAcknowledgeFileName( segment.id ).c_str() );
+            unlink( getIndexFileName( segment.id ).c_str() );
+            mSegments.pop_back();
+            continue;
+        }
+        if ( validSize < segment.size )
+        {
+            // Torn write of a power loss, the records behind it would be mis-framed
+            mLogger.warn( "SegmentedLog::recoverNewestSegment",
+                          " Truncating segment " + std::to_string( segment.id ) + " from " +
+                              std::to_string( segment.size ) + " to " + std::to_string( validSize ) + " bytes" );
+            if ( truncate( getSegmentFileName( segment.id ).c_str(), static_cast<off_t>( validSize ) ) != 0 )
+            {
+                mLogger.error( "SegmentedLog::recoverNewestSegment", " Could not truncate the segment" );
+            }
+            segment.size = validSize;
+        }
+        mNextSequence = std::max( mNextSequence, nextSequence );
+        return;
+    }
+}
+
+bool
+SegmentedLog::writeRecord( int fd, const uint8_t *bufPtr, size_t size, uint64_t sequence )
+{
+    auto header = makeRecordHeader( bufPtr, size, sequence );
+    // Header and data are written with a single call. A power loss can still tear the record, which is then found
+    // by the CRC
+    std::array<struct iovec, 2> parts = { { { &header, sizeof( header ) },
+                                            { const_cast<uint8_t *>( bufPtr ), size } } };
+    return writeParts( fd, parts.data(), static_cast<int>( parts.size() ) );
+}
+
+bool
+SegmentedLog::writeParts( int fd, struct iovec *parts, int count )
+{
+    struct iovec *current = parts;
+    while ( count > 0 )
+    {
+        auto res = writev( fd, current, count );
+        if ( res < 0 )
+        {
+            if ( errno == EINTR )
+            {
+                continue;
+            }
+            mLogger.error( "SegmentedLog::writeParts",
+                           " Error writing the records: " + std::string( strerror( errno ) ) );
+            return false;
+        }
+        auto written = static_cast<size_t>( res );
+        while ( ( count > 0 ) && ( written >= current->iov_len ) )
+        {
+            written -= current->iov_len;
+            current++;
+            count--;
+        }
+        if ( count > 0 )
+        {
+            current->iov_base = static_cast<uint8_t *>( current->iov_base ) + written;
+            current->iov_len -= written;
+        }
+    }
+    return true;
+}
+
+bool
+SegmentedLog::takeOverLegacyFile( const std::string &legacyFile )
+{
+    struct stat legacy = {};
+    if ( legacyFile.empty() || ( stat( legacyFile.c_str(), &legacy ) != 0 ) )
+    {
+        return true;
+    }
+    if ( legacy.st_size > 0 )
+    {
+        // The legacy file is at most as large as the persistency partition and only read once
+        std::vector<uint8_t> data( static_cast<size_t>( legacy.st_size ) );
+        std::ifstream file( legacyFile, std::ios_base::binary );
+        if ( !file.read( reinterpret_cast<char *>( data.data() ), static_cast<std::streamsize>( data.size() ) ) )
+        {
+            mLogger.error( "SegmentedLog::init", " Could not read " + legacyFile );
+            return false;
+        }
+
+        Segment segment;
+        bool oldest = mSegments.empty() || ( mSegments.front().id > 0U );
+        segment.id = ( ( !mSegments.empty() ) && oldest ) ? ( mSegments.front().id - 1U ) : mNextId++;
+        // Older than all records of the log, which start with sequence number 1
+        uint64_t sequence = oldest ? 0U : mNextSequence++;
+        int fd = open( getSegmentFileName( segment.id ).c_str(),
+                       O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                       S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH );
+        bool written = ( fd >= 0 ) && writeRecord( fd, data.data(), data.size(), sequence );
+        if ( written && ( mWriteBatchConfig.fsyncPolicy != FsyncPolicy::NEVER ) )
+        {
+            // The legacy file is deleted next
+            written = ( fdatasync( fd ) == 0 );
+        }
+        if ( fd >= 0 )
+        {
+            close( fd );
+        }
+        if ( !written )
+        {
+            mLogger.error( "SegmentedLog::init", " Could not move " + legacyFile + " into a segment" );
+            unlink( getSegmentFileName( segment.id ).c_str() );
+            return false;
+        }
+        segment.size = sizeof( RecordHeader ) + data.size();
+        if ( oldest )
+        {
+            mSegments.push_front( segment );
+        }
+        else
+        {
+            mSegments.push_back( segment );
+        }
+    }
+    unlink( legacyFile.c_str() );
+    return true;
+}
+
+void
+SegmentedLog::loadAcknowledgements( const std::vector<uint64_t> &acknowledgeFileIds )
+{
+    for ( auto id : acknowledgeFileIds )
+    {
+        auto segment = std::find_if(
+            mSegments.begin(), mSegments.end(), [id]( const Segment &candidate ) { return candidate.id == id; } );
+        if ( segment == mSegments.end() )
+        {
+            // The segment was deleted before its acknowledge file, a new segment could get the same id
+            unlink( getAcknowledgeFileName( id ).c_str() );
+            continue;
+        }
+        std::ifstream file( getAcknowledgeFileName( id ) );
+        size_t acknowledged = 0;
+        if ( file >> acknowledged )
+        {
+            segment->acknowledged = std::min( acknowledged, segment->size );
+        }
+    }
+    // Segments processed completely before the deletion was interrupted
+    for ( auto segment = mSegments.begin(); segment != mSegments.end(); )
+    {
+        if ( segment->acknowledged >= segment->size )
+        {
+            unlink( getSegmentFileName( segment->id ).c_str() );
+            unlink( getAcknowledgeFileName( segment->id ).c_str() );
+            unlink( getIndexFileName( segment->id ).c_str() );
+            segment = mSegments.erase( segment );
+        }
+        else
+        {
+            segment++;
+        }
+    }
+}
+
+void
+SegmentedLog::loadIndexes( const std::vector<uint64_t> &indexFileIds )
+{
+    for ( auto id : indexFileIds )
+    {
+        auto segment = std::find_if(
+            mSegments.begin(), mSegments.end(), [id]( const Segment &candidate ) { return candidate.id == id; } );
+        if ( segment == mSegments.end() )
+        {
+            // The segment was deleted before its index file, a new segment could get the same id
+            unlink( getIndexFileName( id ).c_str() );
+            continue;
+        }
+        std::ifstream file( getIndexFileName( id ) );
+        Segment index;
+        if ( file >> index.priority >> index.oldestTimestampMs >> index.newestTimestampMs )
+        {
+            segment->priority = index.priority;
+            segment->oldestTimestampMs = index.oldestTimestampMs;
+            segment->newestTimestampMs = index.newestTimestampMs;
+        }
+    }
+}
+
+void
+SegmentedLog::closeActiveSegment()
+{
+    if ( mActiveFd < 0 )
+    {
+        return;
+    }
+    if ( flushLocked() != ErrorCode::SUCCESS )
+    {
+        // Already closed
+        return;
+    }
+    if ( mWriteBatchConfig.fsyncPolicy != FsyncPolicy::NEVER )
+    {
+        // Nothing is written to the segment anymore, so an interval sync would miss it
+        syncLocked();
+    }
+    close( mActiveFd );
+    mActiveFd = -1;
+    // Without index file the segment is treated as most important when read after a restart
+    const auto &segment = mSegments.back();
+    std::ofstream file( getIndexFileName( segment.id ), std::ios_base::trunc );
+    file << segment.priority << " " << segment.oldestTimestampMs << " " << segment.newestTimestampMs;
+    file.close();
+    if ( file.fail() )
+    {
+        mLogger.warn( "SegmentedLog::closeActiveSegment",
+                      " Could not store the index of segment " + std::to_string( segment.id ) );
+    }
+}
+
+void
+SegmentedLog::discardActiveSegment()
+{
+    mPendingRecords.clear();
+    mUnsyncedBytes = 0;
+    if ( mActiveFd >= 0 )
+    {
+        close( mActiveFd );
+        mActiveFd = -1;
+    }
+}
+
+ErrorCode
+SegmentedLog::flushLocked()
+{
+    if ( mPendingRecords.empty() )
+    {
+        return ErrorCode::SUCCESS;
+    }
+    size_t size = mPendingRecords.size();
+    struct iovec batch = { mPendingRecords.data(), size };
+    bool written = writeParts( mActiveFd, &batch, 1 );
+    mPendingRecords.clear();
+    if ( !written )
+    {
+        onWriteFailed( mSegments.back().size - size );
+        return ErrorCode::FILESYSTEM_ERROR;
+    }
+    onWritten( size );
+    return ErrorCode::SUCCESS;
+}
+
+void
+SegmentedLog::syncLocked()
+{
+    if ( ( mActiveFd < 0 ) || ( mUnsyncedBytes == 0U ) )
+    {
+        return;
+    }
+    TraceModule::get().sectionBegin( TraceSection::PERSISTENCY_FSYNC );
+    if ( fdatasync( mActiveFd ) != 0 )
+    {
+        mLogger.error( "SegmentedLog::syncLocked", " Could not sync: " + std::string( strerror( errno ) ) );
+    }
+    TraceModule::get().sectionEnd( TraceSection::PERSISTENCY_FSYNC );
+    mUnsyncedBytes = 0;
+    mLastSyncMs = FastClock::monotonicTimeMs();
+}
+
+void
+SegmentedLog::onWritten( size_t size )
+{
+    TraceModule::get().addToVariable( TraceVariable::PERSISTENCY_BYTES_WRITTEN, size );
+    bool wasSynced = ( mUnsyncedBytes == 0U );
+    mUnsyncedBytes += size;
+    if ( mWriteBatchConfig.fsyncPolicy == FsyncPolicy::PER_BATCH )
+    {
+        syncLocked();
+    }
+    else if ( ( mWriteBatchConfig.fsyncPolicy == FsyncPolicy::INTERVAL ) && wasSynced )
+    {
+        mWait.notify();
+    }
+}
+
+void
+SegmentedLog::onWriteFailed( size_t durableSize )
+{
+    auto &segment = mSegments.back();
+    // Drop the partial write, so the segment only holds complete records
+    if ( ftruncate( mActiveFd, static_cast<off_t>( durableSize ) ) != 0 )
+    {
+        mLogger.error( "SegmentedLog::onWriteFailed", " Could not truncate the segment" );
+    }
+    discardActiveSegment();
+    mTotalSize -= segment.size - durableSize;
+    segment.size = durableSize;
+    if ( segment.size == 0U )
+    {
+        unlink( getSegmentFileName( segment.id ).c_str() );
+        mSegments.pop_back();
+    }
+}
+
+uint32_t
+SegmentedLog::flushDue()
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    auto nowMs = FastClock::monotonicTimeMs();
+    uint32_t waitTimeMs = Signal::WaitWithPredicate;
+    if ( !mPendingRecords.empty() )
+    {
+        auto dueMs = mPendingSinceMs + mWriteBatchConfig.flushIntervalMs;
+        if ( nowMs >= dueMs )
+        {
+            flushLocked();
+        }
+        else
+        {
+            waitTimeMs = static_cast<uint32_t>( dueMs - nowMs );
+        }
+    }
+    if ( ( mWriteBatchConfig.fsyncPolicy == FsyncPolicy::INTERVAL ) && ( mUnsyncedBytes > 0U ) )
+    {
+        auto dueMs = mLastSyncMs + mWriteBatchConfig.fsyncIntervalMs;
+        if ( nowMs >= dueMs )
+        {
+            syncLocked();
+        }
+        else
+        {
+            waitTimeMs = std::min( waitTimeMs, static_cast<uint32_t>( dueMs - nowMs ) );
+        }
+    }
+    return waitTimeMs;
+}
+
+void
+SegmentedLog::doWork( void *data )
+{
+    auto *log = static_cast<SegmentedLog *>( data );
+    while ( !log->mShouldStop )
+    {
+        log->mWait.wait( log->flushDue() );
+    }
+}
+
+ErrorCode
+SegmentedLog::append( const uint8_t *bufPtr, size_t size, const RecordInfo &info )
+{
+    if ( ( bufPtr == nullptr ) || ( size > UINT32_MAX ) )
+    {
+        return ErrorCode::INVALID_DATA;
+    }
+
+    std::lock_guard<std::mutex> lock( mMutex );
+    size_t recordSize = sizeof( RecordHeader ) + size;
+    // Start a new segment once the current one is full, a record is never split across segments
+    if ( ( mActiveFd >= 0 ) && ( ( mSegments.back().size + recordSize ) > mSegmentSize ) )
+    {
+        closeActiveSegment();
+    }
+    if ( mActiveFd < 0 )
+    {
+        Segment segment;
+        segment.id = mNextId;
+        mActiveFd = open( getSegmentFileName( segment.id ).c_str(),
+                          O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC,
+                          S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH );
+        if ( mActiveFd < 0 )
+        {
+            mLogger.error( "SegmentedLog::append", " Could not create segment " + std::to_string( segment.id ) );
+            return ErrorCode::FILESYSTEM_ERROR;
+        }
+        mNextId++;
+        mSegments.push_back( segment );
+    }
+
+    auto &segment = mSegments.back();
+    auto sequence = mNextSequence++;
+    if ( segment.size == 0U )
+    {
+        segment.priority = info.priority;
+        segment.oldestTimestampMs = info.timestampMs;
+        segment.newestTimestampMs = info.timestampMs;
+    }
+    else
+    {
+        segment.priority = std::min( segment.priority, info.priority );
+        segment.oldestTimestampMs = std::min( segment.oldestTimestampMs, info.timestampMs );
+        segment.newestTimestampMs = std::max( segment.newestTimestampMs, info.timestampMs );
+    }
+    // Records as large as a batch are not copied into the buffer
+    if ( ( mWriteBatchConfig.batchSize == 0U ) ||
+         ( mPendingRecords.empty() && ( recordSize >= mWriteBatchConfig.batchSize ) ) )
+    {
+        if ( !writeRecord( mActiveFd, bufPtr, size, sequence ) )
+        {
+            onWriteFailed( segment.size );
+            return ErrorCode::FILESYSTEM_ERROR;
+        }
+        segment.size += recordSize;
+        mTotalSize += recordSize;
+        onWritten( recordSize );
+        return ErrorCode::SUCCESS;
+    }
+
+    if ( mPendingRecords.empty() )
+    {
+        mPendingSinceMs = FastClock::monotonicTimeMs();
+        mWait.notify();
+    }
+    auto header = makeRecordHeader( bufPtr, size, sequence );
+    const auto *headerBytes = reinterpret_cast<const uint8_t *>( &header );
+    mPendingRecords.insert( mPendingRecords.end(), headerBytes, headerBytes + sizeof( header ) );
+    mPendingRecords.insert( mPendingRecords.end(), bufPtr, bufPtr + size );
+    // Counted as soon as buffered, so the partition limit and readers include the buffered records
+    segment.size += recordSize;
+    mTotalSize += recordSize;
+    if ( mPendingRecords.size() >= mWriteBatchConfig.batchSize )
+    {
+        return flushLocked();
+    }
+    return ErrorCode::SUCCESS;
+}
+
+size_t
+SegmentedLog::getSize() const
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    return mTotalSize;
+}
+
+std::vector<SegmentedLog::Segment>
+SegmentedLog::getSegments() const
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    return std::vector<Segment>( mSegments.begin(), mSegments.end() );
+}
+
+ErrorCode
+SegmentedLog::mapSegment( const Segment &segment, const MappedReader &reader )
+{
+    int fd = open( getSegmentFileName( segment.id ).c_str(), O_RDONLY | O_CLOEXEC );
+    if ( fd < 0 )
+    {
+        mLogger.error( "SegmentedLog::mapSegment", " Could not open segment " + std::to_string( segment.id ) );
+        return ErrorCode::FILESYSTEM_ERROR;
+    }
+    // Never map beyond the end of the file, access there would raise SIGBUS
+    struct stat res = {};
+    size_t size = 0;
+    if ( fstat( fd, &res ) == 0 )
+    {
+        size = std::min( segment.size, static_cast<size_t>( res.st_size ) );
+    }
+    if ( size == 0U )
+    {
+        close( fd );
+        return ErrorCode::EMPTY;
+    }
+    void *data = mmap( nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0 );
+    close( fd );
+    if ( data == MAP_FAILED )
+    {
+        mLogger.error( "SegmentedLog::mapSegment", " Could not map segment " + std::to_string( segment.id ) );
+        return ErrorCode::FILESYSTEM_ERROR;
+    }
+    reader( static_cast<const uint8_t *>( data ), size );
+    munmap( data, size );
+    return ErrorCode::SUCCESS;
+}
+
+ErrorCode
+SegmentedLog::parseRecords( uint64_t id, const uint8_t *data, size_t size, size_t pos, const RecordReader &reader )
+{
+    uint64_t nextSequence = 0;
+    while ( pos < size )
+    {
+        const uint8_t *recordData = nullptr;
+        size_t recordSize = 0;
+        uint64_t sequence = 0;
+        if ( !parseRecord( data, size, pos, nextSequence, recordData, recordSize, sequence ) )
+        {
+            mLogger.error( "SegmentedLog::parseRecords",
+                           " Corrupted record at offset " + std::to_string( pos ) + " of segment " +
+                               std::to_string( id ) );
+            return ErrorCode::INVALID_DATA;
+        }
+        nextSequence = sequence + 1U;
+        pos += sizeof( RecordHeader ) + recordSize;
+        if ( !reader( recordData, recordSize, pos ) )
+        {
+            break;
+        }
+    }
+    return ErrorCode::SUCCESS;
+}
+
+ErrorCode
+SegmentedLog::readRecords( uint64_t id, size_t offset, const RecordReader &reader )
+{
+    Segment segment;
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        if ( ( !mSegments.empty() ) && ( id == mSegments.back().id ) )
+        {
+            // Writes the buffered records. Later writes go to a new segment, so this one can be deleted once it is
+            // processed
+            closeActiveSegment();
+        }
+        auto it = std::find_if(
+            mSegments.begin(), mSegments.end(), [id]( const Segment &candidate ) { return candidate.id == id; } );
+        if ( it == mSegments.end() )
+        {
+            return ErrorCode::EMPTY;
+        }
+        segment = *it;
+    }
+    // Mapped without the lock, so writes are not blocked while the reader processes the records
+    ErrorCode recordStatus = ErrorCode::SUCCESS;
+    ErrorCode status = mapSegment(
+        segment, [this, &segment, offset, &reader, &recordStatus]( const uint8_t *data, size_t size ) {
+            recordStatus = parseRecords( segment.id, data, size, std::max( offset, segment.acknowledged ), reader );
+        } );
+    return ( status != ErrorCode::SUCCESS ) ? status : recordStatus;
+}
+
+ErrorCode
+SegmentedLog::rewriteRecords( int fd,
+                              uint64_t id,
+                              const uint8_t *data,
+                              size_t size,
+                              const RecordRewriter &rewriter,
+                              size_t &newSize,
+                              bool &changed )
+{
+    std::vector<uint8_t> out;
+    size_t pos = 0;
+    uint64_t nextSequence = 0;
+    while ( pos < size )
+    {
+        const uint8_t *recordData = nullptr;
+        size_t recordSize = 0;
+        uint64_t sequence = 0;
+        if ( !parseRecord( data, size, pos, nextSequence, recordData, recordSize, sequence ) )
+        {
+            mLogger.error( "SegmentedLog::rewriteSegment",
+                           " Corrupted record at offset " + std::to_string( pos ) + " of segment " +
+                               std::to_string( id ) );
+            return ErrorCode::INVALID_DATA;
+        }
+        nextSequence = sequence + 1U;
+        pos += sizeof( RecordHeader ) + recordSize;
+        out.clear();
+        if ( rewriter( recordData, recordSize, out ) && ( out.size() <= UINT32_MAX ) )
+        {
+            changed = true;
+            recordData = out.data();
+            recordSize = out.size();
+        }
+        if ( !writeRecord( fd, recordData, recordSize, sequence ) )
+        {
+            return ErrorCode::FILESYSTEM_ERROR;
+        }
+        newSize += sizeof( RecordHeader ) + recordSize;
+    }
+    return ErrorCode::SUCCESS;
+}
+
+ErrorCode
+SegmentedLog::rewriteSegment( uint64_t id, const RecordRewriter &rewriter )
+{
+    Segment segment;
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        auto it = std::find_if(
+            mSegments.begin(), mSegments.end(), [id]( const Segment &candidate ) { return candidate.id == id; } );
+        // The acknowledged offset would not match the rewritten records
+        if ( ( it == mSegments.end() ) || ( ( id == mSegments.back().id ) && ( mActiveFd >= 0 ) ) ||
+             ( it->acknowledged > 0U ) )
+        {
+            return ErrorCode::EMPTY;
+        }
+        segment = *it;
+    }
+
+    // Rewritten without the lock, so appends are not blocked while the rewriter processes the records
+    int fd = open( getRewriteFileName( id ).c_str(),
+                   O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                   S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH );
+    if ( fd < 0 )
+    {
+        mLogger.error( "SegmentedLog::rewriteSegment",
+                       " Could not create the new file of segment " + std::to_string( id ) );
+        return ErrorCode::FILESYSTEM_ERROR;
+    }
+    size_t newSize = 0;
+    bool changed = false;
+    ErrorCode recordStatus = ErrorCode::SUCCESS;
+    ErrorCode status = mapSegment(
+        segment, [this, fd, id, &rewriter, &newSize, &changed, &recordStatus]( const uint8_t *data, size_t size ) {
+            recordStatus = rewriteRecords( fd, id, data, size, rewriter, newSize, changed );
+        } );
+    if ( status == ErrorCode::SUCCESS )
+    {
+        status = recordStatus;
+    }
+    // The new records must be on disk before they replace the old ones
+    if ( ( status == ErrorCode::SUCCESS ) && changed && ( fsync( fd ) != 0 ) )
+    {
+        status = ErrorCode::FILESYSTEM_ERROR;
+    }
+    close( fd );
+    if ( ( status != ErrorCode::SUCCESS ) || ( !changed ) )
+    {
+        unlink( getRewriteFileName( id ).c_str() );
+        return status;
+    }
+
+    std::lock_guard<std::mutex> lock( mMutex );
+    auto it = std::find_if(
+        mSegments.begin(), mSegments.end(), [id]( const Segment &candidate ) { return candidate.id == id; } );
+    // Deleted or acknowledged in the meantime
+    if ( ( it == mSegments.end() ) || ( it->acknowledged > 0U ) || ( it->size != segment.size ) )
+    {
+        unlink( getRewriteFileName( id ).c_str() );
+        return ErrorCode::EMPTY;
+    }
+    if ( rename( getRewriteFileName( id ).c_str(), getSegmentFileName( id ).c_str() ) != 0 )
+    {
+        mLogger.error( "SegmentedLog::rewriteSegment", " Could not replace segment " + std::to_string( id ) );
+        unlink( getRewriteFileName( id ).c_str() );
+        return ErrorCode::FILESYSTEM_ERROR;
+    }
+    mTotalSize = mTotalSize - it->size + newSize;
+    it->size = newSize;
+    return ErrorCode::SUCCESS;
+}
+
+ErrorCode
+SegmentedLog::read( uint8_t *const readBufPtr, size_t size )
+{
+    if ( readBufPtr == nullptr )
+    {
+        return ErrorCode::INVALID_DATA;
+    }
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        flushLocked();
+    }
+    size_t pos = 0;
+    for ( const auto &segment : getSegments() )
+    {
+        if ( pos >= size )
+        {
+            break;
+        }
+        // Not through readRecords(), reading everything must not start a new segment
+        auto status = mapSegment( segment, [this, &segment, readBufPtr, size, &pos]( const uint8_t *data,
+                                                                                    size_t dataSize ) {
+            parseRecords( segment.id,
+                          data,
+                          dataSize,
+                          segment.acknowledged,
+                          [readBufPtr, size, &pos]( const uint8_t *recordData, size_t recordSize, size_t ) {
+                              auto copySize = std::min( recordSize, size - pos );
+                              memcpy( readBufPtr + pos, recordData, copySize );
+                              pos += copySize;
+                              return pos < size;
+                          } );
+        } );
+        if ( status == ErrorCode::FILESYSTEM_ERROR )
+        {
+            return status;
+        }
+    }
+    return ( pos == 0U ) ? ErrorCode::EMPTY : ErrorCode::SUCCESS;
+}
+
+ErrorCode
+SegmentedLog::eraseSegmentLocked( std::deque<Segment>::iterator segment )
+{
+    ErrorCode status = ErrorCode::SUCCESS;
+    if ( segment->id == mSegments.back().id )
+    {
+        // Buffered records belong to the deleted segment
+        discardActiveSegment();
+    }
+    if ( ( unlink( getSegmentFileName( segment->id ).c_str() ) != 0 ) && ( errno != ENOENT ) )
+    {
+        mLogger.error( "SegmentedLog::eraseSegment", " Could not delete segment " + std::to_string( segment->id ) );
+        status = ErrorCode::FILESYSTEM_ERROR;
+    }
+    if ( segment->acknowledged > 0U )
+    {
+        unlink( getAcknowledgeFileName( segment->id ).c_str() );
+    }
+    unlink( getIndexFileName( segment->id ).c_str() );
+    // Removed from the index in any case, a file which could not be deleted is found again on the next init
+    mTotalSize -= segment->size - segment->acknowledged;
+    mSegments.erase( segment );
+    return status;
+}
+
+ErrorCode
+SegmentedLog::eraseSegment( uint64_t id )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    auto it = std::find_if(
+        mSegments.begin(), mSegments.end(), [id]( const Segment &candidate ) { return candidate.id == id; } );
+    if ( it == mSegments.end() )
+    {
+        return ErrorCode::EMPTY;
+    }
+    return eraseSegmentLocked( it );
+}
+
+ErrorCode
+SegmentedLog::acknowledge( uint64_t id, size_t offset )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    // The acknowledged records must be on disk, the acknowledgement could be stored before them otherwise
+    flushLocked();
+    auto segment = std::find_if(
+        mSegments.begin(), mSegments.end(), [id]( const Segment &candidate ) { return candidate.id == id; } );
+    if ( segment == mSegments.end() )
+    {
+        return ErrorCode::EMPTY;
+    }
+    if ( offset >= segment->size )
+    {
+        return eraseSegmentLocked( segment );
+    }
+    if ( offset <= segment->acknowledged )
+    {
+        return ErrorCode::SUCCESS;
+    }
+
+    // Stored first, so the acknowledged data is never processed twice after a restart
+    std::ofstream file( getAcknowledgeFileName( id ), std::ios_base::trunc );
+    file << offset;
+    file.close();
+    if ( file.fail() )
+    {
+        mLogger.error( "SegmentedLog::acknowledge",
+                       " Could not store the acknowledgement of segment " + std::to_string( id ) );
+        return ErrorCode::FILESYSTEM_ERROR;
+    }
+    mTotalSize -= offset - segment->acknowledged;
+    segment->acknowledged = offset;
+
+    // Free the disk space of the acknowledged data, the file keeps its size so offsets stay valid
+    int fd = open( getSegmentFileName( id ).c_str(), O_WRONLY | O_CLOEXEC );
+    if ( fd >= 0 )
+    {
+        if ( fallocate( fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>( offset ) ) != 0 )
+        {
+            // Not supported by all file systems, the space is then freed when the segment is deleted
+            mLogger.trace( "SegmentedLog::acknowledge", " Could not free acknowledged data" );
+        }
+        close( fd );
+    }
+    return ErrorCode::SUCCESS;
+}
+
+size_t
+SegmentedLog::evictOldest()
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    if ( mSegments.empty() )
+    {
+        return 0;
+    }
+    size_t size = mSegments.front().size - mSegments.front().acknowledged;
+    eraseSegmentLocked( mSegments.begin() );
+    return size;
+}
+
+ErrorCode
+SegmentedLog::eraseAll()
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    ErrorCode status = ErrorCode::SUCCESS;
+    while ( !mSegments.empty() )
+    {
+        if ( eraseSegmentLocked( mSegments.begin() ) != ErrorCode::SUCCESS )
+        {
+            status = ErrorCode::FILESYSTEM_ERROR;
+        }
+    }
+    return status;
+}
@@ -0,0 +1,119 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "CacheAndPersist.h"
+#include <benchmark/benchmark.h>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace Aws::IoTFleetWise::Platform::Linux::PersistencyManagement;
+
+static constexpr size_t PARTITION_SIZE = 64 * 1024 * 1024;
+
+static std::string
+createDirectory()
+{
+    char path[] = "/tmp/fwe-benchmark-XXXXXX";
+    return ( mkdtemp( path ) != nullptr ) ? std::string( path ) : std::string( "/tmp" );
+}
+
+static std::vector<uint8_t>
+createPayload( size_t size )
+{
+    std::vector<uint8_t> payload( size );
+    for ( size_t i = 0; i < size; i++ )
+    {
+        payload[i] = static_cast<uint8_t>( i * 31 );
+    }
+    return payload;
+}
+
+static void
+BM_writeCollectedData( benchmark::State &state )
+{
+    // Payloads that could not be sent are appended to the segmented log with the default write batching
+    auto payload = createPayload( static_cast<size_t>( state.range( 0 ) ) );
+    CacheAndPersist storage( createDirectory(), PARTITION_SIZE );
+    storage.init();
+    storage.erase( DataType::EDGE_TO_CLOUD_PAYLOAD );
+    for ( auto _ : state )
+    {
+        if ( storage.write( payload.data(), payload.size(), DataType::EDGE_TO_CLOUD_PAYLOAD ) ==
+             ErrorCode::MEMORY_FULL )
+        {
+            state.PauseTiming();
+            storage.erase( DataType::EDGE_TO_CLOUD_PAYLOAD );
+            state.ResumeTiming();
+        }
+    }
+    storage.erase( DataType::EDGE_TO_CLOUD_PAYLOAD );
+    state.SetItemsProcessed( state.iterations() );
+    state.SetBytesProcessed( state.iterations() * state.range( 0 ) );
+}
+BENCHMARK( BM_writeCollectedData )->Arg( 1024 )->Arg( 128 * 1024 );
+
+static void
+BM_readCollectedData( benchmark::State &state )
+{
+    // Reads back 1000 persisted payloads record by record, as done when the connection is back
+    const size_t payloadCount = 1000;
+    auto payload = createPayload( static_cast<size_t>( state.range( 0 ) ) );
+    CacheAndPersist storage( createDirectory(), PARTITION_SIZE );
+    storage.init();
+    storage.erase( DataType::EDGE_TO_CLOUD_PAYLOAD );
+    for ( size_t i = 0; i < payloadCount; i++ )
+    {
+        storage.write( payload.data(), payload.size(), DataType::EDGE_TO_CLOUD_PAYLOAD );
+    }
+    for ( auto _ : state )
+    {
+        size_t bytesRead = 0;
+        for ( const auto &segment : storage.getCollectedDataSegments() )
+        {
+            storage.readCollectedDataRecords(
+                segment.id, 0, [&bytesRead]( const uint8_t *data, size_t size, size_t endOffset ) {
+                    (void)endOffset;
+                    benchmark::DoNotOptimize( data );
+                    bytesRead += size;
+                    return true;
+                } );
+        }
+        benchmark::DoNotOptimize( bytesRead );
+    }
+    storage.erase( DataType::EDGE_TO_CLOUD_PAYLOAD );
+    state.SetItemsProcessed( state.iterations() * static_cast<int64_t>( payloadCount ) );
+    state.SetBytesProcessed( state.iterations() * static_cast<int64_t>( payloadCount ) * state.range( 0 ) );
+}
+BENCHMARK( BM_readCollectedData )->Arg( 1024 );
+
+static void
+BM_writeAndReadCollectionSchemeList( benchmark::State &state )
+{
+    // The collection scheme list is replaced as a whole with every update from the cloud
+    auto payload = createPayload( static_cast<size_t>( state.range( 0 ) ) );
+    std::vector<uint8_t> readBuffer( payload.size() );
+    CacheAndPersist storage( createDirectory(), PARTITION_SIZE );
+    storage.init();
+    for ( auto _ : state )
+    {
+        storage.write( payload.data(), payload.size(), DataType::COLLECTION_SCHEME_LIST );
+        storage.read( readBuffer.data(), readBuffer.size(), DataType::COLLECTION_SCHEME_LIST );
+        benchmark::DoNotOptimize( readBuffer.data() );
+    }
+    storage.erase( DataType::COLLECTION_SCHEME_LIST );
+    state.SetBytesProcessed( state.iterations() * state.range( 0 ) * 2 );
+}
+BENCHMARK( BM_writeAndReadCollectionSchemeList )->Arg( 64 * 1024 );
+
+BENCHMARK_MAIN();
@@ -282,9 +282,62 @@ TEST( CacheAndPersistTest, testMultipleEventDataPersistency )
 
         // Verify if the size of the data written is same as size of the data read back
         // contents of the file need parsing and are being tested at a higher level test file
-        ASSERT_EQ( readSize, size1 + size2 );
+        // Each write is stored as a record with a header
+        ASSERT_EQ( readSize, size1 + size2 + 2 * SegmentedLog::RECORD_HEADER_SIZE );
 
         ASSERT_EQ( storage.erase( DataType::EDGE_TO_CLOUD_PAYLOAD ), ErrorCode::SUCCESS );
         ASSERT_EQ( storage.getSize( DataType::EDGE_TO_CLOUD_PAYLOAD ), 0 );
     }
-}
\ No newline at end of file
+}
+
+// Test that the oldest collected data is dropped when the partition is full
+TEST( CacheAndPersistTest, testCollectedDataEviction )
+{
+    char buffer[PATH_MAX];
+    if ( getcwd( buffer, sizeof( buffer ) ) != NULL )
+    {
+        // Every write in its own segment, space for three of them
+        const size_t recordSize = 30 + SegmentedLog::RECORD_HEADER_SIZE;
+        CacheAndPersist storage( std::string( buffer ), 4 * recordSize, recordSize );
+
+        ASSERT_TRUE( storage.init() );
+        ASSERT_EQ( storage.erase( DataType::COLLECTION_SCHEME_LIST ), ErrorCode::SUCCESS );
+        ASSERT_EQ( storage.erase( DataType::DECODER_MANIFEST ), ErrorCode::SUCCESS );
+        ASSERT_EQ( storage.erase( DataType::EDGE_TO_CLOUD_PAYLOAD ), ErrorCode::SUCCESS );
+
+        for ( char c = 'a'; c <= 'd'; c++ )
+        {
+            std::string data( 30, c );
+            ASSERT_EQ(
+                storage.write(
+                    reinterpret_cast<const uint8_t *>( data.c_str() ), data.size(), DataType::EDGE_TO_CLOUD_PAYLOAD ),
+                ErrorCode::SUCCESS );
+        }
+        // The first segment was evicted to make space for the last one
+        auto segments = storage.getCollectedDataSegments();
+        ASSERT_EQ( segments.size(), 3 );
+        ASSERT_EQ( storage.getSize( DataType::EDGE_TO_CLOUD_PAYLOAD ), 3 * recordSize );
+        std::string oldest;
+        ASSERT_EQ( storage.readCollectedDataRecords( segments[0].id,
+                                                     0,
+                                                     [&oldest]( const uint8_t *data, size_t size, size_t ) {
+                                                         oldest.assign( reinterpret_cast<const char *>( data ), size );
+                                                         return true;
+                                                     } ),
+                   ErrorCode::SUCCESS );
+        ASSERT_EQ( oldest, std::string( 30, 'b' ) );
+
+        // Data which can never fit is rejected
+        std::string tooLarge( 4 * recordSize, 'x' );
+        ASSERT_EQ( storage.write( reinterpret_cast<const uint8_t *>( tooLarge.c_str() ),
+                                  tooLarge.size(),
+                                  DataType::EDGE_TO_CLOUD_PAYLOAD ),
+                   ErrorCode::MEMORY_FULL );
+
+        // Deleting an uploaded segment keeps the others
+        ASSERT_EQ( storage.eraseCollectedDataSegment( segments[0].id ), ErrorCode::SUCCESS );
+        ASSERT_EQ( storage.getSize( DataType::EDGE_TO_CLOUD_PAYLOAD ), 2 * recordSize );
+        ASSERT_EQ( storage.erase( DataType::EDGE_TO_CLOUD_PAYLOAD ), ErrorCode::SUCCESS );
+        ASSERT_EQ( storage.getSize( DataType::EDGE_TO_CLOUD_PAYLOAD ), 0 );
+    }
+}
@@ -0,0 +1,407 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "SegmentedLog.h"
+#include "TraceModule.h"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+using namespace Aws::IoTFleetWise::Platform::Linux;
+using namespace Aws::IoTFleetWise::Platform::Linux::PersistencyManagement;
+
+class SegmentedLogTest : public ::testing::Test
+{
+protected:
+    void
+    SetUp() override
+    {
+        char directory[] = "/tmp/SegmentedLogTestXXXXXX";
+        ASSERT_NE( mkdtemp( directory ), nullptr );
+        mDirectory = directory;
+    }
+
+    void
+    TearDown() override
+    {
+        SegmentedLog log( mDirectory, "Data" );
+        log.init();
+        log.eraseAll();
+        rmdir( mDirectory.c_str() );
+    }
+
+    static ErrorCode
+    append( SegmentedLog &log, const std::string &data )
+    {
+        return log.append( reinterpret_cast<const uint8_t *>( data.c_str() ), data.size() );
+    }
+
+    static std::string
+    readAll( SegmentedLog &log )
+    {
+        // The size includes the record headers
+        std::string out( log.getSize(), '\0' );
+        if ( log.read( reinterpret_cast<uint8_t *>( &out[0] ), out.size() ) != ErrorCode::SUCCESS )
+        {
+            return "";
+        }
+        return out.substr( 0, out.find( '\0' ) );
+    }
+
+    static std::vector<std::string>
+    readRecords( SegmentedLog &log, uint64_t id, ErrorCode expectedStatus = ErrorCode::SUCCESS )
+    {
+        std::vector<std::string> records;
+        EXPECT_EQ( log.readRecords( id,
+                                    0,
+                                    [&records]( const uint8_t *data, size_t size, size_t ) {
+                                        records.emplace_back( reinterpret_cast<const char *>( data ), size );
+                                        return true;
+                                    } ),
+                   expectedStatus );
+        return records;
+    }
+
+    std::string
+    getSegmentFileName( uint64_t id ) const
+    {
+        return mDirectory + "/Data." + std::to_string( id ) + ".seg";
+    }
+
+    size_t
+    getSegmentFileSize( uint64_t id ) const
+    {
+        struct stat res = {};
+        if ( stat( getSegmentFileName( id ).c_str(), &res ) != 0 )
+        {
+            return 0;
+        }
+        return static_cast<size_t>( res.st_size );
+    }
+
+    std::string mDirectory;
+};
+
+TEST_F( SegmentedLogTest, AppendStartsNewSegmentWhenFull )
+{
+    const size_t header = SegmentedLog::RECORD_HEADER_SIZE;
+    SegmentedLog log( mDirectory, "Data", 2 * header + 10 );
+    ASSERT_TRUE( log.init() );
+    ASSERT_EQ( log.getSize(), 0 );
+    ASSERT_EQ( log.getSegments().size(), 0 );
+
+    ASSERT_EQ( append( log, "aaaaaa" ), ErrorCode::SUCCESS );
+    ASSERT_EQ( append( log, "bbbb" ), ErrorCode::SUCCESS );
+    // Does not fit anymore, a record is never split
+    ASSERT_EQ( append( log, "cc" ), ErrorCode::SUCCESS );
+    // Larger than a segment
+    std::string large( 2 * header + 20, 'd' );
+    ASSERT_EQ( append( log, large ), ErrorCode::SUCCESS );
+
+    auto segments = log.getSegments();
+    ASSERT_EQ( segments.size(), 3 );
+    ASSERT_EQ( segments[0].size, 2 * header + 10 );
+    ASSERT_EQ( segments[1].size, header + 2 );
+    ASSERT_EQ( segments[2].size, header + large.size() );
+    ASSERT_EQ( log.getSize(), 4 * header + 12 + large.size() );
+    ASSERT_EQ( readAll( log ), "aaaaaabbbbcc" + large );
+    ASSERT_EQ( readRecords( log, segments[0].id ), std::vector<std::string>( { "aaaaaa", "bbbb" } ) );
+    ASSERT_EQ( log.append( nullptr, 1 ), ErrorCode::INVALID_DATA );
+}
+
+TEST_F( SegmentedLogTest, PartialDrainDeletesOnlyReadSegments )
+{
+    SegmentedLog log( mDirectory, "Data", 1000 );
+    ASSERT_TRUE( log.init() );
+    ASSERT_EQ( append( log, "first" ), ErrorCode::SUCCESS );
+    ASSERT_EQ( append( log, "second" ), ErrorCode::SUCCESS );
+
+    auto segments = log.getSegments();
+    ASSERT_EQ( segments.size(), 1 );
+    ASSERT_EQ( readRecords( log, segments[0].id ), std::vector<std::string>( { "first", "second" } ) );
+
+    // Written while the read segment is uploaded, goes to a new segment
+    ASSERT_EQ( append( log, "third" ), ErrorCode::SUCCESS );
+    ASSERT_EQ( log.getSegments().size(), 2 );
+
+    ASSERT_EQ( log.eraseSegment( segments[0].id ), ErrorCode::SUCCESS );
+    ASSERT_EQ( log.eraseSegment( segments[0].id ), ErrorCode::EMPTY );
+    ASSERT_EQ( log.getSize(), SegmentedLog::RECORD_HEADER_SIZE + 5 );
+    ASSERT_EQ( readAll( log ), "third" );
+    ASSERT_TRUE( readRecords( log, segments[0].id, ErrorCode::EMPTY ).empty() );
+}
+
+TEST_F( SegmentedLogTest, AcknowledgedDataIsNotReadAgain )
+{
+    const size_t header = SegmentedLog::RECORD_HEADER_SIZE;
+    uint64_t id = 0;
+    {
+        SegmentedLog log( mDirectory, "Data", 1000 );
+        ASSERT_TRUE( log.init() );
+        ASSERT_EQ( append( log, "aaaa" ), ErrorCode::SUCCESS );
+        ASSERT_EQ( append( log, "bbbb" ), ErrorCode::SUCCESS );
+        id = log.getSegments()[0].id;
+
+        ASSERT_EQ( log.acknowledge( id, header + 4 ), ErrorCode::SUCCESS );
+        ASSERT_EQ( log.getSize(), header + 4 );
+        ASSERT_EQ( readAll( log ), "bbbb" );
+        ASSERT_EQ( log.acknowledge( id + 1U, 4 ), ErrorCode::EMPTY );
+    }
+
+    // The acknowledgement survives a restart
+    SegmentedLog log( mDirectory, "Data", 1000 );
+    ASSERT_TRUE( log.init() );
+    auto segments = log.getSegments();
+    ASSERT_EQ( segments.size(), 1 );
+    ASSERT_EQ( segments[0].acknowledged, header + 4 );
+    ASSERT_EQ( readAll( log ), "bbbb" );
+    ASSERT_EQ( readRecords( log, id ), std::vector<std::string>( { "bbbb" } ) );
+
+    // Acknowledged up to the end, the segment is deleted
+    ASSERT_EQ( log.acknowledge( id, 2 * ( header + 4 ) ), ErrorCode::SUCCESS );
+    ASSERT_EQ( log.getSegments().size(), 0 );
+    ASSERT_EQ( log.getSize(), 0 );
+    ASSERT_NE( access( ( mDirectory + "/Data." + std::to_string( id ) + ".ack" ).c_str(), F_OK ), 0 );
+}
+
+TEST_F( SegmentedLogTest, EvictOldestFirst )
+{
+    const size_t recordSize = SegmentedLog::RECORD_HEADER_SIZE + 4;
+    SegmentedLog log( mDirectory, "Data", recordSize );
+    ASSERT_TRUE( log.init() );
+    ASSERT_EQ( append( log, "1111" ), ErrorCode::SUCCESS );
+    ASSERT_EQ( append( log, "2222" ), ErrorCode::SUCCESS );
+    ASSERT_EQ( append( log, "3333" ), ErrorCode::SUCCESS );
+
+    ASSERT_EQ( log.evictOldest(), recordSize );
+    ASSERT_EQ( readAll( log ), "22223333" );
+    ASSERT_EQ( log.eraseAll(), ErrorCode::SUCCESS );
+    ASSERT_EQ( log.evictOldest(), 0 );
+    ASSERT_EQ( log.getSize(), 0 );
+    uint8_t buffer[1];
+    ASSERT_EQ( log.read( buffer, sizeof( buffer ) ), ErrorCode::EMPTY );
+}
+
+TEST_F( SegmentedLogTest, InitRestoresSegmentsAndTakesOverLegacyFile )
+{
+    const size_t recordSize = SegmentedLog::RECORD_HEADER_SIZE + 4;
+    {
+        SegmentedLog log( mDirectory, "Data", recordSize );
+        ASSERT_TRUE( log.init() );
+        ASSERT_EQ( append( log, "new1" ), ErrorCode::SUCCESS );
+        ASSERT_EQ( append( log, "new2" ), ErrorCode::SUCCESS );
+    }
+    std::string legacyFile = mDirectory + "/Legacy.bin";
+    {
+        std::ofstream legacy( legacyFile, std::ios_base::binary );
+        legacy << "old";
+    }
+
+    SegmentedLog log( mDirectory, "Data", recordSize );
+    ASSERT_TRUE( log.init( legacyFile ) );
+    ASSERT_EQ( log.getSegments().size(), 3 );
+    // The data of the legacy file is the oldest
+    ASSERT_EQ( readAll( log ), "oldnew1new2" );
+    ASSERT_NE( access( legacyFile.c_str(), F_OK ), 0 );
+
+    // New data is appended after the restored segments
+    ASSERT_EQ( append( log, "new3" ), ErrorCode::SUCCESS );
+    ASSERT_EQ( readAll( log ), "oldnew1new2new3" );
+}
+
+TEST_F( SegmentedLogTest, IndexIsRestoredOnInit )
+{
+    const size_t recordSize = SegmentedLog::RECORD_HEADER_SIZE + 4;
+    uint64_t firstId = 0;
+    {
+        SegmentedLog log( mDirectory, "Data", 2 * recordSize );
+        ASSERT_TRUE( log.init() );
+        ASSERT_EQ( log.append( reinterpret_cast<const uint8_t *>( "rec1" ), 4, { 5, 2000 } ), ErrorCode::SUCCESS );
+        ASSERT_EQ( log.append( reinterpret_cast<const uint8_t *>( "rec2" ), 4, { 2, 1000 } ), ErrorCode::SUCCESS );
+        ASSERT_EQ( log.append( reinterpret_cast<const uint8_t *>( "rec3" ), 4, { 7, 3000 } ), ErrorCode::SUCCESS );
+        firstId = log.getSegments().front().id;
+    }
+
+    SegmentedLog log( mDirectory, "Data", 2 * recordSize );
+    ASSERT_TRUE( log.init() );
+    auto segments = log.getSegments();
+    ASSERT_EQ( segments.size(), 2 );
+    // The segment has the most important priority and the time range of its records
+    ASSERT_EQ( segments[0].priority, 2 );
+    ASSERT_EQ( segments[0].oldestTimestampMs, 1000 );
+    ASSERT_EQ( segments[0].newestTimestampMs, 2000 );
+    ASSERT_EQ( segments[1].priority, 7 );
+    ASSERT_EQ( segments[1].oldestTimestampMs, 3000 );
+
+    // The index is deleted with its segment
+    std::string indexFile = mDirectory + "/Data." + std::to_string( firstId ) + ".idx";
+    ASSERT_EQ( access( indexFile.c_str(), F_OK ), 0 );
+    ASSERT_EQ( log.acknowledge( firstId, segments[0].size ), ErrorCode::SUCCESS );
+    ASSERT_NE( access( indexFile.c_str(), F_OK ), 0 );
+}
+
+TEST_F( SegmentedLogTest, RewriteSegmentReplacesRecords )
+{
+    const size_t header = SegmentedLog::RECORD_HEADER_SIZE;
+    auto shorten = []( const uint8_t *data, size_t size, std::vector<uint8_t> &out ) {
+        if ( ( size < 2 ) || ( data[0] == 'x' ) )
+        {
+            return false;
+        }
+        out.assign( data, data + 1 );
+        return true;
+    };
+    uint64_t id = 0;
+    {
+        SegmentedLog log( mDirectory, "Data", 2 * header + 8 );
+        ASSERT_TRUE( log.init() );
+        ASSERT_EQ( append( log, "aaaa" ), ErrorCode::SUCCESS );
+        ASSERT_EQ( append( log, "xxxx" ), ErrorCode::SUCCESS );
+        id = log.getSegments()[0].id;
+        // Still written to
+        ASSERT_EQ( log.rewriteSegment( id, shorten ), ErrorCode::EMPTY );
+        ASSERT_EQ( append( log, "bbbb" ), ErrorCode::SUCCESS );
+        ASSERT_EQ( log.getSegments().size(), 2 );
+
+        ASSERT_EQ( log.rewriteSegment( id, shorten ), ErrorCode::SUCCESS );
+        ASSERT_EQ( log.getSegments()[0].size, 2 * header + 5 );
+        ASSERT_EQ( getSegmentFileSize( id ), 2 * header + 5 );
+        ASSERT_EQ( log.getSize(), 3 * header + 9 );
+        ASSERT_EQ( readRecords( log, id ), std::vector<std::string>( { "a", "xxxx" } ) );
+        ASSERT_NE( access( ( mDirectory + "/Data." + std::to_string( id ) + ".new" ).c_str(), F_OK ), 0 );
+        ASSERT_EQ( log.rewriteSegment( id + 5U, shorten ), ErrorCode::EMPTY );
+
+        ASSERT_EQ( log.acknowledge( id, header + 1 ), ErrorCode::SUCCESS );
+        ASSERT_EQ( log.rewriteSegment( id, shorten ), ErrorCode::EMPTY );
+    }
+
+    // The rewritten segment survives a restart
+    SegmentedLog log( mDirectory, "Data", 2 * header + 8 );
+    ASSERT_TRUE( log.init() );
+    ASSERT_EQ( readAll( log ), "xxxxbbbb" );
+}
+
+TEST_F( SegmentedLogTest, RecoveryTruncatesTornWrite )
+{
+    const size_t header = SegmentedLog::RECORD_HEADER_SIZE;
+    uint64_t id = 0;
+    {
+        SegmentedLog log( mDirectory, "Data", 1000 );
+        ASSERT_TRUE( log.init() );
+        ASSERT_EQ( append( log, "good1" ), ErrorCode::SUCCESS );
+        ASSERT_EQ( append( log, "good2" ), ErrorCode::SUCCESS );
+        id = log.getSegments()[0].id;
+    }
+    // A power loss while writing the third record leaves only a part of it
+    {
+        std::ifstream segment( getSegmentFileName( id ), std::ios_base::binary );
+        std::string record( header + 5, '\0' );
+        segment.read( &record[0], static_cast<std::streamsize>( record.size() ) );
+        std::ofstream torn( getSegmentFileName( id ), std::ios_base::binary | std::ios_base::app );
+        torn.write( record.data(), static_cast<std::streamsize>( header - 3 ) );
+    }
+
+    SegmentedLog log( mDirectory, "Data", 1000 );
+    ASSERT_TRUE( log.init() );
+    auto segments = log.getSegments();
+    ASSERT_EQ( segments.size(), 1 );
+    ASSERT_EQ( segments[0].size, 2 * ( header + 5 ) );
+    ASSERT_EQ( readRecords( log, id ), std::vector<std::string>( { "good1", "good2" } ) );
+
+    // The sequence numbers continue behind the recovered records
+    ASSERT_EQ( append( log, "good3" ), ErrorCode::SUCCESS );
+    ASSERT_EQ( readAll( log ), "good1good2good3" );
+}
+
+TEST_F( SegmentedLogTest, CorruptedRecordIsDetected )
+{
+    const size_t header = SegmentedLog::RECORD_HEADER_SIZE;
+    SegmentedLog log( mDirectory, "Data", 1000 );
+    ASSERT_TRUE( log.init() );
+    ASSERT_EQ( append( log, "aaaa" ), ErrorCode::SUCCESS );
+    ASSERT_EQ( append( log, "bbbb" ), ErrorCode::SUCCESS );
+    ASSERT_EQ( append( log, "cccc" ), ErrorCode::SUCCESS );
+    auto id = log.getSegments()[0].id;
+
+    // Flip a bit in the data of the second record
+    {
+        std::fstream segment( getSegmentFileName( id ), std::ios_base::binary | std::ios_base::in | std::ios_base::out );
+        segment.seekp( static_cast<std::streamoff>( 2 * header + 4 + 1 ) );
+        segment.put( 'B' );
+    }
+    // The records before it are still read
+    ASSERT_EQ( readRecords( log, id, ErrorCode::INVALID_DATA ), std::vector<std::string>( { "aaaa" } ) );
+}
+
+TEST_F( SegmentedLogTest, BatchedAppendsAreWrittenTogether )
+{
+    const size_t recordSize = SegmentedLog::RECORD_HEADER_SIZE + 4;
+    SegmentedLog::WriteBatchConfig batchConfig;
+    batchConfig.batchSize = 3 * recordSize;
+    batchConfig.flushIntervalMs = 100000;
+    batchConfig.fsyncPolicy = SegmentedLog::FsyncPolicy::PER_BATCH;
+    auto bytesWritten = TraceModule::get().getVariableMax( TraceVariable::PERSISTENCY_BYTES_WRITTEN );
+    uint64_t id = 0;
+    {
+        SegmentedLog log( mDirectory, "Data", 1000, batchConfig );
+        ASSERT_TRUE( log.init() );
+        ASSERT_EQ( append( log, "aaaa" ), ErrorCode::SUCCESS );
+        ASSERT_EQ( append( log, "bbbb" ), ErrorCode::SUCCESS );
+        id = log.getSegments()[0].id;
+        // Buffered, but already counted
+        ASSERT_EQ( getSegmentFileSize( id ), 0 );
+        ASSERT_EQ( log.getSize(), 2 * recordSize );
+
+        // Completes the batch
+        ASSERT_EQ( append( log, "cccc" ), ErrorCode::SUCCESS );
+        ASSERT_EQ( getSegmentFileSize( id ), 3 * recordSize );
+        ASSERT_EQ( TraceModule::get().getVariableMax( TraceVariable::PERSISTENCY_BYTES_WRITTEN ),
+                   bytesWritten + 3 * recordSize );
+
+        // Reading writes the buffered records first
+        ASSERT_EQ( append( log, "dddd" ), ErrorCode::SUCCESS );
+        ASSERT_EQ( readAll( log ), "aaaabbbbccccdddd" );
+        ASSERT_EQ( getSegmentFileSize( id ), 4 * recordSize );
+
+        // Written when the log is destroyed
+        ASSERT_EQ( append( log, "eeee" ), ErrorCode::SUCCESS );
+        ASSERT_EQ( getSegmentFileSize( id ), 4 * recordSize );
+    }
+
+    SegmentedLog log( mDirectory, "Data", 1000, batchConfig );
+    ASSERT_TRUE( log.init() );
+    ASSERT_EQ( readAll( log ), "aaaabbbbccccddddeeee" );
+}
+
+TEST_F( SegmentedLogTest, BufferedRecordsAreWrittenAfterInterval )
+{
+    SegmentedLog::WriteBatchConfig batchConfig;
+    batchConfig.batchSize = 1000;
+    batchConfig.flushIntervalMs = 10;
+    batchConfig.fsyncPolicy = SegmentedLog::FsyncPolicy::INTERVAL;
+    batchConfig.fsyncIntervalMs = 10;
+    SegmentedLog log( mDirectory, "Data", 1000, batchConfig );
+    ASSERT_TRUE( log.init() );
+    ASSERT_EQ( append( log, "aaaa" ), ErrorCode::SUCCESS );
+    auto id = log.getSegments()[0].id;
+
+    for ( int i = 0; ( i < 100 ) && ( getSegmentFileSize( id ) == 0U ); i++ )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+    }
+    ASSERT_EQ( getSegmentFileSize( id ), SegmentedLog::RECORD_HEADER_SIZE + 4 );
+}
@@ -0,0 +1,71 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+#if defined( IOTFLEETWISE_LINUX )
+// Includes
+#include <cstddef>
+#include <cstdint>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace Platform
+{
+namespace Linux
+{
+
+/**
+ * @brief Counts the heap allocations per thread, so that it can be verified that the data plane does not allocate
+ * once it is warmed up.
+ *
+ * With FWE_ALLOCATION_COUNTING the global operator new is replaced by one that counts every allocation of the
+ * calling thread. The counters are kept in a fixed table of MAX_THREADS slots, which the threads claim on their first
+ * allocation and free when they exit, so counting neither allocates nor takes a lock. Threads beyond MAX_THREADS are
+ * not counted. Other threads read the counters by thread ID, see ThreadTelemetrySampler.
+ */
+class AllocationCounter
+{
+public:
+    static constexpr size_t MAX_THREADS = 512;
+
+    /**
+     * @brief Returns true if the build counts allocations, i.e. was built with FWE_ALLOCATION_COUNTING
+     */
+    static bool isEnabled();
+
+    /**
+     * @brief Counts one allocation of the calling thread, called by the operator new hooks
+     */
+    static void countAllocation();
+
+    /**
+     * @brief Returns the number of allocations of a thread since it started. Can be called from any thread.
+     * @param threadId the thread ID as in /proc/self/task
+     * @return 0 if the thread did not allocate yet or is not counted
+     */
+    static uint64_t getAllocations( uint64_t threadId );
+
+    /**
+     * @brief Returns the number of allocations of the calling thread since it started
+     */
+    static uint64_t getCurrentThreadAllocations();
+};
+
+} // namespace Linux
+} // namespace Platform
+} // namespace IoTFleetWise
+} // namespace Aws
+#endif // IOTFLEETWISE_LINUX
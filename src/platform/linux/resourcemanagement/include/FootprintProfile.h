@@ -0,0 +1,77 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include <cstddef>
+#include <cstdint>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace Platform
+{
+namespace Linux
+{
+
+/**
+ * @brief Compile-time limits for low-end control units with about 32 MiB of RAM
+ */
+struct SmallFootprintProfile
+{
+    static constexpr uint32_t MAX_NUMBER_OF_ACTIVE_CONDITION = 256;
+    static constexpr uint32_t MAX_DIFFERENT_SIGNAL_IDS = 5000;
+    static constexpr int PARALLEL_RECEIVED_FRAMES_FROM_KERNEL = 4;
+    static constexpr size_t DEFAULT_SAMPLE_MEMORY_BUDGET = 2 * 1024 * 1024;
+};
+
+/**
+ * @brief Compile-time limits of the default build
+ */
+struct DefaultFootprintProfile
+{
+    static constexpr uint32_t MAX_NUMBER_OF_ACTIVE_CONDITION = 4096;
+    static constexpr uint32_t MAX_DIFFERENT_SIGNAL_IDS = 50000;
+    static constexpr int PARALLEL_RECEIVED_FRAMES_FROM_KERNEL = 10;
+    static constexpr size_t DEFAULT_SAMPLE_MEMORY_BUDGET = 20 * 1024 * 1024;
+};
+
+/**
+ * @brief Compile-time limits for central compute units with gigabytes of RAM and many buses
+ */
+struct LargeFootprintProfile
+{
+    static constexpr uint32_t MAX_NUMBER_OF_ACTIVE_CONDITION = 16384;
+    static constexpr uint32_t MAX_DIFFERENT_SIGNAL_IDS = 200000;
+    static constexpr int PARALLEL_RECEIVED_FRAMES_FROM_KERNEL = 64;
+    static constexpr size_t DEFAULT_SAMPLE_MEMORY_BUDGET = 256 * 1024 * 1024;
+};
+
+/**
+ * @brief The profile of this build, selected with the CMake option FWE_FOOTPRINT_PROFILE. The limits of the modules
+ * are defined from it, so they stay compile-time constants.
+ */
+#if defined( FWE_FOOTPRINT_PROFILE_SMALL )
+using FootprintProfile = SmallFootprintProfile;
+#elif defined( FWE_FOOTPRINT_PROFILE_LARGE )
+using FootprintProfile = LargeFootprintProfile;
+#else
+using FootprintProfile = DefaultFootprintProfile;
+#endif
+
+} // namespace Linux
+} // namespace Platform
+} // namespace IoTFleetWise
+} // namespace Aws
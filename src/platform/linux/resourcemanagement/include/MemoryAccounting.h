@@ -0,0 +1,195 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+#if defined( IOTFLEETWISE_LINUX )
+// Includes
+#include "TraceModule.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace Platform
+{
+namespace Linux
+{
+
+/**
+ * @brief The parts of the agent whose memory is accounted separately
+ */
+enum class MemorySubsystem : uint8_t
+{
+    DECODING = 0, // Buffers of the vehicle data sources and the queues of decoded data
+    INSPECTION,   // History buffers of the inspection engine
+    COLLECTION,   // Serialization of the collected data
+    PERSISTENCY,  // Records waiting to be written to flash
+    CONNECTIVITY, // Allocations of the AWS SDK
+    SUBSYSTEM_COUNT
+};
+
+/**
+ * @brief Accounts the bytes and the number of allocations per MemorySubsystem, so that the growth of the resident
+ * memory can be attributed.
+ *
+ * The allocators of the big containers of a subsystem report to it, see TrackedAllocator and ArenaAllocator. The
+ * current values are kept in TraceAtomicVariables, so they are printed and forwarded to the metrics receiver like all
+ * other trace variables, and their maximum is the peak since the start. A subsystem can have a ceiling. Allocations
+ * never fail because of a ceiling, but every time the used bytes rise above it MEMORY_CEILING_EXCEEDED is incremented
+ * and the subsystem can check isOverCeiling before it grows further.
+ */
+class MemoryAccounting
+{
+public:
+    static inline void
+    onAllocate( MemorySubsystem subsystem, size_t bytes )
+    {
+        auto index = static_cast<size_t>( subsystem );
+        auto &traceModule = TraceModule::get();
+        traceModule.addToAtomicVariable( getBytesVariable( subsystem ), bytes );
+        traceModule.incrementAtomicVariable( getAllocationsVariable( subsystem ) );
+        auto ceiling = getCeilings()[index].load( std::memory_order_relaxed );
+        if ( ceiling > 0 )
+        {
+            auto usedBytes = traceModule.getAtomicVariable( getBytesVariable( subsystem ) );
+            if ( ( usedBytes > ceiling ) && ( usedBytes - bytes <= ceiling ) )
+            {
+                traceModule.incrementAtomicVariable( TraceAtomicVariable::MEMORY_CEILING_EXCEEDED );
+            }
+        }
+    }
+
+    static inline void
+    onDeallocate( MemorySubsystem subsystem, size_t bytes )
+    {
+        auto &traceModule = TraceModule::get();
+        traceModule.subtractFromAtomicVariable( getBytesVariable( subsystem ), bytes );
+        traceModule.decrementAtomicVariable( getAllocationsVariable( subsystem ) );
+    }
+
+    /**
+     * @brief Bytes currently allocated by the subsystem
+     */
+    static uint64_t getUsedBytes( MemorySubsystem subsystem );
+
+    /**
+     * @brief Number of allocations of the subsystem that were not freed yet
+     */
+    static uint64_t getAllocationCount( MemorySubsystem subsystem );
+
+    /**
+     * @brief Sets the ceiling of a subsystem. Can be called from any thread.
+     * @param subsystem the subsystem
+     * @param bytes the ceiling in bytes, 0 for no ceiling
+     */
+    static void setCeiling( MemorySubsystem subsystem, size_t bytes );
+
+    static size_t getCeiling( MemorySubsystem subsystem );
+
+    /**
+     * @brief Returns true if the subsystem has a ceiling and uses more bytes than it
+     */
+    static bool isOverCeiling( MemorySubsystem subsystem );
+
+    /**
+     * @brief Returns the lower case name of the subsystem as used in the configuration, for example "decoding"
+     */
+    static const char *getName( MemorySubsystem subsystem );
+
+    /**
+     * @brief Finds the subsystem of a name returned by getName
+     * @return False if there is no subsystem with the name
+     */
+    static bool getSubsystem( const std::string &name, MemorySubsystem &subsystem );
+
+private:
+    static inline TraceAtomicVariable
+    getBytesVariable( MemorySubsystem subsystem )
+    {
+        return static_cast<TraceAtomicVariable>( toUType( TraceAtomicVariable::MEMORY_DECODING_BYTES ) +
+                                                 ( static_cast<size_t>( subsystem ) * 2 ) );
+    }
+
+    static inline TraceAtomicVariable
+    getAllocationsVariable( MemorySubsystem subsystem )
+    {
+        return static_cast<TraceAtomicVariable>( toUType( getBytesVariable( subsystem ) ) + 1 );
+    }
+
+    static std::array<std::atomic<size_t>, static_cast<size_t>( MemorySubsystem::SUBSYSTEM_COUNT )> &getCeilings();
+};
+
+/**
+ * @brief STL allocator that allocates from the heap and accounts the memory to a MemorySubsystem.
+ */
+template <typename T, MemorySubsystem SUBSYSTEM>
+class TrackedAllocator
+{
+public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind
+    {
+        using other = TrackedAllocator<U, SUBSYSTEM>;
+    };
+
+    TrackedAllocator() = default;
+    template <typename U>
+    TrackedAllocator( const TrackedAllocator<U, SUBSYSTEM> & ) // NOLINT(google-explicit-constructor)
+    {
+    }
+
+    T *
+    allocate( size_t count )
+    {
+        auto bytes = count * sizeof( T );
+        auto *pointer = ::operator new( bytes );
+        MemoryAccounting::onAllocate( SUBSYSTEM, bytes );
+        return static_cast<T *>( pointer );
+    }
+
+    void
+    deallocate( T *pointer, size_t count )
+    {
+        MemoryAccounting::onDeallocate( SUBSYSTEM, count * sizeof( T ) );
+        ::operator delete( pointer );
+    }
+};
+
+template <typename T, typename U, MemorySubsystem SUBSYSTEM>
+inline bool
+operator==( const TrackedAllocator<T, SUBSYSTEM> &, const TrackedAllocator<U, SUBSYSTEM> & )
+{
+    return true;
+}
+
+template <typename T, typename U, MemorySubsystem SUBSYSTEM>
+inline bool
+operator!=( const TrackedAllocator<T, SUBSYSTEM> &, const TrackedAllocator<U, SUBSYSTEM> & )
+{
+    return false;
+}
+
+} // namespace Linux
+} // namespace Platform
+} // namespace IoTFleetWise
+} // namespace Aws
+#endif // IOTFLEETWISE_LINUX
@@ -0,0 +1,229 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+#if defined( IOTFLEETWISE_LINUX )
+// Includes
+#include "LoggingModule.h"
+#include "MemoryAccounting.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <new>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace Platform
+{
+namespace Linux
+{
+
+/**
+ * @brief One memory region reserved at startup for the large and long-lived structures of the data pipeline:
+ * the queues between the threads and the history buffers of the inspection.
+ *
+ * Allocating them from one region backed by huge pages needs a few TLB entries instead of one per 4 KiB page. The
+ * region can also be locked, so that no page fault happens once the pipeline runs. If no region was reserved or the
+ * region is full, allocate returns nullptr and the caller uses the heap instead, so a too small arena only loses the
+ * benefit and never fails an allocation.
+ */
+class MemoryArena
+{
+public:
+    // Every allocation starts on a cache line, which covers the alignment of all types stored in the arena
+    static constexpr size_t ALIGNMENT = 64;
+    // The region is rounded up to whole huge pages of the default size of x86_64 and ARM64 with 4 KiB pages
+    static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+    static MemoryArena &get();
+
+    MemoryArena() = default;
+    ~MemoryArena() = default;
+
+    MemoryArena( const MemoryArena & ) = delete;
+    MemoryArena &operator=( const MemoryArena & ) = delete;
+    MemoryArena( MemoryArena && ) = delete;
+    MemoryArena &operator=( MemoryArena && ) = delete;
+
+    /**
+     * @brief Reserves the region. Has to be called before the structures that should use the arena are created.
+     *
+     * Huge pages from the reserved pool are tried first, then transparent huge pages are requested for normal pages.
+     * @param bytes size of the region, rounded up to whole huge pages
+     * @param lockInMemory if true all pages are faulted in and locked, a failure to lock is only logged
+     * @return False if the region could not be mapped or a region is reserved already
+     */
+    bool reserve( size_t bytes, bool lockInMemory );
+
+    /**
+     * @brief Allocates from the region. Thread safe.
+     * @return nullptr if no region is reserved or no free block is big enough
+     */
+    void *allocate( size_t bytes );
+
+    /**
+     * @brief Returns memory to the region. Thread safe.
+     * @param pointer pointer returned by allocate
+     * @param bytes the size passed to allocate
+     * @return False if the pointer is not in the region, so that it has to be freed by the caller
+     */
+    bool deallocate( void *pointer, size_t bytes );
+
+    /**
+     * @brief Unmaps the region. Only for tests, fails while memory is allocated from the region.
+     * @return True if no region is reserved anymore
+     */
+    bool release();
+
+    inline size_t
+    getReservedBytes() const
+    {
+        return mSize;
+    }
+
+    /**
+     * @brief Bytes allocated from the region including the rounding to ALIGNMENT
+     */
+    size_t getUsedBytes() const;
+
+    inline bool
+    usesHugePages() const
+    {
+        return mHugePages;
+    }
+
+    inline bool
+    isLocked() const
+    {
+        return mLocked;
+    }
+
+private:
+    static inline size_t
+    roundUp( size_t bytes, size_t alignment )
+    {
+        return ( bytes + alignment - 1 ) / alignment * alignment;
+    }
+
+    LoggingModule mLogger;
+    mutable std::mutex mMutex;
+    uint8_t *mBase{ nullptr };
+    size_t mSize{ 0 };
+    bool mHugePages{ false };
+    bool mLocked{ false };
+    size_t mUsedBytes{ 0 };
+    std::map<size_t, size_t> mFreeBlocks; /**< offset to size of all free blocks, adjacent blocks are merged */
+};
+
+/**
+ * @brief STL allocator for the MemoryArena, falls back to the heap if the arena has no space. Both are accounted
+ * to the MemorySubsystem. Types aligned to cache lines keep their alignment on the heap as well.
+ */
+template <typename T, MemorySubsystem SUBSYSTEM>
+class ArenaAllocator
+{
+public:
+    static_assert( alignof( T ) <= MemoryArena::ALIGNMENT, "Type is aligned stricter than the MemoryArena" );
+
+    using value_type = T;
+
+    template <typename U>
+    struct rebind
+    {
+        using other = ArenaAllocator<U, SUBSYSTEM>;
+    };
+
+    ArenaAllocator() = default;
+    template <typename U>
+    ArenaAllocator( const ArenaAllocator<U, SUBSYSTEM> & ) // NOLINT(google-explicit-constructor)
+    {
+    }
+
+    T *
+    allocate( size_t count )
+    {
+        auto bytes = count * sizeof( T );
+        auto *pointer = MemoryArena::get().allocate( bytes );
+        if ( pointer == nullptr )
+        {
+            pointer = heapAllocate( bytes );
+        }
+        MemoryAccounting::onAllocate( SUBSYSTEM, bytes );
+        return static_cast<T *>( pointer );
+    }
+
+    void
+    deallocate( T *pointer, size_t count )
+    {
+        MemoryAccounting::onDeallocate( SUBSYSTEM, count * sizeof( T ) );
+        if ( !MemoryArena::get().deallocate( pointer, count * sizeof( T ) ) )
+        {
+            heapDeallocate( pointer );
+        }
+    }
+
+private:
+    // Operator new only guarantees the alignment of std::max_align_t before C++17
+    static constexpr bool OVER_ALIGNED = alignof( T ) > alignof( std::max_align_t );
+
+    static void *
+    heapAllocate( size_t bytes )
+    {
+        if ( !OVER_ALIGNED )
+        {
+            return ::operator new( bytes );
+        }
+        void *pointer = nullptr;
+        if ( posix_memalign( &pointer, MemoryArena::ALIGNMENT, bytes ) != 0 )
+        {
+            throw std::bad_alloc();
+        }
+        return pointer;
+    }
+
+    static void
+    heapDeallocate( void *pointer )
+    {
+        if ( !OVER_ALIGNED )
+        {
+            ::operator delete( pointer );
+            return;
+        }
+        std::free( pointer ); // NOLINT(cppcoreguidelines-no-malloc)
+    }
+};
+
+template <typename T, typename U, MemorySubsystem SUBSYSTEM>
+inline bool
+operator==( const ArenaAllocator<T, SUBSYSTEM> &, const ArenaAllocator<U, SUBSYSTEM> & )
+{
+    return true;
+}
+
+template <typename T, typename U, MemorySubsystem SUBSYSTEM>
+inline bool
+operator!=( const ArenaAllocator<T, SUBSYSTEM> &, const ArenaAllocator<U, SUBSYSTEM> & )
+{
+    return false;
+}
+
+} // namespace Linux
+} // namespace Platform
+} // namespace IoTFleetWise
+} // namespace Aws
+#endif // IOTFLEETWISE_LINUX
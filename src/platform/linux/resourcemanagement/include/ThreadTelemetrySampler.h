@@ -0,0 +1,168 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+
+#pragma once
+
+#if defined( IOTFLEETWISE_LINUX )
+// Includes
+#include "LoggingModule.h"
+#include "Signal.h"
+#include "Thread.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace Platform
+{
+namespace Linux
+{
+/**
+ * @brief Samples the CPU time, run queue wait and context switches of every thread of the process together with the
+ * occupancy of registered queues, so that a busy or starving thread can be correlated with the queue it consumes.
+ *
+ * The /proc/self/task/<tid>/schedstat file of every thread is kept open and read with pread into a stack buffer,
+ * so a sample does neither open files nor allocate. If schedstat is not available the utime and stime of
+ * /proc/self/task/<tid>/stat are used and no context switches are reported. The task directory is only scanned
+ * for new and exited threads every RESCAN_INTERVAL samples.
+ *
+ * The values of every period are set as named variables of the TraceModule, which prints them and forwards them
+ * to the RemoteProfiler:
+ * threadCpuTimeUs_<name>_<tid>, threadRunQueueWaitUs_<name>_<tid>, threadContextSwitches_<name>_<tid> and
+ * queueOccupancy_<name>. If the heap allocations are counted, see AllocationCounter, the allocations per second of
+ * every thread are set as threadAllocationsPerSecond_<name>_<tid>.
+ */
+class ThreadTelemetrySampler
+{
+public:
+    static constexpr uint32_t RESCAN_INTERVAL = 10;
+
+    using OccupancyFunction = std::function<size_t()>;
+
+    /**
+     * @brief The values of one thread in the last sampling period
+     */
+    struct ThreadSample
+    {
+        uint64_t threadId{ 0 };
+        std::string threadName;
+        uint64_t cpuTimeUs{ 0 };
+        uint64_t runQueueWaitUs{ 0 };
+        uint64_t contextSwitches{ 0 };
+        uint64_t allocations{ 0 }; /**< Heap allocations, always 0 if AllocationCounter is not enabled */
+    };
+
+    /**
+     * @param samplingPeriodMs time between two samples of the thread
+     */
+    explicit ThreadTelemetrySampler( uint32_t samplingPeriodMs );
+    ~ThreadTelemetrySampler();
+
+    ThreadTelemetrySampler( const ThreadTelemetrySampler & ) = delete;
+    ThreadTelemetrySampler &operator=( const ThreadTelemetrySampler & ) = delete;
+    ThreadTelemetrySampler( ThreadTelemetrySampler && ) = delete;
+    ThreadTelemetrySampler &operator=( ThreadTelemetrySampler && ) = delete;
+
+    /**
+     * @brief Registers a queue whose occupancy is sampled with the threads. Has to be called before start.
+     * @param name name of the queue in the metrics
+     * @param occupancy returns the current number of elements, called from the sampling thread
+     */
+    void registerQueue( const std::string &name, OccupancyFunction occupancy );
+
+    bool start();
+
+    bool stop();
+
+    bool isAlive();
+
+    /**
+     * @brief Takes one sample of all threads and queues. Only called by the sampling thread, or if it is not
+     * running.
+     * @return False if the task directory could not be read
+     */
+    bool sample();
+
+    /**
+     * @brief Returns the values of all threads in the last sampling period
+     */
+    std::vector<ThreadSample> getThreadSamples() const;
+
+    /**
+     * @brief Returns the occupancy of a registered queue at the last sample
+     */
+    size_t getQueueOccupancy( const std::string &name ) const;
+
+private:
+    struct TrackedThread
+    {
+        uint64_t threadId{ 0 };
+        int fd{ -1 };
+        bool schedstat{ false };
+        bool seen{ false };
+        bool hasBaseline{ false };
+        bool sampled{ false };
+        uint64_t lastCpuTimeUs{ 0 };
+        uint64_t lastRunQueueWaitUs{ 0 };
+        uint64_t lastContextSwitches{ 0 };
+        uint64_t lastAllocations{ 0 };
+        ThreadSample sample;
+        std::string cpuTimeName;
+        std::string runQueueWaitName;
+        std::string contextSwitchesName;
+        std::string allocationsName;
+    };
+
+    struct TrackedQueue
+    {
+        std::string name;
+        std::string metricName;
+        OccupancyFunction occupancy;
+        size_t lastOccupancy{ 0 };
+    };
+
+    static void doWork( void *data );
+    bool shouldStop() const;
+    bool rescanThreads();
+    void openThread( uint64_t threadId );
+    void closeThread( TrackedThread &thread );
+    bool readThread( TrackedThread &thread, uint64_t &cpuTimeUs, uint64_t &runQueueWaitUs, uint64_t &contextSwitches );
+
+    uint32_t mSamplingPeriodMs;
+    uint64_t mMicrosecondsPerClockTick;
+    uint32_t mSamplesSinceRescan{ RESCAN_INTERVAL };
+    uint64_t mLastSampleTimeUs{ 0 };
+    std::vector<TrackedThread> mThreads;
+    std::vector<TrackedQueue> mQueues;
+    // Protects the last values against reads from other threads
+    mutable std::mutex mSamplesMutex;
+    Thread mThread;
+    std::atomic<bool> mShouldStop{ false };
+    std::mutex mThreadMutex;
+    Signal mWait;
+    LoggingModule mLogger;
+};
+
+} // namespace Linux
+} // namespace Platform
+} // namespace IoTFleetWise
+} // namespace Aws
+#endif // IOTFLEETWISE_LINUX
@@ -0,0 +1,239 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#if defined( IOTFLEETWISE_LINUX )
+// Includes
+#include "AllocationCounter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace Platform
+{
+namespace Linux
+{
+namespace
+{
+struct ThreadSlot
+{
+    std::atomic<uint64_t> mThreadId{ 0 }; /**< 0 if the slot is free */
+    std::atomic<uint64_t> mAllocations{ 0 };
+};
+
+// Zero initialized before any allocation can happen
+ThreadSlot gSlots[AllocationCounter::MAX_THREADS];
+// Counts the threads that found no free slot, never read
+ThreadSlot gOverflowSlot;
+
+thread_local ThreadSlot *tSlot = nullptr;
+
+// Frees the slot of the thread when it exits
+struct SlotReleaser
+{
+    ThreadSlot *mSlot{ nullptr };
+
+    SlotReleaser() = default;
+    SlotReleaser( const SlotReleaser & ) = delete;
+    SlotReleaser &operator=( const SlotReleaser & ) = delete;
+    SlotReleaser( SlotReleaser && ) = delete;
+    SlotReleaser &operator=( SlotReleaser && ) = delete;
+
+    ~SlotReleaser()
+    {
+        if ( ( mSlot != nullptr ) && ( mSlot != &gOverflowSlot ) )
+        {
+            mSlot->mAllocations.store( 0, std::memory_order_relaxed );
+            mSlot->mThreadId.store( 0, std::memory_order_release );
+        }
+        // Allocations in later thread exit handlers must not be counted on a slot that another thread can claim
+        tSlot = &gOverflowSlot;
+    }
+};
+
+// Sets tSlot to a free slot, or to gOverflowSlot if there is none
+void
+claimSlot()
+{
+    auto threadId = static_cast<uint64_t>( syscall( SYS_gettid ) );
+    ThreadSlot *claimed = &gOverflowSlot;
+    for ( auto &slot : gSlots )
+    {
+        uint64_t expected = 0;
+        if ( slot.mThreadId.compare_exchange_strong( expected, threadId, std::memory_order_acq_rel ) )
+        {
+            claimed = &slot;
+            break;
+        }
+    }
+    // Published before the releaser is initialized: where the C library has no __cxa_thread_atexit_impl, registering
+    // its destructor calls operator new. The nested allocation must be counted on this slot, otherwise it claims a
+    // second slot that is never released.
+    tSlot = claimed;
+    static thread_local SlotReleaser releaser;
+    releaser.mSlot = claimed;
+}
+
+ThreadSlot *
+findSlot( uint64_t threadId )
+{
+    for ( auto &slot : gSlots )
+    {
+        if ( slot.mThreadId.load( std::memory_order_acquire ) == threadId )
+        {
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+} // namespace
+
+constexpr size_t AllocationCounter::MAX_THREADS;
+
+bool
+AllocationCounter::isEnabled()
+{
+#if defined( FWE_ALLOCATION_COUNTING )
+    return true;
+#else
+    return false;
+#endif
+}
+
+void
+AllocationCounter::countAllocation()
+{
+    if ( tSlot == nullptr )
+    {
+        claimSlot();
+    }
+    tSlot->mAllocations.fetch_add( 1, std::memory_order_relaxed );
+}
+
+uint64_t
+AllocationCounter::getAllocations( uint64_t threadId )
+{
+    auto *slot = findSlot( threadId );
+    return ( slot == nullptr ) ? 0 : slot->mAllocations.load( std::memory_order_relaxed );
+}
+
+uint64_t
+AllocationCounter::getCurrentThreadAllocations()
+{
+    if ( ( tSlot == nullptr ) || ( tSlot == &gOverflowSlot ) )
+    {
+        return 0;
+    }
+    return tSlot->mAllocations.load( std::memory_order_relaxed );
+}
+
+} // namespace Linux
+} // namespace Platform
+} // namespace IoTFleetWise
+} // namespace Aws
+
+#if defined( FWE_ALLOCATION_COUNTING )
+// Replacements of the global allocation functions, which count every allocation of the calling thread. The
+// allocation itself is done with malloc like by the default implementation.
+
+void *
+operator new( std::size_t size )
+{
+    Aws::IoTFleetWise::Platform::Linux::AllocationCounter::countAllocation();
+    if ( size == 0 )
+    {
+        size = 1;
+    }
+    while ( true )
+    {
+        void *pointer = std::malloc( size ); // NOLINT(cppcoreguidelines-no-malloc)
+        if ( pointer != nullptr )
+        {
+            return pointer;
+        }
+        auto handler = std::get_new_handler();
+        if ( handler == nullptr )
+        {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void *
+operator new[]( std::size_t size )
+{
+    return operator new( size );
+}
+
+void *
+operator new( std::size_t size, const std::nothrow_t & ) noexcept
+{
+    try
+    {
+        return operator new( size );
+    }
+    catch ( ... )
+    {
+        return nullptr;
+    }
+}
+
+void *
+operator new[]( std::size_t size, const std::nothrow_t & ) noexcept
+{
+    return operator new( size, std::nothrow );
+}
+
+void
+operator delete( void *pointer ) noexcept
+{
+    std::free( pointer ); // NOLINT(cppcoreguidelines-no-malloc)
+}
+
+void
+operator delete[]( void *pointer ) noexcept
+{
+    std::free( pointer ); // NOLINT(cppcoreguidelines-no-malloc)
+}
+
+void
+operator delete( void *pointer, std::size_t ) noexcept
+{
+    std::free( pointer ); // NOLINT(cppcoreguidelines-no-malloc)
+}
+
+void
+operator delete[]( void *pointer, std::size_t ) noexcept
+{
+    std::free( pointer ); // NOLINT(cppcoreguidelines-no-malloc)
+}
+
+void
+operator delete( void *pointer, const std::nothrow_t & ) noexcept
+{
+    std::free( pointer ); // NOLINT(cppcoreguidelines-no-malloc)
+}
+
+void
+operator delete[]( void *pointer, const std::nothrow_t & ) noexcept
+{
+    std::free( pointer ); // NOLINT(cppcoreguidelines-no-malloc)
+}
+#endif // FWE_ALLOCATION_COUNTING
+#endif // IOTFLEETWISE_LINUX
@@ -0,0 +1,111 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#if defined( IOTFLEETWISE_LINUX )
+// Includes
+#include "MemoryAccounting.h"
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace Platform
+{
+namespace Linux
+{
+
+uint64_t
+MemoryAccounting::getUsedBytes( MemorySubsystem subsystem )
+{
+    return TraceModule::get().getAtomicVariable( getBytesVariable( subsystem ) );
+}
+
+uint64_t
+MemoryAccounting::getAllocationCount( MemorySubsystem subsystem )
+{
+    return TraceModule::get().getAtomicVariable( getAllocationsVariable( subsystem ) );
+}
+
+void
+MemoryAccounting::setCeiling( MemorySubsystem subsystem, size_t bytes )
+{
+    if ( subsystem < MemorySubsystem::SUBSYSTEM_COUNT )
+    {
+        getCeilings()[static_cast<size_t>( subsystem )].store( bytes, std::memory_order_relaxed );
+    }
+}
+
+size_t
+MemoryAccounting::getCeiling( MemorySubsystem subsystem )
+{
+    if ( subsystem < MemorySubsystem::SUBSYSTEM_COUNT )
+    {
+        return getCeilings()[static_cast<size_t>( subsystem )].load( std::memory_order_relaxed );
+    }
+    return 0;
+}
+
+bool
+MemoryAccounting::isOverCeiling( MemorySubsystem subsystem )
+{
+    auto ceiling = getCeiling( subsystem );
+    return ( ceiling > 0 ) && ( getUsedBytes( subsystem ) > ceiling );
+}
+
+const char *
+MemoryAccounting::getName( MemorySubsystem subsystem )
+{
+    switch ( subsystem )
+    {
+    case MemorySubsystem::DECODING:
+        return "decoding";
+    case MemorySubsystem::INSPECTION:
+        return "inspection";
+    case MemorySubsystem::COLLECTION:
+        return "collection";
+    case MemorySubsystem::PERSISTENCY:
+        return "persistency";
+    case MemorySubsystem::CONNECTIVITY:
+        return "connectivity";
+    default:
+        return "unknown";
+    }
+}
+
+bool
+MemoryAccounting::getSubsystem( const std::string &name, MemorySubsystem &subsystem )
+{
+    for ( size_t i = 0; i < static_cast<size_t>( MemorySubsystem::SUBSYSTEM_COUNT ); i++ )
+    {
+        if ( name == getName( static_cast<MemorySubsystem>( i ) ) )
+        {
+            subsystem = static_cast<MemorySubsystem>( i );
+            return true;
+        }
+    }
+    return false;
+}
+
+std::array<std::atomic<size_t>, static_cast<size_t>( MemorySubsystem::SUBSYSTEM_COUNT )> &
+MemoryAccounting::getCeilings()
+{
+    // Zero initialized before any allocation can happen
+    static std::array<std::atomic<size_t>, static_cast<size_t>( MemorySubsystem::SUBSYSTEM_COUNT )> ceilings{};
+    return ceilings;
+}
+
+} // namespace Linux
+} // namespace Platform
+} // namespace IoTFleetWise
+} // namespace Aws
+#endif // IOTFLEETWISE_LINUX
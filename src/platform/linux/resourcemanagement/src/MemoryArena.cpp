@@ -0,0 +1,191 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#if defined( IOTFLEETWISE_LINUX )
+// Includes
+#include "MemoryArena.h"
+#include <cerrno>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <sys/mman.h>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace Platform
+{
+namespace Linux
+{
+
+constexpr size_t MemoryArena::ALIGNMENT;
+constexpr size_t MemoryArena::HUGE_PAGE_SIZE;
+
+MemoryArena &
+MemoryArena::get()
+{
+    // Never destroyed, static objects destroyed at exit might still return memory to it
+    static auto *arena = new MemoryArena();
+    return *arena;
+}
+
+bool
+MemoryArena::reserve( size_t bytes, bool lockInMemory )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    if ( mBase != nullptr )
+    {
+        mLogger.error( "MemoryArena::reserve", " A region is reserved already " );
+        return false;
+    }
+    if ( bytes == 0 )
+    {
+        mLogger.error( "MemoryArena::reserve", " Size must not be 0 " );
+        return false;
+    }
+    auto size = roundUp( bytes, HUGE_PAGE_SIZE );
+    mHugePages = true;
+    auto *mapping =
+        mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0 );
+    if ( mapping == MAP_FAILED )
+    {
+        // No pool of huge pages is configured, the kernel may still back the region with transparent huge pages
+        mHugePages = false;
+        mapping = mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+        if ( mapping == MAP_FAILED )
+        {
+            mLogger.error( "MemoryArena::reserve",
+                           " Failed to map " + std::to_string( size ) + " Bytes: " + std::string( strerror( errno ) ) );
+            return false;
+        }
+        (void)madvise( mapping, size, MADV_HUGEPAGE );
+    }
+    mLocked = false;
+    if ( lockInMemory )
+    {
+        if ( mlock( mapping, size ) == 0 )
+        {
+            mLocked = true;
+        }
+        else
+        {
+            mLogger.warn( "MemoryArena::reserve",
+                          " Failed to lock the region, pages are faulted in on first use: " +
+                              std::string( strerror( errno ) ) );
+        }
+    }
+    mBase = static_cast<uint8_t *>( mapping );
+    mSize = size;
+    mUsedBytes = 0;
+    mFreeBlocks.clear();
+    mFreeBlocks[0] = size;
+    mLogger.info( "MemoryArena::reserve",
+                  " Reserved " + std::to_string( size ) + " Bytes" + ( mHugePages ? " of huge pages" : "" ) +
+                      ( mLocked ? ", locked in memory" : "" ) );
+    return true;
+}
+
+void *
+MemoryArena::allocate( size_t bytes )
+{
+    if ( bytes == 0 )
+    {
+        return nullptr;
+    }
+    auto size = roundUp( bytes, ALIGNMENT );
+    std::lock_guard<std::mutex> lock( mMutex );
+    // First fit keeps the long-lived structures allocated at startup at the beginning of the region
+    for ( auto it = mFreeBlocks.begin(); it != mFreeBlocks.end(); it++ )
+    {
+        if ( it->second < size )
+        {
+            continue;
+        }
+        auto offset = it->first;
+        auto remaining = it->second - size;
+        mFreeBlocks.erase( it );
+        if ( remaining > 0 )
+        {
+            mFreeBlocks[offset + size] = remaining;
+        }
+        mUsedBytes += size;
+        return mBase + offset;
+    }
+    return nullptr;
+}
+
+bool
+MemoryArena::deallocate( void *pointer, size_t bytes )
+{
+    auto *address = static_cast<uint8_t *>( pointer );
+    std::lock_guard<std::mutex> lock( mMutex );
+    if ( ( mBase == nullptr ) || ( address < mBase ) || ( address >= mBase + mSize ) )
+    {
+        return false;
+    }
+    auto offset = static_cast<size_t>( address - mBase );
+    auto size = roundUp( bytes, ALIGNMENT );
+    mUsedBytes -= size;
+    auto next = mFreeBlocks.lower_bound( offset );
+    if ( ( next != mFreeBlocks.end() ) && ( next->first == offset + size ) )
+    {
+        size += next->second;
+        next = mFreeBlocks.erase( next );
+    }
+    if ( next != mFreeBlocks.begin() )
+    {
+        auto previous = std::prev( next );
+        if ( previous->first + previous->second == offset )
+        {
+            previous->second += size;
+            return true;
+        }
+    }
+    mFreeBlocks.emplace_hint( next, offset, size );
+    return true;
+}
+
+bool
+MemoryArena::release()
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    if ( mBase == nullptr )
+    {
+        return true;
+    }
+    if ( mUsedBytes > 0 )
+    {
+        return false;
+    }
+    munmap( mBase, mSize );
+    mBase = nullptr;
+    mSize = 0;
+    mHugePages = false;
+    mLocked = false;
+    mFreeBlocks.clear();
+    return true;
+}
+
+size_t
+MemoryArena::getUsedBytes() const
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    return mUsedBytes;
+}
+
+} // namespace Linux
+} // namespace Platform
+} // namespace IoTFleetWise
+} // namespace Aws
+#endif // IOTFLEETWISE_LINUX
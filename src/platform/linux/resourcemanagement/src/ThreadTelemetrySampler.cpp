@@ -0,0 +1,413 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+
+#if defined( IOTFLEETWISE_LINUX )
+// Includes
+#include "ThreadTelemetrySampler.h"
+#include "AllocationCounter.h"
+#include "TraceModule.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <dirent.h>
+#include <fcntl.h>
+#include <fstream>
+#include <unistd.h>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace Platform
+{
+namespace Linux
+{
+namespace
+{
+// Parses the unsigned integer starting at position and moves position behind it
+uint64_t
+parseUnsigned( const char *&position, const char *end )
+{
+    uint64_t value = 0;
+    while ( ( position < end ) && ( *position >= '0' ) && ( *position <= '9' ) )
+    {
+        value = ( value * 10U ) + static_cast<uint64_t>( *position - '0' );
+        position++;
+    }
+    return value;
+}
+
+// Moves position behind the next space
+void
+skipField( const char *&position, const char *end )
+{
+    while ( ( position < end ) && ( *position != ' ' ) )
+    {
+        position++;
+    }
+    if ( position < end )
+    {
+        position++;
+    }
+}
+} // namespace
+
+constexpr uint32_t ThreadTelemetrySampler::RESCAN_INTERVAL;
+
+ThreadTelemetrySampler::ThreadTelemetrySampler( uint32_t samplingPeriodMs )
+    : mSamplingPeriodMs( std::max( 1U, samplingPeriodMs ) )
+    , mMicrosecondsPerClockTick( 1000000U / static_cast<uint64_t>( std::max( 1L, sysconf( _SC_CLK_TCK ) ) ) )
+{
+}
+
+ThreadTelemetrySampler::~ThreadTelemetrySampler()
+{
+    // To make sure the thread stops during teardown of tests.
+    if ( isAlive() )
+    {
+        stop();
+    }
+    for ( auto &thread : mThreads )
+    {
+        closeThread( thread );
+    }
+    for ( const auto &queue : mQueues )
+    {
+        TraceModule::get().removeNamedVariable( queue.metricName );
+    }
+}
+
+void
+ThreadTelemetrySampler::registerQueue( const std::string &name, OccupancyFunction occupancy )
+{
+    std::lock_guard<std::mutex> lock( mSamplesMutex );
+    TrackedQueue queue;
+    queue.name = name;
+    queue.metricName = "queueOccupancy_" + name;
+    queue.occupancy = std::move( occupancy );
+    mQueues.emplace_back( std::move( queue ) );
+}
+
+bool
+ThreadTelemetrySampler::start()
+{
+    // Prevent concurrent stop/init
+    std::lock_guard<std::mutex> lock( mThreadMutex );
+    // On multi core systems the shared variable mShouldStop must be updated for
+    // all cores before starting the thread otherwise thread will directly end
+    mShouldStop.store( false );
+    if ( !mThread.create( doWork, this, "fwRMTelemetry" ) )
+    {
+        mLogger.trace( "ThreadTelemetrySampler::start", " Telemetry sampler thread failed to start " );
+        return false;
+    }
+    mLogger.trace( "ThreadTelemetrySampler::start",
+                   " Telemetry sampler thread started with a period of " + std::to_string( mSamplingPeriodMs ) +
+                       " ms" );
+    return true;
+}
+
+bool
+ThreadTelemetrySampler::stop()
+{
+    std::lock_guard<std::mutex> lock( mThreadMutex );
+    mShouldStop.store( true, std::memory_order_relaxed );
+    mWait.notify();
+    mThread.release();
+    mShouldStop.store( false, std::memory_order_relaxed );
+    return !mThread.isActive();
+}
+
+bool
+ThreadTelemetrySampler::isAlive()
+{
+    return mThread.isValid() && mThread.isActive();
+}
+
+bool
+ThreadTelemetrySampler::shouldStop() const
+{
+    return mShouldStop.load( std::memory_order_relaxed );
+}
+
+void
+ThreadTelemetrySampler::doWork( void *data )
+{
+    auto *sampler = static_cast<ThreadTelemetrySampler *>( data );
+    while ( !sampler->shouldStop() )
+    {
+        if ( !sampler->sample() )
+        {
+            sampler->mLogger.warn( "ThreadTelemetrySampler::doWork", "Failed to read the threads of the process" );
+        }
+        sampler->mWait.wait( sampler->mSamplingPeriodMs );
+    }
+}
+
+void
+ThreadTelemetrySampler::openThread( uint64_t threadId )
+{
+    TrackedThread thread;
+    thread.threadId = threadId;
+    auto taskPath = "/proc/self/task/" + std::to_string( threadId );
+    thread.fd = open( ( taskPath + "/schedstat" ).c_str(), O_RDONLY | O_CLOEXEC );
+    thread.schedstat = thread.fd >= 0;
+    if ( !thread.schedstat )
+    {
+        thread.fd = open( ( taskPath + "/stat" ).c_str(), O_RDONLY | O_CLOEXEC );
+        if ( thread.fd < 0 )
+        {
+            // The thread exited in the meantime
+            return;
+        }
+    }
+    std::ifstream commFile( taskPath + "/comm" );
+    std::getline( commFile, thread.sample.threadName );
+    thread.sample.threadId = threadId;
+    auto suffix = thread.sample.threadName + "_" + std::to_string( threadId );
+    thread.cpuTimeName = "threadCpuTimeUs_" + suffix;
+    thread.runQueueWaitName = "threadRunQueueWaitUs_" + suffix;
+    thread.contextSwitchesName = "threadContextSwitches_" + suffix;
+    thread.allocationsName = "threadAllocationsPerSecond_" + suffix;
+    thread.seen = true;
+    mThreads.emplace_back( std::move( thread ) );
+}
+
+void
+ThreadTelemetrySampler::closeThread( TrackedThread &thread )
+{
+    if ( thread.fd >= 0 )
+    {
+        close( thread.fd );
+        thread.fd = -1;
+    }
+    if ( thread.sampled )
+    {
+        TraceModule::get().removeNamedVariable( thread.cpuTimeName );
+        TraceModule::get().removeNamedVariable( thread.runQueueWaitName );
+        TraceModule::get().removeNamedVariable( thread.contextSwitchesName );
+        if ( AllocationCounter::isEnabled() )
+        {
+            TraceModule::get().removeNamedVariable( thread.allocationsName );
+        }
+        thread.sampled = false;
+    }
+}
+
+bool
+ThreadTelemetrySampler::rescanThreads()
+{
+    DIR *taskDir = opendir( "/proc/self/task" );
+    if ( taskDir == nullptr )
+    {
+        return false;
+    }
+    for ( auto &thread : mThreads )
+    {
+        thread.seen = false;
+    }
+    struct dirent *entry = nullptr;
+    while ( ( entry = readdir( taskDir ) ) != nullptr )
+    {
+        if ( ( entry->d_name[0] < '0' ) || ( entry->d_name[0] > '9' ) )
+        {
+            continue;
+        }
+        auto threadId = static_cast<uint64_t>( strtoull( entry->d_name, nullptr, 10 ) );
+        auto it = std::find_if( mThreads.begin(), mThreads.end(), [threadId]( const TrackedThread &thread ) {
+            return thread.threadId == threadId;
+        } );
+        if ( it == mThreads.end() )
+        {
+            openThread( threadId );
+        }
+        else
+        {
+            it->seen = true;
+        }
+    }
+    closedir( taskDir );
+    for ( auto it = mThreads.begin(); it != mThreads.end(); )
+    {
+        // A thread whose file can not be read anymore exited, its ID might already be reused by a new thread
+        if ( ( !it->seen ) || ( it->fd < 0 ) )
+        {
+            closeThread( *it );
+            it = mThreads.erase( it );
+        }
+        else
+        {
+            it++;
+        }
+    }
+    return true;
+}
+
+bool
+ThreadTelemetrySampler::readThread( TrackedThread &thread,
+                                    uint64_t &cpuTimeUs,
+                                    uint64_t &runQueueWaitUs,
+                                    uint64_t &contextSwitches )
+{
+    char buffer[512];
+    auto size = pread( thread.fd, buffer, sizeof( buffer ), 0 );
+    if ( size <= 0 )
+    {
+        return false;
+    }
+    const char *position = buffer;
+    const char *end = buffer + size;
+    if ( thread.schedstat )
+    {
+        // Time on the CPU in ns, time waiting on the run queue in ns, number of time slices run on the CPU
+        cpuTimeUs = parseUnsigned( position, end ) / 1000U;
+        skipField( position, end );
+        runQueueWaitUs = parseUnsigned( position, end ) / 1000U;
+        skipField( position, end );
+        contextSwitches = parseUnsigned( position, end );
+        return true;
+    }
+    // The name in field 2 can contain spaces and parentheses, so the fields are counted from its last ')'
+    while ( ( end > position ) && ( *( end - 1 ) != ')' ) )
+    {
+        end--;
+    }
+    if ( end == position )
+    {
+        return false;
+    }
+    position = end + 1;
+    end = buffer + size;
+    // After ") " follows field 3, utime is field 14 and stime field 15
+    for ( int field = 2; field < 14; field++ )
+    {
+        skipField( position, end );
+    }
+    auto ticks = parseUnsigned( position, end );
+    skipField( position, end );
+    ticks += parseUnsigned( position, end );
+    cpuTimeUs = ticks * mMicrosecondsPerClockTick;
+    runQueueWaitUs = 0;
+    contextSwitches = 0;
+    return true;
+}
+
+bool
+ThreadTelemetrySampler::sample()
+{
+    std::lock_guard<std::mutex> lock( mSamplesMutex );
+    bool success = true;
+    if ( mSamplesSinceRescan >= RESCAN_INTERVAL )
+    {
+        mSamplesSinceRescan = 0;
+        success = rescanThreads();
+    }
+    mSamplesSinceRescan++;
+
+    // The period is measured, as the wait for the next sample can take longer than the sampling period
+    auto sampleTimeUs = static_cast<uint64_t>( std::chrono::duration_cast<std::chrono::microseconds>(
+                                                   std::chrono::steady_clock::now().time_since_epoch() )
+                                                   .count() );
+    auto periodUs = std::max<uint64_t>( 1U, sampleTimeUs - mLastSampleTimeUs );
+    mLastSampleTimeUs = sampleTimeUs;
+    auto countAllocations = AllocationCounter::isEnabled();
+    auto &traceModule = TraceModule::get();
+    for ( auto &thread : mThreads )
+    {
+        uint64_t cpuTimeUs = 0;
+        uint64_t runQueueWaitUs = 0;
+        uint64_t contextSwitches = 0;
+        uint64_t allocations = countAllocations ? AllocationCounter::getAllocations( thread.threadId ) : 0;
+        if ( ( thread.fd < 0 ) || ( !readThread( thread, cpuTimeUs, runQueueWaitUs, contextSwitches ) ) )
+        {
+            // Removed with the next scan, which is done right away
+            closeThread( thread );
+            mSamplesSinceRescan = RESCAN_INTERVAL;
+            continue;
+        }
+        // The first read of a thread only sets the baseline
+        if ( thread.hasBaseline )
+        {
+            thread.sample.cpuTimeUs = cpuTimeUs - thread.lastCpuTimeUs;
+            thread.sample.runQueueWaitUs = runQueueWaitUs - thread.lastRunQueueWaitUs;
+            thread.sample.contextSwitches = contextSwitches - thread.lastContextSwitches;
+            // The counter starts from 0 again if the slot of the thread was released in the meantime
+            thread.sample.allocations =
+                ( allocations >= thread.lastAllocations ) ? ( allocations - thread.lastAllocations ) : allocations;
+            thread.sampled = true;
+            traceModule.setNamedVariable(
+                thread.cpuTimeName, static_cast<int64_t>( thread.sample.cpuTimeUs ), "Microseconds" );
+            if ( thread.schedstat )
+            {
+                traceModule.setNamedVariable(
+                    thread.runQueueWaitName, static_cast<int64_t>( thread.sample.runQueueWaitUs ), "Microseconds" );
+                traceModule.setNamedVariable(
+                    thread.contextSwitchesName, static_cast<int64_t>( thread.sample.contextSwitches ), "Count" );
+            }
+            if ( countAllocations )
+            {
+                auto allocationsPerSecond = ( thread.sample.allocations * 1000000U ) / periodUs;
+                traceModule.setNamedVariable(
+                    thread.allocationsName, static_cast<int64_t>( allocationsPerSecond ), "Count/Second" );
+            }
+        }
+        thread.hasBaseline = true;
+        thread.lastCpuTimeUs = cpuTimeUs;
+        thread.lastRunQueueWaitUs = runQueueWaitUs;
+        thread.lastContextSwitches = contextSwitches;
+        thread.lastAllocations = allocations;
+    }
+
+    for ( auto &queue : mQueues )
+    {
+        queue.lastOccupancy = queue.occupancy();
+        traceModule.setNamedVariable( queue.metricName, static_cast<int64_t>( queue.lastOccupancy ), "Count" );
+    }
+    return success;
+}
+
+std::vector<ThreadTelemetrySampler::ThreadSample>
+ThreadTelemetrySampler::getThreadSamples() const
+{
+    std::lock_guard<std::mutex> lock( mSamplesMutex );
+    std::vector<ThreadSample> samples;
+    for ( const auto &thread : mThreads )
+    {
+        if ( thread.sampled )
+        {
+            samples.push_back( thread.sample );
+        }
+    }
+    return samples;
+}
+
+size_t
+ThreadTelemetrySampler::getQueueOccupancy( const std::string &name ) const
+{
+    std::lock_guard<std::mutex> lock( mSamplesMutex );
+    for ( const auto &queue : mQueues )
+    {
+        if ( queue.name == name )
+        {
+            return queue.lastOccupancy;
+        }
+    }
+    return 0;
+}
+
+} // namespace Linux
+} // namespace Platform
+} // namespace IoTFleetWise
+} // namespace Aws
+#endif // IOTFLEETWISE_LINUX
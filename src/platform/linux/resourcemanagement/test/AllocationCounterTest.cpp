@@ -0,0 +1,84 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "AllocationCounter.h"
+#include <atomic>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <new>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+namespace
+{
+// Explicit calls of the allocation functions can not be optimized away like new expressions
+void
+allocate( uint32_t count )
+{
+    for ( uint32_t i = 0; i < count; i++ )
+    {
+        auto *pointer = ::operator new( 16 );
+        ::operator delete( pointer );
+    }
+}
+} // namespace
+
+TEST( AllocationCounterTest, CountAllocationsOfCurrentThread )
+{
+    if ( !AllocationCounter::isEnabled() )
+    {
+        GTEST_SKIP() << "Built without FWE_ALLOCATION_COUNTING";
+    }
+    auto threadId = static_cast<uint64_t>( syscall( SYS_gettid ) );
+    auto allocations = AllocationCounter::getCurrentThreadAllocations();
+    allocate( 10 );
+    ASSERT_EQ( AllocationCounter::getCurrentThreadAllocations(), allocations + 10 );
+    ASSERT_EQ( AllocationCounter::getAllocations( threadId ), allocations + 10 );
+    // Frees are not counted
+    auto *array = new ( std::nothrow ) uint8_t[100];
+    delete[] array;
+    ASSERT_EQ( AllocationCounter::getCurrentThreadAllocations(), allocations + 11 );
+}
+
+TEST( AllocationCounterTest, CountAllocationsOfOtherThreads )
+{
+    if ( !AllocationCounter::isEnabled() )
+    {
+        GTEST_SKIP() << "Built without FWE_ALLOCATION_COUNTING";
+    }
+    std::atomic<uint64_t> threadId{ 0 };
+    std::atomic<bool> allocated{ false };
+    std::atomic<bool> stop{ false };
+    std::thread thread( [&]() {
+        allocate( 5 );
+        threadId = static_cast<uint64_t>( syscall( SYS_gettid ) );
+        allocated = true;
+        while ( !stop )
+        {
+            std::this_thread::yield();
+        }
+    } );
+    while ( !allocated )
+    {
+        std::this_thread::yield();
+    }
+    // Further allocations of the thread library are possible, but not before the first allocation of the thread
+    ASSERT_GE( AllocationCounter::getAllocations( threadId ), 5 );
+    stop = true;
+    thread.join();
+    // The slot is released when the thread exits
+    ASSERT_EQ( AllocationCounter::getAllocations( threadId ), 0 );
+}
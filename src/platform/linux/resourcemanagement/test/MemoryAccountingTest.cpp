@@ -0,0 +1,72 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "MemoryAccounting.h"
+#include "MemoryArena.h"
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+TEST( MemoryAccountingTest, AllocatorsAccountPerSubsystem )
+{
+    auto persistencyBytes = MemoryAccounting::getUsedBytes( MemorySubsystem::PERSISTENCY );
+    auto persistencyAllocations = MemoryAccounting::getAllocationCount( MemorySubsystem::PERSISTENCY );
+    auto collectionBytes = MemoryAccounting::getUsedBytes( MemorySubsystem::COLLECTION );
+    {
+        std::vector<uint32_t, TrackedAllocator<uint32_t, MemorySubsystem::PERSISTENCY>> tracked( 100 );
+        ASSERT_EQ( MemoryAccounting::getUsedBytes( MemorySubsystem::PERSISTENCY ),
+                   persistencyBytes + 100 * sizeof( uint32_t ) );
+        ASSERT_EQ( MemoryAccounting::getAllocationCount( MemorySubsystem::PERSISTENCY ), persistencyAllocations + 1 );
+        // Rebound allocators of shared pointers keep the subsystem
+        auto shared = std::allocate_shared<uint64_t>( ArenaAllocator<uint64_t, MemorySubsystem::PERSISTENCY>(), 7 );
+        ASSERT_GT( MemoryAccounting::getUsedBytes( MemorySubsystem::PERSISTENCY ),
+                   persistencyBytes + 100 * sizeof( uint32_t ) );
+        ASSERT_EQ( MemoryAccounting::getAllocationCount( MemorySubsystem::PERSISTENCY ), persistencyAllocations + 2 );
+        ASSERT_EQ( MemoryAccounting::getUsedBytes( MemorySubsystem::COLLECTION ), collectionBytes );
+    }
+    ASSERT_EQ( MemoryAccounting::getUsedBytes( MemorySubsystem::PERSISTENCY ), persistencyBytes );
+    ASSERT_EQ( MemoryAccounting::getAllocationCount( MemorySubsystem::PERSISTENCY ), persistencyAllocations );
+}
+
+TEST( MemoryAccountingTest, CeilingExceeded )
+{
+    auto exceeded = TraceModule::get().getAtomicVariable( TraceAtomicVariable::MEMORY_CEILING_EXCEEDED );
+    auto usedBytes = MemoryAccounting::getUsedBytes( MemorySubsystem::COLLECTION );
+    MemoryAccounting::setCeiling( MemorySubsystem::COLLECTION, usedBytes + 1000 );
+    ASSERT_EQ( MemoryAccounting::getCeiling( MemorySubsystem::COLLECTION ), usedBytes + 1000 );
+    {
+        std::vector<uint8_t, TrackedAllocator<uint8_t, MemorySubsystem::COLLECTION>> belowCeiling( 1000 );
+        ASSERT_FALSE( MemoryAccounting::isOverCeiling( MemorySubsystem::COLLECTION ) );
+        // Does not fail, only counted once when rising above the ceiling
+        std::vector<uint8_t, TrackedAllocator<uint8_t, MemorySubsystem::COLLECTION>> aboveCeiling( 10 );
+        std::vector<uint8_t, TrackedAllocator<uint8_t, MemorySubsystem::COLLECTION>> further( 10 );
+        ASSERT_TRUE( MemoryAccounting::isOverCeiling( MemorySubsystem::COLLECTION ) );
+        ASSERT_EQ( TraceModule::get().getAtomicVariable( TraceAtomicVariable::MEMORY_CEILING_EXCEEDED ),
+                   exceeded + 1 );
+    }
+    ASSERT_FALSE( MemoryAccounting::isOverCeiling( MemorySubsystem::COLLECTION ) );
+    MemoryAccounting::setCeiling( MemorySubsystem::COLLECTION, 0 );
+    ASSERT_FALSE( MemoryAccounting::isOverCeiling( MemorySubsystem::COLLECTION ) );
+}
+
+TEST( MemoryAccountingTest, SubsystemNames )
+{
+    MemorySubsystem subsystem{};
+    ASSERT_TRUE( MemoryAccounting::getSubsystem( "connectivity", subsystem ) );
+    ASSERT_EQ( subsystem, MemorySubsystem::CONNECTIVITY );
+    ASSERT_STREQ( MemoryAccounting::getName( MemorySubsystem::DECODING ), "decoding" );
+    ASSERT_FALSE( MemoryAccounting::getSubsystem( "unknown", subsystem ) );
+}
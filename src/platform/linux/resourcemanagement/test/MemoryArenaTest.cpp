@@ -0,0 +1,108 @@
+
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "MemoryArena.h"
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+TEST( MemoryArenaTest, NotReserved )
+{
+    MemoryArena arena;
+    ASSERT_EQ( arena.allocate( 100 ), nullptr );
+    int value = 0;
+    ASSERT_FALSE( arena.deallocate( &value, sizeof( value ) ) );
+    ASSERT_FALSE( arena.reserve( 0, false ) );
+    ASSERT_TRUE( arena.release() );
+}
+
+TEST( MemoryArenaTest, AllocateUntilFullAndMergeFreeBlocks )
+{
+    MemoryArena arena;
+    ASSERT_TRUE( arena.reserve( 1, false ) );
+    ASSERT_FALSE( arena.reserve( 1, false ) );
+    ASSERT_EQ( arena.getReservedBytes(), MemoryArena::HUGE_PAGE_SIZE );
+    auto half = MemoryArena::HUGE_PAGE_SIZE / 2;
+    auto *first = arena.allocate( half - 1 );
+    auto *second = arena.allocate( half );
+    ASSERT_NE( first, nullptr );
+    ASSERT_NE( second, nullptr );
+    ASSERT_EQ( reinterpret_cast<uintptr_t>( first ) % MemoryArena::ALIGNMENT, 0 );
+    ASSERT_EQ( reinterpret_cast<uintptr_t>( second ) % MemoryArena::ALIGNMENT, 0 );
+    ASSERT_EQ( arena.getUsedBytes(), MemoryArena::HUGE_PAGE_SIZE );
+    ASSERT_EQ( arena.allocate( 1 ), nullptr );
+    // Still in use
+    ASSERT_FALSE( arena.release() );
+
+    ASSERT_TRUE( arena.deallocate( first, half - 1 ) );
+    ASSERT_TRUE( arena.deallocate( second, half ) );
+    ASSERT_EQ( arena.getUsedBytes(), 0 );
+    // Only possible if both free blocks were merged
+    auto *all = arena.allocate( MemoryArena::HUGE_PAGE_SIZE );
+    ASSERT_EQ( all, first );
+    ASSERT_TRUE( arena.deallocate( all, MemoryArena::HUGE_PAGE_SIZE ) );
+    ASSERT_TRUE( arena.release() );
+    ASSERT_EQ( arena.getReservedBytes(), 0 );
+}
+
+TEST( MemoryArenaTest, LockInMemory )
+{
+    MemoryArena arena;
+    // Locking might not be permitted, the region is usable nevertheless
+    ASSERT_TRUE( arena.reserve( MemoryArena::HUGE_PAGE_SIZE, true ) );
+    auto *memory = arena.allocate( 1000 );
+    ASSERT_NE( memory, nullptr );
+    ASSERT_TRUE( arena.deallocate( memory, 1000 ) );
+    ASSERT_TRUE( arena.release() );
+}
+
+TEST( MemoryArenaTest, AllocatorFallsBackToHeap )
+{
+    auto &arena = MemoryArena::get();
+    ASSERT_TRUE( arena.reserve( MemoryArena::HUGE_PAGE_SIZE, false ) );
+    {
+        std::vector<uint64_t, ArenaAllocator<uint64_t, MemorySubsystem::INSPECTION>> inArena( 1000 );
+        ASSERT_GE( arena.getUsedBytes(), 1000 * sizeof( uint64_t ) );
+        auto usedBytes = arena.getUsedBytes();
+        // Does not fit anymore
+        std::vector<uint8_t, ArenaAllocator<uint8_t, MemorySubsystem::INSPECTION>> onHeap(
+            MemoryArena::HUGE_PAGE_SIZE );
+        ASSERT_EQ( arena.getUsedBytes(), usedBytes );
+        auto shared = std::allocate_shared<uint32_t>( ArenaAllocator<uint32_t, MemorySubsystem::INSPECTION>(), 5 );
+        ASSERT_GT( arena.getUsedBytes(), usedBytes );
+        ASSERT_EQ( *shared, 5 );
+    }
+    ASSERT_EQ( arena.getUsedBytes(), 0 );
+    ASSERT_TRUE( arena.release() );
+}
+
+TEST( MemoryArenaTest, AllocatorKeepsCacheLineAlignmentOnHeap )
+{
+    struct alignas( MemoryArena::ALIGNMENT ) CacheLine
+    {
+        uint64_t mValue{ 0 };
+    };
+    // Without a reserved arena everything comes from the heap
+    std::vector<CacheLine, ArenaAllocator<CacheLine, MemorySubsystem::INSPECTION>> lines;
+    for ( uint64_t i = 0; i < 100; i++ )
+    {
+        lines.emplace_back();
+        lines.back().mValue = i;
+        ASSERT_EQ( reinterpret_cast<uintptr_t>( lines.data() ) % MemoryArena::ALIGNMENT, 0 );
+    }
+    ASSERT_EQ( lines[99].mValue, 99 );
+}
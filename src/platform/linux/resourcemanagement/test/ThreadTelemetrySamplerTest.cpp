@@ -0,0 +1,164 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+
+#include "ThreadTelemetrySampler.h"
+#include "AllocationCounter.h"
+#include "TraceModule.h"
+#include <atomic>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+namespace
+{
+void
+busyLoop( void *data )
+{
+    auto *stop = static_cast<std::atomic<bool> *>( data );
+    while ( !stop->load() )
+    {
+    }
+}
+
+void
+allocatingLoop( void *data )
+{
+    auto *stop = static_cast<std::atomic<bool> *>( data );
+    while ( !stop->load() )
+    {
+        auto *pointer = ::operator new( 16 );
+        ::operator delete( pointer );
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+}
+} // namespace
+
+/**
+ * @brief Validates that the CPU time of a busy thread and the occupancy of a queue are sampled and set in the
+ * TraceModule, and that the variables of an exited thread are removed
+ */
+TEST( ThreadTelemetrySamplerTest, SampleThreadsAndQueues )
+{
+    ThreadTelemetrySampler sampler( 100 );
+    size_t occupancy = 7;
+    sampler.registerQueue( "TestQueue", [&occupancy]() { return occupancy; } );
+
+    std::atomic<bool> stop{ false };
+    Thread busyThread;
+    ASSERT_TRUE( busyThread.create( busyLoop, &stop, "fwTestBusy" ) );
+    // The thread names itself after it started
+    std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+    ASSERT_TRUE( sampler.sample() );
+    // The first sample only sets the baseline
+    ASSERT_TRUE( sampler.getThreadSamples().empty() );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 300 ) );
+    ASSERT_TRUE( sampler.sample() );
+
+    ThreadTelemetrySampler::ThreadSample busySample;
+    for ( const auto &sample : sampler.getThreadSamples() )
+    {
+        if ( sample.threadName == "fwTestBusy" )
+        {
+            busySample = sample;
+        }
+    }
+    ASSERT_NE( busySample.threadId, 0 );
+    // Even on a loaded single core the thread gets a part of the 300 ms
+    ASSERT_GT( busySample.cpuTimeUs, 10000 );
+    auto name = "fwTestBusy_" + std::to_string( busySample.threadId );
+    ASSERT_EQ( TraceModule::get().getNamedVariable( "threadCpuTimeUs_" + name ),
+               static_cast<int64_t>( busySample.cpuTimeUs ) );
+    ASSERT_EQ( sampler.getQueueOccupancy( "TestQueue" ), 7 );
+    ASSERT_EQ( TraceModule::get().getNamedVariable( "queueOccupancy_TestQueue" ), 7 );
+
+    occupancy = 0;
+    stop = true;
+    busyThread.release();
+    // Exited threads are noticed by the failing read, and removed with the scan of the next sample
+    ASSERT_TRUE( sampler.sample() );
+    ASSERT_TRUE( sampler.sample() );
+    ASSERT_EQ( TraceModule::get().getNamedVariable( "threadCpuTimeUs_" + name ), 0 );
+    ASSERT_EQ( TraceModule::get().getNamedVariable( "queueOccupancy_TestQueue" ), 0 );
+    for ( const auto &sample : sampler.getThreadSamples() )
+    {
+        ASSERT_NE( sample.threadId, busySample.threadId );
+    }
+}
+
+/**
+ * @brief Validates that the allocations per second are reported for an allocating thread and are 0 for a thread
+ * that does not allocate
+ */
+TEST( ThreadTelemetrySamplerTest, SampleAllocations )
+{
+    if ( !AllocationCounter::isEnabled() )
+    {
+        GTEST_SKIP() << "Built without FWE_ALLOCATION_COUNTING";
+    }
+    ThreadTelemetrySampler sampler( 100 );
+    std::atomic<bool> stop{ false };
+    Thread busyThread;
+    Thread allocatingThread;
+    ASSERT_TRUE( busyThread.create( busyLoop, &stop, "fwTestBusy" ) );
+    ASSERT_TRUE( allocatingThread.create( allocatingLoop, &stop, "fwTestAlloc" ) );
+    // The threads name themselves after they started
+    std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+    ASSERT_TRUE( sampler.sample() );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 300 ) );
+    ASSERT_TRUE( sampler.sample() );
+
+    ThreadTelemetrySampler::ThreadSample busySample;
+    ThreadTelemetrySampler::ThreadSample allocatingSample;
+    for ( const auto &sample : sampler.getThreadSamples() )
+    {
+        if ( sample.threadName == "fwTestBusy" )
+        {
+            busySample = sample;
+        }
+        else if ( sample.threadName == "fwTestAlloc" )
+        {
+            allocatingSample = sample;
+        }
+    }
+    ASSERT_NE( busySample.threadId, 0 );
+    ASSERT_NE( allocatingSample.threadId, 0 );
+    ASSERT_EQ( busySample.allocations, 0 );
+    ASSERT_GT( allocatingSample.allocations, 0 );
+    ASSERT_EQ( TraceModule::get().getNamedVariable( "threadAllocationsPerSecond_fwTestBusy_" +
+                                                    std::to_string( busySample.threadId ) ),
+               0 );
+    ASSERT_GT( TraceModule::get().getNamedVariable( "threadAllocationsPerSecond_fwTestAlloc_" +
+                                                    std::to_string( allocatingSample.threadId ) ),
+               0 );
+    stop = true;
+    busyThread.release();
+    allocatingThread.release();
+}
+
+/**
+ * @brief Validates that the sampling thread starts and stops
+ */
+TEST( ThreadTelemetrySamplerTest, StartStop )
+{
+    ThreadTelemetrySampler sampler( 10 );
+    ASSERT_TRUE( sampler.start() );
+    ASSERT_TRUE( sampler.isAlive() );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 100 ) );
+    ASSERT_TRUE( sampler.stop() );
+    ASSERT_FALSE( sampler.isAlive() );
+    // At least the main thread and the sampling thread itself were sampled
+    ASSERT_GE( sampler.getThreadSamples().size(), 2 );
+}
@@ -0,0 +1,192 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace Platform
+{
+namespace Linux
+{
+/**
+ * @brief Blocking multi producer/multi consumer queue with a fixed capacity.
+ *
+ * Connects the stages of a pipeline: producers block in push() while the queue is full, which throttles them to
+ * the speed of the consumers, and consumers block in pop() while the queue is empty. Unlike the lock free queues
+ * the elements do not need to be trivially copyable, so shared pointers can be handed over. After close() no
+ * more elements are accepted, waiting threads wake up and the remaining elements can still be popped.
+ */
+template <typename T>
+class BoundedQueue
+{
+public:
+    /**
+     * @param capacity maximum number of queued elements, at least 1
+     */
+    explicit BoundedQueue( size_t capacity )
+        : mCapacity( ( capacity > 0U ) ? capacity : 1U )
+    {
+    }
+
+    BoundedQueue( const BoundedQueue & ) = delete;
+    BoundedQueue &operator=( const BoundedQueue & ) = delete;
+    BoundedQueue( BoundedQueue && ) = delete;
+    BoundedQueue &operator=( BoundedQueue && ) = delete;
+
+    /**
+     * @brief Appends an element, waiting while the queue is full
+     * @return False if the queue was closed, the element is then dropped
+     */
+    bool
+    push( T element )
+    {
+        std::unique_lock<std::mutex> lock( mMutex );
+        mNotFull.wait( lock, [this]() { return mClosed || ( mElements.size() < mCapacity ); } );
+        if ( mClosed )
+        {
+            return false;
+        }
+        mElements.push_back( std::move( element ) );
+        lock.unlock();
+        mNotEmpty.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Appends an element if there is space left, without waiting
+     * @return False if the queue is full or closed
+     */
+    bool
+    tryPush( T &element )
+    {
+        {
+            std::lock_guard<std::mutex> lock( mMutex );
+            if ( mClosed || ( mElements.size() >= mCapacity ) )
+            {
+                return false;
+            }
+            mElements.push_back( std::move( element ) );
+        }
+        mNotEmpty.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Removes the oldest element, waiting while the queue is empty
+     * @return False if the queue is closed and empty
+     */
+    bool
+    pop( T &element )
+    {
+        std::unique_lock<std::mutex> lock( mMutex );
+        mNotEmpty.wait( lock, [this]() { return mClosed || ( !mElements.empty() ); } );
+        if ( mElements.empty() )
+        {
+            return false;
+        }
+        element = std::move( mElements.front() );
+        mElements.pop_front();
+        lock.unlock();
+        mNotFull.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Removes the oldest element, waiting at most the timeout while the queue is empty
+     * @return False if no element arrived within the timeout or the queue is closed and empty
+     */
+    bool
+    pop( T &element, uint32_t timeoutMs )
+    {
+        std::unique_lock<std::mutex> lock( mMutex );
+        mNotEmpty.wait_for(
+            lock, std::chrono::milliseconds( timeoutMs ), [this]() { return mClosed || ( !mElements.empty() ); } );
+        if ( mElements.empty() )
+        {
+            return false;
+        }
+        element = std::move( mElements.front() );
+        mElements.pop_front();
+        lock.unlock();
+        mNotFull.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Rejects further elements and wakes up all waiting threads
+     */
+    void
+    close()
+    {
+        {
+            std::lock_guard<std::mutex> lock( mMutex );
+            mClosed = true;
+        }
+        mNotFull.notify_all();
+        mNotEmpty.notify_all();
+    }
+
+    /**
+     * @brief Accepts elements again after close(), the queue must be empty
+     */
+    void
+    reopen()
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        mClosed = false;
+    }
+
+    bool
+    isClosed() const
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        return mClosed;
+    }
+
+    size_t
+    size() const
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        return mElements.size();
+    }
+
+    size_t
+    capacity() const
+    {
+        return mCapacity;
+    }
+
+private:
+    const size_t mCapacity;
+    mutable std::mutex mMutex;
+    std::condition_variable mNotFull;
+    std::condition_variable mNotEmpty;
+    std::deque<T> mElements;
+    bool mClosed{ false };
+};
+
+} // namespace Linux
+} // namespace Platform
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -0,0 +1,198 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "FastClock.h"
+#include "TraceModule.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace Platform
+{
+namespace Linux
+{
+/**
+ * @brief What is counted per named mutex
+ */
+enum class MutexCounter : uint8_t
+{
+    ACQUISITIONS = 0, // successful locks
+    CONTENDED,        // locks which had to wait because the mutex was held
+    WAIT_TIME_US,     // time the contended locks waited
+    MUTEX_COUNTER_SIZE
+};
+
+/**
+ * @brief Process wide contention statistics of the InstrumentedMutex instances, per mutex name
+ *
+ * All mutexes constructed with the same name share one entry, e.g. the decoder dictionary mutexes of all CAN
+ * consumers. The counters are relaxed atomics, only looking up an entry by name takes a lock, which is done once
+ * per mutex on construction.
+ *
+ * The counting is compiled in with FWE_MUTEX_CONTENTION_TRACING and enabled at runtime with setEnabled. While it
+ * is disabled a lock costs one relaxed load more than a std::mutex.
+ *
+ * forwardToMetricsReceiver reports the counters of the period since its previous call, so the RemoteProfiler sends
+ * the contention per metrics upload interval.
+ */
+class MutexContention
+{
+public:
+    static MutexContention &get();
+
+    /**
+     * @brief Returns true if the build counts the contention, i.e. was built with FWE_MUTEX_CONTENTION_TRACING
+     */
+    static bool isCompiledIn();
+
+    void
+    setEnabled( bool enabled )
+    {
+        mEnabled.store( enabled && isCompiledIn(), std::memory_order_relaxed );
+    }
+
+    bool
+    isEnabled() const
+    {
+        return mEnabled.load( std::memory_order_relaxed );
+    }
+
+    /**
+     * @brief Returns the entry of a mutex name, creating it on first use
+     * @param name the name of the mutex
+     * @return the entry ID, INVALID_MUTEX_ID if all entries are in use
+     */
+    uint32_t getMutexId( const std::string &name );
+
+    void
+    add( uint32_t mutexId, MutexCounter counter, uint64_t value )
+    {
+        if ( ( mutexId < MAX_MUTEXES ) && ( counter < MutexCounter::MUTEX_COUNTER_SIZE ) )
+        {
+            mEntries[mutexId].mCounters[static_cast<uint8_t>( counter )].fetch_add( value,
+                                                                                   std::memory_order_relaxed );
+        }
+    }
+
+    /**
+     * @brief Total of a counter of a mutex name since startup
+     */
+    uint64_t getTotal( uint32_t mutexId, MutexCounter counter ) const;
+
+    /**
+     * @brief Calls for every mutex name acquired in the period the receiver->setMetric with the counters of the
+     * period since the previous call
+     *
+     * The names are mutexAcquisitions_<name>, mutexContended_<name> and mutexWaitTimeUs_<name>.
+     */
+    void forwardToMetricsReceiver( IMetricsReceiver *receiver );
+
+    static constexpr uint32_t MAX_MUTEXES = 64;
+    static constexpr uint32_t INVALID_MUTEX_ID = MAX_MUTEXES;
+
+private:
+    static constexpr size_t COUNTER_COUNT = static_cast<size_t>( MutexCounter::MUTEX_COUNTER_SIZE );
+
+    struct Entry
+    {
+        std::atomic<uint64_t> mCounters[COUNTER_COUNT]{};
+        uint64_t mReported[COUNTER_COUNT]{}; // totals at the previous forwardToMetricsReceiver
+        std::string mName;
+    };
+
+    std::atomic<bool> mEnabled{ false };
+    std::mutex mMutex;
+    uint32_t mMutexCount{ 0 };
+    Entry mEntries[MAX_MUTEXES];
+};
+
+/**
+ * @brief A std::mutex which counts its acquisitions, contended acquisitions and wait time under its name in the
+ * MutexContention statistics. Can be used with std::lock_guard and std::unique_lock.
+ */
+class InstrumentedMutex
+{
+public:
+    explicit InstrumentedMutex( const std::string &name )
+        : mMutexId( MutexContention::get().getMutexId( name ) )
+    {
+    }
+
+    InstrumentedMutex( const InstrumentedMutex & ) = delete;
+    InstrumentedMutex &operator=( const InstrumentedMutex & ) = delete;
+    InstrumentedMutex( InstrumentedMutex && ) = delete;
+    InstrumentedMutex &operator=( InstrumentedMutex && ) = delete;
+    ~InstrumentedMutex() = default;
+
+    void
+    lock()
+    {
+#if defined( FWE_MUTEX_CONTENTION_TRACING )
+        auto &contention = MutexContention::get();
+        if ( contention.isEnabled() )
+        {
+            // Only a lock that could not be taken right away is timed
+            if ( !mMutex.try_lock() )
+            {
+                auto startUs = FastClock::monotonicTimeUs();
+                mMutex.lock();
+                contention.add( mMutexId, MutexCounter::WAIT_TIME_US, FastClock::monotonicTimeUs() - startUs );
+                contention.add( mMutexId, MutexCounter::CONTENDED, 1 );
+            }
+            contention.add( mMutexId, MutexCounter::ACQUISITIONS, 1 );
+            return;
+        }
+#endif
+        mMutex.lock();
+    }
+
+    bool
+    try_lock()
+    {
+        if ( !mMutex.try_lock() )
+        {
+            return false;
+        }
+#if defined( FWE_MUTEX_CONTENTION_TRACING )
+        auto &contention = MutexContention::get();
+        if ( contention.isEnabled() )
+        {
+            contention.add( mMutexId, MutexCounter::ACQUISITIONS, 1 );
+        }
+#endif
+        return true;
+    }
+
+    void
+    unlock()
+    {
+        mMutex.unlock();
+    }
+
+private:
+    std::mutex mMutex;
+    uint32_t mMutexId;
+};
+
+} // namespace Linux
+} // namespace Platform
+} // namespace IoTFleetWise
+} // namespace Aws
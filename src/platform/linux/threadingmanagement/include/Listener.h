@@ -14,7 +14,12 @@
 #pragma once
 
 // Includes
+#include "InstrumentedMutex.h"
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iterator>
+#include <memory>
 #include <mutex>
 #include <vector>
 namespace Aws
@@ -27,6 +32,11 @@ namespace Linux
 {
 /**
  * @brief Template utility implementing a thread safe Subject/Observer design pattern.
+ *
+ * The listeners are kept in an immutable snapshot which is replaced as a whole on subscribe and unsubscribe,
+ * so notifying does not take a lock. Notifications running while a listener is added or removed still invoke
+ * the snapshot they started with. Replaced snapshots are freed on a later modification once no notification
+ * is running anymore, or in the destructor.
  */
 template <typename ThreadListener>
 class ThreadListeners
@@ -37,11 +47,15 @@ private:
     using CallBackFunction = void ( ThreadListener::* )( Args... );
 
 public:
-    ThreadListeners() = default;
+    ThreadListeners()
+        : mContainer( new ListenerContainer() )
+    {
+    }
     virtual ~ThreadListeners()
     {
         MutexLock lock( mMutex );
-        mContainer.clear();
+        delete mContainer.load();
+        freeRetiredContainers();
     }
     ThreadListeners( const ThreadListeners & ) = delete;
     ThreadListeners &operator=( const ThreadListeners & ) = delete;
@@ -59,18 +73,15 @@ public:
     {
         MutexLock lock( mMutex );
 
-        ListenerContainer &container = getContainer();
-        const auto &containerIterator = std::find( container.begin(), container.end(), listener );
-        if ( containerIterator == container.end() )
-        {
-            container.emplace_back( listener );
-            mModified = mCopied;
-            return true;
-        }
-        else
+        const ListenerContainer &container = *mContainer.load();
+        if ( std::find( container.begin(), container.end(), listener ) != container.end() )
         {
             return false;
         }
+        std::unique_ptr<ListenerContainer> newContainer( new ListenerContainer( container ) );
+        newContainer->emplace_back( listener );
+        replaceContainer( std::move( newContainer ) );
+        return true;
     }
 
     /**
@@ -84,18 +95,19 @@ public:
     {
         MutexLock lock( mMutex );
 
-        ListenerContainer &container = getContainer();
-        const auto &containerIterator = std::find( container.begin(), container.end(), listener );
-        if ( containerIterator != container.end() )
-        {
-            container.erase( containerIterator );
-            mModified = mCopied;
-            return true;
-        }
-        else
+        const ListenerContainer &container = *mContainer.load();
+        if ( std::find( container.begin(), container.end(), listener ) == container.end() )
         {
             return false;
         }
+        std::unique_ptr<ListenerContainer> newContainer( new ListenerContainer() );
+        newContainer->reserve( container.size() - 1U );
+        std::copy_if( container.begin(),
+                      container.end(),
+                      std::back_inserter( *newContainer ),
+                      [listener]( ThreadListener *subscribed ) { return subscribed != listener; } );
+        replaceContainer( std::move( newContainer ) );
+        return true;
     }
 
     /**
@@ -105,11 +117,9 @@ public:
     void
     notifyListeners( CallBackFunction<Args...> callBackFunction, Args... args ) const
     {
-        MutexLock lock( mMutex );
+        ReaderGuard guard( mReaders );
 
-        ContainerInvocationState state( this );
-
-        for ( const auto &listener : mContainer )
+        for ( const auto &listener : *mContainer.load() )
         {
             ( ( listener )->*callBackFunction )( args... );
         }
@@ -121,95 +131,70 @@ public:
     size_t
     size() const
     {
-        MutexLock lock( mMutex );
+        ReaderGuard guard( mReaders );
 
-        return mContainer.size();
+        return mContainer.load()->size();
     }
 
 private:
     // Container to store the list of listeners to this thread
     using ListenerContainer = std::vector<ThreadListener *>;
-    // Mutex to protect the storage from concurrent reads and writes
-    using MutexLock = std::lock_guard<std::mutex>;
-    // Container for all listeners registered.
-    mutable ListenerContainer mContainer;
-    // Temporary container used during modification via subscribe/unsubscribe
-    mutable ListenerContainer mTemporaryContainer;
-    // Container state coordinating local swaps of the listener container
-    // Active flag is set when Listener callbacks are being executed
-    mutable bool mActive{ false };
-    // Copied flag is set when the Listener Container is being backed up successfully after an invocation
-    mutable bool mCopied{ false };
-    // Modified flag is set when the Listener Container is being modified ( when a listener callback
-    // is either added or removed.
-    mutable bool mModified{ false };
-    mutable typename std::mutex mMutex;
-
-    // Manages the container storing the listeners in a way that
-    // callback invocations is eventually consistent.
-    struct ContainerInvocationState
+    // Mutex serializing subscribe and unsubscribe
+    using MutexLock = std::lock_guard<InstrumentedMutex>;
+
+    // Counts a running notification for the lifetime of the guard
+    struct ReaderGuard
     {
-        ContainerInvocationState( ThreadListeners const *currentState )
-            : mPreviousState( currentState->mActive )
-            , mOriginalContainer( currentState )
+        explicit ReaderGuard( std::atomic<uint32_t> &readers )
+            : mReaders( readers )
         {
-            currentState->mActive = true;
+            mReaders.fetch_add( 1 );
         }
 
-        ~ContainerInvocationState()
+        ~ReaderGuard()
         {
-            mOriginalContainer->mActive = mPreviousState;
-
-            if ( !mOriginalContainer->mActive )
-            {
-                mOriginalContainer->backupContainer();
-            }
+            mReaders.fetch_sub( 1 );
         }
 
-        ContainerInvocationState( const ContainerInvocationState & ) = delete;
-        ContainerInvocationState &operator=( const ContainerInvocationState & ) = delete;
-        ContainerInvocationState( ContainerInvocationState && ) = delete;
-        ContainerInvocationState &operator=( ContainerInvocationState && ) = delete;
+        ReaderGuard( const ReaderGuard & ) = delete;
+        ReaderGuard &operator=( const ReaderGuard & ) = delete;
+        ReaderGuard( ReaderGuard && ) = delete;
+        ReaderGuard &operator=( ReaderGuard && ) = delete;
 
     private:
-        bool mPreviousState;
-        ThreadListeners const *mOriginalContainer;
+        std::atomic<uint32_t> &mReaders;
     };
 
-    ListenerContainer &
-    getContainer()
+    // Has to be called with mMutex held
+    void
+    replaceContainer( std::unique_ptr<ListenerContainer> newContainer )
     {
-        if ( mModified )
-        {
-            return mTemporaryContainer;
-        }
-        if ( mActive )
+        mRetiredContainers.emplace_back( mContainer.exchange( newContainer.release() ) );
+        // A notification starting after the exchange can only load the new snapshot. Both are sequentially
+        // consistent, so if no notification is counted here, none can still be using a retired snapshot.
+        if ( mReaders.load() == 0U )
         {
-            mModified = true;
-            mCopied = true;
-            mTemporaryContainer = mContainer;
-
-            return mTemporaryContainer;
+            freeRetiredContainers();
         }
-        return mContainer;
     }
 
     void
-    backupContainer() const
+    freeRetiredContainers()
     {
-
-        if ( mCopied )
+        for ( auto *container : mRetiredContainers )
         {
-            if ( mModified )
-            {
-                mContainer = mTemporaryContainer;
-                mModified = false;
-            }
-
-            mTemporaryContainer.clear();
-            mCopied = false;
+            delete container;
         }
+        mRetiredContainers.clear();
     }
+
+    // Current snapshot of all listeners registered, never nullptr
+    std::atomic<ListenerContainer *> mContainer;
+    // Number of notifications currently iterating a snapshot
+    mutable std::atomic<uint32_t> mReaders{ 0 };
+    // Replaced snapshots that may still be iterated by a running notification
+    std::vector<ListenerContainer *> mRetiredContainers;
+    InstrumentedMutex mMutex{ "ThreadListeners" };
 };
 
 } // namespace Linux
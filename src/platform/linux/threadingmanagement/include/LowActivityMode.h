@@ -0,0 +1,189 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+#if defined( IOTFLEETWISE_LINUX )
+// Includes
+#include "ClockHandler.h"
+#include "LoggingModule.h"
+#include "Signal.h"
+#include "TimeTypes.h"
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace Platform
+{
+namespace Linux
+{
+
+/**
+ * @brief Process wide power saving state for a parked vehicle.
+ *
+ * The mode is entered when no bus traffic was seen for a while or the ignition signal reports off, and left with the
+ * next bus traffic, ignition on or message from the cloud. While it is active the threads of the data pipeline:
+ * - park instead of polling on their idle timers, as only bus traffic or a cloud message can give them work,
+ * - round the remaining real deadlines up to a common tick, so that all threads wake up together,
+ * - run with a larger timer slack, so that the kernel can coalesce their wakeups with other timers.
+ * Threads that are not woken up by bus traffic or a cloud message themselves register their Signal, it is notified
+ * when the mode is left.
+ */
+class LowActivityMode
+{
+public:
+    struct Config
+    {
+        uint32_t busSilenceTimeMs{ 0 };   /**< bus silence after which the mode is entered, 0 to not enter on silence */
+        uint32_t ignitionSignalId{ INVALID_IGNITION_SIGNAL_ID }; /**< signal whose value 0 means ignition off */
+        uint32_t wakeupTickMs{ DEFAULT_WAKEUP_TICK_MS };         /**< the deadlines are rounded up to this tick */
+        uint64_t timerSlackNs{ DEFAULT_TIMER_SLACK_NS };          /**< timer slack of the threads in the mode */
+    };
+
+    static constexpr uint32_t INVALID_IGNITION_SIGNAL_ID = std::numeric_limits<uint32_t>::max();
+    static constexpr uint32_t DEFAULT_WAKEUP_TICK_MS = 1000;
+    static constexpr uint64_t DEFAULT_TIMER_SLACK_NS = 100000000;
+    // Bus traffic is only recorded if the last recorded traffic is older, so that the data sources of all
+    // channels do not write the shared timestamp for every frame
+    static constexpr Timestamp BUS_ACTIVITY_GRANULARITY_MS = 100;
+
+    static LowActivityMode &get();
+
+    LowActivityMode() = default;
+    ~LowActivityMode() = default;
+
+    LowActivityMode( const LowActivityMode & ) = delete;
+    LowActivityMode &operator=( const LowActivityMode & ) = delete;
+    LowActivityMode( LowActivityMode && ) = delete;
+    LowActivityMode &operator=( LowActivityMode && ) = delete;
+
+    /**
+     * @brief Enables the mode. Has to be called before the threads of the data pipeline start.
+     * @return False if the config is invalid
+     */
+    bool init( const Config &config );
+
+    inline bool
+    isEnabled() const
+    {
+        return mEnabled;
+    }
+
+    inline bool
+    isActive() const
+    {
+        return mActive.load( std::memory_order_relaxed );
+    }
+
+    inline uint32_t
+    getIgnitionSignalId() const
+    {
+        return mConfig.ignitionSignalId;
+    }
+
+    /**
+     * @brief Records bus traffic and leaves the mode. Called by the data consumers for every frame, costs a relaxed
+     * atomic load if nothing changes.
+     * @param receiveTime time the frame was received, milliseconds since epoch
+     */
+    inline void
+    onBusActivity( Timestamp receiveTime )
+    {
+        if ( !mEnabled )
+        {
+            return;
+        }
+        if ( receiveTime >= mLastBusActivity.load( std::memory_order_relaxed ) + BUS_ACTIVITY_GRANULARITY_MS )
+        {
+            mLastBusActivity.store( receiveTime, std::memory_order_relaxed );
+        }
+        if ( isActive() && ( !mIgnitionOff.load( std::memory_order_relaxed ) ) )
+        {
+            leave( "bus traffic" );
+        }
+    }
+
+    /**
+     * @brief Enters the mode on ignition off and leaves it on ignition on
+     */
+    void onIgnition( bool on );
+
+    /**
+     * @brief Leaves the mode, a message from the cloud might have to be processed by all threads
+     */
+    void onCloudMessage();
+
+    /**
+     * @brief Enters the mode if no bus traffic was recorded for the configured time. Called by the idle data
+     * consumers before they wait.
+     */
+    void checkBusSilence();
+
+    /**
+     * @brief Returns the time an idle thread waits whose wakeup is only a poll for new work
+     * @param idleTimeMs the time to wait outside the mode
+     * @return Signal::WaitWithPredicate while the mode is active
+     */
+    uint32_t getIdleWaitTimeMs( uint32_t idleTimeMs );
+
+    /**
+     * @brief Returns the time a thread waits for its next real deadline, e.g. a pending collection
+     * @param deadlineMs time until the deadline, std::numeric_limits<uint32_t>::max() if there is none
+     * @param idleTimeMs the time to wait outside the mode if there is no earlier deadline
+     * @return the time until the first tick at or after the deadline while the mode is active, else the minimum of
+     * deadline and idle time
+     */
+    uint32_t getDeadlineWaitTimeMs( uint32_t deadlineMs, uint32_t idleTimeMs );
+
+    /**
+     * @brief Registers the Signal of a thread that has to be woken up when the mode is left
+     */
+    void addWakeUpSignal( Signal &signal );
+    void removeWakeUpSignal( Signal &signal );
+
+    /**
+     * @brief Disables the mode again. Only for tests.
+     */
+    void reset();
+
+private:
+    void enter( const std::string &reason );
+    void leave( const std::string &reason );
+    // Sets the timer slack of the calling thread if the mode changed since the thread set it last
+    void updateTimerSlack();
+
+    LoggingModule mLogger;
+    std::shared_ptr<const Clock> mClock = ClockHandler::getClock();
+    Config mConfig;
+    bool mEnabled{ false };
+    std::atomic<bool> mActive{ false };
+    std::atomic<bool> mIgnitionOff{ false };
+    std::atomic<Timestamp> mLastBusActivity{ 0 };
+    // Incremented on every change of the mode, so that threads know when to update their timer slack
+    std::atomic<uint32_t> mGeneration{ 0 };
+    std::mutex mMutex;
+    std::vector<Signal *> mWakeUpSignals;
+};
+
+} // namespace Linux
+} // namespace Platform
+} // namespace IoTFleetWise
+} // namespace Aws
+#endif // IOTFLEETWISE_LINUX
@@ -0,0 +1,163 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+#include "LoggingModule.h"
+#include "Thread.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace Platform
+{
+namespace Linux
+{
+
+enum class RetryStatus
+{
+    SUCCESS,
+    RETRY,
+    ABORT
+};
+
+class IRetryable
+{
+public:
+    /**
+     * @brief This function will be called for every retry
+     * @return decides if the function can be retried later or succeeded or unrecoverable failed
+     */
+    virtual RetryStatus attempt() = 0;
+
+    /**
+     * @brief Is called after the retries stopped which means it succeeded or is aborted
+     * @param code signals how it finished: if it was aborted or succeeded. retry should be never observed here
+     */
+    virtual void onFinished( RetryStatus code ) = 0;
+    virtual ~IRetryable() = default;
+};
+
+/**
+ * @brief Runs the attempts of all retryables on a few shared worker threads instead of one thread per retryable
+ *
+ * The due attempts are kept in a timer heap. The first attempt runs right away, after each RETRY the next one is due
+ * after an exponential backoff from the start backoff up to the max backoff. The backoff is randomized between half
+ * and the full value, so that the reconnects of many vehicles after an outage do not synchronize.
+ *
+ * An attempt may block, e.g. while waiting for a connection, so WORKER_COUNT attempts can run at the same time. The
+ * workers are started with the first scheduled retryable. The class is a Singleton and thread safe.
+ */
+class RetryScheduler
+{
+public:
+    static constexpr size_t WORKER_COUNT = 2;
+
+    using RetryId = uint64_t;
+
+    static RetryScheduler &getInstance();
+
+    /**
+     * @brief Schedules the first attempt of the retryable right away
+     * @return id to cancel the retries, 0 if the workers could not be started
+     */
+    RetryId schedule( IRetryable &retryable, uint32_t startBackoffMs, uint32_t maxBackoffMs );
+
+    /**
+     * @brief Stops the retries. If they did not finish yet, onFinished( ABORT ) is called. Waits for a running attempt
+     *        to complete, unless called from that attempt
+     */
+    void cancel( RetryId id );
+
+    /**
+     * @brief Checks if the retries did not finish yet
+     */
+    bool isScheduled( RetryId id );
+
+    /**
+     * @brief Randomizes the backoff between half and the full value
+     */
+    uint32_t getJitteredBackoffMs( uint32_t backoffMs );
+
+    ~RetryScheduler();
+
+    RetryScheduler( const RetryScheduler & ) = delete;
+    RetryScheduler &operator=( const RetryScheduler & ) = delete;
+    RetryScheduler( RetryScheduler && ) = delete;
+    RetryScheduler &operator=( RetryScheduler && ) = delete;
+
+private:
+    RetryScheduler();
+
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+    struct Retry
+    {
+        IRetryable *mRetryable{ nullptr };
+        uint32_t mMaxBackoffMs{ 0 };
+        uint32_t mBackoffMs{ 0 };
+        TimePoint mDueTime;
+        bool mRunning{ false };
+        bool mCancelled{ false };
+        std::thread::id mWorker;
+    };
+
+    using DueRetry = std::pair<TimePoint, RetryId>;
+
+    /**
+     * @brief Starts the workers if not done yet. Must be called with mMutex held
+     */
+    bool startWorkers();
+
+    uint32_t getJitteredBackoffMsLocked( uint32_t backoffMs );
+
+    static void doWork( void *data );
+
+    /**
+     * @brief Runs an attempt and schedules the next one or finishes the retries. Called with the lock held, which is
+     *        released during the callbacks
+     */
+    void runAttempt( std::unique_lock<std::mutex> &lock, RetryId id, Retry &retry );
+
+    std::mutex mMutex;
+    std::condition_variable mWakeUp;
+    std::condition_variable mRetryDone;
+    std::map<RetryId, Retry> mRetries;
+    std::priority_queue<DueRetry, std::vector<DueRetry>, std::greater<DueRetry>> mDueRetries;
+    RetryId mNextId{ 1 };
+    std::minstd_rand mRandom;
+
+    std::array<Thread, WORKER_COUNT> mWorkers;
+    bool mWorkersStarted{ false };
+    std::atomic<bool> mShouldStop{ false };
+    LoggingModule mLogger;
+};
+
+} // namespace Linux
+} // namespace Platform
+} // namespace IoTFleetWise
+} // namespace Aws
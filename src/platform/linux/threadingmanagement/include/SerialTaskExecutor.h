@@ -0,0 +1,183 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "LoggingModule.h"
+#include "Thread.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace Platform
+{
+namespace Linux
+{
+
+/**
+ * @brief Runs the tasks of many sources on a few shared worker threads
+ *
+ * Each source posts its tasks to its own queue. The tasks of one queue run one after the other in the order they
+ * were posted, tasks of different queues run in parallel on the workers. A queue with pending tasks gets one worker
+ * for one task at a time and is then put back behind the other ready queues, so a busy source does not starve the
+ * others. An idle queue costs no thread. Posting never blocks: a full queue rejects the task, so that a task can
+ * post to its own or another queue without waiting for a worker.
+ *
+ * A task can also be posted with a delay, the workers then wait for the earliest delayed task instead of a source
+ * sleeping on its own thread. A periodic source posts its next run from its task, so many periodic sources share the
+ * workers. Removing a queue or stopping the executor drops its delayed tasks without waiting for them.
+ */
+class SerialTaskExecutor
+{
+public:
+    using Task = std::function<void()>;
+    using QueueId = uint32_t;
+
+    static constexpr QueueId INVALID_QUEUE_ID = 0U;
+    static constexpr size_t DEFAULT_QUEUE_CAPACITY = 16;
+
+    /**
+     * @param workerCount number of worker threads, at least 1
+     * @param threadName  prefix of the names of the worker threads
+     */
+    explicit SerialTaskExecutor( uint32_t workerCount, std::string threadName = "fwTaskExec" );
+    ~SerialTaskExecutor();
+
+    SerialTaskExecutor( const SerialTaskExecutor & ) = delete;
+    SerialTaskExecutor &operator=( const SerialTaskExecutor & ) = delete;
+    SerialTaskExecutor( SerialTaskExecutor && ) = delete;
+    SerialTaskExecutor &operator=( SerialTaskExecutor && ) = delete;
+
+    /**
+     * @brief Starts the worker threads
+     * @return True if all threads are running
+     */
+    bool start();
+
+    /**
+     * @brief Runs the pending tasks of all queues and stops the threads. Tasks posted meanwhile are rejected.
+     * @return True if all threads stopped
+     */
+    bool stop();
+
+    bool isAlive();
+
+    /**
+     * @brief Creates a queue whose tasks run one after the other
+     * @param capacity maximum number of tasks waiting in the queue, at least 1
+     * @return the id of the queue
+     */
+    QueueId createQueue( size_t capacity = DEFAULT_QUEUE_CAPACITY );
+
+    /**
+     * @brief Rejects further tasks of the queue, waits until its pending and running tasks are done and removes it.
+     * Must not be called from a task of the queue.
+     */
+    void removeQueue( QueueId queueId );
+
+    /**
+     * @brief Appends a task to the queue, without waiting
+     * @return False if the queue is full or removed or the executor is stopped, the task is then not run
+     */
+    bool post( QueueId queueId, Task task );
+
+    /**
+     * @brief Appends a task to the queue once the delay elapsed, without waiting. The delayed task does not count
+     * against the capacity of the queue, so a periodic task is not lost because the queue was full at that time.
+     * @return False if the queue is removed or the executor is stopped, the task is then not run
+     */
+    bool postAfter( QueueId queueId, uint32_t delayMs, Task task );
+
+    /**
+     * @return the number of tasks of the queue that did not start yet
+     */
+    size_t getPendingTaskCount( QueueId queueId ) const;
+
+    /**
+     * @return the capacity of the queue, 0 if it does not exist
+     */
+    size_t getQueueCapacity( QueueId queueId ) const;
+
+    uint32_t
+    getWorkerCount() const
+    {
+        return static_cast<uint32_t>( mWorkers.size() );
+    }
+
+private:
+    struct Queue
+    {
+        std::deque<Task> mTasks;
+        size_t mCapacity{ 0 };
+        // In the ready list or a task is running, so the queue is not scheduled twice
+        bool mScheduled{ false };
+        bool mRunning{ false };
+        bool mRemoved{ false };
+    };
+
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+    struct Worker
+    {
+        SerialTaskExecutor *mExecutor{ nullptr };
+        Thread mThread;
+    };
+
+    static void doWork( void *data );
+
+    /**
+     * @brief Appends the task and puts the queue into the ready list if it is not scheduled yet. Must be called with
+     * mMutex held.
+     * @return True if a worker has to be woken up
+     */
+    bool enqueue( QueueId queueId, Queue &queue, Task task );
+
+    /**
+     * @brief Moves the delayed tasks that are due to their queues. Must be called with mMutex held.
+     */
+    void enqueueDueTasks();
+
+    mutable std::mutex mMutex;
+    std::condition_variable mWakeUp;
+    std::condition_variable mQueueIdle;
+    std::map<QueueId, Queue> mQueues;
+    std::deque<QueueId> mReadyQueues;
+    // Ordered by due time, tasks with the same due time keep the order they were posted in
+    std::multimap<TimePoint, std::pair<QueueId, Task>> mDelayedTasks;
+    QueueId mNextQueueId{ INVALID_QUEUE_ID + 1U };
+    bool mAccepting{ false };
+    bool mShouldStop{ false };
+    std::vector<std::unique_ptr<Worker>> mWorkers;
+    std::string mThreadName;
+    std::mutex mThreadMutex;
+    LoggingModule mLogger;
+};
+
+} // namespace Linux
+} // namespace Platform
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -16,9 +16,15 @@
 // Includes
 
 #include <atomic>
+#include <cerrno>
 #include <chrono>
-#include <condition_variable>
+#include <cstdint>
+#include <ctime>
+#include <linux/futex.h>
 #include <mutex>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
 
 namespace Aws
 {
@@ -29,68 +35,165 @@ namespace Platform
 namespace Linux
 {
 /**
- * @brief Wrapper on top of a condition variable. Helps Thread state transitions.
+ * @brief Wakeup signal on top of a futex. Helps Thread state transitions.
+ *
+ * The notification flag and the number of blocked waiters share one 32 bit word, on which the waiters block with a
+ * futex. notify() sets the flag and only makes the wakeup system call if a thread is actually blocked and the flag
+ * was not set before, so repeated notifications while the waiter is awake or not yet woken up are coalesced into
+ * one. Producers can call it for every batch.
+ *
+ * By default wait() blocks right away. With setWaitStrategy() the waiting thread first spins and then yields for a
+ * number of iterations before it blocks, which removes the wakeup latency for signals that follow shortly.
  */
 class Signal
 {
 public:
-    Signal()
-    {
-        mNotify = false;
-    }
+    Signal() = default;
     ~Signal() = default;
 
+    Signal( const Signal & ) = delete;
+    Signal &operator=( const Signal & ) = delete;
+    Signal( Signal && ) = delete;
+    Signal &operator=( Signal && ) = delete;
+
     /**
-     * @brief wait constant passed to the condition variable. Releases when the
-     * predicate returns true.
+     * @brief wait constant, waits until the signal is notified without timeout.
      */
     static constexpr uint32_t WaitWithPredicate = static_cast<uint32_t>( -1 );
     /**
      * @brief Wakes up the thread from the waiting cycle.
+     * @return True if a blocked thread was woken up with a system call, false if the notification was coalesced
+     * with a pending one or no thread is blocked
      */
-    void
+    bool
     notify()
     {
-        std::unique_lock<std::mutex> mWaitMutex( mMutex );
-        mNotify = true;
-        mWaitMutex.unlock();
-        mSignalCondition.notify_one();
+        // Read-modify-write on the same word as the registration of the waiter in wait(): either the waiter
+        // sees the flag before blocking or this thread sees the blocked waiter
+        auto state = mState.fetch_or( NOTIFIED, std::memory_order_acq_rel );
+        if ( ( ( state & NOTIFIED ) != 0U ) || ( state < WAITER ) )
+        {
+            return false;
+        }
+        futex( FUTEX_WAKE_PRIVATE, 1, nullptr );
+        return true;
+    }
+
+    /**
+     * @brief Configures how wait() idles before it blocks. Can be changed while a thread waits, the next wait()
+     *        uses the new strategy.
+     * @param spinCount number of busy polls of the signal before yielding
+     * @param yieldCount number of polls of the signal with a yield of the CPU in between before blocking
+     */
+    void
+    setWaitStrategy( uint32_t spinCount, uint32_t yieldCount )
+    {
+        mSpinCount.store( spinCount, std::memory_order_relaxed );
+        mYieldCount.store( yieldCount, std::memory_order_relaxed );
     }
 
     /**
-     * @brief Wait for some time for the signal to be set.
-     * @param timeoutMs timeout in Milliseconds.
+     * @brief Wait for some time for the signal to be set. Consumes the notification.
+     * @param timeoutMs timeout in Milliseconds, WaitWithPredicate to wait without timeout.
      */
     void
     wait( uint32_t timeoutMs )
     {
-        // Predicate, returns true if the wakeup signal is set.
-        auto predicate = [this]() -> bool { return mNotify; };
-        std::unique_lock<std::mutex> mWaitMutex( mMutex );
-        if ( !predicate() )
+        auto spinCount = mSpinCount.load( std::memory_order_relaxed );
+        for ( uint32_t i = 0; i < spinCount; i++ )
         {
-            if ( timeoutMs == WaitWithPredicate )
+            if ( tryConsume() )
             {
-                // Waits until the predicate returns true
-                mSignalCondition.wait( mWaitMutex, predicate );
+                return;
             }
-            else
+            relaxCpu();
+        }
+        auto yieldCount = mYieldCount.load( std::memory_order_relaxed );
+        for ( uint32_t i = 0; i < yieldCount; i++ )
+        {
+            if ( tryConsume() )
             {
-                // Waits until either the predicate returns true or the timeout expires.
-                mSignalCondition.wait_for( mWaitMutex, std::chrono::milliseconds( timeoutMs ), predicate );
+                return;
             }
+            std::this_thread::yield();
         }
-
-        if ( mNotify )
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds( timeoutMs );
+        auto state = mState.fetch_add( WAITER, std::memory_order_acq_rel ) + WAITER;
+        for ( ;; )
         {
-            mNotify = false;
+            if ( ( state & NOTIFIED ) != 0U )
+            {
+                // Consume the notification and unregister in one step
+                if ( mState.compare_exchange_weak(
+                         state, state - WAITER - NOTIFIED, std::memory_order_acq_rel, std::memory_order_relaxed ) )
+                {
+                    return;
+                }
+                continue;
+            }
+            struct timespec timeout = {};
+            if ( timeoutMs != WaitWithPredicate )
+            {
+                auto remaining = deadline - std::chrono::steady_clock::now();
+                if ( remaining <= std::chrono::steady_clock::duration::zero() )
+                {
+                    // Timed out, unregister. A notification that came in meanwhile is consumed as well.
+                    while ( !mState.compare_exchange_weak( state,
+                                                           ( state - WAITER ) & ~NOTIFIED,
+                                                           std::memory_order_acq_rel,
+                                                           std::memory_order_relaxed ) )
+                    {
+                    }
+                    return;
+                }
+                auto remainingNs = std::chrono::duration_cast<std::chrono::nanoseconds>( remaining ).count();
+                timeout.tv_sec = static_cast<time_t>( remainingNs / 1000000000 );
+                timeout.tv_nsec = static_cast<long>( remainingNs % 1000000000 );
+            }
+            // Blocks only if the word is still unchanged, i.e. no notification since the state was read
+            futex( FUTEX_WAIT_PRIVATE, state, timeoutMs != WaitWithPredicate ? &timeout : nullptr );
+            state = mState.load( std::memory_order_acquire );
         }
     }
 
 private:
-    std::condition_variable mSignalCondition;
-    std::atomic<bool> mNotify;
-    std::mutex mMutex;
+    static constexpr uint32_t NOTIFIED = 1U;
+    // The number of blocked waiters is counted in the bits above the flag
+    static constexpr uint32_t WAITER = 2U;
+
+    // Consumes the notification if it is set, without writing the shared word otherwise
+    bool
+    tryConsume()
+    {
+        if ( ( mState.load( std::memory_order_relaxed ) & NOTIFIED ) == 0U )
+        {
+            return false;
+        }
+        return ( mState.fetch_and( ~NOTIFIED, std::memory_order_acq_rel ) & NOTIFIED ) != 0U;
+    }
+
+    void
+    futex( int operation, uint32_t value, const struct timespec *timeout )
+    {
+        static_assert( sizeof( std::atomic<uint32_t> ) == sizeof( uint32_t ), "The futex word must be 32 bit" );
+        // Errors are not relevant: EAGAIN if the word changed, EINTR or ETIMEDOUT, the caller checks the state again
+        (void)syscall( SYS_futex, reinterpret_cast<uint32_t *>( &mState ), operation, value, timeout, nullptr, 0 );
+    }
+
+    // Hint to the CPU that this is a busy wait loop
+    static void
+    relaxCpu()
+    {
+#if defined( __x86_64__ ) || defined( __i386__ )
+        __builtin_ia32_pause();
+#elif defined( __aarch64__ )
+        asm volatile( "yield" );
+#endif
+    }
+
+    std::atomic<uint32_t> mState{ 0 };
+    std::atomic<uint32_t> mSpinCount{ 0 };
+    std::atomic<uint32_t> mYieldCount{ 0 };
 };
 
 } // namespace Linux
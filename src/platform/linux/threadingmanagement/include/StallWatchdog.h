@@ -0,0 +1,211 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+#if defined( IOTFLEETWISE_LINUX )
+// Includes
+#include "LoggingModule.h"
+#include "Signal.h"
+#include "Thread.h"
+#include "TimeTypes.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace Platform
+{
+namespace Linux
+{
+
+/**
+ * @brief A stage of a main loop which ran longer than the threshold of the StallWatchdog
+ */
+struct StallRecord
+{
+    std::string loopName;         /**< name of the thread running the loop */
+    const char *stage{ nullptr }; /**< stage the loop was in */
+    Timestamp startTimeMs{ 0 };   /**< system time the stage started */
+    uint64_t durationMs{ 0 };     /**< time spent in the stage */
+    bool ongoing{ false };        /**< recorded by the watchdog thread while the stage was still running */
+};
+
+/**
+ * @brief Process wide detection of stalled iterations of the main loops of the pipeline threads
+ *
+ * Every watched loop creates a Heartbeat on its thread, marks the stage it enters with Heartbeat::enter() and the
+ * time it waits for work with Heartbeat::idle(). A mark is a coarse clock read and a few relaxed atomic stores, and a
+ * single relaxed load while the watchdog is disabled. A stage which took longer than the threshold is recorded by the
+ * loop itself when it leaves the stage, with the stage name and its duration, in a flight recorder keeping the last
+ * RECORD_COUNT stalls. The watchdog thread checks the loops every period, so that a loop which is stuck is recorded
+ * and logged while it is stuck, once per stall. The RemoteProfiler uploads the records with the logs, see
+ * takeRecords(), so that the stalls can be analyzed after the fact.
+ */
+class StallWatchdog
+{
+public:
+    static constexpr uint32_t MAX_LOOPS = 64;
+    static constexpr size_t RECORD_COUNT = 64;
+    static constexpr uint32_t INVALID_LOOP_ID = MAX_LOOPS;
+
+    /**
+     * @brief Heartbeat of the main loop of the calling thread, registered under the name of the thread
+     */
+    class Heartbeat
+    {
+    public:
+        Heartbeat();
+        ~Heartbeat();
+
+        Heartbeat( const Heartbeat & ) = delete;
+        Heartbeat &operator=( const Heartbeat & ) = delete;
+        Heartbeat( Heartbeat && ) = delete;
+        Heartbeat &operator=( Heartbeat && ) = delete;
+
+        /**
+         * @brief Marks the start of a stage, which also ends the previous stage
+         * @param stage name of the stage, must be a string literal
+         */
+        void
+        enter( const char *stage )
+        {
+            StallWatchdog::get().enter( mLoopId, stage );
+        }
+
+        /**
+         * @brief Ends the current stage before the loop waits for work
+         */
+        void
+        idle()
+        {
+            StallWatchdog::get().idle( mLoopId );
+        }
+
+    private:
+        uint32_t mLoopId;
+    };
+
+    static StallWatchdog &get();
+
+    StallWatchdog() = default;
+    ~StallWatchdog();
+
+    StallWatchdog( const StallWatchdog & ) = delete;
+    StallWatchdog &operator=( const StallWatchdog & ) = delete;
+    StallWatchdog( StallWatchdog && ) = delete;
+    StallWatchdog &operator=( StallWatchdog && ) = delete;
+
+    /**
+     * @brief Sets the duration after which a stage is a stall
+     * @param thresholdMs 0 disables the detection
+     */
+    void
+    setThreshold( uint32_t thresholdMs )
+    {
+        mThresholdMs.store( thresholdMs, std::memory_order_relaxed );
+    }
+
+    uint32_t
+    getThreshold() const
+    {
+        return mThresholdMs.load( std::memory_order_relaxed );
+    }
+
+    /**
+     * @brief Registers a loop, see Heartbeat
+     * @return the ID of the loop, INVALID_LOOP_ID if MAX_LOOPS are registered
+     */
+    uint32_t registerLoop( const std::string &name );
+
+    void unregisterLoop( uint32_t loopId );
+
+    void
+    enter( uint32_t loopId, const char *stage )
+    {
+        auto thresholdMs = getThreshold();
+        if ( ( thresholdMs > 0U ) && ( loopId < MAX_LOOPS ) )
+        {
+            mark( mLoops[loopId], stage, thresholdMs );
+        }
+    }
+
+    void
+    idle( uint32_t loopId )
+    {
+        enter( loopId, nullptr );
+    }
+
+    /**
+     * @brief Records the stages which are running longer than the threshold and were not recorded yet. Called by
+     *        the watchdog thread.
+     * @return the number of newly recorded stalls
+     */
+    size_t check();
+
+    /**
+     * @brief Returns the records since the previous call and removes them from the flight recorder
+     */
+    std::vector<StallRecord> takeRecords();
+
+    /**
+     * @brief Starts the watchdog thread, which checks the loops every half threshold
+     * @return True if the thread is running
+     */
+    bool start();
+
+    bool stop();
+
+    bool isAlive();
+
+private:
+    struct Loop
+    {
+        std::atomic<bool> mUsed{ false };
+        // nullptr while the loop is idle
+        std::atomic<const char *> mStage{ nullptr };
+        std::atomic<Timestamp> mStageStartMs{ 0 };
+        // Set once the stall of the current stage is recorded
+        std::atomic<bool> mRecorded{ false };
+        // Only changed under mMutex while the loop is not used
+        std::string mName;
+    };
+
+    void mark( Loop &loop, const char *stage, uint32_t thresholdMs );
+    void record( const Loop &loop, const char *stage, Timestamp startMs, Timestamp nowMs, bool ongoing );
+    static void doWork( void *data );
+    bool shouldStop() const;
+
+    std::atomic<uint32_t> mThresholdMs{ 0 };
+    Loop mLoops[MAX_LOOPS];
+    std::mutex mMutex;
+    std::deque<StallRecord> mRecords;
+    Thread mThread;
+    std::atomic<bool> mShouldStop{ false };
+    std::mutex mThreadMutex;
+    Signal mWait;
+    LoggingModule mLogger;
+};
+
+} // namespace Linux
+} // namespace Platform
+} // namespace IoTFleetWise
+} // namespace Aws
+#endif // IOTFLEETWISE_LINUX
@@ -17,8 +17,14 @@
 // Includes
 #include "Signal.h"
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <map>
 #include <memory>
+#include <string>
+#include <sys/types.h>
+#include <vector>
 
 namespace Aws
 {
@@ -28,6 +34,30 @@ namespace Platform
 {
 namespace Linux
 {
+/**
+ * @brief Scheduling policy of a thread
+ */
+enum class ThreadSchedulingPolicy
+{
+    INHERIT, /**< Policy and priority of the creating thread */
+    OTHER,   /**< SCHED_OTHER, the default time sharing policy */
+    FIFO,    /**< SCHED_FIFO, real-time, runs until it blocks or a higher priority thread is ready */
+    RR       /**< SCHED_RR, real-time, round robin between threads of the same priority */
+};
+
+/**
+ * @brief How a thread is placed and scheduled, configured by thread name
+ */
+struct ThreadConfig
+{
+    std::vector<uint32_t> cpuAffinity; /**< CPUs the thread may run on, all if empty */
+    ThreadSchedulingPolicy schedulingPolicy{ ThreadSchedulingPolicy::INHERIT };
+    int priority{ 0 }; /**< Real-time priority 1 to 99 for FIFO and RR, ignored otherwise */
+    bool hasNice{ false };
+    int nice{ 0 }; /**< Nice value -20 to 19, only applied if hasNice */
+    size_t stackSizeBytes{ 0 }; /**< 0 for the default stack size */
+};
+
 /**
  * @brief POSIX Thread Wrapper Implementation.
  * As a rule of thumb, Thread names must follow this convention i.e.
@@ -46,9 +76,11 @@ public:
      * @brief Creates a POSIX Thread.
      * @param workerFunction function pointer to the thread task.
      * @param execParam thread handle execution settings.
+     * @param name name of the thread. If a configuration matches the name, the stack size is set on creation and
+     * the affinity, policy and nice value by the thread before it runs the worker function.
      * @return True if the thread has been created.
      */
-    bool create( WorkerFunction workerFunction, void *execParam );
+    bool create( WorkerFunction workerFunction, void *execParam, const std::string &name = std::string() );
 
     /**
      * @brief Checks if the thread is actively running
@@ -79,15 +111,50 @@ public:
      */
     static void SetCurrentThreadName( const std::string &name );
 
+    /**
+     * @brief Sets the configurations of the threads created from now on
+     * @param configs configuration per thread name. A name ending with '*' matches all threads starting with the
+     * part before it, e.g. fwDIConsumer* matches fwDIConsumer1. An exact name takes precedence, otherwise the longest
+     * matching prefix.
+     */
+    static void setConfigs( std::map<std::string, ThreadConfig> configs );
+
+    static std::map<std::string, ThreadConfig> getConfigs();
+
+    /**
+     * @brief Finds the configuration for a thread name
+     * @return False if no configuration matches
+     */
+    static bool findConfig( const std::string &name, ThreadConfig &config );
+
+    /**
+     * @brief Applies the affinity, scheduling policy and nice value of the configuration to the calling thread
+     * @return False if one of them could not be applied, e.g. because a real-time policy needs CAP_SYS_NICE
+     */
+    static bool applyConfigToCurrentThread( const ThreadConfig &config );
+
+    /**
+     * @brief Applies the current configurations to the named threads which are running, e.g. after setConfigs()
+     *        at runtime. The stack size only applies to threads created later, and a thread whose configuration
+     *        was removed keeps its settings.
+     * @return False if a configuration could not be applied to one of the threads
+     */
+    static bool applyConfigsToRunningThreads();
+
 private:
     struct ThreadSettings
     {
         Thread *mSelf{ nullptr };
         WorkerFunction mWorkerFunction{ nullptr };
         void *mParams{ nullptr };
+        std::string mName;
+        bool mHasConfig{ false };
+        ThreadConfig mConfig;
     };
     static void *workerFunctionWrapper( void *params );
 
+    static bool applyConfigToThread( pid_t threadId, const ThreadConfig &config );
+
     unsigned long getThreadID() const;
 
     pthread_t mThread{ 0 };
@@ -0,0 +1,110 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+
+#pragma once
+
+// Includes
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace Platform
+{
+namespace Linux
+{
+/**
+ * @brief Publishes a shared pointer from a control thread to data plane threads in an RCU like way.
+ *
+ * The writer replaces the pointer and increments a version. Every reader keeps its own copy of the
+ * pointer together with the version it copied. Checking for a new version costs the readers one atomic
+ * load, only when a new pointer was published the short critical section to copy it is entered. As
+ * readers hold their own shared pointer, the old object is freed when the last reader has moved on.
+ */
+template <typename T>
+class VersionedSharedPtr
+{
+public:
+    VersionedSharedPtr() = default;
+    VersionedSharedPtr( const VersionedSharedPtr & ) = delete;
+    VersionedSharedPtr &operator=( const VersionedSharedPtr & ) = delete;
+    VersionedSharedPtr( VersionedSharedPtr && ) = delete;
+    VersionedSharedPtr &operator=( VersionedSharedPtr && ) = delete;
+
+    /**
+     * @brief Publishes a new pointer. Can be called from any thread.
+     * @param ptr the new pointer, can be nullptr
+     */
+    void
+    store( std::shared_ptr<T> ptr )
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        mPtr = std::move( ptr );
+        mVersion.fetch_add( 1, std::memory_order_release );
+    }
+
+    /**
+     * @brief Returns a copy of the currently published pointer
+     * @return the published pointer
+     */
+    std::shared_ptr<T>
+    load() const
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        return mPtr;
+    }
+
+    /**
+     * @brief Updates the copy of a reader if a newer pointer was published since the copy was taken.
+     * @param ptr copy of the reader
+     * @param version version of the copy, initialize with 0 before the first call
+     * @return True if ptr and version were updated, False if the copy is up to date
+     */
+    bool
+    refresh( std::shared_ptr<T> &ptr, uint64_t &version ) const
+    {
+        if ( mVersion.load( std::memory_order_acquire ) == version )
+        {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock( mMutex );
+        ptr = mPtr;
+        version = mVersion.load( std::memory_order_relaxed );
+        return true;
+    }
+
+    /**
+     * @brief Returns the version of the published pointer, 0 if nothing was published yet
+     * @return the version
+     */
+    uint64_t
+    getVersion() const
+    {
+        return mVersion.load( std::memory_order_acquire );
+    }
+
+private:
+    mutable std::mutex mMutex;
+    std::shared_ptr<T> mPtr;
+    std::atomic<uint64_t> mVersion{ 0 };
+};
+
+} // namespace Linux
+} // namespace Platform
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -0,0 +1,117 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "InstrumentedMutex.h"
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace Platform
+{
+namespace Linux
+{
+namespace
+{
+const char *const COUNTER_METRIC_NAMES[] = { "mutexAcquisitions_", "mutexContended_", "mutexWaitTimeUs_" };
+const char *const COUNTER_METRIC_UNITS[] = { "Count", "Count", "Microseconds" };
+static_assert( sizeof( COUNTER_METRIC_NAMES ) / sizeof( COUNTER_METRIC_NAMES[0] ) ==
+                   static_cast<size_t>( MutexCounter::MUTEX_COUNTER_SIZE ),
+               "A metric name is needed for every counter" );
+} // namespace
+
+constexpr uint32_t MutexContention::MAX_MUTEXES;
+constexpr uint32_t MutexContention::INVALID_MUTEX_ID;
+
+MutexContention &
+MutexContention::get()
+{
+    static MutexContention contention;
+    return contention;
+}
+
+bool
+MutexContention::isCompiledIn()
+{
+#if defined( FWE_MUTEX_CONTENTION_TRACING )
+    return true;
+#else
+    return false;
+#endif
+}
+
+uint32_t
+MutexContention::getMutexId( const std::string &name )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    for ( uint32_t i = 0; i < mMutexCount; i++ )
+    {
+        if ( mEntries[i].mName == name )
+        {
+            return i;
+        }
+    }
+    if ( mMutexCount >= MAX_MUTEXES )
+    {
+        return INVALID_MUTEX_ID;
+    }
+    mEntries[mMutexCount].mName = name;
+    return mMutexCount++;
+}
+
+uint64_t
+MutexContention::getTotal( uint32_t mutexId, MutexCounter counter ) const
+{
+    if ( ( mutexId >= MAX_MUTEXES ) || ( counter >= MutexCounter::MUTEX_COUNTER_SIZE ) )
+    {
+        return 0U;
+    }
+    return mEntries[mutexId].mCounters[static_cast<uint8_t>( counter )].load( std::memory_order_relaxed );
+}
+
+void
+MutexContention::forwardToMetricsReceiver( IMetricsReceiver *receiver )
+{
+    if ( receiver == nullptr )
+    {
+        return;
+    }
+    std::lock_guard<std::mutex> lock( mMutex );
+    for ( uint32_t i = 0; i < mMutexCount; i++ )
+    {
+        auto &entry = mEntries[i];
+        uint64_t period[COUNTER_COUNT];
+        for ( size_t c = 0; c < COUNTER_COUNT; c++ )
+        {
+            auto total = entry.mCounters[c].load( std::memory_order_relaxed );
+            period[c] = total - entry.mReported[c];
+            entry.mReported[c] = total;
+        }
+        // Mutexes not taken in the period are not reported, e.g. while the counting is disabled
+        if ( period[static_cast<size_t>( MutexCounter::ACQUISITIONS )] == 0U )
+        {
+            continue;
+        }
+        for ( size_t c = 0; c < COUNTER_COUNT; c++ )
+        {
+            receiver->setMetric(
+                COUNTER_METRIC_NAMES[c] + entry.mName, static_cast<double>( period[c] ), COUNTER_METRIC_UNITS[c] );
+        }
+    }
+}
+
+} // namespace Linux
+} // namespace Platform
+} // namespace IoTFleetWise
+} // namespace Aws
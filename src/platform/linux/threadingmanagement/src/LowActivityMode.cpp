@@ -0,0 +1,219 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#if defined( IOTFLEETWISE_LINUX )
+// Includes
+#include "LowActivityMode.h"
+#include <algorithm>
+#include <sys/prctl.h>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace Platform
+{
+namespace Linux
+{
+
+constexpr uint32_t LowActivityMode::INVALID_IGNITION_SIGNAL_ID;
+constexpr uint32_t LowActivityMode::DEFAULT_WAKEUP_TICK_MS;
+constexpr uint64_t LowActivityMode::DEFAULT_TIMER_SLACK_NS;
+constexpr Timestamp LowActivityMode::BUS_ACTIVITY_GRANULARITY_MS;
+
+LowActivityMode &
+LowActivityMode::get()
+{
+    static LowActivityMode mode;
+    return mode;
+}
+
+bool
+LowActivityMode::init( const Config &config )
+{
+    if ( config.wakeupTickMs == 0 )
+    {
+        mLogger.error( "LowActivityMode::init", " The wakeup tick must not be 0 " );
+        return false;
+    }
+    mConfig = config;
+    mEnabled = true;
+    // The bus silence is counted from the start
+    mLastBusActivity.store( mClock->timeSinceEpochMs(), std::memory_order_relaxed );
+    mLogger.info( "LowActivityMode::init",
+                  " Enabled with bus silence time " + std::to_string( config.busSilenceTimeMs ) + " ms and tick " +
+                      std::to_string( config.wakeupTickMs ) + " ms" );
+    return true;
+}
+
+void
+LowActivityMode::onIgnition( bool on )
+{
+    if ( !mEnabled )
+    {
+        return;
+    }
+    mIgnitionOff.store( !on, std::memory_order_relaxed );
+    if ( on )
+    {
+        mLastBusActivity.store( mClock->timeSinceEpochMs(), std::memory_order_relaxed );
+        if ( isActive() )
+        {
+            leave( "ignition on" );
+        }
+    }
+    else if ( !isActive() )
+    {
+        enter( "ignition off" );
+    }
+}
+
+void
+LowActivityMode::onCloudMessage()
+{
+    if ( mEnabled && isActive() )
+    {
+        // The bus stays silent, so the mode is entered again with the next silence check
+        mLastBusActivity.store( mClock->timeSinceEpochMs(), std::memory_order_relaxed );
+        leave( "cloud message" );
+    }
+}
+
+void
+LowActivityMode::checkBusSilence()
+{
+    if ( ( !mEnabled ) || ( mConfig.busSilenceTimeMs == 0 ) || isActive() )
+    {
+        return;
+    }
+    if ( mClock->timeSinceEpochMs() >= mLastBusActivity.load( std::memory_order_relaxed ) + mConfig.busSilenceTimeMs )
+    {
+        enter( "bus silence" );
+    }
+}
+
+uint32_t
+LowActivityMode::getIdleWaitTimeMs( uint32_t idleTimeMs )
+{
+    if ( !mEnabled )
+    {
+        return idleTimeMs;
+    }
+    updateTimerSlack();
+    return isActive() ? Signal::WaitWithPredicate : idleTimeMs;
+}
+
+uint32_t
+LowActivityMode::getDeadlineWaitTimeMs( uint32_t deadlineMs, uint32_t idleTimeMs )
+{
+    if ( !mEnabled )
+    {
+        return std::min( deadlineMs, idleTimeMs );
+    }
+    updateTimerSlack();
+    if ( !isActive() )
+    {
+        return std::min( deadlineMs, idleTimeMs );
+    }
+    if ( deadlineMs == std::numeric_limits<uint32_t>::max() )
+    {
+        return Signal::WaitWithPredicate;
+    }
+    if ( deadlineMs == 0 )
+    {
+        return 0;
+    }
+    // The ticks are multiples of the tick since epoch, so all threads round to the same points in time
+    auto now = mClock->timeSinceEpochMs();
+    auto deadline = now + deadlineMs;
+    auto tick = static_cast<Timestamp>( mConfig.wakeupTickMs );
+    auto alignedDeadline = ( deadline + tick - 1 ) / tick * tick;
+    return static_cast<uint32_t>(
+        std::min<Timestamp>( alignedDeadline - now, std::numeric_limits<uint32_t>::max() - 1 ) );
+}
+
+void
+LowActivityMode::addWakeUpSignal( Signal &signal )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    mWakeUpSignals.push_back( &signal );
+}
+
+void
+LowActivityMode::removeWakeUpSignal( Signal &signal )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    mWakeUpSignals.erase( std::remove( mWakeUpSignals.begin(), mWakeUpSignals.end(), &signal ),
+                          mWakeUpSignals.end() );
+}
+
+void
+LowActivityMode::reset()
+{
+    if ( isActive() )
+    {
+        leave( "reset" );
+    }
+    mEnabled = false;
+    mConfig = Config();
+    mIgnitionOff.store( false, std::memory_order_relaxed );
+}
+
+void
+LowActivityMode::enter( const std::string &reason )
+{
+    bool expected = false;
+    if ( !mActive.compare_exchange_strong( expected, true, std::memory_order_relaxed ) )
+    {
+        return;
+    }
+    mGeneration.fetch_add( 1, std::memory_order_relaxed );
+    mLogger.info( "LowActivityMode::enter", " Entered because of " + reason );
+}
+
+void
+LowActivityMode::leave( const std::string &reason )
+{
+    bool expected = true;
+    if ( !mActive.compare_exchange_strong( expected, false, std::memory_order_relaxed ) )
+    {
+        return;
+    }
+    mGeneration.fetch_add( 1, std::memory_order_relaxed );
+    mLogger.info( "LowActivityMode::leave", " Left because of " + reason );
+    std::lock_guard<std::mutex> lock( mMutex );
+    for ( auto *signal : mWakeUpSignals )
+    {
+        signal->notify();
+    }
+}
+
+void
+LowActivityMode::updateTimerSlack()
+{
+    thread_local uint32_t appliedGeneration = 0;
+    auto generation = mGeneration.load( std::memory_order_relaxed );
+    if ( generation == appliedGeneration )
+    {
+        return;
+    }
+    appliedGeneration = generation;
+    // 0 restores the default timer slack of the thread
+    (void)prctl( PR_SET_TIMERSLACK, static_cast<unsigned long>( isActive() ? mConfig.timerSlackNs : 0 ), 0, 0, 0 );
+}
+
+} // namespace Linux
+} // namespace Platform
+} // namespace IoTFleetWise
+} // namespace Aws
+#endif // IOTFLEETWISE_LINUX
@@ -0,0 +1,203 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "RetryScheduler.h"
+#include <algorithm>
+#include <string>
+
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+RetryScheduler &
+RetryScheduler::getInstance()
+{
+    static RetryScheduler instance;
+    return instance;
+}
+
+RetryScheduler::RetryScheduler()
+    : mRandom( std::random_device()() )
+{
+}
+
+RetryScheduler::~RetryScheduler()
+{
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        mShouldStop.store( true );
+    }
+    mWakeUp.notify_all();
+    for ( auto &worker : mWorkers )
+    {
+        worker.release();
+    }
+}
+
+bool
+RetryScheduler::startWorkers()
+{
+    if ( mWorkersStarted )
+    {
+        return true;
+    }
+    for ( size_t i = 0; i < mWorkers.size(); i++ )
+    {
+        if ( !mWorkers[i].create( doWork, this, "fwRetry" + std::to_string( i + 1U ) ) )
+        {
+            mLogger.error( "RetryScheduler::startWorkers", "Retry worker failed to start" );
+            return false;
+        }
+    }
+    mWorkersStarted = true;
+    return true;
+}
+
+RetryScheduler::RetryId
+RetryScheduler::schedule( IRetryable &retryable, uint32_t startBackoffMs, uint32_t maxBackoffMs )
+{
+    RetryId id = 0;
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        if ( !startWorkers() )
+        {
+            return 0;
+        }
+        id = mNextId++;
+        Retry retry;
+        retry.mRetryable = &retryable;
+        retry.mMaxBackoffMs = std::max( startBackoffMs, maxBackoffMs );
+        retry.mBackoffMs = startBackoffMs;
+        retry.mDueTime = std::chrono::steady_clock::now();
+        mDueRetries.emplace( retry.mDueTime, id );
+        mRetries.emplace( id, retry );
+    }
+    mWakeUp.notify_one();
+    return id;
+}
+
+void
+RetryScheduler::cancel( RetryId id )
+{
+    std::unique_lock<std::mutex> lock( mMutex );
+    auto it = mRetries.find( id );
+    if ( it == mRetries.end() )
+    {
+        return;
+    }
+    auto &retry = it->second;
+    if ( retry.mRunning )
+    {
+        // The worker finishes the retries once the attempt returns. The entry in the timer heap is left behind and
+        // skipped when it becomes due.
+        retry.mCancelled = true;
+        if ( retry.mWorker == std::this_thread::get_id() )
+        {
+            return;
+        }
+        mRetryDone.wait( lock, [&]() { return mRetries.find( id ) == mRetries.end(); } );
+        return;
+    }
+    auto retryable = retry.mRetryable;
+    mRetries.erase( it );
+    lock.unlock();
+    mLogger.trace( "RetryScheduler::cancel", "Stop retries with ABORT" );
+    retryable->onFinished( RetryStatus::ABORT );
+}
+
+bool
+RetryScheduler::isScheduled( RetryId id )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    return mRetries.find( id ) != mRetries.end();
+}
+
+uint32_t
+RetryScheduler::getJitteredBackoffMs( uint32_t backoffMs )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    return getJitteredBackoffMsLocked( backoffMs );
+}
+
+uint32_t
+RetryScheduler::getJitteredBackoffMsLocked( uint32_t backoffMs )
+{
+    std::uniform_int_distribution<uint32_t> distribution( 0, backoffMs / 2U );
+    return ( backoffMs - ( backoffMs / 2U ) ) + distribution( mRandom );
+}
+
+void
+RetryScheduler::runAttempt( std::unique_lock<std::mutex> &lock, RetryId id, Retry &retry )
+{
+    retry.mRunning = true;
+    retry.mWorker = std::this_thread::get_id();
+    auto retryable = retry.mRetryable;
+    lock.unlock();
+    RetryStatus result = retryable->attempt();
+    lock.lock();
+    // The retry is not erased while it is running, so the reference is still valid
+    retry.mRunning = false;
+    if ( ( result == RetryStatus::RETRY ) && ( !retry.mCancelled ) && ( !mShouldStop ) )
+    {
+        auto waitTimeMs = getJitteredBackoffMsLocked( retry.mBackoffMs );
+        mLogger.trace( "RetryScheduler::runAttempt", "Current retry time is: " + std::to_string( waitTimeMs ) );
+        retry.mDueTime = std::chrono::steady_clock::now() + std::chrono::milliseconds( waitTimeMs );
+        mDueRetries.emplace( retry.mDueTime, id );
+        // exponential backoff
+        retry.mBackoffMs = std::min( retry.mBackoffMs * 2U, retry.mMaxBackoffMs );
+        return;
+    }
+    if ( result == RetryStatus::RETRY )
+    {
+        // If the retries are stopped without succeeding signal abort
+        result = RetryStatus::ABORT;
+    }
+    // Keep the retry until onFinished returned, so that cancel() waits for it
+    retry.mRunning = true;
+    lock.unlock();
+    mLogger.trace( "RetryScheduler::runAttempt", "Finished with code " + std::to_string( static_cast<int>( result ) ) );
+    retryable->onFinished( result );
+    lock.lock();
+    mRetries.erase( id );
+    mRetryDone.notify_all();
+}
+
+void
+RetryScheduler::doWork( void *data )
+{
+    auto *scheduler = static_cast<RetryScheduler *>( data );
+    std::unique_lock<std::mutex> lock( scheduler->mMutex );
+    while ( !scheduler->mShouldStop )
+    {
+        if ( scheduler->mDueRetries.empty() )
+        {
+            scheduler->mWakeUp.wait( lock );
+            continue;
+        }
+        auto next = scheduler->mDueRetries.top();
+        auto it = scheduler->mRetries.find( next.second );
+        // Skip entries of cancelled retries and outdated entries
+        if ( ( it == scheduler->mRetries.end() ) || it->second.mRunning || ( it->second.mDueTime != next.first ) )
+        {
+            scheduler->mDueRetries.pop();
+            continue;
+        }
+        if ( next.first > std::chrono::steady_clock::now() )
+        {
+            scheduler->mWakeUp.wait_until( lock, next.first );
+            continue;
+        }
+        scheduler->mDueRetries.pop();
+        scheduler->runAttempt( lock, next.second, it->second );
+        // Another worker might wait for an earlier due time now
+        scheduler->mWakeUp.notify_one();
+    }
+}
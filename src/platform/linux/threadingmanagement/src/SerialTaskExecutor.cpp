@@ -0,0 +1,281 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "SerialTaskExecutor.h"
+#include <algorithm>
+#include <iterator>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace Platform
+{
+namespace Linux
+{
+
+constexpr SerialTaskExecutor::QueueId SerialTaskExecutor::INVALID_QUEUE_ID;
+constexpr size_t SerialTaskExecutor::DEFAULT_QUEUE_CAPACITY;
+
+SerialTaskExecutor::SerialTaskExecutor( uint32_t workerCount, std::string threadName )
+    : mThreadName( std::move( threadName ) )
+{
+    workerCount = std::max( 1U, workerCount );
+    for ( uint32_t i = 0; i < workerCount; i++ )
+    {
+        auto worker = std::make_unique<Worker>();
+        worker->mExecutor = this;
+        mWorkers.emplace_back( std::move( worker ) );
+    }
+}
+
+SerialTaskExecutor::~SerialTaskExecutor()
+{
+    // To make sure the threads stop during teardown of tests.
+    if ( isAlive() )
+    {
+        stop();
+    }
+}
+
+bool
+SerialTaskExecutor::start()
+{
+    // Prevent concurrent stop/init
+    std::lock_guard<std::mutex> lock( mThreadMutex );
+    {
+        std::lock_guard<std::mutex> queuesLock( mMutex );
+        mShouldStop = false;
+        mAccepting = true;
+    }
+    for ( size_t i = 0; i < mWorkers.size(); i++ )
+    {
+        if ( !mWorkers[i]->mThread.create( doWork, mWorkers[i].get(), mThreadName + std::to_string( i + 1 ) ) )
+        {
+            mLogger.error( "SerialTaskExecutor::start", " Worker Thread failed to start " );
+            return false;
+        }
+    }
+    mLogger.trace( "SerialTaskExecutor::start", " Started " + std::to_string( mWorkers.size() ) + " worker threads " );
+    return true;
+}
+
+bool
+SerialTaskExecutor::stop()
+{
+    std::lock_guard<std::mutex> lock( mThreadMutex );
+    {
+        // The workers run the pending tasks before they return
+        std::lock_guard<std::mutex> queuesLock( mMutex );
+        mAccepting = false;
+        mShouldStop = true;
+        // The delayed tasks are not waited for
+        mDelayedTasks.clear();
+    }
+    mWakeUp.notify_all();
+    bool stopped = true;
+    for ( auto &worker : mWorkers )
+    {
+        worker->mThread.release();
+        stopped = stopped && !worker->mThread.isActive();
+    }
+    mLogger.trace( "SerialTaskExecutor::stop", " Worker Threads stopped " );
+    return stopped;
+}
+
+bool
+SerialTaskExecutor::isAlive()
+{
+    return std::all_of( mWorkers.begin(), mWorkers.end(), []( const std::unique_ptr<Worker> &worker ) {
+        return worker->mThread.isValid() && worker->mThread.isActive();
+    } );
+}
+
+SerialTaskExecutor::QueueId
+SerialTaskExecutor::createQueue( size_t capacity )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    auto queueId = mNextQueueId++;
+    mQueues[queueId].mCapacity = std::max<size_t>( 1U, capacity );
+    return queueId;
+}
+
+void
+SerialTaskExecutor::removeQueue( QueueId queueId )
+{
+    std::unique_lock<std::mutex> lock( mMutex );
+    auto queue = mQueues.find( queueId );
+    if ( queue == mQueues.end() )
+    {
+        return;
+    }
+    queue->second.mRemoved = true;
+    for ( auto delayed = mDelayedTasks.begin(); delayed != mDelayedTasks.end(); )
+    {
+        delayed = ( delayed->second.first == queueId ) ? mDelayedTasks.erase( delayed ) : std::next( delayed );
+    }
+    // Without running workers the pending tasks are dropped
+    mQueueIdle.wait( lock, [this, &queue]() {
+        return ( !queue->second.mScheduled ) || ( mShouldStop && ( !queue->second.mRunning ) );
+    } );
+    mReadyQueues.erase( std::remove( mReadyQueues.begin(), mReadyQueues.end(), queueId ), mReadyQueues.end() );
+    mQueues.erase( queue );
+}
+
+bool
+SerialTaskExecutor::post( QueueId queueId, Task task )
+{
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        auto queue = mQueues.find( queueId );
+        if ( ( !mAccepting ) || ( queue == mQueues.end() ) || queue->second.mRemoved ||
+             ( queue->second.mTasks.size() >= queue->second.mCapacity ) )
+        {
+            return false;
+        }
+        if ( !enqueue( queueId, queue->second, std::move( task ) ) )
+        {
+            return true;
+        }
+    }
+    mWakeUp.notify_one();
+    return true;
+}
+
+bool
+SerialTaskExecutor::postAfter( QueueId queueId, uint32_t delayMs, Task task )
+{
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        auto queue = mQueues.find( queueId );
+        if ( ( !mAccepting ) || ( queue == mQueues.end() ) || queue->second.mRemoved )
+        {
+            return false;
+        }
+        mDelayedTasks.emplace( std::chrono::steady_clock::now() + std::chrono::milliseconds( delayMs ),
+                               std::make_pair( queueId, std::move( task ) ) );
+    }
+    // The waiting workers might wait for a later delayed task
+    mWakeUp.notify_all();
+    return true;
+}
+
+bool
+SerialTaskExecutor::enqueue( QueueId queueId, Queue &queue, Task task )
+{
+    queue.mTasks.emplace_back( std::move( task ) );
+    if ( queue.mScheduled )
+    {
+        // The worker running the queue puts it back into the ready list
+        return false;
+    }
+    queue.mScheduled = true;
+    mReadyQueues.push_back( queueId );
+    return true;
+}
+
+void
+SerialTaskExecutor::enqueueDueTasks()
+{
+    auto now = std::chrono::steady_clock::now();
+    size_t readyQueues = 0;
+    while ( ( !mDelayedTasks.empty() ) && ( mDelayedTasks.begin()->first <= now ) )
+    {
+        auto delayed = mDelayedTasks.begin();
+        // Delayed tasks of removed queues are erased by removeQueue
+        auto queueId = delayed->second.first;
+        if ( enqueue( queueId, mQueues[queueId], std::move( delayed->second.second ) ) )
+        {
+            readyQueues++;
+        }
+        mDelayedTasks.erase( delayed );
+    }
+    // The calling worker takes one of the queues, the others need further workers
+    if ( readyQueues > 1 )
+    {
+        mWakeUp.notify_all();
+    }
+}
+
+size_t
+SerialTaskExecutor::getPendingTaskCount( QueueId queueId ) const
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    auto queue = mQueues.find( queueId );
+    return ( queue == mQueues.end() ) ? 0U : queue->second.mTasks.size();
+}
+
+size_t
+SerialTaskExecutor::getQueueCapacity( QueueId queueId ) const
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    auto queue = mQueues.find( queueId );
+    return ( queue == mQueues.end() ) ? 0U : queue->second.mCapacity;
+}
+
+void
+SerialTaskExecutor::doWork( void *data )
+{
+    auto *executor = static_cast<Worker *>( data )->mExecutor;
+    std::unique_lock<std::mutex> lock( executor->mMutex );
+    while ( true )
+    {
+        executor->enqueueDueTasks();
+        if ( executor->mReadyQueues.empty() )
+        {
+            if ( executor->mShouldStop )
+            {
+                // Stopping and all pending tasks are done
+                executor->mQueueIdle.notify_all();
+                return;
+            }
+            if ( executor->mDelayedTasks.empty() )
+            {
+                executor->mWakeUp.wait( lock );
+            }
+            else
+            {
+                executor->mWakeUp.wait_until( lock, executor->mDelayedTasks.begin()->first );
+            }
+            continue;
+        }
+        auto queueId = executor->mReadyQueues.front();
+        executor->mReadyQueues.pop_front();
+        // Only removeQueue erases a queue, and it waits until the queue is no longer scheduled
+        auto &queue = executor->mQueues[queueId];
+        auto task = std::move( queue.mTasks.front() );
+        queue.mTasks.pop_front();
+        queue.mRunning = true;
+        lock.unlock();
+        task();
+        // Release what the task captured before the next one runs
+        task = nullptr;
+        lock.lock();
+        queue.mRunning = false;
+        if ( queue.mTasks.empty() )
+        {
+            queue.mScheduled = false;
+            executor->mQueueIdle.notify_all();
+        }
+        else
+        {
+            executor->mReadyQueues.push_back( queueId );
+        }
+    }
+}
+
+} // namespace Linux
+} // namespace Platform
+} // namespace IoTFleetWise
+} // namespace Aws
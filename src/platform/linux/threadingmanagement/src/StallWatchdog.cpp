@@ -0,0 +1,254 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#if defined( IOTFLEETWISE_LINUX )
+// Includes
+#include "StallWatchdog.h"
+#include "FastClock.h"
+#include "TraceModule.h"
+#include <algorithm>
+#include <iterator>
+#include <sys/prctl.h>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace Platform
+{
+namespace Linux
+{
+namespace
+{
+constexpr uint32_t MIN_CHECK_PERIOD_MS = 10;
+constexpr uint32_t DISABLED_CHECK_PERIOD_MS = 1000;
+} // namespace
+
+constexpr uint32_t StallWatchdog::MAX_LOOPS;
+constexpr size_t StallWatchdog::RECORD_COUNT;
+constexpr uint32_t StallWatchdog::INVALID_LOOP_ID;
+
+StallWatchdog::Heartbeat::Heartbeat()
+{
+    // The name is at most 15 characters, see PR_SET_NAME
+    char name[17] = {};
+    (void)prctl( PR_GET_NAME, name, 0, 0, 0 );
+    mLoopId = StallWatchdog::get().registerLoop( name );
+}
+
+StallWatchdog::Heartbeat::~Heartbeat()
+{
+    StallWatchdog::get().unregisterLoop( mLoopId );
+}
+
+StallWatchdog &
+StallWatchdog::get()
+{
+    static StallWatchdog watchdog;
+    return watchdog;
+}
+
+StallWatchdog::~StallWatchdog()
+{
+    stop();
+}
+
+uint32_t
+StallWatchdog::registerLoop( const std::string &name )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    for ( uint32_t loopId = 0; loopId < MAX_LOOPS; loopId++ )
+    {
+        auto &loop = mLoops[loopId];
+        if ( !loop.mUsed.load( std::memory_order_relaxed ) )
+        {
+            loop.mName = name;
+            loop.mStage.store( nullptr, std::memory_order_relaxed );
+            loop.mRecorded.store( false, std::memory_order_relaxed );
+            loop.mUsed.store( true, std::memory_order_release );
+            return loopId;
+        }
+    }
+    mLogger.warn( "StallWatchdog::registerLoop", "Too many loops, " + name + " is not watched" );
+    return INVALID_LOOP_ID;
+}
+
+void
+StallWatchdog::unregisterLoop( uint32_t loopId )
+{
+    if ( loopId >= MAX_LOOPS )
+    {
+        return;
+    }
+    std::lock_guard<std::mutex> lock( mMutex );
+    mLoops[loopId].mStage.store( nullptr, std::memory_order_relaxed );
+    mLoops[loopId].mUsed.store( false, std::memory_order_release );
+}
+
+void
+StallWatchdog::mark( Loop &loop, const char *stage, uint32_t thresholdMs )
+{
+    auto nowMs = FastClock::monotonicTimeMs( ClockPrecision::COARSE );
+    // Only written by the thread of the loop
+    const char *previousStage = loop.mStage.load( std::memory_order_relaxed );
+    if ( previousStage != nullptr )
+    {
+        auto startMs = loop.mStageStartMs.load( std::memory_order_relaxed );
+        if ( nowMs - startMs >= thresholdMs )
+        {
+            // A stall recorded while it was ongoing is recorded again with its complete duration, but counted once
+            if ( !loop.mRecorded.load( std::memory_order_relaxed ) )
+            {
+                TraceModule::get().incrementAtomicVariable( TraceAtomicVariable::LOOP_STALLS );
+            }
+            record( loop, previousStage, startMs, nowMs, false );
+        }
+    }
+    if ( ( stage == nullptr ) && ( previousStage == nullptr ) )
+    {
+        return;
+    }
+    loop.mRecorded.store( false, std::memory_order_relaxed );
+    // The start is written before the stage, so that check() can detect a stage changing while it is read
+    loop.mStageStartMs.store( nowMs, std::memory_order_release );
+    loop.mStage.store( stage, std::memory_order_release );
+}
+
+void
+StallWatchdog::record( const Loop &loop, const char *stage, Timestamp startMs, Timestamp nowMs, bool ongoing )
+{
+    StallRecord stallRecord;
+    stallRecord.stage = stage;
+    stallRecord.durationMs = nowMs - startMs;
+    stallRecord.startTimeMs = FastClock::systemTimeMs( ClockPrecision::COARSE ) - stallRecord.durationMs;
+    stallRecord.ongoing = ongoing;
+    std::lock_guard<std::mutex> lock( mMutex );
+    stallRecord.loopName = loop.mName;
+    if ( mRecords.size() >= RECORD_COUNT )
+    {
+        mRecords.pop_front();
+    }
+    mRecords.push_back( std::move( stallRecord ) );
+}
+
+size_t
+StallWatchdog::check()
+{
+    auto thresholdMs = getThreshold();
+    if ( thresholdMs == 0U )
+    {
+        return 0;
+    }
+    auto nowMs = FastClock::monotonicTimeMs( ClockPrecision::COARSE );
+    size_t stalls = 0;
+    for ( auto &loop : mLoops )
+    {
+        if ( !loop.mUsed.load( std::memory_order_acquire ) )
+        {
+            continue;
+        }
+        auto startMs = loop.mStageStartMs.load( std::memory_order_acquire );
+        const char *stage = loop.mStage.load( std::memory_order_acquire );
+        if ( ( stage == nullptr ) || ( startMs != loop.mStageStartMs.load( std::memory_order_acquire ) ) ||
+             ( nowMs < startMs + thresholdMs ) || loop.mRecorded.exchange( true, std::memory_order_relaxed ) )
+        {
+            continue;
+        }
+        TraceModule::get().incrementAtomicVariable( TraceAtomicVariable::LOOP_STALLS );
+        record( loop, stage, startMs, nowMs, true );
+        stalls++;
+        mLogger.warn( "StallWatchdog::check", [&]() {
+            std::lock_guard<std::mutex> lock( mMutex );
+            return "Loop " + loop.mName + " is in stage " + stage + " since " + std::to_string( nowMs - startMs ) +
+                   " ms";
+        } );
+    }
+    return stalls;
+}
+
+std::vector<StallRecord>
+StallWatchdog::takeRecords()
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    std::vector<StallRecord> records( std::make_move_iterator( mRecords.begin() ),
+                                      std::make_move_iterator( mRecords.end() ) );
+    mRecords.clear();
+    return records;
+}
+
+bool
+StallWatchdog::start()
+{
+    // Prevent concurrent stop/init
+    std::lock_guard<std::mutex> lock( mThreadMutex );
+    mShouldStop.store( false );
+    if ( !mThread.create( doWork, this, "fwPLWatchdog" ) )
+    {
+        mLogger.error( "StallWatchdog::start", " Watchdog Thread failed to start " );
+        return false;
+    }
+    mLogger.trace( "StallWatchdog::start",
+                   " Watchdog Thread started with threshold " + std::to_string( getThreshold() ) + " ms" );
+    return true;
+}
+
+bool
+StallWatchdog::stop()
+{
+    if ( !mThread.isValid() || !mThread.isActive() )
+    {
+        return true;
+    }
+    std::lock_guard<std::mutex> lock( mThreadMutex );
+    mShouldStop.store( true, std::memory_order_relaxed );
+    mWait.notify();
+    mThread.release();
+    mLogger.trace( "StallWatchdog::stop", " Watchdog Thread stopped " );
+    mShouldStop.store( false, std::memory_order_relaxed );
+    return !mThread.isActive();
+}
+
+bool
+StallWatchdog::isAlive()
+{
+    return mThread.isValid() && mThread.isActive();
+}
+
+bool
+StallWatchdog::shouldStop() const
+{
+    return mShouldStop.load( std::memory_order_relaxed );
+}
+
+void
+StallWatchdog::doWork( void *data )
+{
+    auto *watchdog = static_cast<StallWatchdog *>( data );
+    while ( !watchdog->shouldStop() )
+    {
+        auto thresholdMs = watchdog->getThreshold();
+        watchdog->mWait.wait( ( thresholdMs > 0U ) ? std::max( thresholdMs / 2U, MIN_CHECK_PERIOD_MS )
+                                                   : DISABLED_CHECK_PERIOD_MS );
+        if ( watchdog->shouldStop() )
+        {
+            break;
+        }
+        watchdog->check();
+    }
+}
+
+} // namespace Linux
+} // namespace Platform
+} // namespace IoTFleetWise
+} // namespace Aws
+#endif // IOTFLEETWISE_LINUX
@@ -15,8 +15,16 @@
 // Includes
 
 #include "Thread.h"
+#include "LoggingModule.h"
+#include <algorithm>
+#include <climits>
+#include <mutex>
+#include <pthread.h>
+#include <sched.h>
 #include <string>
 #include <sys/prctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
 #include <unistd.h>
 
 namespace Aws
@@ -27,18 +35,149 @@ namespace Platform
 {
 namespace Linux
 {
+namespace
+{
+std::mutex gThreadConfigsMutex;
+std::map<std::string, ThreadConfig> gThreadConfigs;
+// Kernel thread IDs and names of the named threads whose worker function runs
+std::mutex gRunningThreadsMutex;
+std::map<pid_t, std::string> gRunningThreads;
+} // namespace
+
+void
+Thread::setConfigs( std::map<std::string, ThreadConfig> configs )
+{
+    std::lock_guard<std::mutex> lock( gThreadConfigsMutex );
+    gThreadConfigs = std::move( configs );
+}
+
+std::map<std::string, ThreadConfig>
+Thread::getConfigs()
+{
+    std::lock_guard<std::mutex> lock( gThreadConfigsMutex );
+    return gThreadConfigs;
+}
+
+bool
+Thread::findConfig( const std::string &name, ThreadConfig &config )
+{
+    std::lock_guard<std::mutex> lock( gThreadConfigsMutex );
+    auto exact = gThreadConfigs.find( name );
+    if ( exact != gThreadConfigs.end() )
+    {
+        config = exact->second;
+        return true;
+    }
+    size_t longestPrefix = 0;
+    bool found = false;
+    for ( const auto &entry : gThreadConfigs )
+    {
+        const auto &pattern = entry.first;
+        if ( pattern.empty() || ( pattern.back() != '*' ) )
+        {
+            continue;
+        }
+        auto prefixLength = pattern.size() - 1;
+        if ( ( name.compare( 0, prefixLength, pattern, 0, prefixLength ) == 0 ) && ( name.size() >= prefixLength ) &&
+             ( ( !found ) || ( prefixLength > longestPrefix ) ) )
+        {
+            config = entry.second;
+            longestPrefix = prefixLength;
+            found = true;
+        }
+    }
+    return found;
+}
+
+bool
+Thread::applyConfigsToRunningThreads()
+{
+    std::lock_guard<std::mutex> lock( gRunningThreadsMutex );
+    bool success = true;
+    for ( const auto &thread : gRunningThreads )
+    {
+        ThreadConfig config;
+        if ( findConfig( thread.second, config ) )
+        {
+            success = applyConfigToThread( thread.first, config ) && success;
+        }
+    }
+    return success;
+}
+
+bool
+Thread::applyConfigToCurrentThread( const ThreadConfig &config )
+{
+    return applyConfigToThread( static_cast<pid_t>( syscall( SYS_gettid ) ), config );
+}
 
 bool
-Thread::create( WorkerFunction workerFunction, void *execParam )
+Thread::applyConfigToThread( pid_t threadId, const ThreadConfig &config )
+{
+    // On Linux the affinity, the scheduling policy and the nice value are properties of the thread, addressed by its
+    // kernel thread ID
+    bool success = true;
+    if ( !config.cpuAffinity.empty() )
+    {
+        cpu_set_t cpuSet;
+        CPU_ZERO( &cpuSet );
+        for ( auto cpu : config.cpuAffinity )
+        {
+            if ( cpu < CPU_SETSIZE )
+            {
+                CPU_SET( cpu, &cpuSet );
+            }
+        }
+        success = ( sched_setaffinity( threadId, sizeof( cpuSet ), &cpuSet ) == 0 ) && success;
+    }
+    if ( config.schedulingPolicy != ThreadSchedulingPolicy::INHERIT )
+    {
+        int policy = SCHED_OTHER;
+        if ( config.schedulingPolicy == ThreadSchedulingPolicy::FIFO )
+        {
+            policy = SCHED_FIFO;
+        }
+        else if ( config.schedulingPolicy == ThreadSchedulingPolicy::RR )
+        {
+            policy = SCHED_RR;
+        }
+        struct sched_param parameters = {};
+        if ( policy != SCHED_OTHER )
+        {
+            parameters.sched_priority = std::max( sched_get_priority_min( policy ),
+                                                  std::min( sched_get_priority_max( policy ), config.priority ) );
+        }
+        success = ( sched_setscheduler( threadId, policy, &parameters ) == 0 ) && success;
+    }
+    if ( config.hasNice )
+    {
+        success = ( setpriority( PRIO_PROCESS, static_cast<id_t>( threadId ), config.nice ) == 0 ) && success;
+    }
+    return success;
+}
+
+bool
+Thread::create( WorkerFunction workerFunction, void *execParam, const std::string &name )
 {
     mExecParams.mSelf = this;
     mExecParams.mWorkerFunction = workerFunction;
     mExecParams.mParams = execParam;
+    mExecParams.mName = name;
+    mExecParams.mHasConfig = ( !name.empty() ) && findConfig( name, mExecParams.mConfig );
 
     mDone.store( false );
     mTerminateSignal = std::make_unique<Signal>();
 
-    if ( pthread_create( &mThread, nullptr, Thread::workerFunctionWrapper, &mExecParams ) != 0 )
+    pthread_attr_t attributes;
+    pthread_attr_init( &attributes );
+    if ( mExecParams.mHasConfig && ( mExecParams.mConfig.stackSizeBytes > 0U ) )
+    {
+        auto stackSize = std::max( mExecParams.mConfig.stackSizeBytes, static_cast<size_t>( PTHREAD_STACK_MIN ) );
+        pthread_attr_setstacksize( &attributes, stackSize );
+    }
+    auto result = pthread_create( &mThread, &attributes, Thread::workerFunctionWrapper, &mExecParams );
+    pthread_attr_destroy( &attributes );
+    if ( result != 0 )
     {
 
         mThreadId = 0;
@@ -95,11 +234,37 @@ Thread::workerFunctionWrapper( void *params )
     ThreadSettings *threadSettings = static_cast<ThreadSettings *>( params );
     Thread *self = threadSettings->mSelf;
 
+    // Named and configured before the worker function runs, so that it never runs on the wrong CPU
+    if ( !threadSettings->mName.empty() )
+    {
+        SetCurrentThreadName( threadSettings->mName );
+    }
+    if ( threadSettings->mHasConfig && ( !applyConfigToCurrentThread( threadSettings->mConfig ) ) )
+    {
+        LoggingModule logger;
+        logger.warn( "Thread::workerFunctionWrapper",
+                     "Could not apply the complete configuration of thread " + threadSettings->mName +
+                         ", a real-time policy or negative nice value needs CAP_SYS_NICE" );
+    }
+
+    auto threadId = static_cast<pid_t>( syscall( SYS_gettid ) );
+    if ( !threadSettings->mName.empty() )
+    {
+        std::lock_guard<std::mutex> lock( gRunningThreadsMutex );
+        gRunningThreads[threadId] = threadSettings->mName;
+    }
+
     if ( !self->mDone.load() )
     {
         self->mExecParams.mWorkerFunction( self->mExecParams.mParams );
     }
 
+    if ( !threadSettings->mName.empty() )
+    {
+        std::lock_guard<std::mutex> lock( gRunningThreadsMutex );
+        gRunningThreads.erase( threadId );
+    }
+
     self->mDone.store( true );
     // Signal Termination so that the thread can be released.
     self->mTerminateSignal->notify();
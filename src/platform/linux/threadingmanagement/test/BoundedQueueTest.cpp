@@ -0,0 +1,129 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "BoundedQueue.h"
+#include <atomic>
+#include <gtest/gtest.h>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+TEST( BoundedQueueTest, PushPopInOrder )
+{
+    BoundedQueue<std::shared_ptr<int>> queue( 2 );
+    ASSERT_EQ( queue.capacity(), 2 );
+    ASSERT_TRUE( queue.push( std::make_shared<int>( 1 ) ) );
+    auto second = std::make_shared<int>( 2 );
+    ASSERT_TRUE( queue.tryPush( second ) );
+    ASSERT_EQ( second, nullptr );
+    // Full, the element stays with the caller
+    auto third = std::make_shared<int>( 3 );
+    ASSERT_FALSE( queue.tryPush( third ) );
+    ASSERT_NE( third, nullptr );
+    ASSERT_EQ( queue.size(), 2 );
+
+    std::shared_ptr<int> element;
+    ASSERT_TRUE( queue.pop( element ) );
+    ASSERT_EQ( *element, 1 );
+    ASSERT_TRUE( queue.pop( element ) );
+    ASSERT_EQ( *element, 2 );
+    ASSERT_EQ( queue.size(), 0 );
+}
+
+TEST( BoundedQueueTest, CloseWakesUpAndDrains )
+{
+    BoundedQueue<int> queue( 1 );
+    ASSERT_TRUE( queue.push( 1 ) );
+    // Blocks as the queue is full until it is closed
+    std::thread producer( [&queue]() { ASSERT_FALSE( queue.push( 2 ) ); } );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+    queue.close();
+    producer.join();
+
+    // Queued elements can still be popped after close
+    int element = 0;
+    ASSERT_TRUE( queue.pop( element ) );
+    ASSERT_EQ( element, 1 );
+    ASSERT_FALSE( queue.pop( element ) );
+
+    queue.reopen();
+    ASSERT_TRUE( queue.push( 3 ) );
+    ASSERT_TRUE( queue.pop( element ) );
+    ASSERT_EQ( element, 3 );
+}
+
+TEST( BoundedQueueTest, PopWithTimeout )
+{
+    BoundedQueue<int> queue( 2 );
+    int element = 0;
+    ASSERT_FALSE( queue.pop( element, 10 ) );
+    ASSERT_FALSE( queue.isClosed() );
+    ASSERT_TRUE( queue.push( 1 ) );
+    ASSERT_TRUE( queue.pop( element, 10 ) );
+    ASSERT_EQ( element, 1 );
+
+    std::thread producer( [&queue]() {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 20 ) );
+        queue.push( 2 );
+    } );
+    ASSERT_TRUE( queue.pop( element, 10000 ) );
+    ASSERT_EQ( element, 2 );
+    producer.join();
+
+    queue.close();
+    ASSERT_FALSE( queue.pop( element, 10000 ) );
+    ASSERT_TRUE( queue.isClosed() );
+}
+
+TEST( BoundedQueueTest, MultipleProducersAndConsumers )
+{
+    constexpr int ELEMENTS_PER_PRODUCER = 1000;
+    BoundedQueue<int> queue( 4 );
+    std::atomic<int> sum{ 0 };
+    std::atomic<int> count{ 0 };
+    std::vector<std::thread> consumers;
+    for ( int i = 0; i < 3; i++ )
+    {
+        consumers.emplace_back( [&]() {
+            int element = 0;
+            while ( queue.pop( element ) )
+            {
+                sum += element;
+                count++;
+            }
+        } );
+    }
+    std::vector<std::thread> producers;
+    for ( int i = 0; i < 2; i++ )
+    {
+        producers.emplace_back( [&queue]() {
+            for ( int j = 1; j <= ELEMENTS_PER_PRODUCER; j++ )
+            {
+                queue.push( j );
+            }
+        } );
+    }
+    for ( auto &producer : producers )
+    {
+        producer.join();
+    }
+    queue.close();
+    for ( auto &consumer : consumers )
+    {
+        consumer.join();
+    }
+    ASSERT_EQ( count, 2 * ELEMENTS_PER_PRODUCER );
+    ASSERT_EQ( sum, ELEMENTS_PER_PRODUCER * ( ELEMENTS_PER_PRODUCER + 1 ) );
+}
@@ -0,0 +1,108 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "InstrumentedMutex.h"
+#include <chrono>
+#include <gtest/gtest.h>
+#include <map>
+#include <string>
+#include <thread>
+
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+namespace
+{
+class MetricsCollector : public IMetricsReceiver
+{
+public:
+    void
+    setMetric( const std::string &name, double value, const std::string &unit ) override
+    {
+        static_cast<void>( unit );
+        mMetrics[name] = value;
+    }
+
+    std::map<std::string, double> mMetrics;
+};
+} // namespace
+
+TEST( InstrumentedMutexTest, CountsContentionPerName )
+{
+    if ( !MutexContention::isCompiledIn() )
+    {
+        GTEST_SKIP() << "Built without FWE_MUTEX_CONTENTION_TRACING";
+    }
+    auto &contention = MutexContention::get();
+    InstrumentedMutex first( "mutexTest" );
+    InstrumentedMutex second( "mutexTest" );
+    auto mutexId = contention.getMutexId( "mutexTest" );
+    ASSERT_NE( mutexId, MutexContention::INVALID_MUTEX_ID );
+
+    // Nothing is counted while disabled
+    {
+        std::lock_guard<InstrumentedMutex> lock( first );
+    }
+    ASSERT_EQ( contention.getTotal( mutexId, MutexCounter::ACQUISITIONS ), 0 );
+
+    contention.setEnabled( true );
+    {
+        std::lock_guard<InstrumentedMutex> lock( first );
+    }
+    {
+        std::unique_lock<InstrumentedMutex> lock( second, std::try_to_lock );
+        ASSERT_TRUE( lock.owns_lock() );
+    }
+    ASSERT_EQ( contention.getTotal( mutexId, MutexCounter::ACQUISITIONS ), 2 );
+    ASSERT_EQ( contention.getTotal( mutexId, MutexCounter::CONTENDED ), 0 );
+
+    // A lock waiting for another thread is contended
+    std::unique_lock<InstrumentedMutex> held( first );
+    std::thread waiter( [&first]() {
+        std::lock_guard<InstrumentedMutex> lock( first );
+    } );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 20 ) );
+    held.unlock();
+    waiter.join();
+    contention.setEnabled( false );
+    ASSERT_EQ( contention.getTotal( mutexId, MutexCounter::ACQUISITIONS ), 4 );
+    ASSERT_EQ( contention.getTotal( mutexId, MutexCounter::CONTENDED ), 1 );
+    ASSERT_GE( contention.getTotal( mutexId, MutexCounter::WAIT_TIME_US ), 10000 );
+
+    MetricsCollector collector;
+    contention.forwardToMetricsReceiver( &collector );
+    ASSERT_EQ( collector.mMetrics["mutexAcquisitions_mutexTest"], 4.0 );
+    ASSERT_EQ( collector.mMetrics["mutexContended_mutexTest"], 1.0 );
+    ASSERT_GE( collector.mMetrics["mutexWaitTimeUs_mutexTest"], 10000.0 );
+
+    // The next period only reports mutexes which were taken since
+    collector.mMetrics.clear();
+    contention.forwardToMetricsReceiver( &collector );
+    ASSERT_EQ( collector.mMetrics.count( "mutexAcquisitions_mutexTest" ), 0 );
+}
+
+TEST( InstrumentedMutexTest, NotCountedWhenFull )
+{
+    auto &contention = MutexContention::get();
+    for ( uint32_t i = 0; i < MutexContention::MAX_MUTEXES; i++ )
+    {
+        contention.getMutexId( "mutexTestFill" + std::to_string( i ) );
+    }
+    ASSERT_EQ( contention.getMutexId( "mutexTestOverflow" ), MutexContention::INVALID_MUTEX_ID );
+    InstrumentedMutex mutex( "mutexTestOverflow" );
+    contention.setEnabled( true );
+    {
+        std::lock_guard<InstrumentedMutex> lock( mutex );
+    }
+    contention.setEnabled( false );
+    ASSERT_EQ( contention.getTotal( MutexContention::INVALID_MUTEX_ID, MutexCounter::ACQUISITIONS ), 0 );
+}
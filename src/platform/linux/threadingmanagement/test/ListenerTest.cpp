@@ -0,0 +1,132 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "Listener.h"
+#include <atomic>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+namespace
+{
+class CountingListener
+{
+public:
+    virtual ~CountingListener() = default;
+
+    virtual void
+    onEvent( int value )
+    {
+        mSum += value;
+    }
+
+    std::atomic<int> mSum{ 0 };
+};
+
+class SubscribingListener : public CountingListener
+{
+public:
+    SubscribingListener( ThreadListeners<CountingListener> &listeners, CountingListener *other )
+        : mListeners( listeners )
+        , mOther( other )
+    {
+    }
+
+    void
+    onEvent( int value ) override
+    {
+        CountingListener::onEvent( value );
+        mListeners.unSubscribeListener( this );
+        mListeners.subscribeListener( mOther );
+    }
+
+private:
+    ThreadListeners<CountingListener> &mListeners;
+    CountingListener *mOther;
+};
+} // namespace
+
+/**
+ * @brief Validates subscribe and unsubscribe and that a modification from a callback only applies to the next
+ * notification
+ */
+TEST( ListenerTest, ModifyDuringNotification )
+{
+    ThreadListeners<CountingListener> listeners;
+    CountingListener other;
+    SubscribingListener subscribing( listeners, &other );
+    ASSERT_TRUE( listeners.subscribeListener( &subscribing ) );
+    ASSERT_FALSE( listeners.subscribeListener( &subscribing ) );
+    ASSERT_EQ( listeners.size(), 1 );
+
+    listeners.notifyListeners<int>( &CountingListener::onEvent, 2 );
+    ASSERT_EQ( subscribing.mSum, 2 );
+    ASSERT_EQ( other.mSum, 0 );
+    ASSERT_EQ( listeners.size(), 1 );
+
+    listeners.notifyListeners<int>( &CountingListener::onEvent, 3 );
+    ASSERT_EQ( subscribing.mSum, 2 );
+    ASSERT_EQ( other.mSum, 3 );
+
+    ASSERT_TRUE( listeners.unSubscribeListener( &other ) );
+    ASSERT_FALSE( listeners.unSubscribeListener( &other ) );
+    ASSERT_EQ( listeners.size(), 0 );
+}
+
+/**
+ * @brief Validates that notifications from several threads see every listener that stays subscribed while others
+ * are added and removed
+ */
+TEST( ListenerTest, NotifyWhileSubscribing )
+{
+    ThreadListeners<CountingListener> listeners;
+    CountingListener permanent;
+    ASSERT_TRUE( listeners.subscribeListener( &permanent ) );
+
+    const int notifyCount = 10000;
+    std::atomic<bool> stop{ false };
+    std::thread modifier( [&listeners, &stop]() {
+        std::vector<CountingListener> transient( 8 );
+        while ( !stop )
+        {
+            for ( auto &listener : transient )
+            {
+                listeners.subscribeListener( &listener );
+            }
+            for ( auto &listener : transient )
+            {
+                listeners.unSubscribeListener( &listener );
+            }
+        }
+    } );
+    std::vector<std::thread> notifiers;
+    for ( int i = 0; i < 2; i++ )
+    {
+        notifiers.emplace_back( [&listeners]() {
+            for ( int j = 0; j < notifyCount; j++ )
+            {
+                listeners.notifyListeners<int>( &CountingListener::onEvent, 1 );
+            }
+        } );
+    }
+    for ( auto &notifier : notifiers )
+    {
+        notifier.join();
+    }
+    stop = true;
+    modifier.join();
+    ASSERT_EQ( permanent.mSum, 2 * notifyCount );
+    ASSERT_EQ( listeners.size(), 1 );
+}
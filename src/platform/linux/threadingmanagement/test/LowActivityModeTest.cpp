@@ -0,0 +1,105 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+
+#include "LowActivityMode.h"
+#include <chrono>
+#include <gtest/gtest.h>
+#include <limits>
+#include <sys/prctl.h>
+#include <thread>
+
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+TEST( LowActivityModeTest, Disabled )
+{
+    LowActivityMode mode;
+    ASSERT_FALSE( mode.isEnabled() );
+    mode.onIgnition( false );
+    mode.checkBusSilence();
+    ASSERT_FALSE( mode.isActive() );
+    ASSERT_EQ( mode.getIdleWaitTimeMs( 100 ), 100 );
+    ASSERT_EQ( mode.getDeadlineWaitTimeMs( 10, 100 ), 10 );
+    ASSERT_EQ( mode.getDeadlineWaitTimeMs( std::numeric_limits<uint32_t>::max(), 100 ), 100 );
+    LowActivityMode::Config config;
+    config.wakeupTickMs = 0;
+    ASSERT_FALSE( mode.init( config ) );
+}
+
+TEST( LowActivityModeTest, EnterOnBusSilenceAndLeaveOnBusActivity )
+{
+    LowActivityMode mode;
+    LowActivityMode::Config config;
+    config.busSilenceTimeMs = 50;
+    config.timerSlackNs = 2000000;
+    ASSERT_TRUE( mode.init( config ) );
+    mode.checkBusSilence();
+    ASSERT_FALSE( mode.isActive() );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 60 ) );
+    mode.checkBusSilence();
+    ASSERT_TRUE( mode.isActive() );
+    ASSERT_TRUE( mode.getIdleWaitTimeMs( 100 ) == Signal::WaitWithPredicate );
+    ASSERT_EQ( prctl( PR_GET_TIMERSLACK, 0, 0, 0, 0 ), 2000000 );
+
+    Signal wakeUp;
+    mode.addWakeUpSignal( wakeUp );
+    mode.onBusActivity( ClockHandler::getClock()->timeSinceEpochMs() );
+    ASSERT_FALSE( mode.isActive() );
+    auto start = std::chrono::steady_clock::now();
+    wakeUp.wait( 10000 );
+    ASSERT_LT( std::chrono::steady_clock::now() - start, std::chrono::seconds( 5 ) );
+    mode.removeWakeUpSignal( wakeUp );
+    ASSERT_EQ( mode.getIdleWaitTimeMs( 100 ), 100 );
+    ASSERT_NE( prctl( PR_GET_TIMERSLACK, 0, 0, 0, 0 ), 2000000 );
+}
+
+TEST( LowActivityModeTest, Ignition )
+{
+    LowActivityMode mode;
+    ASSERT_TRUE( mode.init( LowActivityMode::Config() ) );
+    mode.onIgnition( false );
+    ASSERT_TRUE( mode.isActive() );
+    // Bus traffic while the ignition is off does not wake up the vehicle
+    mode.onBusActivity( ClockHandler::getClock()->timeSinceEpochMs() );
+    ASSERT_TRUE( mode.isActive() );
+    mode.onCloudMessage();
+    ASSERT_FALSE( mode.isActive() );
+    mode.onIgnition( false );
+    ASSERT_TRUE( mode.isActive() );
+    mode.onIgnition( true );
+    ASSERT_FALSE( mode.isActive() );
+    // Without a configured bus silence time only the ignition enters the mode
+    mode.checkBusSilence();
+    ASSERT_FALSE( mode.isActive() );
+}
+
+TEST( LowActivityModeTest, DeadlinesAlignedToTick )
+{
+    LowActivityMode mode;
+    LowActivityMode::Config config;
+    config.wakeupTickMs = 1000;
+    ASSERT_TRUE( mode.init( config ) );
+    mode.onIgnition( false );
+    ASSERT_TRUE( mode.getDeadlineWaitTimeMs( std::numeric_limits<uint32_t>::max(), 100 ) == Signal::WaitWithPredicate );
+    ASSERT_EQ( mode.getDeadlineWaitTimeMs( 0, 100 ), 0 );
+    auto now = ClockHandler::getClock()->timeSinceEpochMs();
+    auto waitTimeMs = mode.getDeadlineWaitTimeMs( 10, 100 );
+    ASSERT_GE( waitTimeMs, 10 );
+    ASSERT_LT( waitTimeMs, 1010 );
+    // Allow for the clock advancing between the two reads
+    auto remainder = ( now + waitTimeMs ) % 1000;
+    ASSERT_TRUE( ( remainder == 0 ) || ( remainder >= 990 ) );
+    mode.reset();
+    ASSERT_FALSE( mode.isActive() );
+    ASSERT_EQ( mode.getDeadlineWaitTimeMs( 10, 100 ), 10 );
+}
@@ -0,0 +1,189 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "SerialTaskExecutor.h"
+#include <atomic>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+TEST( SerialTaskExecutorTest, TasksOfAQueueRunInOrder )
+{
+    SerialTaskExecutor executor( 4 );
+    ASSERT_TRUE( executor.start() );
+    ASSERT_TRUE( executor.isAlive() );
+    auto queueId = executor.createQueue( 100 );
+    std::vector<int> order;
+    std::atomic<int> running{ 0 };
+    std::atomic<bool> overlapped{ false };
+    for ( int i = 0; i < 100; i++ )
+    {
+        ASSERT_TRUE( executor.post( queueId, [&, i]() {
+            overlapped = overlapped || ( ++running > 1 );
+            order.push_back( i );
+            running--;
+        } ) );
+    }
+    executor.removeQueue( queueId );
+    ASSERT_FALSE( overlapped );
+    ASSERT_EQ( order.size(), 100 );
+    for ( int i = 0; i < 100; i++ )
+    {
+        ASSERT_EQ( order[static_cast<size_t>( i )], i );
+    }
+    // The queue is gone
+    ASSERT_FALSE( executor.post( queueId, []() {} ) );
+    ASSERT_TRUE( executor.stop() );
+    ASSERT_FALSE( executor.isAlive() );
+}
+
+TEST( SerialTaskExecutorTest, QueuesRunInParallel )
+{
+    SerialTaskExecutor executor( 2 );
+    ASSERT_TRUE( executor.start() );
+    auto first = executor.createQueue();
+    auto second = executor.createQueue();
+    // The first queue blocks until the second ran, which needs a second worker
+    std::atomic<bool> secondRan{ false };
+    std::atomic<bool> firstSawSecond{ false };
+    ASSERT_TRUE( executor.post( first, [&]() {
+        for ( int i = 0; ( i < 100 ) && ( !secondRan ); i++ )
+        {
+            std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+        }
+        firstSawSecond = secondRan.load();
+    } ) );
+    ASSERT_TRUE( executor.post( second, [&]() { secondRan = true; } ) );
+    executor.removeQueue( first );
+    executor.removeQueue( second );
+    ASSERT_TRUE( firstSawSecond );
+    ASSERT_TRUE( executor.stop() );
+}
+
+TEST( SerialTaskExecutorTest, FullQueueRejects )
+{
+    SerialTaskExecutor executor( 1 );
+    auto queueId = executor.createQueue( 2 );
+    ASSERT_EQ( executor.getQueueCapacity( queueId ), 2 );
+    // Not accepted before start
+    ASSERT_FALSE( executor.post( queueId, []() {} ) );
+    ASSERT_TRUE( executor.start() );
+
+    std::mutex blocker;
+    std::unique_lock<std::mutex> blocked( blocker );
+    std::atomic<int> runs{ 0 };
+    auto task = [&]() {
+        std::lock_guard<std::mutex> lock( blocker );
+        runs++;
+    };
+    ASSERT_TRUE( executor.post( queueId, task ) );
+    // Wait until the worker took the first task, which then waits for the blocker
+    while ( executor.getPendingTaskCount( queueId ) > 0 )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+    ASSERT_TRUE( executor.post( queueId, task ) );
+    ASSERT_TRUE( executor.post( queueId, task ) );
+    ASSERT_EQ( executor.getPendingTaskCount( queueId ), 2 );
+    ASSERT_FALSE( executor.post( queueId, task ) );
+    blocked.unlock();
+
+    // The pending tasks still run on stop, new ones are rejected
+    ASSERT_TRUE( executor.stop() );
+    ASSERT_EQ( runs, 3 );
+    ASSERT_FALSE( executor.post( queueId, task ) );
+    executor.removeQueue( queueId );
+}
+
+TEST( SerialTaskExecutorTest, TaskPostsToItsOwnQueue )
+{
+    SerialTaskExecutor executor( 1 );
+    ASSERT_TRUE( executor.start() );
+    auto queueId = executor.createQueue( 1 );
+    std::atomic<int> runs{ 0 };
+    std::function<void()> task = [&]() {
+        if ( ++runs < 5 )
+        {
+            executor.post( queueId, task );
+        }
+    };
+    ASSERT_TRUE( executor.post( queueId, task ) );
+    // The running task no longer occupies the queue, so the next one fits
+    for ( int i = 0; ( i < 100 ) && ( runs < 5 ); i++ )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+    }
+    executor.removeQueue( queueId );
+    ASSERT_EQ( runs, 5 );
+    ASSERT_TRUE( executor.stop() );
+}
+
+TEST( SerialTaskExecutorTest, DelayedTasks )
+{
+    SerialTaskExecutor executor( 1 );
+    auto queueId = executor.createQueue( 1 );
+    // Not accepted before start
+    ASSERT_FALSE( executor.postAfter( queueId, 0, []() {} ) );
+    ASSERT_TRUE( executor.start() );
+
+    std::mutex orderMutex;
+    std::vector<int> order;
+    auto append = [&]( int i ) {
+        std::lock_guard<std::mutex> lock( orderMutex );
+        order.push_back( i );
+    };
+    auto start = std::chrono::steady_clock::now();
+    std::atomic<bool> lateRan{ false };
+    ASSERT_TRUE( executor.postAfter( queueId, 100, [&]() {
+        append( 3 );
+        lateRan = std::chrono::steady_clock::now() - start >= std::chrono::milliseconds( 100 );
+    } ) );
+    ASSERT_TRUE( executor.postAfter( queueId, 50, [&]() { append( 2 ); } ) );
+    ASSERT_TRUE( executor.post( queueId, [&]() { append( 1 ); } ) );
+    // The delayed tasks do not count against the capacity
+    ASSERT_EQ( executor.getPendingTaskCount( queueId ), 1 );
+    for ( int i = 0; ( i < 100 ) && ( !lateRan ); i++ )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+    }
+    ASSERT_TRUE( lateRan );
+    ASSERT_EQ( order, std::vector<int>( { 1, 2, 3 } ) );
+
+    // A periodic task stops with the removal of its queue, without waiting for its next run
+    std::atomic<int> runs{ 0 };
+    std::function<void()> periodic = [&]() {
+        runs++;
+        executor.postAfter( queueId, 10000, periodic );
+    };
+    ASSERT_TRUE( executor.post( queueId, periodic ) );
+    while ( runs == 0 )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+    auto removeStart = std::chrono::steady_clock::now();
+    executor.removeQueue( queueId );
+    ASSERT_LT( std::chrono::steady_clock::now() - removeStart, std::chrono::seconds( 5 ) );
+    ASSERT_EQ( runs, 1 );
+    ASSERT_FALSE( executor.postAfter( queueId, 0, []() {} ) );
+
+    // Stopping drops the delayed tasks of the remaining queues
+    auto otherQueueId = executor.createQueue();
+    std::atomic<bool> dropped{ true };
+    ASSERT_TRUE( executor.postAfter( otherQueueId, 10000, [&]() { dropped = false; } ) );
+    ASSERT_TRUE( executor.stop() );
+    ASSERT_TRUE( dropped );
+}
@@ -0,0 +1,84 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "Signal.h"
+#include <atomic>
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <thread>
+
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+namespace
+{
+void
+busyWaitUs( int64_t us )
+{
+    auto end = std::chrono::steady_clock::now() + std::chrono::microseconds( us );
+    while ( std::chrono::steady_clock::now() < end )
+    {
+    }
+}
+} // namespace
+
+/**
+ * A reader notifies the consumer for every frame, like the CAN data source for a full 1 Mbit/s bus with about
+ * 8000 frames per second, i.e. one frame every 125 us. The consumer processes the available frames for the given
+ * time per wakeup and then waits again. Reports the share of notifications that needed a wakeup system call.
+ */
+static void
+BM_notifyPerFrame( benchmark::State &state )
+{
+    const int64_t frameIntervalUs = 125;
+    const auto processingUs = state.range( 0 );
+    const int framesPerIteration = 1000;
+    uint64_t notifications = 0;
+    uint64_t wakeups = 0;
+    for ( auto _ : state )
+    {
+        Signal signal;
+        std::atomic<int> produced( 0 );
+        std::atomic<bool> done( false );
+        std::thread consumer( [&]() {
+            int consumed = 0;
+            while ( !done || ( consumed < produced ) )
+            {
+                signal.wait( 10 );
+                if ( consumed < produced )
+                {
+                    consumed = produced;
+                    busyWaitUs( processingUs );
+                }
+            }
+        } );
+        for ( int i = 0; i < framesPerIteration; i++ )
+        {
+            busyWaitUs( frameIntervalUs );
+            produced++;
+            notifications++;
+            if ( signal.notify() )
+            {
+                wakeups++;
+            }
+        }
+        done = true;
+        signal.notify();
+        consumer.join();
+    }
+    state.counters["notifications"] = static_cast<double>( notifications );
+    state.counters["wakeupSyscalls"] = static_cast<double>( wakeups );
+    state.counters["syscallsPerNotify"] = static_cast<double>( wakeups ) / static_cast<double>( notifications );
+}
+BENCHMARK( BM_notifyPerFrame )->Arg( 0 )->Arg( 500 )->Iterations( 3 )->Unit( benchmark::kMillisecond );
+
+BENCHMARK_MAIN();
@@ -0,0 +1,82 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+
+#include "Signal.h"
+#include <atomic>
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+TEST( SignalTest, WaitReturnsImmediatelyIfNotified )
+{
+    Signal signal;
+    signal.notify();
+    auto start = std::chrono::steady_clock::now();
+    signal.wait( 10000 );
+    ASSERT_LT( std::chrono::steady_clock::now() - start, std::chrono::seconds( 5 ) );
+}
+
+TEST( SignalTest, WaitTimesOutWithoutNotify )
+{
+    for ( auto spinCount : { 0U, 1000U } )
+    {
+        Signal signal;
+        signal.setWaitStrategy( spinCount, 10 );
+        auto start = std::chrono::steady_clock::now();
+        signal.wait( 50 );
+        ASSERT_GE( std::chrono::steady_clock::now() - start, std::chrono::milliseconds( 50 ) );
+    }
+}
+
+TEST( SignalTest, NotificationIsConsumedByOneWait )
+{
+    Signal signal;
+    signal.setWaitStrategy( 100, 10 );
+    signal.notify();
+    signal.notify();
+    signal.wait( 10000 );
+    auto start = std::chrono::steady_clock::now();
+    signal.wait( 50 );
+    ASSERT_GE( std::chrono::steady_clock::now() - start, std::chrono::milliseconds( 50 ) );
+}
+
+TEST( SignalTest, NoNotificationIsLost )
+{
+    // Without spinning every wait blocks, with spinning most notifications are seen before blocking
+    for ( auto spinCount : { 0U, 1000U } )
+    {
+        Signal request;
+        Signal response;
+        request.setWaitStrategy( spinCount, 10 );
+        response.setWaitStrategy( spinCount, 10 );
+        constexpr int ROUND_TRIPS = 1000;
+        std::atomic<int> served( 0 );
+        std::thread server( [&]() {
+            while ( served < ROUND_TRIPS )
+            {
+                request.wait( Signal::WaitWithPredicate );
+                served++;
+                response.notify();
+            }
+        } );
+        for ( int i = 0; i < ROUND_TRIPS; i++ )
+        {
+            request.notify();
+            response.wait( Signal::WaitWithPredicate );
+        }
+        server.join();
+        ASSERT_EQ( served, ROUND_TRIPS );
+    }
+}
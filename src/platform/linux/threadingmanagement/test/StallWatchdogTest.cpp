@@ -0,0 +1,150 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "StallWatchdog.h"
+#include "FastClock.h"
+#include "TraceModule.h"
+#include <chrono>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+namespace
+{
+// Waits until the coarse clock read by the watchdog has advanced by durationMs since startMs, as it can tick slower
+// than a sleep of a few milliseconds
+void
+waitForCoarseClock( Timestamp startMs, uint64_t durationMs )
+{
+    while ( FastClock::monotonicTimeMs( ClockPrecision::COARSE ) - startMs < durationMs )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+}
+} // namespace
+
+TEST( StallWatchdogTest, SlowStageRecordedWhenLeft )
+{
+    StallWatchdog watchdog;
+    watchdog.setThreshold( 20 );
+    auto loopId = watchdog.registerLoop( "loop" );
+    ASSERT_NE( loopId, StallWatchdog::INVALID_LOOP_ID );
+    auto stalls = TraceModule::get().getAtomicVariable( TraceAtomicVariable::LOOP_STALLS );
+
+    watchdog.enter( loopId, "fast" );
+    watchdog.enter( loopId, "slow" );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+    watchdog.idle( loopId );
+    // Waiting is not a stall
+    std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+    watchdog.idle( loopId );
+    ASSERT_EQ( watchdog.check(), 0 );
+
+    auto records = watchdog.takeRecords();
+    ASSERT_EQ( records.size(), 1 );
+    ASSERT_EQ( records[0].loopName, "loop" );
+    ASSERT_STREQ( records[0].stage, "slow" );
+    ASSERT_GE( records[0].durationMs, 20 );
+    ASSERT_FALSE( records[0].ongoing );
+    ASSERT_EQ( TraceModule::get().getAtomicVariable( TraceAtomicVariable::LOOP_STALLS ), stalls + 1 );
+    ASSERT_TRUE( watchdog.takeRecords().empty() );
+    watchdog.unregisterLoop( loopId );
+}
+
+TEST( StallWatchdogTest, StuckStageRecordedByCheckOnce )
+{
+    StallWatchdog watchdog;
+    watchdog.setThreshold( 20 );
+    auto loopId = watchdog.registerLoop( "loop" );
+    auto stalls = TraceModule::get().getAtomicVariable( TraceAtomicVariable::LOOP_STALLS );
+
+    watchdog.enter( loopId, "stuck" );
+    ASSERT_EQ( watchdog.check(), 0 );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+    ASSERT_EQ( watchdog.check(), 1 );
+    ASSERT_EQ( watchdog.check(), 0 );
+    watchdog.enter( loopId, "next" );
+
+    // Recorded while stuck and with the complete duration, but counted once
+    auto records = watchdog.takeRecords();
+    ASSERT_EQ( records.size(), 2 );
+    ASSERT_TRUE( records[0].ongoing );
+    ASSERT_FALSE( records[1].ongoing );
+    ASSERT_STREQ( records[1].stage, "stuck" );
+    ASSERT_GE( records[1].durationMs, records[0].durationMs );
+    ASSERT_EQ( TraceModule::get().getAtomicVariable( TraceAtomicVariable::LOOP_STALLS ), stalls + 1 );
+    watchdog.unregisterLoop( loopId );
+}
+
+TEST( StallWatchdogTest, DisabledAndLimits )
+{
+    StallWatchdog watchdog;
+    auto loopId = watchdog.registerLoop( "loop" );
+    watchdog.enter( loopId, "slow" );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 30 ) );
+    ASSERT_EQ( watchdog.check(), 0 );
+    watchdog.idle( loopId );
+    ASSERT_TRUE( watchdog.takeRecords().empty() );
+    // An invalid loop is ignored
+    watchdog.setThreshold( 1 );
+    watchdog.enter( StallWatchdog::INVALID_LOOP_ID, "slow" );
+    watchdog.idle( StallWatchdog::INVALID_LOOP_ID );
+
+    // The flight recorder keeps the newest records
+    for ( size_t i = 0; i < StallWatchdog::RECORD_COUNT + 1; i++ )
+    {
+        watchdog.enter( loopId, ( i == 0 ) ? "first" : "other" );
+        waitForCoarseClock( FastClock::monotonicTimeMs( ClockPrecision::COARSE ), 1 );
+        watchdog.idle( loopId );
+    }
+    auto records = watchdog.takeRecords();
+    ASSERT_EQ( records.size(), StallWatchdog::RECORD_COUNT );
+    ASSERT_STREQ( records[0].stage, "other" );
+    watchdog.unregisterLoop( loopId );
+
+    for ( uint32_t i = 0; i < StallWatchdog::MAX_LOOPS; i++ )
+    {
+        ASSERT_EQ( watchdog.registerLoop( "loop" ), i );
+    }
+    ASSERT_EQ( watchdog.registerLoop( "loop" ), StallWatchdog::INVALID_LOOP_ID );
+}
+
+TEST( StallWatchdogTest, HeartbeatOfThread )
+{
+    auto &watchdog = StallWatchdog::get();
+    watchdog.takeRecords();
+    watchdog.setThreshold( 20 );
+    ASSERT_TRUE( watchdog.start() );
+    ASSERT_TRUE( watchdog.isAlive() );
+    std::thread loop( []() {
+        Thread::SetCurrentThreadName( "fwTestLoop" );
+        StallWatchdog::Heartbeat heartbeat;
+        heartbeat.enter( "sleep" );
+        std::this_thread::sleep_for( std::chrono::milliseconds( 200 ) );
+        heartbeat.idle();
+    } );
+    loop.join();
+    ASSERT_TRUE( watchdog.stop() );
+    ASSERT_FALSE( watchdog.isAlive() );
+    watchdog.setThreshold( 0 );
+
+    auto records = watchdog.takeRecords();
+    ASSERT_EQ( records.size(), 2 );
+    ASSERT_EQ( records[0].loopName, "fwTestLoop" );
+    ASSERT_TRUE( records[0].ongoing );
+    ASSERT_EQ( records[1].loopName, "fwTestLoop" );
+    ASSERT_FALSE( records[1].ongoing );
+    ASSERT_GE( records[1].durationMs, 150 );
+}
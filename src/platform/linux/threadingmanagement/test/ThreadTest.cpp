@@ -14,7 +14,14 @@
 
 #include "Thread.h"
 
+#include <algorithm>
+#include <atomic>
 #include <gtest/gtest.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string>
+#include <sys/prctl.h>
+#include <sys/resource.h>
 
 using namespace Aws::IoTFleetWise::Platform::Linux;
 void
@@ -36,3 +43,153 @@ TEST( ThreadTest, ThreadCPUUsageInfo )
     ASSERT_TRUE( !thread.isValid() );
     ASSERT_TRUE( !thread.isActive() );
 }
+
+namespace
+{
+struct ConfiguredThreadObservation
+{
+    std::string name;
+    uint32_t cpuCount{ 0 };
+    uint32_t firstCpu{ 0 };
+    int nice{ 0 };
+    size_t stackSize{ 0 };
+};
+
+void
+observeConfiguredThread( void *data )
+{
+    auto *observation = static_cast<ConfiguredThreadObservation *>( data );
+    char name[16] = {};
+    prctl( PR_GET_NAME, name, 0, 0, 0 );
+    observation->name = name;
+    cpu_set_t cpuSet;
+    CPU_ZERO( &cpuSet );
+    pthread_getaffinity_np( pthread_self(), sizeof( cpuSet ), &cpuSet );
+    observation->cpuCount = static_cast<uint32_t>( CPU_COUNT( &cpuSet ) );
+    while ( ( observation->firstCpu < CPU_SETSIZE ) && ( !CPU_ISSET( observation->firstCpu, &cpuSet ) ) )
+    {
+        observation->firstCpu++;
+    }
+    observation->nice = getpriority( PRIO_PROCESS, 0 );
+    pthread_attr_t attributes;
+    pthread_getattr_np( pthread_self(), &attributes );
+    pthread_attr_getstacksize( &attributes, &observation->stackSize );
+    pthread_attr_destroy( &attributes );
+}
+} // namespace
+
+TEST( ThreadTest, FindConfigByName )
+{
+    ThreadConfig consumers;
+    consumers.nice = 1;
+    ThreadConfig firstConsumer;
+    firstConsumer.nice = 2;
+    ThreadConfig all;
+    all.nice = 3;
+    Thread::setConfigs( { { "fwDIConsumer*", consumers }, { "fwDIConsumer1", firstConsumer }, { "fw*", all } } );
+    ThreadConfig config;
+    ASSERT_TRUE( Thread::findConfig( "fwDIConsumer1", config ) );
+    ASSERT_EQ( config.nice, 2 );
+    ASSERT_TRUE( Thread::findConfig( "fwDIConsumer2", config ) );
+    ASSERT_EQ( config.nice, 1 );
+    ASSERT_TRUE( Thread::findConfig( "fwRetry1", config ) );
+    ASSERT_EQ( config.nice, 3 );
+    ASSERT_FALSE( Thread::findConfig( "other", config ) );
+    Thread::setConfigs( {} );
+    ASSERT_FALSE( Thread::findConfig( "fwDIConsumer1", config ) );
+}
+
+TEST( ThreadTest, ApplyConfigOnCreate )
+{
+    // Pin to the last CPU this process may run on
+    cpu_set_t allowedCpus;
+    CPU_ZERO( &allowedCpus );
+    ASSERT_EQ( sched_getaffinity( 0, sizeof( allowedCpus ), &allowedCpus ), 0 );
+    uint32_t lastCpu = 0;
+    for ( uint32_t cpu = 0; cpu < CPU_SETSIZE; cpu++ )
+    {
+        if ( CPU_ISSET( cpu, &allowedCpus ) )
+        {
+            lastCpu = cpu;
+        }
+    }
+    ThreadConfig config;
+    config.cpuAffinity = { lastCpu };
+    config.schedulingPolicy = ThreadSchedulingPolicy::OTHER;
+    // Raising the nice value does not need privileges
+    config.hasNice = true;
+    config.nice = 5;
+    config.stackSizeBytes = 4U * 1024U * 1024U;
+    Thread::setConfigs( { { "fwTestConf*", config } } );
+
+    ConfiguredThreadObservation observation;
+    Thread thread;
+    ASSERT_TRUE( thread.create( observeConfiguredThread, &observation, "fwTestConf1" ) );
+    // Release before the worker function ran would skip it
+    while ( thread.isActive() )
+    {
+        usleep( 1000 );
+    }
+    thread.release();
+    ASSERT_EQ( observation.name, "fwTestConf1" );
+    ASSERT_EQ( observation.cpuCount, 1 );
+    ASSERT_EQ( observation.firstCpu, lastCpu );
+    ASSERT_EQ( observation.nice, 5 );
+    ASSERT_GE( observation.stackSize, config.stackSizeBytes );
+
+    // Threads without matching configuration are not changed
+    ConfiguredThreadObservation other;
+    ASSERT_TRUE( thread.create( observeConfiguredThread, &other, "fwTestOther" ) );
+    while ( thread.isActive() )
+    {
+        usleep( 1000 );
+    }
+    thread.release();
+    ASSERT_EQ( other.name, "fwTestOther" );
+    ASSERT_EQ( other.nice, getpriority( PRIO_PROCESS, 0 ) );
+    Thread::setConfigs( {} );
+}
+
+namespace
+{
+struct RunningThreadObservation
+{
+    std::atomic<bool> started{ false };
+    std::atomic<bool> configApplied{ false };
+    int nice{ 0 };
+};
+
+void
+observeRunningThread( void *data )
+{
+    auto *observation = static_cast<RunningThreadObservation *>( data );
+    observation->started = true;
+    while ( !observation->configApplied )
+    {
+        usleep( 1000 );
+    }
+    observation->nice = getpriority( PRIO_PROCESS, 0 );
+}
+} // namespace
+
+TEST( ThreadTest, ApplyConfigToRunningThread )
+{
+    Thread::setConfigs( {} );
+    RunningThreadObservation observation;
+    Thread thread;
+    ASSERT_TRUE( thread.create( observeRunningThread, &observation, "fwTestLive1" ) );
+    while ( !observation.started )
+    {
+        usleep( 1000 );
+    }
+    // Raising the nice value does not need privileges
+    ThreadConfig config;
+    config.hasNice = true;
+    config.nice = std::min( 19, getpriority( PRIO_PROCESS, 0 ) + 5 );
+    Thread::setConfigs( { { "fwTestLive*", config } } );
+    ASSERT_TRUE( Thread::applyConfigsToRunningThreads() );
+    observation.configApplied = true;
+    thread.release();
+    ASSERT_EQ( observation.nice, config.nice );
+    Thread::setConfigs( {} );
+}
@@ -0,0 +1,84 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+
+#include "VersionedSharedPtr.h"
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+TEST( VersionedSharedPtrTest, RefreshOnlyOnNewVersion )
+{
+    VersionedSharedPtr<const int> published;
+    std::shared_ptr<const int> copy;
+    uint64_t version = 0;
+    ASSERT_EQ( published.getVersion(), 0 );
+    ASSERT_FALSE( published.refresh( copy, version ) );
+    ASSERT_EQ( copy, nullptr );
+
+    auto first = std::make_shared<const int>( 1 );
+    published.store( first );
+    ASSERT_EQ( published.load(), first );
+    ASSERT_TRUE( published.refresh( copy, version ) );
+    ASSERT_EQ( copy, first );
+    ASSERT_EQ( version, 1 );
+    ASSERT_FALSE( published.refresh( copy, version ) );
+
+    // The reader keeps the old object alive until it refreshes
+    std::weak_ptr<const int> weakFirst = first;
+    first.reset();
+    published.store( std::make_shared<const int>( 2 ) );
+    ASSERT_FALSE( weakFirst.expired() );
+    ASSERT_TRUE( published.refresh( copy, version ) );
+    ASSERT_EQ( *copy, 2 );
+    ASSERT_TRUE( weakFirst.expired() );
+
+    // Publishing nullptr is also a new version
+    published.store( nullptr );
+    ASSERT_TRUE( published.refresh( copy, version ) );
+    ASSERT_EQ( copy, nullptr );
+    ASSERT_EQ( version, 3 );
+}
+
+TEST( VersionedSharedPtrTest, ConcurrentReaders )
+{
+    VersionedSharedPtr<const std::vector<int>> published;
+    published.store( std::make_shared<const std::vector<int>>( 100, 0 ) );
+    std::atomic<bool> stop{ false };
+    std::vector<std::thread> readers;
+    for ( int i = 0; i < 4; i++ )
+    {
+        readers.emplace_back( [&published, &stop]() {
+            std::shared_ptr<const std::vector<int>> copy;
+            uint64_t version = 0;
+            while ( !stop.load() )
+            {
+                published.refresh( copy, version );
+                // Every published vector has the same value in all elements
+                ASSERT_EQ( copy->front(), copy->back() );
+            }
+        } );
+    }
+    for ( int value = 1; value < 1000; value++ )
+    {
+        published.store( std::make_shared<const std::vector<int>>( 100, value ) );
+    }
+    stop.store( true );
+    for ( auto &reader : readers )
+    {
+        reader.join();
+    }
+    ASSERT_EQ( published.getVersion(), 1000 );
+}
@@ -38,6 +38,12 @@ public:
      */
     virtual Timestamp timeSinceEpochMs() const = 0;
 
+    /**
+     * @brief Computes the timestamp since epoch from the system clock
+     * @return timestamp in microseconds
+     */
+    virtual uint64_t timeSinceEpochUs() const = 0;
+
     /**
      * @brief  Convert the current time to "%Y-%m-%d %I:%M:%S %p" format.
      * @return current time in a string format
@@ -0,0 +1,111 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace Platform
+{
+namespace Linux
+{
+/**
+ * @brief Deterministic per device offsets for periodic activities
+ *
+ * When many vehicles power on at the same time, activities running on fixed intervals from boot send their traffic in
+ * synchronized bursts. Each periodic activity starts after an offset instead, which is derived from a hash of the
+ * device ID, e.g. the MQTT client ID, and the name of the activity. So a device keeps its phase across restarts while
+ * the devices of a fleet, and the activities of one device, are spread over the period. A default constructed
+ * instance has no jitter.
+ */
+class DeviceJitter
+{
+public:
+    /**
+     * @brief No jitter, all offsets are 0
+     */
+    DeviceJitter() = default;
+
+    /**
+     * @param deviceId identifies the device, empty for no jitter
+     * @param maxOffsetMs upper bound of all offsets, which bounds the delay of the first occurrence. 0 for no jitter
+     */
+    DeviceJitter( const std::string &deviceId, uint64_t maxOffsetMs )
+        : mSeed( hash( FNV_OFFSET_BASIS, deviceId.c_str() ) )
+        , mMaxOffsetMs( deviceId.empty() ? 0 : maxOffsetMs )
+    {
+    }
+
+    bool
+    isEnabled() const
+    {
+        return mMaxOffsetMs > 0;
+    }
+
+    /**
+     * @brief Offset of the first occurrence of the activity after its start
+     * @param activity name of the activity, activities of one device with different names get different offsets
+     * @param periodMs period of the activity, the offset is below the period and the maximum offset
+     * @return offset in ms, 0 without jitter
+     */
+    uint64_t
+    getOffsetMs( const char *activity, uint64_t periodMs ) const
+    {
+        auto range = std::min( periodMs, mMaxOffsetMs );
+        if ( range == 0 )
+        {
+            return 0;
+        }
+        return mix( hash( mSeed, activity ) ) % range;
+    }
+
+private:
+    static constexpr uint64_t FNV_OFFSET_BASIS = 0xCBF29CE484222325ULL;
+    static constexpr uint64_t FNV_PRIME = 0x100000001B3ULL;
+
+    // FNV-1a, continued from the given hash
+    static uint64_t
+    hash( uint64_t value, const char *text )
+    {
+        for ( ; *text != '\0'; text++ )
+        {
+            value ^= static_cast<uint8_t>( *text );
+            value *= FNV_PRIME;
+        }
+        return value;
+    }
+
+    // Finalizer of SplitMix64, so that similar IDs like consecutive VINs do not give similar offsets
+    static uint64_t
+    mix( uint64_t value )
+    {
+        value = ( value ^ ( value >> 30U ) ) * 0xBF58476D1CE4E5B9ULL;
+        value = ( value ^ ( value >> 27U ) ) * 0x94D049BB133111EBULL;
+        return value ^ ( value >> 31U );
+    }
+
+    uint64_t mSeed{ FNV_OFFSET_BASIS };
+    uint64_t mMaxOffsetMs{ 0 };
+};
+
+} // namespace Linux
+} // namespace Platform
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -0,0 +1,122 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+
+#pragma once
+
+// Includes
+#include "TimeTypes.h"
+#include <ctime>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace Platform
+{
+namespace Linux
+{
+/**
+ * @brief Precision of a FastClock read
+ */
+enum class ClockPrecision
+{
+    // Reads the clock with the full resolution
+    PRECISE,
+    // Reads the value of the last timer tick, typically 1 to 4 ms old, which is cheaper to read
+    COARSE
+};
+
+/**
+ * @brief Non virtual clock reads for loops and per message hot paths
+ *
+ * Unlike ClockHandler::getClock() the functions need neither a shared pointer nor a virtual call, they read the
+ * clocks with clock_gettime which is served from the vDSO without a system call.
+ *
+ * The monotonic time is not changed when NTP or the user sets the system time, so it should be used for all
+ * intervals, timeouts and deadlines. The system time should only be used for timestamps which are compared with
+ * timestamps from outside the process or are serialized.
+ */
+class FastClock
+{
+public:
+    /**
+     * @brief Returns the monotonic time, which has an arbitrary start point
+     * @param precision PRECISE for CLOCK_MONOTONIC or COARSE for CLOCK_MONOTONIC_COARSE
+     * @return monotonic time in milliseconds
+     */
+    static Timestamp
+    monotonicTimeMs( ClockPrecision precision = ClockPrecision::PRECISE )
+    {
+        return readUs( precision == ClockPrecision::COARSE ? CLOCK_MONOTONIC_COARSE : CLOCK_MONOTONIC ) /
+               MICROSECONDS_PER_MILLISECOND;
+    }
+
+    /**
+     * @brief Returns the monotonic time, which has an arbitrary start point
+     * @return monotonic time in microseconds
+     */
+    static uint64_t
+    monotonicTimeUs()
+    {
+        return readUs( CLOCK_MONOTONIC );
+    }
+
+    /**
+     * @brief Returns the system time since epoch
+     * @param precision PRECISE for CLOCK_REALTIME or COARSE for CLOCK_REALTIME_COARSE
+     * @return system time in milliseconds
+     */
+    static Timestamp
+    systemTimeMs( ClockPrecision precision = ClockPrecision::PRECISE )
+    {
+        return readUs( precision == ClockPrecision::COARSE ? CLOCK_REALTIME_COARSE : CLOCK_REALTIME ) /
+               MICROSECONDS_PER_MILLISECOND;
+    }
+
+    /**
+     * @brief Returns the system time since epoch
+     * @return system time in microseconds
+     */
+    static uint64_t
+    systemTimeUs()
+    {
+        return readUs( CLOCK_REALTIME );
+    }
+
+    /**
+     * @brief Returns the CPU time the calling thread used since it started
+     * @return CPU time in microseconds
+     */
+    static uint64_t
+    threadCpuTimeUs()
+    {
+        return readUs( CLOCK_THREAD_CPUTIME_ID );
+    }
+
+private:
+    static uint64_t
+    readUs( clockid_t clockId )
+    {
+        struct timespec time = {};
+        // Can only fail for an invalid clock ID
+        (void)clock_gettime( clockId, &time );
+        return ( static_cast<uint64_t>( time.tv_sec ) * 1000000U ) +
+               ( static_cast<uint64_t>( time.tv_nsec ) / 1000U );
+    }
+};
+
+} // namespace Linux
+} // namespace Platform
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -28,6 +28,26 @@ namespace Linux
 
 using Timestamp = std::uint64_t;
 
+/**
+ * @brief Microseconds elapsed within the millisecond of a Timestamp, from 0 to 999.
+ *
+ * Timestamps stay in milliseconds everywhere. Sources that can time stamp with a higher resolution
+ * carry this fraction next to the millisecond Timestamp, for all other sources it is 0.
+ */
+using TimestampFractionUs = std::uint16_t;
+
+static constexpr uint64_t MICROSECONDS_PER_MILLISECOND = 1000;
+
+/**
+ * @brief Combines a millisecond Timestamp and its microsecond fraction
+ * @return microseconds since epoch
+ */
+inline uint64_t
+toMicroseconds( Timestamp timestampMs, TimestampFractionUs fractionUs )
+{
+    return ( timestampMs * MICROSECONDS_PER_MILLISECOND ) + fractionUs;
+}
+
 } // namespace Linux
 } // namespace Platform
 } // namespace IoTFleetWise
@@ -31,7 +31,8 @@ namespace Linux
 class Timer
 {
 public:
-    using Clock = std::chrono::high_resolution_clock;
+    // Not affected by changes of the system time
+    using Clock = std::chrono::steady_clock;
     using Duration = Clock::duration;
     using DurationUs = std::chrono::microseconds;
     using DurationMs = std::chrono::milliseconds;
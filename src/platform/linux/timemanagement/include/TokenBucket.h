@@ -0,0 +1,154 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "TimeTypes.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace Platform
+{
+namespace Linux
+{
+/**
+ * @brief Rate limiter which allows bursts up to a capacity
+ *
+ * The bucket fills up with ratePerSecond tokens per second up to its capacity, consuming takes tokens out of it.
+ * Requests larger than the capacity are granted once the bucket is full and leave it in debt, so that the average
+ * rate is kept. The bucket is not thread safe and takes the current time as parameter, so that the caller can
+ * check several buckets against the same time. A bucket with a rate of 0 is unlimited.
+ */
+class TokenBucket
+{
+public:
+    /**
+     * @brief Creates an unlimited bucket
+     */
+    TokenBucket() = default;
+
+    /**
+     * @param ratePerSecond tokens added per second, 0 for no limit
+     * @param capacity maximum tokens, which is the largest burst. 0 for one second of the rate
+     * @param nowMs current time, the bucket starts full
+     */
+    TokenBucket( double ratePerSecond, double capacity, Timestamp nowMs )
+        : mRatePerSecond( std::max( 0.0, ratePerSecond ) )
+        , mCapacity( ( capacity > 0.0 ) ? capacity : mRatePerSecond )
+        , mTokens( mCapacity )
+        , mLastRefillMs( nowMs )
+    {
+    }
+
+    bool
+    isLimited() const
+    {
+        return mRatePerSecond > 0.0;
+    }
+
+    /**
+     * @brief Changes the rate and capacity at runtime. The tokens, or the debt, are kept up to the new capacity, so
+     *        that a change does not allow an extra burst. A bucket which was unlimited starts full.
+     */
+    void
+    setRate( double ratePerSecond, double capacity, Timestamp nowMs )
+    {
+        bool wasLimited = isLimited();
+        refill( nowMs );
+        mRatePerSecond = std::max( 0.0, ratePerSecond );
+        mCapacity = ( capacity > 0.0 ) ? capacity : mRatePerSecond;
+        mTokens = wasLimited ? std::min( mTokens, mCapacity ) : mCapacity;
+    }
+
+    /**
+     * @brief Checks whether the tokens can be consumed now, without consuming them
+     */
+    bool
+    canConsume( double tokens, Timestamp nowMs )
+    {
+        refill( nowMs );
+        return ( !isLimited() ) || ( mTokens >= std::min( tokens, mCapacity ) );
+    }
+
+    /**
+     * @brief Consumes the tokens unconditionally, call after canConsume() returned true
+     */
+    void
+    consume( double tokens, Timestamp nowMs )
+    {
+        refill( nowMs );
+        if ( isLimited() )
+        {
+            mTokens -= tokens;
+        }
+    }
+
+    /**
+     * @brief Consumes the tokens if available
+     * @return True if the tokens were consumed
+     */
+    bool
+    tryConsume( double tokens, Timestamp nowMs )
+    {
+        if ( !canConsume( tokens, nowMs ) )
+        {
+            return false;
+        }
+        consume( tokens, nowMs );
+        return true;
+    }
+
+    /**
+     * @brief Time until the tokens can be consumed
+     * @return milliseconds, 0 if they can be consumed now
+     */
+    uint32_t
+    getWaitTimeMs( double tokens, Timestamp nowMs )
+    {
+        if ( canConsume( tokens, nowMs ) )
+        {
+            return 0;
+        }
+        auto missing = std::min( tokens, mCapacity ) - mTokens;
+        return static_cast<uint32_t>( std::ceil( ( missing * 1000.0 ) / mRatePerSecond ) );
+    }
+
+private:
+    void
+    refill( Timestamp nowMs )
+    {
+        // A clock set back only delays the refill
+        if ( nowMs > mLastRefillMs )
+        {
+            mTokens =
+                std::min( mCapacity, mTokens + ( ( static_cast<double>( nowMs - mLastRefillMs ) * mRatePerSecond ) /
+                                                 1000.0 ) );
+        }
+        mLastRefillMs = nowMs;
+    }
+
+    double mRatePerSecond{ 0.0 };
+    double mCapacity{ 0.0 };
+    double mTokens{ 0.0 };
+    Timestamp mLastRefillMs{ 0 };
+};
+
+} // namespace Linux
+} // namespace Platform
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -40,6 +40,14 @@ public:
                 .count() );
     }
 
+    uint64_t
+    timeSinceEpochUs() const override
+    {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::system_clock::now().time_since_epoch() )
+                .count() );
+    }
+
     std::string
     timestampToString() const override
     {
@@ -1,6 +1,7 @@
 #include <benchmark/benchmark.h>
 
 #include "ClockHandler.h"
+#include "FastClock.h"
 
 using namespace Aws::IoTFleetWise::Platform::Linux;
 
@@ -24,4 +25,22 @@ BM_timeSinceEpochMs( benchmark::State &state )
 }
 BENCHMARK( BM_timeSinceEpochMs );
 
+static void
+BM_fastClockMonotonicTimeMs( benchmark::State &state )
+{
+    auto precision = state.range( 0 ) == 0 ? ClockPrecision::PRECISE : ClockPrecision::COARSE;
+    for ( auto _ : state )
+        benchmark::DoNotOptimize( FastClock::monotonicTimeMs( precision ) );
+}
+BENCHMARK( BM_fastClockMonotonicTimeMs )->Arg( 0 )->Arg( 1 );
+
+static void
+BM_fastClockSystemTimeMs( benchmark::State &state )
+{
+    auto precision = state.range( 0 ) == 0 ? ClockPrecision::PRECISE : ClockPrecision::COARSE;
+    for ( auto _ : state )
+        benchmark::DoNotOptimize( FastClock::systemTimeMs( precision ) );
+}
+BENCHMARK( BM_fastClockSystemTimeMs )->Arg( 0 )->Arg( 1 );
+
 BENCHMARK_MAIN();
\ No newline at end of file
@@ -13,6 +13,7 @@
  */
 
 #include "ClockHandler.h"
+#include "FastClock.h"
 
 #include <gtest/gtest.h>
 
@@ -24,3 +25,20 @@ TEST( ClockHandlerTest, timeSinceEpochMs )
     ASSERT_NE( clock.get(), nullptr );
     ASSERT_GT( clock->timeSinceEpochMs(), 0ull );
 }
+
+TEST( ClockHandlerTest, fastClock )
+{
+    auto clock = ClockHandler::getClock();
+    auto systemTimeMs = FastClock::systemTimeMs();
+    ASSERT_LE( systemTimeMs, clock->timeSinceEpochMs() );
+    ASSERT_LE( clock->timeSinceEpochMs() - systemTimeMs, 1000ull );
+    // The coarse clocks lag at most one tick behind
+    ASSERT_LE( FastClock::systemTimeMs( ClockPrecision::COARSE ), FastClock::systemTimeMs() );
+    ASSERT_LE( FastClock::systemTimeMs() - FastClock::systemTimeMs( ClockPrecision::COARSE ), 100ull );
+    ASSERT_LE( FastClock::monotonicTimeMs( ClockPrecision::COARSE ), FastClock::monotonicTimeMs() );
+    ASSERT_LE( FastClock::systemTimeUs() / 1000ull - systemTimeMs, 1000ull );
+
+    auto monotonicTimeUs = FastClock::monotonicTimeUs();
+    ASSERT_LE( monotonicTimeUs / 1000ull, FastClock::monotonicTimeMs() );
+    ASSERT_LE( monotonicTimeUs, FastClock::monotonicTimeUs() );
+}
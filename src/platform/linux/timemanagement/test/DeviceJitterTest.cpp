@@ -0,0 +1,60 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "DeviceJitter.h"
+#include <gtest/gtest.h>
+#include <set>
+#include <string>
+
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+TEST( DeviceJitterTest, NoJitter )
+{
+    ASSERT_FALSE( DeviceJitter().isEnabled() );
+    ASSERT_EQ( DeviceJitter().getOffsetMs( "checkin", 300000 ), 0 );
+    ASSERT_EQ( DeviceJitter( "", 30000 ).getOffsetMs( "checkin", 300000 ), 0 );
+    ASSERT_EQ( DeviceJitter( "vehicle1", 0 ).getOffsetMs( "checkin", 300000 ), 0 );
+    ASSERT_EQ( DeviceJitter( "vehicle1", 30000 ).getOffsetMs( "checkin", 0 ), 0 );
+}
+
+TEST( DeviceJitterTest, DeterministicPerDeviceAndActivity )
+{
+    DeviceJitter jitter( "vehicle1", 30000 );
+    ASSERT_TRUE( jitter.isEnabled() );
+    // The same device gets the same offset after a restart
+    ASSERT_EQ( jitter.getOffsetMs( "checkin", 300000 ),
+               DeviceJitter( "vehicle1", 30000 ).getOffsetMs( "checkin", 300000 ) );
+    ASSERT_NE( jitter.getOffsetMs( "checkin", 300000 ), jitter.getOffsetMs( "persistedDataUpload", 300000 ) );
+    ASSERT_NE( jitter.getOffsetMs( "checkin", 300000 ),
+               DeviceJitter( "vehicle2", 30000 ).getOffsetMs( "checkin", 300000 ) );
+}
+
+TEST( DeviceJitterTest, FleetIsSpreadOverTheRange )
+{
+    // 1000 vehicles with consecutive client IDs, offsets bounded by the period and the maximum offset
+    std::set<uint64_t> secondsUsed;
+    std::set<uint64_t> shortPeriodOffsets;
+    for ( int i = 0; i < 1000; i++ )
+    {
+        DeviceJitter jitter( "vehicle" + std::to_string( i ), 30000 );
+        auto offsetMs = jitter.getOffsetMs( "checkin", 300000 );
+        ASSERT_LT( offsetMs, 30000 );
+        secondsUsed.insert( offsetMs / 1000 );
+        auto shortPeriodOffsetMs = jitter.getOffsetMs( "periodicCollection", 10 );
+        ASSERT_LT( shortPeriodOffsetMs, 10 );
+        shortPeriodOffsets.insert( shortPeriodOffsetMs );
+    }
+    // Every second of the range gets some of the vehicles
+    ASSERT_EQ( secondsUsed.size(), 30 );
+    ASSERT_EQ( shortPeriodOffsets.size(), 10 );
+}
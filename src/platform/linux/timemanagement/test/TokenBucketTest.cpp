@@ -0,0 +1,84 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "TokenBucket.h"
+#include <gtest/gtest.h>
+
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+TEST( TokenBucketTest, UnlimitedBucket )
+{
+    TokenBucket bucket;
+    ASSERT_FALSE( bucket.isLimited() );
+    ASSERT_TRUE( bucket.tryConsume( 1e12, 0 ) );
+    ASSERT_EQ( bucket.getWaitTimeMs( 1e12, 0 ), 0 );
+}
+
+TEST( TokenBucketTest, BurstAndRefill )
+{
+    // 100 tokens per second, bursts of up to 500
+    TokenBucket bucket( 100, 500, 1000 );
+    ASSERT_TRUE( bucket.isLimited() );
+    ASSERT_TRUE( bucket.tryConsume( 300, 1000 ) );
+    ASSERT_TRUE( bucket.tryConsume( 200, 1000 ) );
+    ASSERT_FALSE( bucket.tryConsume( 10, 1000 ) );
+    ASSERT_EQ( bucket.getWaitTimeMs( 10, 1000 ), 100 );
+    ASSERT_FALSE( bucket.tryConsume( 10, 1050 ) );
+    ASSERT_TRUE( bucket.tryConsume( 10, 1100 ) );
+
+    // The bucket does not fill up beyond its capacity
+    ASSERT_TRUE( bucket.tryConsume( 500, 100000 ) );
+    ASSERT_FALSE( bucket.canConsume( 1, 100000 ) );
+}
+
+TEST( TokenBucketTest, RequestLargerThanCapacity )
+{
+    TokenBucket bucket( 100, 200, 0 );
+    // Granted when full, the debt then delays the next request so the average rate is kept
+    ASSERT_TRUE( bucket.tryConsume( 1000, 0 ) );
+    ASSERT_EQ( bucket.getWaitTimeMs( 1, 0 ), 8010 );
+    ASSERT_FALSE( bucket.tryConsume( 1, 8000 ) );
+    ASSERT_TRUE( bucket.tryConsume( 1, 8010 ) );
+}
+
+TEST( TokenBucketTest, ClockSetBack )
+{
+    TokenBucket bucket( 10, 10, 5000 );
+    ASSERT_TRUE( bucket.tryConsume( 10, 5000 ) );
+    ASSERT_FALSE( bucket.tryConsume( 1, 1000 ) );
+    // Refill continues from the new time
+    ASSERT_TRUE( bucket.tryConsume( 1, 1100 ) );
+}
+
+TEST( TokenBucketTest, ChangeRate )
+{
+    TokenBucket bucket( 100, 500, 0 );
+    ASSERT_TRUE( bucket.tryConsume( 400, 0 ) );
+    // The remaining tokens are kept, a larger capacity does not allow an extra burst
+    bucket.setRate( 1000, 1000, 0 );
+    ASSERT_FALSE( bucket.canConsume( 101, 0 ) );
+    ASSERT_TRUE( bucket.tryConsume( 100, 0 ) );
+    ASSERT_EQ( bucket.getWaitTimeMs( 100, 0 ), 100 );
+    // A smaller capacity caps the tokens
+    bucket.setRate( 10, 20, 1000 );
+    ASSERT_TRUE( bucket.tryConsume( 20, 1000 ) );
+    ASSERT_FALSE( bucket.canConsume( 1, 1000 ) );
+
+    // Unlimited and back, the bucket then starts full
+    bucket.setRate( 0, 0, 1000 );
+    ASSERT_FALSE( bucket.isLimited() );
+    ASSERT_TRUE( bucket.tryConsume( 1e12, 1000 ) );
+    bucket.setRate( 10, 50, 1000 );
+    ASSERT_TRUE( bucket.tryConsume( 50, 1000 ) );
+    ASSERT_FALSE( bucket.canConsume( 1, 1000 ) );
+}
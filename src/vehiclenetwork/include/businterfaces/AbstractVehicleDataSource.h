@@ -15,12 +15,17 @@
 
 // Includes
 #include "Listener.h"
+#include "MemoryArena.h"
+#include "Signal.h"
+#include "VersionedSharedPtr.h"
 #include "VehicleDataSourceListener.h"
 #include "datatypes/VehicleDataMessage.h"
 #include "datatypes/VehicleDataSourceConfig.h"
 #include <boost/lockfree/queue.hpp>
+#include <array>
 #include <boost/lockfree/spsc_queue.hpp>
 #include <memory>
+#include <vector>
 
 namespace Aws
 {
@@ -29,8 +34,11 @@ namespace IoTFleetWise
 namespace VehicleNetwork
 {
 using namespace Aws::IoTFleetWise::Platform::Linux;
-// Single Producer/Consumer buffer. Used for data processing between the source and the consumer.
-using VehicleMessageCircularBuffer = boost::lockfree::spsc_queue<VehicleDataMessage>;
+// Single Producer/Consumer buffer. Used for data processing between the source and the consumer. Allocated from the
+// MemoryArena if one is reserved and accounted to the decoding memory.
+using VehicleMessageCircularBuffer = boost::lockfree::spsc_queue<
+    VehicleDataMessage,
+    boost::lockfree::allocator<ArenaAllocator<VehicleDataMessage, MemorySubsystem::DECODING>>>;
 using VehicleMessageCircularBufferPtr = std::shared_ptr<VehicleMessageCircularBuffer>;
 // Multi Producer/Single Consumer buffer. Used for raw data propagation.
 using VehicleRawMessageCircularBuffer = boost::lockfree::queue<VehicleDataMessage>;
@@ -45,6 +53,9 @@ using VehicleRawMessageCircularBufferPtr = std::shared_ptr<VehicleRawMessageCirc
 class AbstractVehicleDataSource : public ThreadListeners<VehicleDataSourceListener>
 {
 public:
+    // Maximum number of circular buffers a source can split its messages over
+    static constexpr size_t MAX_BUFFER_COUNT = 8;
+
     ~AbstractVehicleDataSource() override = default;
 
     /**
@@ -87,17 +98,58 @@ public:
      */
     virtual void resumeDataAcquisition() = 0;
 
+    /**
+     * @brief Ask the source to only acquire the given messages from the Transport.
+     * Sources that can not filter on the Transport level keep acquiring all messages, so users
+     * of the source must not rely on the filter being applied.
+     * @param messageIDs IDs of all messages that should be acquired. Empty means no message is needed.
+     * @return True if the filter is applied by the source.
+     */
+    virtual bool
+    setMessageFilter( const std::vector<uint32_t> &messageIDs )
+    {
+        static_cast<void>( messageIDs );
+        return false;
+    }
+
     /**
      * @brief Handle of the Vehicle Data Source circular buffer. User of the Data Source
      * can use this object to consume data. The buffer can ONLY be consume
      * from one single consumer thread.
-     * @return shared object pointer to the circular buffer.
+     * Sources can split their messages over multiple buffers by message ID, so that each buffer is consumed
+     * by an own thread. All messages with the same ID are always in the same buffer.
+     * @param index index of the buffer, from 0 to getBufferCount() - 1
+     * @return shared object pointer to the circular buffer, nullptr if there is no buffer with this index
      */
     inline VehicleMessageCircularBufferPtr
-    getBuffer()
+    getBuffer( size_t index = 0 )
+    {
+        return ( index < mCircularBuffPtrs.size() ) ? mCircularBuffPtrs[index] : nullptr;
+    }
+
+    /**
+     * @return the number of circular buffers the messages are split over
+     */
+    inline size_t
+    getBufferCount() const
     {
-        return mCircularBuffPtr;
+        return mCircularBuffPtrs.size();
     }
+    /**
+     * @brief Sets the signal that is notified after new messages have been pushed to the circular buffer,
+     * so that the consumer does not need to poll the buffer. Can be called at any time.
+     * @param dataAvailableSignal signal of the consumer, nullptr to stop notifying
+     * @param index index of the circular buffer the consumer reads from
+     */
+    inline void
+    setDataAvailableSignal( std::shared_ptr<Signal> dataAvailableSignal, size_t index = 0 )
+    {
+        if ( index < MAX_BUFFER_COUNT )
+        {
+            mDataAvailableSignals[index].store( std::move( dataAvailableSignal ) );
+        }
+    }
+
     /**
      * @brief Provide the Transport Protocol Type used by the source.
      * If multiple source configs are provided, they are assumed have the same
@@ -148,8 +200,39 @@ protected:
         static std::atomic<VehicleDataSourceID> sourceID( INVALID_DATA_SOURCE_ID );
         return ++sourceID;
     }
-    // A FIFO queue holding the currently acquired vehicle data messages.
-    VehicleMessageCircularBufferPtr mCircularBuffPtr;
+
+    /**
+     * @brief Selects the circular buffer of a message, the same ID always gives the same buffer.
+     * @param messageID ID of the message
+     * @return index of the buffer
+     */
+    inline size_t
+    getBufferIndex( uint32_t messageID ) const
+    {
+        if ( mCircularBuffPtrs.size() <= 1 )
+        {
+            return 0;
+        }
+        // Fibonacci hashing spreads IDs that only differ in the lower bits over all buffers
+        return static_cast<size_t>( ( messageID * 2654435769U ) >> 16 ) % mCircularBuffPtrs.size();
+    }
+
+    /**
+     * @brief Notifies the consumer about new messages in a circular buffer.
+     * Must only be called from the thread pushing to the circular buffers.
+     * @param index index of the circular buffer
+     */
+    inline void
+    notifyDataAvailable( size_t index = 0 )
+    {
+        mDataAvailableSignals[index].refresh( mDataAvailableSignalCaches[index], mDataAvailableSignalVersions[index] );
+        if ( mDataAvailableSignalCaches[index] != nullptr )
+        {
+            mDataAvailableSignalCaches[index]->notify();
+        }
+    }
+    // FIFO queues holding the currently acquired vehicle data messages, at most MAX_BUFFER_COUNT.
+    std::vector<VehicleMessageCircularBufferPtr> mCircularBuffPtrs;
     // Current active Data Source Configurations
     std::vector<VehicleDataSourceConfig> mConfigs;
     // Unique Identifier of the source.
@@ -161,6 +244,12 @@ protected:
     VehicleDataSourceIfName mIfName;
     // Type of the source
     VehicleDataSourceType mType;
+
+private:
+    std::array<VersionedSharedPtr<Signal>, MAX_BUFFER_COUNT> mDataAvailableSignals;
+    // Copies of mDataAvailableSignals owned by the pushing thread
+    std::array<std::shared_ptr<Signal>, MAX_BUFFER_COUNT> mDataAvailableSignalCaches;
+    std::array<uint64_t, MAX_BUFFER_COUNT> mDataAvailableSignalVersions{};
 };
 using VehicleDataSourcePtr = std::shared_ptr<AbstractVehicleDataSource>;
 } // namespace VehicleNetwork
@@ -0,0 +1,159 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+#if defined( IOTFLEETWISE_LINUX )
+// Includes
+#include "TimeTypes.h"
+#include <cstddef>
+#include <cstdint>
+#include <linux/can.h>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace VehicleNetwork
+{
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+/**
+ * @brief Load and frame rate statistics of one CAN channel
+ *
+ * The statistics are collected by the thread reading the socket, so the class is not thread safe. The counting on
+ * every frame is kept to a few additions and one hash map lookup. Once per window the statistics are published to
+ * the TraceModule as named variables with the channel name as suffix, from where they are printed and forwarded to
+ * the metrics receiver for upload:
+ *  - canBusLoadPercent_<channel>: estimated share of the bit time used by the received frames
+ *  - canFramesPerSecond_<channel>: all received frames
+ *  - canFrameIdPerSecond_<channel>_<id>: frames per second of the busiest CAN IDs
+ *  - canMaxBurst_<channel>: most frames received in one recvmmsg call
+ *  - canKernelDrops_<channel>: frames dropped by the kernel because the socket receive queue was full
+ */
+class CANBusStatistics
+{
+public:
+    static constexpr uint32_t DEFAULT_BITRATE = 500000;
+    static constexpr size_t DEFAULT_TOP_FRAME_IDS = 5;
+    static constexpr Timestamp PUBLISH_INTERVAL_MS = 1000;
+
+    /**
+     * @param channelName suffix of the published variables, typically the interface name
+     * @param bitrate nominal bitrate of the bus in bit/s, used to compute the load
+     * @param topFrameIds number of busiest CAN IDs whose frame rate is published
+     */
+    CANBusStatistics( std::string channelName, uint32_t bitrate, size_t topFrameIds );
+    ~CANBusStatistics();
+
+    CANBusStatistics( const CANBusStatistics & ) = delete;
+    CANBusStatistics &operator=( const CANBusStatistics & ) = delete;
+    CANBusStatistics( CANBusStatistics && ) = delete;
+    CANBusStatistics &operator=( CANBusStatistics && ) = delete;
+
+    /**
+     * @brief Estimates the bits of a frame on the bus from its ID format and data length, without stuff bits
+     *
+     * A standard frame has 47 bits of overhead and an extended frame 67 bits, including the interframe space. CAN FD
+     * frames are counted the same way, so with bit rate switching their load is overestimated.
+     * @param canId CAN ID including CAN_EFF_FLAG for extended IDs
+     * @param length data length in bytes
+     */
+    static uint32_t
+    estimateFrameBits( canid_t canId, uint8_t length )
+    {
+        return ( ( ( canId & CAN_EFF_FLAG ) != 0 ) ? EXTENDED_FRAME_OVERHEAD_BITS : STANDARD_FRAME_OVERHEAD_BITS ) +
+               ( 8U * length );
+    }
+
+    /**
+     * @brief Counts a frame received from the socket
+     */
+    void
+    onFrame( canid_t canId, uint8_t length )
+    {
+        mFrames++;
+        mBits += estimateFrameBits( canId, length );
+        mFramesPerId[canId]++;
+    }
+
+    /**
+     * @brief Counts the frames received with one recvmmsg call
+     */
+    void onBurst( size_t frames );
+
+    /**
+     * @brief Counts frames dropped by the kernel, as reported with SO_RXQ_OVFL
+     */
+    void
+    onKernelDrops( uint32_t droppedFrames )
+    {
+        mKernelDrops += droppedFrames;
+    }
+
+    /**
+     * @brief Publishes the statistics and starts a new window if the window is at least PUBLISH_INTERVAL_MS long
+     * @param nowMs current monotonic time
+     * @return true if the statistics were published
+     */
+    bool publishIfDue( Timestamp nowMs );
+
+    /**
+     * @brief Publishes the statistics of the window until nowMs and starts a new window
+     */
+    void publish( Timestamp nowMs );
+
+    /**
+     * @brief The bus load of the last published window in percent
+     */
+    double
+    getBusLoadPercent() const
+    {
+        return mBusLoadPercent;
+    }
+
+    /**
+     * @brief The busiest CAN IDs of the last published window with their frames per second, busiest first
+     */
+    const std::vector<std::pair<canid_t, double>> &
+    getTopFrameRates() const
+    {
+        return mTopFrameRates;
+    }
+
+private:
+    static constexpr uint32_t STANDARD_FRAME_OVERHEAD_BITS = 47;
+    static constexpr uint32_t EXTENDED_FRAME_OVERHEAD_BITS = 67;
+
+    std::string getFrameIdVariableName( canid_t canId ) const;
+
+    std::string mChannelName;
+    uint32_t mBitrate;
+    size_t mTopFrameIds;
+    Timestamp mWindowStartMs{ 0 };
+    uint64_t mFrames{ 0 };
+    uint64_t mBits{ 0 };
+    size_t mMaxBurst{ 0 };
+    uint64_t mKernelDrops{ 0 };
+    std::unordered_map<canid_t, uint32_t> mFramesPerId;
+    double mBusLoadPercent{ 0.0 };
+    std::vector<std::pair<canid_t, double>> mTopFrameRates;
+};
+} // namespace VehicleNetwork
+} // namespace IoTFleetWise
+} // namespace Aws
+#endif // IOTFLEETWISE_LINUX
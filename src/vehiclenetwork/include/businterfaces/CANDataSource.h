@@ -16,12 +16,19 @@
 #if defined( IOTFLEETWISE_LINUX )
 // Includes
 #include "AbstractVehicleDataSource.h"
-#include "ClockHandler.h"
+#include "CANBusStatistics.h"
+#include "FastClock.h"
+#include "FootprintProfile.h"
 #include "LoggingModule.h"
 #include "Signal.h"
 #include "Thread.h"
 #include "Timer.h"
 #include <iostream>
+#include <linux/can.h>
+#include <memory>
+#include <mutex>
+#include <sys/socket.h>
+#include <vector>
 
 using namespace Aws::IoTFleetWise::Platform::Linux;
 
@@ -31,6 +38,8 @@ namespace IoTFleetWise
 {
 namespace VehicleNetwork
 {
+class CANDataSourceEventLoop;
+
 /**
  * @brief Linux CAN Bus implementation. Uses Raw Sockets to listen to CAN
  * data on 1 single CAN IF.
@@ -38,11 +47,28 @@ namespace VehicleNetwork
 class CANDataSource : public AbstractVehicleDataSource
 {
 public:
-    static constexpr int PARALLEL_RECEIVED_FRAMES_FROM_KERNEL = 10;
+    // Default number of frames received from the kernel in one syscall, can be changed with receiveBatchSize
+    static constexpr int PARALLEL_RECEIVED_FRAMES_FROM_KERNEL =
+        Platform::Linux::FootprintProfile::PARALLEL_RECEIVED_FRAMES_FROM_KERNEL;
+    // Maximum of receiveBatchSize which is the kernel limit of messages in one recvmmsg call (UIO_MAXIOV)
+    static constexpr size_t MAX_RECEIVE_BATCH_SIZE = 1024;
     static constexpr int DEFAULT_THREAD_IDLE_TIME_MS = 1000;
+    // Above this number of message IDs the kernel filter falls back to a mask based filter, as the kernel
+    // checks every filter entry linearly for each received frame.
+    static constexpr size_t MAX_EXACT_FRAME_FILTERS = 128;
 
     /**
      * @brief Data Source Constructor.
+     *
+     * Besides interfaceName and threadIdleTimeMs the transportProperties of the config can contain
+     * the optional keys receiveBatchSize ( frames per recvmmsg call ), busyPollUs ( SO_BUSY_POLL value )
+     * and idleSpinCount ( empty reads before the thread sleeps ) to trade CPU load against latency.
+     * With microsecondTimestamps set to true the frames additionally carry the microseconds within the
+     * millisecond of their reception time. With decoderThreads set to more than 1 the frames are split by CAN ID
+     * over that many buffers, so that multiple consumer threads can decode the frames of one busy interface.
+     * With busStatistics set to true the bus load, the frame rates of the busiest CAN IDs, the burst sizes and the
+     * kernel drops are published to the TraceModule, see CANBusStatistics. The load is computed for the nominal
+     * bitrate ( default 500000 ), the number of CAN IDs is set with busStatisticsTopIds ( default 5 ).
      * @param useKernelTimestamp the kernel time which is normally more precise will be used
      */
     CANDataSource( bool useKernelTimestamp );
@@ -66,7 +92,47 @@ public:
 
     void suspendDataAcquisition() override;
 
+    /**
+     * @brief Programs CAN_RAW_FILTER on the socket so that the kernel drops all frames not in messageIDs.
+     * The filter is kept and applied again on every connect.
+     * @param messageIDs CAN IDs as received on the socket, including CAN_EFF_FLAG for extended IDs
+     * @return True if the filter is applied or will be applied on connect
+     */
+    bool setMessageFilter( const std::vector<uint32_t> &messageIDs ) override;
+
+    /**
+     * @brief Builds the kernel filter for a set of CAN IDs.
+     * Up to maxExactFilters IDs get one exact filter each. Beyond that one mask filter per frame format
+     * (standard and extended) is built that lets through at least all requested IDs.
+     * @param messageIDs CAN IDs including CAN_EFF_FLAG for extended IDs
+     * @param maxExactFilters maximum number of exact filters
+     * @return the filter entries to be passed to CAN_RAW_FILTER
+     */
+    static std::vector<struct can_filter> buildFrameFilter( const std::vector<uint32_t> &messageIDs,
+                                                            size_t maxExactFilters );
+
+    /**
+     * @brief Lets the socket be serviced by a shared event loop instead of an own thread.
+     * Must be called before connect.
+     * @param eventLoop started event loop, nullptr to use an own thread
+     */
+    void setEventLoop( std::shared_ptr<CANDataSourceEventLoop> eventLoop );
+
+    /**
+     * @brief Receives one batch of frames from the socket and pushes them to the circular buffer.
+     * Called from the own thread or from the event loop, never from both concurrently.
+     * @return number of received frames, 0 or negative if nothing was received
+     */
+    int receiveFrames();
+
 private:
+    // Allocate the buffers for recvmmsg according to mReceiveBatchSize
+    void setupReceiveBuffers();
+    // Publish the average number of frames per syscall and reset the statistic. Returns the frames
+    // received since the last call
+    uint64_t traceReceiveStatistics();
+    // Apply the filter in mFrameFilter on the current socket. mFilterMutex must be held
+    bool applyFrameFilter();
     // Start the bus thread
     bool start();
     // Stop the bus thread
@@ -87,7 +153,6 @@ private:
     mutable std::mutex mThreadMutex;
     Timer mTimer;
     LoggingModule mLogger;
-    std::shared_ptr<const Clock> mClock = ClockHandler::getClock();
     int mSocket{ -1 };
     Platform::Linux::Signal mWait;
     uint32_t mIdleTimeMs{ DEFAULT_THREAD_IDLE_TIME_MS };
@@ -95,6 +160,29 @@ private:
     uint64_t discardedMessages{ 0 };
     bool mUseKernelTimestamp{ true };
     std::atomic<Timestamp> mResumeTime{ 0 };
+    std::mutex mFilterMutex;
+    std::vector<struct can_filter> mFrameFilter;
+    bool mFrameFilterSet{ false };
+    uint32_t mKernelDroppedFrames{ 0 };
+    size_t mReceiveBatchSize{ PARALLEL_RECEIVED_FRAMES_FROM_KERNEL };
+    // If not 0, SO_BUSY_POLL is set on the socket with this value
+    uint32_t mBusyPollUs{ 0 };
+    // Number of times the socket is polled again after an empty read before the thread sleeps
+    uint32_t mIdleSpinCount{ 0 };
+    bool mUseMicrosecondTimestamps{ false };
+    std::vector<struct canfd_frame> mFrames;
+    std::vector<struct iovec> mFrameBuffers;
+    std::vector<struct mmsghdr> mMessages;
+    std::vector<char> mCmsgBuffer;
+    size_t mLastReceived{ 0 };
+    uint64_t mSyscallsWithFrames{ 0 };
+    uint64_t mFramesFromSyscalls{ 0 };
+    Timestamp mLastFrameTime{ 0 };
+    // Set on resume so that frames received before the resume are dropped
+    std::atomic<bool> mWokeUpFromSleep{ false };
+    std::shared_ptr<CANDataSourceEventLoop> mEventLoop;
+    // Only set if the bus statistics are enabled, owned by the thread receiving the frames
+    std::unique_ptr<CANBusStatistics> mBusStatistics;
 };
 } // namespace VehicleNetwork
 } // namespace IoTFleetWise
@@ -0,0 +1,135 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+
+#pragma once
+
+#if defined( IOTFLEETWISE_LINUX )
+// Includes
+#include "LoggingModule.h"
+#include "Thread.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace VehicleNetwork
+{
+class CANDataSource;
+
+/**
+ * @brief Services the sockets of many CANDataSource instances from one single thread using epoll.
+ *
+ * A CANDataSource that is given an event loop does not start its own thread. Instead its socket is
+ * registered here and its frames are received in this thread when the kernel signals them. Every
+ * source still has its own circular buffer, so the consumers and the VehicleDataSourceBinder do not
+ * notice the difference. The sockets of suspended sources are not polled.
+ *
+ * With a cycle handler the thread can also process the received frames further, e.g. decode and inspect them, so
+ * that a whole pipeline runs to completion on this thread.
+ */
+class CANDataSourceEventLoop
+{
+public:
+    static constexpr int MAX_EVENTS_PER_WAIT = 32;
+
+    CANDataSourceEventLoop();
+    ~CANDataSourceEventLoop();
+
+    CANDataSourceEventLoop( const CANDataSourceEventLoop & ) = delete;
+    CANDataSourceEventLoop &operator=( const CANDataSourceEventLoop & ) = delete;
+    CANDataSourceEventLoop( CANDataSourceEventLoop && ) = delete;
+    CANDataSourceEventLoop &operator=( CANDataSourceEventLoop && ) = delete;
+
+    /**
+     * @brief Creates the epoll instance and starts the thread
+     * @return True if the thread is running
+     */
+    bool start();
+
+    /**
+     * @brief Stops the thread. Registered sources stay registered.
+     * @return True if the thread stopped
+     */
+    bool stop();
+
+    /**
+     * @brief Checks if the thread is running
+     */
+    bool isAlive();
+
+    /**
+     * @brief Registers the socket of a source. The socket is not polled until enableSource is called.
+     * @param source the source that receives the frames of the socket
+     * @param socket the non blocking SocketCAN file descriptor
+     * @return True on success
+     */
+    bool addSource( CANDataSource *source, int socket );
+
+    /**
+     * @brief Unregisters a socket. After the call returns the source is not called anymore.
+     * @param socket the socket passed to addSource
+     * @return True on success
+     */
+    bool removeSource( int socket );
+
+    /**
+     * @brief Starts or stops polling a registered socket.
+     * @param socket the socket passed to addSource
+     * @param enabled True to receive frames, false to leave them in the kernel queue
+     * @return True on success
+     */
+    bool enableSource( int socket, bool enabled );
+
+    /**
+     * @brief Sets the handler called on the thread after every wake up, after the frames of the signaled sockets
+     * were received. Can also be called while the thread runs.
+     * @param handler returns the maximum time in milliseconds until it is called again, nullptr to only wait for
+     * the sockets
+     */
+    void setCycleHandler( std::function<uint32_t()> handler );
+
+    /**
+     * @brief Wakes up the thread, which then calls the cycle handler. Can be called from any thread.
+     */
+    void wakeup();
+
+private:
+    static void doWork( void *data );
+    bool shouldStop() const;
+
+    Thread mThread;
+    std::atomic<bool> mShouldStop{ false };
+    std::mutex mThreadMutex;
+    // Protects mSources and makes sure a removed source is not called anymore
+    std::mutex mSourcesMutex;
+    std::map<int, CANDataSource *> mSources;
+    // Protected by mSourcesMutex as well
+    std::function<uint32_t()> mCycleHandler;
+    int mEpollFd{ -1 };
+    // Used to wake up the thread on stop and by wakeup
+    int mWakeupFd{ -1 };
+    uint32_t mID{ 0 };
+    LoggingModule mLogger;
+};
+} // namespace VehicleNetwork
+} // namespace IoTFleetWise
+} // namespace Aws
+#endif // IOTFLEETWISE_LINUX
@@ -0,0 +1,179 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+#if defined( IOTFLEETWISE_LINUX )
+// Includes
+#include "AbstractVehicleDataSource.h"
+#include "LoggingModule.h"
+#include "Signal.h"
+#include "Thread.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace VehicleNetwork
+{
+
+/**
+ * @brief Replays a recorded CAN log file into the circular buffer instead of receiving from a socket, to
+ * reproduce field issues and to benchmark the pipeline deterministically.
+ *
+ * Supported are candump log files ( candump -l or -L ) and Vector ASC files. The file is memory mapped and
+ * parsed while it is replayed, so the log size is not limited by the memory. The replay starts on the first
+ * resumeDataAcquisition and pauses while the acquisition is suspended.
+ */
+class CANLogReplayDataSource : public AbstractVehicleDataSource
+{
+public:
+    enum class LogFormat
+    {
+        CANDUMP,
+        ASC
+    };
+
+    enum class ReplayMode
+    {
+        // Frames are pushed with the original gaps between them
+        REAL_TIME,
+        // The gaps between frames are divided by the replay speed
+        SCALED,
+        // Frames are pushed as soon as there is space in the circular buffer, no frame is discarded
+        AS_FAST_AS_POSSIBLE
+    };
+
+    // Maximum number of frames pushed before the consumer is notified
+    static constexpr size_t REPLAY_BATCH_SIZE = 64;
+    // Time to wait for space in the circular buffer when replaying as fast as possible
+    static constexpr uint32_t FULL_BUFFER_RETRY_MS = 1;
+
+    /**
+     * @brief The transportProperties of the config contain logFile and optionally
+     * - logFormat: candump or asc, by default asc for files ending with .asc and candump otherwise
+     * - channel: only the frames of this candump interface name or ASC channel number are replayed
+     * - replayMode: realTime ( default ), scaled or asFastAsPossible
+     * - replaySpeed: factor by which a scaled replay is faster than real time
+     * - preserveTimestamps: true to keep the log timestamps instead of the replay time. ASC timestamps are
+     *   relative to the start of the recording and are added to the system time at the start of the replay
+     * - loop: true to replay the log again from the start when the end is reached
+     */
+    CANLogReplayDataSource();
+
+    ~CANLogReplayDataSource() override;
+
+    CANLogReplayDataSource( const CANLogReplayDataSource & ) = delete;
+    CANLogReplayDataSource &operator=( const CANLogReplayDataSource & ) = delete;
+    CANLogReplayDataSource( CANLogReplayDataSource && ) = delete;
+    CANLogReplayDataSource &operator=( CANLogReplayDataSource && ) = delete;
+
+    bool init( const std::vector<VehicleDataSourceConfig> &sourceConfigs ) override;
+    bool connect() override;
+
+    bool disconnect() override;
+
+    bool isAlive() final;
+
+    void resumeDataAcquisition() override;
+
+    void suspendDataAcquisition() override;
+
+    /**
+     * @return the number of frames pushed to the circular buffer since connect
+     */
+    uint64_t
+    getReplayedFrames() const
+    {
+        return mReplayedFrames.load( std::memory_order_relaxed );
+    }
+
+    /**
+     * @return true once all frames of the log were replayed. Never true when looping
+     */
+    bool
+    isReplayFinished() const
+    {
+        return mReplayFinished.load( std::memory_order_relaxed );
+    }
+
+private:
+    struct ReplayFrame
+    {
+        // Log time in microseconds
+        uint64_t timeUs{ 0 };
+        // CAN ID including CAN_EFF_FLAG for extended IDs as received from a socket
+        uint32_t id{ 0 };
+        uint8_t length{ 0 };
+        uint8_t data[VehicleDataMessage::MAX_PAYLOAD_SIZE]{};
+    };
+
+    bool start();
+    bool stop();
+    bool shouldStop() const;
+    bool shouldSleep() const;
+    static void doWork( void *data );
+    void unmapLogFile();
+    // Parses the lines of the log until the next frame of the replayed channel, false at the end of the log
+    bool readNextFrame( ReplayFrame &frame );
+    bool parseCandumpLine( const char *begin, const char *end, ReplayFrame &frame ) const;
+    bool parseAscLine( const char *begin, const char *end, ReplayFrame &frame );
+    // Pushes the frames that are due, returns the time in ms until the next frame is due
+    uint32_t replayFrames();
+
+    Thread mThread;
+    std::atomic<bool> mShouldStop{ false };
+    std::atomic<bool> mShouldSleep{ false };
+    mutable std::mutex mThreadMutex;
+    Platform::Linux::Signal mWait;
+    LoggingModule mLogger;
+
+    std::string mLogFilename;
+    LogFormat mLogFormat{ LogFormat::CANDUMP };
+    std::string mChannel;
+    ReplayMode mReplayMode{ ReplayMode::REAL_TIME };
+    double mReplaySpeed{ 1.0 };
+    bool mPreserveTimestamps{ false };
+    bool mLoop{ false };
+
+    int mFileDescriptor{ -1 };
+    const char *mLogData{ nullptr };
+    size_t mLogSize{ 0 };
+    size_t mReadOffset{ 0 };
+    // ASC header settings
+    bool mAscHexBase{ true };
+    bool mAscRelativeTimestamps{ false };
+    uint64_t mAscPreviousTimeUs{ 0 };
+
+    ReplayFrame mPendingFrame;
+    bool mHasPendingFrame{ false };
+    // Set when the relation between the log time and the replay time has to be established again
+    bool mRebase{ true };
+    uint64_t mReplayStartUs{ 0 };
+    uint64_t mLogStartUs{ 0 };
+    uint64_t mReplayStartSystemTimeUs{ 0 };
+    uint64_t mDiscardedFrames{ 0 };
+    std::atomic<uint64_t> mReplayedFrames{ 0 };
+    std::atomic<bool> mReplayFinished{ false };
+};
+} // namespace VehicleNetwork
+} // namespace IoTFleetWise
+} // namespace Aws
+#endif // IOTFLEETWISE_LINUX
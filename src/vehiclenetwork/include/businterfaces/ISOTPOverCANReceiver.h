@@ -78,6 +78,16 @@ public:
      */
     bool receivePDU( std::vector<uint8_t> &pduData );
 
+    /**
+     * @brief Receives a PDU into a buffer of the caller, so that a buffer allocated once can be reused for every
+     *        PDU. Blocks like receivePDU( std::vector<uint8_t> & ).
+     * @param buffer buffer where the PDU data will be filled
+     * @param capacity size of the buffer. MAX_PDU_SIZE fits every PDU, longer PDUs are truncated.
+     * @param size output number of bytes received, 0 if nothing was received
+     * @return True if the PDU is received, False otherwise.
+     */
+    bool receivePDU( uint8_t *buffer, size_t capacity, size_t &size );
+
 private:
     ISOTPOverCANReceiverOptions mReceiverOptions;
     Timer mTimer;
@@ -76,6 +76,14 @@ public:
      */
     bool sendPDU( const std::vector<uint8_t> &pduData );
 
+    /**
+     * @brief Sends the PDU from a buffer of the caller. Blocks like sendPDU( const std::vector<uint8_t> & ).
+     * @param data PDU bytes
+     * @param size number of bytes to send
+     * @return True if send, False otherwise
+     */
+    bool sendPDU( const uint8_t *data, size_t size );
+
 private:
     ISOTPOverCANSenderOptions mSenderOptions;
     Timer mTimer;
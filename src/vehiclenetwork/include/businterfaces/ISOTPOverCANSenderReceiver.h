@@ -78,6 +78,16 @@ public:
      */
     bool receivePDU( std::vector<uint8_t> &pduData );
 
+    /**
+     * @brief Receives a PDU into a buffer of the caller, so that a buffer allocated once can be reused for every
+     *        PDU. Blocks like receivePDU( std::vector<uint8_t> & ).
+     * @param buffer buffer where the PDU data will be filled
+     * @param capacity size of the buffer. MAX_PDU_SIZE fits every PDU, longer PDUs are truncated.
+     * @param size output number of bytes received, 0 if nothing was received
+     * @return True if the PDU is received, False otherwise.
+     */
+    bool receivePDU( uint8_t *buffer, size_t capacity, size_t &size );
+
     /**
      * @brief Sends the PDU over the channel. This API blocks till
      *        all bytes in the PDU are transmitted.
@@ -86,6 +96,34 @@ public:
      */
     bool sendPDU( const std::vector<uint8_t> &pduData );
 
+    /**
+     * @brief Sends the PDU from a buffer of the caller. Blocks like sendPDU( const std::vector<uint8_t> & ).
+     * @param data PDU bytes
+     * @param size number of bytes to send
+     * @return True if send, False otherwise
+     */
+    bool sendPDU( const uint8_t *data, size_t size );
+
+    /**
+     * @brief Returns the file descriptor of the socket, so that callers can wait for PDUs
+     *        of several channels in one poll. It is only valid while connected.
+     * @return socket file descriptor
+     */
+    int
+    getSocket() const
+    {
+        return mSocket;
+    }
+
+    /**
+     * @brief Returns the options the channel was initialized with
+     */
+    const ISOTPOverCANSenderReceiverOptions &
+    getOptions() const
+    {
+        return mSenderReceiverOptions;
+    }
+
 private:
     ISOTPOverCANSenderReceiverOptions mSenderReceiverOptions;
     Timer mTimer;
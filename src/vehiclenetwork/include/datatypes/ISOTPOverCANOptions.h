@@ -14,6 +14,7 @@
 #pragma once
 
 // Includes
+#include <cstddef>
 #include <cstdint>
 #include <string>
 
@@ -27,6 +28,9 @@ namespace VehicleNetwork
 // We relax that a bit e.g. up to 100 ms for network latency.
 const uint32_t P2_TIMEOUT_DEFAULT_MS = 5000; // P2*CAN Max is 5 seconds. To be tuned
 const uint32_t P2_TIMEOUT_INFINITE = 0;
+// Size of a receive buffer that fits every PDU. ISO TP maximum PDU size is 4095, additional bytes are needed
+// for the Linux Networking stack internals.
+const size_t MAX_PDU_SIZE = 5000;
 /**
  * @brief Set of Options a Sender of a PDU must provide to the ISO-TP Stack
  * to establish the Socket between the sender ECU and the receiver ECU.
@@ -0,0 +1,65 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include <cstdint>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace VehicleNetwork
+{
+
+// Image types of the collection schemes, see ImageData.ImageType in collection_schemes.proto
+const uint32_t IMAGE_TYPE_COMPRESSED_JPG = 0;
+const uint32_t IMAGE_TYPE_COMPRESSED_PNG = 1;
+const uint32_t IMAGE_TYPE_RAW_RGB8 = 100;
+const uint32_t IMAGE_TYPE_RAW_BGR8 = 104;
+const uint32_t IMAGE_TYPE_RAW_MONO8 = 108;
+
+/**
+ * @brief Format the frames of an image source are re-encoded to before they are persisted
+ */
+enum class ImageEncoding
+{
+    ORIGINAL, // Frames are kept in the format they are received in
+    JPEG,
+    WEBP
+};
+
+/**
+ * @brief Selection and re-encoding of the frames of a request, applied on the edge before they are persisted.
+ * The default keeps all frames as they are.
+ * @param keepEveryNthFrame Keeps the first and then every Nth frame, 0 and 1 keep all frames
+ * @param keyFramesOnly Keeps only the key frames of H.264 streams. Frames which are not H.264, e.g. still images,
+ * are all key frames.
+ * @param similarityThreshold A frame is skipped if its similarity to the last kept frame, between 0 and 1, is at least
+ * the threshold. 0 disables the comparison.
+ * @param encoding Re-encodes raw frames to this format
+ * @param encodingQuality Quality of the re-encoded frames, 1 to 100
+ */
+struct ImageCaptureOptions
+{
+    uint32_t keepEveryNthFrame{ 0 };
+    bool keyFramesOnly{ false };
+    double similarityThreshold{ 0.0 };
+    ImageEncoding encoding{ ImageEncoding::ORIGINAL };
+    uint32_t encodingQuality{ 90 };
+};
+
+} // namespace VehicleNetwork
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -0,0 +1,329 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace VehicleNetwork
+{
+
+/**
+ * @brief Type of a SyntheticValue. The numeric types match the SignalDataType of the decoder manifest.
+ */
+enum class SyntheticValueType : std::uint8_t
+{
+    UNDEFINED_TYPE,
+    BOOL_TYPE,
+    UINT8_TYPE,
+    UINT16_TYPE,
+    UINT32_TYPE,
+    UINT64_TYPE,
+    INT8_TYPE,
+    INT16_TYPE,
+    INT32_TYPE,
+    INT64_TYPE,
+    FLOAT_TYPE,
+    DOUBLE_TYPE,
+    BYTES_TYPE
+};
+
+/**
+ * @brief Bytes referenced by a SyntheticValue. The memory is owned by the data source and has to stay valid until
+ * the message holding the value was consumed.
+ */
+struct SyntheticBytesView
+{
+    const std::uint8_t *data;
+    std::uint32_t size;
+};
+
+/**
+ * @brief Already decoded value of a signal stored inline with its type, so that values can be created, copied and
+ * queued without heap allocations and read without RTTI.
+ */
+class SyntheticValue
+{
+public:
+    SyntheticValue() = default;
+
+    // Implicit, so that a std::initializer_list of plain values can be passed to SyntheticVehicleDataMessage::setup
+    SyntheticValue( bool value )
+        : mType( SyntheticValueType::BOOL_TYPE )
+    {
+        mValue.boolValue = value;
+    }
+    SyntheticValue( std::uint8_t value )
+        : SyntheticValue( SyntheticValueType::UINT8_TYPE, static_cast<std::uint64_t>( value ) )
+    {
+    }
+    SyntheticValue( std::uint16_t value )
+        : SyntheticValue( SyntheticValueType::UINT16_TYPE, static_cast<std::uint64_t>( value ) )
+    {
+    }
+    SyntheticValue( std::uint32_t value )
+        : SyntheticValue( SyntheticValueType::UINT32_TYPE, static_cast<std::uint64_t>( value ) )
+    {
+    }
+    SyntheticValue( std::uint64_t value )
+        : SyntheticValue( SyntheticValueType::UINT64_TYPE, value )
+    {
+    }
+    SyntheticValue( std::int8_t value )
+        : SyntheticValue( SyntheticValueType::INT8_TYPE, static_cast<std::int64_t>( value ) )
+    {
+    }
+    SyntheticValue( std::int16_t value )
+        : SyntheticValue( SyntheticValueType::INT16_TYPE, static_cast<std::int64_t>( value ) )
+    {
+    }
+    SyntheticValue( std::int32_t value )
+        : SyntheticValue( SyntheticValueType::INT32_TYPE, static_cast<std::int64_t>( value ) )
+    {
+    }
+    SyntheticValue( std::int64_t value )
+        : SyntheticValue( SyntheticValueType::INT64_TYPE, value )
+    {
+    }
+    SyntheticValue( float value )
+        : mType( SyntheticValueType::FLOAT_TYPE )
+    {
+        mValue.floatValue = value;
+    }
+    SyntheticValue( double value )
+        : mType( SyntheticValueType::DOUBLE_TYPE )
+    {
+        mValue.doubleValue = value;
+    }
+    SyntheticValue( SyntheticBytesView value )
+        : mType( SyntheticValueType::BYTES_TYPE )
+    {
+        mValue.bytesValue = value;
+    }
+
+    inline SyntheticValueType
+    getType() const
+    {
+        return mType;
+    }
+
+    /**
+     * @brief Reads the value if it has exactly the type of the argument
+     * @param value the value, unchanged if the type does not match
+     * @return True if the type matches
+     */
+    inline bool
+    get( bool &value ) const
+    {
+        return getAs( SyntheticValueType::BOOL_TYPE, mValue.boolValue, value );
+    }
+    inline bool
+    get( std::uint8_t &value ) const
+    {
+        return getAs( SyntheticValueType::UINT8_TYPE, mValue.uintValue, value );
+    }
+    inline bool
+    get( std::uint16_t &value ) const
+    {
+        return getAs( SyntheticValueType::UINT16_TYPE, mValue.uintValue, value );
+    }
+    inline bool
+    get( std::uint32_t &value ) const
+    {
+        return getAs( SyntheticValueType::UINT32_TYPE, mValue.uintValue, value );
+    }
+    inline bool
+    get( std::uint64_t &value ) const
+    {
+        return getAs( SyntheticValueType::UINT64_TYPE, mValue.uintValue, value );
+    }
+    inline bool
+    get( std::int8_t &value ) const
+    {
+        return getAs( SyntheticValueType::INT8_TYPE, mValue.intValue, value );
+    }
+    inline bool
+    get( std::int16_t &value ) const
+    {
+        return getAs( SyntheticValueType::INT16_TYPE, mValue.intValue, value );
+    }
+    inline bool
+    get( std::int32_t &value ) const
+    {
+        return getAs( SyntheticValueType::INT32_TYPE, mValue.intValue, value );
+    }
+    inline bool
+    get( std::int64_t &value ) const
+    {
+        return getAs( SyntheticValueType::INT64_TYPE, mValue.intValue, value );
+    }
+    inline bool
+    get( float &value ) const
+    {
+        return getAs( SyntheticValueType::FLOAT_TYPE, mValue.floatValue, value );
+    }
+    inline bool
+    get( double &value ) const
+    {
+        return getAs( SyntheticValueType::DOUBLE_TYPE, mValue.doubleValue, value );
+    }
+    inline bool
+    get( SyntheticBytesView &value ) const
+    {
+        return getAs( SyntheticValueType::BYTES_TYPE, mValue.bytesValue, value );
+    }
+
+    /**
+     * @brief Converts a numeric value to double, e.g. for a CollectedSignal
+     * @return the value, 0.0 for bytes and undefined values
+     */
+    inline double
+    toDouble() const
+    {
+        switch ( mType )
+        {
+        case SyntheticValueType::BOOL_TYPE:
+            return mValue.boolValue ? 1.0 : 0.0;
+        case SyntheticValueType::FLOAT_TYPE:
+            return static_cast<double>( mValue.floatValue );
+        case SyntheticValueType::DOUBLE_TYPE:
+            return mValue.doubleValue;
+        case SyntheticValueType::UNDEFINED_TYPE:
+        case SyntheticValueType::BYTES_TYPE:
+            return 0.0;
+        default:
+            return isSigned() ? static_cast<double>( mValue.intValue ) : static_cast<double>( mValue.uintValue );
+        }
+    }
+
+private:
+    SyntheticValue( SyntheticValueType type, std::uint64_t value )
+        : mType( type )
+    {
+        mValue.uintValue = value;
+    }
+    SyntheticValue( SyntheticValueType type, std::int64_t value )
+        : mType( type )
+    {
+        mValue.intValue = value;
+    }
+
+    inline bool
+    isSigned() const
+    {
+        return ( mType >= SyntheticValueType::INT8_TYPE ) && ( mType <= SyntheticValueType::INT64_TYPE );
+    }
+
+    template <typename Stored, typename T>
+    inline bool
+    getAs( SyntheticValueType type, const Stored &stored, T &value ) const
+    {
+        if ( mType != type )
+        {
+            return false;
+        }
+        value = static_cast<T>( stored );
+        return true;
+    }
+
+    SyntheticValueType mType{ SyntheticValueType::UNDEFINED_TYPE };
+    union
+    {
+        bool boolValue;
+        std::uint64_t uintValue;
+        std::int64_t intValue;
+        float floatValue;
+        double doubleValue;
+        SyntheticBytesView bytesValue;
+    } mValue{};
+};
+
+/**
+ * @brief Values of a message stored inline with a fixed capacity, a small vector that never allocates.
+ */
+class SyntheticValueList
+{
+public:
+    /**
+     * @brief Maximum number of values of one message
+     */
+    static constexpr std::size_t MAX_VALUES = 16;
+
+    SyntheticValueList() = default;
+
+    /**
+     * @brief Appends a value
+     * @return False if MAX_VALUES values are stored already
+     */
+    inline bool
+    push_back( const SyntheticValue &value )
+    {
+        if ( mSize >= MAX_VALUES )
+        {
+            return false;
+        }
+        mValues[mSize++] = value;
+        return true;
+    }
+
+    inline void
+    clear()
+    {
+        mSize = 0;
+    }
+
+    inline std::size_t
+    size() const
+    {
+        return mSize;
+    }
+
+    inline bool
+    empty() const
+    {
+        return mSize == 0;
+    }
+
+    inline const SyntheticValue &
+    operator[]( std::size_t index ) const
+    {
+        return mValues[index];
+    }
+
+    inline const SyntheticValue *
+    begin() const
+    {
+        return mValues.data();
+    }
+
+    inline const SyntheticValue *
+    end() const
+    {
+        return mValues.data() + mSize;
+    }
+
+private:
+    std::array<SyntheticValue, MAX_VALUES> mValues{};
+    std::size_t mSize{ 0 };
+};
+
+} // namespace VehicleNetwork
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -0,0 +1,127 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "TimeTypes.h"
+#include "datatypes/SyntheticValue.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace VehicleNetwork
+{
+
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+/**
+ * @brief Vehicle Data Message holding synthetic data i.e. values that were already
+ * decoded or generated by the data source. Raw frames use VehicleDataMessage.
+ * The typed values are stored inline, so that creating, copying and queueing a message never allocates memory on
+ * the heap.
+ */
+class SyntheticVehicleDataMessage
+{
+public:
+    /**
+     * @brief Constructor/destructor
+     */
+    inline SyntheticVehicleDataMessage() = default;
+
+    inline ~SyntheticVehicleDataMessage() = default;
+
+    /**
+     * @brief Unique identifier of the Vehicle Data Message.
+     * @return ID
+     */
+    inline std::uint64_t
+    getMessageID() const
+    {
+        return mID;
+    }
+
+    /**
+     * @brief Synthetic representation of the Message
+     * @return List of typed values
+     */
+    inline const SyntheticValueList &
+    getSyntheticData() const
+    {
+        return mSyntheticData;
+    }
+
+    /**
+     * @brief Timepoint when the Message was acquired from the vehicle
+     * @return Timestamp
+     */
+    inline const Timestamp &
+    getReceptionTimestamp() const
+    {
+        return mTimestamp;
+    }
+
+    /**
+     * @brief Checks if the Message is valid or not.
+     * A message is valid if it has a synthetic representation
+     * @return True if Valid, False if not.
+     */
+    inline bool
+    isValid() const
+    {
+        return !mSyntheticData.empty();
+    }
+
+    /**
+     * @brief Routine to setup a Synthetic Vehicle Data Message.
+     * @param id message ID
+     * @param syntheticData the values, at most SyntheticValueList::MAX_VALUES
+     * @param count number of values
+     * @param timestamp time the values were acquired
+     * @return False and an invalid message if there are too many values
+     */
+    inline bool
+    setup( const std::uint32_t &id, const SyntheticValue *syntheticData, std::size_t count, const Timestamp &timestamp )
+    {
+        mTimestamp = timestamp;
+        mID = id;
+        mSyntheticData.clear();
+        if ( count > SyntheticValueList::MAX_VALUES )
+        {
+            return false;
+        }
+        for ( std::size_t i = 0; i < count; i++ )
+        {
+            mSyntheticData.push_back( syntheticData[i] );
+        }
+        return true;
+    }
+
+    inline bool
+    setup( const std::uint32_t &id, std::initializer_list<SyntheticValue> syntheticData, const Timestamp &timestamp )
+    {
+        return setup( id, syntheticData.begin(), syntheticData.size(), timestamp );
+    }
+
+private:
+    std::uint64_t mID{};
+    SyntheticValueList mSyntheticData;
+    Timestamp mTimestamp{};
+};
+} // namespace VehicleNetwork
+} // namespace IoTFleetWise
+} // namespace Aws
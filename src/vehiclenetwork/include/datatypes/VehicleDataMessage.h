@@ -16,10 +16,10 @@
 // Includes
 #include "TimeTypes.h"
 
-#include <boost/any.hpp>
+#include <array>
+#include <cstddef>
 #include <cstdint>
-#include <string>
-#include <vector>
+#include <cstring>
 namespace Aws
 {
 namespace IoTFleetWise
@@ -30,12 +30,19 @@ namespace VehicleNetwork
 using namespace Aws::IoTFleetWise::Platform::Linux;
 
 /**
- * @brief Generic Structure of a Vehicle Data Message.
- * Every Message has two sub structures i.e. Raw and Synthetic.
+ * @brief Raw Vehicle Data Message as received from the vehicle network.
+ * The payload is stored inline with a fixed capacity big enough for CAN and CAN FD frames,
+ * so that creating, copying and queueing a message never allocates memory on the heap.
+ * Synthetic (already decoded) data is carried by SyntheticVehicleDataMessage instead.
  */
 class VehicleDataMessage
 {
 public:
+    /**
+     * @brief Maximum payload size in bytes. 64 Bytes is the size of a CAN FD frame.
+     */
+    static constexpr std::size_t MAX_PAYLOAD_SIZE = 64;
+
     /**
      * @brief Constructor/destructor
      */
@@ -55,27 +62,22 @@ public:
 
     /**
      * @brief Raw representation of the Message
-     * @return Byte array of the raw data
+     * @return Pointer to the first byte of the raw data. Only getRawDataSize() bytes are valid.
      */
-    // TODO: This API implies a copy of the data from the Network.
-    // In certain Protocol stacks, the raw data can be a shared object.
-    // Instead of Copying, we can use the shared object and work on it instead.
-    // This interface is also not optimized for Standard CAN frames, as the size does not
-    // exceed 8 Bytes. Using a Vector introduces an overhead of 8 extra bytes for the vector handle.
-    inline const std::vector<std::uint8_t> &
-    getRawData()
+    inline const std::uint8_t *
+    getRawData() const
     {
-        return mRawData;
+        return mRawData.data();
     }
 
     /**
-     * @brief Synthetic representation of the Message
-     * @return Array of Any type
+     * @brief Size of the raw representation of the Message
+     * @return Number of valid bytes returned by getRawData()
      */
-    inline const std::vector<boost::any> &
-    getSyntheticData()
+    inline std::size_t
+    getRawDataSize() const
     {
-        return mSyntheticData;
+        return mRawDataSize;
     }
 
     /**
@@ -88,37 +90,65 @@ public:
         return mTimestamp;
     }
 
+    /**
+     * @brief Microseconds within the millisecond of getReceptionTimestamp()
+     * @return 0 if the source does not time stamp with microsecond resolution
+     */
+    inline TimestampFractionUs
+    getReceptionTimestampFractionUs() const
+    {
+        return mTimestampFractionUs;
+    }
+
     /**
      * @brief Checks if the Message is valid or not.
-     * A message is valid if it have either a synthetic or a raw representation
+     * A message is valid if it has a raw representation
      * @return True if Valid, False if not.
      */
     inline bool
     isValid() const
     {
-        return !mSyntheticData.empty() || !mRawData.empty();
+        return mRawDataSize != 0;
     }
 
     /**
-     * @brief Routine to setup a Vehicle Data Message.
+     * @brief Routine to setup a Vehicle Data Message. The payload is copied into the inline storage.
+     * @param id Message ID e.g. the CAN ID
+     * @param rawData pointer to the payload
+     * @param size payload size in bytes
+     * @param timestamp reception time of the message
+     * @param timestampFractionUs microseconds within the millisecond of the reception time
+     * @return False if the payload does not fit into MAX_PAYLOAD_SIZE, in which case the message is invalid
      */
-    inline void
+    inline bool
     setup( const std::uint32_t &id,
-           const std::vector<std::uint8_t> &rawData,
-           const std::vector<boost::any> &syntheticData,
-           const Timestamp &timestamp )
+           const std::uint8_t *rawData,
+           std::size_t size,
+           const Timestamp &timestamp,
+           TimestampFractionUs timestampFractionUs = 0 )
     {
         mTimestamp = timestamp;
+        mTimestampFractionUs = timestampFractionUs;
         mID = id;
-        mRawData = rawData;
-        mSyntheticData = syntheticData;
+        if ( ( size > MAX_PAYLOAD_SIZE ) || ( ( rawData == nullptr ) && ( size != 0 ) ) )
+        {
+            mRawDataSize = 0;
+            return false;
+        }
+        if ( size != 0 )
+        {
+            std::memcpy( mRawData.data(), rawData, size );
+        }
+        mRawDataSize = static_cast<std::uint8_t>( size );
+        return true;
     }
 
 private:
     std::uint64_t mID{};
-    std::vector<std::uint8_t> mRawData;
-    std::vector<boost::any> mSyntheticData;
     Timestamp mTimestamp{};
+    TimestampFractionUs mTimestampFractionUs{};
+    std::uint8_t mRawDataSize{};
+    std::array<std::uint8_t, MAX_PAYLOAD_SIZE> mRawData{};
 };
 } // namespace VehicleNetwork
 } // namespace IoTFleetWise
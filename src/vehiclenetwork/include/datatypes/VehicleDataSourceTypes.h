@@ -50,7 +50,8 @@ enum class VehicleDataSourceProtocol
     RAW_SOCKET,
     DOIP,
     AVB,
-    DDS
+    DDS,
+    UDS
 };
 
 // Vehicle Data Source States
@@ -92,7 +93,8 @@ enum class ECUID
 enum class ECUType
 {
     ENGINE,
-    TRANSMISSION
+    TRANSMISSION,
+    OTHER // Any further ECU found by the functional broadcast
 };
 
 } // namespace VehicleNetwork
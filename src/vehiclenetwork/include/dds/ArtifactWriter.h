@@ -0,0 +1,124 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "BoundedQueue.h"
+#include "LoggingModule.h"
+#include "Thread.h"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace VehicleNetwork
+{
+
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+/**
+ * @brief Writes sensor artifacts to disk on its own threads
+ *
+ * An artifact is handed over with submit() as a list of buffers, which are moved into the writer, so the caller can
+ * continue with the next artifact while the previous one is written. Each artifact is written by one worker thread
+ * with a single gathering write per batch of buffers, without copying the buffers into a stream, and the completion
+ * callback is called on the worker thread once the file is complete. When the workers can not keep up the queue fills
+ * up and submit() blocks, which pushes back on the caller instead of buffering an unbounded amount of artifacts. On
+ * stop the queued artifacts are still written.
+ */
+class ArtifactWriter
+{
+public:
+    static constexpr size_t DEFAULT_QUEUE_SIZE = 4;
+
+    /**
+     * @brief Called on the worker thread once the artifact is written
+     * @param path path of the artifact
+     * @param success false if the artifact could not be written, the file is then removed
+     */
+    using CompletionCallback = std::function<void( const std::string &path, bool success )>;
+
+    /**
+     * @param workerCount     number of threads writing artifacts, at least 1
+     * @param queueSize       capacity of the queue of artifacts waiting to be written
+     */
+    ArtifactWriter( uint32_t workerCount = 1, size_t queueSize = DEFAULT_QUEUE_SIZE );
+    ~ArtifactWriter();
+
+    ArtifactWriter( const ArtifactWriter & ) = delete;
+    ArtifactWriter &operator=( const ArtifactWriter & ) = delete;
+    ArtifactWriter( ArtifactWriter && ) = delete;
+    ArtifactWriter &operator=( ArtifactWriter && ) = delete;
+
+    /**
+     * @brief Starts the worker threads
+     * @return True if all threads are running
+     */
+    bool start();
+
+    /**
+     * @brief Writes the queued artifacts and stops the threads
+     * @return True if all threads stopped
+     */
+    bool stop();
+
+    bool isAlive();
+
+    /**
+     * @brief Queues an artifact for writing, waiting while the queue is full. An existing file at the path is
+     * replaced.
+     * @param path path of the artifact
+     * @param buffers content of the artifact, written one after the other
+     * @param onComplete called once the artifact is written
+     * @return False if the writer is stopped, the artifact is then not written and onComplete not called
+     */
+    bool submit( std::string path, std::vector<std::vector<uint8_t>> buffers, CompletionCallback onComplete );
+
+    /**
+     * @brief Writes the buffers to the file at the path, replacing an existing file
+     * @return False if the file could not be written completely, it is then removed
+     */
+    static bool writeArtifact( const std::string &path, const std::vector<std::vector<uint8_t>> &buffers );
+
+private:
+    struct Artifact
+    {
+        std::string path;
+        std::vector<std::vector<uint8_t>> buffers;
+        CompletionCallback onComplete;
+    };
+
+    struct Worker
+    {
+        ArtifactWriter *mWriter{ nullptr };
+        Thread mThread;
+    };
+
+    static void doWork( void *data );
+
+    BoundedQueue<Artifact> mQueue;
+    std::vector<std::unique_ptr<Worker>> mWorkers;
+    std::mutex mThreadMutex;
+    LoggingModule mLogger;
+};
+
+} // namespace VehicleNetwork
+} // namespace IoTFleetWise
+} // namespace Aws
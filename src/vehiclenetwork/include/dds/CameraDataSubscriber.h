@@ -14,13 +14,15 @@
 #pragma once
 
 // Includes
+#include "ArtifactWriter.h"
 #include "CameraPubSubTypes.h"
 #include "ClockHandler.h"
+#include "FrameProcessor.h"
+#include "FrameRingBuffer.h"
 #include "IDDSSubscriber.h"
 #include "LoggingModule.h"
-#include "Signal.h"
-#include "Thread.h"
 #include "Timer.h"
+#include <deque>
 #include <iostream>
 
 namespace Aws
@@ -36,7 +38,8 @@ using namespace Aws::IoTFleetWise::Platform::Linux;
  * @brief IDDSSusbcriber implementation for the Camera Sensor.
  * This object listens to Camera frame data on a DDS Topic and shares the
  * resulting camera artifact data with the Data Inspection DDS Module via the SensorDataListener
- * notification.
+ * notification. Before an artifact is written, its frames are selected and re-encoded according
+ * to the capture options of the request.
  */
 class CameraDataSubscriber : public IDDSSubscriber
 {
@@ -57,6 +60,12 @@ public:
 
     bool isAlive() override;
 
+    void setPreTriggerRetentionMs( uint32_t retentionMs ) override;
+
+    bool persistFromPreTriggerBuffer( const DDSDataRequest &dataRequest ) override;
+
+    void registerDataRequest( const DDSDataRequest &dataRequest ) override;
+
     /**
      * @brief From DataReaderListener.
      * method to be called by the Data Reader  when the subscriber is matched with a new Writer on the Publisher side.
@@ -67,53 +76,72 @@ public:
 
     /**
      * @brief From DataReaderListener.
-     * method to be called by the Data Reader   when a new message is put on the topic. After this
-     * call, the message is copied into the subscriber and it's removed from the topic.
+     * method to be called by the Data Reader   when a new message is put on the topic. The message
+     * is not taken here, a task on the executor takes it as a loaned sample.
      * @param reader DataReader, temporary one that helps retrieving the data.
      */
     void on_data_available( DataReader *reader ) override;
 
 private:
-    // Start the bus thread
+    // Creates the queues of the subscriber on the executor
     bool start();
-    // Stop the bus thread
+    // Waits for the queued tasks of the subscriber and removes its queues
     bool stop();
-    // atomic state of the bus. If true, we should stop
-    bool shouldStop() const;
-    /**
-     * @brief Main work function.
-     * Typically this function waits on conditional variable until it's set.
-     * The conditional variable gets set when on_data_available is called by the DDS Stack.
-     * After that, in the current phase of implementation,
-     *  we simply raise onSensorArtifactAvailable.
-     *  Next step is to persist the data into a physical location.
-     * @param data data pointer from the stack.
-     */
-    static void doWork( void *data );
-    // stores a Camera frame buffer on disk, in the same location provided in the fileName
+    // Posts a task to take the received responses, unless one is already queued
+    void scheduleTake();
+    // Checks if the write queue has room for another artifact
+    bool canSubmitArtifact() const;
+    // Takes the received responses as loaned samples and hands their frames over to a write task by moving them out
+    // of the loans. The listeners are notified once the artifact is written, so the next response can be taken
+    // while the previous one is written. While the write queue is full the responses stay in the reader, and the
+    // next completed write schedules the take again.
     // TODO: In the current form of the code, the CameraFrames received are appended to the
     // the same file on disk. So the consumer of this file would not know how to recover the
     // frames again/Split the file into frames. We want to do this correctly in future versions
     // of this code, where we would store as a metadata the frame size and/or store the frames
     // in separate artifacts.
-    static bool persistToStorage( const std::vector<CameraFrame> &buffer, const std::string &fileName );
+    void takeAndPersistResponses();
+    // Removes and returns the registered request of the response, a request with default options if there is none
+    DDSDataRequest takeDataRequest( const std::string &dataItemId );
+    // Posts a task selecting and re-encoding the frames as requested and writing them to the artifact at the path
+    bool submitArtifact( std::string artifactPath,
+                         std::vector<std::vector<uint8_t>> frames,
+                         const DDSDataRequest &dataRequest );
+    // Appends the frames that are newer than the newest buffered frame to the pre-trigger buffer
+    void appendToPreTriggerBuffer( const CameraDataItem &dataItem );
+    // Called by the write task once an artifact is written
+    void onArtifactWritten( const std::string &artifactPath, bool success );
+
+    // Artifacts waiting to be written, the responses stay in the reader beyond this
+    static constexpr size_t WRITE_QUEUE_SIZE = 4;
+    // Requests waiting for their response, the oldest ones are dropped beyond this
+    static constexpr size_t MAX_PENDING_REQUESTS = 16;
 
-    Thread mThread;
-    std::atomic<bool> mShouldStop{ false };
     std::atomic<bool> mIsAlive{ false };
-    std::atomic<bool> mNewResponseReceived{ false };
+    std::atomic<bool> mConnected{ false };
+    std::atomic<bool> mTakeScheduled{ false };
+    // Set when the take stopped because the write queue was full
+    std::atomic<bool> mTakeDeferred{ false };
     mutable std::mutex mThreadMutex;
+    // Set if the executor was started by the subscriber because none was shared
+    bool mOwnsExecutor{ false };
+    SerialTaskExecutor::QueueId mTakeQueue{ SerialTaskExecutor::INVALID_QUEUE_ID };
+    SerialTaskExecutor::QueueId mWriteQueue{ SerialTaskExecutor::INVALID_QUEUE_ID };
     Timer mTimer;
     LoggingModule mLogger;
     std::shared_ptr<const Clock> mClock = ClockHandler::getClock();
-    Platform::Linux::Signal mWait;
-    CameraDataItem mDataItem;
     DomainParticipant *mDDSParticipant{ nullptr };
     Subscriber *mDDSSubscriber{ nullptr };
     Topic *mDDSTopic{ nullptr };
     DataReader *mDDSReader{ nullptr };
     TypeSupport mDDStype{ new CameraDataItemPubSubType() };
     std::string mCachePath;
+    FrameRingBuffer mPreTriggerBuffer;
+    // Only used by the write tasks, which run one after the other
+    std::unique_ptr<FrameProcessor> mFrameProcessor;
+    std::mutex mPendingRequestsMutex;
+    std::deque<DDSDataRequest> mPendingRequests;
+    bool mPreTriggerBufferEnabled{ false };
     uint32_t mSourceID{ 0 };
 };
 } // namespace VehicleNetwork
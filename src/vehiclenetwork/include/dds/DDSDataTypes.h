@@ -14,12 +14,19 @@
 #pragma once
 
 // Includes
+#include "datatypes/ImageCaptureOptions.h"
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <vector>
 
 // Default settings for the DDS Transport.
 const uint32_t SEND_BUFFER_SIZE_BYTES = 0;    // Fallback to Kernel settings
 const uint32_t RECEIVE_BUFFER_SIZE_BYTES = 0; // Fallback to Kernel settings
+// Name of the ring file of the pre-trigger buffer in the temporary cache location
+const char *const PRE_TRIGGER_BUFFER_FILE_NAME = "pre-trigger-buffer.ring";
+// Maximum age of the newest frame in the pre-trigger buffer for the buffer to be used for a request
+const uint64_t PRE_TRIGGER_BUFFER_MAX_AGE_MS = 1000;
 namespace Aws
 {
 namespace IoTFleetWise
@@ -76,6 +83,11 @@ enum class DDSTransportType
  * @param temporaryCacheLocation AWS IoT FleetWise caches the chunks of data received from the DDS
  * Network into disk locations an intermediate steps before sending them to the cloud location.
  * Each source should provide a location.
+ * @param preTriggerBufferSizeBytes Size of the ring file in the temporary cache location keeping the most recent
+ * frames of the source, so that the frames before a trigger are taken from it instead of being requested from the
+ * source. 0 disables the buffer.
+ * @param frameWidth Width in pixels of the raw frames of the source, needed to re-encode them. 0 if unknown.
+ * @param frameHeight Height in pixels of the raw frames of the source, needed to re-encode them. 0 if unknown.
  */
 struct DDSDataSourceConfig
 {
@@ -89,10 +101,26 @@ struct DDSDataSourceConfig
     DDSWriterName writerName;
     std::string temporaryCacheLocation;
     DDSTransportType transportType;
+    size_t preTriggerBufferSizeBytes{ 0 };
+    uint32_t frameWidth{ 0 };
+    uint32_t frameHeight{ 0 };
 };
 
 using DDSDataSourcesConfig = std::vector<DDSDataSourceConfig>;
 
+/**
+ * Metadata representing an DDS Data Request.
+ * Refer to DataInspection::EventMetadata for more details
+ */
+struct DDSDataRequest
+{
+    uint32_t eventID;
+    uint32_t negativeOffsetMs;
+    uint32_t positiveOffsetMs;
+    uint32_t imageType;
+    ImageCaptureOptions captureOptions;
+};
+
 } // namespace VehicleNetwork
 } // namespace IoTFleetWise
 } // namespace Aws
@@ -0,0 +1,91 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "IFrameEncoder.h"
+#include "LoggingModule.h"
+#include "datatypes/ImageCaptureOptions.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace VehicleNetwork
+{
+
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+/**
+ * @brief Selects and re-encodes the frames of an artifact before it is persisted
+ *
+ * The frames are first reduced to the key frames, if requested, then to every Nth of the remaining ones, and then the
+ * frames that are too similar to the last kept frame are dropped. The similarity is compared on a sample of the bytes
+ * of the frames, which is meaningful for raw frames and for frames of the same encoder with similar content. The kept
+ * frames are re-encoded by the encoder if they are raw frames of the configured size; frames which can not be encoded
+ * are kept in their original format. Not thread safe, the frames of one source are processed one artifact after the
+ * other.
+ */
+class FrameProcessor
+{
+public:
+    // Bytes compared per frame for the similarity
+    static constexpr size_t SIMILARITY_SAMPLE_COUNT = 4096;
+
+    /**
+     * @param encoder       re-encodes raw frames, nullptr to never re-encode
+     * @param frameWidth    width of the raw frames of the source in pixels, 0 if unknown
+     * @param frameHeight   height of the raw frames of the source in pixels, 0 if unknown
+     */
+    FrameProcessor( std::unique_ptr<IFrameEncoder> encoder, uint32_t frameWidth, uint32_t frameHeight );
+
+    /**
+     * @brief Applies the options to the frames of one artifact
+     * @param frames the frames, replaced by the kept and re-encoded frames
+     * @param options selection and encoding of the frames
+     * @param imageType image type of the frames, see ImageCaptureOptions.h
+     */
+    void process( std::vector<std::vector<uint8_t>> &frames, const ImageCaptureOptions &options, uint32_t imageType );
+
+    /**
+     * @brief Checks if the frame can be decoded on its own. H.264 frames in Annex B format are key frames if they
+     * contain an IDR slice, all other frames are key frames.
+     */
+    static bool isKeyFrame( const std::vector<uint8_t> &frame );
+
+    /**
+     * @brief Compares sampled bytes of the two frames
+     * @return 1 for identical samples down to 0 for maximal difference. Bytes beyond the end of the shorter frame
+     * count as maximal difference.
+     */
+    static double getSimilarity( const std::vector<uint8_t> &first, const std::vector<uint8_t> &second );
+
+private:
+    void encodeFrames( std::vector<std::vector<uint8_t>> &frames,
+                       const ImageCaptureOptions &options,
+                       uint32_t imageType );
+
+    std::unique_ptr<IFrameEncoder> mEncoder;
+    uint32_t mFrameWidth;
+    uint32_t mFrameHeight;
+    LoggingModule mLogger;
+};
+
+} // namespace VehicleNetwork
+} // namespace IoTFleetWise
+} // namespace Aws
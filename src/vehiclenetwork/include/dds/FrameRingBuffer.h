@@ -0,0 +1,121 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "LoggingModule.h"
+#include "TimeTypes.h"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace VehicleNetwork
+{
+
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+/**
+ * @brief Rolling history of the most recent sensor frames in a memory-mapped ring file
+ *
+ * The frames are stored as they are received, e.g. compressed images, one after the other in a file of fixed size
+ * that is mapped into memory, so that the history does not occupy heap memory and the kernel can page it out. A frame
+ * that does not fit at the end of the file is stored at its beginning. Frames older than the retention time are
+ * dropped, except the newest of them, so that the history always reaches back at least the retention time. If the
+ * file is full, the oldest frames are dropped regardless of the retention time. The index of the frames is only kept
+ * in memory, the history does not survive a restart. All methods are thread safe.
+ */
+class FrameRingBuffer
+{
+public:
+    FrameRingBuffer() = default;
+    ~FrameRingBuffer();
+
+    FrameRingBuffer( const FrameRingBuffer & ) = delete;
+    FrameRingBuffer &operator=( const FrameRingBuffer & ) = delete;
+    FrameRingBuffer( FrameRingBuffer && ) = delete;
+    FrameRingBuffer &operator=( FrameRingBuffer && ) = delete;
+
+    /**
+     * @brief Creates the ring file, replacing an existing file, and maps it
+     * @param path path of the ring file
+     * @param capacityBytes size of the ring file
+     * @return False if the file could not be created or mapped
+     */
+    bool init( const std::string &path, size_t capacityBytes );
+
+    /**
+     * @brief Sets how long the frames are kept. With a retention time of 0 no frames are stored.
+     */
+    void setRetentionMs( uint32_t retentionMs );
+
+    uint32_t getRetentionMs() const;
+
+    /**
+     * @brief Appends a frame
+     * @param timestamp time the frame was captured in ms since epoch
+     * @param data content of the frame
+     * @param size size of the frame in bytes
+     * @return False if the frame is not stored because it is not newer than the newest frame, it is bigger than the
+     * ring file, the retention time is 0 or the buffer is not initialized
+     */
+    bool append( Timestamp timestamp, const uint8_t *data, size_t size );
+
+    /**
+     * @brief Copies the frames captured in the interval
+     * @param from begin of the interval in ms since epoch
+     * @param to end of the interval in ms since epoch
+     * @param frames the frames of the interval, oldest first
+     * @return False if the history does not reach back to the begin of the interval, frames is then not modified
+     */
+    bool slice( Timestamp from, Timestamp to, std::vector<std::vector<uint8_t>> &frames ) const;
+
+    /**
+     * @brief Time the newest frame was captured, 0 if there is no frame
+     */
+    Timestamp getNewestTimestamp() const;
+
+    size_t getFrameCount() const;
+
+private:
+    struct Entry
+    {
+        Timestamp timestamp;
+        size_t offset;
+        size_t size;
+    };
+
+    // Finds the offset to store a frame of the given size, dropping the oldest frames until it fits
+    size_t makeRoom( size_t size );
+    void release();
+
+    mutable std::mutex mMutex;
+    int mFileDescriptor{ -1 };
+    uint8_t *mData{ nullptr };
+    size_t mCapacity{ 0 };
+    // Oldest first
+    std::deque<Entry> mEntries;
+    uint32_t mRetentionMs{ 0 };
+    LoggingModule mLogger;
+};
+
+} // namespace VehicleNetwork
+} // namespace IoTFleetWise
+} // namespace Aws
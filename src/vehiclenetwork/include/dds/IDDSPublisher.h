@@ -33,17 +33,6 @@ namespace VehicleNetwork
 {
 using namespace eprosima::fastdds::dds;
 using namespace Aws::IoTFleetWise::Platform::Linux;
-/**
- * Metadata representing an DDS Data Request.
- * Refer to DataInspection::EventMetadata for more details
- */
-struct DDSDataRequest
-{
-    uint32_t eventID;
-    uint32_t negativeOffsetMs;
-    uint32_t positiveOffsetMs;
-};
-
 /**
  * @brief Abstract DDS Publisher Interface. Every DDS Node that wants to publish data to a
  * DDS topic should implement from this interface.
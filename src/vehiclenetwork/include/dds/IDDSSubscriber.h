@@ -16,6 +16,7 @@
 // Includes
 #include "DDSDataTypes.h"
 #include "Listener.h"
+#include "SerialTaskExecutor.h"
 
 #include "datatypes/VehicleDataSourceTypes.h"
 // DDS lib related headers
@@ -76,6 +77,41 @@ public:
      */
     virtual bool isAlive() = 0;
 
+    /**
+     * @brief Sets how long the frames received from the source are kept in the pre-trigger buffer. Without
+     * pre-trigger buffer this has no effect.
+     * @param retentionMs retention time, 0 to not keep any frames
+     */
+    virtual void setPreTriggerRetentionMs( uint32_t retentionMs ) = 0;
+
+    /**
+     * @brief Persists the data of the request from the pre-trigger buffer, without requesting it from the source.
+     * The listeners are notified once the artifact is available, like for data received from the source.
+     * @param dataRequest the request
+     * @return False if there is no pre-trigger buffer or it does not cover the requested time interval, the data
+     * must then be requested from the source
+     */
+    virtual bool persistFromPreTriggerBuffer( const DDSDataRequest &dataRequest ) = 0;
+
+    /**
+     * @brief Announces a request that was sent to the source, so that its response is persisted with the image type
+     * and capture options of the request. Responses of requests which were not announced are persisted as received.
+     * @param dataRequest the request
+     */
+    virtual void registerDataRequest( const DDSDataRequest &dataRequest ) = 0;
+
+    /**
+     * @brief Sets the executor that takes and persists the data of the subscriber, so that the subscribers of all
+     * sources share its threads. Must be called before connect(). Without it the subscriber starts its own executor
+     * with a single worker.
+     * @param executor started executor, which must outlive the connection
+     */
+    void
+    setExecutor( std::shared_ptr<SerialTaskExecutor> executor )
+    {
+        mExecutor = std::move( executor );
+    }
+
     /**
      * @return the unique ID of the channel.
      */
@@ -159,6 +195,7 @@ protected:
     VehicleDataSourceProtocol mNetworkProtocol;
     std::string mTemporaryCacheLocation;
     DDSTopicQoS mTopicQoS;
+    std::shared_ptr<SerialTaskExecutor> mExecutor;
 };
 using DDSSubscriberPtr = std::unique_ptr<IDDSSubscriber>;
 } // namespace VehicleNetwork
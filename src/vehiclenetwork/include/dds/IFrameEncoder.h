@@ -0,0 +1,58 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "datatypes/ImageCaptureOptions.h"
+#include <cstdint>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace VehicleNetwork
+{
+
+/**
+ * @brief Abstract encoder of raw camera frames into a compressed image format
+ */
+class IFrameEncoder
+{
+public:
+    virtual ~IFrameEncoder() = default;
+
+    /**
+     * @brief Encodes one raw frame
+     * @param frame the raw frame, rows of pixels without padding
+     * @param imageType raw image type of the frame, e.g. IMAGE_TYPE_RAW_RGB8
+     * @param width width of the frame in pixels
+     * @param height height of the frame in pixels
+     * @param encoding format to encode to, not ImageEncoding::ORIGINAL
+     * @param quality quality of the encoded image, 1 to 100
+     * @param encoded the encoded image
+     * @return False if the format is not supported or the encoding failed
+     */
+    virtual bool encode( const std::vector<uint8_t> &frame,
+                         uint32_t imageType,
+                         uint32_t width,
+                         uint32_t height,
+                         ImageEncoding encoding,
+                         uint32_t quality,
+                         std::vector<uint8_t> &encoded ) = 0;
+};
+
+} // namespace VehicleNetwork
+} // namespace IoTFleetWise
+} // namespace Aws
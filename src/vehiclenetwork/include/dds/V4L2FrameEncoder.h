@@ -0,0 +1,99 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "IFrameEncoder.h"
+#include "LoggingModule.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace VehicleNetwork
+{
+
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+/**
+ * @brief Encodes raw frames to JPEG with a hardware encoder of the Video4Linux memory-to-memory API
+ *
+ * On the first frame the video devices are searched for a memory-to-memory device that outputs JPEG. Without such a
+ * device no frame is encoded. The device is configured for the format and size of the frames, and reconfigured only
+ * when they change. One frame is encoded at a time with a single memory mapped buffer per direction. Not thread
+ * safe.
+ */
+class V4L2FrameEncoder : public IFrameEncoder
+{
+public:
+    // Video devices searched for an encoder, /dev/video0 to /dev/video63
+    static constexpr uint32_t MAX_DEVICE_INDEX = 63;
+    // Time to wait for an encoded frame
+    static constexpr int ENCODE_TIMEOUT_MS = 1000;
+
+    V4L2FrameEncoder() = default;
+    ~V4L2FrameEncoder() override;
+
+    V4L2FrameEncoder( const V4L2FrameEncoder & ) = delete;
+    V4L2FrameEncoder &operator=( const V4L2FrameEncoder & ) = delete;
+    V4L2FrameEncoder( V4L2FrameEncoder && ) = delete;
+    V4L2FrameEncoder &operator=( V4L2FrameEncoder && ) = delete;
+
+    bool encode( const std::vector<uint8_t> &frame,
+                 uint32_t imageType,
+                 uint32_t width,
+                 uint32_t height,
+                 ImageEncoding encoding,
+                 uint32_t quality,
+                 std::vector<uint8_t> &encoded ) override;
+
+private:
+    struct MappedBuffer
+    {
+        void *address{ nullptr };
+        size_t length{ 0 };
+    };
+
+    // Opens the first memory-to-memory device that encodes to JPEG
+    bool openDevice();
+    // Sets the formats of both directions and maps their buffers, unless already configured for them
+    bool configure( uint32_t pixelFormat, uint32_t rowSize, uint32_t width, uint32_t height, uint32_t quality );
+    bool mapBuffer( uint32_t type, MappedBuffer &buffer );
+    bool queueBuffer( uint32_t type, size_t bytesUsed );
+    bool dequeueBuffer( uint32_t type, short pollEvents, size_t &bytesUsed );
+    // Stops streaming and unmaps the buffers, so that the next frame configures the device again
+    void releaseBuffers();
+
+    uint32_t getOutputType() const;
+    uint32_t getCaptureType() const;
+
+    int mFd{ -1 };
+    bool mDeviceSearched{ false };
+    bool mMultiPlanar{ false };
+    bool mConfigured{ false };
+    uint32_t mPixelFormat{ 0 };
+    uint32_t mWidth{ 0 };
+    uint32_t mHeight{ 0 };
+    uint32_t mQuality{ 0 };
+    MappedBuffer mOutputBuffer;
+    MappedBuffer mCaptureBuffer;
+    LoggingModule mLogger;
+};
+
+} // namespace VehicleNetwork
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -0,0 +1,184 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "dds/ArtifactWriter.h"
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace VehicleNetwork
+{
+
+ArtifactWriter::ArtifactWriter( uint32_t workerCount, size_t queueSize )
+    : mQueue( queueSize )
+{
+    workerCount = std::max( 1U, workerCount );
+    for ( uint32_t i = 0; i < workerCount; i++ )
+    {
+        auto worker = std::make_unique<Worker>();
+        worker->mWriter = this;
+        mWorkers.emplace_back( std::move( worker ) );
+    }
+    // No artifact is accepted before start
+    mQueue.close();
+}
+
+ArtifactWriter::~ArtifactWriter()
+{
+    // To make sure the threads stop during teardown of tests.
+    if ( isAlive() )
+    {
+        stop();
+    }
+}
+
+bool
+ArtifactWriter::start()
+{
+    // Prevent concurrent stop/init
+    std::lock_guard<std::mutex> lock( mThreadMutex );
+    mQueue.reopen();
+    for ( size_t i = 0; i < mWorkers.size(); i++ )
+    {
+        if ( !mWorkers[i]->mThread.create( doWork, mWorkers[i].get(), "fwVNArtWrite" + std::to_string( i + 1 ) ) )
+        {
+            mLogger.error( "ArtifactWriter::start", " Writer Thread failed to start " );
+            return false;
+        }
+    }
+    mLogger.trace( "ArtifactWriter::start", " Started " + std::to_string( mWorkers.size() ) + " writer threads " );
+    return true;
+}
+
+bool
+ArtifactWriter::stop()
+{
+    std::lock_guard<std::mutex> lock( mThreadMutex );
+    // Closing the queue lets the workers write the queued artifacts and then return
+    mQueue.close();
+    bool stopped = true;
+    for ( auto &worker : mWorkers )
+    {
+        worker->mThread.release();
+        stopped = stopped && !worker->mThread.isActive();
+    }
+    mLogger.trace( "ArtifactWriter::stop", " Writer Threads stopped " );
+    return stopped;
+}
+
+bool
+ArtifactWriter::isAlive()
+{
+    return std::all_of( mWorkers.begin(), mWorkers.end(), []( const std::unique_ptr<Worker> &worker ) {
+        return worker->mThread.isValid() && worker->mThread.isActive();
+    } );
+}
+
+bool
+ArtifactWriter::submit( std::string path, std::vector<std::vector<uint8_t>> buffers, CompletionCallback onComplete )
+{
+    if ( !mQueue.push( Artifact{ std::move( path ), std::move( buffers ), std::move( onComplete ) } ) )
+    {
+        mLogger.warn( "ArtifactWriter::submit", "Writer is stopped, the artifact is not written" );
+        return false;
+    }
+    return true;
+}
+
+bool
+ArtifactWriter::writeArtifact( const std::string &path, const std::vector<std::vector<uint8_t>> &buffers )
+{
+    int fd = open( path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644 );
+    if ( fd < 0 )
+    {
+        return false;
+    }
+    std::vector<struct iovec> ioVectors;
+    ioVectors.reserve( std::min<size_t>( buffers.size(), IOV_MAX ) );
+    bool success = true;
+    auto buffer = buffers.begin();
+    while ( success && ( buffer != buffers.end() ) )
+    {
+        // Gather up to IOV_MAX buffers in one write
+        ioVectors.clear();
+        for ( ; ( buffer != buffers.end() ) && ( ioVectors.size() < IOV_MAX ); buffer++ )
+        {
+            if ( !buffer->empty() )
+            {
+                ioVectors.push_back( { const_cast<uint8_t *>( buffer->data() ), buffer->size() } );
+            }
+        }
+        size_t first = 0;
+        while ( first < ioVectors.size() )
+        {
+            auto written = writev( fd, &ioVectors[first], static_cast<int>( ioVectors.size() - first ) );
+            if ( written < 0 )
+            {
+                if ( errno == EINTR )
+                {
+                    continue;
+                }
+                success = false;
+                break;
+            }
+            // Skip the completely written buffers and continue a partially written one
+            auto remaining = static_cast<size_t>( written );
+            while ( ( first < ioVectors.size() ) && ( remaining >= ioVectors[first].iov_len ) )
+            {
+                remaining -= ioVectors[first].iov_len;
+                first++;
+            }
+            if ( remaining > 0U )
+            {
+                ioVectors[first].iov_base = static_cast<uint8_t *>( ioVectors[first].iov_base ) + remaining;
+                ioVectors[first].iov_len -= remaining;
+            }
+        }
+    }
+    success = ( close( fd ) == 0 ) && success;
+    if ( !success )
+    {
+        (void)remove( path.c_str() );
+    }
+    return success;
+}
+
+void
+ArtifactWriter::doWork( void *data )
+{
+    auto *worker = static_cast<Worker *>( data );
+    Artifact artifact;
+    while ( worker->mWriter->mQueue.pop( artifact ) )
+    {
+        bool success = writeArtifact( artifact.path, artifact.buffers );
+        // Release the buffers before the callback, so that their memory is available for the next artifact
+        artifact.buffers.clear();
+        if ( artifact.onComplete )
+        {
+            artifact.onComplete( artifact.path, success );
+        }
+    }
+}
+
+} // namespace VehicleNetwork
+} // namespace IoTFleetWise
+} // namespace Aws
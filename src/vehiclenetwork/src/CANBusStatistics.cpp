@@ -0,0 +1,151 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#if defined( IOTFLEETWISE_LINUX )
+// Includes
+#include "businterfaces/CANBusStatistics.h"
+#include "TraceModule.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace VehicleNetwork
+{
+constexpr uint32_t CANBusStatistics::DEFAULT_BITRATE;
+constexpr size_t CANBusStatistics::DEFAULT_TOP_FRAME_IDS;
+constexpr Timestamp CANBusStatistics::PUBLISH_INTERVAL_MS;
+constexpr uint32_t CANBusStatistics::STANDARD_FRAME_OVERHEAD_BITS;
+constexpr uint32_t CANBusStatistics::EXTENDED_FRAME_OVERHEAD_BITS;
+
+CANBusStatistics::CANBusStatistics( std::string channelName, uint32_t bitrate, size_t topFrameIds )
+    : mChannelName( std::move( channelName ) )
+    , mBitrate( bitrate )
+    , mTopFrameIds( topFrameIds )
+{
+}
+
+CANBusStatistics::~CANBusStatistics()
+{
+    // The variables of a removed channel should not be reported forever
+    auto &traceModule = TraceModule::get();
+    traceModule.removeNamedVariable( "canBusLoadPercent_" + mChannelName );
+    traceModule.removeNamedVariable( "canFramesPerSecond_" + mChannelName );
+    traceModule.removeNamedVariable( "canMaxBurst_" + mChannelName );
+    traceModule.removeNamedVariable( "canKernelDrops_" + mChannelName );
+    for ( const auto &frameRate : mTopFrameRates )
+    {
+        traceModule.removeNamedVariable( getFrameIdVariableName( frameRate.first ) );
+    }
+}
+
+void
+CANBusStatistics::onBurst( size_t frames )
+{
+    mMaxBurst = std::max( mMaxBurst, frames );
+    TraceModule::get().recordHistogram( TraceHistogram::CAN_FRAMES_PER_BURST, frames );
+}
+
+bool
+CANBusStatistics::publishIfDue( Timestamp nowMs )
+{
+    if ( mWindowStartMs == 0 )
+    {
+        mWindowStartMs = nowMs;
+        return false;
+    }
+    if ( ( nowMs - mWindowStartMs ) < PUBLISH_INTERVAL_MS )
+    {
+        return false;
+    }
+    publish( nowMs );
+    return true;
+}
+
+void
+CANBusStatistics::publish( Timestamp nowMs )
+{
+    double windowSeconds = static_cast<double>( std::max<Timestamp>( nowMs - mWindowStartMs, 1 ) ) / 1000.0;
+    mBusLoadPercent = ( mBitrate == 0 ) ? 0.0
+                                        : ( static_cast<double>( mBits ) * 100.0 ) /
+                                              ( static_cast<double>( mBitrate ) * windowSeconds );
+
+    // Only the top N are sorted, the map can have thousands of IDs on a busy bus
+    std::vector<std::pair<canid_t, uint32_t>> frameCounts;
+    frameCounts.reserve( mFramesPerId.size() );
+    for ( const auto &frameCount : mFramesPerId )
+    {
+        if ( frameCount.second > 0 )
+        {
+            frameCounts.emplace_back( frameCount );
+        }
+    }
+    size_t topCount = std::min( mTopFrameIds, frameCounts.size() );
+    std::partial_sort( frameCounts.begin(),
+                       frameCounts.begin() + static_cast<std::ptrdiff_t>( topCount ),
+                       frameCounts.end(),
+                       []( const std::pair<canid_t, uint32_t> &a, const std::pair<canid_t, uint32_t> &b ) {
+                           return ( a.second > b.second ) || ( ( a.second == b.second ) && ( a.first < b.first ) );
+                       } );
+
+    auto &traceModule = TraceModule::get();
+    // IDs that left the top N are not reported anymore
+    for ( const auto &frameRate : mTopFrameRates )
+    {
+        traceModule.removeNamedVariable( getFrameIdVariableName( frameRate.first ) );
+    }
+    mTopFrameRates.clear();
+    for ( size_t i = 0; i < topCount; i++ )
+    {
+        double idFramesPerSecond = static_cast<double>( frameCounts[i].second ) / windowSeconds;
+        mTopFrameRates.emplace_back( frameCounts[i].first, idFramesPerSecond );
+        traceModule.setNamedVariable( getFrameIdVariableName( frameCounts[i].first ),
+                                      static_cast<int64_t>( std::llround( idFramesPerSecond ) ),
+                                      "Count/Second" );
+    }
+    traceModule.setNamedVariable(
+        "canBusLoadPercent_" + mChannelName, static_cast<int64_t>( std::llround( mBusLoadPercent ) ), "Percent" );
+    double framesPerSecond = static_cast<double>( mFrames ) / windowSeconds;
+    traceModule.setNamedVariable(
+        "canFramesPerSecond_" + mChannelName, static_cast<int64_t>( std::llround( framesPerSecond ) ), "Count/Second" );
+    traceModule.setNamedVariable( "canMaxBurst_" + mChannelName, static_cast<int64_t>( mMaxBurst ), "Count" );
+    traceModule.setNamedVariable( "canKernelDrops_" + mChannelName, static_cast<int64_t>( mKernelDrops ), "Count" );
+
+    // The map keeps its buckets, so the IDs of the bus do not allocate again in the next window
+    for ( auto &frameCount : mFramesPerId )
+    {
+        frameCount.second = 0;
+    }
+    mWindowStartMs = nowMs;
+    mFrames = 0;
+    mBits = 0;
+    mMaxBurst = 0;
+    mKernelDrops = 0;
+}
+
+std::string
+CANBusStatistics::getFrameIdVariableName( canid_t canId ) const
+{
+    std::array<char, 16> id{};
+    (void)snprintf( id.data(), id.size(), "0x%X", canId & CAN_EFF_MASK );
+    return "canFrameIdPerSecond_" + mChannelName + "_" + id.data();
+}
+
+} // namespace VehicleNetwork
+} // namespace IoTFleetWise
+} // namespace Aws
+#endif // IOTFLEETWISE_LINUX
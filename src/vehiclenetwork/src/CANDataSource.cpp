@@ -14,7 +14,7 @@
 #if defined( IOTFLEETWISE_LINUX )
 // Includes
 #include "businterfaces/CANDataSource.h"
-#include "ClockHandler.h"
+#include "businterfaces/CANDataSourceEventLoop.h"
 #include "EnumUtility.h"
 #include "TraceModule.h"
 #include <boost/lockfree/spsc_queue.hpp>
@@ -26,6 +26,7 @@
 #include <linux/net_tstamp.h>
 #include <net/if.h>
 #include <sys/ioctl.h>
+#include <thread>
 
 namespace Aws
 {
@@ -36,6 +37,17 @@ namespace VehicleNetwork
 using namespace Aws::IoTFleetWise::Platform::Utility;
 static const std::string INTERFACE_NAME_KEY = "interfaceName";
 static const std::string THREAD_IDLE_TIME_KEY = "threadIdleTimeMs";
+static const std::string RECEIVE_BATCH_SIZE_KEY = "receiveBatchSize";
+static const std::string BUSY_POLL_KEY = "busyPollUs";
+static const std::string IDLE_SPIN_COUNT_KEY = "idleSpinCount";
+static const std::string MICROSECOND_TIMESTAMPS_KEY = "microsecondTimestamps";
+static const std::string DECODER_THREADS_KEY = "decoderThreads";
+static const std::string BUS_STATISTICS_KEY = "busStatistics";
+static const std::string BITRATE_KEY = "bitrate";
+static const std::string BUS_STATISTICS_TOP_IDS_KEY = "busStatisticsTopIds";
+// we expect only one timestamp and the kernel drop counter to return per frame
+static constexpr size_t CMSG_BUFFER_SIZE =
+    CMSG_SPACE( sizeof( struct scm_timestamping ) ) + CMSG_SPACE( sizeof( uint32_t ) );
 CANDataSource::CANDataSource( bool useKernelTimestamp )
     : mUseKernelTimestamp{ useKernelTimestamp }
 {
@@ -53,8 +65,13 @@ CANDataSource::CANDataSource()
 
 CANDataSource::~CANDataSource()
 {
+    if ( mEventLoop )
+    {
+        // The event loop must not call this source anymore once it is destroyed
+        mEventLoop->removeSource( mSocket );
+    }
     // To make sure the thread stops during teardown of tests.
-    if ( isAlive() )
+    else if ( isAlive() )
     {
         stop();
     }
@@ -81,8 +98,36 @@ CANDataSource::init( const std::vector<VehicleDataSourceConfig> &sourceConfigs )
         mIfName = settingsIterator->second;
     }
 
-    mCircularBuffPtr =
-        std::make_shared<VehicleMessageCircularBuffer>( sourceConfigs[0].maxNumberOfVehicleDataMessages );
+    // Optionally split the frames by CAN ID over multiple buffers, each consumed by an own decoder thread
+    size_t bufferCount = 1;
+    settingsIterator = sourceConfigs[0].transportProperties.find( std::string( DECODER_THREADS_KEY ) );
+    if ( settingsIterator != sourceConfigs[0].transportProperties.end() )
+    {
+        try
+        {
+            bufferCount = static_cast<size_t>( std::stoul( settingsIterator->second ) );
+        }
+        catch ( const std::exception &e )
+        {
+            mLogger.error( "CANDataSource::init",
+                           "Could not cast the decoderThreads, invalid input: " + std::string( e.what() ) );
+            return false;
+        }
+        if ( ( bufferCount == 0 ) || ( bufferCount > MAX_BUFFER_COUNT ) )
+        {
+            mLogger.error( "CANDataSource::init",
+                           "decoderThreads must be between 1 and " + std::to_string( MAX_BUFFER_COUNT ) );
+            return false;
+        }
+    }
+    mCircularBuffPtrs.clear();
+    for ( size_t i = 0; i < bufferCount; i++ )
+    {
+        // Every buffer gets the full size as a burst of one CAN ID only fills one of them
+        mCircularBuffPtrs.emplace_back( std::allocate_shared<VehicleMessageCircularBuffer>(
+            ArenaAllocator<VehicleMessageCircularBuffer, MemorySubsystem::DECODING>(),
+            sourceConfigs[0].maxNumberOfVehicleDataMessages ) );
+    }
     settingsIterator = sourceConfigs[0].transportProperties.find( std::string( THREAD_IDLE_TIME_KEY ) );
     if ( settingsIterator == sourceConfigs[0].transportProperties.end() )
     {
@@ -103,6 +148,105 @@ CANDataSource::init( const std::vector<VehicleDataSourceConfig> &sourceConfigs )
         }
     }
 
+    // Optional low latency and batching settings
+    settingsIterator = sourceConfigs[0].transportProperties.find( std::string( RECEIVE_BATCH_SIZE_KEY ) );
+    if ( settingsIterator != sourceConfigs[0].transportProperties.end() )
+    {
+        try
+        {
+            mReceiveBatchSize = static_cast<size_t>( std::stoul( settingsIterator->second ) );
+        }
+        catch ( const std::exception &e )
+        {
+            mLogger.error( "CANDataSource::init",
+                           "Could not cast the receiveBatchSize, invalid input: " + std::string( e.what() ) );
+            return false;
+        }
+        if ( ( mReceiveBatchSize == 0 ) || ( mReceiveBatchSize > MAX_RECEIVE_BATCH_SIZE ) )
+        {
+            mLogger.error( "CANDataSource::init",
+                           "receiveBatchSize must be between 1 and " + std::to_string( MAX_RECEIVE_BATCH_SIZE ) );
+            return false;
+        }
+    }
+    settingsIterator = sourceConfigs[0].transportProperties.find( std::string( BUSY_POLL_KEY ) );
+    if ( settingsIterator != sourceConfigs[0].transportProperties.end() )
+    {
+        try
+        {
+            mBusyPollUs = static_cast<uint32_t>( std::stoul( settingsIterator->second ) );
+        }
+        catch ( const std::exception &e )
+        {
+            mLogger.error( "CANDataSource::init",
+                           "Could not cast the busyPollUs, invalid input: " + std::string( e.what() ) );
+            return false;
+        }
+    }
+    settingsIterator = sourceConfigs[0].transportProperties.find( std::string( IDLE_SPIN_COUNT_KEY ) );
+    if ( settingsIterator != sourceConfigs[0].transportProperties.end() )
+    {
+        try
+        {
+            mIdleSpinCount = static_cast<uint32_t>( std::stoul( settingsIterator->second ) );
+        }
+        catch ( const std::exception &e )
+        {
+            mLogger.error( "CANDataSource::init",
+                           "Could not cast the idleSpinCount, invalid input: " + std::string( e.what() ) );
+            return false;
+        }
+    }
+    settingsIterator = sourceConfigs[0].transportProperties.find( std::string( MICROSECOND_TIMESTAMPS_KEY ) );
+    if ( settingsIterator != sourceConfigs[0].transportProperties.end() )
+    {
+        if ( settingsIterator->second == "true" )
+        {
+            mUseMicrosecondTimestamps = true;
+        }
+        else if ( settingsIterator->second == "false" )
+        {
+            mUseMicrosecondTimestamps = false;
+        }
+        else
+        {
+            mLogger.error( "CANDataSource::init", "microsecondTimestamps must be true or false" );
+            return false;
+        }
+    }
+    settingsIterator = sourceConfigs[0].transportProperties.find( std::string( BUS_STATISTICS_KEY ) );
+    mBusStatistics.reset();
+    if ( ( settingsIterator != sourceConfigs[0].transportProperties.end() ) && ( settingsIterator->second == "true" ) )
+    {
+        uint32_t bitrate = CANBusStatistics::DEFAULT_BITRATE;
+        size_t topFrameIds = CANBusStatistics::DEFAULT_TOP_FRAME_IDS;
+        try
+        {
+            settingsIterator = sourceConfigs[0].transportProperties.find( std::string( BITRATE_KEY ) );
+            if ( settingsIterator != sourceConfigs[0].transportProperties.end() )
+            {
+                bitrate = static_cast<uint32_t>( std::stoul( settingsIterator->second ) );
+            }
+            settingsIterator = sourceConfigs[0].transportProperties.find( std::string( BUS_STATISTICS_TOP_IDS_KEY ) );
+            if ( settingsIterator != sourceConfigs[0].transportProperties.end() )
+            {
+                topFrameIds = static_cast<size_t>( std::stoul( settingsIterator->second ) );
+            }
+        }
+        catch ( const std::exception &e )
+        {
+            mLogger.error( "CANDataSource::init",
+                           "Could not cast the bus statistics settings, invalid input: " + std::string( e.what() ) );
+            return false;
+        }
+        if ( bitrate == 0 )
+        {
+            mLogger.error( "CANDataSource::init", "bitrate must be greater than 0" );
+            return false;
+        }
+        mBusStatistics = std::make_unique<CANBusStatistics>( mIfName, bitrate, topFrameIds );
+    }
+
     mTimer.reset();
     return true;
 }
@@ -118,14 +262,13 @@ CANDataSource::start()
     // Make sure the thread goes into sleep immediately to wait for
     // the manifest to be available
     mShouldSleep.store( true );
-    if ( !mThread.create( doWork, this ) )
+    if ( !mThread.create( doWork, this, "fwVNLinuxCAN" + std::to_string( mID ) ) )
     {
         mLogger.trace( "CANDataSource::start", " CAN Data Source Thread failed to start " );
     }
     else
     {
         mLogger.trace( "CANDataSource::start", " CAN Data Source Thread started " );
-        mThread.setThreadName( "fwVNLinuxCAN" + std::to_string( mID ) );
     }
     return mThread.isActive() && mThread.isValid();
 }
@@ -137,6 +280,11 @@ CANDataSource::suspendDataAcquisition()
     mLogger.trace( "CANDataSource::suspendDataAcquisition",
                    "Going to sleep until a the resume signal. CAN Data Source : " + std::to_string( mID ) );
     mShouldSleep.store( true, std::memory_order_relaxed );
+    if ( mEventLoop )
+    {
+        // Leave the frames in the kernel queue until resumed
+        mEventLoop->enableSource( mSocket, false );
+    }
 }
 
 void
@@ -146,12 +294,24 @@ CANDataSource::resumeDataAcquisition()
     mLogger.trace( "CANDataSource::resumeDataAcquisition",
                    " Resuming Network data acquisition on Data Source :" + std::to_string( mID ) );
     // Make sure the thread does not sleep anymore
-    mResumeTime = mClock->timeSinceEpochMs();
+    mResumeTime = FastClock::systemTimeMs();
     mShouldSleep.store( false );
+    if ( mEventLoop )
+    {
+        mWokeUpFromSleep = true;
+        mEventLoop->enableSource( mSocket, true );
+        return;
+    }
     // Wake up the worker thread.
     mWait.notify();
 }
 
+void
+CANDataSource::setEventLoop( std::shared_ptr<CANDataSourceEventLoop> eventLoop )
+{
+    mEventLoop = std::move( eventLoop );
+}
+
 bool
 CANDataSource::stop()
 {
@@ -182,12 +342,9 @@ CANDataSource::doWork( void *data )
 
     CANDataSource *dataSource = static_cast<CANDataSource *>( data );
 
-    Timestamp lastFrameTime = 0;
     uint32_t activations = 0;
-    bool wokeUpFromSleep =
-        false; /**< This variable is true after the thread is woken up for example because a valid decoder manifest was
-                  received until the thread sleeps for the next time when it is false again*/
     Timer logTimer;
+    uint32_t emptyPolls = 0;
     do
     {
         activations++;
@@ -198,132 +355,322 @@ CANDataSource::doWork( void *data )
             dataSource->mLogger.trace( "CANDataSource::doWork",
                                        "No valid decoding dictionary available, Channel going to sleep " );
             dataSource->mWait.wait( Platform::Linux::Signal::WaitWithPredicate );
-            wokeUpFromSleep = true;
+            dataSource->mWokeUpFromSleep = true;
         }
 
         dataSource->mTimer.reset();
-        int nmsgs = 0;
-        struct can_frame frame[PARALLEL_RECEIVED_FRAMES_FROM_KERNEL];
-        struct iovec frame_buffer[PARALLEL_RECEIVED_FRAMES_FROM_KERNEL];
-        struct mmsghdr msg[PARALLEL_RECEIVED_FRAMES_FROM_KERNEL];
-        // we expect only one timestamp to return
-        char cmsgReturnBuffer[PARALLEL_RECEIVED_FRAMES_FROM_KERNEL][CMSG_SPACE( sizeof( struct scm_timestamping ) )] = {
-            { 0 } };
-
-        // Setup all buffer to receive data
-        for ( int i = 0; i < PARALLEL_RECEIVED_FRAMES_FROM_KERNEL; i++ )
-        {
-            frame_buffer[i].iov_base = &frame[i];
-            frame_buffer[i].iov_len = sizeof( frame );
-            msg[i].msg_hdr.msg_name = nullptr; // not interested in the source address
-            msg[i].msg_hdr.msg_namelen = 0;
-            msg[i].msg_hdr.msg_iov = &frame_buffer[i];
-            msg[i].msg_hdr.msg_iovlen = 1;
-            msg[i].msg_hdr.msg_control = &cmsgReturnBuffer[i];
-            msg[i].msg_hdr.msg_controllen = sizeof( cmsgReturnBuffer[i] );
-        }
-        // In one syscall receive up to PARALLEL_RECEIVED_FRAMES_FROM_KERNEL frames in parallel
-        nmsgs = recvmmsg( dataSource->mSocket, msg, PARALLEL_RECEIVED_FRAMES_FROM_KERNEL, 0, nullptr );
-        for ( int i = 0; i < nmsgs; i++ )
-        {
-            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-cstyle-cast)
-            struct cmsghdr *currentHeader = CMSG_FIRSTHDR( &msg[i].msg_hdr );
-            VehicleDataMessage message;
-            const std::vector<boost::any> syntheticData{};
-            std::vector<std::uint8_t> rawData = {};
-            Timestamp timestamp = 0;
-            if ( dataSource->mUseKernelTimestamp )
+        int nmsgs = dataSource->receiveFrames();
+        if ( nmsgs > 0 )
+        {
+            emptyPolls = 0;
+        }
+        else
+        {
+            // In low latency mode poll the socket again a few times before going to sleep
+            if ( emptyPolls < dataSource->mIdleSpinCount )
             {
-                while ( currentHeader != nullptr )
-                {
-                    if ( currentHeader->cmsg_type == SO_TIMESTAMPING )
-                    {
-                        // With linux kernel 5.1 new return scm_timestamping64 was introduced
-                        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-cstyle-cast)
-                        scm_timestamping *timestampArray = (scm_timestamping *)( CMSG_DATA( currentHeader ) );
-                        // From https://www.kernel.org/doc/Documentation/networking/can.txt
-                        // Most timestamps are passed in ts[0]. Hardware timestamps are passed in ts[2].
-                        if ( timestampArray->ts[2].tv_sec != 0 )
-                        {
-                            timestamp = static_cast<Timestamp>( ( timestampArray->ts[2].tv_sec * 1000 ) +
-                                                                ( timestampArray->ts[2].tv_nsec / 1000000 ) );
-                        }
-                        else
-                        {
-                            timestamp = static_cast<Timestamp>( ( timestampArray->ts[0].tv_sec * 1000 ) +
-                                                                ( timestampArray->ts[0].tv_nsec / 1000000 ) );
-                        }
-                    }
-                    currentHeader = CMSG_NXTHDR( &msg[i].msg_hdr, currentHeader );
-                }
-                TraceModule::get().setVariable( TraceVariable::MAX_SYSTEMTIME_KERNELTIME_DIFF,
-                                                static_cast<uint64_t>( dataSource->mClock->timeSinceEpochMs() ) -
-                                                    static_cast<uint64_t>( timestamp ) );
+                emptyPolls++;
+                std::this_thread::yield();
+                continue;
             }
-            else
+            emptyPolls = 0;
+            if ( logTimer.getElapsedMs().count() > static_cast<int64_t>( LoggingModule::LOG_AGGREGATION_TIME_MS ) )
             {
-                timestamp = dataSource->mClock->timeSinceEpochMs();
+                // Nothing is in the ring buffer to consume. Go to idle mode for some time.
+                // The statistics are also traced if the log level filters the message
+                auto framesPerSyscall = dataSource->traceReceiveStatistics();
+                dataSource->mLogger.trace( "CANDataSource::doWork", [&]() {
+                    return "Activations: " + std::to_string( activations ) +
+                           ". Waiting for some data to come. Idling for :" + std::to_string( dataSource->mIdleTimeMs ) +
+                           " ms, processed " + std::to_string( dataSource->receivedMessages ) + " frames, " +
+                           std::to_string( framesPerSyscall ) + " frames per syscall";
+                } );
+                activations = 0;
+                logTimer.reset();
             }
-            if ( timestamp < lastFrameTime )
+            dataSource->mWait.wait( static_cast<uint32_t>( dataSource->mIdleTimeMs ) );
+        }
+    } while ( !dataSource->shouldStop() );
+}
+
+void
+CANDataSource::setupReceiveBuffers()
+{
+    // canfd_frame is layout compatible with can_frame, classic frames are received with CAN_MTU bytes
+    // The receive vectors are set up once and reused for every recvmmsg call
+    mFrames.assign( mReceiveBatchSize, canfd_frame{} );
+    mFrameBuffers.assign( mReceiveBatchSize, iovec{} );
+    mMessages.assign( mReceiveBatchSize, mmsghdr{} );
+    mCmsgBuffer.assign( mReceiveBatchSize * CMSG_BUFFER_SIZE, 0 );
+    for ( size_t i = 0; i < mReceiveBatchSize; i++ )
+    {
+        mFrameBuffers[i].iov_base = &mFrames[i];
+        mFrameBuffers[i].iov_len = sizeof( mFrames[i] );
+        mMessages[i].msg_hdr.msg_name = nullptr; // not interested in the source address
+        mMessages[i].msg_hdr.msg_namelen = 0;
+        mMessages[i].msg_hdr.msg_iov = &mFrameBuffers[i];
+        mMessages[i].msg_hdr.msg_iovlen = 1;
+        mMessages[i].msg_hdr.msg_control = &mCmsgBuffer[i * CMSG_BUFFER_SIZE];
+        mMessages[i].msg_hdr.msg_controllen = CMSG_BUFFER_SIZE;
+    }
+    mLastReceived = 0;
+}
+
+uint64_t
+CANDataSource::traceReceiveStatistics()
+{
+    uint64_t averageFramesPerSyscall =
+        ( mSyscallsWithFrames == 0 ) ? 0 : ( mFramesFromSyscalls / mSyscallsWithFrames );
+    TraceModule::get().setVariable( TraceVariable::CAN_FRAMES_PER_SYSCALL, averageFramesPerSyscall );
+    mSyscallsWithFrames = 0;
+    mFramesFromSyscalls = 0;
+    return averageFramesPerSyscall;
+}
+
+int
+CANDataSource::receiveFrames()
+{
+    // Only the control length of the received messages is modified by the kernel, everything else
+    // was set up once
+    for ( size_t i = 0; i < mLastReceived; i++ )
+    {
+        mMessages[i].msg_hdr.msg_controllen = CMSG_BUFFER_SIZE;
+    }
+    // In one syscall receive up to mReceiveBatchSize frames in parallel
+    int nmsgs = recvmmsg( mSocket, mMessages.data(), static_cast<unsigned int>( mMessages.size() ), 0, nullptr );
+    if ( mBusStatistics )
+    {
+        // Also on empty reads, so that a silent bus is published with no load
+        mBusStatistics->publishIfDue( FastClock::monotonicTimeMs( ClockPrecision::COARSE ) );
+    }
+    if ( nmsgs <= 0 )
+    {
+        mLastReceived = 0;
+        // The kernel queue is drained, so everything received from now on is new
+        mWokeUpFromSleep = false;
+        return nmsgs;
+    }
+    mLastReceived = static_cast<size_t>( nmsgs );
+    mSyscallsWithFrames++;
+    mFramesFromSyscalls += mLastReceived;
+    if ( mBusStatistics )
+    {
+        mBusStatistics->onBurst( mLastReceived );
+    }
+    bool wokeUpFromSleep = mWokeUpFromSleep;
+    // Bit i is set if a message was pushed to buffer i
+    uint32_t pushedBuffers = 0;
+    for ( size_t i = 0; i < mLastReceived; i++ )
+    {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-cstyle-cast)
+        struct cmsghdr *currentHeader = CMSG_FIRSTHDR( &mMessages[i].msg_hdr );
+        VehicleDataMessage message;
+        Timestamp timestamp = 0;
+        TimestampFractionUs timestampFractionUs = 0;
+        while ( currentHeader != nullptr )
+        {
+            if ( ( currentHeader->cmsg_level == SOL_SOCKET ) && ( currentHeader->cmsg_type == SO_RXQ_OVFL ) )
             {
-                TraceModule::get().incrementAtomicVariable( TraceAtomicVariable::NOT_TIME_MONOTONIC_FRAMES );
+                // Number of frames dropped by the kernel since the socket was opened because the receive
+                // queue was full
+                uint32_t droppedFrames = 0;
+                std::memcpy( &droppedFrames, CMSG_DATA( currentHeader ), sizeof( droppedFrames ) );
+                if ( droppedFrames > mKernelDroppedFrames )
+                {
+                    TraceModule::get().addToAtomicVariable( TraceAtomicVariable::KERNEL_DROPPED_CAN_FRAMES,
+                                                            droppedFrames - mKernelDroppedFrames );
+                    if ( mBusStatistics )
+                    {
+                        mBusStatistics->onKernelDrops( droppedFrames - mKernelDroppedFrames );
+                    }
+                    mKernelDroppedFrames = droppedFrames;
+                }
             }
-            // After waking up the Socket Can old messages in the kernel queue need to be ignored
-            if ( !wokeUpFromSleep || timestamp >= dataSource->mResumeTime )
+            else if ( mUseKernelTimestamp && ( currentHeader->cmsg_type == SO_TIMESTAMPING ) )
             {
-                lastFrameTime = timestamp;
-                dataSource->receivedMessages++;
-                TraceVariable traceFrames =
-                    static_cast<TraceVariable>( dataSource->mID + toUType( TraceVariable::READ_SOCKET_FRAMES_0 ) );
-                TraceModule::get().setVariable( ( traceFrames < TraceVariable::READ_SOCKET_FRAMES_MAX )
-                                                    ? traceFrames
-                                                    : TraceVariable::READ_SOCKET_FRAMES_MAX,
-                                                dataSource->receivedMessages );
-                rawData.reserve( frame[i].can_dlc );
-                for ( size_t j = 0; j < frame[i].can_dlc; ++j )
+                // With linux kernel 5.1 new return scm_timestamping64 was introduced
+                // NOLINTNEXTLINE(cppcoreguidelines-pro-type-cstyle-cast)
+                scm_timestamping *timestampArray = (scm_timestamping *)( CMSG_DATA( currentHeader ) );
+                // From https://www.kernel.org/doc/Documentation/networking/can.txt
+                // Most timestamps are passed in ts[0]. Hardware timestamps are passed in ts[2].
+                const struct timespec &kernelTime =
+                    ( timestampArray->ts[2].tv_sec != 0 ) ? timestampArray->ts[2] : timestampArray->ts[0];
+                timestamp =
+                    static_cast<Timestamp>( ( kernelTime.tv_sec * 1000 ) + ( kernelTime.tv_nsec / 1000000 ) );
+                if ( mUseMicrosecondTimestamps )
                 {
-                    rawData.emplace_back( frame[i].data[j] );
+                    timestampFractionUs = static_cast<TimestampFractionUs>( ( kernelTime.tv_nsec / 1000 ) % 1000 );
                 }
-                message.setup( frame[i].can_id, rawData, syntheticData, timestamp );
-                if ( message.isValid() )
+            }
+            currentHeader = CMSG_NXTHDR( &mMessages[i].msg_hdr, currentHeader );
+        }
+        if ( mBusStatistics )
+        {
+            // All frames on the bus count for its load, also the ones ignored after waking up
+            mBusStatistics->onFrame( mFrames[i].can_id, mFrames[i].len );
+        }
+        if ( mUseKernelTimestamp )
+        {
+            TraceModule::get().setVariable( TraceVariable::MAX_SYSTEMTIME_KERNELTIME_DIFF,
+                                            static_cast<uint64_t>( FastClock::systemTimeMs() ) -
+                                                static_cast<uint64_t>( timestamp ) );
+        }
+        else if ( mUseMicrosecondTimestamps )
+        {
+            uint64_t timestampUs = FastClock::systemTimeUs();
+            timestamp = timestampUs / MICROSECONDS_PER_MILLISECOND;
+            timestampFractionUs = static_cast<TimestampFractionUs>( timestampUs % MICROSECONDS_PER_MILLISECOND );
+        }
+        else
+        {
+            timestamp = FastClock::systemTimeMs();
+        }
+        if ( timestamp < mLastFrameTime )
+        {
+            TraceModule::get().incrementAtomicVariable( TraceAtomicVariable::NOT_TIME_MONOTONIC_FRAMES );
+        }
+        // After waking up the Socket Can old messages in the kernel queue need to be ignored
+        if ( !wokeUpFromSleep || timestamp >= mResumeTime )
+        {
+            mLastFrameTime = timestamp;
+            receivedMessages++;
+            TraceVariable traceFrames =
+                static_cast<TraceVariable>( mID + toUType( TraceVariable::READ_SOCKET_FRAMES_0 ) );
+            TraceModule::get().setVariable( ( traceFrames < TraceVariable::READ_SOCKET_FRAMES_MAX )
+                                                ? traceFrames
+                                                : TraceVariable::READ_SOCKET_FRAMES_MAX,
+                                            receivedMessages );
+            // The payload is copied into the inline storage of the message, no heap allocation
+            if ( message.setup(
+                     mFrames[i].can_id, mFrames[i].data, mFrames[i].len, timestamp, timestampFractionUs ) &&
+                 message.isValid() )
+            {
+                // All frames of one CAN ID go to the same buffer to keep their order
+                size_t bufferIndex = getBufferIndex( mFrames[i].can_id );
+                if ( !mCircularBuffPtrs[bufferIndex]->push( message ) )
                 {
-                    if ( !dataSource->mCircularBuffPtr->push( message ) )
-                    {
-                        dataSource->discardedMessages++;
-                        TraceModule::get().setVariable( TraceVariable::DISCARDED_FRAMES,
-                                                        dataSource->discardedMessages );
-                        dataSource->mLogger.warn( "CANDataSource::doWork", " Circular Buffer is full" );
-                    }
+                    discardedMessages++;
+                    TraceModule::get().setVariable( TraceVariable::DISCARDED_FRAMES, discardedMessages );
+                    mLogger.warn( "CANDataSource::receiveFrames", []() { return " Circular Buffer is full"; } );
                 }
                 else
                 {
-                    dataSource->mLogger.warn( "CANDataSource::doWork", "Message is not valid" );
+                    pushedBuffers |= 1U << bufferIndex;
                 }
             }
+            else
+            {
+                mLogger.warn( "CANDataSource::receiveFrames", []() { return "Message is not valid"; } );
+            }
         }
-        if ( nmsgs <= 0 )
+    }
+    // Once per batch and buffer so that the consumers wake up without polling the buffers
+    for ( size_t bufferIndex = 0; pushedBuffers != 0; bufferIndex++, pushedBuffers >>= 1 )
+    {
+        if ( ( pushedBuffers & 1U ) != 0 )
         {
-            if ( logTimer.getElapsedMs().count() > static_cast<int64_t>( LoggingModule::LOG_AGGREGATION_TIME_MS ) )
+            notifyDataAvailable( bufferIndex );
+        }
+    }
+    if ( mLastReceived < mMessages.size() )
+    {
+        // Less than a full batch means the kernel queue is drained
+        mWokeUpFromSleep = false;
+    }
+    return nmsgs;
+}
+
+std::vector<struct can_filter>
+CANDataSource::buildFrameFilter( const std::vector<uint32_t> &messageIDs, size_t maxExactFilters )
+{
+    std::vector<struct can_filter> filter;
+    if ( messageIDs.size() <= maxExactFilters )
+    {
+        filter.reserve( messageIDs.size() );
+        for ( auto id : messageIDs )
+        {
+            struct can_filter entry = {};
+            entry.can_id = id;
+            // Match format and ID exactly and never accept remote frames
+            entry.can_mask =
+                CAN_EFF_FLAG | CAN_RTR_FLAG | ( ( ( id & CAN_EFF_FLAG ) != 0 ) ? CAN_EFF_MASK : CAN_SFF_MASK );
+            filter.emplace_back( entry );
+        }
+        return filter;
+    }
+    // Too many IDs: build one mask filter per frame format with only the bits all IDs have in common
+    for ( auto extended : { false, true } )
+    {
+        const canid_t idMask = extended ? CAN_EFF_MASK : CAN_SFF_MASK;
+        bool found = false;
+        canid_t first = 0;
+        canid_t commonBits = idMask;
+        for ( auto id : messageIDs )
+        {
+            if ( ( ( id & CAN_EFF_FLAG ) != 0 ) != extended )
             {
-                // Nothing is in the ring buffer to consume. Go to idle mode for some time.
-                dataSource->mLogger.trace(
-                    "CANDataSource::doWork",
-                    "Activations: " + std::to_string( activations ) +
-                        ". Waiting for some data to come. Idling for :" + std::to_string( dataSource->mIdleTimeMs ) +
-                        " ms, processed " + std::to_string( dataSource->receivedMessages ) + " frames" );
-                activations = 0;
-                logTimer.reset();
+                continue;
             }
-            dataSource->mWait.wait( static_cast<uint32_t>( dataSource->mIdleTimeMs ) );
-            wokeUpFromSleep = false;
+            if ( !found )
+            {
+                first = id & idMask;
+                found = true;
+            }
+            commonBits &= ~( ( id & idMask ) ^ first );
         }
-    } while ( !dataSource->shouldStop() );
+        if ( found )
+        {
+            struct can_filter entry = {};
+            entry.can_id = ( first & commonBits ) | ( extended ? CAN_EFF_FLAG : 0U );
+            entry.can_mask = commonBits | CAN_EFF_FLAG | CAN_RTR_FLAG;
+            filter.emplace_back( entry );
+        }
+    }
+    return filter;
+}
+
+bool
+CANDataSource::setMessageFilter( const std::vector<uint32_t> &messageIDs )
+{
+    std::lock_guard<std::mutex> lock( mFilterMutex );
+    mFrameFilter = buildFrameFilter( messageIDs, MAX_EXACT_FRAME_FILTERS );
+    mFrameFilterSet = true;
+    mLogger.trace( "CANDataSource::setMessageFilter",
+                   "Kernel filter with " + std::to_string( mFrameFilter.size() ) + " entries for " +
+                       std::to_string( messageIDs.size() ) + " CAN IDs on " + mIfName );
+    if ( mSocket < 0 )
+    {
+        // Applied on connect
+        return true;
+    }
+    return applyFrameFilter();
+}
+
+bool
+CANDataSource::applyFrameFilter()
+{
+    // An empty filter makes the kernel drop all frames
+    if ( setsockopt( mSocket,
+                     SOL_CAN_RAW,
+                     CAN_RAW_FILTER,
+                     mFrameFilter.empty() ? nullptr : mFrameFilter.data(),
+                     static_cast<socklen_t>( mFrameFilter.size() * sizeof( struct can_filter ) ) ) != 0 )
+    {
+        mLogger.error( "CANDataSource::applyFrameFilter", "Could not set CAN_RAW_FILTER on " + mIfName );
+        return false;
+    }
+    return true;
 }
 
 size_t
 CANDataSource::queueSize() const
 {
-    return mCircularBuffPtr->read_available();
+    size_t size = 0;
+    for ( const auto &buffer : mCircularBuffPtrs )
+    {
+        size += buffer->read_available();
+    }
+    return size;
 }
 
 bool
@@ -367,6 +714,39 @@ CANDataSource::connect()
         }
     }
 
+    if ( mBusyPollUs > 0 )
+    {
+        // Let the kernel busy poll the device queue for new frames instead of waiting for the interrupt
+        const int busyPollUs = static_cast<int>( mBusyPollUs );
+        if ( setsockopt( mSocket, SOL_SOCKET, SO_BUSY_POLL, &busyPollUs, sizeof( busyPollUs ) ) != 0 )
+        {
+            mLogger.warn( "CANDataSource::connect", " SO_BUSY_POLL not supported or permitted on " + mIfName );
+        }
+    }
+
+    // Report the number of frames dropped by the kernel with every received frame
+    const int enableDropCounter = 1;
+    if ( setsockopt( mSocket, SOL_SOCKET, SO_RXQ_OVFL, &enableDropCounter, sizeof( enableDropCounter ) ) != 0 )
+    {
+        mLogger.warn( "CANDataSource::connect", " Kernel drop counter not supported by socket" );
+    }
+    mKernelDroppedFrames = 0;
+    {
+        std::lock_guard<std::mutex> lock( mFilterMutex );
+        if ( mFrameFilterSet && !applyFrameFilter() )
+        {
+            close( mSocket );
+            return false;
+        }
+    }
+
+    // Also receive CAN FD frames. Kernels or interfaces without CAN FD support only deliver classic frames
+    const int enableCanFdFrames = 1;
+    if ( setsockopt( mSocket, SOL_CAN_RAW, CAN_RAW_FD_FRAMES, &enableCanFdFrames, sizeof( enableCanFdFrames ) ) != 0 )
+    {
+        mLogger.warn( "CANDataSource::connect", " CAN FD frames not supported on interface " + mIfName );
+    }
+
     memset( &interfaceAddress, 0, sizeof( interfaceAddress ) );
     interfaceAddress.can_family = AF_CAN;
     interfaceAddress.can_ifindex = interfaceRequest.ifr_ifindex;
@@ -378,6 +758,20 @@ CANDataSource::connect()
         close( mSocket );
         return false;
     }
+    setupReceiveBuffers();
+    if ( mEventLoop )
+    {
+        // The socket is serviced by the shared event loop, which only polls it once resumed
+        mShouldSleep.store( true );
+        if ( !mEventLoop->addSource( this, mSocket ) )
+        {
+            close( mSocket );
+            return false;
+        }
+        notifyListeners<const VehicleDataSourceID &>( &VehicleDataSourceListener::onVehicleDataSourceConnected,
+                                                      mID );
+        return true;
+    }
     // Notify on connection success
     notifyListeners<const VehicleDataSourceID &>( &VehicleDataSourceListener::onVehicleDataSourceConnected, mID );
     // Start the main thread.
@@ -387,7 +781,15 @@ CANDataSource::connect()
 bool
 CANDataSource::disconnect()
 {
-    if ( !stop() && close( mSocket ) < 0 )
+    if ( mEventLoop )
+    {
+        mEventLoop->removeSource( mSocket );
+        if ( close( mSocket ) < 0 )
+        {
+            return false;
+        }
+    }
+    else if ( !stop() && close( mSocket ) < 0 )
     {
         return false;
     }
@@ -403,7 +805,8 @@ CANDataSource::isAlive()
     socklen_t len = sizeof( error );
     // Get the error status of the socket
     int retSockOpt = getsockopt( mSocket, SOL_SOCKET, SO_ERROR, &error, &len );
-    if ( retSockOpt == -1 || !mThread.isValid() || !mThread.isActive() || error != 0 )
+    bool workerAlive = mEventLoop ? mEventLoop->isAlive() : ( mThread.isValid() && mThread.isActive() );
+    if ( retSockOpt == -1 || !workerAlive || error != 0 )
     {
         return false;
     }
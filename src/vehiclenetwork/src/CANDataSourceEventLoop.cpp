@@ -0,0 +1,237 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+
+#if defined( IOTFLEETWISE_LINUX )
+// Includes
+#include "businterfaces/CANDataSourceEventLoop.h"
+#include "businterfaces/CANDataSource.h"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace VehicleNetwork
+{
+
+CANDataSourceEventLoop::CANDataSourceEventLoop()
+{
+    static std::atomic<uint32_t> instanceCounter( 0 );
+    mID = instanceCounter++;
+}
+
+CANDataSourceEventLoop::~CANDataSourceEventLoop()
+{
+    // To make sure the thread stops during teardown of tests.
+    if ( isAlive() )
+    {
+        stop();
+    }
+    if ( mWakeupFd >= 0 )
+    {
+        close( mWakeupFd );
+    }
+    if ( mEpollFd >= 0 )
+    {
+        close( mEpollFd );
+    }
+}
+
+bool
+CANDataSourceEventLoop::start()
+{
+    // Prevent concurrent stop/init
+    std::lock_guard<std::mutex> lock( mThreadMutex );
+    if ( mEpollFd < 0 )
+    {
+        mEpollFd = epoll_create1( EPOLL_CLOEXEC );
+        mWakeupFd = eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC );
+        if ( ( mEpollFd < 0 ) || ( mWakeupFd < 0 ) )
+        {
+            mLogger.error( "CANDataSourceEventLoop::start", "Could not create epoll instance" );
+            return false;
+        }
+        struct epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.fd = mWakeupFd;
+        if ( epoll_ctl( mEpollFd, EPOLL_CTL_ADD, mWakeupFd, &event ) != 0 )
+        {
+            mLogger.error( "CANDataSourceEventLoop::start", "Could not register the wake up event" );
+            return false;
+        }
+    }
+    // On multi core systems the shared variable mShouldStop must be updated for
+    // all cores before starting the thread otherwise thread will directly end
+    mShouldStop.store( false );
+    if ( !mThread.create( doWork, this, "fwVNCANLoop" + std::to_string( mID ) ) )
+    {
+        mLogger.trace( "CANDataSourceEventLoop::start", " Event loop Thread failed to start " );
+    }
+    else
+    {
+        mLogger.trace( "CANDataSourceEventLoop::start", " Event loop Thread started " );
+    }
+    return mThread.isActive() && mThread.isValid();
+}
+
+bool
+CANDataSourceEventLoop::stop()
+{
+    std::lock_guard<std::mutex> lock( mThreadMutex );
+    mShouldStop.store( true, std::memory_order_relaxed );
+    uint64_t wakeup = 1;
+    if ( write( mWakeupFd, &wakeup, sizeof( wakeup ) ) < 0 )
+    {
+        mLogger.warn( "CANDataSourceEventLoop::stop", "Could not wake up the event loop" );
+    }
+    mThread.release();
+    mShouldStop.store( false, std::memory_order_relaxed );
+    mLogger.trace( "CANDataSourceEventLoop::stop", " Event loop Thread stopped " );
+    return !mThread.isActive();
+}
+
+bool
+CANDataSourceEventLoop::isAlive()
+{
+    return mThread.isValid() && mThread.isActive();
+}
+
+bool
+CANDataSourceEventLoop::shouldStop() const
+{
+    return mShouldStop.load( std::memory_order_relaxed );
+}
+
+bool
+CANDataSourceEventLoop::addSource( CANDataSource *source, int socket )
+{
+    if ( ( source == nullptr ) || ( socket < 0 ) || ( mEpollFd < 0 ) )
+    {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock( mSourcesMutex );
+    struct epoll_event event = {};
+    // No events until the source is enabled
+    event.events = 0;
+    event.data.fd = socket;
+    if ( epoll_ctl( mEpollFd, EPOLL_CTL_ADD, socket, &event ) != 0 )
+    {
+        mLogger.error( "CANDataSourceEventLoop::addSource", "Could not register socket " + std::to_string( socket ) );
+        return false;
+    }
+    mSources[socket] = source;
+    return true;
+}
+
+bool
+CANDataSourceEventLoop::removeSource( int socket )
+{
+    std::lock_guard<std::mutex> lock( mSourcesMutex );
+    if ( mSources.erase( socket ) == 0 )
+    {
+        return false;
+    }
+    return epoll_ctl( mEpollFd, EPOLL_CTL_DEL, socket, nullptr ) == 0;
+}
+
+bool
+CANDataSourceEventLoop::enableSource( int socket, bool enabled )
+{
+    std::lock_guard<std::mutex> lock( mSourcesMutex );
+    if ( mSources.find( socket ) == mSources.end() )
+    {
+        return false;
+    }
+    struct epoll_event event = {};
+    // Level triggered: a source that does not drain its socket in one batch is called again
+    event.events = enabled ? static_cast<uint32_t>( EPOLLIN ) : 0U;
+    event.data.fd = socket;
+    return epoll_ctl( mEpollFd, EPOLL_CTL_MOD, socket, &event ) == 0;
+}
+
+void
+CANDataSourceEventLoop::setCycleHandler( std::function<uint32_t()> handler )
+{
+    {
+        std::lock_guard<std::mutex> lock( mSourcesMutex );
+        mCycleHandler = std::move( handler );
+    }
+    // The thread might wait without timeout
+    wakeup();
+}
+
+void
+CANDataSourceEventLoop::wakeup()
+{
+    uint64_t wakeup = 1;
+    if ( ( mWakeupFd >= 0 ) && ( write( mWakeupFd, &wakeup, sizeof( wakeup ) ) < 0 ) )
+    {
+        mLogger.warn( "CANDataSourceEventLoop::wakeup", "Could not wake up the event loop" );
+    }
+}
+
+void
+CANDataSourceEventLoop::doWork( void *data )
+{
+    CANDataSourceEventLoop *eventLoop = static_cast<CANDataSourceEventLoop *>( data );
+    std::array<struct epoll_event, MAX_EVENTS_PER_WAIT> events{};
+    // Without a cycle handler the thread only wakes up for the sockets
+    int timeoutMs = -1;
+    while ( !eventLoop->shouldStop() )
+    {
+        int numberOfEvents = epoll_wait( eventLoop->mEpollFd, events.data(), MAX_EVENTS_PER_WAIT, timeoutMs );
+        if ( numberOfEvents < 0 )
+        {
+            if ( errno != EINTR )
+            {
+                eventLoop->mLogger.error( "CANDataSourceEventLoop::doWork", "epoll_wait failed" );
+                return;
+            }
+            continue;
+        }
+        std::lock_guard<std::mutex> lock( eventLoop->mSourcesMutex );
+        for ( size_t i = 0; i < static_cast<size_t>( numberOfEvents ); i++ )
+        {
+            if ( events[i].data.fd == eventLoop->mWakeupFd )
+            {
+                // Level triggered, so the counter is reset to not wake up again
+                uint64_t wakeups = 0;
+                (void)read( eventLoop->mWakeupFd, &wakeups, sizeof( wakeups ) );
+                continue;
+            }
+            auto source = eventLoop->mSources.find( events[i].data.fd );
+            if ( source != eventLoop->mSources.end() )
+            {
+                source->second->receiveFrames();
+            }
+        }
+        timeoutMs = -1;
+        if ( eventLoop->mCycleHandler )
+        {
+            timeoutMs = static_cast<int>(
+                std::min<uint32_t>( eventLoop->mCycleHandler(), static_cast<uint32_t>( INT32_MAX ) ) );
+        }
+    }
+}
+
+} // namespace VehicleNetwork
+} // namespace IoTFleetWise
+} // namespace Aws
+#endif // IOTFLEETWISE_LINUX
@@ -0,0 +1,808 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#if defined( IOTFLEETWISE_LINUX )
+// Includes
+#include "businterfaces/CANLogReplayDataSource.h"
+#include "FastClock.h"
+#include "TraceModule.h"
+#include <cstring>
+#include <fcntl.h>
+#include <linux/can.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace VehicleNetwork
+{
+static const std::string LOG_FILE_KEY = "logFile";
+static const std::string LOG_FORMAT_KEY = "logFormat";
+static const std::string CHANNEL_KEY = "channel";
+static const std::string REPLAY_MODE_KEY = "replayMode";
+static const std::string REPLAY_SPEED_KEY = "replaySpeed";
+static const std::string PRESERVE_TIMESTAMPS_KEY = "preserveTimestamps";
+static const std::string LOOP_KEY = "loop";
+constexpr size_t CANLogReplayDataSource::REPLAY_BATCH_SIZE;
+constexpr uint32_t CANLogReplayDataSource::FULL_BUFFER_RETRY_MS;
+
+namespace
+{
+// The parsers work on the memory mapped file, which is not null terminated, so every helper is bounded by end
+
+const char *
+skipBlanks( const char *pos, const char *end )
+{
+    while ( ( pos < end ) && ( ( *pos == ' ' ) || ( *pos == '\t' ) ) )
+    {
+        pos++;
+    }
+    return pos;
+}
+
+// Returns the next blank separated token and moves pos behind it, false if there is none
+bool
+nextToken( const char *&pos, const char *end, const char *&tokenBegin, const char *&tokenEnd )
+{
+    tokenBegin = skipBlanks( pos, end );
+    tokenEnd = tokenBegin;
+    while ( ( tokenEnd < end ) && ( *tokenEnd != ' ' ) && ( *tokenEnd != '\t' ) )
+    {
+        tokenEnd++;
+    }
+    pos = tokenEnd;
+    return tokenEnd != tokenBegin;
+}
+
+bool
+tokenEquals( const char *begin, const char *end, const char *text )
+{
+    auto length = strlen( text );
+    return ( static_cast<size_t>( end - begin ) == length ) && ( memcmp( begin, text, length ) == 0 );
+}
+
+int
+hexDigit( char c )
+{
+    if ( ( c >= '0' ) && ( c <= '9' ) )
+    {
+        return c - '0';
+    }
+    if ( ( c >= 'a' ) && ( c <= 'f' ) )
+    {
+        return c - 'a' + 10;
+    }
+    if ( ( c >= 'A' ) && ( c <= 'F' ) )
+    {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+bool
+parseNumber( const char *begin, const char *end, bool hex, uint32_t &value )
+{
+    const auto base = hex ? 16U : 10U;
+    uint64_t result = 0;
+    if ( ( begin == end ) || ( ( end - begin ) > 10 ) )
+    {
+        return false;
+    }
+    for ( auto pos = begin; pos < end; pos++ )
+    {
+        auto digit = hexDigit( *pos );
+        if ( ( digit < 0 ) || ( static_cast<uint32_t>( digit ) >= base ) )
+        {
+            return false;
+        }
+        result = ( result * base ) + static_cast<uint64_t>( digit );
+    }
+    if ( result > UINT32_MAX )
+    {
+        return false;
+    }
+    value = static_cast<uint32_t>( result );
+    return true;
+}
+
+// Parses seconds with up to 6 fractional digits, e.g. 1436509052.249713, into microseconds
+bool
+parseSecondsUs( const char *begin, const char *end, uint64_t &timeUs )
+{
+    uint64_t seconds = 0;
+    uint64_t fractionUs = 0;
+    uint64_t fractionScale = 100000;
+    bool fraction = false;
+    if ( begin == end )
+    {
+        return false;
+    }
+    for ( auto pos = begin; pos < end; pos++ )
+    {
+        if ( ( *pos == '.' ) && !fraction )
+        {
+            fraction = true;
+        }
+        else if ( ( *pos >= '0' ) && ( *pos <= '9' ) )
+        {
+            if ( !fraction )
+            {
+                seconds = ( seconds * 10 ) + static_cast<uint64_t>( *pos - '0' );
+            }
+            else if ( fractionScale > 0 )
+            {
+                // Digits beyond microseconds are ignored
+                fractionUs += static_cast<uint64_t>( *pos - '0' ) * fractionScale;
+                fractionScale /= 10;
+            }
+        }
+        else
+        {
+            return false;
+        }
+    }
+    timeUs = ( seconds * 1000000 ) + fractionUs;
+    return true;
+}
+
+// Parses a CAN ID, extended IDs are either marked with a trailing x or have more than 3 hex digits in candump
+bool
+parseCanId( const char *begin, const char *end, bool hex, bool extendedByLength, uint32_t &id )
+{
+    bool extended = false;
+    if ( ( begin < end ) && ( ( *( end - 1 ) == 'x' ) || ( *( end - 1 ) == 'X' ) ) )
+    {
+        extended = true;
+        end--;
+    }
+    if ( extendedByLength && ( ( end - begin ) > 3 ) )
+    {
+        extended = true;
+    }
+    if ( !parseNumber( begin, end, hex, id ) )
+    {
+        return false;
+    }
+    if ( extended )
+    {
+        id = ( id & CAN_EFF_MASK ) | CAN_EFF_FLAG;
+    }
+    else if ( id > CAN_SFF_MASK )
+    {
+        return false;
+    }
+    return true;
+}
+} // namespace
+
+CANLogReplayDataSource::CANLogReplayDataSource()
+{
+    mType = VehicleDataSourceType::CAN_SOURCE;
+    mNetworkProtocol = VehicleDataSourceProtocol::RAW_SOCKET;
+    mID = generateSourceID();
+}
+
+CANLogReplayDataSource::~CANLogReplayDataSource()
+{
+    // To make sure the thread stops during teardown of tests.
+    if ( isAlive() )
+    {
+        stop();
+    }
+    unmapLogFile();
+}
+
+bool
+CANLogReplayDataSource::init( const std::vector<VehicleDataSourceConfig> &sourceConfigs )
+{
+    if ( sourceConfigs.size() != 1 )
+    {
+        mLogger.error( "CANLogReplayDataSource::init", " Only one source config is supported " );
+        return false;
+    }
+    const auto &properties = sourceConfigs[0].transportProperties;
+    auto settingsIterator = properties.find( LOG_FILE_KEY );
+    if ( settingsIterator == properties.end() )
+    {
+        mLogger.error( "CANLogReplayDataSource::init", "Could not find logFile in the config" );
+        return false;
+    }
+    mLogFilename = settingsIterator->second;
+    mIfName = mLogFilename;
+
+    const std::string ascExtension = ".asc";
+    mLogFormat = ( ( mLogFilename.size() >= ascExtension.size() ) &&
+                   ( mLogFilename.compare( mLogFilename.size() - ascExtension.size(),
+                                           ascExtension.size(),
+                                           ascExtension ) == 0 ) )
+                     ? LogFormat::ASC
+                     : LogFormat::CANDUMP;
+    settingsIterator = properties.find( LOG_FORMAT_KEY );
+    if ( settingsIterator != properties.end() )
+    {
+        if ( settingsIterator->second == "candump" )
+        {
+            mLogFormat = LogFormat::CANDUMP;
+        }
+        else if ( settingsIterator->second == "asc" )
+        {
+            mLogFormat = LogFormat::ASC;
+        }
+        else
+        {
+            // BLF files consist of zlib compressed containers, convert them to ASC first
+            mLogger.error( "CANLogReplayDataSource::init",
+                           "logFormat must be candump or asc, not " + settingsIterator->second );
+            return false;
+        }
+    }
+
+    settingsIterator = properties.find( CHANNEL_KEY );
+    mChannel = ( settingsIterator != properties.end() ) ? settingsIterator->second : "";
+
+    mReplayMode = ReplayMode::REAL_TIME;
+    settingsIterator = properties.find( REPLAY_MODE_KEY );
+    if ( settingsIterator != properties.end() )
+    {
+        if ( settingsIterator->second == "realTime" )
+        {
+            mReplayMode = ReplayMode::REAL_TIME;
+        }
+        else if ( settingsIterator->second == "scaled" )
+        {
+            mReplayMode = ReplayMode::SCALED;
+        }
+        else if ( settingsIterator->second == "asFastAsPossible" )
+        {
+            mReplayMode = ReplayMode::AS_FAST_AS_POSSIBLE;
+        }
+        else
+        {
+            mLogger.error( "CANLogReplayDataSource::init",
+                           "replayMode must be realTime, scaled or asFastAsPossible" );
+            return false;
+        }
+    }
+    mReplaySpeed = 1.0;
+    settingsIterator = properties.find( REPLAY_SPEED_KEY );
+    if ( settingsIterator != properties.end() )
+    {
+        try
+        {
+            mReplaySpeed = std::stod( settingsIterator->second );
+        }
+        catch ( const std::exception &e )
+        {
+            mLogger.error( "CANLogReplayDataSource::init",
+                           "Could not cast the replaySpeed, invalid input: " + std::string( e.what() ) );
+            return false;
+        }
+        if ( !( mReplaySpeed > 0.0 ) )
+        {
+            mLogger.error( "CANLogReplayDataSource::init", "replaySpeed must be greater than 0" );
+            return false;
+        }
+    }
+    if ( mReplayMode == ReplayMode::REAL_TIME )
+    {
+        mReplaySpeed = 1.0;
+    }
+
+    for ( auto flag : { std::make_pair( &PRESERVE_TIMESTAMPS_KEY, &mPreserveTimestamps ),
+                        std::make_pair( &LOOP_KEY, &mLoop ) } )
+    {
+        *flag.second = false;
+        settingsIterator = properties.find( *flag.first );
+        if ( settingsIterator == properties.end() )
+        {
+            continue;
+        }
+        if ( settingsIterator->second == "true" )
+        {
+            *flag.second = true;
+        }
+        else if ( settingsIterator->second != "false" )
+        {
+            mLogger.error( "CANLogReplayDataSource::init", *flag.first + " must be true or false" );
+            return false;
+        }
+    }
+
+    mCircularBuffPtrs.clear();
+    mCircularBuffPtrs.emplace_back( std::allocate_shared<VehicleMessageCircularBuffer>(
+        ArenaAllocator<VehicleMessageCircularBuffer, MemorySubsystem::DECODING>(),
+        sourceConfigs[0].maxNumberOfVehicleDataMessages ) );
+    return true;
+}
+
+bool
+CANLogReplayDataSource::connect()
+{
+    unmapLogFile();
+    mFileDescriptor = open( mLogFilename.c_str(), O_RDONLY | O_CLOEXEC );
+    if ( mFileDescriptor < 0 )
+    {
+        mLogger.error( "CANLogReplayDataSource::connect", " Could not open the log file " + mLogFilename );
+        return false;
+    }
+    struct stat fileStatus = {};
+    if ( fstat( mFileDescriptor, &fileStatus ) != 0 )
+    {
+        unmapLogFile();
+        return false;
+    }
+    mLogSize = static_cast<size_t>( fileStatus.st_size );
+    if ( mLogSize > 0 )
+    {
+        void *mapping = mmap( nullptr, mLogSize, PROT_READ, MAP_PRIVATE, mFileDescriptor, 0 );
+        if ( mapping == MAP_FAILED )
+        {
+            mLogger.error( "CANLogReplayDataSource::connect", " Could not map the log file " + mLogFilename );
+            unmapLogFile();
+            return false;
+        }
+        // The log is read once from start to end, so the kernel can read ahead and drop read pages early
+        (void)madvise( mapping, mLogSize, MADV_SEQUENTIAL );
+        mLogData = static_cast<const char *>( mapping );
+    }
+    mReadOffset = 0;
+    mAscHexBase = true;
+    mAscRelativeTimestamps = false;
+    mAscPreviousTimeUs = 0;
+    mHasPendingFrame = false;
+    mRebase = true;
+    mReplayStartSystemTimeUs = 0;
+    mReplayedFrames.store( 0, std::memory_order_relaxed );
+    mReplayFinished.store( false, std::memory_order_relaxed );
+    notifyListeners<const VehicleDataSourceID &>( &VehicleDataSourceListener::onVehicleDataSourceConnected, mID );
+    return start();
+}
+
+bool
+CANLogReplayDataSource::disconnect()
+{
+    if ( !stop() )
+    {
+        return false;
+    }
+    unmapLogFile();
+    notifyListeners<const VehicleDataSourceID &>( &VehicleDataSourceListener::onVehicleDataSourceDisconnected, mID );
+    return true;
+}
+
+void
+CANLogReplayDataSource::unmapLogFile()
+{
+    if ( mLogData != nullptr )
+    {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+        munmap( const_cast<char *>( mLogData ), mLogSize );
+        mLogData = nullptr;
+    }
+    mLogSize = 0;
+    if ( mFileDescriptor >= 0 )
+    {
+        close( mFileDescriptor );
+        mFileDescriptor = -1;
+    }
+}
+
+bool
+CANLogReplayDataSource::isAlive()
+{
+    return ( mFileDescriptor >= 0 ) && mThread.isValid() && mThread.isActive();
+}
+
+bool
+CANLogReplayDataSource::start()
+{
+    // Prevent concurrent stop/init
+    std::lock_guard<std::mutex> lock( mThreadMutex );
+    mShouldStop.store( false );
+    // Wait for the decoder manifest before replaying
+    mShouldSleep.store( true );
+    if ( !mThread.create( doWork, this, "fwVNCANReplay" + std::to_string( mID ) ) )
+    {
+        mLogger.trace( "CANLogReplayDataSource::start", " CAN Log Replay Thread failed to start " );
+    }
+    else
+    {
+        mLogger.trace( "CANLogReplayDataSource::start", " CAN Log Replay Thread started " );
+    }
+    return mThread.isActive() && mThread.isValid();
+}
+
+bool
+CANLogReplayDataSource::stop()
+{
+    std::lock_guard<std::mutex> lock( mThreadMutex );
+    mShouldStop.store( true, std::memory_order_relaxed );
+    mWait.notify();
+    mThread.release();
+    mShouldStop.store( false, std::memory_order_relaxed );
+    mLogger.trace( "CANLogReplayDataSource::stop", " CAN Log Replay Thread stopped " );
+    return !mThread.isActive();
+}
+
+bool
+CANLogReplayDataSource::shouldStop() const
+{
+    return mShouldStop.load( std::memory_order_relaxed );
+}
+
+bool
+CANLogReplayDataSource::shouldSleep() const
+{
+    return mShouldSleep.load( std::memory_order_relaxed );
+}
+
+void
+CANLogReplayDataSource::suspendDataAcquisition()
+{
+    mLogger.trace( "CANLogReplayDataSource::suspendDataAcquisition",
+                   "Pausing the replay until the resume signal. CAN Data Source : " + std::to_string( mID ) );
+    mShouldSleep.store( true, std::memory_order_relaxed );
+}
+
+void
+CANLogReplayDataSource::resumeDataAcquisition()
+{
+    mLogger.trace( "CANLogReplayDataSource::resumeDataAcquisition",
+                   " Resuming the replay on Data Source :" + std::to_string( mID ) );
+    mShouldSleep.store( false );
+    mWait.notify();
+}
+
+void
+CANLogReplayDataSource::doWork( void *data )
+{
+    auto *dataSource = static_cast<CANLogReplayDataSource *>( data );
+    do
+    {
+        if ( dataSource->shouldSleep() )
+        {
+            dataSource->mLogger.trace( "CANLogReplayDataSource::doWork",
+                                       "No valid decoding dictionary available, replay paused " );
+            dataSource->mWait.wait( Platform::Linux::Signal::WaitWithPredicate );
+            // The time spent sleeping must not be caught up
+            dataSource->mRebase = true;
+            continue;
+        }
+        auto waitMs = dataSource->replayFrames();
+        if ( waitMs > 0 )
+        {
+            dataSource->mWait.wait( waitMs );
+        }
+    } while ( !dataSource->shouldStop() );
+}
+
+uint32_t
+CANLogReplayDataSource::replayFrames()
+{
+    uint32_t waitMs = 0;
+    bool pushed = false;
+    for ( size_t i = 0; i < REPLAY_BATCH_SIZE; i++ )
+    {
+        if ( !mHasPendingFrame )
+        {
+            if ( !readNextFrame( mPendingFrame ) )
+            {
+                if ( mLoop && ( mReplayedFrames.load( std::memory_order_relaxed ) > 0 ) )
+                {
+                    mReadOffset = 0;
+                    mAscPreviousTimeUs = 0;
+                    mRebase = true;
+                    continue;
+                }
+                if ( !mReplayFinished.exchange( true ) )
+                {
+                    mLogger.info( "CANLogReplayDataSource::replayFrames",
+                                  "Replay of " + mLogFilename + " finished after " +
+                                      std::to_string( mReplayedFrames.load() ) + " frames" );
+                }
+                waitMs = Platform::Linux::Signal::WaitWithPredicate;
+                break;
+            }
+            mHasPendingFrame = true;
+        }
+        if ( mRebase || ( mPendingFrame.timeUs < mLogStartUs ) )
+        {
+            mReplayStartUs = FastClock::monotonicTimeUs();
+            mLogStartUs = mPendingFrame.timeUs;
+            if ( mReplayStartSystemTimeUs == 0 )
+            {
+                mReplayStartSystemTimeUs = FastClock::systemTimeUs();
+            }
+            mRebase = false;
+        }
+        if ( mReplayMode != ReplayMode::AS_FAST_AS_POSSIBLE )
+        {
+            auto logElapsedUs = static_cast<double>( mPendingFrame.timeUs - mLogStartUs );
+            auto dueUs = mReplayStartUs + static_cast<uint64_t>( logElapsedUs / mReplaySpeed );
+            auto nowUs = FastClock::monotonicTimeUs();
+            // Frames due within the next millisecond are pushed now, the wait has millisecond resolution
+            if ( dueUs > nowUs + MICROSECONDS_PER_MILLISECOND )
+            {
+                waitMs = static_cast<uint32_t>( ( dueUs - nowUs ) / MICROSECONDS_PER_MILLISECOND );
+                break;
+            }
+        }
+
+        uint64_t timestampUs = FastClock::systemTimeUs();
+        if ( mPreserveTimestamps )
+        {
+            timestampUs = ( mLogFormat == LogFormat::ASC ) ? ( mReplayStartSystemTimeUs + mPendingFrame.timeUs )
+                                                           : mPendingFrame.timeUs;
+        }
+        VehicleDataMessage message;
+        if ( !message.setup( mPendingFrame.id,
+                             mPendingFrame.data,
+                             mPendingFrame.length,
+                             timestampUs / MICROSECONDS_PER_MILLISECOND,
+                             static_cast<TimestampFractionUs>( timestampUs % MICROSECONDS_PER_MILLISECOND ) ) ||
+             !message.isValid() )
+        {
+            mHasPendingFrame = false;
+            continue;
+        }
+        if ( !mCircularBuffPtrs[0]->push( message ) )
+        {
+            if ( mReplayMode == ReplayMode::AS_FAST_AS_POSSIBLE )
+            {
+                // Keep the frame and wait for the consumer, so that a benchmark does not lose frames
+                waitMs = FULL_BUFFER_RETRY_MS;
+                break;
+            }
+            mDiscardedFrames++;
+            TraceModule::get().setVariable( TraceVariable::DISCARDED_FRAMES, mDiscardedFrames );
+            mLogger.warn( "CANLogReplayDataSource::replayFrames", []() { return " Circular Buffer is full"; } );
+        }
+        else
+        {
+            pushed = true;
+            mReplayedFrames.fetch_add( 1, std::memory_order_relaxed );
+        }
+        mHasPendingFrame = false;
+    }
+    if ( pushed )
+    {
+        notifyDataAvailable();
+    }
+    return waitMs;
+}
+
+bool
+CANLogReplayDataSource::readNextFrame( ReplayFrame &frame )
+{
+    while ( mReadOffset < mLogSize )
+    {
+        const char *begin = mLogData + mReadOffset;
+        const auto *end = static_cast<const char *>( memchr( begin, '\n', mLogSize - mReadOffset ) );
+        if ( end == nullptr )
+        {
+            end = mLogData + mLogSize;
+            mReadOffset = mLogSize;
+        }
+        else
+        {
+            mReadOffset = static_cast<size_t>( end - mLogData ) + 1;
+        }
+        if ( ( end > begin ) && ( *( end - 1 ) == '\r' ) )
+        {
+            end--;
+        }
+        bool parsed = ( mLogFormat == LogFormat::ASC ) ? parseAscLine( begin, end, frame )
+                                                        : parseCandumpLine( begin, end, frame );
+        if ( parsed )
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool
+CANLogReplayDataSource::parseCandumpLine( const char *begin, const char *end, ReplayFrame &frame ) const
+{
+    // (1436509052.249713) vcan0 044#2A366C2BBA
+    // (1436509052.249713) vcan0 123##1112233 with the CAN FD flags nibble after ##
+    const char *tokenBegin = nullptr;
+    const char *tokenEnd = nullptr;
+    const char *pos = begin;
+    if ( !nextToken( pos, end, tokenBegin, tokenEnd ) || ( ( tokenEnd - tokenBegin ) < 3 ) ||
+         ( *tokenBegin != '(' ) || ( *( tokenEnd - 1 ) != ')' ) ||
+         !parseSecondsUs( tokenBegin + 1, tokenEnd - 1, frame.timeUs ) )
+    {
+        return false;
+    }
+    if ( !nextToken( pos, end, tokenBegin, tokenEnd ) )
+    {
+        return false;
+    }
+    if ( !mChannel.empty() && !tokenEquals( tokenBegin, tokenEnd, mChannel.c_str() ) )
+    {
+        return false;
+    }
+    if ( !nextToken( pos, end, tokenBegin, tokenEnd ) )
+    {
+        return false;
+    }
+    const auto *separator =
+        static_cast<const char *>( memchr( tokenBegin, '#', static_cast<size_t>( tokenEnd - tokenBegin ) ) );
+    if ( ( separator == nullptr ) || !parseCanId( tokenBegin, separator, true, true, frame.id ) )
+    {
+        return false;
+    }
+    const char *data = separator + 1;
+    if ( ( data < tokenEnd ) && ( *data == '#' ) )
+    {
+        // Skip the CAN FD flags
+        data += 2;
+    }
+    else if ( ( data < tokenEnd ) && ( ( *data == 'R' ) || ( *data == 'r' ) ) )
+    {
+        // Remote frames carry no data
+        return false;
+    }
+    frame.length = 0;
+    while ( ( data + 1 ) < tokenEnd )
+    {
+        if ( *data == '.' )
+        {
+            data++;
+            continue;
+        }
+        auto high = hexDigit( data[0] );
+        auto low = hexDigit( data[1] );
+        if ( ( high < 0 ) || ( low < 0 ) || ( frame.length >= VehicleDataMessage::MAX_PAYLOAD_SIZE ) )
+        {
+            return false;
+        }
+        frame.data[frame.length++] = static_cast<uint8_t>( ( high << 4 ) | low );
+        data += 2;
+    }
+    return data == tokenEnd;
+}
+
+bool
+CANLogReplayDataSource::parseAscLine( const char *begin, const char *end, ReplayFrame &frame )
+{
+    // Header:  base hex  timestamps absolute
+    // Classic:    0.015991 1  123x            Rx   d 8 01 02 03 04 05 06 07 08
+    // CAN FD:     0.015991 CANFD   1 Rx        123  Name  1 0 d 12 01 02 ...
+    const char *tokenBegin = nullptr;
+    const char *tokenEnd = nullptr;
+    const char *pos = begin;
+    if ( !nextToken( pos, end, tokenBegin, tokenEnd ) )
+    {
+        return false;
+    }
+    if ( tokenEquals( tokenBegin, tokenEnd, "base" ) )
+    {
+        while ( nextToken( pos, end, tokenBegin, tokenEnd ) )
+        {
+            if ( tokenEquals( tokenBegin, tokenEnd, "dec" ) )
+            {
+                mAscHexBase = false;
+            }
+            else if ( tokenEquals( tokenBegin, tokenEnd, "hex" ) )
+            {
+                mAscHexBase = true;
+            }
+            else if ( tokenEquals( tokenBegin, tokenEnd, "relative" ) )
+            {
+                mAscRelativeTimestamps = true;
+            }
+            else if ( tokenEquals( tokenBegin, tokenEnd, "absolute" ) )
+            {
+                mAscRelativeTimestamps = false;
+            }
+        }
+        return false;
+    }
+    uint64_t timeUs = 0;
+    if ( !parseSecondsUs( tokenBegin, tokenEnd, timeUs ) )
+    {
+        return false;
+    }
+    if ( mAscRelativeTimestamps )
+    {
+        // Every event is relative to the previous one
+        timeUs += mAscPreviousTimeUs;
+    }
+    mAscPreviousTimeUs = timeUs;
+    frame.timeUs = timeUs;
+
+    if ( !nextToken( pos, end, tokenBegin, tokenEnd ) )
+    {
+        return false;
+    }
+    bool canFd = tokenEquals( tokenBegin, tokenEnd, "CANFD" );
+    if ( canFd && !nextToken( pos, end, tokenBegin, tokenEnd ) )
+    {
+        return false;
+    }
+    if ( !mChannel.empty() && !tokenEquals( tokenBegin, tokenEnd, mChannel.c_str() ) )
+    {
+        return false;
+    }
+    uint32_t dataLength = 0;
+    if ( canFd )
+    {
+        // Direction, ID, optional symbolic name, BRS, ESI, DLC, data length
+        const char *idBegin = nullptr;
+        const char *idEnd = nullptr;
+        if ( !nextToken( pos, end, tokenBegin, tokenEnd ) || !nextToken( pos, end, idBegin, idEnd ) ||
+             !parseCanId( idBegin, idEnd, mAscHexBase, false, frame.id ) )
+        {
+            return false;
+        }
+        uint32_t value = 0;
+        if ( !nextToken( pos, end, tokenBegin, tokenEnd ) )
+        {
+            return false;
+        }
+        if ( !parseNumber( tokenBegin, tokenEnd, false, value ) && !nextToken( pos, end, tokenBegin, tokenEnd ) )
+        {
+            return false;
+        }
+        // tokenBegin is BRS, followed by ESI and DLC
+        for ( int i = 0; i < 2; i++ )
+        {
+            if ( !nextToken( pos, end, tokenBegin, tokenEnd ) )
+            {
+                return false;
+            }
+        }
+        if ( !nextToken( pos, end, tokenBegin, tokenEnd ) || !parseNumber( tokenBegin, tokenEnd, false, dataLength ) )
+        {
+            return false;
+        }
+    }
+    else
+    {
+        // ID, direction, d for data frames, DLC
+        if ( !nextToken( pos, end, tokenBegin, tokenEnd ) ||
+             !parseCanId( tokenBegin, tokenEnd, mAscHexBase, false, frame.id ) ||
+             !nextToken( pos, end, tokenBegin, tokenEnd ) || !nextToken( pos, end, tokenBegin, tokenEnd ) ||
+             !tokenEquals( tokenBegin, tokenEnd, "d" ) || !nextToken( pos, end, tokenBegin, tokenEnd ) ||
+             !parseNumber( tokenBegin, tokenEnd, true, dataLength ) )
+        {
+            return false;
+        }
+    }
+    if ( dataLength > VehicleDataMessage::MAX_PAYLOAD_SIZE )
+    {
+        return false;
+    }
+    frame.length = static_cast<uint8_t>( dataLength );
+    for ( size_t i = 0; i < frame.length; i++ )
+    {
+        uint32_t byte = 0;
+        if ( !nextToken( pos, end, tokenBegin, tokenEnd ) || !parseNumber( tokenBegin, tokenEnd, mAscHexBase, byte ) ||
+             ( byte > UINT8_MAX ) )
+        {
+            return false;
+        }
+        frame.data[i] = static_cast<uint8_t>( byte );
+    }
+    return true;
+}
+
+} // namespace VehicleNetwork
+} // namespace IoTFleetWise
+} // namespace Aws
+#endif // IOTFLEETWISE_LINUX
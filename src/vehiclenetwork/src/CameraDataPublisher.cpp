@@ -129,14 +129,13 @@ CameraDataPublisher::start()
     // On multi core systems the shared variable mShouldStop must be updated for
     // all cores before starting the thread otherwise thread will directly end
     mShouldStop.store( false );
-    if ( !mThread.create( doWork, this ) )
+    if ( !mThread.create( doWork, this, "fwVNDDSCamPub" + std::to_string( mID ) ) )
     {
         mLogger.trace( "CameraDataPublisher::start", " Camera Publisher Thread failed to start " );
     }
     else
     {
         mLogger.trace( "CameraDataPublisher::start", " Camera Publisher Thread started " );
-        mThread.setThreadName( "fwVNDDSCamPub" + std::to_string( mID ) );
     }
     return mThread.isActive() && mThread.isValid();
 }
@@ -14,10 +14,11 @@
 // Includes
 #include "dds/CameraDataSubscriber.h"
 #include "ClockHandler.h"
+#include "dds/V4L2FrameEncoder.h"
 #include <cstdio>
+#include <fastdds/dds/core/LoanableSequence.hpp>
 #include <fastdds/rtps/transport/shared_mem/SharedMemTransportDescriptor.h>
 #include <fastrtps/transport/UDPv4TransportDescriptor.h>
-#include <fstream>
 #include <iostream>
 namespace Aws
 {
@@ -31,10 +32,13 @@ CameraDataSubscriber::CameraDataSubscriber()
     mID = generateChannelID();
 }
 
+constexpr size_t CameraDataSubscriber::WRITE_QUEUE_SIZE;
+constexpr size_t CameraDataSubscriber::MAX_PENDING_REQUESTS;
+
 CameraDataSubscriber::~CameraDataSubscriber()
 {
-    // To make sure the thread stops during teardown of tests.
-    if ( mThread.isValid() && mThread.isActive() )
+    // To make sure no task of the subscriber runs after teardown of tests.
+    if ( mConnected.load() )
     {
         stop();
     }
@@ -114,13 +118,29 @@ CameraDataSubscriber::init( const DDSDataSourceConfig &dataSourceConfig )
         return false;
     }
 
-    mDDSReader = mDDSSubscriber->create_datareader( mDDSTopic, DATAREADER_QOS_DEFAULT, this );
+    // Frames published on the same host are read directly from the shared memory pool of the writer instead of
+    // being copied through the transport. This falls back to the transport if the writer does not support it.
+    DataReaderQos readerQos = DATAREADER_QOS_DEFAULT;
+    readerQos.data_sharing().automatic();
+    mDDSReader = mDDSSubscriber->create_datareader( mDDSTopic, readerQos, this );
     if ( mDDSReader == nullptr )
     {
         return false;
     }
     // Store the source ID to be able to report on the right Source when we receive data.
     mSourceID = dataSourceConfig.sourceID;
+    mFrameProcessor = std::make_unique<FrameProcessor>(
+        std::make_unique<V4L2FrameEncoder>(), dataSourceConfig.frameWidth, dataSourceConfig.frameHeight );
+    // The pre-trigger buffer is optional, without it the frames before a trigger are requested from the source
+    if ( dataSourceConfig.preTriggerBufferSizeBytes > 0U )
+    {
+        mPreTriggerBufferEnabled =
+            mPreTriggerBuffer.init( mCachePath + PRE_TRIGGER_BUFFER_FILE_NAME, dataSourceConfig.preTriggerBufferSizeBytes );
+        if ( !mPreTriggerBufferEnabled )
+        {
+            mLogger.warn( "CameraDataSubscriber::init", " Pre-trigger buffer could not be created, it is disabled " );
+        }
+    }
     return true;
 }
 
@@ -129,77 +149,237 @@ CameraDataSubscriber::start()
 {
     // Prevent concurrent stop/init
     std::lock_guard<std::mutex> lock( mThreadMutex );
-    // On multi core systems the shared variable mShouldStop must be updated for
-    // all cores before starting the thread otherwise thread will directly end
-    mShouldStop.store( false );
-    if ( !mThread.create( doWork, this ) )
+    if ( mExecutor == nullptr )
     {
-        mLogger.trace( "CameraDataSubscriber::start", " Camera Subscriber Thread failed to start " );
+        mExecutor = std::make_shared<SerialTaskExecutor>( 1U, "fwVNDDSCamSub" + std::to_string( mID ) + "_" );
+        mOwnsExecutor = true;
     }
-    else
+    if ( mOwnsExecutor && ( !mExecutor->start() ) )
     {
-        mLogger.trace( "CameraDataSubscriber::start", " Camera Subscriber Thread started " );
-        mThread.setThreadName( "fwVNDDSCamSub" + std::to_string( mID ) );
+        mLogger.error( "CameraDataSubscriber::start", " Executor failed to start " );
+        return false;
     }
-    return mThread.isActive() && mThread.isValid();
+    // The take and the writes have their own queues, so the next response can be taken while one is written
+    mTakeQueue = mExecutor->createQueue( 1U );
+    mWriteQueue = mExecutor->createQueue( WRITE_QUEUE_SIZE );
+    mTakeScheduled.store( false );
+    mTakeDeferred.store( false );
+    mConnected.store( true );
+    mLogger.trace( "CameraDataSubscriber::start", " Camera Subscriber started " );
+    return true;
 }
 
 bool
 CameraDataSubscriber::stop()
 {
     std::lock_guard<std::mutex> lock( mThreadMutex );
-    mShouldStop.store( true, std::memory_order_relaxed );
-    mWait.notify();
-    mThread.release();
-    mShouldStop.store( false, std::memory_order_relaxed );
-    mLogger.trace( "CameraDataSubscriber::stop", " Camera Subscriber Thread stopped " );
-    return !mThread.isActive();
+    if ( !mConnected.exchange( false ) )
+    {
+        return true;
+    }
+    // The artifacts handed over before are still written. The ids of removed queues are not reused, so a late
+    // notification from the reader can not post to another queue.
+    mExecutor->removeQueue( mTakeQueue );
+    mExecutor->removeQueue( mWriteQueue );
+    bool stopped = true;
+    if ( mOwnsExecutor )
+    {
+        stopped = mExecutor->stop();
+    }
+    mLogger.trace( "CameraDataSubscriber::stop", " Camera Subscriber stopped " );
+    return stopped;
+}
+
+void
+CameraDataSubscriber::scheduleTake()
+{
+    if ( mConnected.load() && ( !mTakeScheduled.exchange( true ) ) &&
+         ( !mExecutor->post( mTakeQueue, [this]() { takeAndPersistResponses(); } ) ) )
+    {
+        mTakeScheduled.store( false );
+    }
 }
 
 bool
-CameraDataSubscriber::shouldStop() const
+CameraDataSubscriber::canSubmitArtifact() const
 {
-    return mShouldStop.load( std::memory_order_relaxed );
+    return mExecutor->getPendingTaskCount( mWriteQueue ) < WRITE_QUEUE_SIZE;
 }
 
 void
-CameraDataSubscriber::doWork( void *data )
+CameraDataSubscriber::takeAndPersistResponses()
 {
-
-    CameraDataSubscriber *subscriber = static_cast<CameraDataSubscriber *>( data );
-
-    while ( !subscriber->shouldStop() )
+    // Reset before taking, so that a response arriving meanwhile schedules the next take
+    mTakeScheduled.store( false );
+    LoanableSequence<CameraDataItem> dataItems;
+    SampleInfoSeq sampleInfos;
+    while ( true )
     {
-        // Wait for data to arrive from the DDS Network.
-        subscriber->mWait.wait( Platform::Linux::Signal::WaitWithPredicate );
-        // Ok we have received data and it should have been loaded into our CameraDataItem.
-        // We should log it into local storage location and then notify the DDS Handler that
-        // the data is ready.
-        // Make sure that we only notify during normal cycle and NOT on shutdown
-        if ( subscriber->mNewResponseReceived.load() )
+        if ( !canSubmitArtifact() )
         {
-
-            SensorArtifactMetadata cameraArtifact;
-            cameraArtifact.path = subscriber->mCachePath + subscriber->mDataItem.dataItemId();
-            cameraArtifact.sourceID = subscriber->mSourceID;
-            if ( Aws::IoTFleetWise::VehicleNetwork::CameraDataSubscriber::persistToStorage(
-                     subscriber->mDataItem.frameBuffer(), cameraArtifact.path ) )
+            // A write completing from now on schedules the take again. If it already completed, continue here.
+            mTakeDeferred.store( true );
+            if ( ( !canSubmitArtifact() ) || ( !mTakeDeferred.exchange( false ) ) )
+            {
+                return;
+            }
+        }
+        // One response at a time, so that the remaining ones stay in the reader while the writes are behind
+        if ( mDDSReader->take( dataItems, sampleInfos, 1 ) != ReturnCode_t::RETCODE_OK )
+        {
+            return;
+        }
+        for ( LoanableCollection::size_type i = 0; i < sampleInfos.length(); i++ )
+        {
+            if ( !sampleInfos[i].valid_data )
+            {
+                continue;
+            }
+            // We should log it into local storage location and then notify the DDS Handler that
+            // the data is ready. The frames are moved out of the loan, which is returned right after.
+            auto &dataItem = dataItems[i];
+            if ( mPreTriggerBufferEnabled )
             {
-                subscriber->notifyListeners<const SensorArtifactMetadata &>(
-                    &SensorDataListener::onSensorArtifactAvailable, cameraArtifact );
-                subscriber->mLogger.info( "CameraDataSubscriber::doWork",
-                                          " Data Collected from the Camera and made available " );
+                appendToPreTriggerBuffer( dataItem );
             }
-            else
+            std::vector<std::vector<uint8_t>> frames;
+            frames.reserve( dataItem.frameBuffer().size() );
+            for ( auto &frame : dataItem.frameBuffer() )
             {
-                subscriber->mLogger.error( "CameraDataSubscriber::doWork",
-                                           " Could not persist the data received into disk " );
+                frames.emplace_back( std::move( frame.frameData() ) );
             }
+            auto dataRequest = takeDataRequest( dataItem.dataItemId() );
+            if ( !submitArtifact( mCachePath + dataItem.dataItemId().c_str(), std::move( frames ), dataRequest ) )
+            {
+                mLogger.error( "CameraDataSubscriber::takeAndPersistResponses",
+                               " Could not queue the data received for writing " );
+            }
+        }
+        mDDSReader->return_loan( dataItems, sampleInfos );
+    }
+}
 
-            // Reset the response
-            subscriber->mNewResponseReceived.store( false, std::memory_order_relaxed );
+void
+CameraDataSubscriber::registerDataRequest( const DDSDataRequest &dataRequest )
+{
+    std::lock_guard<std::mutex> lock( mPendingRequestsMutex );
+    mPendingRequests.push_back( dataRequest );
+    // Sources that never respond must not grow the list
+    if ( mPendingRequests.size() > MAX_PENDING_REQUESTS )
+    {
+        mPendingRequests.pop_front();
+    }
+}
+
+DDSDataRequest
+CameraDataSubscriber::takeDataRequest( const std::string &dataItemId )
+{
+    std::lock_guard<std::mutex> lock( mPendingRequestsMutex );
+    for ( auto request = mPendingRequests.begin(); request != mPendingRequests.end(); request++ )
+    {
+        if ( std::to_string( request->eventID ) == dataItemId )
+        {
+            auto dataRequest = *request;
+            mPendingRequests.erase( request );
+            return dataRequest;
         }
     }
+    return DDSDataRequest();
+}
+
+bool
+CameraDataSubscriber::submitArtifact( std::string artifactPath,
+                                      std::vector<std::vector<uint8_t>> frames,
+                                      const DDSDataRequest &dataRequest )
+{
+    return mExecutor->post( mWriteQueue,
+                            [this,
+                             artifactPath = std::move( artifactPath ),
+                             frames = std::move( frames ),
+                             imageType = dataRequest.imageType,
+                             captureOptions = dataRequest.captureOptions]() mutable {
+                                // Done here, so that the take is not delayed by it
+                                mFrameProcessor->process( frames, captureOptions, imageType );
+                                bool success = ArtifactWriter::writeArtifact( artifactPath, frames );
+                                // Release the frames before the notification, so that their memory is available
+                                // for the next artifact
+                                frames.clear();
+                                frames.shrink_to_fit();
+                                onArtifactWritten( artifactPath, success );
+                                if ( mTakeDeferred.exchange( false ) )
+                                {
+                                    scheduleTake();
+                                }
+                            } );
+}
+
+void
+CameraDataSubscriber::appendToPreTriggerBuffer( const CameraDataItem &dataItem )
+{
+    for ( const auto &frame : dataItem.frameBuffer() )
+    {
+        // Responses to requests repeat frames that are already buffered, only newer frames are appended
+        if ( frame.timestamp() > mPreTriggerBuffer.getNewestTimestamp() )
+        {
+            (void)mPreTriggerBuffer.append( frame.timestamp(), frame.frameData().data(), frame.frameData().size() );
+        }
+    }
+}
+
+void
+CameraDataSubscriber::onArtifactWritten( const std::string &artifactPath, bool success )
+{
+    if ( success )
+    {
+        SensorArtifactMetadata cameraArtifact;
+        cameraArtifact.path = artifactPath;
+        cameraArtifact.sourceID = mSourceID;
+        notifyListeners<const SensorArtifactMetadata &>( &SensorDataListener::onSensorArtifactAvailable,
+                                                         cameraArtifact );
+        mLogger.info( "CameraDataSubscriber::onArtifactWritten", " Data Collected from the Camera and made available " );
+    }
+    else
+    {
+        mLogger.error( "CameraDataSubscriber::onArtifactWritten", " Could not persist the data received into disk " );
+    }
+}
+
+void
+CameraDataSubscriber::setPreTriggerRetentionMs( uint32_t retentionMs )
+{
+    if ( mPreTriggerBufferEnabled )
+    {
+        mPreTriggerBuffer.setRetentionMs( retentionMs );
+        mLogger.trace( "CameraDataSubscriber::setPreTriggerRetentionMs",
+                       " Frames are buffered for " + std::to_string( retentionMs ) + " ms" );
+    }
+}
+
+bool
+CameraDataSubscriber::persistFromPreTriggerBuffer( const DDSDataRequest &dataRequest )
+{
+    if ( ( !mPreTriggerBufferEnabled ) || ( mPreTriggerBuffer.getRetentionMs() == 0U ) )
+    {
+        return false;
+    }
+    auto now = mClock->timeSinceEpochMs();
+    // The buffer must be recent, otherwise the camera stopped publishing and the data has to be requested
+    if ( mPreTriggerBuffer.getNewestTimestamp() + PRE_TRIGGER_BUFFER_MAX_AGE_MS < now + dataRequest.positiveOffsetMs )
+    {
+        return false;
+    }
+    std::vector<std::vector<uint8_t>> frames;
+    if ( ( dataRequest.negativeOffsetMs > now ) ||
+         ( !mPreTriggerBuffer.slice(
+             now - dataRequest.negativeOffsetMs, now + dataRequest.positiveOffsetMs, frames ) ) )
+    {
+        return false;
+    }
+    mLogger.trace( "CameraDataSubscriber::persistFromPreTriggerBuffer",
+                   " Persisting " + std::to_string( frames.size() ) + " buffered frames for event " +
+                       std::to_string( dataRequest.eventID ) );
+    return mConnected.load() &&
+           submitArtifact( mCachePath + std::to_string( dataRequest.eventID ), std::move( frames ), dataRequest );
 }
 
 bool
@@ -217,7 +397,8 @@ CameraDataSubscriber::disconnect()
 bool
 CameraDataSubscriber::isAlive()
 {
-    return ( mIsAlive.load( std::memory_order_relaxed ) && mThread.isValid() && mThread.isActive() );
+    return ( mIsAlive.load( std::memory_order_relaxed ) && mConnected.load() && ( mExecutor != nullptr ) &&
+             mExecutor->isAlive() );
 }
 
 void
@@ -239,41 +420,10 @@ CameraDataSubscriber::on_subscription_matched( DataReader *reader, const Subscri
 void
 CameraDataSubscriber::on_data_available( DataReader *reader )
 {
-    SampleInfo info;
-    if ( reader->take_next_sample( &mDataItem, &info ) == ReturnCode_t::RETCODE_OK )
-    {
-        if ( info.valid_data )
-        {
-            mNewResponseReceived.store( true, std::memory_order_relaxed );
-            mLogger.trace( "CameraDataSubscriber::on_data_available", " Data received from the DDS Node " );
-            mWait.notify();
-        }
-    }
-}
-
-bool
-CameraDataSubscriber::persistToStorage( const std::vector<CameraFrame> &frameBuffer, const std::string &fileName )
-{
-    // To be sure, cleanup any file with the same name
-    (void)remove( fileName.c_str() );
-    // First create the file
-    std::ofstream newFile( fileName.c_str(), std::ios_base::binary | std::ios_base::app );
-    if ( !newFile.is_open() )
-    {
-        return false;
-    }
-    else
-    {
-        // Iterate over all frames and append their data to the file.
-        for ( const auto &frameData : frameBuffer )
-        { // Write buffer to IO.
-            newFile.write( reinterpret_cast<const char *>( frameData.frameData().data() ),
-                           static_cast<std::streamsize>( frameData.frameData().size() ) );
-        }
+    (void)reader; // unused variable
 
-        newFile.close();
-        return newFile.good();
-    }
+    mLogger.trace( "CameraDataSubscriber::on_data_available", " Data received from the DDS Node " );
+    scheduleTake();
 }
 
 } // namespace VehicleNetwork
@@ -0,0 +1,178 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "dds/FrameProcessor.h"
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <utility>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace VehicleNetwork
+{
+
+constexpr size_t FrameProcessor::SIMILARITY_SAMPLE_COUNT;
+
+namespace
+{
+// H.264 NAL unit types of the slices
+constexpr uint8_t H264_NAL_TYPE_NON_IDR_SLICE = 1U;
+constexpr uint8_t H264_NAL_TYPE_IDR_SLICE = 5U;
+constexpr uint8_t H264_NAL_TYPE_MASK = 0x1FU;
+} // namespace
+
+FrameProcessor::FrameProcessor( std::unique_ptr<IFrameEncoder> encoder, uint32_t frameWidth, uint32_t frameHeight )
+    : mEncoder( std::move( encoder ) )
+    , mFrameWidth( frameWidth )
+    , mFrameHeight( frameHeight )
+{
+}
+
+void
+FrameProcessor::process( std::vector<std::vector<uint8_t>> &frames,
+                         const ImageCaptureOptions &options,
+                         uint32_t imageType )
+{
+    auto receivedCount = frames.size();
+    std::vector<std::vector<uint8_t>> keptFrames;
+    keptFrames.reserve( frames.size() );
+    size_t candidateIndex = 0;
+    for ( auto &frame : frames )
+    {
+        if ( options.keyFramesOnly && ( !isKeyFrame( frame ) ) )
+        {
+            continue;
+        }
+        auto index = candidateIndex++;
+        if ( ( options.keepEveryNthFrame > 1U ) && ( ( index % options.keepEveryNthFrame ) != 0U ) )
+        {
+            continue;
+        }
+        if ( ( options.similarityThreshold > 0.0 ) && ( !keptFrames.empty() ) &&
+             ( getSimilarity( keptFrames.back(), frame ) >= options.similarityThreshold ) )
+        {
+            continue;
+        }
+        keptFrames.emplace_back( std::move( frame ) );
+    }
+    frames = std::move( keptFrames );
+    if ( frames.size() != receivedCount )
+    {
+        mLogger.trace( "FrameProcessor::process",
+                       " Kept " + std::to_string( frames.size() ) + " of " + std::to_string( receivedCount ) +
+                           " frames" );
+    }
+    if ( ( options.encoding != ImageEncoding::ORIGINAL ) && ( !frames.empty() ) )
+    {
+        encodeFrames( frames, options, imageType );
+    }
+}
+
+void
+FrameProcessor::encodeFrames( std::vector<std::vector<uint8_t>> &frames,
+                              const ImageCaptureOptions &options,
+                              uint32_t imageType )
+{
+    if ( imageType < IMAGE_TYPE_RAW_RGB8 )
+    {
+        mLogger.warn( "FrameProcessor::encodeFrames", " Only raw frames are re-encoded, frames kept as received " );
+        return;
+    }
+    if ( ( mEncoder == nullptr ) || ( mFrameWidth == 0U ) || ( mFrameHeight == 0U ) )
+    {
+        mLogger.warn( "FrameProcessor::encodeFrames",
+                      " No encoder or frame size configured, frames kept as received " );
+        return;
+    }
+    auto quality = std::min( std::max( options.encodingQuality, 1U ), 100U );
+    // All frames of an artifact have the same format, so they are only replaced once all are encoded
+    std::vector<std::vector<uint8_t>> encodedFrames( frames.size() );
+    for ( size_t i = 0; i < frames.size(); i++ )
+    {
+        if ( !mEncoder->encode(
+                 frames[i], imageType, mFrameWidth, mFrameHeight, options.encoding, quality, encodedFrames[i] ) )
+        {
+            mLogger.warn( "FrameProcessor::encodeFrames", " Frames could not be encoded, kept as received " );
+            return;
+        }
+    }
+    frames = std::move( encodedFrames );
+}
+
+bool
+FrameProcessor::isKeyFrame( const std::vector<uint8_t> &frame )
+{
+    // H.264 in Annex B format starts with the start code 0x000001, possibly preceded by further zero bytes
+    size_t leadingZeros = 0;
+    while ( ( leadingZeros < frame.size() ) && ( frame[leadingZeros] == 0U ) )
+    {
+        leadingZeros++;
+    }
+    if ( ( leadingZeros < 2U ) || ( leadingZeros >= frame.size() ) || ( frame[leadingZeros] != 1U ) )
+    {
+        return true;
+    }
+    // The first slice decides, the parameter sets and SEI before it are skipped
+    for ( size_t i = 0; i + 3U < frame.size(); i++ )
+    {
+        if ( ( frame[i] != 0U ) || ( frame[i + 1U] != 0U ) || ( frame[i + 2U] != 1U ) )
+        {
+            continue;
+        }
+        auto nalType = static_cast<uint8_t>( frame[i + 3U] & H264_NAL_TYPE_MASK );
+        if ( nalType == H264_NAL_TYPE_IDR_SLICE )
+        {
+            return true;
+        }
+        if ( nalType == H264_NAL_TYPE_NON_IDR_SLICE )
+        {
+            return false;
+        }
+        i += 3U;
+    }
+    return false;
+}
+
+double
+FrameProcessor::getSimilarity( const std::vector<uint8_t> &first, const std::vector<uint8_t> &second )
+{
+    auto length = std::max( first.size(), second.size() );
+    if ( length == 0U )
+    {
+        return 1.0;
+    }
+    auto sampleCount = std::min( length, SIMILARITY_SAMPLE_COUNT );
+    uint64_t difference = 0;
+    for ( size_t i = 0; i < sampleCount; i++ )
+    {
+        // Evenly spread over the longer frame
+        auto position = static_cast<size_t>( ( static_cast<uint64_t>( i ) * length ) / sampleCount );
+        if ( ( position >= first.size() ) || ( position >= second.size() ) )
+        {
+            difference += UINT8_MAX;
+        }
+        else
+        {
+            difference += static_cast<uint64_t>( std::abs( static_cast<int>( first[position] ) - second[position] ) );
+        }
+    }
+    return 1.0 - ( static_cast<double>( difference ) / ( static_cast<double>( sampleCount ) * UINT8_MAX ) );
+}
+
+} // namespace VehicleNetwork
+} // namespace IoTFleetWise
+} // namespace Aws
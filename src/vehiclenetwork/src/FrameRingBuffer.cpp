@@ -0,0 +1,198 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "dds/FrameRingBuffer.h"
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace VehicleNetwork
+{
+
+FrameRingBuffer::~FrameRingBuffer()
+{
+    release();
+}
+
+void
+FrameRingBuffer::release()
+{
+    if ( mData != nullptr )
+    {
+        (void)munmap( mData, mCapacity );
+        mData = nullptr;
+    }
+    if ( mFileDescriptor >= 0 )
+    {
+        (void)close( mFileDescriptor );
+        mFileDescriptor = -1;
+    }
+    mCapacity = 0;
+    mEntries.clear();
+}
+
+bool
+FrameRingBuffer::init( const std::string &path, size_t capacityBytes )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    release();
+    if ( capacityBytes == 0U )
+    {
+        return false;
+    }
+    mFileDescriptor = open( path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600 );
+    if ( mFileDescriptor < 0 )
+    {
+        mLogger.error( "FrameRingBuffer::init", "Could not create the ring file " + path );
+        return false;
+    }
+    if ( ftruncate( mFileDescriptor, static_cast<off_t>( capacityBytes ) ) != 0 )
+    {
+        mLogger.error( "FrameRingBuffer::init", "Could not resize the ring file " + path );
+        release();
+        return false;
+    }
+    void *data = mmap( nullptr, capacityBytes, PROT_READ | PROT_WRITE, MAP_SHARED, mFileDescriptor, 0 );
+    if ( data == MAP_FAILED )
+    {
+        mLogger.error( "FrameRingBuffer::init", "Could not map the ring file " + path );
+        release();
+        return false;
+    }
+    mData = static_cast<uint8_t *>( data );
+    mCapacity = capacityBytes;
+    mLogger.trace( "FrameRingBuffer::init",
+                   "Mapped the ring file " + path + " of " + std::to_string( capacityBytes ) + " bytes" );
+    return true;
+}
+
+void
+FrameRingBuffer::setRetentionMs( uint32_t retentionMs )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    mRetentionMs = retentionMs;
+    if ( mRetentionMs == 0U )
+    {
+        mEntries.clear();
+    }
+}
+
+uint32_t
+FrameRingBuffer::getRetentionMs() const
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    return mRetentionMs;
+}
+
+size_t
+FrameRingBuffer::makeRoom( size_t size )
+{
+    while ( !mEntries.empty() )
+    {
+        auto head = mEntries.front().offset;
+        auto tail = mEntries.back().offset + mEntries.back().size;
+        if ( mEntries.back().offset >= head )
+        {
+            // The frames are stored in [head, tail), so there is space at the end and at the beginning
+            if ( mCapacity - tail >= size )
+            {
+                return tail;
+            }
+            if ( head >= size )
+            {
+                return 0;
+            }
+        }
+        // The frames wrapped around, so there is only space between the newest and the oldest frame
+        else if ( head - tail >= size )
+        {
+            return tail;
+        }
+        mEntries.pop_front();
+    }
+    return 0;
+}
+
+bool
+FrameRingBuffer::append( Timestamp timestamp, const uint8_t *data, size_t size )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    if ( ( mData == nullptr ) || ( mRetentionMs == 0U ) || ( size > mCapacity ) ||
+         ( ( data == nullptr ) && ( size > 0U ) ) )
+    {
+        return false;
+    }
+    if ( ( !mEntries.empty() ) && ( timestamp <= mEntries.back().timestamp ) )
+    {
+        return false;
+    }
+    // The oldest frame is only dropped once the next one is also older than the retention time
+    while ( ( mEntries.size() >= 2U ) && ( mEntries[1].timestamp + mRetentionMs <= timestamp ) )
+    {
+        mEntries.pop_front();
+    }
+    auto offset = makeRoom( size );
+    if ( size > 0U )
+    {
+        std::memcpy( mData + offset, data, size );
+    }
+    mEntries.push_back( Entry{ timestamp, offset, size } );
+    return true;
+}
+
+bool
+FrameRingBuffer::slice( Timestamp from, Timestamp to, std::vector<std::vector<uint8_t>> &frames ) const
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    if ( mEntries.empty() || ( mEntries.front().timestamp > from ) )
+    {
+        return false;
+    }
+    frames.clear();
+    for ( const auto &entry : mEntries )
+    {
+        if ( entry.timestamp > to )
+        {
+            break;
+        }
+        if ( entry.timestamp >= from )
+        {
+            frames.emplace_back( mData + entry.offset, mData + entry.offset + entry.size );
+        }
+    }
+    return true;
+}
+
+Timestamp
+FrameRingBuffer::getNewestTimestamp() const
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    return mEntries.empty() ? 0 : mEntries.back().timestamp;
+}
+
+size_t
+FrameRingBuffer::getFrameCount() const
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    return mEntries.size();
+}
+
+} // namespace VehicleNetwork
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -26,10 +26,6 @@
 #include <sys/types.h>
 #include <unistd.h>
 
-// ISO TP maximum PDU size is 4095, additional bytes are needed
-// for the Linux Networking stack internals.
-#define MAX_PDU_SIZE 5000
-
 namespace Aws
 {
 namespace IoTFleetWise
@@ -133,6 +129,20 @@ ISOTPOverCANReceiver::isAlive() const
 bool
 ISOTPOverCANReceiver::receivePDU( std::vector<uint8_t> &pduData )
 {
+    // To pass on the vector to read, we need to reserve some bytes. The capacity is kept, so a vector reused by the
+    // caller is only allocated once.
+    pduData.resize( MAX_PDU_SIZE );
+    size_t size = 0;
+    bool received = receivePDU( pduData.data(), pduData.size(), size );
+    // Remove the unnecessary bytes from the PDU container.
+    pduData.resize( size );
+    return received;
+}
+
+bool
+ISOTPOverCANReceiver::receivePDU( uint8_t *buffer, size_t capacity, size_t &size )
+{
+    size = 0;
     if ( mReceiverOptions.mP2TimeoutMs > P2_TIMEOUT_INFINITE )
     {
         struct pollfd pfd = { mSocket, POLLIN, 0 };
@@ -143,22 +153,16 @@ ISOTPOverCANReceiver::receivePDU( std::vector<uint8_t> &pduData )
             return false;
         }
     }
-    // To pass on the vector to read, we need to reserve some bytes.
-    pduData.resize( MAX_PDU_SIZE );
     // coverity[check_return : SUPPRESS]
-    int bytesRead = static_cast<int>( read( mSocket, pduData.data(), MAX_PDU_SIZE ) );
-    mLogger.trace( "ISOTPOverCANReceiver::receivePDU", " Received a PDU of size:" + std::to_string( bytesRead ) );
-    // Remove the unnecessary bytes from the PDU container.
-    if ( bytesRead > 0 )
-    {
-        pduData.resize( static_cast<size_t>( bytesRead ) );
-    }
-    else
+    auto bytesRead = read( mSocket, buffer, capacity );
+    mLogger.trace( "ISOTPOverCANReceiver::receivePDU",
+                   [bytesRead]() { return " Received a PDU of size:" + std::to_string( bytesRead ); } );
+    if ( bytesRead <= 0 )
     {
-        pduData.resize( 0 );
+        return false;
     }
-
-    return bytesRead > 0;
+    size = static_cast<size_t>( bytesRead );
+    return true;
 }
 
 } // namespace VehicleNetwork
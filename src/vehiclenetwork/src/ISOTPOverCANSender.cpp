@@ -119,9 +119,16 @@ ISOTPOverCANSender::isAlive() const
 bool
 ISOTPOverCANSender::sendPDU( const std::vector<uint8_t> &pduData )
 {
-    int bytesWritten = static_cast<int>( write( mSocket, pduData.data(), pduData.size() ) );
-    mLogger.trace( "ISOTPOverCANSender::sendPDU", " sent a PDU of size:" + std::to_string( bytesWritten ) );
-    return ( bytesWritten > 0 && bytesWritten == static_cast<int>( pduData.size() ) );
+    return sendPDU( pduData.data(), pduData.size() );
+}
+
+bool
+ISOTPOverCANSender::sendPDU( const uint8_t *data, size_t size )
+{
+    auto bytesWritten = write( mSocket, data, size );
+    mLogger.trace( "ISOTPOverCANSender::sendPDU",
+                   [bytesWritten]() { return " sent a PDU of size:" + std::to_string( bytesWritten ); } );
+    return ( bytesWritten > 0 ) && ( static_cast<size_t>( bytesWritten ) == size );
 }
 
 } // namespace VehicleNetwork
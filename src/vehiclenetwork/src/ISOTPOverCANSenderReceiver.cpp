@@ -26,10 +26,6 @@
 #include <sys/types.h>
 #include <unistd.h>
 
-// ISO TP maximum PDU size is 4095, additional bytes are needed
-// for the Linux Networking stack internals.
-#define MAX_PDU_SIZE 5000
-
 namespace Aws
 {
 namespace IoTFleetWise
@@ -136,6 +132,20 @@ ISOTPOverCANSenderReceiver::isAlive() const
 bool
 ISOTPOverCANSenderReceiver::receivePDU( std::vector<uint8_t> &pduData )
 {
+    // To pass on the vector to read, we need to reserve some bytes. The capacity is kept, so a vector reused by the
+    // caller is only allocated once.
+    pduData.resize( MAX_PDU_SIZE );
+    size_t size = 0;
+    bool received = receivePDU( pduData.data(), pduData.size(), size );
+    // Remove the unnecessary bytes from the PDU container.
+    pduData.resize( size );
+    return received;
+}
+
+bool
+ISOTPOverCANSenderReceiver::receivePDU( uint8_t *buffer, size_t capacity, size_t &size )
+{
+    size = 0;
     if ( mSenderReceiverOptions.mP2TimeoutMs > P2_TIMEOUT_INFINITE )
     {
         struct pollfd pfd = { mSocket, POLLIN, 0 };
@@ -146,30 +156,31 @@ ISOTPOverCANSenderReceiver::receivePDU( std::vector<uint8_t> &pduData )
             return false;
         }
     }
-    // To pass on the vector to read, we need to reserve some bytes.
-    pduData.resize( MAX_PDU_SIZE );
     // coverity[check_return : SUPPRESS]
-    int bytesRead = static_cast<int>( read( mSocket, pduData.data(), MAX_PDU_SIZE ) );
-    mLogger.trace( "ISOTPOverCANSenderReceiver::receivePDU", " Received a PDU of size:" + std::to_string( bytesRead ) );
-    // Remove the unnecessary bytes from the PDU container.
-    if ( bytesRead > 0 )
+    auto bytesRead = read( mSocket, buffer, capacity );
+    mLogger.trace( "ISOTPOverCANSenderReceiver::receivePDU",
+                   [bytesRead]() { return " Received a PDU of size:" + std::to_string( bytesRead ); } );
+    if ( bytesRead <= 0 )
     {
-        pduData.resize( static_cast<size_t>( bytesRead ) );
-    }
-    else
-    {
-        pduData.resize( 0 );
+        return false;
     }
-
-    return bytesRead > 0;
+    size = static_cast<size_t>( bytesRead );
+    return true;
 }
 
 bool
 ISOTPOverCANSenderReceiver::sendPDU( const std::vector<uint8_t> &pduData )
 {
-    int bytesWritten = static_cast<int>( write( mSocket, pduData.data(), pduData.size() ) );
-    mLogger.trace( "ISOTPOverCANSenderReceiver::sendPDU", " sent a PDU of size:" + std::to_string( bytesWritten ) );
-    return ( bytesWritten > 0 && bytesWritten == static_cast<int>( pduData.size() ) );
+    return sendPDU( pduData.data(), pduData.size() );
+}
+
+bool
+ISOTPOverCANSenderReceiver::sendPDU( const uint8_t *data, size_t size )
+{
+    auto bytesWritten = write( mSocket, data, size );
+    mLogger.trace( "ISOTPOverCANSenderReceiver::sendPDU",
+                   [bytesWritten]() { return " sent a PDU of size:" + std::to_string( bytesWritten ); } );
+    return ( bytesWritten > 0 ) && ( static_cast<size_t>( bytesWritten ) == size );
 }
 
 } // namespace VehicleNetwork
@@ -0,0 +1,384 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "dds/V4L2FrameEncoder.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/videodev2.h>
+#include <poll.h>
+#include <string>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace VehicleNetwork
+{
+
+constexpr uint32_t V4L2FrameEncoder::MAX_DEVICE_INDEX;
+constexpr int V4L2FrameEncoder::ENCODE_TIMEOUT_MS;
+
+namespace
+{
+int
+xioctl( int fd, unsigned long request, void *arg )
+{
+    int result = 0;
+    do
+    {
+        result = ioctl( fd, request, arg );
+    } while ( ( result < 0 ) && ( errno == EINTR ) );
+    return result;
+}
+
+// Returns the V4L2 pixel format and the bytes per pixel of a raw image type, 0 if not supported
+uint32_t
+getPixelFormat( uint32_t imageType, uint32_t &bytesPerPixel )
+{
+    switch ( imageType )
+    {
+    case IMAGE_TYPE_RAW_RGB8:
+        bytesPerPixel = 3;
+        return V4L2_PIX_FMT_RGB24;
+    case IMAGE_TYPE_RAW_BGR8:
+        bytesPerPixel = 3;
+        return V4L2_PIX_FMT_BGR24;
+    case IMAGE_TYPE_RAW_MONO8:
+        bytesPerPixel = 1;
+        return V4L2_PIX_FMT_GREY;
+    default:
+        bytesPerPixel = 0;
+        return 0;
+    }
+}
+} // namespace
+
+V4L2FrameEncoder::~V4L2FrameEncoder()
+{
+    releaseBuffers();
+    if ( mFd >= 0 )
+    {
+        close( mFd );
+    }
+}
+
+uint32_t
+V4L2FrameEncoder::getOutputType() const
+{
+    return mMultiPlanar ? V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE : V4L2_BUF_TYPE_VIDEO_OUTPUT;
+}
+
+uint32_t
+V4L2FrameEncoder::getCaptureType() const
+{
+    return mMultiPlanar ? V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE : V4L2_BUF_TYPE_VIDEO_CAPTURE;
+}
+
+bool
+V4L2FrameEncoder::encode( const std::vector<uint8_t> &frame,
+                          uint32_t imageType,
+                          uint32_t width,
+                          uint32_t height,
+                          ImageEncoding encoding,
+                          uint32_t quality,
+                          std::vector<uint8_t> &encoded )
+{
+    // The memory-to-memory API has no WebP format
+    if ( encoding != ImageEncoding::JPEG )
+    {
+        return false;
+    }
+    uint32_t bytesPerPixel = 0;
+    auto pixelFormat = getPixelFormat( imageType, bytesPerPixel );
+    if ( ( pixelFormat == 0U ) || ( static_cast<uint64_t>( width ) * height * bytesPerPixel != frame.size() ) )
+    {
+        return false;
+    }
+    if ( !mDeviceSearched )
+    {
+        mDeviceSearched = true;
+        if ( !openDevice() )
+        {
+            mLogger.warn( "V4L2FrameEncoder::encode", " No hardware JPEG encoder found, frames are not encoded " );
+        }
+    }
+    if ( ( mFd < 0 ) || ( !configure( pixelFormat, width * bytesPerPixel, width, height, quality ) ) ||
+         ( frame.size() > mOutputBuffer.length ) )
+    {
+        return false;
+    }
+    std::memcpy( mOutputBuffer.address, frame.data(), frame.size() );
+    size_t encodedSize = 0;
+    size_t consumedSize = 0;
+    if ( ( !queueBuffer( getOutputType(), frame.size() ) ) || ( !queueBuffer( getCaptureType(), 0 ) ) ||
+         ( !dequeueBuffer( getCaptureType(), POLLIN, encodedSize ) ) ||
+         ( !dequeueBuffer( getOutputType(), POLLOUT, consumedSize ) ) || ( encodedSize > mCaptureBuffer.length ) )
+    {
+        // The buffers may still be queued, start over with the next frame
+        mLogger.error( "V4L2FrameEncoder::encode", " Encoding failed: " + std::string( std::strerror( errno ) ) );
+        releaseBuffers();
+        return false;
+    }
+    auto *encodedData = static_cast<const uint8_t *>( mCaptureBuffer.address );
+    encoded.assign( encodedData, encodedData + encodedSize );
+    return true;
+}
+
+bool
+V4L2FrameEncoder::openDevice()
+{
+    for ( uint32_t i = 0; i <= MAX_DEVICE_INDEX; i++ )
+    {
+        auto path = "/dev/video" + std::to_string( i );
+        int fd = open( path.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC );
+        if ( fd < 0 )
+        {
+            continue;
+        }
+        struct v4l2_capability capability = {};
+        if ( xioctl( fd, VIDIOC_QUERYCAP, &capability ) == 0 )
+        {
+            auto caps = ( ( capability.capabilities & V4L2_CAP_DEVICE_CAPS ) != 0U ) ? capability.device_caps
+                                                                                   : capability.capabilities;
+            if ( ( caps & ( V4L2_CAP_VIDEO_M2M | V4L2_CAP_VIDEO_M2M_MPLANE ) ) != 0U )
+            {
+                mMultiPlanar = ( caps & V4L2_CAP_VIDEO_M2M_MPLANE ) != 0U;
+                struct v4l2_fmtdesc formatDescription = {};
+                formatDescription.type = getCaptureType();
+                while ( xioctl( fd, VIDIOC_ENUM_FMT, &formatDescription ) == 0 )
+                {
+                    if ( formatDescription.pixelformat == V4L2_PIX_FMT_JPEG )
+                    {
+                        mFd = fd;
+                        mLogger.info( "V4L2FrameEncoder::openDevice", " Using the JPEG encoder " + path );
+                        return true;
+                    }
+                    formatDescription.index++;
+                }
+            }
+        }
+        close( fd );
+    }
+    return false;
+}
+
+bool
+V4L2FrameEncoder::configure( uint32_t pixelFormat, uint32_t rowSize, uint32_t width, uint32_t height, uint32_t quality )
+{
+    if ( mConfigured && ( pixelFormat == mPixelFormat ) && ( width == mWidth ) && ( height == mHeight ) &&
+         ( quality == mQuality ) )
+    {
+        return true;
+    }
+    releaseBuffers();
+    for ( auto type : { getOutputType(), getCaptureType() } )
+    {
+        auto format = ( type == getOutputType() ) ? pixelFormat : V4L2_PIX_FMT_JPEG;
+        struct v4l2_format videoFormat = {};
+        videoFormat.type = type;
+        if ( mMultiPlanar )
+        {
+            videoFormat.fmt.pix_mp.width = width;
+            videoFormat.fmt.pix_mp.height = height;
+            videoFormat.fmt.pix_mp.pixelformat = format;
+            videoFormat.fmt.pix_mp.field = V4L2_FIELD_NONE;
+            videoFormat.fmt.pix_mp.num_planes = 1;
+        }
+        else
+        {
+            videoFormat.fmt.pix.width = width;
+            videoFormat.fmt.pix.height = height;
+            videoFormat.fmt.pix.pixelformat = format;
+            videoFormat.fmt.pix.field = V4L2_FIELD_NONE;
+        }
+        // The driver replaces formats it does not support
+        if ( ( xioctl( mFd, VIDIOC_S_FMT, &videoFormat ) != 0 ) ||
+             ( ( mMultiPlanar ? videoFormat.fmt.pix_mp.pixelformat : videoFormat.fmt.pix.pixelformat ) != format ) )
+        {
+            mLogger.warn( "V4L2FrameEncoder::configure", " The encoder does not support the format of the frames " );
+            return false;
+        }
+        // The frames are copied as they are, so the rows must not be padded
+        auto bytesPerLine =
+            mMultiPlanar ? videoFormat.fmt.pix_mp.plane_fmt[0].bytesperline : videoFormat.fmt.pix.bytesperline;
+        if ( ( type == getOutputType() ) && ( bytesPerLine != 0U ) && ( bytesPerLine != rowSize ) )
+        {
+            mLogger.warn( "V4L2FrameEncoder::configure", " The encoder requires padded rows, which is not supported " );
+            return false;
+        }
+    }
+    struct v4l2_control control = {};
+    control.id = V4L2_CID_JPEG_COMPRESSION_QUALITY;
+    control.value = static_cast<int32_t>( quality );
+    if ( xioctl( mFd, VIDIOC_S_CTRL, &control ) != 0 )
+    {
+        mLogger.trace( "V4L2FrameEncoder::configure", " The encoder does not support setting the quality " );
+    }
+    if ( ( !mapBuffer( getOutputType(), mOutputBuffer ) ) || ( !mapBuffer( getCaptureType(), mCaptureBuffer ) ) )
+    {
+        releaseBuffers();
+        return false;
+    }
+    for ( auto type : { getOutputType(), getCaptureType() } )
+    {
+        int streamType = static_cast<int>( type );
+        if ( xioctl( mFd, VIDIOC_STREAMON, &streamType ) != 0 )
+        {
+            releaseBuffers();
+            return false;
+        }
+    }
+    mPixelFormat = pixelFormat;
+    mWidth = width;
+    mHeight = height;
+    mQuality = quality;
+    mConfigured = true;
+    return true;
+}
+
+bool
+V4L2FrameEncoder::mapBuffer( uint32_t type, MappedBuffer &buffer )
+{
+    struct v4l2_requestbuffers request = {};
+    request.count = 1;
+    request.type = type;
+    request.memory = V4L2_MEMORY_MMAP;
+    if ( ( xioctl( mFd, VIDIOC_REQBUFS, &request ) != 0 ) || ( request.count < 1U ) )
+    {
+        return false;
+    }
+    struct v4l2_buffer videoBuffer = {};
+    struct v4l2_plane planes[VIDEO_MAX_PLANES] = {};
+    videoBuffer.type = type;
+    videoBuffer.memory = V4L2_MEMORY_MMAP;
+    videoBuffer.index = 0;
+    if ( mMultiPlanar )
+    {
+        videoBuffer.m.planes = planes;
+        videoBuffer.length = 1;
+    }
+    if ( xioctl( mFd, VIDIOC_QUERYBUF, &videoBuffer ) != 0 )
+    {
+        return false;
+    }
+    auto length = mMultiPlanar ? planes[0].length : videoBuffer.length;
+    auto offset = mMultiPlanar ? planes[0].m.mem_offset : videoBuffer.m.offset;
+    auto *address = mmap( nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, mFd, static_cast<off_t>( offset ) );
+    if ( address == MAP_FAILED )
+    {
+        return false;
+    }
+    buffer.address = address;
+    buffer.length = length;
+    return true;
+}
+
+bool
+V4L2FrameEncoder::queueBuffer( uint32_t type, size_t bytesUsed )
+{
+    struct v4l2_buffer videoBuffer = {};
+    struct v4l2_plane planes[VIDEO_MAX_PLANES] = {};
+    videoBuffer.type = type;
+    videoBuffer.memory = V4L2_MEMORY_MMAP;
+    videoBuffer.index = 0;
+    if ( mMultiPlanar )
+    {
+        planes[0].bytesused = static_cast<uint32_t>( bytesUsed );
+        videoBuffer.m.planes = planes;
+        videoBuffer.length = 1;
+    }
+    else
+    {
+        videoBuffer.bytesused = static_cast<uint32_t>( bytesUsed );
+    }
+    return xioctl( mFd, VIDIOC_QBUF, &videoBuffer ) == 0;
+}
+
+bool
+V4L2FrameEncoder::dequeueBuffer( uint32_t type, short pollEvents, size_t &bytesUsed )
+{
+    struct pollfd pollDescriptor = {};
+    pollDescriptor.fd = mFd;
+    pollDescriptor.events = pollEvents;
+    while ( true )
+    {
+        struct v4l2_buffer videoBuffer = {};
+        struct v4l2_plane planes[VIDEO_MAX_PLANES] = {};
+        videoBuffer.type = type;
+        videoBuffer.memory = V4L2_MEMORY_MMAP;
+        if ( mMultiPlanar )
+        {
+            videoBuffer.m.planes = planes;
+            videoBuffer.length = 1;
+        }
+        if ( xioctl( mFd, VIDIOC_DQBUF, &videoBuffer ) == 0 )
+        {
+            bytesUsed = mMultiPlanar ? planes[0].bytesused : videoBuffer.bytesused;
+            return ( videoBuffer.flags & V4L2_BUF_FLAG_ERROR ) == 0U;
+        }
+        if ( errno != EAGAIN )
+        {
+            return false;
+        }
+        int result = 0;
+        do
+        {
+            result = poll( &pollDescriptor, 1, ENCODE_TIMEOUT_MS );
+        } while ( ( result < 0 ) && ( errno == EINTR ) );
+        if ( result <= 0 )
+        {
+            errno = ( result == 0 ) ? ETIMEDOUT : errno;
+            return false;
+        }
+    }
+}
+
+void
+V4L2FrameEncoder::releaseBuffers()
+{
+    if ( mFd < 0 )
+    {
+        return;
+    }
+    for ( auto type : { getOutputType(), getCaptureType() } )
+    {
+        int streamType = static_cast<int>( type );
+        (void)xioctl( mFd, VIDIOC_STREAMOFF, &streamType );
+    }
+    for ( auto *buffer : { &mOutputBuffer, &mCaptureBuffer } )
+    {
+        if ( buffer->address != nullptr )
+        {
+            munmap( buffer->address, buffer->length );
+            *buffer = MappedBuffer();
+        }
+    }
+    for ( auto type : { getOutputType(), getCaptureType() } )
+    {
+        struct v4l2_requestbuffers request = {};
+        request.count = 0;
+        request.type = type;
+        request.memory = V4L2_MEMORY_MMAP;
+        (void)xioctl( mFd, VIDIOC_REQBUFS, &request );
+    }
+    mConfigured = false;
+}
+
+} // namespace VehicleNetwork
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -0,0 +1,95 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "dds/ArtifactWriter.h"
+#include <atomic>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <iterator>
+#include <mutex>
+#include <string>
+
+using namespace Aws::IoTFleetWise::VehicleNetwork;
+
+namespace
+{
+std::vector<uint8_t>
+readFile( const std::string &path )
+{
+    std::ifstream file( path, std::ios_base::binary );
+    return std::vector<uint8_t>( std::istreambuf_iterator<char>( file ), std::istreambuf_iterator<char>() );
+}
+} // namespace
+
+/**
+ * @brief Validates that the buffers are written one after the other and replace an existing file
+ */
+TEST( ArtifactWriterTest, WriteArtifact )
+{
+    const std::string path = "/tmp/ArtifactWriterTest.bin";
+    std::vector<std::vector<uint8_t>> oldBuffers{ std::vector<uint8_t>( 1000, 0xFF ) };
+    ASSERT_TRUE( ArtifactWriter::writeArtifact( path, oldBuffers ) );
+
+    std::vector<std::vector<uint8_t>> buffers{ { 1, 2, 3 }, {}, { 4 }, std::vector<uint8_t>( 100000, 5 ) };
+    ASSERT_TRUE( ArtifactWriter::writeArtifact( path, buffers ) );
+    std::vector<uint8_t> expected;
+    for ( const auto &buffer : buffers )
+    {
+        expected.insert( expected.end(), buffer.begin(), buffer.end() );
+    }
+    ASSERT_EQ( readFile( path ), expected );
+    (void)remove( path.c_str() );
+
+    ASSERT_FALSE( ArtifactWriter::writeArtifact( "/tmp/ArtifactWriterTestMissingDirectory/test.bin", buffers ) );
+}
+
+/**
+ * @brief Validates that all submitted artifacts are written and completed, also the ones still queued on stop
+ */
+TEST( ArtifactWriterTest, SubmitAndComplete )
+{
+    ArtifactWriter writer( 2, 2 );
+    ASSERT_FALSE( writer.submit( "/tmp/ArtifactWriterTestStopped.bin", {}, nullptr ) );
+    ASSERT_TRUE( writer.start() );
+    ASSERT_TRUE( writer.isAlive() );
+
+    std::mutex mutex;
+    std::vector<std::string> completedPaths;
+    std::atomic<int> failures{ 0 };
+    auto onComplete = [&]( const std::string &path, bool success ) {
+        std::lock_guard<std::mutex> lock( mutex );
+        completedPaths.push_back( path );
+        if ( !success )
+        {
+            failures++;
+        }
+    };
+    const int artifactCount = 10;
+    for ( int i = 0; i < artifactCount; i++ )
+    {
+        std::vector<std::vector<uint8_t>> buffers{ std::vector<uint8_t>( 1000, static_cast<uint8_t>( i ) ) };
+        ASSERT_TRUE(
+            writer.submit( "/tmp/ArtifactWriterTest" + std::to_string( i ) + ".bin", std::move( buffers ), onComplete ) );
+    }
+    ASSERT_TRUE( writer.stop() );
+    ASSERT_FALSE( writer.isAlive() );
+
+    ASSERT_EQ( completedPaths.size(), artifactCount );
+    ASSERT_EQ( failures, 0 );
+    for ( int i = 0; i < artifactCount; i++ )
+    {
+        auto path = "/tmp/ArtifactWriterTest" + std::to_string( i ) + ".bin";
+        ASSERT_EQ( readFile( path ), std::vector<uint8_t>( 1000, static_cast<uint8_t>( i ) ) );
+        (void)remove( path.c_str() );
+    }
+}
@@ -0,0 +1,75 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "businterfaces/CANBusStatistics.h"
+#include "TraceModule.h"
+#include <gtest/gtest.h>
+
+using namespace Aws::IoTFleetWise::VehicleNetwork;
+
+TEST( CANBusStatisticsTest, estimateFrameBitsFromDlc )
+{
+    ASSERT_EQ( CANBusStatistics::estimateFrameBits( 0x123, 8 ), 111 );
+    ASSERT_EQ( CANBusStatistics::estimateFrameBits( 0x123, 0 ), 47 );
+    ASSERT_EQ( CANBusStatistics::estimateFrameBits( 0x18FEF100 | CAN_EFF_FLAG, 8 ), 131 );
+}
+
+TEST( CANBusStatisticsTest, busLoadAndTopFrameRates )
+{
+    CANBusStatistics statistics( "vcanStat", 100000, 2 );
+    ASSERT_FALSE( statistics.publishIfDue( 1000 ) );
+    // 100 frames of 111 bits in 1 second on a 100 kbit/s bus
+    for ( int i = 0; i < 50; i++ )
+    {
+        statistics.onFrame( 0x100, 8 );
+    }
+    for ( int i = 0; i < 30; i++ )
+    {
+        statistics.onFrame( 0x200, 8 );
+    }
+    for ( int i = 0; i < 20; i++ )
+    {
+        statistics.onFrame( 0x300, 8 );
+    }
+    statistics.onBurst( 60 );
+    statistics.onBurst( 40 );
+    statistics.onKernelDrops( 3 );
+    ASSERT_FALSE( statistics.publishIfDue( 1999 ) );
+    ASSERT_TRUE( statistics.publishIfDue( 2000 ) );
+
+    ASSERT_DOUBLE_EQ( statistics.getBusLoadPercent(), 11.1 );
+    ASSERT_EQ( statistics.getTopFrameRates().size(), 2 );
+    ASSERT_EQ( statistics.getTopFrameRates()[0].first, 0x100 );
+    ASSERT_DOUBLE_EQ( statistics.getTopFrameRates()[0].second, 50.0 );
+    ASSERT_EQ( statistics.getTopFrameRates()[1].first, 0x200 );
+
+    auto &traceModule = TraceModule::get();
+    ASSERT_EQ( traceModule.getNamedVariable( "canBusLoadPercent_vcanStat" ), 11 );
+    ASSERT_EQ( traceModule.getNamedVariable( "canFramesPerSecond_vcanStat" ), 100 );
+    ASSERT_EQ( traceModule.getNamedVariable( "canFrameIdPerSecond_vcanStat_0x100" ), 50 );
+    ASSERT_EQ( traceModule.getNamedVariable( "canFrameIdPerSecond_vcanStat_0x300" ), 0 );
+    ASSERT_EQ( traceModule.getNamedVariable( "canMaxBurst_vcanStat" ), 60 );
+    ASSERT_EQ( traceModule.getNamedVariable( "canKernelDrops_vcanStat" ), 3 );
+
+    // Next window only the third ID is active, the IDs that left the top are not reported anymore
+    for ( int i = 0; i < 10; i++ )
+    {
+        statistics.onFrame( 0x300, 8 );
+    }
+    statistics.publish( 3000 );
+    ASSERT_EQ( statistics.getTopFrameRates().size(), 1 );
+    ASSERT_EQ( statistics.getTopFrameRates()[0].first, 0x300 );
+    ASSERT_EQ( traceModule.getNamedVariable( "canFrameIdPerSecond_vcanStat_0x100" ), 0 );
+    ASSERT_EQ( traceModule.getNamedVariable( "canFrameIdPerSecond_vcanStat_0x300" ), 10 );
+    ASSERT_EQ( traceModule.getNamedVariable( "canMaxBurst_vcanStat" ), 0 );
+}
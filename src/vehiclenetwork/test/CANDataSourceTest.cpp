@@ -13,6 +13,8 @@
  */
 
 #include "businterfaces/CANDataSource.h"
+#include "businterfaces/CANDataSourceEventLoop.h"
+#include <atomic>
 #include <functional>
 #include <gtest/gtest.h>
 #include <linux/can.h>
@@ -269,6 +271,48 @@ TEST_F( CANDataSourceTest, testNetworkDataAquisitionStateChange )
     ASSERT_TRUE( listener.gotDisConnectCallback );
 }
 
+TEST_F( CANDataSourceTest, testSharedEventLoopAcquiresFromNetwork )
+{
+    ASSERT_TRUE( socketFD != -1 );
+    VehicleDataSourceConfig sourceConfig;
+    sourceConfig.transportProperties.emplace( "interfaceName", "vcan0" );
+    sourceConfig.transportProperties.emplace( "threadIdleTimeMs", "1000" );
+    sourceConfig.maxNumberOfVehicleDataMessages = 1000;
+    std::vector<VehicleDataSourceConfig> sourceConfigs = { sourceConfig };
+    auto eventLoop = std::make_shared<CANDataSourceEventLoop>();
+    ASSERT_TRUE( eventLoop->start() );
+    // Two sources on the same interface serviced by one thread
+    CANDataSource activeSource;
+    CANDataSource suspendedSource;
+    ASSERT_TRUE( activeSource.init( sourceConfigs ) );
+    ASSERT_TRUE( suspendedSource.init( sourceConfigs ) );
+    activeSource.setEventLoop( eventLoop );
+    suspendedSource.setEventLoop( eventLoop );
+    ASSERT_TRUE( activeSource.connect() );
+    ASSERT_TRUE( suspendedSource.connect() );
+    ASSERT_TRUE( activeSource.isAlive() );
+    ASSERT_TRUE( suspendedSource.isAlive() );
+    activeSource.resumeDataAcquisition();
+    sendTestMessage( socketFD );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 500 ) );
+    VehicleDataMessage msg;
+    ASSERT_TRUE( activeSource.getBuffer()->pop( msg ) );
+    ASSERT_EQ( msg.getMessageID(), 0x123 );
+    // A suspended source is not polled
+    ASSERT_FALSE( suspendedSource.getBuffer()->pop( msg ) );
+    // Frames received while suspended are dropped after resume
+    suspendedSource.resumeDataAcquisition();
+    std::this_thread::sleep_for( std::chrono::milliseconds( 500 ) );
+    ASSERT_FALSE( suspendedSource.getBuffer()->pop( msg ) );
+    sendTestMessage( socketFD );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 500 ) );
+    ASSERT_TRUE( suspendedSource.getBuffer()->pop( msg ) );
+    ASSERT_TRUE( activeSource.disconnect() );
+    ASSERT_TRUE( suspendedSource.disconnect() );
+    ASSERT_TRUE( eventLoop->stop() );
+    ASSERT_FALSE( activeSource.isAlive() );
+}
+
 TEST_F( CANDataSourceTest, testSourceIdsAreUnique )
 {
     ASSERT_TRUE( socketFD != -1 );
@@ -283,3 +327,221 @@ TEST_F( CANDataSourceTest, testSourceIdsAreUnique )
     }
     ASSERT_EQ( NUM_SOURCES, sourceIDs.size() );
 }
+
+TEST_F( CANDataSourceTest, testKernelFilterOnlyPassesDictionaryFrames )
+{
+    ASSERT_TRUE( socketFD != -1 );
+
+    VehicleDataSourceConfig sourceConfig;
+    sourceConfig.transportProperties.emplace( "interfaceName", "vcan0" );
+    sourceConfig.transportProperties.emplace( "threadIdleTimeMs", "100" );
+    sourceConfig.maxNumberOfVehicleDataMessages = 1000;
+    std::vector<VehicleDataSourceConfig> sourceConfigs = { sourceConfig };
+    CANDataSource dataSource;
+    ASSERT_TRUE( dataSource.init( sourceConfigs ) );
+    // Filter set before the connect is applied on connect
+    ASSERT_TRUE( dataSource.setMessageFilter( { 0x100 } ) );
+    ASSERT_TRUE( dataSource.connect() );
+    dataSource.resumeDataAcquisition();
+    std::this_thread::sleep_for( std::chrono::milliseconds( 200 ) );
+    // 0x123 is filtered in the kernel
+    sendTestMessage( socketFD );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 500 ) );
+    VehicleDataMessage msg;
+    ASSERT_FALSE( dataSource.getBuffer()->pop( msg ) );
+
+    ASSERT_TRUE( dataSource.setMessageFilter( { 0x100, 0x123 } ) );
+    sendTestMessage( socketFD );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 500 ) );
+    ASSERT_TRUE( dataSource.getBuffer()->pop( msg ) );
+    ASSERT_EQ( msg.getMessageID(), 0x123 );
+    ASSERT_TRUE( dataSource.disconnect() );
+}
+
+TEST( CANDataSourceFilterTest, buildExactFilter )
+{
+    auto filter = CANDataSource::buildFrameFilter( { 0x123, 0x18FEF100 | CAN_EFF_FLAG }, 10 );
+    ASSERT_EQ( filter.size(), 2 );
+    ASSERT_EQ( filter[0].can_id, 0x123 );
+    ASSERT_EQ( filter[0].can_mask, CAN_EFF_FLAG | CAN_RTR_FLAG | CAN_SFF_MASK );
+    ASSERT_EQ( filter[1].can_id, 0x18FEF100 | CAN_EFF_FLAG );
+    ASSERT_EQ( filter[1].can_mask, CAN_EFF_FLAG | CAN_RTR_FLAG | CAN_EFF_MASK );
+    ASSERT_TRUE( CANDataSource::buildFrameFilter( {}, 10 ).empty() );
+}
+
+TEST( CANDataSourceFilterTest, buildMaskFilterWhenTooManyIds )
+{
+    std::vector<uint32_t> ids = { 0x100, 0x101, 0x103, 0x1FF00001 | CAN_EFF_FLAG, 0x1FF00002 | CAN_EFF_FLAG };
+    auto filter = CANDataSource::buildFrameFilter( ids, 2 );
+    ASSERT_EQ( filter.size(), 2 );
+    // Every requested ID must pass its format filter
+    for ( auto id : ids )
+    {
+        bool passes = false;
+        for ( const auto &entry : filter )
+        {
+            passes = passes || ( ( id & entry.can_mask ) == ( entry.can_id & entry.can_mask ) );
+        }
+        ASSERT_TRUE( passes );
+    }
+    // Standard filter: bits 0 and 1 differ, the rest must match
+    ASSERT_EQ( filter[0].can_id, 0x100 );
+    ASSERT_EQ( filter[0].can_mask, ( CAN_SFF_MASK & ~0x3U ) | CAN_EFF_FLAG | CAN_RTR_FLAG );
+    // Frames of a different format or an unrelated ID are still dropped
+    ASSERT_NE( 0x200U & filter[0].can_mask, filter[0].can_id & filter[0].can_mask );
+}
+
+TEST( CANDataSourceConfigTest, receiveTuningSettings )
+{
+    VehicleDataSourceConfig sourceConfig;
+    sourceConfig.transportProperties.emplace( "interfaceName", "vcan0" );
+    sourceConfig.transportProperties.emplace( "threadIdleTimeMs", "100" );
+    sourceConfig.maxNumberOfVehicleDataMessages = 1000;
+    {
+        auto config = sourceConfig;
+        config.transportProperties.emplace( "receiveBatchSize", "64" );
+        config.transportProperties.emplace( "busyPollUs", "50" );
+        config.transportProperties.emplace( "idleSpinCount", "100" );
+        CANDataSource dataSource;
+        ASSERT_TRUE( dataSource.init( { config } ) );
+    }
+    {
+        auto config = sourceConfig;
+        config.transportProperties.emplace( "receiveBatchSize", "0" );
+        CANDataSource dataSource;
+        ASSERT_FALSE( dataSource.init( { config } ) );
+    }
+    {
+        auto config = sourceConfig;
+        config.transportProperties.emplace( "receiveBatchSize", "2000" );
+        CANDataSource dataSource;
+        ASSERT_FALSE( dataSource.init( { config } ) );
+    }
+    {
+        auto config = sourceConfig;
+        config.transportProperties.emplace( "idleSpinCount", "abc" );
+        CANDataSource dataSource;
+        ASSERT_FALSE( dataSource.init( { config } ) );
+    }
+    {
+        auto config = sourceConfig;
+        config.transportProperties.emplace( "microsecondTimestamps", "true" );
+        CANDataSource dataSource;
+        ASSERT_TRUE( dataSource.init( { config } ) );
+    }
+    {
+        auto config = sourceConfig;
+        config.transportProperties.emplace( "microsecondTimestamps", "1" );
+        CANDataSource dataSource;
+        ASSERT_FALSE( dataSource.init( { config } ) );
+    }
+    {
+        auto config = sourceConfig;
+        config.transportProperties.emplace( "busStatistics", "true" );
+        config.transportProperties.emplace( "bitrate", "250000" );
+        config.transportProperties.emplace( "busStatisticsTopIds", "10" );
+        CANDataSource dataSource;
+        ASSERT_TRUE( dataSource.init( { config } ) );
+    }
+    {
+        auto config = sourceConfig;
+        config.transportProperties.emplace( "busStatistics", "true" );
+        config.transportProperties.emplace( "bitrate", "0" );
+        CANDataSource dataSource;
+        ASSERT_FALSE( dataSource.init( { config } ) );
+    }
+}
+
+TEST( CANDataSourceConfigTest, decoderThreadsCreateOneBufferEach )
+{
+    VehicleDataSourceConfig sourceConfig;
+    sourceConfig.transportProperties.emplace( "interfaceName", "vcan0" );
+    sourceConfig.transportProperties.emplace( "threadIdleTimeMs", "100" );
+    sourceConfig.maxNumberOfVehicleDataMessages = 1000;
+    {
+        CANDataSource dataSource;
+        ASSERT_TRUE( dataSource.init( { sourceConfig } ) );
+        ASSERT_EQ( dataSource.getBufferCount(), 1 );
+        ASSERT_NE( dataSource.getBuffer( 0 ), nullptr );
+        ASSERT_EQ( dataSource.getBuffer( 1 ), nullptr );
+    }
+    {
+        auto config = sourceConfig;
+        config.transportProperties.emplace( "decoderThreads", "4" );
+        CANDataSource dataSource;
+        ASSERT_TRUE( dataSource.init( { config } ) );
+        ASSERT_EQ( dataSource.getBufferCount(), 4 );
+        for ( size_t i = 0; i < 4; i++ )
+        {
+            ASSERT_NE( dataSource.getBuffer( i ), nullptr );
+            ASSERT_EQ( dataSource.getBuffer( i )->write_available(), 1000 );
+        }
+        ASSERT_EQ( dataSource.getBuffer( 4 ), nullptr );
+    }
+    {
+        auto config = sourceConfig;
+        config.transportProperties.emplace( "decoderThreads", "0" );
+        CANDataSource dataSource;
+        ASSERT_FALSE( dataSource.init( { config } ) );
+    }
+    {
+        auto config = sourceConfig;
+        config.transportProperties.emplace( "decoderThreads",
+                                            std::to_string( AbstractVehicleDataSource::MAX_BUFFER_COUNT + 1 ) );
+        CANDataSource dataSource;
+        ASSERT_FALSE( dataSource.init( { config } ) );
+    }
+}
+
+TEST( CANDataSourceEventLoopTest, lifecycle )
+{
+    CANDataSourceEventLoop eventLoop;
+    CANDataSource dataSource;
+    // Sources can only be registered once the loop is started
+    ASSERT_FALSE( eventLoop.addSource( &dataSource, 0 ) );
+    ASSERT_TRUE( eventLoop.start() );
+    ASSERT_TRUE( eventLoop.isAlive() );
+    ASSERT_FALSE( eventLoop.addSource( nullptr, 0 ) );
+    ASSERT_FALSE( eventLoop.addSource( &dataSource, -1 ) );
+    ASSERT_FALSE( eventLoop.removeSource( 1234 ) );
+    ASSERT_FALSE( eventLoop.enableSource( 1234, true ) );
+    ASSERT_TRUE( eventLoop.stop() );
+    ASSERT_FALSE( eventLoop.isAlive() );
+    // Can be started again
+    ASSERT_TRUE( eventLoop.start() );
+    ASSERT_TRUE( eventLoop.stop() );
+}
+
+TEST( CANDataSourceEventLoopTest, cycleHandler )
+{
+    CANDataSourceEventLoop eventLoop;
+    ASSERT_TRUE( eventLoop.start() );
+    std::atomic<uint32_t> cycles( 0 );
+    uint32_t timeoutMs = 10;
+    eventLoop.setCycleHandler( [&cycles, &timeoutMs]() {
+        cycles++;
+        return timeoutMs;
+    } );
+    // Called again after the returned timeout
+    std::this_thread::sleep_for( std::chrono::milliseconds( 200 ) );
+    ASSERT_GE( cycles.load(), 5 );
+    // Waits for a wake up only
+    eventLoop.setCycleHandler( [&cycles]() {
+        cycles++;
+        return static_cast<uint32_t>( 100000 );
+    } );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 100 ) );
+    auto cyclesBeforeWakeup = cycles.load();
+    std::this_thread::sleep_for( std::chrono::milliseconds( 100 ) );
+    ASSERT_EQ( cycles.load(), cyclesBeforeWakeup );
+    eventLoop.wakeup();
+    std::this_thread::sleep_for( std::chrono::milliseconds( 100 ) );
+    ASSERT_EQ( cycles.load(), cyclesBeforeWakeup + 1 );
+    // Not called after it was removed
+    eventLoop.setCycleHandler( nullptr );
+    auto cyclesAfterRemoval = cycles.load();
+    eventLoop.wakeup();
+    std::this_thread::sleep_for( std::chrono::milliseconds( 100 ) );
+    ASSERT_EQ( cycles.load(), cyclesAfterRemoval );
+    ASSERT_TRUE( eventLoop.stop() );
+}
@@ -0,0 +1,173 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "businterfaces/CANLogReplayDataSource.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <linux/can.h>
+#include <thread>
+
+using namespace Aws::IoTFleetWise::VehicleNetwork;
+
+static std::string
+writeLogFile( const std::string &extension, const std::string &content )
+{
+    std::string filename = "/tmp/CANLogReplayDataSourceTest" + extension;
+    std::ofstream file( filename, std::ios::binary | std::ios::trunc );
+    file << content;
+    return filename;
+}
+
+static std::vector<VehicleDataSourceConfig>
+createConfig( const std::string &logFile, const std::map<std::string, std::string> &properties = {} )
+{
+    std::vector<VehicleDataSourceConfig> configs( 1 );
+    configs[0].transportProperties = properties;
+    configs[0].transportProperties.emplace( "logFile", logFile );
+    configs[0].maxNumberOfVehicleDataMessages = 1000;
+    return configs;
+}
+
+static std::vector<VehicleDataMessage>
+replayAll( CANLogReplayDataSource &source, size_t expectedFrames )
+{
+    std::vector<VehicleDataMessage> messages;
+    source.resumeDataAcquisition();
+    for ( int i = 0; ( i < 1000 ) && ( messages.size() < expectedFrames ); i++ )
+    {
+        VehicleDataMessage message;
+        while ( source.getBuffer()->pop( message ) )
+        {
+            messages.emplace_back( message );
+        }
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+    return messages;
+}
+
+TEST( CANLogReplayDataSourceTest, ReplayCandumpLog )
+{
+    auto logFile = writeLogFile( ".log",
+                                 "(1436509052.249713) vcan0 044#2A366C2BBA\n"
+                                 "(1436509052.250000) vcan1 123#0102\n"
+                                 "(1436509052.251500) vcan0 12345678#DEADBEEF\n"
+                                 "(1436509052.252000) vcan0 7FF#R\n"
+                                 "(1436509052.253000) vcan0 456##1000102030405060708090A0B\r\n"
+                                 "garbage\n"
+                                 "(1436509052.254000) vcan0 001#" );
+    CANLogReplayDataSource source;
+    ASSERT_TRUE( source.init( createConfig(
+        logFile, { { "channel", "vcan0" }, { "replayMode", "asFastAsPossible" }, { "preserveTimestamps", "true" } } ) ) );
+    ASSERT_TRUE( source.connect() );
+    ASSERT_TRUE( source.isAlive() );
+
+    auto messages = replayAll( source, 3 );
+    ASSERT_EQ( messages.size(), 3 );
+    EXPECT_EQ( messages[0].getMessageID(), 0x44 );
+    ASSERT_EQ( messages[0].getRawDataSize(), 5 );
+    EXPECT_EQ( messages[0].getRawData()[0], 0x2A );
+    EXPECT_EQ( messages[0].getRawData()[4], 0xBA );
+    EXPECT_EQ( messages[0].getReceptionTimestamp(), 1436509052249 );
+    EXPECT_EQ( messages[0].getReceptionTimestampFractionUs(), 713 );
+    EXPECT_EQ( messages[1].getMessageID(), 0x12345678U | CAN_EFF_FLAG );
+    EXPECT_EQ( messages[1].getRawDataSize(), 4 );
+    EXPECT_EQ( messages[2].getMessageID(), 0x456 );
+    ASSERT_EQ( messages[2].getRawDataSize(), 12 );
+    EXPECT_EQ( messages[2].getRawData()[11], 0x0B );
+    // The frame without data at the end of the file without a line break is invalid
+    for ( int i = 0; ( i < 1000 ) && !source.isReplayFinished(); i++ )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+    EXPECT_TRUE( source.isReplayFinished() );
+    EXPECT_EQ( source.getReplayedFrames(), 3 );
+    ASSERT_TRUE( source.disconnect() );
+    std::remove( logFile.c_str() );
+}
+
+TEST( CANLogReplayDataSourceTest, ReplayAscLog )
+{
+    auto logFile = writeLogFile( ".asc",
+                                 "date Wed Jun 1 10:00:00.000 am 2022\n"
+                                 "base hex  timestamps relative\n"
+                                 "Begin Triggerblock Wed Jun 1 10:00:00.000 am 2022\n"
+                                 "   0.010000 1  123             Rx   d 2 01 02  Length = 0 BitCount = 0 ID = 291\n"
+                                 "   0.005000 2  124             Rx   d 1 FF\n"
+                                 "   0.005000 1  1ABCDEFx        Tx   d 1 AA\n"
+                                 "   0.005000 1  ErrorFrame\n"
+                                 "   0.005000 CANFD   1 Rx        456  Speed   1 0 9 12 "
+                                 "00 01 02 03 04 05 06 07 08 09 0A 0B\n"
+                                 "End TriggerBlock\n" );
+    CANLogReplayDataSource source;
+    ASSERT_TRUE( source.init(
+        createConfig( logFile, { { "channel", "1" }, { "replayMode", "scaled" }, { "replaySpeed", "10" } } ) ) );
+    ASSERT_TRUE( source.connect() );
+
+    auto messages = replayAll( source, 3 );
+    ASSERT_EQ( messages.size(), 3 );
+    EXPECT_EQ( messages[0].getMessageID(), 0x123 );
+    ASSERT_EQ( messages[0].getRawDataSize(), 2 );
+    EXPECT_EQ( messages[0].getRawData()[1], 0x02 );
+    EXPECT_EQ( messages[1].getMessageID(), 0x1ABCDEFU | CAN_EFF_FLAG );
+    EXPECT_EQ( messages[2].getMessageID(), 0x456 );
+    ASSERT_EQ( messages[2].getRawDataSize(), 12 );
+    EXPECT_EQ( messages[2].getRawData()[10], 0x0A );
+    // Rewritten timestamps are the replay time
+    EXPECT_LE( messages[0].getReceptionTimestamp(), messages[2].getReceptionTimestamp() );
+    ASSERT_TRUE( source.disconnect() );
+    std::remove( logFile.c_str() );
+}
+
+TEST( CANLogReplayDataSourceTest, NoReplayBeforeResume )
+{
+    auto logFile = writeLogFile( ".log", "(1.000000) vcan0 044#2A\n" );
+    CANLogReplayDataSource source;
+    ASSERT_TRUE( source.init( createConfig( logFile, { { "replayMode", "asFastAsPossible" } } ) ) );
+    ASSERT_TRUE( source.connect() );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+    EXPECT_EQ( source.getBuffer()->read_available(), 0 );
+    EXPECT_EQ( replayAll( source, 1 ).size(), 1 );
+    ASSERT_TRUE( source.disconnect() );
+    std::remove( logFile.c_str() );
+}
+
+TEST( CANLogReplayDataSourceTest, LoopReplay )
+{
+    auto logFile = writeLogFile( ".log", "(1.000000) vcan0 044#2A\n(1.000100) vcan0 045#2B\n" );
+    CANLogReplayDataSource source;
+    ASSERT_TRUE( source.init( createConfig( logFile, { { "replayMode", "asFastAsPossible" }, { "loop", "true" } } ) ) );
+    ASSERT_TRUE( source.connect() );
+    auto messages = replayAll( source, 10 );
+    ASSERT_GE( messages.size(), 10 );
+    EXPECT_EQ( messages[2].getMessageID(), 0x44 );
+    EXPECT_FALSE( source.isReplayFinished() );
+    ASSERT_TRUE( source.disconnect() );
+    std::remove( logFile.c_str() );
+}
+
+TEST( CANLogReplayDataSourceTest, InvalidConfig )
+{
+    CANLogReplayDataSource source;
+    ASSERT_FALSE( source.init( {} ) );
+    std::vector<VehicleDataSourceConfig> noLogFile( 1 );
+    ASSERT_FALSE( source.init( noLogFile ) );
+    ASSERT_FALSE( source.init( createConfig( "trace.blf", { { "logFormat", "blf" } } ) ) );
+    ASSERT_FALSE( source.init( createConfig( "trace.log", { { "replayMode", "slow" } } ) ) );
+    ASSERT_FALSE( source.init( createConfig( "trace.log", { { "replayMode", "scaled" }, { "replaySpeed", "0" } } ) ) );
+    ASSERT_FALSE( source.init( createConfig( "trace.log", { { "replaySpeed", "fast" } } ) ) );
+    ASSERT_FALSE( source.init( createConfig( "trace.log", { { "loop", "yes" } } ) ) );
+    ASSERT_TRUE( source.init( createConfig( "/nonexistent/trace.log" ) ) );
+    ASSERT_FALSE( source.connect() );
+}
@@ -0,0 +1,181 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "dds/FrameProcessor.h"
+#include <gtest/gtest.h>
+
+using namespace Aws::IoTFleetWise::VehicleNetwork;
+
+namespace
+{
+std::vector<uint8_t>
+createFrame( size_t size, uint8_t value )
+{
+    return std::vector<uint8_t>( size, value );
+}
+
+// H.264 access unit with SPS, PPS and a slice of the given NAL type
+std::vector<uint8_t>
+createH264Frame( uint8_t sliceNalType )
+{
+    return {
+        0, 0, 0, 1, 0x67, 0x42, 0, 0, 0, 1, 0x68, 0xCE, 0, 0, 1, static_cast<uint8_t>( 0x60 | sliceNalType ), 0x88 };
+}
+
+// Encodes a frame to a JPEG marker and its first byte, so the test can check which frames were encoded
+class MockFrameEncoder : public IFrameEncoder
+{
+public:
+    bool
+    encode( const std::vector<uint8_t> &frame,
+            uint32_t imageType,
+            uint32_t width,
+            uint32_t height,
+            ImageEncoding encoding,
+            uint32_t quality,
+            std::vector<uint8_t> &encoded ) override
+    {
+        mCalls++;
+        mQuality = quality;
+        if ( ( mFailAtCall == mCalls ) || ( imageType != IMAGE_TYPE_RAW_MONO8 ) ||
+             ( encoding != ImageEncoding::JPEG ) || ( frame.size() != static_cast<size_t>( width ) * height ) )
+        {
+            return false;
+        }
+        encoded = { 0xFF, 0xD8, frame[0] };
+        return true;
+    }
+
+    int mCalls{ 0 };
+    int mFailAtCall{ 0 };
+    uint32_t mQuality{ 0 };
+};
+
+std::vector<std::vector<uint8_t>>
+createFrames( size_t count )
+{
+    std::vector<std::vector<uint8_t>> frames;
+    for ( size_t i = 0; i < count; i++ )
+    {
+        frames.emplace_back( createFrame( 16, static_cast<uint8_t>( i * 20 ) ) );
+    }
+    return frames;
+}
+} // namespace
+
+TEST( FrameProcessorTest, DefaultOptionsKeepAllFrames )
+{
+    FrameProcessor processor( nullptr, 0, 0 );
+    auto frames = createFrames( 5 );
+    processor.process( frames, ImageCaptureOptions(), IMAGE_TYPE_COMPRESSED_JPG );
+    ASSERT_EQ( frames, createFrames( 5 ) );
+}
+
+TEST( FrameProcessorTest, KeepEveryNthFrame )
+{
+    FrameProcessor processor( nullptr, 0, 0 );
+    auto frames = createFrames( 7 );
+    ImageCaptureOptions options;
+    options.keepEveryNthFrame = 3;
+    processor.process( frames, options, IMAGE_TYPE_COMPRESSED_JPG );
+    ASSERT_EQ( frames.size(), 3 );
+    ASSERT_EQ( frames[0][0], 0 );
+    ASSERT_EQ( frames[1][0], 60 );
+    ASSERT_EQ( frames[2][0], 120 );
+}
+
+TEST( FrameProcessorTest, KeyFrames )
+{
+    ASSERT_TRUE( FrameProcessor::isKeyFrame( createH264Frame( 5 ) ) );
+    ASSERT_FALSE( FrameProcessor::isKeyFrame( createH264Frame( 1 ) ) );
+    // Parameter sets without a slice
+    ASSERT_FALSE( FrameProcessor::isKeyFrame( { 0, 0, 1, 0x67, 0x42 } ) );
+    // Still images and raw frames are always key frames
+    ASSERT_TRUE( FrameProcessor::isKeyFrame( { 0xFF, 0xD8, 0xFF, 0xE0 } ) );
+    ASSERT_TRUE( FrameProcessor::isKeyFrame( createFrame( 16, 0 ) ) );
+
+    FrameProcessor processor( nullptr, 0, 0 );
+    std::vector<std::vector<uint8_t>> frames = {
+        createH264Frame( 5 ), createH264Frame( 1 ), createH264Frame( 1 ), createH264Frame( 5 ), createH264Frame( 1 ) };
+    ImageCaptureOptions options;
+    options.keyFramesOnly = true;
+    processor.process( frames, options, IMAGE_TYPE_COMPRESSED_JPG );
+    ASSERT_EQ( frames.size(), 2 );
+    ASSERT_EQ( frames[1], createH264Frame( 5 ) );
+}
+
+TEST( FrameProcessorTest, SkipSimilarFrames )
+{
+    ASSERT_DOUBLE_EQ( FrameProcessor::getSimilarity( createFrame( 16, 10 ), createFrame( 16, 10 ) ), 1.0 );
+    ASSERT_DOUBLE_EQ( FrameProcessor::getSimilarity( createFrame( 16, 0 ), createFrame( 16, 255 ) ), 0.0 );
+    ASSERT_DOUBLE_EQ( FrameProcessor::getSimilarity( createFrame( 8, 10 ), createFrame( 16, 10 ) ), 0.5 );
+    ASSERT_DOUBLE_EQ( FrameProcessor::getSimilarity( {}, {} ), 1.0 );
+
+    FrameProcessor processor( nullptr, 0, 0 );
+    std::vector<std::vector<uint8_t>> frames = { createFrame( 16, 100 ),
+                                                 createFrame( 16, 101 ),
+                                                 createFrame( 16, 102 ),
+                                                 createFrame( 16, 200 ),
+                                                 createFrame( 16, 201 ) };
+    ImageCaptureOptions options;
+    options.similarityThreshold = 0.995;
+    processor.process( frames, options, IMAGE_TYPE_COMPRESSED_JPG );
+    // Compared to the last kept frame, so a slow drift is still noticed
+    ASSERT_EQ( frames.size(), 3 );
+    ASSERT_EQ( frames[0][0], 100 );
+    ASSERT_EQ( frames[1][0], 102 );
+    ASSERT_EQ( frames[2][0], 200 );
+}
+
+TEST( FrameProcessorTest, ReEncodeRawFrames )
+{
+    auto encoder = std::make_unique<MockFrameEncoder>();
+    auto *mockEncoder = encoder.get();
+    FrameProcessor processor( std::move( encoder ), 4, 4 );
+    auto frames = createFrames( 4 );
+    ImageCaptureOptions options;
+    options.keepEveryNthFrame = 2;
+    options.encoding = ImageEncoding::JPEG;
+    options.encodingQuality = 150;
+    processor.process( frames, options, IMAGE_TYPE_RAW_MONO8 );
+    // Only the kept frames are encoded
+    ASSERT_EQ( mockEncoder->mCalls, 2 );
+    ASSERT_EQ( mockEncoder->mQuality, 100 );
+    ASSERT_EQ( frames.size(), 2 );
+    ASSERT_EQ( frames[0], std::vector<uint8_t>( { 0xFF, 0xD8, 0 } ) );
+    ASSERT_EQ( frames[1], std::vector<uint8_t>( { 0xFF, 0xD8, 40 } ) );
+
+    // Compressed frames are not re-encoded
+    options.keepEveryNthFrame = 0;
+    frames = createFrames( 2 );
+    processor.process( frames, options, IMAGE_TYPE_COMPRESSED_PNG );
+    ASSERT_EQ( mockEncoder->mCalls, 2 );
+    ASSERT_EQ( frames, createFrames( 2 ) );
+}
+
+TEST( FrameProcessorTest, FailedEncodingKeepsAllFramesAsReceived )
+{
+    auto encoder = std::make_unique<MockFrameEncoder>();
+    encoder->mFailAtCall = 2;
+    FrameProcessor processor( std::move( encoder ), 4, 4 );
+    auto frames = createFrames( 3 );
+    ImageCaptureOptions options;
+    options.encoding = ImageEncoding::JPEG;
+    processor.process( frames, options, IMAGE_TYPE_RAW_MONO8 );
+    ASSERT_EQ( frames, createFrames( 3 ) );
+
+    // Without frame size nothing is encoded
+    FrameProcessor processorWithoutSize( std::make_unique<MockFrameEncoder>(), 0, 0 );
+    processorWithoutSize.process( frames, options, IMAGE_TYPE_RAW_MONO8 );
+    ASSERT_EQ( frames, createFrames( 3 ) );
+}
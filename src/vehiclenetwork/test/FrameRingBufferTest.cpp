@@ -0,0 +1,100 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "dds/FrameRingBuffer.h"
+#include <gtest/gtest.h>
+
+using namespace Aws::IoTFleetWise::VehicleNetwork;
+
+namespace
+{
+std::vector<uint8_t>
+createFrame( size_t size, uint8_t value )
+{
+    return std::vector<uint8_t>( size, value );
+}
+} // namespace
+
+/**
+ * @brief Validates that the history reaches back the retention time and is sliced by time
+ */
+TEST( FrameRingBufferTest, RetentionAndSlice )
+{
+    FrameRingBuffer buffer;
+    auto frame = createFrame( 10, 1 );
+    ASSERT_FALSE( buffer.append( 1000, frame.data(), frame.size() ) );
+    ASSERT_TRUE( buffer.init( "/tmp/FrameRingBufferTest.ring", 1000 ) );
+    // Nothing is stored without retention time
+    ASSERT_FALSE( buffer.append( 1000, frame.data(), frame.size() ) );
+    buffer.setRetentionMs( 300 );
+    ASSERT_EQ( buffer.getRetentionMs(), 300 );
+
+    for ( Timestamp time = 1000; time <= 2000; time += 100 )
+    {
+        frame = createFrame( 10, static_cast<uint8_t>( time / 100 ) );
+        ASSERT_TRUE( buffer.append( time, frame.data(), frame.size() ) );
+    }
+    // Frames that are not newer are rejected
+    ASSERT_FALSE( buffer.append( 2000, frame.data(), frame.size() ) );
+    ASSERT_EQ( buffer.getNewestTimestamp(), 2000 );
+    // 1700 is exactly the retention time old, so nothing older is needed
+    ASSERT_EQ( buffer.getFrameCount(), 4 );
+
+    std::vector<std::vector<uint8_t>> frames;
+    ASSERT_FALSE( buffer.slice( 1650, 2000, frames ) );
+    ASSERT_TRUE( frames.empty() );
+    ASSERT_TRUE( buffer.slice( 1700, 1900, frames ) );
+    ASSERT_EQ( frames.size(), 3 );
+    ASSERT_EQ( frames[0], createFrame( 10, 17 ) );
+    ASSERT_EQ( frames[2], createFrame( 10, 19 ) );
+
+    // The frame older than the retention time is kept until the next one is also too old
+    frame = createFrame( 10, 20 );
+    ASSERT_TRUE( buffer.append( 2050, frame.data(), frame.size() ) );
+    ASSERT_TRUE( buffer.slice( 1750, 2050, frames ) );
+    ASSERT_EQ( frames.size(), 4 );
+    ASSERT_EQ( frames[0], createFrame( 10, 18 ) );
+
+    buffer.setRetentionMs( 0 );
+    ASSERT_EQ( buffer.getFrameCount(), 0 );
+    ASSERT_FALSE( buffer.slice( 0, 3000, frames ) );
+}
+
+/**
+ * @brief Validates that the oldest frames are dropped when the ring file is full and that frames wrap around
+ */
+TEST( FrameRingBufferTest, WrapAround )
+{
+    FrameRingBuffer buffer;
+    ASSERT_TRUE( buffer.init( "/tmp/FrameRingBufferTest.ring", 100 ) );
+    buffer.setRetentionMs( 100000 );
+    auto bigFrame = createFrame( 101, 0 );
+    ASSERT_FALSE( buffer.append( 1, bigFrame.data(), bigFrame.size() ) );
+
+    for ( Timestamp time = 1; time <= 50; time++ )
+    {
+        auto frame = createFrame( 30 + ( time % 7 ), static_cast<uint8_t>( time ) );
+        ASSERT_TRUE( buffer.append( time, frame.data(), frame.size() ) );
+        std::vector<std::vector<uint8_t>> frames;
+        ASSERT_TRUE( buffer.slice( time + 1 - buffer.getFrameCount(), time, frames ) );
+        ASSERT_EQ( frames.size(), buffer.getFrameCount() );
+        // All stored frames are intact
+        for ( size_t i = 0; i < frames.size(); i++ )
+        {
+            auto frameTime = time + 1 - frames.size() + i;
+            ASSERT_EQ( frames[i], createFrame( 30 + ( frameTime % 7 ), static_cast<uint8_t>( frameTime ) ) );
+        }
+        ASSERT_GE( buffer.getFrameCount(), 1 );
+        ASSERT_LE( buffer.getFrameCount(), 3 );
+    }
+}
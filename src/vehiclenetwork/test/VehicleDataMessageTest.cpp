@@ -11,8 +11,11 @@
  * permissions and limitations under the License.
  */
 
+#include "datatypes/SyntheticVehicleDataMessage.h"
 #include "datatypes/VehicleDataMessage.h"
 #include <gtest/gtest.h>
+#include <type_traits>
+#include <vector>
 
 using namespace Aws::IoTFleetWise::VehicleNetwork;
 using namespace Aws::IoTFleetWise::Platform::Linux;
@@ -25,22 +28,128 @@ TEST( VehicleDataMessageTest, SetupTest )
 
     std::uint32_t id = 0xFFU;
     const std::vector<std::uint8_t> rawData = { 0U, 1U, 2U, 3U, 4U, 5U, 6U, 7U };
-    const std::vector<boost::any> syntheticData = { 0U, 1U, 2U, 3U, 4U, 5U, 6U, 7U };
     Timestamp timestamp = static_cast<Timestamp>( 12345678 );
-    message.setup( id, rawData, syntheticData, timestamp );
+    ASSERT_TRUE( message.setup( id, rawData.data(), rawData.size(), timestamp ) );
     ASSERT_EQ( message.getMessageID(), id );
     ASSERT_TRUE( message.isValid() );
     // Raw Data
+    ASSERT_EQ( message.getRawDataSize(), rawData.size() );
     for ( size_t i = 0; i < rawData.size(); i++ )
     {
-        ASSERT_EQ( rawData[i], ( message.getRawData() )[i] );
+        ASSERT_EQ( rawData[i], message.getRawData()[i] );
     }
+    // Timestamp
+    ASSERT_EQ( message.getReceptionTimestamp(), timestamp );
+    ASSERT_EQ( message.getReceptionTimestampFractionUs(), 0 );
+    ASSERT_TRUE( message.setup( id, rawData.data(), rawData.size(), timestamp, 345 ) );
+    ASSERT_EQ( message.getReceptionTimestamp(), timestamp );
+    ASSERT_EQ( message.getReceptionTimestampFractionUs(), 345 );
+    ASSERT_EQ( toMicroseconds( message.getReceptionTimestamp(), message.getReceptionTimestampFractionUs() ),
+               12345678345U );
+}
+
+TEST( VehicleDataMessageTest, CANFDPayload )
+{
+    VehicleDataMessage message;
+    std::vector<std::uint8_t> rawData( VehicleDataMessage::MAX_PAYLOAD_SIZE );
+    for ( size_t i = 0; i < rawData.size(); i++ )
+    {
+        rawData[i] = static_cast<std::uint8_t>( i );
+    }
+    ASSERT_TRUE( message.setup( 0x123, rawData.data(), rawData.size(), 1 ) );
+    ASSERT_EQ( message.getRawDataSize(), static_cast<size_t>( VehicleDataMessage::MAX_PAYLOAD_SIZE ) );
+    ASSERT_EQ( message.getRawData()[63], 63 );
+    // Copies of the message carry the payload without any heap ownership
+    VehicleDataMessage copy = message;
+    ASSERT_EQ( copy.getRawData()[10], 10 );
+    ASSERT_TRUE( std::is_trivially_copyable<VehicleDataMessage>::value );
+}
+
+TEST( VehicleDataMessageTest, InvalidPayload )
+{
+    VehicleDataMessage message;
+    std::vector<std::uint8_t> rawData( VehicleDataMessage::MAX_PAYLOAD_SIZE + 1 );
+    ASSERT_FALSE( message.setup( 0x123, rawData.data(), rawData.size(), 1 ) );
+    ASSERT_FALSE( message.isValid() );
+    ASSERT_FALSE( message.setup( 0x123, nullptr, 8, 1 ) );
+    ASSERT_FALSE( message.isValid() );
+    ASSERT_TRUE( message.setup( 0x123, nullptr, 0, 1 ) );
+    ASSERT_FALSE( message.isValid() );
+}
+
+TEST( SyntheticVehicleDataMessageTest, SetupTest )
+{
+    SyntheticVehicleDataMessage message;
 
+    std::uint32_t id = 0xFFU;
+    const std::vector<SyntheticValue> syntheticData = { 0U, 1U, 2U, 3U, 4U, 5U, 6U, 7U };
+    Timestamp timestamp = static_cast<Timestamp>( 12345678 );
+    ASSERT_TRUE( message.setup( id, syntheticData.data(), syntheticData.size(), timestamp ) );
+    ASSERT_EQ( message.getMessageID(), id );
+    ASSERT_TRUE( message.isValid() );
     // Synthetic Data
+    ASSERT_EQ( message.getSyntheticData().size(), syntheticData.size() );
     for ( size_t i = 0; i < syntheticData.size(); i++ )
     {
-        ASSERT_EQ( boost::any_cast<uint>( syntheticData[i] ), boost::any_cast<uint>( message.getSyntheticData()[i] ) );
+        uint32_t expected = 0;
+        uint32_t actual = 0;
+        ASSERT_TRUE( syntheticData[i].get( expected ) );
+        ASSERT_TRUE( message.getSyntheticData()[i].get( actual ) );
+        ASSERT_EQ( expected, actual );
     }
     // Timestamp
     ASSERT_EQ( message.getReceptionTimestamp(), timestamp );
+    // Values are stored inline
+    ASSERT_TRUE( std::is_trivially_copyable<SyntheticVehicleDataMessage>::value );
+}
+
+TEST( SyntheticVehicleDataMessageTest, TypedValues )
+{
+    const std::uint8_t bytes[] = { 1, 2, 3 };
+    SyntheticVehicleDataMessage message;
+    ASSERT_TRUE( message.setup( 1,
+                                { true,
+                                  static_cast<std::uint8_t>( 200 ),
+                                  static_cast<std::int16_t>( -300 ),
+                                  static_cast<std::int64_t>( -5000000000 ),
+                                  static_cast<std::uint64_t>( 5000000000 ),
+                                  1.5F,
+                                  -2.25,
+                                  SyntheticBytesView{ bytes, sizeof( bytes ) } },
+                                1 ) );
+    const auto &values = message.getSyntheticData();
+    ASSERT_EQ( values.size(), 8 );
+    EXPECT_EQ( values[0].getType(), SyntheticValueType::BOOL_TYPE );
+    EXPECT_EQ( values[1].getType(), SyntheticValueType::UINT8_TYPE );
+    EXPECT_EQ( values[2].getType(), SyntheticValueType::INT16_TYPE );
+    EXPECT_EQ( values[6].getType(), SyntheticValueType::DOUBLE_TYPE );
+    EXPECT_EQ( values[7].getType(), SyntheticValueType::BYTES_TYPE );
+    EXPECT_DOUBLE_EQ( values[0].toDouble(), 1.0 );
+    EXPECT_DOUBLE_EQ( values[1].toDouble(), 200.0 );
+    EXPECT_DOUBLE_EQ( values[2].toDouble(), -300.0 );
+    EXPECT_DOUBLE_EQ( values[3].toDouble(), -5000000000.0 );
+    EXPECT_DOUBLE_EQ( values[4].toDouble(), 5000000000.0 );
+    EXPECT_DOUBLE_EQ( values[5].toDouble(), 1.5 );
+    EXPECT_DOUBLE_EQ( values[6].toDouble(), -2.25 );
+    EXPECT_DOUBLE_EQ( values[7].toDouble(), 0.0 );
+
+    // Only the exact type can be read
+    std::int16_t int16Value = 0;
+    std::int32_t int32Value = 0;
+    ASSERT_TRUE( values[2].get( int16Value ) );
+    EXPECT_EQ( int16Value, -300 );
+    ASSERT_FALSE( values[2].get( int32Value ) );
+    EXPECT_EQ( int32Value, 0 );
+    float floatValue = 0.0F;
+    ASSERT_TRUE( values[5].get( floatValue ) );
+    EXPECT_FLOAT_EQ( floatValue, 1.5F );
+    SyntheticBytesView bytesView{ nullptr, 0 };
+    ASSERT_TRUE( values[7].get( bytesView ) );
+    EXPECT_EQ( bytesView.data, bytes );
+    EXPECT_EQ( bytesView.size, 3 );
+
+    // Too many values
+    std::vector<SyntheticValue> tooManyValues( SyntheticValueList::MAX_VALUES + 1, SyntheticValue( 1.0 ) );
+    ASSERT_FALSE( message.setup( 2, tooManyValues.data(), tooManyValues.size(), 1 ) );
+    ASSERT_FALSE( message.isValid() );
 }
@@ -0,0 +1,234 @@
+#!/usr/bin/python3
+# Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+# Licensed under the Amazon Software License (the "License").
+# You may not use this file except in compliance with the License.
+# A copy of the License is located at
+# http://aws.amazon.com/asl/
+# or in the "license" file accompanying this file. This file is distributed
+# on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+# express or implied. See the License for the specific language governing
+# permissions and limitations under the License.
+
+# This script decodes a VehicleData payload sent by the Edge Agent to JSON, with one entry per signal sample and
+# raw CAN frame for both payload format versions. With --candump the raw CAN frames are printed in the log file
+# format of candump instead, e.g. to replay a raw CAN log with canplayer.
+# To install the required dependencies, follow these instructions:
+# 1. Install the Python packages:
+#
+#        python3.7 -m pip install protobuf python-snappy
+#
+#    For payloads compressed with the LZ4 or ZSTD codec, also install `lz4` or `zstandard` respectively.
+#
+# 2. Generate the Python module of the payload schema into the directory of this script:
+#
+#        protoc --python_out=. -I ../../interfaces/protobuf/schemas/edgeToCloud vehicle_data.proto
+#
+
+import sys
+import json
+import vehicle_data_pb2
+
+PAYLOAD_FORMAT_SAMPLES = 0
+PAYLOAD_FORMAT_COLUMNS = 1
+
+# Header of the payloads compressed with the LZ4 or ZSTD codec: "FWC", codec ID, dictionary ID and uncompressed size
+COMPRESSED_HEADER_MAGIC = b"FWC"
+COMPRESSED_HEADER_SIZE = 12
+CODEC_LZ4 = 1
+CODEC_ZSTD = 2
+
+CAN_EFF_FLAG = 0x80000000
+CAN_MAX_DLEN = 8
+
+def read_varint(data, offset):
+    value = 0
+    shift = 0
+    while True:
+        byte = data[offset]
+        offset += 1
+        value |= (byte & 0x7F) << shift
+        if byte < 0x80:
+            return value, offset
+        shift += 7
+
+def decode_raw_can_log(raw_can_log, trigger_time):
+    can_frames = []
+    data = raw_can_log.frames
+    offset = 0
+    time_us = trigger_time * 1000
+    while offset < len(data):
+        delta, offset = read_varint(data, offset)
+        time_us += (delta >> 1) ^ -(delta & 1)
+        interface_index, offset = read_varint(data, offset)
+        message_id, offset = read_varint(data, offset)
+        size = data[offset]
+        offset += 1
+        can_frames.append({
+            "message_id": message_id,
+            "interface_id": raw_can_log.interface_ids[interface_index],
+            "time_ms_epoch": time_us // 1000,
+            "time_us_fraction": time_us % 1000,
+            "byte_values": list(data[offset:offset + size])})
+        offset += size
+    return can_frames
+
+def decode_times(column, trigger_time):
+    times = []
+    time = 0
+    for delta in column.relative_time_ms_deltas:
+        time += delta
+        times.append(trigger_time + time)
+    fractions = list(column.relative_time_us_fractions)
+    if len(fractions) == 0:
+        fractions = [0] * len(times)
+    return times, fractions
+
+def decode_values(column):
+    if len(column.integer_value_deltas) > 0:
+        values = []
+        value = 0
+        for delta in column.integer_value_deltas:
+            value += delta
+            values.append(float(value))
+        return values
+    if len(column.float_values) > 0:
+        return list(column.float_values)
+    return list(column.double_values)
+
+def decode(vehicle_data):
+    trigger_time = vehicle_data.collection_event_time_ms_epoch
+    signals = []
+    can_frames = []
+    if vehicle_data.payload_format_version == PAYLOAD_FORMAT_SAMPLES:
+        for signal in vehicle_data.captured_signals:
+            signals.append({
+                "signal_id": signal.signal_id,
+                "time_ms_epoch": trigger_time + signal.relative_time_ms,
+                "time_us_fraction": signal.relative_time_us_fraction,
+                "value": signal.double_value})
+        for frame in vehicle_data.can_frames:
+            can_frames.append({
+                "message_id": frame.message_id,
+                "interface_id": frame.interface_id,
+                "time_ms_epoch": trigger_time + frame.relative_time_ms,
+                "time_us_fraction": frame.relative_time_us_fraction,
+                "byte_values": list(frame.byte_values)})
+    elif vehicle_data.payload_format_version == PAYLOAD_FORMAT_COLUMNS:
+        for column in vehicle_data.signal_columns:
+            times, fractions = decode_times(column, trigger_time)
+            values = decode_values(column)
+            for i in range(len(times)):
+                signals.append({
+                    "signal_id": column.signal_id,
+                    "time_ms_epoch": times[i],
+                    "time_us_fraction": fractions[i],
+                    "value": values[i]})
+        for column in vehicle_data.can_frame_columns:
+            times, fractions = decode_times(column, trigger_time)
+            offset = 0
+            for i in range(len(times)):
+                size = column.frame_sizes[i]
+                can_frames.append({
+                    "message_id": column.message_id,
+                    "interface_id": column.interface_id,
+                    "time_ms_epoch": times[i],
+                    "time_us_fraction": fractions[i],
+                    "byte_values": list(column.byte_values[offset:offset + size])})
+                offset += size
+    else:
+        raise Exception("Unsupported payload format version " + str(vehicle_data.payload_format_version))
+    if vehicle_data.HasField("raw_can_log"):
+        can_frames += decode_raw_can_log(vehicle_data.raw_can_log, trigger_time)
+    signal_summaries = []
+    for summary in vehicle_data.signal_summaries:
+        signal_summaries.append({
+            "signal_id": summary.signal_id,
+            "window_start_ms_epoch": trigger_time + summary.relative_window_start_ms,
+            "window_period_ms": summary.window_period_ms,
+            "count": summary.count,
+            "min": summary.min,
+            "max": summary.max,
+            "mean": summary.mean,
+            "variance": summary.variance,
+            "histogram_counts": list(summary.histogram_counts),
+            "percentile_values": list(summary.percentile_values)})
+    signals.sort(key=lambda s: (s["time_ms_epoch"], s["time_us_fraction"]))
+    can_frames.sort(key=lambda f: (f["time_ms_epoch"], f["time_us_fraction"]))
+    return {
+        "campaign_arn": vehicle_data.campaign_arn,
+        "decoder_arn": vehicle_data.decoder_arn,
+        "collection_event_id": vehicle_data.collection_event_id,
+        "collection_event_time_ms_epoch": trigger_time,
+        "payload_format_version": vehicle_data.payload_format_version,
+        "signals": signals,
+        "can_frames": can_frames,
+        "signal_summaries": signal_summaries,
+        "active_dtc_codes": list(vehicle_data.dtc_data.active_dtc_codes),
+        "geohash": vehicle_data.geohash.geohash_string}
+
+def uncompress(payload, dictionary_file):
+    codec = payload[3]
+    dictionary_id = int.from_bytes(payload[4:8], "little")
+    uncompressed_size = int.from_bytes(payload[8:12], "little")
+    data = payload[COMPRESSED_HEADER_SIZE:]
+    if codec == CODEC_LZ4:
+        import lz4.block
+        return lz4.block.decompress(data, uncompressed_size=uncompressed_size)
+    if codec == CODEC_ZSTD:
+        import zstandard
+        if dictionary_id != 0 and dictionary_file is None:
+            print("Payload compressed with dictionary "+str(dictionary_id)+", use --dictionary <FILE>")
+            exit(-1)
+        dictionary = None
+        if dictionary_file is not None:
+            with open(dictionary_file, 'rb') as fp:
+                dictionary = zstandard.ZstdCompressionDict(fp.read())
+        decompressor = zstandard.ZstdDecompressor(dict_data=dictionary)
+        return decompressor.decompress(data, max_output_size=uncompressed_size)
+    print("Unknown compression codec "+str(codec))
+    exit(-1)
+
+def print_candump(events):
+    for event in events:
+        for frame in event["can_frames"]:
+            if frame["message_id"] & CAN_EFF_FLAG:
+                message_id = "%08X" % (frame["message_id"] & ~CAN_EFF_FLAG)
+            else:
+                message_id = "%03X" % frame["message_id"]
+            # CAN FD frames are written with the separator ## followed by the flags
+            separator = "#" if len(frame["byte_values"]) <= CAN_MAX_DLEN else "##0"
+            print("(%d.%06d) %s %s%s%s" % (
+                frame["time_ms_epoch"] // 1000,
+                (frame["time_ms_epoch"] % 1000) * 1000 + frame["time_us_fraction"],
+                frame["interface_id"],
+                message_id,
+                separator,
+                bytes(frame["byte_values"]).hex().upper()))
+
+if len(sys.argv) < 2:
+    print("Usage: python3 "+sys.argv[0]+" <PAYLOAD_FILE> [--snappy] [--dictionary <FILE>] [--candump]")
+    exit(-1)
+
+dictionary_file = None
+if "--dictionary" in sys.argv[2:-1]:
+    dictionary_file = sys.argv[sys.argv.index("--dictionary") + 1]
+
+with open(sys.argv[1], 'rb') as fp:
+    payload = fp.read()
+if payload[:3] == COMPRESSED_HEADER_MAGIC and len(payload) >= COMPRESSED_HEADER_SIZE:
+    payload = uncompress(payload, dictionary_file)
+elif "--snappy" in sys.argv[2:]:
+    import snappy
+    payload = snappy.uncompress(payload)
+
+vehicle_data = vehicle_data_pb2.VehicleData()
+vehicle_data.ParseFromString(payload)
+# Small payloads of several events can be bundled into one publish
+events = [decode(vehicle_data)] + [decode(event) for event in vehicle_data.aggregated_vehicle_data]
+if "--candump" in sys.argv[2:]:
+    print_candump(events)
+elif len(events) > 1:
+    print(json.dumps(events, indent=4))
+else:
+    print(json.dumps(events[0], indent=4))
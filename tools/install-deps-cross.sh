@@ -58,7 +58,9 @@ apt install -y \
     curl \
     zlib1g-dev:arm64 \
     libcurl4-openssl-dev:arm64 \
-    libsnappy-dev:arm64
+    libsnappy-dev:arm64 \
+    liblz4-dev:arm64 \
+    libzstd-dev:arm64
 
 mkdir -p deps-cross && cd deps-cross
 
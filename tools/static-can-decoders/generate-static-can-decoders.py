@@ -0,0 +1,238 @@
+#!/usr/bin/python3
+# Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+# SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+# Licensed under the Amazon Software License (the "License").
+# You may not use this file except in compliance with the License.
+# A copy of the License is located at
+# http://aws.amazon.com/asl/
+# or in the "license" file accompanying this file. This file is distributed
+# on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+# express or implied. See the License for the specific language governing
+# permissions and limitations under the License.
+
+# Generates a decode function per CAN ID with the masks and shifts computed at compile time, see
+# StaticCANDecoder.h. The input is either the JSON form of the decoder manifest or a DBC file together with
+# a JSON object mapping the signal names to the signal IDs of the decoder manifest.
+
+import argparse
+import json
+import sys
+
+MAX_CAN_FRAME_BYTE_SIZE = 8
+MAX_CANFD_FRAME_BYTE_SIZE = 64
+
+
+def get(signal, snake_case, camel_case, default=None):
+    # Accept the field names of the proto as well as the camel case names of the protobuf JSON mapping
+    if snake_case in signal:
+        return signal[snake_case]
+    if camel_case in signal:
+        return signal[camel_case]
+    if default is None:
+        raise KeyError(snake_case)
+    return default
+
+
+def load_manifest(filename):
+    with open(filename) as fp:
+        manifest = json.load(fp)
+    signals = []
+    for signal in get(manifest, "can_signals", "canSignals", []):
+        signals.append(
+            {
+                "interface_id": str(get(signal, "interface_id", "interfaceId", "")),
+                "message_id": int(get(signal, "message_id", "messageId")),
+                "signal_id": int(get(signal, "signal_id", "signalId")),
+                "name": None,
+                "start_bit": int(get(signal, "start_bit", "startBit", 0)),
+                "length": int(get(signal, "length", "length")),
+                "is_big_endian": bool(get(signal, "is_big_endian", "isBigEndian", False)),
+                "is_signed": bool(get(signal, "is_signed", "isSigned", False)),
+                "factor": float(get(signal, "factor", "factor", 1.0)),
+                "offset": float(get(signal, "offset", "offset", 0.0)),
+            }
+        )
+    return signals
+
+
+def dbc_to_lsb_start_bit(start, length):
+    # DBC files give the most significant bit of Motorola signals, the decoder manifest the least significant
+    msb = (start // 8) * 8 + (7 - start % 8)
+    lsb = msb + length - 1
+    return (lsb // 8) * 8 + (7 - lsb % 8)
+
+
+def load_dbc(filename, signal_ids_filename):
+    import cantools
+
+    with open(signal_ids_filename) as fp:
+        signal_ids = json.load(fp)
+    db = cantools.database.load_file(filename)
+    signals = []
+    for message in db.messages:
+        if message.is_multiplexed():
+            print(f"Skipping multiplexed message {message.name}, it is decoded by the generic decoder")
+            continue
+        for signal in message.signals:
+            if signal.name not in signal_ids:
+                continue
+            is_big_endian = signal.byte_order == "big_endian"
+            signals.append(
+                {
+                    "interface_id": "",
+                    "message_id": message.frame_id | (0x80000000 if message.is_extended_frame else 0),
+                    "signal_id": int(signal_ids[signal.name]),
+                    "name": signal.name,
+                    "start_bit": dbc_to_lsb_start_bit(signal.start, signal.length)
+                    if is_big_endian
+                    else signal.start,
+                    "length": signal.length,
+                    "is_big_endian": is_big_endian,
+                    "is_signed": signal.is_signed,
+                    "factor": float(signal.scale),
+                    "offset": float(signal.offset),
+                }
+            )
+    return signals
+
+
+def fits_word(signal):
+    # Same condition as CANDecoder::compileDecodePlan for the single word fast path
+    start_byte = signal["start_bit"] // 8
+    start_bit_in_byte = signal["start_bit"] % 8
+    length = signal["length"]
+    if length < 1 or length > 64:
+        return False
+    if signal["is_big_endian"]:
+        end = start_byte * 8 + 8 - start_bit_in_byte
+        low_byte = (end - length) // 8 if end >= length else 0
+        high_byte = start_byte
+    else:
+        low_byte = start_byte
+        high_byte = (signal["start_bit"] + length - 1) // 8
+    return high_byte - low_byte + 1 <= 8
+
+
+def cpp_double(value):
+    # repr is the shortest representation reading back to the same double
+    text = repr(float(value))
+    if "inf" in text or "nan" in text:
+        raise ValueError(f"Invalid factor or offset {text}")
+    return text
+
+
+def generate(signals, source):
+    # The same CAN ID can have other signals on another interface, at runtime the decoder matching the format of
+    # the channel is used
+    messages = {}
+    for signal in signals:
+        messages.setdefault((signal["message_id"], signal["interface_id"]), []).append(signal)
+
+    lines = [
+        "// Generated by tools/static-can-decoders/generate-static-can-decoders.py from " + source,
+        "// Do not edit, changes are overwritten by the next build.",
+        "",
+        "#pragma once",
+        "",
+        '#include "StaticCANDecoder.h"',
+        "#include <algorithm>",
+        "",
+        "namespace Aws",
+        "{",
+        "namespace IoTFleetWise",
+        "{",
+        "namespace DataManagement",
+        "{",
+        "namespace",
+        "{",
+    ]
+    decoders = []
+    for message_id, interface_id in sorted(messages):
+        message_signals = messages[(message_id, interface_id)]
+        if not all(fits_word(signal) for signal in message_signals):
+            print(f"Skipping CAN ID 0x{message_id:X}, a signal spans more than 8 bytes")
+            continue
+        # The decoder manifest ingestion sizes a message the same way
+        size = MAX_CAN_FRAME_BYTE_SIZE
+        if any(signal["start_bit"] + signal["length"] > MAX_CAN_FRAME_BYTE_SIZE * 8 for signal in message_signals):
+            size = MAX_CANFD_FRAME_BYTE_SIZE
+        suffix = f"0x{message_id:X}_{len(decoders)}"
+        lines.append("")
+        lines.append(f"constexpr StaticCANSignalInfo SIGNALS_{suffix}[] = {{")
+        for signal in message_signals:
+            comment = f" // {signal['name']}" if signal["name"] else ""
+            lines.append(
+                f"    {{ {signal['signal_id']}U, {signal['start_bit']}, {signal['length']}, "
+                f"{str(signal['is_big_endian']).lower()}, {str(signal['is_signed']).lower()}, "
+                f"{cpp_double(signal['factor'])}, {cpp_double(signal['offset'])} }},{comment}"
+            )
+        lines.append("};")
+        lines.append("")
+        lines.append("bool")
+        lines.append(f"decode{suffix}( const uint8_t *frameData, size_t frameSize, double *physicalValues )")
+        lines.append("{")
+        for index, signal in enumerate(message_signals):
+            lines.append(
+                f"    using S{index} = StaticCANSignal<{signal['start_bit']}, {signal['length']}, "
+                f"{str(signal['is_big_endian']).lower()}, {str(signal['is_signed']).lower()}, {size}>;"
+            )
+        min_frame_sizes = ", ".join(f"S{index}::MIN_FRAME_SIZE" for index in range(len(message_signals)))
+        lines.append(f"    constexpr uint32_t MIN_FRAME_SIZE = std::max( {{ {min_frame_sizes} }} );")
+        lines.append("    if ( frameSize < MIN_FRAME_SIZE )")
+        lines.append("    {")
+        lines.append("        return false;")
+        lines.append("    }")
+        for index, signal in enumerate(message_signals):
+            lines.append(
+                f"    physicalValues[{index}] = static_cast<double>( S{index}::extract( frameData, frameSize ) ) * "
+                f"{cpp_double(signal['factor'])} + {cpp_double(signal['offset'])};"
+            )
+        lines.append("    return true;")
+        lines.append("}")
+        decoders.append(
+            f"    {{ {message_id}U, {size}, SIGNALS_{suffix}, {len(message_signals)}, &decode{suffix} }},"
+        )
+    if not decoders:
+        raise ValueError("No CAN message could be generated")
+    lines.append("")
+    lines.append("} // namespace")
+    lines.append("")
+    lines.append("constexpr StaticCANMessageDecoder GENERATED_STATIC_CAN_DECODERS[] = {")
+    lines.extend(decoders)
+    lines.append("};")
+    lines.append("")
+    lines.append("} // namespace DataManagement")
+    lines.append("} // namespace IoTFleetWise")
+    lines.append("} // namespace Aws")
+    return "\n".join(lines) + "\n"
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generates static CAN decoders for a fixed decoder manifest")
+    parser.add_argument("input", help="Decoder manifest in JSON (.json) or DBC file (.dbc)")
+    parser.add_argument("output", help="Generated header file")
+    parser.add_argument(
+        "--signal-ids", help="JSON object mapping the DBC signal names to signal IDs, required for DBC files"
+    )
+    args = parser.parse_args()
+
+    if args.input.lower().endswith(".dbc"):
+        if args.signal_ids is None:
+            print("--signal-ids is required for DBC files")
+            return -1
+        signals = load_dbc(args.input, args.signal_ids)
+    else:
+        signals = load_manifest(args.input)
+
+    try:
+        header = generate(signals, args.input)
+    except ValueError as error:
+        print(error)
+        return -1
+    with open(args.output, "w") as fp:
+        fp.write(header)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())